@@ -9,6 +9,11 @@ static int test_fail = 0;
 
 void test_irr_array();
 void test_irr_string();
+void test_fast_atof();
+void test_material();
+void test_ref_ptr();
+void test_atom();
+void test_color_converter();
 
 static video::E_DRIVER_TYPE chooseDriver(core::stringc arg_)
 {
@@ -40,6 +45,11 @@ void run_unit_tests() {
 	try {
 		test_irr_array();
 		test_irr_string();
+		test_fast_atof();
+		test_material();
+		test_ref_ptr();
+		test_atom();
+		test_color_converter();
 	} catch (const std::exception &e) {
 		std::cerr << e.what() << std::endl;
 		test_fail++;
@@ -1,4 +1,5 @@
 #include <irrArray.h>
+#include <utility>
 #include "test_helper.h"
 
 using namespace irr;
@@ -57,6 +58,49 @@ static void test_basics() {
 	UASSERTEQ(v.size(), 2);
 }
 
+static void test_move() {
+	array<int> v;
+	for (int i = 0; i < 5; i++)
+		v.push_back(i);
+	v.sort();
+	const int *data = v.const_pointer();
+
+	// moving takes the memory and the sorted flag over
+	array<int> w(std::move(v));
+	UASSERTEQ(w.size(), 5);
+	UASSERTEQ(w.const_pointer(), data);
+	UASSERTEQ(w.binary_search(3), 3);
+	UASSERT(v.empty());
+
+	v.push_back(7);
+	v = std::move(w);
+	UASSERTEQ(v.size(), 5);
+	UASSERTEQ(v.const_pointer(), data);
+	UASSERTEQ(v[4], 4);
+	UASSERT(w.empty());
+
+	// the moved from array can be used again
+	w.push_back(1);
+	UASSERTEQ(w.size(), 1);
+	UASSERTEQ(w[0], 1);
+}
+
+static void test_self_assignment() {
+	array<int> v;
+	for (int i = 0; i < 5; i++)
+		v.push_back(i);
+	const array<int> &ref = v;
+	v = ref;
+	UASSERTEQ(v.size(), 5);
+	UASSERTEQ(v[4], 4);
+
+	array<int> &alias = v;
+	v = std::move(alias);
+	UASSERTEQ(v.size(), 5);
+	UASSERTEQ(v[0], 0);
+	UASSERTEQ(v[4], 4);
+}
+
 static void test_linear_searches() {
 	// Populate the array with 0, 1, 2, ..., 100, 100, 99, 98, 97, ..., 0
 	array<int> arr;
@@ -129,6 +173,8 @@ static void test_binary_searches() {
 void test_irr_array()
 {
 	test_basics();
+	test_move();
+	test_self_assignment();
 	test_linear_searches();
 	test_binary_searches();
 	std::cout << "    test_irr_array PASSED" << std::endl;
@@ -0,0 +1,132 @@
+#include <irrAtom.h>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "test_helper.h"
+
+using namespace irr;
+using core::atom;
+
+#define CMPSTR(a, b) (!strcmp(a, b))
+#define UASSERTSTR(actual, expected) UASSERTCMP(CMPSTR, actual.c_str(), expected)
+
+static void test_basics()
+{
+	atom empty;
+	UASSERT(empty.empty());
+	UASSERTSTR(empty, "");
+	UASSERTEQ(empty.size(), 0);
+	UASSERT(atom("") == empty);
+	UASSERT(atom((const c8*)0) == empty);
+
+	// atoms of the same text share the entry
+	atom name("test_atom name");
+	atom other(core::stringc("test_atom name"));
+	UASSERT(name == other);
+	UASSERT(!name.empty());
+	UASSERTSTR(name, "test_atom name");
+	UASSERTEQ(name.size(), 14);
+	UASSERTEQ(name.hash(), other.hash());
+	UASSERT(name.c_str() == other.c_str());
+
+	atom different("test_atom Name");
+	UASSERT(name != different);
+	UASSERT((name < different) != (different < name));
+}
+
+static void test_find()
+{
+	UASSERT(atom::find("test_atom unknown").empty());
+	{
+		atom interned("test_atom interned");
+		UASSERT(atom::find("test_atom interned") == interned);
+		UASSERT(atom::find(core::stringc("test_atom interned")) == interned);
+		// find() doesn't intern the text
+		UASSERT(atom::find("test_atom unknown").empty());
+	}
+	// the last atom removes the text from the table
+	UASSERT(atom::find("test_atom interned").empty());
+}
+
+static void test_copy_and_move()
+{
+	atom name("test_atom copied");
+	atom copy(name);
+	UASSERT(copy == name);
+
+	atom moved(std::move(copy));
+	UASSERT(moved == name);
+	UASSERT(copy.empty());
+
+	atom assigned;
+	assigned = name;
+	UASSERT(assigned == name);
+	const atom &alias = assigned;
+	assigned = alias;
+	UASSERT(assigned == name);
+	atom &movedAlias = assigned;
+	assigned = std::move(movedAlias);
+	UASSERT(assigned == name);
+
+	assigned = atom("test_atom other");
+	UASSERT(assigned != name);
+	UASSERTSTR(assigned, "test_atom other");
+
+	// the entry stays while any atom points to it
+	name = atom();
+	assigned = atom();
+	UASSERTSTR(moved, "test_atom copied");
+	UASSERT(atom::find("test_atom copied") == moved);
+	moved = atom();
+	UASSERT(atom::find("test_atom copied").empty());
+	UASSERT(atom::find("test_atom other").empty());
+}
+
+static void test_hash_map()
+{
+	std::unordered_map<atom, int> map;
+	map[atom("test_atom one")] = 1;
+	map[atom("test_atom two")] = 2;
+	UASSERTEQ(map.size(), 2);
+	UASSERTEQ(map[atom("test_atom one")], 1);
+	UASSERTEQ(map[atom("test_atom two")], 2);
+	UASSERT(map.find(atom::find("test_atom three")) == map.end());
+}
+
+static void test_threads()
+{
+	// interning and releasing the same texts on several threads
+	std::atomic<int> mismatches(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([&mismatches] {
+			for (int i = 0; i < 20000; i++)
+			{
+				atom name(core::stringc("test_atom thread ") + core::stringc(i % 10));
+				atom copy(name);
+				if (atom::find(name.c_str()) != name)
+					++mismatches;
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+		thread.join();
+	UASSERTEQ(mismatches.load(), 0);
+
+	for (int i = 0; i < 10; i++)
+		UASSERT(atom::find(core::stringc("test_atom thread ") + core::stringc(i)).empty());
+}
+
+void test_atom()
+{
+	test_basics();
+	test_find();
+	test_copy_and_move();
+	test_hash_map();
+	test_threads();
+	std::cout << "    test_atom PASSED" << std::endl;
+}
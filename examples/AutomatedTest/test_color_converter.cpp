@@ -0,0 +1,78 @@
+#include <irrlicht.h>
+#include "test_helper.h"
+
+using namespace irr;
+using namespace irr::video;
+
+// The conversions between A8R8G8B8 and R8G8B8 process whole vectors first,
+// these are the plain loops they have to match.
+static void referenceA8R8G8B8toR8G8B8(const u8 *in, s32 count, u8 *out)
+{
+	for (s32 x = 0; x < count; ++x) {
+		out[x * 3 + 0] = in[x * 4 + 2];
+		out[x * 3 + 1] = in[x * 4 + 1];
+		out[x * 3 + 2] = in[x * 4 + 0];
+	}
+}
+
+static void referenceR8G8B8toA8R8G8B8(const u8 *in, s32 count, u8 *out)
+{
+	for (s32 x = 0; x < count; ++x) {
+		out[x * 4 + 0] = in[x * 3 + 2];
+		out[x * 4 + 1] = in[x * 3 + 1];
+		out[x * 4 + 2] = in[x * 3 + 0];
+		out[x * 4 + 3] = 0xff;
+	}
+}
+
+static void test_conversion(IVideoDriver *driver, ECOLOR_FORMAT from, ECOLOR_FORMAT to,
+	void (*reference)(const u8 *, s32, u8 *))
+{
+	const u32 toSize = IImage::getBitsPerPixelFromFormat(to) / 8;
+	const u8 guard = 0xcd;
+
+	u8 source[80 * 4 + 3];
+	u32 seed = 12345;
+	for (u8 &value : source) {
+		seed = seed * 1103515245 + 12345;
+		value = (u8)(seed >> 16);
+	}
+
+	// every length around the vector widths, at every alignment
+	for (s32 count = 0; count < 70; ++count) {
+		for (u32 offset = 0; offset < 4; ++offset) {
+			u8 expected[80 * 4 + 8];
+			u8 converted[80 * 4 + 8];
+			for (u32 i = 0; i < sizeof(converted); ++i)
+				expected[i] = converted[i] = guard;
+
+			reference(source + offset, count, expected + offset);
+			driver->convertColor(source + offset, from, count, converted + offset, to);
+
+			for (u32 i = 0; i < sizeof(converted); ++i) {
+				if (converted[i] != expected[i]) {
+					std::cout << "count " << count << " offset " << offset << " byte " << i << std::endl;
+					UASSERTEQ((u32)converted[i], (u32)expected[i]);
+				}
+			}
+			// nothing written after the last pixel
+			UASSERTEQ((u32)converted[offset + count * toSize], (u32)guard);
+		}
+	}
+}
+
+void test_color_converter()
+{
+	SIrrlichtCreationParameters p;
+	p.DriverType = EDT_NULL;
+	p.LoggingLevel = ELL_NONE;
+	IrrlichtDevice *device = createDeviceEx(p);
+	UASSERT(device);
+
+	IVideoDriver *driver = device->getVideoDriver();
+	test_conversion(driver, ECF_A8R8G8B8, ECF_R8G8B8, referenceA8R8G8B8toR8G8B8);
+	test_conversion(driver, ECF_R8G8B8, ECF_A8R8G8B8, referenceR8G8B8toA8R8G8B8);
+
+	device->drop();
+	std::cout << "    test_color_converter PASSED" << std::endl;
+}
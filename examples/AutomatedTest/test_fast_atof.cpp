@@ -0,0 +1,111 @@
+#include <fast_atof.h>
+#include <cstring>
+#include <limits>
+#include "test_helper.h"
+
+using namespace irr;
+using namespace irr::core;
+
+// parses the whole string, bounded and without relying on the terminator
+static f32 parse(const char* str)
+{
+	const size_t length = strlen(str);
+	f32 result = 0.f;
+	const char* next = fast_atof_fixed_move(str, result, str + length);
+	UASSERTEQ(next, str + length);
+	return result;
+}
+
+static void test_basics()
+{
+	UASSERTEQ(parse("0"), 0.f);
+	UASSERTEQ(parse("-12.375"), -12.375f);
+	UASSERTEQ(parse("1.5e-3"), 0x1.89374cp-10f);
+	UASSERTEQ(parse(".25"), 0.25f);
+	UASSERTEQ(parse("+7."), 7.f);
+	UASSERTEQ(parse("0.1"), 0x1.99999ap-4f);
+	UASSERTEQ(parse("1e39"), std::numeric_limits<f32>::infinity());
+	UASSERTEQ(parse("1e-50"), 0.f);
+
+	// strings without digits are 0, an e without digits isn't part of the number
+	f32 result = 1.f;
+	const char* str = "-.x";
+	UASSERTEQ(fast_atof_fixed_move(str, result), str + 2);
+	UASSERTEQ(result, 0.f);
+	str = "2ex";
+	UASSERTEQ(fast_atof_fixed_move(str, result), str + 1);
+	UASSERTEQ(result, 2.f);
+}
+
+static void test_halfway()
+{
+	// exactly between two floats rounds to even
+	UASSERTEQ(parse("16777217"), 16777216.f);
+	UASSERTEQ(parse("16777219"), 16777220.f);
+	UASSERTEQ(parse("1.000000059604644775390625"), 1.f);
+	UASSERTEQ(parse("340282356779733661637539395458142568448"), std::numeric_limits<f32>::infinity());
+
+	// just above or below it doesn't
+	UASSERTEQ(parse("1.000000059604644775390625000001"), 0x1.000002p+0f);
+	UASSERTEQ(parse("16777217.000000000000000000001"), 16777218.f);
+	UASSERTEQ(parse("16777216.999999999999999999999"), 16777216.f);
+	UASSERTEQ(parse("340282356779733661637539395458142568447.9"), 0x1.fffffep+127f);
+}
+
+static void test_subnormals()
+{
+	UASSERTEQ(parse("1.17549428e-38"), 0x1.fffffcp-127f);
+	UASSERTEQ(parse("1.4e-45"), 0x1p-149f);
+	UASSERTEQ(parse("4.2e-45"), 0x1.8p-148f);
+
+	// half of the smallest subnormal, exactly and slightly more
+	UASSERTEQ(parse("7.00649232162408535461864791644958065640130970938257885878534141944895541342930300743319094181060791015625e-46"), 0.f);
+	UASSERTEQ(parse("7.006492321624085354618647916449580656401309709382578858785341419448955413429303007433190941810607910156250000001e-46"), 0x1p-149f);
+}
+
+static void test_long_mantissas()
+{
+	UASSERTEQ(parse("3.14159265358979323846264338327950288"), 0x1.921fb6p+1f);
+	UASSERTEQ(parse("0.1000000000000000000000000000001"), 0x1.99999ap-4f);
+	UASSERTEQ(parse("1.2345678901234567890123"), 0x1.3c0ca4p+0f);
+	UASSERTEQ(parse("000000000000000000000000000001.5"), 1.5f);
+	UASSERTEQ(parse("0.000000000000000000000000000015e30"), 15.f);
+}
+
+static void test_bounded()
+{
+	// nothing is read at or after end
+	const char str[] = "1.5e3";
+	f32 result = 0.f;
+	UASSERTEQ(fast_atof_fixed_move(str, result, str + 3), str + 3);
+	UASSERTEQ(result, 1.5f);
+	UASSERTEQ(fast_atof_fixed_move(str, result, str + 4), str + 3);
+	UASSERTEQ(result, 1.5f);
+
+	const char digits[] = "16777217.0000000000000000000019";
+	UASSERTEQ(fast_atof_fixed_move(digits, result, digits + 29), digits + 29);
+	UASSERTEQ(result, 16777216.f);
+	UASSERTEQ(fast_atof_fixed_move(digits, result, digits + 30), digits + 30);
+	UASSERTEQ(result, 16777218.f);
+
+	const char list[] = "1, 2.5;-3e1 42";
+	f32 values[4] = {};
+	const char* next = 0;
+	UASSERTEQ(fast_atof_array(list, list + 12, values, 4, &next), 3u);
+	UASSERTEQ(next, list + 11);
+	UASSERTEQ(values[0], 1.f);
+	UASSERTEQ(values[1], 2.5f);
+	UASSERTEQ(values[2], -30.f);
+	UASSERTEQ(fast_atof_array(list, list + 13, values, 4), 4u);
+	UASSERTEQ(values[3], 4.f);
+}
+
+void test_fast_atof()
+{
+	test_basics();
+	test_halfway();
+	test_subnormals();
+	test_long_mantissas();
+	test_bounded();
+	std::cout << "    test_fast_atof PASSED" << std::endl;
+}
@@ -0,0 +1,94 @@
+#include <SMaterial.h>
+#include <irrArray.h>
+#include <utility>
+#include "test_helper.h"
+
+using namespace irr;
+using namespace irr::video;
+
+static core::matrix4 scaled(f32 s)
+{
+	core::matrix4 m;
+	m.setScale(s);
+	return m;
+}
+
+static void test_layer_move()
+{
+	SMaterialLayer first;
+	first.TextureWrapU = ETC_CLAMP;
+	first.LODBias = 3;
+	first.setTextureMatrix(scaled(2.f));
+	const core::matrix4 *matrix = &first.getTextureMatrix();
+
+	// moving hands the texture matrix over instead of copying it
+	SMaterialLayer second(std::move(first));
+	UASSERT(&second.getTextureMatrix() == matrix);
+	UASSERT(second.getTextureMatrix() == scaled(2.f));
+	UASSERTEQ(second.TextureWrapU, ETC_CLAMP);
+	UASSERTEQ(second.LODBias, 3);
+	UASSERT(first.getTextureMatrix() == core::IdentityMatrix);
+
+	SMaterialLayer third;
+	third.setTextureMatrix(scaled(4.f));
+	third = std::move(second);
+	UASSERT(&third.getTextureMatrix() == matrix);
+	UASSERT(third.getTextureMatrix() == scaled(2.f));
+	UASSERTEQ(third.TextureWrapU, ETC_CLAMP);
+
+	SMaterialLayer &alias = third;
+	third = std::move(alias);
+	UASSERT(third.getTextureMatrix() == scaled(2.f));
+
+	// copies still get their own matrix
+	SMaterialLayer copy(third);
+	UASSERT(&copy.getTextureMatrix() != matrix);
+	UASSERT(copy == third);
+}
+
+static void test_material_compare()
+{
+	SMaterial first;
+	first.getTextureMatrix(0) = scaled(2.f);
+	const SMaterial &ref = first;
+	UASSERT(!(first != ref));
+	UASSERT(first == ref);
+
+	SMaterial second(first);
+	UASSERT(!(first != second));
+	second.getTextureMatrix(0) = scaled(3.f);
+	UASSERT(first != second);
+	second.getTextureMatrix(0) = scaled(2.f);
+	UASSERT(first == second);
+	second.Shininess = 1.f;
+	UASSERT(first != second);
+
+	first = ref;
+	UASSERT(first.getTextureMatrix(0) == scaled(2.f));
+}
+
+static void test_material_array()
+{
+	// growing moves the materials, their texture matrices have to survive
+	core::array<SMaterial> materials;
+	for (u32 i = 0; i < 100; i++)
+	{
+		SMaterial m;
+		m.getTextureMatrix(0) = scaled((f32)i);
+		materials.push_back(std::move(m));
+	}
+	for (u32 i = 0; i < 100; i++)
+		UASSERT(materials[i].getTextureMatrix(0) == scaled((f32)i));
+
+	core::array<SMaterial> moved(std::move(materials));
+	UASSERTEQ(moved.size(), 100);
+	UASSERT(moved[99].getTextureMatrix(0) == scaled(99.f));
+}
+
+void test_material()
+{
+	test_layer_move();
+	test_material_compare();
+	test_material_array();
+	std::cout << "    test_material PASSED" << std::endl;
+}
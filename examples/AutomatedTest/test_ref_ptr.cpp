@@ -0,0 +1,135 @@
+#include <irrRefPtr.h>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "test_helper.h"
+
+using namespace irr;
+using core::ref_ptr;
+
+static int alive = 0;
+
+class CCounted : public IReferenceCounted
+{
+public:
+	CCounted() { ++alive; }
+	~CCounted() { --alive; }
+};
+
+class CDerived : public CCounted
+{
+};
+
+static void test_ownership()
+{
+	{
+		ref_ptr<CCounted> p = core::adopt_ref(new CCounted());
+		UASSERTEQ(alive, 1);
+		UASSERTEQ(p->getReferenceCount(), 1);
+
+		ref_ptr<CCounted> copy(p);
+		UASSERTEQ(p->getReferenceCount(), 2);
+		UASSERT(copy == p);
+
+		// moving doesn't touch the counter
+		ref_ptr<CCounted> moved(std::move(copy));
+		UASSERTEQ(p->getReferenceCount(), 2);
+		UASSERT(!copy);
+
+		moved = nullptr;
+		UASSERTEQ(p->getReferenceCount(), 1);
+		UASSERTEQ(alive, 1);
+	}
+	UASSERTEQ(alive, 0);
+
+	CCounted *raw = new CCounted();
+	{
+		ref_ptr<CCounted> p = core::grab_ref(raw);
+		UASSERTEQ(raw->getReferenceCount(), 2);
+		CCounted *released = p.release();
+		UASSERT(released == raw);
+		UASSERT(!p);
+		UASSERTEQ(raw->getReferenceCount(), 2);
+		released->drop();
+	}
+	UASSERTEQ(raw->getReferenceCount(), 1);
+	raw->drop();
+	UASSERTEQ(alive, 0);
+}
+
+static void test_assignment()
+{
+	ref_ptr<CCounted> p(new CCounted(), false);
+	ref_ptr<CCounted> q(new CCounted(), false);
+	UASSERTEQ(alive, 2);
+
+	q = p;
+	UASSERTEQ(alive, 1);
+	UASSERTEQ(p->getReferenceCount(), 2);
+
+	// self-assignment must not drop the object first
+	const ref_ptr<CCounted> &alias = p;
+	p = alias;
+	UASSERTEQ(p->getReferenceCount(), 2);
+	ref_ptr<CCounted> &movedAlias = p;
+	p = std::move(movedAlias);
+	UASSERT(p.get());
+	UASSERTEQ(p->getReferenceCount(), 2);
+	p.reset(p.get());
+	UASSERTEQ(p->getReferenceCount(), 2);
+
+	// converting from a derived class
+	ref_ptr<CDerived> derived(new CDerived(), false);
+	ref_ptr<CCounted> base(derived);
+	UASSERTEQ(derived->getReferenceCount(), 2);
+	ref_ptr<CCounted> movedBase(std::move(derived));
+	UASSERTEQ(movedBase->getReferenceCount(), 2);
+	UASSERT(!derived);
+
+	p.swap(base);
+	UASSERT(p == movedBase);
+	UASSERTEQ(q->getReferenceCount(), 2);
+
+	p = nullptr;
+	q.reset();
+	base.reset();
+	movedBase.reset();
+	UASSERTEQ(alive, 0);
+}
+
+static void test_thread_safe_counting()
+{
+	CCounted *object = new CCounted();
+#ifndef IRR_THREADSAFE_REFERENCE_COUNTING
+	UASSERT(!object->isThreadSafeReferenceCounting());
+#endif
+	object->setThreadSafeReferenceCounting(true);
+	UASSERT(object->isThreadSafeReferenceCounting());
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([object] {
+			for (int i = 0; i < 100000; i++)
+			{
+				ref_ptr<CCounted> p(object);
+				ref_ptr<CCounted> copy(p);
+			}
+		});
+	}
+	for (std::thread &thread : threads)
+		thread.join();
+
+	UASSERTEQ(object->getReferenceCount(), 1);
+	UASSERTEQ(alive, 1);
+	object->drop();
+	UASSERTEQ(alive, 0);
+}
+
+void test_ref_ptr()
+{
+	test_ownership();
+	test_assignment();
+	test_thread_safe_counting();
+	std::cout << "    test_ref_ptr PASSED" << std::endl;
+}
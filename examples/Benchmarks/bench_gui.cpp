@@ -0,0 +1,46 @@
+#include <irrlicht.h>
+#include "bench_helper.h"
+
+using namespace irr;
+using namespace gui;
+
+static const wchar_t *paragraph =
+	L"The quick brown fox jumps over the lazy dog. Pack my box with five dozen liquor jugs. "
+	L"How vexingly quick daft zebras jump! Sphinx of black quartz, judge my vow. "
+	L"The five boxing wizards jump quickly, while the jay, pig, fox, zebra and my wolves quack. ";
+
+void bench_gui(IrrlichtDevice *device)
+{
+	IGUIEnvironment *guienv = device->getGUIEnvironment();
+	video::IVideoDriver *driver = device->getVideoDriver();
+	IGUIFont *font = guienv->getBuiltInFont();
+	if (!font)
+		return;
+
+	core::stringw text;
+	for (u32 i = 0; i < 8; ++i)
+		text += paragraph;
+
+	const core::recti screen(0, 0, 640, 480);
+	benchmark("font_draw_line", 1000, [&] {
+		font->draw(paragraph, screen, video::SColor(255, 255, 255, 255));
+	});
+
+	benchmark("font_getDimension", 1000, [&] {
+		core::dimension2du size = font->getDimension(text.c_str());
+		doNotOptimize(&size);
+	});
+
+	// setText breaks the text into lines when word wrap is enabled
+	IGUIStaticText *label = guienv->addStaticText(L"", core::recti(0, 0, 200, 480));
+	label->setWordWrap(true);
+	benchmark("staticText_breakText_200px", 200, [&] {
+		label->setText(text.c_str());
+	});
+	benchmark("staticText_draw_wrapped", 200, [&] {
+		driver->beginScene();
+		label->draw();
+		driver->endScene();
+	});
+	label->remove();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <irrlicht.h>
+
+// Samples taken of every benchmark, the reported values are per call
+constexpr int BENCHMARK_SAMPLES = 7;
+
+// Checks the benchmark name against the filter given on the command line
+bool benchmarkEnabled(const char *name);
+
+// Adds the samples in nanoseconds per call to the JSON report
+void benchmarkResult(const char *name, irr::u32 iterations, std::vector<double> &samples);
+
+// Keeps the compiler from removing computations whose results are unused
+void doNotOptimize(const void *p);
+
+// Times f, called iterations times per sample after one warm up sample
+template <typename F>
+void benchmark(const char *name, irr::u32 iterations, F f)
+{
+	if (!benchmarkEnabled(name))
+		return;
+
+	std::vector<double> samples;
+	for (int s = -1; s < BENCHMARK_SAMPLES; ++s) {
+		const auto start = std::chrono::steady_clock::now();
+		for (irr::u32 i = 0; i < iterations; ++i)
+			f();
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+		if (s >= 0)
+			samples.push_back(elapsed.count() / iterations);
+	}
+	benchmarkResult(name, iterations, samples);
+}
+
+// A cube of 2 units around the origin, also used by the rendering benchmarks
+irr::scene::SMesh *createCube();
+
+// Renders the scripted scenes with the driver named on the command line
+int runRenderBenchmarks(int argc, char *argv[]);
+
+// Replays a frame captured by the rendering benchmarks, or by any application
+int runReplayBenchmark(int argc, char *argv[]);
+
+void bench_math();
+void bench_video(irr::IrrlichtDevice *device);
+void bench_io(irr::IrrlichtDevice *device);
+void bench_scene(irr::IrrlichtDevice *device);
+void bench_gui(irr::IrrlichtDevice *device);
@@ -0,0 +1,152 @@
+#include <cstring>
+#include <irrlicht.h>
+#include <zlib.h>
+#include "bench_helper.h"
+
+using namespace irr;
+
+static void put16(core::array<u8> &out, u32 v)
+{
+	out.push_back((u8)v);
+	out.push_back((u8)(v >> 8));
+}
+
+static void put32(core::array<u8> &out, u32 v)
+{
+	put16(out, v & 0xffff);
+	put16(out, v >> 16);
+}
+
+static void putBytes(core::array<u8> &out, const void *data, u32 size)
+{
+	const u8 *bytes = (const u8 *)data;
+	for (u32 i = 0; i < size; ++i)
+		out.push_back(bytes[i]);
+}
+
+// Writes a zip archive with deflated text files, built in memory so the
+// benchmark doesn't depend on media files or the disk cache.
+static void createZip(core::array<u8> &zip, u32 files, u32 fileSize)
+{
+	struct Entry {
+		core::stringc name;
+		u32 offset, crc, size, compressedSize;
+	};
+	core::array<Entry> entries;
+
+	core::array<u8> text;
+	u32 seed = 42;
+	static const char *words[] = {"vertex ", "index ", "buffer ", "texture ", "material ", "\n"};
+	while (text.size() < fileSize) {
+		seed = seed * 1103515245 + 12345;
+		const char *word = words[(seed >> 16) % 6];
+		putBytes(text, word, (u32)strlen(word));
+	}
+	text.set_used(fileSize);
+
+	core::array<u8> packed;
+	for (u32 f = 0; f < files; ++f) {
+		// raw deflate, as zip stores it
+		z_stream stream;
+		memset(&stream, 0, sizeof(stream));
+		deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+		packed.set_used(deflateBound(&stream, fileSize));
+		stream.next_in = text.pointer();
+		stream.avail_in = fileSize;
+		stream.next_out = packed.pointer();
+		stream.avail_out = packed.size();
+		deflate(&stream, Z_FINISH);
+		deflateEnd(&stream);
+
+		Entry e;
+		e.name = core::stringc("file") + core::stringc(f) + ".txt";
+		e.offset = zip.size();
+		e.crc = crc32(0, text.const_pointer(), fileSize);
+		e.size = fileSize;
+		e.compressedSize = (u32)stream.total_out;
+		entries.push_back(e);
+
+		put32(zip, 0x04034b50);
+		put16(zip, 20);
+		put16(zip, 0);
+		put16(zip, 8);
+		put32(zip, 0);
+		put32(zip, e.crc);
+		put32(zip, e.compressedSize);
+		put32(zip, e.size);
+		put16(zip, e.name.size());
+		put16(zip, 0);
+		putBytes(zip, e.name.c_str(), e.name.size());
+		putBytes(zip, packed.const_pointer(), e.compressedSize);
+	}
+
+	const u32 directory = zip.size();
+	for (u32 f = 0; f < entries.size(); ++f) {
+		const Entry &e = entries[f];
+		put32(zip, 0x02014b50);
+		put16(zip, 20);
+		put16(zip, 20);
+		put16(zip, 0);
+		put16(zip, 8);
+		put32(zip, 0);
+		put32(zip, e.crc);
+		put32(zip, e.compressedSize);
+		put32(zip, e.size);
+		put16(zip, e.name.size());
+		put16(zip, 0);
+		put16(zip, 0);
+		put16(zip, 0);
+		put16(zip, 0);
+		put32(zip, 0);
+		put32(zip, e.offset);
+		putBytes(zip, e.name.c_str(), e.name.size());
+	}
+
+	const u32 directorySize = zip.size() - directory;
+	put32(zip, 0x06054b50);
+	put16(zip, 0);
+	put16(zip, 0);
+	put16(zip, entries.size());
+	put16(zip, entries.size());
+	put32(zip, directorySize);
+	put32(zip, directory);
+	put16(zip, 0);
+}
+
+void bench_io(IrrlichtDevice *device)
+{
+	io::IFileSystem *fs = device->getFileSystem();
+
+	core::array<u8> zip;
+	createZip(zip, 64, 64 * 1024);
+
+	benchmark("zip_open_64_files", 200, [&] {
+		io::IReadFile *file = fs->createMemoryReadFile(zip.const_pointer(), zip.size(), "bench.zip");
+		io::IFileArchive *archive = 0;
+		fs->addFileArchive(file, true, true, io::EFAT_ZIP, "", &archive);
+		file->drop();
+		fs->removeFileArchive(archive);
+	});
+
+	io::IReadFile *file = fs->createMemoryReadFile(zip.const_pointer(), zip.size(), "bench.zip");
+	io::IFileArchive *archive = 0;
+	fs->addFileArchive(file, true, true, io::EFAT_ZIP, "", &archive);
+	file->drop();
+	if (!archive)
+		return;
+
+	core::array<u8> buffer;
+	buffer.set_used(64 * 1024);
+	u32 index = 0;
+	benchmark("zip_inflate_64KiB", 200, [&] {
+		io::IReadFile *entry = archive->createAndOpenFile(index);
+		index = (index + 1) % 64;
+		if (entry) {
+			entry->read(buffer.pointer(), buffer.size());
+			entry->drop();
+		}
+		doNotOptimize(buffer.const_pointer());
+	});
+
+	fs->removeFileArchive(archive);
+}
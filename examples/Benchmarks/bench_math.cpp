@@ -0,0 +1,52 @@
+#include <irrlicht.h>
+#include "bench_helper.h"
+
+using namespace irr;
+using core::matrix4;
+using core::vector3df;
+
+void bench_math()
+{
+	matrix4 a, b, c;
+	a.setRotationDegrees(vector3df(10.f, 20.f, 30.f));
+	a.setTranslation(vector3df(1.f, 2.f, 3.f));
+	b.buildProjectionMatrixPerspectiveFovLH(1.f, 4.f / 3.f, 1.f, 1000.f);
+
+	benchmark("matrix4_multiply", 100000, [&] {
+		c.setbyproduct_nocheck(b, a);
+		a[12] += c[0] * 1e-9f;
+		doNotOptimize(&c);
+	});
+
+	benchmark("matrix4_getInverse", 100000, [&] {
+		a.getInverse(c);
+		doNotOptimize(&c);
+	});
+
+	const u32 count = 1024;
+	core::array<vector3df> in(count), out(count);
+	for (u32 i = 0; i < count; ++i) {
+		in.push_back(vector3df((f32)i, (f32)(i % 7), (f32)(i % 13)));
+		out.push_back(vector3df());
+	}
+	benchmark("matrix4_transformVectArray_1024", 1000, [&] {
+		a.transformVectArray(out.pointer(), in.const_pointer(), count);
+		doNotOptimize(out.const_pointer());
+	});
+
+	core::aabbox3df box(-1.f, -2.f, -3.f, 4.f, 5.f, 6.f);
+	benchmark("matrix4_transformBoxEx", 100000, [&] {
+		core::aabbox3df t(box);
+		a.transformBoxEx(t);
+		doNotOptimize(&t);
+	});
+
+	core::quaternion q1(vector3df(0.1f, 0.2f, 0.3f)), q2(vector3df(1.f, 0.5f, -0.3f)), q;
+	f32 t = 0.f;
+	benchmark("quaternion_slerp_getMatrix", 100000, [&] {
+		t = t < 1.f ? t + 0.001f : 0.f;
+		q.slerp(q1, q2, t);
+		q.getMatrix_transposed(c);
+		doNotOptimize(&c);
+	});
+}
@@ -0,0 +1,234 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+#include "exampleHelper.h"
+#include "bench_helper.h"
+
+using namespace irr;
+using namespace scene;
+
+static IMeshLoader *findLoader(ISceneManager *smgr, const io::path &name)
+{
+	for (u32 i = 0; i < smgr->getMeshLoaderCount(); ++i) {
+		IMeshLoader *loader = smgr->getMeshLoader(i);
+		if (loader->isALoadableFileExtension(name))
+			return loader;
+	}
+	return nullptr;
+}
+
+// Loads the file with the loader directly, so the mesh cache isn't involved
+static void bench_loader(IrrlichtDevice *device, const char *name, const io::path &fileName,
+	const void *data, u32 size, u32 iterations)
+{
+	IMeshLoader *loader = findLoader(device->getSceneManager(), fileName);
+	if (!loader)
+		return;
+
+	io::IFileSystem *fs = device->getFileSystem();
+	auto load = [&] {
+		io::IReadFile *file = fs->createMemoryReadFile(data, size, fileName);
+		IAnimatedMesh *mesh = loader->createMesh(file);
+		file->drop();
+		return mesh;
+	};
+
+	// a file the loader rejects would only measure the error path
+	IAnimatedMesh *mesh = load();
+	if (!mesh) {
+		fprintf(stderr, "%s: loading failed\n", name);
+		return;
+	}
+	mesh->drop();
+
+	benchmark(name, iterations, [&] {
+		IAnimatedMesh *mesh = load();
+		if (mesh)
+			mesh->drop();
+	});
+}
+
+// A grid of quads with positions, normals and texture coordinates
+static void createObj(core::stringc &obj, u32 cells)
+{
+	char line[128];
+	for (u32 y = 0; y <= cells; ++y)
+		for (u32 x = 0; x <= cells; ++x) {
+			snprintf(line, sizeof(line), "v %.3f %.3f 0\nvt %.4f %.4f\nvn 0 0 -1\n",
+				(f32)x, (f32)y, (f32)x / cells, (f32)y / cells);
+			obj += line;
+		}
+	for (u32 y = 0; y < cells; ++y)
+		for (u32 x = 0; x < cells; ++x) {
+			const u32 a = y * (cells + 1) + x + 1, b = a + 1, c = a + cells + 1, d = c + 1;
+			snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n",
+				a, a, a, c, c, c, d, d, d, b, b, b);
+			obj += line;
+		}
+}
+
+static void putInt(core::array<u8> &out, s32 v)
+{
+	for (u32 i = 0; i < 4; ++i)
+		out.push_back((u8)((u32)v >> (i * 8)));
+}
+
+static void putFloat(core::array<u8> &out, f32 v)
+{
+	s32 bits;
+	memcpy(&bits, &v, 4);
+	putInt(out, bits);
+}
+
+static u32 beginChunk(core::array<u8> &out, const char *name)
+{
+	for (u32 i = 0; i < 4; ++i)
+		out.push_back(name[i]);
+	putInt(out, 0);
+	return out.size();
+}
+
+static void endChunk(core::array<u8> &out, u32 start)
+{
+	const u32 size = out.size() - start;
+	for (u32 i = 0; i < 4; ++i)
+		out[start - 4 + i] = (u8)(size >> (i * 8));
+}
+
+// The same grid as B3D, one node with one mesh
+static void createB3D(core::array<u8> &b3d, u32 cells)
+{
+	const u32 file = beginChunk(b3d, "BB3D");
+	putInt(b3d, 1);
+
+	const u32 node = beginChunk(b3d, "NODE");
+	b3d.push_back('g');
+	b3d.push_back(0);
+	const f32 transform[] = {0, 0, 0, 1, 1, 1, 1, 0, 0, 0};
+	for (f32 v : transform)
+		putFloat(b3d, v);
+
+	const u32 mesh = beginChunk(b3d, "MESH");
+	putInt(b3d, -1);
+
+	const u32 vertices = beginChunk(b3d, "VRTS");
+	putInt(b3d, 1);
+	putInt(b3d, 1);
+	putInt(b3d, 2);
+	for (u32 y = 0; y <= cells; ++y)
+		for (u32 x = 0; x <= cells; ++x) {
+			const f32 v[] = {(f32)x, (f32)y, 0.f, 0.f, 0.f, -1.f, (f32)x / cells, (f32)y / cells};
+			for (f32 f : v)
+				putFloat(b3d, f);
+		}
+	endChunk(b3d, vertices);
+
+	const u32 triangles = beginChunk(b3d, "TRIS");
+	putInt(b3d, -1);
+	for (u32 y = 0; y < cells; ++y)
+		for (u32 x = 0; x < cells; ++x) {
+			const s32 a = y * (cells + 1) + x, b = a + 1, c = a + cells + 1, d = c + 1;
+			const s32 t[] = {a, c, d, a, d, b};
+			for (s32 i : t)
+				putInt(b3d, i);
+		}
+	endChunk(b3d, triangles);
+
+	endChunk(b3d, mesh);
+	endChunk(b3d, node);
+	endChunk(b3d, file);
+}
+
+SMesh *createCube()
+{
+	SMeshBuffer *mb = new SMeshBuffer();
+	const video::SColor white(255, 255, 255, 255);
+	for (u32 i = 0; i < 8; ++i)
+		mb->Vertices.push_back(video::S3DVertex((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f,
+			(i & 4) ? 1.f : -1.f, 0, 1, 0, white, 0, 0));
+	const u16 indices[] = {0,2,3, 0,3,1, 4,5,7, 4,7,6, 0,1,5, 0,5,4, 2,6,7, 2,7,3, 0,4,6, 0,6,2, 1,3,7, 1,7,5};
+	for (u16 i : indices)
+		mb->Indices.push_back(i);
+	mb->recalculateBoundingBox();
+
+	SMesh *mesh = new SMesh();
+	mesh->addMeshBuffer(mb);
+	mesh->recalculateBoundingBox();
+	mb->drop();
+	return mesh;
+}
+
+static void bench_drawAll(IrrlichtDevice *device, const char *name, u32 nodes)
+{
+	if (!benchmarkEnabled(name))
+		return;
+
+	ISceneManager *smgr = device->getSceneManager()->createNewSceneManager();
+	video::IVideoDriver *driver = device->getVideoDriver();
+
+	SMesh *cube = createCube();
+	const u32 side = (u32)ceilf(sqrtf((f32)nodes));
+	for (u32 i = 0; i < nodes; ++i) {
+		IMeshSceneNode *node = smgr->addMeshSceneNode(cube, 0, -1,
+			core::vector3df((f32)(i % side) * 4.f - side * 2.f, 0.f, (f32)(i / side) * 4.f));
+		node->setMaterialFlag(video::EMF_LIGHTING, false);
+	}
+	cube->drop();
+	smgr->addCameraSceneNode(0, core::vector3df(0.f, 20.f, -20.f), core::vector3df(0.f, 0.f, side * 2.f));
+
+	benchmark(name, 20, [&] {
+		driver->beginScene();
+		smgr->drawAll();
+		driver->endScene();
+	});
+	smgr->drop();
+}
+
+void bench_scene(IrrlichtDevice *device)
+{
+	ISceneManager *smgr = device->getSceneManager();
+	io::IFileSystem *fs = device->getFileSystem();
+
+	core::stringc obj;
+	createObj(obj, 64);
+	bench_loader(device, "load_obj_64x64_grid", "grid.obj", obj.c_str(), obj.size(), 10);
+
+	core::array<u8> b3d;
+	createB3D(b3d, 64);
+	bench_loader(device, "load_b3d_64x64_grid", "grid.b3d", b3d.const_pointer(), b3d.size(), 20);
+
+	bench_drawAll(device, "sceneManager_drawAll_100_nodes", 100);
+	bench_drawAll(device, "sceneManager_drawAll_1000_nodes", 1000);
+	bench_drawAll(device, "sceneManager_drawAll_10000_nodes", 10000);
+
+	// the sample rig, skipped without the media directory
+	const io::path rigName = getExampleMediaPath() + "coolguy_opt.x";
+	io::IReadFile *rigFile = fs->createAndOpenFile(rigName);
+	if (!rigFile)
+		return;
+	core::array<u8> rig;
+	rig.set_used((u32)rigFile->getSize());
+	rigFile->read(rig.pointer(), rig.size());
+	rigFile->drop();
+	bench_loader(device, "load_x_coolguy", "coolguy_opt.x", rig.const_pointer(), rig.size(), 10);
+
+	io::IReadFile *file = fs->createMemoryReadFile(rig.const_pointer(), rig.size(), rigName);
+	IAnimatedMesh *mesh = smgr->getMesh(file);
+	file->drop();
+	if (mesh && mesh->getMeshType() == EAMT_SKINNED) {
+		ISkinnedMesh *skinned = (ISkinnedMesh *)mesh;
+		const f32 frames = (f32)skinned->getFrameCount();
+		f32 frame = 0.f;
+		benchmark("skinnedMesh_animateMesh_coolguy", 1000, [&] {
+			frame = frame + 0.37f < frames ? frame + 0.37f : 0.f;
+			skinned->animateMesh(frame, 1.f);
+		});
+		// skinning is skipped while the animation doesn't change
+		benchmark("skinnedMesh_animateMesh_skinMesh_coolguy", 1000, [&] {
+			frame = frame + 0.37f < frames ? frame + 0.37f : 0.f;
+			skinned->animateMesh(frame, 1.f);
+			skinned->skinMesh();
+		});
+	}
+}
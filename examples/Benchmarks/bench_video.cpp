@@ -0,0 +1,90 @@
+#include <irrlicht.h>
+#include "bench_helper.h"
+
+using namespace irr;
+using namespace video;
+
+static void bench_convert(IVideoDriver *driver, const char *name,
+	ECOLOR_FORMAT from, ECOLOR_FORMAT to, const core::array<u8> &source, core::array<u8> &target)
+{
+	const s32 pixels = 256 * 256;
+	benchmark(name, 100, [&] {
+		driver->convertColor(source.const_pointer(), from, pixels, target.pointer(), to);
+		doNotOptimize(target.const_pointer());
+	});
+}
+
+void bench_video(IrrlichtDevice *device)
+{
+	IVideoDriver *driver = device->getVideoDriver();
+
+	// a deterministic pattern, large enough for any format
+	core::array<u8> source, target;
+	source.set_used(256 * 256 * 4);
+	target.set_used(256 * 256 * 4);
+	u32 seed = 12345;
+	for (u32 i = 0; i < source.size(); ++i) {
+		seed = seed * 1103515245 + 12345;
+		source[i] = (u8)(seed >> 16);
+	}
+
+	bench_convert(driver, "convertColor_A8R8G8B8_to_R8G8B8_256x256", ECF_A8R8G8B8, ECF_R8G8B8, source, target);
+	bench_convert(driver, "convertColor_R8G8B8_to_A8R8G8B8_256x256", ECF_R8G8B8, ECF_A8R8G8B8, source, target);
+	bench_convert(driver, "convertColor_A8R8G8B8_to_A1R5G5B5_256x256", ECF_A8R8G8B8, ECF_A1R5G5B5, source, target);
+	bench_convert(driver, "convertColor_A1R5G5B5_to_A8R8G8B8_256x256", ECF_A1R5G5B5, ECF_A8R8G8B8, source, target);
+	bench_convert(driver, "convertColor_R5G6B5_to_A8R8G8B8_256x256", ECF_R5G6B5, ECF_A8R8G8B8, source, target);
+
+	// the plain loops of the vectorized conversions above, to compare with
+	benchmark("convertColor_A8R8G8B8_to_R8G8B8_256x256_scalar", 100, [&] {
+		const u8 *in = source.const_pointer();
+		u8 *out = target.pointer();
+		for (s32 x = 0; x < 256 * 256; ++x) {
+			out[x * 3 + 0] = in[x * 4 + 2];
+			out[x * 3 + 1] = in[x * 4 + 1];
+			out[x * 3 + 2] = in[x * 4 + 0];
+		}
+		doNotOptimize(target.const_pointer());
+	});
+	benchmark("convertColor_R8G8B8_to_A8R8G8B8_256x256_scalar", 100, [&] {
+		const u8 *in = source.const_pointer();
+		u32 *out = (u32 *)target.pointer();
+		for (s32 x = 0; x < 256 * 256; ++x)
+			out[x] = 0xff000000 | (in[x * 3] << 16) | (in[x * 3 + 1] << 8) | in[x * 3 + 2];
+		doNotOptimize(target.const_pointer());
+	});
+
+	IImage *image = driver->createImageFromData(ECF_A8R8G8B8, core::dimension2du(256, 256), source.pointer(), false);
+	IImage *smaller = driver->createImage(ECF_A8R8G8B8, core::dimension2du(100, 75));
+	IImage *larger = driver->createImage(ECF_A8R8G8B8, core::dimension2du(400, 300));
+	IImage *other = driver->createImage(ECF_R5G6B5, core::dimension2du(100, 75));
+
+	benchmark("copyToScaling_256x256_to_100x75", 200, [&] {
+		image->copyToScaling(smaller);
+		doNotOptimize(smaller->getData());
+	});
+	benchmark("copyToScaling_256x256_to_400x300", 50, [&] {
+		image->copyToScaling(larger);
+		doNotOptimize(larger->getData());
+	});
+	benchmark("copyToScaling_256x256_to_100x75_R5G6B5", 200, [&] {
+		image->copyToScaling(other);
+		doNotOptimize(other->getData());
+	});
+	benchmark("copyToScalingBoxFilter_256x256_to_100x75", 50, [&] {
+		image->copyToScalingBoxFilter(smaller);
+		doNotOptimize(smaller->getData());
+	});
+	benchmark("copyToScalingFiltered_bilinear_256x256_to_100x75", 20, [&] {
+		image->copyToScalingFiltered(smaller, EISF_BILINEAR);
+		doNotOptimize(smaller->getData());
+	});
+	benchmark("copyToScalingFiltered_lanczos3_256x256_to_100x75", 20, [&] {
+		image->copyToScalingFiltered(smaller, EISF_LANCZOS3);
+		doNotOptimize(smaller->getData());
+	});
+
+	other->drop();
+	larger->drop();
+	smaller->drop();
+	image->drop();
+}
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <irrlicht.h>
+#include "bench_helper.h"
+
+using namespace irr;
+
+static const char *filter = nullptr;
+static bool firstResult = true;
+
+bool benchmarkEnabled(const char *name)
+{
+	return !filter || strstr(name, filter);
+}
+
+void benchmarkResult(const char *name, u32 iterations, std::vector<double> &samples)
+{
+	std::sort(samples.begin(), samples.end());
+	printf("%s\n\t\t{\"name\": \"%s\", \"iterations\": %u, \"samples\": %u, "
+		"\"min_ns\": %.1f, \"median_ns\": %.1f, \"max_ns\": %.1f}",
+		firstResult ? "" : ",", name, iterations, (u32)samples.size(),
+		samples.front(), samples[samples.size() / 2], samples.back());
+	fflush(stdout);
+	firstResult = false;
+}
+
+void doNotOptimize(const void *p)
+{
+	// an opaque call, the optimizer has to assume p gets read
+	static const void *volatile sink;
+	sink = p;
+}
+
+/* Micro-benchmarks of the hot paths, on the null driver so they measure
+the engine and not the GPU. The results are written to stdout as JSON:
+	Benchmarks [name filter]
+The rendering benchmarks compare the drivers on the same scenes instead:
+	Benchmarks render <null|ogles1|ogles2|opengl|opengl3> [frames] [headless] [capture]
+With capture, the last frame of each scene is written to <scene>.irrcapture,
+which a driver then draws without the engine around it:
+	Benchmarks replay <capture file> <driver> [frames] [headless]
+*/
+int main(int argc, char *argv[])
+{
+	if (argc > 1 && strcmp(argv[1], "render") == 0)
+		return runRenderBenchmarks(argc - 2, argv + 2);
+	if (argc > 1 && strcmp(argv[1], "replay") == 0)
+		return runReplayBenchmark(argc - 2, argv + 2);
+
+	if (argc > 1)
+		filter = argv[1];
+
+	SIrrlichtCreationParameters p;
+	p.DriverType = video::EDT_NULL;
+	p.WindowSize = core::dimension2du(640, 480);
+	p.LoggingLevel = ELL_NONE;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device)
+		return 1;
+
+	printf("{\n\t\"version\": \"%s\",\n\t\"benchmarks\": [", device->getVersion());
+
+	bench_math();
+	bench_video(device);
+	bench_io(device);
+	bench_scene(device);
+	bench_gui(device);
+
+	printf("\n\t]\n}\n");
+	device->drop();
+	return 0;
+}
@@ -0,0 +1,381 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <irrlicht.h>
+#include "exampleHelper.h"
+#include "bench_helper.h"
+
+using namespace irr;
+
+static bool chooseDriver(const char *name, video::E_DRIVER_TYPE &type)
+{
+	static const struct {
+		const char *name;
+		video::E_DRIVER_TYPE type;
+	} drivers[] = {
+		{"null", video::EDT_NULL},
+		{"ogles1", video::EDT_OGLES1},
+		{"ogles2", video::EDT_OGLES2},
+		{"opengl", video::EDT_OPENGL},
+		{"opengl3", video::EDT_OPENGL3},
+	};
+	for (const auto &d : drivers) {
+		if (strcmp(name, d.name) == 0) {
+			type = d.type;
+			return true;
+		}
+	}
+	return false;
+}
+
+// A fixed seed for every scene, so all drivers get the same content
+class Random {
+public:
+	Random() : Seed(20240531) {}
+	u32 next()
+	{
+		Seed = Seed * 1103515245 + 12345;
+		return Seed >> 16;
+	}
+	f32 range(f32 low, f32 high) { return low + (high - low) * (next() & 0x7fff) / 32767.f; }
+private:
+	u32 Seed;
+};
+
+// Each scene adds its content, gets moved along its camera path and
+// removes what it added again
+class RenderScene {
+public:
+	virtual ~RenderScene() {}
+	virtual const char *getName() const = 0;
+	virtual bool setUp(IrrlichtDevice *device, scene::ISceneManager *smgr) = 0;
+	virtual void frame(f32 t) {}
+	virtual void draw2D() {}
+	virtual void tearDown() {}
+};
+
+static void printPercentiles(const char *name, const video::SFrameTimePercentiles &p)
+{
+	if (p.Samples == 0)
+		printf("\"%s\": null", name);
+	else
+		printf("\"%s\": {\"median\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f}",
+			name, p.Median, p.Percentile95, p.Percentile99, p.Max);
+}
+
+static void addFrameStats(video::SFrameStats &total, const video::SFrameStats &stats)
+{
+	total.DrawCalls += stats.DrawCalls;
+	total.PrimitivesDrawn += stats.PrimitivesDrawn;
+	total.TextureBinds += stats.TextureBinds;
+	total.ProgramSwitches += stats.ProgramSwitches;
+	total.MaterialChanges += stats.MaterialChanges;
+}
+
+static void printResult(const char *name, const video::SFrameTimeStats &times, const video::SFrameStats &total,
+	u32 frames, bool first)
+{
+	printf("%s\n\t\t{\"name\": \"%s\", \"frames\": %u, ", first ? "" : ",", name, times.Frames);
+	printPercentiles("cpu_ms", times.CPUTime);
+	printf(", ");
+	printPercentiles("frame_ms", times.FrameTime);
+	printf(", ");
+	printPercentiles("gpu_ms", times.GPUTime);
+	const f32 n = (f32)core::max_(frames, 1u);
+	printf(", \"draw_calls\": %.1f, \"primitives\": %.1f, \"texture_binds\": %.1f, "
+		"\"program_switches\": %.1f, \"material_changes\": %.1f}",
+		total.DrawCalls / n, total.PrimitivesDrawn / n, total.TextureBinds / n,
+		total.ProgramSwitches / n, total.MaterialChanges / n);
+	fflush(stdout);
+}
+
+// With capture set, the last frame of the scene is written to <scene>.irrcapture
+static bool runScene(IrrlichtDevice *device, RenderScene &renderScene, u32 frames, bool capture, bool first)
+{
+	video::IVideoDriver *driver = device->getVideoDriver();
+	scene::ISceneManager *smgr = device->getSceneManager()->createNewSceneManager();
+	if (!renderScene.setUp(device, smgr)) {
+		smgr->drop();
+		return false;
+	}
+
+	// the camera circles the scene, driven by the frame number only
+	scene::ICameraSceneNode *camera = smgr->addCameraSceneNode();
+	camera->setFarValue(1000.f);
+
+	ITimer *timer = device->getTimer();
+	timer->stop();
+
+	const u32 warmUp = 10;
+	driver->setFrameTimeHistory(frames);
+	video::SFrameStats total;
+	for (u32 f = 0; f < warmUp + frames && device->run(); ++f) {
+		const f32 t = (f32)f / (warmUp + frames);
+		timer->setTime(f * 16);
+		camera->setPosition(core::vector3df(sinf(t * core::PI * 2.f) * 120.f, 40.f, cosf(t * core::PI * 2.f) * 120.f));
+		camera->setTarget(core::vector3df(0.f, 0.f, 0.f));
+		renderScene.frame(t);
+
+		if (capture && f == warmUp + frames - 1) {
+			const io::path name = io::path(renderScene.getName()) + ".irrcapture";
+			io::IWriteFile *file = device->getFileSystem()->createAndWriteFile(name);
+			if (file) {
+				driver->captureFrame(file);
+				file->drop();
+			}
+		}
+
+		driver->beginScene(video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(255, 40, 40, 60));
+		smgr->drawAll();
+		renderScene.draw2D();
+		driver->endScene();
+
+		if (f >= warmUp)
+			addFrameStats(total, driver->getFrameStats());
+	}
+	const video::SFrameTimeStats times = driver->getFrameTimeStats();
+	driver->setFrameTimeHistory(0);
+	timer->start();
+
+	printResult(renderScene.getName(), times, total, frames, first);
+
+	renderScene.tearDown();
+	smgr->drop();
+	return true;
+}
+
+// Many static nodes sharing one mesh and material
+class StaticMeshScene : public RenderScene {
+public:
+	const char *getName() const override { return "static_meshes"; }
+	bool setUp(IrrlichtDevice *device, scene::ISceneManager *smgr) override
+	{
+		Random random;
+		scene::SMesh *cube = createCube();
+		for (u32 i = 0; i < 5000; ++i) {
+			scene::IMeshSceneNode *node = smgr->addMeshSceneNode(cube, 0, -1,
+				core::vector3df(random.range(-100.f, 100.f), random.range(-20.f, 20.f), random.range(-100.f, 100.f)),
+				core::vector3df(random.range(0.f, 360.f), random.range(0.f, 360.f), 0.f));
+			node->setMaterialFlag(video::EMF_LIGHTING, false);
+		}
+		cube->drop();
+		return true;
+	}
+};
+
+// Animated and skinned copies of the sample rig
+class SkinnedCrowdScene : public RenderScene {
+public:
+	const char *getName() const override { return "skinned_crowd"; }
+	bool setUp(IrrlichtDevice *device, scene::ISceneManager *smgr) override
+	{
+		const io::path mediaPath = getExampleMediaPath();
+		io::IReadFile *file = device->getFileSystem()->createAndOpenFile(mediaPath + "coolguy_opt.x");
+		if (!file)
+			return false;
+		scene::IAnimatedMesh *mesh = smgr->getMesh(file);
+		file->drop();
+		if (!mesh)
+			return false;
+		video::ITexture *texture = device->getVideoDriver()->getTexture(mediaPath + "cooltexture.png");
+
+		Random random;
+		for (u32 i = 0; i < 200; ++i) {
+			scene::IAnimatedMeshSceneNode *node = smgr->addAnimatedMeshSceneNode(mesh, 0, -1,
+				core::vector3df((f32)(i % 20) * 8.f - 80.f, 0.f, (f32)(i / 20) * 8.f - 40.f),
+				core::vector3df(0.f, random.range(0.f, 360.f), 0.f), core::vector3df(2.f, 2.f, 2.f));
+			node->setMaterialFlag(video::EMF_LIGHTING, false);
+			node->setMaterialTexture(0, texture);
+			node->setFrameLoop(0, 29);
+			node->setAnimationSpeed(random.range(20.f, 40.f));
+			node->setCurrentFrame(random.range(0.f, 29.f));
+		}
+		return true;
+	}
+};
+
+// Nodes whose materials alternate between many textures
+class TextureSwitchScene : public RenderScene {
+public:
+	const char *getName() const override { return "texture_switching"; }
+	bool setUp(IrrlichtDevice *device, scene::ISceneManager *smgr) override
+	{
+		Driver = device->getVideoDriver();
+		Random random;
+		for (u32 i = 0; i < 64; ++i) {
+			video::IImage *image = Driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(64, 64));
+			image->fill(video::SColor(255, random.next() & 255, random.next() & 255, random.next() & 255));
+			for (u32 y = 0; y < 64; y += 8)
+				for (u32 x = 0; x < 64; ++x)
+					image->setPixel(x, y, video::SColor(255, 255, 255, 255));
+			core::stringc name = core::stringc("bench_texture_") + core::stringc(i);
+			Textures.push_back(Driver->addTexture(name.c_str(), image));
+			image->drop();
+		}
+
+		scene::SMesh *cube = createCube();
+		for (u32 i = 0; i < 2000; ++i) {
+			scene::IMeshSceneNode *node = smgr->addMeshSceneNode(cube, 0, -1,
+				core::vector3df(random.range(-100.f, 100.f), random.range(-20.f, 20.f), random.range(-100.f, 100.f)));
+			node->setMaterialFlag(video::EMF_LIGHTING, false);
+			node->setMaterialTexture(0, Textures[random.next() % Textures.size()]);
+			if (i % 3 == 0)
+				node->setMaterialTexture(1, Textures[random.next() % Textures.size()]);
+		}
+		cube->drop();
+		return true;
+	}
+	void tearDown() override
+	{
+		for (u32 i = 0; i < Textures.size(); ++i)
+			Driver->removeTexture(Textures[i]);
+		Textures.clear();
+	}
+private:
+	video::IVideoDriver *Driver = nullptr;
+	core::array<video::ITexture *> Textures;
+};
+
+// Many GUI elements plus 2D primitives over an empty 3D scene
+class GUIStressScene : public RenderScene {
+public:
+	const char *getName() const override { return "gui_2d"; }
+	bool setUp(IrrlichtDevice *device, scene::ISceneManager *smgr) override
+	{
+		Driver = device->getVideoDriver();
+		GUI = device->getGUIEnvironment();
+		Root = GUI->addStaticText(L"", core::recti(0, 0, 4096, 4096));
+		Random random;
+		for (u32 i = 0; i < 300; ++i) {
+			const s32 x = (s32)(random.next() % 700), y = (s32)(random.next() % 560);
+			if (i % 3 == 0)
+				GUI->addButton(core::recti(x, y, x + 90, y + 24), Root, -1, L"Button");
+			else if (i % 3 == 1)
+				GUI->addCheckBox(i % 2 == 0, core::recti(x, y, x + 120, y + 20), Root, -1, L"Check box");
+			else
+				GUI->addStaticText(L"Some static text with a border", core::recti(x, y, x + 200, y + 20), true, true, Root);
+		}
+		return true;
+	}
+	void draw2D() override
+	{
+		Random random;
+		for (u32 i = 0; i < 500; ++i) {
+			const s32 x = (s32)(random.next() % 760), y = (s32)(random.next() % 560);
+			Driver->draw2DRectangle(video::SColor(128, random.next() & 255, random.next() & 255, 255),
+				core::recti(x, y, x + 40, y + 40));
+		}
+		GUI->drawAll();
+	}
+	void tearDown() override
+	{
+		Root->remove();
+	}
+private:
+	video::IVideoDriver *Driver = nullptr;
+	gui::IGUIEnvironment *GUI = nullptr;
+	gui::IGUIElement *Root = nullptr;
+};
+
+static bool hasOption(int argc, char *argv[], const char *option)
+{
+	for (int i = 2; i < argc; ++i)
+		if (strcmp(argv[i], option) == 0)
+			return true;
+	return false;
+}
+
+int runRenderBenchmarks(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	if (argc < 1 || !chooseDriver(argv[0], p.DriverType)) {
+		fprintf(stderr, "Usage: Benchmarks render <null|ogles1|ogles2|opengl|opengl3> [frames] [headless] [capture]\n");
+		return 1;
+	}
+	const u32 frames = argc > 1 ? (u32)core::max_(atoi(argv[1]), 1) : 300;
+	if (hasOption(argc, argv, "headless"))
+		p.DeviceType = EIDT_HEADLESS;
+	p.FrameCapture = hasOption(argc, argv, "capture");
+	p.WindowSize = core::dimension2du(800, 600);
+	p.Vsync = false;
+	p.LoggingLevel = ELL_NONE;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device)
+		return 1;
+	video::IVideoDriver *driver = device->getVideoDriver();
+
+	printf("{\n\t\"version\": \"%s\",\n\t\"driver\": \"%s\",\n\t\"renderer\": \"%s\",\n\t\"gpu_timers\": %s,\n\t\"scenes\": [",
+		device->getVersion(), argv[0], core::stringc(driver->getName()).c_str(),
+		driver->queryFeature(video::EVDF_TIMER_QUERY) ? "true" : "false");
+
+	StaticMeshScene staticMeshes;
+	SkinnedCrowdScene skinnedCrowd;
+	TextureSwitchScene textureSwitching;
+	GUIStressScene gui;
+	RenderScene *scenes[] = {&staticMeshes, &skinnedCrowd, &textureSwitching, &gui};
+	bool first = true;
+	for (RenderScene *scene : scenes)
+		if (runScene(device, *scene, frames, p.FrameCapture, first))
+			first = false;
+
+	printf("\n\t]\n}\n");
+	device->drop();
+	return 0;
+}
+
+int runReplayBenchmark(int argc, char *argv[])
+{
+	SIrrlichtCreationParameters p;
+	if (argc < 2 || !chooseDriver(argv[1], p.DriverType)) {
+		fprintf(stderr, "Usage: Benchmarks replay <capture file> <null|ogles1|ogles2|opengl|opengl3> [frames] [headless]\n");
+		return 1;
+	}
+	const u32 frames = argc > 2 ? (u32)core::max_(atoi(argv[2]), 1) : 300;
+	if (hasOption(argc, argv, "headless"))
+		p.DeviceType = EIDT_HEADLESS;
+	p.WindowSize = core::dimension2du(800, 600);
+	p.Vsync = false;
+	p.LoggingLevel = ELL_NONE;
+
+	IrrlichtDevice *device = createDeviceEx(p);
+	if (!device)
+		return 1;
+	video::IVideoDriver *driver = device->getVideoDriver();
+
+	io::IReadFile *file = device->getFileSystem()->createAndOpenFile(argv[0]);
+	video::IFrameReplay *replay = file ? driver->createFrameReplay(file) : nullptr;
+	if (file)
+		file->drop();
+	if (!replay) {
+		fprintf(stderr, "Can't replay %s\n", argv[0]);
+		device->drop();
+		return 1;
+	}
+
+	printf("{\n\t\"version\": \"%s\",\n\t\"driver\": \"%s\",\n\t\"renderer\": \"%s\",\n\t\"gpu_timers\": %s,\n"
+		"\t\"commands\": %u,\n\t\"textures\": %u,\n\t\"mesh_buffers\": %u,\n\t\"payloads\": %s,\n\t\"scenes\": [",
+		device->getVersion(), argv[1], core::stringc(driver->getName()).c_str(),
+		driver->queryFeature(video::EVDF_TIMER_QUERY) ? "true" : "false",
+		replay->getCommandCount(), replay->getTextureCount(), replay->getMeshBufferCount(),
+		replay->hasPayloads() ? "true" : "false");
+
+	// the same frame again and again, so there is nothing but the driver to measure
+	const u32 warmUp = 10;
+	driver->setFrameTimeHistory(frames);
+	video::SFrameStats total;
+	for (u32 f = 0; f < warmUp + frames && device->run(); ++f) {
+		if (!replay->replay())
+			break;
+		if (f >= warmUp)
+			addFrameStats(total, driver->getFrameStats());
+	}
+	printResult(argv[0], driver->getFrameTimeStats(), total, frames, true);
+	driver->setFrameTimeHistory(0);
+
+	printf("\n\t]\n}\n");
+	replay->drop();
+	device->drop();
+	return 0;
+}
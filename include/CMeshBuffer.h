@@ -7,6 +7,7 @@
 
 #include "irrArray.h"
 #include "IMeshBuffer.h"
+#include "SDirtyRanges.h"
 
 namespace irr
 {
@@ -22,13 +23,22 @@ namespace scene
 			: ChangedID_Vertex(1), ChangedID_Index(1)
 			, MappingHint_Vertex(EHM_NEVER), MappingHint_Index(EHM_NEVER)
 			, HWBuffer(NULL)
-			, PrimitiveType(EPT_TRIANGLES)
+			, PrimitiveType(EPT_TRIANGLES), CompactVertices(false), SeparateVertexStreams(false)
+			, GPUOnly(false), ClientDataReleased(false)
+			, ReleasedVertexCount(0), ReleasedIndexCount(0)
 		{
 			#ifdef _DEBUG
 			setDebugName("CMeshBuffer");
 			#endif
 		}
 
+		//! Destructor, lets the driver release the hardware buffer
+		~CMeshBuffer()
+		{
+			if (HWBuffer)
+				HWBuffer->onMeshBufferDestroyed(this);
+		}
+
 
 		//! Get material of this meshbuffer
 		/** \return Material of this buffer */
@@ -66,7 +76,7 @@ namespace scene
 		/** \return Number of vertices. */
 		u32 getVertexCount() const override
 		{
-			return Vertices.size();
+			return ClientDataReleased ? ReleasedVertexCount : Vertices.size();
 		}
 
 		//! Get type of index data which is stored in this meshbuffer.
@@ -96,7 +106,7 @@ namespace scene
 		/** \return Number of indices. */
 		u32 getIndexCount() const override
 		{
-			return Indices.size();
+			return ClientDataReleased ? ReleasedIndexCount : Indices.size();
 		}
 
 
@@ -237,6 +247,16 @@ namespace scene
 		}
 
 
+		//! Removes the vertices from the given index on
+		bool truncateVertices(u32 count) override
+		{
+			if (count > Vertices.size())
+				return false;
+			Vertices.set_used(count);
+			return true;
+		}
+
+
 		//! get the current hardware mapping hint
 		E_HARDWARE_MAPPING getHardwareMappingHint_Vertex() const override
 		{
@@ -258,6 +278,77 @@ namespace scene
 				MappingHint_Index=NewMappingHint;
 		}
 
+		//! Set if the driver may keep the vertices quantized in its hardware buffer
+		void setCompactVertices(bool compact) override
+		{
+			if (CompactVertices == compact)
+				return;
+			CompactVertices = compact;
+			setDirty(EBT_VERTEX);
+		}
+
+		//! Get if the driver may keep the vertices quantized in its hardware buffer
+		bool getCompactVertices() const override
+		{
+			return CompactVertices;
+		}
+
+		//! Set if the driver keeps each vertex attribute in a stream of its own
+		void setSeparateVertexStreams(bool separate) override
+		{
+			if (SeparateVertexStreams == separate)
+				return;
+			SeparateVertexStreams = separate;
+			setDirty(EBT_VERTEX);
+		}
+
+		//! Get if the driver keeps each vertex attribute in a stream of its own
+		bool getSeparateVertexStreams() const override
+		{
+			return SeparateVertexStreams;
+		}
+
+		//! Set if the vertices and indices are freed once they are in a static hardware buffer
+		void setGPUOnly(bool gpuOnly) override
+		{
+			GPUOnly = gpuOnly;
+		}
+
+		//! Get if the vertices and indices are freed once they are in a static hardware buffer
+		bool getGPUOnly() const override
+		{
+			return GPUOnly;
+		}
+
+		//! Frees the vertices and indices of a GPU only buffer, used by the VideoDriver
+		bool releaseClientData() override
+		{
+			if (!GPUOnly || ClientDataReleased)
+				return false;
+			ReleasedVertexCount = Vertices.size();
+			ReleasedIndexCount = Indices.size();
+			Vertices.clear();
+			Indices.clear();
+			ClientDataReleased = true;
+			return true;
+		}
+
+		//! Get if the vertices and indices were freed by releaseClientData()
+		bool isClientDataReleased() const override
+		{
+			return ClientDataReleased;
+		}
+
+		//! Gives back the vertices and indices freed by releaseClientData(), used by the VideoDriver
+		void restoreClientData(const void* vertices, const void* indices) override
+		{
+			if (!ClientDataReleased)
+				return;
+			Vertices.set_data(static_cast<const T*>(vertices), ReleasedVertexCount);
+			Indices.set_data(static_cast<const u16*>(indices), ReleasedIndexCount);
+			ClientDataReleased = false;
+		}
+
 		//! Describe what kind of primitive geometry is used by the meshbuffer
 		void setPrimitiveType(E_PRIMITIVE_TYPE type) override
 		{
@@ -274,9 +365,34 @@ namespace scene
 		void setDirty(E_BUFFER_TYPE Buffer=EBT_VERTEX_AND_INDEX) override
 		{
 			if (Buffer==EBT_VERTEX_AND_INDEX ||Buffer==EBT_VERTEX)
+			{
 				++ChangedID_Vertex;
+				DirtyRanges_Vertex.clear();
+			}
 			if (Buffer==EBT_VERTEX_AND_INDEX || Buffer==EBT_INDEX)
+			{
 				++ChangedID_Index;
+				DirtyRanges_Index.clear();
+			}
+		}
+
+		//! flags a range of the mesh as changed, only this range is uploaded again
+		void setDirtyRange(u32 first, u32 count, E_BUFFER_TYPE Buffer=EBT_VERTEX) override
+		{
+			if (Buffer==EBT_VERTEX_AND_INDEX ||Buffer==EBT_VERTEX)
+				DirtyRanges_Vertex.add(++ChangedID_Vertex, first, count);
+			if (Buffer==EBT_VERTEX_AND_INDEX || Buffer==EBT_INDEX)
+				DirtyRanges_Index.add(++ChangedID_Index, first, count);
+		}
+
+		//! Get the range changed since an earlier change ID
+		bool getDirtyRange(u32 changedID, u32& first, u32& count, E_BUFFER_TYPE Buffer) const override
+		{
+			if (Buffer==EBT_VERTEX)
+				return DirtyRanges_Vertex.get(changedID, ChangedID_Vertex, first, count);
+			if (Buffer==EBT_INDEX)
+				return DirtyRanges_Index.get(changedID, ChangedID_Index, first, count);
+			return false;
 		}
 
 		//! Get the currently used ID for identification of changes.
@@ -287,11 +403,11 @@ namespace scene
 		/** This shouldn't be used for anything outside the VideoDriver. */
 		u32 getChangedID_Index() const override {return ChangedID_Index;}
 
-		void setHWBuffer(void *ptr) const override {
+		void setHWBuffer(IHardwareBufferLink *ptr) const override {
 			HWBuffer = ptr;
 		}
 
-		void *getHWBuffer() const override {
+		IHardwareBufferLink *getHWBuffer() const override {
 			return HWBuffer;
 		}
 
@@ -299,10 +415,14 @@ namespace scene
 		u32 ChangedID_Vertex;
 		u32 ChangedID_Index;
 
+		//! Ranges given to setDirtyRange since the last setDirty
+		SDirtyRanges DirtyRanges_Vertex;
+		SDirtyRanges DirtyRanges_Index;
+
 		//! hardware mapping hint
 		E_HARDWARE_MAPPING MappingHint_Vertex;
 		E_HARDWARE_MAPPING MappingHint_Index;
-		mutable void *HWBuffer;
+		mutable IHardwareBufferLink *HWBuffer;
 
 		//! Material for this meshbuffer.
 		video::SMaterial Material;
@@ -314,6 +434,16 @@ namespace scene
 		core::aabbox3d<f32> BoundingBox;
 		//! Primitive type used for rendering (triangles, lines, ...)
 		E_PRIMITIVE_TYPE PrimitiveType;
+		//! The driver may quantize the vertices in its hardware buffer
+		bool CompactVertices;
+		//! The driver keeps each vertex attribute in a stream of its own
+		bool SeparateVertexStreams;
+		//! Vertices and indices are freed once they are in a static hardware buffer
+		bool GPUOnly;
+		bool ClientDataReleased;
+		//! Counts of the freed vertices and indices
+		u32 ReleasedVertexCount;
+		u32 ReleasedIndexCount;
 	};
 
 	//! Standard meshbuffer
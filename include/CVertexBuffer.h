@@ -119,6 +119,14 @@ namespace scene
 					NewVertices=new CSpecificVertexList<video::S3DVertexTangents>;
 					break;
 				}
+				case video::EVT_SKINNED:
+				{
+					NewVertices=new CSpecificVertexList<video::S3DVertexSkinned>;
+					break;
+				}
+				// compact vertices are only kept by the drivers
+				case video::EVT_COMPACT:
+					return;
 			}
 			if (Vertices)
 			{
@@ -19,7 +19,15 @@ namespace scene
 		EAC_BOX = 1,
 		EAC_FRUSTUM_BOX = 2,
 		EAC_FRUSTUM_SPHERE = 4,
-		EAC_OCC_QUERY = 8
+		EAC_OCC_QUERY = 8,
+		//! The node hides the nodes behind it from the camera
+		/** Its occluder mesh is rasterized into a coarse depth buffer on
+		the CPU each frame, nodes with automatic culling whose bounding box
+		lies completely behind it are culled. Only works for mesh scene
+		nodes, see IMeshSceneNode::setOccluderMesh(), and only if enabled by
+		ISceneManager::setOcclusionCullingEnabled(). Combine it with other
+		flags, it doesn't cull the node itself. */
+		EAC_OCCLUDER = 16
 	};
 
 	//! Names for culling type
@@ -30,6 +38,7 @@ namespace scene
 		"frustum_box",		// camera frustum against node box
 		"frustum_sphere",	// camera frustum against node sphere
 		"occ_query",		// occlusion query
+		"occluder",		// hides other nodes in the occlusion buffer
 		0
 	};
 
@@ -42,6 +42,14 @@ namespace irr
 		Does not need X11 or other graphical subsystems.
 		May support hw-acceleration via OpenGL-ES */
 		EIDT_ANDROID,		
+
+		//! A device without a window which renders offscreen with EGL
+		/** For rendering on servers without a display. Renders with OpenGL-ES to a pbuffer of
+		the window size on an EGL device (EGL_EXT_platform_device) or the Mesa surfaceless
+		platform, results are read back with IVideoDriver::createScreenShot() or render targets.
+		Must be compiled in by setting the ENABLE_HEADLESS CMake option to ON.
+		Never selected by EIDT_BEST. */
+		EIDT_HEADLESS,
 	};
 
 } // end namespace irr
@@ -136,6 +136,12 @@ namespace video
 		//! Support for ETC2 compressed textures.
 		EVDF_TEXTURE_COMPRESSED_ETC2,
 
+		//! Support for BC7 (BPTC) compressed textures.
+		EVDF_TEXTURE_COMPRESSED_BPTC,
+
+		//! Support for ASTC LDR compressed textures.
+		EVDF_TEXTURE_COMPRESSED_ASTC,
+
 		//! Support for cube map textures.
 		EVDF_TEXTURE_CUBEMAP,
 
@@ -145,6 +151,48 @@ namespace video
 		//! Support for clamping vertices beyond far-plane to depth instead of capping them.
 		EVDF_DEPTH_CLAMP,
 
+		//! Support for drawing many instances of a mesh buffer with one draw call.
+		EVDF_INSTANCING,
+
+		//! Support for uniform blocks in GLSL shaders, see IMaterialRendererServices::setUniformBlock()
+		EVDF_UNIFORM_BLOCKS,
+
+		//! Support for measuring GPU time, see IVideoDriver::beginGPUTimerScope()
+		EVDF_TIMER_QUERY,
+
+		//! Support for uploading textures over the next frames, see ETCF_DEFERRED_UPLOAD
+		EVDF_TEXTURE_UPLOAD_QUEUE,
+
+		//! Support for immutable texture storage and streaming mip levels, see ETCF_STREAM_MIP_MAPS
+		EVDF_TEXTURE_STORAGE,
+
+		//! Support for moving video::EVT_SKINNED vertices by their joints in the vertex shader, see scene::ISkinnedMesh::setHardwareSkinning()
+		EVDF_HARDWARE_SKINNING,
+
+		//! Support for video::EVT_COMPACT vertices in hardware buffers, see scene::IMeshBuffer::setCompactVertices()
+		EVDF_COMPACT_VERTICES,
+
+		//! Support for loading textures on worker threads, see IVideoDriver::getTextureAsync()
+		EVDF_ASYNC_TEXTURE_LOADING,
+
+		//! Support for executing all drawing on a thread of the driver, see IVideoDriver::setRenderThreadEnabled()
+		EVDF_RENDER_THREAD,
+
+		//! Support for uploading textures of ETCF_DEFERRED_UPLOAD on a thread with a shared context
+		EVDF_SHARED_CONTEXT_UPLOAD,
+
+		//! Support for clipping depth from 0 to 1 instead of -1 to 1, which gives reverse depth its precision, see IVideoDriver::setReverseDepth()
+		EVDF_DEPTH_CLIP_CONTROL,
+
+		//! Support for culling the buffers of IVideoDriver::drawMeshBufferBatch() with compute shaders and drawing them with one indirect draw call
+		EVDF_GPU_CULLING,
+
+		//! Support for blending the keyframes of non-skinned animated meshes in the vertex shader, see IVideoDriver::drawMeshBufferMorphed()
+		EVDF_HARDWARE_MORPHING,
+
+		//! Support for order-independent transparency, see IVideoDriver::beginTransparencyAccumulation()
+		EVDF_WEIGHTED_TRANSPARENCY,
+
 		//! Only used for counting the elements of this enum
 		EVDF_COUNT
 	};
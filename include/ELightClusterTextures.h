@@ -0,0 +1,58 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __E_LIGHT_CLUSTER_TEXTURES_H_INCLUDED__
+#define __E_LIGHT_CLUSTER_TEXTURES_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Number of light clusters across the screen
+const u32 LIGHT_CLUSTERS_X = 16;
+
+//! Number of light clusters up the screen
+const u32 LIGHT_CLUSTERS_Y = 9;
+
+//! Number of light clusters along the view direction
+/** The depth slices grow exponentially from the near to the far value of the
+camera. A fragment at the view depth z lies in the slice
+floor(log(z / near) / log(far / near) * LIGHT_CLUSTERS_Z). */
+const u32 LIGHT_CLUSTERS_Z = 24;
+
+//! Width of the ELCT_INDICES and ELCT_LIGHTS textures
+const u32 LIGHT_TEXTURE_WIDTH = 1024;
+
+//! Textures holding the lights binned into the clusters of the camera view
+/** They are filled once per frame by ISceneManager::drawAll(), see
+ISceneManager::getLightClusterTexture(). The textures have no mipmaps, shaders
+read them texel by texel. */
+enum E_LIGHT_CLUSTER_TEXTURE
+{
+	//! ECF_G32R32F, one texel per cluster
+	/** The cluster x,y,z is at x + y * LIGHT_CLUSTERS_X, z. Red is the first
+	entry of the cluster in ELCT_INDICES, green the number of its lights.
+	Clusters are numbered from the left bottom of the screen. */
+	ELCT_CLUSTERS = 0,
+
+	//! ECF_R32F, the indices of the lights in ELCT_LIGHTS
+	/** Entry i is at i % LIGHT_TEXTURE_WIDTH, i / LIGHT_TEXTURE_WIDTH. */
+	ELCT_INDICES,
+
+	//! ECF_A32B32G32R32F, two texels per light
+	/** Light i starts at the texel 2 * i, counted like the entries of
+	ELCT_INDICES. The first texel holds the position in view space and the
+	radius, the second one the color. */
+	ELCT_LIGHTS,
+
+	//! Not used as texture, just counts the textures
+	ELCT_COUNT
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -18,12 +18,15 @@ namespace io
 		//! CReadFile
 		ERFT_READ_FILE  = MAKE_IRR_ID('r','e','a','d'),
 
-		//! CMemoryReadFile
+		//! CMemoryReadFile, and files on disk opened through a memory mapping
 		ERFT_MEMORY_READ_FILE = MAKE_IRR_ID('r','m','e','m'),
 
 		//! CLimitReadFile
 		ERFT_LIMIT_READ_FILE = MAKE_IRR_ID('r','l','i','m'),
 
+		//! CInflateReadFile, deflated files of zip archives decompressed while they are read
+		ERFT_INFLATE_READ_FILE = MAKE_IRR_ID('r','i','n','f'),
+
 		//! Unknown type
 		EFIT_UNKNOWN        = MAKE_IRR_ID('u','n','k','n')
 	};
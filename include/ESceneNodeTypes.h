@@ -24,6 +24,15 @@ namespace scene
 		//! Mesh Scene Node
 		ESNT_MESH           = MAKE_IRR_ID('m','e','s','h'),
 
+		//! Instanced Mesh Scene Node
+		ESNT_INSTANCED_MESH = MAKE_IRR_ID('i','m','s','h'),
+
+		//! Chunk Grid Scene Node
+		ESNT_CHUNK_GRID     = MAKE_IRR_ID('c','h','n','k'),
+
+		//! Static Batch Scene Node
+		ESNT_STATIC_BATCH   = MAKE_IRR_ID('s','b','t','c'),
+
 		//! Empty Scene Node
 		ESNT_EMPTY          = MAKE_IRR_ID('e','m','t','y'),
 
@@ -33,6 +42,9 @@ namespace scene
 		//! Camera Scene Node
 		ESNT_CAMERA         = MAKE_IRR_ID('c','a','m','_'),
 
+		//! Light Scene Node
+		ESNT_LIGHT          = MAKE_IRR_ID('l','g','h','t'),
+
 		//! Billboard Scene Node
 		ESNT_BILLBOARD      = MAKE_IRR_ID('b','i','l','l'),
 
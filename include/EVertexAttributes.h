@@ -16,6 +16,8 @@ enum E_VERTEX_ATTRIBUTES
 	EVA_TCOORD1,
 	EVA_TANGENT,
 	EVA_BINORMAL,
+	EVA_JOINT_INDICES,
+	EVA_JOINT_WEIGHTS,
 	EVA_COUNT
 };
 
@@ -29,6 +31,45 @@ const char* const sBuiltInVertexAttributeNames[] =
 	"inTexCoord1",
 	"inVertexTangent",
 	"inVertexBinormal",
+	"inJointIndices",
+	"inJointWeights",
+	0
+};
+
+//! Enumeration for the attributes of the keyframe a morphed vertex is blended towards.
+/** Morphed vertices have no joints, so the attributes share the locations of
+the joint attributes. See IVideoDriver::drawMeshBufferMorphed(). */
+enum E_MORPH_ATTRIBUTES
+{
+	EMA_POSITION = EVA_JOINT_INDICES,
+	EMA_NORMAL = EVA_JOINT_WEIGHTS
+};
+
+//! Array holding the built in morph attribute names, in the order of E_MORPH_ATTRIBUTES
+const char* const sBuiltInMorphAttributeNames[] =
+{
+	"inMorphPosition",
+	"inMorphNormal",
+	0
+};
+
+//! Enumeration for the attributes read once per instance by instanced draws.
+/** They are located right after the regular vertex attributes. */
+enum E_INSTANCE_ATTRIBUTES
+{
+	//! Instance transformation, a mat4 which takes up four locations
+	EIA_TRANSFORM = EVA_COUNT,
+	EIA_COLOR = EIA_TRANSFORM + 4,
+	EIA_PARAMS,
+	EIA_COUNT
+};
+
+//! Array holding the built in instance attribute names, in the order of E_INSTANCE_ATTRIBUTES
+const char* const sBuiltInInstanceAttributeNames[] =
+{
+	"inInstanceTransform",
+	"inInstanceColor",
+	"inInstanceParams",
 	0
 };
 
@@ -158,6 +158,80 @@ namespace scene
 		/** Also takes in to account transitions. */
 		virtual void animateJoints(bool CalculateAbsolutePositions=true) = 0;
 
+		//! Adds an animation layer, which is blended over the animation of the node.
+		/** Layers are blended in the order they were added, each one
+		replacing the pose below it by its weight. They only animate
+		skinned meshes, and nodes with layers don't share the skinned copy
+		of their mesh with other nodes.
+		\param begin: Start frame number of the layer.
+		\param end: End frame number of the layer.
+		\param framesPerSecond: Frames per second played, negative to play
+		the layer backwards.
+		\param loop: Whether the layer is played looped.
+		\param weight: Weight of the layer, from 0 (not visible) to 1
+		(replaces the pose below).
+		\return Index of the new layer. */
+		virtual u32 addAnimationLayer(s32 begin, s32 end, f32 framesPerSecond,
+				bool loop=true, f32 weight=1.f) = 0;
+
+		//! Removes all animation layers
+		virtual void removeAnimationLayers() = 0;
+
+		//! Returns the amount of animation layers
+		virtual u32 getAnimationLayerCount() const = 0;
+
+		//! Fades the weight of an animation layer.
+		/** \param layer: Index of the layer.
+		\param weight: Weight to fade to, from 0 to 1.
+		\param time: Seconds to reach the weight in, 0 to set it at once
+		or negative to use the time set by setTransitionTime(). */
+		virtual void setAnimationLayerWeight(u32 layer, f32 weight, f32 time=0.f) = 0;
+
+		//! Returns the current weight of an animation layer
+		virtual f32 getAnimationLayerWeight(u32 layer) const = 0;
+
+		//! Sets how much an animation layer moves a joint.
+		/** The weight of the layer is multiplied with this, so joints can
+		be masked out of a layer, for example to play a different animation
+		on the upper body only. All joints have a weight of 1 at first.
+		\param layer: Index of the layer.
+		\param jointName: Name of the joint.
+		\param weight: Weight of the joint, from 0 to 1.
+		\param children: Whether the weight is set for all children of
+		the joint as well.
+		\return True if successful, false if the joint wasn't found. */
+		virtual bool setAnimationLayerJointWeight(u32 layer, const c8* jointName,
+				f32 weight, bool children=true) = 0;
+
+		//! Crossfades to an animation layer.
+		/** Fades the layer in while fading out all other layers.
+		\param layer: Index of the layer, or -1 to fade back to the
+		animation of the node itself.
+		\param time: Seconds of the crossfade, negative to use the time
+		set by setTransitionTime(). */
+		virtual void crossfadeAnimationLayer(s32 layer, f32 time=-1.f) = 0;
+
+		//! Sets the animation level of detail.
+		/** Skinned nodes which are small on the screen of the active
+		camera update their pose less often, don't animate the normals of
+		their mesh and leave updating the absolute positions of their
+		joints to the next OnAnimate().
+		\param screenSize: Height of the bounding sphere of the node
+		relative to the screen height, below which the detail is reduced.
+		0 turns the animation level of detail off, which is the default.
+		\param updateInterval: Milliseconds between the pose updates of
+		nodes with a reduced detail. */
+		virtual void setAnimationLOD(f32 screenSize, u32 updateInterval=100) = 0;
+
+		//! Sets whether the bounding box of the node encloses its whole frame loop.
+		/** For skinned meshes the box is then computed once for the frame
+		loop and the animation layers, instead of following the current
+		frame. Culling stays conservative, and the node doesn't have to
+		move in the spatial index of the scene on every frame. Joints
+		controlled by the user may move the mesh out of the box. Off by
+		default. */
+		virtual void setLoopBoundingBox(bool on) = 0;
+
 		//! render mesh ignoring its transformation.
 		/** Culling is unaffected. */
 		virtual void setRenderFromIdentity( bool On )=0;
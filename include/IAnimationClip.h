@@ -0,0 +1,55 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_ANIMATION_CLIP_H_INCLUDED__
+#define __I_ANIMATION_CLIP_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Joint animation shared by skinned meshes with the same skeleton
+	/** A clip holds the keys of one animation apart from any mesh, so many
+	meshes can play it without each storing its own keys. The keys are
+	resampled at a fixed rate and quantized to 16 bits per component, joints
+	which don't move in a channel keep a single key. A clip is made by
+	ISkinnedMesh::createAnimationClip(), the mesh it was made from may be
+	dropped afterwards, and played by ISkinnedMesh::setAnimationClip(). */
+	class IAnimationClip : public virtual IReferenceCounted
+	{
+	public:
+
+		//! Gets the number of joints the clip has keys for
+		virtual u32 getJointCount() const = 0;
+
+		//! Gets the name of a joint
+		/** \return Name of the joint, or 0 if the number is too large. */
+		virtual const c8* getJointName(u32 number) const = 0;
+
+		//! Gets a joint number from its name
+		/** \return Number of the joint, or -1 if the clip has no such joint. */
+		virtual s32 getJointNumber(const c8* name) const = 0;
+
+		//! Gets the signature of the skeleton the clip was made for
+		/** Skeletons with the same joint names in the same order have the
+		same signature, meshes map the joints of such clips only once. */
+		virtual u64 getSkeletonSignature() const = 0;
+
+		//! Gets the last frame of the animation
+		virtual f32 getEndFrame() const = 0;
+
+		//! Gets the number of samples taken per frame
+		virtual f32 getSamplesPerFrame() const = 0;
+
+		//! Gets the number of bytes taken by the keys
+		virtual u32 getKeyMemorySize() const = 0;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -74,6 +74,17 @@ public:
 	//! Removes all attributes
 	virtual void clear() = 0;
 
+	//! Returns a handle for reading and writing an attribute without looking up its name
+	/** The handle is the index of the attribute, use it with the index
+	overloads like getAttributeAsBool(s32). It stays valid until clear() is
+	called. Looking up a name is cheap, but a handle avoids it for values
+	read every frame.
+	\param attributeName Name of the attribute.
+	\param type Type the attribute is added with if it doesn't exist yet,
+	EAT_BOOL, EAT_INT or EAT_FLOAT. It starts out as false or 0 then.
+	\return Index of the attribute. */
+	virtual s32 getAttributeHandle(const c8* attributeName, E_ATTRIBUTE_TYPE type = EAT_BOOL) = 0;
+
 
 	/*
 
@@ -54,6 +54,12 @@ namespace scene
 		/** \return The current view matrix of the camera. */
 		virtual const core::matrix4& getViewMatrix() const =0;
 
+		//! Gets the product of the projection and the view matrix of the camera.
+		/** It's computed together with the frustum, only when the view
+		or the projection changed since the last updateMatrices().
+		\return The current view-projection matrix of the camera. */
+		virtual const core::matrix4& getViewProjectionMatrix() const =0;
+
 		//! Sets a custom view matrix affector.
 		/** The matrix passed here, will be multiplied with the view
 		matrix when it gets updated. This allows for custom camera
@@ -136,6 +142,29 @@ namespace scene
 		/** \param fovy: New field of view in radians. */
 		virtual void setFOV(f32 fovy) =0;
 
+		//! Renders with reversed depth, near plane at depth 1 and far plane at depth 0.
+		/** Together with a floating point depth buffer this spreads the
+		depth precision much more evenly over the view range. The camera
+		switches video::IVideoDriver::setReverseDepth() when it becomes
+		active while rendering. Only the projection built by the camera is
+		adjusted, matrices passed to setProjectionMatrix() must already
+		map depth that way. (default: false)
+		\param reverse: True to reverse the depth range. */
+		virtual void setReverseDepth(bool reverse) =0;
+
+		//! Checks if the camera renders with reversed depth.
+		virtual bool isReverseDepth() const =0;
+
+		//! Moves the far plane of the projection to infinity.
+		/** Nothing gets clipped in the distance anymore, the far value
+		still limits culling in the view frustum. Only the projection
+		built by the camera is adjusted. (default: false)
+		\param infinite: True for a projection without far plane. */
+		virtual void setInfiniteFarPlane(bool infinite) =0;
+
+		//! Checks if the projection of the camera has its far plane at infinity.
+		virtual bool isInfiniteFarPlane() const =0;
+
 		//! Get the view frustum.
 		/** \return The current view frustum. */
 		virtual const SViewFrustum* getViewFrustum() const =0;
@@ -166,6 +195,8 @@ namespace scene
 		virtual void bindTargetAndRotation(bool bound) =0;
 
 		//! Updates the matrices without uploading them to the driver
+		/** Does nothing if neither the absolute position of the camera
+		nor any of its settings changed since the last update. */
 		virtual void updateMatrices() = 0;
 
 		//! Queries if the camera scene node's rotation and its target position are bound together.
@@ -0,0 +1,74 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_CHUNK_GRID_SCENE_NODE_H_INCLUDED__
+#define __I_CHUNK_GRID_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMesh;
+
+//! A scene node displaying large world geometry made of many chunk meshes
+/** Each chunk is a static mesh at an integer grid position. The position
+identifies the chunk and groups it with its neighbours into regions of
+8x8x8 chunks, the geometry itself is given relative to the node. Culling
+tests the boxes of the regions first, and only the chunks of regions cut by
+the view frustum one by one.
+
+The buffers of all visible chunks are grouped by material, and each group is
+drawn with a single IVideoDriver::drawMeshBufferBatch() call. Chunk buffers
+are static, so drivers with buffer arenas pack them into shared buffer
+objects. Drivers supporting video::EVDF_GPU_CULLING cull the chunks of these
+batches with a compute shader, also against the depth of the previous frame,
+so only the regions are culled on the CPU then. The materials of the node are those of the chunk mesh buffers,
+equal materials being merged into one. Changing one of them changes all
+buffers using it. */
+class IChunkGridSceneNode : public ISceneNode
+{
+public:
+
+	//! Constructor
+	IChunkGridSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: ISceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Sets the mesh of a chunk
+	/** Replaces the previous mesh of the chunk. The hardware buffers of a
+	replaced mesh are freed right away if the node held the last reference.
+	\param position Grid position of the chunk.
+	\param mesh Geometry of the chunk, relative to the node. 0 removes the chunk. */
+	virtual void setChunk(const core::vector3di& position, IMesh* mesh) = 0;
+
+	//! Returns the mesh of a chunk, or 0 if there is none
+	virtual IMesh* getChunk(const core::vector3di& position) const = 0;
+
+	//! Uploads the changed mesh buffers of a chunk again
+	/** Call after changing the vertices, indices or materials of the
+	buffers of a chunk mesh in place. Their bounding boxes have to be
+	recalculated before. Only the buffers of this chunk are uploaded. */
+	virtual void updateChunk(const core::vector3di& position) = 0;
+
+	//! Removes a chunk
+	virtual void removeChunk(const core::vector3di& position) = 0;
+
+	//! Removes all chunks
+	virtual void clearChunks() = 0;
+
+	//! Get the number of chunks
+	virtual u32 getChunkCount() const = 0;
+
+	//! Get the number of chunks which passed culling in the last rendered frame
+	virtual u32 getVisibleChunkCount() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
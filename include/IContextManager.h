@@ -7,6 +7,7 @@
 
 #include "SExposedVideoData.h"
 #include "SIrrCreationParameters.h"
+#include "rect.h"
 #include <string>
 
 namespace irr
@@ -49,11 +50,73 @@ namespace video
 			Note that only 1 thread at a time may access an OpenGL context.	*/
 		virtual bool activateContext(const SExposedVideoData& videoData, bool restorePrimaryOnZero=false) =0;
 
+		//! Makes the context current on the calling thread, or releases it from the calling thread
+		/** Used to move the context to the render thread of
+		IVideoDriver::setRenderThreadEnabled().
+		\return False if the context can't be moved between threads. */
+		virtual bool setContextCurrent(bool current) { return false; }
+
+		//! Creates a context sharing textures, buffers and shaders with the context of the manager
+		/** Such a context has no window to draw to. It's meant for threads
+		creating resources while another thread renders, for example
+		loader threads uploading textures. Call it while the context of
+		the manager exists.
+		\return Handle for makeSharedContextCurrent() and destroySharedContext(),
+		or 0 if the platform or the manager doesn't support shared contexts. */
+		virtual void* createSharedContext() { return 0; }
+
+		//! Makes a context of createSharedContext() current on the calling thread
+		/** Unlike activateContext() this doesn't change the context of
+		getContext(), so any thread may call it.
+		\param context Handle of createSharedContext(), or 0 to release the
+		shared context of the calling thread. */
+		virtual bool makeSharedContextCurrent(void* context) { return false; }
+
+		//! Destroys a context of createSharedContext(), it must not be current on any thread
+		virtual void destroySharedContext(void* context) {}
+
+		//! Sets how many vertical blanks swapBuffers() waits for, see IVideoDriver::setSwapInterval()
+		/** Negative values request adaptive vsync, which falls back to
+		normal vsync where the platform lacks it.
+		\return False if the interval can't be changed. */
+		virtual bool setSwapInterval(s32 interval) { return false; }
+
+		//! Creates a new context in place of a lost one
+		/** Some platforms lose the context with all its resources, for
+		example EGL after power management events on mobile GPUs. The
+		loss shows when the context is activated or the buffers are
+		swapped. The drivers call this on beginScene().
+		\return True if the context was lost and a new one is active, the
+		driver has to call IVideoDriver::restoreResources() then. */
+		virtual bool recreateLostContext() { return false; }
+
 		//! Get the address of any OpenGL procedure (including core procedures).
 		virtual void* getProcAddress(const std::string &procName) =0;
 
         //! Swap buffers.
         virtual bool swapBuffers() =0;
+
+		//! Number of frames since the current back buffer was presented
+		/** Where the platform reports it, like EGL with EGL_EXT_buffer_age,
+		a frame can keep the old content of its back buffer and only redraw
+		what changed since then. Querying it fixes the age for the frame.
+		\return 0 if the content of the back buffer is unknown. */
+		virtual s32 getBufferAge() { return 0; }
+
+		//! Tells which part of the back buffer the next frame draws, before drawing it
+		/** Lets tile based GPUs skip loading and storing the rest, needs
+		EGL_KHR_partial_update. Has to be called after getBufferAge().
+		\param rects Rectangles in window coordinates, origin top left.
+		\param count Number of rectangles.
+		\return False if the platform doesn't support it. */
+		virtual bool setDamageRegion(const core::rect<s32>* rects, u32 count) { return false; }
+
+		//! Swaps the buffers, telling the compositor which part of the window changed
+		/** Needs EGL_KHR_swap_buffers_with_damage or the EXT variant,
+		otherwise all of the window is presented.
+		\param rects Rectangles in window coordinates, origin top left.
+		\param count Number of rectangles. */
+		virtual bool swapBuffersWithDamage(const core::rect<s32>* rects, u32 count) { return swapBuffers(); }
 	};
 
 } // end namespace video
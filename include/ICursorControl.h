@@ -161,9 +161,19 @@ namespace gui
 		virtual void setReferenceRect(core::rect<s32>* rect=0) = 0;
 
 		//! Internally fixes the mouse position, and reports relative mouse movement compared to the old position 
-		/** Specific to SDL */
+		/** Supported by SDL, and on X11 when built with XInput2, where the
+		raw movement of the mouse is read and the cursor is kept inside the
+		window. Read the movement with getRelativeMotion() instead of
+		recentering the cursor with setPosition(). */
 		virtual void setRelativeMode(bool relative) {};
 
+		//! Returns the mouse movement in relative mode since the last call
+		/** The device accumulates the movements reported during the frames,
+		which aren't limited by the window border or the cursor position.
+		\return Movement in pixels, 0,0 if not in relative mode or not
+		supported. */
+		virtual core::vector2d<f32> getRelativeMotion() { return core::vector2d<f32>(0.f, 0.f); }
+
 		//! Sets the active cursor icon
 		/** Setting cursor icons is so far only supported on Win32 and Linux */
 		virtual void setActiveIcon(ECURSOR_ICON iconId) {}
@@ -45,6 +45,9 @@ enum E_FILE_ARCHIVE_TYPE
 	//! A wad Archive, Quake2, Halflife
 	EFAT_WAD     = MAKE_IRR_ID('W','A','D', 0),
 
+	//! An LZ4 frame, holding one file like a gzip archive
+	EFAT_LZ4     = MAKE_IRR_ID('L','Z','4', 0),
+
     //! An Android asset file archive
     EFAT_ANDROID_ASSET = MAKE_IRR_ID('A','S','S','E'),
 
@@ -53,7 +56,7 @@ enum E_FILE_ARCHIVE_TYPE
 };
 
 //! The FileArchive manages archives and provides access to files inside them.
-class IFileArchive : public virtual IReferenceCounted
+class IFileArchive : public virtual IReferenceCounted, public core::CMemoryTagged<core::EMC_IO>
 {
 public:
 
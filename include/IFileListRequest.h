@@ -0,0 +1,54 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_FILE_LIST_REQUEST_H_INCLUDED__
+#define __I_FILE_LIST_REQUEST_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "path.h"
+
+namespace irr
+{
+namespace io
+{
+	class IFileList;
+
+//! Handle of a directory which is listed on a worker thread
+/** Created by IFileSystem::createFileListAsync(). The entries are available
+in the order they are found while the directory is listed, createFileList()
+sorts them like IFileSystem::createFileList() does. */
+class IFileListRequest : public virtual IReferenceCounted
+{
+public:
+	//! Get the listed directory, ending with a slash
+	virtual const path& getPath() const = 0;
+
+	//! Check if the whole directory is listed
+	/** Can be called from any thread. */
+	virtual bool isReady() const = 0;
+
+	//! Waits until the whole directory is listed
+	virtual void wait() = 0;
+
+	//! Get the number of entries found so far
+	/** Can be called from any thread. */
+	virtual u32 getEntryCount() const = 0;
+
+	//! Get an entry found so far, in the order the entries were found
+	/** \param index Index of the entry, less than getEntryCount().
+	\param fullName Receives the name of the file including the path.
+	\param size Receives the size of the file in bytes, 0 if sizes
+	weren't requested.
+	\param isDirectory Receives true for directories.
+	\return False if there's no such entry yet. */
+	virtual bool getEntry(u32 index, path& fullName, u32& size, bool& isDirectory) const = 0;
+
+	//! Creates a sorted list of the entries found so far
+	/** \return The list, drop it when it's no longer needed. */
+	virtual IFileList* createFileList() const = 0;
+};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -0,0 +1,65 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_FILE_PREFETCH_REQUEST_H_INCLUDED__
+#define __I_FILE_PREFETCH_REQUEST_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "path.h"
+
+namespace irr
+{
+namespace io
+{
+	class IReadFile;
+	class IFilePrefetchRequest;
+
+//! Interface of an object which is told about the files of a prefetch request
+class IFilePrefetchCallback
+{
+public:
+	virtual ~IFilePrefetchCallback() {}
+
+	//! Called as soon as a file is loaded, on a worker thread
+	/** Decoding the file can be started here, so it runs on the worker
+	threads as well. The callback is called for the files of a request at
+	the same time on several threads.
+	\param request The request of the file.
+	\param index Index of the file in the request.
+	\param file The contents of the file, grab it to keep it after the
+	call. 0 if the file couldn't be loaded. */
+	virtual void OnFilePrefetched(IFilePrefetchRequest* request, u32 index, IReadFile* file) = 0;
+};
+
+//! Handle of files which are loaded on worker threads
+/** Created by IFileSystem::prefetchFiles(). Deflated files of zip archives
+are decompressed on worker threads, files on disk are read there. Once
+isReady() returns true, createAndOpenFile() opens the loaded files in memory,
+as often as needed. */
+class IFilePrefetchRequest : public virtual IReferenceCounted
+{
+public:
+	//! Get the number of files of the request
+	virtual u32 getFileCount() const = 0;
+
+	//! Get the name of a file, as it was passed to IFileSystem::prefetchFiles()
+	virtual const path& getFileName(u32 index) const = 0;
+
+	//! Check if all files are loaded or failed
+	/** Can be called from any thread. */
+	virtual bool isReady() const = 0;
+
+	//! Waits until all files are loaded or failed
+	virtual void wait() = 0;
+
+	//! Opens a loaded file
+	/** \return Memory read file with the contents, or 0 if the file
+	couldn't be loaded or the request isn't ready yet. Each call returns a
+	new file sharing the contents, drop it when it's no longer needed. */
+	virtual IReadFile* createAndOpenFile(u32 index) const = 0;
+};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
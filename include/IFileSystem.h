@@ -7,6 +7,9 @@
 
 #include "IReferenceCounted.h"
 #include "IFileArchive.h"
+#include "irrArray.h"
+#include "IFilePrefetchRequest.h"
+#include "IFileListRequest.h"
 
 namespace irr
 {
@@ -38,6 +41,33 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IReadFile* createAndOpenFile(const path& filename) =0;
 
+	//! Set from which size on files on disk are opened through a memory mapping
+	/** createAndOpenFile() then returns an IMemoryReadFile, whose
+	getBuffer() gives loaders the contents without copying them. Files
+	inside archives are not affected. Default is 256 KB.
+	\param size Size in bytes, a negative size disables the mappings. */
+	virtual void setMemoryMappingThreshold(long size) =0;
+
+	//! Set the memory budget of the cache of decompressed files from zip archives
+	/** Deflated files of up to a sixteenth of the budget are decompressed
+	once and kept in the cache, so opening them again is cheap. Larger
+	files are decompressed while they are read. The least recently opened
+	files are removed from the cache first. Default is 4 MB.
+	\param size Budget in bytes, 0 disables the cache. */
+	virtual void setDecompressedFileCacheSize(u32 size) =0;
+
+	//! Reads and decompresses files on worker threads
+	/** Deflated files of zip archives are read right away and decompressed
+	on worker threads. Files on disk are read on the worker threads. Files
+	of other archives are read right away. The files don't go through the
+	cache of decompressed files.
+	\param filenames Names of the files, found like with createAndOpenFile().
+	\param callback Told about each file as soon as it is loaded, on a
+	worker thread. May be 0, it has to exist until the request is ready.
+	\return Request to poll or wait for. Drop it when it's no longer needed. */
+	virtual IFilePrefetchRequest* prefetchFiles(const core::array<path>& filenames,
+			IFilePrefetchCallback* callback=0) =0;
+
 	//! Creates an IReadFile interface for accessing memory like a file.
 	/** This allows you to use a pointer to memory where an IReadFile is requested.
 	\param memory: A pointer to the start of the file in memory
@@ -83,11 +113,28 @@ public:
 	/** \param filename: Name of file to open.
 	\param append: If the file already exist, all write operations are
 	appended to the file.
+	\param bufferSize: Bytes collected in memory before they are written
+	to the file. Seeking back into them changes them in memory, so writers
+	patching chunk sizes don't move around in the file. 0 writes each call
+	through to the file.
 	\return Pointer to the created file interface. 0 is returned, if the
 	file could not created or opened for writing.
 	The returned pointer should be dropped when no longer needed.
 	See IReferenceCounted::drop() for more information. */
-	virtual IWriteFile* createAndWriteFile(const path& filename, bool append=false) =0;
+	virtual IWriteFile* createAndWriteFile(const path& filename, bool append=false, u32 bufferSize=64*1024) =0;
+
+	//! Opens a file for writing data of a size known in advance.
+	/** The file is mapped into memory where the platform supports it, so
+	writing copies into the mapping. Writing more than size bytes fails then,
+	the file is cut to the bytes written when it is dropped. Otherwise a
+	file from createAndWriteFile() is returned.
+	\param filename: Name of file to create, an existing file is replaced.
+	\param size: Number of bytes which will be written.
+	\return Pointer to the created file interface. 0 is returned, if the
+	file could not created.
+	The returned pointer should be dropped when no longer needed.
+	See IReferenceCounted::drop() for more information. */
+	virtual IWriteFile* createSizedWriteFile(const path& filename, u32 size) =0;
 
 	//! Adds an archive to the file system.
 	/** After calling this, the Irrlicht Engine will also search and open
@@ -154,6 +201,20 @@ public:
 	\return True if the archive was added successfully, false if not. */
 	virtual bool addFileArchive(IFileArchive* archive) =0;
 
+	//! Adds several archives to the file system, reading them at the same time
+	/** Opens the archive files one after another, then creates the archives
+	on worker threads, which is faster when many archives are mounted at
+	startup. The archives are added in the order of the names, like with
+	one addFileArchive() call for each. Files inside other archives and
+	folders are added on the calling thread. The archive loaders have to be
+	able to create archives of different files at the same time, the
+	built-in zip loader can.
+	\param filenames Names of the archives.
+	\param ignoreCase, ignorePaths, archiveType See addFileArchive().
+	\return Number of archives which were added. */
+	virtual u32 addFileArchives(const core::array<path>& filenames, bool ignoreCase=true,
+			bool ignorePaths=true, E_FILE_ARCHIVE_TYPE archiveType=EFAT_UNKNOWN) =0;
+
 	//! Get the number of archives currently attached to the file system
 	virtual u32 getFileArchiveCount() const =0;
 
@@ -274,7 +335,9 @@ public:
 	virtual bool changeWorkingDirectoryTo(const path& newDirectory) =0;
 
 	//! Converts a relative path to an absolute (unique) path, resolving symbolic links if required
-	/** \param filename Possibly relative file or directory name to query.
+	/** Results are cached until the working directory is changed, so
+	symbolic links changed in the meantime may not be followed.
+	\param filename Possibly relative file or directory name to query.
 	\result Absolute filename which points to the same file. */
 	virtual path getAbsolutePath(const path& filename) const =0;
 
@@ -302,6 +365,16 @@ public:
 	See IReferenceCounted::drop() for more information. */
 	virtual IFileList* createFileList() =0;
 
+	//! Lists the current working directory on a worker thread
+	/** The entries can be shown while the directory is listed, so large
+	or remote directories don't stall the application.
+	\param fetchSizes False to skip getting the sizes of the files, which
+	is most of the work when the type of an entry is known from its
+	directory entry.
+	\return Request to poll or wait for. Drop it when it's no longer
+	needed, a listing which isn't ready is cancelled. */
+	virtual IFileListRequest* createFileListAsync(bool fetchSizes=true) =0;
+
 	//! Creates an empty filelist
 	/** \return a Pointer to the created IFileList is returned. After the list has been used
 	it has to be deleted using its IFileList::drop() method.
@@ -312,7 +385,10 @@ public:
 	virtual EFileSystemType setFileListSystem(EFileSystemType listType) =0;
 
 	//! Determines if a file exists and could be opened.
-	/** \param filename is the string identifying the file which should be tested for existence.
+	/** Results are cached until the working directory or the archives are
+	changed, or a file is written with this file system. Files created or
+	deleted on disk by others in the meantime may not be noticed.
+	\param filename is the string identifying the file which should be tested for existence.
 	\return True if file exists, and false if it does not exist or an error occurred. */
 	virtual bool existFile(const path& filename) const =0;
 };
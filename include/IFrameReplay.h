@@ -0,0 +1,48 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_FRAME_REPLAY_H_INCLUDED__
+#define __I_FRAME_REPLAY_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "EDriverTypes.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! A frame written by IVideoDriver::captureFrame(), loaded for drawing it again
+/** Created by IVideoDriver::createFrameReplay(), which creates the textures
+and mesh buffers of the capture in that driver. replay() then issues the
+commands of the frame, so it can be timed on any driver and machine.
+Captures without payloads draw blank textures and zeroed vertices of the
+captured sizes. Materials the replaying driver doesn't have, like shader
+materials added by the application, are drawn with EMT_SOLID. */
+class IFrameReplay : public virtual IReferenceCounted
+{
+public:
+	//! Issue the commands of the frame, from beginScene() to endScene()
+	/** \return False if the driver failed to begin or end the scene. */
+	virtual bool replay() = 0;
+
+	//! Get the number of commands in the frame
+	virtual u32 getCommandCount() const = 0;
+
+	//! Get the number of textures the frame uses
+	virtual u32 getTextureCount() const = 0;
+
+	//! Get the number of mesh buffers the frame draws
+	virtual u32 getMeshBufferCount() const = 0;
+
+	//! Get the driver the frame was captured with
+	virtual E_DRIVER_TYPE getCapturedDriverType() const = 0;
+
+	//! Check if the capture has the texture pixels and the vertices
+	virtual bool hasPayloads() const = 0;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
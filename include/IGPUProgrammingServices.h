@@ -155,8 +155,42 @@ public:
 			callback, baseMaterial, userData);
 	}
 
+	//! Adds a new high-level shading material renderer without waiting for the shaders.
+	/** Works like addHighLevelShaderMaterial(), but returns before the
+	shaders are compiled and linked. Until that is finished, materials of
+	the returned type are drawn with baseMaterial, use
+	isShaderMaterialReady() to find out when this is the case. Drivers
+	without support for this compile the shaders immediately.
+	\return Number of the material type, or -1 if an error occurred.
+	Compile and link errors which happen later are only printed to the
+	log. */
+	virtual s32 addHighLevelShaderMaterialAsync(
+		const c8* vertexShaderProgram,
+		const c8* pixelShaderProgram = 0,
+		IShaderConstantSetCallBack* callback = 0,
+		E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID,
+		s32 userData = 0)
+	{
+		return addHighLevelShaderMaterial(vertexShaderProgram, pixelShaderProgram,
+			callback, baseMaterial, userData);
+	}
+
+	//! Check if a shader material is ready to be drawn with its own shaders.
+	/** \param materialType Material type returned by
+	addHighLevelShaderMaterialAsync().
+	\return False while the shaders are still compiling or if linking
+	them failed, true otherwise. */
+	virtual bool isShaderMaterialReady(s32 materialType)
+	{
+		return true;
+	}
+
 	//! Like IGPUProgrammingServices::addShaderMaterial(), but loads from files.
-	/** \param vertexShaderProgramFileName Text file containing the source
+	/** The files are cached and only read again when their modification
+	time or size changed. Lines like #include "common.glsl" are replaced
+	with the named file, relative to the directory of the including file.
+	Each file is included at most once per shader.
+	\param vertexShaderProgramFileName Text file containing the source
 	of the vertex shader program. Set to empty string if no vertex shader
 	shall be created.
 	\param vertexShaderEntryPointName Name of the entry function of the
@@ -279,6 +313,37 @@ public:
 			callback, baseMaterial, userData);
 	}
 
+	//! Like addHighLevelShaderMaterialFromFiles(), but compiles a permutation of the shaders selected by defines
+	/** The defines are inserted into both shaders behind their #version
+	line, e.g. "#define USE_FOG\n#define LIGHT_COUNT 4\n". Requesting a
+	permutation again with the same sources, defines, callback, base
+	material and user data returns the material type created the first
+	time instead of compiling and linking another program. All entry
+	points are "main" and the compile targets are shader type 1.1.
+	\param vertexShaderProgramFileName Text file containing the source
+	of the vertex shader program. Set to empty string if no vertex shader
+	shall be created.
+	\param pixelShaderProgramFileName Text file containing the source of
+	the pixel shader program. Set to empty string if no pixel shader shall
+	be created.
+	\param defines Preprocessor lines added to both shaders, or 0.
+	\param callback Pointer to an implementation of
+	IShaderConstantSetCallBack in which you can set the needed shader
+	program constants. Set this to 0 if you don't need this.
+	\param baseMaterial Base material which renderstates will be used to
+	shade the material.
+	\param userData a user data int, passed to the callback.
+	\return Number of the material type which can be set in
+	SMaterial::MaterialType to use the renderer. -1 is returned if an error
+	occurred. */
+	virtual s32 addHighLevelShaderPermutationFromFiles(
+		const io::path& vertexShaderProgramFileName,
+		const io::path& pixelShaderProgramFileName,
+		const c8* defines,
+		IShaderConstantSetCallBack* callback = 0,
+		E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID,
+		s32 userData = 0) = 0;
+
 	//! Like IGPUProgrammingServices::addShaderMaterial(), but loads from files.
 	/** \param vertexShaderProgram Text file handle containing the source
 	of the vertex shader program. Set to 0 if no vertex shader shall be
@@ -6,6 +6,7 @@
 #define __I_GUI_ELEMENT_H_INCLUDED__
 
 #include "IReferenceCounted.h"
+#include "irrMemory.h"
 #include "rect.h"
 #include "irrString.h"
 #include "IEventReceiver.h"
@@ -13,6 +14,7 @@
 #include "EGUIAlignment.h"
 #include "IAttributes.h"
 #include "IGUIEnvironment.h"
+#include "S2DDrawList.h"
 #include <cassert>
 #include <algorithm>
 #include <list>
@@ -23,7 +25,8 @@ namespace irr
 namespace gui
 {
 //! Base class of all GUI elements.
-class IGUIElement : virtual public IReferenceCounted, public IEventReceiver
+class IGUIElement : virtual public IReferenceCounted, public IEventReceiver,
+	public core::CMemoryTagged<core::EMC_GUI>
 {
 public:
 
@@ -35,7 +38,9 @@ public:
 		MaxSize(0,0), MinSize(1,1), IsVisible(true), IsEnabled(true),
 		IsSubElement(false), NoClip(false), ID(id), IsTabStop(false), TabOrder(-1), IsTabGroup(false),
 		AlignLeft(EGUIA_UPPERLEFT), AlignRight(EGUIA_UPPERLEFT), AlignTop(EGUIA_UPPERLEFT), AlignBottom(EGUIA_UPPERLEFT),
-		Environment(environment), Type(type)
+		Environment(environment), Type(type), DrawCache(0),
+		TextureCache(0), TextureCacheEnabled(false), TextureCacheValid(false),
+		HitTestValid(false)
 	{
 		#ifdef _DEBUG
 		setDebugName("IGUIElement");
@@ -46,6 +51,7 @@ public:
 		{
 			parent->addChildToEnd(this);
 			recalculateAbsolutePosition(true);
+			invalidateDrawCache();
 		}
 	}
 
@@ -57,6 +63,10 @@ public:
 			child->Parent = nullptr;
 			child->drop();
 		}
+
+		delete DrawCache;
+		if (TextureCache)
+			TextureCache->drop();
 	}
 
 
@@ -300,6 +310,7 @@ public:
 		{
 			addChildToEnd(child);
 			child->updateAbsolutePosition();
+			child->invalidateDrawCache();
 		}
 	}
 
@@ -309,7 +320,9 @@ public:
 		assert(child->Parent == this);
 		Children.erase(child->ParentPos);
 		child->Parent = nullptr;
+		invalidateDrawing(child->AbsoluteClippingRect);
 		child->drop();
+		invalidateHitTest();
 	}
 
 	//! Removes all children.
@@ -334,8 +347,96 @@ public:
 		if ( isVisible() )
 		{
 			for (auto child : Children)
-				child->draw();
+				drawChild(child);
+		}
+	}
+
+
+	//! Records the drawing of this element and its children to replay it while they are unchanged
+	/** Meant for subtrees which are expensive to draw and rarely change,
+	like inventory screens. Changes of text, position, visibility,
+	children, hover and focus and the setters of the engine elements
+	invalidate the recording. Elements changed otherwise, e.g. by a
+	changed skin color or custom elements with own state, have to call
+	invalidateDrawCache(). Drivers without IVideoDriver::beginRecording2D
+	draw the element as usual.
+	\param enable True to record the drawing, false to draw as usual. */
+	void setDrawCacheEnabled(bool enable)
+	{
+		if (enable == (DrawCache != 0))
+			return;
+
+		if (enable)
+			DrawCache = new video::S2DDrawList();
+		else
+		{
+			delete DrawCache;
+			DrawCache = 0;
 		}
+
+		invalidateDrawCache();
+	}
+
+	//! Returns true if the drawing of this element is recorded, see setDrawCacheEnabled()
+	bool isDrawCacheEnabled() const
+	{
+		return DrawCache != 0;
+	}
+
+	//! Draws this element and its children into a texture, which is drawn instead while they are unchanged
+	/** The subtree is composited with a single 2d image then. The texture
+	is drawn again on the same changes that invalidate setDrawCacheEnabled().
+	Translucent parts are blended twice, into the texture and onto the
+	screen, so this is meant for opaque panels. Drivers without render
+	targets draw the element as usual. Takes precedence over
+	setDrawCacheEnabled() for the same element.
+	\param enable True to draw the element through a texture. */
+	void setTextureCacheEnabled(bool enable)
+	{
+		TextureCacheEnabled = enable;
+		if (!enable && TextureCache)
+		{
+			TextureCache->drop();
+			TextureCache = 0;
+		}
+
+		invalidateDrawCache();
+	}
+
+	//! Returns true if the element is drawn through a texture, see setTextureCacheEnabled()
+	bool isTextureCacheEnabled() const
+	{
+		return TextureCacheEnabled;
+	}
+
+	//! Makes this element and its ancestors record their drawing again
+	/** Also adds the clipping rectangle of the element to the damage of
+	the gui, see IGUIEnvironment::getDrawDamage().
+	\param includeChildren Also invalidate the recordings of all
+	descendants, e.g. after skin or font changes. */
+	void invalidateDrawCache(bool includeChildren=false)
+	{
+		invalidateDrawing(AbsoluteClippingRect);
+
+		if (includeChildren)
+		{
+			for (auto child : Children)
+				child->invalidateDrawCache(true);
+		}
+	}
+
+	//! Makes the root element find the element under the mouse from scratch
+	/** The GUI environment keeps an index of the clipping rectangles of
+	the visible elements to find the hovered element. Changes of position,
+	visibility and children rebuild it. Elements overriding
+	getElementFromPoint() with other rules than their clipping rectangle and
+	isPointInside() have to call this when their rules change. */
+	void invalidateHitTest()
+	{
+		IGUIElement* root = this;
+		while (root->Parent)
+			root = root->Parent;
+		root->HitTestValid = false;
 	}
 
 
@@ -381,6 +482,8 @@ public:
 	virtual void setVisible(bool visible)
 	{
 		IsVisible = visible;
+		invalidateDrawCache();
+		invalidateHitTest();
 	}
 
 
@@ -499,6 +602,7 @@ public:
 	virtual void setEnabled(bool enabled)
 	{
 		IsEnabled = enabled;
+		invalidateDrawCache();
 	}
 
 
@@ -506,6 +610,7 @@ public:
 	virtual void setText(const wchar_t* text)
 	{
 		Text = text;
+		invalidateDrawCache();
 	}
 
 
@@ -561,6 +666,8 @@ public:
 			return true;
 		Children.erase(child->ParentPos);
 		child->ParentPos = Children.insert(Children.end(), child);
+		invalidateDrawing(child->AbsoluteClippingRect);
+		invalidateHitTest();
 		return true;
 	}
 
@@ -575,6 +682,8 @@ public:
 			return true;
 		Children.erase(child->ParentPos);
 		child->ParentPos = Children.insert(Children.begin(), child);
+		invalidateDrawing(child->AbsoluteClippingRect);
+		invalidateHitTest();
 		return true;
 	}
 
@@ -791,7 +900,40 @@ protected:
 			child->LastParentRect = getAbsolutePosition();
 			child->Parent = this;
 			child->ParentPos = Children.insert(Children.end(), child);
+			// the child is damaged once it has its position
+			invalidateDrawing(core::rect<s32>(0, 0, 0, 0));
+			invalidateHitTest();
+		}
+	}
+
+	//! Makes this element and its ancestors record their drawing again, damaging the given area
+	void invalidateDrawing(const core::rect<s32>& damage)
+	{
+		for (IGUIElement* e = this; e; e = e->Parent)
+		{
+			if (e->DrawCache)
+				e->DrawCache->Valid = false;
+			e->TextureCacheValid = false;
+		}
+
+		if (Environment)
+			Environment->addDrawDamage(damage);
+	}
+
+	//! Draws a child, replaying its recorded drawing or texture if it has one that is still valid
+	void drawChild(IGUIElement* child)
+	{
+		if (child->TextureCacheEnabled && Environment)
+		{
+			// set before drawing, as animated children invalidate it again while drawing
+			const bool redraw = !child->TextureCacheValid;
+			child->TextureCacheValid = true;
+			Environment->drawTextureCached(child, child->TextureCache, redraw);
 		}
+		else if (child->DrawCache && Environment)
+			Environment->drawRecorded(child, *child->DrawCache);
+		else
+			child->draw();
 	}
 
 #ifndef NDEBUG
@@ -827,6 +969,8 @@ protected:
 	// not virtual because needed in constructor
 	void recalculateAbsolutePosition(bool recursive)
 	{
+		const core::rect<s32> oldAbsoluteRect(AbsoluteRect);
+		const core::rect<s32> oldAbsoluteClippingRect(AbsoluteClippingRect);
 		core::rect<s32> parentAbsolute(0,0,0,0);
 		core::rect<s32> parentAbsoluteClip;
 		f32 fw=0.f, fh=0.f;
@@ -942,6 +1086,13 @@ protected:
 
 		LastParentRect = parentAbsolute;
 
+		if (AbsoluteRect != oldAbsoluteRect || AbsoluteClippingRect != oldAbsoluteClippingRect)
+		{
+			invalidateDrawing(oldAbsoluteClippingRect);
+			invalidateDrawCache();
+			invalidateHitTest();
+		}
+
 		if ( recursive )
 		{
 			// update all children
@@ -1026,6 +1177,21 @@ protected:
 
 	//! type of element
 	EGUI_ELEMENT_TYPE Type;
+
+	//! recorded drawing of the element and its children, 0 if not recorded
+	video::S2DDrawList* DrawCache;
+
+	//! texture the element and its children are drawn into, owned by the environment's implementation
+	IReferenceCounted* TextureCache;
+
+	//! draw through TextureCache?
+	bool TextureCacheEnabled;
+
+	//! false if TextureCache has to be drawn again
+	bool TextureCacheValid;
+
+	//! false if the hit-test index of the root element has to be built again
+	bool HitTestValid;
 };
 
 
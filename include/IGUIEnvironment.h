@@ -27,6 +27,7 @@ namespace irr
 	{
 		class IVideoDriver;
 		class ITexture;
+		struct S2DDrawList;
 	} // end namespace video
 
 namespace gui
@@ -34,6 +35,8 @@ namespace gui
 
 class IGUIElement;
 class IGUIFont;
+class IGUIGlyphSource;
+class IGUIFontDistanceField;
 class IGUISpriteBank;
 class IGUIScrollBar;
 class IGUIImage;
@@ -65,6 +68,48 @@ public:
 	            Can be set to false to control that size yourself, p.E when not the full size should be used for UI. */
 	virtual void drawAll(bool useScreenSize=true) = 0;
 
+	//! Tells if the gui changed since drawAll() was called the last time
+	/** For applications drawing only when something changed, see
+	scene::ISceneManager::needsRedraw(). The gui changed if an element
+	invalidated its drawing, see IGUIElement::invalidateDrawCache(), like
+	elements do on changes of text, position, visibility, children, hover
+	and focus, if elements wait for deletion, if a tooltip is due or if the
+	screen size changed. A focused edit box with a blinking cursor keeps the
+	gui changing. Custom elements changing otherwise, and changes of the
+	skin, have to call invalidateDrawCache() of themselves or the root
+	element. */
+	virtual bool needsRedraw() const = 0;
+
+	//! Gets the part of the screen the gui changed since drawAll() was called the last time
+	/** The bounding rectangle of the elements which invalidated their
+	drawing, at their old and new positions. All of the screen before
+	the first drawAll() and after the screen size changed. Frames in
+	which only the gui changed can pass it to
+	video::IVideoDriver::setFrameDamage() before beginScene(), the
+	scene behind the gui then has to look the same as in the previous
+	frames. Elements drawing outside of their clipping rectangle are not
+	covered. */
+	virtual core::rect<s32> getDrawDamage() const = 0;
+
+	//! Adds an area of the screen to getDrawDamage()
+	/** Called by IGUIElement::invalidateDrawCache(). */
+	virtual void addDrawDamage(const core::rect<s32>& rect) = 0;
+
+	//! Draws an element and its children by replaying their recorded drawing
+	/** The drawing is recorded again if the list is outdated. Called
+	for elements with IGUIElement::setDrawCacheEnabled().
+	\param element Element to draw
+	\param list Recording of the element */
+	virtual void drawRecorded(IGUIElement* element, video::S2DDrawList& list) = 0;
+
+	//! Draws an element and its children through a texture
+	/** Called for elements with IGUIElement::setTextureCacheEnabled().
+	\param element Element to draw
+	\param cache Texture of the element, created and replaced by the
+	environment as needed. The element drops it when it no longer needs it.
+	\param redraw True to draw the element into the texture again. */
+	virtual void drawTextureCached(IGUIElement* element, IReferenceCounted*& cache, bool redraw) = 0;
+
 	//! Sets the focus to an element.
 	/** Causes a EGET_ELEMENT_FOCUS_LOST event followed by a
 	EGET_ELEMENT_FOCUSED event. If someone absorbed either of the events,
@@ -181,6 +226,39 @@ public:
 	\return Pointer to the font stored. This can differ from given parameter if the name previously existed. */
 	virtual IGUIFont* addFont(const io::path& name, IGUIFont* font) = 0;
 
+	//! Adds a font which rasterizes its glyphs on demand into a texture
+	/** Only the glyphs drawn recently are kept in the texture, the least
+	recently used ones are replaced by new ones. This keeps large character
+	sets like CJK fonts small in video memory. Glyphs which don't fit into
+	the texture next to the others drawn in the same frame are skipped, so
+	the texture should hold all glyphs of a frame.
+	\param name Name the font should be stored as.
+	\param source Rasterizes the glyphs, grabbed by the font.
+	\param atlasSize Width and height of the glyph texture.
+	\return Pointer to the font stored, 0 on failure. This can differ from
+	a new font if the name previously existed. */
+	virtual IGUIFont* addGlyphCacheFont(const io::path& name, IGUIGlyphSource* source, u32 atlasSize=512) = 0;
+
+	//! Adds a font drawing its glyphs from signed distance fields
+	/** Works like addGlyphCacheFont(), but the glyphs are turned into
+	distance fields, which the OpenGL ES 2 and OpenGL 3 drivers draw with
+	sharp edges at any scale. Other drivers draw the distances as alpha,
+	which gives blurred edges. The source should rasterize the glyphs at the
+	largest size drawn, fonts of smaller sizes are created with
+	IGUIFontDistanceField::createScaledFont() and share the texture.
+	\param name Name the font should be stored as.
+	\param source Rasterizes the glyphs, grabbed by the font.
+	\param scale Size of the text relative to the size of the rasterized glyphs.
+	\param spread Distance in pixels of the rasterized glyphs which the
+	fields extend beyond the edges of the glyphs. Larger values keep the
+	edges smooth at smaller scales, but need more space in the texture.
+	\param atlasSize Width and height of the glyph texture.
+	\return Pointer to the font stored, 0 on failure or if a font of
+	another type had the name. This can differ from a new font if the name
+	previously existed. */
+	virtual IGUIFontDistanceField* addDistanceFieldFont(const io::path& name, IGUIGlyphSource* source,
+		f32 scale=1.f, u32 spread=4, u32 atlasSize=1024) = 0;
+
 	//! remove loaded font
 	virtual void removeFont(IGUIFont* font) = 0;
 
@@ -9,6 +9,7 @@
 #include "SColor.h"
 #include "rect.h"
 #include "irrString.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -31,10 +32,36 @@ enum EGUI_FONT_TYPE
 	/** Currently not used. */
 	EGFT_OS,
 
+	//! Fonts drawing glyphs from signed distance fields, see IGUIFontDistanceField.
+	EGFT_DISTANCE_FIELD,
+
 	//! An external font type provided by the user.
 	EGFT_CUSTOM
 };
 
+//! Text laid out by a font, to draw it again without looking up its characters
+/** Filled by IGUIFont::drawLayout() and IGUIFont::getLayoutDimension(),
+which lay out the text again only when the text or the font changed. */
+struct SGUITextLayout
+{
+	SGUITextLayout() : Revision(0) {}
+
+	//! The text which was laid out
+	core::stringw Text;
+
+	//! Sprite of each visible character
+	core::array<u32> Sprites;
+
+	//! Position of each sprite, relative to the upper left corner of the text
+	core::array<core::position2di> Positions;
+
+	//! Size of the whole text
+	core::dimension2d<u32> Dimension;
+
+	//! Identifies the font and its settings the text was laid out with, 0 if not laid out
+	u32 Revision;
+};
+
 //! Font interface.
 class IGUIFont : public virtual IReferenceCounted
 {
@@ -57,6 +84,38 @@ public:
 	it would be drawn. */
 	virtual core::dimension2d<u32> getDimension(const wchar_t* text) const = 0;
 
+	//! Returns the horizontal distance a character moves the following characters
+	/** Measuring texts by adding up the advances of their characters
+	avoids building strings for getDimension(). */
+	virtual s32 getCharacterAdvance(wchar_t character) const
+	{
+		const wchar_t text[2] = { character, 0 };
+		return (s32)getDimension(text).Width;
+	}
+
+	//! Draws a text like draw(), keeping its layout to draw it faster the next time
+	/** Elements drawing the same text every frame keep a layout per text.
+	Fonts which can't lay out text draw it with draw().
+	\param text: Text to draw
+	\param layout: Layout of the text, laid out again if the text or the font changed
+	\param position: Rectangle specifying position where to draw the text.
+	\param color: Color of the text
+	\param hcenter: Specifies if the text should be centered horizontally into the rectangle.
+	\param vcenter: Specifies if the text should be centered vertically into the rectangle.
+	\param clip: Optional pointer to a rectangle against which the text will be clipped. */
+	virtual void drawLayout(const core::stringw& text, SGUITextLayout& layout,
+		const core::rect<s32>& position, video::SColor color,
+		bool hcenter=false, bool vcenter=false, const core::rect<s32>* clip=0)
+	{
+		draw(text, position, color, hcenter, vcenter, clip);
+	}
+
+	//! Calculates the width and height of a text like getDimension(), keeping its layout for drawLayout()
+	virtual core::dimension2d<u32> getLayoutDimension(const core::stringw& text, SGUITextLayout& layout)
+	{
+		return getDimension(text.c_str());
+	}
+
 	//! Calculates the index of the character in the text which is on a specific position.
 	/** \param text: Text string.
 	\param pixel_x: X pixel position of which the index of the character will be returned.
@@ -0,0 +1,44 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_GUI_FONT_DISTANCE_FIELD_H_INCLUDED__
+#define __I_GUI_FONT_DISTANCE_FIELD_H_INCLUDED__
+
+#include "IGUIFont.h"
+
+namespace irr
+{
+namespace gui
+{
+
+//! Font drawing its glyphs from signed distance fields, sharp at any scale
+/** Created by IGUIEnvironment::addDistanceFieldFont(). Fonts of several
+sizes share the glyphs and their texture, so texts of all sizes are drawn
+from one texture and can be batched by the driver. */
+class IGUIFontDistanceField : public IGUIFont
+{
+public:
+
+	//! Returns the type of this font
+	EGUI_FONT_TYPE getType() const override { return EGFT_DISTANCE_FIELD; }
+
+	//! Sets the size of the text relative to the size the glyphs are rasterized with
+	/** \param scale Factor for the glyphs and all metrics of the font,
+	except the kerning, which is in pixels. */
+	virtual void setScale(f32 scale) = 0;
+
+	//! Returns the size of the text relative to the size the glyphs are rasterized with
+	virtual f32 getScale() const = 0;
+
+	//! Creates a font drawing the glyphs of this font at another scale
+	/** The new font shares the glyphs and the texture of this font.
+	\param scale Scale of the new font, see setScale().
+	\return The new font, which the caller drops. Add it to the
+	environment with IGUIEnvironment::addFont() to find it by name. */
+	virtual IGUIFontDistanceField* createScaledFont(f32 scale) = 0;
+};
+
+} // end namespace gui
+} // end namespace irr
+
+#endif
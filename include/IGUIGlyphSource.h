@@ -0,0 +1,48 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_GUI_GLYPH_SOURCE_H_INCLUDED__
+#define __I_GUI_GLYPH_SOURCE_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "dimension2d.h"
+#include "position2d.h"
+
+namespace irr
+{
+namespace video
+{
+	class IImage;
+} // end namespace video
+
+namespace gui
+{
+
+//! Rasterizes the glyphs of a font on demand
+/** Used by fonts created with IGUIEnvironment::addGlyphCacheFont(),
+which keep only the glyphs drawn recently in a texture. Implement it
+with a font rasterizer like FreeType to draw large character sets. */
+class IGUIGlyphSource : public virtual IReferenceCounted
+{
+public:
+
+	//! Returns the height of a line of text
+	virtual u32 getLineHeight() const = 0;
+
+	//! Returns the size no glyph image is larger than
+	virtual core::dimension2d<u32> getMaxGlyphSize() const = 0;
+
+	//! Rasterizes the glyph of a character
+	/** \param character Unicode code point of the character.
+	\param advance Receives the horizontal distance from this character to the next one.
+	\param offset Receives the position of the upper left corner of the
+	image relative to the upper left corner of the character cell.
+	\return Image of the glyph, which the caller drops, or 0 for characters
+	which draw nothing, like spaces. Alpha is used for blending. */
+	virtual video::IImage* rasterizeGlyph(u32 character, s32& advance, core::position2d<s32>& offset) = 0;
+};
+
+} // end namespace gui
+} // end namespace irr
+
+#endif
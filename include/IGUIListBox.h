@@ -58,6 +58,14 @@ namespace gui
 		\return The id of the new created item */
 		virtual u32 addItem(const wchar_t* text, s32 icon) = 0;
 
+		//! adds many list items at once
+		/** Faster than adding the items one by one, as the scrollbar
+		is only updated once.
+		\param texts Texts of the new list entries
+		\param icon Sprite index of the Icon of all new entries, -1 for none
+		\return The id of the first new item */
+		virtual u32 addItems(const core::array<core::stringw>& texts, s32 icon=-1) = 0;
+
 		//! Removes an item from the list
 		virtual void removeItem(u32 index) = 0;
 
@@ -16,6 +16,7 @@ namespace irr
 namespace video
 {
 	class ITexture;
+	class IImage;
 } // end namespace video
 
 namespace gui
@@ -87,6 +88,24 @@ public:
 	 \returns The index of the sprite or -1 on failure */
 	virtual s32 addTextureAsSprite(video::ITexture* texture) = 0;
 
+	//! Add the image as a single non-animated sprite.
+	/** Packed into an atlas texture when setAtlasSize() is set, otherwise
+	a texture is created for it.
+	 \returns The index of the sprite or -1 on failure */
+	virtual s32 addImageAsSprite(video::IImage* image) = 0;
+
+	//! Packs sprites added afterwards into shared atlas textures
+	/** addTextureAsSprite() and addImageAsSprite() then copy the pixels
+	into textures of this size, which are uploaded when a sprite is drawn
+	the next time. Sprites sharing a texture are drawn with a single call by
+	draw2DSpriteBatch(). Sprites larger than the atlas and textures which
+	can't be read get a texture of their own.
+	\param size Width and height of the atlas textures, 0 to disable packing. */
+	virtual void setAtlasSize(u32 size) = 0;
+
+	//! Returns the size of the atlas textures, 0 if sprites are not packed
+	virtual u32 getAtlasSize() const = 0;
+
 	//! Clears sprites, rectangles and textures
 	virtual void clear() = 0;
 
@@ -6,6 +6,7 @@
 #define __I_IMAGE_H_INCLUDED__
 
 #include "IReferenceCounted.h"
+#include "irrMemory.h"
 #include "position2d.h"
 #include "rect.h"
 #include "SColor.h"
@@ -16,12 +17,83 @@ namespace irr
 namespace video
 {
 
+//! Filters of IImage::copyToScalingFiltered()
+enum E_IMAGE_SCALING_FILTER
+{
+	//! Averages the source pixels covered by a target pixel, takes the nearest pixel when enlarging
+	EISF_BOX = 0,
+
+	//! Interpolates linearly, widened to a tent over the covered pixels when shrinking
+	EISF_BILINEAR,
+
+	//! Windowed sinc with 3 lobes, the sharpest and slowest filter
+	EISF_LANCZOS3
+};
+
+//! Flags of IImage::createMipMaps()
+enum E_MIP_MAP_FLAGS
+{
+	//! The colors of R8G8B8 and A8R8G8B8 images are sRGB coded and filtered in linear space
+	EMMF_SRGB = 0x1,
+
+	//! Scale the alpha of each level to keep the share of pixels passing the alpha reference
+	/** Keeps alpha tested cutouts like foliage from thinning out in the
+	distance. Only used for A8R8G8B8 images. */
+	EMMF_PRESERVE_ALPHA_COVERAGE = 0x2
+};
+
+//! Pixel of an ECF_R8G8B8 image
+struct SPixelR8G8B8
+{
+	u8 Red;
+	u8 Green;
+	u8 Blue;
+};
+
+//! Storage of one pixel of an uncompressed color format and its conversion to SColor
+/** Lets IImage::getRow() hand out typed pixels, so loops over a known
+format need neither a virtual call nor a switch per pixel. */
+template <ECOLOR_FORMAT format>
+struct SColorFormatPixel;
+
+template <>
+struct SColorFormatPixel<ECF_A1R5G5B5>
+{
+	typedef u16 Type;
+	static SColor toColor(Type pixel) { return A1R5G5B5toA8R8G8B8(pixel); }
+	static Type fromColor(const SColor& color) { return color.toA1R5G5B5(); }
+};
+
+template <>
+struct SColorFormatPixel<ECF_R5G6B5>
+{
+	typedef u16 Type;
+	static SColor toColor(Type pixel) { return R5G6B5toA8R8G8B8(pixel); }
+	static Type fromColor(const SColor& color) { return A8R8G8B8toR5G6B5(color.color); }
+};
+
+template <>
+struct SColorFormatPixel<ECF_R8G8B8>
+{
+	typedef SPixelR8G8B8 Type;
+	static SColor toColor(const Type& pixel) { return SColor(255, pixel.Red, pixel.Green, pixel.Blue); }
+	static Type fromColor(const SColor& color) { Type pixel = { (u8)color.getRed(), (u8)color.getGreen(), (u8)color.getBlue() }; return pixel; }
+};
+
+template <>
+struct SColorFormatPixel<ECF_A8R8G8B8>
+{
+	typedef u32 Type;
+	static SColor toColor(Type pixel) { return SColor(pixel); }
+	static Type fromColor(const SColor& color) { return color.color; }
+};
+
 //! Interface for software image data.
 /** Image loaders create these images from files. IVideoDrivers convert
 these images into their (hardware) textures.
 NOTE: Floating point formats are not well supported yet. Basically only getData() works for them.
 */
-class IImage : public virtual IReferenceCounted
+class IImage : public virtual IReferenceCounted, public core::CMemoryTagged<core::EMC_IMAGE>
 {
 public:
 
@@ -183,6 +255,19 @@ public:
 		return Data;
 	}
 
+	//! Get the pixels of a row, typed for the color format
+	/** Faster than getPixel() and setPixel() for whole rows, see
+	SColorFormatPixel for the supported formats.
+	\param y Row, 0 is the top one.
+	\return Pointer to getDimension().Width pixels. The template parameter
+	has to match getColorFormat(). */
+	template <ECOLOR_FORMAT format>
+	typename SColorFormatPixel<format>::Type* getRow(u32 y) const
+	{
+		_IRR_DEBUG_BREAK_IF(format != Format || y >= Size.Height)
+		return reinterpret_cast<typename SColorFormatPixel<format>::Type*>(Data + y * Pitch);
+	}
+
 	//! Lock function. Use this to get a pointer to the image data.
 	/** Use getData instead.
 	\return Pointer to the image data. What type of data is pointed to
@@ -358,6 +443,24 @@ public:
 	/**	NOTE: mipmaps are ignored */
 	virtual void copyToScalingBoxFilter(IImage* target, s32 bias = 0, bool blend = false) = 0;
 
+	//! copies this surface into another, resampling it to fit with a filter
+	/** Works on rows of all uncompressed formats except the depth formats,
+	the target may have another format. Large images are resampled on
+	several threads.
+	NOTE: mipmaps are ignored
+	\return False if a format isn't supported, the target is unchanged then. */
+	virtual bool copyToScalingFiltered(IImage* target, E_IMAGE_SCALING_FILTER filter = EISF_BILINEAR) = 0;
+
+	//! Replaces the mipmaps by ones box filtered from the image on the CPU
+	/** Each level is filtered from the one before. This doesn't touch
+	any driver, so it can run on a loading thread. Textures created from
+	the image upload the levels instead of letting the GPU create them.
+	\param flags Combination of E_MIP_MAP_FLAGS.
+	\param alphaReference Alpha test reference of EMMF_PRESERVE_ALPHA_COVERAGE, 0 to 1.
+	\return False for compressed formats, the depth formats and images
+	of 1x1 pixel, the mipmaps are unchanged then. */
+	virtual bool createMipMaps(u32 flags = 0, f32 alphaReference = 0.5f) = 0;
+
 	//! fills the surface with given color
 	virtual void fill(const SColor &color) =0;
 
@@ -408,6 +511,10 @@ public:
 		case ECF_ETC2_RGB:
 			return 24;
 		case ECF_ETC2_ARGB:
+		case ECF_BC7:
+		case ECF_ASTC_4x4:
+		case ECF_ASTC_6x6:
+		case ECF_ASTC_8x8:
 			return 32;
 		case ECF_D16:
 			return 16;
@@ -473,7 +580,15 @@ public:
 			imageSize = core::ceil32(width / 4.0f) * core::ceil32(height / 4.0f) * 8;
 			break;
 		case ECF_ETC2_ARGB:
-			imageSize = core::ceil32(width / 4.0f) * core::ceil32(height / 4.0f) * 16;
+		case ECF_BC7:
+		case ECF_ASTC_4x4:
+			imageSize = ((width + 3) / 4) * ((height + 3) / 4) * 16;
+			break;
+		case ECF_ASTC_6x6:
+			imageSize = ((width + 5) / 6) * ((height + 5) / 6) * 16;
+			break;
+		case ECF_ASTC_8x8:
+			imageSize = ((width + 7) / 8) * ((height + 7) / 8) * 16;
 			break;
 		default: // uncompressed formats
 			imageSize = getBitsPerPixelFromFormat(format) / 8 * width;
@@ -499,7 +614,11 @@ public:
 	case ECF_PVRTC2_ARGB4:\
 	case ECF_ETC1:\
 	case ECF_ETC2_RGB:\
-	case ECF_ETC2_ARGB:
+	case ECF_ETC2_ARGB:\
+	case ECF_BC7:\
+	case ECF_ASTC_4x4:\
+	case ECF_ASTC_6x6:\
+	case ECF_ASTC_8x8:
 
 	//! check if this is compressed color format
 	static bool isCompressedFormat(const ECOLOR_FORMAT format)
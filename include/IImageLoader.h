@@ -46,6 +46,37 @@ public:
 	\return Pointer to newly created image, or 0 upon error. */
 	virtual IImage* loadImage(io::IReadFile* file) const = 0;
 
+	//! Reads the size and color format of the image in the file, without decoding it
+	/** Only loaders which are able to decode into memory of the caller
+	implement this, see loadImageInto().
+	\param file File handle, at the start of the image.
+	\param size Receives the size loadImageInto() writes with the same scaleDenominator.
+	\param format Receives the color format loadImage() would create.
+	\param scaleDenominator Loaders which can reduce the size while decoding
+	(JPEG, by 2, 4 or 8) report the reduced size, others the full size.
+	\return True if the loader is able to decode the file with loadImageInto(). */
+	virtual bool getImageInfo(io::IReadFile* file, core::dimension2du& size, ECOLOR_FORMAT& format, u32 scaleDenominator = 1) const
+	{
+		return false;
+	}
+
+	//! Decodes the file straight into memory of the caller
+	/** Saves creating an IImage and converting it afterwards, e.g. when
+	decoding into a mapped pixel buffer or into the format of a texture.
+	Loaders implementing it write at least ECF_A8R8G8B8 and the format
+	returned by getImageInfo().
+	\param file File handle, at the start of the image.
+	\param data Receives the rows of the image, which has the size returned
+	by getImageInfo() for the same scaleDenominator.
+	\param pitch Bytes from the start of one row in data to the next.
+	\param format Color format to write.
+	\param scaleDenominator See getImageInfo().
+	\return True on success, false on errors or unsupported formats. */
+	virtual bool loadImageInto(io::IReadFile* file, void* data, u32 pitch, ECOLOR_FORMAT format, u32 scaleDenominator = 1) const
+	{
+		return false;
+	}
+
 	//! Creates a multiple surfaces from the file eg. whole cube map.
 	/** \param file File handle to check.
 	\param type Pointer to E_TEXTURE_TYPE where a recommended type of the texture will be stored.
@@ -20,6 +20,26 @@ namespace video
 {
 	class IImage;
 
+//! Bits of the param of IImageWriter::writeImage() for png files
+/** A zlib compression level combined with the row filters to try, e.g.
+3 | EPWP_FILTER_SUB | EPWP_ZLIB_RLE writes screenshots fast and still small.
+0 keeps the defaults of libpng. */
+enum E_PNG_WRITE_PARAM
+{
+	//! compression level 1 (fastest) to 9 (smallest), 0 for the zlib default
+	EPWP_LEVEL_MASK = 0xf,
+
+	//! Filters libpng chooses from for each row, all when none is set
+	EPWP_FILTER_NONE = 0x10,
+	EPWP_FILTER_SUB = 0x20,
+	EPWP_FILTER_UP = 0x40,
+	EPWP_FILTER_AVG = 0x80,
+	EPWP_FILTER_PAETH = 0x100,
+
+	//! Use the run length strategy of zlib, much faster for images with flat areas
+	EPWP_ZLIB_RLE = 0x200
+};
+
 
 //! Interface for writing software image data.
 class IImageWriter : public IReferenceCounted
@@ -38,6 +58,18 @@ public:
 	virtual bool writeImage(io::IWriteFile *file, IImage *image, u32 param = 0) const = 0;
 };
 
+//! Interface of an object which is told when an image of IVideoDriver::writeImageToFileAsync() is written
+class IImageWriteCallback
+{
+public:
+	virtual ~IImageWriteCallback() {}
+
+	//! Called by IVideoDriver::endScene() on the thread using the driver, after the file is closed
+	/** \param filename Name of the file passed to writeImageToFileAsync().
+	\param success True if the image was written. */
+	virtual void OnImageWritten(const io::path& filename, bool success) = 0;
+};
+
 } // namespace video
 } // namespace irr
 
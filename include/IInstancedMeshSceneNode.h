@@ -0,0 +1,60 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __I_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IMeshSceneNode.h"
+#include "S3DInstance.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! A scene node displaying many instances of a static mesh
+/** Instance transformations are relative to the node. Instances outside
+of the view frustum are skipped, the remaining ones are drawn with
+IVideoDriver::drawMeshBufferInstanced(), so the materials should use a
+shader which reads the instance attributes to get a single draw call per
+mesh buffer. */
+class IInstancedMeshSceneNode : public IMeshSceneNode
+{
+public:
+
+	//! Constructor
+	IInstancedMeshSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: IMeshSceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Adds an instance
+	/** \return Index of the new instance. */
+	virtual u32 addInstance(const video::S3DInstance& instance) = 0;
+
+	//! Replaces the data of an instance
+	virtual void setInstance(u32 index, const video::S3DInstance& instance) = 0;
+
+	//! Get the data of an instance
+	virtual const video::S3DInstance& getInstance(u32 index) const = 0;
+
+	//! Removes an instance
+	/** The last instance takes the place of the removed one. */
+	virtual void removeInstance(u32 index) = 0;
+
+	//! Removes all instances
+	virtual void clearInstances() = 0;
+
+	//! Get the number of instances
+	virtual u32 getInstanceCount() const = 0;
+
+	//! Get the number of instances which passed culling in the last rendered frame
+	virtual u32 getVisibleInstanceCount() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
@@ -0,0 +1,46 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_JOB_GRAPH_H_INCLUDED__
+#define __I_JOB_GRAPH_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+
+namespace irr
+{
+
+//! Jobs which start once the jobs they depend on are done
+/** Created by IJobScheduler::createJobGraph(). A graph can be run any
+number of times, the jobs keep their dependencies until clear(). */
+class IJobGraph : public virtual IReferenceCounted
+{
+public:
+	//! Function a job runs with the data it was added with
+	typedef void (*JobFunction)(void* data);
+
+	//! Adds a job
+	/** \param function Function the job runs.
+	\param data Passed to the function.
+	\param dependencies Indices of jobs which have to be done before this
+	one starts. Only jobs added before can be named, so a graph has no
+	cycles.
+	\param dependencyCount Number of indices in dependencies.
+	\return Index of the job, used by later jobs to depend on it. */
+	virtual u32 addJob(JobFunction function, void* data,
+		const u32* dependencies=0, u32 dependencyCount=0) = 0;
+
+	//! Number of jobs in the graph
+	virtual u32 getJobCount() const = 0;
+
+	//! Runs all jobs of the graph
+	/** The calling thread runs jobs as well until the whole graph is
+	done. Must not be called while the graph is running. */
+	virtual void run() = 0;
+
+	//! Removes all jobs
+	virtual void clear() = 0;
+};
+
+} // end namespace irr
+
+#endif
@@ -0,0 +1,72 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_JOB_SCHEDULER_H_INCLUDED__
+#define __I_JOB_SCHEDULER_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "IJobGraph.h"
+
+namespace irr
+{
+
+//! Thread pool shared by the engine and the application
+/** Owned by the IrrlichtDevice, see IrrlichtDevice::getJobScheduler().
+Every worker has a queue of its own and steals from the others when it
+runs out of jobs. A thread waiting for its jobs, like the one calling
+parallelFor() or IJobGraph::run(), runs queued jobs meanwhile, so jobs
+may wait for jobs of their own without blocking a worker. */
+class IJobScheduler : public virtual IReferenceCounted
+{
+public:
+	//! Function a job runs with the data it was added with
+	typedef void (*JobFunction)(void* data);
+
+	//! Function running the indices from begin to end - 1 of a parallelFor()
+	typedef void (*RangeFunction)(void* data, u32 begin, u32 end);
+
+	//! Number of worker threads
+	/** The thread waiting for the jobs helps besides them, so work is
+	best split into at least getWorkerCount() + 1 parts. */
+	virtual u32 getWorkerCount() const = 0;
+
+	//! Runs a function over the indices from 0 to count - 1 and returns when all are done
+	/** \param count Number of indices.
+	\param grainSize Indices each call of the function gets at most, 0
+	splits the range into a few parts for each thread.
+	\param function Called with ranges of indices, from several threads
+	at the same time.
+	\param data Passed to the function. */
+	virtual void parallelFor(u32 count, u32 grainSize, RangeFunction function, void* data) = 0;
+
+	//! Creates an empty job graph
+	/** \return The graph. Drop it when done, see
+	IReferenceCounted::drop() for more information. */
+	virtual IJobGraph* createJobGraph() = 0;
+
+	//! Queues a job for the thread calling IrrlichtDevice::run()
+	/** Results of background work which have to touch the scene or the
+	video driver are handed over this way. Can be called from any thread,
+	the jobs run in the order they were added at the start of the next
+	IrrlichtDevice::run(). */
+	virtual void addMainThreadJob(JobFunction function, void* data) = 0;
+
+	//! Runs the jobs queued by addMainThreadJob()
+	/** Called by IrrlichtDevice::run(), applications without a run loop
+	can call it themselves.
+	\return Number of jobs run. */
+	virtual u32 runMainThreadJobs() = 0;
+
+	//! Scratch memory of the calling thread
+	/** Each thread has memory of its own, which a job can use without
+	locking or allocating again. The memory is the same for all jobs on
+	a thread, so it must not be kept after the job returns or across
+	waiting for other jobs.
+	\param size Bytes needed.
+	\return Memory of at least size bytes. */
+	virtual void* getScratchMemory(u32 size) = 0;
+};
+
+} // end namespace irr
+
+#endif
@@ -0,0 +1,46 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_LIGHT_SCENE_NODE_H_INCLUDED__
+#define __I_LIGHT_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "ELightClusterTextures.h"
+#include "SColor.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! A dynamic point light
+/** The lights in the view of the camera are binned into the clusters of its
+frustum each frame, so shaders only evaluate the lights near a fragment. No
+built-in material uses them, shaders read them from the textures of
+ISceneManager::getLightClusterTexture(). */
+class ILightSceneNode : public ISceneNode
+{
+public:
+
+	//! constructor
+	ILightSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id=-1,
+		const core::vector3df& position = core::vector3df(0,0,0))
+		: ISceneNode(parent, mgr, id, position) {}
+
+	//! Sets the color of the light
+	virtual void setColor(const video::SColorf& color) = 0;
+
+	//! Returns the color of the light
+	virtual const video::SColorf& getColor() const = 0;
+
+	//! Sets the distance at which the light has no effect anymore
+	virtual void setRadius(f32 radius) = 0;
+
+	//! Returns the distance at which the light has no effect anymore
+	virtual f32 getRadius() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -15,6 +15,62 @@ namespace video
 
 class IVideoDriver;
 
+//! Uniform blocks which are filled by the driver if a shader declares them
+/** GLSL declaration of the blocks:
+\code
+layout(std140) uniform IrrFrameData
+{
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	vec4 uFogColor;
+	vec4 uFogParams; // start, end, density, E_FOG_TYPE
+	vec4 uAmbientLight;
+};
+
+layout(std140) uniform IrrDrawData
+{
+	mat4 uWorld;
+	mat4 uWorldView;
+	mat4 uWorldViewProjection;
+};
+\endcode */
+enum E_BUILT_IN_UNIFORM_BLOCK
+{
+	//! Updated when the view, projection, fog or ambient light change
+	EUB_FRAME = 0,
+	//! Updated when the world transformation changes
+	EUB_DRAW,
+	EUB_COUNT
+};
+
+//! Names of the built-in uniform blocks as used in shaders
+const char* const sBuiltInUniformBlockNames[] =
+{
+	"IrrFrameData",
+	"IrrDrawData",
+	0
+};
+
+//! Contents of the IrrFrameData uniform block
+struct SFrameUniformBlock
+{
+	f32 View[16];
+	f32 Projection[16];
+	f32 ViewProjection[16];
+	f32 FogColor[4];
+	f32 FogParams[4];
+	f32 AmbientLight[4];
+};
+
+//! Contents of the IrrDrawData uniform block
+struct SDrawUniformBlock
+{
+	f32 World[16];
+	f32 WorldView[16];
+	f32 WorldViewProjection[16];
+};
+
 
 //! Interface providing some methods for changing advanced, internal states of a IVideoDriver.
 class IMaterialRendererServices
@@ -115,6 +171,21 @@ public:
 	\param constantAmount Amount of registers to be set. One register consists of 4 floats. */
 	virtual void setPixelShaderConstant(const f32* data, s32 startRegister, s32 constantAmount=1) = 0;
 
+	//! Return an index for a uniform block of the shader based on a name.
+	/** Only available if the driver supports EVDF_UNIFORM_BLOCKS.
+	\return Index of the block, -1 if the shader has no such block. */
+	virtual s32 getUniformBlockID(const c8* name) { return -1; }
+
+	//! Sets the contents of a uniform block.
+	/** All uniforms of the block are uploaded with a single call. The
+	built-in blocks (E_BUILT_IN_UNIFORM_BLOCK) are owned by the driver and
+	can't be set.
+	\param index Index of the block, see getUniformBlockID()
+	\param data Block contents in std140 layout
+	\param size Size of data in bytes, at most the size of the block
+	\return True if successful. */
+	virtual bool setUniformBlock(s32 index, const void* data, u32 size) { return false; }
+
 	//! \deprecated. This method may be removed by Irrlicht 2.0
 	_IRR_DEPRECATED_ bool setVertexShaderConstant(const c8* name, const f32* floats, int count)
 	{
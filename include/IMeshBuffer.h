@@ -8,6 +8,7 @@
 #include "IReferenceCounted.h"
 #include "SMaterial.h"
 #include "aabbox3d.h"
+#include "matrix4.h"
 #include "S3DVertex.h"
 #include "SVertexIndex.h"
 #include "EHardwareBufferFlags.h"
@@ -17,6 +18,21 @@ namespace irr
 {
 namespace scene
 {
+	class IMeshBuffer;
+
+	//! Link of a mesh buffer to the hardware buffer a video driver created for it
+	/** The mesh buffer keeps the link with IMeshBuffer::setHWBuffer() and
+	tells it when it is destroyed, so the driver doesn't have to hold a
+	reference to the mesh buffer to find out when the hardware buffer can go. */
+	class IHardwareBufferLink
+	{
+	public:
+		virtual ~IHardwareBufferLink() {}
+
+		//! Called from the destructor of the mesh buffer which keeps the link
+		virtual void onMeshBufferDestroyed(const IMeshBuffer* mb) = 0;
+	};
+
 	//! Struct for holding a mesh with a single material.
 	/** A part of an IMesh which has the same material on each face of that
 	group. Logical groups of an IMesh need not be put into separate mesh
@@ -146,8 +162,10 @@ namespace scene
 		virtual u32 getChangedID_Index() const = 0;
 
 		//! Used by the VideoDriver to remember the buffer link.
-		virtual void setHWBuffer(void *ptr) const = 0;
-		virtual void *getHWBuffer() const = 0;
+		/** Implementations call IHardwareBufferLink::onMeshBufferDestroyed()
+		from their destructor when a link is set. */
+		virtual void setHWBuffer(IHardwareBufferLink *ptr) const = 0;
+		virtual IHardwareBufferLink *getHWBuffer() const = 0;
 
 		//! Describe what kind of primitive geometry is used by the meshbuffer
 		/** Note: Default is EPT_TRIANGLES. Using other types is fine for rendering.
@@ -180,6 +198,117 @@ namespace scene
 			return 0;
 		}
 
+		//! Get the joint matrices for hardware skinning
+		/** Vertices of type video::EVT_SKINNED are moved by the matrices
+		their joint indices refer to.
+		\param count Receives the number of matrices.
+		\return Pointer to the matrices, or 0 if the buffer isn't skinned
+		by the driver. */
+		virtual const core::matrix4* getJointMatrices(u32& count) const
+		{
+			count = 0;
+			return 0;
+		}
+
+		//! Removes the vertices from the given index on
+		/** The indices aren't changed, so they must not refer to the
+		removed vertices anymore.
+		\param count New number of vertices, not larger than the current one.
+		\return False if the buffer can't remove vertices. */
+		virtual bool truncateVertices(u32 count)
+		{
+			return false;
+		}
+
+		//! Flags a range of vertices or indices as changed
+		/** Like setDirty(), but drivers which uploaded the buffer a few
+		changes ago then only upload the changed ranges again. Call
+		setDirty() instead when the number of vertices or indices changed.
+		\param first Index of the first changed vertex or index.
+		\param count Number of changed vertices or indices.
+		\param buffer Which of the buffers changed. */
+		virtual void setDirtyRange(u32 first, u32 count, E_BUFFER_TYPE buffer=EBT_VERTEX)
+		{
+			setDirty(buffer);
+		}
+
+		//! Get the range of vertices or indices changed since an earlier change ID
+		/** This shouldn't be used for anything outside the VideoDriver.
+		\param changedID Change ID the driver uploaded the buffer at, see getChangedID_Vertex().
+		\param first Receives the first changed vertex or index.
+		\param count Receives the number of vertices or indices from first on to upload.
+		\param buffer EBT_VERTEX or EBT_INDEX.
+		\return False if the whole buffer has to be uploaded. */
+		virtual bool getDirtyRange(u32 changedID, u32& first, u32& count, E_BUFFER_TYPE buffer) const
+		{
+			return false;
+		}
+
+		//! Set if the driver may keep the vertices quantized in its hardware buffer
+		/** The OpenGL 3 driver then stores video::EVT_STANDARD vertices as
+		video::S3DVertexCompact, with the positions relative to the box around
+		the vertices. This takes 20 instead of 36 bytes per vertex, while
+		positions move by up to 1/131070 of the box size. Only has an effect
+		with a vertex hardware mapping hint other than EHM_NEVER.
+		Shader materials without a compact variant are drawn from the vertices
+		of the buffer instead. */
+		virtual void setCompactVertices(bool compact) {}
+
+		//! Get if the driver may keep the vertices quantized in its hardware buffer
+		virtual bool getCompactVertices() const
+		{
+			return false;
+		}
+
+		//! Set if the driver keeps each vertex attribute in a stream of its own
+		/** The OpenGL 3 driver then stores all positions of its hardware
+		buffer one after another, followed by all normals and so on, instead
+		of whole vertices. Draws with video::ECP_NONE as color mask and the
+		video::EMT_SOLID material, like depth and shadow passes, then only
+		fetch the positions. Only has an effect with a vertex hardware mapping
+		hint other than EHM_NEVER, and not together with compact vertices. */
+		virtual void setSeparateVertexStreams(bool separate) {}
+
+		//! Get if the driver keeps each vertex attribute in a stream of its own
+		virtual bool getSeparateVertexStreams() const
+		{
+			return false;
+		}
+
+		//! Set if the vertices and indices are freed once they are in a static hardware buffer
+		/** Spares the copy of static meshes in system memory. The OpenGL 3
+		driver frees them after the first complete upload of a buffer with the
+		EHM_STATIC hint for both vertices and indices, and gives them back
+		before it removes the hardware buffer. While they are freed, only the
+		counts, the bounding box and the material are valid: the buffer can't
+		be used for collision, picking or mesh manipulation, and changes are
+		not uploaded. */
+		virtual void setGPUOnly(bool gpuOnly) {}
+
+		//! Get if the vertices and indices are freed once they are in a static hardware buffer
+		virtual bool getGPUOnly() const
+		{
+			return false;
+		}
+
+		//! Frees the vertices and indices of a GPU only buffer, used by the VideoDriver
+		/** \return True if they were freed. */
+		virtual bool releaseClientData()
+		{
+			return false;
+		}
+
+		//! Get if the vertices and indices were freed by releaseClientData()
+		virtual bool isClientDataReleased() const
+		{
+			return false;
+		}
+
+		//! Gives back the vertices and indices freed by releaseClientData(), used by the VideoDriver
+		/** \param vertices getVertexCount() vertices of getVertexType().
+		\param indices getIndexCount() indices of getIndexType(). */
+		virtual void restoreClientData(const void* vertices, const void* indices) {}
+
 	};
 
 } // end namespace scene
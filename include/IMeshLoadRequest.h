@@ -0,0 +1,41 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_MESH_LOAD_REQUEST_H_INCLUDED__
+#define __I_MESH_LOAD_REQUEST_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IAnimatedMesh;
+
+//! Handle of a mesh which is loaded on a background thread.
+/** Created by ISceneManager::getMeshAsync(). The file is parsed by the mesh
+loaders on a background thread. The mesh is added to the mesh cache on the
+thread drawing the scene, during a later ISceneManager::drawAll(). After that
+isReady() returns true and getMesh() returns the mesh. */
+class IMeshLoadRequest : public virtual IReferenceCounted
+{
+public:
+	//! Check if the mesh is loaded and in the mesh cache
+	/** Can be called from any thread. */
+	virtual bool isReady() const = 0;
+
+	//! Check if loading failed
+	/** A failed request is never ready. */
+	virtual bool isFailed() const = 0;
+
+	//! Get the loaded mesh
+	/** \return The mesh, or 0 if the request isn't ready yet. This pointer
+	should not be dropped, the mesh is owned by the mesh cache like the ones
+	returned by ISceneManager::getMesh(). */
+	virtual IAnimatedMesh* getMesh() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
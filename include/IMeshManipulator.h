@@ -20,6 +20,25 @@ namespace scene
 
 	struct SMesh;
 
+	//! Steps of IMeshManipulator::optimizeMesh()
+	enum E_MESH_OPTIMIZATION
+	{
+		//! Merge vertices which are exactly equal
+		EMO_WELD_VERTICES = 0x1,
+
+		//! Order the triangles for the post transform vertex cache (Forsyth)
+		EMO_VERTEX_CACHE = 0x2,
+
+		//! Order clusters of triangles from the outside in, to reduce overdraw
+		EMO_OVERDRAW = 0x4,
+
+		//! Order the vertices by their first use, for the vertex fetch
+		EMO_VERTEX_FETCH = 0x8,
+
+		//! All of the above
+		EMO_ALL = 0xf
+	};
+
 	//! An interface for easy manipulation of meshes.
 	/** Scale, set alpha value, flip surfaces, and so on. This exists for
 	fixing problems with wrong imported or exported meshes quickly after
@@ -69,6 +88,68 @@ namespace scene
 		IReferenceCounted::drop() for more information. */
 		virtual SMesh* createMeshCopy(IMesh* mesh) const = 0;
 
+		//! Merges meshes into few large buffers, for drawing static geometry with few draw calls.
+		/** The vertices of each mesh are transformed, normals with the
+		inverse transposed transformation, tangents and binormals with the
+		transformation itself. Buffers with equal material and vertex type
+		are merged, with a new buffer begun where one would exceed the 65536
+		vertices 16 bit indices can reach. Only triangle lists of standard,
+		light map and tangent vertices are merged.
+		\param meshes Meshes to merge, 0 entries are left out.
+		\param transforms Transformation of each mesh into the space of the
+		merged mesh.
+		\param materials Materials to use instead of those of the mesh
+		buffers, one for each buffer of each mesh in order, for example the
+		materials of the scene nodes displaying them. Empty to use those of
+		the buffers.
+		\return Merged mesh. If you no longer need it, you should call
+		SMesh::drop(). */
+		virtual SMesh* createMergedMesh(const core::array<IMesh*>& meshes,
+				const core::array<core::matrix4>& transforms,
+				const core::array<video::SMaterial>& materials=core::array<video::SMaterial>()) const = 0;
+
+		//! Reorders and welds the vertices and triangles of a mesh for faster rendering.
+		/** The steps run in the order of E_MESH_OPTIMIZATION. The vertex
+		steps are left out for skinned meshes, as their weights refer to
+		the vertices. Only triangle lists with 16 bit indices are changed.
+		\param mesh Mesh on which the operation is performed.
+		\param flags Steps to run, a combination of E_MESH_OPTIMIZATION. */
+		virtual void optimizeMesh(IMesh* mesh, u32 flags=EMO_ALL) const = 0;
+
+		//! Reorders and welds the vertices and triangles of a mesh buffer for faster rendering.
+		/** Unused vertices are only removed if
+		IMeshBuffer::truncateVertices() supports it, otherwise they are moved
+		to the end. Don't pass EMO_WELD_VERTICES or EMO_VERTEX_FETCH for
+		buffers of skinned meshes.
+		\param buffer Mesh buffer on which the operation is performed.
+		\param flags Steps to run, a combination of E_MESH_OPTIMIZATION. */
+		virtual void optimizeMeshBuffer(IMeshBuffer* buffer, u32 flags=EMO_ALL) const = 0;
+
+		//! Creates a copy of a mesh with fewer triangles.
+		/** Vertices are collapsed into their neighbours in the order of the
+		smallest quadric error, after Garland and Heckbert. The borders of
+		the surface and vertices at the same position with different
+		attributes, like texture seams, stay in place, so the buffers
+		can't always be reduced as far as asked for. Each buffer keeps its
+		material. Only triangle lists with 16 bit indices are simplified,
+		other buffers are copied.
+		\param mesh Mesh to simplify.
+		\param ratio Fraction of the triangles to keep, between 0 and 1.
+		\return Simplified mesh, 0 if mesh was 0. If you no longer need
+		it, you should call SMesh::drop(). */
+		virtual SMesh* createSimplifiedMesh(IMesh* mesh, f32 ratio) const = 0;
+
+		//! Creates meshes of decreasing detail for IMeshSceneNode::setLODMeshes().
+		/** \param mesh Mesh of full detail.
+		\param lods Receives the levelCount simplified meshes, level i
+		has about reduction^(i+1) of the triangles of mesh. You should
+		drop them when you no longer need them.
+		\param levelCount Number of meshes to create.
+		\param reduction Fraction of the triangles each level keeps from
+		the one before. */
+		virtual void createLODChain(IMesh* mesh, core::array<IMesh*>& lods,
+				u32 levelCount, f32 reduction=0.5f) const = 0;
+
 		//! Get amount of polygons in mesh.
 		/** \param mesh Input mesh
 		\return Number of polygons in mesh. */
@@ -165,6 +246,15 @@ protected:
 						func(verts[i]);
 					}
 					break;
+				case video::EVT_SKINNED:
+					{
+						video::S3DVertexSkinned* verts = (video::S3DVertexSkinned*)buffer->getVertices();
+						func(verts[i]);
+					}
+					break;
+				// compact vertices are only kept by the drivers
+				case video::EVT_COMPACT:
+					break;
 				}
 				if (boundingBoxUpdate)
 				{
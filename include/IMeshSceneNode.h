@@ -47,6 +47,53 @@ public:
 	/** This flag can be set by setReadOnlyMaterials().
 	\return Whether the materials are read-only. */
 	virtual bool isReadOnlyMaterials() const = 0;
+
+	//! Sets meshes of less detail, drawn when the node gets small on screen
+	/** The size on screen is the diameter of the bounding sphere of the
+	node relative to the screen height, projected by the active camera.
+	The levels are drawn with the materials of the node, so each of them
+	needs as many mesh buffers as the mesh. setMesh() removes the levels.
+	\param meshes Meshes of decreasing detail, for example from
+	IMeshManipulator::createLODChain(). Pass an empty array to always draw
+	the mesh.
+	\param screenSizes For each mesh, the size on screen below which it is
+	drawn, decreasing.
+	\param hysteresis Fraction by which the size has to pass a screen size
+	before the level changes, so nodes near it don't switch every frame. */
+	virtual void setLODMeshes(const core::array<IMesh*>& meshes,
+			const core::array<f32>& screenSizes, f32 hysteresis=0.1f) {}
+
+	//! Get the level of detail chosen in the last frame
+	/** \return 0 for the mesh, i for meshes[i-1] of setLODMeshes(). */
+	virtual u32 getCurrentLOD() const { return 0; }
+
+	//! Set a quad with a prerendered view of the mesh, drawn instead of it when far away
+	/** Beyond the distance, the node is drawn as a quad turning around its
+	Y axis to face the camera. It shows the view closest to the direction of
+	the camera and is drawn together with the quads of all billboards.
+	Shadows are still cast by the mesh.
+	\param texture Views of the mesh of this node from
+	ISceneManager::createImpostorTexture(), 0 to draw the mesh at any
+	distance. It isn't grabbed, keep it in the texture cache.
+	\param views Number of views in the texture.
+	\param distance Distance from the camera to the center of the bounding
+	box beyond which the quad is drawn. */
+	virtual void setImpostor(video::ITexture* texture, u32 views, f32 distance) {}
+
+	//! Check if the quad was drawn instead of the mesh in the last frame
+	virtual bool isImpostorVisible() const { return false; }
+
+	//! Sets a simplified mesh used when the node is an occluder
+	/** With EAC_OCCLUDER in the automatic culling of the node, this mesh
+	is rasterized to hide other nodes. It should have few triangles and lie
+	completely inside the displayed mesh, else nodes which should be visible
+	may be culled.
+	\param mesh Occluder mesh, 0 to use the displayed mesh. */
+	virtual void setOccluderMesh(IMesh* mesh) {}
+
+	//! Get the mesh rasterized when the node is an occluder
+	/** \return The mesh set by setOccluderMesh(), else the displayed mesh. */
+	virtual const IMesh* getOccluderMesh() const { return 0; }
 };
 
 } // end namespace scene
@@ -0,0 +1,128 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_POST_PROCESS_CHAIN_H_INCLUDED__
+#define __I_POST_PROCESS_CHAIN_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include "SMaterial.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Special sources of the inputs of post-processing passes
+enum E_POST_PROCESS_SOURCE
+{
+	//! The color of the scene drawn between IPostProcessChain::begin() and end()
+	EPPS_SCENE = -1,
+
+	//! The depth of the scene drawn between IPostProcessChain::begin() and end()
+	EPPS_SCENE_DEPTH = -2,
+
+	//! No input, the texture of the material layer is kept
+	EPPS_NONE = -3
+};
+
+//! A chain of full screen shader passes, drawn after the scene
+/** The scene is drawn into a render target texture between begin() and end().
+end() then draws each pass as a single triangle covering its target, with
+the outputs of earlier passes as textures. The last pass draws into the
+render target which was active at begin(), usually the screen.
+
+The scene and the intermediate textures are drawn into render targets lent
+from the transient pool of the driver, see
+IVideoDriver::acquireTransientRenderTarget(). Each one goes back to the pool
+right after the last pass reading it, so a chain of any length usually
+ping-pongs between two targets.
+
+The vertices of the triangle are given in clip space, with the world, view
+and projection transformations set to identity. Their texture coordinates
+run from 0,0 at the left bottom to 1,1 at the right top of the target, which
+matches the render target textures. Create the chain with
+IVideoDriver::createPostProcessChain(), and draw it with the scene by
+ISceneManager::setPostProcessChain().
+
+With setDynamicResolution() the scene is drawn at a lower resolution while
+the GPU can't keep up, and the last pass upscales it. Since the scene
+manager ends the chain before the GUI scene nodes, and the GUI environment
+is drawn afterwards, the GUI stays at the full resolution. */
+class IPostProcessChain : public virtual IReferenceCounted
+{
+public:
+
+	//! Appends a pass
+	/** The pass reads the output of the previous pass, or the scene for the
+	first pass, as its first texture. Its material has no depth test and
+	no culling, change it with getPassMaterial().
+	\param materialType Material type drawing the pass, usually a shader
+	of IGPUProgrammingServices.
+	\param scale Size of the output relative to the scene, for blurs and
+	other effects working on fewer pixels. Ignored for the last pass.
+	\param format Color format of the output.
+	\return Index of the pass. */
+	virtual u32 addPass(s32 materialType, f32 scale = 1.f, ECOLOR_FORMAT format = ECF_A8R8G8B8) = 0;
+
+	//! Returns the number of passes
+	virtual u32 getPassCount() const = 0;
+
+	//! Removes all passes
+	virtual void removeAllPasses() = 0;
+
+	//! Sets the texture a pass reads in a texture layer of its material
+	/** \param pass Index of the pass.
+	\param layer Texture layer of the material, below MATERIAL_MAX_TEXTURES.
+	\param source Index of an earlier pass, or one of E_POST_PROCESS_SOURCE. */
+	virtual void setPassInput(u32 pass, u32 layer, s32 source) = 0;
+
+	//! Returns the material of a pass
+	/** The textures of the layers with inputs are replaced while drawing. */
+	virtual SMaterial& getPassMaterial(u32 pass) = 0;
+
+	//! Sets the color format of the scene texture, ECF_A8R8G8B8 by default
+	virtual void setSceneFormat(ECOLOR_FORMAT format) = 0;
+
+	//! Sets the color the scene texture is cleared to by begin()
+	virtual void setClearColor(SColor color) = 0;
+
+	//! Lets the resolution of the scene follow the GPU time of the frames
+	/** The GPU time is the sum of the outermost scopes of
+	IVideoDriver::getGPUTimerResults(), which includes the "scene" scope
+	of the scene manager. Once it exceeds the target, the scene resolution
+	is lowered in steps of 5 percent. It is raised again once the time is
+	well below the target, and after each change the measurements of a few
+	frames are skipped, so it doesn't flip between two sizes. Needs a
+	driver supporting EVDF_TIMER_QUERY, otherwise the scale stays at its
+	maximum.
+
+	The scene texture and the outputs of the passes shrink with the scale,
+	and the last pass draws into the full viewport, which upscales the
+	scene with the bilinear filter of its input. Use a sharpening shader
+	for the last pass to get a crisper result. Without passes the chain
+	then draws an upscaling pass of its own.
+	\param milliseconds GPU time per frame to stay below, 0 to always
+	draw at the full resolution.
+	\param minScale Lowest scale of the scene resolution.
+	\param maxScale Highest scale of the scene resolution. */
+	virtual void setDynamicResolution(f32 milliseconds, f32 minScale = 0.5f, f32 maxScale = 1.f) = 0;
+
+	//! Returns the scale the scene is currently drawn at, 1 without dynamic resolution
+	virtual f32 getResolutionScale() const = 0;
+
+	//! Redirects the drawing into the cleared scene texture
+	/** Does nothing and returns false if there are no passes and no
+	dynamic resolution, or the driver has no render targets. */
+	virtual bool begin() = 0;
+
+	//! Draws the passes and restores the render target of begin()
+	virtual void end() = 0;
+
+	//! Checks if begin() was called without end() yet
+	virtual bool isActive() const = 0;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -0,0 +1,51 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_PROFILER_H_INCLUDED__
+#define __I_PROFILER_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace io
+{
+	class IWriteFile;
+} // end namespace io
+
+//! Records the time spent in the profiling zones of the engine
+/** The zones cover the phases of ISceneManager::drawAll(), skinning,
+mesh and texture loading, gui drawing, draw calls of the OpenGL 3 driver
+and decompression of zip archives. They only exist when the engine is
+built with the ENABLE_PROFILER CMake option, see
+IrrlichtDevice::getProfiler(). Every thread records into a buffer of its
+own without locking, which keeps the latest zones when it's full. */
+class IProfiler
+{
+public:
+
+	//! Destructor
+	virtual ~IProfiler() {}
+
+	//! Starts or stops recording the zones
+	/** Disabled by default. A disabled zone costs a single atomic load. */
+	virtual void setEnabled(bool enabled) = 0;
+
+	//! Returns if the zones are recorded
+	virtual bool isEnabled() const = 0;
+
+	//! Forgets all zones recorded so far
+	virtual void clear() = 0;
+
+	//! Writes the recorded zones as Chrome trace event JSON
+	/** The file can be opened with chrome://tracing or Perfetto, which
+	show the zones of each thread nested by time.
+	\param file File to write to.
+	\return True if everything was written. */
+	virtual bool writeChromeTrace(io::IWriteFile* file) const = 0;
+};
+
+} // end namespace irr
+
+#endif
@@ -6,6 +6,7 @@
 #define __I_READ_FILE_H_INCLUDED__
 
 #include "IReferenceCounted.h"
+#include "irrMemory.h"
 #include "coreutil.h"
 #include "EReadFileType.h"
 
@@ -15,7 +16,7 @@ namespace io
 {
 
 	//! Interface providing read access to a file.
-	class IReadFile : public virtual IReferenceCounted
+	class IReadFile : public virtual IReferenceCounted, public core::CMemoryTagged<core::EMC_IO>
 	{
 	public:
 		//! Reads an amount of bytes from the file.
@@ -32,6 +33,23 @@ namespace io
 		\return True if successful, otherwise false. */
 		virtual bool seek(long finalPos, bool relativeMovement = false) = 0;
 
+		//! Reads an amount of bytes from a position of the file
+		/** Doesn't use or change the position of read() and seek(). Files on
+		disk, in memory and the uncompressed files of archives can be read
+		from several threads at once by this, which share the file handle of
+		their archive. Other files seek and read, they have to be used by one
+		thread at a time.
+		\param offset Position in the file to read from.
+		\param buffer Pointer to buffer where read bytes are written to.
+		\param sizeToRead Amount of bytes to read from the file.
+		\return How many bytes were read. */
+		virtual size_t readAt(long offset, void* buffer, size_t sizeToRead)
+		{
+			if (!seek(offset))
+				return 0;
+			return read(buffer, sizeToRead);
+		}
+
 		//! Get size of file.
 		/** \return Size of the file in bytes. */
 		virtual long getSize() const = 0;
@@ -6,6 +6,7 @@
 #define __I_IREFERENCE_COUNTED_H_INCLUDED__
 
 #include "irrTypes.h"
+#include <atomic>
 
 namespace irr
 {
@@ -37,6 +38,13 @@ namespace irr
 	You will not have to drop the pointer to the loaded texture, because
 	the name of the method does not start with 'create'. The texture
 	is stored somewhere by the driver.
+
+	grab() and drop() are not thread-safe by default, which keeps them as
+	cheap as a plain increment. Objects which are grabbed and dropped on
+	several threads call setThreadSafeReferenceCounting(). Defining
+	IRR_THREADSAFE_REFERENCE_COUNTING (the ENABLE_THREADSAFE_REFCOUNT
+	CMake option) makes this the default for all objects.
+	core::ref_ptr from irrRefPtr.h does the grab() and drop() calls for you.
 	*/
 	class IReferenceCounted
 	{
@@ -44,7 +52,12 @@ namespace irr
 
 		//! Constructor.
 		IReferenceCounted()
-			: DebugName(0), ReferenceCounter(1)
+			: DebugName(0), ReferenceCounter(1),
+#ifdef IRR_THREADSAFE_REFERENCE_COUNTING
+			ThreadSafe(true)
+#else
+			ThreadSafe(false)
+#endif
 		{
 		}
 
@@ -83,7 +96,13 @@ namespace irr
 		You will not have to drop the pointer to the loaded texture,
 		because the name of the method does not start with 'create'.
 		The texture is stored somewhere by the driver. */
-		void grab() const { ++ReferenceCounter; }
+		void grab() const
+		{
+			if (ThreadSafe)
+				ReferenceCounter.fetch_add(1, std::memory_order_relaxed);
+			else
+				ReferenceCounter.store(ReferenceCounter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
 
 		//! Drops the object. Decrements the reference counter by one.
 		/** The IReferenceCounted class provides a basic reference
@@ -116,10 +135,23 @@ namespace irr
 		bool drop() const
 		{
 			// someone is doing bad reference counting.
-			_IRR_DEBUG_BREAK_IF(ReferenceCounter <= 0)
+			_IRR_DEBUG_BREAK_IF(getReferenceCount() <= 0)
+
+			s32 count;
+			if (ThreadSafe)
+			{
+				count = ReferenceCounter.fetch_sub(1, std::memory_order_release) - 1;
+				// see all writes of the other threads before destroying
+				if (!count)
+					std::atomic_thread_fence(std::memory_order_acquire);
+			}
+			else
+			{
+				count = ReferenceCounter.load(std::memory_order_relaxed) - 1;
+				ReferenceCounter.store(count, std::memory_order_relaxed);
+			}
 
-			--ReferenceCounter;
-			if (!ReferenceCounter)
+			if (!count)
 			{
 				delete this;
 				return true;
@@ -132,7 +164,25 @@ namespace irr
 		/** \return Current value of the reference counter. */
 		s32 getReferenceCount() const
 		{
-			return ReferenceCounter;
+			return ReferenceCounter.load(std::memory_order_relaxed);
+		}
+
+		//! Makes grab() and drop() of this object atomic.
+		/** Needed when the object is grabbed or dropped on more than one
+		thread, e.g. a request handed to a worker thread. Costs an atomic
+		instruction per grab() and drop(), so it is off by default unless
+		IRR_THREADSAFE_REFERENCE_COUNTING is defined. Must be set before
+		the object is shared with another thread.
+		\param enable: True for atomic reference counting. */
+		void setThreadSafeReferenceCounting(bool enable)
+		{
+			ThreadSafe = enable;
+		}
+
+		//! Returns if grab() and drop() of this object are atomic.
+		bool isThreadSafeReferenceCounting() const
+		{
+			return ThreadSafe;
 		}
 
 		//! Returns the debug name of the object.
@@ -161,7 +211,13 @@ namespace irr
 		const c8* DebugName;
 
 		//! The reference counter. Mutable to do reference counting on const objects.
-		mutable s32 ReferenceCounter;
+		/** Always atomic, but only updated with read-modify-write operations
+		when ThreadSafe is set, otherwise relaxed loads and stores compile to
+		the same code as a plain s32. */
+		mutable std::atomic<s32> ReferenceCounter;
+
+		//! If grab() and drop() use atomic read-modify-write operations.
+		bool ThreadSafe;
 	};
 
 } // end namespace irr
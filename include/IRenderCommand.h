@@ -0,0 +1,32 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_RENDER_COMMAND_H_INCLUDED__
+#define __I_RENDER_COMMAND_H_INCLUDED__
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+
+//! Interface of drawing work which is run on the render thread of a driver
+/** See IVideoDriver::setRenderThreadEnabled(). A command should draw from
+data it owns, like a copy of the positions of the last simulated frame,
+because the thread which queued it already works on the next frame while
+the command runs. */
+class IRenderCommand
+{
+public:
+	virtual ~IRenderCommand() {}
+
+	//! Called on the thread which owns the rendering context
+	/** \param driver The driver to draw with. Only commands may use it
+	while the render thread runs. */
+	virtual void execute(IVideoDriver* driver) = 0;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -32,7 +32,7 @@ namespace video
 	public:
 
 		//! constructor
-		IRenderTarget() : DepthStencil(0), DriverType(EDT_NULL)
+		IRenderTarget() : DepthStencil(0), DriverType(EDT_NULL), SampleCount(0), DiscardDepthStencil(false)
 		{
 		}
 
@@ -99,6 +99,42 @@ namespace video
 			return DriverType;
 		}
 
+		//! Sets the number of samples per pixel for antialiasing
+		/** The target is then drawn into multisampled buffers, which are
+		resolved into its textures when another render target is set or the
+		scene ends. Until then the textures keep their previous content, and
+		the multisampled buffers are undefined after it, so clear the target
+		whenever it is set again. A depth texture is only filled when its
+		format matches the multisampled one exactly.
+		Only single color textures are supported, the count is clamped to
+		the maximum of the driver. Takes effect when the target is set next.
+		\param count Samples per pixel, 0 or 1 to draw into the textures directly. */
+		void setSampleCount(u8 count)
+		{
+			SampleCount = count;
+		}
+
+		//! Returns the requested number of samples per pixel, see setSampleCount()
+		u8 getSampleCount() const
+		{
+			return SampleCount;
+		}
+
+		//! Lets the driver discard the depth and stencil once the target isn't drawn anymore
+		/** Saves tile based GPUs writing them back to memory, and skips their
+		multisample resolve. Only enable it if the depth texture is not read
+		afterwards. Disabled by default. */
+		void setDiscardDepthStencil(bool discard)
+		{
+			DiscardDepthStencil = discard;
+		}
+
+		//! Checks if the depth and stencil are discarded, see setDiscardDepthStencil()
+		bool getDiscardDepthStencil() const
+		{
+			return DiscardDepthStencil;
+		}
+
 	protected:
 
 		//! Set multiple textures.
@@ -117,6 +153,12 @@ namespace video
 		//! Driver type of render target.
 		E_DRIVER_TYPE DriverType;
 
+		//! Requested samples per pixel of the drawing buffers.
+		u8 SampleCount;
+
+		//! Depth and stencil are not needed after drawing.
+		bool DiscardDepthStencil;
+
 	private:
 		// no copying (IReferenceCounted still allows that for reasons which take some time to work around)
 		IRenderTarget(const IRenderTarget&);
@@ -7,7 +7,10 @@
 
 #include "IReferenceCounted.h"
 #include "position2d.h"
+#include "vector2d.h"
 #include "line3d.h"
+#include "triangle3d.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -15,6 +18,54 @@ namespace irr
 namespace scene
 {
 	class ICameraSceneNode;
+	class ISceneNode;
+	class IMesh;
+
+	//! A triangle hit by a ray
+	struct SCollisionHit
+	{
+		SCollisionHit() : Node(0), Distance(0.f), MeshBuffer(0), TriangleIndex(0), Instance(-1) {}
+
+		//! Node which was hit, 0 for hits of ISceneCollisionManager::getCollisionPoint()
+		ISceneNode* Node;
+
+		//! Position of the hit in world space
+		core::vector3df Point;
+
+		//! The triangle which was hit, in world space
+		core::triangle3df Triangle;
+
+		//! Distance of the hit from the start of the ray
+		f32 Distance;
+
+		//! Index of the mesh buffer holding the triangle
+		u32 MeshBuffer;
+
+		//! Index of the triangle in its mesh buffer
+		u32 TriangleIndex;
+
+		//! Instance of an IInstancedMeshSceneNode which was hit, -1 for other nodes
+		s32 Instance;
+
+		bool operator<(const SCollisionHit& other) const
+		{
+			return Distance < other.Distance;
+		}
+	};
+
+	//! A point projected by ISceneCollisionManager::getScreenCoordinatesFrom3DPositions()
+	struct SScreenPosition
+	{
+		//! Position in pixels, relative to the upper left corner of the viewport
+		/** (-10000, -10000) for points behind the camera. */
+		core::vector2df Pos;
+
+		//! Distance of the point from the camera along its view direction
+		f32 Depth;
+
+		//! True if the point is in front of the camera and within the viewport
+		bool Visible;
+	};
 
 	class ISceneCollisionManager : public virtual IReferenceCounted
 	{
@@ -30,6 +81,76 @@ namespace scene
 		virtual core::line3d<f32> getRayFromScreenCoordinates(
 			const core::position2d<s32>& pos, const ICameraSceneNode* camera = 0) = 0;
 
+		//! Projects many 3d positions to the screen at once
+		/** For nameplates and markers. The matrices of the camera are
+		combined once and four positions are projected at a time with SIMD
+		where available. The current viewport of the driver is used, like
+		for getRayFromScreenCoordinates(). The far plane isn't tested.
+		\param positions Positions in world space.
+		\param count Number of positions.
+		\param outPositions Receives one result per position.
+		\param camera Camera to project with. If null, the active camera
+		is used.
+		\return Number of visible positions. */
+		virtual u32 getScreenCoordinatesFrom3DPositions(const core::vector3df* positions, u32 count,
+			SScreenPosition* outPositions, const ICameraSceneNode* camera = 0) = 0;
+
+		//! Returns the nearest scene node whose bounding box is hit by a ray.
+		/** The bounding boxes are tested in the space of each node, so they
+		are tested as oriented boxes. Only visible nodes are considered. If
+		the scene manager has a spatial index and no root is given, only the
+		nodes found in the index are tested.
+		\param ray Line segment in world space.
+		\param idBitMask Only nodes with an id having at least one of these
+		bits set are considered. 0 considers all nodes.
+		\param bNoDebugObjects Don't consider nodes marked as debug objects.
+		\param root Only this node's children (recursively) are tested. If 0,
+		the root scene node is taken.
+		\return The nearest node hit, or 0 if none was hit. */
+		virtual ISceneNode* getSceneNodeFromRayBB(const core::line3d<f32>& ray,
+			s32 idBitMask=0, bool bNoDebugObjects=false, ISceneNode* root=0) = 0;
+
+		//! Finds the nearest triangle of a mesh hit by a ray.
+		/** The triangles are searched with a bounding volume hierarchy,
+		which is built at the first query of a mesh and cached until the
+		mesh buffers change.
+		\param ray Line segment in the space of the mesh.
+		\param mesh Mesh to test, only its triangle lists are used.
+		\param outHit Receives the hit, in the space of the mesh.
+		\return True if a triangle was hit. */
+		virtual bool getCollisionPoint(const core::line3d<f32>& ray, IMesh* mesh, SCollisionHit& outHit) = 0;
+
+		//! Finds the nearest triangle of the scene hit by a ray.
+		/** Tests the meshes of mesh, animated mesh and instanced mesh scene
+		nodes. Nodes are tested in the order their bounding boxes are hit, so
+		nodes behind the nearest hit aren't tested at all. Other nodes are
+		ignored.
+		\param ray Line segment in world space.
+		\param outHit Receives the hit.
+		\param idBitMask Only nodes with an id having at least one of these
+		bits set are considered. 0 considers all nodes.
+		\param bNoDebugObjects Don't consider nodes marked as debug objects.
+		\param root Only this node's children (recursively) are tested. If 0,
+		the root scene node is taken.
+		\return The node which was hit, or 0 if none was hit. */
+		virtual ISceneNode* getSceneNodeAndCollisionPointFromRay(const core::line3d<f32>& ray,
+			SCollisionHit& outHit, s32 idBitMask=0, bool bNoDebugObjects=false, ISceneNode* root=0) = 0;
+
+		//! Finds the nearest triangle of each node hit by a ray.
+		/** Works like getSceneNodeAndCollisionPointFromRay(), but tests
+		all nodes whose bounding box is hit.
+		\param outHits Receives the hits sorted by distance. Cleared first,
+		but keeps its memory, so the same array can be passed to each query
+		without allocating.
+		\return Number of hits. */
+		virtual u32 getSceneNodesAndCollisionPointsFromRay(const core::line3d<f32>& ray,
+			core::array<SCollisionHit>& outHits, s32 idBitMask=0, bool bNoDebugObjects=false, ISceneNode* root=0) = 0;
+
+		//! Deletes the cached triangle hierarchies of all meshes.
+		/** Hierarchies of meshes nobody else holds on to are freed
+		automatically from time to time. */
+		virtual void clearTriangleBVHCache() = 0;
+
 	};
 
 } // end namespace scene
@@ -16,6 +16,9 @@
 #include "EMeshWriterEnums.h"
 #include "SceneParameters.h"
 #include "ISkinnedMesh.h"
+#include "SShadowMapParameters.h"
+#include "SSceneView.h"
+#include "ELightClusterTextures.h"
 
 namespace irr
 {
@@ -42,6 +45,9 @@ namespace video
 	class SMaterial;
 	class IImage;
 	class ITexture;
+	class IRenderTarget;
+	struct S3DVertex;
+	class IPostProcessChain;
 } // end namespace video
 
 namespace scene
@@ -59,7 +65,9 @@ namespace scene
 		//! Camera pass. The active view is set up here. The very first pass.
 		ESNRP_CAMERA =1,
 
-		//! In this pass, lights are transformed into camera space and added to the driver
+		//! In this pass, lights are transformed into camera space and binned into the light clusters
+		/** Only nodes of the type ESNT_LIGHT, implementing ILightSceneNode,
+		are taken. They aren't drawn. */
 		ESNRP_LIGHT =2,
 
 		//! This is used for sky boxes.
@@ -89,11 +97,21 @@ namespace scene
 		//! Transparent effect scene nodes, drawn after Transparent nodes. They are sorted from back to front and drawn in that order.
 		ESNRP_TRANSPARENT_EFFECT =32,
 
-		//! Drawn after the solid nodes, before the transparent nodes, the time for drawing shadow volumes
+		//! Depth of the shadow casters, drawn into the shadow maps before the solid nodes.
+		/** Only used when ISceneManager::setShadowMappingEnabled() is on. Nodes register
+		for it once per frame, even when they are outside of the view of the camera, and
+		draw their solid geometry in render(). The view and projection transformations are
+		those of the light then, and color writes are disabled. */
 		ESNRP_SHADOW =64,
 
 		//! Drawn after transparent effect nodes. For custom gui's. Unsorted (in order nodes registered themselves). 
-		ESNRP_GUI = 128
+		ESNRP_GUI = 128,
+
+		//! Depth of the solid nodes, drawn before them with color writes disabled.
+		/** Only used when ISceneManager::setDepthPrepassEnabled() is on. Nodes never register
+		for it, the solid nodes are drawn once more instead and should draw the same geometry as
+		in ESNRP_SOLID. */
+		ESNRP_DEPTH_PREPASS = 256
 
 	};
 
@@ -102,13 +120,19 @@ namespace scene
 	class IBillboardSceneNode;
 	class ICameraSceneNode;
 	class IDummyTransformationSceneNode;
+	class ILightSceneNode;
 	class IMesh;
 	class IMeshBuffer;
 	class IMeshCache;
 	class ISceneCollisionManager;
+	class ISpatialIndex;
 	class IMeshLoader;
+	class IMeshLoadRequest;
 	class IMeshManipulator;
 	class IMeshSceneNode;
+	class IInstancedMeshSceneNode;
+	class IChunkGridSceneNode;
+	class IStaticBatchSceneNode;
 	class IMeshWriter;
 	class ISceneNode;
 	class ISceneNodeFactory;
@@ -324,6 +348,48 @@ namespace scene
 		 **/
 		virtual IAnimatedMesh* getMesh(io::IReadFile* file) = 0;
 
+		//! Loads a mesh on a background thread.
+		/** Works like getMesh(), but returns right away. The file is parsed
+		by the mesh loaders on a thread of the scene manager, one file at a
+		time. The mesh is added to the mesh cache during a later drawAll(),
+		or a later call of this method, and the request becomes ready then.
+		Requests for a file which is already loading return the same request.
+		Files of archives are read into memory before returning, other files
+		must not be used by the caller until the request is ready or failed.
+		Loading a mesh with getMesh() meanwhile waits for the file being parsed.
+		Messages the loaders log are sent from the loading thread.
+		\param file File handle of the mesh to load.
+		\return Request to poll with IMeshLoadRequest::isReady(), or 0 if
+		file is 0. Drop the request when done with it, the mesh stays in the
+		mesh cache. See IReferenceCounted::drop() for more information. */
+		virtual IMeshLoadRequest* getMeshAsync(io::IReadFile* file) = 0;
+
+		//! Sets a directory in which getMesh() caches skinned meshes as .irrbm files.
+		/** The cached files are named after a hash of the content of the
+		loaded file, so changed files are parsed again. Skinned meshes found
+		in the cache skip parsing the original format, the others are written
+		into the cache after parsing. The files store the memory layout of
+		the meshes, so the directory shouldn't be shared between platforms.
+		\param directory Existing directory, or an empty path to disable the
+		cache, which is the default. */
+		virtual void setMeshCacheDirectory(const io::path& directory) = 0;
+
+		//! Records a texture file a mesh file refers to, for mesh loaders
+		/** For loaders run by getMesh() and getMeshAsync() while the
+		MESH_LOADER_TEXTURES parameter is set. The returned texture is a
+		reference which the loader puts into the materials of the mesh,
+		its ITexture::getSource() is video::ETS_UNRESOLVED. After the loader
+		is done, the textures of all references are loaded in one batch
+		with video::IVideoDriver::getTextureAsync() and replace the
+		references in the materials of the mesh, the references are
+		dropped then. Materials which aren't in the mesh buffers of the
+		mesh keep the dropped references.
+		\param name Name of the texture file as it is in the mesh file.
+		Names are looked up as they are and next to the mesh file.
+		\return Reference, the same one for the same name while a file is
+		loaded. This pointer should not be dropped. */
+		virtual video::ITexture* addMeshTextureReference(const io::path& name) = 0;
+
 		//! Get interface to the mesh cache which is shared between all existing scene managers.
 		/** With this interface, it is possible to manually add new loaded
 		meshes (if ISceneManager::getMesh() is not sufficient), to remove them and to iterate
@@ -370,6 +436,56 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) = 0;
 
+		//! Adds a scene node for rendering many instances of a static mesh.
+		/** \param mesh: Pointer to the loaded static mesh to be displayed.
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\param alsoAddIfMeshPointerZero: Add the scene node even if a 0 pointer is passed.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) = 0;
+
+		//! Adds a scene node for large world geometry made of chunk meshes.
+		/** \param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IChunkGridSceneNode* addChunkGridSceneNode(ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) = 0;
+
+		//! Adds a scene node merging many static mesh scene nodes into few large buffers.
+		/** Add the nodes with IStaticBatchSceneNode::addNode().
+		\param parent: Parent of the scene node. Can be NULL if no parent.
+		\param id: Id of the node. This id can be used to identify the scene node.
+		\param position: Position of the space relative to its parent where the
+		scene node will be placed.
+		\param rotation: Initial rotation of the scene node.
+		\param scale: Initial scale of the scene node.
+		\param cellSize: Edge length of the cubes the nodes are merged and
+		culled in, in the space of the batch. Larger cells mean fewer draw
+		calls but coarser culling.
+		\return Pointer to the created scene node.
+		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
+		virtual IStaticBatchSceneNode* addStaticBatchSceneNode(ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			f32 cellSize=100.f) = 0;
+
 		//! Adds a camera scene node to the scene graph and sets it as active camera.
 		/** This camera does not react on user input.
 		If you want to move or animate it, use ISceneNode::setPosition(),
@@ -416,6 +532,19 @@ namespace scene
 			const core::vector3df& position = core::vector3df(0,0,0), s32 id=-1,
 			video::SColor colorTop = 0xFFFFFFFF, video::SColor colorBottom = 0xFFFFFFFF) = 0;
 
+		//! Adds a dynamic point light to the scene graph.
+		/** \param parent Parent scene node of the light. Can be null.
+		\param position Position of the light relative to its parent.
+		\param color Color of the light.
+		\param radius Distance at which the light has no effect anymore.
+		\param id Id of the node.
+		\return Pointer to the light. This pointer should not be dropped.
+		See IReferenceCounted::drop() for more information. */
+		virtual ILightSceneNode* addLightSceneNode(ISceneNode* parent = 0,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			video::SColorf color = video::SColorf(1.0f, 1.0f, 1.0f),
+			f32 radius = 100.0f, s32 id = -1) = 0;
+
 		//! Adds an empty scene node to the scene graph.
 		/** Can be used for doing advanced transformations
 		or structuring the scene graph.
@@ -448,7 +577,8 @@ namespace scene
 		node are searched. If null is specified, the root scene node is
 		taken.
 		\return Pointer to the first scene node with this id,
-		and null if no scene node could be found.
+		and null if no scene node could be found. With the node registry
+		enabled, any of several nodes with this id is returned.
 		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
 		virtual ISceneNode* getSceneNodeFromId(s32 id, ISceneNode* start=0) = 0;
 
@@ -458,7 +588,8 @@ namespace scene
 		node are searched. If null is specified, the root scene node is
 		taken.
 		\return Pointer to the first scene node with this id,
-		and null if no scene node could be found.
+		and null if no scene node could be found. With the node registry
+		enabled, any of several nodes with this name is returned.
 		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
 		virtual ISceneNode* getSceneNodeFromName(const c8* name, ISceneNode* start=0) = 0;
 
@@ -468,7 +599,8 @@ namespace scene
 		node are searched. If null is specified, the root scene node is
 		taken.
 		\return Pointer to the first scene node with this type,
-		and null if no scene node could be found.
+		and null if no scene node could be found. With the node registry
+		enabled, any of several nodes of this type is returned.
 		This pointer should not be dropped. See IReferenceCounted::drop() for more information. */
 		virtual ISceneNode* getSceneNodeFromType(scene::ESCENE_NODE_TYPE type, ISceneNode* start=0) = 0;
 
@@ -477,7 +609,8 @@ namespace scene
 		\param outNodes: results will be added to this array (outNodes is not cleared).
 		\param start: Scene node to start from. This node and all children of this scene
 		node are checked (recursively, so also children of children, etc). If null is specified,
-		the root scene node is taken as start-node. */
+		the root scene node is taken as start-node. With the node registry
+		enabled, the nodes aren't in the order of the scene graph. */
 		virtual void getSceneNodesFromType(ESCENE_NODE_TYPE type,
 				core::array<scene::ISceneNode*>& outNodes,
 				ISceneNode* start=0) = 0;
@@ -507,6 +640,32 @@ namespace scene
 		virtual u32 registerNodeForRendering(ISceneNode* node,
 			E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC) = 0;
 
+		//! Registers a single mesh buffer of a node for rendering.
+		/** Like registerNodeForRendering(), but the scene manager draws the
+		buffer itself with the absolute transformation of the node. Solid
+		buffers are sorted together with the buffers of all other nodes by
+		material, transparent ones back to front by the center of their
+		bounding box. The node isn't culled here, so check isCulled() before.
+		\param node: Node the mesh buffer belongs to.
+		\param meshBuffer: Mesh buffer to draw.
+		\param material: Material to draw it with, has to stay valid until
+		the scene is drawn.
+		\param pass: ESNRP_SOLID or ESNRP_TRANSPARENT, others are ignored. */
+		virtual void registerMeshBufferForRendering(ISceneNode* node,
+			IMeshBuffer* meshBuffer, const video::SMaterial& material,
+			E_SCENE_NODE_RENDER_PASS pass = ESNRP_SOLID) = 0;
+
+		//! Registers a camera facing quad, to be drawn together with all other quads of its material.
+		/** Billboard scene nodes call this instead of drawing themselves.
+		The quads of a material are copied into one streamed mesh buffer,
+		transparent ones sorted back to front, and drawn with a single call.
+		The quad isn't culled here, so check isCulled() before.
+		\param material: Material of the quad, it is copied.
+		\param vertices: Four vertices in world space, they are copied. They
+		make up the triangles 0,2,1 and 0,3,2. */
+		virtual void registerBillboardForRendering(const video::SMaterial& material,
+			const video::S3DVertex* vertices) = 0;
+
 		//! Clear all nodes which are currently registered for rendering
 		/** Usually you don't have to care about this as drawAll will clear nodes
 		after rendering them. But sometimes you might have to manully reset this.
@@ -520,6 +679,108 @@ namespace scene
 		by existing scene node animators, culling of scene nodes is done, etc. */
 		virtual void drawAll() = 0;
 
+		//! Draws all the scene nodes as seen by several cameras
+		/** Used for stereo rendering and split screens. The scene is
+		animated once, and the nodes are culled and register themselves
+		once against a frustum enclosing the frustums of all views. The
+		sorted render queues are then drawn for each view, with its
+		camera and into its viewport. The cameras aren't set active, the
+		active camera is left as it is. Shadow maps are rendered once for
+		the first view, their cascades should cover the others. Occlusion
+		culling is skipped, the occluders of one view may hide nodes of
+		the others. Like drawAll(), this can only be invoked between
+		IVideoDriver::beginScene() and IVideoDriver::endScene().
+		\param views: The views to draw, all need a camera. With a single
+		view this draws like drawAll() with the camera of the view active. */
+		virtual void drawAllViews(const core::array<SSceneView>& views) = 0;
+
+		//! Draws all the scene nodes into the faces of a cubemap
+		/** For reflection and environment probes. The nodes are culled
+		and register themselves once against the box enclosing the drawn
+		faces, and the render queues are sorted once. Then each entry gets
+		a mask of the faces its box is seen in, and every face draws only
+		the entries it sees. The faces are drawn with cameras at position
+		with a field of view of 90 degrees, looking along the axis of the
+		face. The up vector is +Y for the X and Z faces, -Z for the +Y
+		face and +Z for the -Y face. Like drawAllViews(), shadow maps are
+		rendered for the first face only and occlusion culling is skipped.
+		The nodes aren't animated, the post-processing chain and the gui
+		nodes aren't drawn, so the probes of a frame are usually drawn
+		before drawAll(). Afterwards the render target set before is set
+		again. This can only be invoked between
+		IVideoDriver::beginScene() and IVideoDriver::endScene().
+		\param target: Render target with a cubemap texture from
+		IVideoDriver::addRenderTargetTextureCubemap() and a depth texture
+		of the same size. Its cube surface is changed for each face.
+		\param position: Center of the probe.
+		\param nearValue: Distance of the near plane of the faces.
+		\param farValue: Distance of the far plane of the faces.
+		\param faces: Faces to draw, 1 << video::E_CUBE_SURFACE or'ed
+		together. Distant probes can draw a few faces per frame, and so
+		spread their update over several frames.
+		\param clearColor: Color the faces are cleared with, their
+		depth and stencil are cleared as well. */
+		virtual void drawAllToCubemap(video::IRenderTarget* target, const core::vector3df& position,
+			f32 nearValue, f32 farValue, u32 faces = 0x3f, video::SColor clearColor = video::SColor(255,0,0,0)) = 0;
+
+		//! Animates the scene and tells if it has to be drawn again
+		/** For applications drawing only when something changed, like menus
+		and viewers, to save power. Call this once per frame instead of
+		drawing unconditionally, drawAll() and drawAllViews() don't animate
+		the nodes again in the frame after it. The scene has to be drawn if
+		invalidate() was called, a node moved, was shown, hidden, added or
+		removed, an animated mesh node changed its frame, the active camera
+		changed its view or projection, or meshes loaded in the background
+		were published since the scene was drawn the last time. Other
+		changes, like changed materials or meshes, aren't noticed and need
+		invalidate(). Running animators keep the scene changing. Checking
+		the nodes is much cheaper than drawing them, but has to visit all of
+		them, so it isn't free. Combine it with
+		gui::IGUIEnvironment::needsRedraw() and
+		IrrlichtDevice::waitForEvents():
+		\code
+		while (device->run())
+		{
+			// the scene is checked first, it animates
+			if (!smgr->needsRedraw() && !env->needsRedraw())
+			{
+				device->waitForEvents(100);
+				continue;
+			}
+			driver->beginScene(true, true, video::SColor(255,0,0,0));
+			smgr->drawAll();
+			env->drawAll();
+			driver->endScene();
+		}
+		\endcode
+		\return True if the scene has to be drawn again. */
+		virtual bool needsRedraw() = 0;
+
+		//! Makes needsRedraw() return true until the scene is drawn again
+		/** Call this after changes needsRedraw() doesn't notice, like
+		changed materials, textures or meshes. */
+		virtual void invalidate() = 0;
+
+		//! Renders a mesh from several directions into one texture, for impostors.
+		/** The mesh is seen from \p views directions spread evenly around
+		its Y axis, starting at -Z. Each view is drawn orthogonally into a
+		square cell and shows the bounding sphere of the mesh, pixels not
+		covered by it get an alpha of 0. The cells fill a grid of
+		ceil(sqrt(views)) columns row by row from the top left. They are
+		rendered into a render target texture and copied into an ordinary
+		one, so the result gets mipmaps. This draws with the video driver, so
+		it can only be invoked between IVideoDriver::beginScene() and
+		IVideoDriver::endScene().
+		\param mesh: Mesh to render, with the materials of its mesh buffers.
+		\param views: Number of directions.
+		\param viewSize: Width and height of a cell in pixels.
+		\param name: Name of the texture in the texture cache.
+		\return The texture or 0 on failure. It is owned by the video driver
+		like those of IVideoDriver::addTexture(), so don't drop it.
+		\see IMeshSceneNode::setImpostor() */
+		virtual video::ITexture* createImpostorTexture(IMesh* mesh, u32 views=8,
+			u32 viewSize=128, const io::path& name="impostor") = 0;
+
 		//! Adds an external mesh loader for extending the engine with new file formats.
 		/** If you want the engine to be extended with
 		file formats it currently is not able to load (e.g. .cob), just implement
@@ -582,6 +843,18 @@ namespace scene
 		pass currently is active they can render the correct part of their geometry. */
 		virtual E_SCENE_NODE_RENDER_PASS getSceneNodeRenderPass() const = 0;
 
+		//! Get the sub-millisecond part of the time the scene is animated with.
+		/** drawAll() calls ISceneNode::OnAnimate() with the virtual time
+		in whole milliseconds. When the FRACTIONAL_ANIMATION_TIME parameter
+		is set, scene nodes can add the fraction returned here to the
+		elapsed milliseconds, so they advance evenly at frame times which
+		aren't whole milliseconds.
+		\param timeMs Time passed to ISceneNode::OnAnimate().
+		\return Fraction of a millisecond in [0,1) the animation time is
+		past timeMs. 0 when the parameter isn't set or timeMs isn't the time
+		of the current drawAll(). */
+		virtual f32 getAnimationTimeFraction(u32 timeMs) const = 0;
+
 		//! Creates a new scene manager.
 		/** This can be used to easily draw and/or store two
 		independent scenes at the same time. The mesh cache will be
@@ -635,6 +908,163 @@ namespace scene
 		\return True if node is not visible in the current scene, else
 		false. */
 		virtual bool isCulled(const ISceneNode* node) const =0;
+
+		//! Enables or disables the spatial index of the scene nodes.
+		/** The index is kept up to date while nodes move, so culling,
+		radius queries and ray picking with
+		ISceneCollisionManager::getSceneNodeFromRayBB() don't need to visit
+		every node. It is disabled by default, as keeping it up to date
+		costs more than it saves in scenes with few nodes.
+		\param enable True to create the index, false to delete it. */
+		virtual void setSpatialIndexEnabled(bool enable) = 0;
+
+		//! Get the spatial index of the scene nodes.
+		/** \return The index, or 0 if it is not enabled. */
+		virtual ISpatialIndex* getSpatialIndex() const = 0;
+
+		//! Enables or disables the registry of the scene nodes by id, name and type.
+		/** The registry is kept up to date while nodes are added, removed
+		and get a new id or name, so getSceneNodeFromId(),
+		getSceneNodeFromName(), getSceneNodeFromType() and
+		getSceneNodesFromType() only visit the nodes with the key instead of
+		the whole scene graph. It is disabled by default, as it costs memory
+		and time on every change of the scene graph.
+		\param enable True to create the registry, false to delete it. */
+		virtual void setNodeRegistryEnabled(bool enable) = 0;
+
+		//! Check if the registry of the scene nodes is enabled.
+		virtual bool isNodeRegistryEnabled() const = 0;
+
+		//! Enables or disables the occlusion culling on the CPU.
+		/** Each frame, the occluder meshes of the visible nodes with
+		EAC_OCCLUDER are rasterized into a small depth buffer on the worker
+		threads, then nodes with automatic culling completely behind them
+		are culled before they register for rendering. It is disabled by
+		default, as it only pays off with a few large occluders, like walls
+		and terrain, in front of many nodes.
+		\param enable True to create the depth buffer, false to delete it. */
+		virtual void setOcclusionCullingEnabled(bool enable) {}
+
+		//! Check if the occlusion culling on the CPU is enabled.
+		virtual bool isOcclusionCullingEnabled() const { return false; }
+
+		//! Enables or disables the parallel update of the scene nodes.
+		/** When enabled, drawAll() animates the children of the root scene
+		node and updates their absolute transformations on worker threads,
+		one job per child. Animated meshes with a skinned mesh no other
+		visible node uses are skinned on the worker threads as well, the
+		others are still skinned while rendering. All jobs are finished
+		before the first node is registered for rendering.
+		Scene nodes and IAnimationEndCallBack implementations must then not
+		change anything outside of their own subtree in OnAnimate(), as
+		these run at the same time for different subtrees.
+		\param enable True to start the worker threads, false to stop them. */
+		virtual void setParallelUpdateEnabled(bool enable) = 0;
+
+		//! Enables or disables the depth pre-pass of the solid scene nodes.
+		/** When enabled, drawAll() draws the sorted solid nodes twice: first in
+		ESNRP_DEPTH_PREPASS with color writes disabled, then in ESNRP_SOLID with
+		the depth function ECFN_EQUAL and depth writes disabled. The materials
+		are then only evaluated for visible fragments, which pays off with
+		expensive shaders and a lot of overdraw. Both passes use the materials
+		of the nodes, so vertex shaders and alpha tests give the same depth in
+		both. Solid nodes which draw nothing in ESNRP_DEPTH_PREPASS, and
+		materials without depth test or depth writes, are hidden by the equal
+		test. The override material of the driver still applies if it is
+		enabled for ESNRP_SOLID. Disabled by default.
+		\param enable True to draw the depth of the solid nodes first. */
+		virtual void setDepthPrepassEnabled(bool enable) = 0;
+
+		//! Checks if the depth pre-pass is enabled, see setDepthPrepassEnabled()
+		virtual bool isDepthPrepassEnabled() const = 0;
+
+		//! Enables or disables order-independent transparency.
+		/** When enabled, drawAll() doesn't sort the transparent nodes and
+		mesh buffers whose materials the driver can accumulate, see
+		video::IVideoDriver::canAccumulateTransparency(). They are grouped
+		by material and drawn first in ESNRP_TRANSPARENT, into the
+		accumulation buffers of the driver, which then blends them over the
+		scene. Nodes drawing themselves are only accumulated if all their
+		materials can be. The other transparent nodes are still sorted back
+		to front and drawn over the accumulated ones. If the driver doesn't
+		support video::EVDF_WEIGHTED_TRANSPARENCY, or fails to accumulate
+		into the current render target, all of them are sorted as before.
+		Close layers of similar transparency blend to their average instead
+		of in order, so the result differs from sorting where they overlap.
+		Disabled by default.
+		\param enable True to accumulate the transparent nodes without sorting them. */
+		virtual void setOrderIndependentTransparencyEnabled(bool enable) = 0;
+
+		//! Checks if order-independent transparency is enabled, see setOrderIndependentTransparencyEnabled()
+		virtual bool isOrderIndependentTransparencyEnabled() const = 0;
+
+		//! Enables or disables the cascaded shadow maps of a directional light.
+		/** When enabled, drawAll() draws the nodes registered for ESNRP_SHADOW
+		into one depth texture per cascade, after the camera and sky box passes
+		and before the solid nodes. The view of the active camera is split
+		into slices along its view direction, each cascade covers one slice.
+		Only the casters overlapping a cascade are drawn into it. A cascade is
+		kept from the previous frame when neither its light transformation nor
+		the position or bounding box of any of its casters changed, and none of
+		them is an animated mesh. The shadow maps are not used by any built-in
+		material, shaders read them with getShadowMap() and
+		getShadowMapMatrix(). Disabled by default.
+		\param enable True to draw the shadow maps. */
+		virtual void setShadowMappingEnabled(bool enable) = 0;
+
+		//! Checks if the shadow maps are drawn, see setShadowMappingEnabled()
+		virtual bool isShadowMappingEnabled() const = 0;
+
+		//! Sets the light and the cascades of the shadow maps
+		/** Changing the cascade count or resolution recreates the textures. */
+		virtual void setShadowMapParameters(const SShadowMapParameters& parameters) = 0;
+
+		//! Returns the parameters of the shadow maps
+		virtual const SShadowMapParameters& getShadowMapParameters() const = 0;
+
+		//! Returns the depth texture of a cascade
+		/** \param cascade Index of the cascade, the nearest one is 0.
+		\return The texture, or 0 if the cascade was not drawn yet. */
+		virtual video::ITexture* getShadowMap(u32 cascade) const = 0;
+
+		//! Returns the transformation from world space to the clip space of a cascade
+		/** \param cascade Index of the cascade, the nearest one is 0. */
+		virtual const core::matrix4& getShadowMapMatrix(u32 cascade) const = 0;
+
+		//! Returns the distance from the camera where a cascade ends
+		/** Shaders pick the first cascade whose split is beyond the view depth of a fragment.
+		\param cascade Index of the cascade, the nearest one is 0. */
+		virtual f32 getShadowMapSplit(u32 cascade) const = 0;
+
+		//! Forces all cascades to be drawn again in the next frame
+		/** Needed when a caster changed without moving or changing its bounding
+		box, for example when its mesh was modified. */
+		virtual void invalidateShadowMaps() = 0;
+
+		//! Returns a texture of the lights binned into the clusters of the camera view
+		/** drawAll() bins the visible lights after the camera pass and uploads
+		the textures once per frame, see E_LIGHT_CLUSTER_TEXTURE for their
+		layouts. A cluster lists the lights whose sphere may reach into it,
+		so the work per fragment depends on the lights nearby instead of all
+		lights of the scene. The binning runs on the threads of
+		setParallelUpdateEnabled() if enabled.
+		\return The texture, or 0 while there were no lights yet or the
+		driver doesn't support float textures. */
+		virtual video::ITexture* getLightClusterTexture(E_LIGHT_CLUSTER_TEXTURE texture) const = 0;
+
+		//! Returns the number of lights in the view of the camera in the last frame
+		virtual u32 getVisibleLightCount() const = 0;
+
+		//! Sets the post-processing chain drawn by drawAll()
+		/** drawAll() then draws the scene into the scene texture of the chain
+		and its passes at the end, into the render target which was active
+		before drawAll().
+		\param chain The chain, or 0 to draw the scene directly. It is
+		grabbed by the scene manager. */
+		virtual void setPostProcessChain(video::IPostProcessChain* chain) = 0;
+
+		//! Returns the post-processing chain drawn by drawAll(), or 0
+		virtual video::IPostProcessChain* getPostProcessChain() const = 0;
 	};
 
 
@@ -6,15 +6,19 @@
 #define __I_SCENE_NODE_H_INCLUDED__
 
 #include "IReferenceCounted.h"
+#include "irrMemory.h"
 #include "ESceneNodeTypes.h"
 #include "ECullingTypes.h"
 #include "EDebugSceneTypes.h"
 #include "SMaterial.h"
 #include "irrString.h"
+#include "irrAtom.h"
 #include "aabbox3d.h"
 #include "matrix4.h"
 #include "IAttributes.h"
-#include <list>
+#include "ISpatialIndex.h"
+#include "ISceneNodeRegistry.h"
+#include <vector>
 
 namespace irr
 {
@@ -24,7 +28,10 @@ namespace scene
 	class ISceneManager;
 
 	//! Typedef for list of scene nodes
-	typedef std::list<ISceneNode*> ISceneNodeList;
+	/** Kept in one block of memory, so walking the children of a node
+	doesn't jump around the heap. Adding or removing children invalidates
+	iterators into the list. */
+	typedef std::vector<ISceneNode*> ISceneNodeList;
 
 	//! Scene node interface.
 	/** A scene node is a node in the hierarchical scene graph. Every scene
@@ -34,7 +41,7 @@ namespace scene
 	example easily possible to attach a light to a moving car, or to place
 	a walking character on a moving platform on a moving ship.
 	*/
-	class ISceneNode : virtual public IReferenceCounted
+	class ISceneNode : virtual public IReferenceCounted, public core::CMemoryTagged<core::EMC_SCENE>
 	{
 	public:
 
@@ -46,7 +53,9 @@ namespace scene
 			: RelativeTranslation(position), RelativeRotation(rotation), RelativeScale(scale),
 				Parent(0), SceneManager(mgr), ID(id),
 				AutomaticCullingState(EAC_BOX), DebugDataVisible(EDS_OFF),
-				IsVisible(true), IsDebugObject(false)
+				IsVisible(true), IsDebugObject(false), SpatialIndex(0), SpatialIndexId(-1), NodeRegistry(0),
+				TransformDirty(true), TransformRevision(0), ParentTransformRevision(0),
+				TransformedBoxRevision(0)
 		{
 			if (parent)
 				parent->addChild(this);
@@ -122,11 +131,23 @@ namespace scene
 		}
 
 
+		//! Returns the interned name of the node.
+		/** Comparing it with another atom is cheaper than comparing the
+		strings, ISceneManager::getSceneNodeFromName() uses it.
+		\return Name as atom. */
+		const core::atom& getNameAtom() const
+		{
+			return Name;
+		}
+
+
 		//! Sets the name of the node.
 		/** \param name New name of the scene node. */
 		virtual void setName(const c8* name)
 		{
-			Name = name;
+			Name = core::atom(name);
+			if (NodeRegistry)
+				NodeRegistry->updateNode(this);
 		}
 
 
@@ -134,7 +155,9 @@ namespace scene
 		/** \param name New name of the scene node. */
 		virtual void setName(const core::stringc& name)
 		{
-			Name = name;
+			Name = core::atom(name);
+			if (NodeRegistry)
+				NodeRegistry->updateNode(this);
 		}
 
 
@@ -155,9 +178,20 @@ namespace scene
 		\return The transformed bounding box. */
 		virtual const core::aabbox3d<f32> getTransformedBoundingBox() const
 		{
-			core::aabbox3d<f32> box = getBoundingBox();
-			AbsoluteTransformation.transformBoxEx(box);
-			return box;
+			// cached until the absolute transformation or the box change,
+			// the box is compared exactly instead of with the tolerance of operator==
+			const core::aabbox3d<f32>& box = getBoundingBox();
+			const core::aabbox3d<f32>& source = TransformedBoxSource;
+			if (TransformedBoxRevision != TransformRevision + 1 ||
+				source.MinEdge.X != box.MinEdge.X || source.MinEdge.Y != box.MinEdge.Y || source.MinEdge.Z != box.MinEdge.Z ||
+				source.MaxEdge.X != box.MaxEdge.X || source.MaxEdge.Y != box.MaxEdge.Y || source.MaxEdge.Z != box.MaxEdge.Z)
+			{
+				TransformedBoxSource = box;
+				TransformedBox = box;
+				AbsoluteTransformation.transformBoxEx(TransformedBox);
+				TransformedBoxRevision = TransformRevision + 1;
+			}
+			return TransformedBox;
 		}
 
 		//! Get a the 8 corners of the original bounding box transformed and
@@ -169,8 +203,7 @@ namespace scene
 		{
 			edges.set_used(8);
 			getBoundingBox().getEdges( edges.pointer() );
-			for ( u32 i=0; i<8; ++i )
-				AbsoluteTransformation.transformVect( edges[i] );
+			AbsoluteTransformation.transformVectArray(edges.pointer(), edges.const_pointer(), 8);
 		}
 
 		//! Get the absolute transformation of the node. Is recalculated every OnAnimate()-call.
@@ -186,6 +219,13 @@ namespace scene
 		}
 
 
+		//! Get a number which changes with each change of the absolute transformation
+		u32 getTransformRevision() const
+		{
+			return TransformRevision;
+		}
+
+
 		//! Returns the relative transformation of the scene node.
 		/** The relative transformation is stored internally as 3
 		vectors: translation, rotation and scale. To get the relative
@@ -258,6 +298,8 @@ namespace scene
 		virtual void setID(s32 id)
 		{
 			ID = id;
+			if (NodeRegistry)
+				NodeRegistry->updateNode(this);
 		}
 
 
@@ -277,6 +319,9 @@ namespace scene
 				child->remove(); // remove from old parent
 				Children.push_back(child);
 				child->Parent = this;
+				child->TransformDirty = true;
+				child->setSpatialIndex(SpatialIndex);
+				child->setNodeRegistry(NodeRegistry);
 			}
 		}
 
@@ -294,6 +339,9 @@ namespace scene
 				if ((*it) == child)
 				{
 					(*it)->Parent = 0;
+					(*it)->TransformDirty = true;
+					(*it)->setSpatialIndex(0);
+					(*it)->setNodeRegistry(0);
 					(*it)->drop();
 					Children.erase(it);
 					return true;
@@ -313,6 +361,9 @@ namespace scene
 			for (; it != Children.end(); ++it)
 			{
 				(*it)->Parent = 0;
+				(*it)->TransformDirty = true;
+				(*it)->setSpatialIndex(0);
+				(*it)->setNodeRegistry(0);
 				(*it)->drop();
 			}
 
@@ -403,6 +454,7 @@ namespace scene
 		virtual void setScale(const core::vector3df& scale)
 		{
 			RelativeScale = scale;
+			TransformDirty = true;
 		}
 
 
@@ -423,6 +475,7 @@ namespace scene
 		virtual void setRotation(const core::vector3df& rotation)
 		{
 			RelativeRotation = rotation;
+			TransformDirty = true;
 		}
 
 
@@ -442,6 +495,7 @@ namespace scene
 		virtual void setPosition(const core::vector3df& newpos)
 		{
 			RelativeTranslation = newpos;
+			TransformDirty = true;
 		}
 
 
@@ -519,7 +573,7 @@ namespace scene
 
 		//! Returns a const reference to the list of all children.
 		/** \return The list of all children of this node. */
-		const std::list<ISceneNode*>& getChildren() const
+		const ISceneNodeList& getChildren() const
 		{
 			return Children;
 		}
@@ -543,16 +597,116 @@ namespace scene
 
 		//! Updates the absolute position based on the relative and the parents position
 		/** Note: This does not recursively update the parents absolute positions, so if you have a deeper
-			hierarchy you might want to update the parents first.*/
+			hierarchy you might want to update the parents first.
+			Nothing is computed if neither the relative transformation nor the absolute
+			transformation of the parent changed since the last call, see markTransformDirty(). */
 		virtual void updateAbsolutePosition()
 		{
-			if (Parent)
-			{
-				AbsoluteTransformation =
-					Parent->getAbsoluteTransformation() * getRelativeTransformation();
-			}
-			else
-				AbsoluteTransformation = getRelativeTransformation();
+			const u32 parentRevision = Parent ? Parent->TransformRevision : 0;
+			if (!TransformDirty && parentRevision == ParentTransformRevision)
+				return;
+
+			TransformDirty = false;
+			ParentTransformRevision = parentRevision;
+
+			const core::matrix4 transformation = Parent ?
+				Parent->getAbsoluteTransformation() * getRelativeTransformation() :
+				getRelativeTransformation();
+
+			if (transformation == AbsoluteTransformation)
+				return;
+
+			if (SpatialIndex)
+				SpatialIndex->updateNode(this);
+
+			AbsoluteTransformation = transformation;
+			++TransformRevision;
+		}
+
+
+		//! Makes the next updateAbsolutePosition() recompute the absolute transformation
+		/** setPosition(), setRotation(), setScale() and changing the parent do
+		this already. Scene nodes which change RelativeTranslation,
+		RelativeRotation or RelativeScale directly, or whose
+		getRelativeTransformation() depends on anything else, have to call it
+		after each change. */
+		void markTransformDirty()
+		{
+			TransformDirty = true;
+		}
+
+
+		//! Tells the spatial index that the bounding box of this node changed
+		/** Moving nodes are updated in updateAbsolutePosition(), this is
+		only needed after changing the bounding box of a node without moving
+		it. Does nothing if the scene manager has no spatial index. */
+		void updateSpatialIndex()
+		{
+			if (SpatialIndex)
+				SpatialIndex->updateNode(this);
+		}
+
+
+		//! Sets the spatial index of this node and all children
+		/** Called when nodes are added to or removed from a scene graph, or
+		when the scene manager enables its spatial index. Nodes are removed
+		from their previous index. */
+		void setSpatialIndex(ISpatialIndex* index)
+		{
+			if (SpatialIndex == index)
+				return;
+
+			if (SpatialIndex)
+				SpatialIndex->removeNode(this);
+			SpatialIndex = index;
+			if (SpatialIndex)
+				SpatialIndex->updateNode(this);
+
+			ISceneNodeList::iterator it = Children.begin();
+			for (; it != Children.end(); ++it)
+				(*it)->setSpatialIndex(index);
+		}
+
+
+		//! Sets the node registry of this node and all children
+		/** Called when nodes are added to or removed from a scene graph, or
+		when the scene manager enables its registry. Nodes are removed from
+		their previous registry. */
+		void setNodeRegistry(ISceneNodeRegistry* registry)
+		{
+			if (NodeRegistry == registry)
+				return;
+
+			if (NodeRegistry)
+				NodeRegistry->removeNode(this);
+			NodeRegistry = registry;
+			if (NodeRegistry)
+				NodeRegistry->updateNode(this);
+
+			ISceneNodeList::iterator it = Children.begin();
+			for (; it != Children.end(); ++it)
+				(*it)->setNodeRegistry(registry);
+		}
+
+
+		//! Get the registry finding this node by its id, name and type, 0 if there is none
+		ISceneNodeRegistry* getNodeRegistry() const
+		{
+			return NodeRegistry;
+		}
+
+
+		//! Get the id of this node in its spatial index, -1 if it has none
+		s32 getSpatialIndexId() const
+		{
+			return SpatialIndexId;
+		}
+
+
+		//! Sets the id of this node in its spatial index, only used by ISpatialIndex implementations
+		void setSpatialIndexId(s32 id)
+		{
+			SpatialIndexId = id;
 		}
 
 
@@ -598,6 +752,8 @@ namespace scene
 			RelativeTranslation = toCopyFrom->RelativeTranslation;
 			RelativeRotation = toCopyFrom->RelativeRotation;
 			RelativeScale = toCopyFrom->RelativeScale;
+			TransformDirty = true;
+			++TransformRevision;
 			ID = toCopyFrom->ID;
 			AutomaticCullingState = toCopyFrom->AutomaticCullingState;
 			DebugDataVisible = toCopyFrom->DebugDataVisible;
@@ -628,7 +784,7 @@ namespace scene
 		}
 
 		//! Name of the scene node.
-		core::stringc Name;
+		core::atom Name;
 
 		//! Absolute transformation of the node.
 		core::matrix4 AbsoluteTransformation;
@@ -646,7 +802,7 @@ namespace scene
 		ISceneNode* Parent;
 
 		//! List of all children of this node
-		std::list<ISceneNode*> Children;
+		ISceneNodeList Children;
 
 		//! Pointer to the scene manager
 		ISceneManager* SceneManager;
@@ -665,6 +821,29 @@ namespace scene
 
 		//! Is debug object?
 		bool IsDebugObject;
+
+		//! Index updated on changes of the absolute transformation, 0 if there is none
+		ISpatialIndex* SpatialIndex;
+
+		//! Id of this node in SpatialIndex
+		s32 SpatialIndexId;
+
+		//! Registry told about changes of the id and name, 0 if there is none
+		ISceneNodeRegistry* NodeRegistry;
+
+		//! The relative transformation or the parent changed since the last updateAbsolutePosition()
+		bool TransformDirty;
+
+		//! Incremented on each change of AbsoluteTransformation
+		u32 TransformRevision;
+
+		//! TransformRevision of the parent used for AbsoluteTransformation
+		u32 ParentTransformRevision;
+
+		//! Cache of getTransformedBoundingBox(), valid if TransformedBoxRevision is TransformRevision + 1
+		mutable core::aabbox3d<f32> TransformedBox;
+		mutable core::aabbox3d<f32> TransformedBoxSource;
+		mutable u32 TransformedBoxRevision;
 	};
 
 
@@ -0,0 +1,36 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_SCENE_NODE_REGISTRY_H_INCLUDED__
+#define __I_SCENE_NODE_REGISTRY_H_INCLUDED__
+
+namespace irr
+{
+namespace scene
+{
+	class ISceneNode;
+
+//! Finds scene nodes by their id, name and type without walking the scene graph.
+/** Enabled with ISceneManager::setNodeRegistryEnabled(). The registry holds
+the root scene node and all nodes below it. Nodes report being added, removed
+and getting a new id or name themselves, the registry only reads their keys
+before the next lookup, as the type of a node isn't known yet while its
+constructor adds it to its parent. */
+class ISceneNodeRegistry
+{
+public:
+	virtual ~ISceneNodeRegistry() {}
+
+	//! Marks the keys of a node as outdated, adding the node if it isn't registered yet
+	/** Called by ISceneNode, doesn't access the node until the next lookup. */
+	virtual void updateNode(ISceneNode* node) = 0;
+
+	//! Removes a node from the registry
+	/** Called by ISceneNode when a node leaves the scene graph. */
+	virtual void removeNode(ISceneNode* node) = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -0,0 +1,43 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_SCREEN_SHOT_REQUEST_H_INCLUDED__
+#define __I_SCREEN_SHOT_REQUEST_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+
+namespace irr
+{
+namespace video
+{
+	class IImage;
+
+//! Handle of a screenshot which is read back from the GPU without waiting for it.
+/** Created by IVideoDriver::createScreenShotAsync(). The driver copies the
+pixels into main memory during a later IVideoDriver::endScene(), once the GPU
+has finished rendering the frame. After that isReady() returns true and
+createImage() can be called from any thread, the flip and the color format
+conversion are done within that call. */
+class IScreenShotRequest : public virtual IReferenceCounted
+{
+public:
+	//! Check if the pixels have arrived in main memory
+	/** Can be called from any thread. */
+	virtual bool isReady() const = 0;
+
+	//! Check if the readback failed
+	/** A failed request is never ready. */
+	virtual bool isFailed() const = 0;
+
+	//! Create the image of the screenshot
+	/** Does the flip and color conversion at each call, so the caller
+	should keep the result instead of calling it again.
+	\return The image in the format given to createScreenShotAsync(), or 0
+	if the request isn't ready yet. Drop the image when done with it. */
+	virtual IImage* createImage() const = 0;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
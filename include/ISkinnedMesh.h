@@ -8,6 +8,7 @@
 #include "irrArray.h"
 #include "IBoneSceneNode.h"
 #include "IAnimatedMesh.h"
+#include "IAnimationClip.h"
 #include "SSkinMeshBuffer.h"
 
 namespace irr
@@ -56,6 +57,32 @@ namespace scene
 		sensitive). Unmatched joints will not be animated. */
 		virtual bool useAnimationFrom(const ISkinnedMesh *mesh) = 0;
 
+		//! Creates a clip of the animation played by the keys of the joints
+		/** The keys are sampled from frame 0 to the last frame, so the
+		clip can be shared by meshes with the same joint names, and this
+		mesh may be dropped afterwards.
+		\param samplesPerFrame Samples taken per frame, more keep motion
+		between the frames which the linear interpolation of samples loses.
+		\return The clip, drop it when done, or 0 if the mesh isn't animated. */
+		virtual IAnimationClip* createAnimationClip(f32 samplesPerFrame=1.f) = 0;
+
+		//! Plays a clip instead of the keys of the joints
+		/** The joints are matched with the joints of the clip by name when
+		the first clip of a skeleton signature is set. Clips of the same
+		signature reuse the mapping, so switching clips doesn't compare names.
+		useAnimationFrom() removes the clip again.
+		\param clip Clip to play, it is grabbed. 0 to play the keys of the
+		joints again.
+		\return True if all joints of this mesh were matched. Unmatched
+		joints are not animated. */
+		virtual bool setAnimationClip(IAnimationClip* clip) = 0;
+
+		//! Gets the clip set by setAnimationClip(), or 0
+		virtual IAnimationClip* getAnimationClip() const = 0;
+
+		//! Gets the signature of the skeleton, see IAnimationClip::getSkeletonSignature()
+		virtual u64 getSkeletonSignature() const = 0;
+
 		//! Update Normals when Animating
 		/** \param on If false don't animate, which is faster.
 		Else update normals, which allows for proper lighting of
@@ -76,9 +103,35 @@ namespace scene
 		virtual void convertMeshToTangents() = 0;
 
 		//! Allows to enable hardware skinning.
-		/* This feature is not implemented in Irrlicht yet */
+		/** The mesh buffers moved by joints get vertices of type
+		video::EVT_SKINNED, which hold the joint weights, and the joint
+		matrices are passed to the driver instead of moving the vertices on
+		the CPU. Only drivers supporting video::EVDF_HARDWARE_SKINNING draw
+		such buffers. As the vertices don't change anymore, the buffers can
+		use the hardware mapping hint EHM_STATIC.
+		Fails for buffers with more than video::MAX_SKINNING_JOINTS joints or
+		with vertex types other than video::EVT_STANDARD.
+		\return True if hardware skinning is enabled afterwards. */
 		virtual bool setHardwareSkinning(bool on) = 0;
 
+		//! Skins the frames of a loop in advance, for meshes played by many nodes.
+		/** Scene nodes showing a frame of the loop then take the skinned
+		copy of their mesh from the baked frames, or interpolate it between
+		them, instead of animating the joints and skinning the mesh. Not
+		used with hardware skinning. Replaces frames baked before, and the
+		frames are baked again when the joints change.
+		\param begin First frame of the loop.
+		\param end Last frame of the loop.
+		\param samplesPerFrame Amount of baked frames per frame.
+		\param interpolate True to interpolate the vertices between the
+		baked frames, false to show the nearest baked frame as it is,
+		which costs nothing per frame.
+		\return True if successful. */
+		virtual bool bakeFrames(s32 begin, s32 end, u32 samplesPerFrame=1, bool interpolate=true) = 0;
+
+		//! Drops the frames baked by bakeFrames()
+		virtual void clearBakedFrames() = 0;
+
 		//! Refreshes vertex data cached in joints such as positions and normals
 		virtual void refreshJointCache() = 0;
 
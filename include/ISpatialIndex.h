@@ -0,0 +1,56 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_SPATIAL_INDEX_H_INCLUDED__
+#define __I_SPATIAL_INDEX_H_INCLUDED__
+
+#include "irrArray.h"
+#include "aabbox3d.h"
+#include "line3d.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ISceneNode;
+
+//! Finds scene nodes by their position without walking the whole scene graph.
+/** Enabled with ISceneManager::setSpatialIndexEnabled(). The index holds the
+transformed bounding box of each node below the root scene node. Nodes report
+changes of their absolute transformation themselves, the index only updates
+the boxes of those nodes before the next query. Queries return nodes
+regardless of their visibility. */
+class ISpatialIndex
+{
+public:
+	virtual ~ISpatialIndex() {}
+
+	//! Marks the box of a node as outdated, adding the node if it isn't indexed yet
+	/** Called by ISceneNode, doesn't access the node until the next query. */
+	virtual void updateNode(ISceneNode* node) = 0;
+
+	//! Removes a node from the index
+	/** Called by ISceneNode when a node leaves the scene graph. */
+	virtual void removeNode(ISceneNode* node) = 0;
+
+	//! Get all nodes whose transformed bounding box intersects a box
+	/** \param box Box in world space.
+	\param outNodes Receives the nodes, in no particular order. */
+	virtual void getNodesInBox(const core::aabbox3df& box, core::array<ISceneNode*>& outNodes) = 0;
+
+	//! Get all nodes whose transformed bounding box intersects a sphere
+	/** \param center Center of the sphere in world space.
+	\param radius Radius of the sphere.
+	\param outNodes Receives the nodes, in no particular order. */
+	virtual void getNodesInRadius(const core::vector3df& center, f32 radius, core::array<ISceneNode*>& outNodes) = 0;
+
+	//! Get all nodes whose transformed bounding box is crossed by a line segment
+	/** \param line Line segment in world space.
+	\param outNodes Receives the nodes, in no particular order. */
+	virtual void getNodesOnLine(const core::line3df& line, core::array<ISceneNode*>& outNodes) = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
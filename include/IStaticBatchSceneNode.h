@@ -0,0 +1,64 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __I_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+#define __I_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+	class IMeshSceneNode;
+
+//! A scene node drawing many static mesh scene nodes with few draw calls
+/** The meshes of the member nodes are merged with their transformations
+into large static buffers, one per material, vertex type and cell of a grid
+of cubes. Each member belongs to the cell holding the center of its box, so
+cells are culled as a whole. The cells are drawn like the chunks of an
+IChunkGridSceneNode, one IVideoDriver::drawMeshBufferBatch() call per
+material.
+
+Members are hidden, with their children, while they are in the batch.
+Adding or removing a member only merges its cell again, at the next
+registration of the batch. Members removed from the scene graph leave the
+batch by themselves. Moving a member has no effect until it is removed and
+added again. The materials of the node are those of the merged buffers,
+changing one changes the drawn buffers but not the members. */
+class IStaticBatchSceneNode : public ISceneNode
+{
+public:
+
+	//! Constructor
+	IStaticBatchSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1,1,1))
+		: ISceneNode(parent, mgr, id, position, rotation, scale) {}
+
+	//! Adds a mesh scene node to the batch
+	/** Its mesh is merged with its current absolute transformation, relative
+	to the batch, and with its materials. Levels of detail and impostors of
+	the node are not used. The node is hidden until it is removed again.
+	\param node Node to add, grabbed by the batch. */
+	virtual void addNode(IMeshSceneNode* node) = 0;
+
+	//! Removes a node from the batch and shows it again
+	virtual void removeNode(IMeshSceneNode* node) = 0;
+
+	//! Get the number of nodes in the batch
+	virtual u32 getNodeCount() const = 0;
+
+	//! Get the number of cells holding nodes
+	virtual u32 getCellCount() const = 0;
+
+	//! Get the number of cells which passed culling in the last rendered frame
+	virtual u32 getVisibleCellCount() const = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+
+#endif
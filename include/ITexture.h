@@ -6,6 +6,7 @@
 #define __I_TEXTURE_H_INCLUDED__
 
 #include "IReferenceCounted.h"
+#include "irrMemory.h"
 #include "IImage.h"
 #include "dimension2d.h"
 #include "EDriverTypes.h"
@@ -105,6 +106,73 @@ enum E_TEXTURE_CREATION_FLAG
 	*/
 	ETCF_SUPPORT_VERTEXT_TEXTURE = 0x00000200,
 
+	//! Allow the driver to copy small textures into a shared texture atlas
+	/** Default is false.
+	2D drawing functions then use the atlas, so images of different
+	textures can be drawn with a single draw call. The textures themselves
+	stay unchanged, changing one through lock() removes it from the atlas.
+	Currently only affects the OpenGL 3 and OpenGL ES 2 drivers.
+	*/
+	ETCF_ALLOW_ATLAS = 0x00000400,
+
+	//! Allow the driver to upload the texture data over the next frames
+	/** Default is false.
+	The data is copied into a staging buffer at the end of a frame and
+	copied into the texture at the end of the next one, limited by
+	SIrrlichtCreationParameters::TextureUploadBudget. Until then
+	ITexture::isReady() returns false and the content is undefined.
+	Locking the texture uploads it right away.
+	Drivers supporting EVDF_SHARED_CONTEXT_UPLOAD upload the data on a
+	thread of their own instead, without limit.
+	Only used by drivers supporting EVDF_TEXTURE_UPLOAD_QUEUE.
+	*/
+	ETCF_DEFERRED_UPLOAD = 0x00000800,
+
+	//! Allow the driver to stream the mip levels of the texture
+	/** Default is false.
+	Only the small mip levels are uploaded on creation, the larger ones
+	follow over the next frames as long as ITexture::setScreenSizeHint
+	asks for them. When SIrrlichtCreationParameters::TextureStreamingBudget
+	is exceeded, the largest levels of the least needed textures are dropped
+	again. The texture keeps a copy of all levels in main memory.
+	Only used for 2D textures by drivers supporting EVDF_TEXTURE_STORAGE.
+	*/
+	ETCF_STREAM_MIP_MAPS = 0x00001000,
+
+	//! Create the mip levels on the CPU instead of the GPU
+	/** Default is false.
+	This flag is only used when ETCF_CREATE_MIP_MAPS is also enabled.
+	Textures loaded from files get their levels with IImage::createMipMaps
+	when the file is decoded, for IVideoDriver::getTextureAsync on the
+	loading thread. Other textures create them when they are created.
+	Compressed textures and the depth formats still use the GPU.
+	Currently only affects the OpenGL drivers.
+	*/
+	ETCF_CREATE_MIP_MAPS_ON_CPU = 0x00002000,
+
+	//! The colors are sRGB coded, mip levels created on the CPU are filtered in linear space
+	/** Default is false. See ETCF_CREATE_MIP_MAPS_ON_CPU. */
+	ETCF_SRGB_MIP_MAPS = 0x00004000,
+
+	//! Mip levels created on the CPU keep the share of pixels passing an alpha test at 0.5
+	/** Default is false. Keeps alpha tested cutouts like foliage from
+	thinning out in the distance. See ETCF_CREATE_MIP_MAPS_ON_CPU. */
+	ETCF_PRESERVE_ALPHA_COVERAGE = 0x00008000,
+
+	//! Keep the color format of images the driver can upload as they are
+	/** Default is false. Textures are otherwise created in the format
+	chosen by ETCF_ALWAYS_16_BIT, ETCF_ALWAYS_32_BIT and the other format
+	flags, e.g. 24 bit images become 32 bit textures. Keeping the format
+	saves converting and copying the images, and their memory. */
+	ETCF_PRESERVE_IMAGE_FORMAT = 0x00010000,
+
+	//! The alpha channel holds a signed distance field instead of a coverage
+	/** Default is false. Alpha 0.5 is the edge of the shape, higher values
+	are inside of it. Drivers with 2D shaders draw such textures with sharp
+	edges at any scale, see ITexture::isDistanceField(). Textures with this
+	flag are never put into a texture atlas. */
+	ETCF_DISTANCE_FIELD = 0x00020000,
+
 	/** This flag is never used, it only forces the compiler to compile
 	these enumeration values to 32 bit. */
 	ETCF_FORCE_32_BIT_DO_NOT_USE = 0x7fffffff
@@ -147,7 +215,18 @@ enum E_TEXTURE_LOCK_FLAGS
 	upload it again to the card.
 	If you disable this flag you get the memory just as it is on the graphic card.
 	For backward compatibility reasons this flag is enabled by default. */
-	ETLF_FLIP_Y_UP_RTT = 1	
+	ETLF_FLIP_Y_UP_RTT = 1,
+
+	//! Read the texture without waiting for the GPU
+	/** Only used together with ETLM_READ_ONLY. The first lock() starts
+	copying the texture into a pixel buffer and returns 0, while
+	ITexture::isReadbackPending() is true. Usually one or two frames later
+	the pixels arrived and the next lock() with the same mipmap level and
+	layer returns them like a synchronous lock(). Combine it with
+	ETLF_FLIP_Y_UP_RTT by casting the or'ed flags to E_TEXTURE_LOCK_FLAGS.
+	Drivers which can't read back asynchronously (everything except the
+	OpenGL 3 and OpenGL ES 3 drivers) ignore the flag and lock synchronously. */
+	ETLF_ASYNC_READ = 2
 };
 
 //! Where did the last IVideoDriver::getTexture call find this texture
@@ -160,7 +239,14 @@ enum E_TEXTURE_SOURCE
 	ETS_FROM_CACHE,
 
 	//! Texture had to be loaded
-	ETS_FROM_FILE
+	ETS_FROM_FILE,
+
+	//! IVideoDriver::getTextureAsync is still loading the texture
+	ETS_LOADING,
+
+	//! Reference to a texture file a mesh loader found in a mesh file
+	/** Only used while a mesh is loaded, see scene::MESH_LOADER_TEXTURES. */
+	ETS_UNRESOLVED
 };
 
 //! Enumeration describing the type of ITexture.
@@ -182,13 +268,13 @@ NULL device, their textures are compatible. If you try to use a texture
 created by one device with an other device, the device will refuse to do that
 and write a warning or an error message to the output buffer.
 */
-class ITexture : public virtual IReferenceCounted
+class ITexture : public virtual IReferenceCounted, public core::CMemoryTagged<core::EMC_VIDEO>
 {
 public:
 
 	//! constructor
 	ITexture(const io::path& name, E_TEXTURE_TYPE type) : NamedPath(name), DriverType(EDT_NULL), OriginalColorFormat(ECF_UNKNOWN),
-		ColorFormat(ECF_UNKNOWN), Pitch(0), HasMipMaps(false), IsRenderTarget(false), Source(ETS_UNKNOWN), Type(type)
+		ColorFormat(ECF_UNKNOWN), Pitch(0), HasMipMaps(false), IsRenderTarget(false), IsDistanceField(false), Source(ETS_UNKNOWN), Type(type)
 	{
 	}
 
@@ -282,6 +368,36 @@ public:
 	\return True if this is a render target, otherwise false. */
 	bool isRenderTarget() const { return IsRenderTarget; }
 
+	//! Check whether the alpha channel holds a signed distance field
+	/** Set for textures created with ETCF_DISTANCE_FIELD. The OpenGL ES 2
+	and OpenGL 3 drivers draw 2D images of them with a shader turning the
+	distances into smooth edges, so glyphs stay sharp when scaled.
+	\return True if the texture is a distance field, otherwise false. */
+	bool isDistanceField() const { return IsDistanceField; }
+
+	//! Check whether the texture data was uploaded
+	/** \return False while the upload of a texture created with
+	ETCF_DEFERRED_UPLOAD is still queued, otherwise true. */
+	virtual bool isReady() const { return true; }
+
+	//! Check whether a lock() with ETLF_ASYNC_READ still waits for the GPU
+	/** \return True while the pixels are on their way, lock() returns
+	0 until then. */
+	virtual bool isReadbackPending() const { return false; }
+
+	//! Check whether the texture is in video memory
+	/** \return False if the texture was evicted to stay within the
+	budget set by IVideoDriver::setTextureMemoryBudget(). It is uploaded
+	again when it is used. */
+	virtual bool isResident() const { return true; }
+
+	//! Set the size the texture is expected to cover on screen
+	/** Textures created with ETCF_STREAM_MIP_MAPS only keep the mip
+	levels needed for this size. 0 asks for all levels, which is the
+	default.
+	\param size Width or height in pixels, whichever is larger. */
+	virtual void setScreenSizeHint(u32 size) {}
+
 	//! Get name of texture (in most cases this is the filename)
 	const io::SNamedPath& getName() const { return NamedPath; }
 
@@ -346,6 +462,7 @@ protected:
 	u32 Pitch;
 	bool HasMipMaps;
 	bool IsRenderTarget;
+	bool IsDistanceField;
 	E_TEXTURE_SOURCE Source;
 	E_TEXTURE_TYPE Type;
 };
@@ -66,6 +66,20 @@ public:
 	//! sets current virtual time
 	virtual void setTime(u32 time) = 0;
 
+	//! Returns current real time in nanoseconds of a monotonic clock.
+	/** Unlike getRealTime() this clock is never adjusted and doesn't
+	wrap around, so differences of two values measure elapsed time with
+	sub-millisecond precision. The value doesn't start with 0. */
+	virtual u64 getRealTimeNs() const = 0;
+
+	//! Returns current virtual time in nanoseconds.
+	/** The same time as getTime(), which is this value divided by
+	1000000, but with the precision of getRealTimeNs(). */
+	virtual u64 getTimeNs() const = 0;
+
+	//! Sets current virtual time in nanoseconds
+	virtual void setTimeNs(u64 time) = 0;
+
 	//! Stops the virtual timer.
 	/** The timer is reference counted, which means everything which calls
 	stop() will also have to call start(), otherwise the timer may not
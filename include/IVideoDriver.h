@@ -19,6 +19,9 @@
 #include "EDriverFeatures.h"
 #include "SExposedVideoData.h"
 #include "SOverrideMaterial.h"
+#include "IScreenShotRequest.h"
+#include "S2DDrawList.h"
+#include "ILogger.h"
 
 namespace irr
 {
@@ -41,11 +44,16 @@ namespace video
 	struct S3DVertex;
 	struct S3DVertex2TCoords;
 	struct S3DVertexTangents;
+	struct S3DInstance;
 	class IImageLoader;
 	class IImageWriter;
+	class IImageWriteCallback;
+	class IRenderCommand;
 	class IMaterialRenderer;
 	class IGPUProgrammingServices;
 	class IRenderTarget;
+	class IPostProcessChain;
+	class IFrameReplay;
 
 	//! enumeration for geometry transformation states
 	enum E_TRANSFORMATION_STATE
@@ -117,6 +125,169 @@ namespace video
 		0
 	};
 
+	//! How drivers check for errors of the graphics API, see IVideoDriver::setErrorCheckMode()
+	enum E_ERROR_CHECK_MODE
+	{
+		//! Errors are not checked
+		EECM_NONE=0,
+
+		//! Errors and warnings are reported by the debug output of the graphics API
+		/** Needs KHR_debug, OpenGL 4.3 or OpenGL ES 3.2. The messages arrive
+		asynchronously, so nothing waits for the GPU, but they may be logged
+		some calls after the call causing them. */
+		EECM_DEBUG_OUTPUT,
+
+		//! Debug output reported within the causing call, and error queries after calls
+		/** Stalls the pipeline on some drivers. The error queries are only
+		compiled into debug builds. */
+		EECM_SYNCHRONOUS
+	};
+
+	//! GPU time measured for a scope, see IVideoDriver::beginGPUTimerScope()
+	struct SGPUTimerResult
+	{
+		//! Name passed to beginGPUTimerScope()
+		core::stringc Name;
+
+		//! Number of enclosing scopes
+		u32 Depth;
+
+		//! GPU time between start and end of the scope
+		f32 Milliseconds;
+	};
+
+	//! Work done by the driver during a frame, see IVideoDriver::getFrameStats()
+	struct SFrameStats
+	{
+		SFrameStats()
+		{
+			reset();
+		}
+
+		void reset()
+		{
+			DrawCalls = 0;
+			PrimitivesDrawn = 0;
+			VerticesUploaded = 0;
+			BufferBytesUploaded = 0;
+			BufferReallocations = 0;
+			TextureBinds = 0;
+			ProgramSwitches = 0;
+			MaterialChanges = 0;
+			RenderTargetSwitches = 0;
+			TextureBytesConverted = 0;
+			TextureBytesKept = 0;
+		}
+
+		//! Number of draw calls
+		u32 DrawCalls;
+
+		//! Number of primitives drawn
+		u32 PrimitivesDrawn;
+
+		//! Vertices copied to the GPU, from client memory or into hardware buffers
+		u32 VerticesUploaded;
+
+		//! Bytes copied into GPU buffers
+		u32 BufferBytesUploaded;
+
+		//! Number of times the storage of a GPU buffer was (re)allocated
+		u32 BufferReallocations;
+
+		//! Number of texture bindings changed
+		u32 TextureBinds;
+
+		//! Number of shader program changes
+		u32 ProgramSwitches;
+
+		//! Number of times a different material was applied
+		u32 MaterialChanges;
+
+		//! Number of render target changes
+		u32 RenderTargetSwitches;
+
+		//! Bytes of images converted or resized to create textures
+		u32 TextureBytesConverted;
+
+		//! Bytes of images new textures keep in main memory, see ETCF_ALLOW_MEMORY_COPY
+		u32 TextureBytesKept;
+	};
+
+	//! Distribution of one kind of frame time, see SFrameTimeStats
+	struct SFrameTimePercentiles
+	{
+		SFrameTimePercentiles() : Samples(0), Median(0.f), Percentile95(0.f),
+			Percentile99(0.f), Max(0.f) {}
+
+		//! Number of frames this time was measured for
+		u32 Samples;
+
+		//! Times in milliseconds half, 95% and 99% of the frames didn't exceed
+		f32 Median;
+		f32 Percentile95;
+		f32 Percentile99;
+
+		//! Longest time in milliseconds
+		f32 Max;
+	};
+
+	//! Frame times of the latest frames, see IVideoDriver::getFrameTimeStats()
+	struct SFrameTimeStats
+	{
+		SFrameTimeStats() : Frames(0), Hitches(0) {}
+
+		//! Number of frames the statistics cover
+		u32 Frames;
+
+		//! Frames whose frame time exceeded the hitch threshold
+		u32 Hitches;
+
+		//! Time between the endScene() calls of consecutive frames
+		SFrameTimePercentiles FrameTime;
+
+		//! Time from beginScene() to endScene() on the CPU
+		SFrameTimePercentiles CPUTime;
+
+		//! Time the GPU took for the frame
+		/** Only measured by drivers supporting EVDF_TIMER_QUERY. The
+		results arrive a few frames later, so the latest frames have none. */
+		SFrameTimePercentiles GPUTime;
+
+		//! Time endScene() took to present the frame
+		/** Includes waiting for vsync and for setMaxFramesInFlight(). */
+		SFrameTimePercentiles SwapTime;
+	};
+
+	//! Video memory used by textures, see IVideoDriver::getTextureResidencyStats()
+	struct STextureResidencyStats
+	{
+		STextureResidencyStats() : TextureCount(0), ResidentCount(0), ResidentBytes(0),
+			EvictedBytes(0), Budget(0), Evictions(0), Restores(0)
+		{
+		}
+
+		//! Number of textures tracked by the driver
+		u32 TextureCount;
+
+		//! Number of textures in video memory
+		u32 ResidentCount;
+
+		//! Approximate video memory used by the resident textures
+		u64 ResidentBytes;
+
+		//! Approximate video memory the evicted textures need when used again
+		u64 EvictedBytes;
+
+		//! Memory budget, 0 if unlimited
+		u64 Budget;
+
+		//! Number of evictions since the driver was created
+		u32 Evictions;
+
+		//! Number of evicted textures uploaded again since the driver was created
+		u32 Restores;
+	};
+
 	//! Interface to driver which is able to perform 2d and 3d graphics functions.
 	/** This interface is one of the most important interfaces of
 	the Irrlicht Engine: All rendering and texture manipulation is done with
@@ -167,6 +338,100 @@ namespace video
 		\return False if failed and true if succeeded. */
 		virtual bool endScene() = 0;
 
+		//! Tells the driver which part of the screen the next frame changes
+		/** Call before beginScene(), for frames which only change a small
+		part of the screen, like in gui applications, see
+		gui::IGUIEnvironment::getDrawDamage(). If the platform reports the
+		age of the back buffer, the frame keeps its old content: the screen
+		is only cleared and drawn within the rectangle changed since that
+		buffer was presented, everything else drawn to the screen is
+		clipped. The compositor is told which part changed where the
+		platform supports it, and tile based GPUs can skip the rest. The
+		frame has to draw everything within the rectangle, the skipped
+		drawing has to look the same as in the previous frames. Otherwise,
+		and for render targets, frames are drawn completely. Supported by
+		the OpenGL ES 2 and OpenGL 3 drivers with EGL, see
+		IContextManager::getBufferAge().
+		\param rect Area of the screen the frame changes. Applies to the next
+		frame only. */
+		virtual void setFrameDamage(const core::rect<s32>& rect) = 0;
+
+		//! Sets how many vertical blanks the presentation of endScene() waits for
+		/** \param interval 0 presents right away and may tear, 1 waits
+		for the next vertical blank. Negative values enable adaptive vsync:
+		a frame finished in time waits for vertical blank -interval, a late
+		one is presented right away instead of losing a whole refresh
+		period. Where adaptive vsync is missing this is normal vsync.
+		\return False if the driver or the platform can't change the
+		interval. */
+		virtual bool setSwapInterval(s32 interval) = 0;
+
+		//! Limits how many frames the GPU may lag behind endScene()
+		/** With vsync the driver queues finished frames while the GPU
+		is behind, each adding a refresh period of input latency. With a
+		limit endScene() waits until the GPU finished all but that many
+		frames.
+		\param frames Frames the GPU may lag behind, 1 is the lowest
+		latency. 0 removes the limit, which is the default.
+		\return False if the driver can't limit the frames. */
+		virtual bool setMaxFramesInFlight(u32 frames) = 0;
+
+		//! Selects how the driver checks for errors of the graphics API
+		/** Debug builds default to EECM_DEBUG_OUTPUT where it is supported
+		and to EECM_SYNCHRONOUS otherwise, release builds to EECM_NONE.
+		\return False if the driver doesn't support the mode. */
+		virtual bool setErrorCheckMode(E_ERROR_CHECK_MODE mode) = 0;
+
+		//! Discards debug output below a log level
+		/** Messages of the debug output are logged a few times per second
+		each, further repetitions are counted and their number is logged once
+		a second by endScene().
+		\param minLevel The severities of OpenGL map to ELL_ERROR (high),
+		ELL_WARNING (medium), ELL_INFORMATION (low) and ELL_DEBUG
+		(notification). Default: ELL_INFORMATION. */
+		virtual void setDebugMessageLevel(ELOG_LEVEL minLevel) = 0;
+
+		//! Enables or disables a message of the debug output
+		/** \param id ID the graphics API logs the message with. */
+		virtual void setDebugMessageEnabled(u32 id, bool enabled) = 0;
+
+		//! Moves all work on the rendering context to a thread of the driver
+		/** While the render thread runs, the application draws by queuing
+		IRenderCommand objects with queueRenderCommand() and hands each
+		recorded frame over with submitRenderCommands(). The render thread
+		executes one frame while the application simulates and records the
+		next one. Other methods of the driver, and the textures, buffers
+		and scene nodes drawn through it, must then only be used by the
+		commands. Window resizes reported by the device are passed on to
+		the render thread. On X11 the device enables Xlib thread support
+		for this. Requires EVDF_RENDER_THREAD.
+		\param enable True to start the render thread, false to execute
+		the submitted commands, stop the thread and take the context back
+		to the calling thread.
+		\return True if the render thread runs as requested. */
+		virtual bool setRenderThreadEnabled(bool enable) = 0;
+
+		//! Checks if the render thread of setRenderThreadEnabled() runs
+		virtual bool isRenderThreadEnabled() const = 0;
+
+		//! Records a command into the frame submitted by the next submitRenderCommands()
+		/** Recording takes no locks. Without a render thread the command
+		is executed right away.
+		\param command Command to execute. Not grabbed, it must stay
+		valid until the submitRenderCommands() following the one which
+		submitted it returns. */
+		virtual void queueRenderCommand(IRenderCommand* command) = 0;
+
+		//! Hands the recorded commands over to the render thread
+		/** Waits until the render thread finished the previously submitted
+		frame first, so at most one frame executes while the next one is
+		recorded. A frame usually begins with a command calling
+		beginScene() and ends with one calling endScene(). */
+		virtual void submitRenderCommands() = 0;
+
+		//! Waits until the render thread executed all submitted commands
+		virtual void finishRenderCommands() = 0;
+
 		//! Queries the features of the driver.
 		/** Returns true if a feature is available
 		\param feature Feature to query.
@@ -265,6 +530,25 @@ namespace video
 		IReferenceCounted::drop() for more information. */
 		virtual ITexture* getTexture(io::IReadFile* file) =0;
 
+		//! Get access to a named texture, loading it on worker threads.
+		/** Works like getTexture(), but returns right away. The file is
+		read and decoded by the image loaders on the worker threads of
+		io::IFileSystem::prefetchFiles(). Until then the texture is a grey
+		1x1 placeholder and ITexture::getSource() returns ETS_LOADING.
+		getTexture() of the same file returns the placeholder meanwhile.
+		A later endScene() gives the placeholder the loaded images, so
+		materials using it show the loaded texture without being changed.
+		ITexture::getSource() returns ETS_FROM_FILE then, or ETS_UNKNOWN if
+		the file couldn't be loaded and the placeholder stays.
+		Drivers without EVDF_ASYNC_TEXTURE_LOADING load the texture right
+		away like getTexture(). Messages the image loaders log are sent from
+		the worker threads.
+		\param filename Filename of the texture to be loaded.
+		\return Pointer to the texture, or 0 if the file doesn't exist.
+		This pointer should not be dropped. See IReferenceCounted::drop()
+		for more information. */
+		virtual ITexture* getTextureAsync(const io::path& filename) = 0;
+
 		//! Returns a texture by index
 		/** \param index: Index of the texture, must be smaller than
 		getTextureCount() Please note that this index might change when
@@ -439,6 +723,23 @@ namespace video
 		actual value of pixels. */
 		virtual u32 getOcclusionQueryResult(scene::ISceneNode* node) const =0;
 
+		//! Starts a named GPU timer scope.
+		/** Scopes can be nested and have to be ended with
+		endGPUTimerScope() before endScene(). The GPU time of a scope is
+		read without waiting for the GPU, so results show up a few frames
+		later in getGPUTimerResults(). Only does something if the driver
+		supports EVDF_TIMER_QUERY.
+		\param name Name of the scope in the results. */
+		virtual void beginGPUTimerScope(const c8* name) =0;
+
+		//! Ends the GPU timer scope which was started last.
+		virtual void endGPUTimerScope() =0;
+
+		//! Return the GPU timer scopes of the latest frame with results.
+		/** Scopes are in the order they were started in, so nested scopes
+		follow their parent. */
+		virtual const core::array<SGPUTimerResult>& getGPUTimerResults() const =0;
+
 		//! Create render target.
 		virtual IRenderTarget* addRenderTarget() = 0;
 
@@ -448,6 +749,48 @@ namespace video
 		//! Remove all render targets.
 		virtual void removeAllRenderTargets() = 0;
 
+		//! Lends a render target texture from the pool of transient ones
+		/** Textures given back by releaseTransientRenderTargetTexture() are
+		lent out again for the same size and format, so effects with several
+		passes share their intermediate textures instead of creating their
+		own. The free textures of the pool are removed when the window is
+		resized.
+		\param size Size of the texture.
+		\param format Color format of the texture.
+		\return The texture, or 0 if it could not be created. It must not
+		be dropped or removed, but given back instead. */
+		virtual ITexture* acquireTransientRenderTargetTexture(const core::dimension2d<u32>& size, ECOLOR_FORMAT format) = 0;
+
+		//! Gives a texture of acquireTransientRenderTargetTexture() back to the pool
+		virtual void releaseTransientRenderTargetTexture(ITexture* texture) = 0;
+
+		//! Lends a render target with its own textures from the pool of transient ones
+		/** Unlike a render target whose textures are exchanged by
+		IRenderTarget::setTexture(), the textures of a pooled target stay
+		attached, so switching between the targets needs no new attachments
+		and no completeness check of the framebuffer. Targets given back by
+		releaseTransientRenderTarget() are lent out again for the same
+		size and formats. The free targets of the pool are removed when the
+		window is resized.
+		\param size Size of the textures.
+		\param colorFormat Color format of the color texture, which is
+		IRenderTarget::getTexture()[0].
+		\param depthFormat Format of the depth texture, which is
+		IRenderTarget::getDepthStencil(), or ECF_UNKNOWN for none.
+		\return The render target, or 0 if a texture could not be created.
+		It must not be dropped or removed, and its textures must not be
+		changed, give it back instead. */
+		virtual IRenderTarget* acquireTransientRenderTarget(const core::dimension2d<u32>& size,
+			ECOLOR_FORMAT colorFormat, ECOLOR_FORMAT depthFormat = ECF_UNKNOWN) = 0;
+
+		//! Gives a render target of acquireTransientRenderTarget() back to the pool
+		virtual void releaseTransientRenderTarget(IRenderTarget* target) = 0;
+
+		//! Creates an empty chain of full screen shader passes
+		/** \return The chain. Drop it when it is no longer needed. See
+		IReferenceCounted::drop() for more information. */
+		virtual IPostProcessChain* createPostProcessChain() = 0;
+
 		//! Sets a boolean alpha channel on the texture based on a color key.
 		/** This makes the texture fully transparent at the texels where
 		this color key can be found when using for example draw2DImage
@@ -844,10 +1187,71 @@ namespace video
 					const core::position2d<s32>& end,
 					SColor color=SColor(255,255,255,255)) =0;
 
+		//! Starts recording the 2d images and rectangles drawn into a list
+		/** They are still drawn while recording. The list can be drawn
+		again with drawRecording2D() as long as nothing else than 2d images
+		and rectangles was drawn while recording. Recordings can be nested,
+		drawing a recording records it again.
+		\param list List to record into, its previous content is removed.
+		\return False if the driver can't record, nothing is recorded then. */
+		virtual bool beginRecording2D(S2DDrawList& list) =0;
+
+		//! Stops the recording started last by beginRecording2D()
+		/** \return True if the recorded list can be drawn again. */
+		virtual bool endRecording2D() =0;
+
+		//! Draws a list recorded by beginRecording2D() again
+		/** The list can't be drawn if it is invalid, was recorded on
+		another render target size, or textures were removed since.
+		\param list Recorded list
+		\return True if the list was drawn, false if it has to be recorded again. */
+		virtual bool drawRecording2D(const S2DDrawList& list) =0;
+
 		//! Draws a mesh buffer
 		/** \param mb Buffer to draw */
 		virtual void drawMeshBuffer(const scene::IMeshBuffer* mb) =0;
 
+		//! Draws several mesh buffers with the currently set material
+		/** Each buffer is drawn with its own world transformation. The
+		world transformation set before is changed by this call. Drivers
+		supporting EVDF_GPU_CULLING cull large batches of static buffers
+		sharing one world transformation on the GPU, against the view
+		frustum and the depth of the previous frame, and draw them with a
+		single indirect draw call.
+		\param mb Array of buffers to draw
+		\param worldMatrices Array of world transformations, one per buffer
+		\param count Number of entries in both arrays */
+		virtual void drawMeshBufferBatch(const scene::IMeshBuffer* const* mb,
+			const core::matrix4* worldMatrices, u32 count) =0;
+
+		//! Draws several instances of a mesh buffer with the currently set material
+		/** If the driver supports EVDF_INSTANCING and the shader of the
+		material reads the inInstanceTransform attribute, all instances are
+		drawn with a single draw call. The world transformation is identity
+		then, and the shader has to apply the instance transformation itself.
+		Otherwise each instance is drawn separately with its transformation
+		as world transformation, and the instance color and parameters are
+		ignored. The world transformation set before is changed by this call.
+		\param mb Buffer to draw
+		\param instances Array of instance data
+		\param count Number of instances */
+		virtual void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const S3DInstance* instances, u32 count) =0;
+
+		//! Draws a mesh buffer blended towards the vertices of another one
+		/** Drivers supporting EVDF_HARDWARE_MORPHING interpolate the
+		positions and normals in the vertex shader of the built-in
+		materials, reading both buffers from hardware buffers which are
+		uploaded once. Both buffers need the same vertex type and count,
+		a vertex mapping hint other than EHM_NEVER, and no EVT_SKINNED or
+		compact vertices. Otherwise only mb is drawn, like drawMeshBuffer()
+		does.
+		\param mb Buffer to draw, providing everything but the blended positions and normals
+		\param target Buffer to blend the positions and normals towards
+		\param blend Weight of target, from 0 for mb to 1 for target */
+		virtual void drawMeshBufferMorphed(const scene::IMeshBuffer* mb,
+			const scene::IMeshBuffer* target, f32 blend) =0;
+
 		//! Draws normals of a mesh buffer
 		/** \param mb Buffer to draw the normals of
 		\param length length scale factor of the normals
@@ -890,6 +1294,11 @@ namespace video
 		/** \return Size of screen or render window. */
 		virtual const core::dimension2d<u32>& getScreenSize() const =0;
 
+		//! Get the current render target
+		/** \return Render target set by setRenderTargetEx() or
+		setRenderTarget(), 0 if the screen is the render target. */
+		virtual IRenderTarget* getCurrentRenderTarget() const =0;
+
 		//! Get the size of the current render target
 		/** This method will return the screen size if the driver
 		doesn't support render to texture, or if the current render
@@ -912,6 +1321,102 @@ namespace video
 		\return Amount of primitives drawn in the last frame. */
 		virtual u32 getPrimitiveCountDrawn( u32 mode =0 ) const =0;
 
+		//! Returns the work done by the driver in the current frame.
+		/** The counters are reset by beginScene(), so after endScene()
+		they describe the whole frame. Which counters are maintained
+		depends on the driver, the null driver only counts draw calls
+		and primitives. */
+		virtual const SFrameStats& getFrameStats() const =0;
+
+		//! Records the commands submitted to the null driver
+		/** Lets machines without GPU measure and compare the CPU side of
+		rendering. While recording, the null driver keeps the state a GPU
+		driver would: materials are compared like the OpenGL 3 driver does,
+		mesh buffers get hardware buffer links, render targets and their
+		textures exist, transformations are kept and the frame statistics
+		count material changes, texture binds and render target switches.
+		Each command is written as a line of text to the log, without
+		pointers or timings, so the logs of two runs can be compared byte
+		for byte. Other drivers don't record.
+		\param enable True to start recording, false to stop it.
+		\param log File the commands are written to while recording, 0 to
+		only keep the state. It is grabbed until recording stops.
+		\return True if the driver records commands now. */
+		virtual bool setCommandRecording(bool enable, io::IWriteFile* log = 0) =0;
+
+		//! Writes the commands of the next frame to a file
+		/** Needs a driver created with
+		SIrrlichtCreationParameters::FrameCapture, which puts a capture
+		layer in front of it. From the next beginScene() to its endScene()
+		the transformations, materials, render targets and draw calls are
+		written, along with the textures and mesh buffers they use and
+		their content hashes. Mesh buffers whose data changes during the
+		frame are written again. createFrameReplay() loads the file for
+		drawing the frame on any driver.
+		\param file File the frame is written to. It is grabbed until the
+		frame ends.
+		\param payloads True to also write the texture pixels, vertices and
+		indices, so a replay draws the same content. Otherwise only the
+		sizes and hashes are written.
+		\return True if the next frame is captured. */
+		virtual bool captureFrame(io::IWriteFile* file, bool payloads = true) =0;
+
+		//! Loads a frame written by captureFrame() for drawing it with this driver
+		/** \param file Capture file, read completely by this call.
+		\return The replay, or 0 if the file isn't a capture this version
+		can read. Drop it when done with it. */
+		virtual IFrameReplay* createFrameReplay(io::IReadFile* file) =0;
+
+		//! Returns the number of frames finished by endScene()
+		/** Lets caches tell whether their data was used in the current frame. */
+		virtual u32 getFrameCount() const =0;
+
+		//! Sets how many frames getFrameTimeStats() can look back on
+		/** Recording only writes a few values per frame, the percentiles
+		are computed when queried, so this can stay enabled in release
+		builds. Disabled by default.
+		\param frames Number of latest frames whose times are kept, 0
+		disables the recording.
+		\param hitchMilliseconds Frame time above which a frame counts as
+		hitch. */
+		virtual void setFrameTimeHistory(u32 frames, f32 hitchMilliseconds = 50.f) =0;
+
+		//! Returns the distribution of the frame times of the latest frames
+		/** \param frames Number of latest frames to cover, 0 for all
+		frames set by setFrameTimeHistory(). */
+		virtual SFrameTimeStats getFrameTimeStats(u32 frames = 0) const =0;
+
+		//! Limits the video memory used by textures
+		/** When the resident textures get larger at the end of a frame,
+		the least recently used ones are evicted until they fit. Evicted
+		textures keep their image in main memory and are uploaded again
+		when they are used. Only textures created with
+		ETCF_ALLOW_MEMORY_COPY can be evicted, render targets never are.
+		Only supported by the OpenGL 3 and OpenGL ES 2 drivers.
+		\param bytes Budget in bytes, 0 disables it. */
+		virtual void setTextureMemoryBudget(u64 bytes) =0;
+
+		//! Returns the video memory used by textures
+		/** The sizes are estimated from format, size and mip levels. The
+		null driver doesn't track textures and only returns the budget. */
+		virtual const STextureResidencyStats& getTextureResidencyStats() const =0;
+
+		//! Creates the video memory resources again after the context was lost
+		/** Some platforms, like Android when the app is paused, destroy
+		the graphics context, and with it all textures, hardware buffers
+		and shaders. beginScene() calls this when the context manager
+		replaced a lost context, so it is only needed when managing the
+		context manually.
+		Textures which kept their image in main memory are uploaded from
+		it, those used in the last frame right away and the others when
+		they are used again. Textures without image are loaded from their
+		file again, in parallel. Render targets get empty storage, and
+		hardware buffers are uploaded again when drawn. Only supported by
+		the OpenGL ES 2 driver.
+		\return False if not supported, or if some resources couldn't be
+		restored. Their content is lost then. */
+		virtual bool restoreResources() =0;
+
 		//! Gets name of this video driver.
 		/** \return Returns the name of the video driver, e.g. in case
 		of the Direct3D8 driver, it would return "Direct3D 8.1". */
@@ -981,6 +1486,18 @@ namespace video
 		See IReferenceCounted::drop() for more information. */
 		virtual core::array<IImage*> createImagesFromFile(io::IReadFile* file, E_TEXTURE_TYPE* type = 0) = 0;
 
+		//! Creates software images from several files at the same time
+		/** The files are decoded by the image loaders on worker threads,
+		which is much faster than calling createImagesFromFile() for many
+		small files one after another. Files which share the file of an
+		archive are read into memory on the calling thread first. A file must
+		not be passed more than once.
+		\param files Files from which the images are created.
+		\return The first image of each file, in the order of files. 0 for
+		files which couldn't be loaded. If you no longer need the images,
+		you should call IImage::drop() on each of them. */
+		virtual core::array<IImage*> createImagesFromFiles(const core::array<io::IReadFile*>& files) = 0;
+
 		//! Creates a software image from a file.
 		/** No hardware texture will be created for this image. This
 		method is useful for example if you want to read a heightmap
@@ -1039,6 +1556,24 @@ namespace video
 		\return True on successful write. */
 		virtual bool writeImageToFile(IImage* image, io::IWriteFile* file, u32 param =0) =0;
 
+		//! Writes an image to a file on a background thread
+		/** Encoding large images, like screenshots, takes long enough to
+		stall a frame. The file is created right away, the image is
+		encoded and written later on a thread of the driver.
+		\param image Image to write. The driver takes over the reference of
+		the caller and drops the image once it is written, so it must not be
+		dropped or changed after the call.
+		\param filename Name of the file to write, its extension selects
+		the image writer.
+		\param param Control parameter for the backend, e.g. the quality of
+		jpeg files or the E_PNG_WRITE_PARAM bits of png files.
+		\param callback Told about the result by a later endScene(), may be
+		0. Must stay valid until then, or until the driver is destroyed.
+		\return False if the file couldn't be created or no writer supports
+		it, the image is dropped then as well. */
+		virtual bool writeImageToFileAsync(IImage* image, const io::path& filename, u32 param = 0,
+			IImageWriteCallback* callback = 0) = 0;
+
 		//! Creates a software image from a byte array.
 		/** No hardware texture will be created for this image. This
 		method is useful for example if you want to read a heightmap
@@ -1223,10 +1758,38 @@ namespace video
 			clearBuffers(ECBF_DEPTH, SColor(255,0,0,0), 1.f, 0);
 		}
 
+		//! Sets if depth values get smaller with the distance from the camera
+		/** Depth buffers are most precise close to 0, so a projection
+		mapping the near plane to 1 and the far plane to 0 spreads the
+		precision over the distance and avoids z-fighting far away. With
+		reverse depth, the less and greater comparisons of
+		SMaterial::ZBuffer are swapped, and the depth values given to
+		clearBuffers(), beginScene() and setRenderTargetEx() are mirrored,
+		so materials and clears keep their meaning. Drivers supporting
+		EVDF_DEPTH_CLIP_CONTROL also clip depth from 0 to 1 instead of -1
+		to 1 meanwhile, so projections have to be D3D style then. Cameras
+		switch this while rendering, see
+		scene::ICameraSceneNode::setReverseDepth(). */
+		virtual void setReverseDepth(bool reverse) =0;
+
+		//! Checks if depth values get smaller with the distance from the camera
+		virtual bool isReverseDepth() const =0;
+
 		//! Make a screenshot of the last rendered frame.
 		/** \return An image created from the last rendered frame. */
 		virtual IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) =0;
 
+		//! Make a screenshot of the last rendered frame without waiting for the GPU to finish it.
+		/** Drivers which can't read back asynchronously take the screenshot
+		right away and return a request which is already ready.
+		\param format Format of the image created from the request,
+		ECF_UNKNOWN for ECF_A8R8G8B8.
+		\param target Only ERT_FRAME_BUFFER is supported by all drivers.
+		\return Request to poll with IScreenShotRequest::isReady(), or 0 on
+		failure. Drop the request when done with it, a pending readback is
+		discarded then. See IReferenceCounted::drop() for more information. */
+		virtual IScreenShotRequest* createScreenShotAsync(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) =0;
+
 		//! Check if the image is already loaded.
 		/** Works similar to getTexture(), but does not load the texture
 		if it is not currently loaded.
@@ -1258,6 +1821,12 @@ namespace video
 		/** \param count Number of vertices to set as minimum. */
 		virtual void setMinHardwareBufferVertexCount(u32 count) =0;
 
+		//! Set how many hardware buffers of destroyed mesh buffers are released per frame
+		/** The rest waits for the next frames, so destroying many mesh
+		buffers at once doesn't stall a single frame. Default is 64.
+		\param count Number of hardware buffers, 0 releases all at once. */
+		virtual void setHardwareBufferDeletionBudget(u32 count) =0;
+
 		//! Get the global Material, which might override local materials.
 		/** Depending on the enable flags, values from this Material
 		are used to override those of local materials of some
@@ -1326,6 +1895,31 @@ namespace video
 
 		//! Used by some SceneNodes to check if a material should be rendered in the transparent render pass
 		virtual bool needsTransparentRenderPass(const irr::video::SMaterial& material) const = 0;
+
+		//! Checks if a material can be drawn between beginTransparencyAccumulation() and endTransparencyAccumulation()
+		/** True for the built-in materials EMT_TRANSPARENT_ALPHA_CHANNEL,
+		EMT_TRANSPARENT_VERTEX_ALPHA and EMT_TRANSPARENT_REFLECTION_2_LAYER
+		which need the transparent render pass and don't write depth, if
+		the driver supports EVDF_WEIGHTED_TRANSPARENCY. */
+		virtual bool canAccumulateTransparency(const SMaterial& material) const = 0;
+
+		//! Starts accumulating transparent materials independent of the order they are drawn in
+		/** Implements weighted blended order-independent transparency.
+		The materials drawn until endTransparencyAccumulation() add their
+		colors, weighted by alpha and distance from the camera, into
+		floating point buffers of the size of the current render target,
+		hidden by its depth. This approximates blending them sorted back
+		to front, close layers of similar alpha are averaged. Only
+		materials for which canAccumulateTransparency() returns true may
+		be drawn in between, and the render target must not change.
+		\return False if nothing is accumulated, for example because the
+		driver doesn't support EVDF_WEIGHTED_TRANSPARENCY. The transparent
+		materials then have to be drawn sorted as usual. */
+		virtual bool beginTransparencyAccumulation() = 0;
+
+		//! Blends the accumulated transparent materials over the current render target
+		/** Only call this if beginTransparencyAccumulation() returned true. */
+		virtual void endTransparencyAccumulation() = 0;
 	};
 
 } // end namespace video
@@ -6,6 +6,7 @@
 #define __I_WRITE_FILE_H_INCLUDED__
 
 #include "IReferenceCounted.h"
+#include "irrMemory.h"
 #include "path.h"
 
 namespace irr
@@ -14,7 +15,7 @@ namespace io
 {
 
 	//! Interface providing write access to a file.
-	class IWriteFile : public virtual IReferenceCounted
+	class IWriteFile : public virtual IReferenceCounted, public core::CMemoryTagged<core::EMC_IO>
 	{
 	public:
 		//! Writes an amount of bytes to the file.
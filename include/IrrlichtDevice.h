@@ -19,6 +19,8 @@
 namespace irr
 {
 	class ILogger;
+	class IProfiler;
+	class IJobScheduler;
 	class IEventReceiver;
 
 	namespace io {
@@ -87,6 +89,46 @@ namespace irr
 		*/
 		virtual void sleep(u32 timeMs, bool pauseTimer=false) = 0;
 
+		//! Blocks until the window system has events for the device, or the time passed
+		/** For applications drawing only when something changed, see
+		scene::ISceneManager::needsRedraw(). Unlike sleep(), this returns
+		as soon as input arrives, while not using the processor until then.
+		The events are left for the next run() to read. Devices which can't
+		wait for their events, like the console and headless devices, sleep
+		for the given time. Joysticks and jobs queued for the main thread
+		don't end the wait, so keep the time short if they are used.
+		\param timeoutMs: Longest time to wait in milliseconds.
+		\return True if events arrived, false if the time passed. */
+		virtual bool waitForEvents(u32 timeoutMs) = 0;
+
+		//! Makes run() keep a steady time between frames
+		/** run() waits until the target time passed since the previous
+		frame was due, before it reads the new input. It sleeps while far
+		from that time and spins for the last part, as sleeping may
+		overshoot by a scheduler period. Late frames start right away and
+		the following ones keep the new phase instead of catching up.
+		As the input is read after the wait, it's as recent as possible
+		when the frame is drawn. Combine with
+		IVideoDriver::setMaxFramesInFlight() so the driver doesn't queue
+		frames on top of that.
+		\param frameTimeUs Target time between frames in microseconds,
+		for example 16667 for 60 frames per second. 0 disables pacing,
+		which is the default.
+		\param spinTimeUs Time before the target spent spinning instead of
+		sleeping. Larger values are more precise but use more CPU time. */
+		virtual void setFramePacing(u32 frameTimeUs, u32 spinTimeUs=2000) = 0;
+
+		//! Makes run() wait for events while the window is minimized
+		/** A minimized or hidden window shows nothing of what the
+		application draws, so run() blocks with waitForEvents() for up to
+		the given time before it reads the input, instead of letting the
+		application loop spin. Restoring the window ends the wait early.
+		Applications which have to keep their simulation running at full
+		rate while minimized can disable it.
+		\param timeoutMs Longest time run() waits, 0 disables the wait.
+		The default is 100 milliseconds. */
+		virtual void setMinimizedWaitTime(u32 timeoutMs) = 0;
+
 		//! Provides access to the video driver for drawing 3d and 2d geometry.
 		/** \return Pointer the video driver. */
 		virtual video::IVideoDriver* getVideoDriver() = 0;
@@ -128,6 +170,20 @@ namespace irr
 		\return Pointer to the ITimer object. */
 		virtual ITimer* getTimer() = 0;
 
+		//! Provides access to the profiler of the engine.
+		/** \return Pointer to the profiler, 0 if the engine was built
+		without the ENABLE_PROFILER CMake option. Shared by all devices,
+		it must not be deleted. */
+		virtual IProfiler* getProfiler() = 0;
+
+		//! Provides access to the thread pool of the engine.
+		/** Engine parts running work in parallel share it with the
+		application, so together they don't start more threads than there
+		are cores. Its size is set by
+		SIrrlichtCreationParameters::JobThreads.
+		\return Pointer to the job scheduler. */
+		virtual IJobScheduler* getJobScheduler() = 0;
+
 		//! Sets the caption of the window.
 		/** \param text: New text of the window caption. */
 		virtual void setWindowCaption(const wchar_t* text) = 0;
@@ -201,6 +257,21 @@ namespace irr
 		further to the scene manager and the GUI environment. */
 		virtual bool postEventFromUser(const SEvent& event) = 0;
 
+		//! Sets if consecutive mouse input events of a type received from the system are merged.
+		/** Merged events are posted once per call of run() instead of one
+		by one, or earlier when an event of another type arrives, so the
+		order of events is kept. Only events with the same button states
+		and modifier keys are merged. Supported are EMIE_MOUSE_MOVED, which
+		keeps the last position, and EMIE_MOUSE_WHEEL, which sums up the
+		wheel deltas. Events posted with postEventFromUser() are never merged.
+		By default mouse moves are merged and wheel events are not.
+		\param type Mouse input event type.
+		\param merge True to merge consecutive events of this type. */
+		virtual void setEventCoalescing(EMOUSE_INPUT_EVENT type, bool merge) = 0;
+
+		//! Checks if consecutive mouse input events of a type received from the system are merged.
+		virtual bool getEventCoalescing(EMOUSE_INPUT_EVENT type) const = 0;
+
 		//! Sets the input receiving scene manager.
 		/** If set to null, the main scene manager (returned by
 		GetSceneManager()) will receive the input
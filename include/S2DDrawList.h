@@ -0,0 +1,64 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_2D_DRAW_LIST_H_INCLUDED__
+#define __S_2D_DRAW_LIST_H_INCLUDED__
+
+#include "S3DVertex.h"
+#include "irrArray.h"
+#include "rect.h"
+#include "dimension2d.h"
+
+namespace irr
+{
+namespace video
+{
+	class ITexture;
+
+//! 2D drawing recorded by IVideoDriver::beginRecording2D to draw it again
+/** The content belongs to the driver which recorded it, the quads are
+stored in the coordinates of the render target they were drawn to. */
+struct S2DDrawList
+{
+	//! Quads sharing texture and render states
+	struct SBatch
+	{
+		//! Not grabbed, removing textures outdates all lists
+		const ITexture* Texture;
+		core::rect<s32> ClipRect;
+		u32 FirstVertex;
+		u32 VertexCount;
+		bool Alpha;
+		bool AlphaChannel;
+		bool Clip;
+	};
+
+	S2DDrawList() : Generation(0), Valid(false) {}
+
+	//! Removes the recorded drawing
+	void clear()
+	{
+		Batches.set_used(0);
+		Vertices.set_used(0);
+		Valid = false;
+	}
+
+	core::array<SBatch> Batches;
+
+	//! Four vertices per quad
+	core::array<S3DVertex> Vertices;
+
+	//! Size of the render target the quads were drawn to
+	core::dimension2du TargetSize;
+
+	//! Lists of another generation refer to removed textures
+	u32 Generation;
+
+	//! False if the list was invalidated, or something else than quads was drawn while recording
+	bool Valid;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -0,0 +1,47 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_3D_INSTANCE_H_INCLUDED__
+#define __S_3D_INSTANCE_H_INCLUDED__
+
+#include "matrix4.h"
+#include "SColor.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Per-instance data of an instanced draw
+/** Shaders read these values through the inInstanceTransform,
+inInstanceColor and inInstanceParams vertex attributes, see
+E_INSTANCE_ATTRIBUTES. */
+struct S3DInstance
+{
+	//! default constructor
+	S3DInstance() : Color(0xffffffff)
+	{
+		Params[0] = Params[1] = Params[2] = 0.f;
+	}
+
+	//! constructor
+	S3DInstance(const core::matrix4& transform, SColor color = SColor(0xffffffff))
+		: Transform(transform), Color(color)
+	{
+		Params[0] = Params[1] = Params[2] = 0.f;
+	}
+
+	//! World transformation of the instance
+	core::matrix4 Transform;
+
+	//! Color of the instance
+	SColor Color;
+
+	//! Free parameters for use by the shader
+	f32 Params[3];
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
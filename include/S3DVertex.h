@@ -28,7 +28,16 @@ enum E_VERTEX_TYPE
 	/** Usually used for tangent space normal mapping.
 		Usually tangent and binormal get send to shaders as texture coordinate sets 1 and 2.
 	*/
-	EVT_TANGENTS
+	EVT_TANGENTS,
+
+	//! Vertex with the joints which move it, video::S3DVertexSkinned.
+	/** Used by skinned meshes with hardware skinning enabled. */
+	EVT_SKINNED,
+
+	//! Quantized vertex, video::S3DVertexCompact.
+	/** Only kept in hardware buffers, see scene::IMeshBuffer::setCompactVertices().
+	Drawn directly, the positions are in the range 0 to 1. */
+	EVT_COMPACT
 };
 
 //! Array holding the built in vertex type names
@@ -37,6 +46,8 @@ const char* const sBuiltInVertexTypeNames[] =
 	"standard",
 	"2tcoords",
 	"tangents",
+	"skinned",
+	"compact",
 	0
 };
 
@@ -262,6 +273,202 @@ struct S3DVertexTangents : public S3DVertex
 };
 
 
+//! Most joints the vertices of a mesh buffer can refer to for hardware skinning
+const u32 MAX_SKINNING_JOINTS = 48;
+
+//! Vertex moved by up to four joints of a skinned mesh.
+/** The joint indices refer to the joint palette of the mesh buffer, the
+weights are fixed point with 255 meaning 1 and add up to 255. Unused slots
+have a weight of 0. */
+struct S3DVertexSkinned : public S3DVertex
+{
+	//! default constructor
+	S3DVertexSkinned() : S3DVertex()
+	{
+		for (u32 i=0; i<4; ++i)
+		{
+			JointIndices[i] = 0;
+			JointWeights[i] = 0;
+		}
+	}
+
+	//! constructor from S3DVertex, the vertex isn't moved by any joint
+	S3DVertexSkinned(const S3DVertex& o) : S3DVertex(o)
+	{
+		for (u32 i=0; i<4; ++i)
+		{
+			JointIndices[i] = 0;
+			JointWeights[i] = 0;
+		}
+	}
+
+	//! Indices of the joints in the joint palette
+	u8 JointIndices[4];
+
+	//! Weights of the joints, 255 is a weight of 1
+	u8 JointWeights[4];
+
+	bool operator==(const S3DVertexSkinned& other) const
+	{
+		if (static_cast<S3DVertex>(*this)!=static_cast<const S3DVertex&>(other))
+			return false;
+		for (u32 i=0; i<4; ++i)
+			if (JointIndices[i] != other.JointIndices[i] || JointWeights[i] != other.JointWeights[i])
+				return false;
+		return true;
+	}
+
+	bool operator!=(const S3DVertexSkinned& other) const
+	{
+		return !(*this == other);
+	}
+
+	static E_VERTEX_TYPE getType()
+	{
+		return EVT_SKINNED;
+	}
+};
+
+
+//! Vertex of video::EVT_COMPACT, 20 instead of the 36 bytes of S3DVertex
+/** Positions are 16 bit fractions of a box, normals have 10 bits
+per component and texture coordinates are half floats. */
+struct S3DVertexCompact
+{
+	//! default constructor
+	S3DVertexCompact() : Normal(0), Color(0xffffffff)
+	{
+		Pos[0] = Pos[1] = Pos[2] = Pos[3] = 0;
+		TCoords[0] = TCoords[1] = 0;
+	}
+
+	//! constructor quantizing a vertex
+	/** \param v Vertex to quantize.
+	\param boxMin Minimum edge of the box the position is stored relative to.
+	\param boxInvExtent 1 divided by the extent of the box in each axis, 0 for flat axes. */
+	S3DVertexCompact(const S3DVertex& v, const core::vector3df& boxMin, const core::vector3df& boxInvExtent)
+		: Normal(packNormal(v.Normal)), Color(v.Color)
+	{
+		Pos[0] = packUnit((v.Pos.X - boxMin.X) * boxInvExtent.X);
+		Pos[1] = packUnit((v.Pos.Y - boxMin.Y) * boxInvExtent.Y);
+		Pos[2] = packUnit((v.Pos.Z - boxMin.Z) * boxInvExtent.Z);
+		Pos[3] = 0;
+		TCoords[0] = packHalf(v.TCoords.X);
+		TCoords[1] = packHalf(v.TCoords.Y);
+	}
+
+	//! Position, 0 to 65535 span the box the vertex was quantized in, the fourth value is padding
+	u16 Pos[4];
+
+	//! Normal vector, signed 10 bits each for x, y and z from the lowest bit on
+	u32 Normal;
+
+	//! Color
+	SColor Color;
+
+	//! Texture coordinates as half floats
+	u16 TCoords[2];
+
+	//! Returns the position, given the box the vertex was quantized in
+	core::vector3df getPosition(const core::vector3df& boxMin, const core::vector3df& boxExtent) const
+	{
+		return core::vector3df(boxMin.X + boxExtent.X * (Pos[0] / 65535.f),
+			boxMin.Y + boxExtent.Y * (Pos[1] / 65535.f),
+			boxMin.Z + boxExtent.Z * (Pos[2] / 65535.f));
+	}
+
+	//! Returns the normal vector
+	core::vector3df getNormal() const
+	{
+		return core::vector3df(unpackSigned10(Normal), unpackSigned10(Normal >> 10), unpackSigned10(Normal >> 20));
+	}
+
+	//! Returns the texture coordinates
+	core::vector2d<f32> getTCoords() const
+	{
+		return core::vector2d<f32>(unpackHalf(TCoords[0]), unpackHalf(TCoords[1]));
+	}
+
+	bool operator==(const S3DVertexCompact& other) const
+	{
+		return Pos[0] == other.Pos[0] && Pos[1] == other.Pos[1] && Pos[2] == other.Pos[2] &&
+			Normal == other.Normal && Color == other.Color &&
+			TCoords[0] == other.TCoords[0] && TCoords[1] == other.TCoords[1];
+	}
+
+	bool operator!=(const S3DVertexCompact& other) const
+	{
+		return !(*this == other);
+	}
+
+	static E_VERTEX_TYPE getType()
+	{
+		return EVT_COMPACT;
+	}
+
+	//! Packs a value from 0 to 1 into 16 bits
+	static u16 packUnit(f32 value)
+	{
+		return (u16)core::round32(core::clamp(value, 0.f, 1.f) * 65535.f);
+	}
+
+	//! Packs a normal in the 10:10:10:2 layout of GL_INT_2_10_10_10_REV, the 2 bits stay 0
+	static u32 packNormal(const core::vector3df& n)
+	{
+		const u32 x = (u32)core::round32(core::clamp(n.X, -1.f, 1.f) * 511.f) & 0x3ff;
+		const u32 y = (u32)core::round32(core::clamp(n.Y, -1.f, 1.f) * 511.f) & 0x3ff;
+		const u32 z = (u32)core::round32(core::clamp(n.Z, -1.f, 1.f) * 511.f) & 0x3ff;
+		return x | (y << 10) | (z << 20);
+	}
+
+	//! Unpacks the lowest 10 bits as a signed normalized value
+	static f32 unpackSigned10(u32 bits)
+	{
+		const s32 value = (s32)(bits << 22) >> 22;
+		return core::max_(value / 511.f, -1.f);
+	}
+
+	//! Converts to a half float, rounding to nearest
+	static u16 packHalf(f32 value)
+	{
+		const u32 bits = core::IR(value);
+		const u16 sign = (u16)((bits >> 16) & 0x8000);
+		const s32 exponent = (s32)((bits >> 23) & 0xff) - 127 + 15;
+		const u32 mantissa = bits & 0x7fffff;
+
+		// infinity for too large values, NaN stays NaN
+		if (exponent >= 31)
+			return sign | 0x7c00 | ((bits & 0x7f800000) == 0x7f800000 && mantissa ? 0x200 : 0);
+
+		// denormals, with the implicit bit shifted in
+		if (exponent <= 0)
+		{
+			if (exponent < -10)
+				return sign;
+			const u32 full = mantissa | 0x800000;
+			const u32 shift = (u32)(14 - exponent);
+			return sign | (u16)((full >> shift) + ((full >> (shift - 1)) & 1));
+		}
+
+		// a carry out of the mantissa correctly increases the exponent
+		return sign | (u16)((((u32)exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+	}
+
+	//! Converts from a half float
+	static f32 unpackHalf(u16 half)
+	{
+		const u32 sign = (u32)(half & 0x8000) << 16;
+		const u32 exponent = (half >> 10) & 0x1f;
+		const u32 mantissa = half & 0x3ff;
+
+		if (exponent == 0)
+			return core::FR(sign | core::IR(mantissa * (1.f / 16777216.f)));
+		if (exponent == 31)
+			return core::FR(sign | 0x7f800000 | (mantissa << 13));
+		return core::FR(sign | ((exponent + 112) << 23) | (mantissa << 13));
+	}
+};
+
 
 inline u32 getVertexPitchFromType(E_VERTEX_TYPE vertexType)
 {
@@ -271,6 +478,10 @@ inline u32 getVertexPitchFromType(E_VERTEX_TYPE vertexType)
 		return sizeof(video::S3DVertex2TCoords);
 	case video::EVT_TANGENTS:
 		return sizeof(video::S3DVertexTangents);
+	case video::EVT_SKINNED:
+		return sizeof(video::S3DVertexSkinned);
+	case video::EVT_COMPACT:
+		return sizeof(video::S3DVertexCompact);
 	default:
 		return sizeof(video::S3DVertex);
 	}
@@ -39,7 +39,7 @@ namespace video
 
 		/** Compressed image formats. **/
 
-		//! DXT1 color format.
+		//! DXT1 color format, also known as BC1.
 		ECF_DXT1,
 
 		//! DXT2 color format.
@@ -51,7 +51,7 @@ namespace video
 		//! DXT4 color format.
 		ECF_DXT4,
 
-		//! DXT5 color format.
+		//! DXT5 color format, also known as BC3.
 		ECF_DXT5,
 
 		//! PVRTC RGB 2bpp.
@@ -81,6 +81,18 @@ namespace video
 		//! ETC2 ARGB.
 		ECF_ETC2_ARGB,
 
+		//! BC7 (BPTC) ARGB.
+		ECF_BC7,
+
+		//! ASTC ARGB with 4x4 blocks, 8bpp.
+		ECF_ASTC_4x4,
+
+		//! ASTC ARGB with 6x6 blocks, 3.56bpp.
+		ECF_ASTC_6x6,
+
+		//! ASTC ARGB with 8x8 blocks, 2bpp.
+		ECF_ASTC_8x8,
+
 		/** The following formats may only be used for render target textures. */
 
 		/** Floating point formats. */
@@ -153,6 +165,10 @@ namespace video
 		"ETC1",
 		"ETC2_RGB",
 		"ETC2_ARGB",
+		"BC7",
+		"ASTC_4x4",
+		"ASTC_6x6",
+		"ASTC_8x8",
 		"R16F",
 		"G16R16F",
 		"A16B16G16R16F",
@@ -0,0 +1,86 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_DIRTY_RANGES_H_INCLUDED__
+#define __S_DIRTY_RANGES_H_INCLUDED__
+
+#include "irrMath.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! The last changed ranges of a buffer, each with the change ID it was made at
+/** Lets a video driver whose copy of the buffer is a few changes old upload
+only the elements changed since then. Change IDs have to increase by one
+with each change. */
+struct SDirtyRanges
+{
+	//! Number of changes which are remembered
+	enum { MAX_RANGES = 8 };
+
+	SDirtyRanges() : Used(0), Next(0) {}
+
+	//! Records that count elements from first on changed, with the change ID the buffer has now
+	void add(u32 changedID, u32 first, u32 count)
+	{
+		IDs[Next] = changedID;
+		First[Next] = first;
+		Count[Next] = count;
+		Next = (Next + 1) % MAX_RANGES;
+		if (Used < MAX_RANGES)
+			++Used;
+	}
+
+	//! Forgets all ranges, after a change of the whole buffer
+	void clear()
+	{
+		Used = 0;
+		Next = 0;
+	}
+
+	//! Get the union of the ranges changed after an older change ID
+	/** \param changedID Change ID the copy of the buffer was made at.
+	\param currentID Change ID the buffer has now.
+	\param first Receives the first changed element.
+	\param count Receives the number of elements from first on which changed.
+	\return False if not all changes since changedID are known. */
+	bool get(u32 changedID, u32 currentID, u32& first, u32& count) const
+	{
+		if (!changedID || changedID >= currentID || currentID - changedID > Used)
+			return false;
+
+		u32 end = 0;
+		first = 0xffffffff;
+		u32 found = 0;
+		for (u32 i=0; i<Used; ++i)
+		{
+			if (IDs[i] > changedID && IDs[i] <= currentID)
+			{
+				first = core::min_(first, First[i]);
+				end = core::max_(end, First[i] + Count[i]);
+				++found;
+			}
+		}
+
+		// a change of the whole buffer in between cleared the older ranges
+		if (found != currentID - changedID)
+			return false;
+
+		count = end > first ? end - first : 0;
+		return true;
+	}
+
+private:
+	u32 IDs[MAX_RANGES];
+	u32 First[MAX_RANGES];
+	u32 Count[MAX_RANGES];
+	u32 Used;
+	u32 Next;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
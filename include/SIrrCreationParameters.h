@@ -11,6 +11,7 @@
 #include "ILogger.h"
 #include "position2d.h"
 #include "path.h"
+#include "irrMemory.h"
 #include "IrrCompileConfig.h" // for IRRLICHT_SDK_VERSION
 
 namespace irr
@@ -48,16 +49,24 @@ namespace irr
 #else
 			LoggingLevel(ELL_INFORMATION),
 #endif
+			AsyncLogging(false),
+			JobThreads(-1),
 			DisplayAdapter(0),
 			DriverMultithreaded(false),
 			UsePerformanceTimer(true),
 			SDK_version_do_not_use(IRRLICHT_SDK_VERSION),
 			PrivateData(0),
 #ifdef IRR_MOBILE_PATHS
-			OGLES2ShaderPath("media/Shaders/")
+			OGLES2ShaderPath("media/Shaders/"),
 #else
-			OGLES2ShaderPath("../../media/Shaders/")
+			OGLES2ShaderPath("../../media/Shaders/"),
 #endif
+			ShaderCachePath(""),
+			TextureUploadBudget(4 * 1024 * 1024),
+			TextureStreamingBudget(0),
+			TextureMemoryBudget(0),
+			MemoryAllocator(0),
+			FrameCapture(false)
 		{
 		}
 
@@ -88,11 +97,19 @@ namespace irr
 			EventReceiver = other.EventReceiver;
 			WindowId = other.WindowId;
 			LoggingLevel = other.LoggingLevel;
+			AsyncLogging = other.AsyncLogging;
+			JobThreads = other.JobThreads;
 			DisplayAdapter = other.DisplayAdapter;
 			DriverMultithreaded = other.DriverMultithreaded;
 			UsePerformanceTimer = other.UsePerformanceTimer;
 			PrivateData = other.PrivateData;
 			OGLES2ShaderPath = other.OGLES2ShaderPath;
+			ShaderCachePath = other.ShaderCachePath;
+			TextureUploadBudget = other.TextureUploadBudget;
+			TextureStreamingBudget = other.TextureStreamingBudget;
+			TextureMemoryBudget = other.TextureMemoryBudget;
+			MemoryAllocator = other.MemoryAllocator;
+			FrameCapture = other.FrameCapture;
 			return *this;
 		}
 
@@ -103,6 +120,7 @@ namespace irr
 		EIDT_COCOA is only available on Mac OSX,
 		EIDT_X11 is available on Linux, Solaris, BSD and other operating systems which use X11,
 		EIDT_SDL is available on most systems if compiled in,
+		EIDT_HEADLESS is available on systems with EGL if compiled in,
 		EIDT_BEST will select the best available device for your operating system.
 		Default: EIDT_BEST. */
 		E_DEVICE_TYPE DeviceType;
@@ -292,8 +310,23 @@ namespace irr
 		*/
 		ELOG_LEVEL LoggingLevel;
 
+		//! Print log messages on a background thread
+		/** Keeps floods of messages from blocking the logging thread on stdout
+		or the Android log. Repeated messages are collapsed and a message
+		printed more than 20 times a second is suppressed for the rest of
+		that second. The event receiver still gets every message on the
+		calling thread. Default: false. */
+		bool AsyncLogging;
+
+		//! Number of worker threads of the job scheduler
+		/** See IrrlichtDevice::getJobScheduler(). With 0 all jobs run on
+		the threads waiting for them. Default: -1, which starts one thread
+		less than there are cores, as the main thread helps with the
+		jobs. */
+		s32 JobThreads;
+
 		//! Allows to select which graphic card is used for rendering when more than one card is in the system.
-		/** So far only supported on D3D */
+		/** So far only supported on D3D and by EIDT_HEADLESS, where it is the index of the EGL device */
 		u32 DisplayAdapter;
 
 		//! Create the driver multithreaded.
@@ -324,6 +357,41 @@ namespace irr
 		/** This is about the shaders which can be found in media/Shaders by default. It's only necessary
 		to set when using OGL-ES 2.0 */
 		irr::io::path OGLES2ShaderPath;
+
+		//! Set the directory where linked shader programs are cached.
+		/** Linking shaders can take a long time on some platforms, so linked programs
+		are stored there and reused on the next start as long as the sources and
+		the driver didn't change. The directory must exist and end with a slash.
+		Only used by the OpenGL 3 and OpenGL ES 2 drivers if the driver supports program
+		binaries. Default: empty, which disables the cache. */
+		irr::io::path ShaderCachePath;
+
+		//! Bytes of texture data uploaded per frame for textures created with ETCF_DEFERRED_UPLOAD
+		/** At least one texture is uploaded each frame, even if it is larger.
+		Default: 4 MiB. */
+		u32 TextureUploadBudget;
+
+		//! Bytes of video memory used by textures created with ETCF_STREAM_MIP_MAPS
+		/** When exceeded, the driver drops the largest mip levels of the textures
+		with the most resolution left over their screen size hint. The mip levels
+		requested in a frame are uploaded up to TextureUploadBudget.
+		Default: 0, which disables the limit. */
+		u32 TextureStreamingBudget;
+
+		//! Bytes of video memory used by all textures, see IVideoDriver::setTextureMemoryBudget()
+		/** Default: 0, which disables the limit. */
+		u64 TextureMemoryBudget;
+
+		//! Allocator for the memory the engine accounts per subsystem, see core::setMemoryAllocator()
+		/** Set when the device is created, which fails if memory of another
+		allocator is still alive. It has to outlive all objects of the engine.
+		Default: 0, which keeps the current allocator. */
+		core::IMemoryAllocator* MemoryAllocator;
+
+		//! Put a capture layer in front of the video driver, see IVideoDriver::captureFrame()
+		/** The layer costs a virtual call per driver call while it isn't
+		capturing. Default: false. */
+		bool FrameCapture;
 	};
 
 
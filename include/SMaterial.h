@@ -656,6 +656,9 @@ namespace video
 		\return True if the materials differ, else false. */
 		inline bool operator!=(const SMaterial& b) const
 		{
+			if (this == &b)
+				return false;
+
 			bool different =
 				MaterialType != b.MaterialType ||
 				AmbientColor != b.AmbientColor ||
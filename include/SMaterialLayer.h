@@ -6,6 +6,7 @@
 #define __S_MATERIAL_LAYER_H_INCLUDED__
 
 #include "matrix4.h"
+#include <utility>
 
 namespace irr
 {
@@ -63,6 +64,13 @@ namespace video
 			*this = other;
 		}
 
+		//! Move constructor
+		/** \param other Material layer to take the texture matrix from. */
+		SMaterialLayer(SMaterialLayer&& other) noexcept : TextureMatrix(0)
+		{
+			*this = std::move(other);
+		}
+
 		//! Destructor
 		~SMaterialLayer()
 		{
@@ -112,6 +120,29 @@ namespace video
 			return *this;
 		}
 
+		//! Move assignment operator
+		/** Swaps the texture matrices instead of copying them, so arrays of
+		materials can grow without allocating them again.
+		\param other Material layer to move from.
+		\return This material layer, updated. */
+		SMaterialLayer& operator=(SMaterialLayer&& other) noexcept
+		{
+			if (this == &other)
+				return *this;
+
+			Texture = other.Texture;
+			std::swap(TextureMatrix, other.TextureMatrix);
+			TextureWrapU = other.TextureWrapU;
+			TextureWrapV = other.TextureWrapV;
+			TextureWrapW = other.TextureWrapW;
+			BilinearFilter = other.BilinearFilter;
+			TrilinearFilter = other.TrilinearFilter;
+			AnisotropicFilter = other.AnisotropicFilter;
+			LODBias = other.LODBias;
+
+			return *this;
+		}
+
 		//! Gets the texture transformation matrix
 		/** \return Texture matrix of this layer. */
 		core::matrix4& getTextureMatrix()
@@ -0,0 +1,36 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_SCENE_VIEW_H_INCLUDED__
+#define __S_SCENE_VIEW_H_INCLUDED__
+
+#include "rect.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class ICameraSceneNode;
+
+//! A camera and the part of the render target it draws into, see ISceneManager::drawAllViews()
+struct SSceneView
+{
+	//! default constructor
+	SSceneView() : Camera(0) {}
+
+	//! constructor
+	SSceneView(ICameraSceneNode* camera, const core::rect<s32>& viewPort)
+		: Camera(camera), ViewPort(viewPort) {}
+
+	//! Camera the view is seen through, its aspect ratio should match the viewport
+	ICameraSceneNode* Camera;
+
+	//! Area of the current render target the view is drawn into
+	core::rect<s32> ViewPort;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
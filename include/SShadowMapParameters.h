@@ -0,0 +1,49 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __S_SHADOW_MAP_PARAMETERS_H_INCLUDED__
+#define __S_SHADOW_MAP_PARAMETERS_H_INCLUDED__
+
+#include "vector3d.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Maximal number of cascades of the shadow map pass
+const u32 MAX_SHADOW_CASCADES = 4;
+
+//! Parameters of the cascaded shadow map pass, see ISceneManager::setShadowMappingEnabled()
+struct SShadowMapParameters
+{
+	//! default constructor
+	SShadowMapParameters() : LightDirection(0.f, -1.f, 0.f), CascadeCount(3),
+		Resolution(2048), MaxDistance(0.f), SplitLambda(0.75f), CasterDistance(100.f)
+	{
+	}
+
+	//! Direction the directional light shines into, in world space
+	core::vector3df LightDirection;
+
+	//! Number of cascades, from 1 to MAX_SHADOW_CASCADES
+	u32 CascadeCount;
+
+	//! Width and height of the depth texture of each cascade
+	u32 Resolution;
+
+	//! Distance from the camera covered by the last cascade
+	/** 0 to use the far value of the active camera. */
+	f32 MaxDistance;
+
+	//! Blend between logarithmic (1) and uniform (0) cascade splits
+	f32 SplitLambda;
+
+	//! How far casters in front of a cascade, towards the light, still throw shadows into it
+	f32 CasterDistance;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
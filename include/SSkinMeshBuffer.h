@@ -7,6 +7,7 @@
 
 #include "IMeshBuffer.h"
 #include "S3DVertex.h"
+#include <string.h>
 
 
 namespace irr
@@ -15,12 +16,15 @@ namespace scene
 {
 
 
-//! A mesh buffer able to choose between S3DVertex2TCoords, S3DVertex and S3DVertexTangents at runtime
+//! A mesh buffer able to choose between S3DVertex2TCoords, S3DVertex, S3DVertexTangents and S3DVertexSkinned at runtime
+/** The vertices of all types are kept in one byte array with the pitch of
+the current vertex type, conversions to larger types happen in place. */
 struct SSkinMeshBuffer : public IMeshBuffer
 {
 	//! Default constructor
 	SSkinMeshBuffer(video::E_VERTEX_TYPE vt=video::EVT_STANDARD) :
 		ChangedID_Vertex(1), ChangedID_Index(1), VertexType(vt),
+		VertexPitch(video::getVertexPitchFromType(vt)),
 		PrimitiveType(EPT_TRIANGLES),
 		MappingHint_Vertex(EHM_NEVER), MappingHint_Index(EHM_NEVER),
 		HWBuffer(NULL),
@@ -31,6 +35,13 @@ struct SSkinMeshBuffer : public IMeshBuffer
 		#endif
 	}
 
+	//! Destructor, lets the driver release the hardware buffer
+	~SSkinMeshBuffer()
+	{
+		if (HWBuffer)
+			HWBuffer->onMeshBufferDestroyed(this);
+	}
+
 	//! Get Material of this buffer.
 	const video::SMaterial& getMaterial() const override
 	{
@@ -46,57 +57,76 @@ struct SSkinMeshBuffer : public IMeshBuffer
 	//! Get standard vertex at given index
 	virtual video::S3DVertex *getVertex(u32 index)
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return (video::S3DVertex*)&Vertices_2TCoords[index];
-			case video::EVT_TANGENTS:
-				return (video::S3DVertex*)&Vertices_Tangents[index];
-			default:
-				return &Vertices_Standard[index];
-		}
+		return reinterpret_cast<video::S3DVertex*>(Vertices.pointer() + index*VertexPitch);
+	}
+
+	//! Get standard vertex at given index
+	const video::S3DVertex *getVertex(u32 index) const
+	{
+		return reinterpret_cast<const video::S3DVertex*>(Vertices.const_pointer() + index*VertexPitch);
+	}
+
+	//! Get the vertices as an array of their type
+	/** \return Pointer to the vertices, T has to be the structure of the current vertex type. */
+	template <class T>
+	T* getVertexArray()
+	{
+		_IRR_DEBUG_BREAK_IF(T::getType() != VertexType)
+		return reinterpret_cast<T*>(Vertices.pointer());
+	}
+
+	//! Get the vertices as an array of their type
+	template <class T>
+	const T* getVertexArray() const
+	{
+		_IRR_DEBUG_BREAK_IF(T::getType() != VertexType)
+		return reinterpret_cast<const T*>(Vertices.const_pointer());
+	}
+
+	//! Adds a vertex of the current vertex type
+	template <class T>
+	void pushVertex(const T& vertex)
+	{
+		_IRR_DEBUG_BREAK_IF(T::getType() != VertexType)
+		const u32 used = Vertices.size();
+		Vertices.set_used(used + VertexPitch);
+		memcpy(Vertices.pointer() + used, &vertex, VertexPitch);
+	}
+
+	//! Changes the vertex count, added vertices are zeroed
+	void setVertexCount(u32 count)
+	{
+		Vertices.set_used(count*VertexPitch);
+	}
+
+	//! Reserves the memory of a vertex count
+	void reallocateVertices(u32 count)
+	{
+		Vertices.reallocate(count*VertexPitch);
 	}
 
 	//! Get pointer to vertex array
 	const void* getVertices() const override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords.const_pointer();
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents.const_pointer();
-			default:
-				return Vertices_Standard.const_pointer();
-		}
+		return Vertices.const_pointer();
 	}
 
 	//! Get pointer to vertex array
 	void* getVertices() override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords.pointer();
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents.pointer();
-			default:
-				return Vertices_Standard.pointer();
-		}
+		return Vertices.pointer();
 	}
 
 	//! Get vertex count
 	u32 getVertexCount() const override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords.size();
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents.size();
-			default:
-				return Vertices_Standard.size();
-		}
+		return Vertices.size() / VertexPitch;
+	}
+
+	//! Get the size of a vertex in bytes
+	u32 getVertexPitch() const
+	{
+		return VertexPitch;
 	}
 
 	//! Get type of index data which is stored in this meshbuffer.
@@ -144,44 +174,14 @@ struct SSkinMeshBuffer : public IMeshBuffer
 
 		BoundingBoxNeedsRecalculated = false;
 
-		switch (VertexType)
+		const u32 count = getVertexCount();
+		if (count == 0)
+			BoundingBox.reset(0,0,0);
+		else
 		{
-			case video::EVT_STANDARD:
-			{
-				if (Vertices_Standard.empty())
-					BoundingBox.reset(0,0,0);
-				else
-				{
-					BoundingBox.reset(Vertices_Standard[0].Pos);
-					for (u32 i=1; i<Vertices_Standard.size(); ++i)
-						BoundingBox.addInternalPoint(Vertices_Standard[i].Pos);
-				}
-				break;
-			}
-			case video::EVT_2TCOORDS:
-			{
-				if (Vertices_2TCoords.empty())
-					BoundingBox.reset(0,0,0);
-				else
-				{
-					BoundingBox.reset(Vertices_2TCoords[0].Pos);
-					for (u32 i=1; i<Vertices_2TCoords.size(); ++i)
-						BoundingBox.addInternalPoint(Vertices_2TCoords[i].Pos);
-				}
-				break;
-			}
-			case video::EVT_TANGENTS:
-			{
-				if (Vertices_Tangents.empty())
-					BoundingBox.reset(0,0,0);
-				else
-				{
-					BoundingBox.reset(Vertices_Tangents[0].Pos);
-					for (u32 i=1; i<Vertices_Tangents.size(); ++i)
-						BoundingBox.addInternalPoint(Vertices_Tangents[i].Pos);
-				}
-				break;
-			}
+			BoundingBox.reset(getVertex(0)->Pos);
+			for (u32 i=1; i<count; ++i)
+				BoundingBox.addInternalPoint(getVertex(i)->Pos);
 		}
 	}
 
@@ -191,140 +191,90 @@ struct SSkinMeshBuffer : public IMeshBuffer
 		return VertexType;
 	}
 
+	//! Set the vertex type of a buffer without vertices
+	void setVertexType(video::E_VERTEX_TYPE vertexType)
+	{
+		_IRR_DEBUG_BREAK_IF(!Vertices.empty())
+		VertexType = vertexType;
+		VertexPitch = video::getVertexPitchFromType(vertexType);
+	}
+
 	//! Convert to 2tcoords vertex type
 	void convertTo2TCoords()
 	{
 		if (VertexType==video::EVT_STANDARD)
-		{
-			for(u32 n=0;n<Vertices_Standard.size();++n)
-			{
-				video::S3DVertex2TCoords Vertex;
-				Vertex.Color=Vertices_Standard[n].Color;
-				Vertex.Pos=Vertices_Standard[n].Pos;
-				Vertex.Normal=Vertices_Standard[n].Normal;
-				Vertex.TCoords=Vertices_Standard[n].TCoords;
-				Vertices_2TCoords.push_back(Vertex);
-			}
-			Vertices_Standard.clear();
-			VertexType=video::EVT_2TCOORDS;
-		}
+			convertVertices<video::S3DVertex2TCoords>();
 	}
 
 	//! Convert to tangents vertex type
 	void convertToTangents()
+	{
+		if (VertexType==video::EVT_STANDARD || VertexType==video::EVT_2TCOORDS)
+			convertVertices<video::S3DVertexTangents>();
+	}
+
+	//! Convert to skinned vertex type, the vertices aren't moved by any joint yet
+	void convertToSkinned()
 	{
 		if (VertexType==video::EVT_STANDARD)
 		{
-			for(u32 n=0;n<Vertices_Standard.size();++n)
-			{
-				video::S3DVertexTangents Vertex;
-				Vertex.Color=Vertices_Standard[n].Color;
-				Vertex.Pos=Vertices_Standard[n].Pos;
-				Vertex.Normal=Vertices_Standard[n].Normal;
-				Vertex.TCoords=Vertices_Standard[n].TCoords;
-				Vertices_Tangents.push_back(Vertex);
-			}
-			Vertices_Standard.clear();
-			VertexType=video::EVT_TANGENTS;
+			convertVertices<video::S3DVertexSkinned>();
+			setDirty(EBT_VERTEX);
 		}
-		else if (VertexType==video::EVT_2TCOORDS)
+	}
+
+	//! Convert skinned vertices back to the standard vertex type
+	void convertSkinnedToStandard()
+	{
+		if (VertexType==video::EVT_SKINNED)
 		{
-			for(u32 n=0;n<Vertices_2TCoords.size();++n)
-			{
-				video::S3DVertexTangents Vertex;
-				Vertex.Color=Vertices_2TCoords[n].Color;
-				Vertex.Pos=Vertices_2TCoords[n].Pos;
-				Vertex.Normal=Vertices_2TCoords[n].Normal;
-				Vertex.TCoords=Vertices_2TCoords[n].TCoords;
-				Vertices_Tangents.push_back(Vertex);
-			}
-			Vertices_2TCoords.clear();
-			VertexType=video::EVT_TANGENTS;
+			convertVertices<video::S3DVertex>();
+			JointMatrices.clear();
+			setDirty(EBT_VERTEX);
 		}
 	}
 
+	//! Get the joint matrices for hardware skinning
+	const core::matrix4* getJointMatrices(u32& count) const override
+	{
+		count = JointMatrices.size();
+		return count ? JointMatrices.const_pointer() : 0;
+	}
+
 	//! returns position of vertex i
 	const core::vector3df& getPosition(u32 i) const override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords[i].Pos;
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents[i].Pos;
-			default:
-				return Vertices_Standard[i].Pos;
-		}
+		return getVertex(i)->Pos;
 	}
 
 	//! returns position of vertex i
 	core::vector3df& getPosition(u32 i) override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords[i].Pos;
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents[i].Pos;
-			default:
-				return Vertices_Standard[i].Pos;
-		}
+		return getVertex(i)->Pos;
 	}
 
 	//! returns normal of vertex i
 	const core::vector3df& getNormal(u32 i) const override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords[i].Normal;
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents[i].Normal;
-			default:
-				return Vertices_Standard[i].Normal;
-		}
+		return getVertex(i)->Normal;
 	}
 
 	//! returns normal of vertex i
 	core::vector3df& getNormal(u32 i) override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords[i].Normal;
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents[i].Normal;
-			default:
-				return Vertices_Standard[i].Normal;
-		}
+		return getVertex(i)->Normal;
 	}
 
 	//! returns texture coords of vertex i
 	const core::vector2df& getTCoords(u32 i) const override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords[i].TCoords;
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents[i].TCoords;
-			default:
-				return Vertices_Standard[i].TCoords;
-		}
+		return getVertex(i)->TCoords;
 	}
 
 	//! returns texture coords of vertex i
 	core::vector2df& getTCoords(u32 i) override
 	{
-		switch (VertexType)
-		{
-			case video::EVT_2TCOORDS:
-				return Vertices_2TCoords[i].TCoords;
-			case video::EVT_TANGENTS:
-				return Vertices_Tangents[i].TCoords;
-			default:
-				return Vertices_Standard[i].TCoords;
-		}
+		return getVertex(i)->TCoords;
 	}
 
 	//! append the vertices and indices to the current buffer
@@ -384,11 +334,11 @@ struct SSkinMeshBuffer : public IMeshBuffer
 
 	u32 getChangedID_Index() const override {return ChangedID_Index;}
 
-	void setHWBuffer(void *ptr) const override {
+	void setHWBuffer(IHardwareBufferLink *ptr) const override {
 		HWBuffer = ptr;
 	}
 
-	void *getHWBuffer() const override {
+	IHardwareBufferLink *getHWBuffer() const override {
 		return HWBuffer;
 	}
 
@@ -396,20 +346,25 @@ struct SSkinMeshBuffer : public IMeshBuffer
 	//! Call this after changing the positions of any vertex.
 	void boundingBoxNeedsRecalculated(void) { BoundingBoxNeedsRecalculated = true; }
 
-	core::array<video::S3DVertexTangents> Vertices_Tangents;
-	core::array<video::S3DVertex2TCoords> Vertices_2TCoords;
-	core::array<video::S3DVertex> Vertices_Standard;
+	//! Vertices of VertexType, VertexPitch bytes each
+	core::array<u8> Vertices;
 	core::array<u16> Indices;
 
+	//! Joint matrices for hardware skinning, the joint indices of the vertices refer to them
+	core::array<core::matrix4> JointMatrices;
+
 	u32 ChangedID_Vertex;
 	u32 ChangedID_Index;
 
-	//ISkinnedMesh::SJoint *AttachedJoint;
+	//! Transformation of the joint a buffer without weights is attached to
 	core::matrix4 Transformation;
 
 	video::SMaterial Material;
 	video::E_VERTEX_TYPE VertexType;
 
+	//! Size of a vertex of VertexType
+	u32 VertexPitch;
+
 	core::aabbox3d<f32> BoundingBox;
 
 	//! Primitive type used for rendering (triangles, lines, ...)
@@ -419,9 +374,41 @@ struct SSkinMeshBuffer : public IMeshBuffer
 	E_HARDWARE_MAPPING MappingHint_Vertex:3;
 	E_HARDWARE_MAPPING MappingHint_Index:3;
 
-	mutable void *HWBuffer;
+	mutable IHardwareBufferLink *HWBuffer;
 
 	bool BoundingBoxNeedsRecalculated:1;
+
+private:
+	//! Changes the vertex type, keeping the S3DVertex part of all vertices
+	/** Growing types are converted from the last vertex backwards and
+	shrinking ones from the first, so no vertex is overwritten before it is
+	read. Additional fields get the defaults of T. */
+	template <class T>
+	void convertVertices()
+	{
+		const u32 count = getVertexCount();
+		const u32 oldPitch = VertexPitch;
+		const u32 newPitch = sizeof(T);
+
+		if (newPitch > oldPitch)
+			Vertices.set_used(count*newPitch);
+
+		u8* data = Vertices.pointer();
+		for (u32 n=0; n<count; ++n)
+		{
+			const u32 i = newPitch > oldPitch ? count-1-n : n;
+			video::S3DVertex vertex;
+			memcpy(&vertex, data + i*oldPitch, sizeof(video::S3DVertex));
+			const T converted(vertex);
+			memcpy(data + i*newPitch, &converted, newPitch);
+		}
+
+		if (newPitch < oldPitch)
+			Vertices.set_used(count*newPitch);
+
+		VertexType = T::getType();
+		VertexPitch = newPitch;
+	}
 };
 
 
@@ -429,4 +416,3 @@ struct SSkinMeshBuffer : public IMeshBuffer
 } // end namespace irr
 
 #endif
-
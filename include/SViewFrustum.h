@@ -11,12 +11,118 @@
 #include "aabbox3d.h"
 #include "matrix4.h"
 #include "IVideoDriver.h"
+#include "irrSIMD.h"
 
 namespace irr
 {
 namespace scene
 {
 
+	struct SViewFrustum;
+
+	//! The planes of a view frustum packed for testing many boxes at once
+	/** Each plane component is stored in its own array, padded to a multiple
+	of four with planes nothing can be in front of. For every component a lane
+	mask tells whether the normal is positive, which selects the box corner
+	nearest to and furthest from the plane without branching. */
+	struct SPackedFrustum
+	{
+		enum { PLANE_COUNT = 8 };
+
+		SPackedFrustum() {}
+
+		inline explicit SPackedFrustum(const SViewFrustum& frustum);
+
+		//! Packs the planes of a frustum
+		inline void set(const SViewFrustum& frustum);
+
+		//! Classifies boxes against the frustum
+		/** Gives the same results as testing each box against every plane
+		with aabbox3d::classifyPlaneRelation.
+		\param boxes Boxes to test.
+		\param count Number of boxes.
+		\param relations Receives one result per box: ISREL3D_FRONT if the box
+		is in front of any plane and so outside of the frustum, else
+		ISREL3D_CLIPPED if a plane cuts it, else ISREL3D_BACK. */
+		void classifyBoxes(const core::aabbox3d<f32>* boxes, u32 count, core::EIntersectionRelation3D* relations) const
+		{
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+			typedef core::SSIMD4f S;
+			const S::V zero = S::splat(0.f);
+
+			for (u32 b = 0; b < count; ++b)
+			{
+				const core::aabbox3d<f32>& box = boxes[b];
+				const S::V minX = S::splat(box.MinEdge.X);
+				const S::V minY = S::splat(box.MinEdge.Y);
+				const S::V minZ = S::splat(box.MinEdge.Z);
+				const S::V maxX = S::splat(box.MaxEdge.X);
+				const S::V maxY = S::splat(box.MaxEdge.Y);
+				const S::V maxZ = S::splat(box.MaxEdge.Z);
+
+				u32 front = 0;
+				u32 clipped = 0;
+				for (u32 i = 0; i < PLANE_COUNT; i += 4)
+				{
+					const S::M px = S::loadMask(PositiveX + i);
+					const S::M py = S::loadMask(PositiveY + i);
+					const S::M pz = S::loadMask(PositiveZ + i);
+					const S::V nx = S::load(NormalX + i);
+					const S::V ny = S::load(NormalY + i);
+					const S::V nz = S::load(NormalZ + i);
+					const S::V d = S::load(D + i);
+
+					// summed in the order of vector3d::dotProduct
+					const S::V nearDistance = S::add(S::add(S::add(
+						S::mul(S::select(px, minX, maxX), nx),
+						S::mul(S::select(py, minY, maxY), ny)),
+						S::mul(S::select(pz, minZ, maxZ), nz)), d);
+					const S::V farDistance = S::add(S::add(S::add(
+						S::mul(S::select(px, maxX, minX), nx),
+						S::mul(S::select(py, maxY, minY), ny)),
+						S::mul(S::select(pz, maxZ, minZ), nz)), d);
+
+					front |= S::bits(S::less(zero, nearDistance));
+					clipped |= S::bits(S::less(zero, farDistance));
+				}
+
+				relations[b] = front ? core::ISREL3D_FRONT : (clipped ? core::ISREL3D_CLIPPED : core::ISREL3D_BACK);
+			}
+#else
+			for (u32 b = 0; b < count; ++b)
+			{
+				// the padding planes have every box behind them
+				core::EIntersectionRelation3D result = core::ISREL3D_BACK;
+				for (u32 i = 0; i < PLANE_COUNT; ++i)
+				{
+					const core::plane3d<f32> plane(core::vector3df(NormalX[i], NormalY[i], NormalZ[i]), D[i]);
+					const core::EIntersectionRelation3D r = boxes[b].classifyPlaneRelation(plane);
+					if (r == core::ISREL3D_FRONT)
+					{
+						result = r;
+						break;
+					}
+					if (r == core::ISREL3D_CLIPPED)
+						result = r;
+				}
+				relations[b] = result;
+			}
+#endif
+		}
+
+		//! Plane normal components and distances, padded to PLANE_COUNT
+		f32 NormalX[PLANE_COUNT];
+		f32 NormalY[PLANE_COUNT];
+		f32 NormalZ[PLANE_COUNT];
+		f32 D[PLANE_COUNT];
+
+		//! All bits set where the normal component is positive
+		u32 PositiveX[PLANE_COUNT];
+		u32 PositiveY[PLANE_COUNT];
+		u32 PositiveZ[PLANE_COUNT];
+	};
+
+
 	//! Defines the view frustum. That's the space visible by the camera.
 	/** The view frustum is enclosed by 6 planes. These six planes share
 	eight points. A bounding box around these eight points is also stored in
@@ -45,18 +151,22 @@ namespace scene
 
 
 		//! Default Constructor
-		SViewFrustum() : BoundingRadius(0.f), FarNearDistance(0.f) {}
+		SViewFrustum() : BoundingRadius(0.f), FarNearDistance(0.f) { PackedPlanes.set(*this); }
 
 		//! Copy Constructor
 		SViewFrustum(const SViewFrustum& other);
 
 		//! This constructor creates a view frustum based on a projection and/or view matrix.
 		//\param zClipFromZero: Clipping of z can be projected from 0 to w when true (D3D style) and from -w to w when false (OGL style).
-		SViewFrustum(const core::matrix4& mat, bool zClipFromZero);
+		//\param reverseDepth: The projection maps the near plane to w and the far plane to 0 (or -w), see video::IVideoDriver::setReverseDepth().
+		SViewFrustum(const core::matrix4& mat, bool zClipFromZero, bool reverseDepth=false);
 
 		//! This constructor creates a view frustum based on a projection and/or view matrix.
-		//\param zClipFromZero: Clipping of z can be projected from 0 to w when true (D3D style) and from -w to w when false (OGL style).
-		inline void setFrom(const core::matrix4& mat, bool zClipFromZero);
+		/** A far plane at infinity never culls anything, the bounding box
+		of the frustum isn't valid then.
+		\param zClipFromZero: Clipping of z can be projected from 0 to w when true (D3D style) and from -w to w when false (OGL style).
+		\param reverseDepth: The projection maps the near plane to w and the far plane to 0 (or -w), see video::IVideoDriver::setReverseDepth(). */
+		inline void setFrom(const core::matrix4& mat, bool zClipFromZero, bool reverseDepth=false);
 
 		//! transforms the frustum by the matrix
 		/** \param mat: Matrix by which the view frustum is transformed.*/
@@ -89,9 +199,13 @@ namespace scene
 		//! returns a bounding box enclosing the whole view frustum
 		const core::aabbox3d<f32> &getBoundingBox() const;
 
-		//! recalculates the bounding box and sphere based on the planes
+		//! recalculates the bounding box, sphere and packed planes based on the planes
+		/** Call this after changing the planes directly. */
 		inline void recalculateBoundingBox();
 
+		//! get the planes packed for testing many boxes at once
+		const SPackedFrustum& getPackedPlanes() const;
+
 		//! get the bounding sphere's radius (of an optimized sphere, not the AABB's)
 		float getBoundingRadius() const;
 
@@ -138,6 +252,9 @@ namespace scene
 		float BoundingRadius;
 		float FarNearDistance;
 		core::vector3df BoundingCenter;
+
+		//! The planes as of the last recalculateBoundingBox()
+		SPackedFrustum PackedPlanes;
 	};
 
 
@@ -159,18 +276,27 @@ namespace scene
 		BoundingRadius = other.BoundingRadius;
 		FarNearDistance = other.FarNearDistance;
 		BoundingCenter = other.BoundingCenter;
+		PackedPlanes = other.PackedPlanes;
 	}
 
-	inline SViewFrustum::SViewFrustum(const core::matrix4& mat, bool zClipFromZero)
+	inline SViewFrustum::SViewFrustum(const core::matrix4& mat, bool zClipFromZero, bool reverseDepth)
 	{
-		setFrom(mat, zClipFromZero);
+		setFrom(mat, zClipFromZero, reverseDepth);
 	}
 
 
 	inline void SViewFrustum::transform(const core::matrix4& mat)
 	{
+		// same as matrix4::transformPlane, but with one inverse for all planes
+		const core::matrix4 transposedInverse(mat, core::matrix4::EM4CONST_INVERSE_TRANSPOSED);
 		for (u32 i=0; i<VF_PLANE_COUNT; ++i)
-			mat.transformPlane(planes[i]);
+		{
+			core::vector3df member;
+			mat.transformVect(member, planes[i].getMemberPoint());
+			core::vector3df normal = planes[i].Normal;
+			transposedInverse.rotateVect(normal);
+			planes[i].setPlane(member, normal.normalize());
+		}
 
 		mat.transformVect(cameraPosition);
 		recalculateBoundingBox();
@@ -275,6 +401,12 @@ namespace scene
 
 		// Also recalculate the bounding sphere when the bbox changes
 		recalculateBoundingSphere();
+		PackedPlanes.set(*this);
+	}
+
+	inline const SPackedFrustum& SViewFrustum::getPackedPlanes() const
+	{
+		return PackedPlanes;
 	}
 
 	inline float SViewFrustum::getBoundingRadius() const
@@ -294,7 +426,7 @@ namespace scene
 
 	//! This constructor creates a view frustum based on a projection
 	//! and/or view matrix.
-	inline void SViewFrustum::setFrom(const core::matrix4& mat, bool zClipFromZero)
+	inline void SViewFrustum::setFrom(const core::matrix4& mat, bool zClipFromZero, bool reverseDepth)
 	{
 		// left clipping plane
 		planes[VF_LEFT_PLANE].Normal.X = mat[3 ] + mat[0];
@@ -320,35 +452,44 @@ namespace scene
 		planes[VF_BOTTOM_PLANE].Normal.Z = mat[11] + mat[9];
 		planes[VF_BOTTOM_PLANE].D =        mat[15] + mat[13];
 
-		// far clipping plane
-		planes[VF_FAR_PLANE].Normal.X = mat[3 ] - mat[2];
-		planes[VF_FAR_PLANE].Normal.Y = mat[7 ] - mat[6];
-		planes[VF_FAR_PLANE].Normal.Z = mat[11] - mat[10];
-		planes[VF_FAR_PLANE].D =        mat[15] - mat[14];
+		// with reverse depth, z gets w at the near plane and 0 (or -w) at the far plane
+		const VFPLANES wPlane = reverseDepth ? VF_NEAR_PLANE : VF_FAR_PLANE;
+		const VFPLANES zeroPlane = reverseDepth ? VF_FAR_PLANE : VF_NEAR_PLANE;
 
-		// near clipping plane
+		// far clipping plane, z = w
+		planes[wPlane].Normal.X = mat[3 ] - mat[2];
+		planes[wPlane].Normal.Y = mat[7 ] - mat[6];
+		planes[wPlane].Normal.Z = mat[11] - mat[10];
+		planes[wPlane].D =        mat[15] - mat[14];
+
+		// near clipping plane, z = 0 or z = -w
 		if ( zClipFromZero )
 		{
-			planes[VF_NEAR_PLANE].Normal.X = mat[2];
-			planes[VF_NEAR_PLANE].Normal.Y = mat[6];
-			planes[VF_NEAR_PLANE].Normal.Z = mat[10];
-			planes[VF_NEAR_PLANE].D =        mat[14];
+			planes[zeroPlane].Normal.X = mat[2];
+			planes[zeroPlane].Normal.Y = mat[6];
+			planes[zeroPlane].Normal.Z = mat[10];
+			planes[zeroPlane].D =        mat[14];
 		}
 		else
 		{
-			// near clipping plane
-			planes[VF_NEAR_PLANE].Normal.X = mat[3 ] + mat[2];
-			planes[VF_NEAR_PLANE].Normal.Y = mat[7 ] + mat[6];
-			planes[VF_NEAR_PLANE].Normal.Z = mat[11] + mat[10];
-			planes[VF_NEAR_PLANE].D =        mat[15] + mat[14];
+			planes[zeroPlane].Normal.X = mat[3 ] + mat[2];
+			planes[zeroPlane].Normal.Y = mat[7 ] + mat[6];
+			planes[zeroPlane].Normal.Z = mat[11] + mat[10];
+			planes[zeroPlane].D =        mat[15] + mat[14];
 		}
 
 		// normalize normals
 		u32 i;
 		for ( i=0; i != VF_PLANE_COUNT; ++i)
 		{
-			const f32 len = -core::reciprocal_squareroot(
-					planes[i].Normal.getLengthSQ());
+			const f32 lengthSQ = planes[i].Normal.getLengthSQ();
+			if (lengthSQ == 0.f)
+			{
+				// the far plane of an infinite projection, everything is in front of it
+				planes[i].D = -1.f;
+				continue;
+			}
+			const f32 len = -core::reciprocal_squareroot(lengthSQ);
 			planes[i].Normal *= len;
 			planes[i].D *= len;
 		}
@@ -455,6 +596,34 @@ namespace scene
 		BoundingRadius = sqrtf(longest);
 	}
 
+	inline SPackedFrustum::SPackedFrustum(const SViewFrustum& frustum)
+	{
+		set(frustum);
+	}
+
+	inline void SPackedFrustum::set(const SViewFrustum& frustum)
+	{
+		for (u32 i = 0; i < PLANE_COUNT; ++i)
+		{
+			if (i < SViewFrustum::VF_PLANE_COUNT)
+			{
+				const core::plane3d<f32>& plane = frustum.planes[i];
+				NormalX[i] = plane.Normal.X;
+				NormalY[i] = plane.Normal.Y;
+				NormalZ[i] = plane.Normal.Z;
+				D[i] = plane.D;
+			}
+			else
+			{
+				NormalX[i] = NormalY[i] = NormalZ[i] = 0.f;
+				D[i] = -1.f;
+			}
+			PositiveX[i] = NormalX[i] > 0.f ? 0xffffffff : 0;
+			PositiveY[i] = NormalY[i] > 0.f ? 0xffffffff : 0;
+			PositiveZ[i] = NormalZ[i] > 0.f ? 0xffffffff : 0;
+		}
+	}
+
 } // end namespace scene
 } // end namespace irr
 
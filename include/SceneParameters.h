@@ -48,6 +48,57 @@ namespace scene
 	**/
 	const c8* const OBJ_LOADER_IGNORE_MATERIAL_FILES = "OBJ_IgnoreMaterialFiles";
 
+
+	//! Flag to parse large .obj files on several threads
+	/** The vertex data and faces of the file are read in parallel parts,
+	the groups and materials are applied in file order afterwards, so the
+	mesh is the same as without the flag. Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::OBJ_LOADER_PARALLEL_PARSE, true);
+	\endcode
+	**/
+	const c8* const OBJ_LOADER_PARALLEL_PARSE = "OBJ_ParallelParse";
+
+	//! Flag to optimize the meshes getMesh() loads for rendering
+	/** Runs IMeshManipulator::optimizeMesh() with all steps on each
+	loaded mesh, only reordering the triangles of skinned meshes. Meshes
+	in the cache directory of ISceneManager::setMeshCacheDirectory() are
+	stored optimized, so they aren't optimized again when loaded from there.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::OPTIMIZE_LOADED_MESHES, true);
+	\endcode
+	**/
+	const c8* const OPTIMIZE_LOADED_MESHES = "Optimize_Loaded_Meshes";
+
+	//! Flag to load the textures the .b3d, .x and .obj files refer to
+	/** The loaders only record the texture files, with
+	ISceneManager::addMeshTextureReference(). Once a file is parsed,
+	getMesh() and getMeshAsync() load the textures of the mesh in one
+	batch with video::IVideoDriver::getTextureAsync(), each file once, and
+	put them into the materials. The names are looked up as they are, and
+	next to the mesh file. The .obj loader reads the map_Kd textures of the
+	.mtl files from disk. Meshes with textures aren't stored in the cache
+	directory of ISceneManager::setMeshCacheDirectory(). Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::MESH_LOADER_TEXTURES, true);
+	\endcode
+	**/
+	const c8* const MESH_LOADER_TEXTURES = "Mesh_Loader_Textures";
+
+	//! Flag to animate the scene nodes with sub-millisecond precision
+	/** ISceneManager::drawAll() still passes whole milliseconds to
+	ISceneNode::OnAnimate(), but ISceneManager::getAnimationTimeFraction()
+	returns the rest of the nanosecond virtual time, which animated mesh
+	scene nodes add to their elapsed time. Avoids the uneven animation of
+	frame times like 16.67ms alternating between 16 and 17ms.
+	Use it like this:
+	\code
+	SceneManager->getParameters()->setAttribute(scene::FRACTIONAL_ANIMATION_TIME, true);
+	\endcode
+	**/
+	const c8* const FRACTIONAL_ANIMATION_TIME = "Fractional_Animation_Time";
+
 } // end namespace scene
 } // end namespace irr
 
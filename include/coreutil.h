@@ -77,7 +77,8 @@ inline io::path& deletePathFromFilename(io::path& filename)
 	if ( p != s )
 	{
 		++p;
-		filename = p;
+		// p points into the string, so it can't be assigned directly
+		filename = filename.subString((u32)(p - s), filename.size() - (u32)(p - s));
 	}
 	return filename;
 }
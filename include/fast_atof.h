@@ -7,6 +7,7 @@
 
 #include "irrMath.h"
 #include "irrString.h"
+#include <cstring>
 
 namespace irr
 {
@@ -363,6 +364,489 @@ inline float fast_atof(const char* floatAsString, const char** out=0)
 	return ret;
 }
 
+//! Returns if eight chars loaded by swar_load8() are all digits
+inline bool swar_is_8_digits(u64 v)
+{
+	return ((v & 0xF0F0F0F0F0F0F0F0ull) | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+		== 0x3333333333333333ull;
+}
+
+//! Loads eight chars into an u64, the first one in the lowest byte
+inline u64 swar_load8(const char* in)
+{
+	// compilers turn this into a single load on little endian machines
+	const u8* p = (const u8*)in;
+	return (u64)p[0] | ((u64)p[1] << 8) | ((u64)p[2] << 16) | ((u64)p[3] << 24) |
+		((u64)p[4] << 32) | ((u64)p[5] << 40) | ((u64)p[6] << 48) | ((u64)p[7] << 56);
+}
+
+//! Converts eight digits loaded by swar_load8() into their value
+/** Combines neighbouring digits, then pairs and quads of them, with three
+    multiplications instead of eight. */
+inline u32 swar_parse_8_digits(u64 v)
+{
+	const u64 mask = 0x000000FF000000FFull;
+	const u64 mul1 = 100 + (1000000ull << 32);
+	const u64 mul2 = 1 + (10000ull << 32);
+	v -= 0x3030303030303030ull;
+	v = (v * 10) + (v >> 8);
+	return (u32)(((v & mask) * mul1 + ((v >> 16) & mask) * mul2) >> 32);
+}
+
+//! Appends the digits at in to mantissa, eight at a time while end allows it
+/** \param[in,out] in Start of the digits, set to the first char after them.
+    \param end End of the string, or 0 if it is zero terminated.
+    \param[in,out] mantissa Value the digits are appended to, overflows
+    after 19 digits.
+    \return Number of digits. */
+inline u32 strtou64_10_append(const char*& in, const char* end, u64& mantissa)
+{
+	const char* const start = in;
+	while (end && end - in >= 8)
+	{
+		const u64 chars = swar_load8(in);
+		if (!swar_is_8_digits(chars))
+			break;
+		mantissa = mantissa * 100000000u + swar_parse_8_digits(chars);
+		in += 8;
+	}
+
+	while (in != end && (u32)(*in - '0') < 10)
+	{
+		mantissa = mantissa * 10 + (u32)(*in - '0');
+		++in;
+	}
+	return (u32)(in - start);
+}
+
+//! Converts mantissa * 10^exponent10 into the nearest f32
+/** Eisel-Lemire algorithm, as in the fast_float library: the mantissa
+    is multiplied with a 128 bit approximation of the power of 10, which
+    always has enough correct bits for f32. The result is correctly
+    rounded, like strtof() does it, but doesn't depend on the locale.
+    \param mantissa Exact decimal mantissa, at most 19 digits.
+    \param exponent10 Power of 10 to scale it with. */
+inline f32 decimal_to_f32(u64 mantissa, s32 exponent10)
+{
+	// truncated 128 bit powers of 5 from 5^-65 to 5^38, most significant
+	// bit set, high and low half
+	static const u64 powersOf5[2 * 104] = {
+		0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull, 0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull,
+		0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull, 0x83a3eeeef9153e89ull, 0x1953cf68300424acull,
+		0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull, 0xcdb02555653131b6ull, 0x3792f412cb06794dull,
+		0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull, 0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull,
+		0xc8de047564d20a8bull, 0xf245825a5a445275ull, 0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull,
+		0x9ced737bb6c4183dull, 0x55464dd69685606bull, 0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull,
+		0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull, 0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull,
+		0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull, 0xef73d256a5c0f77cull, 0x963e66858f6d4440ull,
+		0x95a8637627989aadull, 0xdde7001379a44aa8ull, 0xbb127c53b17ec159ull, 0x5560c018580d5d52ull,
+		0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull, 0x9226712162ab070dull, 0xcab3961304ca70e8ull,
+		0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull, 0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull,
+		0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull, 0xb267ed1940f1c61cull, 0x55f038b237591ed3ull,
+		0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull, 0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull,
+		0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull, 0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull,
+		0x881cea14545c7575ull, 0x7e50d64177da2e54ull, 0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull,
+		0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull, 0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull,
+		0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull, 0xcfb11ead453994baull, 0x67de18eda5814af2ull,
+		0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull, 0xa2425ff75e14fc31ull, 0xa1258379a94d028dull,
+		0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull, 0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull,
+		0x9e74d1b791e07e48ull, 0x775ea264cf55347eull, 0xc612062576589ddaull, 0x95364afe032a819eull,
+		0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull, 0x9abe14cd44753b52ull, 0xc4926a9672793543ull,
+		0xc16d9a0095928a27ull, 0x75b7053c0f178294ull, 0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull,
+		0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull, 0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull,
+		0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull, 0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull,
+		0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull, 0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull,
+		0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull, 0xb424dc35095cd80full, 0x538484c19ef38c95ull,
+		0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull, 0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull,
+		0xafebff0bcb24aafeull, 0xf78f69a51539d749ull, 0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull,
+		0x89705f4136b4a597ull, 0x31680a88f8953031ull, 0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull,
+		0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull, 0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull,
+		0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull, 0xd1b71758e219652bull, 0xd3c36113404ea4a9ull,
+		0x83126e978d4fdf3bull, 0x645a1cac083126eaull, 0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull,
+		0xccccccccccccccccull, 0xcccccccccccccccdull, 0x8000000000000000ull, 0x0000000000000000ull,
+		0xa000000000000000ull, 0x0000000000000000ull, 0xc800000000000000ull, 0x0000000000000000ull,
+		0xfa00000000000000ull, 0x0000000000000000ull, 0x9c40000000000000ull, 0x0000000000000000ull,
+		0xc350000000000000ull, 0x0000000000000000ull, 0xf424000000000000ull, 0x0000000000000000ull,
+		0x9896800000000000ull, 0x0000000000000000ull, 0xbebc200000000000ull, 0x0000000000000000ull,
+		0xee6b280000000000ull, 0x0000000000000000ull, 0x9502f90000000000ull, 0x0000000000000000ull,
+		0xba43b74000000000ull, 0x0000000000000000ull, 0xe8d4a51000000000ull, 0x0000000000000000ull,
+		0x9184e72a00000000ull, 0x0000000000000000ull, 0xb5e620f480000000ull, 0x0000000000000000ull,
+		0xe35fa931a0000000ull, 0x0000000000000000ull, 0x8e1bc9bf04000000ull, 0x0000000000000000ull,
+		0xb1a2bc2ec5000000ull, 0x0000000000000000ull, 0xde0b6b3a76400000ull, 0x0000000000000000ull,
+		0x8ac7230489e80000ull, 0x0000000000000000ull, 0xad78ebc5ac620000ull, 0x0000000000000000ull,
+		0xd8d726b7177a8000ull, 0x0000000000000000ull, 0x878678326eac9000ull, 0x0000000000000000ull,
+		0xa968163f0a57b400ull, 0x0000000000000000ull, 0xd3c21bcecceda100ull, 0x0000000000000000ull,
+		0x84595161401484a0ull, 0x0000000000000000ull, 0xa56fa5b99019a5c8ull, 0x0000000000000000ull,
+		0xcecb8f27f4200f3aull, 0x0000000000000000ull, 0x813f3978f8940984ull, 0x4000000000000000ull,
+		0xa18f07d736b90be5ull, 0x5000000000000000ull, 0xc9f2c9cd04674edeull, 0xa400000000000000ull,
+		0xfc6f7c4045812296ull, 0x4d00000000000000ull, 0x9dc5ada82b70b59dull, 0xf020000000000000ull,
+		0xc5371912364ce305ull, 0x6c28000000000000ull, 0xf684df56c3e01bc6ull, 0xc732000000000000ull,
+		0x9a130b963a6c115cull, 0x3c7f400000000000ull, 0xc097ce7bc90715b3ull, 0x4b9f100000000000ull,
+		0xf0bdc21abb48db20ull, 0x1e86d40000000000ull, 0x96769950b50d88f4ull, 0x1314448000000000ull,
+	};
+
+	u32 bits;
+	if (mantissa == 0 || exponent10 < -65)
+		bits = 0;
+	else if (exponent10 > 38)
+		bits = 0x7F800000;
+	else
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		const u32 lz = (u32)__builtin_clzll(mantissa);
+#else
+		u32 lz = 0;
+		for (u64 top = mantissa; !(top & (1ull << 63)); top <<= 1)
+			++lz;
+#endif
+		mantissa <<= lz;
+
+		// 64x64 to 128 bit multiplication
+		const u64* power = powersOf5 + 2 * (exponent10 + 65);
+		struct SProduct
+		{
+			SProduct(u64 a, u64 b)
+			{
+#ifdef __SIZEOF_INT128__
+				const unsigned __int128 p = (unsigned __int128)a * b;
+				High = (u64)(p >> 64);
+				Low = (u64)p;
+#else
+				const u64 aL = (u32)a, aH = a >> 32, bL = (u32)b, bH = b >> 32;
+				const u64 ll = aL * bL, lh = aL * bH, hl = aH * bL, hh = aH * bH;
+				const u64 mid = (ll >> 32) + (u32)lh + (u32)hl;
+				Low = (mid << 32) | (u32)ll;
+				High = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+			}
+			u64 High;
+			u64 Low;
+		};
+		SProduct product(mantissa, power[0]);
+
+		// the lower half of the power only matters if the bits below the
+		// 23+3 which are used could carry into them
+		const u64 precisionMask = 0xFFFFFFFFFFFFFFFFull >> 26;
+		if ((product.High & precisionMask) == precisionMask)
+		{
+			const SProduct second(mantissa, power[1]);
+			product.Low += second.High;
+			if (second.High > product.Low)
+				++product.High;
+		}
+
+		const u32 upperBit = (u32)(product.High >> 63);
+		const u32 shift = upperBit + 64 - 23 - 3;
+		u64 m = product.High >> shift;
+		// floor(log2(10^exponent10)) + 63, biased for f32
+		s32 power2 = (((152170 + 65536) * exponent10) >> 16) + 63 + (s32)upperBit - (s32)lz + 127;
+
+		if (power2 <= 0)
+		{
+			// subnormal or zero
+			if (-power2 + 1 >= 64)
+				m = 0;
+			else
+			{
+				m >>= -power2 + 1;
+				m += (m & 1);
+				m >>= 1;
+			}
+			power2 = (m < (1ull << 23)) ? 0 : 1;
+			bits = ((u32)power2 << 23) | ((u32)m & 0x7FFFFF);
+		}
+		else
+		{
+			// exactly halfway between two floats, round to even
+			if (product.Low <= 1 && exponent10 >= -17 && exponent10 <= 10 &&
+				(m & 3) == 1 && (m << shift) == product.High)
+				m &= ~1ull;
+
+			m += (m & 1);
+			m >>= 1;
+			if (m >= (2ull << 23))
+			{
+				m = 1ull << 23;
+				++power2;
+			}
+			if (power2 >= 0xFF)
+				bits = 0x7F800000;
+			else
+				bits = ((u32)power2 << 23) | ((u32)m & 0x7FFFFF);
+		}
+	}
+
+	f32 result;
+	memcpy(&result, &bits, 4);
+	return result;
+}
+
+//! Compares a long decimal number with the point halfway between a float and the next larger one
+/** Slow path of fast_atof_fixed_move() for mantissas with more than 19
+    digits, where decimal_to_f32() can only tell the two nearest floats.
+    Both numbers are compared exactly as big integers. More than 120
+    digits are never needed for that, as the halfway points of f32 have
+    at most 113 significant digits.
+    \param in First significant digit.
+    \param end End of the digits, which may contain one decimal point.
+    \param exponent10 Power of 10 to scale the digits with.
+    \param lower The smaller of the two nearest floats, positive.
+    \return Less than, equal to or greater than 0 if the number is below,
+    exactly at or above the halfway point. */
+inline s32 compare_decimal_to_f32_halfway(const char* in, const char* end, s32 exponent10, f32 lower)
+{
+	// enough for 120 digits scaled to the exponent range of f32
+	struct SBigInt
+	{
+		SBigInt(u32 value) : Size(value ? 1 : 0) { Limbs[0] = value; }
+
+		void multiplyAdd(u32 factor, u32 summand)
+		{
+			u64 carry = summand;
+			for (u32 i = 0; i < Size; ++i)
+			{
+				carry += (u64)Limbs[i] * factor;
+				Limbs[i] = (u32)carry;
+				carry >>= 32;
+			}
+			if (carry)
+				Limbs[Size++] = (u32)carry;
+		}
+
+		void multiplyPow5(u32 exponent)
+		{
+			static const u32 powers[14] = { 1, 5, 25, 125, 625, 3125, 15625, 78125,
+				390625, 1953125, 9765625, 48828125, 244140625, 1220703125 };
+			for (; exponent > 13; exponent -= 13)
+				multiplyAdd(powers[13], 0);
+			multiplyAdd(powers[exponent], 0);
+		}
+
+		void shiftLeft(u32 count)
+		{
+			const u32 bits = count % 32;
+			if (bits)
+			{
+				u32 carry = 0;
+				for (u32 i = 0; i < Size; ++i)
+				{
+					const u32 limb = Limbs[i];
+					Limbs[i] = (limb << bits) | carry;
+					carry = limb >> (32 - bits);
+				}
+				if (carry)
+					Limbs[Size++] = carry;
+			}
+			const u32 words = count / 32;
+			if (words && Size)
+			{
+				for (u32 i = Size; i-- > 0; )
+					Limbs[i + words] = Limbs[i];
+				memset(Limbs, 0, words * sizeof(u32));
+				Size += words;
+			}
+		}
+
+		s32 compare(const SBigInt& other) const
+		{
+			if (Size != other.Size)
+				return Size < other.Size ? -1 : 1;
+			for (u32 i = Size; i-- > 0; )
+			{
+				if (Limbs[i] != other.Limbs[i])
+					return Limbs[i] < other.Limbs[i] ? -1 : 1;
+			}
+			return 0;
+		}
+
+		u32 Limbs[64];
+		u32 Size;
+	};
+
+	// the digits, cut after 120, the rest only matters if it isn't zero
+	SBigInt decimal(0);
+	u32 taken = 0;
+	bool truncated = false;
+	for (; in != end; ++in)
+	{
+		if ('.' == *in)
+			continue;
+		if (taken < 120)
+		{
+			decimal.multiplyAdd(10, (u32)(*in - '0'));
+			++taken;
+		}
+		else
+		{
+			++exponent10;
+			truncated |= '0' != *in;
+		}
+	}
+
+	// halfway = (2 * m + 1) * 2^(e - 1) for lower = m * 2^e
+	u32 bits;
+	memcpy(&bits, &lower, 4);
+	const u32 biasedExponent = bits >> 23;
+	SBigInt halfway(2 * (biasedExponent ? (bits & 0x7FFFFF) | 0x800000 : bits) + 1);
+	const s32 exponent2 = (biasedExponent ? (s32)biasedExponent : 1) - 150 - 1;
+
+	// decimal * 5^exponent10 * 2^exponent10 against halfway * 2^exponent2
+	if (exponent10 >= 0)
+		decimal.multiplyPow5((u32)exponent10);
+	else
+		halfway.multiplyPow5((u32)-exponent10);
+	if (exponent10 > exponent2)
+		decimal.shiftLeft((u32)(exponent10 - exponent2));
+	else
+		halfway.shiftLeft((u32)(exponent2 - exponent10));
+
+	const s32 result = decimal.compare(halfway);
+	return (result == 0 && truncated) ? 1 : result;
+}
+
+//! Converts a float like -12.375 or 1.5e-3 into the nearest f32
+/** This is how most mesh data is written. All digits are gathered in a
+    single integer without any float math, eight at a time in long
+    runs when end is known, and converted with decimal_to_f32(), so it is both faster
+    and more precise than fast_atof_move(). The result is the same as the
+    one of strtof(), also for mantissas with more than 19 significant
+    digits, which are rounded with compare_decimal_to_f32_halfway().
+    Strings without digits give 0, like in fast_atof_move().
+    \param[in] in The string to convert.
+    \param[out] result The resultant float will be written here.
+    \param[in] end End of the string, or 0 if it is zero terminated.
+    \return Pointer to the first character in the string that wasn't used
+    to create the float value.
+*/
+inline const char* fast_atof_fixed_move(const char* in, f32& result, const char* end=0)
+{
+	if (!in)
+		return fast_atof_move(in, result);
+	if (in == end)
+	{
+		result = 0.f;
+		return in;
+	}
+
+	const bool negative = ('-' == *in);
+	if (negative || ('+'==*in))
+		++in;
+
+	// leading zeros don't count as digits of the mantissa
+	while ( in != end && '0' == *in )
+		++in;
+
+	const char* significant = in;
+	u64 mantissa = 0;
+	u32 digits = strtou64_10_append(in, end, mantissa);
+
+	u32 decimals = 0;
+	if ( in != end && *in == '.' )
+	{
+		++in;
+		if (!digits)
+		{
+			const char* const fractionZeros = in;
+			while ( in != end && '0' == *in )
+				++in;
+			decimals = (u32)(in - fractionZeros);
+			significant = in;
+		}
+		const u32 fraction = strtou64_10_append(in, end, mantissa);
+		decimals += fraction;
+		digits += fraction;
+	}
+
+	const char* const mantissaEnd = in;
+
+	s32 exponent = -(s32)decimals;
+	if ( in != end && ('e' == *in || 'E' == *in) )
+	{
+		const char* e = in + 1;
+		const bool negativeExponent = (e != end && '-' == *e);
+		if (e != end && (negativeExponent || '+' == *e))
+			++e;
+
+		// without digits the e isn't part of the number
+		if (e != end && (u32)(*e - '0') < 10)
+		{
+			s32 value = 0;
+			while ( e != end && (u32)(*e - '0') < 10 )
+			{
+				if (value < 10000)
+					value = value * 10 + (*e - '0');
+				++e;
+			}
+			exponent += negativeExponent ? -value : value;
+			in = e;
+		}
+	}
+
+	f32 value;
+	if (digits <= 19)
+		value = decimal_to_f32(mantissa, exponent);
+	else
+	{
+		// the mantissa overflowed, the number lies between its first 19
+		// digits truncated and incremented, which almost always give the
+		// same float
+		mantissa = 0;
+		for (const char* p = significant; mantissa < 1000000000000000000ull; ++p)
+		{
+			if ('.' != *p)
+				mantissa = mantissa * 10 + (u32)(*p - '0');
+		}
+		const s32 truncatedExponent = exponent + (s32)digits - 19;
+		value = decimal_to_f32(mantissa, truncatedExponent);
+		const f32 upper = decimal_to_f32(mantissa + 1, truncatedExponent);
+		if (value != upper)
+		{
+			u32 bits;
+			memcpy(&bits, &value, 4);
+			const s32 halfway = compare_decimal_to_f32_halfway(significant, mantissaEnd, exponent, value);
+			// exactly halfway rounds to even
+			if (halfway > 0 || (halfway == 0 && (bits & 1)))
+				value = upper;
+		}
+	}
+
+	result = negative?-value:value;
+	return in;
+}
+
+//! Parses a list of floats separated by whitespace, commas or semicolons in one call
+/** Stops at the first word which isn't a number, or after count numbers.
+    Each one is parsed like fast_atof_fixed_move(), with the whole
+    string bounded by end.
+    \param[in] in The string to convert.
+    \param[in] end End of the string.
+    \param[out] out Array of at least count floats.
+    \param[in] count Maximum number of floats to parse.
+    \param[out] next (optional) If provided, it will be set to point at
+    the first character after the last parsed float.
+    \return Number of floats written to out.
+*/
+inline u32 fast_atof_array(const char* in, const char* end, f32* out, u32 count, const char** next=0)
+{
+	u32 parsed = 0;
+	while (in && parsed < count)
+	{
+		const char* p = in;
+		while (p != end && (' ' == *p || '\t' == *p || '\r' == *p || '\n' == *p || ',' == *p || ';' == *p))
+			++p;
+
+		if (p == end || !((u32)(*p - '0') < 10 || '-' == *p || '+' == *p || '.' == *p))
+			break;
+
+		in = fast_atof_fixed_move(p, out[parsed], end);
+		++parsed;
+	}
+
+	if (next)
+		*next = in;
+	return parsed;
+}
+
 } // end namespace core
 } // end namespace irr
 
@@ -42,6 +42,10 @@ public:
 	array(const array<T>& other) : m_data(other.m_data), is_sorted(other.is_sorted)
 	{ }
 
+	//! Move constructor, takes the memory of other over
+	array(array<T>&& other) noexcept : m_data(std::move(other.m_data)), is_sorted(other.is_sorted)
+	{ }
+
 	//! Reallocates the array, make it bigger or smaller.
 	/** \param new_size New size of array.
 	\param canShrink Specifies whether the array is reallocated even if
@@ -159,6 +163,16 @@ public:
 		return *this;
 	}
 
+	//! Move assignment operator, takes the memory of other over
+	array<T>& operator=(array<T>&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+		m_data = std::move(other.m_data);
+		is_sorted = other.is_sorted;
+		return *this;
+	}
+
 	array<T>& operator=(const std::vector<T> &other)
 	{
 		m_data = other;
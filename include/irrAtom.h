@@ -0,0 +1,185 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_ATOM_H_INCLUDED__
+#define __IRR_ATOM_H_INCLUDED__
+
+#include "IrrCompileConfig.h" // for IRRLICHT_API
+#include "irrString.h"
+#include <atomic>
+#include <cstring>
+#include <functional>
+
+namespace irr
+{
+namespace core
+{
+
+//! String shared by all atoms with the same text
+struct SAtomEntry
+{
+	//! FNV-1a hash of String
+	size_t Hash;
+
+	//! Number of atoms pointing to the entry
+	/** Only goes from 1 to 0 while the table is locked. */
+	mutable std::atomic<u32> References;
+
+	stringc String;
+};
+
+//! Returns the entry of a string with a grabbed reference
+/** \param create False to return 0 instead of adding a string which
+isn't interned yet.
+\return Entry, or 0 for an empty string. */
+IRRLICHT_API const SAtomEntry* IRRCALLCONV internAtom(const c8* str, u32 length, bool create);
+
+//! Drops a reference of an entry, removes it from the table on the last one
+IRRLICHT_API void IRRCALLCONV releaseAtom(const SAtomEntry* entry);
+
+//! Interned string with a precomputed hash and O(1) comparison
+/** All atoms with the same text share one entry, so comparing atoms
+compares pointers, and copying one doesn't copy the text. Use them for names
+which are compared much more often than they are created, like keys of
+registries. Creating an atom from a string looks it up in a global table
+and locks a mutex, atoms can be used on all threads.
+The empty string is the null atom. */
+class atom
+{
+public:
+	//! Constructs the empty atom
+	atom() : Entry(0) {}
+
+	//! Interns a string
+	explicit atom(const c8* str)
+		: Entry(str ? internAtom(str, (u32)strlen(str), true) : 0) {}
+
+	//! Interns a string
+	explicit atom(const stringc& str)
+		: Entry(internAtom(str.c_str(), str.size(), true)) {}
+
+	atom(const atom& other) : Entry(other.Entry)
+	{
+		if (Entry)
+			Entry->References.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	atom(atom&& other) : Entry(other.Entry)
+	{
+		other.Entry = 0;
+	}
+
+	~atom()
+	{
+		release();
+	}
+
+	atom& operator=(const atom& other)
+	{
+		// other may be this atom, release() clears Entry
+		const SAtomEntry* entry = other.Entry;
+		if (entry)
+			entry->References.fetch_add(1, std::memory_order_relaxed);
+		release();
+		Entry = entry;
+		return *this;
+	}
+
+	atom& operator=(atom&& other)
+	{
+		if (this != &other)
+		{
+			release();
+			Entry = other.Entry;
+			other.Entry = 0;
+		}
+		return *this;
+	}
+
+	//! Returns the atom of a string without interning it
+	/** \return The atom, or the empty atom if no atom of this string
+	exists. Then no name compared with atoms can match the string. */
+	static atom find(const c8* str)
+	{
+		return atom(str ? internAtom(str, (u32)strlen(str), false) : 0);
+	}
+
+	//! Returns the atom of a string without interning it
+	static atom find(const stringc& str)
+	{
+		return atom(internAtom(str.c_str(), str.size(), false));
+	}
+
+	//! Returns the text
+	const c8* c_str() const
+	{
+		return Entry ? Entry->String.c_str() : "";
+	}
+
+	//! Returns the length of the text
+	u32 size() const
+	{
+		return Entry ? Entry->String.size() : 0;
+	}
+
+	//! Returns if this is the empty atom
+	bool empty() const
+	{
+		return Entry == 0;
+	}
+
+	//! Returns the precomputed hash of the text
+	size_t hash() const
+	{
+		return Entry ? Entry->Hash : 0;
+	}
+
+	bool operator==(const atom& other) const { return Entry == other.Entry; }
+	bool operator!=(const atom& other) const { return Entry != other.Entry; }
+
+	//! Orders by identity, not alphabetically
+	bool operator<(const atom& other) const { return Entry < other.Entry; }
+
+private:
+	explicit atom(const SAtomEntry* entry) : Entry(entry) {}
+
+	void release()
+	{
+		if (!Entry)
+			return;
+
+		// only the last reference needs the table lock
+		u32 references = Entry->References.load(std::memory_order_relaxed);
+		while (references > 1)
+		{
+			if (Entry->References.compare_exchange_weak(references, references - 1,
+					std::memory_order_release, std::memory_order_relaxed))
+			{
+				Entry = 0;
+				return;
+			}
+		}
+		releaseAtom(Entry);
+		Entry = 0;
+	}
+
+	const SAtomEntry* Entry;
+};
+
+} // end namespace core
+} // end namespace irr
+
+namespace std
+{
+	template <>
+	struct hash<irr::core::atom>
+	{
+		size_t operator()(const irr::core::atom& a) const
+		{
+			return a.hash();
+		}
+	};
+}
+
+#endif
+
@@ -136,6 +136,15 @@ namespace core
 		return (T)(a*(1.f-t)) + (b*t);
 	}
 
+	//! Linear interpolation of count pairs of values, out[i] = lerp(a[i], b[i], t[i*tStride])
+	/** A tStride of 0 uses t[0] for all pairs. out may be a or b. */
+	template<class T>
+	inline void lerpArray(T* out, const T* a, const T* b, const f32* t, u32 tStride, u32 count)
+	{
+		for (u32 i = 0; i < count; ++i)
+			out[i] = lerp(a[i], b[i], t[i * tStride]);
+	}
+
 	//! clamps a value between low and high
 	template <class T>
 	inline const T clamp (const T& value, const T& low, const T& high)
@@ -0,0 +1,129 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_MEMORY_H_INCLUDED__
+#define __IRR_MEMORY_H_INCLUDED__
+
+#include "IrrCompileConfig.h" // for IRRLICHT_API
+#include "irrTypes.h"
+#include <cstddef>
+
+namespace irr
+{
+namespace core
+{
+
+//! Subsystems the engine accounts its memory to
+enum E_MEMORY_CATEGORY
+{
+	//! Anything not listed below
+	EMC_GENERAL = 0,
+	//! Textures and other objects of the video drivers
+	EMC_VIDEO,
+	//! Scene nodes
+	EMC_SCENE,
+	//! GUI elements
+	EMC_GUI,
+	//! Files and file archives
+	EMC_IO,
+	//! Images and their pixel data
+	EMC_IMAGE,
+
+	EMC_COUNT
+};
+
+//! Names of the memory categories
+const c8* const MemoryCategoryNames[] =
+{
+	"general",
+	"video",
+	"scene",
+	"gui",
+	"io",
+	"image",
+	0
+};
+
+//! Allocator the engine takes its tagged memory from
+/** Set it with SIrrlichtCreationParameters::MemoryAllocator or
+setMemoryAllocator. It has to stay valid as long as any memory it gave out
+is alive, and it is called from any thread. */
+class IMemoryAllocator
+{
+public:
+	virtual ~IMemoryAllocator() {}
+
+	//! Allocates memory
+	/** \param size Size in bytes, never 0.
+	\param category Subsystem the memory is for.
+	\return Memory aligned to at least 16 bytes, the engine does not
+	handle failures. */
+	virtual void* allocate(size_t size, E_MEMORY_CATEGORY category) = 0;
+
+	//! Frees memory of allocate with the same size and category
+	virtual void deallocate(void* p, size_t size, E_MEMORY_CATEGORY category) = 0;
+};
+
+//! Memory counters of a category
+/** The totals only grow, sample them twice to get the allocation rate. */
+struct SMemoryStats
+{
+	SMemoryStats() : LiveBytes(0), PeakBytes(0), TotalAllocations(0), TotalBytes(0) {}
+
+	//! Bytes currently allocated
+	u64 LiveBytes;
+	//! Highest value LiveBytes had
+	u64 PeakBytes;
+	//! Number of allocations so far
+	u64 TotalAllocations;
+	//! Bytes allocated so far
+	u64 TotalBytes;
+};
+
+//! Sets the allocator for tagged memory
+/** \param allocator New allocator, or 0 for the global operators new and
+delete.
+\return False if memory of the current allocator is still alive, which the
+new one couldn't free. The allocator is not changed then. */
+IRRLICHT_API bool IRRCALLCONV setMemoryAllocator(IMemoryAllocator* allocator);
+
+//! Returns the allocator set with setMemoryAllocator, 0 for the default one
+IRRLICHT_API IMemoryAllocator* IRRCALLCONV getMemoryAllocator();
+
+//! Allocates memory from the current allocator and accounts it to a category
+IRRLICHT_API void* IRRCALLCONV allocateMemory(size_t size, E_MEMORY_CATEGORY category);
+
+//! Frees memory of allocateMemory, with the same size and category
+IRRLICHT_API void IRRCALLCONV deallocateMemory(void* p, size_t size, E_MEMORY_CATEGORY category);
+
+//! Accounts memory which doesn't come from allocateMemory to a category
+/** For memory owned by a category which another allocator gives out. A
+negative size accounts freed memory. */
+IRRLICHT_API void IRRCALLCONV trackMemory(s64 size, E_MEMORY_CATEGORY category);
+
+//! Returns the counters of a category
+IRRLICHT_API SMemoryStats IRRCALLCONV getMemoryStats(E_MEMORY_CATEGORY category);
+
+//! Base class allocating objects of the derived classes in a memory category
+/** The operator delete gets the size of the most derived class as long as
+the destructor is virtual. */
+template <E_MEMORY_CATEGORY Category>
+class CMemoryTagged
+{
+public:
+	static void* operator new(size_t size)
+	{
+		return allocateMemory(size, Category);
+	}
+
+	static void operator delete(void* p, size_t size)
+	{
+		if (p)
+			deallocateMemory(p, size, Category);
+	}
+};
+
+} // end namespace core
+} // end namespace irr
+
+#endif
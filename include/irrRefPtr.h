@@ -0,0 +1,159 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_REF_PTR_H_INCLUDED__
+#define __IRR_REF_PTR_H_INCLUDED__
+
+#include "IReferenceCounted.h"
+#include <cstddef>
+#include <utility>
+
+namespace irr
+{
+namespace core
+{
+
+//! Pointer to an IReferenceCounted object which calls grab() and drop() for you.
+/** Copying grabs the object and destroying or resetting drops it. Moving
+hands the reference over without touching the reference counter, so a
+ref_ptr can be passed to another thread or stored in a container without
+any grab() and drop() pairs.
+
+Objects returned by a method starting with 'create' already carry a reference
+for the caller, wrap them with grabObject false:
+\code
+core::ref_ptr<video::IImage> image(driver->createImage(...), false);
+\endcode
+*/
+template <class T>
+class ref_ptr
+{
+public:
+	//! Constructs a null pointer
+	ref_ptr() : Object(0) {}
+
+	//! Constructs a null pointer
+	ref_ptr(std::nullptr_t) : Object(0) {}
+
+	//! Points to object
+	/** \param object Object to point to, may be 0.
+	\param grabObject False to take over a reference the caller already
+	owns, like the one of a created object. */
+	explicit ref_ptr(T* object, bool grabObject = true) : Object(object)
+	{
+		if (Object && grabObject)
+			Object->grab();
+	}
+
+	ref_ptr(const ref_ptr& other) : Object(other.Object)
+	{
+		if (Object)
+			Object->grab();
+	}
+
+	ref_ptr(ref_ptr&& other) : Object(other.Object)
+	{
+		other.Object = 0;
+	}
+
+	//! Converts from a pointer to a derived class
+	template <class U>
+	ref_ptr(const ref_ptr<U>& other) : Object(other.get())
+	{
+		if (Object)
+			Object->grab();
+	}
+
+	//! Converts from a pointer to a derived class, without grabbing
+	template <class U>
+	ref_ptr(ref_ptr<U>&& other) : Object(other.release())
+	{
+	}
+
+	~ref_ptr()
+	{
+		if (Object)
+			Object->drop();
+	}
+
+	ref_ptr& operator=(const ref_ptr& other)
+	{
+		reset(other.Object);
+		return *this;
+	}
+
+	ref_ptr& operator=(ref_ptr&& other)
+	{
+		if (this != &other)
+			reset(other.release(), false);
+		return *this;
+	}
+
+	ref_ptr& operator=(std::nullptr_t)
+	{
+		reset();
+		return *this;
+	}
+
+	//! Points to another object and drops the current one
+	/** \param object Object to point to, may be 0.
+	\param grabObject False to take over a reference the caller already owns. */
+	void reset(T* object = 0, bool grabObject = true)
+	{
+		// grab first, object may be the current one
+		if (object && grabObject)
+			object->grab();
+		T* old = Object;
+		Object = object;
+		if (old)
+			old->drop();
+	}
+
+	//! Gives up the reference without dropping it
+	/** \return The object, the caller has to drop() it. */
+	T* release()
+	{
+		T* object = Object;
+		Object = 0;
+		return object;
+	}
+
+	//! Returns the object without changing its reference count
+	T* get() const { return Object; }
+
+	T* operator->() const { return Object; }
+	T& operator*() const { return *Object; }
+	explicit operator bool() const { return Object != 0; }
+
+	void swap(ref_ptr& other) { std::swap(Object, other.Object); }
+
+	template <class U>
+	bool operator==(const ref_ptr<U>& other) const { return Object == other.get(); }
+	template <class U>
+	bool operator!=(const ref_ptr<U>& other) const { return Object != other.get(); }
+	bool operator==(const T* other) const { return Object == other; }
+	bool operator!=(const T* other) const { return Object != other; }
+
+private:
+	T* Object;
+};
+
+//! Wraps an object returned by a 'create' method, taking over its reference
+template <class T>
+inline ref_ptr<T> adopt_ref(T* object)
+{
+	return ref_ptr<T>(object, false);
+}
+
+//! Wraps an object and grabs it
+template <class T>
+inline ref_ptr<T> grab_ref(T* object)
+{
+	return ref_ptr<T>(object);
+}
+
+} // end namespace core
+} // end namespace irr
+
+#endif
+
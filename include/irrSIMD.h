@@ -0,0 +1,111 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __IRR_SIMD_H_INCLUDED__
+#define __IRR_SIMD_H_INCLUDED__
+
+#include "irrTypes.h"
+
+// SSE2 is part of every x86_64 target and NEON of every aarch64 one, the math
+// headers use them for f32 matrices and the batch functions when the compiler
+// targets them. Define IRR_NO_SIMD to use the scalar code instead.
+#if !defined(IRR_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _IRR_SIMD_SSE2_
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define _IRR_SIMD_NEON_
+#endif
+#endif
+
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+namespace irr
+{
+namespace core
+{
+
+	//! Operations on four f32 lanes
+	/** All loads and stores are unaligned, as none of the math types are aligned. */
+	struct SSIMD4f
+	{
+#if defined(_IRR_SIMD_SSE2_)
+		typedef __m128 V;
+		//! Result of a comparison, all bits of a lane are set where it is true
+		typedef __m128 M;
+
+		static V load(const f32* p) { return _mm_loadu_ps(p); }
+		static void store(f32* p, V a) { _mm_storeu_ps(p, a); }
+		//! Stores the first 3 lanes only
+		static void store3(f32* p, V a) { _mm_storel_pi(reinterpret_cast<__m64*>(p), a); _mm_store_ss(p + 2, _mm_movehl_ps(a, a)); }
+		static V splat(f32 v) { return _mm_set1_ps(v); }
+		static V set(f32 a, f32 b, f32 c, f32 d) { return _mm_setr_ps(a, b, c, d); }
+		static V add(V a, V b) { return _mm_add_ps(a, b); }
+		static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+		static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+		static V div(V a, V b) { return _mm_div_ps(a, b); }
+		static V madd(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+		static V min_(V a, V b) { return _mm_min_ps(a, b); }
+		static V max_(V a, V b) { return _mm_max_ps(a, b); }
+		static V sqrt(V a) { return _mm_sqrt_ps(a); }
+		static V abs(V a) { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+		static M less(V a, V b) { return _mm_cmplt_ps(a, b); }
+		static M lessEqual(V a, V b) { return _mm_cmple_ps(a, b); }
+		//! Loads four lanes of 0 or 0xffffffff
+		static M loadMask(const u32* p) { return _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+		//! One bit per set lane, lane 0 in bit 0
+		static u32 bits(M mask) { return (u32)_mm_movemask_ps(mask); }
+		//! a where the mask is set, else b
+		static V select(M mask, V a, V b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		//! Turns four vectors of xyzw into the vectors of x, y, z and w and back
+		static void transpose(V& a, V& b, V& c, V& d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+#else
+		typedef float32x4_t V;
+		//! Result of a comparison, all bits of a lane are set where it is true
+		typedef uint32x4_t M;
+
+		static V load(const f32* p) { return vld1q_f32(p); }
+		static void store(f32* p, V a) { vst1q_f32(p, a); }
+		//! Stores the first 3 lanes only
+		static void store3(f32* p, V a) { vst1_f32(p, vget_low_f32(a)); vst1q_lane_f32(p + 2, a, 2); }
+		static V splat(f32 v) { return vdupq_n_f32(v); }
+		static V set(f32 a, f32 b, f32 c, f32 d) { const f32 v[4] = { a, b, c, d }; return vld1q_f32(v); }
+		static V add(V a, V b) { return vaddq_f32(a, b); }
+		static V sub(V a, V b) { return vsubq_f32(a, b); }
+		static V mul(V a, V b) { return vmulq_f32(a, b); }
+		static V div(V a, V b) { return vdivq_f32(a, b); }
+		static V madd(V a, V b, V c) { return vmlaq_f32(c, a, b); }
+		static V min_(V a, V b) { return vminq_f32(a, b); }
+		static V max_(V a, V b) { return vmaxq_f32(a, b); }
+		static V sqrt(V a) { return vsqrtq_f32(a); }
+		static V abs(V a) { return vabsq_f32(a); }
+		static M less(V a, V b) { return vcltq_f32(a, b); }
+		static M lessEqual(V a, V b) { return vcleq_f32(a, b); }
+		//! Loads four lanes of 0 or 0xffffffff
+		static M loadMask(const u32* p) { return vld1q_u32(p); }
+		//! One bit per set lane, lane 0 in bit 0
+		static u32 bits(M mask)
+		{
+			static const uint32x4_t laneBits = { 1, 2, 4, 8 };
+			return vaddvq_u32(vandq_u32(mask, laneBits));
+		}
+		//! a where the mask is set, else b
+		static V select(M mask, V a, V b) { return vbslq_f32(mask, a, b); }
+		//! Turns four vectors of xyzw into the vectors of x, y, z and w and back
+		static void transpose(V& a, V& b, V& c, V& d)
+		{
+			const float32x4x2_t ab = vtrnq_f32(a, b);
+			const float32x4x2_t cd = vtrnq_f32(c, d);
+			a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+			b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+			c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+			d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+		}
+#endif
+	};
+
+} // end namespace core
+} // end namespace irr
+#endif
+
+#endif
@@ -71,6 +71,10 @@ public:
 		*this = other;
 	}
 
+	//! Move constructor
+	string(string<T>&& other) : str(std::move(other.str))
+	{}
+
 	//! Constructor from other string types
 	template <class B>
 	string(const string<B>& other)
@@ -152,6 +156,13 @@ public:
 		return *this;
 	}
 
+	//! Move assignment operator
+	string<T>& operator=(string<T>&& other)
+	{
+		str = std::move(other.str);
+		return *this;
+	}
+
 	//! Assignment operator for other string types
 	template <class B>
 	string<T>& operator=(const string<B>& other)
@@ -786,6 +797,16 @@ public:
 		return *this;
 	}
 
+	//! Erases a range of characters from the string.
+	/** \param index: Index of the first character to be erased.
+	\param count: Number of characters to erase, clamped to the string end. */
+	string<T>& erase(u32 index, u32 count)
+	{
+		if (index < size())
+			str.erase(index, count);
+		return *this;
+	}
+
 	//! verify the existing string.
 	string<T>& validate()
 	{
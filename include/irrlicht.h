@@ -42,6 +42,7 @@
 #include "EGUIAlignment.h"
 #include "EGUIElementTypes.h"
 #include "EHardwareBufferFlags.h"
+#include "ELightClusterTextures.h"
 #include "EMaterialFlags.h"
 #include "EMaterialTypes.h"
 #include "EMeshWriterEnums.h"
@@ -49,16 +50,21 @@
 #include "fast_atof.h"
 #include "IAnimatedMesh.h"
 #include "IAnimatedMeshSceneNode.h"
+#include "IAnimationClip.h"
 #include "IAttributes.h"
 #include "IBillboardSceneNode.h"
 #include "IBoneSceneNode.h"
 #include "ICameraSceneNode.h"
+#include "IChunkGridSceneNode.h"
 #include "IContextManager.h"
 #include "ICursorControl.h"
 #include "IDummyTransformationSceneNode.h"
 #include "IEventReceiver.h"
 #include "IFileList.h"
+#include "IFilePrefetchRequest.h"
+#include "IFileListRequest.h"
 #include "IFileSystem.h"
+#include "IFrameReplay.h"
 #include "IGPUProgrammingServices.h"
 #include "IGUIButton.h"
 #include "IGUICheckBox.h"
@@ -69,6 +75,8 @@
 #include "IGUIFileOpenDialog.h"
 #include "IGUIFont.h"
 #include "IGUIFontBitmap.h"
+#include "IGUIFontDistanceField.h"
+#include "IGUIGlyphSource.h"
 #include "IGUIImage.h"
 #include "IGUIListBox.h"
 #include "IGUIScrollBar.h"
@@ -80,7 +88,11 @@
 #include "IImage.h"
 #include "IImageLoader.h"
 #include "IImageWriter.h"
+#include "IInstancedMeshSceneNode.h"
 #include "IIndexBuffer.h"
+#include "IJobGraph.h"
+#include "IJobScheduler.h"
+#include "ILightSceneNode.h"
 #include "ILogger.h"
 #include "IMaterialRenderer.h"
 #include "IMaterialRendererServices.h"
@@ -88,24 +100,36 @@
 #include "IMeshBuffer.h"
 #include "IMeshCache.h"
 #include "IMeshLoader.h"
+#include "IMeshLoadRequest.h"
 #include "IMeshManipulator.h"
 #include "IMeshSceneNode.h"
 #include "IMeshWriter.h"
 #include "IOSOperator.h"
+#include "IPostProcessChain.h"
+#include "IProfiler.h"
 #include "IReadFile.h"
 #include "IReferenceCounted.h"
 #include "irrArray.h"
+#include "irrAtom.h"
+#include "IRenderCommand.h"
 #include "IRenderTarget.h"
 #include "IrrlichtDevice.h"
 #include "irrMath.h"
+#include "irrMemory.h"
+#include "irrRefPtr.h"
+#include "irrSIMD.h"
 #include "irrString.h"
 #include "irrTypes.h"
 #include "path.h"
 #include "ISceneCollisionManager.h"
 #include "ISceneManager.h"
 #include "ISceneNode.h"
+#include "ISceneNodeRegistry.h"
+#include "IScreenShotRequest.h"
 #include "IShaderConstantSetCallBack.h"
 #include "ISkinnedMesh.h"
+#include "ISpatialIndex.h"
+#include "IStaticBatchSceneNode.h"
 #include "ITexture.h"
 #include "ITimer.h"
 #include "IVertexBuffer.h"
@@ -119,15 +143,20 @@
 #include "position2d.h"
 #include "quaternion.h"
 #include "rect.h"
+#include "S2DDrawList.h"
+#include "S3DInstance.h"
 #include "S3DVertex.h"
 #include "SAnimatedMesh.h"
 #include "SceneParameters.h"
 #include "SColor.h"
+#include "SDirtyRanges.h"
 #include "SExposedVideoData.h"
 #include "SIrrCreationParameters.h"
 #include "SMaterial.h"
 #include "SMesh.h"
 #include "SMeshBuffer.h"
+#include "SSceneView.h"
+#include "SShadowMapParameters.h"
 #include "SSkinMeshBuffer.h"
 #include "SVertexIndex.h"
 #include "SViewFrustum.h"
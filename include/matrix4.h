@@ -12,6 +12,7 @@
 #include "aabbox3d.h"
 #include "rect.h"
 #include "irrString.h"
+#include "irrSIMD.h"
 #include "IrrCompileConfig.h" // for IRRLICHT_API
 
 // enable this to keep track of changes to the matrix
@@ -22,6 +23,12 @@
 // this is only for debugging purposes
 //#define USE_MATRIX_TEST_DEBUG
 
+// The products, inverse and vector transformations of f32 matrices use SSE2
+// or NEON, see irrSIMD.h
+#if (defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)) && !defined(USE_MATRIX_TEST)
+#define _IRR_MATRIX_SIMD_
+#endif
+
 #if defined( USE_MATRIX_TEST_DEBUG )
 
 struct MatrixTest
@@ -267,6 +274,15 @@ namespace core
 			//! An alternate transform vector method, reading from and writing to an array of 4 floats
 			void transformVec4(T *out, const T * in) const;
 
+			//! Transforms count vectors by this matrix
+			/** This operation is performed as if the vectors were 4d with the 4th component =1.
+			out and in may point to the same array. */
+			void transformVectArray(vector3df* out, const vector3df* in, u32 count) const;
+
+			//! Rotates count vectors by the rotation part of this matrix
+			/** out and in may point to the same array. */
+			void rotateVectArray(vector3df* out, const vector3df* in, u32 count) const;
+
 			//! Translate a vector by the translation part of this matrix.
 			/** This operation is performed as if the vector was 4d with the 4th component =1 */
 			void translateVect( vector3df& vect ) const;
@@ -312,7 +328,8 @@ namespace core
 			CMatrix4<T>& buildProjectionMatrixPerspectiveFovLH(f32 fieldOfViewRadians, f32 aspectRatio, f32 zNear, f32 zFar, bool zClipFromZero=true);
 
 			//! Builds a left-handed perspective projection matrix based on a field of view, with far plane at infinity
-			CMatrix4<T>& buildProjectionMatrixPerspectiveFovInfinityLH(f32 fieldOfViewRadians, f32 aspectRatio, f32 zNear, f32 epsilon=0);
+			//\param zClipFromZero: Clipping of z can be projected from 0 to w when true (D3D style) and from -w to w when false (OGL style).
+			CMatrix4<T>& buildProjectionMatrixPerspectiveFovInfinityLH(f32 fieldOfViewRadians, f32 aspectRatio, f32 zNear, f32 epsilon=0, bool zClipFromZero=true);
 
 			//! Builds a right-handed perspective projection matrix.
 			CMatrix4<T>& buildProjectionMatrixPerspectiveRH(f32 widthOfViewVolume, f32 heightOfViewVolume, f32 zNear, f32 zFar, bool zClipFromZero=true);
@@ -1254,6 +1271,26 @@ namespace core
 		out[3] = in[0]*M[3] + in[1]*M[7] + in[2]*M[11] + in[3]*M[15];
 	}
 
+	template <class T>
+	inline void CMatrix4<T>::transformVectArray(vector3df* out, const vector3df* in, u32 count) const
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			out[i] = in[i];
+			transformVect(out[i]);
+		}
+	}
+
+	template <class T>
+	inline void CMatrix4<T>::rotateVectArray(vector3df* out, const vector3df* in, u32 count) const
+	{
+		for (u32 i = 0; i < count; ++i)
+		{
+			out[i] = in[i];
+			rotateVect(out[i]);
+		}
+	}
+
 
 	//! Transforms a plane by this matrix
 	template <class T>
@@ -1655,7 +1692,7 @@ namespace core
 	// Builds a left-handed perspective projection matrix based on a field of view, with far plane culling at infinity
 	template <class T>
 	inline CMatrix4<T>& CMatrix4<T>::buildProjectionMatrixPerspectiveFovInfinityLH(
-			f32 fieldOfViewRadians, f32 aspectRatio, f32 zNear, f32 epsilon)
+			f32 fieldOfViewRadians, f32 aspectRatio, f32 zNear, f32 epsilon, bool zClipFromZero)
 	{
 		const f64 h = reciprocal(tan(fieldOfViewRadians*0.5));
 		_IRR_DEBUG_BREAK_IF(aspectRatio==0.f); //divide by zero
@@ -1678,7 +1715,10 @@ namespace core
 
 		M[12] = 0;
 		M[13] = 0;
-		M[14] = (T)(zNear*(epsilon-1.f));
+		if ( zClipFromZero ) // DirectX version
+			M[14] = (T)(zNear*(epsilon-1.f));
+		else	// OpenGL version
+			M[14] = (T)(zNear*(epsilon-2.f));
 		M[15] = 0;
 
 #if defined ( USE_MATRIX_TEST )
@@ -2376,6 +2416,193 @@ namespace core
 		return mat*scalar;
 	}
 
+#if defined(_IRR_MATRIX_SIMD_)
+	//! Building blocks of the f32 matrix specializations
+	struct SMatrix4SIMD : public SSIMD4f
+	{
+		//! Sets out to the product a*b, out may be a or b
+		static void multiply(f32* out, const f32* a, const f32* b)
+		{
+			const V a0 = load(a), a1 = load(a + 4), a2 = load(a + 8), a3 = load(a + 12);
+			for (u32 i = 0; i < 16; i += 4)
+			{
+				const V r = madd(a3, splat(b[i + 3]), madd(a2, splat(b[i + 2]),
+					madd(a1, splat(b[i + 1]), mul(a0, splat(b[i])))));
+				store(out + i, r);
+			}
+		}
+
+		//! x*m[0..3] + y*m[4..7] + z*m[8..11]
+		static V rotate(const f32* m, const vector3df& v)
+		{
+			return madd(load(m + 8), splat(v.Z), madd(load(m + 4), splat(v.Y), mul(load(m), splat(v.X))));
+		}
+	};
+
+	template <>
+	inline CMatrix4<f32>& CMatrix4<f32>::setbyproduct_nocheck(const CMatrix4<f32>& other_a, const CMatrix4<f32>& other_b)
+	{
+		SMatrix4SIMD::multiply(M, other_a.M, other_b.M);
+		return *this;
+	}
+
+	template <>
+	inline CMatrix4<f32> CMatrix4<f32>::operator*(const CMatrix4<f32>& m2) const
+	{
+		CMatrix4<f32> m3(EM4CONST_NOTHING);
+		SMatrix4SIMD::multiply(m3.M, M, m2.M);
+		return m3;
+	}
+
+	template <>
+	inline void CMatrix4<f32>::rotateVect(vector3df& vect) const
+	{
+		SMatrix4SIMD::store3(&vect.X, SMatrix4SIMD::rotate(M, vect));
+	}
+
+	template <>
+	inline void CMatrix4<f32>::rotateVect(vector3df& out, const vector3df& in) const
+	{
+		SMatrix4SIMD::store3(&out.X, SMatrix4SIMD::rotate(M, in));
+	}
+
+	template <>
+	inline void CMatrix4<f32>::rotateVect(f32* out, const vector3df& in) const
+	{
+		SMatrix4SIMD::store3(out, SMatrix4SIMD::rotate(M, in));
+	}
+
+	template <>
+	inline void CMatrix4<f32>::transformVect(vector3df& vect) const
+	{
+		SMatrix4SIMD::store3(&vect.X, SMatrix4SIMD::add(SMatrix4SIMD::rotate(M, vect), SMatrix4SIMD::load(M + 12)));
+	}
+
+	template <>
+	inline void CMatrix4<f32>::transformVect(vector3df& out, const vector3df& in) const
+	{
+		SMatrix4SIMD::store3(&out.X, SMatrix4SIMD::add(SMatrix4SIMD::rotate(M, in), SMatrix4SIMD::load(M + 12)));
+	}
+
+	template <>
+	inline void CMatrix4<f32>::transformVect(f32* out, const vector3df& in) const
+	{
+		SMatrix4SIMD::store(out, SMatrix4SIMD::add(SMatrix4SIMD::rotate(M, in), SMatrix4SIMD::load(M + 12)));
+	}
+
+	template <>
+	inline void CMatrix4<f32>::transformVectArray(vector3df* out, const vector3df* in, u32 count) const
+	{
+		typedef SMatrix4SIMD S;
+		const S::V m0 = S::load(M), m1 = S::load(M + 4), m2 = S::load(M + 8), m3 = S::load(M + 12);
+		for (u32 i = 0; i < count; ++i)
+			S::store3(&out[i].X, S::madd(m2, S::splat(in[i].Z), S::madd(m1, S::splat(in[i].Y), S::madd(m0, S::splat(in[i].X), m3))));
+	}
+
+	template <>
+	inline void CMatrix4<f32>::rotateVectArray(vector3df* out, const vector3df* in, u32 count) const
+	{
+		typedef SMatrix4SIMD S;
+		const S::V m0 = S::load(M), m1 = S::load(M + 4), m2 = S::load(M + 8);
+		for (u32 i = 0; i < count; ++i)
+			S::store3(&out[i].X, S::madd(m2, S::splat(in[i].Z), S::madd(m1, S::splat(in[i].Y), S::mul(m0, S::splat(in[i].X)))));
+	}
+
+	template <>
+	inline void CMatrix4<f32>::transformBoxEx(core::aabbox3d<f32>& box) const
+	{
+		typedef SMatrix4SIMD S;
+		S::V bmin = S::load(M + 12);
+		S::V bmax = bmin;
+		const f32* amin = &box.MinEdge.X;
+		const f32* amax = &box.MaxEdge.X;
+		for (u32 j = 0; j < 3; ++j)
+		{
+			const S::V row = S::load(M + j * 4);
+			const S::V a = S::mul(row, S::splat(amin[j]));
+			const S::V b = S::mul(row, S::splat(amax[j]));
+			bmin = S::add(bmin, S::min_(a, b));
+			bmax = S::add(bmax, S::max_(a, b));
+		}
+		S::store3(&box.MinEdge.X, bmin);
+		S::store3(&box.MaxEdge.X, bmax);
+	}
+
+#if defined(_IRR_SIMD_SSE2_)
+	//! Inverse by the 2x2 block matrices of this matrix.
+	template <>
+	inline bool CMatrix4<f32>::getInverse(CMatrix4<f32>& out) const
+	{
+#define IRR_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define IRR_SWIZZLE(a, x, y, z, w) IRR_SHUFFLE(a, a, x, y, z, w)
+		// products of 2x2 matrices stored as (m00, m01, m10, m11)
+		struct Mat2
+		{
+			// a*b
+			static __m128 mul(__m128 a, __m128 b)
+			{
+				return _mm_add_ps(_mm_mul_ps(a, IRR_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(IRR_SWIZZLE(a, 1, 0, 3, 2), IRR_SWIZZLE(b, 2, 1, 2, 1)));
+			}
+			// adjugate(a)*b
+			static __m128 adjMul(__m128 a, __m128 b)
+			{
+				return _mm_sub_ps(_mm_mul_ps(IRR_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(IRR_SWIZZLE(a, 1, 1, 2, 2), IRR_SWIZZLE(b, 2, 3, 0, 1)));
+			}
+			// a*adjugate(b)
+			static __m128 mulAdj(__m128 a, __m128 b)
+			{
+				return _mm_sub_ps(_mm_mul_ps(a, IRR_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(IRR_SWIZZLE(a, 1, 0, 3, 2), IRR_SWIZZLE(b, 2, 1, 2, 1)));
+			}
+		};
+
+		const __m128 r0 = _mm_loadu_ps(M), r1 = _mm_loadu_ps(M + 4), r2 = _mm_loadu_ps(M + 8), r3 = _mm_loadu_ps(M + 12);
+		const __m128 A = _mm_movelh_ps(r0, r1);
+		const __m128 B = _mm_movehl_ps(r1, r0);
+		const __m128 C = _mm_movelh_ps(r2, r3);
+		const __m128 D = _mm_movehl_ps(r3, r2);
+
+		// determinants of A, B, C and D
+		const __m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(IRR_SHUFFLE(r0, r2, 0, 2, 0, 2), IRR_SHUFFLE(r1, r3, 1, 3, 1, 3)),
+			_mm_mul_ps(IRR_SHUFFLE(r0, r2, 1, 3, 1, 3), IRR_SHUFFLE(r1, r3, 0, 2, 0, 2)));
+		const __m128 detA = IRR_SWIZZLE(detSub, 0, 0, 0, 0);
+		const __m128 detB = IRR_SWIZZLE(detSub, 1, 1, 1, 1);
+		const __m128 detC = IRR_SWIZZLE(detSub, 2, 2, 2, 2);
+		const __m128 detD = IRR_SWIZZLE(detSub, 3, 3, 3, 3);
+
+		const __m128 D_C = Mat2::adjMul(D, C);
+		const __m128 A_B = Mat2::adjMul(A, B);
+		__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2::mul(B, D_C));
+		__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2::mul(C, A_B));
+		__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2::mulAdj(D, A_B));
+		__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2::mulAdj(A, D_C));
+
+		// |M| = |A||D| + |B||C| - trace(A_B * D_C)
+		__m128 trace = _mm_mul_ps(A_B, IRR_SWIZZLE(D_C, 0, 2, 1, 3));
+		trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+		trace = _mm_add_ss(trace, IRR_SWIZZLE(trace, 1, 1, 1, 1));
+		const f32 d = _mm_cvtss_f32(_mm_sub_ss(_mm_add_ss(_mm_mul_ss(detA, detD), _mm_mul_ss(detB, detC)), trace));
+
+		if (core::iszero(d, FLT_MIN))
+			return false;
+
+		const __m128 scale = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), _mm_set1_ps(d));
+		X = _mm_mul_ps(X, scale);
+		Y = _mm_mul_ps(Y, scale);
+		Z = _mm_mul_ps(Z, scale);
+		W = _mm_mul_ps(W, scale);
+
+		_mm_storeu_ps(out.M, IRR_SHUFFLE(X, Y, 3, 1, 3, 1));
+		_mm_storeu_ps(out.M + 4, IRR_SHUFFLE(X, Y, 2, 0, 2, 0));
+		_mm_storeu_ps(out.M + 8, IRR_SHUFFLE(Z, W, 3, 1, 3, 1));
+		_mm_storeu_ps(out.M + 12, IRR_SHUFFLE(Z, W, 2, 0, 2, 0));
+#undef IRR_SWIZZLE
+#undef IRR_SHUFFLE
+		return true;
+	}
+#endif
+#endif
+
 
 	//! Typedef for f32 matrix
 	typedef CMatrix4<f32> matrix4;
@@ -777,6 +777,8 @@ private:
 	typedef void (APIENTRYP PFNGLTEXPAGECOMMITMENTPROC_MT) (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLboolean commit);
 
 	std::unordered_set<std::string> extensions;
+	// Vendor, renderer and version of the context the procedures were last loaded for.
+	std::string loadedContext;
 public:
 	// Call this once after creating the context.
 	void LoadAllProcedures(irr::video::IContextManager *cmgr);
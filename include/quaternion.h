@@ -751,6 +751,199 @@ inline core::quaternion& quaternion::rotationFromTo(const vector3df& from, const
 }
 
 
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+//! Building blocks of the quaternion batch functions
+struct SQuaternionSIMD : public SSIMD4f
+{
+	//! acos for x between 0 and 1, Abramowitz and Stegun 4.4.45 with an error below 2e-8
+	static V acos01(V x)
+	{
+		V p = splat(-0.0012624911f);
+		p = madd(p, x, splat(0.0066700901f));
+		p = madd(p, x, splat(-0.0170881256f));
+		p = madd(p, x, splat(0.0308918810f));
+		p = madd(p, x, splat(-0.0501743046f));
+		p = madd(p, x, splat(0.0889789874f));
+		p = madd(p, x, splat(-0.2145988016f));
+		p = madd(p, x, splat(1.5707963050f));
+		return mul(p, sqrt(sub(splat(1.f), x)));
+	}
+
+	//! sin for x between 0 and PI/2, Taylor series up to x^11 with an error below 6e-8
+	static V sinHalfPi(V x)
+	{
+		const V x2 = mul(x, x);
+		V p = splat(-1.f / 39916800.f);
+		p = madd(p, x2, splat(1.f / 362880.f));
+		p = madd(p, x2, splat(-1.f / 5040.f));
+		p = madd(p, x2, splat(1.f / 120.f));
+		p = madd(p, x2, splat(-1.f / 6.f));
+		p = madd(p, x2, splat(1.f));
+		return mul(p, x);
+	}
+
+	//! Loads four quaternions as vectors of their x, y, z and w
+	static void load(const quaternion* q, V& x, V& y, V& z, V& w)
+	{
+		x = SSIMD4f::load(&q[0].X);
+		y = SSIMD4f::load(&q[1].X);
+		z = SSIMD4f::load(&q[2].X);
+		w = SSIMD4f::load(&q[3].X);
+		transpose(x, y, z, w);
+	}
+
+	static void store(quaternion* q, V x, V y, V z, V w)
+	{
+		transpose(x, y, z, w);
+		SSIMD4f::store(&q[0].X, x);
+		SSIMD4f::store(&q[1].X, y);
+		SSIMD4f::store(&q[2].X, z);
+		SSIMD4f::store(&q[3].X, w);
+	}
+};
+#endif
+
+
+//! Interpolates count pairs of quaternions, out[i].slerp(q1[i], q2[i], time[i*timeStride], threshold)
+/** A timeStride of 0 uses time[0] for all pairs. out may be q1 or q2.
+With SSE2 or NEON four pairs are interpolated at once and acos and sin are
+approximated by polynomials, so the results differ from slerp() in the last
+bits. The times have to be between 0 and 1 for this. */
+inline void slerpArray(quaternion* out, const quaternion* q1, const quaternion* q2,
+		const f32* time, u32 timeStride, u32 count, f32 threshold=.05f)
+{
+	u32 i = 0;
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+	typedef SQuaternionSIMD S;
+	const S::V one = S::splat(1.f);
+	const S::V limit = S::splat(1.f - threshold);
+	for (; i + 4 <= count; i += 4)
+	{
+		S::V ax, ay, az, aw, bx, by, bz, bw;
+		S::load(q1 + i, ax, ay, az, aw);
+		S::load(q2 + i, bx, by, bz, bw);
+		const S::V t = timeStride ? S::set(time[i * timeStride], time[(i + 1) * timeStride],
+			time[(i + 2) * timeStride], time[(i + 3) * timeStride]) : S::splat(time[0]);
+		const S::V invT = S::sub(one, t);
+
+		// make sure we use the short rotation
+		S::V angle = S::madd(ax, bx, S::madd(ay, by, S::madd(az, bz, S::mul(aw, bw))));
+		const S::V sign = S::select(S::less(angle, S::splat(0.f)), S::splat(-1.f), one);
+		angle = S::mul(angle, sign);
+		ax = S::mul(ax, sign);
+		ay = S::mul(ay, sign);
+		az = S::mul(az, sign);
+		aw = S::mul(aw, sign);
+
+		// spherical interpolation
+		const S::V theta = S::acos01(S::min_(angle, one));
+		const S::V invSinTheta = S::div(one, S::sinHalfPi(theta));
+		S::V scale = S::mul(S::sinHalfPi(S::mul(theta, invT)), invSinTheta);
+		S::V invScale = S::mul(S::sinHalfPi(S::mul(theta, t)), invSinTheta);
+
+		// linear interpolation which is normalized, where the quaternions are too close for that
+		const S::V lx = S::madd(ax, invT, S::mul(bx, t));
+		const S::V ly = S::madd(ay, invT, S::mul(by, t));
+		const S::V lz = S::madd(az, invT, S::mul(bz, t));
+		const S::V lw = S::madd(aw, invT, S::mul(bw, t));
+		const S::V invLength = S::div(one, S::sqrt(S::madd(lx, lx, S::madd(ly, ly, S::madd(lz, lz, S::mul(lw, lw))))));
+		const S::M spherical = S::lessEqual(angle, limit);
+		scale = S::select(spherical, scale, S::mul(invT, invLength));
+		invScale = S::select(spherical, invScale, S::mul(t, invLength));
+
+		S::store(out + i,
+			S::madd(ax, scale, S::mul(bx, invScale)),
+			S::madd(ay, scale, S::mul(by, invScale)),
+			S::madd(az, scale, S::mul(bz, invScale)),
+			S::madd(aw, scale, S::mul(bw, invScale)));
+	}
+#endif
+	for (; i < count; ++i)
+		out[i].slerp(q1[i], q2[i], time[i * timeStride], threshold);
+}
+
+
+//! Builds count transformation matrices from rotations, translations and optional scales
+/** Each matrix is the same as rotation[i].getMatrix_transposed() with the
+translation translation[i], and the first three rows scaled by scale[i] when
+scale is not 0. With SSE2 or NEON four matrices are built at once. */
+inline void getMatrixArray_transposed(matrix4* dest, const quaternion* rotation,
+		const vector3df* translation, const vector3df* scale, u32 count)
+{
+	u32 i = 0;
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+	typedef SQuaternionSIMD S;
+	const S::V one = S::splat(1.f);
+	const S::V two = S::splat(2.f);
+	for (; i + 4 <= count; i += 4)
+	{
+		S::V x, y, z, w;
+		S::load(rotation + i, x, y, z, w);
+
+		const S::V invLength = S::div(one, S::sqrt(S::madd(x, x, S::madd(y, y, S::madd(z, z, S::mul(w, w))))));
+		x = S::mul(x, invLength);
+		y = S::mul(y, invLength);
+		z = S::mul(z, invLength);
+		w = S::mul(w, invLength);
+
+		const S::V x2 = S::mul(x, two), y2 = S::mul(y, two), z2 = S::mul(z, two);
+		const S::V xx = S::mul(x, x2), yy = S::mul(y, y2), zz = S::mul(z, z2);
+		const S::V xy = S::mul(x, y2), xz = S::mul(x, z2), yz = S::mul(y, z2);
+		const S::V xw = S::mul(x2, w), yw = S::mul(y2, w), zw = S::mul(z2, w);
+
+		// the rows of the four matrices, as vectors over the matrices
+		S::V r[3][4] = {
+			{ S::sub(S::sub(one, yy), zz), S::sub(xy, zw), S::add(xz, yw), S::splat(0.f) },
+			{ S::add(xy, zw), S::sub(S::sub(one, xx), zz), S::sub(yz, xw), S::splat(0.f) },
+			{ S::sub(xz, yw), S::add(yz, xw), S::sub(S::sub(one, xx), yy), S::splat(0.f) }
+		};
+
+		if (scale)
+		{
+			const vector3df* s = scale + i;
+			const S::V sx = S::set(s[0].X, s[1].X, s[2].X, s[3].X);
+			const S::V sy = S::set(s[0].Y, s[1].Y, s[2].Y, s[3].Y);
+			const S::V sz = S::set(s[0].Z, s[1].Z, s[2].Z, s[3].Z);
+			for (u32 c = 0; c < 3; ++c)
+			{
+				r[0][c] = S::mul(r[0][c], sx);
+				r[1][c] = S::mul(r[1][c], sy);
+				r[2][c] = S::mul(r[2][c], sz);
+			}
+		}
+
+		for (u32 row = 0; row < 3; ++row)
+		{
+			S::transpose(r[row][0], r[row][1], r[row][2], r[row][3]);
+			for (u32 j = 0; j < 4; ++j)
+				S::SSIMD4f::store(dest[i + j].pointer() + row * 4, r[row][j]);
+		}
+
+		for (u32 j = 0; j < 4; ++j)
+		{
+			const vector3df& t = translation[i + j];
+			S::SSIMD4f::store(dest[i + j].pointer() + 12, S::set(t.X, t.Y, t.Z, 1.f));
+		}
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		rotation[i].getMatrix_transposed(dest[i]);
+		dest[i].setTranslation(translation[i]);
+		if (scale)
+		{
+			f32* m = dest[i].pointer();
+			for (u32 c = 0; c < 3; ++c)
+			{
+				m[c] *= scale[i].X;
+				m[4 + c] *= scale[i].Y;
+				m[8 + c] *= scale[i].Z;
+			}
+		}
+	}
+}
+
+
 } // end namespace core
 } // end namespace irr
 
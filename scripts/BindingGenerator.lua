@@ -383,6 +383,8 @@ f:write( typedefs:Concat( "\n" ) );
 f:write( "\n\n" );
 f:write [[
 	std::unordered_set<std::string> extensions;
+	// Vendor, renderer and version of the context the procedures were last loaded for.
+	std::string loadedContext;
 public:
 	// Call this once after creating the context.
 	void LoadAllProcedures(irr::video::IContextManager *cmgr);
@@ -418,18 +420,43 @@ OpenGLProcedures GL = OpenGLProcedures();
 
 void OpenGLProcedures::LoadAllProcedures(irr::video::IContextManager *cmgr)
 {
+	// Entry points are only looked up while still missing, so with another context of
+	// the same driver everything left to do is failing the missing ones again.
+	if (!GetString) GetString = (PFNGLGETSTRINGPROC_MT)cmgr->getProcAddress("glGetString");
+	if (!GetString)
+		return;
+	std::string context;
+	for (GLenum name : {VENDOR, RENDERER, VERSION}) {
+		auto str = GetString(name);
+		context.append(str ? (const char *)str : "").append("/");
+	}
+	if (context == loadedContext)
+		return;
+	loadedContext = context;
+	extensions.clear();
 
 ]];
 f:write( loader:Concat() );
 f:write[[
 
+	// OpenGL 3 way to enumerate extensions
+	int ext_count = 0;
+	GetIntegerv(NUM_EXTENSIONS, &ext_count);
+	extensions.reserve(ext_count);
+	for (int k = 0; k < ext_count; k++)
+		extensions.emplace((char *)GetStringi(EXTENSIONS, k));
+	if (ext_count)
+		return;
+
+	// OpenGL 2 / ES 2 way to enumerate extensions
+	auto ext_str = GetString(EXTENSIONS);
+	if (!ext_str)
+		return;
 	// get the extension string, chop it up
-	std::string ext_string = std::string((char*)GetString(EXTENSIONS));
-	std::stringstream ext_ss(ext_string);
+	std::stringstream ext_ss((char*)ext_str);
 	std::string tmp;
 	while (std::getline(ext_ss, tmp, ' '))
 		extensions.emplace(tmp);
-
 }
 ]];
 f:close();
@@ -50,6 +50,17 @@ const IFileList* CAndroidAssetFileArchive::getFileList() const
 //! opens a file by file name
 IReadFile* CAndroidAssetFileArchive::createAndOpenFile(const io::path& filename)
 {
+	// the files of added directories are known, other names aren't in the apk
+	if (!IgnorePaths && findFile(filename, false) < 0)
+	{
+		io::path dirname(filename);
+		dirname.replace('\\', '/');
+		const s32 slash = dirname.findLast('/');
+		dirname = slash >= 0 ? dirname.subString(0, slash) : io::path();
+		if (findFile(dirname, true) >= 0)
+			return NULL;
+	}
+
     CAndroidAssetReader *reader = new CAndroidAssetReader(AssetManager, filename);
 
     if(reader->isOpen())
@@ -101,6 +112,9 @@ void CAndroidAssetFileArchive::addDirectoryToFileList(const io::path &dirname_)
 		// os::Printer::log("addItem:", full_filename.c_str(), ELL_DEBUG);
 	}
 	AAssetDir_close(dir);
+
+	// searched by findFile for every file which is opened
+	sort();
 }
 
 } // end namespace io
@@ -49,7 +49,8 @@ namespace io
 
 		//! Add a directory to read files from. Since the Android 
 		//! API does not return names of directories, they need to
-		//! be added manually.
+		//! be added manually. The files of added directories are
+		//! kept, names missing in them are not looked up again.
 		virtual void addDirectoryToFileList(const io::path &filename);
 
 		//! return the name (id) of the file Archive
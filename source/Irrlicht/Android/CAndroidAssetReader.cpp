@@ -14,6 +14,7 @@
 
 #include <android_native_app_glue.h>
 #include <android/native_activity.h>
+#include <unistd.h>
 
 namespace irr
 {
@@ -21,12 +22,21 @@ namespace io
 {
 
 CAndroidAssetReader::CAndroidAssetReader(AAssetManager *assetManager, const io::path &filename)
-	: AssetManager(assetManager), Filename(filename)
+	: AssetManager(assetManager), Filename(filename), Buffer(0)
 {
 	Asset = AAssetManager_open(AssetManager, 
 					core::stringc(filename).c_str(),
-				    AASSET_MODE_RANDOM);
+				    AASSET_MODE_BUFFER);
 
+	// only assets stored uncompressed have a file descriptor, getting the
+	// buffer of compressed ones would inflate them completely
+	off_t start, length;
+	const int fd = Asset ? AAsset_openFileDescriptor(Asset, &start, &length) : -1;
+	if (fd >= 0)
+	{
+		close(fd);
+		Buffer = AAsset_getBuffer(Asset);
+	}
 }
 
 CAndroidAssetReader::~CAndroidAssetReader()
@@ -10,7 +10,7 @@
 #ifdef  _IRR_COMPILE_ANDROID_ASSET_READER_
 
 
-#include "IReadFile.h"
+#include "IMemoryReadFile.h"
 
 struct AAssetManager;
 struct AAsset;
@@ -21,7 +21,10 @@ namespace irr
 namespace io
 {
 
-	class CAndroidAssetReader : public virtual IReadFile
+	//! Reads an asset of the apk
+	/** Assets which are stored uncompressed are mapped, so loaders can
+	parse them in place through the IMemoryReadFile interface. */
+	class CAndroidAssetReader : public IMemoryReadFile
 	{
 	public:
 		CAndroidAssetReader(AAssetManager *assetManager, const io::path &filename);
@@ -54,6 +57,12 @@ namespace io
 		/** \return File name as zero terminated character string. */
 		virtual const io::path& getFileName() const;
 
+		//! Get the mapped asset, 0 if it is compressed
+		const void *getBuffer() const override { return Buffer; }
+
+		//! Mapped assets are memory read files, see getBuffer()
+		EREAD_FILE_TYPE getType() const override { return Buffer ? ERFT_MEMORY_READ_FILE : EFIT_UNKNOWN; }
+
 		/** Return true if the file could be opened. */
 		bool isOpen() const { return Asset!=NULL; }
 
@@ -64,6 +73,9 @@ namespace io
 		// An asset, i.e. file
 		AAsset *Asset;
 		path Filename;
+
+		//! The mapped asset
+		const void *Buffer;
     };
 
 } // end namespace io
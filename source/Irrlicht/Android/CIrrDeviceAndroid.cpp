@@ -102,6 +102,8 @@ bool CIrrDeviceAndroid::run()
 	if (!Initialized)
 		return false;
 
+	// waits for the frame time before the input is read
+	paceFrame();
 	os::Timer::tick();
 
 	s32 id;
@@ -176,6 +178,14 @@ void CIrrDeviceAndroid::sleep(u32 timeMs, bool pauseTimer)
 		Timer->start();
 }
 
+bool CIrrDeviceAndroid::waitForEvents(u32 timeoutMs)
+{
+	// the looper reports the sources without reading them, run() processes their events
+	s32 events = 0;
+	void* source = 0;
+	return ALooper_pollOnce((int)timeoutMs, 0, &events, &source) >= 0;
+}
+
 void CIrrDeviceAndroid::setWindowCaption(const wchar_t* text)
 {
 }
@@ -30,6 +30,8 @@ namespace irr
 
 		virtual void sleep(u32 timeMs, bool pauseTimer = false);
 
+		virtual bool waitForEvents(u32 timeoutMs);
+
 		virtual void setWindowCaption(const wchar_t* text);
 
 		virtual bool isWindowActive() const;
@@ -12,6 +12,7 @@
 #endif
 #include "IDummyTransformationSceneNode.h"
 #include "IBoneSceneNode.h"
+#include "ICameraSceneNode.h"
 #include "IMaterialRenderer.h"
 #include "IMesh.h"
 #include "IMeshCache.h"
@@ -34,11 +35,12 @@ CAnimatedMeshSceneNode::CAnimatedMeshSceneNode(IAnimatedMesh* mesh,
 		const core::vector3df& scale)
 : IAnimatedMeshSceneNode(parent, mgr, id, position, rotation, scale), Mesh(0),
 	StartFrame(0), EndFrame(0), FramesPerSecond(0.025f),
-	CurrentFrameNr(0.f), LastTimeMs(0),
+	CurrentFrameNr(0.f), LastTimeMs(0), LastTimeFraction(0.f),
 	TransitionTime(0), Transiting(0.f), TransitingBlend(0.f),
 	JointMode(EJUOR_NONE), JointsUsed(false),
-	Looping(true), ReadOnlyMaterials(false), RenderFromIdentity(false),
-	LoopCallBack(0), PassCount(0)
+	Looping(true), ReadOnlyMaterials(false), RenderFromIdentity(false), LoopBoundingBox(false),
+	LoopCallBack(0), PassCount(0), PreparedMesh(0), Pose(0),
+	LODScreenSize(0.f), LODUpdateInterval(100), LODElapsedMs(0), AnimatedFrameNr(0.f)
 {
 	#ifdef _DEBUG
 	setDebugName("CAnimatedMeshSceneNode");
@@ -53,6 +55,9 @@ CAnimatedMeshSceneNode::~CAnimatedMeshSceneNode()
 {
 	if (LoopCallBack)
 		LoopCallBack->drop();
+
+	if (Pose)
+		Pose->drop();
 }
 
 
@@ -61,6 +66,8 @@ void CAnimatedMeshSceneNode::setCurrentFrame(f32 frame)
 {
 	// if you pass an out of range value, we just clamp it
 	CurrentFrameNr = core::clamp ( frame, (f32)StartFrame, (f32)EndFrame );
+	PreparedMesh = 0;
+	LODElapsedMs = LODUpdateInterval; // show it at once
 
 	beginTransition(); //transit to this frame if enabled
 }
@@ -74,11 +81,11 @@ f32 CAnimatedMeshSceneNode::getFrameNr() const
 
 
 //! Get CurrentFrameNr and update transiting settings
-void CAnimatedMeshSceneNode::buildFrameNr(u32 timeMs)
+void CAnimatedMeshSceneNode::buildFrameNr(f32 timeMs)
 {
 	if (Transiting!=0.f)
 	{
-		TransitingBlend += (f32)(timeMs) * Transiting;
+		TransitingBlend += timeMs * Transiting;
 		if (TransitingBlend > 1.f)
 		{
 			Transiting=0.f;
@@ -150,6 +157,9 @@ void CAnimatedMeshSceneNode::OnRegisterSceneNode()
 		int transparentCount = 0;
 		int solidCount = 0;
 
+		// casters are registered even when culled, their shadows may still be visible
+		SceneManager->registerNodeForRendering(this, scene::ESNRP_SHADOW);
+
 		// count transparent and solid materials in this scene node
 		const u32 numMaterials = ReadOnlyMaterials ? Mesh->getMeshBufferCount() : Materials.size();
 		for (u32 i=0; i<numMaterials; ++i)
@@ -191,30 +201,55 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 		return 0;
 #else
 
+		CSkinnedMesh* skinnedMesh = static_cast<CSkinnedMesh*>(Mesh);
+
+		// Nodes small on the screen update their pose less often, without the
+		// normals, and leave their joints to be positioned by the next OnAnimate()
+		const bool reduced = isAnimationLODReduced();
+		const bool updatePose = !reduced || LODElapsedMs >= LODUpdateInterval;
+		if (updatePose)
+		{
+			AnimatedFrameNr = getFrameNr();
+			LODElapsedMs = 0;
+		}
+
+		// Nodes showing the same frame share a skinned copy of the mesh,
+		// unless the joints of this node are set by the user or blended from layers.
+		if (JointMode != EJUOR_CONTROL && AnimationLayers.empty())
+		{
+			SMesh* pose = skinnedMesh->grabPose(AnimatedFrameNr, 0, !reduced);
+			if (pose)
+			{
+				if (Pose)
+					Pose->drop();
+				Pose = pose;
+
+				if (JointMode == EJUOR_READ && updatePose && gatherNeededJoints())
+				{
+					// the joints may still be animated for another node
+					skinnedMesh->animateMesh(AnimatedFrameNr, 1.0f);
+					recoverNeededJoints(skinnedMesh, !reduced);
+				}
+
+				return Pose;
+			}
+		}
+
 		// As multiple scene nodes may be sharing the same skinned mesh, we have to
 		// re-animate it every frame to ensure that this node gets the mesh that it needs.
 
-		CSkinnedMesh* skinnedMesh = static_cast<CSkinnedMesh*>(Mesh);
-
 		if (JointMode == EJUOR_CONTROL)//write to mesh
 			skinnedMesh->transferJointsToMesh(JointChildSceneNodes);
+		else if (!AnimationLayers.empty())
+			animateLayers();
 		else
-			skinnedMesh->animateMesh(getFrameNr(), 1.0f);
+			skinnedMesh->animateMesh(AnimatedFrameNr, 1.0f);
 
 		// Update the skinned mesh for the current joint transforms.
-		skinnedMesh->skinMesh();
+		skinnedMesh->skinMesh(0, !reduced);
 
-		if (JointMode == EJUOR_READ)//read from mesh
-		{
-			skinnedMesh->recoverJointsFromMesh(JointChildSceneNodes);
-
-			//---slow---
-			for (u32 n=0;n<JointChildSceneNodes.size();++n)
-				if (JointChildSceneNodes[n]->getParent()==this)
-				{
-					JointChildSceneNodes[n]->updateAbsolutePositionOfAllChildren(); //temp, should be an option
-				}
-		}
+		if (JointMode == EJUOR_READ && gatherNeededJoints())//read from mesh
+			recoverNeededJoints(skinnedMesh, !reduced);
 
 		if(JointMode == EJUOR_CONTROL)
 		{
@@ -228,17 +263,71 @@ IMesh * CAnimatedMeshSceneNode::getMeshForCurrentFrame()
 }
 
 
+//! Keyframe the mesh of the current frame is blended towards on the GPU
+IMesh* CAnimatedMeshSceneNode::getMorphTargetMesh(f32& blend)
+{
+	const f32 frameNr = getFrameNr();
+	blend = core::fract(frameNr);
+	if (Mesh->getMeshType() == EAMT_SKINNED || blend <= 0.f)
+		return 0;
+
+	// backwards playback blends between the same two keyframes
+	const s32 next = (s32)frameNr + 1;
+	if (next > EndFrame || next >= (s32)Mesh->getFrameCount())
+		return 0;
+
+	return Mesh->getMesh(next, 255, StartFrame, EndFrame);
+}
+
+
+//! Animates and skins the mesh for the current frame ahead of render()
+void CAnimatedMeshSceneNode::prepareMeshForCurrentFrame()
+{
+	PreparedMesh = Mesh ? getMeshForCurrentFrame() : 0;
+}
+
+
+//! Skins the shared copy of the mesh for the current frame ahead of render()
+void CAnimatedMeshSceneNode::preparePoseForCurrentFrame(CJobSystem* jobs)
+{
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	if (!Mesh || Mesh->getMeshType() != EAMT_SKINNED || JointMode == EJUOR_CONTROL || !AnimationLayers.empty())
+		return;
+
+	// render() gets the same copy again from the pose cache
+	const bool reduced = isAnimationLODReduced();
+	const f32 frame = (reduced && LODElapsedMs < LODUpdateInterval) ? AnimatedFrameNr : getFrameNr();
+	SMesh* pose = static_cast<CSkinnedMesh*>(Mesh)->grabPose(frame, jobs, !reduced);
+	if (pose)
+	{
+		if (Pose)
+			Pose->drop();
+		Pose = pose;
+	}
+#endif
+}
+
+
 //! OnAnimate() is called just before rendering the whole scene.
 void CAnimatedMeshSceneNode::OnAnimate(u32 timeMs)
 {
+	const f32 timeFraction = SceneManager->getAnimationTimeFraction(timeMs);
 	if (LastTimeMs==0)	// first frame
 	{
 		LastTimeMs = timeMs;
+		LastTimeFraction = timeFraction;
 	}
 
+	// the fractions are 0 unless the scene manager animates with FRACTIONAL_ANIMATION_TIME
+	const f32 elapsedMs = (f32)(timeMs-LastTimeMs) + (timeFraction-LastTimeFraction);
+
 	// set CurrentFrameNr
-	buildFrameNr(timeMs-LastTimeMs);
+	buildFrameNr(elapsedMs);
+	buildLayerFrames(elapsedMs);
+	LODElapsedMs += timeMs-LastTimeMs;
 	LastTimeMs = timeMs;
+	LastTimeFraction = timeFraction;
+	PreparedMesh = 0;
 
 	IAnimatedMeshSceneNode::OnAnimate(timeMs);
 }
@@ -253,16 +342,26 @@ void CAnimatedMeshSceneNode::render()
 		return;
 
 
-	const bool isTransparentPass =
-		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+	const E_SCENE_NODE_RENDER_PASS pass = SceneManager->getSceneNodeRenderPass();
+	const bool isTransparentPass = pass == scene::ESNRP_TRANSPARENT;
+
+	// the depth pre-pass and the shadow maps draw the solid buffers once more,
+	// without debug data
+	if (pass != scene::ESNRP_DEPTH_PREPASS && pass != scene::ESNRP_SHADOW)
+		++PassCount;
 
-	++PassCount;
+	scene::IMesh* m = PreparedMesh ? PreparedMesh : getMeshForCurrentFrame();
 
-	scene::IMesh* m = getMeshForCurrentFrame();
+	f32 morphBlend = 0.f;
+	scene::IMesh* morphTarget = driver->queryFeature(video::EVDF_HARDWARE_MORPHING) ? getMorphTargetMesh(morphBlend) : 0;
 
 	if(m)
 	{
-		Box = m->getBoundingBox();
+		if (!LoopBoundingBox && Box != m->getBoundingBox())
+		{
+			Box = m->getBoundingBox();
+			updateSpatialIndex();
+		}
 	}
 	else
 	{
@@ -320,7 +419,10 @@ void CAnimatedMeshSceneNode::render()
 					driver->setTransform(video::ETS_WORLD, AbsoluteTransformation * ((SSkinMeshBuffer*)mb)->Transformation);
 
 				driver->setMaterial(material);
-				driver->drawMeshBuffer(mb);
+				if (morphTarget && i < morphTarget->getMeshBufferCount())
+					driver->drawMeshBufferMorphed(mb, morphTarget->getMeshBuffer(i), morphBlend);
+				else
+					driver->drawMeshBuffer(mb);
 			}
 		}
 	}
@@ -451,6 +553,8 @@ bool CAnimatedMeshSceneNode::setFrameLoop(s32 begin, s32 end)
 	else
 		setCurrentFrame((f32)StartFrame);
 
+	updateLoopBoundingBox();
+
 	return true;
 }
 
@@ -526,7 +630,7 @@ IBoneSceneNode* CAnimatedMeshSceneNode::getJointNode(const c8* jointName)
 		return 0;
 	}
 
-	return JointChildSceneNodes[number];
+	return getJointNode((u32)number);
 #endif
 }
 
@@ -555,6 +659,14 @@ IBoneSceneNode* CAnimatedMeshSceneNode::getJointNode(u32 jointID)
 		return 0;
 	}
 
+	// the joint is recovered from the mesh from now on
+	if (JointsQueried.size() < JointChildSceneNodes.size())
+	{
+		for (u32 i=JointsQueried.size(); i<JointChildSceneNodes.size(); ++i)
+			JointsQueried.push_back(0);
+	}
+	JointsQueried[jointID] = 1;
+
 	return JointChildSceneNodes[jointID];
 #endif
 }
@@ -590,6 +702,9 @@ bool CAnimatedMeshSceneNode::removeChild(ISceneNode* child)
 				if (JointChildSceneNodes[i] == child)
 				{
 					JointChildSceneNodes[i] = 0; //remove link to child
+					const s32 sorted = SortedJointNodes.binary_search(child);
+					if (sorted != -1)
+						SortedJointNodes.erase(sorted);
 					break;
 				}
 			}
@@ -658,6 +773,12 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh* mesh)
 			Mesh->drop();
 
 		Mesh = mesh;
+		PreparedMesh = 0;
+		AnimationLayers.clear();
+
+		if (Pose)
+			Pose->drop();
+		Pose = 0;
 
 		// grab the mesh (it's non-null!)
 		Mesh->grab();
@@ -665,6 +786,7 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh* mesh)
 
 	// get materials and bounding box
 	Box = Mesh->getBoundingBox();
+	updateSpatialIndex();
 
 	IMesh* m = Mesh->getMesh(0,0);
 	if (m)
@@ -689,6 +811,23 @@ void CAnimatedMeshSceneNode::setMesh(IAnimatedMesh* mesh)
 		checkJoints();
 	}
 
+	// the keyframes are uploaded once to be blended on the GPU
+	video::IVideoDriver* driver = SceneManager ? SceneManager->getVideoDriver() : 0;
+	if (Mesh->getMeshType() != EAMT_SKINNED && Mesh->getFrameCount() > 1 &&
+		driver && driver->queryFeature(video::EVDF_HARDWARE_MORPHING))
+	{
+		for (u32 f=0; f<Mesh->getFrameCount(); ++f)
+		{
+			IMesh* frame = Mesh->getMesh(f);
+			for (u32 i=0; frame && i<frame->getMeshBufferCount(); ++i)
+			{
+				IMeshBuffer* mb = frame->getMeshBuffer(i);
+				if (mb->getHardwareMappingHint_Vertex() == EHM_NEVER)
+					mb->setHardwareMappingHint(EHM_STATIC, EBT_VERTEX);
+			}
+		}
+	}
+
 	// get start and begin time
 	setAnimationSpeed(Mesh->getAnimationSpeed());	// NOTE: This had been commented out (but not removed!) in r3526. Which caused meshloader-values for speed to be ignored unless users specified explicitly. Missing a test-case where this could go wrong so I put the code back in.
 	setFrameLoop(0, Mesh->getFrameCount()-1);
@@ -744,7 +883,10 @@ void CAnimatedMeshSceneNode::animateJoints(bool CalculateAbsolutePositions)
 		CSkinnedMesh* skinnedMesh=static_cast<CSkinnedMesh*>(Mesh);
 
 		skinnedMesh->transferOnlyJointsHintsToMesh( JointChildSceneNodes );
-		skinnedMesh->animateMesh(frame, 1.0f);
+		if (!AnimationLayers.empty())
+			animateLayers();
+		else
+			skinnedMesh->animateMesh(frame, 1.0f);
 		skinnedMesh->recoverJointsFromMesh( JointChildSceneNodes);
 
 		//-----------------------------------------
@@ -810,6 +952,339 @@ void CAnimatedMeshSceneNode::animateJoints(bool CalculateAbsolutePositions)
 #endif
 }
 
+//! Adds an animation layer, which is blended over the animation of the node.
+u32 CAnimatedMeshSceneNode::addAnimationLayer(s32 begin, s32 end, f32 framesPerSecond,
+		bool loop, f32 weight)
+{
+	const s32 maxFrameCount = Mesh->getFrameCount() - 1;
+	if (end < begin)
+		core::swap(begin, end);
+
+	SAnimationLayer layer;
+	layer.StartFrame = core::s32_clamp(begin, 0, maxFrameCount);
+	layer.EndFrame = core::s32_clamp(end, layer.StartFrame, maxFrameCount);
+	layer.FramesPerSecond = framesPerSecond * 0.001f;
+	layer.CurrentFrameNr = (f32)(framesPerSecond < 0.f ? layer.EndFrame : layer.StartFrame);
+	layer.Looping = loop;
+	layer.Weight = core::clamp(weight, 0.f, 1.f);
+	layer.TargetWeight = layer.Weight;
+	layer.WeightSpeed = 0.f;
+
+	AnimationLayers.push_back(layer);
+	PreparedMesh = 0;
+	updateLoopBoundingBox();
+	return AnimationLayers.size()-1;
+}
+
+
+//! Removes all animation layers
+void CAnimatedMeshSceneNode::removeAnimationLayers()
+{
+	AnimationLayers.clear();
+	PreparedMesh = 0;
+	updateLoopBoundingBox();
+}
+
+
+//! Returns the amount of animation layers
+u32 CAnimatedMeshSceneNode::getAnimationLayerCount() const
+{
+	return AnimationLayers.size();
+}
+
+
+//! Fades the weight of an animation layer.
+void CAnimatedMeshSceneNode::setAnimationLayerWeight(u32 layer, f32 weight, f32 time)
+{
+	if (layer >= AnimationLayers.size())
+		return;
+
+	SAnimationLayer& animationLayer = AnimationLayers[layer];
+	animationLayer.TargetWeight = core::clamp(weight, 0.f, 1.f);
+
+	const f32 timeMs = time < 0.f ? (f32)TransitionTime : time*1000.f;
+	if (timeMs > 0.f && animationLayer.Weight != animationLayer.TargetWeight)
+	{
+		animationLayer.WeightSpeed = (animationLayer.TargetWeight - animationLayer.Weight) / timeMs;
+	}
+	else
+	{
+		animationLayer.Weight = animationLayer.TargetWeight;
+		animationLayer.WeightSpeed = 0.f;
+		PreparedMesh = 0;
+	}
+}
+
+
+//! Returns the current weight of an animation layer
+f32 CAnimatedMeshSceneNode::getAnimationLayerWeight(u32 layer) const
+{
+	return layer < AnimationLayers.size() ? AnimationLayers[layer].Weight : 0.f;
+}
+
+
+//! Sets how much an animation layer moves a joint.
+bool CAnimatedMeshSceneNode::setAnimationLayerJointWeight(u32 layer, const c8* jointName,
+		f32 weight, bool children)
+{
+#ifndef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	return false;
+#else
+	if (layer >= AnimationLayers.size() || !Mesh || Mesh->getMeshType() != EAMT_SKINNED)
+		return false;
+
+	CSkinnedMesh* skinnedMesh = static_cast<CSkinnedMesh*>(Mesh);
+	const s32 number = skinnedMesh->getJointNumber(jointName);
+	if (number == -1)
+		return false;
+
+	const core::array<ISkinnedMesh::SJoint*>& joints = skinnedMesh->getAllJoints();
+	core::array<f32>& jointWeights = AnimationLayers[layer].JointWeights;
+	if (jointWeights.empty())
+	{
+		jointWeights.set_used(joints.size());
+		for (u32 i=0; i<jointWeights.size(); ++i)
+			jointWeights[i] = 1.f;
+	}
+
+	weight = core::clamp(weight, 0.f, 1.f);
+
+	core::array<ISkinnedMesh::SJoint*> stack;
+	stack.push_back(joints[number]);
+	while (!stack.empty())
+	{
+		ISkinnedMesh::SJoint* joint = stack.getLast();
+		stack.erase(stack.size()-1);
+
+		const s32 n = joints.linear_search(joint);
+		if (n != -1)
+			jointWeights[n] = weight;
+
+		if (children)
+		{
+			for (u32 i=0; i<joint->Children.size(); ++i)
+				stack.push_back(joint->Children[i]);
+		}
+	}
+
+	PreparedMesh = 0;
+	return true;
+#endif
+}
+
+
+//! Crossfades to an animation layer.
+void CAnimatedMeshSceneNode::crossfadeAnimationLayer(s32 layer, f32 time)
+{
+	for (u32 i=0; i<AnimationLayers.size(); ++i)
+		setAnimationLayerWeight(i, (s32)i == layer ? 1.f : 0.f, time);
+}
+
+
+//! Plays the animation layers and fades their weights
+void CAnimatedMeshSceneNode::buildLayerFrames(f32 timeMs)
+{
+	for (u32 i=0; i<AnimationLayers.size(); ++i)
+	{
+		SAnimationLayer& layer = AnimationLayers[i];
+
+		if (layer.StartFrame == layer.EndFrame)
+		{
+			layer.CurrentFrameNr = (f32)layer.StartFrame;
+		}
+		else
+		{
+			layer.CurrentFrameNr += timeMs * layer.FramesPerSecond;
+
+			if (!layer.Looping)
+			{
+				layer.CurrentFrameNr = core::clamp(layer.CurrentFrameNr, (f32)layer.StartFrame, (f32)layer.EndFrame);
+			}
+			else if (layer.FramesPerSecond > 0.f) //forwards...
+			{
+				if (layer.CurrentFrameNr > layer.EndFrame)
+					layer.CurrentFrameNr = layer.StartFrame + fmodf(layer.CurrentFrameNr - layer.StartFrame, (f32)(layer.EndFrame-layer.StartFrame));
+			}
+			else //backwards...
+			{
+				if (layer.CurrentFrameNr < layer.StartFrame)
+					layer.CurrentFrameNr = layer.EndFrame - fmodf(layer.EndFrame - layer.CurrentFrameNr, (f32)(layer.EndFrame-layer.StartFrame));
+			}
+		}
+
+		if (layer.WeightSpeed != 0.f)
+		{
+			layer.Weight += timeMs * layer.WeightSpeed;
+			if ((layer.WeightSpeed > 0.f && layer.Weight >= layer.TargetWeight) ||
+				(layer.WeightSpeed < 0.f && layer.Weight <= layer.TargetWeight))
+			{
+				layer.Weight = layer.TargetWeight;
+				layer.WeightSpeed = 0.f;
+			}
+		}
+	}
+}
+
+
+//! Animates the skinned mesh to the current frame with the layers blended over it
+void CAnimatedMeshSceneNode::animateLayers()
+{
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	// all poses are blended before the joint matrices are built once
+	CSkinnedMesh* skinnedMesh = static_cast<CSkinnedMesh*>(Mesh);
+	skinnedMesh->beginBlend(getFrameNr());
+
+	for (u32 i=0; i<AnimationLayers.size(); ++i)
+	{
+		const SAnimationLayer& layer = AnimationLayers[i];
+		skinnedMesh->blendPose(layer.CurrentFrameNr, layer.Weight,
+				layer.JointWeights.empty() ? 0 : &layer.JointWeights);
+	}
+
+	skinnedMesh->endBlend();
+#endif
+}
+
+
+//! Sets the animation level of detail.
+void CAnimatedMeshSceneNode::setAnimationLOD(f32 screenSize, u32 updateInterval)
+{
+	LODScreenSize = screenSize;
+	LODUpdateInterval = updateInterval;
+}
+
+
+//! Sets whether the bounding box of the node encloses its whole frame loop.
+void CAnimatedMeshSceneNode::setLoopBoundingBox(bool on)
+{
+	LoopBoundingBox = on;
+	updateLoopBoundingBox();
+}
+
+
+//! Sets the box to enclose the frame loop and the layers, if LoopBoundingBox is on
+void CAnimatedMeshSceneNode::updateLoopBoundingBox()
+{
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	if (!LoopBoundingBox || !Mesh || Mesh->getMeshType() != EAMT_SKINNED)
+		return;
+
+	CSkinnedMesh* skinnedMesh = static_cast<CSkinnedMesh*>(Mesh);
+	Box = skinnedMesh->getLoopBoundingBox(StartFrame, EndFrame);
+	for (u32 i=0; i<AnimationLayers.size(); ++i)
+		Box.addInternalBox(skinnedMesh->getLoopBoundingBox(AnimationLayers[i].StartFrame, AnimationLayers[i].EndFrame));
+
+	updateSpatialIndex();
+#endif
+}
+
+
+//! Whether the node is small enough on the screen to reduce its animation detail
+bool CAnimatedMeshSceneNode::isAnimationLODReduced() const
+{
+	if (LODScreenSize <= 0.f)
+		return false;
+
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (!camera)
+		return false;
+
+	const core::aabbox3df box = getTransformedBoundingBox();
+	const f32 radius = box.getExtent().getLength() * 0.5f;
+	const f32 distance = box.getCenter().getDistanceFrom(camera->getAbsolutePosition());
+	if (distance <= radius)
+		return false;
+
+	// height of the bounding sphere relative to the screen height
+	const f32 screenSize = radius / (distance * tanf(camera->getFOV() * 0.5f));
+	return screenSize < LODScreenSize;
+}
+
+
+//! Updates the absolute position of a node and all of its children
+static void updateAbsolutePositionOfTree(ISceneNode* node)
+{
+	node->updateAbsolutePosition();
+
+	for (ISceneNode* child : node->getChildren())
+		updateAbsolutePositionOfTree(child);
+}
+
+
+//! Marks the joints which were queried or have children attached, and their parents
+bool CAnimatedMeshSceneNode::gatherNeededJoints()
+{
+	const u32 count = JointChildSceneNodes.size();
+	JointsNeeded.set_used(count);
+	for (u32 i=0; i<count; ++i)
+		JointsNeeded[i] = 0;
+
+	bool any = false;
+	for (u32 i=0; i<count; ++i)
+	{
+		IBoneSceneNode* bone = JointChildSceneNodes[i];
+		if (!bone || JointsNeeded[i])
+			continue;
+
+		bool needed = i < JointsQueried.size() && JointsQueried[i];
+		for (ISceneNode* child : bone->getChildren())
+		{
+			if (!isJointNode(child))
+			{
+				needed = true;
+				break;
+			}
+		}
+		if (!needed)
+			continue;
+
+		// the absolute position depends on all parents
+		for (ISceneNode* node = bone; node && isJointNode(node); node = node->getParent())
+		{
+			const u32 number = static_cast<IBoneSceneNode*>(node)->getBoneIndex();
+			if (JointsNeeded[number])
+				break;
+			JointsNeeded[number] = 1;
+		}
+		any = true;
+	}
+
+	return any;
+}
+
+
+//! Whether the node is one of JointChildSceneNodes
+bool CAnimatedMeshSceneNode::isJointNode(ISceneNode* node) const
+{
+	return SortedJointNodes.binary_search(node) != -1;
+}
+
+
+//! Recovers the joints marked by gatherNeededJoints()
+void CAnimatedMeshSceneNode::recoverNeededJoints(CSkinnedMesh* skinnedMesh, bool propagate)
+{
+#ifdef _IRR_COMPILE_WITH_SKINNED_MESH_SUPPORT_
+	skinnedMesh->recoverJointsFromMesh(JointChildSceneNodes, JointsNeeded);
+
+	if (!propagate)
+		return;
+
+	// the joints themselves are up to date, only the attached nodes are left
+	for (u32 i=0; i<JointsNeeded.size(); ++i)
+	{
+		if (!JointsNeeded[i])
+			continue;
+
+		for (ISceneNode* child : JointChildSceneNodes[i]->getChildren())
+		{
+			if (!isJointNode(child))
+				updateAbsolutePositionOfTree(child);
+		}
+	}
+#endif
+}
+
+
 /*!
 */
 void CAnimatedMeshSceneNode::checkJoints()
@@ -826,11 +1301,17 @@ void CAnimatedMeshSceneNode::checkJoints()
 		for (u32 i=0; i<JointChildSceneNodes.size(); ++i)
 			removeChild(JointChildSceneNodes[i]);
 		JointChildSceneNodes.clear();
+		JointsQueried.clear();
 
 		//Create joints for SkinnedMesh
 		((CSkinnedMesh*)Mesh)->addJoints(JointChildSceneNodes, this, SceneManager);
 		((CSkinnedMesh*)Mesh)->recoverJointsFromMesh(JointChildSceneNodes);
 
+		SortedJointNodes.set_used(JointChildSceneNodes.size());
+		for (u32 i=0; i<JointChildSceneNodes.size(); ++i)
+			SortedJointNodes[i] = JointChildSceneNodes[i];
+		SortedJointNodes.sort();
+
 		JointsUsed=true;
 		JointMode=EJUOR_READ;
 	}
@@ -903,8 +1384,16 @@ ISceneNode* CAnimatedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager*
 		newNode->LoopCallBack->grab();
 	newNode->PassCount = PassCount;
 	newNode->JointChildSceneNodes = JointChildSceneNodes;
+	newNode->JointsQueried = JointsQueried;
+	newNode->SortedJointNodes = SortedJointNodes;
 	newNode->PretransitingSave = PretransitingSave;
+	newNode->AnimationLayers = AnimationLayers;
+	newNode->LODScreenSize = LODScreenSize;
+	newNode->LODUpdateInterval = LODUpdateInterval;
+	newNode->LODElapsedMs = LODElapsedMs;
+	newNode->AnimatedFrameNr = AnimatedFrameNr;
 	newNode->RenderFromIdentity = RenderFromIdentity;
+	newNode->LoopBoundingBox = LoopBoundingBox;
 
 	return newNode;
 }
@@ -7,6 +7,7 @@
 
 #include "IAnimatedMeshSceneNode.h"
 #include "IAnimatedMesh.h"
+#include "CSceneNodePool.h"
 
 #include "matrix4.h"
 
@@ -16,11 +17,18 @@ namespace irr
 namespace scene
 {
 	class IDummyTransformationSceneNode;
+	class CJobSystem;
+	class CSkinnedMesh;
+	struct SMesh;
 
-	class CAnimatedMeshSceneNode : public IAnimatedMeshSceneNode
+	class CAnimatedMeshSceneNode : public IAnimatedMeshSceneNode, public CSceneNodePoolAllocated<CAnimatedMeshSceneNode>
 	{
 	public:
 
+		//! the pool takes precedence over the operators of ISceneNode
+		using CSceneNodePoolAllocated<CAnimatedMeshSceneNode>::operator new;
+		using CSceneNodePoolAllocated<CAnimatedMeshSceneNode>::operator delete;
+
 		//! constructor
 		CAnimatedMeshSceneNode(IAnimatedMesh* mesh, ISceneNode* parent, ISceneManager* mgr,	s32 id,
 			const core::vector3df& position = core::vector3df(0,0,0),
@@ -42,6 +50,18 @@ namespace scene
 		//! renders the node.
 		void render() override;
 
+		//! Animates and skins the mesh for the current frame ahead of render()
+		/** Used by the parallel scene update, which calls it from a worker
+		thread between OnAnimate() and rendering. Only valid if no other
+		visible node uses the same mesh, as the mesh itself is changed. */
+		void prepareMeshForCurrentFrame();
+
+		//! Skins the shared copy of the mesh for the current frame ahead of render()
+		/** Used by the parallel scene update for nodes sharing their mesh,
+		from the thread updating the scene. Large meshes are skinned on
+		jobs. Does nothing if the joints are controlled by the user. */
+		void preparePoseForCurrentFrame(CJobSystem* jobs);
+
 		//! returns the axis aligned bounding box of this node
 		const core::aabbox3d<f32>& getBoundingBox() const override;
 
@@ -131,6 +151,35 @@ namespace scene
 		//! updates the joint positions of this mesh
 		void animateJoints(bool CalculateAbsolutePositions=true) override;
 
+		//! Adds an animation layer, which is blended over the animation of the node.
+		u32 addAnimationLayer(s32 begin, s32 end, f32 framesPerSecond,
+				bool loop=true, f32 weight=1.f) override;
+
+		//! Removes all animation layers
+		void removeAnimationLayers() override;
+
+		//! Returns the amount of animation layers
+		u32 getAnimationLayerCount() const override;
+
+		//! Fades the weight of an animation layer.
+		void setAnimationLayerWeight(u32 layer, f32 weight, f32 time=0.f) override;
+
+		//! Returns the current weight of an animation layer
+		f32 getAnimationLayerWeight(u32 layer) const override;
+
+		//! Sets how much an animation layer moves a joint.
+		bool setAnimationLayerJointWeight(u32 layer, const c8* jointName,
+				f32 weight, bool children=true) override;
+
+		//! Crossfades to an animation layer.
+		void crossfadeAnimationLayer(s32 layer, f32 time=-1.f) override;
+
+		//! Sets the animation level of detail.
+		void setAnimationLOD(f32 screenSize, u32 updateInterval=100) override;
+
+		//! Sets whether the bounding box of the node encloses its whole frame loop.
+		void setLoopBoundingBox(bool on) override;
+
 		//! render mesh ignoring its transformation. Used with ragdolls. (culling is unaffected)
 		void setRenderFromIdentity( bool On ) override;
 
@@ -145,8 +194,27 @@ namespace scene
 		//! Get a static mesh for the current frame of this animated mesh
 		IMesh* getMeshForCurrentFrame();
 
-		void buildFrameNr(u32 timeMs);
+		//! Next keyframe of a non-skinned mesh, 0 if the current frame isn't between two keyframes
+		/** \param blend Receives the weight of the returned keyframe */
+		IMesh* getMorphTargetMesh(f32& blend);
+
+		void buildFrameNr(f32 timeMs);
+		void buildLayerFrames(f32 timeMs);
+		//! Animates the skinned mesh to the current frame with the layers blended over it
+		void animateLayers();
+		//! Whether the node is small enough on the screen to reduce its animation detail
+		bool isAnimationLODReduced() const;
+		//! Sets the box to enclose the frame loop and the layers, if LoopBoundingBox is on
+		void updateLoopBoundingBox();
 		void checkJoints();
+		//! Marks the joints which were queried or have children attached, and their parents
+		/** \return True if any joint has to be recovered. */
+		bool gatherNeededJoints();
+		//! Whether the node is one of JointChildSceneNodes
+		bool isJointNode(ISceneNode* node) const;
+		//! Recovers the joints marked by gatherNeededJoints()
+		/** \param propagate Whether to update the absolute positions of the attached nodes. */
+		void recoverNeededJoints(CSkinnedMesh* skinnedMesh, bool propagate);
 		void beginTransition();
 
 		core::array<video::SMaterial> Materials;
@@ -159,6 +227,7 @@ namespace scene
 		f32 CurrentFrameNr;
 
 		u32 LastTimeMs;
+		f32 LastTimeFraction; //sub-millisecond part of LastTimeMs, see ISceneManager::getAnimationTimeFraction
 		u32 TransitionTime; //Transition time in millisecs
 		f32 Transiting; //is mesh transiting (plus cache of TransitionTime)
 		f32 TransitingBlend; //0-1, calculated on buildFrameNr
@@ -170,12 +239,50 @@ namespace scene
 		bool Looping;
 		bool ReadOnlyMaterials;
 		bool RenderFromIdentity;
+		bool LoopBoundingBox;
 
 		IAnimationEndCallBack* LoopCallBack;
 		s32 PassCount;
 
+		//! mesh returned by prepareMeshForCurrentFrame(), until the next OnAnimate()
+		IMesh* PreparedMesh;
+
+		//! skinned copy of a CSkinnedMesh shown by this node, shared with other nodes at the same frame
+		SMesh* Pose;
+
 		core::array<IBoneSceneNode* > JointChildSceneNodes;
+		//! joints returned by getJointNode(), by joint number
+		core::array<u8> JointsQueried;
+		//! joints recovered from the mesh in EJUOR_READ mode, by joint number
+		core::array<u8> JointsNeeded;
+		//! JointChildSceneNodes sorted by address, to tell joints from attached nodes
+		core::array<ISceneNode*> SortedJointNodes;
 		core::array<core::matrix4> PretransitingSave;
+
+		struct SAnimationLayer
+		{
+			s32 StartFrame;
+			s32 EndFrame;
+			f32 FramesPerSecond; //per millisecond, like the one of the node
+			f32 CurrentFrameNr;
+			bool Looping;
+
+			f32 Weight;
+			f32 TargetWeight;
+			f32 WeightSpeed; //per millisecond, 0 while not fading
+
+			//! weight of each joint by joint number, empty while all are 1
+			core::array<f32> JointWeights;
+		};
+
+		core::array<SAnimationLayer> AnimationLayers;
+
+		f32 LODScreenSize;
+		u32 LODUpdateInterval;
+		//! time since the pose was updated last
+		u32 LODElapsedMs;
+		//! frame of the pose, lags behind CurrentFrameNr while the detail is reduced
+		f32 AnimatedFrameNr;
 	};
 
 } // end namespace scene
@@ -0,0 +1,258 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CAnimationClip.h"
+#include "irrMath.h"
+
+namespace irr
+{
+namespace scene
+{
+
+CAnimationClip::CAnimationClip(const core::array<core::stringc>& jointNames, f32 endFrame, f32 samplesPerFrame)
+	: JointNames(jointNames), Signature(getSkeletonSignature(jointNames)),
+	EndFrame(core::max_(endFrame, 0.f)), SamplesPerFrame(core::max_(samplesPerFrame, 0.001f))
+{
+	#ifdef _DEBUG
+	setDebugName("CAnimationClip");
+	#endif
+
+	// the last sample is taken at the end frame itself
+	SampleCount = (u32)core::ceil32(EndFrame * SamplesPerFrame) + 1;
+
+	for (u32 i=0; i<JointNames.size(); ++i)
+		JointIndex.emplace(core::atom(JointNames[i]), i);
+
+	STrack track;
+	track.FirstRotation = 0;
+	track.RotationCount = NotAnimated;
+	Tracks.set_used(JointNames.size());
+	for (u32 i=0; i<Tracks.size(); ++i)
+		Tracks[i] = track;
+}
+
+
+u32 CAnimationClip::getJointCount() const
+{
+	return JointNames.size();
+}
+
+
+const c8* CAnimationClip::getJointName(u32 number) const
+{
+	return number < JointNames.size() ? JointNames[number].c_str() : 0;
+}
+
+
+s32 CAnimationClip::getJointNumber(const c8* name) const
+{
+	const core::atom key = core::atom::find(name);
+	if (key.empty())
+		return -1;
+
+	const auto it = JointIndex.find(key);
+	return it != JointIndex.end() ? (s32)it->second : -1;
+}
+
+
+u64 CAnimationClip::getSkeletonSignature() const
+{
+	return Signature;
+}
+
+
+f32 CAnimationClip::getEndFrame() const
+{
+	return EndFrame;
+}
+
+
+f32 CAnimationClip::getSamplesPerFrame() const
+{
+	return SamplesPerFrame;
+}
+
+
+u32 CAnimationClip::getKeyMemorySize() const
+{
+	return Tracks.size() * sizeof(STrack) +
+		(Positions.size() + Scales.size() + Rotations.size()) * sizeof(u16);
+}
+
+
+u64 CAnimationClip::getSkeletonSignature(const core::array<core::stringc>& jointNames)
+{
+	// FNV-1a over the names, each ended by its terminating zero
+	u64 hash = 14695981039346656037ull;
+	for (u32 i=0; i<jointNames.size(); ++i)
+	{
+		const c8* name = jointNames[i].c_str();
+		for (u32 c=0; c<=jointNames[i].size(); ++c)
+			hash = (hash ^ (u8)name[c]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+
+void CAnimationClip::setTrack(u32 joint, const core::vector3df* positions,
+	const core::quaternion* rotations, const core::vector3df* scales)
+{
+	if (joint >= Tracks.size())
+		return;
+
+	STrack& track = Tracks[joint];
+	if (positions)
+		quantize(track.Position, Positions, positions);
+	if (scales)
+		quantize(track.Scale, Scales, scales);
+
+	if (!rotations)
+		return;
+
+	u32 count = 1;
+	for (u32 i=1; i<SampleCount; ++i)
+	{
+		if (!rotations[i].equals(rotations[0]))
+		{
+			count = SampleCount;
+			break;
+		}
+	}
+
+	track.FirstRotation = Rotations.size() / 4;
+	track.RotationCount = count;
+	core::quaternion previous = rotations[0];
+	for (u32 i=0; i<count; ++i)
+	{
+		// neighbouring keys on the same hemisphere, so the sign doesn't flip between them
+		core::quaternion q = rotations[i];
+		q.normalize();
+		if (q.dotProduct(previous) < 0.f)
+			q = core::quaternion(-q.X, -q.Y, -q.Z, -q.W);
+		previous = q;
+
+		Rotations.push_back((s16)core::round32(q.X * 32767.f));
+		Rotations.push_back((s16)core::round32(q.Y * 32767.f));
+		Rotations.push_back((s16)core::round32(q.Z * 32767.f));
+		Rotations.push_back((s16)core::round32(q.W * 32767.f));
+	}
+}
+
+
+void CAnimationClip::quantize(SVectorChannel& channel, core::array<u16>& keys, const core::vector3df* values)
+{
+	core::vector3df minEdge = values[0];
+	core::vector3df maxEdge = values[0];
+	for (u32 i=1; i<SampleCount; ++i)
+	{
+		minEdge.X = core::min_(minEdge.X, values[i].X);
+		minEdge.Y = core::min_(minEdge.Y, values[i].Y);
+		minEdge.Z = core::min_(minEdge.Z, values[i].Z);
+		maxEdge.X = core::max_(maxEdge.X, values[i].X);
+		maxEdge.Y = core::max_(maxEdge.Y, values[i].Y);
+		maxEdge.Z = core::max_(maxEdge.Z, values[i].Z);
+	}
+
+	channel.First = keys.size() / 3;
+	channel.Min = minEdge;
+	channel.Step = (maxEdge - minEdge) / 65535.f;
+
+	// a channel which doesn't change keeps its value in Min
+	if (minEdge.equals(maxEdge))
+	{
+		channel.Count = 1;
+		channel.Step.set(0.f, 0.f, 0.f);
+		keys.push_back(0);
+		keys.push_back(0);
+		keys.push_back(0);
+		return;
+	}
+
+	channel.Count = SampleCount;
+	for (u32 i=0; i<SampleCount; ++i)
+	{
+		const core::vector3df offset = values[i] - minEdge;
+		keys.push_back(channel.Step.X > 0.f ? (u16)core::round32(offset.X / channel.Step.X) : 0);
+		keys.push_back(channel.Step.Y > 0.f ? (u16)core::round32(offset.Y / channel.Step.Y) : 0);
+		keys.push_back(channel.Step.Z > 0.f ? (u16)core::round32(offset.Z / channel.Step.Z) : 0);
+	}
+}
+
+
+bool CAnimationClip::isAnimated(u32 joint) const
+{
+	return joint < Tracks.size() &&
+		(Tracks[joint].Position.Count != NotAnimated || Tracks[joint].RotationCount != NotAnimated);
+}
+
+
+bool CAnimationClip::isScaled(u32 joint) const
+{
+	return joint < Tracks.size() && Tracks[joint].Scale.Count != NotAnimated;
+}
+
+
+core::vector3df CAnimationClip::decode(const SVectorChannel& channel, const core::array<u16>& keys, u32 key)
+{
+	const u16* k = &keys[(channel.First + key) * 3];
+	return core::vector3df(channel.Min.X + channel.Step.X * k[0],
+		channel.Min.Y + channel.Step.Y * k[1],
+		channel.Min.Z + channel.Step.Z * k[2]);
+}
+
+
+core::quaternion CAnimationClip::decodeRotation(const STrack& track, u32 key) const
+{
+	const s16* k = &Rotations[(track.FirstRotation + key) * 4];
+	core::quaternion q(k[0] / 32767.f, k[1] / 32767.f, k[2] / 32767.f, k[3] / 32767.f);
+	return q.normalize();
+}
+
+
+void CAnimationClip::sample(u32 joint, f32 frame, bool interpolate,
+	core::vector3df& position, core::quaternion& rotation, core::vector3df& scale) const
+{
+	if (joint >= Tracks.size())
+		return;
+
+	const f32 at = core::clamp(frame * SamplesPerFrame, 0.f, (f32)(SampleCount - 1));
+	u32 key = (u32)at;
+	f32 t = at - key;
+	if (!interpolate && t > 0.f)
+	{
+		++key;
+		t = 0.f;
+	}
+	const u32 next = t > 0.f ? key + 1 : key;
+
+	const STrack& track = Tracks[joint];
+
+	if (track.Position.Count == 1)
+		position = track.Position.Min;
+	else if (track.Position.Count != NotAnimated)
+	{
+		const core::vector3df a = decode(track.Position, Positions, key);
+		position = a + (decode(track.Position, Positions, next) - a) * t;
+	}
+
+	if (track.Scale.Count == 1)
+		scale = track.Scale.Min;
+	else if (track.Scale.Count != NotAnimated)
+	{
+		const core::vector3df a = decode(track.Scale, Scales, key);
+		scale = a + (decode(track.Scale, Scales, next) - a) * t;
+	}
+
+	if (track.RotationCount == 1)
+		rotation = decodeRotation(track, 0);
+	else if (track.RotationCount != NotAnimated)
+	{
+		if (t > 0.f)
+			rotation.slerp(decodeRotation(track, key), decodeRotation(track, next), t);
+		else
+			rotation = decodeRotation(track, key);
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,122 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_ANIMATION_CLIP_H_INCLUDED__
+#define __C_ANIMATION_CLIP_H_INCLUDED__
+
+#include "IAnimationClip.h"
+#include "irrArray.h"
+#include "irrString.h"
+#include "irrAtom.h"
+#include "vector3d.h"
+#include "quaternion.h"
+#include <unordered_map>
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Resampled and quantized joint animation, see IAnimationClip
+	class CAnimationClip : public IAnimationClip
+	{
+	public:
+
+		//! Key count of a channel which isn't animated
+		static const u32 NotAnimated = 0;
+
+		//! Creates an empty clip
+		/** \param jointNames Names of the joints, in the order of their tracks
+		\param endFrame Last frame of the animation
+		\param samplesPerFrame Samples taken per frame */
+		CAnimationClip(const core::array<core::stringc>& jointNames, f32 endFrame, f32 samplesPerFrame);
+
+		u32 getJointCount() const override;
+
+		const c8* getJointName(u32 number) const override;
+
+		s32 getJointNumber(const c8* name) const override;
+
+		u64 getSkeletonSignature() const override;
+
+		f32 getEndFrame() const override;
+
+		f32 getSamplesPerFrame() const override;
+
+		u32 getKeyMemorySize() const override;
+
+		//! Number of samples of animated channels
+		u32 getSampleCount() const { return SampleCount; }
+
+		//! Stores the samples of the joint, getSampleCount() of each animated channel
+		/** Channels which don't change get a single key. Pass 0 for channels
+		which aren't animated. */
+		void setTrack(u32 joint, const core::vector3df* positions,
+			const core::quaternion* rotations, const core::vector3df* scales);
+
+		//! True if the joint has animated positions or rotations
+		bool isAnimated(u32 joint) const;
+
+		//! True if the joint has animated scales
+		bool isScaled(u32 joint) const;
+
+		//! Samples the channels of a joint at a frame
+		/** Channels which aren't animated are left unchanged.
+		\param interpolate False to take the sample at or after the frame,
+		like the keys of E_INTERPOLATION_MODE EIM_CONSTANT. */
+		void sample(u32 joint, f32 frame, bool interpolate,
+			core::vector3df& position, core::quaternion& rotation, core::vector3df& scale) const;
+
+		//! Signature of a skeleton by the names of its joints in order
+		static u64 getSkeletonSignature(const core::array<core::stringc>& jointNames);
+
+	private:
+
+		//! Quantized vectors of a channel, Min + Step * key
+		struct SVectorChannel
+		{
+			SVectorChannel() : First(0), Count(NotAnimated) {}
+
+			//! Index of the first key in the key array, 3 components each
+			u32 First;
+			//! NotAnimated, 1 for channels which don't change or the sample count
+			u32 Count;
+			core::vector3df Min;
+			core::vector3df Step;
+		};
+
+		struct STrack
+		{
+			SVectorChannel Position;
+			SVectorChannel Scale;
+			//! Index of the first rotation in Rotations, 4 components each
+			u32 FirstRotation;
+			u32 RotationCount;
+		};
+
+		void quantize(SVectorChannel& channel, core::array<u16>& keys, const core::vector3df* values);
+
+		static core::vector3df decode(const SVectorChannel& channel, const core::array<u16>& keys, u32 key);
+
+		core::quaternion decodeRotation(const STrack& track, u32 key) const;
+
+		core::array<core::stringc> JointNames;
+		//! Joint number by interned name, the first joint of a name wins
+		std::unordered_map<core::atom, u32> JointIndex;
+		u64 Signature;
+
+		f32 EndFrame;
+		f32 SamplesPerFrame;
+		u32 SampleCount;
+
+		core::array<STrack> Tracks;
+		core::array<u16> Positions;
+		core::array<u16> Scales;
+		//! Unit quaternions with components scaled to 32767
+		core::array<s16> Rotations;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
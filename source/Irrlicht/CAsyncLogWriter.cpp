@@ -0,0 +1,208 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CAsyncLogWriter.h"
+#include "os.h"
+#include <chrono>
+
+namespace irr
+{
+
+CAsyncLogWriter::CAsyncLogWriter(u32 capacity) :
+	Mask(0), Head(0), Tail(0), Written(0), Running(true), Sleeping(false),
+	LastLevel(ELL_NONE), Repeats(0)
+{
+	u32 size = 16;
+	while (size < capacity)
+		size <<= 1;
+	Mask = size - 1;
+
+	Slots.reset(new SSlot[size]);
+	for (u32 i = 0; i < size; ++i)
+		Slots[i].Sequence.store(i, std::memory_order_relaxed);
+
+	for (u32 i = 0; i < RATE_SLOTS; ++i)
+	{
+		Rates[i].Hash = 0;
+		Rates[i].Second = 0;
+		Rates[i].Printed = 0;
+		Rates[i].Suppressed = 0;
+	}
+
+	Thread = std::thread(&CAsyncLogWriter::writerLoop, this);
+}
+
+CAsyncLogWriter::~CAsyncLogWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(WakeMutex);
+		Running = false;
+	}
+	Wake.notify_one();
+	Thread.join();
+}
+
+bool CAsyncLogWriter::push(const c8* text, const c8* hint, ELOG_LEVEL ll)
+{
+	u32 pos = Head.load(std::memory_order_relaxed);
+	SSlot* slot;
+	for (;;)
+	{
+		slot = &Slots[pos & Mask];
+		const s32 diff = (s32)(slot->Sequence.load(std::memory_order_acquire) - pos);
+		if (diff == 0)
+		{
+			if (Head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+			return false;
+		else
+			pos = Head.load(std::memory_order_relaxed);
+	}
+
+	slot->Level = ll;
+	slot->Text = text;
+	if (hint)
+		slot->Hint = hint;
+	slot->Sequence.store(pos + 1, std::memory_order_release);
+
+	if (Sleeping.exchange(false))
+	{
+		std::lock_guard<std::mutex> lock(WakeMutex);
+		Wake.notify_one();
+	}
+	return true;
+}
+
+void CAsyncLogWriter::flush()
+{
+	const u32 target = Head.load();
+	std::unique_lock<std::mutex> lock(WakeMutex);
+	Wake.notify_one();
+	Drained.wait(lock, [&] { return (s32)(Written.load() - target) >= 0; });
+}
+
+bool CAsyncLogWriter::pop(ELOG_LEVEL& ll, core::stringc& text)
+{
+	SSlot& slot = Slots[Tail & Mask];
+	if (slot.Sequence.load(std::memory_order_acquire) != Tail + 1)
+		return false;
+
+	ll = slot.Level;
+	text = std::move(slot.Text);
+	slot.Text = "";
+	if (slot.Hint.size())
+	{
+		text += ": ";
+		text += slot.Hint;
+		slot.Hint = "";
+	}
+	slot.Sequence.store(Tail + Mask + 1, std::memory_order_release);
+	++Tail;
+	return true;
+}
+
+void CAsyncLogWriter::writerLoop()
+{
+	ELOG_LEVEL ll;
+	core::stringc text;
+	for (;;)
+	{
+		while (pop(ll, text))
+		{
+			write(ll, text);
+			Written.fetch_add(1);
+		}
+		writeRepeats();
+
+		std::unique_lock<std::mutex> lock(WakeMutex);
+		Drained.notify_all();
+		if (!Running)
+		{
+			// producers are gone, but the last ones may have been filling slots
+			if (Written.load() == Head.load())
+				break;
+			continue;
+		}
+		Sleeping = true;
+		// the timeout covers a producer which saw Sleeping just before it was set
+		Wake.wait_for(lock, std::chrono::milliseconds(50));
+		Sleeping = false;
+	}
+
+	for (u32 i = 0; i < RATE_SLOTS; ++i)
+		writeSuppressed(Rates[i]);
+}
+
+void CAsyncLogWriter::write(ELOG_LEVEL ll, const core::stringc& text)
+{
+	if (ll == LastLevel && text == LastText)
+	{
+		++Repeats;
+		return;
+	}
+	writeRepeats();
+	LastLevel = ll;
+	LastText = text;
+	print(ll, text);
+}
+
+void CAsyncLogWriter::print(ELOG_LEVEL ll, const core::stringc& text)
+{
+	u32 hash = 2166136261u;
+	for (u32 i = 0; i < text.size(); ++i)
+		hash = (hash ^ (u8)text[i]) * 16777619u;
+
+	const u32 second = os::Timer::getRealTime() / 1000;
+	SRate& rate = Rates[hash & (RATE_SLOTS - 1)];
+	if (rate.Hash != hash || rate.Second != second)
+	{
+		writeSuppressed(rate);
+		rate.Hash = hash;
+		rate.Second = second;
+		rate.Printed = 0;
+	}
+
+	if (rate.Printed == RATE_LIMIT)
+	{
+		if (rate.Suppressed++ == 0)
+			rate.Text = text;
+		return;
+	}
+	++rate.Printed;
+	os::Printer::print(text.c_str(), ll);
+}
+
+void CAsyncLogWriter::writeRepeats()
+{
+	if (!Repeats)
+		return;
+
+	if (Repeats == 1)
+		print(LastLevel, LastText);
+	else
+	{
+		c8 tmp[64];
+		snprintf_irr(tmp, sizeof(tmp), "Last message repeated %u times", Repeats);
+		os::Printer::print(tmp, LastLevel);
+	}
+	Repeats = 0;
+	// a later copy of the message is printed again
+	LastLevel = ELL_NONE;
+}
+
+void CAsyncLogWriter::writeSuppressed(SRate& rate)
+{
+	if (!rate.Suppressed)
+		return;
+
+	c8 tmp[64];
+	snprintf_irr(tmp, sizeof(tmp), "Suppressed %u more messages like: ", rate.Suppressed);
+	core::stringc s = tmp;
+	s += rate.Text;
+	os::Printer::print(s.c_str(), ELL_WARNING);
+	rate.Suppressed = 0;
+}
+
+} // end namespace irr
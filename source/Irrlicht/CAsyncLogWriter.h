@@ -0,0 +1,112 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_ASYNC_LOG_WRITER_H_INCLUDED__
+#define __C_ASYNC_LOG_WRITER_H_INCLUDED__
+
+#include "ILogger.h"
+#include "irrString.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace irr
+{
+
+//! Writes log messages to os::Printer on a background thread.
+/** Messages are queued in a bounded ring buffer which any thread can push to
+without taking a lock, a single thread drains it. Consecutive duplicates are
+collapsed into a repeat count and a message printed too often within a second
+is suppressed until the next second, so a flood of errors from a bad frame
+neither blocks the caller on stdout nor buries the rest of the log. */
+class CAsyncLogWriter
+{
+public:
+	//! Starts the writer thread
+	/** \param capacity Number of queued messages, rounded up to a power of two. */
+	explicit CAsyncLogWriter(u32 capacity = 1024);
+
+	//! Writes all queued messages and stops the thread
+	~CAsyncLogWriter();
+
+	//! Queues a message, the string ": " is put between text and hint
+	/** Joining text and hint is left to the writer thread.
+	\return False if the queue is full, the message is not written then. */
+	bool push(const c8* text, const c8* hint, ELOG_LEVEL ll);
+
+	//! Waits until all messages queued so far are written
+	void flush();
+
+private:
+	struct SSlot
+	{
+		//! Position the slot is free for, or the position plus one when filled
+		std::atomic<u32> Sequence;
+		ELOG_LEVEL Level;
+		core::stringc Text;
+		core::stringc Hint;
+	};
+
+	//! Messages printed for one text hash in the current second
+	struct SRate
+	{
+		u32 Hash;
+		u32 Second;
+		u32 Printed;
+		u32 Suppressed;
+		core::stringc Text;
+	};
+
+	enum
+	{
+		RATE_SLOTS = 64,
+		//! Messages with the same text printed per second before suppressing
+		RATE_LIMIT = 20
+	};
+
+	void writerLoop();
+
+	//! Takes the next message off the queue, only called by the writer thread
+	bool pop(ELOG_LEVEL& ll, core::stringc& text);
+
+	//! Coalesces a message with the previous one or prints it
+	void write(ELOG_LEVEL ll, const core::stringc& text);
+
+	//! Prints a message unless its rate limit is exceeded
+	void print(ELOG_LEVEL ll, const core::stringc& text);
+
+	//! Prints the repeat count of the last message if there is one
+	void writeRepeats();
+
+	//! Prints how many messages were suppressed by the rate limit
+	void writeSuppressed(SRate& rate);
+
+	std::unique_ptr<SSlot[]> Slots;
+	u32 Mask;
+
+	//! Next position to fill, shared by all producers
+	std::atomic<u32> Head;
+	//! Next position to drain, only used by the writer thread
+	u32 Tail;
+	//! Messages taken off the queue and written
+	std::atomic<u32> Written;
+
+	std::atomic<bool> Running;
+	std::atomic<bool> Sleeping;
+	std::mutex WakeMutex;
+	std::condition_variable Wake;
+	std::condition_variable Drained;
+	std::thread Thread;
+
+	//! State of the writer thread
+	core::stringc LastText;
+	ELOG_LEVEL LastLevel;
+	u32 Repeats;
+	SRate Rates[RATE_SLOTS];
+};
+
+} // end namespace irr
+
+#endif
@@ -0,0 +1,94 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "irrAtom.h"
+#include <mutex>
+#include <unordered_map>
+
+namespace irr
+{
+namespace core
+{
+
+namespace
+{
+	// FNV-1a
+	size_t hashString(const c8* str, u32 length)
+	{
+		size_t hash = 2166136261u;
+		for (u32 i=0; i<length; ++i)
+			hash = (hash ^ (size_t)(u8)str[i]) * 16777619u;
+		return hash;
+	}
+
+	struct SAtomTable
+	{
+		std::mutex Mutex;
+		std::unordered_multimap<size_t, SAtomEntry*> Entries;
+	};
+
+	// never destroyed, atoms in static objects may be released after exit
+	SAtomTable& getAtomTable()
+	{
+		static SAtomTable* table = new SAtomTable();
+		return *table;
+	}
+}
+
+
+IRRLICHT_API const SAtomEntry* IRRCALLCONV internAtom(const c8* str, u32 length, bool create)
+{
+	if (!length)
+		return 0;
+
+	const size_t hash = hashString(str, length);
+	SAtomTable& table = getAtomTable();
+
+	std::lock_guard<std::mutex> lock(table.Mutex);
+	const auto range = table.Entries.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		SAtomEntry* entry = it->second;
+		if (entry->String.size() == length && !memcmp(entry->String.c_str(), str, length))
+		{
+			entry->References.fetch_add(1, std::memory_order_relaxed);
+			return entry;
+		}
+	}
+
+	if (!create)
+		return 0;
+
+	SAtomEntry* entry = new SAtomEntry();
+	entry->Hash = hash;
+	entry->References.store(1, std::memory_order_relaxed);
+	entry->String = stringc(str, length);
+	table.Entries.emplace(hash, entry);
+	return entry;
+}
+
+
+IRRLICHT_API void IRRCALLCONV releaseAtom(const SAtomEntry* entry)
+{
+	SAtomTable& table = getAtomTable();
+
+	std::lock_guard<std::mutex> lock(table.Mutex);
+	// internAtom may have found the entry again meanwhile
+	if (entry->References.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	const auto range = table.Entries.equal_range(entry->Hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == entry)
+		{
+			table.Entries.erase(it);
+			break;
+		}
+	}
+	delete entry;
+}
+
+} // end namespace core
+} // end namespace irr
+
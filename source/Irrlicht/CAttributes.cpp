@@ -3,7 +3,6 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CAttributes.h"
-#include "CAttributeImpl.h"
 #include "ITexture.h"
 #include "IVideoDriver.h"
 
@@ -13,7 +12,7 @@ namespace io
 {
 
 CAttributes::CAttributes(video::IVideoDriver* driver)
-: Driver(driver)
+: HandleGeneration(0), Driver(driver)
 {
 	#ifdef _DEBUG
 	setDebugName("CAttributes");
@@ -35,42 +34,140 @@ CAttributes::~CAttributes()
 //! Removes all attributes
 void CAttributes::clear()
 {
-	for (u32 i=0; i<Attributes.size(); ++i)
-		Attributes[i]->drop();
-
 	Attributes.clear();
+	Index.clear();
+	++HandleGeneration;
 }
 
 //! Returns attribute index from name, -1 if not found
 s32 CAttributes::findAttribute(const c8* attributeName) const
 {
-	for (u32 i=0; i<Attributes.size(); ++i)
-		if (Attributes[i]->Name == attributeName)
-			return i;
+	const auto it = Index.find(core::atom::find(attributeName));
+	if (it == Index.end())
+		return -1;
+
+	return it->second;
+}
+
+
+CAttributes::SAttribute* CAttributes::getAttributeP(const c8* attributeName)
+{
+	const s32 index = findAttribute(attributeName);
+	return index < 0 ? 0 : &Attributes[index];
+}
+
+const CAttributes::SAttribute* CAttributes::getAttributeP(const c8* attributeName) const
+{
+	const s32 index = findAttribute(attributeName);
+	return index < 0 ? 0 : &Attributes[index];
+}
+
+u32 CAttributes::add(const c8* attributeName, E_ATTRIBUTE_TYPE type)
+{
+	SAttribute att;
+	att.Name = core::atom(attributeName);
+	att.Type = type;
+	att.Int = 0;
+
+	const u32 index = Attributes.size();
+	// lookups by name find the first attribute with it, like the old linear search
+	Index.emplace(att.Name, index);
+	Attributes.push_back(std::move(att));
+	return index;
+}
+
+//! Returns a handle for reading an attribute without looking up its name
+s32 CAttributes::getAttributeHandle(const c8* attributeName, E_ATTRIBUTE_TYPE type)
+{
+	const s32 index = findAttribute(attributeName);
+	if (index >= 0)
+		return index;
+
+	if (type != EAT_INT && type != EAT_FLOAT)
+		type = EAT_BOOL;
+	return add(attributeName, type);
+}
+
+/*
+	Conversions between the attribute types, integers and floats are
+	never true when read as bool and ignore setting a bool.
+*/
+
+s32 CAttributes::getInt(const SAttribute& att)
+{
+	switch (att.Type)
+	{
+	case EAT_INT:
+		return att.Int;
+	case EAT_FLOAT:
+		return (s32)att.Float;
+	default:
+		return att.Bool ? 1 : 0;
+	}
+}
+
+f32 CAttributes::getFloat(const SAttribute& att)
+{
+	switch (att.Type)
+	{
+	case EAT_INT:
+		return (f32)att.Int;
+	case EAT_FLOAT:
+		return att.Float;
+	default:
+		return att.Bool ? 1.0f : 0.0f;
+	}
+}
 
-	return -1;
+bool CAttributes::getBool(const SAttribute& att)
+{
+	return att.Type == EAT_BOOL && att.Bool;
 }
 
+void CAttributes::setInt(SAttribute& att, s32 value)
+{
+	switch (att.Type)
+	{
+	case EAT_INT:
+		att.Int = value;
+		break;
+	case EAT_FLOAT:
+		att.Float = (f32)value;
+		break;
+	default:
+		att.Bool = (value != 0);
+	}
+}
 
-IAttribute* CAttributes::getAttributeP(const c8* attributeName) const
+void CAttributes::setFloat(SAttribute& att, f32 value)
 {
-	for (u32 i=0; i<Attributes.size(); ++i)
-		if (Attributes[i]->Name == attributeName)
-			return Attributes[i];
+	switch (att.Type)
+	{
+	case EAT_INT:
+		att.Int = (s32)value;
+		break;
+	case EAT_FLOAT:
+		att.Float = value;
+		break;
+	default:
+		att.Bool = (value != 0);
+	}
+}
 
-	return 0;
+void CAttributes::setBool(SAttribute& att, bool value)
+{
+	if (att.Type == EAT_BOOL)
+		att.Bool = value;
 }
 
 //! Sets a attribute as boolean value
 void CAttributes::setAttribute(const c8* attributeName, bool value)
 {
-	IAttribute* att = getAttributeP(attributeName);
+	SAttribute* att = getAttributeP(attributeName);
 	if (att)
-		att->setBool(value);
+		setBool(*att, value);
 	else
-	{
-		Attributes.push_back(new CBoolAttribute(attributeName, value));
-	}
+		addBool(attributeName, value);
 }
 
 //! Gets a attribute as boolean value
@@ -79,9 +176,9 @@ void CAttributes::setAttribute(const c8* attributeName, bool value)
 //! or 0 if attribute is not set.
 bool CAttributes::getAttributeAsBool(const c8* attributeName, bool defaultNotFound) const
 {
-	const IAttribute* att = getAttributeP(attributeName);
+	const SAttribute* att = getAttributeP(attributeName);
 	if (att)
-		return att->getBool();
+		return getBool(*att);
 	else
 		return defaultNotFound;
 }
@@ -89,13 +186,11 @@ bool CAttributes::getAttributeAsBool(const c8* attributeName, bool defaultNotFou
 //! Sets a attribute as integer value
 void CAttributes::setAttribute(const c8* attributeName, s32 value)
 {
-	IAttribute* att = getAttributeP(attributeName);
+	SAttribute* att = getAttributeP(attributeName);
 	if (att)
-		att->setInt(value);
+		setInt(*att, value);
 	else
-	{
-		Attributes.push_back(new CIntAttribute(attributeName, value));
-	}
+		addInt(attributeName, value);
 }
 
 //! Gets a attribute as integer value
@@ -104,9 +199,9 @@ void CAttributes::setAttribute(const c8* attributeName, s32 value)
 //! or 0 if attribute is not set.
 s32 CAttributes::getAttributeAsInt(const c8* attributeName, irr::s32 defaultNotFound) const
 {
-	const IAttribute* att = getAttributeP(attributeName);
+	const SAttribute* att = getAttributeP(attributeName);
 	if (att)
-		return att->getInt();
+		return getInt(*att);
 	else
 		return defaultNotFound;
 }
@@ -114,11 +209,11 @@ s32 CAttributes::getAttributeAsInt(const c8* attributeName, irr::s32 defaultNotF
 //! Sets a attribute as float value
 void CAttributes::setAttribute(const c8* attributeName, f32 value)
 {
-	IAttribute* att = getAttributeP(attributeName);
+	SAttribute* att = getAttributeP(attributeName);
 	if (att)
-		att->setFloat(value);
+		setFloat(*att, value);
 	else
-		Attributes.push_back(new CFloatAttribute(attributeName, value));
+		addFloat(attributeName, value);
 }
 
 //! Gets a attribute as integer value
@@ -127,9 +222,9 @@ void CAttributes::setAttribute(const c8* attributeName, f32 value)
 //! or 0 if attribute is not set.
 f32 CAttributes::getAttributeAsFloat(const c8* attributeName, irr::f32 defaultNotFound) const
 {
-	const IAttribute* att = getAttributeP(attributeName);
+	const SAttribute* att = getAttributeP(attributeName);
 	if (att)
-		return att->getFloat();
+		return getFloat(*att);
 
 	return defaultNotFound;
 }
@@ -147,7 +242,7 @@ const c8* CAttributes::getAttributeName(s32 index) const
 	if ((u32)index >= Attributes.size())
 		return 0;
 
-	return Attributes[index]->Name.c_str();
+	return Attributes[index].Name.c_str();
 }
 
 //! Returns the type of an attribute
@@ -155,9 +250,9 @@ E_ATTRIBUTE_TYPE CAttributes::getAttributeType(const c8* attributeName) const
 {
 	E_ATTRIBUTE_TYPE ret = EAT_UNKNOWN;
 
-	const IAttribute* att = getAttributeP(attributeName);
+	const SAttribute* att = getAttributeP(attributeName);
 	if (att)
-		ret = att->getType();
+		ret = att->Type;
 
 	return ret;
 }
@@ -169,15 +264,15 @@ E_ATTRIBUTE_TYPE CAttributes::getAttributeType(s32 index) const
 	if ((u32)index >= Attributes.size())
 		return EAT_UNKNOWN;
 
-	return Attributes[index]->getType();
+	return Attributes[index].Type;
 }
 
 //! Returns the type of an attribute
 const wchar_t* CAttributes::getAttributeTypeString(const c8* attributeName, const wchar_t* defaultNotFound) const
 {
-	const IAttribute* att = getAttributeP(attributeName);
-	if (att)
-		return att->getTypeString();
+	const s32 index = findAttribute(attributeName);
+	if (index >= 0)
+		return getAttributeTypeString(index, defaultNotFound);
 	else
 		return defaultNotFound;
 }
@@ -189,7 +284,15 @@ const wchar_t* CAttributes::getAttributeTypeString(s32 index, const wchar_t* def
 	if ((u32)index >= Attributes.size())
 		return defaultNotFound;
 
-	return Attributes[index]->getTypeString();
+	switch (Attributes[index].Type)
+	{
+	case EAT_INT:
+		return L"int";
+	case EAT_FLOAT:
+		return L"float";
+	default:
+		return L"bool";
+	}
 }
 
 //! Gets an attribute as integer value
@@ -197,7 +300,7 @@ const wchar_t* CAttributes::getAttributeTypeString(s32 index, const wchar_t* def
 s32 CAttributes::getAttributeAsInt(s32 index) const
 {
 	if ((u32)index < Attributes.size())
-		return Attributes[index]->getInt();
+		return getInt(Attributes[index]);
 	else
 		return 0;
 }
@@ -207,7 +310,7 @@ s32 CAttributes::getAttributeAsInt(s32 index) const
 f32 CAttributes::getAttributeAsFloat(s32 index) const
 {
 	if ((u32)index < Attributes.size())
-		return Attributes[index]->getFloat();
+		return getFloat(Attributes[index]);
 	else
 		return 0.f;
 }
@@ -216,57 +319,52 @@ f32 CAttributes::getAttributeAsFloat(s32 index) const
 //! \param index: Index value, must be between 0 and getAttributeCount()-1.
 bool CAttributes::getAttributeAsBool(s32 index) const
 {
-	bool ret = false;
-
-	if ((u32)index < Attributes.size())
-		ret = Attributes[index]->getBool();
-
-	return ret;
+	return getBool(index);
 }
 
 //! Adds an attribute as integer
 void CAttributes::addInt(const c8* attributeName, s32 value)
 {
-	Attributes.push_back(new CIntAttribute(attributeName, value));
+	Attributes[add(attributeName, EAT_INT)].Int = value;
 }
 
 //! Adds an attribute as float
 void CAttributes::addFloat(const c8* attributeName, f32 value)
 {
-	Attributes.push_back(new CFloatAttribute(attributeName, value));
+	Attributes[add(attributeName, EAT_FLOAT)].Float = value;
 }
 
 //! Adds an attribute as bool
 void CAttributes::addBool(const c8* attributeName, bool value)
 {
-	Attributes.push_back(new CBoolAttribute(attributeName, value));
+	Attributes[add(attributeName, EAT_BOOL)].Bool = value;
 }
 
 //! Returns if an attribute with a name exists
 bool CAttributes::existsAttribute(const c8* attributeName) const
 {
-	return getAttributeP(attributeName) != 0;
+	return findAttribute(attributeName) >= 0;
 }
 
 //! Sets an attribute as boolean value
 void CAttributes::setAttribute(s32 index, bool value)
 {
 	if ((u32)index < Attributes.size())
-		Attributes[index]->setBool(value);
+		setBool(Attributes[index], value);
 }
 
 //! Sets an attribute as integer value
 void CAttributes::setAttribute(s32 index, s32 value)
 {
 	if ((u32)index < Attributes.size())
-		Attributes[index]->setInt(value);
+		setInt(Attributes[index], value);
 }
 
 //! Sets a attribute as float value
 void CAttributes::setAttribute(s32 index, f32 value)
 {
 	if ((u32)index < Attributes.size())
-		Attributes[index]->setFloat(value);
+		setFloat(Attributes[index], value);
 }
 
 } // end namespace io
@@ -7,7 +7,8 @@
 
 
 #include "IAttributes.h"
-#include "IAttribute.h"
+#include "irrAtom.h"
+#include <unordered_map>
 
 namespace irr
 {
@@ -61,6 +62,25 @@ public:
 	//! Removes all attributes
 	void clear() override;
 
+	//! Returns a handle for reading an attribute without looking up its name
+	s32 getAttributeHandle(const c8* attributeName, E_ATTRIBUTE_TYPE type = EAT_BOOL) override;
+
+	//! Changes each time the handles are invalidated by clear()
+	u32 getHandleGeneration() const
+	{
+		return HandleGeneration;
+	}
+
+	//! Reads an attribute by handle like getAttributeAsBool(s32), without the virtual call
+	bool getBool(s32 handle) const
+	{
+		if ((u32)handle >= Attributes.size())
+			return false;
+
+		const SAttribute& att = Attributes[handle];
+		return att.Type == EAT_BOOL && att.Bool;
+	}
+
 
 	/*
 
@@ -138,9 +158,36 @@ public:
 
 protected:
 
-	core::array<IAttribute*> Attributes;
-
-	IAttribute* getAttributeP(const c8* attributeName) const;
+	//! Value of an attribute, converted to the type it was added with when set
+	struct SAttribute
+	{
+		core::atom Name;
+		E_ATTRIBUTE_TYPE Type;
+		union
+		{
+			s32 Int;
+			f32 Float;
+			bool Bool;
+		};
+	};
+
+	//! Adds an attribute even if one with the name exists already
+	u32 add(const c8* attributeName, E_ATTRIBUTE_TYPE type);
+
+	SAttribute* getAttributeP(const c8* attributeName);
+	const SAttribute* getAttributeP(const c8* attributeName) const;
+
+	static s32 getInt(const SAttribute& att);
+	static f32 getFloat(const SAttribute& att);
+	static bool getBool(const SAttribute& att);
+	static void setInt(SAttribute& att, s32 value);
+	static void setFloat(SAttribute& att, f32 value);
+	static void setBool(SAttribute& att, bool value);
+
+	core::array<SAttribute> Attributes;
+	//! First attribute with a name
+	std::unordered_map<core::atom, u32> Index;
+	u32 HandleGeneration;
 
 	video::IVideoDriver* Driver;
 };
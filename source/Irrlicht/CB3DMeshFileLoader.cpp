@@ -10,6 +10,8 @@
 
 #include "IVideoDriver.h"
 #include "IFileSystem.h"
+#include "IMemoryReadFile.h"
+#include "IAttributes.h"
 #include "os.h"
 
 #ifdef _DEBUG
@@ -23,8 +25,8 @@ namespace scene
 
 //! Constructor
 CB3DMeshFileLoader::CB3DMeshFileLoader(scene::ISceneManager* smgr)
-: AnimatedMesh(0), B3DFile(0), VerticesStart(0), NormalsInFile(false),
-	HasVertexColors(false), ShowWarning(true)
+: AnimatedMesh(0), VerticesStart(0), NormalsInFile(false),
+	HasVertexColors(false), ShowWarning(true), LoadTextures(false), SceneManager(smgr)
 {
 	#ifdef _DEBUG
 	setDebugName("CB3DMeshFileLoader");
@@ -49,10 +51,13 @@ IAnimatedMesh* CB3DMeshFileLoader::createMesh(io::IReadFile* file)
 	if (!file)
 		return 0;
 
-	B3DFile = file;
+	if (!B3DFile.open(file))
+		return 0;
+
 	AnimatedMesh = new scene::CSkinnedMesh();
 	ShowWarning = true; // If true a warning is issued if too many textures are used
 	VerticesStart=0;
+	LoadTextures = SceneManager->getParameters()->getAttributeAsBool(MESH_LOADER_TEXTURES);
 
 	if ( load() )
 	{
@@ -64,6 +69,8 @@ IAnimatedMesh* CB3DMeshFileLoader::createMesh(io::IReadFile* file)
 		AnimatedMesh = 0;
 	}
 
+	B3DFile.close();
+
 	return AnimatedMesh;
 }
 
@@ -78,36 +85,36 @@ bool CB3DMeshFileLoader::load()
 	//------ Get header ------
 
 	SB3dChunkHeader header;
-	B3DFile->read(&header, sizeof(header));
+	B3DFile.read(&header, sizeof(header));
 #ifdef __BIG_ENDIAN__
 	header.size = os::Byteswap::byteswap(header.size);
 #endif
 
 	if ( strncmp( header.name, "BB3D", 4 ) != 0 )
 	{
-		os::Printer::log("File is not a b3d file. Loading failed (No header found)", B3DFile->getFileName(), ELL_ERROR);
+		os::Printer::log("File is not a b3d file. Loading failed (No header found)", B3DFile.getFileName(), ELL_ERROR);
 		return false;
 	}
 
 	// Add main chunk...
-	B3dStack.push_back(SB3dChunk(header, B3DFile->getPos()-8));
+	B3dStack.push_back(SB3dChunk(header, B3DFile.getPos()-8));
 
 	// Get file version, but ignore it, as it's not important with b3d files...
 	s32 fileVersion;
-	B3DFile->read(&fileVersion, sizeof(fileVersion));
+	B3DFile.read(&fileVersion, sizeof(fileVersion));
 #ifdef __BIG_ENDIAN__
 	fileVersion = os::Byteswap::byteswap(fileVersion);
 #endif
 
 	//------ Read main chunk ------
 
-	while ( (B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile->getPos() )
+	while ( (B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile.getPos() )
 	{
-		B3DFile->read(&header, sizeof(header));
+		B3DFile.read(&header, sizeof(header));
 #ifdef __BIG_ENDIAN__
 		header.size = os::Byteswap::byteswap(header.size);
 #endif
-		B3dStack.push_back(SB3dChunk(header, B3DFile->getPos()-8));
+		B3dStack.push_back(SB3dChunk(header, B3DFile.getPos()-8));
 
 		if ( strncmp( B3dStack.getLast().name, "TEXS", 4 ) == 0 )
 		{
@@ -127,7 +134,7 @@ bool CB3DMeshFileLoader::load()
 		else
 		{
 			os::Printer::log("Unknown chunk found in mesh base - skipping");
-			if (!B3DFile->seek(B3dStack.getLast().startposition + B3dStack.getLast().length))
+			if (!B3DFile.seek(B3dStack.getLast().startposition + B3dStack.getLast().length))
 				return false;
 			B3dStack.erase(B3dStack.size()-1);
 		}
@@ -185,15 +192,15 @@ bool CB3DMeshFileLoader::readChunkNODE(CSkinnedMesh::SJoint *inJoint)
 	else
 		joint->GlobalMatrix = joint->LocalMatrix;
 
-	while(B3dStack.getLast().startposition + B3dStack.getLast().length > B3DFile->getPos()) // this chunk repeats
+	while(B3dStack.getLast().startposition + B3dStack.getLast().length > B3DFile.getPos()) // this chunk repeats
 	{
 		SB3dChunkHeader header;
-		B3DFile->read(&header, sizeof(header));
+		B3DFile.read(&header, sizeof(header));
 #ifdef __BIG_ENDIAN__
 		header.size = os::Byteswap::byteswap(header.size);
 #endif
 
-		B3dStack.push_back(SB3dChunk(header, B3DFile->getPos()-8));
+		B3dStack.push_back(SB3dChunk(header, B3DFile.getPos()-8));
 
 		if ( strncmp( B3dStack.getLast().name, "NODE", 4 ) == 0 )
 		{
@@ -224,7 +231,7 @@ bool CB3DMeshFileLoader::readChunkNODE(CSkinnedMesh::SJoint *inJoint)
 		else
 		{
 			os::Printer::log("Unknown chunk found in node chunk - skipping");
-			if (!B3DFile->seek(B3dStack.getLast().startposition + B3dStack.getLast().length))
+			if (!B3DFile.seek(B3dStack.getLast().startposition + B3dStack.getLast().length))
 				return false;
 			B3dStack.erase(B3dStack.size()-1);
 		}
@@ -247,7 +254,7 @@ bool CB3DMeshFileLoader::readChunkMESH(CSkinnedMesh::SJoint *inJoint)
 #endif
 
 	s32 brushID;
-	B3DFile->read(&brushID, sizeof(brushID));
+	B3DFile.read(&brushID, sizeof(brushID));
 #ifdef __BIG_ENDIAN__
 	brushID = os::Byteswap::byteswap(brushID);
 #endif
@@ -255,15 +262,15 @@ bool CB3DMeshFileLoader::readChunkMESH(CSkinnedMesh::SJoint *inJoint)
 	NormalsInFile=false;
 	HasVertexColors=false;
 
-	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile->getPos()) //this chunk repeats
+	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile.getPos()) //this chunk repeats
 	{
 		SB3dChunkHeader header;
-		B3DFile->read(&header, sizeof(header));
+		B3DFile.read(&header, sizeof(header));
 #ifdef __BIG_ENDIAN__
 		header.size = os::Byteswap::byteswap(header.size);
 #endif
 
-		B3dStack.push_back(SB3dChunk(header, B3DFile->getPos()-8));
+		B3dStack.push_back(SB3dChunk(header, B3DFile.getPos()-8));
 
 		if ( strncmp( B3dStack.getLast().name, "VRTS", 4 ) == 0 )
 		{
@@ -307,7 +314,7 @@ bool CB3DMeshFileLoader::readChunkMESH(CSkinnedMesh::SJoint *inJoint)
 		else
 		{
 			os::Printer::log("Unknown chunk found in mesh - skipping");
-			if (!B3DFile->seek(B3dStack.getLast().startposition + B3dStack.getLast().length))
+			if (!B3DFile.seek(B3dStack.getLast().startposition + B3dStack.getLast().length))
 				return false;
 			B3dStack.erase(B3dStack.size()-1);
 		}
@@ -345,18 +352,18 @@ bool CB3DMeshFileLoader::readChunkVRTS(CSkinnedMesh::SJoint *inJoint)
 	const s32 max_tex_coords = 3;
 	s32 flags, tex_coord_sets, tex_coord_set_size;
 
-	B3DFile->read(&flags, sizeof(flags));
-	B3DFile->read(&tex_coord_sets, sizeof(tex_coord_sets));
-	B3DFile->read(&tex_coord_set_size, sizeof(tex_coord_set_size));
+	B3DFile.read(&flags, sizeof(flags));
+	B3DFile.read(&tex_coord_sets, sizeof(tex_coord_sets));
+	B3DFile.read(&tex_coord_set_size, sizeof(tex_coord_set_size));
 #ifdef __BIG_ENDIAN__
 	flags = os::Byteswap::byteswap(flags);
 	tex_coord_sets = os::Byteswap::byteswap(tex_coord_sets);
 	tex_coord_set_size = os::Byteswap::byteswap(tex_coord_set_size);
 #endif
 
-	if (tex_coord_sets >= max_tex_coords || tex_coord_set_size >= 4) // Something is wrong
+	if (tex_coord_sets < 0 || tex_coord_sets >= max_tex_coords || tex_coord_set_size < 0 || tex_coord_set_size >= 4) // Something is wrong
 	{
-		os::Printer::log("tex_coord_sets or tex_coord_set_size too big", B3DFile->getFileName(), ELL_ERROR);
+		os::Printer::log("tex_coord_sets or tex_coord_set_size too big", B3DFile.getFileName(), ELL_ERROR);
 		return false;
 	}
 
@@ -377,29 +384,52 @@ bool CB3DMeshFileLoader::readChunkVRTS(CSkinnedMesh::SJoint *inJoint)
 
 	numberOfReads += tex_coord_sets*tex_coord_set_size;
 
-	const s32 memoryNeeded = (B3dStack.getLast().length / sizeof(f32)) / numberOfReads;
+	// the vertices are decoded straight from the buffer of the file
+	const long chunkEnd = core::min_(B3dStack.getLast().startposition + B3dStack.getLast().length, B3DFile.getSize());
+	const u32 vertexSize = numberOfReads * sizeof(f32);
+	const u32 vertexCount = chunkEnd > B3DFile.getPos() ? (u32)(chunkEnd - B3DFile.getPos()) / vertexSize : 0;
 
-	BaseVertices.reallocate(memoryNeeded + BaseVertices.size() + 1);
-	AnimatedVertices_VertexID.reallocate(memoryNeeded + AnimatedVertices_VertexID.size() + 1);
+	BaseVertices.reallocate(vertexCount + BaseVertices.size() + 1);
+	AnimatedVertices_VertexID.reallocate(vertexCount + AnimatedVertices_VertexID.size() + 1);
+	AnimatedVertices_BufferID.reallocate(vertexCount + AnimatedVertices_BufferID.size() + 1);
 
 	//--------------------------------------------//
 
-	while( (B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile->getPos()) // this chunk repeats
+	const c8* data = B3DFile.getData();
+	for (u32 v=0; v<vertexCount; ++v, data += vertexSize)
 	{
+		f32 floats[3+3+4+max_tex_coords*4];
+		memcpy(floats, data, vertexSize);
+		#ifdef __BIG_ENDIAN__
+		for (s32 n=0; n<numberOfReads; ++n)
+			floats[n] = os::Byteswap::byteswap(floats[n]);
+		#endif
+
+		const f32* value = floats;
 		f32 position[3];
 		f32 normal[3]={0.f, 0.f, 0.f};
 		f32 color[4]={1.0f, 1.0f, 1.0f, 1.0f};
 		f32 tex_coords[max_tex_coords][4];
 
-		readFloats(position, 3);
+		memcpy(position, value, 3*sizeof(f32));
+		value += 3;
 
 		if (flags & 1)
-			readFloats(normal, 3);
+		{
+			memcpy(normal, value, 3*sizeof(f32));
+			value += 3;
+		}
 		if (flags & 2)
-			readFloats(color, 4);
+		{
+			memcpy(color, value, 4*sizeof(f32));
+			value += 4;
+		}
 
 		for (s32 i=0; i<tex_coord_sets; ++i)
-			readFloats(tex_coords[i], tex_coord_set_size);
+		{
+			memcpy(tex_coords[i], value, tex_coord_set_size*sizeof(f32));
+			value += tex_coord_set_size;
+		}
 
 		f32 tu=0.0f, tv=0.0f;
 		if (tex_coord_sets >= 1 && tex_coord_set_size >= 2)
@@ -432,6 +462,9 @@ bool CB3DMeshFileLoader::readChunkVRTS(CSkinnedMesh::SJoint *inJoint)
 		AnimatedVertices_BufferID.push_back(-1);
 	}
 
+	// a partial vertex at the end of the chunk is skipped
+	B3DFile.seek(chunkEnd);
+
 	B3dStack.erase(B3dStack.size()-1);
 
 	return true;
@@ -451,7 +484,7 @@ bool CB3DMeshFileLoader::readChunkTRIS(scene::SSkinMeshBuffer *meshBuffer, u32 m
 	bool showVertexWarning=false;
 
 	s32 triangle_brush_id; // Note: Irrlicht can't have different brushes for each triangle (using a workaround)
-	B3DFile->read(&triangle_brush_id, sizeof(triangle_brush_id));
+	B3DFile.read(&triangle_brush_id, sizeof(triangle_brush_id));
 #ifdef __BIG_ENDIAN__
 	triangle_brush_id = os::Byteswap::byteswap(triangle_brush_id);
 #endif
@@ -469,11 +502,11 @@ bool CB3DMeshFileLoader::readChunkTRIS(scene::SSkinMeshBuffer *meshBuffer, u32 m
 	const s32 memoryNeeded = B3dStack.getLast().length / sizeof(s32);
 	meshBuffer->Indices.reallocate(memoryNeeded + meshBuffer->Indices.size() + 1);
 
-	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile->getPos()) // this chunk repeats
+	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile.getPos()) // this chunk repeats
 	{
 		s32 vertex_id[3];
 
-		B3DFile->read(vertex_id, 3*sizeof(s32));
+		B3DFile.read(vertex_id, 3*sizeof(s32));
 #ifdef __BIG_ENDIAN__
 		vertex_id[0] = os::Byteswap::byteswap(vertex_id[0]);
 		vertex_id[1] = os::Byteswap::byteswap(vertex_id[1]);
@@ -489,7 +522,7 @@ bool CB3DMeshFileLoader::readChunkTRIS(scene::SSkinMeshBuffer *meshBuffer, u32 m
 		{
 			if ((u32)vertex_id[i] >= AnimatedVertices_VertexID.size())
 			{
-				os::Printer::log("Illegal vertex index found", B3DFile->getFileName(), ELL_ERROR);
+				os::Printer::log("Illegal vertex index found", B3DFile.getFileName(), ELL_ERROR);
 				return false;
 			}
 
@@ -510,9 +543,9 @@ bool CB3DMeshFileLoader::readChunkTRIS(scene::SSkinMeshBuffer *meshBuffer, u32 m
 
 				//Add the vertex to the meshbuffer:
 				if (meshBuffer->VertexType == video::EVT_STANDARD)
-					meshBuffer->Vertices_Standard.push_back( BaseVertices[ vertex_id[i] ] );
+					meshBuffer->pushVertex<video::S3DVertex>( BaseVertices[ vertex_id[i] ] );
 				else
-					meshBuffer->Vertices_2TCoords.push_back(BaseVertices[ vertex_id[i] ] );
+					meshBuffer->pushVertex(BaseVertices[ vertex_id[i] ] );
 
 				//create vertex id to meshbuffer index link:
 				AnimatedVertices_VertexID[ vertex_id[i] ] = meshBuffer->getVertexCount()-1;
@@ -571,12 +604,12 @@ bool CB3DMeshFileLoader::readChunkBONE(CSkinnedMesh::SJoint *inJoint)
 
 	if (B3dStack.getLast().length > 8)
 	{
-		while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile->getPos()) // this chunk repeats
+		while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile.getPos()) // this chunk repeats
 		{
 			u32 globalVertexID;
 			f32 strength;
-			B3DFile->read(&globalVertexID, sizeof(globalVertexID));
-			B3DFile->read(&strength, sizeof(strength));
+			B3DFile.read(&globalVertexID, sizeof(globalVertexID));
+			B3DFile.read(&strength, sizeof(strength));
 #ifdef __BIG_ENDIAN__
 			globalVertexID = os::Byteswap::byteswap(globalVertexID);
 			strength = os::Byteswap::byteswap(strength);
@@ -618,7 +651,7 @@ bool CB3DMeshFileLoader::readChunkKEYS(CSkinnedMesh::SJoint *inJoint)
 #endif
 
 	s32 flags;
-	B3DFile->read(&flags, sizeof(flags));
+	B3DFile.read(&flags, sizeof(flags));
 #ifdef __BIG_ENDIAN__
 	flags = os::Byteswap::byteswap(flags);
 #endif
@@ -630,11 +663,11 @@ bool CB3DMeshFileLoader::readChunkKEYS(CSkinnedMesh::SJoint *inJoint)
 	CSkinnedMesh::SRotationKey *oldRotKey=0;
 	core::quaternion oldRot[2];
 	bool isFirst[3]={true,true,true};
-	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile->getPos()) //this chunk repeats
+	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile.getPos()) //this chunk repeats
 	{
 		s32 frame;
 
-		B3DFile->read(&frame, sizeof(frame));
+		B3DFile.read(&frame, sizeof(frame));
 		#ifdef __BIG_ENDIAN__
 		frame = os::Byteswap::byteswap(frame);
 		#endif
@@ -767,8 +800,8 @@ bool CB3DMeshFileLoader::readChunkANIM()
 	s32 animFrames;//not stored\used
 	f32 animFPS; //not stored\used
 
-	B3DFile->read(&animFlags, sizeof(s32));
-	B3DFile->read(&animFrames, sizeof(s32));
+	B3DFile.read(&animFlags, sizeof(s32));
+	B3DFile.read(&animFrames, sizeof(s32));
 	readFloats(&animFPS, 1);
 	if (animFPS>0.f)
 		AnimatedMesh->setAnimationSpeed(animFPS);
@@ -794,7 +827,7 @@ bool CB3DMeshFileLoader::readChunkTEXS()
 	os::Printer::log(logStr.c_str(), ELL_DEBUG);
 #endif
 
-	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile->getPos()) //this chunk repeats
+	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile.getPos()) //this chunk repeats
 	{
 		Textures.push_back(SB3dTexture());
 		SB3dTexture& B3dTexture = Textures.getLast();
@@ -805,8 +838,8 @@ bool CB3DMeshFileLoader::readChunkTEXS()
 		os::Printer::log("read Texture", B3dTexture.TextureName.c_str(), ELL_DEBUG);
 #endif
 
-		B3DFile->read(&B3dTexture.Flags, sizeof(s32));
-		B3DFile->read(&B3dTexture.Blend, sizeof(s32));
+		B3DFile.read(&B3dTexture.Flags, sizeof(s32));
+		B3DFile.read(&B3dTexture.Blend, sizeof(s32));
 #ifdef __BIG_ENDIAN__
 		B3dTexture.Flags = os::Byteswap::byteswap(B3dTexture.Flags);
 		B3dTexture.Blend = os::Byteswap::byteswap(B3dTexture.Blend);
@@ -839,7 +872,7 @@ bool CB3DMeshFileLoader::readChunkBRUS()
 #endif
 
 	u32 n_texs;
-	B3DFile->read(&n_texs, sizeof(u32));
+	B3DFile.read(&n_texs, sizeof(u32));
 #ifdef __BIG_ENDIAN__
 	n_texs = os::Byteswap::byteswap(n_texs);
 #endif
@@ -849,7 +882,7 @@ bool CB3DMeshFileLoader::readChunkBRUS()
 	// number of bytes to skip (for ignored texture ids)
 	const u32 n_texs_offset = (num_textures<n_texs)?(n_texs-num_textures):0;
 
-	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile->getPos()) //this chunk repeats
+	while((B3dStack.getLast().startposition + B3dStack.getLast().length) > B3DFile.getPos()) //this chunk repeats
 	{
 		// This is what blitz basic calls a brush, like a Irrlicht Material
 
@@ -867,8 +900,8 @@ bool CB3DMeshFileLoader::readChunkBRUS()
 		readFloats(&B3dMaterial.alpha, 1);
 		readFloats(&B3dMaterial.shininess, 1);
 
-		B3DFile->read(&B3dMaterial.blend, sizeof(B3dMaterial.blend));
-		B3DFile->read(&B3dMaterial.fx, sizeof(B3dMaterial.fx));
+		B3DFile.read(&B3dMaterial.blend, sizeof(B3dMaterial.blend));
+		B3DFile.read(&B3dMaterial.fx, sizeof(B3dMaterial.fx));
 #ifdef __BIG_ENDIAN__
 		B3dMaterial.blend = os::Byteswap::byteswap(B3dMaterial.blend);
 		B3dMaterial.fx = os::Byteswap::byteswap(B3dMaterial.fx);
@@ -882,7 +915,7 @@ bool CB3DMeshFileLoader::readChunkBRUS()
 		for (i=0; i<num_textures; ++i)
 		{
 			s32 texture_id=-1;
-			B3DFile->read(&texture_id, sizeof(s32));
+			B3DFile.read(&texture_id, sizeof(s32));
 #ifdef __BIG_ENDIAN__
 			texture_id = os::Byteswap::byteswap(texture_id);
 #endif
@@ -902,13 +935,13 @@ bool CB3DMeshFileLoader::readChunkBRUS()
 		for (i=0; i<n_texs_offset; ++i)
 		{
 			s32 texture_id=-1;
-			B3DFile->read(&texture_id, sizeof(s32));
+			B3DFile.read(&texture_id, sizeof(s32));
 #ifdef __BIG_ENDIAN__
 			texture_id = os::Byteswap::byteswap(texture_id);
 #endif
 			if (ShowWarning && (texture_id != -1) && (n_texs>video::MATERIAL_MAX_TEXTURES))
 			{
-				os::Printer::log("Too many textures used in one material", B3DFile->getFileName(), ELL_WARNING);
+				os::Printer::log("Too many textures used in one material", B3DFile.getFileName(), ELL_WARNING);
 				ShowWarning = false;
 			}
 		}
@@ -938,6 +971,16 @@ bool CB3DMeshFileLoader::readChunkBRUS()
 			}
 		}
 
+		// the files are loaded by the scene manager after parsing
+		if (LoadTextures)
+		{
+			for (i=0; i<num_textures; ++i)
+			{
+				if (B3dMaterial.Textures[i])
+					B3dMaterial.Material.setTexture(i, SceneManager->addMeshTextureReference(B3dMaterial.Textures[i]->TextureName));
+			}
+		}
+
 		//------ Convert blitz flags/blend to irrlicht -------
 
 		//Two textures:
@@ -1029,26 +1072,63 @@ bool CB3DMeshFileLoader::readChunkBRUS()
 
 void CB3DMeshFileLoader::readString(core::stringc& newstring)
 {
-	newstring="";
-	while (B3DFile->getPos() <= B3DFile->getSize())
-	{
-		c8 character;
-		B3DFile->read(&character, sizeof(character));
-		if (character==0)
-			return;
-		newstring.append(character);
-	}
+	const c8* start = B3DFile.getData();
+	const size_t left = B3DFile.getSize() - B3DFile.getPos();
+	const c8* end = (const c8*)memchr(start, 0, left);
+
+	// strings at the end of the file may lack the terminating zero
+	const size_t length = end ? end - start : left;
+	newstring = core::stringc(start, length);
+	B3DFile.seek((long)(end ? length + 1 : length), true);
 }
 
 
 void CB3DMeshFileLoader::readFloats(f32* vec, u32 count)
 {
-	B3DFile->read(vec, count*sizeof(f32));
+	B3DFile.read(vec, count*sizeof(f32));
 	#ifdef __BIG_ENDIAN__
 	for (u32 n=0; n<count; ++n)
 		vec[n] = os::Byteswap::byteswap(vec[n]);
 	#endif
 }
 
+
+bool CB3DReadBuffer::open(io::IReadFile* file)
+{
+	close();
+
+	FileName = file->getFileName();
+	Size = file->getSize();
+	Pos = 0;
+	if (Size < 0)
+		return false;
+
+	if (file->getType() == io::ERFT_MEMORY_READ_FILE)
+	{
+		Data = (const c8*)static_cast<io::IMemoryReadFile*>(file)->getBuffer();
+		return true;
+	}
+
+	Copy.set_used((u32)Size);
+	file->seek(0);
+	if (Size && file->read(Copy.pointer(), Size) != (size_t)Size)
+	{
+		close();
+		return false;
+	}
+
+	Data = Copy.const_pointer();
+	return true;
+}
+
+
+void CB3DReadBuffer::close()
+{
+	Copy.clear();
+	Data = 0;
+	Size = 0;
+	Pos = 0;
+}
+
 } // end namespace scene
 } // end namespace irr
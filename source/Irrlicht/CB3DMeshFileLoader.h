@@ -22,6 +22,56 @@ namespace irr
 namespace scene
 {
 
+//! The file of a B3D loader, read from memory instead of through IReadFile for every value
+class CB3DReadBuffer
+{
+public:
+	CB3DReadBuffer() : Data(0), Size(0), Pos(0) {}
+
+	//! Uses the buffer of memory files, reads other files into memory at once
+	/** \return False if the file could not be read. */
+	bool open(io::IReadFile* file);
+
+	//! Releases the data of the file
+	void close();
+
+	size_t read(void* buffer, size_t sizeToRead)
+	{
+		const long left = Size - Pos;
+		if ((long)sizeToRead > left)
+			sizeToRead = left > 0 ? (size_t)left : 0;
+		memcpy(buffer, Data + Pos, sizeToRead);
+		Pos += (long)sizeToRead;
+		return sizeToRead;
+	}
+
+	bool seek(long finalPos, bool relativeMovement = false)
+	{
+		const long pos = relativeMovement ? Pos + finalPos : finalPos;
+		if (pos < 0 || pos > Size)
+			return false;
+		Pos = pos;
+		return true;
+	}
+
+	long getPos() const { return Pos; }
+
+	long getSize() const { return Size; }
+
+	//! Data at the current position, getSize()-getPos() bytes are left
+	const c8* getData() const { return Data + Pos; }
+
+	const io::path& getFileName() const { return FileName; }
+
+private:
+	//! copy of files which are not in memory already
+	core::array<c8> Copy;
+	const c8* Data;
+	long Size;
+	long Pos;
+	io::path FileName;
+};
+
 //! Meshloader for B3D format
 class CB3DMeshFileLoader : public IMeshLoader
 {
@@ -68,7 +118,7 @@ private:
 	core::array<video::S3DVertex2TCoords> BaseVertices;
 
 	CSkinnedMesh*	AnimatedMesh;
-	io::IReadFile*	B3DFile;
+	CB3DReadBuffer	B3DFile;
 
 	//B3Ds have Vertex ID's local within the mesh I don't want this
 	// Variable needs to be class member due to recursion in calls
@@ -77,6 +127,11 @@ private:
 	bool NormalsInFile;
 	bool HasVertexColors;
 	bool ShowWarning;
+
+	//! Records the textures of the brushes, see MESH_LOADER_TEXTURES
+	bool LoadTextures;
+
+	scene::ISceneManager* SceneManager;
 };
 
 
@@ -233,6 +233,24 @@ bool CB3DMeshWriter::writeMesh(io::IWriteFile* file, IMesh* const mesh, s32 flag
                     }
                 }
                 break;
+                case EVT_SKINNED:
+                {
+                    // the joints are written with the bones
+                    S3DVertexSkinned *v = (S3DVertexSkinned *) mb->getVertices();
+                    const SColorf col(v[j].Color);
+                    writeColor(file, col);
+
+                    const core::vector2df uv1 = v[j].TCoords;
+                    writeVector2(file, uv1);
+                    if (texcoordsCount == 2)
+                    {
+                        writeVector2(file, core::vector2df(0.f, 0.f));
+                    }
+                }
+                break;
+                // compact vertices are only kept by the drivers
+                case EVT_COMPACT:
+                break;
             }
         }
     }
@@ -0,0 +1,145 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBillboardBatch.h"
+#include <algorithm>
+
+namespace irr
+{
+namespace scene
+{
+
+CBillboardBatch::~CBillboardBatch()
+{
+	for (SGroup* group : Groups)
+	{
+		for (SMeshBuffer* buffer : group->Buffers)
+			buffer->drop();
+		delete group;
+	}
+}
+
+void CBillboardBatch::add(const video::SMaterial& material, bool transparent, const video::S3DVertex* vertices, f32 distanceSQ)
+{
+	if (LastGroup >= Groups.size() || Groups[LastGroup]->Material != material)
+	{
+		LastGroup = 0;
+		while (LastGroup < Groups.size() && Groups[LastGroup]->Material != material)
+			++LastGroup;
+
+		if (LastGroup == Groups.size())
+		{
+			SGroup* group = new SGroup();
+			group->Material = material;
+			group->Transparent = transparent;
+			Groups.push_back(group);
+		}
+	}
+
+	SGroup* group = Groups[LastGroup];
+
+	SQuad quad;
+	quad.DistanceSQ = distanceSQ;
+	quad.FirstVertex = (u32)group->Vertices.size();
+	group->Quads.push_back(quad);
+	group->Vertices.insert(group->Vertices.end(), vertices, vertices + 4);
+}
+
+void CBillboardBatch::build(CRenderQueue& solidQueue, CTransparentRenderQueue& transparentQueue)
+{
+	// groups without quads since the last frame are removed
+	u32 used = 0;
+	for (u32 g = 0; g < Groups.size(); ++g)
+	{
+		SGroup* group = Groups[g];
+		if (group->Quads.empty())
+		{
+			for (SMeshBuffer* buffer : group->Buffers)
+				buffer->drop();
+			delete group;
+			continue;
+		}
+		Groups[used++] = group;
+	}
+	Groups.resize(used);
+	LastGroup = 0;
+
+	for (SGroup* group : Groups)
+	{
+		if (group->Transparent)
+		{
+			std::stable_sort(group->Quads.begin(), group->Quads.end(),
+				[](const SQuad& a, const SQuad& b) { return a.DistanceSQ > b.DistanceSQ; });
+		}
+
+		const u32 quadCount = (u32)group->Quads.size();
+		const u32 bufferCount = (quadCount + MaxQuadsPerBuffer - 1) / MaxQuadsPerBuffer;
+		while (group->Buffers.size() < bufferCount)
+		{
+			SMeshBuffer* buffer = new SMeshBuffer();
+			buffer->setHardwareMappingHint(EHM_STREAM);
+			group->Buffers.push_back(buffer);
+		}
+
+		for (u32 b = 0; b < bufferCount; ++b)
+		{
+			const u32 first = b * MaxQuadsPerBuffer;
+			const u32 count = core::min_(quadCount - first, MaxQuadsPerBuffer);
+
+			SMeshBuffer* buffer = group->Buffers[b];
+			buffer->Material = group->Material;
+
+			// the indices only change with the number of quads
+			if (buffer->Indices.size() != count * 6)
+			{
+				buffer->Indices.set_used(count * 6);
+				u16* indices = buffer->Indices.pointer();
+				for (u32 i = 0; i < count; ++i)
+				{
+					const u16 v = (u16)(i * 4);
+					indices[i * 6 + 0] = v;
+					indices[i * 6 + 1] = v + 2;
+					indices[i * 6 + 2] = v + 1;
+					indices[i * 6 + 3] = v;
+					indices[i * 6 + 4] = v + 3;
+					indices[i * 6 + 5] = v + 2;
+				}
+				buffer->setDirty(EBT_INDEX);
+			}
+
+			buffer->Vertices.set_used(count * 4);
+			video::S3DVertex* vertices = buffer->Vertices.pointer();
+			f32 farthest = 0.f;
+			for (u32 i = 0; i < count; ++i)
+			{
+				const SQuad& quad = group->Quads[first + i];
+				const video::S3DVertex* source = &group->Vertices[quad.FirstVertex];
+				vertices[i * 4 + 0] = source[0];
+				vertices[i * 4 + 1] = source[1];
+				vertices[i * 4 + 2] = source[2];
+				vertices[i * 4 + 3] = source[3];
+				farthest = core::max_(farthest, quad.DistanceSQ);
+			}
+			buffer->setDirty(EBT_VERTEX);
+			buffer->recalculateBoundingBox();
+
+			// the buffers are in world space, so they are drawn without a node
+			if (group->Transparent)
+				transparentQueue.add(farthest, 0, buffer, buffer->Material);
+			else
+				solidQueue.add(CRenderQueue::makeKey(0, buffer->Material, 0.f), 0, buffer, buffer->Material);
+		}
+	}
+}
+
+void CBillboardBatch::clear()
+{
+	for (SGroup* group : Groups)
+	{
+		group->Vertices.clear();
+		group->Quads.clear();
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,66 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BILLBOARD_BATCH_H_INCLUDED__
+#define __C_BILLBOARD_BATCH_H_INCLUDED__
+
+#include "CRenderQueue.h"
+#include "SMeshBuffer.h"
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+
+//! Collects the quads of billboards, to draw all quads of a material at once
+/** The quads are given in world space and already face the camera. Quads of
+the same material are copied into streamed mesh buffers, with transparent
+ones sorted back to front. Each buffer becomes a single entry of the solid or
+transparent render queue. */
+class CBillboardBatch
+{
+public:
+	~CBillboardBatch();
+
+	//! Adds a quad
+	/** \param vertices Four vertices, drawn as the triangles 0,2,1 and 0,3,2.
+	\param distanceSQ Squared distance from the camera, used to sort transparent quads. */
+	void add(const video::SMaterial& material, bool transparent, const video::S3DVertex* vertices, f32 distanceSQ);
+
+	//! Fills the mesh buffers and adds them to the render queues
+	/** The entries stay valid until clear() is called. */
+	void build(CRenderQueue& solidQueue, CTransparentRenderQueue& transparentQueue);
+
+	//! Forgets all quads, keeping the buffers for the next frame
+	void clear();
+
+private:
+	struct SQuad
+	{
+		f32 DistanceSQ;
+		u32 FirstVertex;
+	};
+
+	struct SGroup
+	{
+		video::SMaterial Material;
+		bool Transparent;
+		std::vector<video::S3DVertex> Vertices;
+		std::vector<SQuad> Quads;
+		//! Buffers of up to MaxQuadsPerBuffer quads each
+		std::vector<SMeshBuffer*> Buffers;
+	};
+
+	//! Quads fitting the 16 bit indices of a buffer
+	static constexpr u32 MaxQuadsPerBuffer = 16384;
+
+	std::vector<SGroup*> Groups;
+	//! Group of the previous add(), consecutive billboards usually share it
+	u32 LastGroup = 0;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
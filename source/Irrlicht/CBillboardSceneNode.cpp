@@ -58,7 +58,23 @@ CBillboardSceneNode::~CBillboardSceneNode()
 void CBillboardSceneNode::OnRegisterSceneNode()
 {
 	if (IsVisible)
-		SceneManager->registerNodeForRendering(this);
+	{
+		// the camera is already updated, so without debug data the quad
+		// is built here and drawn with those of all other billboards
+		ICameraSceneNode* camera = SceneManager->getActiveCamera();
+		if (!DebugDataVisible && camera)
+		{
+			if (!SceneManager->isCulled(this))
+			{
+				updateMesh(camera);
+				SceneManager->registerBillboardForRendering(Buffer->Material, Buffer->Vertices.const_pointer());
+			}
+		}
+		else
+		{
+			SceneManager->registerNodeForRendering(this);
+		}
+	}
 
 	ISceneNode::OnRegisterSceneNode();
 }
@@ -7,6 +7,7 @@
 
 #include "IBillboardSceneNode.h"
 #include "SMeshBuffer.h"
+#include "CSceneNodePool.h"
 
 namespace irr
 {
@@ -15,10 +16,14 @@ namespace scene
 
 //! Scene node which is a billboard. A billboard is like a 3d sprite: A 2d element,
 //! which always looks to the camera.
-class CBillboardSceneNode : virtual public IBillboardSceneNode
+class CBillboardSceneNode : virtual public IBillboardSceneNode, public CSceneNodePoolAllocated<CBillboardSceneNode>
 {
 public:
 
+	//! the pool takes precedence over the operators of ISceneNode
+	using CSceneNodePoolAllocated<CBillboardSceneNode>::operator new;
+	using CSceneNodePoolAllocated<CBillboardSceneNode>::operator delete;
+
 	//! constructor
 	CBillboardSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
 		const core::vector3df& position, const core::dimension2d<f32>& size,
@@ -6,6 +6,16 @@
 #define _C_BLIT_H_INCLUDED_
 
 #include "SoftwareDriver2_helper.h"
+#include "CColorConverter.h"
+#include "CJobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _IRR_BLIT_SSE2_
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define _IRR_BLIT_NEON_
+#endif
 
 namespace irr
 {
@@ -135,6 +145,181 @@ inline u32 PixelLerp32(const u32 source, const u32 value)
 	return srcRB | srcXG;
 }
 
+/*!
+	Pixel =>
+			color = dest * ( 1 - SourceAlpha ) + source * SourceAlpha,
+			alpha = destAlpha * ( 1 - SourceAlpha ) + sourceAlpha
+
+	where "1" means "full scale" (255)
+*/
+inline u32 PixelCombine32(const u32 c2, const u32 c1)
+{
+	// alpha test
+	u32 alpha = c1 & 0xFF000000;
+
+	if (0 == alpha)
+		return c2;
+	if (0xFF000000 == alpha)
+	{
+		return c1;
+	}
+
+	alpha >>= 24;
+
+	// add highbit alpha, if ( alpha > 127 ) alpha += 1;
+	// stretches [0;255] to [0;256] to avoid division by 255. use division 256 == shr 8
+	alpha += (alpha >> 7);
+
+	u32 srcRB = c1 & 0x00FF00FF;
+	u32 srcXG = c1 & 0x0000FF00;
+
+	u32 dstRB = c2 & 0x00FF00FF;
+	u32 dstXG = c2 & 0x0000FF00;
+
+
+	u32 rb = srcRB - dstRB;
+	u32 xg = srcXG - dstXG;
+
+	rb *= alpha;
+	xg *= alpha;
+	rb >>= 8;
+	xg >>= 8;
+
+	rb += dstRB;
+	xg += dstXG;
+
+	rb &= 0x00FF00FF;
+	xg &= 0x0000FF00;
+
+	u32 sa = c1 >> 24;
+	u32 da = c2 >> 24;
+	u32 blendAlpha_fix8 = (sa * 256 + da * (256 - alpha)) >> 8;
+	return blendAlpha_fix8 << 24 | rb | xg;
+}
+
+#if defined(_IRR_BLIT_SSE2_)
+/*!
+	PixelBlend32, or PixelCombine32 with combine, of 4 pixels.
+	Each channel is ( source * alpha + dest * ( 256 - alpha ) ) >> 8 with the
+	source alpha stretched to [0;256], which always fits 16 bit.
+*/
+static inline __m128i PixelBlend32x4(const __m128i c2, const __m128i c1, const bool combine)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(256);
+	const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+	__m128i result[2];
+	for (u32 i = 0; i < 2; ++i)
+	{
+		const __m128i src = i ? _mm_unpackhi_epi8(c1, zero) : _mm_unpacklo_epi8(c1, zero);
+		const __m128i dst = i ? _mm_unpackhi_epi8(c2, zero) : _mm_unpacklo_epi8(c2, zero);
+
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm_add_epi16(alpha, _mm_srli_epi16(alpha, 7));
+
+		// combining keeps the whole source alpha
+		const __m128i factor = combine ? _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, full)) : alpha;
+		result[i] = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(src, factor),
+			_mm_mullo_epi16(dst, _mm_sub_epi16(full, alpha))), 8);
+	}
+	__m128i blend = _mm_packus_epi16(result[0], result[1]);
+
+	if (!combine)
+	{
+		// the source alpha, the dest keeps its own where the source is transparent
+		const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+		const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(c1, alphaMask), zero);
+		const __m128i alpha = _mm_or_si128(_mm_andnot_si128(transparent, c1), _mm_and_si128(transparent, c2));
+		blend = _mm_or_si128(_mm_andnot_si128(alphaMask, blend), _mm_and_si128(alphaMask, alpha));
+	}
+	return blend;
+}
+
+//! PixelMul32_2 of 4 pixels with one color, which is given in 16 bit lanes
+static inline __m128i PixelMul32_2x4(const __m128i c0, const __m128i color)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c0, zero), color), 8);
+	const __m128i high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c0, zero), color), 8);
+	return _mm_packus_epi16(low, high);
+}
+#elif defined(_IRR_BLIT_NEON_)
+static inline uint8x16_t PixelBlend32x4(const uint8x16_t c2, const uint8x16_t c1, const bool combine)
+{
+	const uint16x8_t full = vdupq_n_u16(256);
+	const uint16x8_t alphaLanes = vreinterpretq_u16_u64(vdupq_n_u64(0xFFFF000000000000ULL));
+	const uint8_t broadcast[16] = { 3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15 };
+	const uint8x16_t alpha8 = vqtbl1q_u8(c1, vld1q_u8(broadcast));
+
+	uint8x8_t result[2];
+	for (u32 i = 0; i < 2; ++i)
+	{
+		const uint16x8_t src = vmovl_u8(i ? vget_high_u8(c1) : vget_low_u8(c1));
+		const uint16x8_t dst = vmovl_u8(i ? vget_high_u8(c2) : vget_low_u8(c2));
+		uint16x8_t alpha = vmovl_u8(i ? vget_high_u8(alpha8) : vget_low_u8(alpha8));
+		alpha = vaddq_u16(alpha, vshrq_n_u16(alpha, 7));
+
+		const uint16x8_t factor = combine ? vbslq_u16(alphaLanes, full, alpha) : alpha;
+		result[i] = vshrn_n_u16(vmlaq_u16(vmulq_u16(src, factor), dst, vsubq_u16(full, alpha)), 8);
+	}
+	uint8x16_t blend = vcombine_u8(result[0], result[1]);
+
+	if (!combine)
+	{
+		const uint32x4_t alphaMask = vdupq_n_u32(0xFF000000);
+		const uint32x4_t src = vreinterpretq_u32_u8(c1);
+		const uint32x4_t transparent = vceqq_u32(vandq_u32(src, alphaMask), vdupq_n_u32(0));
+		const uint32x4_t alpha = vbslq_u32(transparent, vreinterpretq_u32_u8(c2), src);
+		blend = vreinterpretq_u8_u32(vbslq_u32(alphaMask, alpha, vreinterpretq_u32_u8(blend)));
+	}
+	return blend;
+}
+
+static inline uint8x16_t PixelMul32_2x4(const uint8x16_t c0, const uint16x8_t color)
+{
+	const uint8x8_t low = vshrn_n_u16(vmulq_u16(vmovl_u8(vget_low_u8(c0)), color), 8);
+	const uint8x8_t high = vshrn_n_u16(vmulq_u16(vmovl_u8(vget_high_u8(c0)), color), 8);
+	return vcombine_u8(low, high);
+}
+#endif
+
+/*!
+	Blends a row of source pixels onto the dest like PixelBlend32, or like
+	PixelCombine32 with combine. The source is multiplied by argb first
+	unless argb is 0.
+*/
+static void PixelBlendRow32(u32* dst, const u32* src, u32 count, const u32* argb, const bool combine)
+{
+	u32 x = 0;
+#if defined(_IRR_BLIT_SSE2_)
+	const __m128i color = argb ? _mm_unpacklo_epi8(_mm_set1_epi32((int)*argb), _mm_setzero_si128()) : _mm_setzero_si128();
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i c1 = _mm_loadu_si128((const __m128i*)(src + x));
+		if (argb)
+			c1 = PixelMul32_2x4(c1, color);
+		const __m128i c2 = _mm_loadu_si128((const __m128i*)(dst + x));
+		_mm_storeu_si128((__m128i*)(dst + x), PixelBlend32x4(c2, c1, combine));
+	}
+#elif defined(_IRR_BLIT_NEON_)
+	const uint16x8_t color = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(argb ? *argb : 0)));
+	for (; x + 4 <= count; x += 4)
+	{
+		uint8x16_t c1 = vreinterpretq_u8_u32(vld1q_u32(src + x));
+		if (argb)
+			c1 = PixelMul32_2x4(c1, color);
+		const uint8x16_t c2 = vreinterpretq_u8_u32(vld1q_u32(dst + x));
+		vst1q_u32(dst + x, vreinterpretq_u32_u8(PixelBlend32x4(c2, c1, combine)));
+	}
+#endif
+	for (; x < count; ++x)
+	{
+		const u32 c1 = argb ? PixelMul32_2(src[x], *argb) : src[x];
+		dst[x] = combine ? PixelCombine32(dst[x], c1) : PixelBlend32(dst[x], c1);
+	}
+}
+
 
 /*!
 */
@@ -320,10 +505,7 @@ static void executeBlit_TextureCopy_16_to_32( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
-			{
-				dst[dx] = video::A1R5G5B5toA8R8G8B8( src[dx] );
-			}
+			video::CColorConverter::convert_A1R5G5B5toA8R8G8B8(src, w, dst);
 
 			src = (u16*) ( (u8*) (src) + job->srcPitch );
 			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
@@ -410,13 +592,7 @@ static void executeBlit_TextureCopy_24_to_32( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy < job->height; ++dy )
 		{
-			const u8* s = src;
-
-			for ( u32 dx = 0; dx < job->width; ++dx )
-			{
-				dst[dx] = 0xFF000000 | s[0] << 16 | s[1] << 8 | s[2];
-				s += 3;
-			}
+			video::CColorConverter::convert_R8G8B8toA8R8G8B8(src, job->width, dst);
 
 			src = src + job->srcPitch;
 			dst = (u32*) ( (u8*) (dst) + job->dstPitch );
@@ -456,13 +632,7 @@ static void executeBlit_TextureCopy_32_to_24( const SBlitJob * job )
 	{
 		for ( u32 dy = 0; dy != h; ++dy )
 		{
-			for ( u32 dx = 0; dx != w; ++dx )
-			{
-				u8 * writeTo = &dst[dx * 3];
-				*writeTo++ = (src[dx] >> 16)& 0xFF;
-				*writeTo++ = (src[dx] >> 8) & 0xFF;
-				*writeTo++ = src[dx] & 0xFF;
-			}
+			video::CColorConverter::convert_A8R8G8B8toR8G8B8(src, w, dst);
 
 			src = (u32*) ( (u8*) (src) + job->srcPitch );
 			dst += job->dstPitch;
@@ -505,10 +675,15 @@ static void executeBlit_TextureBlend_32_to_32( const SBlitJob * job )
 	{
 		const u32* src = (u32*)((u8*)(job->src) + job->srcPitch*f18_floor(src_y));
 
-		f18 src_x = f18_zero;
-		for (u32 dx = 0; dx < job->width; ++dx, src_x += wscale)
+		if (wscale == f18_one)
+			PixelBlendRow32(dst, src, job->width, 0, false);
+		else
 		{
-			dst[dx] = PixelBlend32(dst[dx], src[f18_floor(src_x)]);
+			f18 src_x = f18_zero;
+			for (u32 dx = 0; dx < job->width; ++dx, src_x += wscale)
+			{
+				dst[dx] = PixelBlend32(dst[dx], src[f18_floor(src_x)]);
+			}
 		}
 		dst = (u32*)((u8*)(dst)+job->dstPitch);
 	}
@@ -555,10 +730,15 @@ static void executeBlit_TextureBlendColor_32_to_32( const SBlitJob * job )
 	{
 		const u32* src = (u32*)((u8*)(job->src) + job->srcPitch*f18_floor(src_y));
 
-		f18 src_x = f18_zero;
-		for (u32 dx = 0; dx < job->width; ++dx, src_x += wscale)
+		if (wscale == f18_one)
+			PixelBlendRow32(dst, src, job->width, &job->argb, false);
+		else
 		{
-			dst[dx] = PixelBlend32(dst[dx], PixelMul32_2(src[f18_floor(src_x)], job->argb));
+			f18 src_x = f18_zero;
+			for (u32 dx = 0; dx < job->width; ++dx, src_x += wscale)
+			{
+				dst[dx] = PixelBlend32(dst[dx], PixelMul32_2(src[f18_floor(src_x)], job->argb));
+			}
 		}
 		dst = (u32*)((u8*)(dst)+job->dstPitch);
 	}
@@ -732,58 +912,6 @@ static void executeBlit_TextureCombineColor_16_to_24( const SBlitJob * job )
 	}
 }
 
-/*!
-	Pixel =>
-			color = dest * ( 1 - SourceAlpha ) + source * SourceAlpha,
-			alpha = destAlpha * ( 1 - SourceAlpha ) + sourceAlpha
-
-	where "1" means "full scale" (255)
-*/
-inline u32 PixelCombine32(const u32 c2, const u32 c1)
-{
-	// alpha test
-	u32 alpha = c1 & 0xFF000000;
-
-	if (0 == alpha)
-		return c2;
-	if (0xFF000000 == alpha)
-	{
-		return c1;
-	}
-
-	alpha >>= 24;
-
-	// add highbit alpha, if ( alpha > 127 ) alpha += 1;
-	// stretches [0;255] to [0;256] to avoid division by 255. use division 256 == shr 8
-	alpha += (alpha >> 7);
-
-	u32 srcRB = c1 & 0x00FF00FF;
-	u32 srcXG = c1 & 0x0000FF00;
-
-	u32 dstRB = c2 & 0x00FF00FF;
-	u32 dstXG = c2 & 0x0000FF00;
-
-
-	u32 rb = srcRB - dstRB;
-	u32 xg = srcXG - dstXG;
-
-	rb *= alpha;
-	xg *= alpha;
-	rb >>= 8;
-	xg >>= 8;
-
-	rb += dstRB;
-	xg += dstXG;
-
-	rb &= 0x00FF00FF;
-	xg &= 0x0000FF00;
-
-	u32 sa = c1 >> 24;
-	u32 da = c2 >> 24;
-	u32 blendAlpha_fix8 = (sa * 256 + da * (256 - alpha)) >> 8;
-	return blendAlpha_fix8 << 24 | rb | xg;
-}
-
 /*!
 	Combine alpha channels (increases alpha / reduces transparency)
 	Destination alpha is treated as full 255
@@ -848,10 +976,7 @@ static void executeBlit_TextureCombineColor_32_to_32( const SBlitJob * job )
 
 	for ( u32 dy = 0; dy != job->height; ++dy )
 	{
-		for (u32 dx = 0; dx != job->width; ++dx )
-		{
-			dst[dx] = PixelCombine32( dst[dx], PixelMul32_2( src[dx], job->argb ) );
-		}
+		PixelBlendRow32(dst, src, job->width, &job->argb, true);
 		src = (u32*) ( (u8*) (src) + job->srcPitch );
 		dst = (u32*) ( (u8*) (dst) + job->dstPitch );
 	}
@@ -987,6 +1112,22 @@ inline void setClip(AbsRectangle &out, const core::rect<s32> *clip,
 
 }
 
+//! Blits with fewer pixels are done on the calling thread only
+const u32 PARALLEL_BLIT_MIN_PIXELS = 256 * 256;
+
+//! A band of rows of a blit, see Blit()
+struct SBlitBand
+{
+	tExecuteBlit Blitter;
+	SBlitJob Job;
+};
+
+static void executeBlitBand( void* data )
+{
+	const SBlitBand* band = (const SBlitBand*) data;
+	band->Blitter( &band->Job );
+}
+
 /*!
 	a generic 2D Blitter
 */
@@ -1052,7 +1193,35 @@ static s32 Blit(eBlitter operation,
 	job.dstPixelMul = dest->getBytesPerPixel();
 	job.dst = (void*) ( (u8*) dest->getData() + ( job.Dest.y0 * job.dstPitch ) + ( job.Dest.x0 * job.dstPixelMul ) );
 
-	blitter( &job );
+	// large blits are split into bands of rows for the worker threads
+	const u32 cores = std::thread::hardware_concurrency();
+	if ( cores > 1 && job.height > 1 && (u64)job.width * job.height >= PARALLEL_BLIT_MIN_PIXELS )
+	{
+		const u32 bandCount = core::min_( cores, job.height );
+		core::array<SBlitBand> bands;
+		bands.set_used( bandCount );
+
+		scene::CJobSystem jobSystem( bandCount - 1 );
+		u32 y = 0;
+		for ( u32 i = 0; i != bandCount; ++i )
+		{
+			const u32 height = ( job.height - y ) / ( bandCount - i );
+			SBlitBand& band = bands[i];
+			band.Blitter = blitter;
+			band.Job = job;
+			band.Job.height = height;
+			band.Job.dst = (u8*) job.dst + (size_t)y * job.dstPitch;
+			if ( source )
+				band.Job.src = (const u8*) job.src + (ptrdiff_t)y * job.srcPitch;
+			jobSystem.add( executeBlitBand, &band );
+			y += height;
+		}
+		jobSystem.wait();
+	}
+	else
+	{
+		blitter( &job );
+	}
 
 	return 1;
 }
@@ -0,0 +1,550 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CBlockTranscoder.h"
+#include "IVideoDriver.h"
+#include <string.h>
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	//! Modifiers of the ETC1 subblocks, for the pixel indices 0 and 1, 2 and 3 negate them
+	const s32 ETC1_MODIFIERS[8][2] =
+	{
+		{ 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+	};
+
+	//! Distances of the ETC2 T and H modes
+	const s32 ETC2_DISTANCES[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+	//! Modifiers of EAC alpha blocks
+	const s32 EAC_MODIFIERS[16][8] =
+	{
+		{ -3, -6, -9, -15, 2, 5, 8, 14 },
+		{ -3, -7, -10, -13, 2, 6, 9, 12 },
+		{ -2, -5, -8, -13, 1, 4, 7, 12 },
+		{ -2, -4, -6, -13, 1, 3, 5, 12 },
+		{ -3, -6, -8, -12, 2, 5, 7, 11 },
+		{ -3, -7, -9, -11, 2, 6, 8, 10 },
+		{ -4, -7, -8, -11, 3, 6, 7, 10 },
+		{ -3, -5, -8, -11, 2, 4, 7, 10 },
+		{ -2, -6, -8, -10, 1, 5, 7, 9 },
+		{ -2, -5, -8, -10, 1, 4, 7, 9 },
+		{ -2, -4, -8, -10, 1, 3, 7, 9 },
+		{ -2, -5, -7, -10, 1, 4, 6, 9 },
+		{ -3, -4, -7, -10, 2, 3, 6, 9 },
+		{ -1, -2, -3, -10, 0, 1, 2, 9 },
+		{ -4, -6, -8, -9, 3, 5, 7, 8 },
+		{ -3, -5, -7, -9, 2, 4, 6, 8 }
+	};
+
+	inline s32 clampByte(s32 v)
+	{
+		return v < 0 ? 0 : v > 255 ? 255 : v;
+	}
+
+	inline u32 packColor(s32 a, s32 r, s32 g, s32 b)
+	{
+		return ((u32)clampByte(a) << 24) | ((u32)clampByte(r) << 16) | ((u32)clampByte(g) << 8) | (u32)clampByte(b);
+	}
+
+	inline u64 readBigEndian64(const u8* p)
+	{
+		u64 v = 0;
+		for (u32 i = 0; i < 8; ++i)
+			v = (v << 8) | p[i];
+		return v;
+	}
+
+	inline u32 getBlockSize(ECOLOR_FORMAT format)
+	{
+		return format == ECF_DXT1 || format == ECF_ETC1 || format == ECF_ETC2_RGB ? 8 : 16;
+	}
+
+	void decode565(u32 c, s32* rgb)
+	{
+		rgb[0] = (c >> 11) & 31;
+		rgb[1] = (c >> 5) & 63;
+		rgb[2] = c & 31;
+		rgb[0] = (rgb[0] << 3) | (rgb[0] >> 2);
+		rgb[1] = (rgb[1] << 2) | (rgb[1] >> 4);
+		rgb[2] = (rgb[2] << 3) | (rgb[2] >> 2);
+	}
+
+	//! Colors of a BC1 block, BC2 and BC3 always use the mode with four colors
+	void decodeBC1Colors(const u8* block, u32* pixels, bool fourColors)
+	{
+		const u32 c0 = block[0] | (block[1] << 8);
+		const u32 c1 = block[2] | (block[3] << 8);
+		s32 a[3], b[3];
+		decode565(c0, a);
+		decode565(c1, b);
+
+		u32 palette[4];
+		palette[0] = packColor(255, a[0], a[1], a[2]);
+		palette[1] = packColor(255, b[0], b[1], b[2]);
+		if (c0 > c1 || fourColors)
+		{
+			palette[2] = packColor(255, (2 * a[0] + b[0]) / 3, (2 * a[1] + b[1]) / 3, (2 * a[2] + b[2]) / 3);
+			palette[3] = packColor(255, (a[0] + 2 * b[0]) / 3, (a[1] + 2 * b[1]) / 3, (a[2] + 2 * b[2]) / 3);
+		}
+		else
+		{
+			palette[2] = packColor(255, (a[0] + b[0]) / 2, (a[1] + b[1]) / 2, (a[2] + b[2]) / 2);
+			palette[3] = 0;
+		}
+
+		const u32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((u32)block[7] << 24);
+		for (u32 i = 0; i < 16; ++i)
+			pixels[i] = palette[(indices >> (2 * i)) & 3];
+	}
+
+	void setAlpha(u32* pixels, const s32* alpha)
+	{
+		for (u32 i = 0; i < 16; ++i)
+			pixels[i] = (pixels[i] & 0x00FFFFFF) | ((u32)alpha[i] << 24);
+	}
+
+	void getBC3AlphaPalette(s32 a0, s32 a1, s32* palette)
+	{
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1)
+		{
+			for (s32 i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+		}
+		else
+		{
+			for (s32 i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	void decodeBC3Alpha(const u8* block, s32* alpha)
+	{
+		s32 palette[8];
+		getBC3AlphaPalette(block[0], block[1], palette);
+		u64 indices = 0;
+		for (u32 i = 0; i < 6; ++i)
+			indices |= (u64)block[2 + i] << (8 * i);
+		for (u32 i = 0; i < 16; ++i)
+			alpha[i] = palette[(indices >> (3 * i)) & 7];
+	}
+
+	//! Index of a pixel in ETC blocks, which store the pixels column by column
+	inline u32 getETCIndex(u32 indices, u32 x, u32 y)
+	{
+		const u32 k = x * 4 + y;
+		return (((indices >> (k + 16)) & 1) << 1) | ((indices >> k) & 1);
+	}
+
+	inline s32 extend4(s32 c) { return c * 17; }
+	inline s32 extend5(s32 c) { return (c << 3) | (c >> 2); }
+	inline s32 extend6(s32 c) { return (c << 2) | (c >> 4); }
+	inline s32 extend7(s32 c) { return (c << 1) | (c >> 6); }
+
+	//! Pixels of the ETC2 T and H modes, which pick one of four colors
+	void decodeETC2Paint(const s32 (*paint)[3], u32 indices, u32* pixels)
+	{
+		for (u32 y = 0; y < 4; ++y)
+		{
+			for (u32 x = 0; x < 4; ++x)
+			{
+				const s32* c = paint[getETCIndex(indices, x, y)];
+				pixels[y * 4 + x] = packColor(255, c[0], c[1], c[2]);
+			}
+		}
+	}
+
+	//! ETC1 block, or the opaque color block of ETC2 with its additional modes
+	void decodeETCColors(const u8* block, u32* pixels, bool etc2)
+	{
+		const u64 bits = readBigEndian64(block);
+		const u32 indices = (u32)bits;
+		s32 base[2][3];
+
+		if (!((bits >> 33) & 1))
+		{
+			// individual mode, two 4 bit colors
+			for (u32 c = 0; c < 3; ++c)
+			{
+				base[0][c] = extend4((bits >> (60 - 8 * c)) & 15);
+				base[1][c] = extend4((bits >> (56 - 8 * c)) & 15);
+			}
+		}
+		else
+		{
+			// differential mode, a 5 bit color and a 3 bit signed delta
+			s32 first[3], second[3];
+			for (u32 c = 0; c < 3; ++c)
+			{
+				first[c] = (bits >> (59 - 8 * c)) & 31;
+				const s32 delta = (bits >> (56 - 8 * c)) & 7;
+				second[c] = first[c] + (delta >= 4 ? delta - 8 : delta);
+			}
+
+			// ETC2 uses overflowing deltas for its other modes
+			if (etc2 && (second[0] < 0 || second[0] > 31))
+			{
+				s32 paint[4][3];
+				const s32 r1 = (s32)((((bits >> 59) & 3) << 2) | ((bits >> 56) & 3));
+				const s32 base1[3] = { extend4(r1), extend4((bits >> 52) & 15), extend4((bits >> 48) & 15) };
+				const s32 base2[3] = { extend4((bits >> 44) & 15), extend4((bits >> 40) & 15), extend4((bits >> 36) & 15) };
+				const s32 d = ETC2_DISTANCES[(((bits >> 34) & 3) << 1) | ((bits >> 32) & 1)];
+				for (u32 c = 0; c < 3; ++c)
+				{
+					paint[0][c] = base1[c];
+					paint[1][c] = base2[c] + d;
+					paint[2][c] = base2[c];
+					paint[3][c] = base2[c] - d;
+				}
+				decodeETC2Paint(paint, indices, pixels);
+				return;
+			}
+			if (etc2 && (second[1] < 0 || second[1] > 31))
+			{
+				s32 paint[4][3];
+				const s32 g1 = (s32)((((bits >> 56) & 7) << 1) | ((bits >> 52) & 1));
+				const s32 b1 = (s32)((((bits >> 51) & 1) << 3) | ((bits >> 47) & 7));
+				const s32 base1[3] = { extend4((bits >> 59) & 15), extend4(g1), extend4(b1) };
+				const s32 base2[3] = { extend4((bits >> 43) & 15), extend4((bits >> 39) & 15), extend4((bits >> 35) & 15) };
+				const u32 value1 = (base1[0] << 16) | (base1[1] << 8) | base1[2];
+				const u32 value2 = (base2[0] << 16) | (base2[1] << 8) | base2[2];
+				const s32 d = ETC2_DISTANCES[(((bits >> 34) & 1) << 2) | (((bits >> 32) & 1) << 1) | (value1 >= value2 ? 1 : 0)];
+				for (u32 c = 0; c < 3; ++c)
+				{
+					paint[0][c] = base1[c] + d;
+					paint[1][c] = base1[c] - d;
+					paint[2][c] = base2[c] + d;
+					paint[3][c] = base2[c] - d;
+				}
+				decodeETC2Paint(paint, indices, pixels);
+				return;
+			}
+			if (etc2 && (second[2] < 0 || second[2] > 31))
+			{
+				// planar mode, a gradient of three colors
+				const s32 o[3] = { extend6((bits >> 57) & 63),
+					extend7((s32)((((bits >> 56) & 1) << 6) | ((bits >> 49) & 63))),
+					extend6((s32)((((bits >> 48) & 1) << 5) | (((bits >> 43) & 3) << 3) | ((bits >> 39) & 7))) };
+				const s32 h[3] = { extend6((s32)((((bits >> 34) & 31) << 1) | ((bits >> 32) & 1))),
+					extend7((bits >> 25) & 127), extend6((bits >> 19) & 63) };
+				const s32 v[3] = { extend6((bits >> 13) & 63), extend7((bits >> 6) & 127), extend6(bits & 63) };
+				for (s32 y = 0; y < 4; ++y)
+				{
+					for (s32 x = 0; x < 4; ++x)
+					{
+						s32 c[3];
+						for (u32 i = 0; i < 3; ++i)
+							c[i] = (x * (h[i] - o[i]) + y * (v[i] - o[i]) + 4 * o[i] + 2) >> 2;
+						pixels[y * 4 + x] = packColor(255, c[0], c[1], c[2]);
+					}
+				}
+				return;
+			}
+
+			for (u32 c = 0; c < 3; ++c)
+			{
+				base[0][c] = extend5(first[c]);
+				base[1][c] = extend5(second[c] & 31);
+			}
+		}
+
+		const u32 tables[2] = { (u32)(bits >> 37) & 7, (u32)(bits >> 34) & 7 };
+		const bool flip = (bits >> 32) & 1;
+		for (u32 y = 0; y < 4; ++y)
+		{
+			for (u32 x = 0; x < 4; ++x)
+			{
+				// two subblocks of 2x4 pixels, or of 4x2 pixels when flipped
+				const u32 sub = flip ? (y >= 2) : (x >= 2);
+				const u32 index = getETCIndex(indices, x, y);
+				const s32 modifier = ETC1_MODIFIERS[tables[sub]][index & 1] * (index & 2 ? -1 : 1);
+				pixels[y * 4 + x] = packColor(255, base[sub][0] + modifier, base[sub][1] + modifier, base[sub][2] + modifier);
+			}
+		}
+	}
+
+	void decodeEACAlpha(const u8* block, s32* alpha)
+	{
+		const s32 base = block[0];
+		const s32 multiplier = block[1] >> 4;
+		const s32* modifiers = EAC_MODIFIERS[block[1] & 15];
+		u64 indices = 0;
+		for (u32 i = 2; i < 8; ++i)
+			indices = (indices << 8) | block[i];
+
+		for (u32 x = 0; x < 4; ++x)
+		{
+			for (u32 y = 0; y < 4; ++y)
+			{
+				const u32 k = x * 4 + y;
+				alpha[y * 4 + x] = clampByte(base + modifiers[(indices >> (45 - 3 * k)) & 7] * multiplier);
+			}
+		}
+	}
+
+	u32 to565(const f32* rgb)
+	{
+		const u32 r = (u32)core::clamp(rgb[0] * 31.f / 255.f + 0.5f, 0.f, 31.f);
+		const u32 g = (u32)core::clamp(rgb[1] * 63.f / 255.f + 0.5f, 0.f, 63.f);
+		const u32 b = (u32)core::clamp(rgb[2] * 31.f / 255.f + 0.5f, 0.f, 31.f);
+		return (r << 11) | (g << 5) | b;
+	}
+
+	//! BC1 colors from the end points along the main axis of the pixel colors
+	void encodeBC1Colors(const u32* pixels, u8* block)
+	{
+		f32 colors[16][3];
+		f32 mean[3] = { 0.f, 0.f, 0.f };
+		for (u32 i = 0; i < 16; ++i)
+		{
+			colors[i][0] = (f32)((pixels[i] >> 16) & 255);
+			colors[i][1] = (f32)((pixels[i] >> 8) & 255);
+			colors[i][2] = (f32)(pixels[i] & 255);
+			for (u32 c = 0; c < 3; ++c)
+				mean[c] += colors[i][c] / 16.f;
+		}
+
+		f32 covariance[6] = { 0.f, 0.f, 0.f, 0.f, 0.f, 0.f };
+		for (u32 i = 0; i < 16; ++i)
+		{
+			const f32 d[3] = { colors[i][0] - mean[0], colors[i][1] - mean[1], colors[i][2] - mean[2] };
+			covariance[0] += d[0] * d[0];
+			covariance[1] += d[0] * d[1];
+			covariance[2] += d[0] * d[2];
+			covariance[3] += d[1] * d[1];
+			covariance[4] += d[1] * d[2];
+			covariance[5] += d[2] * d[2];
+		}
+
+		// power iteration for the main axis
+		f32 axis[3] = { 1.f, 1.f, 1.f };
+		for (u32 n = 0; n < 4; ++n)
+		{
+			const f32 x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+			const f32 y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+			const f32 z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+			const f32 length = core::max_(core::abs_(x), core::abs_(y), core::abs_(z));
+			if (length < 1e-6f)
+				break;
+			axis[0] = x / length;
+			axis[1] = y / length;
+			axis[2] = z / length;
+		}
+
+		u32 minIndex = 0, maxIndex = 0;
+		f32 minDot = 0.f, maxDot = 0.f;
+		for (u32 i = 0; i < 16; ++i)
+		{
+			const f32 dot = colors[i][0] * axis[0] + colors[i][1] * axis[1] + colors[i][2] * axis[2];
+			if (i == 0 || dot < minDot)
+			{
+				minDot = dot;
+				minIndex = i;
+			}
+			if (i == 0 || dot > maxDot)
+			{
+				maxDot = dot;
+				maxIndex = i;
+			}
+		}
+
+		u32 c0 = to565(colors[maxIndex]);
+		u32 c1 = to565(colors[minIndex]);
+		if (c0 < c1)
+			core::swap(c0, c1);
+		block[0] = (u8)c0;
+		block[1] = (u8)(c0 >> 8);
+		block[2] = (u8)c1;
+		block[3] = (u8)(c1 >> 8);
+
+		// the nearest of the colors the decoder interpolates
+		s32 palette[4][3];
+		decode565(c0, palette[0]);
+		decode565(c1, palette[1]);
+		for (u32 c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		const u32 paletteSize = c0 > c1 ? 4 : 1;
+
+		u32 indices = 0;
+		for (u32 i = 0; i < 16; ++i)
+		{
+			u32 best = 0;
+			s32 bestError = 0x7fffffff;
+			for (u32 p = 0; p < paletteSize; ++p)
+			{
+				s32 error = 0;
+				for (u32 c = 0; c < 3; ++c)
+				{
+					const s32 d = (s32)colors[i][c] - palette[p][c];
+					error += d * d;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					best = p;
+				}
+			}
+			indices |= best << (2 * i);
+		}
+		block[4] = (u8)indices;
+		block[5] = (u8)(indices >> 8);
+		block[6] = (u8)(indices >> 16);
+		block[7] = (u8)(indices >> 24);
+	}
+
+	void encodeBC3Alpha(const u32* pixels, u8* block)
+	{
+		s32 minAlpha = 255, maxAlpha = 0;
+		for (u32 i = 0; i < 16; ++i)
+		{
+			const s32 a = pixels[i] >> 24;
+			minAlpha = core::min_(minAlpha, a);
+			maxAlpha = core::max_(maxAlpha, a);
+		}
+
+		block[0] = (u8)maxAlpha;
+		block[1] = (u8)minAlpha;
+		s32 palette[8];
+		getBC3AlphaPalette(maxAlpha, minAlpha, palette);
+
+		u64 indices = 0;
+		for (u32 i = 0; i < 16; ++i)
+		{
+			const s32 a = pixels[i] >> 24;
+			u32 best = 0;
+			for (u32 p = 1; p < 8; ++p)
+			{
+				if (core::abs_(palette[p] - a) < core::abs_(palette[best] - a))
+					best = p;
+			}
+			indices |= (u64)best << (3 * i);
+		}
+		for (u32 i = 0; i < 6; ++i)
+			block[2 + i] = (u8)(indices >> (8 * i));
+	}
+}
+
+
+//! Returns the format an image should be transcoded to
+ECOLOR_FORMAT CBlockTranscoder::getTarget(ECOLOR_FORMAT format, const IVideoDriver* driver)
+{
+	// the null driver keeps the images as they are
+	if (!driver || driver->getDriverType() == EDT_NULL || driver->queryTextureFormat(format))
+		return ECF_UNKNOWN;
+
+	switch (format)
+	{
+	case ECF_ETC1:
+	case ECF_ETC2_RGB:
+		return driver->queryTextureFormat(ECF_DXT1) ? ECF_DXT1 : ECF_A8R8G8B8;
+	case ECF_ETC2_ARGB:
+		return driver->queryTextureFormat(ECF_DXT5) ? ECF_DXT5 : ECF_A8R8G8B8;
+	case ECF_DXT1:
+	case ECF_DXT3:
+	case ECF_DXT5:
+		return ECF_A8R8G8B8;
+	default:
+		return ECF_UNKNOWN;
+	}
+}
+
+
+//! Transcodes an image of the given size, can be called on any thread
+bool CBlockTranscoder::transcode(ECOLOR_FORMAT format, const u8* in, ECOLOR_FORMAT target, u8* out,
+	const core::dimension2d<u32>& size)
+{
+	if (target != ECF_A8R8G8B8 && target != ECF_DXT1 && target != ECF_DXT5)
+		return false;
+
+	const u32 blocksX = (size.Width + 3) / 4;
+	const u32 blocksY = (size.Height + 3) / 4;
+	const u32 inBlockSize = getBlockSize(format);
+	u32 pixels[16];
+	for (u32 by = 0; by < blocksY; ++by)
+	{
+		for (u32 bx = 0; bx < blocksX; ++bx)
+		{
+			if (!decodeBlock(format, in, pixels))
+				return false;
+			in += inBlockSize;
+
+			if (target != ECF_A8R8G8B8)
+			{
+				// the blocks stay in place, with their pixels outside of the image
+				encodeBlock(target, pixels, out);
+				out += getBlockSize(target);
+				continue;
+			}
+
+			const u32 width = core::min_(4u, size.Width - bx * 4);
+			const u32 height = core::min_(4u, size.Height - by * 4);
+			for (u32 y = 0; y < height; ++y)
+				memcpy(out + ((by * 4 + y) * size.Width + bx * 4) * 4, pixels + y * 4, width * 4);
+		}
+	}
+	return true;
+}
+
+
+//! Decodes a block of 4x4 pixels to A8R8G8B8, rows of 4 pixels each
+bool CBlockTranscoder::decodeBlock(ECOLOR_FORMAT format, const u8* block, u32* pixels)
+{
+	s32 alpha[16];
+	switch (format)
+	{
+	case ECF_DXT1:
+		decodeBC1Colors(block, pixels, false);
+		return true;
+	case ECF_DXT3:
+		decodeBC1Colors(block + 8, pixels, true);
+		for (u32 i = 0; i < 16; ++i)
+			alpha[i] = ((block[i / 2] >> ((i & 1) * 4)) & 15) * 17;
+		setAlpha(pixels, alpha);
+		return true;
+	case ECF_DXT5:
+		decodeBC1Colors(block + 8, pixels, true);
+		decodeBC3Alpha(block, alpha);
+		setAlpha(pixels, alpha);
+		return true;
+	case ECF_ETC1:
+		decodeETCColors(block, pixels, false);
+		return true;
+	case ECF_ETC2_RGB:
+		decodeETCColors(block, pixels, true);
+		return true;
+	case ECF_ETC2_ARGB:
+		decodeETCColors(block + 8, pixels, true);
+		decodeEACAlpha(block, alpha);
+		setAlpha(pixels, alpha);
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+//! Encodes 4x4 pixels in A8R8G8B8 to a BC1 or BC3 block
+void CBlockTranscoder::encodeBlock(ECOLOR_FORMAT format, const u32* pixels, u8* block)
+{
+	if (format == ECF_DXT5)
+	{
+		encodeBC3Alpha(pixels, block);
+		block += 8;
+	}
+	encodeBC1Colors(pixels, block);
+}
+
+} // end namespace video
+} // end namespace irr
@@ -0,0 +1,47 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_BLOCK_TRANSCODER_H_INCLUDED__
+#define __C_BLOCK_TRANSCODER_H_INCLUDED__
+
+#include "IImage.h"
+
+namespace irr
+{
+namespace video
+{
+
+class IVideoDriver;
+
+//! Converts block compressed images to formats the driver supports
+/** Assets can be shipped once, for example as ETC2 for mobile GPUs, and
+are transcoded when they are loaded on GPUs without that format. BC1-3,
+ETC1 and ETC2 blocks can be decoded, BC1 and BC3 blocks encoded. Formats
+which can't be encoded are decoded to A8R8G8B8. */
+class CBlockTranscoder
+{
+public:
+
+	//! Returns the format an image should be transcoded to
+	/** \return ECF_UNKNOWN if the driver supports the format, or if it
+	can't be transcoded. */
+	static ECOLOR_FORMAT getTarget(ECOLOR_FORMAT format, const IVideoDriver* driver);
+
+	//! Transcodes an image of the given size, can be called on any thread
+	/** \param in Blocks of the source format.
+	\param out Receives the image in the target format returned by getTarget().
+	\return False if the formats can't be converted. */
+	static bool transcode(ECOLOR_FORMAT format, const u8* in, ECOLOR_FORMAT target, u8* out,
+		const core::dimension2d<u32>& size);
+
+	//! Decodes a block of 4x4 pixels to A8R8G8B8, rows of 4 pixels each
+	static bool decodeBlock(ECOLOR_FORMAT format, const u8* block, u32* pixels);
+
+	//! Encodes 4x4 pixels in A8R8G8B8 to a BC1 or BC3 block
+	static void encodeBlock(ECOLOR_FORMAT format, const u32* pixels, u8* block);
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -8,16 +8,21 @@
 // Used with SkinnedMesh and IAnimatedMeshSceneNode, for boned meshes
 
 #include "IBoneSceneNode.h"
+#include "CSceneNodePool.h"
 
 namespace irr
 {
 namespace scene
 {
 
-	class CBoneSceneNode : public IBoneSceneNode
+	class CBoneSceneNode : public IBoneSceneNode, public CSceneNodePoolAllocated<CBoneSceneNode>
 	{
 	public:
 
+		//! the pool takes precedence over the operators of ISceneNode
+		using CSceneNodePoolAllocated<CBoneSceneNode>::operator new;
+		using CSceneNodePoolAllocated<CBoneSceneNode>::operator delete;
+
 		//! constructor
 		CBoneSceneNode(ISceneNode* parent, ISceneManager* mgr,
 			s32 id=-1, u32 boneIndex=0, const c8* boneName=0);
@@ -19,8 +19,8 @@ CCameraSceneNode::CCameraSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 i
 	: ICameraSceneNode(parent, mgr, id, position),
 	BoundingBox(core::vector3df(0, 0, 0)),	// Camera has no size. Still not sure if FLT_MAX might be the better variant
 	Target(lookat), UpVector(0.0f, 1.0f, 0.0f), ZNear(1.0f), ZFar(3000.0f),
-	InputReceiverEnabled(true), TargetAndRotationAreBound(false),
-	HasD3DStyleProjectionMatrix(true)
+	ViewDirty(true), InputReceiverEnabled(true), TargetAndRotationAreBound(false),
+	HasD3DStyleProjectionMatrix(true), ReverseDepth(false), InfiniteFarPlane(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CCameraSceneNode");
@@ -67,6 +67,7 @@ void CCameraSceneNode::setProjectionMatrix(const core::matrix4& projection, bool
 {
 	IsOrthogonal = isOrthogonal;
 	ViewArea.getTransform ( video::ETS_PROJECTION ) = projection;
+	ViewDirty = true;
 }
 
 
@@ -93,6 +94,7 @@ const core::matrix4& CCameraSceneNode::getViewMatrix() const
 void CCameraSceneNode::setViewMatrixAffector(const core::matrix4& affector)
 {
 	Affector = affector;
+	ViewDirty = true;
 }
 
 
@@ -120,6 +122,7 @@ bool CCameraSceneNode::OnEvent(const SEvent& event)
 void CCameraSceneNode::setTarget(const core::vector3df& pos)
 {
 	Target = pos;
+	ViewDirty = true;
 
 	if(TargetAndRotationAreBound)
 	{
@@ -137,7 +140,10 @@ then calling this will also change the camera's target to match the rotation.
 void CCameraSceneNode::setRotation(const core::vector3df& rotation)
 {
 	if(TargetAndRotationAreBound)
+	{
 		Target = getAbsolutePosition() + rotation.rotationToDirection();
+		ViewDirty = true;
+	}
 
 	ISceneNode::setRotation(rotation);
 }
@@ -156,6 +162,7 @@ const core::vector3df& CCameraSceneNode::getTarget() const
 void CCameraSceneNode::setUpVector(const core::vector3df& pos)
 {
 	UpVector = pos;
+	ViewDirty = true;
 }
 
 
@@ -221,10 +228,48 @@ void CCameraSceneNode::setFOV(f32 f)
 }
 
 
+void CCameraSceneNode::setReverseDepth(bool reverse)
+{
+	ReverseDepth = reverse;
+	recalculateProjectionMatrix();
+}
+
+
+bool CCameraSceneNode::isReverseDepth() const
+{
+	return ReverseDepth;
+}
+
+
+void CCameraSceneNode::setInfiniteFarPlane(bool infinite)
+{
+	InfiniteFarPlane = infinite;
+	recalculateProjectionMatrix();
+}
+
+
+bool CCameraSceneNode::isInfiniteFarPlane() const
+{
+	return InfiniteFarPlane;
+}
+
+
 void CCameraSceneNode::recalculateProjectionMatrix()
 {
-	ViewArea.getTransform ( video::ETS_PROJECTION ).buildProjectionMatrixPerspectiveFovLH(Fovy, Aspect, ZNear, ZFar, HasD3DStyleProjectionMatrix);
+	core::matrix4& projection = ViewArea.getTransform ( video::ETS_PROJECTION );
+	if ( InfiniteFarPlane )
+		projection.buildProjectionMatrixPerspectiveFovInfinityLH(Fovy, Aspect, ZNear, 0.f, HasD3DStyleProjectionMatrix);
+	else
+		projection.buildProjectionMatrixPerspectiveFovLH(Fovy, Aspect, ZNear, ZFar, HasD3DStyleProjectionMatrix);
+
+	if ( ReverseDepth )
+	{
+		// z' = w - z maps 0..w to w..0, z' = -z maps -w..w to w..-w
+		for ( u32 i = 2; i < 16; i += 4 )
+			projection[i] = HasD3DStyleProjectionMatrix ? projection[i+1] - projection[i] : -projection[i];
+	}
 	IsOrthogonal = false;
+	ViewDirty = true;
 }
 
 
@@ -246,6 +291,12 @@ void CCameraSceneNode::render()
 	video::IVideoDriver* driver = SceneManager->getVideoDriver();
 	if ( driver)
 	{
+		if ( driver->isReverseDepth() != ReverseDepth )
+		{
+			// depth values written so far are meaningless with the other depth direction
+			driver->setReverseDepth(ReverseDepth);
+			driver->clearBuffers(video::ECBF_DEPTH);
+		}
 		driver->setTransform(video::ETS_PROJECTION, ViewArea.getTransform ( video::ETS_PROJECTION) );
 		driver->setTransform(video::ETS_VIEW, ViewArea.getTransform ( video::ETS_VIEW) );
 	}
@@ -254,7 +305,14 @@ void CCameraSceneNode::render()
 //! update
 void CCameraSceneNode::updateMatrices()
 {
-	core::vector3df pos = getAbsolutePosition();
+	// the position can change through the parents without the camera
+	// noticing, so it's compared instead of tracked
+	const core::vector3df pos = getAbsolutePosition();
+	if ( !ViewDirty && pos.X == ViewPosition.X && pos.Y == ViewPosition.Y && pos.Z == ViewPosition.Z )
+		return;
+	ViewDirty = false;
+	ViewPosition = pos;
+
 	core::vector3df tgtv = Target - pos;
 	tgtv.normalize();
 
@@ -293,10 +351,19 @@ void CCameraSceneNode::recalculateViewArea()
 {
 	ViewArea.cameraPosition = getAbsolutePosition();
 
-	core::matrix4 m(core::matrix4::EM4CONST_NOTHING);
-	m.setbyproduct_nocheck(ViewArea.getTransform(video::ETS_PROJECTION),
+	ViewProjection.setbyproduct_nocheck(ViewArea.getTransform(video::ETS_PROJECTION),
 						ViewArea.getTransform(video::ETS_VIEW));
-	ViewArea.setFrom(m, HasD3DStyleProjectionMatrix);
+	ViewArea.setFrom(ViewProjection, HasD3DStyleProjectionMatrix, ReverseDepth);
+
+	if ( InfiniteFarPlane )
+	{
+		// the projection doesn't clip in the distance, still cull at the far value
+		const core::matrix4& view = ViewArea.getTransform(video::ETS_VIEW);
+		core::vector3df forward(view[2], view[6], view[10]);
+		forward.normalize();
+		ViewArea.planes[SViewFrustum::VF_FAR_PLANE].setPlane(ViewArea.cameraPosition + forward * ZFar, forward);
+		ViewArea.recalculateBoundingBox();
+	}
 }
 
 
@@ -337,9 +404,12 @@ ISceneNode* CCameraSceneNode::clone(ISceneNode* newParent, ISceneManager* newMan
 	nb->ZNear = ZNear;
 	nb->ZFar = ZFar;
 	nb->ViewArea = ViewArea;
+	nb->ViewProjection = ViewProjection;
 	nb->Affector = Affector;
 	nb->InputReceiverEnabled = InputReceiverEnabled;
 	nb->TargetAndRotationAreBound = TargetAndRotationAreBound;
+	nb->ReverseDepth = ReverseDepth;
+	nb->InfiniteFarPlane = InfiniteFarPlane;
 
 	if ( newParent )
 		nb->drop();
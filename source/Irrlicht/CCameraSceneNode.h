@@ -40,6 +40,9 @@ namespace scene
 		//! \return Returns the current view matrix of the camera.
 		const core::matrix4& getViewMatrix() const override;
 
+		//! Gets the product of the projection and the view matrix
+		const core::matrix4& getViewProjectionMatrix() const override { return ViewProjection; }
+
 		//! Sets a custom view matrix affector.
 		/** \param affector: The affector matrix. */
 		void setViewMatrixAffector(const core::matrix4& affector) override;
@@ -107,6 +110,18 @@ namespace scene
 		//! Sets the field of view (Default: PI / 3.5f)
 		void setFOV(f32 fovy) override;
 
+		//! Renders with reversed depth (default: false)
+		void setReverseDepth(bool reverse) override;
+
+		//! Checks if the camera renders with reversed depth.
+		bool isReverseDepth() const override;
+
+		//! Moves the far plane of the projection to infinity (default: false)
+		void setInfiniteFarPlane(bool infinite) override;
+
+		//! Checks if the projection has its far plane at infinity.
+		bool isInfiniteFarPlane() const override;
+
 		//! PreRender event
 		void OnRegisterSceneNode() override;
 
@@ -160,10 +175,21 @@ namespace scene
 		SViewFrustum ViewArea;
 		core::matrix4 Affector;
 
+		//! Projection times view, updated with ViewArea
+		core::matrix4 ViewProjection;
+
+		//! The absolute position the view was built at
+		core::vector3df ViewPosition;
+
+		//! The view or the projection changed since the last updateMatrices()
+		bool ViewDirty;
+
 		bool InputReceiverEnabled;
 		bool TargetAndRotationAreBound;
 
 		bool HasD3DStyleProjectionMatrix;	// true: projection from 0 to w; false: -w to w
+		bool ReverseDepth;	// near plane at w, far plane at 0 (or -w)
+		bool InfiniteFarPlane;
 	};
 
 } // end namespace
@@ -0,0 +1,550 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CChunkGridSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "SViewFrustum.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! Chunks per region along each axis
+	const s32 REGION_SIZE = 8;
+
+	s32 regionCoordinate(s32 chunk)
+	{
+		// rounded down, so the regions don't stretch over the origin
+		return (chunk < 0 ? chunk - (REGION_SIZE - 1) : chunk) / REGION_SIZE;
+	}
+}
+
+
+//! constructor
+CChunkGridSceneNode::CChunkGridSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IChunkGridSceneNode(parent, mgr, id, position, rotation, scale),
+	BoxDirty(true), PassCount(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CChunkGridSceneNode");
+	#endif
+}
+
+
+//! destructor
+CChunkGridSceneNode::~CChunkGridSceneNode()
+{
+	for (u32 i=0; i<Chunks.size(); ++i)
+		Chunks[i].Mesh->drop();
+}
+
+
+//! frame
+void CChunkGridSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && !Chunks.empty())
+	{
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+		PassCount = 0;
+		int transparentCount = 0;
+		int solidCount = 0;
+
+		// casters are registered even when culled, their shadows may still be visible
+		SceneManager->registerNodeForRendering(this, scene::ESNRP_SHADOW);
+
+		MaterialTransparent.set_used(Materials.size());
+		for (u32 i=0; i<Materials.size(); ++i)
+		{
+			MaterialTransparent[i] = driver->needsTransparentRenderPass(Materials[i]) ? 1 : 0;
+			if (MaterialTransparent[i])
+				++transparentCount;
+			else
+				++solidCount;
+		}
+
+		if (solidCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (transparentCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! renders the node.
+void CChunkGridSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!driver || MaterialTransparent.size() != Materials.size())
+		return;
+
+	const E_SCENE_NODE_RENDER_PASS pass = SceneManager->getSceneNodeRenderPass();
+
+	// each shadow cascade has its own view, culled against the one it set
+	if (pass == scene::ESNRP_SHADOW)
+	{
+		cullChunks(driver, CasterChunks);
+		if (!CasterChunks.empty())
+			drawChunks(driver, CasterChunks, false);
+		return;
+	}
+
+	// the camera doesn't move between the passes of a frame
+	if (PassCount == 0)
+		cullChunks(driver, VisibleChunks);
+	// the depth pre-pass draws the solid buffers once more, without debug data
+	if (pass != scene::ESNRP_DEPTH_PREPASS)
+		++PassCount;
+
+	if (VisibleChunks.empty())
+		return;
+
+	drawChunks(driver, VisibleChunks, pass == scene::ESNRP_TRANSPARENT);
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+		driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(getBoundingBox(), video::SColor(255,255,255,255));
+		}
+
+		if (DebugDataVisible & scene::EDS_BBOX_BUFFERS)
+		{
+			for (u32 i=0; i<VisibleChunks.size(); ++i)
+				driver->draw3DBox(Chunks[VisibleChunks[i]].Box, video::SColor(255,190,128,128));
+		}
+	}
+}
+
+
+void CChunkGridSceneNode::cullChunks(video::IVideoDriver* driver, core::array<u32>& out)
+{
+	out.set_used(0);
+
+	if (AutomaticCullingState == EAC_OFF)
+	{
+		for (u32 i=0; i<Chunks.size(); ++i)
+			out.push_back(i);
+		return;
+	}
+
+	// the frustum in node space, so the boxes don't need a transformation.
+	// Depth from -1 is the larger volume for either depth convention.
+	core::matrix4 viewProjection(driver->getTransform(video::ETS_PROJECTION));
+	viewProjection *= driver->getTransform(video::ETS_VIEW);
+	viewProjection *= AbsoluteTransformation;
+	const SPackedFrustum frustum(SViewFrustum(viewProjection, false, driver->isReverseDepth()));
+
+	// regions first, in one batch
+	const u32 regionCount = Regions.size();
+	CullBoxes.set_used(regionCount);
+	for (u32 i=0; i<regionCount; ++i)
+	{
+		SRegion& region = Regions[i];
+		if (region.BoxDirty)
+		{
+			region.Empty = true;
+			for (u32 k=0; k<region.Chunks.size(); ++k)
+			{
+				const SChunk& chunk = Chunks[region.Chunks[k]];
+				if (chunk.BufferMaterials.empty())
+					continue;
+				if (region.Empty)
+					region.Box = chunk.Box;
+				else
+					region.Box.addInternalBox(chunk.Box);
+				region.Empty = false;
+			}
+			region.BoxDirty = false;
+		}
+		CullBoxes[i] = region.Box;
+	}
+	CullRelations.set_used(regionCount);
+	frustum.classifyBoxes(CullBoxes.const_pointer(), regionCount, CullRelations.pointer());
+
+	// chunks of regions completely inside are visible, those of cut regions are tested one by one.
+	// Drivers culling batches on the GPU test them on their own, also against occluders.
+	const bool gpuCulling = driver->queryFeature(video::EVDF_GPU_CULLING);
+	CullChunks.set_used(0);
+	for (u32 i=0; i<regionCount; ++i)
+	{
+		const SRegion& region = Regions[i];
+		if (region.Empty || CullRelations[i] == core::ISREL3D_FRONT)
+			continue;
+
+		if (CullRelations[i] == core::ISREL3D_BACK || gpuCulling)
+		{
+			for (u32 k=0; k<region.Chunks.size(); ++k)
+				out.push_back(region.Chunks[k]);
+		}
+		else
+		{
+			for (u32 k=0; k<region.Chunks.size(); ++k)
+				CullChunks.push_back(region.Chunks[k]);
+		}
+	}
+
+	const u32 count = CullChunks.size();
+	CullBoxes.set_used(count);
+	for (u32 i=0; i<count; ++i)
+		CullBoxes[i] = Chunks[CullChunks[i]].Box;
+	CullRelations.set_used(count);
+	frustum.classifyBoxes(CullBoxes.const_pointer(), count, CullRelations.pointer());
+
+	for (u32 i=0; i<count; ++i)
+	{
+		if (CullRelations[i] != core::ISREL3D_FRONT)
+			out.push_back(CullChunks[i]);
+	}
+}
+
+
+void CChunkGridSceneNode::drawChunks(video::IVideoDriver* driver, const core::array<u32>& chunks, bool transparent)
+{
+	const u32 materialCount = Materials.size();
+
+	// sort the buffers of the pass by material, counting them first
+	MaterialOffsets.set_used(materialCount + 1);
+	for (u32 i=0; i<=materialCount; ++i)
+		MaterialOffsets[i] = 0;
+
+	for (u32 i=0; i<chunks.size(); ++i)
+	{
+		const core::array<u32>& materials = Chunks[chunks[i]].BufferMaterials;
+		for (u32 b=0; b<materials.size(); ++b)
+		{
+			if ((MaterialTransparent[materials[b]] != 0) == transparent)
+				++MaterialOffsets[materials[b] + 1];
+		}
+	}
+
+	u32 largestBatch = 0;
+	for (u32 i=0; i<materialCount; ++i)
+	{
+		largestBatch = core::max_(largestBatch, MaterialOffsets[i + 1]);
+		MaterialOffsets[i + 1] += MaterialOffsets[i];
+	}
+
+	if (MaterialOffsets[materialCount] == 0)
+		return;
+
+	// afterwards each offset is the end of its material and the start of the next one
+	DrawBuffers.set_used(MaterialOffsets[materialCount]);
+	for (u32 i=0; i<chunks.size(); ++i)
+	{
+		const SChunk& chunk = Chunks[chunks[i]];
+		for (u32 b=0; b<chunk.BufferMaterials.size(); ++b)
+		{
+			const u32 material = chunk.BufferMaterials[b];
+			if ((MaterialTransparent[material] != 0) == transparent)
+				DrawBuffers[MaterialOffsets[material]++] = chunk.Mesh->getMeshBuffer(b);
+		}
+	}
+
+	// all chunks share the transformation of the node
+	if (DrawMatrices.size() < largestBatch || (!DrawMatrices.empty() && DrawMatrices[0] != AbsoluteTransformation))
+	{
+		DrawMatrices.set_used(core::max_(largestBatch, DrawMatrices.size()));
+		for (u32 i=0; i<DrawMatrices.size(); ++i)
+			DrawMatrices[i] = AbsoluteTransformation;
+	}
+
+	u32 begin = 0;
+	for (u32 i=0; i<materialCount; ++i)
+	{
+		const u32 end = MaterialOffsets[i];
+		if (end != begin)
+		{
+			driver->setMaterial(Materials[i]);
+			driver->drawMeshBufferBatch(DrawBuffers.const_pointer() + begin, DrawMatrices.const_pointer(), end - begin);
+		}
+		begin = end;
+	}
+}
+
+
+//! returns the axis aligned bounding box enclosing all chunks
+const core::aabbox3d<f32>& CChunkGridSceneNode::getBoundingBox() const
+{
+	if (BoxDirty)
+	{
+		bool empty = true;
+		Box.reset(0,0,0);
+		for (u32 i=0; i<Chunks.size(); ++i)
+		{
+			if (Chunks[i].BufferMaterials.empty())
+				continue;
+			if (empty)
+				Box = Chunks[i].Box;
+			else
+				Box.addInternalBox(Chunks[i].Box);
+			empty = false;
+		}
+		BoxDirty = false;
+	}
+	return Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CChunkGridSceneNode::getMaterial(u32 i)
+{
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+u64 CChunkGridSceneNode::makeKey(const core::vector3di& position)
+{
+	return ((u64)(position.X & 0x1fffff) << 42) | ((u64)(position.Y & 0x1fffff) << 21) | (u64)(position.Z & 0x1fffff);
+}
+
+
+u32 CChunkGridSceneNode::findMaterial(const video::SMaterial& material)
+{
+	for (u32 i=0; i<Materials.size(); ++i)
+	{
+		if (Materials[i] == material)
+			return i;
+	}
+
+	Materials.push_back(material);
+	return Materials.size() - 1;
+}
+
+
+void CChunkGridSceneNode::readChunkBuffers(SChunk& chunk)
+{
+	// static buffers, so drivers with buffer arenas pack the chunks together
+	chunk.Mesh->setHardwareMappingHint(EHM_STATIC);
+
+	const u32 count = chunk.Mesh->getMeshBufferCount();
+	chunk.BufferMaterials.set_used(count);
+	for (u32 i=0; i<count; ++i)
+	{
+		const IMeshBuffer* mb = chunk.Mesh->getMeshBuffer(i);
+		chunk.BufferMaterials[i] = findMaterial(mb->getMaterial());
+		if (i == 0)
+			chunk.Box = mb->getBoundingBox();
+		else
+			chunk.Box.addInternalBox(mb->getBoundingBox());
+	}
+}
+
+
+void CChunkGridSceneNode::releaseMesh(IMesh* mesh)
+{
+	// streamed out chunks give their buffers back right away, instead of when the driver notices
+	if (mesh->getReferenceCount() == 1)
+	{
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+		for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
+			driver->removeHardwareBuffer(mesh->getMeshBuffer(i));
+	}
+	mesh->drop();
+}
+
+
+void CChunkGridSceneNode::addChunkToRegion(u32 index)
+{
+	SChunk& chunk = Chunks[index];
+	const u64 key = makeKey(core::vector3di(regionCoordinate(chunk.Position.X),
+		regionCoordinate(chunk.Position.Y), regionCoordinate(chunk.Position.Z)));
+
+	std::unordered_map<u64, u32>::const_iterator it = RegionIndices.find(key);
+	if (it == RegionIndices.end())
+	{
+		SRegion region;
+		region.Key = key;
+		region.BoxDirty = true;
+		region.Empty = true;
+		Regions.push_back(region);
+		it = RegionIndices.insert(std::make_pair(key, Regions.size() - 1)).first;
+	}
+
+	SRegion& region = Regions[it->second];
+	chunk.Region = it->second;
+	chunk.RegionSlot = region.Chunks.size();
+	region.Chunks.push_back(index);
+	region.BoxDirty = true;
+}
+
+
+void CChunkGridSceneNode::removeChunkFromRegion(u32 index)
+{
+	const u32 regionIndex = Chunks[index].Region;
+	const u32 slot = Chunks[index].RegionSlot;
+	SRegion& region = Regions[regionIndex];
+
+	const u32 lastSlot = region.Chunks.size() - 1;
+	if (slot != lastSlot)
+	{
+		region.Chunks[slot] = region.Chunks[lastSlot];
+		Chunks[region.Chunks[slot]].RegionSlot = slot;
+	}
+	region.Chunks.erase(lastSlot);
+	region.BoxDirty = true;
+
+	if (!region.Chunks.empty())
+		return;
+
+	// the last region takes the place of the empty one
+	RegionIndices.erase(region.Key);
+	const u32 lastRegion = Regions.size() - 1;
+	if (regionIndex != lastRegion)
+	{
+		Regions[regionIndex] = Regions[lastRegion];
+		RegionIndices[Regions[regionIndex].Key] = regionIndex;
+		for (u32 i=0; i<Regions[regionIndex].Chunks.size(); ++i)
+			Chunks[Regions[regionIndex].Chunks[i]].Region = regionIndex;
+	}
+	Regions.erase(lastRegion);
+}
+
+
+//! Sets the mesh of a chunk
+void CChunkGridSceneNode::setChunk(const core::vector3di& position, IMesh* mesh)
+{
+	const u64 key = makeKey(position);
+	std::unordered_map<u64, u32>::iterator it = ChunkIndices.find(key);
+
+	if (it == ChunkIndices.end())
+	{
+		if (!mesh)
+			return;
+
+		mesh->grab();
+		SChunk chunk;
+		chunk.Position = position;
+		chunk.Mesh = mesh;
+		chunk.Region = 0;
+		chunk.RegionSlot = 0;
+		Chunks.push_back(chunk);
+		readChunkBuffers(Chunks.getLast());
+		ChunkIndices[key] = Chunks.size() - 1;
+		addChunkToRegion(Chunks.size() - 1);
+	}
+	else if (mesh)
+	{
+		SChunk& chunk = Chunks[it->second];
+		mesh->grab();
+		releaseMesh(chunk.Mesh);
+		chunk.Mesh = mesh;
+		readChunkBuffers(chunk);
+		Regions[chunk.Region].BoxDirty = true;
+	}
+	else
+	{
+		// the last chunk takes the place of the removed one
+		const u32 index = it->second;
+		removeChunkFromRegion(index);
+		releaseMesh(Chunks[index].Mesh);
+		ChunkIndices.erase(it);
+
+		const u32 last = Chunks.size() - 1;
+		if (index != last)
+		{
+			Chunks[index] = Chunks[last];
+			ChunkIndices[makeKey(Chunks[index].Position)] = index;
+			Regions[Chunks[index].Region].Chunks[Chunks[index].RegionSlot] = index;
+		}
+		Chunks.erase(last);
+	}
+
+	// the visible lists hold chunk indices, which may have moved
+	VisibleChunks.set_used(0);
+	CasterChunks.set_used(0);
+	BoxDirty = true;
+	updateSpatialIndex();
+}
+
+
+//! Returns the mesh of a chunk, or 0 if there is none
+IMesh* CChunkGridSceneNode::getChunk(const core::vector3di& position) const
+{
+	std::unordered_map<u64, u32>::const_iterator it = ChunkIndices.find(makeKey(position));
+	return it != ChunkIndices.end() ? Chunks[it->second].Mesh : 0;
+}
+
+
+//! Uploads the changed mesh buffers of a chunk again
+void CChunkGridSceneNode::updateChunk(const core::vector3di& position)
+{
+	std::unordered_map<u64, u32>::const_iterator it = ChunkIndices.find(makeKey(position));
+	if (it == ChunkIndices.end())
+		return;
+
+	SChunk& chunk = Chunks[it->second];
+	chunk.Mesh->setDirty();
+	readChunkBuffers(chunk);
+	Regions[chunk.Region].BoxDirty = true;
+	BoxDirty = true;
+	updateSpatialIndex();
+}
+
+
+//! Removes all chunks
+void CChunkGridSceneNode::clearChunks()
+{
+	for (u32 i=0; i<Chunks.size(); ++i)
+		releaseMesh(Chunks[i].Mesh);
+
+	// the materials stay, so chunks streamed in again find theirs
+	Chunks.clear();
+	ChunkIndices.clear();
+	Regions.clear();
+	RegionIndices.clear();
+	VisibleChunks.clear();
+	CasterChunks.clear();
+	BoxDirty = true;
+	updateSpatialIndex();
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CChunkGridSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CChunkGridSceneNode* nb = new CChunkGridSceneNode(newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->Chunks = Chunks;
+	nb->ChunkIndices = ChunkIndices;
+	nb->Regions = Regions;
+	nb->RegionIndices = RegionIndices;
+	nb->Materials = Materials;
+	for (u32 i=0; i<Chunks.size(); ++i)
+		Chunks[i].Mesh->grab();
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,153 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_CHUNK_GRID_SCENE_NODE_H_INCLUDED__
+#define __C_CHUNK_GRID_SCENE_NODE_H_INCLUDED__
+
+#include "IChunkGridSceneNode.h"
+#include "IMesh.h"
+#include <unordered_map>
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+} // end namespace video
+
+namespace scene
+{
+
+	class CChunkGridSceneNode : public IChunkGridSceneNode
+	{
+	public:
+
+		//! constructor
+		CChunkGridSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CChunkGridSceneNode();
+
+		//! frame
+		void OnRegisterSceneNode() override;
+
+		//! renders the node.
+		void render() override;
+
+		//! returns the axis aligned bounding box enclosing all chunks
+		const core::aabbox3d<f32>& getBoundingBox() const override;
+
+		//! returns the material based on the zero based index i.
+		video::SMaterial& getMaterial(u32 i) override;
+
+		//! returns amount of materials used by this scene node.
+		u32 getMaterialCount() const override { return Materials.size(); }
+
+		//! Returns type of the scene node
+		ESCENE_NODE_TYPE getType() const override { return ESNT_CHUNK_GRID; }
+
+		//! Sets the mesh of a chunk
+		void setChunk(const core::vector3di& position, IMesh* mesh) override;
+
+		//! Returns the mesh of a chunk, or 0 if there is none
+		IMesh* getChunk(const core::vector3di& position) const override;
+
+		//! Uploads the changed mesh buffers of a chunk again
+		void updateChunk(const core::vector3di& position) override;
+
+		//! Removes a chunk
+		void removeChunk(const core::vector3di& position) override { setChunk(position, 0); }
+
+		//! Removes all chunks
+		void clearChunks() override;
+
+		//! Get the number of chunks
+		u32 getChunkCount() const override { return Chunks.size(); }
+
+		//! Get the number of chunks which passed culling in the last rendered frame
+		u32 getVisibleChunkCount() const override { return VisibleChunks.size(); }
+
+		//! Creates a clone of this scene node and its children.
+		ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) override;
+
+	protected:
+
+		struct SChunk
+		{
+			core::vector3di Position;
+			IMesh* Mesh;
+			//! Union of the buffer boxes, relative to the node
+			core::aabbox3d<f32> Box;
+			//! Index into Materials for each mesh buffer
+			core::array<u32> BufferMaterials;
+			u32 Region;
+			//! Index of the chunk in the list of its region
+			u32 RegionSlot;
+		};
+
+		//! 8x8x8 chunks, culled as a whole unless the frustum cuts them
+		struct SRegion
+		{
+			u64 Key;
+			core::array<u32> Chunks;
+			core::aabbox3d<f32> Box;
+			bool BoxDirty;
+			//! No chunk of the region has a mesh buffer
+			bool Empty;
+		};
+
+		//! Packs a grid position into a key of the chunk or region maps
+		static u64 makeKey(const core::vector3di& position);
+
+		//! Takes the box and materials of the mesh buffers of a chunk
+		void readChunkBuffers(SChunk& chunk);
+
+		//! Returns the index of a material in Materials, adding it if it isn't there yet
+		u32 findMaterial(const video::SMaterial& material);
+
+		//! Drops a chunk mesh, freeing its hardware buffers if nobody else holds it
+		void releaseMesh(IMesh* mesh);
+
+		void addChunkToRegion(u32 index);
+		void removeChunkFromRegion(u32 index);
+
+		//! Collects the chunks inside the frustum of the current view and projection of the driver
+		void cullChunks(video::IVideoDriver* driver, core::array<u32>& out);
+
+		//! Draws the buffers of the solid or the transparent materials, one batch per material
+		void drawChunks(video::IVideoDriver* driver, const core::array<u32>& chunks, bool transparent);
+
+		core::array<SChunk> Chunks;
+		std::unordered_map<u64, u32> ChunkIndices;
+
+		core::array<SRegion> Regions;
+		std::unordered_map<u64, u32> RegionIndices;
+
+		core::array<video::SMaterial> Materials;
+		//! Which pass each material is drawn in, updated on registration
+		core::array<u8> MaterialTransparent;
+
+		core::array<u32> VisibleChunks;
+		core::array<u32> CasterChunks;
+
+		//! Culling and drawing scratch space, kept for reuse
+		core::array<core::aabbox3d<f32> > CullBoxes;
+		core::array<u32> CullChunks;
+		core::array<core::EIntersectionRelation3D> CullRelations;
+		core::array<u32> MaterialOffsets;
+		core::array<const IMeshBuffer*> DrawBuffers;
+		core::array<core::matrix4> DrawMatrices;
+
+		mutable core::aabbox3d<f32> Box;
+		mutable bool BoxDirty;
+
+		s32 PassCount;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -7,11 +7,203 @@
 #include "os.h"
 #include "irrString.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _IRR_COLOR_SSE2_
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define _IRR_COLOR_SSSE3_
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define _IRR_COLOR_NEON_
+#endif
+
 namespace irr
 {
 namespace video
 {
 
+namespace
+{
+	// The kernels convert the pixels they can do in whole vectors and return
+	// how many that were, the scalar loops of the callers do the rest.
+	// 24 bit kernels load and store 16 bytes per 4 pixels, so they stop
+	// early enough to stay within the arrays.
+
+	//! Swaps the bytes 0 and 2 of each 32 bit pixel
+	s32 swapRedBlue32(const u8* in, u8* out, s32 count)
+	{
+		s32 x = 0;
+#if defined(_IRR_COLOR_SSE2_)
+		const __m128i ag = _mm_set1_epi32((int)0xff00ff00);
+		const __m128i low = _mm_set1_epi32(0xff);
+		for (; x + 4 <= count; x += 4)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(in + x * 4));
+			const __m128i r = _mm_and_si128(_mm_srli_epi32(v, 16), low);
+			const __m128i b = _mm_slli_epi32(_mm_and_si128(v, low), 16);
+			_mm_storeu_si128((__m128i*)(out + x * 4), _mm_or_si128(_mm_and_si128(v, ag), _mm_or_si128(r, b)));
+		}
+#elif defined(_IRR_COLOR_NEON_)
+		for (; x + 16 <= count; x += 16)
+		{
+			uint8x16x4_t v = vld4q_u8(in + x * 4);
+			const uint8x16_t t = v.val[0];
+			v.val[0] = v.val[2];
+			v.val[2] = t;
+			vst4q_u8(out + x * 4, v);
+		}
+#endif
+		return x;
+	}
+
+	//! Moves the highest byte of each 32 bit pixel to the lowest
+	s32 rotateLeft32(const u8* in, u8* out, s32 count)
+	{
+		s32 x = 0;
+#if defined(_IRR_COLOR_SSE2_)
+		for (; x + 4 <= count; x += 4)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(in + x * 4));
+			_mm_storeu_si128((__m128i*)(out + x * 4), _mm_or_si128(_mm_slli_epi32(v, 8), _mm_srli_epi32(v, 24)));
+		}
+#elif defined(_IRR_COLOR_NEON_)
+		for (; x + 4 <= count; x += 4)
+		{
+			const uint32x4_t v = vld1q_u32((const uint32_t*)(in + x * 4));
+			vst1q_u32((uint32_t*)(out + x * 4), vorrq_u32(vshlq_n_u32(v, 8), vshrq_n_u32(v, 24)));
+		}
+#endif
+		return x;
+	}
+
+	//! Reverses the bytes of each 32 bit pixel
+	s32 reverseBytes32(const u8* in, u8* out, s32 count)
+	{
+		s32 x = 0;
+#if defined(_IRR_COLOR_SSSE3_)
+		const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+		for (; x + 4 <= count; x += 4)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(in + x * 4));
+			_mm_storeu_si128((__m128i*)(out + x * 4), _mm_shuffle_epi8(v, mask));
+		}
+#elif defined(_IRR_COLOR_SSE2_)
+		for (; x + 4 <= count; x += 4)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i*)(in + x * 4));
+			// swap the 16 bit halves, then the bytes within them
+			v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+			_mm_storeu_si128((__m128i*)(out + x * 4), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+		}
+#elif defined(_IRR_COLOR_NEON_)
+		for (; x + 4 <= count; x += 4)
+			vst1q_u8(out + x * 4, vrev32q_u8(vld1q_u8(in + x * 4)));
+#endif
+		return x;
+	}
+
+	//! Expands 24 bit pixels to 32 bit ones with an opaque alpha
+	/** \param swap Reverses the three color bytes when true. */
+	s32 expand24To32(const u8* in, u8* out, s32 count, bool swap)
+	{
+		s32 x = 0;
+#if defined(_IRR_COLOR_SSSE3_)
+		const __m128i mask = swap ?
+			_mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1) :
+			_mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+		for (; x + 6 <= count; x += 4)
+		{
+			const __m128i v = _mm_loadu_si128((const __m128i*)(in + x * 3));
+			_mm_storeu_si128((__m128i*)(out + x * 4), _mm_or_si128(_mm_shuffle_epi8(v, mask), alpha));
+		}
+#elif defined(_IRR_COLOR_NEON_)
+		for (; x + 16 <= count; x += 16)
+		{
+			const uint8x16x3_t v = vld3q_u8(in + x * 3);
+			uint8x16x4_t o;
+			o.val[0] = swap ? v.val[2] : v.val[0];
+			o.val[1] = v.val[1];
+			o.val[2] = swap ? v.val[0] : v.val[2];
+			o.val[3] = vdupq_n_u8(0xff);
+			vst4q_u8(out + x * 4, o);
+		}
+#endif
+		return x;
+	}
+
+	//! Drops the alpha of 32 bit pixels and reverses the three color bytes
+	s32 shrink32To24Swapped(const u8* in, u8* out, s32 count)
+	{
+		s32 x = 0;
+#if defined(_IRR_COLOR_SSSE3_)
+		const __m128i mask = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		for (; x + 6 <= count; x += 4)
+		{
+			// the last 4 bytes written are overwritten by the next pixels
+			const __m128i v = _mm_loadu_si128((const __m128i*)(in + x * 4));
+			_mm_storeu_si128((__m128i*)(out + x * 3), _mm_shuffle_epi8(v, mask));
+		}
+#elif defined(_IRR_COLOR_NEON_)
+		for (; x + 16 <= count; x += 16)
+		{
+			const uint8x16x4_t v = vld4q_u8(in + x * 4);
+			uint8x16x3_t o;
+			o.val[0] = v.val[2];
+			o.val[1] = v.val[1];
+			o.val[2] = v.val[0];
+			vst3q_u8(out + x * 3, o);
+		}
+#endif
+		return x;
+	}
+
+	//! Expands A1R5G5B5 pixels to A8R8G8B8 ones like A1R5G5B5toA8R8G8B8()
+	s32 expand16To32(const u8* in, u8* out, s32 count)
+	{
+		s32 x = 0;
+#if defined(_IRR_COLOR_SSE2_)
+		const __m128i m5 = _mm_set1_epi16(0x1f);
+		const __m128i alphaMask = _mm_set1_epi16((short)0xff00);
+		for (; x + 8 <= count; x += 8)
+		{
+			const __m128i c = _mm_loadu_si128((const __m128i*)(in + x * 2));
+			__m128i r = _mm_and_si128(_mm_srli_epi16(c, 10), m5);
+			__m128i g = _mm_and_si128(_mm_srli_epi16(c, 5), m5);
+			__m128i b = _mm_and_si128(c, m5);
+			// the top bits are repeated in the new low bits
+			r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+			g = _mm_or_si128(_mm_slli_epi16(g, 3), _mm_srli_epi16(g, 2));
+			b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+			const __m128i a = _mm_and_si128(_mm_srai_epi16(c, 15), alphaMask);
+			const __m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+			const __m128i ar = _mm_or_si128(a, r);
+			_mm_storeu_si128((__m128i*)(out + x * 4), _mm_unpacklo_epi16(gb, ar));
+			_mm_storeu_si128((__m128i*)(out + x * 4 + 16), _mm_unpackhi_epi16(gb, ar));
+		}
+#elif defined(_IRR_COLOR_NEON_)
+		const uint16x8_t m5 = vdupq_n_u16(0x1f);
+		for (; x + 8 <= count; x += 8)
+		{
+			const uint16x8_t c = vld1q_u16((const uint16_t*)(in + x * 2));
+			uint16x8_t r = vandq_u16(vshrq_n_u16(c, 10), m5);
+			uint16x8_t g = vandq_u16(vshrq_n_u16(c, 5), m5);
+			uint16x8_t b = vandq_u16(c, m5);
+			r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+			g = vorrq_u16(vshlq_n_u16(g, 3), vshrq_n_u16(g, 2));
+			b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+			const uint16x8_t a = vandq_u16(vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(c), 15)), vdupq_n_u16(0xff00));
+			const uint16x8x2_t pixels = vzipq_u16(vorrq_u16(vshlq_n_u16(g, 8), b), vorrq_u16(a, r));
+			vst1q_u16((uint16_t*)(out + x * 4), pixels.val[0]);
+			vst1q_u16((uint16_t*)(out + x * 4 + 16), pixels.val[1]);
+		}
+#endif
+		return x;
+	}
+} // end anonymous namespace
+
 //! converts a monochrome bitmap to A1R5G5B5 data
 void CColorConverter::convert1BitTo16Bit(const u8* in, s16* out, s32 width, s32 height, s32 linepad, bool flip)
 {
@@ -375,7 +567,11 @@ void CColorConverter::convert_A1R5G5B5toA8R8G8B8(const void* sP, s32 sN, void* d
 	u16* sB = (u16*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	const s32 done = expand16To32((const u8*)sB, (u8*)dB, sN);
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 		*dB++ = A1R5G5B5toA8R8G8B8(*sB++);
 }
 
@@ -398,7 +594,11 @@ void CColorConverter::convert_A8R8G8B8toR8G8B8(const void* sP, s32 sN, void* dP)
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	const s32 done = shrink32To24Swapped(sB, dB, sN);
+	sB += done * 4;
+	dB += done * 3;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		// sB[3] is alpha
 		dB[0] = sB[2];
@@ -506,7 +706,11 @@ void CColorConverter::convert_R8G8B8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 	u8*  sB = (u8* )sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	const s32 done = expand24To32(sB, (u8*)dB, sN, true);
+	sB += done * 3;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[0]<<16) | (sB[1]<<8) | sB[2];
 
@@ -538,7 +742,11 @@ void CColorConverter::convert_B8G8R8toA8R8G8B8(const void* sP, s32 sN, void* dP)
 	u8*  sB = (u8* )sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	const s32 done = expand24To32(sB, (u8*)dB, sN, false);
+	sB += done * 3;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB = 0xff000000 | (sB[2]<<16) | (sB[1]<<8) | sB[0];
 
@@ -552,7 +760,11 @@ void CColorConverter::convert_A8R8G8B8toR8G8B8A8(const void* sP, s32 sN, void* d
 	const u32* sB = (const u32*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	const s32 done = rotateLeft32((const u8*)sB, (u8*)dB, sN);
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB++ = (*sB<<8) | (*sB>>24);
 		++sB;
@@ -564,7 +776,11 @@ void CColorConverter::convert_A8R8G8B8toA8B8G8R8(const void* sP, s32 sN, void* d
 	const u32* sB = (const u32*)sP;
 	u32* dB = (u32*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	const s32 done = swapRedBlue32((const u8*)sB, (u8*)dB, sN);
+	sB += done;
+	dB += done;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		*dB++ = (*sB&0xff00ff00)|((*sB&0x00ff0000)>>16)|((*sB&0x000000ff)<<16);
 		++sB;
@@ -576,7 +792,11 @@ void CColorConverter::convert_B8G8R8A8toA8R8G8B8(const void* sP, s32 sN, void* d
 	u8* sB = (u8*)sP;
 	u8* dB = (u8*)dP;
 
-	for (s32 x = 0; x < sN; ++x)
+	const s32 done = reverseBytes32(sB, dB, sN);
+	sB += done * 4;
+	dB += done * 4;
+
+	for (s32 x = done; x < sN; ++x)
 	{
 		dB[0] = sB[3];
 		dB[1] = sB[2];
@@ -843,6 +1063,66 @@ void CColorConverter::convert_viaFormat(const void* sP, ECOLOR_FORMAT sF, s32 sN
 	}
 }
 
+void CColorConverter::replaceColorKey16(u16* pixels, s32 count, u16 mask, u16 key, u16 replacement)
+{
+	s32 x = 0;
+#if defined(_IRR_COLOR_SSE2_)
+	const __m128i vMask = _mm_set1_epi16((short)mask);
+	const __m128i vKey = _mm_set1_epi16((short)key);
+	const __m128i vReplacement = _mm_set1_epi16((short)replacement);
+	for (; x + 8 <= count; x += 8)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)(pixels + x));
+		const __m128i match = _mm_cmpeq_epi16(_mm_and_si128(v, vMask), vKey);
+		_mm_storeu_si128((__m128i*)(pixels + x), _mm_or_si128(_mm_and_si128(match, vReplacement), _mm_andnot_si128(match, v)));
+	}
+#elif defined(_IRR_COLOR_NEON_)
+	const uint16x8_t vMask = vdupq_n_u16(mask);
+	const uint16x8_t vKey = vdupq_n_u16(key);
+	const uint16x8_t vReplacement = vdupq_n_u16(replacement);
+	for (; x + 8 <= count; x += 8)
+	{
+		const uint16x8_t v = vld1q_u16(pixels + x);
+		vst1q_u16(pixels + x, vbslq_u16(vceqq_u16(vandq_u16(v, vMask), vKey), vReplacement, v));
+	}
+#endif
+	for (; x < count; ++x)
+	{
+		if ((pixels[x] & mask) == key)
+			pixels[x] = replacement;
+	}
+}
+
+void CColorConverter::replaceColorKey32(u32* pixels, s32 count, u32 mask, u32 key, u32 replacement)
+{
+	s32 x = 0;
+#if defined(_IRR_COLOR_SSE2_)
+	const __m128i vMask = _mm_set1_epi32((int)mask);
+	const __m128i vKey = _mm_set1_epi32((int)key);
+	const __m128i vReplacement = _mm_set1_epi32((int)replacement);
+	for (; x + 4 <= count; x += 4)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i*)(pixels + x));
+		const __m128i match = _mm_cmpeq_epi32(_mm_and_si128(v, vMask), vKey);
+		_mm_storeu_si128((__m128i*)(pixels + x), _mm_or_si128(_mm_and_si128(match, vReplacement), _mm_andnot_si128(match, v)));
+	}
+#elif defined(_IRR_COLOR_NEON_)
+	const uint32x4_t vMask = vdupq_n_u32(mask);
+	const uint32x4_t vKey = vdupq_n_u32(key);
+	const uint32x4_t vReplacement = vdupq_n_u32(replacement);
+	for (; x + 4 <= count; x += 4)
+	{
+		const uint32x4_t v = vld1q_u32((const uint32_t*)(pixels + x));
+		vst1q_u32((uint32_t*)(pixels + x), vbslq_u32(vceqq_u32(vandq_u32(v, vMask), vKey), vReplacement, v));
+	}
+#endif
+	for (; x < count; ++x)
+	{
+		if ((pixels[x] & mask) == key)
+			pixels[x] = replacement;
+	}
+}
+
 
 } // end namespace video
 } // end namespace irr
@@ -91,6 +91,11 @@ public:
 				void* dP, ECOLOR_FORMAT dF);
 	// Check if convert_viaFormat is usable
 	static bool canConvertFormat(ECOLOR_FORMAT sourceFormat, ECOLOR_FORMAT destFormat);
+
+	//! Sets the pixels whose bits within mask equal key to replacement
+	/** Compares and selects whole vectors of pixels where SSE2 or NEON is available. */
+	static void replaceColorKey16(u16* pixels, s32 count, u16 mask, u16 key, u16 replacement);
+	static void replaceColorKey32(u32* pixels, s32 count, u32 mask, u32 key, u32 replacement);
 };
 
 
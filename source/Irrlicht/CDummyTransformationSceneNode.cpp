@@ -45,6 +45,14 @@ core::matrix4 CDummyTransformationSceneNode::getRelativeTransformation() const
 	return RelativeTransformationMatrix;
 }
 
+//! Updates the absolute position, always recomputing it
+void CDummyTransformationSceneNode::updateAbsolutePosition()
+{
+	// the matrix can be changed through getRelativeTransformationMatrix() at any time
+	markTransformDirty();
+	IDummyTransformationSceneNode::updateAbsolutePosition();
+}
+
 //! Creates a clone of this scene node and its children.
 ISceneNode* CDummyTransformationSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
 {
@@ -6,16 +6,22 @@
 #define __C_DUMMY_TRANSFORMATION_SCENE_NODE_H_INCLUDED__
 
 #include "IDummyTransformationSceneNode.h"
+#include "CSceneNodePool.h"
 
 namespace irr
 {
 namespace scene
 {
 
-	class CDummyTransformationSceneNode : public IDummyTransformationSceneNode
+	class CDummyTransformationSceneNode : public IDummyTransformationSceneNode,
+		public CSceneNodePoolAllocated<CDummyTransformationSceneNode>
 	{
 	public:
 
+		//! the pool takes precedence over the operators of ISceneNode
+		using CSceneNodePoolAllocated<CDummyTransformationSceneNode>::operator new;
+		using CSceneNodePoolAllocated<CDummyTransformationSceneNode>::operator delete;
+
 		//! constructor
 		CDummyTransformationSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id);
 
@@ -30,6 +36,9 @@ namespace scene
 		//! Returns the relative transformation of the scene node.
 		core::matrix4 getRelativeTransformation() const override;
 
+		//! Updates the absolute position, always recomputing it
+		void updateAbsolutePosition() override;
+
 		//! does nothing.
 		void render() override {}
 
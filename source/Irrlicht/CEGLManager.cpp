@@ -14,13 +14,31 @@
 #include <android/native_activity.h>
 #endif
 
+// from EGL_EXT_buffer_age, older eglext.h lack it
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
+#if defined(_IRR_COMPILE_WITH_HEADLESS_DEVICE_)
+#include <mutex>
+
+// from EGL_EXT_platform_device and EGL_MESA_platform_surfaceless, older eglext.h lack them
+#ifndef EGL_PLATFORM_DEVICE_EXT
+#define EGL_PLATFORM_DEVICE_EXT 0x313F
+#endif
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#endif
+
 namespace irr
 {
 namespace video
 {
 
 CEGLManager::CEGLManager() : IContextManager(), EglWindow(0), EglDisplay(EGL_NO_DISPLAY),
-    EglSurface(EGL_NO_SURFACE), EglContext(EGL_NO_CONTEXT), EglConfig(0), MajorVersion(0), MinorVersion(0)
+    EglSurface(EGL_NO_SURFACE), EglContext(EGL_NO_CONTEXT), EglConfig(0), MajorVersion(0), MinorVersion(0),
+    Headless(false), ContextLost(false), BufferAgeSupported(false), SetDamageRegion(0), SwapBuffersWithDamage(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CEGLManager");
@@ -34,33 +52,146 @@ CEGLManager::~CEGLManager()
     terminate();
 }
 
+#if defined(_IRR_COMPILE_WITH_HEADLESS_DEVICE_)
+namespace
+{
+	typedef EGLDisplay (EGLAPIENTRY *PFN_eglGetPlatformDisplayEXT)(EGLenum platform, void* nativeDisplay, const EGLint* attribs);
+	typedef EGLBoolean (EGLAPIENTRY *PFN_eglQueryDevicesEXT)(EGLint maxDevices, void** devices, EGLint* numDevices);
+
+	//! A display of the platform extensions with the headless managers initializing it
+	struct SHeadlessDisplay
+	{
+		EGLDisplay Display;
+		u32 References;
+	};
+
+	// Platform displays are per device and not per call, and eglTerminate would end
+	// them for every headless device of the process, so they are reference counted.
+	std::mutex HeadlessDisplayMutex;
+	core::array<SHeadlessDisplay> HeadlessDisplays;
+
+	//! Counts a reference to display, returns if it was the first one
+	bool grabHeadlessDisplay(EGLDisplay display)
+	{
+		std::lock_guard<std::mutex> lock(HeadlessDisplayMutex);
+		for (u32 i = 0; i < HeadlessDisplays.size(); ++i)
+		{
+			if (HeadlessDisplays[i].Display == display)
+			{
+				++HeadlessDisplays[i].References;
+				return false;
+			}
+		}
+		SHeadlessDisplay entry;
+		entry.Display = display;
+		entry.References = 1;
+		HeadlessDisplays.push_back(entry);
+		return true;
+	}
+
+	//! Releases a reference to display, returns if it was the last one
+	bool dropHeadlessDisplay(EGLDisplay display)
+	{
+		std::lock_guard<std::mutex> lock(HeadlessDisplayMutex);
+		for (u32 i = 0; i < HeadlessDisplays.size(); ++i)
+		{
+			if (HeadlessDisplays[i].Display == display)
+			{
+				if (--HeadlessDisplays[i].References)
+					return false;
+				HeadlessDisplays.erase(i);
+				return true;
+			}
+		}
+		return true;
+	}
+}
+
+EGLDisplay CEGLManager::getHeadlessDisplay()
+{
+	const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	const core::stringc clientExtensions(extensions ? extensions : "");
+
+	PFN_eglGetPlatformDisplayEXT getPlatformDisplay = 0;
+	if (clientExtensions.find("EGL_EXT_platform_base") >= 0)
+		getPlatformDisplay = (PFN_eglGetPlatformDisplayEXT)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	EGLDisplay display = EGL_NO_DISPLAY;
+
+	if (getPlatformDisplay && clientExtensions.find("EGL_EXT_platform_device") >= 0)
+	{
+		PFN_eglQueryDevicesEXT queryDevices = (PFN_eglQueryDevicesEXT)eglGetProcAddress("eglQueryDevicesEXT");
+		EGLint numDevices = 0;
+		if (queryDevices && queryDevices(0, 0, &numDevices) && numDevices > 0)
+		{
+			core::array<void*> devices((u32)numDevices);
+			devices.set_used((u32)numDevices);
+			queryDevices(numDevices, devices.pointer(), &numDevices);
+
+			u32 index = Params.DisplayAdapter;
+			if (index >= (u32)numDevices)
+			{
+				os::Printer::log("EGL device of DisplayAdapter not found, using the first one. Devices:", core::stringc(numDevices).c_str(), ELL_WARNING);
+				index = 0;
+			}
+			display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[index], 0);
+			if (display != EGL_NO_DISPLAY)
+				os::Printer::log("Using EGL device", core::stringc(index).c_str(), ELL_INFORMATION);
+		}
+	}
+
+	if (display == EGL_NO_DISPLAY && getPlatformDisplay && clientExtensions.find("EGL_MESA_platform_surfaceless") >= 0)
+	{
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+		if (display != EGL_NO_DISPLAY)
+			os::Printer::log("Using surfaceless EGL platform.", ELL_INFORMATION);
+	}
+
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	return display;
+}
+#endif
+
 bool CEGLManager::initialize(const SIrrlichtCreationParameters& params, const SExposedVideoData& data)
 {
 	// store new data
 	Params=params;
 	Data=data;
 
-	if (EglWindow != 0 && EglDisplay != EGL_NO_DISPLAY)
+	if ((EglWindow != 0 || Headless) && EglDisplay != EGL_NO_DISPLAY)
         return true;
 
-	// Window is depend on platform.
+#if defined(_IRR_COMPILE_WITH_HEADLESS_DEVICE_)
+	if (Params.DeviceType == EIDT_HEADLESS)
+	{
+		Headless = true;
+		EglWindow = 0;
+		EglDisplay = getHeadlessDisplay();
+	}
+	else
+#endif
+	{
+		// Window is depend on platform.
 #if defined(_IRR_COMPILE_WITH_WINDOWS_DEVICE_)
-	EglWindow = (NativeWindowType)Data.OpenGLWin32.HWnd;
-	Data.OpenGLWin32.HDc = GetDC((HWND)EglWindow);
-	EglDisplay = eglGetDisplay((NativeDisplayType)Data.OpenGLWin32.HDc);
+		EglWindow = (NativeWindowType)Data.OpenGLWin32.HWnd;
+		Data.OpenGLWin32.HDc = GetDC((HWND)EglWindow);
+		EglDisplay = eglGetDisplay((NativeDisplayType)Data.OpenGLWin32.HDc);
 #elif defined(_IRR_EMSCRIPTEN_PLATFORM_)
-	EglWindow = 0;
-	EglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		EglWindow = 0;
+		EglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
 #elif defined(_IRR_COMPILE_WITH_X11_DEVICE_)
-	EglWindow = (NativeWindowType)Data.OpenGLLinux.X11Window;
-	EglDisplay = eglGetDisplay((NativeDisplayType)Data.OpenGLLinux.X11Display);
+		EglWindow = (NativeWindowType)Data.OpenGLLinux.X11Window;
+		EglDisplay = eglGetDisplay((NativeDisplayType)Data.OpenGLLinux.X11Display);
 #elif defined(_IRR_COMPILE_WITH_ANDROID_DEVICE_)
-	EglWindow =	(ANativeWindow*)Data.OGLESAndroid.Window;
-	EglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		EglWindow =	(ANativeWindow*)Data.OGLESAndroid.Window;
+		EglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
 #elif defined(_IRR_COMPILE_WITH_FB_DEVICE_)
-	EglWindow = (NativeWindowType)Data.OpenGLFB.Window;
-	EglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		EglWindow = (NativeWindowType)Data.OpenGLFB.Window;
+		EglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
 #endif
+	}
 
 	// We must check if EGL display is valid.
 	if (EglDisplay == EGL_NO_DISPLAY)
@@ -82,9 +213,36 @@ bool CEGLManager::initialize(const SIrrlichtCreationParameters& params, const SE
 	else
 		os::Printer::log("EGL version", core::stringc(MajorVersion+(MinorVersion*0.1f)).c_str());
 
+#if defined(_IRR_COMPILE_WITH_HEADLESS_DEVICE_)
+	if (Headless)
+		grabHeadlessDisplay(EglDisplay);
+#endif
+
+	loadDamageExtensions();
+
     return true;
 }
 
+void CEGLManager::loadDamageExtensions()
+{
+	const char* extensions = eglQueryString(EglDisplay, EGL_EXTENSIONS);
+	const core::stringc displayExtensions(extensions ? extensions : "");
+
+	// partial update reports the age as well
+	const bool partialUpdate = displayExtensions.find("EGL_KHR_partial_update") >= 0;
+	BufferAgeSupported = partialUpdate || displayExtensions.find("EGL_EXT_buffer_age") >= 0;
+
+	SetDamageRegion = 0;
+	if (partialUpdate)
+		SetDamageRegion = (PFN_eglDamageRectsKHR)eglGetProcAddress("eglSetDamageRegionKHR");
+
+	SwapBuffersWithDamage = 0;
+	if (displayExtensions.find("EGL_KHR_swap_buffers_with_damage") >= 0)
+		SwapBuffersWithDamage = (PFN_eglDamageRectsKHR)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+	else if (displayExtensions.find("EGL_EXT_swap_buffers_with_damage") >= 0)
+		SwapBuffersWithDamage = (PFN_eglDamageRectsKHR)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+}
+
 void CEGLManager::terminate()
 {
 	if (EglWindow == 0 && EglDisplay == EGL_NO_DISPLAY)
@@ -95,6 +253,9 @@ void CEGLManager::terminate()
 		// We should unbind current EGL context before terminate EGL.
 		eglMakeCurrent(EglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
 
+#if defined(_IRR_COMPILE_WITH_HEADLESS_DEVICE_)
+		if (!Headless || dropHeadlessDisplay(EglDisplay))
+#endif
 		eglTerminate(EglDisplay);
 		EglDisplay = EGL_NO_DISPLAY;
 	}
@@ -149,11 +310,25 @@ bool CEGLManager::generateSurface()
     ANativeWindow_setBuffersGeometry(EglWindow, 0, 0, Format);
 #endif
 
-	// Now we are able to create EGL surface.
-	EglSurface = eglCreateWindowSurface(EglDisplay, EglConfig, EglWindow, 0);
+	if (Headless)
+	{
+		// the default framebuffer of headless devices, read back with createScreenShot
+		const EGLint pbufferAttributes[] =
+		{
+			EGL_WIDTH, (EGLint)Params.WindowSize.Width,
+			EGL_HEIGHT, (EGLint)Params.WindowSize.Height,
+			EGL_NONE
+		};
+		EglSurface = eglCreatePbufferSurface(EglDisplay, EglConfig, pbufferAttributes);
+	}
+	else
+	{
+		// Now we are able to create EGL surface.
+		EglSurface = eglCreateWindowSurface(EglDisplay, EglConfig, EglWindow, 0);
 
-	if (EGL_NO_SURFACE == EglSurface)
-		EglSurface = eglCreateWindowSurface(EglDisplay, EglConfig, 0, 0);
+		if (EGL_NO_SURFACE == EglSurface)
+			EglSurface = eglCreateWindowSurface(EglDisplay, EglConfig, 0, 0);
+	}
 
 	if (EGL_NO_SURFACE == EglSurface)
 		os::Printer::log("Could not create EGL surface.");
@@ -197,7 +372,7 @@ EGLConfig CEGLManager::chooseConfig(EConfigStyle confStyle)
 			EGL_BLUE_SIZE, 8,
 			EGL_ALPHA_SIZE, Params.WithAlphaChannel ? 1:0,
 			EGL_BUFFER_SIZE, Params.Bits,
-			EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
+			EGL_SURFACE_TYPE, Headless ? EGL_PBUFFER_BIT : EGL_WINDOW_BIT,
 			EGL_DEPTH_SIZE, Params.ZBufferBits,
 			EGL_STENCIL_SIZE, Params.Stencilbuffer,
 			EGL_SAMPLE_BUFFERS, Params.AntiAlias ? 1:0,
@@ -517,14 +692,8 @@ void CEGLManager::destroySurface()
     EglSurface = EGL_NO_SURFACE;
 }
 
-bool CEGLManager::generateContext()
+EGLContext CEGLManager::createContext(EGLContext shareContext)
 {
-	if (EglDisplay == EGL_NO_DISPLAY || EglSurface == EGL_NO_SURFACE)
-		return false;
-
-	if (EglContext != EGL_NO_CONTEXT)
-		return true;
-
 	EGLint OpenGLESVersion = 0;
 
 	switch (Params.DriverType)
@@ -548,7 +717,23 @@ bool CEGLManager::generateContext()
 		EGL_NONE, 0
 	};
 
-	EglContext = eglCreateContext(EglDisplay, EglConfig, EGL_NO_CONTEXT, ContextAttrib);
+	EGLContext context = eglCreateContext(EglDisplay, EglConfig, shareContext, ContextAttrib);
+
+	if (context != EGL_NO_CONTEXT)
+		os::Printer::log("EGL context created with OpenGLESVersion: ", core::stringc((int)OpenGLESVersion), ELL_DEBUG);
+
+	return context;
+}
+
+bool CEGLManager::generateContext()
+{
+	if (EglDisplay == EGL_NO_DISPLAY || EglSurface == EGL_NO_SURFACE)
+		return false;
+
+	if (EglContext != EGL_NO_CONTEXT)
+		return true;
+
+	EglContext = createContext(EGL_NO_CONTEXT);
 
 	if (testEGLError())
 	{
@@ -556,11 +741,65 @@ bool CEGLManager::generateContext()
 		return false;
 	}
 
-	os::Printer::log("EGL context created with OpenGLESVersion: ", core::stringc((int)OpenGLESVersion), ELL_DEBUG);
-
     return true;
 }
 
+namespace
+{
+	//! A context of CEGLManager::createSharedContext() with the pbuffer it draws to
+	struct SEGLSharedContext
+	{
+		EGLContext Context;
+		EGLSurface Surface;
+	};
+}
+
+void* CEGLManager::createSharedContext()
+{
+	if (EglContext == EGL_NO_CONTEXT)
+		return 0;
+
+	// without pbuffers for the config, EGL_KHR_surfaceless_context may still make it current
+	const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+	SEGLSharedContext* shared = new SEGLSharedContext;
+	shared->Surface = eglCreatePbufferSurface(EglDisplay, EglConfig, pbufferAttributes);
+	shared->Context = createContext(EglContext);
+
+	if (shared->Context == EGL_NO_CONTEXT)
+	{
+		os::Printer::log("Could not create shared EGL context.", ELL_WARNING);
+		destroySharedContext(shared);
+		return 0;
+	}
+
+	return shared;
+}
+
+bool CEGLManager::makeSharedContextCurrent(void* context)
+{
+	const SEGLSharedContext* shared = (const SEGLSharedContext*)context;
+
+	const EGLBoolean success = shared ?
+		eglMakeCurrent(EglDisplay, shared->Surface, shared->Surface, shared->Context) :
+		eglMakeCurrent(EglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (!success)
+		os::Printer::log(shared ? "Could not make shared EGL context current." : "Could not release shared EGL context.", ELL_WARNING);
+	return success == EGL_TRUE;
+}
+
+void CEGLManager::destroySharedContext(void* context)
+{
+	SEGLSharedContext* shared = (SEGLSharedContext*)context;
+	if (!shared)
+		return;
+
+	if (shared->Context != EGL_NO_CONTEXT)
+		eglDestroyContext(EglDisplay, shared->Context);
+	if (shared->Surface != EGL_NO_SURFACE)
+		eglDestroySurface(EglDisplay, shared->Surface);
+	delete shared;
+}
+
 void CEGLManager::destroyContext()
 {
 	if (EglContext == EGL_NO_CONTEXT)
@@ -575,16 +814,56 @@ void CEGLManager::destroyContext()
 
 bool CEGLManager::activateContext(const SExposedVideoData& videoData, bool restorePrimaryOnZero)
 {
-	eglMakeCurrent(EglDisplay, EglSurface, EglSurface, EglContext);
+	if (eglMakeCurrent(EglDisplay, EglSurface, EglSurface, EglContext) == EGL_TRUE)
+		return true;
 
-	if (testEGLError())
+	if (eglGetError() == EGL_CONTEXT_LOST)
 	{
+		os::Printer::log("EGL context lost.", ELL_WARNING);
+		ContextLost = true;
+	}
+	else
 		os::Printer::log("Could not make EGL context current.");
+
+	return false;
+}
+
+bool CEGLManager::recreateLostContext()
+{
+	if (!ContextLost || EglSurface == EGL_NO_SURFACE)
+		return false;
+
+	// a lost context can only be destroyed
+	destroyContext();
+
+	if (!generateContext() || !activateContext(Data, false))
+		return false;
+
+	ContextLost = false;
+	return true;
+}
+
+bool CEGLManager::setContextCurrent(bool current)
+{
+	if (current)
+		eglMakeCurrent(EglDisplay, EglSurface, EglSurface, EglContext);
+	else
+		eglMakeCurrent(EglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+	if (testEGLError())
+	{
+		os::Printer::log(current ? "Could not make EGL context current." : "Could not release EGL context.");
 		return false;
 	}
 	return true;
 }
 
+bool CEGLManager::setSwapInterval(s32 interval)
+{
+	// EGL knows no adaptive vsync
+	return eglSwapInterval(EglDisplay, interval < 0 ? -interval : interval) == EGL_TRUE;
+}
+
 const SExposedVideoData& CEGLManager::getContext() const
 {
 	return Data;
@@ -597,7 +876,61 @@ void* CEGLManager::getProcAddress(const std::string &procName)
 
 bool CEGLManager::swapBuffers()
 {
-    return (eglSwapBuffers(EglDisplay, EglSurface)==EGL_TRUE);
+	if (eglSwapBuffers(EglDisplay, EglSurface) == EGL_TRUE)
+		return true;
+
+	if (eglGetError() == EGL_CONTEXT_LOST)
+		ContextLost = true;
+
+	return false;
+}
+
+s32 CEGLManager::getBufferAge()
+{
+	EGLint age = 0;
+	if (!BufferAgeSupported || EglSurface == EGL_NO_SURFACE ||
+		!eglQuerySurface(EglDisplay, EglSurface, EGL_BUFFER_AGE_EXT, &age))
+		return 0;
+
+	return age;
+}
+
+EGLint* CEGLManager::convertRects(const core::rect<s32>* rects, u32 count)
+{
+	EGLint height = 0;
+	eglQuerySurface(EglDisplay, EglSurface, EGL_HEIGHT, &height);
+
+	DamageRects.set_used(count * 4);
+	for (u32 i = 0; i < count; ++i)
+	{
+		DamageRects[i * 4] = rects[i].UpperLeftCorner.X;
+		DamageRects[i * 4 + 1] = height - rects[i].LowerRightCorner.Y;
+		DamageRects[i * 4 + 2] = rects[i].getWidth();
+		DamageRects[i * 4 + 3] = rects[i].getHeight();
+	}
+	return DamageRects.pointer();
+}
+
+bool CEGLManager::setDamageRegion(const core::rect<s32>* rects, u32 count)
+{
+	if (!SetDamageRegion || EglSurface == EGL_NO_SURFACE)
+		return false;
+
+	return SetDamageRegion(EglDisplay, EglSurface, convertRects(rects, count), (EGLint)count) == EGL_TRUE;
+}
+
+bool CEGLManager::swapBuffersWithDamage(const core::rect<s32>* rects, u32 count)
+{
+	if (!SwapBuffersWithDamage || EglSurface == EGL_NO_SURFACE)
+		return swapBuffers();
+
+	if (SwapBuffersWithDamage(EglDisplay, EglSurface, convertRects(rects, count), (EGLint)count) == EGL_TRUE)
+		return true;
+
+	if (eglGetError() == EGL_CONTEXT_LOST)
+		ContextLost = true;
+
+	return false;
 }
 
 bool CEGLManager::testEGLError()
@@ -13,6 +13,7 @@
 #include "SIrrCreationParameters.h"
 #include "SExposedVideoData.h"
 #include "IContextManager.h"
+#include "irrArray.h"
 
 namespace irr
 {
@@ -62,12 +63,39 @@ namespace video
 
 		bool activateContext(const SExposedVideoData& videoData, bool restorePrimaryOnZero) override;
 
+		//! Makes the context current on the calling thread, or releases it
+		bool setContextCurrent(bool current) override;
+
+		//! Creates a context sharing the resources of the context of the manager
+		void* createSharedContext() override;
+
+		//! Makes a context of createSharedContext() current on the calling thread, or releases it
+		bool makeSharedContextCurrent(void* context) override;
+
+		//! Destroys a context of createSharedContext()
+		void destroySharedContext(void* context) override;
+
+		//! Sets how many vertical blanks swapBuffers() waits for
+		bool setSwapInterval(s32 interval) override;
+
+		//! Creates a new context after EGL reported EGL_CONTEXT_LOST
+		bool recreateLostContext() override;
+
 		// Get procedure address.
 		void* getProcAddress(const std::string &procName) override;
 
 		// Swap buffers.
 		bool swapBuffers() override;
 
+		//! Number of frames since the current back buffer was presented, needs EGL_EXT_buffer_age
+		s32 getBufferAge() override;
+
+		//! Tells which part of the back buffer the next frame draws, needs EGL_KHR_partial_update
+		bool setDamageRegion(const core::rect<s32>* rects, u32 count) override;
+
+		//! Swaps the buffers with EGL_KHR_swap_buffers_with_damage or EGL_EXT_swap_buffers_with_damage
+		bool swapBuffersWithDamage(const core::rect<s32>* rects, u32 count) override;
+
 	protected:
 		enum EConfigStyle
 		{
@@ -98,6 +126,22 @@ namespace video
 	private:
 		bool testEGLError();
 
+		//! Creates a context for EglConfig, sharing the resources of shareContext if not EGL_NO_CONTEXT
+		EGLContext createContext(EGLContext shareContext);
+
+		//! Gets a display without a windowing system for EIDT_HEADLESS
+		/** Tries the EGL device selected by Params.DisplayAdapter, then the Mesa
+		surfaceless platform and then the default display. */
+		EGLDisplay getHeadlessDisplay();
+
+		//! Gets the damage extensions of EglDisplay
+		void loadDamageExtensions();
+
+		//! Converts rects to EGL rectangles, with the origin at the bottom of the surface
+		EGLint* convertRects(const core::rect<s32>* rects, u32 count);
+
+		typedef EGLBoolean (EGLAPIENTRY *PFN_eglDamageRectsKHR)(EGLDisplay dpy, EGLSurface surface, EGLint* rects, EGLint count);
+
 		NativeWindowType EglWindow;
 		EGLDisplay EglDisplay;
 		EGLSurface EglSurface;
@@ -110,6 +154,17 @@ namespace video
 
 		EGLint MajorVersion;
 		EGLint MinorVersion;
+
+		//! Renders to a pbuffer of Params.WindowSize instead of a window
+		bool Headless;
+
+		//! Set when EGL reported EGL_CONTEXT_LOST, see recreateLostContext()
+		bool ContextLost;
+
+		bool BufferAgeSupported;
+		PFN_eglDamageRectsKHR SetDamageRegion;
+		PFN_eglDamageRectsKHR SwapBuffersWithDamage;
+		core::array<EGLint> DamageRects;
 	};
 }
 }
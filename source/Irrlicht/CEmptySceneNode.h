@@ -6,16 +6,21 @@
 #define __C_EMPTY_SCENE_NODE_H_INCLUDED__
 
 #include "ISceneNode.h"
+#include "CSceneNodePool.h"
 
 namespace irr
 {
 namespace scene
 {
 
-	class CEmptySceneNode : public ISceneNode
+	class CEmptySceneNode : public ISceneNode, public CSceneNodePoolAllocated<CEmptySceneNode>
 	{
 	public:
 
+		//! the pool takes precedence over the operators of ISceneNode
+		using CSceneNodePoolAllocated<CEmptySceneNode>::operator new;
+		using CSceneNodePoolAllocated<CEmptySceneNode>::operator delete;
+
 		//! constructor
 		CEmptySceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id);
 
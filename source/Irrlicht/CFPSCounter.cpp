@@ -13,7 +13,8 @@ namespace video
 
 CFPSCounter::CFPSCounter()
 :	FPS(60), Primitive(0), StartTime(0), FramesCounted(0),
-	PrimitivesCounted(0), PrimitiveAverage(0), PrimitiveTotal(0)
+	PrimitivesCounted(0), PrimitiveAverage(0), PrimitiveTotal(0),
+	FrameTimesRecorded(0), LatestFrame(0), HitchMs(50.f)
 {
 
 }
@@ -71,6 +72,121 @@ void CFPSCounter::registerFrame(u32 now, u32 primitivesDrawn)
 }
 
 
+//! sets how many frames the frame time history keeps, 0 disables it
+void CFPSCounter::setFrameTimeHistory(u32 frames, f32 hitchMs)
+{
+	HitchMs = hitchMs;
+	if (frames == FrameTimes.size())
+		return;
+
+	FrameTimes.set_used(frames);
+	FrameTimesRecorded = 0;
+}
+
+
+//! records the times of a frame, negative times weren't measured
+void CFPSCounter::registerFrameTimes(u32 frame, f32 frameMs, f32 cpuMs)
+{
+	if (FrameTimes.empty())
+		return;
+
+	SFrameTimes& times = FrameTimes[frame % FrameTimes.size()];
+	times.Frame = frame;
+	times.FrameMs = frameMs;
+	times.CPUMs = cpuMs;
+	times.GPUMs = -1.f;
+	times.SwapMs = -1.f;
+
+	LatestFrame = frame;
+	if (FrameTimesRecorded < FrameTimes.size())
+		++FrameTimesRecorded;
+}
+
+
+//! adds the time the frame took to present
+void CFPSCounter::registerSwapTime(u32 frame, f32 ms)
+{
+	SFrameTimes* times = findFrameTimes(frame);
+	if (times)
+		times->SwapMs = ms;
+}
+
+
+//! adds the GPU time of the frame, which is known some frames later
+void CFPSCounter::registerGPUTime(u32 frame, f32 ms)
+{
+	SFrameTimes* times = findFrameTimes(frame);
+	if (times)
+		times->GPUMs = ms;
+}
+
+
+//! returns the entry of the frame if it's still in the history
+CFPSCounter::SFrameTimes* CFPSCounter::findFrameTimes(u32 frame)
+{
+	if (LatestFrame - frame >= FrameTimesRecorded)
+		return 0;
+
+	SFrameTimes& times = FrameTimes[frame % FrameTimes.size()];
+	return times.Frame == frame ? &times : 0;
+}
+
+
+namespace
+{
+	//! sorts the measured times and picks the percentiles by nearest rank
+	SFrameTimePercentiles getPercentiles(core::array<f32>& times)
+	{
+		SFrameTimePercentiles result;
+		result.Samples = times.size();
+		if (times.empty())
+			return result;
+
+		times.sort();
+		const u32 count = times.size();
+		result.Median = times[(count - 1) / 2];
+		result.Percentile95 = times[core::ceil32(count * 0.95f) - 1];
+		result.Percentile99 = times[core::ceil32(count * 0.99f) - 1];
+		result.Max = times.getLast();
+		return result;
+	}
+}
+
+
+//! computes the percentiles of the last frames, all recorded ones for 0
+SFrameTimeStats CFPSCounter::getFrameTimeStats(u32 frames) const
+{
+	SFrameTimeStats stats;
+	if (frames == 0 || frames > FrameTimesRecorded)
+		frames = FrameTimesRecorded;
+
+	core::array<f32> frameMs(frames), cpuMs(frames), gpuMs(frames), swapMs(frames);
+	for (u32 i = 0; i < frames; ++i)
+	{
+		const SFrameTimes& times = FrameTimes[(LatestFrame - i) % FrameTimes.size()];
+		if (times.FrameMs >= 0.f)
+		{
+			frameMs.push_back(times.FrameMs);
+			if (times.FrameMs > HitchMs)
+				++stats.Hitches;
+		}
+		if (times.CPUMs >= 0.f)
+			cpuMs.push_back(times.CPUMs);
+		if (times.GPUMs >= 0.f)
+			gpuMs.push_back(times.GPUMs);
+		if (times.SwapMs >= 0.f)
+			swapMs.push_back(times.SwapMs);
+	}
+
+	stats.Frames = frames;
+	stats.FrameTime = getPercentiles(frameMs);
+	stats.CPUTime = getPercentiles(cpuMs);
+	stats.GPUTime = getPercentiles(gpuMs);
+	stats.SwapTime = getPercentiles(swapMs);
+	return stats;
+}
+
+
 } // end namespace video
 } // end namespace irr
 
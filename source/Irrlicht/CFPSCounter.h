@@ -6,6 +6,8 @@
 #define __C_FPSCOUNTER_H_INCLUDED__
 
 #include "irrTypes.h"
+#include "irrArray.h"
+#include "IVideoDriver.h"
 
 namespace irr
 {
@@ -33,8 +35,39 @@ public:
 	//! to be called every frame
 	void registerFrame(u32 now, u32 primitive);
 
+	//! sets how many frames the frame time history keeps, 0 disables it
+	void setFrameTimeHistory(u32 frames, f32 hitchMs);
+
+	//! returns if frame times are recorded
+	bool isFrameTimeHistoryEnabled() const { return !FrameTimes.empty(); }
+
+	//! records the times of a frame, negative times weren't measured
+	void registerFrameTimes(u32 frame, f32 frameMs, f32 cpuMs);
+
+	//! adds the time the frame took to present
+	void registerSwapTime(u32 frame, f32 ms);
+
+	//! adds the GPU time of the frame, which is known some frames later
+	void registerGPUTime(u32 frame, f32 ms);
+
+	//! computes the percentiles of the last frames, all recorded ones for 0
+	SFrameTimeStats getFrameTimeStats(u32 frames) const;
+
 private:
 
+	//! times of a frame, negative if not measured (yet)
+	struct SFrameTimes
+	{
+		u32 Frame;
+		f32 FrameMs;
+		f32 CPUMs;
+		f32 GPUMs;
+		f32 SwapMs;
+	};
+
+	//! returns the entry of the frame if it's still in the history
+	SFrameTimes* findFrameTimes(u32 frame);
+
 	s32 FPS;
 	u32 Primitive;
 	u32 StartTime;
@@ -43,6 +76,12 @@ private:
 	u32 PrimitivesCounted;
 	u32 PrimitiveAverage;
 	u32 PrimitiveTotal;
+
+	//! ring buffer indexed by frame number modulo its size
+	core::array<SFrameTimes> FrameTimes;
+	u32 FrameTimesRecorded;
+	u32 LatestFrame;
+	f32 HitchMs;
 };
 
 
@@ -94,6 +94,19 @@ u32 CFileList::addItem(const io::path& fullPath, u32 offset, u32 size, bool isDi
 	return Files.size() - 1;
 }
 
+//! Adds many files or folders at once and sorts the list
+void CFileList::addItems(const core::array<SFileListEntry>& entries)
+{
+	// one allocation and one sort for all entries
+	Files.reallocate(Files.size() + entries.size());
+	for (u32 i=0; i < entries.size(); ++i)
+	{
+		const SFileListEntry& e = entries[i];
+		addItem(e.FullName, e.Offset, e.Size, e.IsDirectory, e.ID);
+	}
+	sort();
+}
+
 //! Returns the ID of a file in the file list, based on an index.
 u32 CFileList::getID(u32 index) const
 {
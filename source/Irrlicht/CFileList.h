@@ -84,6 +84,11 @@ public:
 	\param id The ID of the file in the archive which owns it */
 	u32 addItem(const io::path& fullPath, u32 offset, u32 size, bool isDirectory, u32 id=0) override;
 
+	//! Adds many files or folders at once and sorts the list
+	/** \param entries FullName, Offset, Size, ID and IsDirectory of the
+	entries are used like the parameters of addItem(). */
+	void addItems(const core::array<SFileListEntry>& entries);
+
 	//! Sorts the file list. You should call this after adding any items to the file list
 	void sort() override;
 
@@ -114,6 +119,12 @@ public:
 	//! Returns the base path of the file list
 	const io::path& getPath() const override;
 
+	//! True if the names are stored and searched without their path
+	bool getIgnorePaths() const
+	{
+		return IgnorePaths;
+	}
+
 protected:
 
 	//! Ignore paths when adding or searching for files
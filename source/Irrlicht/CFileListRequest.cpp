@@ -0,0 +1,217 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CFileListRequest.h"
+
+#if defined (_IRR_WINDOWS_API_)
+	#include <io.h>
+	#include <tchar.h>
+#elif (defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_))
+	#include <string.h>
+	#include <sys/types.h>
+	#include <dirent.h>
+	#include <sys/stat.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+//! Entries handed out at once while a directory is listed
+static const u32 FILE_LIST_BATCH_SIZE = 64;
+
+CFileListRequest::CFileListRequest(const io::path& path, bool ignoreCase, bool fetchSizes)
+	: Path(path), IgnoreCase(ignoreCase), FetchSizes(fetchSizes), Ready(false), Cancel(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CFileListRequest");
+	#endif
+}
+
+CFileListRequest::~CFileListRequest()
+{
+	if (Thread.joinable())
+	{
+		Cancel.store(true, std::memory_order_relaxed);
+		Thread.join();
+	}
+}
+
+const io::path& CFileListRequest::getPath() const
+{
+	return Path;
+}
+
+bool CFileListRequest::isReady() const
+{
+	return Ready.load(std::memory_order_acquire);
+}
+
+void CFileListRequest::wait()
+{
+	std::unique_lock<std::mutex> lock(ReadyMutex);
+	ReadyWake.wait(lock, [this] { return isReady(); });
+}
+
+u32 CFileListRequest::getEntryCount() const
+{
+	std::lock_guard<std::mutex> lock(EntryMutex);
+	return Entries.size();
+}
+
+bool CFileListRequest::getEntry(u32 index, io::path& fullName, u32& size, bool& isDirectory) const
+{
+	std::lock_guard<std::mutex> lock(EntryMutex);
+	if (index >= Entries.size())
+		return false;
+
+	fullName = Entries[index].FullName;
+	size = Entries[index].Size;
+	isDirectory = Entries[index].IsDirectory;
+	return true;
+}
+
+IFileList* CFileListRequest::createFileList() const
+{
+	CFileList* list = new CFileList(Path, IgnoreCase, false);
+
+	std::lock_guard<std::mutex> lock(EntryMutex);
+	list->addItems(Entries);
+	return list;
+}
+
+void CFileListRequest::start()
+{
+	Thread = std::thread([this] { run(); });
+}
+
+void CFileListRequest::run()
+{
+	listDirectory();
+	flushBatch();
+	setReady();
+}
+
+void CFileListRequest::addEntry(const io::path& fullName, u32 offset, u32 size, bool isDirectory)
+{
+	SFileListEntry entry;
+	entry.FullName = fullName;
+	entry.Offset = offset;
+	entry.Size = size;
+	entry.ID = 0;
+	entry.IsDirectory = isDirectory;
+
+	std::lock_guard<std::mutex> lock(EntryMutex);
+	Entries.push_back(entry);
+}
+
+void CFileListRequest::setReady()
+{
+	{
+		std::lock_guard<std::mutex> lock(ReadyMutex);
+		Ready.store(true, std::memory_order_release);
+	}
+	ReadyWake.notify_all();
+}
+
+void CFileListRequest::flushBatch()
+{
+	if (Batch.empty())
+		return;
+
+	std::lock_guard<std::mutex> lock(EntryMutex);
+	for (u32 i=0; i < Batch.size(); ++i)
+		Entries.push_back(Batch[i]);
+	Batch.set_used(0);
+}
+
+void CFileListRequest::listDirectory()
+{
+	SFileListEntry entry;
+	entry.Offset = 0;
+	entry.ID = 0;
+
+	// --------------------------------------------
+	//! Windows version
+	#ifdef _IRR_WINDOWS_API_
+
+	// TODO: Should be unified once mingw adapts the proper types
+#if defined(__GNUC__)
+	long hFile; //mingw return type declaration
+#else
+	intptr_t hFile;
+#endif
+
+	// the type and size of each entry are part of the directory on windows
+	struct _tfinddata_t c_file;
+	if( (hFile = _tfindfirst( (Path + _IRR_TEXT("*")).c_str(), &c_file )) != -1L )
+	{
+		do
+		{
+			entry.FullName = Path + c_file.name;
+			entry.Size = c_file.size;
+			entry.IsDirectory = (_A_SUBDIR & c_file.attrib) != 0;
+			Batch.push_back(entry);
+			if (Batch.size() >= FILE_LIST_BATCH_SIZE)
+				flushBatch();
+		}
+		while( !Cancel.load(std::memory_order_relaxed) && _tfindnext( hFile, &c_file ) == 0 );
+
+		_findclose( hFile );
+	}
+
+	#endif
+
+	// --------------------------------------------
+	//! Linux version
+	#if (defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_))
+
+	entry.FullName = Path + _IRR_TEXT("..");
+	entry.Size = 0;
+	entry.IsDirectory = true;
+	Batch.push_back(entry);
+
+	//! We use the POSIX compliant methods instead of scandir
+	DIR* dirHandle=opendir(Path.c_str());
+	if (dirHandle)
+	{
+		struct dirent *dirEntry;
+		while (!Cancel.load(std::memory_order_relaxed) && (dirEntry=readdir(dirHandle)))
+		{
+			if((strcmp(dirEntry->d_name, ".")==0) ||
+			   (strcmp(dirEntry->d_name, "..")==0))
+			{
+				continue;
+			}
+
+			entry.FullName = Path + dirEntry->d_name;
+			entry.Size = 0;
+			entry.IsDirectory = false;
+
+			// the type is usually known without stat, links are followed by it
+			bool needStat = true;
+			#if !defined(_IRR_SOLARIS_PLATFORM_) && !defined(__CYGWIN__)
+			// only available on some systems
+			needStat = FetchSizes || dirEntry->d_type == DT_UNKNOWN || dirEntry->d_type == DT_LNK;
+			entry.IsDirectory = dirEntry->d_type == DT_DIR;
+			#endif
+
+			struct stat buf;
+			if (needStat && stat(entry.FullName.c_str(), &buf)==0)
+			{
+				entry.Size = buf.st_size;
+				entry.IsDirectory = S_ISDIR(buf.st_mode);
+			}
+
+			Batch.push_back(entry);
+			if (Batch.size() >= FILE_LIST_BATCH_SIZE)
+				flushBatch();
+		}
+		closedir(dirHandle);
+	}
+	#endif
+}
+
+} // end namespace io
+} // end namespace irr
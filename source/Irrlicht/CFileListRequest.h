@@ -0,0 +1,89 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FILE_LIST_REQUEST_H_INCLUDED__
+#define __C_FILE_LIST_REQUEST_H_INCLUDED__
+
+#include "IFileListRequest.h"
+#include "CFileList.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace irr
+{
+namespace io
+{
+
+//! Directory listed on a worker thread, see IFileSystem::createFileListAsync()
+/** The entries are handed out in batches while the directory is read. Lists
+which aren't read from disk are filled with addEntry() and setReady(). */
+class CFileListRequest : public IFileListRequest
+{
+public:
+
+	//! Constructor
+	/** \param path The directory, ending with a slash.
+	\param ignoreCase Passed to the lists of createFileList().
+	\param fetchSizes False to only stat entries of unknown type. */
+	CFileListRequest(const io::path& path, bool ignoreCase, bool fetchSizes);
+
+	//! Destructor, cancels the listing if it isn't ready
+	~CFileListRequest();
+
+	const io::path& getPath() const override;
+
+	bool isReady() const override;
+
+	void wait() override;
+
+	u32 getEntryCount() const override;
+
+	bool getEntry(u32 index, io::path& fullName, u32& size, bool& isDirectory) const override;
+
+	IFileList* createFileList() const override;
+
+	//! Lists the directory on a worker thread
+	void start();
+
+	//! Lists the directory on the calling thread
+	void run();
+
+	//! Adds an entry of a list which isn't read from disk
+	void addEntry(const io::path& fullName, u32 offset, u32 size, bool isDirectory);
+
+	//! Marks the list as complete
+	void setReady();
+
+private:
+
+	//! Reads the directory, adding the entries in batches
+	void listDirectory();
+
+	//! Adds the entries of Batch to Entries
+	void flushBatch();
+
+	io::path Path;
+	bool IgnoreCase;
+	bool FetchSizes;
+
+	//! Entries found by the listing thread which aren't in Entries yet
+	core::array<SFileListEntry> Batch;
+
+	//! guards Entries
+	mutable std::mutex EntryMutex;
+	core::array<SFileListEntry> Entries;
+
+	std::atomic<bool> Ready;
+	//! Set by the destructor to stop listing
+	std::atomic<bool> Cancel;
+	std::mutex ReadyMutex;
+	std::condition_variable ReadyWake;
+	std::thread Thread;
+};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -0,0 +1,154 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CFilePrefetchRequest.h"
+#include "CJobSystem.h"
+#include "CMemoryFile.h"
+#include "CZipReader.h"
+#include "os.h"
+
+namespace irr
+{
+namespace io
+{
+
+CFilePrefetchRequest::CFilePrefetchRequest(const core::array<io::path>& filenames,
+		IFilePrefetchCallback* callback)
+	: Callback(callback), Ready(false)
+{
+	Files.reallocate(filenames.size());
+	for (u32 i=0; i<filenames.size(); ++i)
+	{
+		SFile file;
+		file.Request = this;
+		file.Name = filenames[i];
+		file.Source = 0;
+		file.Size = 0;
+		Files.push_back(file);
+	}
+}
+
+CFilePrefetchRequest::~CFilePrefetchRequest()
+{
+	for (u32 i=0; i<Files.size(); ++i)
+	{
+		if (Files[i].Source)
+			Files[i].Source->drop();
+	}
+}
+
+u32 CFilePrefetchRequest::getFileCount() const
+{
+	return Files.size();
+}
+
+const io::path& CFilePrefetchRequest::getFileName(u32 index) const
+{
+	return Files[index].Name;
+}
+
+bool CFilePrefetchRequest::isReady() const
+{
+	return Ready.load(std::memory_order_acquire);
+}
+
+void CFilePrefetchRequest::wait()
+{
+	std::unique_lock<std::mutex> lock(ReadyMutex);
+	ReadyWake.wait(lock, [this] { return isReady(); });
+}
+
+IReadFile* CFilePrefetchRequest::createAndOpenFile(u32 index) const
+{
+	// the callbacks open the files while the request isn't ready yet
+	if (index >= Files.size() || !Files[index].Data)
+		return 0;
+
+	return new CMemoryReadFile(Files[index].Data, Files[index].Size, Files[index].Name);
+}
+
+void CFilePrefetchRequest::setDeflatedData(u32 index, core::array<u8>& data, u32 size)
+{
+	Files[index].Deflated.swap(data);
+	Files[index].Size = size;
+}
+
+void CFilePrefetchRequest::setSourceFile(u32 index, IReadFile* file)
+{
+	file->grab();
+	Files[index].Source = file;
+}
+
+void CFilePrefetchRequest::setData(u32 index, c8* data, u32 size)
+{
+	Files[index].Data = std::shared_ptr<const c8>(data, std::default_delete<c8[]>());
+	Files[index].Size = size;
+}
+
+void CFilePrefetchRequest::addJobs(scene::CJobSystem& jobs)
+{
+	for (u32 i=0; i<Files.size(); ++i)
+		jobs.add(loadJob, &Files[i]);
+}
+
+void CFilePrefetchRequest::setReady()
+{
+	{
+		std::lock_guard<std::mutex> lock(ReadyMutex);
+		Ready.store(true, std::memory_order_release);
+	}
+	ReadyWake.notify_all();
+}
+
+void CFilePrefetchRequest::loadJob(void* data)
+{
+	SFile& file = *(SFile*)data;
+
+	c8* contents = 0;
+	if (file.Source)
+	{
+		// a file of its own, so it can be read on this thread
+		const long size = file.Source->getSize();
+		if (size >= 0)
+		{
+			contents = new c8[size > 0 ? size : 1];
+			file.Source->seek(0);
+			if (file.Source->read(contents, size) != (size_t)size)
+			{
+				delete [] contents;
+				contents = 0;
+			}
+		}
+		file.Source->drop();
+		file.Source = 0;
+		file.Size = (u32)size;
+	}
+	else if (file.Deflated.size())
+	{
+		contents = new c8[file.Size > 0 ? file.Size : 1];
+		if (!CZipReader::inflateData(file.Deflated.const_pointer(), file.Deflated.size(), contents, file.Size))
+		{
+			delete [] contents;
+			contents = 0;
+		}
+		file.Deflated.clear();
+	}
+
+	if (contents)
+		file.Data = std::shared_ptr<const c8>(contents, std::default_delete<c8[]>());
+	else if (!file.Data)
+		os::Printer::log("Could not prefetch file", file.Name, ELL_ERROR);
+
+	CFilePrefetchRequest* request = file.Request;
+	if (request->Callback)
+	{
+		const u32 index = (u32)(&file - request->Files.const_pointer());
+		IReadFile* loaded = request->createAndOpenFile(index);
+		request->Callback->OnFilePrefetched(request, index, loaded);
+		if (loaded)
+			loaded->drop();
+	}
+}
+
+} // end namespace io
+} // end namespace irr
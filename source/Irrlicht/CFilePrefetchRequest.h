@@ -0,0 +1,90 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FILE_PREFETCH_REQUEST_H_INCLUDED__
+#define __C_FILE_PREFETCH_REQUEST_H_INCLUDED__
+
+#include "IFilePrefetchRequest.h"
+#include "irrArray.h"
+#include "irrString.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace irr
+{
+namespace scene
+{
+	class CJobSystem;
+} // end namespace scene
+
+namespace io
+{
+
+//! Files loaded on worker threads, see IFileSystem::prefetchFiles()
+/** CFileSystem sets the source of each file on the thread calling
+prefetchFiles(), the files are then loaded by the jobs of its prefetch thread. */
+class CFilePrefetchRequest : public IFilePrefetchRequest
+{
+public:
+	CFilePrefetchRequest(const core::array<io::path>& filenames, IFilePrefetchCallback* callback);
+
+	~CFilePrefetchRequest();
+
+	u32 getFileCount() const override;
+
+	const io::path& getFileName(u32 index) const override;
+
+	bool isReady() const override;
+
+	void wait() override;
+
+	IReadFile* createAndOpenFile(u32 index) const override;
+
+	//! Sets the deflated data of a file, which is decompressed by a job
+	/** The data is swapped into the request. */
+	void setDeflatedData(u32 index, core::array<u8>& data, u32 size);
+
+	//! Sets a file of its own, which is read by a job, it is grabbed
+	void setSourceFile(u32 index, IReadFile* file);
+
+	//! Sets the contents of a file which was read already
+	/** Takes ownership of data, which has to be allocated with new[]. */
+	void setData(u32 index, c8* data, u32 size);
+
+	//! Adds the jobs loading the files, called on the prefetch thread
+	void addJobs(scene::CJobSystem& jobs);
+
+	//! Makes the request ready, once the jobs are done
+	void setReady();
+
+private:
+	struct SFile
+	{
+		CFilePrefetchRequest* Request;
+		io::path Name;
+		//! deflated data to decompress, if any
+		core::array<u8> Deflated;
+		//! file to read, if any
+		IReadFile* Source;
+		//! the loaded contents, empty if loading failed
+		std::shared_ptr<const c8> Data;
+		u32 Size;
+	};
+
+	//! CJobSystem job loading an SFile
+	static void loadJob(void* data);
+
+	core::array<SFile> Files;
+	IFilePrefetchCallback* Callback;
+
+	std::atomic<bool> Ready;
+	std::mutex ReadyMutex;
+	std::condition_variable ReadyWake;
+};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
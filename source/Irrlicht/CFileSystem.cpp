@@ -7,11 +7,17 @@
 #include "IReadFile.h"
 #include "IWriteFile.h"
 #include "CZipReader.h"
+#include "CLZ4Reader.h"
 #include "CFileList.h"
 #include "stdio.h"
 #include "os.h"
 #include "CReadFile.h"
+#include "CMappedReadFile.h"
+#include "CMappedWriteFile.h"
 #include "CMemoryFile.h"
+#include "CJobSystem.h"
+#include "CFilePrefetchRequest.h"
+#include "CFileListRequest.h"
 #include "CLimitReadFile.h"
 #include "CWriteFile.h"
 #include <list>
@@ -42,8 +48,14 @@ namespace irr
 namespace io
 {
 
+//! Names kept by each path cache of CFileSystem
+static const size_t PATH_CACHE_SIZE = 4096;
+
 //! constructor
 CFileSystem::CFileSystem()
+	: MemoryMappingThreshold(256 * 1024),
+	DecompressedFileCache(std::make_shared<CZipEntryCache>(4 * 1024 * 1024)),
+	PrefetchQuit(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CFileSystem");
@@ -53,7 +65,10 @@ CFileSystem::CFileSystem()
 	//! reset current working directory
 	getWorkingDirectory();
 
-	ArchiveLoader.push_back(new CArchiveLoaderZIP(this));
+	ArchiveLoader.push_back(new CArchiveLoaderZIP(this, DecompressedFileCache));
+#ifdef _IRR_COMPILE_WITH_LZ4_
+	ArchiveLoader.push_back(new CArchiveLoaderLZ4(this));
+#endif
 
 }
 
@@ -61,6 +76,18 @@ CFileSystem::CFileSystem()
 //! destructor
 CFileSystem::~CFileSystem()
 {
+	// the queued requests are loaded before the thread stops
+	if (PrefetchThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(PrefetchMutex);
+			PrefetchQuit = true;
+		}
+		PrefetchWake.notify_all();
+		PrefetchThread.join();
+	}
+	dropDonePrefetches();
+
 	u32 i;
 
 	for ( i=0; i < FileArchives.size(); ++i)
@@ -82,9 +109,35 @@ IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 		return 0;
 
 	IReadFile* file = 0;
-	u32 i;
+	u32 i = 0;
+
+	// names of directories aren't indexed
+	const c8 last = filename.lastChar();
+	if (last != '/' && last != '\\')
+	{
+		u32 archive;
+		const s32 index = findIndexedFile(filename, archive);
+
+		// archives which aren't indexed are asked in their order, up to the indexed one
+		for (u32 u=0; u < UnindexedArchives.size() && UnindexedArchives[u] < archive; ++u)
+		{
+			file = FileArchives[UnindexedArchives[u]]->createAndOpenFile(filename);
+			if (file)
+				return file;
+		}
+
+		if (index != -1)
+		{
+			file = FileArchives[archive]->createAndOpenFile((u32)index);
+			if (file)
+				return file;
+		}
+
+		// the later archives only get a chance if the file couldn't be opened
+		i = archive + 1;
+	}
 
-	for (i=0; i< FileArchives.size(); ++i)
+	for (; i< FileArchives.size(); ++i)
 	{
 		file = FileArchives[i]->createAndOpenFile(filename);
 		if (file)
@@ -93,7 +146,222 @@ IReadFile* CFileSystem::createAndOpenFile(const io::path& filename)
 
 	// Create the file using an absolute path so that it matches
 	// the scheme used by CNullDriver::getTexture().
-	return CReadFile::createReadFile(getAbsolutePath(filename));
+	const io::path absolutePath = getAbsolutePath(filename);
+
+	// large files are mapped, so loaders can parse them in place
+	if (MemoryMappingThreshold >= 0)
+	{
+		file = CMappedReadFile::createMappedReadFile(absolutePath, MemoryMappingThreshold);
+		if (file)
+			return file;
+	}
+
+	return CReadFile::createReadFile(absolutePath);
+}
+
+
+//! Adds the files of an archive, which has a lower priority than all indexed ones
+void CFileSystem::addToPathIndex(u32 archive)
+{
+	clearPathCaches(false);
+
+	// other archives may open files which aren't in their file list
+	const IFileArchive* fileArchive = FileArchives[archive];
+	if (fileArchive->getType() != EFAT_ZIP && fileArchive->getType() != EFAT_GZIP)
+	{
+		UnindexedArchives.push_back(archive);
+		return;
+	}
+
+	// CZipReader reads both, its file list is a CFileList
+	const CFileList* list = static_cast<const CFileList*>(fileArchive->getFileList());
+
+	std::unordered_map<io::path, SPathIndexEntry, PathHash>& index =
+		list->getIgnorePaths() ? NameIndex : PathIndex;
+	for (u32 i=0; i < list->getFileCount(); ++i)
+	{
+		if (list->isDirectory(i))
+			continue;
+
+		// the file lists compare names ignoring case
+		io::path name = list->getFullFileName(i);
+		name.make_lower();
+
+		// the archives added before keep their files
+		SPathIndexEntry entry = {archive, i};
+		index.emplace(name, entry);
+	}
+}
+
+
+//! Builds the index again, after archives were removed or moved
+void CFileSystem::rebuildPathIndex()
+{
+	clearPathCaches(false);
+	PathIndex.clear();
+	NameIndex.clear();
+	UnindexedArchives.clear();
+
+	for (u32 i=0; i < FileArchives.size(); ++i)
+		addToPathIndex(i);
+}
+
+
+//! Finds the indexed archive with the highest priority which has the file
+s32 CFileSystem::findIndexedFile(const io::path& filename, u32& archive) const
+{
+	archive = FileArchives.size();
+	s32 file = -1;
+
+	// normalized like CFileList::findFile does
+	io::path name = filename;
+	name.replace('\\', '/');
+	name.make_lower();
+
+	auto it = PathIndex.find(name);
+	if (it != PathIndex.end())
+	{
+		archive = it->second.Archive;
+		file = (s32)it->second.File;
+	}
+
+	if (!NameIndex.empty())
+	{
+		core::deletePathFromFilename(name);
+		it = NameIndex.find(name);
+		if (it != NameIndex.end() && it->second.Archive < archive)
+		{
+			archive = it->second.Archive;
+			file = (s32)it->second.File;
+		}
+	}
+
+	return file;
+}
+
+
+//! Set from which size on files on disk are opened through a memory mapping
+void CFileSystem::setMemoryMappingThreshold(long size)
+{
+	MemoryMappingThreshold = size;
+}
+
+
+//! Set the memory budget of the cache of decompressed files from zip archives
+void CFileSystem::setDecompressedFileCacheSize(u32 size)
+{
+	DecompressedFileCache->setBudget(size);
+}
+
+
+//! Reads and decompresses files on worker threads
+IFilePrefetchRequest* CFileSystem::prefetchFiles(const core::array<io::path>& filenames,
+		IFilePrefetchCallback* callback)
+{
+	dropDonePrefetches();
+
+	CFilePrefetchRequest* request = new CFilePrefetchRequest(filenames, callback);
+	for (u32 i=0; i < filenames.size(); ++i)
+		setPrefetchSource(request, i);
+
+	if (!PrefetchThread.joinable())
+		PrefetchThread = std::thread(&CFileSystem::prefetchLoop, this);
+
+	// grabbed until the request is in PrefetchDone
+	request->grab();
+	{
+		std::lock_guard<std::mutex> lock(PrefetchMutex);
+		PrefetchQueue.push_back(request);
+	}
+	PrefetchWake.notify_one();
+
+	return request;
+}
+
+
+//! Sets where a file of a prefetch request is loaded from
+void CFileSystem::setPrefetchSource(CFilePrefetchRequest* request, u32 index)
+{
+	const io::path& filename = request->getFileName(index);
+	if (filename.empty())
+		return;
+
+	// deflated files of zip archives are read here and decompressed by the jobs
+	const fschar_t last = filename.lastChar();
+	if (last != '/' && last != '\\')
+	{
+		u32 archive;
+		const s32 file = findIndexedFile(filename, archive);
+		if (file >= 0 && (UnindexedArchives.empty() || UnindexedArchives[0] > archive))
+		{
+			// only zip and gzip archives are indexed, CZipReader reads both
+			IDeflatedFileArchive* zip = static_cast<IDeflatedFileArchive*>(FileArchives[archive]);
+			core::array<u8> data;
+			u32 size;
+			if (zip->readDeflatedData((u32)file, data, size))
+			{
+				request->setDeflatedData(index, data, size);
+				return;
+			}
+		}
+	}
+
+	IReadFile* file = createAndOpenFile(filename);
+	if (!file)
+		return;
+
+	// files of archives share the file of their archive, so they are read here
+	if (file->getType() == ERFT_READ_FILE)
+		request->setSourceFile(index, file);
+	else
+	{
+		const long size = file->getSize();
+		c8* data = new c8[size > 0 ? size : 1];
+		if (size >= 0 && file->read(data, size) == (size_t)size)
+			request->setData(index, data, (u32)size);
+		else
+			delete [] data;
+	}
+	file->drop();
+}
+
+
+//! Loads the files of the queued prefetch requests, runs on PrefetchThread
+void CFileSystem::prefetchLoop()
+{
+	const u32 cores = std::thread::hardware_concurrency();
+	scene::CJobSystem jobs(cores > 1 ? cores - 1 : 0);
+
+	for (;;)
+	{
+		CFilePrefetchRequest* request;
+		{
+			std::unique_lock<std::mutex> lock(PrefetchMutex);
+			PrefetchWake.wait(lock, [this] { return PrefetchQuit || !PrefetchQueue.empty(); });
+			if (PrefetchQueue.empty())
+				return;
+
+			request = PrefetchQueue.front();
+			PrefetchQueue.pop_front();
+		}
+
+		request->addJobs(jobs);
+		jobs.wait();
+		request->setReady();
+
+		std::lock_guard<std::mutex> lock(PrefetchMutex);
+		PrefetchDone.push_back(request);
+	}
+}
+
+
+//! Drops the requests PrefetchThread is done with
+void CFileSystem::dropDonePrefetches()
+{
+	std::lock_guard<std::mutex> lock(PrefetchMutex);
+	for (u32 i=0; i < PrefetchDone.size(); ++i)
+		PrefetchDone[i]->drop();
+	PrefetchDone.clear();
 }
 
 
@@ -131,9 +399,22 @@ IWriteFile* CFileSystem::createMemoryWriteFile(void* memory, s32 len,
 
 
 //! Opens a file for write access.
-IWriteFile* CFileSystem::createAndWriteFile(const io::path& filename, bool append)
+IWriteFile* CFileSystem::createAndWriteFile(const io::path& filename, bool append, u32 bufferSize)
+{
+	clearPathCaches(false);
+	return CWriteFile::createWriteFile(filename, append, bufferSize);
+}
+
+
+//! Opens a file for writing data of a size known in advance.
+IWriteFile* CFileSystem::createSizedWriteFile(const io::path& filename, u32 size)
 {
-	return CWriteFile::createWriteFile(filename, append);
+	clearPathCaches(false);
+	IWriteFile* file = CMappedWriteFile::createMappedWriteFile(filename, (long)core::min_(size, 0x7fffffffu));
+	if (file)
+		return file;
+
+	return CWriteFile::createWriteFile(filename, false, core::min_(size, 64u * 1024));
 }
 
 
@@ -181,6 +462,8 @@ bool CFileSystem::moveFileArchive(u32 sourceIndex, s32 relative)
 		FileArchives[s] = t;
 		r = true;
 	}
+	if (r)
+		rebuildPathIndex();
 	return r;
 }
 
@@ -276,6 +559,7 @@ bool CFileSystem::addFileArchive(const io::path& filename, bool ignoreCase,
 	if (archive)
 	{
 		FileArchives.push_back(archive);
+		addToPathIndex(FileArchives.size()-1);
 		if (password.size())
 			archive->Password=password;
 		if (retArchive)
@@ -300,74 +584,162 @@ bool CFileSystem::addFileArchive(IReadFile* file, bool ignoreCase,
 
 	if (file)
 	{
-		IFileArchive* archive = 0;
-		s32 i;
+		IFileArchive* archive = createArchive(file, ignoreCase, ignorePaths, archiveType);
+
+		if (archive)
+		{
+			FileArchives.push_back(archive);
+			addToPathIndex(FileArchives.size()-1);
+			if (password.size())
+				archive->Password=password;
+			if (retArchive)
+				*retArchive = archive;
+			return true;
+		}
+		else
+		{
+			os::Printer::log("Could not create archive for", file->getFileName(), ELL_ERROR);
+		}
+	}
+
+	return false;
+}
+
+
+//! Creates an archive from an opened file with the first fitting loader
+IFileArchive* CFileSystem::createArchive(IReadFile* file, bool ignoreCase, bool ignorePaths,
+		E_FILE_ARCHIVE_TYPE archiveType) const
+{
+	IFileArchive* archive = 0;
+	s32 i;
 
-		if (archiveType == EFAT_UNKNOWN)
+	if (archiveType == EFAT_UNKNOWN)
+	{
+		// try to load archive based on file name
+		for (i = ArchiveLoader.size()-1; i >=0 ; --i)
 		{
-			// try to load archive based on file name
-			for (i = ArchiveLoader.size()-1; i >=0 ; --i)
+			if (ArchiveLoader[i]->isALoadableFileFormat(file->getFileName()))
 			{
-				if (ArchiveLoader[i]->isALoadableFileFormat(file->getFileName()))
-				{
-					archive = ArchiveLoader[i]->createArchive(file, ignoreCase, ignorePaths);
-					if (archive)
-						break;
-				}
+				archive = ArchiveLoader[i]->createArchive(file, ignoreCase, ignorePaths);
+				if (archive)
+					break;
 			}
+		}
 
-			// try to load archive based on content
-			if (!archive)
+		// try to load archive based on content
+		if (!archive)
+		{
+			for (i = ArchiveLoader.size()-1; i >= 0; --i)
 			{
-				for (i = ArchiveLoader.size()-1; i >= 0; --i)
+				file->seek(0);
+				if (ArchiveLoader[i]->isALoadableFileFormat(file))
 				{
 					file->seek(0);
-					if (ArchiveLoader[i]->isALoadableFileFormat(file))
-					{
-						file->seek(0);
-						archive = ArchiveLoader[i]->createArchive(file, ignoreCase, ignorePaths);
-						if (archive)
-							break;
-					}
+					archive = ArchiveLoader[i]->createArchive(file, ignoreCase, ignorePaths);
+					if (archive)
+						break;
 				}
 			}
 		}
-		else
+	}
+	else
+	{
+		// try to open archive based on archive loader type
+		for (i = ArchiveLoader.size()-1; i >= 0; --i)
 		{
-			// try to open archive based on archive loader type
-			for (i = ArchiveLoader.size()-1; i >= 0; --i)
+			if (ArchiveLoader[i]->isALoadableFileFormat(archiveType))
 			{
-				if (ArchiveLoader[i]->isALoadableFileFormat(archiveType))
+				// attempt to open archive
+				file->seek(0);
+				if (ArchiveLoader[i]->isALoadableFileFormat(file))
 				{
-					// attempt to open archive
 					file->seek(0);
-					if (ArchiveLoader[i]->isALoadableFileFormat(file))
-					{
-						file->seek(0);
-						archive = ArchiveLoader[i]->createArchive(file, ignoreCase, ignorePaths);
-						if (archive)
-							break;
-					}
+					archive = ArchiveLoader[i]->createArchive(file, ignoreCase, ignorePaths);
+					if (archive)
+						break;
 				}
 			}
 		}
+	}
 
-		if (archive)
+	return archive;
+}
+
+
+//! CJobSystem job creating the archive of an SArchiveJob
+void CFileSystem::createArchiveJob(void* data)
+{
+	SArchiveJob* job = (SArchiveJob*)data;
+	job->Archive = job->FileSystem->createArchive(job->File, job->IgnoreCase,
+		job->IgnorePaths, job->ArchiveType);
+}
+
+
+//! Adds several archives to the file system, reading them at the same time
+u32 CFileSystem::addFileArchives(const core::array<io::path>& filenames, bool ignoreCase,
+		bool ignorePaths, E_FILE_ARCHIVE_TYPE archiveType)
+{
+	// opening the files may read from the mounted archives, so it's done here
+	core::array<SArchiveJob> jobs(filenames.size());
+	u32 parallel = 0;
+	for (u32 i=0; i < filenames.size(); ++i)
+	{
+		SArchiveJob job = {this, 0, ignoreCase, ignorePaths, archiveType, 0};
+		if (archiveType != EFAT_FOLDER)
+			job.File = createAndOpenFile(filenames[i]);
+
+		// files of archives share the file of their archive
+		if (job.File && job.File->getType() != ERFT_READ_FILE && job.File->getType() != ERFT_MEMORY_READ_FILE)
 		{
-			FileArchives.push_back(archive);
-			if (password.size())
-				archive->Password=password;
-			if (retArchive)
-				*retArchive = archive;
-			return true;
+			job.File->drop();
+			job.File = 0;
 		}
-		else
+		if (job.File)
+			++parallel;
+		jobs.push_back(job);
+	}
+
+	const u32 cores = std::thread::hardware_concurrency();
+	if (parallel > 1 && cores > 1)
+	{
+		scene::CJobSystem workers(core::min_(cores, parallel) - 1);
+		for (u32 i=0; i < jobs.size(); ++i)
 		{
-			os::Printer::log("Could not create archive for", file->getFileName(), ELL_ERROR);
+			if (jobs[i].File)
+				workers.add(createArchiveJob, &jobs[i]);
+		}
+		workers.wait();
+	}
+	else
+	{
+		for (u32 i=0; i < jobs.size(); ++i)
+		{
+			if (jobs[i].File)
+				createArchiveJob(&jobs[i]);
 		}
 	}
 
-	return false;
+	// the archives are added in order, the others the usual way
+	u32 added = 0;
+	for (u32 i=0; i < jobs.size(); ++i)
+	{
+		if (jobs[i].File)
+		{
+			if (jobs[i].Archive)
+			{
+				FileArchives.push_back(jobs[i].Archive);
+				addToPathIndex(FileArchives.size()-1);
+				++added;
+			}
+			else
+				os::Printer::log("Could not create archive for", filenames[i], ELL_ERROR);
+			jobs[i].File->drop();
+		}
+		else if (addFileArchive(filenames[i], ignoreCase, ignorePaths, archiveType))
+			++added;
+	}
+
+	return added;
 }
 
 
@@ -385,6 +757,7 @@ bool CFileSystem::addFileArchive(IFileArchive* archive)
 		}
 		FileArchives.push_back(archive);
 		archive->grab();
+		addToPathIndex(FileArchives.size()-1);
 
 		return true;
 	}
@@ -401,6 +774,7 @@ bool CFileSystem::removeFileArchive(u32 index)
 	{
 		FileArchives[index]->drop();
 		FileArchives.erase(index);
+		rebuildPathIndex();
 		ret = true;
 	}
 	return ret;
@@ -516,11 +890,47 @@ bool CFileSystem::changeWorkingDirectoryTo(const io::path& newDirectory)
 #endif
 	}
 
+	// relative names point elsewhere now
+	clearPathCaches(true);
+
 	return success;
 }
 
 
+//! Forgets the absolute paths and existing files which were looked up
+void CFileSystem::clearPathCaches(bool absolutePaths)
+{
+	std::lock_guard<std::mutex> lock(PathCacheMutex);
+	ExistingFileCache.clear();
+	if (absolutePaths)
+		AbsolutePathCache.clear();
+}
+
+
 io::path CFileSystem::getAbsolutePath(const io::path& filename) const
+{
+	if ( filename.empty() )
+		return filename;
+
+	{
+		std::lock_guard<std::mutex> lock(PathCacheMutex);
+		auto it = AbsolutePathCache.find(filename);
+		if (it != AbsolutePathCache.end())
+			return it->second;
+	}
+
+	const io::path absolutePath = resolveAbsolutePath(filename);
+
+	std::lock_guard<std::mutex> lock(PathCacheMutex);
+	if (AbsolutePathCache.size() >= PATH_CACHE_SIZE)
+		AbsolutePathCache.clear();
+	AbsolutePathCache.emplace(filename, absolutePath);
+	return absolutePath;
+}
+
+
+//! Asks the operating system for the absolute path, getAbsolutePath() caches it
+io::path CFileSystem::resolveAbsolutePath(const io::path& filename) const
 {
 	if ( filename.empty() )
 		return filename;
@@ -730,7 +1140,29 @@ EFileSystemType CFileSystem::setFileListSystem(EFileSystemType listType)
 //! Creates a list of files and directories in the current working directory
 IFileList* CFileSystem::createFileList()
 {
-	CFileList* r = 0;
+	CFileListRequest* request = createFileListRequest(true);
+	if (!request->isReady())
+		request->run();
+
+	IFileList* r = request->createFileList();
+	request->drop();
+	return r;
+}
+
+
+//! Lists the current working directory on a worker thread
+IFileListRequest* CFileSystem::createFileListAsync(bool fetchSizes)
+{
+	CFileListRequest* request = createFileListRequest(fetchSizes);
+	if (!request->isReady())
+		request->start();
+	return request;
+}
+
+
+//! Creates the listing of the working directory, ready unless it has to be read from disk
+CFileListRequest* CFileSystem::createFileListRequest(bool fetchSizes)
+{
 	io::path Path = getWorkingDirectory();
 	Path.replace('\\', '/');
 	if (!Path.empty() && Path.lastChar() != '/')
@@ -739,109 +1171,38 @@ IFileList* CFileSystem::createFileList()
 	//! Construct from native filesystem
 	if (FileSystemType == FILESYSTEM_NATIVE)
 	{
-		// --------------------------------------------
-		//! Windows version
-		#ifdef _IRR_WINDOWS_API_
-
-		r = new CFileList(Path, true, false);
-
-		// TODO: Should be unified once mingw adapts the proper types
-#if defined(__GNUC__)
-		long hFile; //mingw return type declaration
+		// the names of files on windows are compared ignoring case
+#ifdef _IRR_WINDOWS_API_
+		return new CFileListRequest(Path, true, fetchSizes);
 #else
-		intptr_t hFile;
+		return new CFileListRequest(Path, false, fetchSizes);
 #endif
+	}
 
-		struct _tfinddata_t c_file;
-		if( (hFile = _tfindfirst( _T("*"), &c_file )) != -1L )
-		{
-			do
-			{
-				r->addItem(Path + c_file.name, 0, c_file.size, (_A_SUBDIR & c_file.attrib) != 0, 0);
-			}
-			while( _tfindnext( hFile, &c_file ) == 0 );
-
-			_findclose( hFile );
-		}
-
-		#endif
-
-		// --------------------------------------------
-		//! Linux version
-		#if (defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_))
-
-
-		r = new CFileList(Path, false, false);
-
-		r->addItem(Path + _IRR_TEXT(".."), 0, 0, true, 0);
+	//! create file list for the virtual filesystem
+	CFileListRequest* r = new CFileListRequest(Path, false, fetchSizes);
 
-		//! We use the POSIX compliant methods instead of scandir
-		DIR* dirHandle=opendir(Path.c_str());
-		if (dirHandle)
-		{
-			struct dirent *dirEntry;
-			while ((dirEntry=readdir(dirHandle)))
-			{
-				u32 size = 0;
-				bool isDirectory = false;
+	//! PWD
+	r->addEntry(Path + _IRR_TEXT("."), 0, 0, true);
 
-				if((strcmp(dirEntry->d_name, ".")==0) ||
-				   (strcmp(dirEntry->d_name, "..")==0))
-				{
-					continue;
-				}
-				struct stat buf;
-				if (stat(dirEntry->d_name, &buf)==0)
-				{
-					size = buf.st_size;
-					isDirectory = S_ISDIR(buf.st_mode);
-				}
-				#if !defined(_IRR_SOLARIS_PLATFORM_) && !defined(__CYGWIN__)
-				// only available on some systems
-				else
-				{
-					isDirectory = dirEntry->d_type == DT_DIR;
-				}
-				#endif
+	//! parent
+	r->addEntry(Path + _IRR_TEXT(".."), 0, 0, true);
 
-				r->addItem(Path + dirEntry->d_name, 0, size, isDirectory, 0);
-			}
-			closedir(dirHandle);
-		}
-		#endif
-	}
-	else
+	//! merge archives
+	for (u32 i=0; i < FileArchives.size(); ++i)
 	{
-		//! create file list for the virtual filesystem
-		r = new CFileList(Path, false, false);
+		const IFileList *merge = FileArchives[i]->getFileList();
 
-		//! add relative navigation
-		SFileListEntry e2;
-		SFileListEntry e3;
-
-		//! PWD
-		r->addItem(Path + _IRR_TEXT("."), 0, 0, true, 0);
-
-		//! parent
-		r->addItem(Path + _IRR_TEXT(".."), 0, 0, true, 0);
-
-		//! merge archives
-		for (u32 i=0; i < FileArchives.size(); ++i)
+		for (u32 j=0; j < merge->getFileCount(); ++j)
 		{
-			const IFileList *merge = FileArchives[i]->getFileList();
-
-			for (u32 j=0; j < merge->getFileCount(); ++j)
+			if (core::isInSameDirectory(Path, merge->getFullFileName(j)) == 0)
 			{
-				if (core::isInSameDirectory(Path, merge->getFullFileName(j)) == 0)
-				{
-					r->addItem(merge->getFullFileName(j), merge->getFileOffset(j), merge->getFileSize(j), merge->isDirectory(j), 0);
-				}
+				r->addEntry(merge->getFullFileName(j), merge->getFileOffset(j), merge->getFileSize(j), merge->isDirectory(j));
 			}
 		}
 	}
 
-	if (r)
-		r->sort();
+	r->setReady();
 	return r;
 }
 
@@ -855,9 +1216,42 @@ IFileList* CFileSystem::createEmptyFileList(const io::path& path, bool ignoreCas
 //! determines if a file exists and would be able to be opened.
 bool CFileSystem::existFile(const io::path& filename) const
 {
-	for (u32 i=0; i < FileArchives.size(); ++i)
-		if (FileArchives[i]->getFileList()->findFile(filename)!=-1)
+	{
+		std::lock_guard<std::mutex> lock(PathCacheMutex);
+		auto it = ExistingFileCache.find(filename);
+		if (it != ExistingFileCache.end())
+			return it->second;
+	}
+
+	const bool exists = findExistingFile(filename);
+
+	std::lock_guard<std::mutex> lock(PathCacheMutex);
+	if (ExistingFileCache.size() >= PATH_CACHE_SIZE)
+		ExistingFileCache.clear();
+	ExistingFileCache.emplace(filename, exists);
+	return exists;
+}
+
+
+//! Searches the archives and the disk for a file, existFile() caches the result
+bool CFileSystem::findExistingFile(const io::path& filename) const
+{
+	const c8 last = filename.lastChar();
+	if (last == '/' || last == '\\')
+	{
+		for (u32 i=0; i < FileArchives.size(); ++i)
+			if (FileArchives[i]->getFileList()->findFile(filename)!=-1)
+				return true;
+	}
+	else
+	{
+		u32 archive;
+		if (findIndexedFile(filename, archive) != -1)
 			return true;
+		for (u32 i=0; i < UnindexedArchives.size(); ++i)
+			if (FileArchives[UnindexedArchives[i]]->getFileList()->findFile(filename)!=-1)
+				return true;
+	}
 
 #if defined(_MSC_VER)
 		return (_access(filename.c_str(), 0) != -1);
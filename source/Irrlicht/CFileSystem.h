@@ -7,6 +7,12 @@
 
 #include "IFileSystem.h"
 #include "irrArray.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace irr
 {
@@ -14,6 +20,9 @@ namespace io
 {
 
 	class CZipReader;
+	class CZipEntryCache;
+	class CFilePrefetchRequest;
+	class CFileListRequest;
 
 /*!
 	FileSystem which uses normal files and one zipfile
@@ -31,6 +40,16 @@ public:
 	//! opens a file for read access
 	IReadFile* createAndOpenFile(const io::path& filename) override;
 
+	//! Set from which size on files on disk are opened through a memory mapping
+	void setMemoryMappingThreshold(long size) override;
+
+	//! Set the memory budget of the cache of decompressed files from zip archives
+	void setDecompressedFileCacheSize(u32 size) override;
+
+	//! Reads and decompresses files on worker threads
+	IFilePrefetchRequest* prefetchFiles(const core::array<io::path>& filenames,
+			IFilePrefetchCallback* callback=0) override;
+
 	//! Creates an IReadFile interface for accessing memory like a file.
 	IReadFile* createMemoryReadFile(const void* memory, s32 len, const io::path& fileName, bool deleteMemoryWhenDropped = false) override;
 
@@ -41,7 +60,10 @@ public:
 	IWriteFile* createMemoryWriteFile(void* memory, s32 len, const io::path& fileName, bool deleteMemoryWhenDropped=false) override;
 
 	//! Opens a file for write access.
-	IWriteFile* createAndWriteFile(const io::path& filename, bool append=false) override;
+	IWriteFile* createAndWriteFile(const io::path& filename, bool append=false, u32 bufferSize=64*1024) override;
+
+	//! Opens a file for writing data of a size known in advance.
+	IWriteFile* createSizedWriteFile(const io::path& filename, u32 size) override;
 
 	//! Adds an archive to the file system.
 	virtual bool addFileArchive(const io::path& filename,
@@ -60,6 +82,10 @@ public:
 	//! Adds an archive to the file system.
 	bool addFileArchive(IFileArchive* archive) override;
 
+	//! Adds several archives to the file system, reading them at the same time
+	u32 addFileArchives(const core::array<io::path>& filenames, bool ignoreCase=true,
+			bool ignorePaths=true, E_FILE_ARCHIVE_TYPE archiveType=EFAT_UNKNOWN) override;
+
 	//! move the hirarchy of the filesystem. moves sourceIndex relative up or down
 	bool moveFileArchive(u32 sourceIndex, s32 relative) override;
 
@@ -119,6 +145,9 @@ public:
 	//! and returns it.
 	IFileList* createFileList() override;
 
+	//! Lists the current working directory on a worker thread
+	IFileListRequest* createFileListAsync(bool fetchSizes=true) override;
+
 	//! Creates an empty filelist
 	IFileList* createEmptyFileList(const io::path& path, bool ignoreCase, bool ignorePaths) override;
 
@@ -127,6 +156,77 @@ public:
 
 private:
 
+	struct PathHash
+	{
+		size_t operator()(const io::path& p) const
+		{
+			// FNV-1a
+			size_t hash = 2166136261u;
+			for (u32 i=0; i<p.size(); ++i)
+				hash = (hash ^ (size_t)p[i]) * 16777619u;
+			return hash;
+		}
+	};
+
+	//! File of an indexed archive
+	struct SPathIndexEntry
+	{
+		//! Position of the archive in FileArchives
+		u32 Archive;
+		//! Index in the file list of the archive
+		u32 File;
+	};
+
+	//! An archive created by addFileArchives()
+	struct SArchiveJob
+	{
+		const CFileSystem* FileSystem;
+		IReadFile* File;
+		bool IgnoreCase;
+		bool IgnorePaths;
+		E_FILE_ARCHIVE_TYPE ArchiveType;
+		IFileArchive* Archive;
+	};
+
+	//! CJobSystem job creating the archive of an SArchiveJob
+	static void createArchiveJob(void* data);
+
+	//! Creates an archive from an opened file with the first fitting loader
+	IFileArchive* createArchive(IReadFile* file, bool ignoreCase, bool ignorePaths,
+			E_FILE_ARCHIVE_TYPE archiveType) const;
+
+	//! Sets where a file of a prefetch request is loaded from
+	void setPrefetchSource(CFilePrefetchRequest* request, u32 index);
+
+	//! Loads the files of the queued prefetch requests, runs on PrefetchThread
+	void prefetchLoop();
+
+	//! Drops the requests PrefetchThread is done with
+	void dropDonePrefetches();
+
+	//! Adds the files of an archive, which has a lower priority than all indexed ones
+	void addToPathIndex(u32 archive);
+
+	//! Builds the index again, after archives were removed or moved
+	void rebuildPathIndex();
+
+	//! Finds the indexed archive with the highest priority which has the file
+	/** \param archive Receives the position of the archive, FileArchives.size() if none has it.
+	\return Index in the file list of the archive, -1 if none has it. */
+	s32 findIndexedFile(const io::path& filename, u32& archive) const;
+
+	//! Creates the listing of the working directory, ready unless it has to be read from disk
+	CFileListRequest* createFileListRequest(bool fetchSizes);
+
+	//! Asks the operating system for the absolute path, getAbsolutePath() caches it
+	io::path resolveAbsolutePath(const io::path& filename) const;
+
+	//! Searches the archives and the disk for a file, existFile() caches the result
+	bool findExistingFile(const io::path& filename) const;
+
+	//! Forgets the absolute paths and existing files which were looked up
+	void clearPathCaches(bool absolutePaths);
+
 	//! Currently used FileSystemType
 	EFileSystemType FileSystemType;
 	//! WorkingDirectory for Native and Virtual filesystems
@@ -135,6 +235,34 @@ private:
 	core::array<IArchiveLoader*> ArchiveLoader;
 	//! currently attached Archives
 	core::array<IFileArchive*> FileArchives;
+	//! Files of the archives using a CFileList, by lower case name with path.
+	//! Holds the archive with the highest priority of each name.
+	std::unordered_map<io::path, SPathIndexEntry, PathHash> PathIndex;
+	//! The same for archives which ignore paths, by lower case name without path
+	std::unordered_map<io::path, SPathIndexEntry, PathHash> NameIndex;
+	//! Positions of the archives which find their files on their own, ascending
+	core::array<u32> UnindexedArchives;
+	//! Files on disk of at least this size are mapped, negative for none
+	long MemoryMappingThreshold;
+	//! Small decompressed files of the zip archives
+	std::shared_ptr<CZipEntryCache> DecompressedFileCache;
+
+	//! Results of getAbsolutePath() and existFile() by the name asked for,
+	//! emptied when they get too large
+	mutable std::unordered_map<io::path, io::path, PathHash> AbsolutePathCache;
+	mutable std::unordered_map<io::path, bool, PathHash> ExistingFileCache;
+	//! guards the path caches, textures and meshes may be looked up from several threads
+	mutable std::mutex PathCacheMutex;
+
+	//! Started by the first prefetchFiles() call
+	std::thread PrefetchThread;
+	//! guards PrefetchQueue, PrefetchDone and PrefetchQuit
+	std::mutex PrefetchMutex;
+	std::condition_variable PrefetchWake;
+	std::deque<CFilePrefetchRequest*> PrefetchQueue;
+	//! requests PrefetchThread is done with, dropped on the thread adding requests
+	core::array<CFilePrefetchRequest*> PrefetchDone;
+	bool PrefetchQuit;
 };
 
 
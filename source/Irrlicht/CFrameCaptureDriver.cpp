@@ -0,0 +1,785 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CFrameCaptureDriver.h"
+#include "IWriteFile.h"
+#include "IMeshBuffer.h"
+#include "IImage.h"
+#include "IRenderTarget.h"
+#include "S3DInstance.h"
+#include "os.h"
+#include <cstring>
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	void setRect(s32* dest, const core::rect<s32>& rect)
+	{
+		dest[0] = rect.UpperLeftCorner.X;
+		dest[1] = rect.UpperLeftCorner.Y;
+		dest[2] = rect.LowerRightCorner.X;
+		dest[3] = rect.LowerRightCorner.Y;
+	}
+
+	SFrameCaptureClear getClear(u16 flags, SColor color, f32 depth, u8 stencil)
+	{
+		SFrameCaptureClear clear;
+		clear.Flags = flags;
+		clear.Color = color.color;
+		clear.Depth = depth;
+		clear.Stencil = stencil;
+		return clear;
+	}
+}
+
+
+CFrameCaptureDriver::CFrameCaptureDriver(IVideoDriver* driver)
+	: Driver(driver), File(0), Payloads(false), Capturing(false),
+	NextTextureID(1), NextMeshBufferID(1)
+{
+	#ifdef _DEBUG
+	setDebugName("CFrameCaptureDriver");
+	#endif
+
+	Driver->grab();
+}
+
+
+CFrameCaptureDriver::~CFrameCaptureDriver()
+{
+	if (File)
+		File->drop();
+	Driver->drop();
+}
+
+
+bool CFrameCaptureDriver::captureFrame(io::IWriteFile* file, bool payloads)
+{
+	if (!file || Capturing)
+		return false;
+
+	file->grab();
+	if (File)
+		File->drop();
+	File = file;
+	Payloads = payloads;
+	return true;
+}
+
+
+bool CFrameCaptureDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil,
+		const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
+{
+	if (File)
+	{
+		Capturing = true;
+		Textures.clear();
+		MeshBuffers.clear();
+		NextTextureID = 1;
+		NextMeshBufferID = 1;
+
+		SFrameCaptureHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.Magic, "IRRCAPT", 8);
+		header.Version = FRAME_CAPTURE_VERSION;
+		header.DriverType = Driver->getDriverType();
+		header.ScreenSize[0] = Driver->getScreenSize().Width;
+		header.ScreenSize[1] = Driver->getScreenSize().Height;
+		header.Payloads = Payloads ? 1 : 0;
+		writeValue(header);
+
+		writeCommand(EFCC_BEGIN_SCENE);
+		writeValue(getClear(clearFlag, clearColor, clearDepth, clearStencil));
+	}
+
+	return Driver->beginScene(clearFlag, clearColor, clearDepth, clearStencil, videoData, sourceRect);
+}
+
+
+bool CFrameCaptureDriver::endScene()
+{
+	if (Capturing)
+	{
+		writeCommand(EFCC_END_SCENE);
+
+		File->drop();
+		File = 0;
+		Capturing = false;
+
+		// the textures and buffers may be gone before the next capture
+		Textures.clear();
+		MeshBuffers.clear();
+
+		os::Printer::log("Captured frame", ELL_INFORMATION);
+	}
+
+	return Driver->endScene();
+}
+
+
+void CFrameCaptureDriver::write(const void* data, u32 size)
+{
+	File->write(data, size);
+}
+
+
+void CFrameCaptureDriver::writePadding(u32 size)
+{
+	static const u8 zeros[3] = {0, 0, 0};
+	if (size & 3)
+		write(zeros, 4 - (size & 3));
+}
+
+
+void CFrameCaptureDriver::writeCommand(E_FRAME_CAPTURE_COMMAND command)
+{
+	writeValue((u32)command);
+}
+
+
+void CFrameCaptureDriver::writeMatrix(const core::matrix4& matrix)
+{
+	write(matrix.pointer(), 16 * sizeof(f32));
+}
+
+
+u32 CFrameCaptureDriver::captureTexture(const ITexture* texture)
+{
+	if (!texture)
+		return 0;
+
+	auto it = Textures.find(texture);
+	if (it != Textures.end())
+		return it->second;
+
+	const u32 id = NextTextureID++;
+	Textures[texture] = id;
+
+	SFrameCaptureTexture record;
+	memset(&record, 0, sizeof(record));
+	record.ID = id;
+	record.Type = texture->getType();
+	record.Size[0] = texture->getSize().Width;
+	record.Size[1] = texture->getSize().Height;
+	record.ColorFormat = texture->getColorFormat();
+	record.RenderTarget = texture->isRenderTarget() ? 1 : 0;
+
+	const io::path& name = texture->getName().getPath();
+	record.NameLength = name.size();
+
+	// render targets get their content in the frame, and compressed or
+	// depth textures can't be read back by all drivers
+	const ECOLOR_FORMAT format = texture->getColorFormat();
+	const u32 layers = texture->getType() == ETT_CUBEMAP ? 6 : 1;
+	const u32 rowBytes = IImage::getDataSizeFromFormat(format, record.Size[0], 1);
+	const u32 layerBytes = rowBytes * record.Size[1];
+	TextureData.set_used(0);
+	if (!texture->isRenderTarget() && !IImage::isCompressedFormat(format) && !IImage::isDepthFormat(format) && layerBytes)
+	{
+		ITexture* lockable = const_cast<ITexture*>(texture);
+		TextureData.set_used(layers * layerBytes);
+		for (u32 layer = 0; layer < layers; ++layer)
+		{
+			const u8* pixels = static_cast<const u8*>(lockable->lock(ETLM_READ_ONLY, 0, layer));
+			if (!pixels)
+			{
+				TextureData.set_used(0);
+				break;
+			}
+
+			const u32 pitch = lockable->getPitch() ? lockable->getPitch() : rowBytes;
+			for (u32 y = 0; y < record.Size[1]; ++y)
+				memcpy(TextureData.pointer() + layer * layerBytes + y * rowBytes, pixels + y * pitch, rowBytes);
+			lockable->unlock();
+		}
+	}
+
+	if (TextureData.size())
+	{
+		record.Hash = FRAME_CAPTURE_HASH_SEED;
+		hashFrameCaptureData(record.Hash, TextureData.const_pointer(), TextureData.size());
+		if (Payloads)
+			record.PayloadLayers = layers;
+	}
+
+	writeCommand(EFCC_TEXTURE);
+	writeValue(record);
+	write(name.c_str(), name.size());
+	writePadding(name.size());
+	for (u32 layer = 0; layer < record.PayloadLayers; ++layer)
+	{
+		writeValue(layerBytes);
+		write(TextureData.const_pointer() + layer * layerBytes, layerBytes);
+		writePadding(layerBytes);
+	}
+
+	return id;
+}
+
+
+u32 CFrameCaptureDriver::captureMeshBuffer(const scene::IMeshBuffer* mb)
+{
+	auto it = MeshBuffers.find(mb);
+	const bool known = it != MeshBuffers.end();
+	if (known && it->second.ChangedID_Vertex == mb->getChangedID_Vertex()
+		&& it->second.ChangedID_Index == mb->getChangedID_Index())
+		return it->second.ID;
+
+	// a changed buffer is written again under its number
+	SMeshBufferState& state = MeshBuffers[mb];
+	if (!known)
+		state.ID = NextMeshBufferID++;
+	state.ChangedID_Vertex = mb->getChangedID_Vertex();
+	state.ChangedID_Index = mb->getChangedID_Index();
+
+	SFrameCaptureMeshBuffer record;
+	memset(&record, 0, sizeof(record));
+	record.ID = state.ID;
+	record.VertexType = mb->getVertexType();
+	record.IndexType = mb->getIndexType();
+	record.PrimitiveType = mb->getPrimitiveType();
+	record.VertexCount = mb->getVertexCount();
+	record.IndexCount = mb->getIndexCount();
+	record.MappingHint[0] = mb->getHardwareMappingHint_Vertex();
+	record.MappingHint[1] = mb->getHardwareMappingHint_Index();
+	if (mb->getCompactVertices())
+		record.Flags |= EFCMF_COMPACT_VERTICES;
+	if (mb->getSeparateVertexStreams())
+		record.Flags |= EFCMF_SEPARATE_VERTEX_STREAMS;
+	if (mb->getGPUOnly())
+		record.Flags |= EFCMF_GPU_ONLY;
+	const core::aabbox3df& box = mb->getBoundingBox();
+	memcpy(record.BoundingBox, &box.MinEdge.X, 3 * sizeof(f32));
+	memcpy(record.BoundingBox + 3, &box.MaxEdge.X, 3 * sizeof(f32));
+
+	const u32 vertexBytes = getVertexPitchFromType(mb->getVertexType()) * record.VertexCount;
+	const u32 indexBytes = record.IndexCount * (mb->getIndexType() == EIT_16BIT ? sizeof(u16) : sizeof(u32));
+	const bool hasData = !mb->isClientDataReleased() && mb->getVertices() && (mb->getIndices() || !indexBytes);
+	if (hasData)
+	{
+		record.Hash = FRAME_CAPTURE_HASH_SEED;
+		hashFrameCaptureData(record.Hash, mb->getVertices(), vertexBytes);
+		hashFrameCaptureData(record.Hash, mb->getIndices(), indexBytes);
+		record.Payload = Payloads ? 1 : 0;
+	}
+
+	writeCommand(EFCC_MESH_BUFFER);
+	writeValue(record);
+	if (record.Payload)
+	{
+		write(mb->getVertices(), vertexBytes);
+		write(mb->getIndices(), indexBytes);
+		writePadding(indexBytes);
+	}
+
+	return state.ID;
+}
+
+
+void CFrameCaptureDriver::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat)
+{
+	if (Capturing)
+	{
+		writeCommand(EFCC_TRANSFORM);
+		writeValue((u32)state);
+		writeMatrix(mat);
+	}
+
+	Driver->setTransform(state, mat);
+}
+
+
+void CFrameCaptureDriver::setMaterial(const SMaterial& material)
+{
+	if (Capturing)
+	{
+		// the replay has no override, so it gets the material as the driver does
+		SMaterial overridden(material);
+		Driver->getOverrideMaterial().apply(overridden);
+
+		SFrameCaptureMaterial record;
+		memset(&record, 0, sizeof(record));
+		for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i)
+		{
+			const SMaterialLayer& layer = overridden.TextureLayer[i];
+			SFrameCaptureMaterialLayer& captured = record.Layer[i];
+			captured.Texture = captureTexture(layer.Texture);
+			captured.TextureWrap[0] = layer.TextureWrapU;
+			captured.TextureWrap[1] = layer.TextureWrapV;
+			captured.TextureWrap[2] = layer.TextureWrapW;
+			captured.BilinearFilter = layer.BilinearFilter;
+			captured.TrilinearFilter = layer.TrilinearFilter;
+			captured.AnisotropicFilter = layer.AnisotropicFilter;
+			captured.LODBias = layer.LODBias;
+			const core::matrix4& textureMatrix = layer.getTextureMatrix();
+			captured.HasTextureMatrix = textureMatrix.isIdentity() ? 0 : 1;
+			memcpy(captured.TextureMatrix, textureMatrix.pointer(), 16 * sizeof(f32));
+		}
+		record.MaterialType = overridden.MaterialType;
+		record.AmbientColor = overridden.AmbientColor.color;
+		record.DiffuseColor = overridden.DiffuseColor.color;
+		record.EmissiveColor = overridden.EmissiveColor.color;
+		record.SpecularColor = overridden.SpecularColor.color;
+		record.Shininess = overridden.Shininess;
+		record.MaterialTypeParam = overridden.MaterialTypeParam;
+		record.MaterialTypeParam2 = overridden.MaterialTypeParam2;
+		record.Thickness = overridden.Thickness;
+		record.BlendFactor = overridden.BlendFactor;
+		record.PolygonOffsetDepthBias = overridden.PolygonOffsetDepthBias;
+		record.PolygonOffsetSlopeScale = overridden.PolygonOffsetSlopeScale;
+		record.ZBuffer = overridden.ZBuffer;
+		record.AntiAliasing = overridden.AntiAliasing;
+		record.ColorMask = overridden.ColorMask;
+		record.ColorMaterial = overridden.ColorMaterial;
+		record.BlendOperation = overridden.BlendOperation;
+		record.PolygonOffsetFactor = overridden.PolygonOffsetFactor;
+		record.PolygonOffsetDirection = overridden.PolygonOffsetDirection;
+		record.ZWriteEnable = overridden.ZWriteEnable;
+		record.Wireframe = overridden.Wireframe;
+		record.PointCloud = overridden.PointCloud;
+		record.GouraudShading = overridden.GouraudShading;
+		record.Lighting = overridden.Lighting;
+		record.BackfaceCulling = overridden.BackfaceCulling;
+		record.FrontfaceCulling = overridden.FrontfaceCulling;
+		record.FogEnable = overridden.FogEnable;
+		record.NormalizeNormals = overridden.NormalizeNormals;
+		record.UseMipMaps = overridden.UseMipMaps;
+
+		writeCommand(EFCC_MATERIAL);
+		writeValue(record);
+	}
+
+	Driver->setMaterial(material);
+}
+
+
+bool CFrameCaptureDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SColor clearColor,
+		f32 clearDepth, u8 clearStencil)
+{
+	if (Capturing)
+	{
+		SFrameCaptureRenderTarget record;
+		memset(&record, 0, sizeof(record));
+		core::array<u32> textures;
+		if (target)
+		{
+			const core::array<ITexture*>& colors = target->getTexture();
+			for (u32 i = 0; i < colors.size(); ++i)
+				textures.push_back(captureTexture(colors[i]));
+			record.DepthStencil = captureTexture(target->getDepthStencil());
+		}
+		record.ColorTextureCount = textures.size();
+		record.Clear = getClear(clearFlag, clearColor, clearDepth, clearStencil);
+
+		writeCommand(EFCC_RENDER_TARGET);
+		writeValue(record);
+		write(textures.const_pointer(), textures.size() * sizeof(u32));
+	}
+
+	return Driver->setRenderTargetEx(target, clearFlag, clearColor, clearDepth, clearStencil);
+}
+
+
+bool CFrameCaptureDriver::setRenderTarget(ITexture* texture, u16 clearFlag, SColor clearColor,
+		f32 clearDepth, u8 clearStencil)
+{
+	if (Capturing)
+	{
+		SFrameCaptureRenderTarget record;
+		memset(&record, 0, sizeof(record));
+		const u32 id = captureTexture(texture);
+		record.TextureTarget = 1;
+		record.ColorTextureCount = id ? 1 : 0;
+		record.Clear = getClear(clearFlag, clearColor, clearDepth, clearStencil);
+
+		writeCommand(EFCC_RENDER_TARGET);
+		writeValue(record);
+		write(&id, record.ColorTextureCount * sizeof(u32));
+	}
+
+	return Driver->setRenderTarget(texture, clearFlag, clearColor, clearDepth, clearStencil);
+}
+
+
+void CFrameCaptureDriver::setViewPort(const core::rect<s32>& area)
+{
+	if (Capturing)
+	{
+		s32 rect[4];
+		setRect(rect, area);
+		writeCommand(EFCC_VIEWPORT);
+		writeValue(rect);
+	}
+
+	Driver->setViewPort(area);
+}
+
+
+void CFrameCaptureDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
+{
+	if (Capturing)
+	{
+		writeCommand(EFCC_CLEAR);
+		writeValue(getClear(flag, color, depth, stencil));
+	}
+
+	Driver->clearBuffers(flag, color, depth, stencil);
+}
+
+
+void CFrameCaptureDriver::setFog(SColor color, E_FOG_TYPE fogType, f32 start, f32 end,
+		f32 density, bool pixelFog, bool rangeFog)
+{
+	if (Capturing)
+	{
+		SFrameCaptureFog record;
+		record.Color = color.color;
+		record.Type = fogType;
+		record.Start = start;
+		record.End = end;
+		record.Density = density;
+		record.PixelFog = pixelFog ? 1 : 0;
+		record.RangeFog = rangeFog ? 1 : 0;
+
+		writeCommand(EFCC_FOG);
+		writeValue(record);
+	}
+
+	Driver->setFog(color, fogType, start, end, density, pixelFog, rangeFog);
+}
+
+
+void CFrameCaptureDriver::captureVertices(E_FRAME_CAPTURE_COMMAND command, const void* vertices, u32 vertexCount,
+		const void* indexList, u32 primCount, E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+{
+	SFrameCaptureVertices record;
+	record.VertexType = vType;
+	record.PrimitiveType = pType;
+	record.IndexType = iType;
+	record.VertexCount = vertexCount;
+	record.PrimitiveCount = primCount;
+	record.IndexCount = getFrameCaptureIndexCount(pType, primCount);
+	record.Payload = Payloads && vertices && indexList ? 1 : 0;
+
+	writeCommand(command);
+	writeValue(record);
+	if (record.Payload)
+	{
+		const u32 indexBytes = record.IndexCount * (iType == EIT_16BIT ? sizeof(u16) : sizeof(u32));
+		write(vertices, getVertexPitchFromType(vType) * vertexCount);
+		write(indexList, indexBytes);
+		writePadding(indexBytes);
+	}
+}
+
+
+void CFrameCaptureDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount, const void* indexList,
+		u32 primCount, E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+{
+	if (Capturing)
+		captureVertices(EFCC_DRAW_VERTICES, vertices, vertexCount, indexList, primCount, vType, pType, iType);
+
+	Driver->drawVertexPrimitiveList(vertices, vertexCount, indexList, primCount, vType, pType, iType);
+}
+
+
+void CFrameCaptureDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCount, const void* indexList,
+		u32 primCount, E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+{
+	if (Capturing)
+		captureVertices(EFCC_DRAW_2D_VERTICES, vertices, vertexCount, indexList, primCount, vType, pType, iType);
+
+	Driver->draw2DVertexPrimitiveList(vertices, vertexCount, indexList, primCount, vType, pType, iType);
+}
+
+
+void CFrameCaptureDriver::draw3DLine(const core::vector3df& start, const core::vector3df& end, SColor color)
+{
+	if (Capturing)
+	{
+		writeCommand(EFCC_DRAW_3D_LINE);
+		write(&start.X, 3 * sizeof(f32));
+		write(&end.X, 3 * sizeof(f32));
+		writeValue(color.color);
+	}
+
+	Driver->draw3DLine(start, end, color);
+}
+
+
+void CFrameCaptureDriver::draw3DBox(const core::aabbox3d<f32>& box, SColor color)
+{
+	if (Capturing)
+	{
+		writeCommand(EFCC_DRAW_3D_BOX);
+		write(&box.MinEdge.X, 3 * sizeof(f32));
+		write(&box.MaxEdge.X, 3 * sizeof(f32));
+		writeValue(color.color);
+	}
+
+	Driver->draw3DBox(box, color);
+}
+
+
+void CFrameCaptureDriver::capture2DImage(E_FRAME_CAPTURE_COMMAND command, const ITexture* texture, u32 overload,
+		const core::rect<s32>& destRect, const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+		const SColor* colors, bool useAlphaChannelOfTexture)
+{
+	SFrameCapture2DImage record;
+	memset(&record, 0, sizeof(record));
+	record.Texture = captureTexture(texture);
+	setRect(record.DestRect, destRect);
+	setRect(record.SourceRect, sourceRect);
+	if (clipRect)
+	{
+		setRect(record.ClipRect, *clipRect);
+		record.HasClipRect = 1;
+	}
+	for (u32 i = 0; i < 4; ++i)
+		record.Colors[i] = colors ? colors[i].color : 0xffffffff;
+	record.Overload = overload;
+	record.UseAlphaChannel = useAlphaChannelOfTexture ? 1 : 0;
+
+	writeCommand(command);
+	writeValue(record);
+}
+
+
+void CFrameCaptureDriver::draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+		bool useAlphaChannelOfTexture)
+{
+	if (Capturing && texture)
+	{
+		const core::rect<s32> source(core::position2d<s32>(0, 0), core::dimension2di(texture->getOriginalSize()));
+		capture2DImage(EFCC_DRAW_2D_IMAGE, texture, 2, core::rect<s32>(destPos, source.getSize()), source,
+			0, 0, useAlphaChannelOfTexture);
+	}
+
+	Driver->draw2DImage(texture, destPos, useAlphaChannelOfTexture);
+}
+
+
+void CFrameCaptureDriver::draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+		SColor color, bool useAlphaChannelOfTexture)
+{
+	if (Capturing && texture)
+	{
+		const SColor colors[] = {color, color, color, color};
+		capture2DImage(EFCC_DRAW_2D_IMAGE, texture, 0, core::rect<s32>(destPos, sourceRect.getSize()), sourceRect,
+			clipRect, colors, useAlphaChannelOfTexture);
+	}
+
+	Driver->draw2DImage(texture, destPos, sourceRect, clipRect, color, useAlphaChannelOfTexture);
+}
+
+
+void CFrameCaptureDriver::draw2DImage(const video::ITexture* texture, const core::rect<s32>& destRect,
+		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+		const video::SColor * const colors, bool useAlphaChannelOfTexture)
+{
+	if (Capturing && texture)
+		capture2DImage(EFCC_DRAW_2D_IMAGE, texture, 1, destRect, sourceRect, clipRect, colors, useAlphaChannelOfTexture);
+
+	Driver->draw2DImage(texture, destRect, sourceRect, clipRect, colors, useAlphaChannelOfTexture);
+}
+
+
+void CFrameCaptureDriver::draw2DImageBatch(const video::ITexture* texture,
+		const core::array<core::position2d<s32> >& positions,
+		const core::array<core::rect<s32> >& sourceRects,
+		const core::rect<s32>* clipRect, SColor color,
+		bool useAlphaChannelOfTexture)
+{
+	if (Capturing && texture)
+	{
+		const SColor colors[] = {color, color, color, color};
+		capture2DImage(EFCC_DRAW_2D_IMAGE_BATCH, texture, 0, core::rect<s32>(), core::rect<s32>(),
+			clipRect, colors, useAlphaChannelOfTexture);
+
+		const u32 count = core::min_(positions.size(), sourceRects.size());
+		writeValue(count);
+		for (u32 i = 0; i < count; ++i)
+		{
+			s32 item[6];
+			item[0] = positions[i].X;
+			item[1] = positions[i].Y;
+			setRect(item + 2, sourceRects[i]);
+			writeValue(item);
+		}
+	}
+
+	Driver->draw2DImageBatch(texture, positions, sourceRects, clipRect, color, useAlphaChannelOfTexture);
+}
+
+
+void CFrameCaptureDriver::draw2DRectangle(SColor color, const core::rect<s32>& pos, const core::rect<s32>* clip)
+{
+	if (Capturing)
+	{
+		SFrameCapture2DRectangle record;
+		memset(&record, 0, sizeof(record));
+		setRect(record.Rect, pos);
+		if (clip)
+		{
+			setRect(record.ClipRect, *clip);
+			record.HasClipRect = 1;
+		}
+		for (u32 i = 0; i < 4; ++i)
+			record.Colors[i] = color.color;
+
+		writeCommand(EFCC_DRAW_2D_RECTANGLE);
+		writeValue(record);
+	}
+
+	Driver->draw2DRectangle(color, pos, clip);
+}
+
+
+void CFrameCaptureDriver::draw2DRectangle(const core::rect<s32>& pos, SColor colorLeftUp, SColor colorRightUp,
+		SColor colorLeftDown, SColor colorRightDown, const core::rect<s32>* clip)
+{
+	if (Capturing)
+	{
+		SFrameCapture2DRectangle record;
+		memset(&record, 0, sizeof(record));
+		setRect(record.Rect, pos);
+		if (clip)
+		{
+			setRect(record.ClipRect, *clip);
+			record.HasClipRect = 1;
+		}
+		record.Colors[0] = colorLeftUp.color;
+		record.Colors[1] = colorRightUp.color;
+		record.Colors[2] = colorLeftDown.color;
+		record.Colors[3] = colorRightDown.color;
+
+		writeCommand(EFCC_DRAW_2D_RECTANGLE);
+		writeValue(record);
+	}
+
+	Driver->draw2DRectangle(pos, colorLeftUp, colorRightUp, colorLeftDown, colorRightDown, clip);
+}
+
+
+void CFrameCaptureDriver::draw2DLine(const core::position2d<s32>& start, const core::position2d<s32>& end,
+		SColor color)
+{
+	if (Capturing)
+	{
+		const s32 points[] = {start.X, start.Y, end.X, end.Y};
+		writeCommand(EFCC_DRAW_2D_LINE);
+		writeValue(points);
+		writeValue(color.color);
+	}
+
+	Driver->draw2DLine(start, end, color);
+}
+
+
+void CFrameCaptureDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
+{
+	if (Capturing && mb)
+	{
+		const u32 id = captureMeshBuffer(mb);
+		u32 jointCount = 0;
+		const core::matrix4* joints = mb->getJointMatrices(jointCount);
+
+		writeCommand(EFCC_DRAW_MESH_BUFFER);
+		writeValue(id);
+		writeValue(jointCount);
+		for (u32 i = 0; i < jointCount; ++i)
+			writeMatrix(joints[i]);
+	}
+
+	Driver->drawMeshBuffer(mb);
+}
+
+
+void CFrameCaptureDriver::drawMeshBufferBatch(const scene::IMeshBuffer* const* mb,
+		const core::matrix4* worldMatrices, u32 count)
+{
+	if (Capturing && mb && worldMatrices)
+	{
+		// the buffers come first, their records can't be between the draws
+		core::array<u32> ids;
+		ids.reallocate(count);
+		for (u32 i = 0; i < count; ++i)
+			ids.push_back(captureMeshBuffer(mb[i]));
+
+		writeCommand(EFCC_DRAW_MESH_BUFFER_BATCH);
+		writeValue(count);
+		for (u32 i = 0; i < count; ++i)
+		{
+			writeValue(ids[i]);
+			writeMatrix(worldMatrices[i]);
+		}
+	}
+
+	Driver->drawMeshBufferBatch(mb, worldMatrices, count);
+}
+
+
+void CFrameCaptureDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+		const S3DInstance* instances, u32 count)
+{
+	if (Capturing && mb && instances)
+	{
+		const u32 id = captureMeshBuffer(mb);
+
+		writeCommand(EFCC_DRAW_MESH_BUFFER_INSTANCED);
+		writeValue(id);
+		writeValue(count);
+		write(instances, count * sizeof(S3DInstance));
+	}
+
+	Driver->drawMeshBufferInstanced(mb, instances, count);
+}
+
+
+void CFrameCaptureDriver::drawMeshBufferMorphed(const scene::IMeshBuffer* mb,
+		const scene::IMeshBuffer* target, f32 blend)
+{
+	if (Capturing && mb)
+	{
+		const u32 id = captureMeshBuffer(mb);
+		const u32 targetID = target ? captureMeshBuffer(target) : 0;
+
+		writeCommand(EFCC_DRAW_MESH_BUFFER_MORPHED);
+		writeValue(id);
+		writeValue(targetID);
+		writeValue(blend);
+	}
+
+	Driver->drawMeshBufferMorphed(mb, target, blend);
+}
+
+
+//! The deprecated copies, made here to not call them on the driver
+IImage* CFrameCaptureDriver::createImage(ECOLOR_FORMAT format, IImage *imageToCopy)
+{
+	IImage* image = Driver->createImage(format, imageToCopy->getDimension());
+	imageToCopy->copyTo(image);
+	return image;
+}
+
+
+IImage* CFrameCaptureDriver::createImage(IImage* imageToCopy, const core::position2d<s32>& pos, const core::dimension2d<u32>& size)
+{
+	IImage* image = Driver->createImage(imageToCopy->getColorFormat(), imageToCopy->getDimension());
+	imageToCopy->copyTo(image, core::position2di(0,0), core::recti(pos, size));
+	return image;
+}
+
+
+IVideoDriver* createFrameCaptureDriver(IVideoDriver* driver)
+{
+	return new CFrameCaptureDriver(driver);
+}
+
+} // end namespace video
+} // end namespace irr
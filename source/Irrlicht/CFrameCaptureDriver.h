@@ -0,0 +1,291 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FRAME_CAPTURE_DRIVER_H_INCLUDED__
+#define __C_FRAME_CAPTURE_DRIVER_H_INCLUDED__
+
+#include "IVideoDriver.h"
+#include "CFrameCaptureFormat.h"
+#include <unordered_map>
+
+namespace irr
+{
+namespace video
+{
+	//! Capture layer in front of a video driver, see IVideoDriver::captureFrame()
+	/** Created by the device for SIrrlichtCreationParameters::FrameCapture.
+	Calls made by the driver itself, like the passes of a post processing
+	chain or 2d draw lists, don't go through the layer and aren't captured. */
+	class CFrameCaptureDriver : public IVideoDriver
+	{
+	public:
+
+		//! Grabs the driver
+		CFrameCaptureDriver(IVideoDriver* driver);
+
+		~CFrameCaptureDriver();
+
+		bool captureFrame(io::IWriteFile* file, bool payloads = true) override;
+
+		//! Starts a requested capture
+		bool beginScene(u16 clearFlag=(u16)(ECBF_COLOR|ECBF_DEPTH), SColor clearColor = SColor(255,0,0,0), f32 clearDepth = 1.f, u8 clearStencil = 0,
+			const SExposedVideoData& videoData=SExposedVideoData(), core::rect<s32>* sourceRect = 0) override;
+
+		//! Finishes the capture file
+		bool endScene() override;
+
+		// the state and draw calls which are written while capturing
+
+		void setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat) override;
+
+		void setMaterial(const SMaterial& material) override;
+
+		bool setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SColor clearColor = SColor(255,0,0,0),
+			f32 clearDepth = 1.f, u8 clearStencil = 0) override;
+
+		bool setRenderTarget(ITexture* texture, u16 clearFlag=ECBF_COLOR|ECBF_DEPTH, SColor clearColor = SColor(255,0,0,0),
+			f32 clearDepth = 1.f, u8 clearStencil = 0) override;
+
+		void setViewPort(const core::rect<s32>& area) override;
+
+		void clearBuffers(u16 flag, SColor color = SColor(255,0,0,0), f32 depth = 1.f, u8 stencil = 0) override;
+
+		void setFog(SColor color=SColor(0,255,255,255), E_FOG_TYPE fogType=EFT_FOG_LINEAR, f32 start=50.0f, f32 end=100.0f,
+			f32 density=0.01f, bool pixelFog=false, bool rangeFog=false) override;
+
+		void drawVertexPrimitiveList(const void* vertices, u32 vertexCount, const void* indexList, u32 primCount,
+			E_VERTEX_TYPE vType=EVT_STANDARD, scene::E_PRIMITIVE_TYPE pType=scene::EPT_TRIANGLES, E_INDEX_TYPE iType=EIT_16BIT) override;
+
+		void draw2DVertexPrimitiveList(const void* vertices, u32 vertexCount, const void* indexList, u32 primCount,
+			E_VERTEX_TYPE vType=EVT_STANDARD, scene::E_PRIMITIVE_TYPE pType=scene::EPT_TRIANGLES, E_INDEX_TYPE iType=EIT_16BIT) override;
+
+		void draw3DLine(const core::vector3df& start, const core::vector3df& end, SColor color = SColor(255,255,255,255)) override;
+
+		void draw3DBox(const core::aabbox3d<f32>& box, SColor color = SColor(255,255,255,255)) override;
+
+		void draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos, bool useAlphaChannelOfTexture=false) override;
+
+		void draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+			const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect =0,
+			SColor color=SColor(255,255,255,255), bool useAlphaChannelOfTexture=false) override;
+
+		void draw2DImage(const video::ITexture* texture, const core::rect<s32>& destRect,
+			const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect =0,
+			const video::SColor * const colors=0, bool useAlphaChannelOfTexture=false) override;
+
+		void draw2DImageBatch(const video::ITexture* texture,
+			const core::array<core::position2d<s32> >& positions,
+			const core::array<core::rect<s32> >& sourceRects,
+			const core::rect<s32>* clipRect=0, SColor color=SColor(255,255,255,255),
+			bool useAlphaChannelOfTexture=false) override;
+
+		void draw2DRectangle(SColor color, const core::rect<s32>& pos, const core::rect<s32>* clip =0) override;
+
+		void draw2DRectangle(const core::rect<s32>& pos, SColor colorLeftUp, SColor colorRightUp,
+			SColor colorLeftDown, SColor colorRightDown, const core::rect<s32>* clip =0) override;
+
+		void draw2DLine(const core::position2d<s32>& start, const core::position2d<s32>& end,
+			SColor color=SColor(255,255,255,255)) override;
+
+		void drawMeshBuffer(const scene::IMeshBuffer* mb) override;
+
+		void drawMeshBufferBatch(const scene::IMeshBuffer* const* mb, const core::matrix4* worldMatrices, u32 count) override;
+
+		void drawMeshBufferInstanced(const scene::IMeshBuffer* mb, const S3DInstance* instances, u32 count) override;
+
+		void drawMeshBufferMorphed(const scene::IMeshBuffer* mb, const scene::IMeshBuffer* target, f32 blend) override;
+
+		// everything else only goes to the driver
+
+		bool setSwapInterval(s32 interval) override { return Driver->setSwapInterval(interval); }
+		void setFrameDamage(const core::rect<s32>& rect) override { Driver->setFrameDamage(rect); }
+		bool setMaxFramesInFlight(u32 frames) override { return Driver->setMaxFramesInFlight(frames); }
+		bool setErrorCheckMode(E_ERROR_CHECK_MODE mode) override { return Driver->setErrorCheckMode(mode); }
+		void setDebugMessageLevel(ELOG_LEVEL minLevel) override { Driver->setDebugMessageLevel(minLevel); }
+		void setDebugMessageEnabled(u32 id, bool enabled) override { Driver->setDebugMessageEnabled(id, enabled); }
+		bool setRenderThreadEnabled(bool enable) override { return Driver->setRenderThreadEnabled(enable); }
+		bool isRenderThreadEnabled() const override { return Driver->isRenderThreadEnabled(); }
+		void queueRenderCommand(IRenderCommand* command) override { Driver->queueRenderCommand(command); }
+		void submitRenderCommands() override { Driver->submitRenderCommands(); }
+		void finishRenderCommands() override { Driver->finishRenderCommands(); }
+		bool queryFeature(E_VIDEO_DRIVER_FEATURE feature) const override { return Driver->queryFeature(feature); }
+		void disableFeature(E_VIDEO_DRIVER_FEATURE feature, bool flag=true) override { Driver->disableFeature(feature, flag); }
+		const io::IAttributes& getDriverAttributes() const override { return Driver->getDriverAttributes(); }
+		bool checkDriverReset() override { return Driver->checkDriverReset(); }
+		const core::matrix4& getTransform(E_TRANSFORMATION_STATE state) const override { return Driver->getTransform(state); }
+		u32 getImageLoaderCount() const override { return Driver->getImageLoaderCount(); }
+		IImageLoader* getImageLoader(u32 n) override { return Driver->getImageLoader(n); }
+		u32 getImageWriterCount() const override { return Driver->getImageWriterCount(); }
+		IImageWriter* getImageWriter(u32 n) override { return Driver->getImageWriter(n); }
+		ITexture* getTexture(const io::path& filename) override { return Driver->getTexture(filename); }
+		ITexture* getTexture(io::IReadFile* file) override { return Driver->getTexture(file); }
+		ITexture* getTextureAsync(const io::path& filename) override { return Driver->getTextureAsync(filename); }
+		ITexture* getTextureByIndex(u32 index) override { return Driver->getTextureByIndex(index); }
+		u32 getTextureCount() const override { return Driver->getTextureCount(); }
+		void renameTexture(ITexture* texture, const io::path& newName) override { Driver->renameTexture(texture, newName); }
+		ITexture* addTexture(const core::dimension2d<u32>& size, const io::path& name, ECOLOR_FORMAT format = ECF_A8R8G8B8) override { return Driver->addTexture(size, name, format); }
+		ITexture* addTexture(const io::path& name, IImage* image) override { return Driver->addTexture(name, image); }
+		ITexture* addTextureCubemap(const io::path& name, IImage* imagePosX, IImage* imageNegX, IImage* imagePosY, IImage* imageNegY, IImage* imagePosZ, IImage* imageNegZ) override { return Driver->addTextureCubemap(name, imagePosX, imageNegX, imagePosY, imageNegY, imagePosZ, imageNegZ); }
+		ITexture* addTextureCubemap(const irr::u32 sideLen, const io::path& name, ECOLOR_FORMAT format = ECF_A8R8G8B8) override { return Driver->addTextureCubemap(sideLen, name, format); }
+		ITexture* addRenderTargetTexture(const core::dimension2d<u32>& size, const io::path& name = "rt", const ECOLOR_FORMAT format = ECF_UNKNOWN) override { return Driver->addRenderTargetTexture(size, name, format); }
+		ITexture* addRenderTargetTextureCubemap(const irr::u32 sideLen, const io::path& name = "rt", const ECOLOR_FORMAT format = ECF_UNKNOWN) override { return Driver->addRenderTargetTextureCubemap(sideLen, name, format); }
+		void removeTexture(ITexture* texture) override { Driver->removeTexture(texture); }
+		void removeAllTextures() override { Driver->removeAllTextures(); }
+		void removeHardwareBuffer(const scene::IMeshBuffer* mb) override { Driver->removeHardwareBuffer(mb); }
+		void removeAllHardwareBuffers() override { Driver->removeAllHardwareBuffers(); }
+		void addOcclusionQuery(scene::ISceneNode* node, const scene::IMesh* mesh=0) override { Driver->addOcclusionQuery(node, mesh); }
+		void removeOcclusionQuery(scene::ISceneNode* node) override { Driver->removeOcclusionQuery(node); }
+		void removeAllOcclusionQueries() override { Driver->removeAllOcclusionQueries(); }
+		void runOcclusionQuery(scene::ISceneNode* node, bool visible=false) override { Driver->runOcclusionQuery(node, visible); }
+		void runAllOcclusionQueries(bool visible=false) override { Driver->runAllOcclusionQueries(visible); }
+		void updateOcclusionQuery(scene::ISceneNode* node, bool block=true) override { Driver->updateOcclusionQuery(node, block); }
+		void updateAllOcclusionQueries(bool block=true) override { Driver->updateAllOcclusionQueries(block); }
+		u32 getOcclusionQueryResult(scene::ISceneNode* node) const override { return Driver->getOcclusionQueryResult(node); }
+		void beginGPUTimerScope(const c8* name) override { Driver->beginGPUTimerScope(name); }
+		void endGPUTimerScope() override { Driver->endGPUTimerScope(); }
+		const core::array<SGPUTimerResult>& getGPUTimerResults() const override { return Driver->getGPUTimerResults(); }
+		IRenderTarget* addRenderTarget() override { return Driver->addRenderTarget(); }
+		void removeRenderTarget(IRenderTarget* renderTarget) override { Driver->removeRenderTarget(renderTarget); }
+		void removeAllRenderTargets() override { Driver->removeAllRenderTargets(); }
+		ITexture* acquireTransientRenderTargetTexture(const core::dimension2d<u32>& size, ECOLOR_FORMAT format) override { return Driver->acquireTransientRenderTargetTexture(size, format); }
+		void releaseTransientRenderTargetTexture(ITexture* texture) override { Driver->releaseTransientRenderTargetTexture(texture); }
+		IRenderTarget* acquireTransientRenderTarget(const core::dimension2d<u32>& size, ECOLOR_FORMAT colorFormat, ECOLOR_FORMAT depthFormat = ECF_UNKNOWN) override { return Driver->acquireTransientRenderTarget(size, colorFormat, depthFormat); }
+		void releaseTransientRenderTarget(IRenderTarget* target) override { Driver->releaseTransientRenderTarget(target); }
+		IPostProcessChain* createPostProcessChain() override { return Driver->createPostProcessChain(); }
+		void makeColorKeyTexture(video::ITexture* texture, video::SColor color, bool zeroTexels = false) const override { Driver->makeColorKeyTexture(texture, color, zeroTexels); }
+		void makeColorKeyTexture(video::ITexture* texture, core::position2d<s32> colorKeyPixelPos, bool zeroTexels = false) const override { Driver->makeColorKeyTexture(texture, colorKeyPixelPos, zeroTexels); }
+		const core::rect<s32>& getViewPort() const override { return Driver->getViewPort(); }
+		bool beginRecording2D(S2DDrawList& list) override { return Driver->beginRecording2D(list); }
+		bool endRecording2D() override { return Driver->endRecording2D(); }
+		bool drawRecording2D(const S2DDrawList& list) override { return Driver->drawRecording2D(list); }
+		void drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length=10.f, SColor color=0xffffffff) override { Driver->drawMeshBufferNormals(mb, length, color); }
+		void getFog(SColor& color, E_FOG_TYPE& fogType, f32& start, f32& end, f32& density, bool& pixelFog, bool& rangeFog) override { Driver->getFog(color, fogType, start, end, density, pixelFog, rangeFog); }
+		ECOLOR_FORMAT getColorFormat() const override { return Driver->getColorFormat(); }
+		const core::dimension2d<u32>& getScreenSize() const override { return Driver->getScreenSize(); }
+		IRenderTarget* getCurrentRenderTarget() const override { return Driver->getCurrentRenderTarget(); }
+		const core::dimension2d<u32>& getCurrentRenderTargetSize() const override { return Driver->getCurrentRenderTargetSize(); }
+		s32 getFPS() const override { return Driver->getFPS(); }
+		u32 getPrimitiveCountDrawn( u32 mode =0 ) const override { return Driver->getPrimitiveCountDrawn(mode); }
+		const SFrameStats& getFrameStats() const override { return Driver->getFrameStats(); }
+		bool setCommandRecording(bool enable, io::IWriteFile* log = 0) override { return Driver->setCommandRecording(enable, log); }
+		IFrameReplay* createFrameReplay(io::IReadFile* file) override { return Driver->createFrameReplay(file); }
+		u32 getFrameCount() const override { return Driver->getFrameCount(); }
+		void setFrameTimeHistory(u32 frames, f32 hitchMilliseconds = 50.f) override { Driver->setFrameTimeHistory(frames, hitchMilliseconds); }
+		SFrameTimeStats getFrameTimeStats(u32 frames = 0) const override { return Driver->getFrameTimeStats(frames); }
+		void setTextureMemoryBudget(u64 bytes) override { Driver->setTextureMemoryBudget(bytes); }
+		const STextureResidencyStats& getTextureResidencyStats() const override { return Driver->getTextureResidencyStats(); }
+		bool restoreResources() override { return Driver->restoreResources(); }
+		const wchar_t* getName() const override { return Driver->getName(); }
+		void addExternalImageLoader(IImageLoader* loader) override { Driver->addExternalImageLoader(loader); }
+		void addExternalImageWriter(IImageWriter* writer) override { Driver->addExternalImageWriter(writer); }
+		u32 getMaximalPrimitiveCount() const override { return Driver->getMaximalPrimitiveCount(); }
+		void setTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag, bool enabled=true) override { Driver->setTextureCreationFlag(flag, enabled); }
+		bool getTextureCreationFlag(E_TEXTURE_CREATION_FLAG flag) const override { return Driver->getTextureCreationFlag(flag); }
+		core::array<IImage*> createImagesFromFile(const io::path& filename, E_TEXTURE_TYPE* type = 0) override { return Driver->createImagesFromFile(filename, type); }
+		core::array<IImage*> createImagesFromFile(io::IReadFile* file, E_TEXTURE_TYPE* type = 0) override { return Driver->createImagesFromFile(file, type); }
+		core::array<IImage*> createImagesFromFiles(const core::array<io::IReadFile*>& files) override { return Driver->createImagesFromFiles(files); }
+		bool writeImageToFile(IImage* image, const io::path& filename, u32 param = 0) override { return Driver->writeImageToFile(image, filename, param); }
+		bool writeImageToFile(IImage* image, io::IWriteFile* file, u32 param =0) override { return Driver->writeImageToFile(image, file, param); }
+		bool writeImageToFileAsync(IImage* image, const io::path& filename, u32 param = 0, IImageWriteCallback* callback = 0) override { return Driver->writeImageToFileAsync(image, filename, param, callback); }
+		IImage* createImageFromData(ECOLOR_FORMAT format, const core::dimension2d<u32>& size, void *data, bool ownForeignMemory = false, bool deleteMemory = true) override { return Driver->createImageFromData(format, size, data, ownForeignMemory, deleteMemory); }
+		IImage* createImage(ECOLOR_FORMAT format, const core::dimension2d<u32>& size) override { return Driver->createImage(format, size); }
+		IImage* createImage(ECOLOR_FORMAT format, IImage *imageToCopy) override;
+		IImage* createImage(IImage* imageToCopy, const core::position2d<s32>& pos, const core::dimension2d<u32>& size) override;
+		IImage* createImage(ITexture* texture, const core::position2d<s32>& pos, const core::dimension2d<u32>& size) override { return Driver->createImage(texture, pos, size); }
+		void OnResize(const core::dimension2d<u32>& size) override { Driver->OnResize(size); }
+		s32 addMaterialRenderer(IMaterialRenderer* renderer, const c8* name =0) override { return Driver->addMaterialRenderer(renderer, name); }
+		IMaterialRenderer* getMaterialRenderer(u32 idx) const override { return Driver->getMaterialRenderer(idx); }
+		u32 getMaterialRendererCount() const override { return Driver->getMaterialRendererCount(); }
+		const c8* getMaterialRendererName(u32 idx) const override { return Driver->getMaterialRendererName(idx); }
+		void setMaterialRendererName(u32 idx, const c8* name) override { Driver->setMaterialRendererName(idx, name); }
+		void swapMaterialRenderers(u32 idx1, u32 idx2, bool swapNames=true) override { Driver->swapMaterialRenderers(idx1, idx2, swapNames); }
+		const SExposedVideoData& getExposedVideoData() override { return Driver->getExposedVideoData(); }
+		E_DRIVER_TYPE getDriverType() const override { return Driver->getDriverType(); }
+		IGPUProgrammingServices* getGPUProgrammingServices() override { return Driver->getGPUProgrammingServices(); }
+		scene::IMeshManipulator* getMeshManipulator() override { return Driver->getMeshManipulator(); }
+		void setReverseDepth(bool reverse) override { Driver->setReverseDepth(reverse); }
+		bool isReverseDepth() const override { return Driver->isReverseDepth(); }
+		IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override { return Driver->createScreenShot(format, target); }
+		IScreenShotRequest* createScreenShotAsync(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override { return Driver->createScreenShotAsync(format, target); }
+		video::ITexture* findTexture(const io::path& filename) override { return Driver->findTexture(filename); }
+		bool setClipPlane(u32 index, const core::plane3df& plane, bool enable=false) override { return Driver->setClipPlane(index, plane, enable); }
+		void enableClipPlane(u32 index, bool enable) override { Driver->enableClipPlane(index, enable); }
+		void setMinHardwareBufferVertexCount(u32 count) override { Driver->setMinHardwareBufferVertexCount(count); }
+		void setHardwareBufferDeletionBudget(u32 count) override { Driver->setHardwareBufferDeletionBudget(count); }
+		SOverrideMaterial& getOverrideMaterial() override { return Driver->getOverrideMaterial(); }
+		SMaterial& getMaterial2D() override { return Driver->getMaterial2D(); }
+		void enableMaterial2D(bool enable=true) override { Driver->enableMaterial2D(enable); }
+		core::stringc getVendorInfo() override { return Driver->getVendorInfo(); }
+		void setAmbientLight(const SColorf& color) override { Driver->setAmbientLight(color); }
+		const SColorf& getAmbientLight() const override { return Driver->getAmbientLight(); }
+		void setAllowZWriteOnTransparent(bool flag) override { Driver->setAllowZWriteOnTransparent(flag); }
+		core::dimension2du getMaxTextureSize() const override { return Driver->getMaxTextureSize(); }
+		void convertColor(const void* sP, ECOLOR_FORMAT sF, s32 sN, void* dP, ECOLOR_FORMAT dF) const override { Driver->convertColor(sP, sF, sN, dP, dF); }
+		bool queryTextureFormat(ECOLOR_FORMAT format) const override { return Driver->queryTextureFormat(format); }
+		bool needsTransparentRenderPass(const irr::video::SMaterial& material) const override { return Driver->needsTransparentRenderPass(material); }
+		bool canAccumulateTransparency(const SMaterial& material) const override { return Driver->canAccumulateTransparency(material); }
+		bool beginTransparencyAccumulation() override { return Driver->beginTransparencyAccumulation(); }
+		void endTransparencyAccumulation() override { Driver->endTransparencyAccumulation(); }
+
+	private:
+
+		void write(const void* data, u32 size);
+
+		template <class T>
+		void writeValue(const T& value)
+		{
+			write(&value, sizeof(T));
+		}
+
+		//! Keeps the data behind variable sized parts aligned to 4 bytes
+		void writePadding(u32 size);
+
+		void writeCommand(E_FRAME_CAPTURE_COMMAND command);
+
+		void writeMatrix(const core::matrix4& matrix);
+
+		//! Writes the texture at its first use in the frame
+		/** \return Its number in the capture, 0 for none */
+		u32 captureTexture(const ITexture* texture);
+
+		//! Writes the mesh buffer at its first use and whenever its data changed
+		/** \return Its number in the capture */
+		u32 captureMeshBuffer(const scene::IMeshBuffer* mb);
+
+		void captureVertices(E_FRAME_CAPTURE_COMMAND command, const void* vertices, u32 vertexCount,
+			const void* indexList, u32 primCount, E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType);
+
+		void capture2DImage(E_FRAME_CAPTURE_COMMAND command, const ITexture* texture, u32 overload,
+			const core::rect<s32>& destRect, const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+			const SColor* colors, bool useAlphaChannelOfTexture);
+
+		struct SMeshBufferState
+		{
+			u32 ID;
+			u32 ChangedID_Vertex;
+			u32 ChangedID_Index;
+		};
+
+		IVideoDriver* Driver;
+
+		//! The file of a requested or running capture
+		io::IWriteFile* File;
+		bool Payloads;
+		bool Capturing;
+
+		std::unordered_map<const ITexture*, u32> Textures;
+		std::unordered_map<const scene::IMeshBuffer*, SMeshBufferState> MeshBuffers;
+		u32 NextTextureID;
+		u32 NextMeshBufferID;
+
+		//! Pixels of the texture being written
+		core::array<u8> TextureData;
+	};
+
+	//! Puts a capture layer in front of the driver, which it grabs
+	IVideoDriver* createFrameCaptureDriver(IVideoDriver* driver);
+
+} // end namespace video
+} // end namespace irr
+
+#endif
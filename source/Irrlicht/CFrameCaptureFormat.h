@@ -0,0 +1,272 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FRAME_CAPTURE_FORMAT_H_INCLUDED__
+#define __C_FRAME_CAPTURE_FORMAT_H_INCLUDED__
+
+#include "irrTypes.h"
+#include "SMaterial.h"
+#include "EPrimitiveTypes.h"
+
+namespace irr
+{
+namespace video
+{
+
+/* A capture file starts with SFrameCaptureHeader, followed by commands.
+Each command is a u32 of E_FRAME_CAPTURE_COMMAND and its structure, some
+with data behind it, which is padded to 4 bytes. The structures are written
+as they are in memory, so captures are only read on machines of the same
+byte order. Textures and
+mesh buffers are numbered from 1 in the order of their first use, 0 stands
+for none. */
+
+//! Raised with every change of the structures below
+const u32 FRAME_CAPTURE_VERSION = 2;
+
+struct SFrameCaptureHeader
+{
+	//! "IRRCAPT" and the terminating zero
+	c8 Magic[8];
+	u32 Version;
+	u32 DriverType;
+	u32 ScreenSize[2];
+	//! 1 if the textures and mesh buffers come with their data
+	u32 Payloads;
+};
+
+enum E_FRAME_CAPTURE_COMMAND
+{
+	//! SFrameCaptureClear
+	EFCC_BEGIN_SCENE = 0,
+	EFCC_END_SCENE,
+	//! SFrameCaptureTexture, the name and the pixels of each layer
+	EFCC_TEXTURE,
+	//! SFrameCaptureMeshBuffer, the vertices and indices
+	EFCC_MESH_BUFFER,
+	//! u32 state, f32[16]
+	EFCC_TRANSFORM,
+	//! SFrameCaptureMaterial
+	EFCC_MATERIAL,
+	//! SFrameCaptureRenderTarget and the color texture numbers
+	EFCC_RENDER_TARGET,
+	//! s32[4]
+	EFCC_VIEWPORT,
+	//! SFrameCaptureClear
+	EFCC_CLEAR,
+	//! SFrameCaptureFog
+	EFCC_FOG,
+	//! u32 mesh buffer, u32 joint count, f32[16] per joint
+	EFCC_DRAW_MESH_BUFFER,
+	//! u32 count, then u32 mesh buffer and f32[16] world matrix each
+	EFCC_DRAW_MESH_BUFFER_BATCH,
+	//! u32 mesh buffer, u32 count, S3DInstance each
+	EFCC_DRAW_MESH_BUFFER_INSTANCED,
+	//! u32 mesh buffer, u32 target mesh buffer, f32 blend
+	EFCC_DRAW_MESH_BUFFER_MORPHED,
+	//! SFrameCaptureVertices, the vertices and indices
+	EFCC_DRAW_VERTICES,
+	//! SFrameCaptureVertices, the vertices and indices
+	EFCC_DRAW_2D_VERTICES,
+	//! f32[3] start, f32[3] end, u32 color
+	EFCC_DRAW_3D_LINE,
+	//! f32[6] box, u32 color
+	EFCC_DRAW_3D_BOX,
+	//! SFrameCapture2DImage
+	EFCC_DRAW_2D_IMAGE,
+	//! SFrameCapture2DImage, u32 count, s32[2] position and s32[4] source each
+	EFCC_DRAW_2D_IMAGE_BATCH,
+	//! SFrameCapture2DRectangle
+	EFCC_DRAW_2D_RECTANGLE,
+	//! s32[4] start and end, u32 color
+	EFCC_DRAW_2D_LINE,
+
+	EFCC_COUNT
+};
+
+struct SFrameCaptureClear
+{
+	u32 Flags;
+	u32 Color;
+	f32 Depth;
+	u32 Stencil;
+};
+
+struct SFrameCaptureTexture
+{
+	u32 ID;
+	u32 Type;
+	u32 Size[2];
+	u32 ColorFormat;
+	u32 RenderTarget;
+	//! FNV-1a of the pixels of all layers, 0 if they couldn't be read
+	u64 Hash;
+	u32 NameLength;
+	//! Layers with pixels behind the name, each u32 bytes and the data
+	u32 PayloadLayers;
+};
+
+struct SFrameCaptureMeshBuffer
+{
+	u32 ID;
+	u32 VertexType;
+	u32 IndexType;
+	u32 PrimitiveType;
+	u32 VertexCount;
+	u32 IndexCount;
+	u32 MappingHint[2];
+	//! compact vertices, separate vertex streams, GPU only
+	u32 Flags;
+	f32 BoundingBox[6];
+	//! FNV-1a of the vertices and the indices, 0 without client data
+	u64 Hash;
+	//! 1 if vertices and indices follow
+	u32 Payload;
+};
+
+enum E_FRAME_CAPTURE_MESH_BUFFER_FLAG
+{
+	EFCMF_COMPACT_VERTICES = 1,
+	EFCMF_SEPARATE_VERTEX_STREAMS = 2,
+	EFCMF_GPU_ONLY = 4
+};
+
+struct SFrameCaptureMaterialLayer
+{
+	u32 Texture;
+	u8 TextureWrap[3];
+	u8 BilinearFilter;
+	u8 TrilinearFilter;
+	u8 AnisotropicFilter;
+	s8 LODBias;
+	u8 HasTextureMatrix;
+	f32 TextureMatrix[16];
+};
+
+struct SFrameCaptureMaterial
+{
+	SFrameCaptureMaterialLayer Layer[MATERIAL_MAX_TEXTURES];
+	s32 MaterialType;
+	u32 AmbientColor;
+	u32 DiffuseColor;
+	u32 EmissiveColor;
+	u32 SpecularColor;
+	f32 Shininess;
+	f32 MaterialTypeParam;
+	f32 MaterialTypeParam2;
+	f32 Thickness;
+	f32 BlendFactor;
+	f32 PolygonOffsetDepthBias;
+	f32 PolygonOffsetSlopeScale;
+	u8 ZBuffer;
+	u8 AntiAliasing;
+	u8 ColorMask;
+	u8 ColorMaterial;
+	u8 BlendOperation;
+	u8 PolygonOffsetFactor;
+	u8 PolygonOffsetDirection;
+	u8 ZWriteEnable;
+	u8 Wireframe;
+	u8 PointCloud;
+	u8 GouraudShading;
+	u8 Lighting;
+	u8 BackfaceCulling;
+	u8 FrontfaceCulling;
+	u8 FogEnable;
+	u8 NormalizeNormals;
+	u8 UseMipMaps;
+	u8 Padding[3];
+};
+
+struct SFrameCaptureRenderTarget
+{
+	//! 1 if set by IVideoDriver::setRenderTarget() with the first color texture
+	u32 TextureTarget;
+	//! 0 for the frame buffer
+	u32 ColorTextureCount;
+	u32 DepthStencil;
+	SFrameCaptureClear Clear;
+};
+
+struct SFrameCaptureFog
+{
+	u32 Color;
+	u32 Type;
+	f32 Start;
+	f32 End;
+	f32 Density;
+	u32 PixelFog;
+	u32 RangeFog;
+};
+
+struct SFrameCaptureVertices
+{
+	u32 VertexType;
+	u32 PrimitiveType;
+	u32 IndexType;
+	u32 VertexCount;
+	u32 PrimitiveCount;
+	u32 IndexCount;
+	//! 1 if vertices and indices follow
+	u32 Payload;
+};
+
+struct SFrameCapture2DImage
+{
+	u32 Texture;
+	s32 DestRect[4];
+	s32 SourceRect[4];
+	s32 ClipRect[4];
+	u32 Colors[4];
+	u32 HasClipRect;
+	//! 0 for the overload with a position and a source rectangle, 1 for
+	//! the one with a destination rectangle, 2 for the one with a position only
+	u32 Overload;
+	u32 UseAlphaChannel;
+};
+
+struct SFrameCapture2DRectangle
+{
+	s32 Rect[4];
+	s32 ClipRect[4];
+	u32 Colors[4];
+	u32 HasClipRect;
+};
+
+//! FNV-1a, the hash of the capture files
+inline void hashFrameCaptureData(u64& hash, const void* data, size_t size)
+{
+	const u8* bytes = static_cast<const u8*>(data);
+	for (size_t i = 0; i < size; ++i)
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+}
+
+const u64 FRAME_CAPTURE_HASH_SEED = 14695981039346656037ull;
+
+//! Number of indices a draw of primitiveCount primitives reads
+inline u32 getFrameCaptureIndexCount(scene::E_PRIMITIVE_TYPE type, u32 primitiveCount)
+{
+	switch (type)
+	{
+	case scene::EPT_LINE_STRIP:
+		return primitiveCount + 1;
+	case scene::EPT_LINES:
+		return primitiveCount * 2;
+	case scene::EPT_TRIANGLE_STRIP:
+	case scene::EPT_TRIANGLE_FAN:
+		return primitiveCount + 2;
+	case scene::EPT_TRIANGLES:
+		return primitiveCount * 3;
+	case scene::EPT_QUAD_STRIP:
+		return primitiveCount * 2 + 2;
+	case scene::EPT_QUADS:
+		return primitiveCount * 4;
+	default:
+		return primitiveCount;
+	}
+}
+
+} // end namespace video
+} // end namespace irr
+
+#endif
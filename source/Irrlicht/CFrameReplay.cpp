@@ -0,0 +1,730 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CFrameReplay.h"
+#include "IReadFile.h"
+#include "IImage.h"
+#include "IRenderTarget.h"
+#include "os.h"
+#include <cstring>
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	core::rect<s32> getRect(const s32* rect)
+	{
+		return core::rect<s32>(rect[0], rect[1], rect[2], rect[3]);
+	}
+}
+
+
+CFrameReplay::CMeshBuffer::CMeshBuffer(const SFrameCaptureMeshBuffer& record)
+	: Version(0), Vertices(0), Indices(0), VertexCount(0), IndexCount(0),
+	VertexType((E_VERTEX_TYPE)record.VertexType), IndexType((E_INDEX_TYPE)record.IndexType),
+	PrimitiveType((scene::E_PRIMITIVE_TYPE)record.PrimitiveType),
+	MappingHint_Vertex((scene::E_HARDWARE_MAPPING)record.MappingHint[0]),
+	MappingHint_Index((scene::E_HARDWARE_MAPPING)record.MappingHint[1]),
+	ChangedID_Vertex(1), ChangedID_Index(1), HWBuffer(0),
+	CompactVertices((record.Flags & EFCMF_COMPACT_VERTICES) != 0),
+	SeparateVertexStreams((record.Flags & EFCMF_SEPARATE_VERTEX_STREAMS) != 0)
+{
+	#ifdef _DEBUG
+	setDebugName("CFrameReplay::CMeshBuffer");
+	#endif
+
+	BoundingBox.MinEdge.set(record.BoundingBox[0], record.BoundingBox[1], record.BoundingBox[2]);
+	BoundingBox.MaxEdge.set(record.BoundingBox[3], record.BoundingBox[4], record.BoundingBox[5]);
+}
+
+
+CFrameReplay::CMeshBuffer::~CMeshBuffer()
+{
+	if (HWBuffer)
+		HWBuffer->onMeshBufferDestroyed(this);
+}
+
+
+void CFrameReplay::CMeshBuffer::setData(const void* vertices, u32 vertexCount, const void* indices, u32 indexCount)
+{
+	Vertices = vertices;
+	VertexCount = vertexCount;
+	Indices = indices;
+	IndexCount = indexCount;
+}
+
+
+void CFrameReplay::CMeshBuffer::setHardwareMappingHint(scene::E_HARDWARE_MAPPING hint, scene::E_BUFFER_TYPE buffer)
+{
+	if (buffer == scene::EBT_VERTEX_AND_INDEX || buffer == scene::EBT_VERTEX)
+		MappingHint_Vertex = hint;
+	if (buffer == scene::EBT_VERTEX_AND_INDEX || buffer == scene::EBT_INDEX)
+		MappingHint_Index = hint;
+}
+
+
+void CFrameReplay::CMeshBuffer::setDirty(scene::E_BUFFER_TYPE buffer)
+{
+	if (buffer == scene::EBT_VERTEX_AND_INDEX || buffer == scene::EBT_VERTEX)
+		++ChangedID_Vertex;
+	if (buffer == scene::EBT_VERTEX_AND_INDEX || buffer == scene::EBT_INDEX)
+		++ChangedID_Index;
+}
+
+
+const core::matrix4* CFrameReplay::CMeshBuffer::getJointMatrices(u32& count) const
+{
+	count = JointMatrices.size();
+	return count ? JointMatrices.const_pointer() : 0;
+}
+
+
+CFrameReplay::CFrameReplay(IVideoDriver* driver)
+	: Driver(driver), Offset(0), Payloads(false), CapturedDriverType(EDT_NULL)
+{
+	#ifdef _DEBUG
+	setDebugName("CFrameReplay");
+	#endif
+
+	Driver->grab();
+}
+
+
+CFrameReplay::~CFrameReplay()
+{
+	for (u32 i = 0; i < RenderTargets.size(); ++i)
+		Driver->removeRenderTarget(RenderTargets[i]);
+
+	for (u32 i = 0; i < Textures.size(); ++i)
+		if (Textures[i])
+			Driver->removeTexture(Textures[i]);
+
+	for (u32 i = 0; i < MeshBuffers.size(); ++i)
+	{
+		Driver->removeHardwareBuffer(MeshBuffers[i]);
+		MeshBuffers[i]->drop();
+	}
+
+	Driver->drop();
+}
+
+
+bool CFrameReplay::read(void* dest, u32 size)
+{
+	if ((u64)Offset + size > Data.size())
+		return false;
+
+	memcpy(dest, Data.const_pointer() + Offset, size);
+	Offset += size;
+	return true;
+}
+
+
+bool CFrameReplay::skip(u32 size)
+{
+	const u64 padded = ((u64)size + 3) & ~(u64)3;
+	if (Offset + padded > Data.size())
+		return false;
+
+	Offset += (u32)padded;
+	return true;
+}
+
+
+void CFrameReplay::reserveZeros(u32 size)
+{
+	const u32 count = (u32)(((u64)size + 3) / 4);
+	if (Zeros.size() < count)
+	{
+		Zeros.reallocate(count);
+		while (Zeros.size() < count)
+			Zeros.push_back(0);
+	}
+}
+
+
+const void* CFrameReplay::getData(u32 offset, bool payload) const
+{
+	return payload ? (const void*)(Data.const_pointer() + offset) : (const void*)Zeros.const_pointer();
+}
+
+
+ITexture* CFrameReplay::getTexture(u32 id) const
+{
+	return id && id <= Textures.size() ? Textures[id - 1] : 0;
+}
+
+
+core::rect<s32> CFrameReplay::getRect(u32 offset) const
+{
+	s32 rect[4];
+	memcpy(rect, Data.const_pointer() + offset, sizeof(rect));
+	return video::getRect(rect);
+}
+
+
+core::matrix4 CFrameReplay::getMatrix(u32 offset) const
+{
+	core::matrix4 matrix(core::matrix4::EM4CONST_NOTHING);
+	memcpy(matrix.pointer(), Data.const_pointer() + offset, 16 * sizeof(f32));
+	return matrix;
+}
+
+
+bool CFrameReplay::load(io::IReadFile* file)
+{
+	if (!file || file->getSize() <= 0)
+		return false;
+
+	Data.set_used((u32)file->getSize());
+	if (file->read(Data.pointer(), Data.size()) != (size_t)Data.size())
+		return false;
+	Offset = 0;
+
+	SFrameCaptureHeader header;
+	if (!readValue(header) || memcmp(header.Magic, "IRRCAPT", 8) != 0 || header.Version != FRAME_CAPTURE_VERSION)
+	{
+		os::Printer::log("Not a frame capture of this version", file->getFileName(), ELL_ERROR);
+		return false;
+	}
+	Payloads = header.Payloads != 0;
+	CapturedDriverType = (E_DRIVER_TYPE)header.DriverType;
+
+	bool ended = false;
+	while (!ended)
+	{
+		u32 type;
+		if (!readValue(type) || type >= EFCC_COUNT)
+			break;
+
+		SCommand command;
+		command.Type = (E_FRAME_CAPTURE_COMMAND)type;
+		command.Offset = Offset;
+		command.Index = 0;
+
+		bool valid = false;
+		switch (command.Type)
+		{
+		case EFCC_BEGIN_SCENE:
+		case EFCC_CLEAR:
+			valid = skip(sizeof(SFrameCaptureClear));
+			break;
+		case EFCC_END_SCENE:
+			valid = true;
+			ended = true;
+			break;
+		case EFCC_TEXTURE:
+			valid = loadTexture();
+			break;
+		case EFCC_MESH_BUFFER:
+			valid = loadMeshBuffer(command);
+			break;
+		case EFCC_TRANSFORM:
+			valid = skip(sizeof(u32) + 16 * sizeof(f32));
+			break;
+		case EFCC_MATERIAL:
+			valid = loadMaterial(command);
+			break;
+		case EFCC_RENDER_TARGET:
+			valid = loadRenderTarget(command);
+			break;
+		case EFCC_VIEWPORT:
+			valid = skip(4 * sizeof(s32));
+			break;
+		case EFCC_FOG:
+			valid = skip(sizeof(SFrameCaptureFog));
+			break;
+		case EFCC_DRAW_MESH_BUFFER:
+		{
+			u32 id, jointCount;
+			valid = readValue(id) && readValue(jointCount) && id && id <= MeshBuffers.size()
+				&& jointCount < Data.size() / 64 && skip(jointCount * 16 * sizeof(f32));
+			break;
+		}
+		case EFCC_DRAW_MESH_BUFFER_BATCH:
+		{
+			u32 count;
+			valid = readValue(count);
+			for (u32 i = 0; valid && i < count; ++i)
+			{
+				u32 id;
+				valid = readValue(id) && id && id <= MeshBuffers.size() && skip(16 * sizeof(f32));
+			}
+			break;
+		}
+		case EFCC_DRAW_MESH_BUFFER_INSTANCED:
+		{
+			u32 id, count;
+			valid = readValue(id) && readValue(count) && id && id <= MeshBuffers.size()
+				&& count < Data.size() / sizeof(S3DInstance) && skip(count * sizeof(S3DInstance));
+			break;
+		}
+		case EFCC_DRAW_MESH_BUFFER_MORPHED:
+		{
+			u32 id, targetID;
+			f32 blend;
+			valid = readValue(id) && readValue(targetID) && readValue(blend) && id && id <= MeshBuffers.size()
+				&& targetID <= MeshBuffers.size();
+			break;
+		}
+		case EFCC_DRAW_VERTICES:
+		case EFCC_DRAW_2D_VERTICES:
+		{
+			SFrameCaptureVertices record;
+			valid = readValue(record) && record.VertexType <= EVT_SKINNED
+				&& record.VertexCount < Data.size() && record.IndexCount < Data.size();
+			if (!valid)
+				break;
+
+			const u32 vertexBytes = getVertexPitchFromType((E_VERTEX_TYPE)record.VertexType) * record.VertexCount;
+			const u32 indexBytes = record.IndexCount * (record.IndexType == EIT_16BIT ? sizeof(u16) : sizeof(u32));
+			if (record.Payload)
+				valid = skip(vertexBytes) && skip(indexBytes);
+			else
+				reserveZeros(core::max_(vertexBytes, indexBytes));
+			break;
+		}
+		case EFCC_DRAW_3D_LINE:
+		case EFCC_DRAW_3D_BOX:
+			valid = skip(6 * sizeof(f32) + sizeof(u32));
+			break;
+		case EFCC_DRAW_2D_IMAGE:
+			valid = skip(sizeof(SFrameCapture2DImage));
+			break;
+		case EFCC_DRAW_2D_IMAGE_BATCH:
+		{
+			u32 count;
+			valid = skip(sizeof(SFrameCapture2DImage)) && readValue(count)
+				&& count < Data.size() && skip(count * 6 * sizeof(s32));
+			break;
+		}
+		case EFCC_DRAW_2D_RECTANGLE:
+			valid = skip(sizeof(SFrameCapture2DRectangle));
+			break;
+		case EFCC_DRAW_2D_LINE:
+			valid = skip(4 * sizeof(s32) + sizeof(u32));
+			break;
+		default:
+			break;
+		}
+
+		if (!valid)
+			break;
+
+		// textures are made at loading, they have nothing to replay
+		if (command.Type != EFCC_TEXTURE)
+			Commands.push_back(command);
+	}
+
+	if (!ended)
+	{
+		os::Printer::log("Frame capture is truncated or damaged", file->getFileName(), ELL_ERROR);
+		return false;
+	}
+
+	return true;
+}
+
+
+bool CFrameReplay::loadTexture()
+{
+	SFrameCaptureTexture record;
+	if (!readValue(record) || record.ID != Textures.size() + 1 || (u64)Offset + record.NameLength > Data.size())
+		return false;
+
+	const core::stringc name((const c8*)Data.const_pointer() + Offset, record.NameLength);
+	if (!skip(record.NameLength))
+		return false;
+
+	io::path replayName("replay/");
+	replayName += record.ID;
+	replayName += "/";
+	replayName += name;
+
+	const core::dimension2d<u32> size(record.Size[0], record.Size[1]);
+	const ECOLOR_FORMAT format = (ECOLOR_FORMAT)record.ColorFormat;
+	const bool cubemap = record.Type == ETT_CUBEMAP;
+
+	core::array<IImage*> images;
+	bool valid = true;
+	for (u32 layer = 0; layer < record.PayloadLayers; ++layer)
+	{
+		u32 bytes;
+		const u32 offset = Offset + sizeof(u32);
+		if (!readValue(bytes) || bytes < IImage::getDataSizeFromFormat(format, size.Width, size.Height) || !skip(bytes))
+		{
+			valid = false;
+			break;
+		}
+
+		IImage* image = Driver->createImageFromData(format, size, Data.pointer() + offset);
+		if (image)
+			images.push_back(image);
+	}
+
+	ITexture* texture = 0;
+	if (valid)
+	{
+		if (record.RenderTarget)
+			texture = cubemap ? Driver->addRenderTargetTextureCubemap(size.Width, replayName, format)
+				: Driver->addRenderTargetTexture(size, replayName, format);
+		else if (cubemap && images.size() == 6)
+			texture = Driver->addTextureCubemap(replayName, images[0], images[1], images[2], images[3], images[4], images[5]);
+		else if (!cubemap && images.size() == 1)
+			texture = Driver->addTexture(replayName, images[0]);
+		else
+		{
+			// without pixels the texture only has its size and format
+			texture = cubemap ? Driver->addTextureCubemap(size.Width, replayName, format)
+				: Driver->addTexture(size, replayName, format);
+			if (!texture)
+				texture = cubemap ? Driver->addTextureCubemap(size.Width, replayName)
+					: Driver->addTexture(size, replayName);
+		}
+
+		// draws with a texture the driver couldn't make go without it
+		Textures.push_back(texture);
+	}
+
+	for (u32 i = 0; i < images.size(); ++i)
+		images[i]->drop();
+
+	return valid;
+}
+
+
+bool CFrameReplay::loadMeshBuffer(SCommand& command)
+{
+	SFrameCaptureMeshBuffer record;
+	if (!readValue(record) || record.VertexType > EVT_SKINNED || !record.ID
+		|| record.VertexCount >= Data.size() || record.IndexCount >= Data.size())
+		return false;
+
+	if (record.ID == MeshBuffers.size() + 1)
+		MeshBuffers.push_back(new CMeshBuffer(record));
+	else if (record.ID > MeshBuffers.size())
+		return false;
+
+	const u32 vertexBytes = getVertexPitchFromType((E_VERTEX_TYPE)record.VertexType) * record.VertexCount;
+	const u32 indexBytes = record.IndexCount * (record.IndexType == EIT_16BIT ? sizeof(u16) : sizeof(u32));
+
+	SMeshBufferVersion version;
+	version.MeshBuffer = record.ID - 1;
+	version.VertexCount = record.VertexCount;
+	version.IndexCount = record.IndexCount;
+	version.Payload = record.Payload != 0;
+	version.VertexOffset = Offset;
+	if (version.Payload && !skip(vertexBytes))
+		return false;
+	version.IndexOffset = Offset;
+	if (version.Payload && !skip(indexBytes))
+		return false;
+	if (!version.Payload)
+		reserveZeros(core::max_(vertexBytes, indexBytes));
+
+	command.Index = MeshBufferVersions.size();
+	MeshBufferVersions.push_back(version);
+	return true;
+}
+
+
+bool CFrameReplay::loadMaterial(SCommand& command)
+{
+	SFrameCaptureMaterial record;
+	if (!readValue(record))
+		return false;
+
+	SMaterial material;
+	for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i)
+	{
+		const SFrameCaptureMaterialLayer& captured = record.Layer[i];
+		SMaterialLayer& layer = material.TextureLayer[i];
+		layer.Texture = getTexture(captured.Texture);
+		layer.TextureWrapU = captured.TextureWrap[0];
+		layer.TextureWrapV = captured.TextureWrap[1];
+		layer.TextureWrapW = captured.TextureWrap[2];
+		layer.BilinearFilter = captured.BilinearFilter != 0;
+		layer.TrilinearFilter = captured.TrilinearFilter != 0;
+		layer.AnisotropicFilter = captured.AnisotropicFilter;
+		layer.LODBias = captured.LODBias;
+		if (captured.HasTextureMatrix)
+		{
+			core::matrix4 textureMatrix(core::matrix4::EM4CONST_NOTHING);
+			memcpy(textureMatrix.pointer(), captured.TextureMatrix, 16 * sizeof(f32));
+			layer.setTextureMatrix(textureMatrix);
+		}
+	}
+
+	// materials the application added to the captured driver aren't known here
+	if (record.MaterialType >= 0 && (u32)record.MaterialType < Driver->getMaterialRendererCount())
+		material.MaterialType = (E_MATERIAL_TYPE)record.MaterialType;
+	else
+		material.MaterialType = EMT_SOLID;
+	material.AmbientColor = record.AmbientColor;
+	material.DiffuseColor = record.DiffuseColor;
+	material.EmissiveColor = record.EmissiveColor;
+	material.SpecularColor = record.SpecularColor;
+	material.Shininess = record.Shininess;
+	material.MaterialTypeParam = record.MaterialTypeParam;
+	material.MaterialTypeParam2 = record.MaterialTypeParam2;
+	material.Thickness = record.Thickness;
+	material.BlendFactor = record.BlendFactor;
+	material.PolygonOffsetDepthBias = record.PolygonOffsetDepthBias;
+	material.PolygonOffsetSlopeScale = record.PolygonOffsetSlopeScale;
+	material.ZBuffer = record.ZBuffer;
+	material.AntiAliasing = record.AntiAliasing;
+	material.ColorMask = record.ColorMask;
+	material.ColorMaterial = record.ColorMaterial;
+	material.BlendOperation = (E_BLEND_OPERATION)record.BlendOperation;
+	material.PolygonOffsetFactor = record.PolygonOffsetFactor;
+	material.PolygonOffsetDirection = (E_POLYGON_OFFSET)record.PolygonOffsetDirection;
+	material.ZWriteEnable = (E_ZWRITE)record.ZWriteEnable;
+	material.Wireframe = record.Wireframe != 0;
+	material.PointCloud = record.PointCloud != 0;
+	material.GouraudShading = record.GouraudShading != 0;
+	material.Lighting = record.Lighting != 0;
+	material.BackfaceCulling = record.BackfaceCulling != 0;
+	material.FrontfaceCulling = record.FrontfaceCulling != 0;
+	material.FogEnable = record.FogEnable != 0;
+	material.NormalizeNormals = record.NormalizeNormals != 0;
+	material.UseMipMaps = record.UseMipMaps != 0;
+
+	command.Index = Materials.size();
+	Materials.push_back(material);
+	return true;
+}
+
+
+bool CFrameReplay::loadRenderTarget(SCommand& command)
+{
+	SFrameCaptureRenderTarget record;
+	if (!readValue(record) || record.ColorTextureCount >= Data.size())
+		return false;
+
+	core::array<ITexture*> textures;
+	for (u32 i = 0; i < record.ColorTextureCount; ++i)
+	{
+		u32 id;
+		if (!readValue(id))
+			return false;
+		textures.push_back(getTexture(id));
+	}
+
+	if (record.TextureTarget)
+	{
+		// the texture number, setRenderTarget() needs no render target object
+		command.Index = record.ColorTextureCount ? get<u32>(Offset - sizeof(u32)) : 0;
+	}
+	else if (record.ColorTextureCount || record.DepthStencil)
+	{
+		IRenderTarget* target = Driver->addRenderTarget();
+		if (!target)
+			return false;
+		target->setTexture(textures, getTexture(record.DepthStencil));
+		RenderTargets.push_back(target);
+		command.Index = RenderTargets.size();
+	}
+
+	return true;
+}
+
+
+bool CFrameReplay::replay()
+{
+	for (u32 i = 0; i < Commands.size(); ++i)
+	{
+		const SCommand& command = Commands[i];
+		const u32 offset = command.Offset;
+
+		switch (command.Type)
+		{
+		case EFCC_BEGIN_SCENE:
+		{
+			const SFrameCaptureClear clear = get<SFrameCaptureClear>(offset);
+			if (!Driver->beginScene((u16)clear.Flags, clear.Color, clear.Depth, (u8)clear.Stencil))
+				return false;
+			break;
+		}
+		case EFCC_END_SCENE:
+			return Driver->endScene();
+		case EFCC_MESH_BUFFER:
+		{
+			const SMeshBufferVersion& version = MeshBufferVersions[command.Index];
+			CMeshBuffer* mb = MeshBuffers[version.MeshBuffer];
+			if (mb->Version != command.Index + 1)
+			{
+				mb->setData(getData(version.VertexOffset, version.Payload), version.VertexCount,
+					getData(version.IndexOffset, version.Payload), version.IndexCount);
+				if (mb->Version)
+					mb->setDirty();
+				mb->Version = command.Index + 1;
+			}
+			break;
+		}
+		case EFCC_TRANSFORM:
+			Driver->setTransform((E_TRANSFORMATION_STATE)get<u32>(offset), getMatrix(offset + sizeof(u32)));
+			break;
+		case EFCC_MATERIAL:
+			Driver->setMaterial(Materials[command.Index]);
+			break;
+		case EFCC_RENDER_TARGET:
+		{
+			const SFrameCaptureRenderTarget record = get<SFrameCaptureRenderTarget>(offset);
+			const SFrameCaptureClear& clear = record.Clear;
+			if (record.TextureTarget)
+				Driver->setRenderTarget(getTexture(command.Index), (u16)clear.Flags, clear.Color, clear.Depth, (u8)clear.Stencil);
+			else
+				Driver->setRenderTargetEx(command.Index ? RenderTargets[command.Index - 1] : 0,
+					(u16)clear.Flags, clear.Color, clear.Depth, (u8)clear.Stencil);
+			break;
+		}
+		case EFCC_VIEWPORT:
+			Driver->setViewPort(getRect(offset));
+			break;
+		case EFCC_CLEAR:
+		{
+			const SFrameCaptureClear clear = get<SFrameCaptureClear>(offset);
+			Driver->clearBuffers((u16)clear.Flags, SColor(clear.Color), clear.Depth, (u8)clear.Stencil);
+			break;
+		}
+		case EFCC_FOG:
+		{
+			const SFrameCaptureFog fog = get<SFrameCaptureFog>(offset);
+			Driver->setFog(fog.Color, (E_FOG_TYPE)fog.Type, fog.Start, fog.End, fog.Density,
+				fog.PixelFog != 0, fog.RangeFog != 0);
+			break;
+		}
+		case EFCC_DRAW_MESH_BUFFER:
+		{
+			CMeshBuffer* mb = MeshBuffers[get<u32>(offset) - 1];
+			const u32 jointCount = get<u32>(offset + sizeof(u32));
+			mb->JointMatrices.set_used(jointCount);
+			for (u32 j = 0; j < jointCount; ++j)
+				mb->JointMatrices[j] = getMatrix(offset + 2 * sizeof(u32) + j * 16 * sizeof(f32));
+			Driver->drawMeshBuffer(mb);
+			break;
+		}
+		case EFCC_DRAW_MESH_BUFFER_BATCH:
+		{
+			const u32 count = get<u32>(offset);
+			const u32 stride = sizeof(u32) + 16 * sizeof(f32);
+			BatchBuffers.set_used(count);
+			BatchMatrices.set_used(count);
+			for (u32 j = 0; j < count; ++j)
+			{
+				const u32 item = offset + sizeof(u32) + j * stride;
+				BatchBuffers[j] = MeshBuffers[get<u32>(item) - 1];
+				BatchMatrices[j] = getMatrix(item + sizeof(u32));
+			}
+			Driver->drawMeshBufferBatch(BatchBuffers.const_pointer(), BatchMatrices.const_pointer(), count);
+			break;
+		}
+		case EFCC_DRAW_MESH_BUFFER_INSTANCED:
+		{
+			const u32 count = get<u32>(offset + sizeof(u32));
+			Instances.set_used(count);
+			memcpy((void*)Instances.pointer(), Data.const_pointer() + offset + 2 * sizeof(u32), count * sizeof(S3DInstance));
+			Driver->drawMeshBufferInstanced(MeshBuffers[get<u32>(offset) - 1], Instances.const_pointer(), count);
+			break;
+		}
+		case EFCC_DRAW_MESH_BUFFER_MORPHED:
+		{
+			const u32 targetID = get<u32>(offset + sizeof(u32));
+			Driver->drawMeshBufferMorphed(MeshBuffers[get<u32>(offset) - 1], targetID ? MeshBuffers[targetID - 1] : 0,
+				get<f32>(offset + 2 * sizeof(u32)));
+			break;
+		}
+		case EFCC_DRAW_VERTICES:
+		case EFCC_DRAW_2D_VERTICES:
+		{
+			const SFrameCaptureVertices record = get<SFrameCaptureVertices>(offset);
+			const E_VERTEX_TYPE vType = (E_VERTEX_TYPE)record.VertexType;
+			const u32 dataOffset = offset + sizeof(SFrameCaptureVertices);
+			const void* vertices = getData(dataOffset, record.Payload != 0);
+			const void* indices = getData(dataOffset + getVertexPitchFromType(vType) * record.VertexCount, record.Payload != 0);
+			if (command.Type == EFCC_DRAW_VERTICES)
+				Driver->drawVertexPrimitiveList(vertices, record.VertexCount, indices, record.PrimitiveCount,
+					vType, (scene::E_PRIMITIVE_TYPE)record.PrimitiveType, (E_INDEX_TYPE)record.IndexType);
+			else
+				Driver->draw2DVertexPrimitiveList(vertices, record.VertexCount, indices, record.PrimitiveCount,
+					vType, (scene::E_PRIMITIVE_TYPE)record.PrimitiveType, (E_INDEX_TYPE)record.IndexType);
+			break;
+		}
+		case EFCC_DRAW_3D_LINE:
+		{
+			const core::vector3df start = get<core::vector3df>(offset);
+			const core::vector3df end = get<core::vector3df>(offset + 3 * sizeof(f32));
+			Driver->draw3DLine(start, end, get<u32>(offset + 6 * sizeof(f32)));
+			break;
+		}
+		case EFCC_DRAW_3D_BOX:
+		{
+			const core::aabbox3df box(get<core::vector3df>(offset), get<core::vector3df>(offset + 3 * sizeof(f32)));
+			Driver->draw3DBox(box, get<u32>(offset + 6 * sizeof(f32)));
+			break;
+		}
+		case EFCC_DRAW_2D_IMAGE:
+		case EFCC_DRAW_2D_IMAGE_BATCH:
+		{
+			const SFrameCapture2DImage record = get<SFrameCapture2DImage>(offset);
+			const ITexture* texture = getTexture(record.Texture);
+			if (!texture)
+				break;
+
+			const core::rect<s32> destRect = video::getRect(record.DestRect);
+			const core::rect<s32> sourceRect = video::getRect(record.SourceRect);
+			const core::rect<s32> clipRect = video::getRect(record.ClipRect);
+			const core::rect<s32>* clip = record.HasClipRect ? &clipRect : 0;
+			const bool useAlpha = record.UseAlphaChannel != 0;
+			const SColor colors[] = {record.Colors[0], record.Colors[1], record.Colors[2], record.Colors[3]};
+
+			if (command.Type == EFCC_DRAW_2D_IMAGE_BATCH)
+			{
+				const u32 batchOffset = offset + sizeof(SFrameCapture2DImage);
+				const u32 count = get<u32>(batchOffset);
+				BatchPositions.set_used(count);
+				BatchSourceRects.set_used(count);
+				for (u32 j = 0; j < count; ++j)
+				{
+					const u32 item = batchOffset + sizeof(u32) + j * 6 * sizeof(s32);
+					BatchPositions[j].X = get<s32>(item);
+					BatchPositions[j].Y = get<s32>(item + sizeof(s32));
+					BatchSourceRects[j] = getRect(item + 2 * sizeof(s32));
+				}
+				Driver->draw2DImageBatch(texture, BatchPositions, BatchSourceRects, clip, colors[0], useAlpha);
+			}
+			else if (record.Overload == 1)
+				Driver->draw2DImage(texture, destRect, sourceRect, clip, colors, useAlpha);
+			else if (record.Overload == 2)
+				Driver->draw2DImage(texture, destRect.UpperLeftCorner, useAlpha);
+			else
+				Driver->draw2DImage(texture, destRect.UpperLeftCorner, sourceRect, clip, colors[0], useAlpha);
+			break;
+		}
+		case EFCC_DRAW_2D_RECTANGLE:
+		{
+			const SFrameCapture2DRectangle record = get<SFrameCapture2DRectangle>(offset);
+			const core::rect<s32> clipRect = video::getRect(record.ClipRect);
+			Driver->draw2DRectangle(video::getRect(record.Rect), record.Colors[0], record.Colors[1],
+				record.Colors[2], record.Colors[3], record.HasClipRect ? &clipRect : 0);
+			break;
+		}
+		case EFCC_DRAW_2D_LINE:
+		{
+			const core::rect<s32> line = getRect(offset);
+			Driver->draw2DLine(line.UpperLeftCorner, line.LowerRightCorner, get<u32>(offset + 4 * sizeof(s32)));
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+} // end namespace video
+} // end namespace irr
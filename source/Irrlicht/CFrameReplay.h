@@ -0,0 +1,212 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_FRAME_REPLAY_H_INCLUDED__
+#define __C_FRAME_REPLAY_H_INCLUDED__
+
+#include "IFrameReplay.h"
+#include "IVideoDriver.h"
+#include "IMeshBuffer.h"
+#include "S3DVertex.h"
+#include "S3DInstance.h"
+#include "CFrameCaptureFormat.h"
+
+namespace irr
+{
+namespace io
+{
+	class IReadFile;
+}
+namespace video
+{
+	//! Replays a frame of CFrameCaptureDriver, see IVideoDriver::createFrameReplay()
+	class CFrameReplay : public IFrameReplay
+	{
+	public:
+
+		//! Grabs the driver
+		CFrameReplay(IVideoDriver* driver);
+
+		//! Removes the textures and render targets it created
+		~CFrameReplay();
+
+		//! Reads the capture and creates its textures and mesh buffers
+		/** \return False if the file isn't a capture of this version. */
+		bool load(io::IReadFile* file);
+
+		bool replay() override;
+
+		u32 getCommandCount() const override { return Commands.size(); }
+
+		u32 getTextureCount() const override { return Textures.size(); }
+
+		u32 getMeshBufferCount() const override { return MeshBuffers.size(); }
+
+		E_DRIVER_TYPE getCapturedDriverType() const override { return CapturedDriverType; }
+
+		bool hasPayloads() const override { return Payloads; }
+
+	private:
+
+		//! Mesh buffer whose vertices and indices are versions in the capture data
+		class CMeshBuffer : public scene::IMeshBuffer
+		{
+		public:
+			CMeshBuffer(const SFrameCaptureMeshBuffer& record);
+
+			~CMeshBuffer();
+
+			//! Points the buffer to other data, like an upload of the application
+			void setData(const void* vertices, u32 vertexCount, const void* indices, u32 indexCount);
+
+			SMaterial& getMaterial() override { return Material; }
+			const SMaterial& getMaterial() const override { return Material; }
+			E_VERTEX_TYPE getVertexType() const override { return VertexType; }
+			const void* getVertices() const override { return Vertices; }
+			void* getVertices() override { return const_cast<void*>(Vertices); }
+			u32 getVertexCount() const override { return VertexCount; }
+			E_INDEX_TYPE getIndexType() const override { return IndexType; }
+			const u16* getIndices() const override { return static_cast<const u16*>(Indices); }
+			u16* getIndices() override { return static_cast<u16*>(const_cast<void*>(Indices)); }
+			u32 getIndexCount() const override { return IndexCount; }
+			const core::aabbox3df& getBoundingBox() const override { return BoundingBox; }
+			void setBoundingBox(const core::aabbox3df& box) override { BoundingBox = box; }
+			void recalculateBoundingBox() override {}
+			const core::vector3df& getPosition(u32 i) const override { return getVertex(i).Pos; }
+			core::vector3df& getPosition(u32 i) override { return getVertex(i).Pos; }
+			const core::vector3df& getNormal(u32 i) const override { return getVertex(i).Normal; }
+			core::vector3df& getNormal(u32 i) override { return getVertex(i).Normal; }
+			const core::vector2df& getTCoords(u32 i) const override { return getVertex(i).TCoords; }
+			core::vector2df& getTCoords(u32 i) override { return getVertex(i).TCoords; }
+			void append(const void* const vertices, u32 numVertices, const u16* const indices, u32 numIndices) override {}
+			void append(const IMeshBuffer* const other) override {}
+			scene::E_HARDWARE_MAPPING getHardwareMappingHint_Vertex() const override { return MappingHint_Vertex; }
+			scene::E_HARDWARE_MAPPING getHardwareMappingHint_Index() const override { return MappingHint_Index; }
+			void setHardwareMappingHint(scene::E_HARDWARE_MAPPING hint, scene::E_BUFFER_TYPE buffer=scene::EBT_VERTEX_AND_INDEX) override;
+			void setDirty(scene::E_BUFFER_TYPE buffer=scene::EBT_VERTEX_AND_INDEX) override;
+			u32 getChangedID_Vertex() const override { return ChangedID_Vertex; }
+			u32 getChangedID_Index() const override { return ChangedID_Index; }
+			void setHWBuffer(scene::IHardwareBufferLink* ptr) const override { HWBuffer = ptr; }
+			scene::IHardwareBufferLink* getHWBuffer() const override { return HWBuffer; }
+			void setPrimitiveType(scene::E_PRIMITIVE_TYPE type) override { PrimitiveType = type; }
+			scene::E_PRIMITIVE_TYPE getPrimitiveType() const override { return PrimitiveType; }
+			const core::matrix4* getJointMatrices(u32& count) const override;
+			bool getCompactVertices() const override { return CompactVertices; }
+			bool getSeparateVertexStreams() const override { return SeparateVertexStreams; }
+
+			//! Joint matrices of the next draw
+			core::array<core::matrix4> JointMatrices;
+
+			//! Index of the SMeshBufferVersion the buffer points to, plus 1
+			u32 Version;
+
+		private:
+			// all vertex types start with the members of S3DVertex
+			S3DVertex& getVertex(u32 i) const
+			{
+				return *(S3DVertex*)(static_cast<const u8*>(Vertices) + i * getVertexPitchFromType(VertexType));
+			}
+
+			SMaterial Material;
+			const void* Vertices;
+			const void* Indices;
+			u32 VertexCount;
+			u32 IndexCount;
+			core::aabbox3df BoundingBox;
+			E_VERTEX_TYPE VertexType;
+			E_INDEX_TYPE IndexType;
+			scene::E_PRIMITIVE_TYPE PrimitiveType;
+			scene::E_HARDWARE_MAPPING MappingHint_Vertex;
+			scene::E_HARDWARE_MAPPING MappingHint_Index;
+			u32 ChangedID_Vertex;
+			u32 ChangedID_Index;
+			mutable scene::IHardwareBufferLink* HWBuffer;
+			bool CompactVertices;
+			bool SeparateVertexStreams;
+		};
+
+		struct SCommand
+		{
+			E_FRAME_CAPTURE_COMMAND Type;
+			//! Of the structure of the command in Data
+			u32 Offset;
+			//! Of the material, render target or mesh buffer version made at loading
+			u32 Index;
+		};
+
+		//! Reads size bytes at Offset, false at the end of the data
+		bool read(void* dest, u32 size);
+
+		template <class T>
+		bool readValue(T& value)
+		{
+			return read(&value, sizeof(T));
+		}
+
+		//! Skips data which follows a structure, with its padding
+		bool skip(u32 size);
+
+		bool loadTexture();
+		bool loadMeshBuffer(SCommand& command);
+		bool loadMaterial(SCommand& command);
+		bool loadRenderTarget(SCommand& command);
+
+		//! Points to the data of a command, or to zeros if it has no payload
+		const void* getData(u32 offset, bool payload) const;
+
+		//! Makes the zeros last for size bytes
+		void reserveZeros(u32 size);
+
+		ITexture* getTexture(u32 id) const;
+
+		template <class T>
+		T get(u32 offset) const
+		{
+			T value;
+			memcpy(&value, Data.const_pointer() + offset, sizeof(T));
+			return value;
+		}
+
+		core::rect<s32> getRect(u32 offset) const;
+
+		core::matrix4 getMatrix(u32 offset) const;
+
+		IVideoDriver* Driver;
+
+		core::array<u8> Data;
+		u32 Offset;
+		bool Payloads;
+		E_DRIVER_TYPE CapturedDriverType;
+
+		core::array<SCommand> Commands;
+		core::array<ITexture*> Textures;
+		core::array<CMeshBuffer*> MeshBuffers;
+		core::array<SMaterial> Materials;
+		core::array<IRenderTarget*> RenderTargets;
+
+		//! Where the data of a mesh buffer record is
+		struct SMeshBufferVersion
+		{
+			u32 MeshBuffer;
+			u32 VertexOffset;
+			u32 IndexOffset;
+			u32 VertexCount;
+			u32 IndexCount;
+			bool Payload;
+		};
+		core::array<SMeshBufferVersion> MeshBufferVersions;
+
+		//! Stands in for data which isn't in the capture
+		core::array<u32> Zeros;
+
+		core::array<const scene::IMeshBuffer*> BatchBuffers;
+		core::array<core::matrix4> BatchMatrices;
+		core::array<S3DInstance> Instances;
+		core::array<core::position2d<s32> > BatchPositions;
+		core::array<core::rect<s32> > BatchSourceRects;
+	};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -0,0 +1,101 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#pragma once
+
+#include "irrTypes.h"
+#include "irrArray.h"
+#include <cstring>
+
+namespace irr
+{
+namespace video
+{
+
+//! Maps extension names to their index in a table of known names.
+/** Drivers report several hundred extensions and we know about several hundred,
+so comparing each reported name against the whole table dominated the extension
+parsing at startup. The names are hashed once into an open addressing table which
+has at least twice as many slots as names, so a lookup usually costs one hash of
+the name and a single string compare. */
+class CGLExtensionNameIndex
+{
+public:
+	CGLExtensionNameIndex(const char* const* names, u32 count) : Names(names), Mask(0)
+	{
+		u32 size = 64;
+		while (size < count * 2)
+			size <<= 1;
+		Mask = size - 1;
+		Slots.set_used(size);
+		for (u32 i = 0; i < size; ++i)
+			Slots[i] = 0;
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			u32 slot = hash(names[i], strlen(names[i])) & Mask;
+			while (Slots[slot])
+				slot = (slot + 1) & Mask;
+			Slots[slot] = i + 1;
+		}
+	}
+
+	//! Get the index of a name which is not necessarily null terminated
+	/** \return Index into the table passed to the constructor or -1 if the name is unknown. */
+	s32 find(const char* name, size_t length) const
+	{
+		u32 slot = hash(name, length) & Mask;
+		while (Slots[slot])
+		{
+			const char* known = Names[Slots[slot] - 1];
+			if (!strncmp(known, name, length) && known[length] == 0)
+				return static_cast<s32>(Slots[slot] - 1);
+			slot = (slot + 1) & Mask;
+		}
+		return -1;
+	}
+
+	//! Call found(index) for every known name in a space separated extension string
+	template <class F>
+	void parse(const char* extensions, F found) const
+	{
+		if (!extensions)
+			return;
+		const char* p = extensions;
+		while (*p)
+		{
+			while (*p == ' ')
+				++p;
+			const char* end = p;
+			while (*end && *end != ' ')
+				++end;
+			if (end != p)
+			{
+				const s32 index = find(p, end - p);
+				if (index >= 0)
+					found(static_cast<u32>(index));
+			}
+			p = end;
+		}
+	}
+
+private:
+	// FNV-1a
+	static u32 hash(const char* name, size_t length)
+	{
+		u32 h = 2166136261u;
+		for (size_t i = 0; i < length; ++i)
+		{
+			h ^= static_cast<u8>(name[i]);
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	const char* const* Names;
+	core::array<u32> Slots;
+	u32 Mask;
+};
+
+}
+}
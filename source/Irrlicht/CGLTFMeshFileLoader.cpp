@@ -0,0 +1,2299 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CGLTFMeshFileLoader.h"
+#include "CSkinnedMesh.h"
+#include "SAnimatedMesh.h"
+#include "SMesh.h"
+#include "CMeshBuffer.h"
+#include "IMeshManipulator.h"
+#include "IAttributes.h"
+#include "IReadFile.h"
+#include "IMemoryReadFile.h"
+#include "CReadFile.h"
+#include "CMappedReadFile.h"
+#include "CJobSystem.h"
+#include "os.h"
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+
+//! Frames per second of the animation keys, glTF has the times in seconds
+const f32 GLTF_FRAMES_PER_SECOND = 30.f;
+
+//! Mesh buffers have 16 bit indices, larger primitives are split
+const u32 MAX_BUFFER_VERTICES = 65535;
+
+//! Component types of accessors
+enum E_GLTF_COMPONENT_TYPE
+{
+	EGCT_BYTE = 5120,
+	EGCT_UNSIGNED_BYTE = 5121,
+	EGCT_SHORT = 5122,
+	EGCT_UNSIGNED_SHORT = 5123,
+	EGCT_UNSIGNED_INT = 5125,
+	EGCT_FLOAT = 5126
+};
+
+u32 getComponentSize(u32 componentType)
+{
+	switch (componentType)
+	{
+	case EGCT_BYTE:
+	case EGCT_UNSIGNED_BYTE:
+		return 1;
+	case EGCT_SHORT:
+	case EGCT_UNSIGNED_SHORT:
+		return 2;
+	case EGCT_UNSIGNED_INT:
+	case EGCT_FLOAT:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+//! Reads a little endian component, normalized ones as KHR_mesh_quantization describes
+f32 readComponent(const u8* data, u32 componentType, bool normalized)
+{
+	switch (componentType)
+	{
+	case EGCT_BYTE:
+		{
+			const s8 v = (s8)data[0];
+			return normalized ? core::max_(v / 127.f, -1.f) : (f32)v;
+		}
+	case EGCT_UNSIGNED_BYTE:
+		return normalized ? data[0] / 255.f : (f32)data[0];
+	case EGCT_SHORT:
+		{
+			const s16 v = (s16)(data[0] | (data[1] << 8));
+			return normalized ? core::max_(v / 32767.f, -1.f) : (f32)v;
+		}
+	case EGCT_UNSIGNED_SHORT:
+		{
+			const u16 v = (u16)(data[0] | (data[1] << 8));
+			return normalized ? v / 65535.f : (f32)v;
+		}
+	case EGCT_UNSIGNED_INT:
+		return (f32)(data[0] | (data[1] << 8) | (data[2] << 16) | ((u32)data[3] << 24));
+	case EGCT_FLOAT:
+		{
+			const u32 bits = data[0] | (data[1] << 8) | (data[2] << 16) | ((u32)data[3] << 24);
+			f32 v;
+			memcpy(&v, &bits, 4);
+			return v;
+		}
+	default:
+		return 0.f;
+	}
+}
+
+u32 readIndex(const u8* data, u32 componentType)
+{
+	switch (componentType)
+	{
+	case EGCT_UNSIGNED_BYTE:
+		return data[0];
+	case EGCT_UNSIGNED_SHORT:
+		return data[0] | (data[1] << 8);
+	case EGCT_UNSIGNED_INT:
+		return data[0] | (data[1] << 8) | (data[2] << 16) | ((u32)data[3] << 24);
+	default:
+		return (u32)readComponent(data, componentType, false);
+	}
+}
+
+
+//! A value of the JSON part of a glTF file, the strings point into the file
+struct SJSONValue
+{
+	enum E_TYPE
+	{
+		EJT_NULL,
+		EJT_BOOL,
+		EJT_NUMBER,
+		EJT_STRING,
+		EJT_ARRAY,
+		EJT_OBJECT
+	};
+
+	E_TYPE Type;
+	//! name of an object member, escapes aren't resolved
+	const c8* Key;
+	u32 KeyLength;
+	//! contents of a string without the quotes, escapes aren't resolved
+	const c8* Text;
+	u32 TextLength;
+	//! numbers, and 1 or 0 for booleans
+	f64 Number;
+	//! first element or member in CJSONDocument::Values, and their count
+	u32 First;
+	u32 Count;
+};
+
+//! JSON parser, just enough for the JSON part of glTF files
+class CJSONDocument
+{
+public:
+	CJSONDocument() : End(0)
+	{
+		memset(&Root, 0, sizeof(Root));
+	}
+
+	//! Parses the text, false on a syntax error
+	bool parse(const c8* text, const c8* end)
+	{
+		End = end;
+		Values.clear();
+		const c8* p = text;
+		if (!parseValue(p, Root, 0))
+			return false;
+		skipSpace(p);
+		return p == End || *p == 0;
+	}
+
+	const SJSONValue* getRoot() const
+	{
+		return &Root;
+	}
+
+	//! Member of an object, 0 if there is none
+	const SJSONValue* get(const SJSONValue* object, const c8* key) const
+	{
+		if (!object || object->Type != SJSONValue::EJT_OBJECT)
+			return 0;
+		const u32 length = (u32)strlen(key);
+		for (u32 i=0; i<object->Count; ++i)
+		{
+			const SJSONValue& member = Values[object->First+i];
+			if (member.KeyLength == length && !memcmp(member.Key, key, length))
+				return &member;
+		}
+		return 0;
+	}
+
+	//! Element of an array, 0 if there is none
+	const SJSONValue* at(const SJSONValue* array, u32 index) const
+	{
+		if (!array || array->Type != SJSONValue::EJT_ARRAY || index >= array->Count)
+			return 0;
+		return &Values[array->First+index];
+	}
+
+	//! Number of elements of an array, 0 for other values
+	u32 getCount(const SJSONValue* array) const
+	{
+		return array && array->Type == SJSONValue::EJT_ARRAY ? array->Count : 0;
+	}
+
+	f64 getNumber(const SJSONValue* object, const c8* key, f64 defaultValue) const
+	{
+		const SJSONValue* value = get(object, key);
+		return value && value->Type == SJSONValue::EJT_NUMBER ? value->Number : defaultValue;
+	}
+
+	s32 getInt(const SJSONValue* object, const c8* key, s32 defaultValue) const
+	{
+		return (s32)getNumber(object, key, defaultValue);
+	}
+
+	bool getBool(const SJSONValue* object, const c8* key, bool defaultValue) const
+	{
+		const SJSONValue* value = get(object, key);
+		return value && value->Type == SJSONValue::EJT_BOOL ? value->Number != 0 : defaultValue;
+	}
+
+	//! Reads count numbers of an array member, false if it's missing or has another size
+	bool getNumbers(const SJSONValue* object, const c8* key, f32* out, u32 count) const
+	{
+		const SJSONValue* array = get(object, key);
+		if (getCount(array) != count)
+			return false;
+		for (u32 i=0; i<count; ++i)
+			out[i] = (f32)Values[array->First+i].Number;
+		return true;
+	}
+
+	//! Compares a string without escapes
+	static bool equals(const SJSONValue* value, const c8* text)
+	{
+		if (!value || value->Type != SJSONValue::EJT_STRING)
+			return false;
+		const u32 length = (u32)strlen(text);
+		return value->TextLength == length && !memcmp(value->Text, text, length);
+	}
+
+	//! String with the escapes resolved, UTF-8
+	static core::stringc getString(const SJSONValue* value)
+	{
+		core::stringc out;
+		if (!value || value->Type != SJSONValue::EJT_STRING)
+			return out;
+
+		const c8* p = value->Text;
+		const c8* end = p + value->TextLength;
+		out.reserve(value->TextLength);
+		while (p < end)
+		{
+			if (*p != '\\' || p+1 == end)
+			{
+				out.append(*p++);
+				continue;
+			}
+			++p;
+			switch (*p++)
+			{
+			case 'b': out.append('\b'); break;
+			case 'f': out.append('\f'); break;
+			case 'n': out.append('\n'); break;
+			case 'r': out.append('\r'); break;
+			case 't': out.append('\t'); break;
+			case 'u':
+				{
+					u32 c = readHex(p, end);
+					// surrogate pairs
+					if (c >= 0xd800 && c < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+					{
+						p += 2;
+						const u32 low = readHex(p, end);
+						c = 0x10000 + ((c - 0xd800) << 10) + (low - 0xdc00);
+					}
+					appendUTF8(out, c);
+				}
+				break;
+			default:
+				out.append(p[-1]);
+				break;
+			}
+		}
+		return out;
+	}
+
+private:
+	static u32 readHex(const c8*& p, const c8* end)
+	{
+		u32 c = 0;
+		for (u32 i=0; i<4 && p<end; ++i, ++p)
+		{
+			const c8 h = *p;
+			c = c*16 + (h >= 'a' ? h-'a'+10 : h >= 'A' ? h-'A'+10 : h-'0');
+		}
+		return c;
+	}
+
+	static void appendUTF8(core::stringc& out, u32 c)
+	{
+		if (c < 0x80)
+			out.append((c8)c);
+		else if (c < 0x800)
+		{
+			out.append((c8)(0xc0 | (c >> 6)));
+			out.append((c8)(0x80 | (c & 0x3f)));
+		}
+		else if (c < 0x10000)
+		{
+			out.append((c8)(0xe0 | (c >> 12)));
+			out.append((c8)(0x80 | ((c >> 6) & 0x3f)));
+			out.append((c8)(0x80 | (c & 0x3f)));
+		}
+		else
+		{
+			out.append((c8)(0xf0 | (c >> 18)));
+			out.append((c8)(0x80 | ((c >> 12) & 0x3f)));
+			out.append((c8)(0x80 | ((c >> 6) & 0x3f)));
+			out.append((c8)(0x80 | (c & 0x3f)));
+		}
+	}
+
+	void skipSpace(const c8*& p) const
+	{
+		while (p != End && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+			++p;
+	}
+
+	bool parseString(const c8*& p, const c8*& text, u32& length) const
+	{
+		if (p == End || *p != '"')
+			return false;
+		text = ++p;
+		while (p != End && *p != '"')
+		{
+			if (*p == '\\' && p+1 != End)
+				++p;
+			++p;
+		}
+		if (p == End)
+			return false;
+		length = (u32)(p - text);
+		++p;
+		return true;
+	}
+
+	bool parseLiteral(const c8*& p, const c8* literal) const
+	{
+		const u32 length = (u32)strlen(literal);
+		if ((u32)(End - p) < length || memcmp(p, literal, length))
+			return false;
+		p += length;
+		return true;
+	}
+
+	bool parseNumber(const c8*& p, f64& number) const
+	{
+		f64 sign = 1.0;
+		if (p != End && *p == '-')
+		{
+			sign = -1.0;
+			++p;
+		}
+		if (p == End || *p < '0' || *p > '9')
+			return false;
+
+		// integers stay exact up to 2^53, like the byte offsets of large buffers
+		number = 0.0;
+		while (p != End && *p >= '0' && *p <= '9')
+			number = number*10.0 + (*p++ - '0');
+		if (p != End && *p == '.')
+		{
+			++p;
+			f64 scale = 0.1;
+			while (p != End && *p >= '0' && *p <= '9')
+			{
+				number += (*p++ - '0') * scale;
+				scale *= 0.1;
+			}
+		}
+		if (p != End && (*p == 'e' || *p == 'E'))
+		{
+			++p;
+			s32 exponentSign = 1;
+			if (p != End && (*p == '-' || *p == '+'))
+				exponentSign = *p++ == '-' ? -1 : 1;
+			s32 exponent = 0;
+			while (p != End && *p >= '0' && *p <= '9')
+				exponent = core::min_(exponent*10 + (*p++ - '0'), 1000);
+			number *= pow(10.0, exponentSign * exponent);
+		}
+		number *= sign;
+		return true;
+	}
+
+	bool parseValue(const c8*& p, SJSONValue& value, u32 depth)
+	{
+		memset(&value, 0, sizeof(value));
+		skipSpace(p);
+		if (p == End)
+			return false;
+
+		switch (*p)
+		{
+		case '{':
+		case '[':
+			{
+				if (depth >= 64)
+					return false;
+				const bool object = *p == '{';
+				const c8 close = object ? '}' : ']';
+				++p;
+
+				// the children of a value are stored one after another in Values
+				core::array<SJSONValue> children;
+				skipSpace(p);
+				if (p != End && *p == close)
+					++p;
+				else
+				{
+					for (;;)
+					{
+						const c8* key = 0;
+						u32 keyLength = 0;
+						if (object)
+						{
+							skipSpace(p);
+							if (!parseString(p, key, keyLength))
+								return false;
+							skipSpace(p);
+							if (p == End || *p != ':')
+								return false;
+							++p;
+						}
+
+						children.push_back(SJSONValue());
+						if (!parseValue(p, children.getLast(), depth+1))
+							return false;
+						children.getLast().Key = key;
+						children.getLast().KeyLength = keyLength;
+
+						skipSpace(p);
+						if (p == End)
+							return false;
+						if (*p == ',')
+						{
+							++p;
+							continue;
+						}
+						if (*p != close)
+							return false;
+						++p;
+						break;
+					}
+				}
+
+				value.Type = object ? SJSONValue::EJT_OBJECT : SJSONValue::EJT_ARRAY;
+				value.First = Values.size();
+				value.Count = children.size();
+				for (u32 i=0; i<children.size(); ++i)
+					Values.push_back(children[i]);
+				return true;
+			}
+		case '"':
+			value.Type = SJSONValue::EJT_STRING;
+			return parseString(p, value.Text, value.TextLength);
+		case 't':
+			value.Type = SJSONValue::EJT_BOOL;
+			value.Number = 1.0;
+			return parseLiteral(p, "true");
+		case 'f':
+			value.Type = SJSONValue::EJT_BOOL;
+			return parseLiteral(p, "false");
+		case 'n':
+			value.Type = SJSONValue::EJT_NULL;
+			return parseLiteral(p, "null");
+		default:
+			value.Type = SJSONValue::EJT_NUMBER;
+			return parseNumber(p, value.Number);
+		}
+	}
+
+	const c8* End;
+	core::array<SJSONValue> Values;
+	SJSONValue Root;
+};
+
+
+//! Decodes the base64 part of a data uri, false on invalid characters
+bool decodeBase64(const c8* text, u32 length, core::array<u8>& out)
+{
+	out.reallocate(length / 4 * 3, false);
+	u32 bits = 0;
+	u32 bitCount = 0;
+	for (u32 i=0; i<length; ++i)
+	{
+		const c8 c = text[i];
+		u32 v;
+		if (c >= 'A' && c <= 'Z')
+			v = c - 'A';
+		else if (c >= 'a' && c <= 'z')
+			v = c - 'a' + 26;
+		else if (c >= '0' && c <= '9')
+			v = c - '0' + 52;
+		else if (c == '+' || c == '-')
+			v = 62;
+		else if (c == '/' || c == '_')
+			v = 63;
+		else if (c == '=')
+			break;
+		else
+			return false;
+
+		bits = (bits << 6) | v;
+		bitCount += 6;
+		if (bitCount >= 8)
+		{
+			bitCount -= 8;
+			out.push_back((u8)(bits >> bitCount));
+		}
+	}
+	return true;
+}
+
+//! Resolves the %XX escapes of a relative uri
+io::path decodeURI(const core::stringc& uri)
+{
+	io::path out;
+	for (u32 i=0; i<uri.size(); ++i)
+	{
+		if (uri[i] == '%' && i+2 < uri.size())
+		{
+			c8 hex[3] = { uri[i+1], uri[i+2], 0 };
+			out.append((c8)strtol(hex, 0, 16));
+			i += 2;
+		}
+		else
+			out.append(uri[i]);
+	}
+	return out;
+}
+
+
+// EXT_meshopt_compression, the codecs of the meshoptimizer library
+
+const u32 MESHOPT_BYTE_GROUP_SIZE = 16;
+const u32 MESHOPT_VERTEX_BLOCK_BYTES = 8192;
+const u32 MESHOPT_VERTEX_BLOCK_MAX_SIZE = 256;
+const u32 MESHOPT_TAIL_MAX_SIZE = 32;
+
+//! Decodes a group of 16 bytes stored with 0, 2, 4 or 8 bits each
+const u8* decodeMeshoptBytesGroup(const u8* data, const u8* end, u8* buffer, u32 bitsLog2)
+{
+	switch (bitsLog2)
+	{
+	case 0:
+		memset(buffer, 0, MESHOPT_BYTE_GROUP_SIZE);
+		return data;
+	case 1:
+	case 2:
+		{
+			// values with all bits set are stored in full after the group
+			const u32 bits = 1 << bitsLog2;
+			const u32 sentinel = (1 << bits) - 1;
+			if (end - data < (ptrdiff_t)(bits * 2))
+				return 0;
+			const u8* extra = data + bits * 2;
+			for (u32 i=0; i<MESHOPT_BYTE_GROUP_SIZE; ++i)
+			{
+				const u32 shift = 8 - bits - (i * bits) % 8;
+				u8 v = (data[i * bits / 8] >> shift) & sentinel;
+				if (v == sentinel)
+				{
+					if (extra == end)
+						return 0;
+					v = *extra++;
+				}
+				buffer[i] = v;
+			}
+			return extra;
+		}
+	default:
+		if (end - data < (ptrdiff_t)MESHOPT_BYTE_GROUP_SIZE)
+			return 0;
+		memcpy(buffer, data, MESHOPT_BYTE_GROUP_SIZE);
+		return data + MESHOPT_BYTE_GROUP_SIZE;
+	}
+}
+
+//! Vertex codec of EXT_meshopt_compression mode ATTRIBUTES, version 0
+bool decodeMeshoptVertices(u8* out, u32 count, u32 stride, const u8* data, u32 size)
+{
+	if (stride == 0 || stride > 256 || stride % 4 != 0)
+		return false;
+	const u32 tailSize = core::max_(stride, MESHOPT_TAIL_MAX_SIZE);
+	if (size < 1 + tailSize || data[0] != 0xa0)
+		return false;
+
+	const u8* end = data + size;
+	u8 last[256];
+	memcpy(last, end - stride, stride);
+	++data;
+
+	const u32 blockSize = core::min_((MESHOPT_VERTEX_BLOCK_BYTES / stride) & ~(MESHOPT_BYTE_GROUP_SIZE-1), MESHOPT_VERTEX_BLOCK_MAX_SIZE);
+	u8 buffer[MESHOPT_VERTEX_BLOCK_MAX_SIZE];
+	for (u32 first=0; first<count; first+=blockSize)
+	{
+		const u32 blockCount = core::min_(blockSize, count - first);
+		const u32 alignedCount = (blockCount + MESHOPT_BYTE_GROUP_SIZE-1) & ~(MESHOPT_BYTE_GROUP_SIZE-1);
+		u8* block = out + first * stride;
+
+		// each byte of the vertices is stored apart, as deltas to the previous vertex
+		for (u32 k=0; k<stride; ++k)
+		{
+			const u8* header = data;
+			const u32 headerSize = (alignedCount / MESHOPT_BYTE_GROUP_SIZE + 3) / 4;
+			if ((u32)(end - data) < headerSize)
+				return false;
+			data += headerSize;
+			for (u32 i=0; i<alignedCount; i+=MESHOPT_BYTE_GROUP_SIZE)
+			{
+				const u32 group = i / MESHOPT_BYTE_GROUP_SIZE;
+				data = decodeMeshoptBytesGroup(data, end, buffer + i, (header[group / 4] >> ((group % 4) * 2)) & 3);
+				if (!data)
+					return false;
+			}
+
+			u8 p = last[k];
+			for (u32 i=0; i<blockCount; ++i)
+			{
+				const u8 v = buffer[i];
+				p = (u8)(p + ((v >> 1) ^ (u8)-(s32)(v & 1)));
+				block[i * stride + k] = p;
+			}
+		}
+		memcpy(last, block + (blockCount-1) * stride, stride);
+	}
+
+	return (u32)(end - data) == tailSize;
+}
+
+u32 decodeMeshoptVByte(const u8*& data)
+{
+	const u8 lead = *data++;
+	if (lead < 128)
+		return lead;
+
+	u32 result = lead & 127;
+	u32 shift = 7;
+	for (u32 i=0; i<4; ++i)
+	{
+		const u8 group = *data++;
+		result |= (u32)(group & 127) << shift;
+		shift += 7;
+		if (group < 128)
+			break;
+	}
+	return result;
+}
+
+u32 decodeMeshoptIndex(const u8*& data, u32 last)
+{
+	const u32 v = decodeMeshoptVByte(data);
+	return last + ((v >> 1) ^ (u32)-(s32)(v & 1));
+}
+
+void writeMeshoptIndex(u8* out, u32 i, u32 indexSize, u32 index)
+{
+	if (indexSize == 2)
+	{
+		const u16 v = (u16)index;
+		memcpy(out + i*2, &v, 2);
+	}
+	else
+		memcpy(out + i*4, &index, 4);
+}
+
+//! Index codec of EXT_meshopt_compression mode TRIANGLES
+bool decodeMeshoptTriangles(u8* out, u32 count, u32 indexSize, const u8* data, u32 size)
+{
+	if (count % 3 != 0 || (indexSize != 2 && indexSize != 4) || size < 1 + count/3 + 16)
+		return false;
+	if ((data[0] & 0xf0) != 0xe0 || (data[0] & 0x0f) > 1)
+		return false;
+
+	// the fifos of the recently used edges and vertices
+	u32 edges[16][2];
+	u32 vertices[16];
+	memset(edges, 0xff, sizeof(edges));
+	memset(vertices, 0xff, sizeof(vertices));
+	u32 edgeOffset = 0;
+	u32 vertexOffset = 0;
+	u32 next = 0;
+	u32 last = 0;
+	const u32 fecMax = (data[0] & 0x0f) >= 1 ? 13 : 15;
+
+	const u8* code = data + 1;
+	const u8* extra = code + count / 3;
+	const u8* safeEnd = data + size - 16;
+	const u8* codeAux = safeEnd;
+
+#define PUSH_EDGE(a, b) { edges[edgeOffset][0] = a; edges[edgeOffset][1] = b; edgeOffset = (edgeOffset+1) & 15; }
+#define PUSH_VERTEX(v, cond) { vertices[vertexOffset] = v; vertexOffset = (vertexOffset + ((cond) ? 1 : 0)) & 15; }
+
+	for (u32 i=0; i<count; i+=3)
+	{
+		if (extra > safeEnd)
+			return false;
+
+		const u8 codeTri = *code++;
+		u32 a, b, c;
+		if (codeTri < 0xf0)
+		{
+			// an edge of the fifo and a new, recent or free vertex
+			const u32 fe = codeTri >> 4;
+			a = edges[(edgeOffset - 1 - fe) & 15][0];
+			b = edges[(edgeOffset - 1 - fe) & 15][1];
+
+			const u32 fec = codeTri & 15;
+			if (fec < fecMax)
+			{
+				c = fec == 0 ? next++ : vertices[(vertexOffset - 1 - fec) & 15];
+				PUSH_VERTEX(c, fec == 0);
+			}
+			else
+			{
+				// 13 and 14 are the last free vertex -1 and +1
+				last = c = fec != 15 ? last + (fec - (fec ^ 3)) : decodeMeshoptIndex(extra, last);
+				PUSH_VERTEX(c, true);
+			}
+
+			PUSH_EDGE(c, b);
+			PUSH_EDGE(a, c);
+		}
+		else
+		{
+			// three vertices, the codes of the common ones are in a table at the end
+			u32 fea, feb, fec;
+			if (codeTri < 0xfe)
+			{
+				const u8 aux = codeAux[codeTri & 15];
+				fea = 0;
+				feb = aux >> 4;
+				fec = aux & 15;
+			}
+			else
+			{
+				const u8 aux = *extra++;
+				if (aux == 0)
+					next = 0;
+				fea = codeTri == 0xfe ? 0 : 15;
+				feb = aux >> 4;
+				fec = aux & 15;
+			}
+
+			a = fea == 0 ? next++ : 0;
+			b = feb == 0 ? next++ : vertices[(vertexOffset - feb) & 15];
+			c = fec == 0 ? next++ : vertices[(vertexOffset - fec) & 15];
+			if (fea == 15)
+				last = a = decodeMeshoptIndex(extra, last);
+			if (feb == 15)
+				last = b = decodeMeshoptIndex(extra, last);
+			if (fec == 15)
+				last = c = decodeMeshoptIndex(extra, last);
+
+			PUSH_VERTEX(a, true);
+			PUSH_VERTEX(b, feb == 0 || feb == 15);
+			PUSH_VERTEX(c, fec == 0 || fec == 15);
+
+			PUSH_EDGE(b, a);
+			PUSH_EDGE(c, b);
+			PUSH_EDGE(a, c);
+		}
+
+		writeMeshoptIndex(out, i, indexSize, a);
+		writeMeshoptIndex(out, i+1, indexSize, b);
+		writeMeshoptIndex(out, i+2, indexSize, c);
+	}
+
+#undef PUSH_EDGE
+#undef PUSH_VERTEX
+
+	return extra == safeEnd;
+}
+
+//! Index sequence codec of EXT_meshopt_compression mode INDICES
+bool decodeMeshoptIndexSequence(u8* out, u32 count, u32 indexSize, const u8* data, u32 size)
+{
+	if ((indexSize != 2 && indexSize != 4) || size < 1 + count + 4)
+		return false;
+	if ((data[0] & 0xf0) != 0xd0 || (data[0] & 0x0f) > 1)
+		return false;
+
+	// two baselines, the lowest bit picks one
+	u32 last[2] = { 0, 0 };
+	const u8* p = data + 1;
+	const u8* safeEnd = data + size - 4;
+	for (u32 i=0; i<count; ++i)
+	{
+		if (p >= safeEnd)
+			return false;
+		u32 v = decodeMeshoptVByte(p);
+		const u32 current = v & 1;
+		v >>= 1;
+		const u32 index = last[current] + ((v >> 1) ^ (u32)-(s32)(v & 1));
+		last[current] = index;
+		writeMeshoptIndex(out, i, indexSize, index);
+	}
+	return p == safeEnd;
+}
+
+s32 roundSigned(f32 v)
+{
+	return (s32)(v + (v >= 0.f ? 0.5f : -0.5f));
+}
+
+//! Filters of EXT_meshopt_compression, applied after decoding
+template <class T>
+void decodeMeshoptOctahedral(T* data, u32 count)
+{
+	const f32 max = (f32)((1 << (sizeof(T) * 8 - 1)) - 1);
+	for (u32 i=0; i<count; ++i)
+	{
+		// the third component stores 1.0 with the same precision
+		f32 x = data[i*4+0];
+		f32 y = data[i*4+1];
+		const f32 z = data[i*4+2] - fabsf(x) - fabsf(y);
+
+		const f32 t = z >= 0.f ? 0.f : z;
+		x += x >= 0.f ? t : -t;
+		y += y >= 0.f ? t : -t;
+
+		const f32 scale = max / sqrtf(x*x + y*y + z*z);
+		data[i*4+0] = (T)roundSigned(x * scale);
+		data[i*4+1] = (T)roundSigned(y * scale);
+		data[i*4+2] = (T)roundSigned(z * scale);
+	}
+}
+
+void decodeMeshoptQuaternion(s16* data, u32 count)
+{
+	const f32 scale = 1.f / sqrtf(2.f);
+	for (u32 i=0; i<count; ++i)
+	{
+		// the lowest bits of the last component select the one left out
+		const s32 sf = data[i*4+3] | 3;
+		const f32 ss = scale / sf;
+		const f32 x = data[i*4+0] * ss;
+		const f32 y = data[i*4+1] * ss;
+		const f32 z = data[i*4+2] * ss;
+		const f32 ww = 1.f - x*x - y*y - z*z;
+		const f32 w = sqrtf(ww >= 0.f ? ww : 0.f);
+
+		const s32 qc = data[i*4+3] & 3;
+		data[i*4 + ((qc+1) & 3)] = (s16)roundSigned(x * 32767.f);
+		data[i*4 + ((qc+2) & 3)] = (s16)roundSigned(y * 32767.f);
+		data[i*4 + ((qc+3) & 3)] = (s16)roundSigned(z * 32767.f);
+		data[i*4 + ((qc+0) & 3)] = (s16)roundSigned(w * 32767.f);
+	}
+}
+
+void decodeMeshoptExponential(u32* data, u32 count)
+{
+	for (u32 i=0; i<count; ++i)
+	{
+		// 8 bit exponent and 24 bit mantissa, both signed
+		const s32 v = (s32)data[i];
+		const s32 exponent = v >> 24;
+		const s32 mantissa = (s32)((u32)v << 8) >> 8;
+		const f32 f = ldexpf((f32)mantissa, exponent);
+		memcpy(&data[i], &f, 4);
+	}
+}
+
+
+//! Decodes a buffer view compressed with EXT_meshopt_compression on a worker thread
+struct SMeshoptJob
+{
+	const u8* Source;
+	u32 SourceSize;
+	u8* Target;
+	u32 Count;
+	u32 Stride;
+	//! 0 ATTRIBUTES, 1 TRIANGLES, 2 INDICES
+	u32 Mode;
+	//! 0 NONE, 1 OCTAHEDRAL, 2 QUATERNION, 3 EXPONENTIAL
+	u32 Filter;
+	bool Result;
+};
+
+void decodeMeshoptJob(void* data)
+{
+	SMeshoptJob& job = *(SMeshoptJob*)data;
+	switch (job.Mode)
+	{
+	case 0:
+		job.Result = decodeMeshoptVertices(job.Target, job.Count, job.Stride, job.Source, job.SourceSize);
+		break;
+	case 1:
+		job.Result = decodeMeshoptTriangles(job.Target, job.Count, job.Stride, job.Source, job.SourceSize);
+		break;
+	default:
+		job.Result = decodeMeshoptIndexSequence(job.Target, job.Count, job.Stride, job.Source, job.SourceSize);
+		break;
+	}
+	if (!job.Result)
+		return;
+
+#ifdef __BIG_ENDIAN__
+	// the filters work on the little endian components
+	if (job.Filter != 0 || job.Mode != 0)
+	{
+		const u32 componentSize = job.Mode != 0 ? job.Stride : job.Filter == 3 ? 4 : job.Stride / 4;
+		for (u32 i=0; i<job.Count*job.Stride; i+=componentSize)
+		{
+			if (componentSize == 2)
+				*(u16*)(job.Target+i) = os::Byteswap::byteswap(*(u16*)(job.Target+i));
+			else if (componentSize == 4)
+				*(u32*)(job.Target+i) = os::Byteswap::byteswap(*(u32*)(job.Target+i));
+		}
+	}
+#endif
+
+	switch (job.Filter)
+	{
+	case 1:
+		if (job.Stride == 4)
+			decodeMeshoptOctahedral((s8*)job.Target, job.Count);
+		else if (job.Stride == 8)
+			decodeMeshoptOctahedral((s16*)job.Target, job.Count);
+		else
+			job.Result = false;
+		break;
+	case 2:
+		if (job.Stride == 8)
+			decodeMeshoptQuaternion((s16*)job.Target, job.Count);
+		else
+			job.Result = false;
+		break;
+	case 3:
+		if (job.Stride % 4 == 0)
+			decodeMeshoptExponential((u32*)job.Target, job.Count * job.Stride / 4);
+		else
+			job.Result = false;
+		break;
+	default:
+		break;
+	}
+
+#ifdef __BIG_ENDIAN__
+	// back to little endian, like the uncompressed buffer views
+	if (job.Filter != 0 || job.Mode != 0)
+	{
+		const u32 componentSize = job.Mode != 0 ? job.Stride : job.Filter == 3 ? 4 : job.Stride / 4;
+		for (u32 i=0; i<job.Count*job.Stride; i+=componentSize)
+		{
+			if (componentSize == 2)
+				*(u16*)(job.Target+i) = os::Byteswap::byteswap(*(u16*)(job.Target+i));
+			else if (componentSize == 4)
+				*(u32*)(job.Target+i) = os::Byteswap::byteswap(*(u32*)(job.Target+i));
+		}
+	}
+#endif
+}
+
+
+//! Data of a buffer view
+struct SGLTFBufferView
+{
+	const u8* Data;
+	u32 Size;
+	u32 Stride;
+};
+
+//! Elements of an accessor, they point into the buffer views
+struct SGLTFAccessor
+{
+	//! 0 for accessors without buffer view, their elements are zero
+	const u8* Data;
+	u32 Count;
+	u32 ComponentType;
+	u32 Components;
+	u32 Stride;
+	bool Normalized;
+	const SJSONValue* Sparse;
+};
+
+class CGLTFReader;
+
+//! A primitive converted to Irrlicht vertices and triangles, done by the jobs
+struct SGLTFPrimitive
+{
+	const CGLTFReader* Reader;
+	const SJSONValue* Json;
+
+	core::array<video::S3DVertex2TCoords> Vertices;
+	//! Triangles with the winding of Irrlicht
+	core::array<u32> Indices;
+	//! Up to 8 joints and weights for each vertex, when the primitive is skinned
+	core::array<u16> Joints;
+	core::array<f32> Weights;
+	u32 Influences;
+	s32 Material;
+	bool SecondTCoords;
+	bool Result;
+};
+
+void convertPrimitiveJob(void* data);
+
+//! Reads a glTF file, the JSON part and the buffers
+class CGLTFReader
+{
+public:
+	CGLTFReader(ISceneManager* smgr, CJobSystem*& jobs)
+		: SceneManager(smgr), Jobs(jobs), FileData(0), FileSize(0)
+	{
+	}
+
+	~CGLTFReader()
+	{
+		for (u32 i=0; i<Files.size(); ++i)
+			Files[i]->drop();
+		for (u32 i=0; i<OwnedData.size(); ++i)
+			delete [] OwnedData[i];
+	}
+
+	bool read(io::IReadFile* file)
+	{
+		FileName = file->getFileName();
+		Dir = FileName.subString(0, FileName.findLast('/') + 1);
+
+		// files in memory, like mapped ones, are read in place
+		if (file->getType() == io::ERFT_MEMORY_READ_FILE)
+		{
+			FileData = (const u8*)static_cast<io::IMemoryReadFile*>(file)->getBuffer();
+			FileSize = (u32)file->getSize();
+		}
+		else
+		{
+			FileSize = (u32)file->getSize();
+			u8* data = new u8[FileSize];
+			OwnedData.push_back(data);
+			FileSize = (u32)file->read(data, FileSize);
+			FileData = data;
+		}
+
+		const c8* json = (const c8*)FileData;
+		u32 jsonSize = FileSize;
+		const u8* bin = 0;
+		u32 binSize = 0;
+		if (FileSize >= 12 && readU32(FileData) == 0x46546C67)
+		{
+			// binary glTF, the JSON chunk and the optional BIN chunk
+			if (readU32(FileData+4) != 2)
+				return fail("Only version 2 of binary glTF is supported");
+			const u32 length = core::min_(readU32(FileData+8), FileSize);
+			u32 offset = 12;
+			json = 0;
+			while (offset + 8 <= length)
+			{
+				const u32 chunkSize = readU32(FileData+offset);
+				const u32 chunkType = readU32(FileData+offset+4);
+				offset += 8;
+				if (chunkSize > length - offset)
+					return fail("Invalid chunk size");
+				if (chunkType == 0x4E4F534A && !json)
+				{
+					json = (const c8*)FileData + offset;
+					jsonSize = chunkSize;
+				}
+				else if (chunkType == 0x004E4942 && !bin)
+				{
+					bin = FileData + offset;
+					binSize = chunkSize;
+				}
+				offset += (chunkSize + 3) & ~3;
+			}
+			if (!json)
+				return fail("No JSON chunk");
+		}
+
+		if (!Document.parse(json, json + jsonSize))
+			return fail("Invalid JSON");
+		const SJSONValue* root = Document.getRoot();
+
+		const SJSONValue* version = Document.get(Document.get(root, "asset"), "version");
+		if (!version || version->TextLength < 2 || version->Text[0] != '2' || version->Text[1] != '.')
+			return fail("Only glTF 2.0 is supported");
+
+		const SJSONValue* required = Document.get(root, "extensionsRequired");
+		for (u32 i=0; i<Document.getCount(required); ++i)
+		{
+			const SJSONValue* extension = Document.at(required, i);
+			if (!CJSONDocument::equals(extension, "KHR_mesh_quantization") &&
+				!CJSONDocument::equals(extension, "EXT_meshopt_compression"))
+			{
+				return fail("Unsupported extension", CJSONDocument::getString(extension).c_str());
+			}
+		}
+
+		return readBuffers(bin, binSize) && readBufferViews() && readAccessors();
+	}
+
+	//! Converts the meshes, skinned and animated ones to a CSkinnedMesh
+	IAnimatedMesh* createMesh()
+	{
+		const SJSONValue* root = Document.getRoot();
+		const SJSONValue* nodes = Document.get(root, "nodes");
+		const SJSONValue* meshes = Document.get(root, "meshes");
+		const u32 nodeCount = Document.getCount(nodes);
+
+		// the node hierarchy
+		Parents.set_used(nodeCount);
+		for (u32 i=0; i<nodeCount; ++i)
+			Parents[i] = -1;
+		for (u32 i=0; i<nodeCount; ++i)
+		{
+			const SJSONValue* children = Document.get(Document.at(nodes, i), "children");
+			for (u32 c=0; c<Document.getCount(children); ++c)
+			{
+				const u32 child = (u32)Document.at(children, c)->Number;
+				if (child >= nodeCount || child == i || Parents[child] != -1)
+					return failMesh("Invalid node hierarchy");
+				Parents[child] = i;
+			}
+		}
+		for (u32 i=0; i<nodeCount; ++i)
+		{
+			// cycles would never reach a root
+			s32 parent = Parents[i];
+			for (u32 depth=0; parent != -1; ++depth)
+			{
+				if (depth >= nodeCount)
+					return failMesh("Invalid node hierarchy");
+				parent = Parents[parent];
+			}
+		}
+
+		const SJSONValue* scenes = Document.get(root, "scenes");
+		const SJSONValue* scene = Document.at(scenes, (u32)Document.getInt(root, "scene", 0));
+		const SJSONValue* sceneNodes = Document.get(scene, "nodes");
+		if (scene)
+		{
+			for (u32 i=0; i<Document.getCount(sceneNodes); ++i)
+			{
+				const u32 node = (u32)Document.at(sceneNodes, i)->Number;
+				if (node < nodeCount && Parents[node] == -1)
+					Roots.push_back(node);
+			}
+		}
+		else
+		{
+			for (u32 i=0; i<nodeCount; ++i)
+				if (Parents[i] == -1)
+					Roots.push_back(i);
+		}
+
+		// the primitives of all meshes are converted in parallel
+		MeshPrimitives.set_used(Document.getCount(meshes) + 1);
+		MeshPrimitives[0] = 0;
+		u32 primitiveCount = 0;
+		for (u32 m=0; m<Document.getCount(meshes); ++m)
+		{
+			primitiveCount += Document.getCount(Document.get(Document.at(meshes, m), "primitives"));
+			MeshPrimitives[m+1] = primitiveCount;
+		}
+		Primitives.set_used(primitiveCount);
+		for (u32 m=0, p=0; m<Document.getCount(meshes); ++m)
+		{
+			const SJSONValue* primitives = Document.get(Document.at(meshes, m), "primitives");
+			for (u32 i=0; i<Document.getCount(primitives); ++i, ++p)
+			{
+				Primitives[p].Reader = this;
+				Primitives[p].Json = Document.at(primitives, i);
+				Primitives[p].Influences = 0;
+				Primitives[p].Material = -1;
+				Primitives[p].SecondTCoords = false;
+				Primitives[p].Result = false;
+			}
+		}
+		if (primitiveCount > 1)
+		{
+			CJobSystem* jobs = getJobs();
+			for (u32 p=1; p<primitiveCount; ++p)
+				jobs->add(convertPrimitiveJob, &Primitives[p]);
+		}
+		if (primitiveCount)
+			convertPrimitiveJob(&Primitives[0]);
+		readMaterials();
+		if (primitiveCount > 1)
+			getJobs()->wait();
+
+		for (u32 p=0; p<primitiveCount; ++p)
+		{
+			if (!Primitives[p].Result)
+				return failMesh("Invalid primitive");
+		}
+
+		// static meshes get the node transformations applied
+		bool animated = Document.getCount(Document.get(root, "skins")) != 0;
+		const SJSONValue* animation = Document.at(Document.get(root, "animations"), 0);
+		for (u32 i=0; i<Document.getCount(Document.get(animation, "channels")); ++i)
+		{
+			const SJSONValue* path = Document.get(Document.get(Document.at(Document.get(animation, "channels"), i), "target"), "path");
+			if (!CJSONDocument::equals(path, "weights"))
+				animated = true;
+		}
+
+		return animated ? createSkinnedMesh() : createStaticMesh();
+	}
+
+	//! Reads the elements of an accessor as floats, with sparse elements applied
+	bool readFloats(s32 index, core::array<f32>& out, u32 components) const
+	{
+		if (index < 0 || (u32)index >= Accessors.size() || Accessors[index].Components != components)
+			return false;
+		const SGLTFAccessor& accessor = Accessors[index];
+
+		out.set_used(accessor.Count * components);
+		if (!accessor.Data)
+			memset(out.pointer(), 0, out.size() * sizeof(f32));
+		else
+		{
+			const u32 componentSize = getComponentSize(accessor.ComponentType);
+			for (u32 i=0; i<accessor.Count; ++i)
+			{
+				const u8* element = accessor.Data + i * accessor.Stride;
+				for (u32 c=0; c<components; ++c)
+					out[i*components+c] = readComponent(element + c*componentSize, accessor.ComponentType, accessor.Normalized);
+			}
+		}
+
+		if (accessor.Sparse)
+		{
+			const u8* indices;
+			const u8* values;
+			u32 count, indexType;
+			if (!getSparse(accessor, indices, indexType, values, count))
+				return false;
+			const u32 componentSize = getComponentSize(accessor.ComponentType);
+			for (u32 i=0; i<count; ++i)
+			{
+				const u32 element = readIndex(indices + i*getComponentSize(indexType), indexType);
+				if (element >= accessor.Count)
+					return false;
+				for (u32 c=0; c<components; ++c)
+					out[element*components+c] = readComponent(values + (i*components+c)*componentSize, accessor.ComponentType, accessor.Normalized);
+			}
+		}
+		return true;
+	}
+
+	//! Reads the elements of an accessor of indices or joints
+	bool readUInts(s32 index, core::array<u32>& out, u32 components) const
+	{
+		if (index < 0 || (u32)index >= Accessors.size() || Accessors[index].Components != components)
+			return false;
+		const SGLTFAccessor& accessor = Accessors[index];
+		if (accessor.ComponentType == EGCT_FLOAT)
+			return false;
+
+		const u32 componentSize = getComponentSize(accessor.ComponentType);
+		out.set_used(accessor.Count * components);
+		if (!accessor.Data)
+			memset(out.pointer(), 0, out.size() * sizeof(u32));
+		else
+		{
+			for (u32 i=0; i<accessor.Count; ++i)
+			{
+				const u8* element = accessor.Data + i * accessor.Stride;
+				for (u32 c=0; c<components; ++c)
+					out[i*components+c] = readIndex(element + c*componentSize, accessor.ComponentType);
+			}
+		}
+
+		if (accessor.Sparse)
+		{
+			const u8* indices;
+			const u8* values;
+			u32 count, indexType;
+			if (!getSparse(accessor, indices, indexType, values, count))
+				return false;
+			for (u32 i=0; i<count; ++i)
+			{
+				const u32 element = readIndex(indices + i*getComponentSize(indexType), indexType);
+				if (element >= accessor.Count)
+					return false;
+				for (u32 c=0; c<components; ++c)
+					out[element*components+c] = readIndex(values + (i*components+c)*componentSize, accessor.ComponentType);
+			}
+		}
+		return true;
+	}
+
+	u32 getAccessorCount(s32 index) const
+	{
+		return index >= 0 && (u32)index < Accessors.size() ? Accessors[index].Count : 0;
+	}
+
+	u32 getAccessorComponents(s32 index) const
+	{
+		return index >= 0 && (u32)index < Accessors.size() ? Accessors[index].Components : 0;
+	}
+
+	const CJSONDocument& getDocument() const
+	{
+		return Document;
+	}
+
+	//! Base color of a material, multiplied into the vertex colors
+	video::SColorf getBaseColor(s32 material) const
+	{
+		f32 color[4] = { 1.f, 1.f, 1.f, 1.f };
+		const SJSONValue* pbr = Document.get(Document.at(Document.get(Document.getRoot(), "materials"), (u32)material), "pbrMetallicRoughness");
+		Document.getNumbers(pbr, "baseColorFactor", color, 4);
+		return video::SColorf(color[0], color[1], color[2], color[3]);
+	}
+
+private:
+	static u32 readU32(const u8* data)
+	{
+		return data[0] | (data[1] << 8) | (data[2] << 16) | ((u32)data[3] << 24);
+	}
+
+	bool fail(const c8* message, const c8* detail = 0) const
+	{
+		core::stringc text("glTF loader: ");
+		text += message;
+		if (detail)
+		{
+			text += " ";
+			text += detail;
+		}
+		os::Printer::log(text.c_str(), FileName.c_str(), ELL_ERROR);
+		return false;
+	}
+
+	IAnimatedMesh* failMesh(const c8* message) const
+	{
+		fail(message);
+		return 0;
+	}
+
+	CJobSystem* getJobs()
+	{
+		if (!Jobs)
+		{
+			const u32 cores = std::thread::hardware_concurrency();
+			Jobs = new CJobSystem(cores > 1 ? cores - 1 : 1);
+		}
+		return Jobs;
+	}
+
+	bool readBuffers(const u8* bin, u32 binSize)
+	{
+		const SJSONValue* buffers = Document.get(Document.getRoot(), "buffers");
+		Buffers.set_used(Document.getCount(buffers));
+		BufferSizes.set_used(Buffers.size());
+		for (u32 i=0; i<Buffers.size(); ++i)
+		{
+			const SJSONValue* buffer = Document.at(buffers, i);
+			const u32 length = (u32)Document.getNumber(buffer, "byteLength", 0.0);
+			const SJSONValue* uri = Document.get(buffer, "uri");
+			Buffers[i] = 0;
+			BufferSizes[i] = 0;
+
+			if (!uri)
+			{
+				// the BIN chunk of binary files, or a buffer of EXT_meshopt_compression
+				// which only has a fallback nobody reads
+				if (i == 0 && bin)
+				{
+					Buffers[i] = bin;
+					BufferSizes[i] = binSize;
+				}
+				continue;
+			}
+
+			if (uri->TextLength > 5 && !memcmp(uri->Text, "data:", 5))
+			{
+				const c8* comma = (const c8*)memchr(uri->Text, ',', uri->TextLength);
+				if (!comma)
+					return fail("Invalid data uri");
+				core::array<u8> data;
+				const u32 offset = (u32)(comma + 1 - uri->Text);
+				if (!decodeBase64(comma + 1, uri->TextLength - offset, data))
+					return fail("Invalid data uri");
+				u8* owned = new u8[data.size() + 1];
+				memcpy(owned, data.const_pointer(), data.size());
+				OwnedData.push_back(owned);
+				Buffers[i] = owned;
+				BufferSizes[i] = data.size();
+			}
+			else
+			{
+				// external buffers are mapped if possible
+				const io::path name = decodeURI(CJSONDocument::getString(uri));
+				io::IReadFile* file = io::CMappedReadFile::createMappedReadFile(Dir + name, 1);
+				if (!file)
+					file = io::CMappedReadFile::createMappedReadFile(name, 1);
+				if (file)
+				{
+					Files.push_back(file);
+					Buffers[i] = (const u8*)static_cast<io::IMemoryReadFile*>(file)->getBuffer();
+					BufferSizes[i] = (u32)file->getSize();
+				}
+				else
+				{
+					file = io::CReadFile::createReadFile(Dir + name);
+					if (!file)
+						file = io::CReadFile::createReadFile(name);
+					if (!file)
+						return fail("Could not open buffer", name.c_str());
+					u8* owned = new u8[file->getSize() + 1];
+					OwnedData.push_back(owned);
+					BufferSizes[i] = (u32)file->read(owned, file->getSize());
+					Buffers[i] = owned;
+					file->drop();
+				}
+			}
+
+			if (BufferSizes[i] < length)
+				return fail("Buffer is too small");
+		}
+		return true;
+	}
+
+	bool readBufferViews()
+	{
+		const SJSONValue* views = Document.get(Document.getRoot(), "bufferViews");
+		BufferViews.set_used(Document.getCount(views));
+		core::array<SMeshoptJob> jobs;
+		for (u32 i=0; i<BufferViews.size(); ++i)
+		{
+			const SJSONValue* view = Document.at(views, i);
+			SGLTFBufferView& out = BufferViews[i];
+			out.Stride = (u32)Document.getInt(view, "byteStride", 0);
+
+			const SJSONValue* meshopt = Document.get(Document.get(view, "extensions"), "EXT_meshopt_compression");
+			if (meshopt)
+			{
+				const u8* source;
+				u32 sourceSize;
+				if (!getRange(meshopt, source, sourceSize))
+					return fail("Invalid buffer view");
+
+				SMeshoptJob job;
+				job.Source = source;
+				job.SourceSize = sourceSize;
+				job.Count = (u32)Document.getNumber(meshopt, "count", 0.0);
+				job.Stride = (u32)Document.getNumber(meshopt, "byteStride", 0.0);
+				const SJSONValue* mode = Document.get(meshopt, "mode");
+				const SJSONValue* filter = Document.get(meshopt, "filter");
+				job.Mode = CJSONDocument::equals(mode, "ATTRIBUTES") ? 0 : CJSONDocument::equals(mode, "TRIANGLES") ? 1 :
+					CJSONDocument::equals(mode, "INDICES") ? 2 : 3;
+				job.Filter = CJSONDocument::equals(filter, "OCTAHEDRAL") ? 1 : CJSONDocument::equals(filter, "QUATERNION") ? 2 :
+					CJSONDocument::equals(filter, "EXPONENTIAL") ? 3 : 0;
+				if (job.Mode == 3 || (filter && job.Filter == 0) || job.Stride == 0 || job.Stride > 256 ||
+					(u64)job.Count * job.Stride > 0x7fffffff)
+				{
+					return fail("Unsupported EXT_meshopt_compression buffer view");
+				}
+
+				out.Size = job.Count * job.Stride;
+				u8* target = new u8[out.Size + 1];
+				OwnedData.push_back(target);
+				job.Target = target;
+				job.Result = false;
+				out.Data = target;
+				jobs.push_back(job);
+			}
+			else if (!getRange(view, out.Data, out.Size))
+				return fail("Invalid buffer view");
+		}
+
+		if (jobs.size() > 1)
+		{
+			CJobSystem* jobSystem = getJobs();
+			for (u32 i=1; i<jobs.size(); ++i)
+				jobSystem->add(decodeMeshoptJob, &jobs[i]);
+		}
+		if (jobs.size())
+			decodeMeshoptJob(&jobs[0]);
+		if (jobs.size() > 1)
+			getJobs()->wait();
+
+		for (u32 i=0; i<jobs.size(); ++i)
+		{
+			if (!jobs[i].Result)
+				return fail("Could not decode EXT_meshopt_compression buffer view");
+		}
+		return true;
+	}
+
+	//! Range of a buffer view, or of its compressed data
+	bool getRange(const SJSONValue* view, const u8*& data, u32& size) const
+	{
+		const s32 buffer = Document.getInt(view, "buffer", -1);
+		const f64 offset = Document.getNumber(view, "byteOffset", 0.0);
+		const f64 length = Document.getNumber(view, "byteLength", 0.0);
+		if (buffer < 0 || (u32)buffer >= Buffers.size() || !Buffers[buffer] ||
+			offset < 0.0 || length < 0.0 || offset + length > BufferSizes[buffer])
+		{
+			return false;
+		}
+		data = Buffers[buffer] + (u32)offset;
+		size = (u32)length;
+		return true;
+	}
+
+	bool readAccessors()
+	{
+		const SJSONValue* accessors = Document.get(Document.getRoot(), "accessors");
+		Accessors.set_used(Document.getCount(accessors));
+		for (u32 i=0; i<Accessors.size(); ++i)
+		{
+			const SJSONValue* accessor = Document.at(accessors, i);
+			SGLTFAccessor& out = Accessors[i];
+			out.Count = (u32)Document.getNumber(accessor, "count", 0.0);
+			out.ComponentType = (u32)Document.getInt(accessor, "componentType", 0);
+			out.Normalized = Document.getBool(accessor, "normalized", false);
+			out.Sparse = Document.get(accessor, "sparse");
+			out.Data = 0;
+
+			const SJSONValue* type = Document.get(accessor, "type");
+			out.Components = CJSONDocument::equals(type, "SCALAR") ? 1 : CJSONDocument::equals(type, "VEC2") ? 2 :
+				CJSONDocument::equals(type, "VEC3") ? 3 : CJSONDocument::equals(type, "VEC4") ? 4 :
+				CJSONDocument::equals(type, "MAT4") ? 16 : 0;
+
+			const u32 componentSize = getComponentSize(out.ComponentType);
+			if (!componentSize || !out.Components)
+			{
+				// matrices with padded columns are never needed for meshes
+				out.Count = 0;
+				continue;
+			}
+
+			const u32 elementSize = componentSize * out.Components;
+			out.Stride = elementSize;
+			const s32 view = Document.getInt(accessor, "bufferView", -1);
+			if (view < 0)
+				continue;
+			if ((u32)view >= BufferViews.size())
+				return fail("Invalid accessor");
+
+			const SGLTFBufferView& bufferView = BufferViews[view];
+			if (bufferView.Stride)
+				out.Stride = bufferView.Stride;
+			const f64 offset = Document.getNumber(accessor, "byteOffset", 0.0);
+			if (out.Count && (offset < 0.0 || out.Stride < elementSize ||
+				offset + (f64)out.Stride * (out.Count - 1) + elementSize > bufferView.Size))
+			{
+				return fail("Accessor exceeds its buffer view");
+			}
+			out.Data = bufferView.Data + (u32)offset;
+		}
+		return true;
+	}
+
+	//! Indices and values of a sparse accessor
+	bool getSparse(const SGLTFAccessor& accessor, const u8*& indices, u32& indexType, const u8*& values, u32& count) const
+	{
+		count = (u32)Document.getNumber(accessor.Sparse, "count", 0.0);
+		const SJSONValue* sparseIndices = Document.get(accessor.Sparse, "indices");
+		const SJSONValue* sparseValues = Document.get(accessor.Sparse, "values");
+		indexType = (u32)Document.getInt(sparseIndices, "componentType", 0);
+		const s32 indexView = Document.getInt(sparseIndices, "bufferView", -1);
+		const s32 valueView = Document.getInt(sparseValues, "bufferView", -1);
+		if (indexView < 0 || (u32)indexView >= BufferViews.size() || valueView < 0 || (u32)valueView >= BufferViews.size() ||
+			(indexType != EGCT_UNSIGNED_BYTE && indexType != EGCT_UNSIGNED_SHORT && indexType != EGCT_UNSIGNED_INT))
+		{
+			return false;
+		}
+
+		const f64 indexOffset = Document.getNumber(sparseIndices, "byteOffset", 0.0);
+		const f64 valueOffset = Document.getNumber(sparseValues, "byteOffset", 0.0);
+		if (indexOffset < 0.0 || indexOffset + (f64)count * getComponentSize(indexType) > BufferViews[indexView].Size ||
+			valueOffset < 0.0 || valueOffset + (f64)count * accessor.Components * getComponentSize(accessor.ComponentType) > BufferViews[valueView].Size)
+		{
+			return false;
+		}
+		indices = BufferViews[indexView].Data + (u32)indexOffset;
+		values = BufferViews[valueView].Data + (u32)valueOffset;
+		return true;
+	}
+
+	void readMaterials()
+	{
+		const SJSONValue* root = Document.getRoot();
+		const SJSONValue* materials = Document.get(root, "materials");
+		const bool loadTextures = SceneManager->getParameters()->getAttributeAsBool(MESH_LOADER_TEXTURES);
+		Materials.set_used(Document.getCount(materials) + 1);
+		for (u32 i=0; i<Document.getCount(materials); ++i)
+		{
+			const SJSONValue* material = Document.at(materials, i);
+			video::SMaterial& out = Materials[i];
+
+			bool textured = false;
+			const SJSONValue* texture = Document.get(Document.get(material, "pbrMetallicRoughness"), "baseColorTexture");
+			if (texture && loadTextures)
+			{
+				// only images in files of their own are loaded
+				const SJSONValue* textureJson = Document.at(Document.get(root, "textures"), (u32)Document.getInt(texture, "index", -1));
+				const SJSONValue* image = Document.at(Document.get(root, "images"), (u32)Document.getInt(textureJson, "source", -1));
+				const SJSONValue* uri = Document.get(image, "uri");
+				if (uri && !(uri->TextLength > 5 && !memcmp(uri->Text, "data:", 5)))
+				{
+					out.setTexture(0, SceneManager->addMeshTextureReference(Dir + decodeURI(CJSONDocument::getString(uri))));
+					textured = true;
+				}
+			}
+
+			const SJSONValue* alphaMode = Document.get(material, "alphaMode");
+			if (CJSONDocument::equals(alphaMode, "BLEND"))
+				out.MaterialType = textured ? video::EMT_TRANSPARENT_ALPHA_CHANNEL : video::EMT_TRANSPARENT_VERTEX_ALPHA;
+			else if (CJSONDocument::equals(alphaMode, "MASK") && textured)
+			{
+				out.MaterialType = video::EMT_TRANSPARENT_ALPHA_CHANNEL_REF;
+				out.MaterialTypeParam = (f32)Document.getNumber(material, "alphaCutoff", 0.5);
+			}
+
+			out.BackfaceCulling = !Document.getBool(material, "doubleSided", false);
+			if (Document.get(Document.get(material, "extensions"), "KHR_materials_unlit"))
+				out.Lighting = false;
+		}
+	}
+
+	//! Local transformation of a node, converted to the left handed coordinates
+	core::matrix4 getLocalMatrix(u32 node, core::vector3df* position = 0, core::quaternion* rotation = 0, core::vector3df* scale = 0) const
+	{
+		const SJSONValue* json = Document.at(Document.get(Document.getRoot(), "nodes"), node);
+		f32 m[16];
+		core::matrix4 matrix;
+		if (Document.getNumbers(json, "matrix", m, 16))
+		{
+			// the column major matrix mirrored at the xy plane
+			m[2] = -m[2];
+			m[6] = -m[6];
+			m[8] = -m[8];
+			m[9] = -m[9];
+			m[11] = -m[11];
+			m[14] = -m[14];
+			matrix.setM(m);
+			if (position)
+			{
+				*position = matrix.getTranslation();
+				*scale = matrix.getScale();
+				core::matrix4 rotationMatrix(matrix);
+				if (scale->X != 0.f && scale->Y != 0.f && scale->Z != 0.f)
+				{
+					core::matrix4 inverseScale;
+					inverseScale.setScale(core::vector3df(1.f / scale->X, 1.f / scale->Y, 1.f / scale->Z));
+					rotationMatrix = matrix * inverseScale;
+				}
+				*rotation = core::quaternion(rotationMatrix);
+				rotation->makeInverse();
+			}
+			return matrix;
+		}
+
+		f32 t[3] = { 0.f, 0.f, 0.f };
+		f32 r[4] = { 0.f, 0.f, 0.f, 1.f };
+		f32 s[3] = { 1.f, 1.f, 1.f };
+		Document.getNumbers(json, "translation", t, 3);
+		Document.getNumbers(json, "rotation", r, 4);
+		Document.getNumbers(json, "scale", s, 3);
+		const core::vector3df p(t[0], t[1], -t[2]);
+		const core::quaternion q(r[0], r[1], -r[2], r[3]);
+		const core::vector3df sc(s[0], s[1], s[2]);
+		if (position)
+		{
+			*position = p;
+			*rotation = q;
+			*scale = sc;
+		}
+
+		core::matrix4 positionMatrix;
+		positionMatrix.setTranslation(p);
+		core::matrix4 rotationMatrix;
+		q.getMatrix_transposed(rotationMatrix);
+		core::matrix4 scaleMatrix;
+		scaleMatrix.setScale(sc);
+		return positionMatrix * rotationMatrix * scaleMatrix;
+	}
+
+	//! Splits the triangles of a primitive into parts which fit 16 bit indices
+	static void splitPrimitive(const SGLTFPrimitive& primitive, core::array<core::array<u32> >& partVertices,
+		core::array<core::array<u16> >& partIndices)
+	{
+		const u32 vertexCount = primitive.Vertices.size();
+		if (vertexCount <= MAX_BUFFER_VERTICES)
+		{
+			partVertices.set_used(1);
+			partIndices.set_used(1);
+			partVertices[0].set_used(vertexCount);
+			for (u32 i=0; i<vertexCount; ++i)
+				partVertices[0][i] = i;
+			partIndices[0].set_used(primitive.Indices.size());
+			for (u32 i=0; i<primitive.Indices.size(); ++i)
+				partIndices[0][i] = (u16)primitive.Indices[i];
+			return;
+		}
+
+		core::array<s32> remap;
+		remap.set_used(vertexCount);
+		memset(remap.pointer(), 0xff, vertexCount * sizeof(s32));
+		partVertices.clear();
+		partIndices.clear();
+		for (u32 i=0; i<primitive.Indices.size(); i+=3)
+		{
+			if (!partVertices.size() || partVertices.getLast().size() + 3 > MAX_BUFFER_VERTICES)
+			{
+				if (partVertices.size())
+				{
+					for (u32 v=0; v<partVertices.getLast().size(); ++v)
+						remap[partVertices.getLast()[v]] = -1;
+				}
+				partVertices.push_back(core::array<u32>());
+				partIndices.push_back(core::array<u16>());
+			}
+			for (u32 c=0; c<3; ++c)
+			{
+				const u32 index = primitive.Indices[i+c];
+				if (remap[index] < 0)
+				{
+					remap[index] = partVertices.getLast().size();
+					partVertices.getLast().push_back(index);
+				}
+				partIndices.getLast().push_back((u16)remap[index]);
+			}
+		}
+	}
+
+	IAnimatedMesh* createStaticMesh()
+	{
+		const SJSONValue* nodes = Document.get(Document.getRoot(), "nodes");
+		SMesh* mesh = new SMesh();
+
+		core::array<u32> stack;
+		core::array<core::matrix4> matrices;
+		for (u32 r=Roots.size(); r>0; --r)
+		{
+			stack.push_back(Roots[r-1]);
+			matrices.push_back(getLocalMatrix(Roots[r-1]));
+		}
+
+		core::array<core::array<u32> > partVertices;
+		core::array<core::array<u16> > partIndices;
+		while (stack.size())
+		{
+			const u32 node = stack.getLast();
+			const core::matrix4 matrix = matrices.getLast();
+			stack.erase(stack.size()-1);
+			matrices.erase(matrices.size()-1);
+
+			const SJSONValue* json = Document.at(nodes, node);
+			const SJSONValue* children = Document.get(json, "children");
+			for (u32 c=Document.getCount(children); c>0; --c)
+			{
+				const u32 child = (u32)Document.at(children, c-1)->Number;
+				stack.push_back(child);
+				matrices.push_back(matrix * getLocalMatrix(child));
+			}
+
+			const s32 meshIndex = Document.getInt(json, "mesh", -1);
+			if (meshIndex < 0 || (u32)meshIndex + 1 >= MeshPrimitives.size())
+				continue;
+
+			// normals are transformed with the inverse transposed matrix
+			core::matrix4 normalMatrix;
+			matrix.getInverse(normalMatrix);
+			normalMatrix = normalMatrix.getTransposed();
+			const f32* m = matrix.pointer();
+			const f32 determinant = m[0] * (m[5]*m[10] - m[6]*m[9]) - m[1] * (m[4]*m[10] - m[6]*m[8]) + m[2] * (m[4]*m[9] - m[5]*m[8]);
+
+			for (u32 p=MeshPrimitives[meshIndex]; p<MeshPrimitives[meshIndex+1]; ++p)
+			{
+				const SGLTFPrimitive& primitive = Primitives[p];
+				splitPrimitive(primitive, partVertices, partIndices);
+				for (u32 part=0; part<partVertices.size(); ++part)
+				{
+					IMeshBuffer* buffer;
+					if (primitive.SecondTCoords)
+					{
+						SMeshBufferLightMap* lightMapBuffer = new SMeshBufferLightMap();
+						lightMapBuffer->Vertices.set_used(partVertices[part].size());
+						for (u32 v=0; v<partVertices[part].size(); ++v)
+							lightMapBuffer->Vertices[v] = primitive.Vertices[partVertices[part][v]];
+						lightMapBuffer->Indices = partIndices[part];
+						buffer = lightMapBuffer;
+					}
+					else
+					{
+						SMeshBuffer* standardBuffer = new SMeshBuffer();
+						standardBuffer->Vertices.set_used(partVertices[part].size());
+						for (u32 v=0; v<partVertices[part].size(); ++v)
+							standardBuffer->Vertices[v] = primitive.Vertices[partVertices[part][v]];
+						standardBuffer->Indices = partIndices[part];
+						buffer = standardBuffer;
+					}
+
+					for (u32 v=0; v<buffer->getVertexCount(); ++v)
+					{
+						matrix.transformVect(buffer->getPosition(v));
+						normalMatrix.rotateVect(buffer->getNormal(v));
+						buffer->getNormal(v).normalize();
+					}
+					if (determinant < 0.f)
+					{
+						// mirroring transformations turn the triangles around
+						u16* indices = buffer->getIndices();
+						for (u32 i=0; i<buffer->getIndexCount(); i+=3)
+							core::swap(indices[i+1], indices[i+2]);
+					}
+
+					buffer->getMaterial() = getMaterial(primitive.Material);
+					buffer->recalculateBoundingBox();
+					mesh->addMeshBuffer(buffer);
+					buffer->drop();
+				}
+			}
+		}
+
+		mesh->recalculateBoundingBox();
+		SAnimatedMesh* animatedMesh = new SAnimatedMesh(mesh);
+		mesh->drop();
+		return animatedMesh;
+	}
+
+	IAnimatedMesh* createSkinnedMesh()
+	{
+		const SJSONValue* root = Document.getRoot();
+		const SJSONValue* nodes = Document.get(root, "nodes");
+		const SJSONValue* skins = Document.get(root, "skins");
+		CSkinnedMesh* mesh = new CSkinnedMesh();
+
+		// a joint for each node, parents before their children
+		core::array<ISkinnedMesh::SJoint*> joints;
+		joints.set_used(Document.getCount(nodes));
+		memset(joints.pointer(), 0, joints.size() * sizeof(ISkinnedMesh::SJoint*));
+		core::array<u32> stack;
+		for (u32 r=Roots.size(); r>0; --r)
+			stack.push_back(Roots[r-1]);
+		core::array<u32> order;
+		while (stack.size())
+		{
+			const u32 node = stack.getLast();
+			stack.erase(stack.size()-1);
+			order.push_back(node);
+
+			const SJSONValue* json = Document.at(nodes, node);
+			ISkinnedMesh::SJoint* joint = mesh->addJoint(Parents[node] >= 0 ? joints[Parents[node]] : 0);
+			joints[node] = joint;
+			joint->Name = CJSONDocument::getString(Document.get(json, "name"));
+			joint->LocalMatrix = getLocalMatrix(node, &joint->Animatedposition, &joint->Animatedrotation, &joint->Animatedscale);
+			joint->GlobalMatrix = Parents[node] >= 0 ? joints[Parents[node]]->GlobalMatrix * joint->LocalMatrix : joint->LocalMatrix;
+
+			const SJSONValue* children = Document.get(json, "children");
+			for (u32 c=Document.getCount(children); c>0; --c)
+				stack.push_back((u32)Document.at(children, c-1)->Number);
+		}
+
+		// the inverse bind matrices, the first skin of a joint wins
+		core::array<u8> bound;
+		bound.set_used(joints.size());
+		memset(bound.pointer(), 0, bound.size());
+		core::array<f32> matrices;
+		for (u32 s=0; s<Document.getCount(skins); ++s)
+		{
+			const SJSONValue* skin = Document.at(skins, s);
+			const SJSONValue* skinJoints = Document.get(skin, "joints");
+			const s32 accessor = Document.getInt(skin, "inverseBindMatrices", -1);
+			if (accessor < 0)
+				continue;
+			if (!readFloats(accessor, matrices, 16) || matrices.size() < Document.getCount(skinJoints) * 16)
+			{
+				mesh->drop();
+				return failMesh("Invalid inverse bind matrices");
+			}
+			for (u32 j=0; j<Document.getCount(skinJoints); ++j)
+			{
+				const u32 node = (u32)Document.at(skinJoints, j)->Number;
+				if (node >= joints.size() || !joints[node] || bound[node])
+					continue;
+				f32* m = &matrices[j*16];
+				m[2] = -m[2];
+				m[6] = -m[6];
+				m[8] = -m[8];
+				m[9] = -m[9];
+				m[11] = -m[11];
+				m[14] = -m[14];
+				joints[node]->GlobalInversedMatrix.setM(m);
+				bound[node] = 1;
+			}
+		}
+
+		core::array<core::array<u32> > partVertices;
+		core::array<core::array<u16> > partIndices;
+		for (u32 o=0; o<order.size(); ++o)
+		{
+			const u32 node = order[o];
+			const SJSONValue* json = Document.at(nodes, node);
+			const s32 meshIndex = Document.getInt(json, "mesh", -1);
+			if (meshIndex < 0 || (u32)meshIndex + 1 >= MeshPrimitives.size())
+				continue;
+			const SJSONValue* skinJoints = Document.get(Document.at(skins, (u32)Document.getInt(json, "skin", -1)), "joints");
+
+			for (u32 p=MeshPrimitives[meshIndex]; p<MeshPrimitives[meshIndex+1]; ++p)
+			{
+				const SGLTFPrimitive& primitive = Primitives[p];
+				const bool skinned = skinJoints && primitive.Influences;
+				splitPrimitive(primitive, partVertices, partIndices);
+				for (u32 part=0; part<partVertices.size(); ++part)
+				{
+					const u32 bufferId = mesh->getMeshBuffers().size();
+					SSkinMeshBuffer* buffer = mesh->addMeshBuffer();
+					const core::array<u32>& vertices = partVertices[part];
+					if (primitive.SecondTCoords)
+					{
+						buffer->setVertexType(video::EVT_2TCOORDS);
+						buffer->setVertexCount(vertices.size());
+						video::S3DVertex2TCoords* out = buffer->getVertexArray<video::S3DVertex2TCoords>();
+						for (u32 v=0; v<vertices.size(); ++v)
+							out[v] = primitive.Vertices[vertices[v]];
+					}
+					else
+					{
+						buffer->setVertexCount(vertices.size());
+						video::S3DVertex* out = buffer->getVertexArray<video::S3DVertex>();
+						for (u32 v=0; v<vertices.size(); ++v)
+						{
+							const video::S3DVertex2TCoords& vertex = primitive.Vertices[vertices[v]];
+							out[v] = video::S3DVertex(vertex.Pos, vertex.Normal, vertex.Color, vertex.TCoords);
+						}
+					}
+					buffer->Indices = partIndices[part];
+					buffer->Material = getMaterial(primitive.Material);
+					buffer->recalculateBoundingBox();
+
+					if (!skinned)
+					{
+						// moves with the joint of its node
+						joints[node]->AttachedMeshes.push_back(bufferId);
+						continue;
+					}
+
+					for (u32 v=0; v<vertices.size(); ++v)
+					{
+						for (u32 i=0; i<primitive.Influences; ++i)
+						{
+							const f32 strength = primitive.Weights[vertices[v]*primitive.Influences+i];
+							if (strength <= 0.f)
+								continue;
+							const SJSONValue* jointJson = Document.at(skinJoints, primitive.Joints[vertices[v]*primitive.Influences+i]);
+							const u32 jointNode = jointJson ? (u32)jointJson->Number : joints.size();
+							if (jointNode >= joints.size() || !joints[jointNode])
+								continue;
+							ISkinnedMesh::SWeight* weight = mesh->addWeight(joints[jointNode]);
+							weight->buffer_id = (u16)bufferId;
+							weight->vertex_id = v;
+							weight->strength = strength;
+						}
+					}
+				}
+			}
+		}
+
+		if (!readAnimation(mesh, joints))
+		{
+			mesh->drop();
+			return failMesh("Invalid animation");
+		}
+
+		mesh->setAnimationSpeed(GLTF_FRAMES_PER_SECOND);
+		mesh->finalize();
+		return mesh;
+	}
+
+	//! Converts the channels of the first animation to keys
+	bool readAnimation(CSkinnedMesh* mesh, const core::array<ISkinnedMesh::SJoint*>& joints) const
+	{
+		const SJSONValue* animation = Document.at(Document.get(Document.getRoot(), "animations"), 0);
+		const SJSONValue* channels = Document.get(animation, "channels");
+		const SJSONValue* samplers = Document.get(animation, "samplers");
+		core::array<f32> times;
+		core::array<f32> values;
+		for (u32 c=0; c<Document.getCount(channels); ++c)
+		{
+			const SJSONValue* channel = Document.at(channels, c);
+			const SJSONValue* target = Document.get(channel, "target");
+			const SJSONValue* path = Document.get(target, "path");
+			const u32 node = (u32)Document.getInt(target, "node", -1);
+			if (node >= joints.size() || !joints[node] || CJSONDocument::equals(path, "weights"))
+				continue;
+
+			const SJSONValue* sampler = Document.at(samplers, (u32)Document.getInt(channel, "sampler", -1));
+			const bool rotation = CJSONDocument::equals(path, "rotation");
+			const u32 components = rotation ? 4 : 3;
+			if (!sampler || !readFloats(Document.getInt(sampler, "input", -1), times, 1) ||
+				!readFloats(Document.getInt(sampler, "output", -1), values, components))
+			{
+				return false;
+			}
+
+			// cubic splines have tangents around each value
+			const SJSONValue* interpolation = Document.get(sampler, "interpolation");
+			const bool cubic = CJSONDocument::equals(interpolation, "CUBICSPLINE");
+			const bool step = CJSONDocument::equals(interpolation, "STEP");
+			const u32 valueStride = cubic ? components * 3 : components;
+			const u32 valueOffset = cubic ? components : 0;
+			if (values.size() < times.size() * valueStride)
+				return false;
+
+			ISkinnedMesh::SJoint* joint = joints[node];
+			for (u32 k=0; k<times.size(); ++k)
+			{
+				// steps hold the previous value until just before the next key
+				const u32 keyCount = step && k > 0 ? 2 : 1;
+				for (u32 n=0; n<keyCount; ++n)
+				{
+					const f32 frame = times[k] * GLTF_FRAMES_PER_SECOND - (keyCount == 2 && n == 0 ? 0.001f : 0.f);
+					const f32* v = &values[(keyCount == 2 && n == 0 ? k-1 : k) * valueStride + valueOffset];
+					if (rotation)
+					{
+						ISkinnedMesh::SRotationKey* key = mesh->addRotationKey(joint);
+						key->frame = frame;
+						key->rotation.set(v[0], v[1], -v[2], v[3]);
+						key->rotation.normalize();
+					}
+					else if (CJSONDocument::equals(path, "translation"))
+					{
+						ISkinnedMesh::SPositionKey* key = mesh->addPositionKey(joint);
+						key->frame = frame;
+						key->position.set(v[0], v[1], -v[2]);
+					}
+					else if (CJSONDocument::equals(path, "scale"))
+					{
+						ISkinnedMesh::SScaleKey* key = mesh->addScaleKey(joint);
+						key->frame = frame;
+						key->scale.set(v[0], v[1], v[2]);
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	const video::SMaterial& getMaterial(s32 material) const
+	{
+		return material >= 0 && (u32)material+1 < Materials.size() ? Materials[material] : Materials.getLast();
+	}
+
+	ISceneManager* SceneManager;
+	CJobSystem*& Jobs;
+
+	io::path FileName;
+	io::path Dir;
+	const u8* FileData;
+	u32 FileSize;
+	CJSONDocument Document;
+
+	//! Mapped buffer files, and data which was read or decoded
+	core::array<io::IReadFile*> Files;
+	core::array<u8*> OwnedData;
+
+	core::array<const u8*> Buffers;
+	core::array<u32> BufferSizes;
+	core::array<SGLTFBufferView> BufferViews;
+	core::array<SGLTFAccessor> Accessors;
+
+	//! Materials of the file and the default one at the end
+	core::array<video::SMaterial> Materials;
+	core::array<s32> Parents;
+	core::array<u32> Roots;
+	//! Primitives of all meshes, those of mesh i start at MeshPrimitives[i]
+	core::array<SGLTFPrimitive> Primitives;
+	core::array<u32> MeshPrimitives;
+};
+
+//! Converts a primitive to vertices and triangles, runs on the worker threads
+void convertPrimitiveJob(void* data)
+{
+	SGLTFPrimitive& primitive = *(SGLTFPrimitive*)data;
+	const CGLTFReader& reader = *primitive.Reader;
+	const CJSONDocument& document = reader.getDocument();
+	const SJSONValue* attributes = document.get(primitive.Json, "attributes");
+	primitive.Material = document.getInt(primitive.Json, "material", -1);
+
+	core::array<f32> values;
+	const s32 positions = document.getInt(attributes, "POSITION", -1);
+	if (!reader.readFloats(positions, values, 3))
+		return;
+	const u32 vertexCount = values.size() / 3;
+	primitive.Vertices.set_used(vertexCount);
+	for (u32 i=0; i<vertexCount; ++i)
+	{
+		// glTF is right handed, z is mirrored
+		video::S3DVertex2TCoords& vertex = primitive.Vertices[i];
+		vertex.Pos.set(values[i*3], values[i*3+1], -values[i*3+2]);
+		vertex.Color.set(0xffffffff);
+	}
+
+	const s32 normals = document.getInt(attributes, "NORMAL", -1);
+	if (normals >= 0)
+	{
+		if (!reader.readFloats(normals, values, 3) || values.size() != vertexCount * 3)
+			return;
+		for (u32 i=0; i<vertexCount; ++i)
+			primitive.Vertices[i].Normal.set(values[i*3], values[i*3+1], -values[i*3+2]);
+	}
+
+	for (u32 set=0; set<2; ++set)
+	{
+		const s32 tcoords = document.getInt(attributes, set ? "TEXCOORD_1" : "TEXCOORD_0", -1);
+		if (tcoords < 0)
+			continue;
+		if (!reader.readFloats(tcoords, values, 2) || values.size() != vertexCount * 2)
+			return;
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			core::vector2df& tcoord = set ? primitive.Vertices[i].TCoords2 : primitive.Vertices[i].TCoords;
+			tcoord.set(values[i*2], values[i*2+1]);
+		}
+		primitive.SecondTCoords = set == 1;
+	}
+
+	const video::SColorf baseColor = reader.getBaseColor(primitive.Material);
+	const s32 colors = document.getInt(attributes, "COLOR_0", -1);
+	const u32 colorComponents = reader.getAccessorComponents(colors);
+	if (colors >= 0)
+	{
+		if ((colorComponents != 3 && colorComponents != 4) || !reader.readFloats(colors, values, colorComponents) ||
+			values.size() != vertexCount * colorComponents)
+		{
+			return;
+		}
+	}
+	for (u32 i=0; i<vertexCount; ++i)
+	{
+		video::SColorf color(baseColor);
+		if (colors >= 0)
+		{
+			const f32* c = &values[i*colorComponents];
+			color.set(colorComponents == 4 ? c[3] * color.a : color.a, c[0] * color.r, c[1] * color.g, c[2] * color.b);
+		}
+		primitive.Vertices[i].Color = color.toSColor();
+	}
+
+	// up to two sets of joints and weights
+	core::array<u32> joints;
+	for (u32 set=0; set<2; ++set)
+	{
+		const s32 jointAccessor = document.getInt(attributes, set ? "JOINTS_1" : "JOINTS_0", -1);
+		const s32 weightAccessor = document.getInt(attributes, set ? "WEIGHTS_1" : "WEIGHTS_0", -1);
+		if (jointAccessor < 0 || weightAccessor < 0)
+			break;
+		if (!reader.readUInts(jointAccessor, joints, 4) || !reader.readFloats(weightAccessor, values, 4) ||
+			joints.size() != vertexCount * 4 || values.size() != vertexCount * 4)
+		{
+			return;
+		}
+		primitive.Influences = (set + 1) * 4;
+		primitive.Joints.set_used(vertexCount * primitive.Influences);
+		primitive.Weights.set_used(vertexCount * primitive.Influences);
+		for (u32 i=vertexCount; i>0; --i)
+		{
+			// the first set moves to the front of the wider layout
+			const u32 v = i-1;
+			if (set)
+			{
+				for (u32 k=4; k>0; --k)
+				{
+					primitive.Joints[v*8+k-1] = primitive.Joints[v*4+k-1];
+					primitive.Weights[v*8+k-1] = primitive.Weights[v*4+k-1];
+				}
+			}
+			for (u32 k=0; k<4; ++k)
+			{
+				primitive.Joints[v*primitive.Influences+set*4+k] = (u16)joints[v*4+k];
+				primitive.Weights[v*primitive.Influences+set*4+k] = values[v*4+k];
+			}
+		}
+	}
+
+	// triangles, strips and fans become triangle lists with the winding of Irrlicht
+	core::array<u32> indices;
+	const s32 indexAccessor = document.getInt(primitive.Json, "indices", -1);
+	if (indexAccessor >= 0)
+	{
+		if (!reader.readUInts(indexAccessor, indices, 1))
+			return;
+	}
+	else
+	{
+		indices.set_used(vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+			indices[i] = i;
+	}
+
+	const s32 mode = document.getInt(primitive.Json, "mode", 4);
+	if (mode == 4)
+	{
+		primitive.Indices.reallocate(indices.size() / 3 * 3);
+		for (u32 i=0; i+2<indices.size(); i+=3)
+		{
+			primitive.Indices.push_back(indices[i]);
+			primitive.Indices.push_back(indices[i+2]);
+			primitive.Indices.push_back(indices[i+1]);
+		}
+	}
+	else if (mode == 5 || mode == 6)
+	{
+		primitive.Indices.reallocate(indices.size() > 2 ? (indices.size() - 2) * 3 : 0);
+		for (u32 i=0; i+2<indices.size(); ++i)
+		{
+			const u32 a = mode == 6 ? indices[0] : indices[i + (i & 1)];
+			const u32 b = mode == 6 ? indices[i+1] : indices[i + 1 - (i & 1)];
+			const u32 c = indices[i+2];
+			primitive.Indices.push_back(a);
+			primitive.Indices.push_back(c);
+			primitive.Indices.push_back(b);
+		}
+	}
+	else
+	{
+		// points and lines are skipped
+		primitive.Result = true;
+		return;
+	}
+
+	for (u32 i=0; i<primitive.Indices.size(); ++i)
+	{
+		if (primitive.Indices[i] >= vertexCount)
+		{
+			primitive.Indices.clear();
+			return;
+		}
+	}
+
+	if (normals < 0)
+	{
+		// normals of the faces around each vertex
+		for (u32 i=0; i<primitive.Indices.size(); i+=3)
+		{
+			video::S3DVertex2TCoords& a = primitive.Vertices[primitive.Indices[i]];
+			video::S3DVertex2TCoords& b = primitive.Vertices[primitive.Indices[i+1]];
+			video::S3DVertex2TCoords& c = primitive.Vertices[primitive.Indices[i+2]];
+			const core::vector3df normal = (b.Pos - a.Pos).crossProduct(c.Pos - a.Pos);
+			a.Normal += normal;
+			b.Normal += normal;
+			c.Normal += normal;
+		}
+		for (u32 i=0; i<vertexCount; ++i)
+			primitive.Vertices[i].Normal.normalize();
+	}
+
+	primitive.Result = true;
+}
+
+} // end anonymous namespace
+
+
+//! Constructor
+CGLTFMeshFileLoader::CGLTFMeshFileLoader(scene::ISceneManager* smgr)
+	: SceneManager(smgr), Jobs(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CGLTFMeshFileLoader");
+	#endif
+}
+
+
+//! destructor
+CGLTFMeshFileLoader::~CGLTFMeshFileLoader()
+{
+	delete Jobs;
+}
+
+
+//! returns true if the file maybe is able to be loaded by this class
+//! based on the file extension (e.g. ".gltf")
+bool CGLTFMeshFileLoader::isALoadableFileExtension(const io::path& filename) const
+{
+	return core::hasFileExtension(filename, "gltf", "glb");
+}
+
+
+//! creates/loads an animated mesh from the file.
+//! \return Pointer to the created mesh. Returns 0 if loading failed.
+//! If you no longer need the mesh, you should call IAnimatedMesh::drop().
+//! See IReferenceCounted::drop() for more information.
+IAnimatedMesh* CGLTFMeshFileLoader::createMesh(io::IReadFile* file)
+{
+	if (!file || !file->getSize())
+		return 0;
+
+	CGLTFReader reader(SceneManager, Jobs);
+	if (!reader.read(file))
+		return 0;
+	return reader.createMesh();
+}
+
+} // end namespace scene
+} // end namespace irr
+
@@ -0,0 +1,57 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_GLTF_MESH_FILE_LOADER_H_INCLUDED__
+#define __C_GLTF_MESH_FILE_LOADER_H_INCLUDED__
+
+#include "IMeshLoader.h"
+#include "ISceneManager.h"
+
+namespace irr
+{
+namespace scene
+{
+
+class CJobSystem;
+
+//! Meshloader for glTF 2.0 files, .gltf with external or embedded buffers and binary .glb
+/** Meshes without skins and animations become an SMesh with the node
+transformations applied, the others a CSkinnedMesh with a joint for each
+node. The accessors are read in place from files in memory, like mapped
+ones, with the vertex quantization of KHR_mesh_quantization. Buffer views
+compressed with EXT_meshopt_compression and the primitives are decoded on
+worker threads. Only the first animation is loaded, morph targets are
+ignored. The base color textures are recorded with
+ISceneManager::addMeshTextureReference() if MESH_LOADER_TEXTURES is set. */
+class CGLTFMeshFileLoader : public IMeshLoader
+{
+public:
+
+	//! Constructor
+	CGLTFMeshFileLoader(scene::ISceneManager* smgr);
+
+	//! destructor
+	virtual ~CGLTFMeshFileLoader();
+
+	//! returns true if the file maybe is able to be loaded by this class
+	//! based on the file extension (e.g. ".gltf")
+	bool isALoadableFileExtension(const io::path& filename) const override;
+
+	//! creates/loads an animated mesh from the file.
+	//! \return Pointer to the created mesh. Returns 0 if loading failed.
+	//! If you no longer need the mesh, you should call IAnimatedMesh::drop().
+	//! See IReferenceCounted::drop() for more information.
+	IAnimatedMesh* createMesh(io::IReadFile* file) override;
+
+private:
+
+	scene::ISceneManager* SceneManager;
+
+	//! Decodes the buffer views and primitives in parallel, created by the first file
+	CJobSystem* Jobs;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -28,7 +28,7 @@ namespace video
 {
 
 CGLXManager::CGLXManager(const SIrrlichtCreationParameters& params, const SExposedVideoData& videodata, int screennr)
-	: Params(params), PrimaryContext(videodata), VisualInfo(0), glxFBConfig(0), GlxWin(0)
+	: Params(params), PrimaryContext(videodata), VisualInfo(0), glxFBConfig(0), GlxWin(0), ScreenNr(screennr)
 {
 	#ifdef _DEBUG
 	setDebugName("CGLXManager");
@@ -318,46 +318,53 @@ static int IrrIgnoreError(Display *display, XErrorEvent *event)
 }
 #endif
 
-bool CGLXManager::generateContext()
+void* CGLXManager::createGLXContext(void* shareContext)
 {
 	GLXContext context = 0;
 
-	if (glxFBConfig)
-	{
-		if (GlxWin)
-		{
 #if defined(GLX_ARB_create_context)
 
 #ifdef _IRR_OPENGL_USE_EXTPOINTER_
-		PFNGLXCREATECONTEXTATTRIBSARBPROC glxCreateContextAttribsARB=(PFNGLXCREATECONTEXTATTRIBSARBPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXCreateContextAttribsARB"));
+	PFNGLXCREATECONTEXTATTRIBSARBPROC glxCreateContextAttribsARB=(PFNGLXCREATECONTEXTATTRIBSARBPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXCreateContextAttribsARB"));
 #else
-		PFNGLXCREATECONTEXTATTRIBSARBPROC glxCreateContextAttribsARB=glXCreateContextAttribsARB;
+	PFNGLXCREATECONTEXTATTRIBSARBPROC glxCreateContextAttribsARB=glXCreateContextAttribsARB;
 #endif
 
-			if (glxCreateContextAttribsARB)
-			{
-				os::Printer::log("GLX with GLX_ARB_create_context", ELL_DEBUG);
-				int contextAttrBuffer[] = {
-					GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
-					GLX_CONTEXT_MINOR_VERSION_ARB, 0,
-					// GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
-					None
-				};
-				XErrorHandler old = XSetErrorHandler(IrrIgnoreError);
-				context = glxCreateContextAttribsARB((Display*)CurrentContext.OpenGLLinux.X11Display, (GLXFBConfig)glxFBConfig, NULL, True, contextAttrBuffer);
-				XSetErrorHandler(old);
-				// transparently fall back to legacy call
-			}
-			if (!context)
+	if (glxCreateContextAttribsARB)
+	{
+		os::Printer::log("GLX with GLX_ARB_create_context", ELL_DEBUG);
+		int contextAttrBuffer[] = {
+			GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
+			GLX_CONTEXT_MINOR_VERSION_ARB, 0,
+			// GLX_CONTEXT_PROFILE_MASK_ARB, GLX_CONTEXT_CORE_PROFILE_BIT_ARB,
+			None
+		};
+		XErrorHandler old = XSetErrorHandler(IrrIgnoreError);
+		context = glxCreateContextAttribsARB((Display*)CurrentContext.OpenGLLinux.X11Display, (GLXFBConfig)glxFBConfig, (GLXContext)shareContext, True, contextAttrBuffer);
+		XSetErrorHandler(old);
+		// transparently fall back to legacy call
+	}
+	if (!context)
 #endif
+		context = glXCreateNewContext((Display*)CurrentContext.OpenGLLinux.X11Display, (GLXFBConfig)glxFBConfig, GLX_RGBA_TYPE, (GLXContext)shareContext, True);
+
+	return context;
+}
+
+bool CGLXManager::generateContext()
+{
+	GLXContext context = 0;
+
+	if (glxFBConfig)
+	{
+		if (GlxWin)
+		{
+			// create glx context
+			context = (GLXContext)createGLXContext(0);
+			if (!context)
 			{
-				// create glx context
-				context = glXCreateNewContext((Display*)CurrentContext.OpenGLLinux.X11Display, (GLXFBConfig)glxFBConfig, GLX_RGBA_TYPE, NULL, True);
-				if (!context)
-				{
-					os::Printer::log("Could not create GLX rendering context.", ELL_WARNING);
-					return false;
-				}
+				os::Printer::log("Could not create GLX rendering context.", ELL_WARNING);
+				return false;
 			}
 		}
 		else
@@ -446,6 +453,127 @@ bool CGLXManager::activateContext(const SExposedVideoData& videoData, bool resto
 	return true;
 }
 
+bool CGLXManager::setContextCurrent(bool current)
+{
+	Display* display = (Display*)PrimaryContext.OpenGLLinux.X11Display;
+	const bool success = current ?
+		glXMakeCurrent(display, CurrentContext.OpenGLLinux.GLXWindow, (GLXContext)CurrentContext.OpenGLLinux.X11Context) :
+		glXMakeCurrent(display, None, NULL);
+	if (!success)
+		os::Printer::log(current ? "Context activation failed." : "Render Context reset failed.", ELL_ERROR);
+	return success;
+}
+
+namespace
+{
+	//! A context of CGLXManager::createSharedContext() with the pbuffer it draws to
+	struct SGLXSharedContext
+	{
+		GLXContext Context;
+		GLXPbuffer Pbuffer;
+	};
+}
+
+void* CGLXManager::createSharedContext()
+{
+	Display* display = (Display*)CurrentContext.OpenGLLinux.X11Display;
+
+	// a context without window needs a pbuffer, which GLX 1.2 visuals lack
+	if (!glxFBConfig || !CurrentContext.OpenGLLinux.X11Context)
+		return 0;
+
+	int drawableType = 0;
+	glXGetFBConfigAttrib(display, (GLXFBConfig)glxFBConfig, GLX_DRAWABLE_TYPE, &drawableType);
+	if (!(drawableType & GLX_PBUFFER_BIT))
+	{
+		os::Printer::log("GLX frame buffer configuration doesn't support pbuffers for shared contexts.", ELL_INFORMATION);
+		return 0;
+	}
+
+	const int pbufferAttributes[] = { GLX_PBUFFER_WIDTH, 1, GLX_PBUFFER_HEIGHT, 1, None };
+	SGLXSharedContext* shared = new SGLXSharedContext;
+	shared->Pbuffer = glXCreatePbuffer(display, (GLXFBConfig)glxFBConfig, pbufferAttributes);
+	shared->Context = shared->Pbuffer ? (GLXContext)createGLXContext(CurrentContext.OpenGLLinux.X11Context) : 0;
+
+	if (!shared->Context)
+	{
+		os::Printer::log("Could not create shared GLX context.", ELL_WARNING);
+		destroySharedContext(shared);
+		return 0;
+	}
+
+	return shared;
+}
+
+bool CGLXManager::makeSharedContextCurrent(void* context)
+{
+	Display* display = (Display*)PrimaryContext.OpenGLLinux.X11Display;
+	const SGLXSharedContext* shared = (const SGLXSharedContext*)context;
+
+	const Bool success = shared ?
+		glXMakeContextCurrent(display, shared->Pbuffer, shared->Pbuffer, shared->Context) :
+		glXMakeContextCurrent(display, None, None, NULL);
+	if (!success)
+		os::Printer::log(shared ? "Shared context activation failed." : "Shared context release failed.", ELL_WARNING);
+	return success == True;
+}
+
+void CGLXManager::destroySharedContext(void* context)
+{
+	SGLXSharedContext* shared = (SGLXSharedContext*)context;
+	if (!shared)
+		return;
+
+	Display* display = (Display*)PrimaryContext.OpenGLLinux.X11Display;
+	if (shared->Context)
+		glXDestroyContext(display, shared->Context);
+	if (shared->Pbuffer)
+		glXDestroyPbuffer(display, shared->Pbuffer);
+	delete shared;
+}
+
+bool CGLXManager::setSwapInterval(s32 interval)
+{
+	Display* display = (Display*)CurrentContext.OpenGLLinux.X11Display;
+	const char* extensions = glXQueryExtensionsString(display, ScreenNr);
+	if (!extensions)
+		return false;
+
+	// adaptive vsync needs GLX_EXT_swap_control_tear, otherwise it's normal vsync
+	if (interval < 0 && !strstr(extensions, "GLX_EXT_swap_control_tear"))
+		interval = -interval;
+
+	if (strstr(extensions, "GLX_EXT_swap_control"))
+	{
+		PFNGLXSWAPINTERVALEXTPROC glxSwapIntervalEXT = (PFNGLXSWAPINTERVALEXTPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXSwapIntervalEXT"));
+		if (glxSwapIntervalEXT)
+		{
+			glxSwapIntervalEXT(display, CurrentContext.OpenGLLinux.GLXWindow, interval);
+			return true;
+		}
+	}
+
+	// the older extensions know no adaptive vsync, and the SGI one can't disable it
+	if (interval < 0)
+		interval = -interval;
+
+	if (strstr(extensions, "GLX_MESA_swap_control"))
+	{
+		PFNGLXSWAPINTERVALMESAPROC glxSwapIntervalMESA = (PFNGLXSWAPINTERVALMESAPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXSwapIntervalMESA"));
+		if (glxSwapIntervalMESA)
+			return glxSwapIntervalMESA(interval) == 0;
+	}
+
+	if (interval > 0 && strstr(extensions, "GLX_SGI_swap_control"))
+	{
+		PFNGLXSWAPINTERVALSGIPROC glxSwapIntervalSGI = (PFNGLXSWAPINTERVALSGIPROC)glXGetProcAddress(reinterpret_cast<const GLubyte*>("glXSwapIntervalSGI"));
+		if (glxSwapIntervalSGI)
+			return glxSwapIntervalSGI(interval) == 0;
+	}
+
+	return false;
+}
+
 void CGLXManager::destroyContext()
 {
 	if (CurrentContext.OpenGLLinux.X11Context)
@@ -56,6 +56,21 @@ namespace video
         //! Change render context, disable old and activate new defined by videoData
         bool activateContext(const SExposedVideoData& videoData, bool restorePrimaryOnZero) override;
 
+        //! Makes the context current on the calling thread, or releases it
+        bool setContextCurrent(bool current) override;
+
+        //! Creates a context sharing the resources of the context of the manager
+        void* createSharedContext() override;
+
+        //! Makes a context of createSharedContext() current on the calling thread, or releases it
+        bool makeSharedContextCurrent(void* context) override;
+
+        //! Destroys a context of createSharedContext()
+        void destroySharedContext(void* context) override;
+
+        //! Sets how many vertical blanks swapBuffers() waits for
+        bool setSwapInterval(s32 interval) override;
+
 		// Get procedure address.
 		void* getProcAddress(const std::string &procName) override;
 
@@ -65,12 +80,16 @@ namespace video
         XVisualInfo* getVisual() const {return VisualInfo;} // return XVisualInfo
 
     private:
+        //! Creates a context for glxFBConfig, sharing the resources of shareContext if not 0
+        void* createGLXContext(void* shareContext);
+
         SIrrlichtCreationParameters Params;
         SExposedVideoData PrimaryContext;
         SExposedVideoData CurrentContext;
         XVisualInfo* VisualInfo;
         void* glxFBConfig; // GLXFBConfig
         XID GlxWin; // GLXWindow
+        int ScreenNr;
 	};
 }
 }
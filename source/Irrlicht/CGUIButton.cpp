@@ -51,6 +51,7 @@ CGUIButton::~CGUIButton()
 //! Sets if the images should be scaled to fit the button
 void CGUIButton::setScaleImage(bool scaleImage)
 {
+	invalidateDrawCache();
 	ScaleImage = scaleImage;
 }
 
@@ -65,12 +66,14 @@ bool CGUIButton::isScalingImage() const
 //! Sets if the button should use the skin to draw its border
 void CGUIButton::setDrawBorder(bool border)
 {
+	invalidateDrawCache();
 	DrawBorder = border;
 }
 
 
 void CGUIButton::setSpriteBank(IGUISpriteBank* sprites)
 {
+	invalidateDrawCache();
 	if (sprites)
 		sprites->grab();
 
@@ -83,6 +86,7 @@ void CGUIButton::setSpriteBank(IGUISpriteBank* sprites)
 
 void CGUIButton::setSprite(EGUI_BUTTON_STATE state, s32 index, video::SColor color, bool loop, bool scale)
 {
+	invalidateDrawCache();
 	ButtonSprites[(u32)state].Index	= index;
 	ButtonSprites[(u32)state].Color	= color;
 	ButtonSprites[(u32)state].Loop	= loop;
@@ -325,7 +329,7 @@ void CGUIButton::draw()
 		}
 
 		if (font)
-			font->draw(Text.c_str(), rect,
+			font->drawLayout(Text, TextLayout, rect,
 				getActiveColor(),
 				true, true, &AbsoluteClippingRect);
 	}
@@ -339,6 +343,11 @@ void CGUIButton::drawSprite(EGUI_BUTTON_STATE state, u32 startTime, const core::
 
 	if (ButtonSprites[stateIdx].Index != -1)
 	{
+		// animated sprites can't be replayed from a recording
+		const core::array<SGUISprite>& sprites = SpriteBank->getSprites();
+		if ((u32)ButtonSprites[stateIdx].Index < sprites.size() && sprites[ButtonSprites[stateIdx].Index].Frames.size() > 1)
+			invalidateDrawCache();
+
 		if ( ButtonSprites[stateIdx].Scale )
 		{
 			const video::SColor colors[] = {ButtonSprites[stateIdx].Color,ButtonSprites[stateIdx].Color,ButtonSprites[stateIdx].Color,ButtonSprites[stateIdx].Color};
@@ -424,6 +433,7 @@ EGUI_BUTTON_IMAGE_STATE CGUIButton::getImageState(bool pressed) const
 //! sets another skin independent font. if this is set to zero, the button uses the font of the skin.
 void CGUIButton::setOverrideFont(IGUIFont* font)
 {
+	invalidateDrawCache();
 	if (OverrideFont == font)
 		return;
 
@@ -456,6 +466,7 @@ IGUIFont* CGUIButton::getActiveFont() const
 //! Sets another color for the text.
 void CGUIButton::setOverrideColor(video::SColor color)
 {
+	invalidateDrawCache();
 	OverrideColor = color;
 	OverrideColorEnabled = true;
 }
@@ -477,6 +488,7 @@ irr::video::SColor CGUIButton::getActiveColor() const
 
 void CGUIButton::enableOverrideColor(bool enable)
 {
+	invalidateDrawCache();
 	OverrideColorEnabled = enable;
 }
 
@@ -487,6 +499,7 @@ bool CGUIButton::isOverrideColorEnabled() const
 
 void CGUIButton::setImage(EGUI_BUTTON_IMAGE_STATE state, video::ITexture* image, const core::rect<s32>& sourceRect)
 {
+	invalidateDrawCache();
 	if ( state >= EGBIS_COUNT )
 		return;
 
@@ -506,6 +519,7 @@ void CGUIButton::setImage(EGUI_BUTTON_IMAGE_STATE state, video::ITexture* image,
 //! the user can change the state of the button.
 void CGUIButton::setIsPushButton(bool isPushButton)
 {
+	invalidateDrawCache();
 	IsPushButton = isPushButton;
 }
 
@@ -520,6 +534,7 @@ bool CGUIButton::isPressed() const
 //! Sets the pressed state of the button if this is a pushbutton
 void CGUIButton::setPressed(bool pressed)
 {
+	invalidateDrawCache();
 	if (Pressed != pressed)
 	{
 		ClickTime = os::Timer::getTime();
@@ -538,6 +553,7 @@ bool CGUIButton::isPushButton() const
 //! Sets if the alpha channel should be used for drawing images on the button (default is false)
 void CGUIButton::setUseAlphaChannel(bool useAlphaChannel)
 {
+	invalidateDrawCache();
 	UseAlphaChannel = useAlphaChannel;
 }
 
@@ -7,6 +7,7 @@
 
 #include "IGUIButton.h"
 #include "IGUISpriteBank.h"
+#include "IGUIFont.h"
 #include "ITexture.h"
 #include "SColor.h"
 
@@ -222,6 +223,7 @@ namespace gui
 		ButtonImage ButtonImages[EGBIS_COUNT];
 
 		IGUIFont* OverrideFont;
+		SGUITextLayout TextLayout;
 
 		bool OverrideColorEnabled;
 		video::SColor OverrideColor;
@@ -176,7 +176,7 @@ void CGUICheckBox::draw()
 			IGUIFont* font = skin->getFont();
 			if (font)
 			{
-				font->draw(Text.c_str(), checkRect,
+				font->drawLayout(Text, TextLayout, checkRect,
 						skin->getColor(isEnabled() ? EGDC_BUTTON_TEXT : EGDC_GRAY_TEXT), false, true, &AbsoluteClippingRect);
 			}
 		}
@@ -188,6 +188,7 @@ void CGUICheckBox::draw()
 //! set if box is checked
 void CGUICheckBox::setChecked(bool checked)
 {
+	invalidateDrawCache();
 	Checked = checked;
 }
 
@@ -201,6 +202,7 @@ bool CGUICheckBox::isChecked() const
 //! Sets whether to draw the background
 void CGUICheckBox::setDrawBackground(bool draw)
 {
+	invalidateDrawCache();
 	Background = draw;
 }
 
@@ -213,6 +215,7 @@ bool CGUICheckBox::isDrawBackgroundEnabled() const
 //! Sets whether to draw the border
 void CGUICheckBox::setDrawBorder(bool draw)
 {
+	invalidateDrawCache();
 	Border = draw;
 }
 
@@ -6,6 +6,7 @@
 #define __C_GUI_CHECKBOX_H_INCLUDED__
 
 #include "IGUICheckBox.h"
+#include "IGUIFont.h"
 
 namespace irr
 {
@@ -47,6 +48,7 @@ namespace gui
 
 	private:
 
+		SGUITextLayout TextLayout;
 		u32 CheckTime;
 		bool Pressed;
 		bool Checked;
@@ -61,6 +61,7 @@ CGUIComboBox::CGUIComboBox(IGUIEnvironment* environment, IGUIElement* parent,
 
 void CGUIComboBox::setTextAlignment(EGUI_ALIGNMENT horizontal, EGUI_ALIGNMENT vertical)
 {
+	invalidateDrawCache();
 	HAlign = horizontal;
 	VAlign = vertical;
 	SelectedText->setTextAlignment(horizontal, vertical);
@@ -127,6 +128,7 @@ s32 CGUIComboBox::getIndexForItemData(u32 data ) const
 //! Removes an item from the combo box.
 void CGUIComboBox::removeItem(u32 idx)
 {
+	invalidateDrawCache();
 	if (idx >= Items.size())
 		return;
 
@@ -147,6 +149,7 @@ const wchar_t* CGUIComboBox::getText() const
 //! adds an item and returns the index of it
 u32 CGUIComboBox::addItem(const wchar_t* text, u32 data)
 {
+	invalidateDrawCache();
 	Items.push_back( SComboData ( text, data ) );
 
 	if (Selected == -1)
@@ -159,6 +162,7 @@ u32 CGUIComboBox::addItem(const wchar_t* text, u32 data)
 //! deletes all items in the combo box
 void CGUIComboBox::clear()
 {
+	invalidateDrawCache();
 	Items.clear();
 	setSelected(-1);
 }
@@ -174,6 +178,7 @@ s32 CGUIComboBox::getSelected() const
 //! sets the selected item. Set this to -1 if no item should be selected
 void CGUIComboBox::setSelected(s32 idx)
 {
+	invalidateDrawCache();
 	if (idx < -1 || idx >= (s32)Items.size())
 		return;
 
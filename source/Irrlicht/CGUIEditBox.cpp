@@ -75,6 +75,7 @@ CGUIEditBox::~CGUIEditBox()
 //! Sets another skin independent font.
 void CGUIEditBox::setOverrideFont(IGUIFont* font)
 {
+	invalidateDrawCache();
 	if (OverrideFont == font)
 		return;
 
@@ -109,6 +110,7 @@ IGUIFont* CGUIEditBox::getActiveFont() const
 //! Sets another color for the text.
 void CGUIEditBox::setOverrideColor(video::SColor color)
 {
+	invalidateDrawCache();
 	OverrideColor = color;
 	OverrideColorEnabled = true;
 }
@@ -123,6 +125,7 @@ video::SColor CGUIEditBox::getOverrideColor() const
 //! Turns the border on or off
 void CGUIEditBox::setDrawBorder(bool border)
 {
+	invalidateDrawCache();
 	Border = border;
 }
 
@@ -135,6 +138,7 @@ bool CGUIEditBox::isDrawBorderEnabled() const
 //! Sets whether to draw the background
 void CGUIEditBox::setDrawBackground(bool draw)
 {
+	invalidateDrawCache();
 	Background = draw;
 }
 
@@ -147,6 +151,7 @@ bool CGUIEditBox::isDrawBackgroundEnabled() const
 //! Sets if the text should use the override color or the color in the gui skin.
 void CGUIEditBox::enableOverrideColor(bool enable)
 {
+	invalidateDrawCache();
 	OverrideColorEnabled = enable;
 }
 
@@ -158,6 +163,7 @@ bool CGUIEditBox::isOverrideColorEnabled() const
 //! Enables or disables word wrap
 void CGUIEditBox::setWordWrap(bool enable)
 {
+	invalidateDrawCache();
 	WordWrap = enable;
 	breakText();
 }
@@ -186,6 +192,7 @@ bool CGUIEditBox::isWordWrapEnabled() const
 //! Enables or disables newlines.
 void CGUIEditBox::setMultiLine(bool enable)
 {
+	invalidateDrawCache();
 	MultiLine = enable;
 	breakText();
 }
@@ -200,6 +207,7 @@ bool CGUIEditBox::isMultiLineEnabled() const
 
 void CGUIEditBox::setPasswordBox(bool passwordBox, wchar_t passwordChar)
 {
+	invalidateDrawCache();
 	PasswordBox = passwordBox;
 	if (PasswordBox)
 	{
@@ -220,6 +228,7 @@ bool CGUIEditBox::isPasswordBox() const
 //! Sets text justification
 void CGUIEditBox::setTextAlignment(EGUI_ALIGNMENT horizontal, EGUI_ALIGNMENT vertical)
 {
+	invalidateDrawCache();
 	HAlign = horizontal;
 	VAlign = vertical;
 }
@@ -318,12 +327,8 @@ bool CGUIEditBox::processKey(const SEvent& event)
 				if (isEnabled())
 				{
 					// delete
-					core::stringw s;
-					s = Text.subString(0, realmbgn);
-					s.append( Text.subString(realmend, Text.size()-realmend) );
-					Text = s;
+					replaceText(realmbgn, realmend, core::stringw());
 
-					CursorPos = realmbgn;
 					newMarkBegin = 0;
 					newMarkEnd = 0;
 					textChanged = true;
@@ -350,30 +355,17 @@ bool CGUIEditBox::processKey(const SEvent& event)
 					if (MarkBegin == MarkEnd)
 					{
 						// insert text
-						core::stringw s = Text.subString(0, CursorPos);
-						s.append(widep);
-						s.append( Text.subString(CursorPos, Text.size()-CursorPos) );
-
-						if (!Max || s.size()<=Max) // thx to Fish FH for fix
+						if (!Max || Text.size()+widep.size()<=Max) // thx to Fish FH for fix
 						{
-							Text = s;
-							s = widep;
-							CursorPos += s.size();
+							replaceText(CursorPos, CursorPos, widep);
 						}
 					}
 					else
 					{
 						// replace text
-
-						core::stringw s = Text.subString(0, realmbgn);
-						s.append(widep);
-						s.append( Text.subString(realmend, Text.size()-realmend) );
-
-						if (!Max || s.size()<=Max)  // thx to Fish FH for fix
+						if (!Max || Text.size()-(realmend-realmbgn)+widep.size()<=Max)  // thx to Fish FH for fix
 						{
-							Text = s;
-							s = widep;
-							CursorPos = realmbgn + s.size();
+							replaceText(realmbgn, realmend, widep);
 						}
 					}
 				}
@@ -623,30 +615,18 @@ bool CGUIEditBox::processKey(const SEvent& event)
 
 			if (Text.size())
 			{
-				core::stringw s;
-
 				if (MarkBegin != MarkEnd)
 				{
 					// delete marked text
 					const s32 realmbgn = MarkBegin < MarkEnd ? MarkBegin : MarkEnd;
 					const s32 realmend = MarkBegin < MarkEnd ? MarkEnd : MarkBegin;
 
-					s = Text.subString(0, realmbgn);
-					s.append( Text.subString(realmend, Text.size()-realmend) );
-					Text = s;
-
-					CursorPos = realmbgn;
+					replaceText(realmbgn, realmend, core::stringw());
 				}
-				else
+				else if (CursorPos>0)
 				{
 					// delete text behind cursor
-					if (CursorPos>0)
-						s = Text.subString(0, CursorPos-1);
-					else
-						s = L"";
-					s.append( Text.subString(CursorPos, Text.size()-CursorPos) );
-					Text = s;
-					--CursorPos;
+					replaceText(CursorPos-1, CursorPos, core::stringw());
 				}
 
 				if (CursorPos < 0)
@@ -722,10 +702,9 @@ bool CGUIEditBox::processKey(const SEvent& event)
 	// Set new text markers
 	setTextMarkers( newMarkBegin, newMarkEnd );
 
-	// break the text if it has changed
+	// the text was already broken again where it changed
 	if (textChanged)
 	{
-		breakText();
 		calculateScrollPos();
 		sendGuiEvent(EGET_EDITBOX_CHANGED);
 	}
@@ -741,26 +720,18 @@ bool CGUIEditBox::keyDelete()
 {
 	if (Text.size() != 0)
 	{
-		core::stringw s;
-
 		if (MarkBegin != MarkEnd)
 		{
 			// delete marked text
 			const s32 realmbgn = MarkBegin < MarkEnd ? MarkBegin : MarkEnd;
 			const s32 realmend = MarkBegin < MarkEnd ? MarkEnd : MarkBegin;
 
-			s = Text.subString(0, realmbgn);
-			s.append( Text.subString(realmend, Text.size()-realmend) );
-			Text = s;
-
-			CursorPos = realmbgn;
+			replaceText(realmbgn, realmend, core::stringw());
 		}
 		else
 		{
 			// delete text before cursor
-			s = Text.subString(0, CursorPos);
-			s.append( Text.subString(CursorPos+1, Text.size()-CursorPos-1) );
-			Text = s;
+			replaceText(CursorPos, CursorPos+1, core::stringw());
 		}
 
 		if (CursorPos > (s32)Text.size())
@@ -780,6 +751,10 @@ void CGUIEditBox::draw()
 
 	const bool focus = Environment->hasFocus(this);
 
+	// the blinking cursor can't be replayed from a recording
+	if (focus && CursorBlinkTime)
+		invalidateDrawCache();
+
 	IGUISkin* skin = Environment->getSkin();
 	if (!skin)
 		return;
@@ -988,6 +963,7 @@ void CGUIEditBox::draw()
 //! Sets the new caption of this element.
 void CGUIEditBox::setText(const wchar_t* text)
 {
+	invalidateDrawCache();
 	Text = text;
 	if (u32(CursorPos) > Text.size())
 		CursorPos = Text.size();
@@ -1040,7 +1016,10 @@ void CGUIEditBox::setMax(u32 max)
 	Max = max;
 
 	if (Text.size() > Max && Max != 0)
+	{
 		Text = Text.subString(0, Max);
+		breakText();
+	}
 }
 
 
@@ -1054,6 +1033,7 @@ u32 CGUIEditBox::getMax() const
 /** By default it's "_" */
 void CGUIEditBox::setCursorChar(const wchar_t cursorChar)
 {
+	invalidateDrawCache();
 	CursorChar[0] = cursorChar;
 }
 
@@ -1231,16 +1211,99 @@ void CGUIEditBox::breakText()
 
 	LastBreakFont = font;
 
+	breakLines(font, 0, 0, Text.size(), BrokenText, BrokenTextPositions);
+}
+
+
+//! Breaks the lines again after the text between begin and begin+removed was replaced
+void CGUIEditBox::breakText(s32 begin, s32 removed, s32 inserted)
+{
+	if ((!WordWrap && !MultiLine))
+		return;
+
+	IGUIFont* font = getActiveFont();
+	if (!font || font != LastBreakFont || BrokenTextPositions.empty())
+	{
+		breakText();
+		return;
+	}
+
+	// start one line earlier, as words of the edited line might fit on the previous one now
+	const s32 line = core::max_(getLineFromPos(begin) - 1, 0);
+	const s32 oldSize = (s32)Text.size() - inserted + removed;
+
+	ChangedText.set_used(0);
+	ChangedTextPositions.set_used(0);
+	const s32 oldEnd = breakLines(font, BrokenTextPositions[line], begin + inserted, oldSize,
+		ChangedText, ChangedTextPositions);
+	const s32 shift = (s32)Text.size() - oldSize;
+
+	// replace the lines from line to oldEnd by the changed ones
+	const s32 oldCount = oldEnd - line;
+	const s32 newCount = ChangedText.size();
+	const s32 oldTotal = BrokenText.size();
+	if (newCount > oldCount)
+	{
+		const s32 diff = newCount - oldCount;
+		BrokenText.set_used(oldTotal + diff);
+		BrokenTextPositions.set_used(oldTotal + diff);
+		for (s32 i = oldTotal - 1; i >= oldEnd; --i)
+		{
+			BrokenText[i + diff] = std::move(BrokenText[i]);
+			BrokenTextPositions[i + diff] = BrokenTextPositions[i];
+		}
+	}
+	else if (newCount < oldCount)
+	{
+		BrokenText.erase(line + newCount, oldCount - newCount);
+		BrokenTextPositions.erase(line + newCount, oldCount - newCount);
+	}
+
+	for (s32 i = 0; i < newCount; ++i)
+	{
+		BrokenText[line + i] = std::move(ChangedText[i]);
+		BrokenTextPositions[line + i] = ChangedTextPositions[i];
+	}
+
+	if (shift)
+	{
+		for (u32 i = line + newCount; i < BrokenTextPositions.size(); ++i)
+			BrokenTextPositions[i] += shift;
+	}
+}
+
+
+//! Breaks the text from start into lines.
+/** Once a line starts at or behind editEnd where one of the current broken lines
+started before the edit, the rest of the text breaks as before. Returns the index
+of that line, or the count of current broken lines when the text was broken up to
+its end. oldSize is the text size before the edit. */
+s32 CGUIEditBox::breakLines(IGUIFont* font, s32 start, s32 editEnd, s32 oldSize,
+		core::array<core::stringw>& lines, core::array<s32>& positions)
+{
 	core::stringw line;
 	core::stringw word;
 	core::stringw whitespace;
-	s32 lastLineStart = 0;
+	s32 lastLineStart = start;
 	s32 size = Text.size();
 	s32 length = 0;
 	s32 elWidth = RelativeRect.getWidth() - 6;
 	wchar_t c;
+	s32 oldLine = 0;
+	const s32 oldLines = BrokenTextPositions.size();
 
-	for (s32 i=0; i<size; ++i)
+	// checks if the line starting at lastLineStart starts a current broken line
+	auto isOldLineStart = [&]()
+	{
+		if (lastLineStart < editEnd)
+			return false;
+		const s32 shift = size - oldSize;
+		while (oldLine < oldLines && BrokenTextPositions[oldLine] + shift < lastLineStart)
+			++oldLine;
+		return oldLine < oldLines && BrokenTextPositions[oldLine] + shift == lastLineStart;
+	};
+
+	for (s32 i=start; i<size; ++i)
 	{
 		c = Text[i];
 		bool lineBreak = false;
@@ -1282,9 +1345,11 @@ void CGUIEditBox::breakText()
 			{
 				// break to next line
 				length = worldlgth;
-				BrokenText.push_back(line);
-				BrokenTextPositions.push_back(lastLineStart);
+				lines.push_back(line);
+				positions.push_back(lastLineStart);
 				lastLineStart = i - (s32)word.size();
+				if (isOldLineStart())
+					return oldLine;
 				line = word;
 			}
 			else
@@ -1307,9 +1372,11 @@ void CGUIEditBox::breakText()
 			{
 				line += whitespace;
 				line += word;
-				BrokenText.push_back(line);
-				BrokenTextPositions.push_back(lastLineStart);
+				lines.push_back(line);
+				positions.push_back(lastLineStart);
 				lastLineStart = i+1;
+				if (isOldLineStart())
+					return oldLine;
 				line = L"";
 				word = L"";
 				whitespace = L"";
@@ -1325,8 +1392,9 @@ void CGUIEditBox::breakText()
 
 	line += whitespace;
 	line += word;
-	BrokenText.push_back(line);
-	BrokenTextPositions.push_back(lastLineStart);
+	lines.push_back(line);
+	positions.push_back(lastLineStart);
+	return oldLines;
 }
 
 // TODO: that function does interpret VAlign according to line-index (indexed line is placed on top-center-bottom)
@@ -1410,14 +1478,38 @@ s32 CGUIEditBox::getLineFromPos(s32 pos)
 	if (!WordWrap && !MultiLine)
 		return 0;
 
-	s32 i=0;
-	while (i < (s32)BrokenTextPositions.size())
+	// binary search for the last line starting at or before pos
+	s32 first = 0;
+	s32 count = (s32)BrokenTextPositions.size();
+	while (count > 0)
 	{
-		if (BrokenTextPositions[i] > pos)
-			return i-1;
-		++i;
+		const s32 step = count / 2;
+		if (BrokenTextPositions[first + step] <= pos)
+		{
+			first += step + 1;
+			count -= step + 1;
+		}
+		else
+			count = step;
 	}
-	return (s32)BrokenTextPositions.size() - 1;
+	return first - 1;
+}
+
+
+//! Replaces the text between begin and end and breaks the changed lines
+void CGUIEditBox::replaceText(s32 begin, s32 end, const core::stringw& str)
+{
+	// set before breaking, which might move the cursor when joining windows line breaks
+	CursorPos = begin + str.size();
+
+	if (end > (s32)Text.size())
+		end = Text.size();
+	if (begin >= end && str.empty())
+		return;
+
+	Text.erase(begin, end - begin);
+	Text.insert(begin, str.c_str(), str.size());
+	breakText(begin, end - begin, str.size());
 }
 
 
@@ -1434,7 +1526,6 @@ void CGUIEditBox::inputString(const core::stringw &str)
 	if (!isEnabled())
 		return;
 
-	core::stringw s;
 	u32 len = str.size();
 
 	if (MarkBegin != MarkEnd)
@@ -1443,11 +1534,7 @@ void CGUIEditBox::inputString(const core::stringw &str)
 		const s32 realmbgn = MarkBegin < MarkEnd ? MarkBegin : MarkEnd;
 		const s32 realmend = MarkBegin < MarkEnd ? MarkEnd : MarkBegin;
 
-		s = Text.subString(0, realmbgn);
-		s.append(str);
-		s.append( Text.subString(realmend, Text.size()-realmend) );
-		Text = s;
-		CursorPos = realmbgn+len;
+		replaceText(realmbgn, realmend, str);
 	}
 	else if ( OverwriteMode )
 	{
@@ -1467,47 +1554,34 @@ void CGUIEditBox::inputString(const core::stringw &str)
 			}
 			if (!isEOL || Text.size()+len <= Max || Max == 0)
 			{
-				s = Text.subString(0, CursorPos);
-				s.append(str);
 				if ( isEOL )
 				{
 					//just keep appending to the current line
 					//This follows the behavior of other gui libraries behaviors
-					s.append( Text.subString(EOLPos, Text.size()-EOLPos) );
+					replaceText(CursorPos, EOLPos, str);
 				}
 				else
 				{
 					//replace the next character
-					s.append( Text.subString(CursorPos + len,Text.size() - CursorPos - len));
+					replaceText(CursorPos, CursorPos + len, str);
 				}
-				Text = s;
-				CursorPos+=len;
 			}
 		}
 		else if (Text.size()+len <= Max || Max == 0)
 		{
 			// add new character because we are at the end of the string
-			s = Text.subString(0, CursorPos);
-			s.append(str);
-			s.append( Text.subString(CursorPos+len, Text.size()-CursorPos-len) );
-			Text = s;
-			CursorPos+=len;
+			replaceText(CursorPos, Text.size(), str);
 		}
 	}
 	else if (Text.size()+len <= Max || Max == 0)
 	{
 		// add new character
-		s = Text.subString(0, CursorPos);
-		s.append(str);
-		s.append( Text.subString(CursorPos, Text.size()-CursorPos) );
-		Text = s;
-		CursorPos+=len;
+		replaceText(CursorPos, CursorPos, str);
 	}
 
 	BlinkStartTime = os::Timer::getTime();
 	setTextMarkers(0, 0);
 
-	breakText();
 	calculateScrollPos();
 	sendGuiEvent(EGET_EDITBOX_CHANGED);
 }
@@ -1648,6 +1722,7 @@ void CGUIEditBox::calculateFrameRect()
 //! set text markers
 void CGUIEditBox::setTextMarkers(s32 begin, s32 end)
 {
+	invalidateDrawCache();
 	if ( begin != MarkBegin || end != MarkEnd )
 	{
 		MarkBegin = begin;
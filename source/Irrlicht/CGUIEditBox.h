@@ -142,6 +142,13 @@ namespace gui
 	protected:
 		//! Breaks the single text line.
 		void breakText();
+		//! Breaks the lines again after the text between begin and begin+removed was replaced by inserted characters
+		void breakText(s32 begin, s32 removed, s32 inserted);
+		//! Breaks the text from start into lines, returns the first old line which did not need to be broken again
+		s32 breakLines(IGUIFont* font, s32 start, s32 editEnd, s32 oldSize,
+				core::array<core::stringw>& lines, core::array<s32>& positions);
+		//! Replaces the text between begin and end, moves the cursor behind it and breaks the changed lines
+		void replaceText(s32 begin, s32 end, const core::stringw& str);
 		//! sets the area of the given line
 		void setTextRect(s32 line);
 		//! returns the line number that the cursor is on
@@ -190,6 +197,8 @@ namespace gui
 
 		core::array< core::stringw > BrokenText;
 		core::array< s32 > BrokenTextPositions;
+		core::array< core::stringw > ChangedText;
+		core::array< s32 > ChangedTextPositions;
 
 		core::rect<s32> CurrentTextRect, FrameRect; // temporary values
 	};
@@ -6,11 +6,13 @@
 #include "CGUIEnvironment.h"
 
 #include "IVideoDriver.h"
+#include "IRenderTarget.h"
 
 #include "CGUISkin.h"
 #include "CGUIButton.h"
 #include "CGUIScrollBar.h"
 #include "CGUIFont.h"
+#include "CGUIGlyphCacheFont.h"
 #include "CGUISpriteBank.h"
 #include "CGUIImage.h"
 #include "CGUICheckBox.h"
@@ -23,6 +25,7 @@
 #include "CGUIComboBox.h"
 
 #include "IWriteFile.h"
+#include "CProfiler.h"
 #ifdef IRR_ENABLE_BUILTIN_FONT
 #include "BuiltInFont.h"
 #endif
@@ -35,11 +38,51 @@ namespace gui
 
 const io::path CGUIEnvironment::DefaultFontName = "#DefaultFont";
 
+namespace
+{
+
+//! Size of the cells of the hit-test grid in pixels
+const s32 HITTEST_CELL_SIZE = 64;
+
+//! Texture and render target of an element drawn through a texture
+class CGUITextureCache : public IReferenceCounted
+{
+public:
+	CGUITextureCache(video::IVideoDriver* driver)
+		: Driver(driver), Texture(0), RenderTarget(0)
+	{
+		Driver->grab();
+	}
+
+	~CGUITextureCache()
+	{
+		clear();
+		Driver->drop();
+	}
+
+	void clear()
+	{
+		if (RenderTarget)
+			Driver->removeRenderTarget(RenderTarget);
+		if (Texture)
+			Driver->removeTexture(Texture);
+		RenderTarget = 0;
+		Texture = 0;
+	}
+
+	video::IVideoDriver* Driver;
+	video::ITexture* Texture;
+	video::IRenderTarget* RenderTarget;
+};
+
+} // end anonymous namespace
+
 //! constructor
 CGUIEnvironment::CGUIEnvironment(io::IFileSystem* fs, video::IVideoDriver* driver, IOSOperator* op)
 : IGUIElement(EGUIET_ROOT, 0, 0, 0, core::rect<s32>(driver ? core::dimension2d<s32>(driver->getScreenSize()) : core::dimension2d<s32>(0,0))),
 	Driver(driver), Hovered(0), HoveredNoSubelement(0), Focus(0), LastHoveredMousePos(0,0), CurrentSkin(0),
-	FileSystem(fs), UserReceiver(0), Operator(op), FocusFlags(EFF_SET_ON_LMOUSE_DOWN|EFF_SET_ON_TAB)
+	FileSystem(fs), UserReceiver(0), Operator(op), FocusFlags(EFF_SET_ON_LMOUSE_DOWN|EFF_SET_ON_TAB),
+	HitTestColumns(0), HitTestRows(0)
 {
 	if (Driver)
 		Driver->grab();
@@ -168,6 +211,9 @@ void CGUIEnvironment::loadBuiltInFont()
 //! draws all gui elements
 void CGUIEnvironment::drawAll(bool useScreenSize)
 {
+	IRR_PROFILE_SCOPE("CGUIEnvironment::drawAll");
+	if (Driver)
+		DrawnScreenSize = Driver->getScreenSize();
 	if (useScreenSize && Driver)
 	{
 		core::dimension2d<s32> dim(Driver->getScreenSize());
@@ -185,13 +231,146 @@ void CGUIEnvironment::drawAll(bool useScreenSize)
 	if (ToolTip.Element)
 		bringToFront(ToolTip.Element);
 
+	if (Driver)
+		Driver->beginGPUTimerScope("gui");
+
+	// the root is invalidated by all changes below it, see needsRedraw()
+	TextureCacheValid = true;
+	DrawDamage = core::rect<s32>(0, 0, 0, 0);
 	draw();
+
+	if (Driver)
+		Driver->endGPUTimerScope();
+
 	OnPostRender ( os::Timer::getTime () );
 
 	clearDeletionQueue();
 }
 
 
+//! tells if the gui changed since it was drawn
+bool CGUIEnvironment::needsRedraw() const
+{
+	if (!TextureCacheValid || !DeletionQueue.empty())
+		return true;
+
+	if (Driver && Driver->getScreenSize() != DrawnScreenSize)
+		return true;
+
+	return isToolTipDue(os::Timer::getTime());
+}
+
+
+//! gets the part of the screen the gui changed since it was drawn
+core::rect<s32> CGUIEnvironment::getDrawDamage() const
+{
+	if (Driver && Driver->getScreenSize() != DrawnScreenSize)
+		return core::rect<s32>(core::dimension2d<s32>(Driver->getScreenSize()));
+
+	return DrawDamage;
+}
+
+
+//! adds an area of the screen to getDrawDamage()
+void CGUIEnvironment::addDrawDamage(const core::rect<s32>& rect)
+{
+	if (!rect.isValid() || rect.getArea() == 0)
+		return;
+
+	if (DrawDamage.getArea() == 0)
+	{
+		DrawDamage = rect;
+		return;
+	}
+
+	DrawDamage.addInternalPoint(rect.UpperLeftCorner);
+	DrawDamage.addInternalPoint(rect.LowerRightCorner);
+}
+
+
+//! draws an element by replaying its recorded drawing
+void CGUIEnvironment::drawRecorded(IGUIElement* element, video::S2DDrawList& list)
+{
+	if (!Driver)
+	{
+		element->draw();
+		return;
+	}
+
+	if (Driver->drawRecording2D(list))
+		return;
+
+	const bool recording = Driver->beginRecording2D(list);
+	element->draw();
+	if (recording)
+		Driver->endRecording2D();
+}
+
+
+//! draws an element through a texture
+void CGUIEnvironment::drawTextureCached(IGUIElement* element, IReferenceCounted*& cache, bool redraw)
+{
+	const core::rect<s32>& clip = element->getAbsoluteClippingRect();
+	if (!element->isVisible() || !clip.isValid() || clip.getArea() == 0)
+		return;
+
+	if (!Driver || !Driver->queryFeature(video::EVDF_RENDER_TO_TARGET) ||
+		clip.UpperLeftCorner.X < 0 || clip.UpperLeftCorner.Y < 0)
+	{
+		element->draw();
+		return;
+	}
+
+	// the texture starts at the origin, so the elements draw into it at their usual positions
+	const core::dimension2du size(clip.LowerRightCorner.X, clip.LowerRightCorner.Y);
+
+	CGUITextureCache* textureCache = static_cast<CGUITextureCache*>(cache);
+	if (!textureCache)
+	{
+		textureCache = new CGUITextureCache(Driver);
+		cache = textureCache;
+	}
+
+	if (!textureCache->Texture || textureCache->Texture->getOriginalSize() != size)
+	{
+		textureCache->clear();
+		textureCache->Texture = Driver->addRenderTargetTexture(size, "#GUITextureCache", video::ECF_A8R8G8B8);
+		if (textureCache->Texture)
+		{
+			textureCache->RenderTarget = Driver->addRenderTarget();
+			textureCache->RenderTarget->setTexture(textureCache->Texture, 0);
+		}
+		redraw = true;
+	}
+
+	if (!textureCache->RenderTarget)
+	{
+		element->draw();
+		return;
+	}
+
+	if (redraw)
+	{
+		video::IRenderTarget* previousTarget = Driver->getCurrentRenderTarget();
+		const core::rect<s32> previousViewPort = Driver->getViewPort();
+
+		if (!Driver->setRenderTargetEx(textureCache->RenderTarget, video::ECBF_COLOR, video::SColor(0, 0, 0, 0)))
+		{
+			element->draw();
+			return;
+		}
+
+		element->draw();
+
+		Driver->setRenderTargetEx(previousTarget, video::ECBF_NONE);
+		Driver->setViewPort(previousViewPort);
+	}
+
+	Driver->draw2DImage(textureCache->Texture, clip.UpperLeftCorner, clip, 0,
+		video::SColor(255, 255, 255, 255), true);
+}
+
+
 //! sets the focus to an element
 bool CGUIEnvironment::setFocus(IGUIElement* element)
 {
@@ -256,10 +435,15 @@ bool CGUIEnvironment::setFocus(IGUIElement* element)
 		currentFocus->drop();
 
 	if (Focus)
+	{
+		Focus->invalidateDrawCache();
 		Focus->drop();
+	}
 
 	// element is the new focus so it doesn't have to be dropped
 	Focus = element;
+	if (Focus)
+		Focus->invalidateDrawCache();
 
 	return true;
 }
@@ -295,6 +479,7 @@ bool CGUIEnvironment::removeFocus(IGUIElement* element)
 	}
 	if (Focus)
 	{
+		Focus->invalidateDrawCache();
 		Focus->drop();
 		Focus = 0;
 	}
@@ -389,14 +574,7 @@ bool CGUIEnvironment::OnEvent(const SEvent& event)
 void CGUIEnvironment::OnPostRender( u32 time )
 {
 	// launch tooltip
-	if ( ToolTip.Element == 0 &&
-		HoveredNoSubelement && HoveredNoSubelement != this &&
-		(time - ToolTip.EnterTime >= ToolTip.LaunchTime
-		|| (time - ToolTip.LastTime >= ToolTip.RelaunchTime && time - ToolTip.LastTime < ToolTip.LaunchTime)) &&
-		HoveredNoSubelement->getToolTipText().size() &&
-		getSkin() &&
-		getSkin()->getFont(EGDF_TOOLTIP)
-		)
+	if (isToolTipDue(time))
 	{
 		core::rect<s32> pos;
 
@@ -443,6 +621,17 @@ void CGUIEnvironment::OnPostRender( u32 time )
 	IGUIElement::OnPostRender ( time );
 }
 
+bool CGUIEnvironment::isToolTipDue(u32 time) const
+{
+	return ToolTip.Element == 0 &&
+		HoveredNoSubelement && HoveredNoSubelement != this &&
+		(time - ToolTip.EnterTime >= ToolTip.LaunchTime
+		|| (time - ToolTip.LastTime >= ToolTip.RelaunchTime && time - ToolTip.LastTime < ToolTip.LaunchTime)) &&
+		HoveredNoSubelement->getToolTipText().size() &&
+		CurrentSkin &&
+		CurrentSkin->getFont(EGDF_TOOLTIP);
+}
+
 void CGUIEnvironment::addToDeletionQueue(IGUIElement* element)
 {
 	if (!element)
@@ -466,6 +655,112 @@ void CGUIEnvironment::clearDeletionQueue()
 	DeletionQueue.clear();
 }
 
+//! Returns the topmost visible element at a position, using the hit-test index
+IGUIElement* CGUIEnvironment::getElementFromPoint(const core::position2d<s32>& point)
+{
+	if (!HitTestValid)
+	{
+		buildHitTestIndex();
+		HitTestValid = true;
+	}
+
+	if (!HitTestArea.isPointInside(point))
+		return IGUIElement::getElementFromPoint(point);
+
+	const u32 cell = ((point.Y - HitTestArea.UpperLeftCorner.Y) / HITTEST_CELL_SIZE) * HitTestColumns +
+		(point.X - HitTestArea.UpperLeftCorner.X) / HITTEST_CELL_SIZE;
+
+	// the elements are in drawing order, so the last one containing the point is on top
+	for (u32 i=HitTestCellStart[cell+1]; i>HitTestCellStart[cell]; --i)
+	{
+		IGUIElement* element = HitTestElements[HitTestCellItems[i-1]];
+		if (element->isPointInside(point))
+			return element;
+	}
+
+	return 0;
+}
+
+
+//! collects the visible elements and sorts their clipping rectangles into the hit-test grid
+void CGUIEnvironment::buildHitTestIndex()
+{
+	HitTestElements.set_used(0);
+	addToHitTestIndex(this);
+
+	HitTestArea = AbsoluteRect;
+	HitTestArea.repair();
+	HitTestColumns = HitTestArea.getWidth() / HITTEST_CELL_SIZE + 1;
+	HitTestRows = HitTestArea.getHeight() / HITTEST_CELL_SIZE + 1;
+	const u32 cellCount = HitTestColumns * HitTestRows;
+
+	// cells covered by each element, empty if it is outside of the grid
+	core::array< core::rect<s32> > covered;
+	covered.set_used(HitTestElements.size());
+
+	HitTestCellStart.set_used(cellCount + 1);
+	for (u32 c=0; c<=cellCount; ++c)
+		HitTestCellStart[c] = 0;
+
+	for (u32 i=0; i<HitTestElements.size(); ++i)
+	{
+		core::rect<s32> r = HitTestElements[i]->getAbsoluteClippingRect();
+		core::rect<s32>& cells = covered[i];
+		cells = core::rect<s32>(0, 0, -1, -1);
+
+		if (!r.isValid())
+			continue;
+
+		// points on the lower right edge are inside too
+		r.UpperLeftCorner -= HitTestArea.UpperLeftCorner;
+		r.LowerRightCorner -= HitTestArea.UpperLeftCorner;
+		if (r.LowerRightCorner.X < 0 || r.LowerRightCorner.Y < 0 ||
+			r.UpperLeftCorner.X > HitTestArea.getWidth() || r.UpperLeftCorner.Y > HitTestArea.getHeight())
+			continue;
+
+		cells.UpperLeftCorner.X = core::max_(r.UpperLeftCorner.X, 0) / HITTEST_CELL_SIZE;
+		cells.UpperLeftCorner.Y = core::max_(r.UpperLeftCorner.Y, 0) / HITTEST_CELL_SIZE;
+		cells.LowerRightCorner.X = core::min_(r.LowerRightCorner.X, HitTestArea.getWidth()) / HITTEST_CELL_SIZE;
+		cells.LowerRightCorner.Y = core::min_(r.LowerRightCorner.Y, HitTestArea.getHeight()) / HITTEST_CELL_SIZE;
+
+		for (s32 y=cells.UpperLeftCorner.Y; y<=cells.LowerRightCorner.Y; ++y)
+			for (s32 x=cells.UpperLeftCorner.X; x<=cells.LowerRightCorner.X; ++x)
+				++HitTestCellStart[y*HitTestColumns + x + 1];
+	}
+
+	for (u32 c=0; c<cellCount; ++c)
+		HitTestCellStart[c+1] += HitTestCellStart[c];
+
+	// fill the cells in drawing order, counting up from their start
+	core::array<u32> fill;
+	fill.set_used(cellCount);
+	for (u32 c=0; c<cellCount; ++c)
+		fill[c] = HitTestCellStart[c];
+
+	HitTestCellItems.set_used(HitTestCellStart[cellCount]);
+	for (u32 i=0; i<HitTestElements.size(); ++i)
+	{
+		const core::rect<s32>& cells = covered[i];
+		for (s32 y=cells.UpperLeftCorner.Y; y<=cells.LowerRightCorner.Y; ++y)
+			for (s32 x=cells.UpperLeftCorner.X; x<=cells.LowerRightCorner.X; ++x)
+				HitTestCellItems[fill[y*HitTestColumns + x]++] = i;
+	}
+}
+
+
+//! adds the visible elements of a subtree in drawing order
+void CGUIEnvironment::addToHitTestIndex(IGUIElement* element)
+{
+	if (!element->isVisible())
+		return;
+
+	HitTestElements.push_back(element);
+
+	for (auto child : element->getChildren())
+		addToHitTestIndex(child);
+}
+
+
 //
 void CGUIEnvironment::updateHoveredElement(core::position2d<s32> mousePos)
 {
@@ -501,6 +796,11 @@ void CGUIEnvironment::updateHoveredElement(core::position2d<s32> mousePos)
 
 	if (Hovered != lastHovered)
 	{
+		if (lastHovered)
+			lastHovered->invalidateDrawCache();
+		if (Hovered)
+			Hovered->invalidateDrawCache();
+
 		SEvent event;
 		event.EventType = EET_GUI_EVENT;
 
@@ -593,21 +893,33 @@ bool CGUIEnvironment::postEventFromUser(const SEvent& event)
 			}
 		}
 
-		// sending input to focus
+		// sending input to focus, elements using the input may look different afterwards
 		if (Focus && Focus->OnEvent(event))
+		{
+			if (Focus)
+				Focus->invalidateDrawCache();
 			return true;
+		}
 
 		// focus could have died in last call
 		if (!Focus && Hovered)
 		{
-			return Hovered->OnEvent(event);
+			if (!Hovered->OnEvent(event))
+				return false;
+			if (Hovered)
+				Hovered->invalidateDrawCache();
+			return true;
 		}
 
 		break;
 	case EET_KEY_INPUT_EVENT:
 		{
 			if (Focus && Focus->OnEvent(event))
+			{
+				if (Focus)
+					Focus->invalidateDrawCache();
 				return true;
+			}
 
 			// For keys we handle the event before changing focus to give elements the chance for catching the TAB
 			// Send focus changing event
@@ -627,7 +939,11 @@ bool CGUIEnvironment::postEventFromUser(const SEvent& event)
 		break;
 	case EET_STRING_INPUT_EVENT:
 		if (Focus && Focus->OnEvent(event))
+		{
+			if (Focus)
+				Focus->invalidateDrawCache();
 			return true;
+		}
 		break;
 	default:
 		break;
@@ -657,6 +973,8 @@ void CGUIEnvironment::setSkin(IGUISkin* skin)
 
 	if (CurrentSkin)
 		CurrentSkin->grab();
+
+	invalidateDrawCache(true);
 }
 
 
@@ -945,6 +1263,35 @@ IGUIFont* CGUIEnvironment::addFont(const io::path& name, IGUIFont* font)
 	return font;
 }
 
+
+//! adds a font which rasterizes its glyphs on demand
+IGUIFont* CGUIEnvironment::addGlyphCacheFont(const io::path& name, IGUIGlyphSource* source, u32 atlasSize)
+{
+	if (!source || !Driver)
+		return 0;
+
+	CGUIGlyphCacheFont* font = new CGUIGlyphCacheFont(Driver, source, atlasSize);
+	IGUIFont* stored = addFont(name, font);
+	font->drop();
+	return stored;
+}
+
+//! adds a font drawing its glyphs from signed distance fields
+IGUIFontDistanceField* CGUIEnvironment::addDistanceFieldFont(const io::path& name, IGUIGlyphSource* source,
+	f32 scale, u32 spread, u32 atlasSize)
+{
+	if (!source || !Driver)
+		return 0;
+
+	CGUIGlyphCacheFont* font = new CGUIGlyphCacheFont(Driver, source, atlasSize, core::max_(spread, 1u), scale);
+	IGUIFont* stored = addFont(name, font);
+	font->drop();
+
+	if (!stored || stored->getType() != EGFT_DISTANCE_FIELD)
+		return 0;
+	return static_cast<IGUIFontDistanceField*>(stored);
+}
+
 //! remove loaded font
 void CGUIEnvironment::removeFont(IGUIFont* font)
 {
@@ -30,6 +30,21 @@ public:
 	//! draws all gui elements
 	void drawAll(bool useScreenSize) override;
 
+	//! tells if the gui changed since it was drawn
+	bool needsRedraw() const override;
+
+	//! gets the part of the screen the gui changed since it was drawn
+	core::rect<s32> getDrawDamage() const override;
+
+	//! adds an area of the screen to getDrawDamage()
+	void addDrawDamage(const core::rect<s32>& rect) override;
+
+	//! draws an element by replaying its recorded drawing
+	void drawRecorded(IGUIElement* element, video::S2DDrawList& list) override;
+
+	//! draws an element through a texture
+	void drawTextureCached(IGUIElement* element, IReferenceCounted*& cache, bool redraw) override;
+
 	//! returns the current video driver
 	video::IVideoDriver* getVideoDriver() const override;
 
@@ -52,6 +67,9 @@ public:
 	//! called if an event happened.
 	bool OnEvent(const SEvent& event) override;
 
+	//! Returns the topmost visible element at a position, using the hit-test index
+	IGUIElement* getElementFromPoint(const core::position2d<s32>& point) override;
+
 	//! returns the current gui skin
 	IGUISkin* getSkin() const override;
 
@@ -74,6 +92,13 @@ public:
 	//! add an externally loaded font
 	IGUIFont* addFont(const io::path& name, IGUIFont* font) override;
 
+	//! adds a font which rasterizes its glyphs on demand
+	IGUIFont* addGlyphCacheFont(const io::path& name, IGUIGlyphSource* source, u32 atlasSize) override;
+
+	//! adds a font drawing its glyphs from signed distance fields
+	IGUIFontDistanceField* addDistanceFieldFont(const io::path& name, IGUIGlyphSource* source,
+		f32 scale, u32 spread, u32 atlasSize) override;
+
 	//! remove loaded font
 	void removeFont(IGUIFont* font) override;
 
@@ -173,6 +198,13 @@ private:
 
 	void updateHoveredElement(core::position2d<s32> mousePos);
 
+	//! true if the hovered element has a tooltip to show at that time
+	bool isToolTipDue(u32 time) const;
+
+	//! collects the visible elements and sorts their clipping rectangles into the hit-test grid
+	void buildHitTestIndex();
+	void addToHitTestIndex(IGUIElement* element);
+
 	void loadBuiltInFont();
 
 	struct SFont
@@ -222,6 +254,22 @@ private:
 	u32 FocusFlags;
 	core::array<IGUIElement*> DeletionQueue;
 
+	//! screen size of the last drawAll()
+	core::dimension2du DrawnScreenSize;
+
+	//! see getDrawDamage()
+	core::rect<s32> DrawDamage;
+
+	//! Hit-test index, a grid over the screen holding the visible elements
+	//! overlapping each cell in drawing order. Not grabbed, the index is
+	//! built again after any element was added, removed, moved or hidden.
+	core::array<IGUIElement*> HitTestElements;
+	core::array<u32> HitTestCellStart;	// first entry of each cell in HitTestCellItems, one more for the end
+	core::array<u32> HitTestCellItems;	// indices into HitTestElements
+	core::rect<s32> HitTestArea;
+	s32 HitTestColumns;
+	s32 HitTestRows;
+
 	static const io::path DefaultFontName;
 };
 
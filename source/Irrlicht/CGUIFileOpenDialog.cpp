@@ -32,7 +32,7 @@ CGUIFileOpenDialog::CGUIFileOpenDialog(const wchar_t* title,
 					(parent->getAbsolutePosition().getHeight()-FOD_HEIGHT)/2,
 					(parent->getAbsolutePosition().getWidth()-FOD_WIDTH)/2+FOD_WIDTH,
 					(parent->getAbsolutePosition().getHeight()-FOD_HEIGHT)/2+FOD_HEIGHT)),
-	FileNameText(0), FileList(0), Dragging(false)
+	FileNameText(0), FileList(0), ListRequest(0), ListedEntries(0), Dragging(false)
 {
 	#ifdef _DEBUG
 	IGUIElement::setDebugName("CGUIFileOpenDialog");
@@ -140,6 +140,9 @@ CGUIFileOpenDialog::~CGUIFileOpenDialog()
 
 	if (FileList)
 		FileList->drop();
+
+	if (ListRequest)
+		ListRequest->drop();
 }
 
 
@@ -325,6 +328,8 @@ void CGUIFileOpenDialog::draw()
 	if (!IsVisible)
 		return;
 
+	updateListBox();
+
 	IGUISkin* skin = Environment->getSkin();
 
 	core::rect<s32> rect = AbsoluteRect;
@@ -362,26 +367,62 @@ void CGUIFileOpenDialog::fillListBox()
 
 	if (FileList)
 		FileList->drop();
+	FileList = 0;
 
 	FileBox->clear();
 
-	FileList = FileSystem->createFileList();
+	// large directories are listed while the dialog is drawn, the sizes aren't shown
+	if (ListRequest)
+		ListRequest->drop();
+	ListRequest = FileSystem->createFileListAsync(false);
+	ListedEntries = 0;
+	updateListBox();
+
 	core::stringw s;
+	if (FileNameText)
+	{
+		setDirectoryName(FileSystem->getWorkingDirectory());
+		pathToStringW(s, FileDirectory);
+		FileNameText->setText(s.c_str());
+	}
+}
 
-	if (FileList)
+//! shows the files found by ListRequest, and the sorted list once it's ready
+void CGUIFileOpenDialog::updateListBox()
+{
+	IGUISkin *skin = Environment->getSkin();
+
+	if (!ListRequest || !FileBox || !skin)
+		return;
+
+	// checked first, so no entries are missed when it becomes ready meanwhile
+	const bool ready = ListRequest->isReady();
+	core::stringw s;
+
+	if (!ready)
 	{
-		for (u32 i=0; i < FileList->getFileCount(); ++i)
+		// unsorted and not selectable until FileList is set
+		io::path fullName;
+		u32 size;
+		bool isDirectory;
+		for (; ListRequest->getEntry(ListedEntries, fullName, size, isDirectory); ++ListedEntries)
 		{
-			pathToStringW(s, FileList->getFileName(i));
-			FileBox->addItem(s.c_str(), skin->getIcon(FileList->isDirectory(i) ? EGDI_DIRECTORY : EGDI_FILE));
+			core::deletePathFromFilename(fullName);
+			pathToStringW(s, fullName);
+			FileBox->addItem(s.c_str(), skin->getIcon(isDirectory ? EGDI_DIRECTORY : EGDI_FILE));
 		}
+		return;
 	}
 
-	if (FileNameText)
+	FileList = ListRequest->createFileList();
+	ListRequest->drop();
+	ListRequest = 0;
+
+	FileBox->clear();
+	for (u32 i=0; i < FileList->getFileCount(); ++i)
 	{
-		setDirectoryName(FileSystem->getWorkingDirectory());
-		pathToStringW(s, FileDirectory);
-		FileNameText->setText(s.c_str());
+		pathToStringW(s, FileList->getFileName(i));
+		FileBox->addItem(s.c_str(), skin->getIcon(FileList->isDirectory(i) ? EGDI_DIRECTORY : EGDI_FILE));
 	}
 }
 
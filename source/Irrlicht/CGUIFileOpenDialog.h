@@ -57,6 +57,9 @@ namespace gui
 		//! fills the listbox with files.
 		void fillListBox();
 
+		//! shows the files found by ListRequest, and the sorted list once it's ready
+		void updateListBox();
+
 		//! sends the event that the file has been selected.
 		void sendSelectedEvent( EGUI_EVENT_TYPE type );
 
@@ -80,6 +83,10 @@ namespace gui
 		IGUIElement* EventParent;
 		io::IFileSystem* FileSystem;
 		io::IFileList* FileList;
+		//! lists the directory while the dialog is drawn, FileList is set when it's ready
+		io::IFileListRequest* ListRequest;
+		//! entries of ListRequest shown so far
+		u32 ListedEntries;
 		bool Dragging;
 	};
 
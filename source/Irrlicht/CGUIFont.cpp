@@ -16,10 +16,26 @@ namespace irr
 namespace gui
 {
 
+namespace
+{
+	//! last revision given to the layouts of a font
+	u32 LastLayoutRevision = 0;
+}
+
+//! returns a revision for text layouts, unique among all fonts
+u32 createTextLayoutRevision()
+{
+	// fonts are created on the main thread like the elements drawing them
+	u32 revision = ++LastLayoutRevision;
+	if (!revision)
+		revision = ++LastLayoutRevision;
+	return revision;
+}
+
 //! constructor
 CGUIFont::CGUIFont(IGUIEnvironment *env, const io::path& filename)
 : Driver(0), SpriteBank(0), Environment(env), WrongCharacter(0),
-	MaxHeight(0), GlobalKerningWidth(0), GlobalKerningHeight(0)
+	MaxHeight(0), GlobalKerningWidth(0), GlobalKerningHeight(0), LayoutRevision(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CGUIFont");
@@ -84,7 +100,7 @@ bool CGUIFont::load(io::IXMLReader* xml, const io::path& directory)
 				while (i+1 > SpriteBank->getTextureCount())
 					SpriteBank->addTexture(0);
 
-				bool flags[3];
+				bool flags[4];
 				pushTextureCreationFlags(flags);
 
 				// load texture
@@ -212,24 +228,30 @@ void CGUIFont::setMaxHeight()
 		if (t>MaxHeight)
 			MaxHeight = t;
 	}
+
+	// called once the characters are loaded
+	changeLayoutRevision();
 }
 
-void CGUIFont::pushTextureCreationFlags(bool(&flags)[3])
+void CGUIFont::pushTextureCreationFlags(bool(&flags)[4])
 {
 	flags[0] = Driver->getTextureCreationFlag(video::ETCF_ALLOW_NON_POWER_2);
 	flags[1] = Driver->getTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS);
 	flags[2] = Driver->getTextureCreationFlag(video::ETCF_ALLOW_MEMORY_COPY);
+	flags[3] = Driver->getTextureCreationFlag(video::ETCF_ALLOW_ATLAS);
 
 	Driver->setTextureCreationFlag(video::ETCF_ALLOW_NON_POWER_2, true);
 	Driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, false);
 	Driver->setTextureCreationFlag(video::ETCF_ALLOW_MEMORY_COPY, true);
+	Driver->setTextureCreationFlag(video::ETCF_ALLOW_ATLAS, true);
 }
 
-void CGUIFont::popTextureCreationFlags(const bool(&flags)[3])
+void CGUIFont::popTextureCreationFlags(const bool(&flags)[4])
 {
 	Driver->setTextureCreationFlag(video::ETCF_ALLOW_NON_POWER_2, flags[0]);
 	Driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, flags[1]);
 	Driver->setTextureCreationFlag(video::ETCF_ALLOW_MEMORY_COPY, flags[2]);
+	Driver->setTextureCreationFlag(video::ETCF_ALLOW_ATLAS, flags[3]);
 }
 
 //! loads a font file, native file needed, for texture parsing
@@ -298,7 +320,7 @@ bool CGUIFont::loadTexture(video::IImage* image, const io::path& name)
 
 	if ( ret )
 	{
-		bool flags[3];
+		bool flags[4];
 		pushTextureCreationFlags(flags);
 
 		SpriteBank->addTexture(Driver->addTexture(name, tmpImage));
@@ -389,6 +411,7 @@ void CGUIFont::readPositions(video::IImage* image, s32& lowerRightPositions)
 void CGUIFont::setKerningWidth(s32 kerning)
 {
 	GlobalKerningWidth = kerning;
+	changeLayoutRevision();
 }
 
 
@@ -415,6 +438,7 @@ s32 CGUIFont::getKerningWidth(const wchar_t* thisLetter, const wchar_t* previous
 void CGUIFont::setKerningHeight(s32 kerning)
 {
 	GlobalKerningHeight = kerning;
+	changeLayoutRevision();
 }
 
 
@@ -444,6 +468,71 @@ s32 CGUIFont::getAreaFromCharacter(const wchar_t c) const
 void CGUIFont::setInvisibleCharacters( const wchar_t *s )
 {
 	Invisible = s;
+	changeLayoutRevision();
+}
+
+
+void CGUIFont::changeLayoutRevision()
+{
+	LayoutRevision = createTextLayoutRevision();
+}
+
+
+//! lays out the text again if it or the font changed since
+void CGUIFont::updateLayout(const core::stringw& text, SGUITextLayout& layout) const
+{
+	if (layout.Revision == LayoutRevision && layout.Text == text)
+		return;
+
+	layout.Text = text;
+	layout.Revision = LayoutRevision;
+	layout.Sprites.set_used(0);
+	layout.Positions.set_used(0);
+	layout.Sprites.reallocate(text.size(), false);
+	layout.Positions.reallocate(text.size(), false);
+
+	core::dimension2d<u32> dim(0, 0);
+	core::position2di offset(0, 0);
+
+	for (const wchar_t* p = text.c_str(); *p; ++p)
+	{
+		bool lineBreak=false;
+		if (*p == L'\r') // Mac or Windows breaks
+		{
+			lineBreak = true;
+			if (p[1] == L'\n') // Windows breaks
+				++p;
+		}
+		else if (*p == L'\n') // Unix breaks
+		{
+			lineBreak = true;
+		}
+		if (lineBreak)
+		{
+			dim.Height += MaxHeight;
+			if (dim.Width < (u32)offset.X)
+				dim.Width = offset.X;
+			offset.X = 0;
+			offset.Y += MaxHeight;
+			continue;
+		}
+
+		const SFontArea& area = Areas[getAreaFromCharacter(*p)];
+
+		offset.X += area.underhang;
+		if (Invisible.findFirst(*p) < 0)
+		{
+			layout.Sprites.push_back(area.spriteno);
+			layout.Positions.push_back(offset);
+		}
+
+		offset.X += area.width + area.overhang + GlobalKerningWidth;
+	}
+
+	dim.Height += MaxHeight;
+	if (dim.Width < (u32)offset.X)
+		dim.Width = offset.X;
+	layout.Dimension = dim;
 }
 
 
@@ -493,15 +582,23 @@ void CGUIFont::draw(const core::stringw& text, const core::rect<s32>& position,
 					video::SColor color,
 					bool hcenter, bool vcenter, const core::rect<s32>* clip
 				)
+{
+	drawLayout(text, DrawLayout, position, color, hcenter, vcenter, clip);
+}
+
+
+//! draws a text from its cached layout
+void CGUIFont::drawLayout(const core::stringw& text, SGUITextLayout& layout,
+		const core::rect<s32>& position, video::SColor color,
+		bool hcenter, bool vcenter, const core::rect<s32>* clip)
 {
 	if (!Driver || !SpriteBank)
 		return;
 
-	core::dimension2d<s32> textDimension;	// NOTE: don't make this u32 or the >> later on can fail when the dimension width is < position width
-	core::position2d<s32> offset = position.UpperLeftCorner;
+	updateLayout(text, layout);
 
-	if (hcenter || vcenter || clip)
-		textDimension = getDimension(text.c_str());
+	core::dimension2d<s32> textDimension(layout.Dimension);	// NOTE: don't make this u32 or the >> later on can fail when the dimension width is < position width
+	core::position2d<s32> offset = position.UpperLeftCorner;
 
 	if (hcenter)
 		offset.X += (position.getWidth() - textDimension.Width) >> 1;
@@ -517,50 +614,28 @@ void CGUIFont::draw(const core::stringw& text, const core::rect<s32>& position,
 			return;
 	}
 
-	core::array<u32> indices(text.size());
-	core::array<core::position2di> offsets(text.size());
+	const u32 count = layout.Positions.size();
+	DrawPositions.set_used(count);
+	for (u32 i=0; i<count; ++i)
+		DrawPositions[i] = layout.Positions[i] + offset;
 
-	for(u32 i = 0;i < text.size();i++)
-	{
-		wchar_t c = text[i];
-
-		bool lineBreak=false;
-		if ( c == L'\r') // Mac or Windows breaks
-		{
-			lineBreak = true;
-			if ( text[i + 1] == L'\n') // Windows breaks
-				c = text[++i];
-		}
-		else if ( c == L'\n') // Unix breaks
-		{
-			lineBreak = true;
-		}
-
-		if (lineBreak)
-		{
-			offset.Y += MaxHeight;
-			offset.X = position.UpperLeftCorner.X;
-
-			if ( hcenter )
-			{
-				offset.X += (position.getWidth() - textDimension.Width) >> 1;
-			}
-			continue;
-		}
+	SpriteBank->draw2DSpriteBatch(layout.Sprites, DrawPositions, clip, color);
+}
 
-		SFontArea& area = Areas[getAreaFromCharacter(c)];
 
-		offset.X += area.underhang;
-		if ( Invisible.findFirst ( c ) < 0 )
-		{
-			indices.push_back(area.spriteno);
-			offsets.push_back(offset);
-		}
+//! returns the dimension of a text from its cached layout
+core::dimension2d<u32> CGUIFont::getLayoutDimension(const core::stringw& text, SGUITextLayout& layout)
+{
+	updateLayout(text, layout);
+	return layout.Dimension;
+}
 
-		offset.X += area.width + area.overhang + GlobalKerningWidth;
-	}
 
-	SpriteBank->draw2DSpriteBatch(indices, offsets, clip, color);
+//! returns the distance a character moves the following characters
+s32 CGUIFont::getCharacterAdvance(wchar_t character) const
+{
+	const SFontArea& area = Areas[getAreaFromCharacter(character)];
+	return area.underhang + area.width + area.overhang + GlobalKerningWidth;
 }
 
 
@@ -25,6 +25,10 @@ namespace gui
 
 	class IGUIEnvironment;
 
+//! returns a revision for text layouts, unique among all fonts
+/** See SGUITextLayout::Revision. */
+u32 createTextLayoutRevision();
+
 class CGUIFont : public IGUIFontBitmap
 {
 public:
@@ -46,9 +50,20 @@ public:
 			video::SColor color, bool hcenter=false,
 			bool vcenter=false, const core::rect<s32>* clip=0) override;
 
+	//! draws a text from its cached layout
+	void drawLayout(const core::stringw& text, SGUITextLayout& layout,
+			const core::rect<s32>& position, video::SColor color,
+			bool hcenter=false, bool vcenter=false, const core::rect<s32>* clip=0) override;
+
 	//! returns the dimension of a text
 	core::dimension2d<u32> getDimension(const wchar_t* text) const override;
 
+	//! returns the distance a character moves the following characters
+	s32 getCharacterAdvance(wchar_t character) const override;
+
+	//! returns the dimension of a text from its cached layout
+	core::dimension2d<u32> getLayoutDimension(const core::stringw& text, SGUITextLayout& layout) override;
+
 	//! Calculates the index of the character in the text which is on a specific position.
 	s32 getCharacterFromPos(const wchar_t* text, s32 pixel_x) const override;
 
@@ -90,8 +105,14 @@ private:
 	s32 getAreaFromCharacter (const wchar_t c) const;
 	void setMaxHeight();
 
-	void pushTextureCreationFlags(bool(&flags)[3]);
-	void popTextureCreationFlags(const bool(&flags)[3]);
+	//! lays out the text again if it or the font changed since
+	void updateLayout(const core::stringw& text, SGUITextLayout& layout) const;
+
+	//! the cached layouts are outdated after changing the font
+	void changeLayoutRevision();
+
+	void pushTextureCreationFlags(bool(&flags)[4]);
+	void popTextureCreationFlags(const bool(&flags)[4]);
 
 	core::array<SFontArea>		Areas;
 	std::map<wchar_t, s32>		CharacterMap;
@@ -103,6 +124,15 @@ private:
 	s32				GlobalKerningWidth, GlobalKerningHeight;
 
 	core::stringw Invisible;
+
+	//! revision of the layouts laid out with the current settings, unique among all fonts
+	u32 LayoutRevision;
+
+	//! layout of the text drawn last by draw()
+	SGUITextLayout DrawLayout;
+
+	//! sprite positions of the layout drawn
+	core::array<core::position2di> DrawPositions;
 };
 
 } // end namespace gui
@@ -0,0 +1,608 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CGUIGlyphCacheFont.h"
+#include "CGUIFont.h"
+#include "IVideoDriver.h"
+#include "ITexture.h"
+#include "IImage.h"
+#include <string.h>
+
+namespace irr
+{
+namespace gui
+{
+
+namespace
+{
+	//! counts the fonts created, for unique texture names
+	u32 GlyphCacheFontCount = 0;
+
+	bool isInside(const core::array<u8>& inside, const core::dimension2du& size, s32 x, s32 y)
+	{
+		return x >= 0 && y >= 0 && x < (s32)size.Width && y < (s32)size.Height && inside[y * size.Width + x];
+	}
+
+	//! turns the alpha of a glyph into a signed distance field, larger by the spread on each side
+	/** Alpha 0.5 is the edge of the glyph, 1 and 0 are the spread inside and outside of it. */
+	video::IImage* createDistanceField(video::IVideoDriver* driver, video::IImage* glyph, s32 spread)
+	{
+		// pixels covered at least by half are inside
+		const core::dimension2du size = glyph->getDimension();
+		core::array<u8> inside;
+		inside.set_used(size.Width * size.Height);
+		for (u32 y=0; y<size.Height; ++y)
+			for (u32 x=0; x<size.Width; ++x)
+				inside[y * size.Width + x] = glyph->getPixel(x, y).getAlpha() >= 128 ? 1 : 0;
+
+		const core::dimension2du fieldSize(size.Width + 2 * spread, size.Height + 2 * spread);
+		video::IImage* field = driver->createImage(video::ECF_A8R8G8B8, fieldSize);
+		u32* data = (u32*)field->getData();
+		const u32 pitch = field->getPitch() / 4;
+
+		for (s32 y=0; y<(s32)fieldSize.Height; ++y)
+		{
+			for (s32 x=0; x<(s32)fieldSize.Width; ++x)
+			{
+				const s32 gx = x - spread;
+				const s32 gy = y - spread;
+				const bool in = isInside(inside, size, gx, gy);
+
+				// nearest pixel on the other side of the edge, searched in growing
+				// squares until no closer one can follow
+				s32 nearest = (spread + 1) * (spread + 1);
+				for (s32 r=1; r<=spread && r*r < nearest; ++r)
+				{
+					for (s32 dy=-r; dy<=r; ++dy)
+					{
+						const s32 step = (dy == -r || dy == r) ? 1 : 2 * r;
+						for (s32 dx=-r; dx<=r; dx+=step)
+						{
+							if (isInside(inside, size, gx + dx, gy + dy) != in)
+								nearest = core::min_(nearest, dx * dx + dy * dy);
+						}
+					}
+				}
+
+				// the edge is half way to the nearest pixel
+				f32 distance = core::min_(sqrtf((f32)nearest) - 0.5f, (f32)spread);
+				if (!in)
+					distance = -distance;
+
+				const u32 alpha = core::clamp(core::round32(127.5f + distance * 127.5f / spread), 0, 255);
+				data[y * pitch + x] = video::SColor(alpha, 255, 255, 255).color;
+			}
+		}
+
+		return field;
+	}
+}
+
+//! constructor
+CGUIGlyphCacheFont::CGUIGlyphCacheFont(video::IVideoDriver* driver, IGUIGlyphSource* source, u32 atlasSize, u32 spread, f32 scale)
+: Cache(this), Driver(driver), Source(source), Atlas(0), AtlasImage(0), AtlasChanged(false),
+	CellColumns(0), LineHeight(0), Spread(spread), Scale(scale), GlobalKerningWidth(0), GlobalKerningHeight(0),
+	Invisible(L" "), LayoutRevision(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CGUIGlyphCacheFont");
+	#endif
+
+	Driver->grab();
+	Source->grab();
+
+	for (u32 i=0; i<256; ++i)
+		Pages[i] = 0;
+
+	// textures which are no power of two may be scaled
+	u32 size = 1;
+	while (size < atlasSize)
+		size <<= 1;
+
+	LineHeight = Source->getLineHeight();
+	CellSize = Source->getMaxGlyphSize();
+	CellSize.Width += 2 * Spread;
+	CellSize.Height += 2 * Spread;
+	CellSize.Width = core::clamp<u32>(CellSize.Width, 1, size);
+	CellSize.Height = core::clamp<u32>(CellSize.Height, 1, size);
+	CellColumns = size / CellSize.Width;
+
+	SCell cell;
+	cell.Glyph = -1;
+	cell.LastUseFrame = 0;
+	Cells.set_used(CellColumns * (size / CellSize.Height));
+	for (u32 i=0; i<Cells.size(); ++i)
+		Cells[i] = cell;
+
+	AtlasImage = Driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(size, size));
+	AtlasImage->fill(video::SColor(0,0,0,0));
+
+	const bool mipMaps = Driver->getTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS);
+	const bool distanceField = Driver->getTextureCreationFlag(video::ETCF_DISTANCE_FIELD);
+	Driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, false);
+	Driver->setTextureCreationFlag(video::ETCF_DISTANCE_FIELD, Spread != 0);
+	io::path name("#GlyphCacheFont");
+	name += GlyphCacheFontCount++;
+	Atlas = Driver->addTexture(name, AtlasImage);
+	Driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, mipMaps);
+	Driver->setTextureCreationFlag(video::ETCF_DISTANCE_FIELD, distanceField);
+
+	if (Atlas)
+		Atlas->grab();
+
+	changeLayoutRevision();
+}
+
+
+//! constructor of a font sharing the glyphs and the texture of another one
+CGUIGlyphCacheFont::CGUIGlyphCacheFont(CGUIGlyphCacheFont* cache, f32 scale)
+: Cache(cache), Driver(cache->Driver), Source(cache->Source), Atlas(0), AtlasImage(0), AtlasChanged(false),
+	CellColumns(0), LineHeight(cache->LineHeight), Spread(cache->Spread), Scale(scale),
+	GlobalKerningWidth(cache->GlobalKerningWidth), GlobalKerningHeight(cache->GlobalKerningHeight),
+	Invisible(cache->Invisible), LayoutRevision(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CGUIGlyphCacheFont");
+	#endif
+
+	Cache->grab();
+
+	for (u32 i=0; i<256; ++i)
+		Pages[i] = 0;
+
+	changeLayoutRevision();
+}
+
+
+//! destructor
+CGUIGlyphCacheFont::~CGUIGlyphCacheFont()
+{
+	if (Cache != this)
+	{
+		Cache->drop();
+		return;
+	}
+
+	for (u32 i=0; i<Glyphs.size(); ++i)
+	{
+		if (Glyphs[i].Pending)
+			Glyphs[i].Pending->drop();
+	}
+
+	for (u32 i=0; i<256; ++i)
+		delete [] Pages[i];
+
+	if (Atlas)
+	{
+		Driver->removeTexture(Atlas);
+		Atlas->drop();
+	}
+	AtlasImage->drop();
+
+	Source->drop();
+	Driver->drop();
+}
+
+
+//! returns the glyph of a character, rasterized on first use
+u32 CGUIGlyphCacheFont::getGlyph(u32 character) const
+{
+	s32* entry = 0;
+	if (character < 0x10000)
+	{
+		s32*& page = Pages[character >> 8];
+		if (!page)
+		{
+			page = new s32[256];
+			for (u32 i=0; i<256; ++i)
+				page[i] = -1;
+		}
+		entry = &page[character & 0xff];
+		if (*entry != -1)
+			return *entry;
+	}
+	else
+	{
+		std::unordered_map<u32, u32>::const_iterator it = OtherGlyphs.find(character);
+		if (it != OtherGlyphs.end())
+			return it->second;
+	}
+
+	SGlyph glyph;
+	glyph.Character = character;
+	glyph.Advance = 0;
+	glyph.Cell = -1;
+	glyph.Pending = rasterize(character, glyph.Advance, glyph.Offset);
+	if (glyph.Pending)
+	{
+		glyph.Size = glyph.Pending->getDimension();
+		glyph.Size.Width = core::min_(glyph.Size.Width, CellSize.Width);
+		glyph.Size.Height = core::min_(glyph.Size.Height, CellSize.Height);
+	}
+
+	const u32 index = Glyphs.size();
+	Glyphs.push_back(glyph);
+
+	if (entry)
+		*entry = index;
+	else
+		OtherGlyphs[character] = index;
+
+	return index;
+}
+
+
+//! rasterizes a glyph, turned into a distance field if the font has a spread
+video::IImage* CGUIGlyphCacheFont::rasterize(u32 character, s32& advance, core::position2di& offset) const
+{
+	video::IImage* image = Source->rasterizeGlyph(character, advance, offset);
+	if (!image || !Spread)
+		return image;
+
+	video::IImage* field = createDistanceField(Driver, image, Spread);
+	image->drop();
+	offset.X -= Spread;
+	offset.Y -= Spread;
+	return field;
+}
+
+
+//! copies a glyph into the least recently used cell, false if all are used in this frame
+bool CGUIGlyphCacheFont::makeResident(u32 glyph)
+{
+	// glyphs drawn in this frame may still wait in a batch of the driver
+	const u32 frame = Driver->getFrameCount();
+	s32 cell = -1;
+	for (u32 i=0; i<Cells.size(); ++i)
+	{
+		if (Cells[i].Glyph == -1)
+		{
+			cell = i;
+			break;
+		}
+		if (Cells[i].LastUseFrame != frame &&
+			(cell == -1 || Cells[i].LastUseFrame < Cells[cell].LastUseFrame))
+			cell = i;
+	}
+
+	if (cell == -1)
+		return false;
+
+	SGlyph& g = Glyphs[glyph];
+	video::IImage* image = g.Pending;
+	g.Pending = 0;
+	if (!image)
+	{
+		// evicted before, rasterize it again
+		core::position2di offset;
+		s32 advance;
+		image = rasterize(g.Character, advance, offset);
+		if (!image)
+			return false;
+	}
+
+	if (Cells[cell].Glyph != -1)
+		Glyphs[Cells[cell].Glyph].Cell = -1;
+	Cells[cell].Glyph = glyph;
+	Cells[cell].LastUseFrame = frame;
+	g.Cell = cell;
+
+	// clear the cell and copy the glyph into it
+	const core::position2di pos((cell % CellColumns) * CellSize.Width, (cell / CellColumns) * CellSize.Height);
+	u8* data = (u8*)AtlasImage->getData();
+	const u32 pitch = AtlasImage->getPitch();
+	for (u32 y=0; y<CellSize.Height; ++y)
+		memset(data + (pos.Y + y) * pitch + pos.X * 4, 0, CellSize.Width * 4);
+
+	const core::recti sourceRect(core::position2di(0,0), core::dimension2di(g.Size));
+	if (image->getColorFormat() == video::ECF_A8R8G8B8)
+		image->copyTo(AtlasImage, pos, sourceRect);
+	else
+	{
+		video::IImage* converted = Driver->createImage(video::ECF_A8R8G8B8, image->getDimension());
+		image->copyTo(converted);
+		converted->copyTo(AtlasImage, pos, sourceRect);
+		converted->drop();
+	}
+	image->drop();
+
+	AtlasChanged = true;
+	return true;
+}
+
+
+//! copies the atlas image into the texture
+void CGUIGlyphCacheFont::uploadAtlas()
+{
+	AtlasChanged = false;
+
+	void* data = Atlas->lock(video::ETLM_WRITE_ONLY);
+	if (!data)
+		return;
+
+	if (Atlas->getColorFormat() == AtlasImage->getColorFormat() && Atlas->getPitch() == AtlasImage->getPitch() &&
+		Atlas->getSize() == AtlasImage->getDimension())
+	{
+		memcpy(data, AtlasImage->getData(), AtlasImage->getImageDataSizeInBytes());
+	}
+	else
+	{
+		video::IImage* target = Driver->createImageFromData(Atlas->getColorFormat(), Atlas->getSize(), data, true, false);
+		AtlasImage->copyTo(target);
+		target->drop();
+	}
+
+	Atlas->unlock();
+}
+
+
+//! the cached layouts are outdated after changing the font
+void CGUIGlyphCacheFont::changeLayoutRevision()
+{
+	LayoutRevision = createTextLayoutRevision();
+}
+
+
+//! lays out the text again if it or the font changed since
+void CGUIGlyphCacheFont::updateLayout(const core::stringw& text, SGUITextLayout& layout) const
+{
+	if (layout.Revision == LayoutRevision && layout.Text == text)
+		return;
+
+	layout.Text = text;
+	layout.Revision = LayoutRevision;
+	layout.Sprites.set_used(0);
+	layout.Positions.set_used(0);
+	layout.Sprites.reallocate(text.size(), false);
+	layout.Positions.reallocate(text.size(), false);
+
+	const s32 lineHeight = core::round32(LineHeight * Scale);
+	core::dimension2d<u32> dim(0, 0);
+	f32 x = 0.f;	// glyphs are placed at the scaled advances, rounded each
+	s32 y = 0;
+
+	for (const wchar_t* p = text.c_str(); *p; ++p)
+	{
+		bool lineBreak=false;
+		if (*p == L'\r') // Mac or Windows breaks
+		{
+			lineBreak = true;
+			if (p[1] == L'\n') // Windows breaks
+				++p;
+		}
+		else if (*p == L'\n') // Unix breaks
+		{
+			lineBreak = true;
+		}
+		if (lineBreak)
+		{
+			dim.Height += lineHeight;
+			dim.Width = core::max_(dim.Width, (u32)core::ceil32(core::max_(x, 0.f)));
+			x = 0.f;
+			y += lineHeight;
+			continue;
+		}
+
+		const u32 index = Cache->getGlyph((u32)*p);
+		const SGlyph& glyph = Cache->Glyphs[index];
+		if (glyph.Size.Width && glyph.Size.Height && Invisible.findFirst(*p) < 0)
+		{
+			layout.Sprites.push_back(index);
+			layout.Positions.push_back(core::position2di(core::round32(x + glyph.Offset.X * Scale),
+				y + core::round32(glyph.Offset.Y * Scale)));
+		}
+
+		x += glyph.Advance * Scale + GlobalKerningWidth;
+	}
+
+	dim.Height += lineHeight;
+	dim.Width = core::max_(dim.Width, (u32)core::ceil32(core::max_(x, 0.f)));
+	layout.Dimension = dim;
+}
+
+
+//! draws a text and clips it to the specified rectangle if wanted
+void CGUIGlyphCacheFont::draw(const core::stringw& text, const core::rect<s32>& position,
+		video::SColor color, bool hcenter, bool vcenter, const core::rect<s32>* clip)
+{
+	drawLayout(text, DrawLayout, position, color, hcenter, vcenter, clip);
+}
+
+
+//! draws a text from its cached layout
+void CGUIGlyphCacheFont::drawLayout(const core::stringw& text, SGUITextLayout& layout,
+		const core::rect<s32>& position, video::SColor color,
+		bool hcenter, bool vcenter, const core::rect<s32>* clip)
+{
+	if (!Cache->Atlas)
+		return;
+
+	updateLayout(text, layout);
+
+	core::dimension2d<s32> textDimension(layout.Dimension);	// signed, the text may be wider than the position
+	core::position2d<s32> offset = position.UpperLeftCorner;
+
+	if (hcenter)
+		offset.X += (position.getWidth() - textDimension.Width) >> 1;
+
+	if (vcenter)
+		offset.Y += (position.getHeight() - textDimension.Height) >> 1;
+
+	if (clip)
+	{
+		core::rect<s32> clippedRect(offset, textDimension);
+		clippedRect.clipAgainst(*clip);
+		if (!clippedRect.isValid())
+			return;
+	}
+
+	const u32 frame = Driver->getFrameCount();
+	DrawPositions.set_used(0);
+	DrawRects.set_used(0);
+
+	for (u32 i=0; i<layout.Sprites.size(); ++i)
+	{
+		const u32 index = layout.Sprites[i];
+		if (Cache->Glyphs[index].Cell == -1 && !Cache->makeResident(index))
+			continue;
+
+		const SGlyph& glyph = Cache->Glyphs[index];
+		Cache->Cells[glyph.Cell].LastUseFrame = frame;
+
+		const core::position2di cellPos((glyph.Cell % Cache->CellColumns) * Cache->CellSize.Width,
+			(glyph.Cell / Cache->CellColumns) * Cache->CellSize.Height);
+		DrawPositions.push_back(layout.Positions[i] + offset);
+		DrawRects.push_back(core::recti(cellPos, core::dimension2di(glyph.Size)));
+	}
+
+	if (Cache->AtlasChanged)
+		Cache->uploadAtlas();
+
+	if (!DrawPositions.size())
+		return;
+
+	if (Scale == 1.f)
+	{
+		Driver->draw2DImageBatch(Cache->Atlas, DrawPositions, DrawRects, clip, color, true);
+		return;
+	}
+
+	// the driver batches consecutive images of the same texture
+	const video::SColor colors[4] = { color, color, color, color };
+	for (u32 i=0; i<DrawPositions.size(); ++i)
+	{
+		const core::dimension2di size(core::round32(DrawRects[i].getWidth() * Scale),
+			core::round32(DrawRects[i].getHeight() * Scale));
+		Driver->draw2DImage(Cache->Atlas, core::recti(DrawPositions[i], size), DrawRects[i], clip, colors, true);
+	}
+}
+
+
+//! returns the dimension of a text
+core::dimension2d<u32> CGUIGlyphCacheFont::getDimension(const wchar_t* text) const
+{
+	const u32 lineHeight = core::round32(LineHeight * Scale);
+	core::dimension2d<u32> dim(0, 0);
+	f32 width = 0.f;
+
+	for (const wchar_t* p = text; *p; ++p)
+	{
+		bool lineBreak=false;
+		if (*p == L'\r') // Mac or Windows breaks
+		{
+			lineBreak = true;
+			if (p[1] == L'\n') // Windows breaks
+				++p;
+		}
+		else if (*p == L'\n') // Unix breaks
+		{
+			lineBreak = true;
+		}
+		if (lineBreak)
+		{
+			dim.Height += lineHeight;
+			dim.Width = core::max_(dim.Width, (u32)core::ceil32(core::max_(width, 0.f)));
+			width = 0.f;
+			continue;
+		}
+
+		width += Cache->Glyphs[Cache->getGlyph((u32)*p)].Advance * Scale + GlobalKerningWidth;
+	}
+
+	dim.Height += lineHeight;
+	dim.Width = core::max_(dim.Width, (u32)core::ceil32(core::max_(width, 0.f)));
+
+	return dim;
+}
+
+
+//! returns the dimension of a text from its cached layout
+core::dimension2d<u32> CGUIGlyphCacheFont::getLayoutDimension(const core::stringw& text, SGUITextLayout& layout)
+{
+	updateLayout(text, layout);
+	return layout.Dimension;
+}
+
+
+//! returns the distance a character moves the following characters
+s32 CGUIGlyphCacheFont::getCharacterAdvance(wchar_t character) const
+{
+	return core::round32(Cache->Glyphs[Cache->getGlyph((u32)character)].Advance * Scale) + GlobalKerningWidth;
+}
+
+
+//! Calculates the index of the character in the text which is on a specific position.
+s32 CGUIGlyphCacheFont::getCharacterFromPos(const wchar_t* text, s32 pixel_x) const
+{
+	s32 x = 0;
+	s32 idx = 0;
+
+	while (text[idx])
+	{
+		x += getCharacterAdvance(text[idx]);
+
+		if (x >= pixel_x)
+			return idx;
+
+		++idx;
+	}
+
+	return -1;
+}
+
+
+void CGUIGlyphCacheFont::setKerningWidth(s32 kerning)
+{
+	GlobalKerningWidth = kerning;
+	changeLayoutRevision();
+}
+
+
+void CGUIGlyphCacheFont::setKerningHeight(s32 kerning)
+{
+	GlobalKerningHeight = kerning;
+}
+
+
+s32 CGUIGlyphCacheFont::getKerningWidth(const wchar_t* thisLetter, const wchar_t* previousLetter) const
+{
+	return GlobalKerningWidth;
+}
+
+
+s32 CGUIGlyphCacheFont::getKerningHeight() const
+{
+	return GlobalKerningHeight;
+}
+
+
+void CGUIGlyphCacheFont::setInvisibleCharacters(const wchar_t* s)
+{
+	Invisible = s;
+	changeLayoutRevision();
+}
+
+
+//! Sets the size of the text relative to the size of the rasterized glyphs
+void CGUIGlyphCacheFont::setScale(f32 scale)
+{
+	Scale = scale;
+	changeLayoutRevision();
+}
+
+
+//! Returns the size of the text relative to the size of the rasterized glyphs
+f32 CGUIGlyphCacheFont::getScale() const
+{
+	return Scale;
+}
+
+
+//! Creates a font drawing the glyphs of this font at another scale
+IGUIFontDistanceField* CGUIGlyphCacheFont::createScaledFont(f32 scale)
+{
+	return new CGUIGlyphCacheFont(Cache, scale);
+}
+
+} // end namespace gui
+} // end namespace irr
@@ -0,0 +1,172 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_GUI_GLYPH_CACHE_FONT_H_INCLUDED__
+#define __C_GUI_GLYPH_CACHE_FONT_H_INCLUDED__
+
+#include "IGUIFontDistanceField.h"
+#include "IGUIGlyphSource.h"
+#include "irrArray.h"
+#include <unordered_map>
+
+namespace irr
+{
+
+namespace video
+{
+	class IVideoDriver;
+	class ITexture;
+	class IImage;
+}
+
+namespace gui
+{
+
+//! Font rasterizing its glyphs on demand into a texture of recently used glyphs
+/** Fonts created with a spread turn the glyphs into signed distance fields.
+Fonts created by createScaledFont() share the glyphs and the texture. */
+class CGUIGlyphCacheFont : public IGUIFontDistanceField
+{
+public:
+
+	//! constructor
+	/** \param spread Pixels the distance fields extend beyond the glyphs, 0 for plain glyphs */
+	CGUIGlyphCacheFont(video::IVideoDriver* driver, IGUIGlyphSource* source, u32 atlasSize, u32 spread=0, f32 scale=1.f);
+
+	//! destructor
+	virtual ~CGUIGlyphCacheFont();
+
+	//! draws a text and clips it to the specified rectangle if wanted
+	void draw(const core::stringw& text, const core::rect<s32>& position,
+			video::SColor color, bool hcenter=false,
+			bool vcenter=false, const core::rect<s32>* clip=0) override;
+
+	//! draws a text from its cached layout
+	void drawLayout(const core::stringw& text, SGUITextLayout& layout,
+			const core::rect<s32>& position, video::SColor color,
+			bool hcenter=false, bool vcenter=false, const core::rect<s32>* clip=0) override;
+
+	//! returns the dimension of a text
+	core::dimension2d<u32> getDimension(const wchar_t* text) const override;
+
+	//! returns the distance a character moves the following characters
+	s32 getCharacterAdvance(wchar_t character) const override;
+
+	//! returns the dimension of a text from its cached layout
+	core::dimension2d<u32> getLayoutDimension(const core::stringw& text, SGUITextLayout& layout) override;
+
+	//! Calculates the index of the character in the text which is on a specific position.
+	s32 getCharacterFromPos(const wchar_t* text, s32 pixel_x) const override;
+
+	//! Returns the type of this font
+	EGUI_FONT_TYPE getType() const override { return Spread ? EGFT_DISTANCE_FIELD : EGFT_CUSTOM; }
+
+	//! Sets global kerning width for the font.
+	void setKerningWidth(s32 kerning) override;
+
+	//! Sets global kerning height for the font.
+	void setKerningHeight(s32 kerning) override;
+
+	//! Gets kerning values (distance between letters) for the font.
+	s32 getKerningWidth(const wchar_t* thisLetter=0, const wchar_t* previousLetter=0) const override;
+
+	//! Returns the distance between letters
+	s32 getKerningHeight() const override;
+
+	//! Define which characters should not be drawn by the font.
+	void setInvisibleCharacters(const wchar_t* s) override;
+
+	//! Sets the size of the text relative to the size of the rasterized glyphs
+	void setScale(f32 scale) override;
+
+	//! Returns the size of the text relative to the size of the rasterized glyphs
+	f32 getScale() const override;
+
+	//! Creates a font drawing the glyphs of this font at another scale
+	IGUIFontDistanceField* createScaledFont(f32 scale) override;
+
+private:
+
+	//! constructor of a font sharing the glyphs and the texture of another one
+	CGUIGlyphCacheFont(CGUIGlyphCacheFont* cache, f32 scale);
+
+	struct SGlyph
+	{
+		u32 Character;
+		s32 Advance;
+		core::position2di Offset;
+		core::dimension2du Size;
+		s32 Cell;	// cell of the atlas holding the glyph, -1 if not resident
+		video::IImage* Pending;	// rasterized while measuring, until it is drawn
+	};
+
+	struct SCell
+	{
+		s32 Glyph;	// -1 if free
+		u32 LastUseFrame;
+	};
+
+	//! returns the glyph of a character, rasterized on first use
+	u32 getGlyph(u32 character) const;
+
+	//! rasterizes a glyph, turned into a distance field if the font has a spread
+	video::IImage* rasterize(u32 character, s32& advance, core::position2di& offset) const;
+
+	//! copies a glyph into the least recently used cell, false if all are used in this frame
+	bool makeResident(u32 glyph);
+
+	//! copies the atlas image into the texture
+	void uploadAtlas();
+
+	//! lays out the text again if it or the font changed since
+	void updateLayout(const core::stringw& text, SGUITextLayout& layout) const;
+
+	//! the cached layouts are outdated after changing the font
+	void changeLayoutRevision();
+
+	//! font owning the glyphs and the texture, this font unless created by createScaledFont()
+	CGUIGlyphCacheFont* Cache;
+
+	video::IVideoDriver* Driver;
+	IGUIGlyphSource* Source;
+
+	video::ITexture* Atlas;
+	video::IImage* AtlasImage;
+	bool AtlasChanged;
+	core::dimension2du CellSize;
+	u32 CellColumns;
+	core::array<SCell> Cells;
+
+	//! glyphs of the characters used so far
+	mutable core::array<SGlyph> Glyphs;
+
+	//! glyph indices of the Basic Multilingual Plane, 256 characters per page,
+	//! a page is allocated when one of its characters is used
+	mutable s32* Pages[256];
+
+	//! glyph indices of the characters outside of the Basic Multilingual Plane
+	mutable std::unordered_map<u32, u32> OtherGlyphs;
+
+	u32 LineHeight;
+	u32 Spread;
+
+	f32 Scale;
+	s32 GlobalKerningWidth;
+	s32 GlobalKerningHeight;
+	core::stringw Invisible;
+
+	//! revision of the layouts laid out with the current settings, unique among all fonts
+	u32 LayoutRevision;
+
+	//! layout of the text drawn last by draw()
+	SGUITextLayout DrawLayout;
+
+	//! positions and source rectangles of the glyphs drawn, kept for their memory
+	core::array<core::position2di> DrawPositions;
+	core::array<core::recti> DrawRects;
+};
+
+} // end namespace gui
+} // end namespace irr
+
+#endif // __C_GUI_GLYPH_CACHE_FONT_H_INCLUDED__
@@ -36,6 +36,7 @@ CGUIImage::~CGUIImage()
 //! sets an image
 void CGUIImage::setImage(video::ITexture* image)
 {
+	invalidateDrawCache();
 	if (image == Texture)
 		return;
 
@@ -57,6 +58,7 @@ video::ITexture* CGUIImage::getImage() const
 //! sets the color of the image
 void CGUIImage::setColor(video::SColor color)
 {
+	invalidateDrawCache();
 	Color = color;
 }
 
@@ -118,6 +120,7 @@ void CGUIImage::draw()
 //! sets if the image should use its alpha channel to draw itself
 void CGUIImage::setUseAlphaChannel(bool use)
 {
+	invalidateDrawCache();
 	UseAlphaChannel = use;
 }
 
@@ -125,6 +128,7 @@ void CGUIImage::setUseAlphaChannel(bool use)
 //! sets if the image should use its alpha channel to draw itself
 void CGUIImage::setScaleImage(bool scale)
 {
+	invalidateDrawCache();
 	ScaleImage = scale;
 }
 
@@ -144,6 +148,7 @@ bool CGUIImage::isAlphaChannelUsed() const
 //! Sets the source rectangle of the image. By default the full image is used.
 void CGUIImage::setSourceRect(const core::rect<s32>& sourceRect)
 {
+	invalidateDrawCache();
 	SourceRect = sourceRect;
 }
 
@@ -156,6 +161,7 @@ core::rect<s32> CGUIImage::getSourceRect() const
 //! Restrict target drawing-area.
 void CGUIImage::setDrawBounds(const core::rect<f32>& drawBoundUVs)
 {
+	invalidateDrawCache();
 	DrawBounds = drawBoundUVs;
 	DrawBounds.UpperLeftCorner.X = core::clamp(DrawBounds.UpperLeftCorner.X, 0.f, 1.f);
 	DrawBounds.UpperLeftCorner.Y = core::clamp(DrawBounds.UpperLeftCorner.Y, 0.f, 1.f);
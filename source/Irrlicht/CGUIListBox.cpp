@@ -99,6 +99,7 @@ s32 CGUIListBox::getIcon(u32 id) const
 //! adds a list item, returns id of item
 u32 CGUIListBox::addItem(const wchar_t* text)
 {
+	invalidateDrawCache();
 	return addItem(text, -1);
 }
 
@@ -106,6 +107,7 @@ u32 CGUIListBox::addItem(const wchar_t* text)
 //! adds a list item, returns id of item
 void CGUIListBox::removeItem(u32 id)
 {
+	invalidateDrawCache();
 	if (id >= Items.size())
 		return;
 
@@ -145,6 +147,7 @@ s32 CGUIListBox::getItemAt(s32 xpos, s32 ypos) const
 //! clears the list
 void CGUIListBox::clear()
 {
+	invalidateDrawCache();
 	Items.clear();
 	ItemsIconWidth = 0;
 	Selected = -1;
@@ -200,6 +203,7 @@ s32 CGUIListBox::getSelected() const
 //! sets the selected item. Set this to -1 if no item should be selected
 void CGUIListBox::setSelected(s32 id)
 {
+	invalidateDrawCache();
 	if ((u32)id>=Items.size())
 		Selected = -1;
 	else
@@ -214,6 +218,7 @@ void CGUIListBox::setSelected(s32 id)
 //! sets the selected item. Set this to -1 if no item should be selected
 void CGUIListBox::setSelected(const wchar_t *item)
 {
+	invalidateDrawCache();
 	s32 index = -1;
 
 	if ( item )
@@ -536,7 +541,19 @@ void CGUIListBox::draw()
 	bool hl = (HighlightWhenNotFocused || Environment->hasFocus(this) || Environment->hasFocus(ScrollBar));
 	const irr::s32 selected = getSelected();
 
-	for (s32 i=0; i<(s32)Items.size(); ++i)
+	// all items have the same height, so only the ones around the visible part are visited
+	s32 first = 0;
+	s32 last = (s32)Items.size();
+	if (ItemHeight > 0)
+	{
+		first = core::max_(0, ScrollBar->getPos() / ItemHeight - 1);
+		last = core::min_(last, (ScrollBar->getPos() + AbsoluteRect.getHeight()) / ItemHeight + 1);
+	}
+
+	frameRect.UpperLeftCorner.Y += first * ItemHeight;
+	frameRect.LowerRightCorner.Y += first * ItemHeight;
+
+	for (s32 i=first; i<last; ++i)
 	{
 		if (frameRect.LowerRightCorner.Y >= AbsoluteRect.UpperLeftCorner.Y &&
 			frameRect.UpperLeftCorner.Y <= AbsoluteRect.LowerRightCorner.Y)
@@ -574,14 +591,14 @@ void CGUIListBox::draw()
 
 				if ( i==selected && hl )
 				{
-					Font->draw(Items[i].Text.c_str(), textRect,
+					Font->drawLayout(Items[i].Text, Items[i].Layout, textRect,
 						hasItemOverrideColor(i, EGUI_LBC_TEXT_HIGHLIGHT) ?
 						getItemOverrideColor(i, EGUI_LBC_TEXT_HIGHLIGHT) : getItemDefaultColor(EGUI_LBC_TEXT_HIGHLIGHT),
 						false, true, &clientClip);
 				}
 				else
 				{
-					Font->draw(Items[i].Text.c_str(), textRect,
+					Font->drawLayout(Items[i].Text, Items[i].Layout, textRect,
 						hasItemOverrideColor(i, EGUI_LBC_TEXT) ? getItemOverrideColor(i, EGUI_LBC_TEXT) : getItemDefaultColor(EGUI_LBC_TEXT),
 						false, true, &clientClip);
 				}
@@ -601,6 +618,7 @@ void CGUIListBox::draw()
 //! adds an list item with an icon
 u32 CGUIListBox::addItem(const wchar_t* text, s32 icon)
 {
+	invalidateDrawCache();
 	ListItem i;
 	i.Text = text;
 	i.Icon = icon;
@@ -613,8 +631,31 @@ u32 CGUIListBox::addItem(const wchar_t* text, s32 icon)
 }
 
 
+//! adds many list items at once
+u32 CGUIListBox::addItems(const core::array<core::stringw>& texts, s32 icon)
+{
+	invalidateDrawCache();
+	const u32 first = Items.size();
+	Items.reallocate(first + texts.size());
+
+	ListItem i;
+	i.Icon = icon;
+	for (u32 t=0; t<texts.size(); ++t)
+	{
+		i.Text = texts[t];
+		Items.push_back(i);
+	}
+
+	recalculateItemHeight();
+	recalculateItemWidth(icon);
+
+	return first;
+}
+
+
 void CGUIListBox::setSpriteBank(IGUISpriteBank* bank)
 {
+	invalidateDrawCache();
 	if ( bank == IconBank )
 		return;
 	if (IconBank)
@@ -711,6 +752,7 @@ void CGUIListBox::recalculateItemWidth(s32 icon)
 
 void CGUIListBox::setItem(u32 index, const wchar_t* text, s32 icon)
 {
+	invalidateDrawCache();
 	if ( index >= Items.size() )
 		return;
 
@@ -726,6 +768,7 @@ void CGUIListBox::setItem(u32 index, const wchar_t* text, s32 icon)
 //! Return the index on success or -1 on failure.
 s32 CGUIListBox::insertItem(u32 index, const wchar_t* text, s32 icon)
 {
+	invalidateDrawCache();
 	ListItem i;
 	i.Text = text;
 	i.Icon = icon;
@@ -740,6 +783,7 @@ s32 CGUIListBox::insertItem(u32 index, const wchar_t* text, s32 icon)
 
 void CGUIListBox::swapItems(u32 index1, u32 index2)
 {
+	invalidateDrawCache();
 	if ( index1 >= Items.size() || index2 >= Items.size() )
 		return;
 
@@ -751,6 +795,7 @@ void CGUIListBox::swapItems(u32 index1, u32 index2)
 
 void CGUIListBox::setItemOverrideColor(u32 index, video::SColor color)
 {
+	invalidateDrawCache();
 	for ( u32 c=0; c < EGUI_LBC_COUNT; ++c )
 	{
 		Items[index].OverrideColors[c].Use = true;
@@ -761,6 +806,7 @@ void CGUIListBox::setItemOverrideColor(u32 index, video::SColor color)
 
 void CGUIListBox::setItemOverrideColor(u32 index, EGUI_LISTBOX_COLOR colorType, video::SColor color)
 {
+	invalidateDrawCache();
 	if ( index >= Items.size() || colorType < 0 || colorType >= EGUI_LBC_COUNT )
 		return;
 
@@ -771,6 +817,7 @@ void CGUIListBox::setItemOverrideColor(u32 index, EGUI_LISTBOX_COLOR colorType,
 
 void CGUIListBox::clearItemOverrideColor(u32 index)
 {
+	invalidateDrawCache();
 	for (u32 c=0; c < (u32)EGUI_LBC_COUNT; ++c )
 	{
 		Items[index].OverrideColors[c].Use = false;
@@ -780,6 +827,7 @@ void CGUIListBox::clearItemOverrideColor(u32 index)
 
 void CGUIListBox::clearItemOverrideColor(u32 index, EGUI_LISTBOX_COLOR colorType)
 {
+	invalidateDrawCache();
 	if ( index >= Items.size() || colorType < 0 || colorType >= EGUI_LBC_COUNT )
 		return;
 
@@ -829,6 +877,7 @@ video::SColor CGUIListBox::getItemDefaultColor(EGUI_LISTBOX_COLOR colorType) con
 //! set global itemHeight
 void CGUIListBox::setItemHeight( s32 height )
 {
+	invalidateDrawCache();
 	ItemHeight = height;
 	ItemHeightOverride = 1;
 }
@@ -837,6 +886,7 @@ void CGUIListBox::setItemHeight( s32 height )
 //! Sets whether to draw the background
 void CGUIListBox::setDrawBackground(bool draw)
 {
+	invalidateDrawCache();
     DrawBack = draw;
 }
 
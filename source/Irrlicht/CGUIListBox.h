@@ -7,6 +7,7 @@
 
 #include "IGUIListBox.h"
 #include "irrArray.h"
+#include "IGUIFont.h"
 
 namespace irr
 {
@@ -61,6 +62,9 @@ namespace gui
 		//! returns the id of the new created item
 		u32 addItem(const wchar_t* text, s32 icon) override;
 
+		//! adds many list items at once
+		u32 addItems(const core::array<core::stringw>& texts, s32 icon=-1) override;
+
 		//! Returns the icon of an item
 		s32 getIcon(u32 id) const override;
 
@@ -132,6 +136,9 @@ namespace gui
 			core::stringw Text;
 			s32 Icon = -1;
 
+			// laid out when the item is drawn
+			SGUITextLayout Layout;
+
 			// A multicolor extension
 			struct ListItemOverrideColor
 			{
@@ -345,6 +345,7 @@ s32 CGUIScrollBar::getPosFromMousePos(const core::position2di &pos) const
 //! sets the position of the scrollbar
 void CGUIScrollBar::setPos(s32 pos)
 {
+	invalidateDrawCache();
 	Pos = core::s32_clamp ( pos, Min, Max );
 
 	if ( core::isnotzero ( range() ) )
@@ -410,6 +411,7 @@ s32 CGUIScrollBar::getMax() const
 //! sets the maximum value of the scrollbar.
 void CGUIScrollBar::setMax(s32 max)
 {
+	invalidateDrawCache();
 	Max = max;
 	if ( Min > Max )
 		Min = Max;
@@ -430,6 +432,7 @@ s32 CGUIScrollBar::getMin() const
 //! sets the minimum value of the scrollbar.
 void CGUIScrollBar::setMin(s32 min)
 {
+	invalidateDrawCache();
 	Min = min;
 	if ( Max < Min )
 		Max = Min;
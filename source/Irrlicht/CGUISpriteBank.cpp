@@ -7,14 +7,28 @@
 #include "IGUIEnvironment.h"
 #include "IVideoDriver.h"
 #include "ITexture.h"
+#include "IImage.h"
 
 namespace irr
 {
 namespace gui
 {
 
+namespace
+{
+	//! counts the textures created by sprite banks, for unique names
+	u32 SpriteBankTextureCount = 0;
+
+	io::path getSpriteBankTextureName()
+	{
+		io::path name("#SpriteBankTexture");
+		name += SpriteBankTextureCount++;
+		return name;
+	}
+}
+
 CGUISpriteBank::CGUISpriteBank(IGUIEnvironment* env) :
-	Environment(env), Driver(0)
+	Environment(env), Driver(0), AtlasSize(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CGUISpriteBank");
@@ -93,6 +107,15 @@ void CGUISpriteBank::setTexture(u32 index, video::ITexture* texture)
 //! clear everything
 void CGUISpriteBank::clear()
 {
+	// the atlas textures are only used by this bank
+	for (u32 i=0; i<Atlases.size(); ++i)
+	{
+		Atlases[i].Image->drop();
+		if (Textures[Atlases[i].TextureIndex])
+			Driver->removeTexture(Textures[Atlases[i].TextureIndex]);
+	}
+	Atlases.clear();
+
 	// drop textures
 	for (u32 i=0; i<Textures.size(); ++i)
 	{
@@ -110,11 +133,71 @@ s32 CGUISpriteBank::addTextureAsSprite(video::ITexture* texture)
 	if ( !texture )
 		return -1;
 
+	const core::dimension2du size = texture->getOriginalSize();
+
+	// packing reads the texture back, which only works for unscaled and uncompressed textures
+	if (AtlasSize && Driver && size == texture->getSize() &&
+		!video::IImage::isCompressedFormat(texture->getColorFormat()) &&
+		size.Width < AtlasSize && size.Height < AtlasSize)
+	{
+		void* data = texture->lock(video::ETLM_READ_ONLY);
+		if (data)
+		{
+			s32 sprite = -1;
+			if (texture->getPitch() == video::IImage::getDataSizeFromFormat(texture->getColorFormat(), size.Width, 1))
+			{
+				video::IImage* image = Driver->createImageFromData(texture->getColorFormat(), size, data, false, false);
+				sprite = addToAtlas(image);
+				image->drop();
+			}
+			texture->unlock();
+
+			if (sprite != -1)
+				return sprite;
+		}
+	}
+
+	addTexture(texture);
+	return addSprite(getTextureCount() - 1, core::rect<s32>(0,0, size.Width, size.Height));
+}
+
+
+//! Add the image as a single non-animated sprite.
+s32 CGUISpriteBank::addImageAsSprite(video::IImage* image)
+{
+	if (!image || !Driver)
+		return -1;
+
+	const s32 sprite = addToAtlas(image);
+	if (sprite != -1)
+		return sprite;
+
+	video::ITexture* texture = Driver->addTexture(getSpriteBankTextureName(), image);
+	if (!texture)
+		return -1;
+
 	addTexture(texture);
-	u32 textureIndex = getTextureCount() - 1;
+	return addSprite(getTextureCount() - 1, core::rect<s32>(0,0, image->getDimension().Width, image->getDimension().Height));
+}
+
 
+void CGUISpriteBank::setAtlasSize(u32 size)
+{
+	AtlasSize = size;
+}
+
+
+u32 CGUISpriteBank::getAtlasSize() const
+{
+	return AtlasSize;
+}
+
+
+//! adds a non-animated sprite showing a rectangle of a texture
+s32 CGUISpriteBank::addSprite(u32 textureIndex, const core::rect<s32>& rect)
+{
 	u32 rectangleIndex = Rectangles.size();
-	Rectangles.push_back( core::rect<s32>(0,0, texture->getOriginalSize().Width, texture->getOriginalSize().Height) );
+	Rectangles.push_back(rect);
 
 	SGUISprite sprite;
 	sprite.frameTime = 0;
@@ -129,6 +212,96 @@ s32 CGUISpriteBank::addTextureAsSprite(video::ITexture* texture)
 	return Sprites.size() - 1;
 }
 
+
+//! packs the image into an atlas, returns -1 if it does not fit
+s32 CGUISpriteBank::addToAtlas(video::IImage* image)
+{
+	if (!AtlasSize || video::IImage::isCompressedFormat(image->getColorFormat()))
+		return -1;
+
+	// one transparent pixel between the sprites
+	const core::dimension2du size = image->getDimension();
+	const s32 width = size.Width + 1;
+	const s32 height = size.Height + 1;
+	if (width > (s32)AtlasSize || height > (s32)AtlasSize)
+		return -1;
+
+	SAtlas* atlas = 0;
+	for (u32 i=0; i<Atlases.size() && !atlas; ++i)
+	{
+		SAtlas& a = Atlases[i];
+		if (a.ShelfX + width > (s32)AtlasSize && a.ShelfY + a.ShelfHeight + height <= (s32)AtlasSize)
+		{
+			// start the next shelf
+			a.ShelfY += a.ShelfHeight;
+			a.ShelfX = 0;
+			a.ShelfHeight = 0;
+		}
+		if (a.ShelfX + width <= (s32)AtlasSize && a.ShelfY + height <= (s32)AtlasSize)
+			atlas = &a;
+	}
+
+	if (!atlas)
+	{
+		SAtlas a;
+		a.Image = Driver->createImage(video::ECF_A8R8G8B8, core::dimension2du(AtlasSize, AtlasSize));
+		a.Image->fill(video::SColor(0,0,0,0));
+		a.TextureIndex = Textures.size();
+		a.ShelfX = 0;
+		a.ShelfY = 0;
+		a.ShelfHeight = 0;
+		a.Changed = true;
+		Textures.push_back(0);
+		Atlases.push_back(a);
+		atlas = &Atlases.getLast();
+	}
+
+	const core::position2di pos(atlas->ShelfX, atlas->ShelfY);
+	if (image->getColorFormat() == video::ECF_A8R8G8B8)
+		image->copyTo(atlas->Image, pos);
+	else
+	{
+		video::IImage* converted = Driver->createImage(video::ECF_A8R8G8B8, size);
+		image->copyTo(converted);
+		converted->copyTo(atlas->Image, pos);
+		converted->drop();
+	}
+
+	atlas->ShelfX += width;
+	atlas->ShelfHeight = core::max_(atlas->ShelfHeight, height);
+	atlas->Changed = true;
+
+	return addSprite(atlas->TextureIndex, core::rect<s32>(pos, core::dimension2d<s32>(size)));
+}
+
+
+//! uploads the atlases changed since they were drawn
+void CGUISpriteBank::updateAtlases()
+{
+	for (u32 i=0; i<Atlases.size(); ++i)
+	{
+		SAtlas& atlas = Atlases[i];
+		if (!atlas.Changed)
+			continue;
+		atlas.Changed = false;
+
+		const bool mipMaps = Driver->getTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS);
+		Driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, false);
+		video::ITexture* texture = Driver->addTexture(getSpriteBankTextureName(), atlas.Image);
+		Driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, mipMaps);
+
+		video::ITexture* old = Textures[atlas.TextureIndex];
+		if (old)
+			old->grab();
+		setTexture(atlas.TextureIndex, texture);
+		if (old)
+		{
+			Driver->removeTexture(old);
+			old->drop();
+		}
+	}
+}
+
 // get FrameNr for time. return true on exisiting frame
 inline bool CGUISpriteBank::getFrameNr(u32& frame,u32 index, u32 time, bool loop) const
 {
@@ -157,6 +330,8 @@ void CGUISpriteBank::draw2DSprite(u32 index, const core::position2di& pos,
 		const core::rect<s32>* clip, const video::SColor& color,
 		u32 starttime, u32 currenttime, bool loop, bool center)
 {
+	updateAtlases();
+
 	u32 frame = 0;
 	if (!getFrameNr(frame, index, currenttime - starttime, loop))
 		return;
@@ -182,6 +357,8 @@ void CGUISpriteBank::draw2DSprite(u32 index, const core::rect<s32>& destRect,
 		const core::rect<s32>* clip, const video::SColor * const colors,
 		u32 timeTicks, bool loop)
 {
+	updateAtlases();
+
 	u32 frame = 0;
 	if (!getFrameNr(frame,index, timeTicks, loop))
 		return;
@@ -208,12 +385,15 @@ void CGUISpriteBank::draw2DSpriteBatch(	const core::array<u32>& indices,
 
 	if (!getTextureCount())
 		return;
-	core::array<SDrawBatch> drawBatches(getTextureCount());
+	updateAtlases();
+
+	core::array<SDrawBatch>& drawBatches = DrawBatches;
+	while (drawBatches.size() < Textures.size())
+		drawBatches.push_back(SDrawBatch());
 	for (u32 i=0; i < Textures.size(); ++i)
 	{
-		drawBatches.push_back(SDrawBatch());
-		drawBatches[i].positions.reallocate(drawCount);
-		drawBatches[i].sourceRects.reallocate(drawCount);
+		drawBatches[i].positions.set_used(0);
+		drawBatches[i].sourceRects.set_used(0);
 	}
 
 	for (u32 i = 0; i < drawCount; ++i)
@@ -226,7 +406,7 @@ void CGUISpriteBank::draw2DSpriteBatch(	const core::array<u32>& indices,
 			return;
 
 		const u32 texNum = Sprites[index].Frames[frame].textureNumber;
-		if (texNum >= drawBatches.size())
+		if (texNum >= Textures.size())
 		{
 			continue;
 		}
@@ -253,7 +433,7 @@ void CGUISpriteBank::draw2DSpriteBatch(	const core::array<u32>& indices,
 		}
 	}
 
-	for(u32 i = 0;i < drawBatches.size();i++)
+	for(u32 i = 0;i < Textures.size();i++)
 	{
 		if(!drawBatches[i].positions.empty() && !drawBatches[i].sourceRects.empty())
 			Driver->draw2DImageBatch(getTexture(i), drawBatches[i].positions,
@@ -14,6 +14,7 @@ namespace video
 {
 	class IVideoDriver;
 	class ITexture;
+	class IImage;
 }
 
 namespace gui
@@ -40,6 +41,15 @@ public:
 	//! Add the texture and use it for a single non-animated sprite.
 	s32 addTextureAsSprite(video::ITexture* texture) override;
 
+	//! Add the image as a single non-animated sprite.
+	s32 addImageAsSprite(video::IImage* image) override;
+
+	//! Packs sprites added afterwards into shared atlas textures
+	void setAtlasSize(u32 size) override;
+
+	//! Returns the size of the atlas textures
+	u32 getAtlasSize() const override;
+
 	//! clears sprites, rectangles and textures
 	void clear() override;
 
@@ -66,6 +76,24 @@ protected:
 
 	bool getFrameNr(u32& frameNr, u32 index, u32 time, bool loop) const;
 
+	//! adds a non-animated sprite showing a rectangle of a texture
+	s32 addSprite(u32 textureIndex, const core::rect<s32>& rect);
+
+	//! packs the image into an atlas, returns -1 if it does not fit
+	s32 addToAtlas(video::IImage* image);
+
+	//! uploads the atlases changed since they were drawn
+	void updateAtlases();
+
+	//! An image the sprites are packed into in rows, the shelves
+	struct SAtlas
+	{
+		video::IImage* Image;
+		u32 TextureIndex;
+		s32 ShelfX, ShelfY, ShelfHeight;
+		bool Changed;
+	};
+
 	struct SDrawBatch
 	{
 		core::array<core::position2di> positions;
@@ -79,6 +107,12 @@ protected:
 	IGUIEnvironment* Environment;
 	video::IVideoDriver* Driver;
 
+	core::array<SAtlas> Atlases;
+	u32 AtlasSize;
+
+	//! batches of draw2DSpriteBatch(), kept for their memory
+	core::array<SDrawBatch> DrawBatches;
+
 };
 
 } // end namespace gui
@@ -25,7 +25,7 @@ CGUIStaticText::CGUIStaticText(const wchar_t* text, bool border,
 	Border(border), OverrideColorEnabled(false), OverrideBGColorEnabled(false), WordWrap(false), Background(background),
 	RestrainTextInside(true), RightToLeft(false),
 	OverrideColor(video::SColor(101,255,255,255)), BGColor(video::SColor(101,210,210,210)),
-	OverrideFont(0), LastBreakFont(0)
+	OverrideFont(0), LastBreakFont(0), LastBreakWidth(-1)
 {
 	#ifdef _DEBUG
 	setDebugName("CGUIStaticText");
@@ -95,10 +95,10 @@ void CGUIStaticText::draw()
 				if (HAlign == EGUIA_LOWERRIGHT)
 				{
 					frameRect.UpperLeftCorner.X = frameRect.LowerRightCorner.X -
-						font->getDimension(Text.c_str()).Width;
+						font->getLayoutDimension(Text, TextLayout).Width;
 				}
 
-				font->draw(Text.c_str(), frameRect, 
+				font->drawLayout(Text, TextLayout, frameRect, 
 					getActiveColor(),
 					HAlign == EGUIA_CENTER, VAlign == EGUIA_CENTER, (RestrainTextInside ? &AbsoluteClippingRect : NULL));
 			}
@@ -119,15 +119,24 @@ void CGUIStaticText::draw()
 					r.UpperLeftCorner.Y = r.LowerRightCorner.Y - totalHeight;
 				}
 
+				// the layouts check their text, so breaking the text again needs no update here
+				if (BrokenTextLayouts.size() != BrokenText.size())
+				{
+					BrokenTextLayouts.clear();
+					BrokenTextLayouts.reallocate(BrokenText.size());
+					for (u32 i=0; i<BrokenText.size(); ++i)
+						BrokenTextLayouts.push_back(SGUITextLayout());
+				}
+
 				for (u32 i=0; i<BrokenText.size(); ++i)
 				{
 					if (HAlign == EGUIA_LOWERRIGHT)
 					{
 						r.UpperLeftCorner.X = frameRect.LowerRightCorner.X -
-							font->getDimension(BrokenText[i].c_str()).Width;
+							font->getLayoutDimension(BrokenText[i], BrokenTextLayouts[i]).Width;
 					}
 
-					font->draw(BrokenText[i].c_str(), r,
+					font->drawLayout(BrokenText[i], BrokenTextLayouts[i], r,
 						getActiveColor(),
 						HAlign == EGUIA_CENTER, false, (RestrainTextInside ? &AbsoluteClippingRect : NULL));
 
@@ -145,6 +154,7 @@ void CGUIStaticText::draw()
 //! Sets another skin independent font.
 void CGUIStaticText::setOverrideFont(IGUIFont* font)
 {
+	invalidateDrawCache();
 	if (OverrideFont == font)
 		return;
 
@@ -179,6 +189,7 @@ IGUIFont* CGUIStaticText::getActiveFont() const
 //! Sets another color for the text.
 void CGUIStaticText::setOverrideColor(video::SColor color)
 {
+	invalidateDrawCache();
 	OverrideColor = color;
 	OverrideColorEnabled = true;
 }
@@ -187,6 +198,7 @@ void CGUIStaticText::setOverrideColor(video::SColor color)
 //! Sets another color for the text.
 void CGUIStaticText::setBackgroundColor(video::SColor color)
 {
+	invalidateDrawCache();
 	BGColor = color;
 	OverrideBGColorEnabled = true;
 	Background = true;
@@ -196,6 +208,7 @@ void CGUIStaticText::setBackgroundColor(video::SColor color)
 //! Sets whether to draw the background
 void CGUIStaticText::setDrawBackground(bool draw)
 {
+	invalidateDrawCache();
 	Background = draw;
 }
 
@@ -217,6 +230,7 @@ bool CGUIStaticText::isDrawBackgroundEnabled() const
 //! Sets whether to draw the border
 void CGUIStaticText::setDrawBorder(bool draw)
 {
+	invalidateDrawCache();
 	Border = draw;
 }
 
@@ -230,6 +244,7 @@ bool CGUIStaticText::isDrawBorderEnabled() const
 
 void CGUIStaticText::setTextRestrainedInside(bool restrainTextInside)
 {
+	invalidateDrawCache();
 	RestrainTextInside = restrainTextInside;
 }
 
@@ -242,6 +257,7 @@ bool CGUIStaticText::isTextRestrainedInside() const
 
 void CGUIStaticText::setTextAlignment(EGUI_ALIGNMENT horizontal, EGUI_ALIGNMENT vertical)
 {
+	invalidateDrawCache();
 	HAlign = horizontal;
 	VAlign = vertical;
 }
@@ -267,6 +283,7 @@ irr::video::SColor CGUIStaticText::getActiveColor() const
 //! color in the gui skin.
 void CGUIStaticText::enableOverrideColor(bool enable)
 {
+	invalidateDrawCache();
 	OverrideColorEnabled = enable;
 }
 
@@ -281,6 +298,7 @@ bool CGUIStaticText::isOverrideColorEnabled() const
 //! multiline text control.
 void CGUIStaticText::setWordWrap(bool enable)
 {
+	invalidateDrawCache();
 	WordWrap = enable;
 	breakText();
 }
@@ -294,6 +312,7 @@ bool CGUIStaticText::isWordWrapEnabled() const
 
 void CGUIStaticText::setRightToLeft(bool rtl)
 {
+	invalidateDrawCache();
 	if (RightToLeft != rtl)
 	{
 		RightToLeft = rtl;
@@ -308,220 +327,161 @@ bool CGUIStaticText::isRightToLeft() const
 }
 
 
+//! Returns the width the text is broken at
+s32 CGUIStaticText::getBreakWidth() const
+{
+	s32 elWidth = RelativeRect.getWidth();
+	if (Border)
+		elWidth -= 2*Environment->getSkin()->getSize(EGDS_TEXT_DISTANCE_X);
+	return elWidth;
+}
+
+
+//! Sets a line of the broken text, reusing the strings of the lines before
+void CGUIStaticText::setBrokenLine(u32 line, s32 begin, s32 end, bool hyphen)
+{
+	if (line == BrokenText.size())
+		BrokenText.push_back(core::stringw());
+
+	core::stringw& text = BrokenText[line];
+	text = L"";
+	for (s32 i=begin; i<end; ++i)
+		text.append(Text[i]);
+	if (hyphen)
+		text.append(L'-');
+}
+
+
 //! Breaks the single text line.
 void CGUIStaticText::breakText()
 {
 	if (!WordWrap)
 		return;
 
-	BrokenText.clear();
-
-	IGUISkin* skin = Environment->getSkin();
 	IGUIFont* font = getActiveFont();
 	if (!font)
+	{
+		BrokenText.clear();
 		return;
+	}
 
 	LastBreakFont = font;
+	LastBreakWidth = getBreakWidth();
+
+	// The words are measured by adding up the advances of their characters and
+	// the lines are kept as ranges of the text until they are copied out.
+	// Right-to-left text is broken the same way starting from the end, the
+	// ranges are then bounds between characters counted in reading direction.
+	const s32 size = Text.size();
+	const s32 elWidth = LastBreakWidth;
+	const s32 step = RightToLeft ? -1 : 1;
+	const s32 textStart = RightToLeft ? size : 0;
+	u32 lines = 0;
+
+	s32 lineStart = textStart;	// bound where the current line starts
+	s32 lineEnd = textStart;	// bound after the last word of the current line
+	s32 length = 0;				// width of the current line up to lineEnd
+	s32 wordStart = -1;			// bound where the current word starts, -1 if there is none
+	s32 wordLength = 0;
+	s32 whiteLength = 0;		// width of the whitespace after the current line
+
+	for (s32 i = RightToLeft ? size-1 : 0; i >= 0 && i < size; i += step)
+	{
+		const s32 before = RightToLeft ? i+1 : i;
+		const wchar_t c = Text[i];
+		bool lineBreak = false;
 
-	core::stringw line;
-	core::stringw word;
-	core::stringw whitespace;
-	s32 size = Text.size();
-	s32 length = 0;
-	s32 elWidth = RelativeRect.getWidth();
-	if (Border)
-		elWidth -= 2*skin->getSize(EGDS_TEXT_DISTANCE_X);
-	wchar_t c;
+		if (c == L'\r' || c == L'\n') // Mac, Windows or Unix breaks
+		{
+			lineBreak = true;
+			// Windows breaks
+			if (!RightToLeft && c == L'\r' && Text[i+1] == L'\n')
+				++i;
+			else if (RightToLeft && c == L'\n' && i > 0 && Text[i-1] == L'\r')
+				--i;
+		}
 
-	// We have to deal with right-to-left and left-to-right differently
-	// However, most parts of the following code is the same, it's just
-	// some order and boundaries which change.
-	if (!RightToLeft)
-	{
-		// regular (left-to-right)
-		for (s32 i=0; i<size; ++i)
+		const bool isWhitespace = lineBreak || c == L' ';
+		if (!isWhitespace)
 		{
-			c = Text[i];
-			bool lineBreak = false;
+			// part of a word
+			if (wordStart == -1)
+				wordStart = before;
+			wordLength += font->getCharacterAdvance(c);
+		}
 
-			if (c == L'\r') // Mac or Windows breaks
+		const bool last = RightToLeft ? i <= 0 : i >= size-1;
+		if (wordStart != -1 && (isWhitespace || last))
+		{
+			// here comes the next whitespace, look if
+			// we must break the last word to the next line.
+			const s32 wordEnd = isWhitespace ? before : before + step;
+
+			// This word is too long to fit in the available space, look for
+			// the Unicode Soft HYphen (SHY / 00AD) character for a place to
+			// break the word at
+			s32 where = -1;
+			if (wordLength > elWidth && !RightToLeft)
 			{
-				lineBreak = true;
-				if (Text[i+1] == L'\n') // Windows breaks
+				for (s32 k=wordStart; k<wordEnd && where == -1; ++k)
 				{
-					Text.erase(i+1);
-					--size;
+					if (Text[k] == wchar_t(0x00AD))
+						where = k;
 				}
-				c = '\0';
-			}
-			else if (c == L'\n') // Unix breaks
-			{
-				lineBreak = true;
-				c = '\0';
 			}
 
-			bool isWhitespace = (c == L' ' || c == 0);
-			if ( !isWhitespace )
+			if (where != -1)
 			{
-				// part of a word
-				word += c;
+				setBrokenLine(lines++, lineStart, where, true);
+				length = 0;
+				for (s32 k=where; k<wordEnd; ++k)
+					length += font->getCharacterAdvance(Text[k]);
+				lineStart = where;
 			}
-
-			if ( isWhitespace || i == (size-1))
+			else if (length && (length + wordLength + whiteLength > elWidth))
 			{
-				if (word.size())
-				{
-					// here comes the next whitespace, look if
-					// we must break the last word to the next line.
-					const s32 whitelgth = font->getDimension(whitespace.c_str()).Width;
-					const s32 wordlgth = font->getDimension(word.c_str()).Width;
-
-					if (wordlgth > elWidth)
-					{
-						// This word is too long to fit in the available space, look for
-						// the Unicode Soft HYphen (SHY / 00AD) character for a place to
-						// break the word at
-						int where = word.findFirst( wchar_t(0x00AD) );
-						if (where != -1)
-						{
-							core::stringw first  = word.subString(0, where);
-							core::stringw second = word.subString(where, word.size() - where);
-							BrokenText.push_back(line + first + L"-");
-							const s32 secondLength = font->getDimension(second.c_str()).Width;
-
-							length = secondLength;
-							line = second;
-						}
-						else
-						{
-							// No soft hyphen found, so there's nothing more we can do
-							// break to next line
-							if (length)
-								BrokenText.push_back(line);
-							length = wordlgth;
-							line = word;
-						}
-					}
-					else if (length && (length + wordlgth + whitelgth > elWidth))
-					{
-						// break to next line
-						BrokenText.push_back(line);
-						length = wordlgth;
-						line = word;
-					}
-					else
-					{
-						// add word to line
-						line += whitespace;
-						line += word;
-						length += whitelgth + wordlgth;
-					}
-
-					word = L"";
-					whitespace = L"";
-				}
-
-				if ( isWhitespace )
-				{
-					whitespace += c;
-				}
-
-				// compute line break
-				if (lineBreak)
-				{
-					line += whitespace;
-					line += word;
-					BrokenText.push_back(line);
-					line = L"";
-					word = L"";
-					whitespace = L"";
-					length = 0;
-				}
+				// break to next line
+				setBrokenLine(lines++, core::min_(lineStart, lineEnd), core::max_(lineStart, lineEnd), false);
+				length = wordLength;
+				lineStart = wordStart;
 			}
-		}
-
-		line += whitespace;
-		line += word;
-		BrokenText.push_back(line);
-	}
-	else
-	{
-		// right-to-left
-		for (s32 i=size; i>=0; --i)
-		{
-			c = Text[i];
-			bool lineBreak = false;
-
-			if (c == L'\r') // Mac or Windows breaks
+			else if (!length && wordLength > elWidth)
 			{
-				lineBreak = true;
-				if ((i>0) && Text[i-1] == L'\n') // Windows breaks
-				{
-					Text.erase(i-1);
-					--size;
-				}
-				c = '\0';
+				// nothing more we can do, the word gets a line of its own
+				length = wordLength;
+				lineStart = wordStart;
 			}
-			else if (c == L'\n') // Unix breaks
+			else
 			{
-				lineBreak = true;
-				c = '\0';
+				// add word to line
+				length += whiteLength + wordLength;
 			}
 
-			if (c==L' ' || c==0 || i==0)
-			{
-				if (word.size())
-				{
-					// here comes the next whitespace, look if
-					// we must break the last word to the next line.
-					const s32 whitelgth = font->getDimension(whitespace.c_str()).Width;
-					const s32 wordlgth = font->getDimension(word.c_str()).Width;
-
-					if (length && (length + wordlgth + whitelgth > elWidth))
-					{
-						// break to next line
-						BrokenText.push_back(line);
-						length = wordlgth;
-						line = word;
-					}
-					else
-					{
-						// add word to line
-						line = whitespace + line;
-						line = word + line;
-						length += whitelgth + wordlgth;
-					}
-
-					word = L"";
-					whitespace = L"";
-				}
+			lineEnd = wordEnd;
+			wordStart = -1;
+			wordLength = 0;
+			whiteLength = 0;
+		}
 
-				if (c != 0)
-					whitespace = core::stringw(&c, 1) + whitespace;
+		if (c == L' ')
+			whiteLength += font->getCharacterAdvance(c);
 
-				// compute line break
-				if (lineBreak)
-				{
-					line = whitespace + line;
-					line = word + line;
-					BrokenText.push_back(line);
-					line = L"";
-					word = L"";
-					whitespace = L"";
-					length = 0;
-				}
-			}
-			else
-			{
-				// yippee this is a word..
-				word = core::stringw(&c, 1) + word;
-			}
+		// compute line break, the line keeps its whitespace
+		if (lineBreak)
+		{
+			setBrokenLine(lines++, core::min_(lineStart, before), core::max_(lineStart, before), false);
+			lineStart = RightToLeft ? i : i+1;
+			lineEnd = lineStart;
+			length = 0;
+			whiteLength = 0;
 		}
-
-		line = whitespace + line;
-		line = word + line;
-		BrokenText.push_back(line);
 	}
+
+	const s32 textEnd = RightToLeft ? 0 : size;
+	setBrokenLine(lines++, core::min_(lineStart, textEnd), core::max_(lineStart, textEnd), false);
+
+	if (BrokenText.size() > lines)
+		BrokenText.erase(lines, BrokenText.size() - lines);
 }
 
 
@@ -536,7 +496,10 @@ void CGUIStaticText::setText(const wchar_t* text)
 void CGUIStaticText::updateAbsolutePosition()
 {
 	IGUIElement::updateAbsolutePosition();
-	breakText();
+
+	// moving the text keeps its lines
+	if (getActiveFont() != LastBreakFont || getBreakWidth() != LastBreakWidth)
+		breakText();
 }
 
 
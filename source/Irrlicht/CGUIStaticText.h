@@ -7,6 +7,7 @@
 
 #include "IGUIStaticText.h"
 #include "irrArray.h"
+#include "IGUIFont.h"
 
 namespace irr
 {
@@ -114,6 +115,12 @@ namespace gui
 		//! Breaks the single text line.
 		void breakText();
 
+		//! Returns the width the text is broken at
+		s32 getBreakWidth() const;
+
+		//! Sets a line of the broken text to a range of the text
+		void setBrokenLine(u32 line, s32 begin, s32 end, bool hyphen);
+
 		EGUI_ALIGNMENT HAlign, VAlign;
 		bool Border;
 		bool OverrideColorEnabled;
@@ -126,8 +133,13 @@ namespace gui
 		video::SColor OverrideColor, BGColor;
 		gui::IGUIFont* OverrideFont;
 		gui::IGUIFont* LastBreakFont; // stored because: if skin changes, line break must be recalculated.
+		s32 LastBreakWidth; // stored because: moving the element without resizing keeps the lines.
 
 		core::array< core::stringw > BrokenText;
+
+		//! layouts of the text, or of the lines of the broken text
+		SGUITextLayout TextLayout;
+		core::array< SGUITextLayout > BrokenTextLayouts;
 	};
 
 } // end namespace gui
@@ -776,6 +776,7 @@ void CGUITabControl::draw()
 //! Set the height of the tabs
 void CGUITabControl::setTabHeight( s32 height )
 {
+	invalidateDrawCache();
 	if ( height < 0 )
 		height = 0;
 
@@ -795,6 +796,7 @@ s32 CGUITabControl::getTabHeight() const
 //! set the maximal width of a tab. Per default width is 0 which means "no width restriction".
 void CGUITabControl::setTabMaxWidth(s32 width )
 {
+	invalidateDrawCache();
 	TabMaxWidth = width;
 }
 
@@ -808,6 +810,7 @@ s32 CGUITabControl::getTabMaxWidth() const
 //! Set the extra width added to tabs on each side of the text
 void CGUITabControl::setTabExtraWidth( s32 extraWidth )
 {
+	invalidateDrawCache();
 	if ( extraWidth < 0 )
 		extraWidth = 0;
 
@@ -850,6 +853,7 @@ void CGUITabControl::recalculateScrollBar()
 //! Set the alignment of the tabs
 void CGUITabControl::setTabVerticalAlignment( EGUI_ALIGNMENT alignment )
 {
+	invalidateDrawCache();
 	VerticalAlignment = alignment;
 
 	recalculateScrollButtonPlacement();
@@ -970,6 +974,7 @@ s32 CGUITabControl::getActiveTab() const
 //! Brings a tab to front.
 bool CGUITabControl::setActiveTab(s32 idx)
 {
+	invalidateDrawCache();
 	if ((u32)idx >= Tabs.size())
 		return false;
 
@@ -999,6 +1004,7 @@ bool CGUITabControl::setActiveTab(s32 idx)
 
 void CGUITabControl::setVisibleTab(s32 idx)
 {
+	invalidateDrawCache();
 	for (u32 i=0; i<Tabs.size(); ++i)
 		if (Tabs[i])
 			Tabs[i]->setVisible( (s32)i == idx );
@@ -1007,6 +1013,7 @@ void CGUITabControl::setVisibleTab(s32 idx)
 
 bool CGUITabControl::setActiveTab(IGUITab *tab)
 {
+	invalidateDrawCache();
 	return setActiveTab(getTabIndex(tab));
 }
 
@@ -0,0 +1,232 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CIRBMeshFileLoader.h"
+#include "SIRBStructs.h"
+#include "CSkinnedMesh.h"
+#include "IReadFile.h"
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+
+//! Reads count elements into an array, checking the size of the file first
+template <class T>
+bool readArray(io::IReadFile* file, core::array<T>& array, u32 count)
+{
+	const long remaining = file->getSize() - file->getPos();
+	if ((u64)count * sizeof(T) > (u64)(remaining > 0 ? remaining : 0))
+		return false;
+
+	array.set_used(count);
+	const size_t size = count * sizeof(T);
+	return size == 0 || file->read(array.pointer(), size) == size;
+}
+
+void readMaterial(video::SMaterial& material, const SIRBMaterial& in)
+{
+	material.MaterialType = (video::E_MATERIAL_TYPE)in.MaterialType;
+	material.MaterialTypeParam = in.MaterialTypeParam;
+	material.AmbientColor.color = in.AmbientColor;
+	material.DiffuseColor.color = in.DiffuseColor;
+	material.SpecularColor.color = in.SpecularColor;
+	material.EmissiveColor.color = in.EmissiveColor;
+	material.Shininess = in.Shininess;
+	material.ColorMaterial = in.ColorMaterial;
+	material.ZWriteEnable = (video::E_ZWRITE)in.ZWriteEnable;
+	material.Wireframe = (in.Flags & EIRBMF_WIREFRAME) != 0;
+	material.GouraudShading = (in.Flags & EIRBMF_GOURAUD_SHADING) != 0;
+	material.Lighting = (in.Flags & EIRBMF_LIGHTING) != 0;
+	material.BackfaceCulling = (in.Flags & EIRBMF_BACKFACE_CULLING) != 0;
+	material.FrontfaceCulling = (in.Flags & EIRBMF_FRONTFACE_CULLING) != 0;
+	material.FogEnable = (in.Flags & EIRBMF_FOG_ENABLE) != 0;
+	material.NormalizeNormals = (in.Flags & EIRBMF_NORMALIZE_NORMALS) != 0;
+}
+
+bool readBuffer(io::IReadFile* file, SSkinMeshBuffer* buffer)
+{
+	SIRBBufferHeader header;
+	if (file->read(&header, sizeof(header)) != sizeof(header))
+		return false;
+
+	buffer->PrimitiveType = (E_PRIMITIVE_TYPE)header.PrimitiveType;
+	readMaterial(buffer->Material, header.Material);
+	buffer->Transformation.setM(header.Transformation);
+
+	bool ok;
+	switch (header.VertexType)
+	{
+	case video::EVT_STANDARD:
+	case video::EVT_2TCOORDS:
+	case video::EVT_TANGENTS:
+	{
+		buffer->setVertexType((video::E_VERTEX_TYPE)header.VertexType);
+		const u64 size = (u64)header.VertexCount * buffer->getVertexPitch();
+		ok = size <= 0xffffffff && readArray(file, buffer->Vertices, (u32)size);
+		break;
+	}
+	default:
+		ok = false;
+		break;
+	}
+
+	if (!ok || !readArray(file, buffer->Indices, header.IndexCount))
+		return false;
+
+	for (u32 i=0; i<buffer->Indices.size(); ++i)
+	{
+		if (buffer->Indices[i] >= header.VertexCount)
+			return false;
+	}
+
+	buffer->setDirty();
+	return true;
+}
+
+bool readJoint(io::IReadFile* file, CSkinnedMesh* mesh, ISkinnedMesh::SJoint* joint, s32& parent)
+{
+	SIRBJointHeader header;
+	if (file->read(&header, sizeof(header)) != sizeof(header))
+		return false;
+
+	parent = header.Parent;
+
+	core::array<c8> name;
+	if (!readArray(file, name, header.NameLength))
+		return false;
+	name.push_back(0);
+	joint->Name = name.const_pointer();
+
+	joint->LocalMatrix.setM(header.LocalMatrix);
+	joint->GlobalInversedMatrix.setM(header.GlobalInversedMatrix);
+
+	if (!readArray(file, joint->AttachedMeshes, header.AttachedMeshCount) ||
+		!readArray(file, joint->PositionKeys, header.PositionKeyCount) ||
+		!readArray(file, joint->ScaleKeys, header.ScaleKeyCount) ||
+		!readArray(file, joint->RotationKeys, header.RotationKeyCount))
+		return false;
+
+	core::array<u16> bufferIds;
+	core::array<u32> vertexIds;
+	core::array<f32> strengths;
+	if (!readArray(file, bufferIds, header.WeightCount) ||
+		!readArray(file, vertexIds, header.WeightCount) ||
+		!readArray(file, strengths, header.WeightCount))
+		return false;
+
+	const core::array<SSkinMeshBuffer*>& buffers = mesh->getMeshBuffers();
+	for (u32 i=0; i<joint->AttachedMeshes.size(); ++i)
+	{
+		if (joint->AttachedMeshes[i] >= buffers.size())
+			return false;
+	}
+
+	joint->Weights.reallocate(header.WeightCount);
+	for (u32 i=0; i<header.WeightCount; ++i)
+	{
+		if (bufferIds[i] >= buffers.size() || vertexIds[i] >= buffers[bufferIds[i]]->getVertexCount())
+			return false;
+
+		ISkinnedMesh::SWeight* weight = mesh->addWeight(joint);
+		weight->buffer_id = bufferIds[i];
+		weight->vertex_id = vertexIds[i];
+		weight->strength = strengths[i];
+	}
+
+	return true;
+}
+
+bool load(io::IReadFile* file, CSkinnedMesh* mesh)
+{
+	SIRBHeader header;
+	if (file->read(&header, sizeof(header)) != sizeof(header) ||
+		header.Magic != IRB_MAGIC)
+		return false;
+
+	if (header.Version != IRB_VERSION ||
+		header.LayoutSizes[0] != sizeof(video::S3DVertex) ||
+		header.LayoutSizes[1] != sizeof(video::S3DVertex2TCoords) ||
+		header.LayoutSizes[2] != sizeof(video::S3DVertexTangents) ||
+		header.LayoutSizes[3] != sizeof(core::quaternion))
+	{
+		os::Printer::log("IRB file was written by another version or platform", file->getFileName(), ELL_WARNING);
+		return false;
+	}
+
+	mesh->setAnimationSpeed(header.FramesPerSecond);
+
+	for (u32 i=0; i<header.BufferCount; ++i)
+	{
+		if (!readBuffer(file, mesh->addMeshBuffer()))
+			return false;
+	}
+
+	// the joints are linked once all exist, the parents may come later
+	core::array<s32> parents;
+	parents.set_used(header.JointCount);
+	for (u32 i=0; i<header.JointCount; ++i)
+	{
+		if (!readJoint(file, mesh, mesh->addJoint(0), parents[i]))
+			return false;
+	}
+
+	core::array<ISkinnedMesh::SJoint*>& joints = mesh->getAllJoints();
+	for (u32 i=0; i<joints.size(); ++i)
+	{
+		if (parents[i] < -1 || parents[i] >= (s32)joints.size() || parents[i] == (s32)i)
+			return false;
+		if (parents[i] != -1)
+			joints[parents[i]]->Children.push_back(joints[i]);
+	}
+
+	return true;
+}
+
+} // end anonymous namespace
+
+
+//! Constructor
+CIRBMeshFileLoader::CIRBMeshFileLoader()
+{
+	#ifdef _DEBUG
+	setDebugName("CIRBMeshFileLoader");
+	#endif
+}
+
+
+//! returns true if the file maybe is able to be loaded by this class
+//! based on the file extension (e.g. ".bsp")
+bool CIRBMeshFileLoader::isALoadableFileExtension(const io::path& filename) const
+{
+	return core::hasFileExtension ( filename, "irrbm" );
+}
+
+
+//! creates/loads an animated mesh from the file.
+//! \return Pointer to the created mesh. Returns 0 if loading failed.
+//! If you no longer need the mesh, you should call IAnimatedMesh::drop().
+//! See IReferenceCounted::drop() for more information.
+IAnimatedMesh* CIRBMeshFileLoader::createMesh(io::IReadFile* file)
+{
+	if (!file)
+		return 0;
+
+	CSkinnedMesh* mesh = new CSkinnedMesh();
+	if (!load(file, mesh))
+	{
+		mesh->drop();
+		return 0;
+	}
+
+	// the keys are sorted and the inverse matrices are there already, which finalize() keeps
+	mesh->finalize();
+	return mesh;
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,36 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IRB_MESH_FILE_LOADER_H_INCLUDED__
+#define __C_IRB_MESH_FILE_LOADER_H_INCLUDED__
+
+#include "IMeshLoader.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Meshloader for the binary .irrbm skinned mesh caches, see SIRBStructs.h
+class CIRBMeshFileLoader : public IMeshLoader
+{
+public:
+
+	//! Constructor
+	CIRBMeshFileLoader();
+
+	//! returns true if the file maybe is able to be loaded by this class
+	//! based on the file extension (e.g. ".bsp")
+	bool isALoadableFileExtension(const io::path& filename) const override;
+
+	//! creates/loads an animated mesh from the file.
+	//! \return Pointer to the created mesh. Returns 0 if loading failed.
+	//! If you no longer need the mesh, you should call IAnimatedMesh::drop().
+	//! See IReferenceCounted::drop() for more information.
+	IAnimatedMesh* createMesh(io::IReadFile* file) override;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -0,0 +1,193 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CIRBMeshWriter.h"
+#include "SIRBStructs.h"
+#include "ISkinnedMesh.h"
+#include "IWriteFile.h"
+#include "os.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+
+template <class T>
+bool writeArray(io::IWriteFile* file, const core::array<T>& array)
+{
+	const size_t size = array.size() * sizeof(T);
+	return size == 0 || file->write(array.const_pointer(), size) == size;
+}
+
+void writeMaterial(SIRBMaterial& out, const video::SMaterial& material)
+{
+	out.MaterialType = material.MaterialType;
+	out.MaterialTypeParam = material.MaterialTypeParam;
+	out.AmbientColor = material.AmbientColor.color;
+	out.DiffuseColor = material.DiffuseColor.color;
+	out.SpecularColor = material.SpecularColor.color;
+	out.EmissiveColor = material.EmissiveColor.color;
+	out.Shininess = material.Shininess;
+	out.ColorMaterial = material.ColorMaterial;
+	out.ZWriteEnable = material.ZWriteEnable;
+	out.Flags = (material.Wireframe ? EIRBMF_WIREFRAME : 0) |
+		(material.GouraudShading ? EIRBMF_GOURAUD_SHADING : 0) |
+		(material.Lighting ? EIRBMF_LIGHTING : 0) |
+		(material.BackfaceCulling ? EIRBMF_BACKFACE_CULLING : 0) |
+		(material.FrontfaceCulling ? EIRBMF_FRONTFACE_CULLING : 0) |
+		(material.FogEnable ? EIRBMF_FOG_ENABLE : 0) |
+		(material.NormalizeNormals ? EIRBMF_NORMALIZE_NORMALS : 0);
+	out.Padding = 0;
+}
+
+bool writeBuffer(io::IWriteFile* file, const SSkinMeshBuffer* buffer)
+{
+	SIRBBufferHeader header;
+	// the joint data of hardware skinning is rebuilt when it is enabled again
+	header.VertexType = buffer->VertexType == video::EVT_SKINNED ? video::EVT_STANDARD : buffer->VertexType;
+	header.VertexCount = buffer->getVertexCount();
+	header.IndexCount = buffer->Indices.size();
+	header.PrimitiveType = buffer->PrimitiveType;
+	writeMaterial(header.Material, buffer->Material);
+	memcpy(header.Transformation, buffer->Transformation.pointer(), sizeof(header.Transformation));
+
+	if (file->write(&header, sizeof(header)) != sizeof(header))
+		return false;
+
+	bool ok;
+	if (buffer->VertexType == video::EVT_SKINNED)
+	{
+		ok = true;
+		for (u32 i=0; i<header.VertexCount && ok; ++i)
+			ok = file->write(buffer->getVertex(i), sizeof(video::S3DVertex)) == sizeof(video::S3DVertex);
+	}
+	else
+		ok = writeArray(file, buffer->Vertices);
+
+	return ok && writeArray(file, buffer->Indices);
+}
+
+bool writeJoint(io::IWriteFile* file, const ISkinnedMesh::SJoint* joint, s32 parent)
+{
+	SIRBJointHeader header;
+	header.Parent = parent;
+	header.NameLength = joint->Name.size();
+	memcpy(header.LocalMatrix, joint->LocalMatrix.pointer(), sizeof(header.LocalMatrix));
+	memcpy(header.GlobalInversedMatrix, joint->GlobalInversedMatrix.pointer(), sizeof(header.GlobalInversedMatrix));
+	header.AttachedMeshCount = joint->AttachedMeshes.size();
+	header.PositionKeyCount = joint->PositionKeys.size();
+	header.ScaleKeyCount = joint->ScaleKeys.size();
+	header.RotationKeyCount = joint->RotationKeys.size();
+	header.WeightCount = joint->Weights.size();
+
+	if (file->write(&header, sizeof(header)) != sizeof(header))
+		return false;
+	if (header.NameLength && file->write(joint->Name.c_str(), header.NameLength) != header.NameLength)
+		return false;
+
+	if (!writeArray(file, joint->AttachedMeshes) ||
+		!writeArray(file, joint->PositionKeys) ||
+		!writeArray(file, joint->ScaleKeys) ||
+		!writeArray(file, joint->RotationKeys))
+		return false;
+
+	// the weights have internal members, so their fields are written one array after another
+	const u32 count = joint->Weights.size();
+	core::array<u16> bufferIds(count);
+	core::array<u32> vertexIds(count);
+	core::array<f32> strengths(count);
+	for (u32 i=0; i<count; ++i)
+	{
+		bufferIds.push_back(joint->Weights[i].buffer_id);
+		vertexIds.push_back(joint->Weights[i].vertex_id);
+		strengths.push_back(joint->Weights[i].strength);
+	}
+
+	return writeArray(file, bufferIds) && writeArray(file, vertexIds) && writeArray(file, strengths);
+}
+
+} // end anonymous namespace
+
+
+CIRBMeshWriter::CIRBMeshWriter()
+{
+	#ifdef _DEBUG
+	setDebugName("CIRBMeshWriter");
+	#endif
+}
+
+
+//! Returns the type of the mesh writer
+EMESH_WRITER_TYPE CIRBMeshWriter::getType() const
+{
+	return EMWT_IRB;
+}
+
+
+//! writes a mesh, only skinned meshes are supported
+bool CIRBMeshWriter::writeMesh(io::IWriteFile* file, IMesh* mesh, s32 flags)
+{
+	if (!file || !mesh)
+		return false;
+
+	if (mesh->getMeshType() != EAMT_SKINNED)
+	{
+		os::Printer::log("IRB export only supports skinned meshes", file->getFileName(), ELL_ERROR);
+		return false;
+	}
+
+	ISkinnedMesh* skinnedMesh = static_cast<ISkinnedMesh*>(mesh);
+	// software skinning writes into the vertices, the file has the bind pose
+	skinnedMesh->resetAnimation();
+
+	const core::array<SSkinMeshBuffer*>& buffers = skinnedMesh->getMeshBuffers();
+	const core::array<ISkinnedMesh::SJoint*>& joints = skinnedMesh->getAllJoints();
+
+	SIRBHeader header;
+	header.Magic = IRB_MAGIC;
+	header.Version = IRB_VERSION;
+	header.LayoutSizes[0] = (u8)sizeof(video::S3DVertex);
+	header.LayoutSizes[1] = (u8)sizeof(video::S3DVertex2TCoords);
+	header.LayoutSizes[2] = (u8)sizeof(video::S3DVertexTangents);
+	header.LayoutSizes[3] = (u8)sizeof(core::quaternion);
+	header.FramesPerSecond = skinnedMesh->getAnimationSpeed();
+	header.BufferCount = buffers.size();
+	header.JointCount = joints.size();
+
+	if (file->write(&header, sizeof(header)) != sizeof(header))
+		return false;
+
+	for (u32 i=0; i<buffers.size(); ++i)
+	{
+		if (!writeBuffer(file, buffers[i]))
+			return false;
+	}
+
+	core::array<s32> parents;
+	parents.set_used(joints.size());
+	for (u32 i=0; i<joints.size(); ++i)
+		parents[i] = -1;
+	for (u32 i=0; i<joints.size(); ++i)
+	{
+		for (u32 c=0; c<joints[i]->Children.size(); ++c)
+		{
+			const s32 child = joints.linear_search(joints[i]->Children[c]);
+			if (child != -1)
+				parents[child] = (s32)i;
+		}
+	}
+
+	for (u32 i=0; i<joints.size(); ++i)
+	{
+		if (!writeJoint(file, joints[i], parents[i]))
+			return false;
+	}
+
+	return true;
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,32 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IRB_MESH_WRITER_H_INCLUDED__
+#define __C_IRB_MESH_WRITER_H_INCLUDED__
+
+#include "IMeshWriter.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! class to write finalized skinned meshes into binary .irrbm files, see SIRBStructs.h
+class CIRBMeshWriter : public IMeshWriter
+{
+public:
+
+	CIRBMeshWriter();
+
+	//! Returns the type of the mesh writer
+	EMESH_WRITER_TYPE getType() const override;
+
+	//! writes a mesh, only skinned meshes are supported
+	/** Resets the animation of the mesh, to write the vertices in the bind pose. */
+	bool writeMesh(io::IWriteFile* file, scene::IMesh* mesh, s32 flags=EMWF_NONE) override;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
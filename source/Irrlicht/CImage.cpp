@@ -6,6 +6,7 @@
 #include "irrString.h"
 #include "CColorConverter.h"
 #include "CBlit.h"
+#include "CImageResampler.h"
 #include "os.h"
 #include "SoftwareDriver2_helper.h"
 
@@ -14,30 +15,165 @@ namespace irr
 namespace video
 {
 
+namespace
+{
+
+//! Copies the pixels at the offsets of a row next to each other
+template <u32 N>
+void gatherPixels(const u8* row, const u32* offsets, u32 count, u8* out)
+{
+	for (u32 x=0; x<count; ++x, out+=N)
+		memcpy(out, row + offsets[x], N);
+}
+
+//! Counts the A8R8G8B8 pixels of each alpha value
+void getAlphaHistogram(const u8* data, u32 pixels, u32* histogram)
+{
+	memset(histogram, 0, 256 * sizeof(u32));
+	for (u32 i=0; i<pixels; ++i)
+		++histogram[data[i*4 + 3]];
+}
+
+//! Counts the pixels passing the alpha test after scaling their alpha
+u32 getAlphaCoverage(const u32* histogram, f32 scale, f32 reference)
+{
+	u32 covered = 0;
+	for (u32 a=0; a<256; ++a)
+	{
+		if (core::min_(a * scale, 255.f) > reference)
+			covered += histogram[a];
+	}
+	return covered;
+}
+
+//! Scales the alpha of A8R8G8B8 pixels until the share passing the alpha test matches coverage
+void preserveAlphaCoverage(u8* data, u32 pixels, f32 coverage, f32 reference)
+{
+	u32 histogram[256];
+	getAlphaHistogram(data, pixels, histogram);
+
+	// the coverage grows with the scale, so it is found by bisection
+	const s32 wanted = core::round32(coverage * pixels);
+	f32 low = 0.f;
+	f32 high = 255.f;
+	for (u32 i=0; i<24; ++i)
+	{
+		const f32 mid = (low + high) * 0.5f;
+		if ((s32)getAlphaCoverage(histogram, mid, reference) < wanted)
+			low = mid;
+		else
+			high = mid;
+	}
+	const s32 lowError = core::abs_((s32)getAlphaCoverage(histogram, low, reference) - wanted);
+	const s32 highError = core::abs_((s32)getAlphaCoverage(histogram, high, reference) - wanted);
+	const f32 scale = lowError < highError ? low : high;
+
+	u8 table[256];
+	for (u32 a=0; a<256; ++a)
+		table[a] = (u8)core::min_(a * scale + 0.5f, 255.f);
+	for (u32 i=0; i<pixels; ++i)
+		data[i*4 + 3] = table[data[i*4 + 3]];
+}
+
+//! Sets all pixels of an image to one color
+template <ECOLOR_FORMAT format>
+void fillRows(const IImage* image, const SColor& color)
+{
+	typedef typename SColorFormatPixel<format>::Type Pixel;
+
+	const core::dimension2d<u32>& size = image->getDimension();
+	if (size.Height == 0)
+		return;
+
+	// write the first row, then copy it to the others
+	const Pixel pixel = SColorFormatPixel<format>::fromColor(color);
+	Pixel* first = image->template getRow<format>(0);
+	for (u32 x=0; x<size.Width; ++x)
+		first[x] = pixel;
+
+	for (u32 y=1; y<size.Height; ++y)
+		memcpy(image->template getRow<format>(y), first, size.Width * sizeof(Pixel));
+}
+
+//! Adds up the channels of the pixels in a box, clamped to the image
+template <ECOLOR_FORMAT format>
+void sumPixelBox(const IImage* image, s32 x, s32 y, s32 fx, s32 fy, s32& a, s32& r, s32& g, s32& b)
+{
+	const s32 maxX = image->getDimension().Width - 1;
+	const s32 maxY = image->getDimension().Height - 1;
+
+	for ( s32 dy = 0; dy != fy; ++dy )
+	{
+		const typename SColorFormatPixel<format>::Type* row = image->template getRow<format>(core::s32_min(y + dy, maxY));
+
+		for ( s32 dx = 0; dx != fx; ++dx )
+		{
+			const SColor c = SColorFormatPixel<format>::toColor(row[core::s32_min(x + dx, maxX)]);
+
+			a += c.getAlpha();
+			r += c.getRed();
+			g += c.getGreen();
+			b += c.getBlue();
+		}
+	}
+}
+
+} // end anonymous namespace
+
+
 //! Constructor from raw data
 CImage::CImage(ECOLOR_FORMAT format, const core::dimension2d<u32>& size, void* data,
-	bool ownForeignMemory, bool deleteMemory) : IImage(format, size, deleteMemory)
+	bool ownForeignMemory, bool deleteMemory) : IImage(format, size, deleteMemory),
+	DataSize(0), AllocatedData(false)
 {
 	if (ownForeignMemory)
 	{
 		Data = (u8*)data;
+
+		// memory given to the image still counts towards images
+		if (DeleteMemory)
+		{
+			DataSize = getDataSizeFromFormat(Format, Size.Width, Size.Height);
+			core::trackMemory((s64)DataSize, core::EMC_IMAGE);
+		}
 	}
 	else
 	{
-		const u32 dataSize = getDataSizeFromFormat(Format, Size.Width, Size.Height);
-
-		Data = new u8[align_next(dataSize,16)];
-		memcpy(Data, data, dataSize);
-		DeleteMemory = true;
+		allocateData();
+		memcpy(Data, data, getDataSizeFromFormat(Format, Size.Width, Size.Height));
 	}
 }
 
 
 //! Constructor of empty image
-CImage::CImage(ECOLOR_FORMAT format, const core::dimension2d<u32>& size) : IImage(format, size, true)
+CImage::CImage(ECOLOR_FORMAT format, const core::dimension2d<u32>& size) : IImage(format, size, true),
+	DataSize(0), AllocatedData(false)
 {
-	Data = new u8[align_next(getDataSizeFromFormat(Format, Size.Width, Size.Height),16)];
-	DeleteMemory = true;
+	allocateData();
+}
+
+
+CImage::~CImage()
+{
+	if (AllocatedData)
+	{
+		core::deallocateMemory(Data, DataSize, core::EMC_IMAGE);
+		Data = 0;
+	}
+	else if (DataSize && DeleteMemory)
+	{
+		core::trackMemory(-(s64)DataSize, core::EMC_IMAGE);
+	}
+}
+
+
+void CImage::allocateData()
+{
+	DataSize = align_next(getDataSizeFromFormat(Format, Size.Width, Size.Height), 16);
+	Data = static_cast<u8*>(core::allocateMemory(DataSize, core::EMC_IMAGE));
+	AllocatedData = true;
+	// the base class would free it with delete[]
+	DeleteMemory = false;
 }
 
 
@@ -174,7 +310,6 @@ void CImage::copyToWithAlpha(IImage* target, const core::position2d<s32>& pos, c
 
 
 //! copies this surface into another, scaling it to the target image size
-// note: this is very very slow.
 void CImage::copyToScaling(void* target, u32 width, u32 height, ECOLOR_FORMAT format, u32 pitch)
 {
 	if (IImage::isCompressedFormat(Format))
@@ -242,25 +377,50 @@ void CImage::copyToScaling(void* target, u32 width, u32 height, ECOLOR_FORMAT fo
 		sourceYStart = 0.5f;	// for rounding to nearest pixel
 	}
 
-	s32 yval=0, syval=0;
+	// the source pixels of a row are the same for all rows
+	core::array<u32> offsets;
+	offsets.set_used(width);
+	f32 sx = sourceXStart;
+	for (u32 x=0; x<width; ++x)
+	{
+		offsets[x] = (u32)sx*BytesPerPixel;
+		sx+=sourceXStep;
+	}
+
+	// rows are gathered in the source format and converted at once
+	core::array<u8> row;
+	if (Format != format)
+		row.set_used(width*BytesPerPixel);
+
+	u8* tgtpos = (u8*)target;
 	f32 sy = sourceYStart;
 	for (u32 y=0; y<height; ++y)
 	{
-		f32 sx = sourceXStart;
-		for (u32 x=0; x<width; ++x)
+		const u8* srcpos = Data + (size_t)((u32)sy)*Pitch;
+		u8* out = Format == format ? tgtpos : row.pointer();
+		switch (BytesPerPixel)
 		{
-			CColorConverter::convert_viaFormat(Data+ syval + ((s32)sx)*BytesPerPixel, Format, 1, ((u8*)target)+ yval + (x*bpp), format);
-			sx+=sourceXStep;
+		case 1: gatherPixels<1>(srcpos, offsets.const_pointer(), width, out); break;
+		case 2: gatherPixels<2>(srcpos, offsets.const_pointer(), width, out); break;
+		case 3: gatherPixels<3>(srcpos, offsets.const_pointer(), width, out); break;
+		case 4: gatherPixels<4>(srcpos, offsets.const_pointer(), width, out); break;
+		case 8: gatherPixels<8>(srcpos, offsets.const_pointer(), width, out); break;
+		case 16: gatherPixels<16>(srcpos, offsets.const_pointer(), width, out); break;
+		default:
+			for (u32 x=0; x<width; ++x)
+				memcpy(out + x*BytesPerPixel, srcpos + offsets[x], BytesPerPixel);
+			break;
 		}
+		if (Format != format)
+			CColorConverter::convert_viaFormat(row.const_pointer(), Format, width, tgtpos, format);
+
 		sy+=sourceYStep;
-		syval=(s32)(sy)*Pitch;
-		yval+=pitch;
+		tgtpos+=pitch;
 	}
 }
 
 
 //! copies this surface into another, scaling it to the target image size
-// note: this is very very slow.
 void CImage::copyToScaling(IImage* target)
 {
 	if (IImage::isCompressedFormat(Format))
@@ -295,6 +455,12 @@ void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 
 	const core::dimension2d<u32> destSize = target->getDimension();
 
+	// the resampler is much faster and handles all uncompressed formats,
+	// it only lacks the bias and blending
+	if (bias == 0 && !blend && resampleImage(Data, Format, Size, Pitch,
+		(u8*)target->getData(), target->getColorFormat(), destSize, target->getPitch(), EISF_BOX))
+		return;
+
 	const f32 sourceXStep = (f32) Size.Width / (f32) destSize.Width;
 	const f32 sourceYStep = (f32) Size.Height / (f32) destSize.Height;
 
@@ -318,6 +484,78 @@ void CImage::copyToScalingBoxFilter(IImage* target, s32 bias, bool blend)
 }
 
 
+//! copies this surface into another, resampling it to fit with a filter
+bool CImage::copyToScalingFiltered(IImage* target, E_IMAGE_SCALING_FILTER filter)
+{
+	if (IImage::isCompressedFormat(Format))
+	{
+		os::Printer::log("IImage::copyToScalingFiltered method doesn't work with compressed images.", ELL_WARNING);
+		return false;
+	}
+
+	if (!target)
+		return false;
+
+	return resampleImage(Data, Format, Size, Pitch, (u8*)target->getData(), target->getColorFormat(),
+		target->getDimension(), target->getPitch(), filter);
+}
+
+
+//! Replaces the mipmaps by ones box filtered from the image on the CPU
+bool CImage::createMipMaps(u32 flags, f32 alphaReference)
+{
+	if (IImage::isCompressedFormat(Format) || !isResampleFormat(Format) || (Size.Width <= 1 && Size.Height <= 1))
+		return false;
+
+	u32 dataSize = 0;
+	u32 levelCount = 1;
+	for (core::dimension2d<u32> level = Size; level.Width > 1 || level.Height > 1; ++levelCount)
+	{
+		level = getMipMapsSize(level, 1);
+		dataSize += getDataSizeFromFormat(Format, level.Width, level.Height);
+	}
+
+	const bool coverage = (flags & EMMF_PRESERVE_ALPHA_COVERAGE) && Format == ECF_A8R8G8B8;
+	const f32 reference = core::clamp(alphaReference, 0.f, 1.f) * 255.f;
+	f32 baseCoverage = 0.f;
+	if (coverage)
+	{
+		u32 histogram[256];
+		getAlphaHistogram(Data, Size.getArea(), histogram);
+		baseCoverage = (f32)getAlphaCoverage(histogram, 1.f, reference) / Size.getArea();
+	}
+
+	u8* data = new u8[dataSize];
+	const u8* source = Data;
+	core::dimension2d<u32> sourceSize = Size;
+	u32 sourcePitch = Pitch;
+	u8* target = data;
+
+	for (u32 i=1; i<levelCount; ++i)
+	{
+		const core::dimension2d<u32> targetSize = getMipMapsSize(sourceSize, 1);
+		const u32 targetPitch = targetSize.Width * BytesPerPixel;
+
+		resampleImage(source, Format, sourceSize, sourcePitch, target, Format, targetSize, targetPitch,
+			EISF_BOX, (flags & EMMF_SRGB) != 0);
+		if (coverage)
+			preserveAlphaCoverage(target, targetSize.getArea(), baseCoverage, reference);
+
+		source = target;
+		sourceSize = targetSize;
+		sourcePitch = targetPitch;
+		target += getDataSizeFromFormat(Format, targetSize.Width, targetSize.Height);
+	}
+
+	// the image takes the new levels over
+	setMipMapsData(0, false);
+	MipMapsData = data;
+	DeleteMipMapsMemory = true;
+
+	return true;
+}
+
+
 //! fills the surface with given color
 void CImage::fill(const SColor &color)
 {
@@ -327,38 +565,24 @@ void CImage::fill(const SColor &color)
 		return;
 	}
 
-	u32 c;
-
 	switch ( Format )
 	{
 		case ECF_A1R5G5B5:
-			c = color.toA1R5G5B5();
-			c |= c << 16;
+			fillRows<ECF_A1R5G5B5>(this, color);
 			break;
 		case ECF_R5G6B5:
-			c = video::A8R8G8B8toR5G6B5( color.color );
-			c |= c << 16;
+			fillRows<ECF_R5G6B5>(this, color);
 			break;
 		case ECF_A8R8G8B8:
-			c = color.color;
+			fillRows<ECF_A8R8G8B8>(this, color);
 			break;
 		case ECF_R8G8B8:
-		{
-			u8 rgb[3];
-			CColorConverter::convert_A8R8G8B8toR8G8B8(&color, 1, rgb);
-			const u32 size = getImageDataSizeInBytes();
-			for (u32 i=0; i<size; i+=3)
-			{
-				memcpy(Data+i, rgb, 3);
-			}
-			return;
-		}
-		break;
+			fillRows<ECF_R8G8B8>(this, color);
+			break;
 		default:
 		// TODO: Handle other formats
-			return;
+			break;
 	}
-	memset32( Data, c, getImageDataSizeInBytes() );
 }
 
 
@@ -374,20 +598,22 @@ inline SColor CImage::getPixelBox( s32 x, s32 y, s32 fx, s32 fy, s32 bias ) cons
 	SColor c;
 	s32 a = 0, r = 0, g = 0, b = 0;
 
-	for ( s32 dx = 0; dx != fx; ++dx )
+	switch ( Format )
 	{
-		for ( s32 dy = 0; dy != fy; ++dy )
-		{
-			c = getPixel(	core::s32_min ( x + dx, Size.Width - 1 ) ,
-							core::s32_min ( y + dy, Size.Height - 1 )
-						);
-
-			a += c.getAlpha();
-			r += c.getRed();
-			g += c.getGreen();
-			b += c.getBlue();
-		}
-
+		case ECF_A1R5G5B5:
+			sumPixelBox<ECF_A1R5G5B5>(this, x, y, fx, fy, a, r, g, b);
+			break;
+		case ECF_R5G6B5:
+			sumPixelBox<ECF_R5G6B5>(this, x, y, fx, fy, a, r, g, b);
+			break;
+		case ECF_A8R8G8B8:
+			sumPixelBox<ECF_A8R8G8B8>(this, x, y, fx, fy, a, r, g, b);
+			break;
+		case ECF_R8G8B8:
+			sumPixelBox<ECF_R8G8B8>(this, x, y, fx, fy, a, r, g, b);
+			break;
+		default:
+			break;
 	}
 
 	s32 sdiv = s32_log2_s32(fx * fy);
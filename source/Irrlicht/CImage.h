@@ -36,6 +36,9 @@ public:
 	//! constructor for empty image
 	CImage(ECOLOR_FORMAT format, const core::dimension2d<u32>& size);
 
+	//! destructor
+	virtual ~CImage();
+
 	//! returns a pixel
 	SColor getPixel(u32 x, u32 y) const override;
 
@@ -62,11 +65,25 @@ public:
 	//! copies this surface into another, scaling it to fit, applying a box filter
 	void copyToScalingBoxFilter(IImage* target, s32 bias = 0, bool blend = false) override;
 
+	//! copies this surface into another, resampling it to fit with a filter
+	bool copyToScalingFiltered(IImage* target, E_IMAGE_SCALING_FILTER filter = EISF_BILINEAR) override;
+
+	//! Replaces the mipmaps by ones box filtered from the image on the CPU
+	bool createMipMaps(u32 flags = 0, f32 alphaReference = 0.5f) override;
+
 	//! fills the surface with given color
 	void fill(const SColor &color) override;
 
 private:
 	inline SColor getPixelBox ( s32 x, s32 y, s32 fx, s32 fy, s32 bias ) const;
+
+	//! Allocates Data from the image memory category
+	void allocateData();
+
+	//! Bytes of Data accounted to the image memory category, 0 if not owned
+	size_t DataSize;
+	//! Data comes from allocateData rather than the caller
+	bool AllocatedData;
 };
 
 } // end namespace video
@@ -0,0 +1,203 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CImageLoaderDDS.h"
+
+#include "IReadFile.h"
+#include "os.h"
+#include "CImage.h"
+#include "irrString.h"
+
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	const u32 DDS_MAGIC = 0x20534444; // "DDS "
+
+	const u32 DDSD_MIPMAPCOUNT = 0x20000;
+	const u32 DDPF_FOURCC = 0x4;
+	const u32 DDSCAPS2_CUBEMAP = 0x200;
+	const u32 DDSCAPS2_VOLUME = 0x200000;
+
+	const u32 DDS_DIMENSION_TEXTURE2D = 3;
+
+	u32 makeFourCC(c8 a, c8 b, c8 c, c8 d)
+	{
+		return (u32)(u8)a | ((u32)(u8)b << 8) | ((u32)(u8)c << 16) | ((u32)(u8)d << 24);
+	}
+
+	ECOLOR_FORMAT getFormatFromDXGI(u32 dxgiFormat)
+	{
+		switch (dxgiFormat)
+		{
+		case 71: // DXGI_FORMAT_BC1_UNORM
+		case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+			return ECF_DXT1;
+		case 74: // DXGI_FORMAT_BC2_UNORM
+		case 75: // DXGI_FORMAT_BC2_UNORM_SRGB
+			return ECF_DXT3;
+		case 77: // DXGI_FORMAT_BC3_UNORM
+		case 78: // DXGI_FORMAT_BC3_UNORM_SRGB
+			return ECF_DXT5;
+		case 98: // DXGI_FORMAT_BC7_UNORM
+		case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+			return ECF_BC7;
+		default:
+			return ECF_UNKNOWN;
+		}
+	}
+
+	void byteswapWords(void* data, u32 size)
+	{
+#ifdef __BIG_ENDIAN__
+		u32* words = static_cast<u32*>(data);
+		for (u32 i = 0; i < size / 4; ++i)
+			words[i] = os::Byteswap::byteswap(words[i]);
+#endif
+	}
+}
+
+
+//! returns true if the file maybe is able to be loaded by this class
+//! based on the file extension (e.g. ".dds")
+bool CImageLoaderDDS::isALoadableFileExtension(const io::path& filename) const
+{
+	return core::hasFileExtension(filename, "dds");
+}
+
+
+//! returns true if the file maybe is able to be loaded by this class
+bool CImageLoaderDDS::isALoadableFileFormat(io::IReadFile* file) const
+{
+	if (!file)
+		return false;
+
+	u32 magic = 0;
+	file->read(&magic, sizeof(u32));
+	byteswapWords(&magic, sizeof(u32));
+	return magic == DDS_MAGIC;
+}
+
+
+//! creates a surface from the file
+IImage* CImageLoaderDDS::loadImage(io::IReadFile* file) const
+{
+	u32 magic = 0;
+	SDDSHeader header;
+	if (file->read(&magic, sizeof(u32)) != sizeof(u32) ||
+		file->read(&header, sizeof(SDDSHeader)) != sizeof(SDDSHeader))
+	{
+		os::Printer::log("DDS file is too short", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	byteswapWords(&magic, sizeof(u32));
+	byteswapWords(&header, sizeof(SDDSHeader));
+
+	if (magic != DDS_MAGIC || header.Size != sizeof(SDDSHeader) || header.PixelFormat.Size != sizeof(SDDSPixelFormat))
+	{
+		os::Printer::log("Invalid DDS header", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	if (header.Caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))
+	{
+		os::Printer::log("DDS cube maps and volume textures are not supported", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	ECOLOR_FORMAT format = ECF_UNKNOWN;
+
+	if (header.PixelFormat.Flags & DDPF_FOURCC)
+	{
+		const u32 fourCC = header.PixelFormat.FourCC;
+
+		if (fourCC == makeFourCC('D', 'X', 'T', '1'))
+			format = ECF_DXT1;
+		else if (fourCC == makeFourCC('D', 'X', 'T', '2'))
+			format = ECF_DXT2;
+		else if (fourCC == makeFourCC('D', 'X', 'T', '3'))
+			format = ECF_DXT3;
+		else if (fourCC == makeFourCC('D', 'X', 'T', '4'))
+			format = ECF_DXT4;
+		else if (fourCC == makeFourCC('D', 'X', 'T', '5'))
+			format = ECF_DXT5;
+		else if (fourCC == makeFourCC('D', 'X', '1', '0'))
+		{
+			SDDSHeaderDX10 headerDX10;
+			if (file->read(&headerDX10, sizeof(SDDSHeaderDX10)) != sizeof(SDDSHeaderDX10))
+			{
+				os::Printer::log("DDS file is too short", file->getFileName(), ELL_ERROR);
+				return 0;
+			}
+
+			byteswapWords(&headerDX10, sizeof(SDDSHeaderDX10));
+
+			if (headerDX10.ResourceDimension == DDS_DIMENSION_TEXTURE2D && headerDX10.ArraySize <= 1)
+				format = getFormatFromDXGI(headerDX10.DXGIFormat);
+		}
+	}
+
+	if (format == ECF_UNKNOWN)
+	{
+		os::Printer::log("Unsupported DDS format", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	if (header.Width == 0 || header.Height == 0 || !checkImageDimensions(header.Width, header.Height))
+	{
+		os::Printer::log("Image dimensions too large in file", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	const core::dimension2d<u32> size(header.Width, header.Height);
+	const u32 dataSize = IImage::getDataSizeFromFormat(format, size.Width, size.Height);
+
+	u8* data = new u8[dataSize];
+	if (file->read(data, dataSize) != (size_t)dataSize)
+	{
+		os::Printer::log("DDS file is too short", file->getFileName(), ELL_ERROR);
+		delete [] data;
+		return 0;
+	}
+
+	IImage* image = new CImage(format, size, data, true, true);
+
+	// images can only hold complete mipmap chains
+	u32 mipMapCount = 1;
+	u32 mipMapsSize = 0;
+	for (core::dimension2d<u32> mipSize = size; mipSize.Width > 1 || mipSize.Height > 1; ++mipMapCount)
+	{
+		mipSize.Width = core::max_<u32>(mipSize.Width >> 1, 1);
+		mipSize.Height = core::max_<u32>(mipSize.Height >> 1, 1);
+		mipMapsSize += IImage::getDataSizeFromFormat(format, mipSize.Width, mipSize.Height);
+	}
+
+	if ((header.Flags & DDSD_MIPMAPCOUNT) && header.MipMapCount == mipMapCount && mipMapsSize > 0)
+	{
+		u8* mipMapsData = new u8[mipMapsSize];
+		if (file->read(mipMapsData, mipMapsSize) == (size_t)mipMapsSize)
+			image->setMipMapsData(mipMapsData, false);
+		else
+			os::Printer::log("DDS file is too short, mipmaps skipped", file->getFileName(), ELL_WARNING);
+
+		delete [] mipMapsData;
+	}
+
+	return image;
+}
+
+
+//! creates a loader which is able to load dds images
+IImageLoader* createImageLoaderDDS()
+{
+	return new CImageLoaderDDS();
+}
+
+
+} // end namespace video
+} // end namespace irr
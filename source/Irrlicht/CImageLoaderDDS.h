@@ -0,0 +1,85 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IMAGE_LOADER_DDS_H_INCLUDED__
+#define __C_IMAGE_LOADER_DDS_H_INCLUDED__
+
+
+#include "IImageLoader.h"
+
+
+namespace irr
+{
+namespace video
+{
+
+// byte-align structures
+#include "irrpack.h"
+
+	struct SDDSPixelFormat
+	{
+		u32 Size;
+		u32 Flags;
+		u32 FourCC;
+		u32 RGBBitCount;
+		u32 RBitMask;
+		u32 GBitMask;
+		u32 BBitMask;
+		u32 ABitMask;
+	} PACK_STRUCT;
+
+	struct SDDSHeader
+	{
+		u32 Size;
+		u32 Flags;
+		u32 Height;
+		u32 Width;
+		u32 PitchOrLinearSize;
+		u32 Depth;
+		u32 MipMapCount;
+		u32 Reserved1[11];
+		SDDSPixelFormat PixelFormat;
+		u32 Caps;
+		u32 Caps2;
+		u32 Caps3;
+		u32 Caps4;
+		u32 Reserved2;
+	} PACK_STRUCT;
+
+	//! Follows the header if the FourCC is "DX10"
+	struct SDDSHeaderDX10
+	{
+		u32 DXGIFormat;
+		u32 ResourceDimension;
+		u32 MiscFlag;
+		u32 ArraySize;
+		u32 MiscFlags2;
+	} PACK_STRUCT;
+
+// Default alignment
+#include "irrunpack.h"
+
+/*!
+	Surface Loader for block compressed DirectDraw Surfaces
+	Supports 2D textures in the DXT1 (BC1), DXT3 (BC2), DXT5 (BC3) and BC7 formats.
+	The mipmaps are loaded as well if the file contains all of them.
+*/
+class CImageLoaderDDS : public IImageLoader
+{
+public:
+
+	//! returns true if the file maybe is able to be loaded by this class
+	//! based on the file extension (e.g. ".dds")
+	bool isALoadableFileExtension(const io::path& filename) const override;
+
+	//! returns true if the file maybe is able to be loaded by this class
+	bool isALoadableFileFormat(io::IReadFile* file) const override;
+
+	//! creates a surface from the file
+	IImage* loadImage(io::IReadFile* file) const override;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
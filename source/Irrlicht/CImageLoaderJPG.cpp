@@ -6,6 +6,7 @@
 
 #include "IReadFile.h"
 #include "CImage.h"
+#include "CColorConverter.h"
 #include "os.h"
 #include "irrString.h"
 
@@ -38,6 +39,30 @@ bool CImageLoaderJPG::isALoadableFileExtension(const io::path& filename) const
 	return core::hasFileExtension ( filename, "jpg", "jpeg" );
 }
 
+//! Where the rows of a jpeg go, see CImageLoaderJPG::decodeJpeg()
+struct SJpegDecode
+{
+	SJpegDecode() : Data(0), Pitch(0), Format(ECF_UNKNOWN), ScaleDenominator(1),
+		InfoOnly(false), Image(0), Input(0), RowPointers(0), Row(0) {}
+
+	//! rows of the caller, a new ECF_R8G8B8 image is created when 0
+	void* Data;
+	u32 Pitch;
+	ECOLOR_FORMAT Format;
+	u32 ScaleDenominator;
+
+	//! stop after the header
+	bool InfoOnly;
+
+	core::dimension2du Size;
+	IImage* Image;
+
+	// buffers which are freed after errors
+	u8* Input;
+	u8** RowPointers;
+	u8* Row;
+};
+
 // struct for handling jpeg errors
 struct irr_jpeg_error_mgr
 {
@@ -122,17 +147,13 @@ bool CImageLoaderJPG::isALoadableFileFormat(io::IReadFile* file) const
 	return headerLen >= 3 && !memcmp(header, "\xFF\xD8\xFF", 3);
 }
 
-//! creates a surface from the file
-IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
+//! Reads a jpeg file into the memory or image described by decode
+bool CImageLoaderJPG::decodeJpeg(io::IReadFile* file, SJpegDecode& decode)
 {
-	if (!file)
-		return 0;
-
 	core::stringc filename = file->getFileName();
 
-	u8 **rowPtr=0;
-	u8* input = new u8[file->getSize()];
-	file->read(input, file->getSize());
+	decode.Input = new u8[file->getSize()];
+	file->read(decode.Input, file->getSize());
 
 	// allocate and initialize JPEG decompression object
 	struct jpeg_decompress_struct cinfo;
@@ -158,11 +179,18 @@ IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
 
 		jpeg_destroy_decompress(&cinfo);
 
-		delete [] input;
-		delete [] rowPtr;
+		delete [] decode.Input;
+		delete [] decode.RowPointers;
+		delete [] decode.Row;
+		decode.Input = 0;
+		decode.RowPointers = 0;
+		decode.Row = 0;
 
-		// return null pointer
-		return 0;
+		if (decode.Image)
+			decode.Image->drop();
+		decode.Image = 0;
+
+		return false;
 	}
 
 	// Now we can initialize the JPEG decompression object.
@@ -173,7 +201,7 @@ IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
 
 	// Set up data pointer
 	jsrc.bytes_in_buffer = file->getSize();
-	jsrc.next_input_byte = (JOCTET*)input;
+	jsrc.next_input_byte = (JOCTET*)decode.Input;
 	cinfo.src = &jsrc;
 
 	jsrc.init_source = init_source;
@@ -190,88 +218,186 @@ IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
 	// read file parameters with jpeg_read_header()
 	jpeg_read_header(&cinfo, TRUE);
 
-	bool useCMYK=false;
-	if (cinfo.jpeg_color_space==JCS_CMYK)
+	// reject unreasonable sizes
+	if (!checkImageDimensions(cinfo.image_width, cinfo.image_height))
+		longjmp(jerr.setjmp_buffer, 1);
+
+	if (!decode.Data)
+		decode.Format = ECF_R8G8B8;
+
+	// rows which libjpeg can't write in the target format are converted one by one
+	bool convertRows = false;
+	const bool useCMYK = cinfo.jpeg_color_space==JCS_CMYK;
+	if (useCMYK)
 	{
 		cinfo.out_color_space=JCS_CMYK;
 		cinfo.out_color_components=4;
-		useCMYK=true;
+		convertRows = true;
 	}
+#ifdef JCS_ALPHA_EXTENSIONS
+	else if (decode.Format == ECF_A8R8G8B8)
+	{
+		// libjpeg-turbo writes the bytes of A8R8G8B8 itself, with an opaque alpha
+#ifdef __BIG_ENDIAN__
+		cinfo.out_color_space=JCS_EXT_ARGB;
+#else
+		cinfo.out_color_space=JCS_EXT_BGRA;
+#endif
+		cinfo.out_color_components=4;
+	}
+#endif
 	else
 	{
 		cinfo.out_color_space=JCS_RGB;
 		cinfo.out_color_components=3;
+		convertRows = decode.Format != ECF_R8G8B8;
 	}
 	cinfo.output_gamma=2.2;
 	cinfo.do_fancy_upsampling=FALSE;
 
-	// reject unreasonable sizes
-	if (!checkImageDimensions(cinfo.image_width, cinfo.image_height))
+	// the IDCT of reduced sizes skips most of the work
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = decode.ScaleDenominator >= 8 ? 8 : decode.ScaleDenominator >= 4 ? 4 : decode.ScaleDenominator >= 2 ? 2 : 1;
+	jpeg_calc_output_dimensions(&cinfo);
+	decode.Size.set(cinfo.output_width, cinfo.output_height);
+
+	if (decode.InfoOnly)
+	{
+		jpeg_destroy_decompress(&cinfo);
+		delete [] decode.Input;
+		decode.Input = 0;
+		return true;
+	}
+
+	if (decode.Format != ECF_A8R8G8B8 && decode.Format != ECF_R8G8B8)
+	{
+		os::Printer::log("JPEG: Can't decode into color format", ColorFormatNames[decode.Format < ECF_UNKNOWN ? decode.Format : ECF_UNKNOWN], ELL_ERROR);
 		longjmp(jerr.setjmp_buffer, 1);
+	}
 
 	// Start decompressor
 	jpeg_start_decompress(&cinfo);
 
-	// Get image data
-	u32 rowspan = cinfo.image_width * cinfo.out_color_components;
-	u32 width = cinfo.image_width;
-	u32 height = cinfo.image_height;
+	const u32 width = cinfo.output_width;
+	const u32 height = cinfo.output_height;
 
-	// Allocate memory for buffer
-	u8* output = new u8[rowspan * height];
+	u8* data = (u8*)decode.Data;
+	u32 pitch = decode.Pitch;
+	if (!data)
+	{
+		decode.Image = new CImage(decode.Format, decode.Size);
+		data = (u8*)decode.Image->getData();
+		pitch = decode.Image->getPitch();
+	}
 
-	// Here we use the library's state variable cinfo.output_scanline as the
-	// loop counter, so that we don't have to keep track ourselves.
-	// Create array of row pointers for lib
-	rowPtr = new u8* [height];
+	if (!convertRows)
+	{
+		// Here we use the library's state variable cinfo.output_scanline as the
+		// loop counter, so that we don't have to keep track ourselves.
+		// Create array of row pointers for lib, which decodes into the target
+		decode.RowPointers = new u8* [height];
 
-	for( u32 i = 0; i < height; i++ )
-		rowPtr[i] = &output[ i * rowspan ];
+		for( u32 i = 0; i < height; i++ )
+			decode.RowPointers[i] = &data[ i * pitch ];
 
-	u32 rowsRead = 0;
+		while( cinfo.output_scanline < cinfo.output_height )
+			jpeg_read_scanlines( &cinfo, &decode.RowPointers[cinfo.output_scanline], cinfo.output_height - cinfo.output_scanline );
+	}
+	else
+	{
+		decode.Row = new u8[width * cinfo.output_components];
 
-	while( cinfo.output_scanline < cinfo.output_height )
-		rowsRead += jpeg_read_scanlines( &cinfo, &rowPtr[rowsRead], cinfo.output_height - rowsRead );
+		while( cinfo.output_scanline < cinfo.output_height )
+		{
+			u8* out = &data[ cinfo.output_scanline * pitch ];
+			jpeg_read_scanlines( &cinfo, &decode.Row, 1 );
 
-	delete [] rowPtr;
-	// Finish decompression
+			if (useCMYK)
+			{
+				const u8* in = decode.Row;
+				for (u32 x=0; x<width; ++x, in+=4)
+				{
+					// Also works without K, but has more contrast with K multiplied in
+					const u8 r = (u8)(in[2]*(in[3]/255.f));
+					const u8 g = (u8)(in[1]*(in[3]/255.f));
+					const u8 b = (u8)(in[0]*(in[3]/255.f));
+					if (decode.Format == ECF_A8R8G8B8)
+						((u32*)out)[x] = 0xFF000000 | r << 16 | g << 8 | b;
+					else
+					{
+						out[x*3+0] = r;
+						out[x*3+1] = g;
+						out[x*3+2] = b;
+					}
+				}
+			}
+			else
+				CColorConverter::convert_R8G8B8toA8R8G8B8(decode.Row, width, out);
+		}
+	}
 
+	// Finish decompression
 	jpeg_finish_decompress(&cinfo);
 
 	// Release JPEG decompression object
 	// This is an important step since it will release a good deal of memory.
 	jpeg_destroy_decompress(&cinfo);
 
-	// convert image
-	IImage* image = 0;
-	if (useCMYK)
-	{
-		image = new CImage(ECF_R8G8B8,
-				core::dimension2d<u32>(width, height));
-		const u32 size = 3*width*height;
-		u8* data = (u8*)image->getData();
-		if (data)
-		{
-			for (u32 i=0,j=0; i<size; i+=3, j+=4)
-			{
-				// Also works without K, but has more contrast with K multiplied in
-//				data[i+0] = output[j+2];
-//				data[i+1] = output[j+1];
-//				data[i+2] = output[j+0];
-				data[i+0] = (char)(output[j+2]*(output[j+3]/255.f));
-				data[i+1] = (char)(output[j+1]*(output[j+3]/255.f));
-				data[i+2] = (char)(output[j+0]*(output[j+3]/255.f));
-			}
-		}
-		delete [] output;
-	}
-	else
-		image = new CImage(ECF_R8G8B8,
-				core::dimension2d<u32>(width, height), output);
+	delete [] decode.Input;
+	delete [] decode.RowPointers;
+	delete [] decode.Row;
+	decode.Input = 0;
+	decode.RowPointers = 0;
+	decode.Row = 0;
+
+	return true;
+}
+
 
-	delete [] input;
+//! creates a surface from the file
+IImage* CImageLoaderJPG::loadImage(io::IReadFile* file) const
+{
+	if (!file)
+		return 0;
+
+	SJpegDecode decode;
+	if (!decodeJpeg(file, decode))
+		return 0;
+
+	return decode.Image;
+}
+
+
+//! reads the size and color format from the header
+bool CImageLoaderJPG::getImageInfo(io::IReadFile* file, core::dimension2du& size, ECOLOR_FORMAT& format, u32 scaleDenominator) const
+{
+	if (!file)
+		return false;
+
+	SJpegDecode decode;
+	decode.ScaleDenominator = scaleDenominator;
+	decode.InfoOnly = true;
+	if (!decodeJpeg(file, decode))
+		return false;
+
+	size = decode.Size;
+	format = ECF_R8G8B8;
+	return true;
+}
+
+
+//! decodes into memory of the caller
+bool CImageLoaderJPG::loadImageInto(io::IReadFile* file, void* data, u32 pitch, ECOLOR_FORMAT format, u32 scaleDenominator) const
+{
+	if (!file || !data)
+		return false;
 
-	return image;
+	SJpegDecode decode;
+	decode.Data = data;
+	decode.Pitch = pitch;
+	decode.Format = format;
+	decode.ScaleDenominator = scaleDenominator;
+	return decodeJpeg(file, decode);
 }
 
 
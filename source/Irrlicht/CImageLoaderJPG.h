@@ -18,6 +18,7 @@ namespace irr
 namespace video
 {
 
+struct SJpegDecode;
 
 //! Surface Loader for JPG images
 class CImageLoaderJPG : public IImageLoader
@@ -40,7 +41,18 @@ public:
 	//! creates a surface from the file
 	IImage* loadImage(io::IReadFile* file) const override;
 
+	//! reads the size and color format from the header
+	bool getImageInfo(io::IReadFile* file, core::dimension2du& size, ECOLOR_FORMAT& format, u32 scaleDenominator = 1) const override;
+
+	//! decodes into memory of the caller, in ECF_A8R8G8B8 or ECF_R8G8B8
+	/** scaleDenominator 2, 4 or 8 decodes at a reduced size, which is much
+	faster than scaling the decoded image. */
+	bool loadImageInto(io::IReadFile* file, void* data, u32 pitch, ECOLOR_FORMAT format, u32 scaleDenominator = 1) const override;
+
 private:
+	//! Reads a jpeg file into the memory or image described by decode
+	static bool decodeJpeg(io::IReadFile* file, SJpegDecode& decode);
+
 	// several methods used via function pointers by jpeglib
 
 	/* Receives control for a fatal error. Information sufficient to
@@ -0,0 +1,375 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CImageLoaderKTX.h"
+
+#include "IReadFile.h"
+#include "os.h"
+#include "CImage.h"
+#include "CBlockTranscoder.h"
+#include "CJobSystem.h"
+#include "irrString.h"
+#include <string.h>
+#include <thread>
+#include <zlib.h>
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+#include <zstd.h>
+#endif
+
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	const u8 KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	// sRGB variants are loaded like their linear counterparts
+	ECOLOR_FORMAT getFormatFromVk(u32 vkFormat)
+	{
+		switch (vkFormat)
+		{
+		case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		case 132: // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+		case 133: // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+		case 134: // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+			return ECF_DXT1;
+		case 135: // VK_FORMAT_BC2_UNORM_BLOCK
+		case 136: // VK_FORMAT_BC2_SRGB_BLOCK
+			return ECF_DXT3;
+		case 137: // VK_FORMAT_BC3_UNORM_BLOCK
+		case 138: // VK_FORMAT_BC3_SRGB_BLOCK
+			return ECF_DXT5;
+		case 145: // VK_FORMAT_BC7_UNORM_BLOCK
+		case 146: // VK_FORMAT_BC7_SRGB_BLOCK
+			return ECF_BC7;
+		case 147: // VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+		case 148: // VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+			return ECF_ETC2_RGB;
+		case 151: // VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+		case 152: // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+			return ECF_ETC2_ARGB;
+		case 157: // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+		case 158: // VK_FORMAT_ASTC_4x4_SRGB_BLOCK
+			return ECF_ASTC_4x4;
+		case 165: // VK_FORMAT_ASTC_6x6_UNORM_BLOCK
+		case 166: // VK_FORMAT_ASTC_6x6_SRGB_BLOCK
+			return ECF_ASTC_6x6;
+		case 171: // VK_FORMAT_ASTC_8x8_UNORM_BLOCK
+		case 172: // VK_FORMAT_ASTC_8x8_SRGB_BLOCK
+			return ECF_ASTC_8x8;
+		default:
+			return ECF_UNKNOWN;
+		}
+	}
+
+	template <class T>
+	void byteswapFields(void* fields, u32 count)
+	{
+#ifdef __BIG_ENDIAN__
+		u8* p = static_cast<u8*>(fields);
+		for (u32 i = 0; i < count; ++i, p += sizeof(T))
+		{
+			T value;
+			memcpy(&value, p, sizeof(T));
+			value = os::Byteswap::byteswap(value);
+			memcpy(p, &value, sizeof(T));
+		}
+#endif
+	}
+
+	bool readLevel(io::IReadFile* file, const SKTX2Level& level, u8* data, u32 dataSize)
+	{
+		return level.ByteLength == dataSize && file->seek((long)level.ByteOffset) &&
+			file->read(data, dataSize) == (size_t)dataSize;
+	}
+
+	// supercompression schemes
+	const u32 KTX2_SUPERCOMPRESSION_NONE = 0;
+	const u32 KTX2_SUPERCOMPRESSION_BASISLZ = 1;
+	const u32 KTX2_SUPERCOMPRESSION_ZSTD = 2;
+	const u32 KTX2_SUPERCOMPRESSION_ZLIB = 3;
+
+	bool isSupercompressionSupported(u32 scheme)
+	{
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+		if (scheme == KTX2_SUPERCOMPRESSION_ZSTD)
+			return true;
+#endif
+		return scheme == KTX2_SUPERCOMPRESSION_NONE || scheme == KTX2_SUPERCOMPRESSION_ZLIB;
+	}
+
+	bool decompressLevel(u32 scheme, const u8* in, u32 inSize, u8* out, u32 outSize)
+	{
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+		if (scheme == KTX2_SUPERCOMPRESSION_ZSTD)
+		{
+			const size_t r = ZSTD_decompress(out, outSize, in, inSize);
+			return !ZSTD_isError(r) && r == outSize;
+		}
+#endif
+		if (scheme != KTX2_SUPERCOMPRESSION_ZLIB)
+			return false;
+
+		// zlib streams with their header
+		z_stream stream;
+		memset(&stream, 0, sizeof(stream));
+		stream.next_in = (Bytef*)in;
+		stream.avail_in = (uInt)inSize;
+		stream.next_out = (Bytef*)out;
+		stream.avail_out = (uInt)outSize;
+		if (inflateInit(&stream) != Z_OK)
+			return false;
+		const int err = inflate(&stream, Z_FINISH);
+		inflateEnd(&stream);
+		return err == Z_STREAM_END && stream.total_out == outSize;
+	}
+
+	//! A level which is decompressed or transcoded by a job
+	struct SKTX2LevelJob
+	{
+		//! the data of the file, if it has to be decoded
+		core::array<u8> Source;
+		u32 Scheme;
+		ECOLOR_FORMAT Format;
+		//! format to transcode to, or ECF_UNKNOWN
+		ECOLOR_FORMAT Target;
+		core::dimension2d<u32> Size;
+		//! size of the level in the format of the file
+		u32 DataSize;
+		u8* Out;
+		bool Result;
+	};
+
+	void decodeLevel(void* data)
+	{
+		SKTX2LevelJob& job = *static_cast<SKTX2LevelJob*>(data);
+		const u8* blocks = job.Source.const_pointer();
+		core::array<u8> decompressed;
+		if (job.Scheme != KTX2_SUPERCOMPRESSION_NONE)
+		{
+			u8* target = job.Out;
+			if (job.Target != ECF_UNKNOWN)
+			{
+				decompressed.set_used(job.DataSize);
+				target = decompressed.pointer();
+			}
+			job.Result = decompressLevel(job.Scheme, job.Source.const_pointer(), job.Source.size(), target, job.DataSize);
+			if (!job.Result || job.Target == ECF_UNKNOWN)
+				return;
+			blocks = target;
+		}
+		job.Result = CBlockTranscoder::transcode(job.Format, blocks, job.Target, job.Out, job.Size);
+	}
+}
+
+
+//! constructor
+CImageLoaderKTX::CImageLoaderKTX(IVideoDriver* driver) : Driver(driver)
+{
+}
+
+
+//! returns true if the file maybe is able to be loaded by this class
+//! based on the file extension (e.g. ".ktx2")
+bool CImageLoaderKTX::isALoadableFileExtension(const io::path& filename) const
+{
+	return core::hasFileExtension(filename, "ktx2");
+}
+
+
+//! returns true if the file maybe is able to be loaded by this class
+bool CImageLoaderKTX::isALoadableFileFormat(io::IReadFile* file) const
+{
+	if (!file)
+		return false;
+
+	u8 identifier[12];
+	return file->read(identifier, sizeof(identifier)) == sizeof(identifier) &&
+		memcmp(identifier, KTX2_IDENTIFIER, sizeof(identifier)) == 0;
+}
+
+
+//! creates a surface from the file
+IImage* CImageLoaderKTX::loadImage(io::IReadFile* file) const
+{
+	SKTX2Header header;
+	if (file->read(&header, sizeof(SKTX2Header)) != sizeof(SKTX2Header) ||
+		memcmp(header.Identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+	{
+		os::Printer::log("Invalid KTX2 header", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	byteswapFields<u32>(&header.VkFormat, 13);
+	byteswapFields<u64>(&header.SgdByteOffset, 2);
+
+	if (header.SupercompressionScheme == KTX2_SUPERCOMPRESSION_BASISLZ || header.VkFormat == 0)
+	{
+		os::Printer::log("KTX2 files with Basis Universal data are not supported", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	if (!isSupercompressionSupported(header.SupercompressionScheme))
+	{
+		os::Printer::log("Unsupported KTX2 supercompression", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	if (header.PixelDepth > 0 || header.LayerCount > 1 || header.FaceCount != 1)
+	{
+		os::Printer::log("Only 2D KTX2 textures are supported", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	const ECOLOR_FORMAT format = getFormatFromVk(header.VkFormat);
+	if (format == ECF_UNKNOWN)
+	{
+		os::Printer::log("Unsupported KTX2 format", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	if (header.PixelWidth == 0 || header.PixelHeight == 0 || !checkImageDimensions(header.PixelWidth, header.PixelHeight))
+	{
+		os::Printer::log("Image dimensions too large in file", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	const core::dimension2d<u32> size(header.PixelWidth, header.PixelHeight);
+
+	// a level count of 0 asks for mipmaps to be generated at runtime
+	const u32 levelCount = core::max_<u32>(header.LevelCount, 1);
+
+	// formats the driver lacks are transcoded
+	const ECOLOR_FORMAT target = CBlockTranscoder::getTarget(format, Driver);
+	const ECOLOR_FORMAT imageFormat = target != ECF_UNKNOWN ? target : format;
+
+	u32 mipMapCount = 1;
+	u32 mipMapsSize = 0;
+	for (core::dimension2d<u32> mipSize = size; mipSize.Width > 1 || mipSize.Height > 1; ++mipMapCount)
+	{
+		mipSize.Width = core::max_<u32>(mipSize.Width >> 1, 1);
+		mipSize.Height = core::max_<u32>(mipSize.Height >> 1, 1);
+		mipMapsSize += IImage::getDataSizeFromFormat(imageFormat, mipSize.Width, mipSize.Height);
+	}
+
+	if (levelCount > mipMapCount)
+	{
+		os::Printer::log("Invalid KTX2 level count", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	core::array<SKTX2Level> levels;
+	levels.set_used(levelCount);
+	if (file->read(levels.pointer(), levelCount * sizeof(SKTX2Level)) != levelCount * sizeof(SKTX2Level))
+	{
+		os::Printer::log("KTX2 file is too short", file->getFileName(), ELL_ERROR);
+		return 0;
+	}
+
+	byteswapFields<u64>(levels.pointer(), levelCount * 3);
+
+	// images can only hold complete mipmap chains
+	const u32 loadedLevels = levelCount == mipMapCount && mipMapsSize > 0 ? levelCount : 1;
+	const bool decode = target != ECF_UNKNOWN || header.SupercompressionScheme != KTX2_SUPERCOMPRESSION_NONE;
+
+	const u32 dataSize = IImage::getDataSizeFromFormat(imageFormat, size.Width, size.Height);
+	u8* data = new u8[dataSize];
+	u8* mipMapsData = 0;
+	if (loadedLevels > 1)
+		mipMapsData = new u8[mipMapsSize];
+
+	core::array<SKTX2LevelJob> jobs;
+	jobs.set_used(loadedLevels);
+	u8* out = data;
+	core::dimension2d<u32> mipSize = size;
+	for (u32 i = 0; i < loadedLevels; ++i)
+	{
+		SKTX2LevelJob& job = jobs[i];
+		job.Scheme = header.SupercompressionScheme;
+		job.Format = format;
+		job.Target = target;
+		job.Size = mipSize;
+		job.DataSize = IImage::getDataSizeFromFormat(format, mipSize.Width, mipSize.Height);
+		job.Out = out;
+		job.Result = false;
+
+		const SKTX2Level& level = levels[i];
+		if (!decode)
+			job.Result = readLevel(file, level, out, job.DataSize);
+		else if (level.ByteLength <= 0x7fffffff && (job.Scheme != KTX2_SUPERCOMPRESSION_NONE ?
+			level.UncompressedByteLength == job.DataSize : level.ByteLength == job.DataSize))
+		{
+			// the levels are read here and decoded by the jobs
+			job.Source.set_used((u32)level.ByteLength);
+			job.Result = file->seek((long)level.ByteOffset) &&
+				file->read(job.Source.pointer(), job.Source.size()) == job.Source.size();
+		}
+
+		out = i == 0 ? mipMapsData : out + IImage::getDataSizeFromFormat(imageFormat, mipSize.Width, mipSize.Height);
+		mipSize.Width = core::max_<u32>(mipSize.Width >> 1, 1);
+		mipSize.Height = core::max_<u32>(mipSize.Height >> 1, 1);
+	}
+
+	if (decode)
+	{
+		const u32 cores = std::thread::hardware_concurrency();
+		if (loadedLevels > 1 && cores > 1)
+		{
+			scene::CJobSystem jobSystem(core::min_(cores, loadedLevels) - 1);
+			for (u32 i = 0; i < loadedLevels; ++i)
+			{
+				if (jobs[i].Result)
+					jobSystem.add(decodeLevel, &jobs[i]);
+			}
+			jobSystem.wait();
+		}
+		else
+		{
+			for (u32 i = 0; i < loadedLevels; ++i)
+			{
+				if (jobs[i].Result)
+					decodeLevel(&jobs[i]);
+			}
+		}
+	}
+
+	if (!jobs[0].Result)
+	{
+		os::Printer::log("Invalid KTX2 level data", file->getFileName(), ELL_ERROR);
+		delete [] data;
+		delete [] mipMapsData;
+		return 0;
+	}
+
+	IImage* image = new CImage(imageFormat, size, data, true, true);
+
+	if (mipMapsData)
+	{
+		bool complete = true;
+		for (u32 i = 1; i < loadedLevels; ++i)
+			complete &= jobs[i].Result;
+
+		if (complete)
+			image->setMipMapsData(mipMapsData, false);
+		else
+			os::Printer::log("Invalid KTX2 mipmap data, mipmaps skipped", file->getFileName(), ELL_WARNING);
+
+		delete [] mipMapsData;
+	}
+
+	return image;
+}
+
+
+//! creates a loader which is able to load ktx2 images
+IImageLoader* createImageLoaderKTX(IVideoDriver* driver)
+{
+	return new CImageLoaderKTX(driver);
+}
+
+
+} // end namespace video
+} // end namespace irr
@@ -0,0 +1,85 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IMAGE_LOADER_KTX_H_INCLUDED__
+#define __C_IMAGE_LOADER_KTX_H_INCLUDED__
+
+
+#include "IImageLoader.h"
+
+
+namespace irr
+{
+namespace video
+{
+
+class IVideoDriver;
+
+// byte-align structures
+#include "irrpack.h"
+
+	struct SKTX2Header
+	{
+		u8 Identifier[12];
+		u32 VkFormat;
+		u32 TypeSize;
+		u32 PixelWidth;
+		u32 PixelHeight;
+		u32 PixelDepth;
+		u32 LayerCount;
+		u32 FaceCount;
+		u32 LevelCount;
+		u32 SupercompressionScheme;
+		u32 DfdByteOffset;
+		u32 DfdByteLength;
+		u32 KvdByteOffset;
+		u32 KvdByteLength;
+		u64 SgdByteOffset;
+		u64 SgdByteLength;
+	} PACK_STRUCT;
+
+	struct SKTX2Level
+	{
+		u64 ByteOffset;
+		u64 ByteLength;
+		u64 UncompressedByteLength;
+	} PACK_STRUCT;
+
+// Default alignment
+#include "irrunpack.h"
+
+/*!
+	Surface Loader for Khronos KTX 2.0 textures
+	Supports 2D textures in the BC1, BC2, BC3, BC7, ETC2 and ASTC (4x4, 6x6,
+	8x8) formats, without supercompression or with zlib, and with zstd if
+	compiled with _IRR_COMPILE_WITH_ZSTD_.
+	The mipmaps are loaded as well if the file contains all of them. The
+	levels are decompressed on worker threads, and transcoded to a format
+	the driver supports if it lacks the one of the file.
+*/
+class CImageLoaderKTX : public IImageLoader
+{
+public:
+
+	//! constructor
+	/** \param driver Decides if the images are transcoded, may be 0. */
+	CImageLoaderKTX(IVideoDriver* driver);
+
+	//! returns true if the file maybe is able to be loaded by this class
+	//! based on the file extension (e.g. ".ktx2")
+	bool isALoadableFileExtension(const io::path& filename) const override;
+
+	//! returns true if the file maybe is able to be loaded by this class
+	bool isALoadableFileFormat(io::IReadFile* file) const override;
+
+	//! creates a surface from the file
+	IImage* loadImage(io::IReadFile* file) const override;
+
+private:
+	IVideoDriver* Driver;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
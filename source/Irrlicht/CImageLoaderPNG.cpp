@@ -67,12 +67,32 @@ bool CImageLoaderPng::isALoadableFileFormat(io::IReadFile* file) const
 }
 
 
-// load in the image data
-IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
+namespace
 {
-	if (!file)
-		return 0;
 
+//! Where the rows of a png go, see decodePng()
+struct SPngDecode
+{
+	SPngDecode() : Data(0), Pitch(0), Format(ECF_UNKNOWN), InfoOnly(false),
+		NativeFormat(ECF_UNKNOWN), Image(0) {}
+
+	//! rows of the caller, a new image is created when 0
+	void* Data;
+	u32 Pitch;
+	ECOLOR_FORMAT Format;
+
+	//! stop after the header
+	bool InfoOnly;
+
+	core::dimension2du Size;
+	//! format of the image created when Data is 0
+	ECOLOR_FORMAT NativeFormat;
+	IImage* Image;
+};
+
+//! Reads a png file into the memory or image described by decode
+bool decodePng(io::IReadFile* file, SPngDecode& decode)
+{
 	//Used to point to image rows
 	u8** RowPointers = 0;
 
@@ -81,14 +101,14 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 	if( file->read(buffer, 8) != 8 )
 	{
 		os::Printer::log("LOAD PNG: can't read file (filesize < 8)", file->getFileName(), ELL_ERROR);
-		return 0;
+		return false;
 	}
 
 	// Check if it really is a PNG file
 	if( png_sig_cmp(buffer, 0, 8) )
 	{
 		os::Printer::log("LOAD PNG: not really a png (wrong signature)", file->getFileName(), ELL_ERROR);
-		return 0;
+		return false;
 	}
 
 	// Allocate the png read struct
@@ -97,7 +117,7 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 	if (!png_ptr)
 	{
 		os::Printer::log("LOAD PNG: Internal PNG create read struct failure", file->getFileName(), ELL_ERROR);
-		return 0;
+		return false;
 	}
 
 	// Allocate the png info struct
@@ -106,7 +126,7 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 	{
 		os::Printer::log("LOAD PNG: Internal PNG create info struct failure", file->getFileName(), ELL_ERROR);
 		png_destroy_read_struct(&png_ptr, NULL, NULL);
-		return 0;
+		return false;
 	}
 
 	// for proper error handling
@@ -114,7 +134,7 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 	{
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
 		delete [] RowPointers;
-		return 0;
+		return false;
 	}
 
 	// changed by zola so we don't need to have public FILE pointers
@@ -142,6 +162,27 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 	if (!checkImageDimensions(Width, Height))
 		png_cpexcept_error(png_ptr, "Unreasonable size");
 
+	// all color types end up as RGB, with alpha if they have an alpha channel or transparency
+	const bool hasAlpha = (ColorType & PNG_COLOR_MASK_ALPHA) || png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS);
+	decode.Size.set(Width, Height);
+	decode.NativeFormat = hasAlpha ? ECF_A8R8G8B8 : ECF_R8G8B8;
+
+	if (decode.InfoOnly)
+	{
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return true;
+	}
+
+	if (!decode.Data)
+		decode.Format = decode.NativeFormat;
+
+	if (decode.Format != ECF_A8R8G8B8 && decode.Format != ECF_R8G8B8)
+	{
+		os::Printer::log("LOAD PNG: Can't decode into color format", ColorFormatNames[decode.Format < ECF_UNKNOWN ? decode.Format : ECF_UNKNOWN], ELL_ERROR);
+		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+		return false;
+	}
+
 	// Convert palette color to true color
 	if (ColorType==PNG_COLOR_TYPE_PALETTE)
 		png_set_palette_to_rgb(png_ptr);
@@ -180,59 +221,47 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 			png_set_gamma(png_ptr, screen_gamma, 0.45455);
 	}
 
-	// Update the changes in between, as we need to get the new color type
-	// for proper processing of the RGBA type
-	png_read_update_info(png_ptr, info_ptr);
-	{
-		// Use temporary variables to avoid passing cast pointers
-		png_uint_32 w,h;
-		// Extract info
-		png_get_IHDR(png_ptr, info_ptr,
-			&w, &h,
-			&BitDepth, &ColorType, NULL, NULL, NULL);
-		Width=w;
-		Height=h;
-	}
-
-	// Convert RGBA to BGRA
-	if (ColorType==PNG_COLOR_TYPE_RGB_ALPHA)
+	// libpng writes the rows in the byte order of the target format, so they need no conversion afterwards
+	if (decode.Format == ECF_A8R8G8B8)
 	{
+		// Convert RGBA to BGRA, images without alpha get an opaque one
 #ifdef __BIG_ENDIAN__
-		png_set_swap_alpha(png_ptr);
+		if (hasAlpha)
+			png_set_swap_alpha(png_ptr);
+		else
+			png_set_filler(png_ptr, 0xff, PNG_FILLER_BEFORE);
 #else
+		if (!hasAlpha)
+			png_set_filler(png_ptr, 0xff, PNG_FILLER_AFTER);
 		png_set_bgr(png_ptr);
 #endif
 	}
+	else if (hasAlpha)
+		png_set_strip_alpha(png_ptr);
+
+	// Update the changes in between, the rows have to fit into the target now
+	png_read_update_info(png_ptr, info_ptr);
+	if (png_get_rowbytes(png_ptr, info_ptr) != Width * IImage::getBitsPerPixelFromFormat(decode.Format) / 8)
+		png_cpexcept_error(png_ptr, "Unexpected row size");
 
 	// Create the image structure to be filled by png data
-	video::IImage* image = 0;
-	if (ColorType==PNG_COLOR_TYPE_RGB_ALPHA)
-		image = new CImage(ECF_A8R8G8B8, core::dimension2d<u32>(Width, Height));
-	else
-		image = new CImage(ECF_R8G8B8, core::dimension2d<u32>(Width, Height));
-	if (!image)
+	u8* data = (u8*)decode.Data;
+	u32 pitch = decode.Pitch;
+	if (!data)
 	{
-		os::Printer::log("LOAD PNG: Internal PNG create image struct failure", file->getFileName(), ELL_ERROR);
-		png_destroy_read_struct(&png_ptr, NULL, NULL);
-		return 0;
+		decode.Image = new CImage(decode.Format, decode.Size);
+		data = (u8*)decode.Image->getData();
+		pitch = decode.Image->getPitch();
 	}
 
 	// Create array of pointers to rows in image data
 	RowPointers = new png_bytep[Height];
-	if (!RowPointers)
-	{
-		os::Printer::log("LOAD PNG: Internal PNG create row pointers failure", file->getFileName(), ELL_ERROR);
-		png_destroy_read_struct(&png_ptr, NULL, NULL);
-		delete image;
-		return 0;
-	}
 
 	// Fill array of pointers to rows in image data
-	unsigned char* data = (unsigned char*)image->getData();
 	for (u32 i=0; i<Height; ++i)
 	{
 		RowPointers[i]=data;
-		data += image->getPitch();
+		data += pitch;
 	}
 
 	// for proper error handling
@@ -240,8 +269,10 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 	{
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
 		delete [] RowPointers;
-		delete image;
-		return 0;
+		if (decode.Image)
+			decode.Image->drop();
+		decode.Image = 0;
+		return false;
 	}
 
 	// Read data using the library function that handles all transformations including interlacing
@@ -251,7 +282,54 @@ IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
 	delete [] RowPointers;
 	png_destroy_read_struct(&png_ptr,&info_ptr, 0); // Clean up memory
 
-	return image;
+	return true;
+}
+
+} // end anonymous namespace
+
+
+// load in the image data
+IImage* CImageLoaderPng::loadImage(io::IReadFile* file) const
+{
+	if (!file)
+		return 0;
+
+	SPngDecode decode;
+	if (!decodePng(file, decode))
+		return 0;
+
+	return decode.Image;
+}
+
+
+//! reads the size and color format from the header
+bool CImageLoaderPng::getImageInfo(io::IReadFile* file, core::dimension2du& size, ECOLOR_FORMAT& format, u32 scaleDenominator) const
+{
+	if (!file)
+		return false;
+
+	SPngDecode decode;
+	decode.InfoOnly = true;
+	if (!decodePng(file, decode))
+		return false;
+
+	size = decode.Size;
+	format = decode.NativeFormat;
+	return true;
+}
+
+
+//! decodes into memory of the caller, png has no reduced sizes
+bool CImageLoaderPng::loadImageInto(io::IReadFile* file, void* data, u32 pitch, ECOLOR_FORMAT format, u32 scaleDenominator) const
+{
+	if (!file || !data)
+		return false;
+
+	SPngDecode decode;
+	decode.Data = data;
+	decode.Pitch = pitch;
+	decode.Format = format;
+	return decodePng(file, decode);
 }
 
 
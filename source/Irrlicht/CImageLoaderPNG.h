@@ -31,6 +31,12 @@ public:
 
 	//! creates a surface from the file
 	IImage* loadImage(io::IReadFile* file) const override;
+
+	//! reads the size and color format from the header
+	bool getImageInfo(io::IReadFile* file, core::dimension2du& size, ECOLOR_FORMAT& format, u32 scaleDenominator = 1) const override;
+
+	//! decodes into memory of the caller, in ECF_A8R8G8B8 or ECF_R8G8B8
+	bool loadImageInto(io::IReadFile* file, void* data, u32 pitch, ECOLOR_FORMAT format, u32 scaleDenominator = 1) const override;
 };
 
 
@@ -0,0 +1,699 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CImageResampler.h"
+#include "CJobSystem.h"
+#include "irrArray.h"
+#include "S3DVertex.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _IRR_RESAMPLE_SSE2_
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define _IRR_RESAMPLE_NEON_
+#endif
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+#if defined(_IRR_RESAMPLE_SSE2_)
+	typedef __m128 f32x4;
+
+	inline f32x4 load4(const f32* p) { return _mm_loadu_ps(p); }
+	inline void store4(f32* p, f32x4 a) { _mm_storeu_ps(p, a); }
+	inline f32x4 splat4(f32 v) { return _mm_set1_ps(v); }
+	inline f32x4 add4(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+#elif defined(_IRR_RESAMPLE_NEON_)
+	typedef float32x4_t f32x4;
+
+	inline f32x4 load4(const f32* p) { return vld1q_f32(p); }
+	inline void store4(f32* p, f32x4 a) { vst1q_f32(p, a); }
+	inline f32x4 splat4(f32 v) { return vdupq_n_f32(v); }
+	inline f32x4 add4(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+#else
+	struct f32x4
+	{
+		f32 v[4];
+	};
+
+	inline f32x4 load4(const f32* p) { f32x4 r; for (u32 i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+	inline void store4(f32* p, f32x4 a) { for (u32 i = 0; i < 4; ++i) p[i] = a.v[i]; }
+	inline f32x4 splat4(f32 v) { f32x4 r; for (u32 i = 0; i < 4; ++i) r.v[i] = v; return r; }
+	inline f32x4 add4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+#endif
+
+//! Targets with fewer pixels are resampled on the calling thread only
+const u32 PARALLEL_RESAMPLE_MIN_PIXELS = 256 * 256;
+
+//! Target rows resampled by one job
+const u32 RESAMPLE_BAND_ROWS = 32;
+
+//! Source pixels and their weights for each target pixel of one axis
+struct SResampleTaps
+{
+	//! Source pixels per target pixel
+	u32 Taps;
+	//! Taps entries per target pixel, clamped to the edges
+	core::array<u32> Index;
+	core::array<f32> Weight;
+};
+
+struct SSRGBTables;
+
+struct SResample
+{
+	const u8* Source;
+	ECOLOR_FORMAT SourceFormat;
+	core::dimension2d<u32> SourceSize;
+	u32 SourcePitch;
+	u8* Target;
+	ECOLOR_FORMAT TargetFormat;
+	core::dimension2d<u32> TargetSize;
+	u32 TargetPitch;
+	//! set when the colors of the 8 bit RGB formats are filtered in linear space
+	const SSRGBTables* SRGB;
+	SResampleTaps Horizontal;
+	SResampleTaps Vertical;
+};
+
+//! A band of target rows
+struct SResampleJob
+{
+	const SResample* Resample;
+	u32 FirstRow;
+	u32 EndRow;
+};
+
+inline f32 sinc(f32 x)
+{
+	if (x == 0.f)
+		return 1.f;
+	x *= core::PI;
+	return sinf(x) / x;
+}
+
+//! Weight of a source pixel at a distance from the sample point
+/** \param distance In source pixels
+\param scale Source pixels per target pixel */
+f32 filterWeight(E_IMAGE_SCALING_FILTER filter, f32 distance, f32 scale)
+{
+	switch (filter)
+	{
+	case EISF_BILINEAR:
+		{
+			// when shrinking, the filters are widened to cover all source pixels of a target pixel
+			const f32 x = fabsf(distance) / core::max_(scale, 1.f);
+			return x < 1.f ? 1.f - x : 0.f;
+		}
+	case EISF_LANCZOS3:
+		{
+			const f32 x = fabsf(distance) / core::max_(scale, 1.f);
+			return x < 3.f ? sinc(x) * sinc(x / 3.f) : 0.f;
+		}
+	default:
+		// the part of the source pixel covered by the target pixel, the nearest pixel when enlarging
+		if (scale < 1.f)
+			return distance > -0.5f && distance <= 0.5f ? 1.f : 0.f;
+		return core::max_(0.f, core::min_(distance + 0.5f, scale * 0.5f) - core::max_(distance - 0.5f, scale * -0.5f));
+	}
+}
+
+void computeTaps(SResampleTaps& taps, u32 sourceSize, u32 targetSize, E_IMAGE_SCALING_FILTER filter)
+{
+	const f32 scale = (f32)sourceSize / (f32)targetSize;
+	const f32 width = core::max_(scale, 1.f);
+	f32 radius;
+	switch (filter)
+	{
+	case EISF_BILINEAR:
+		radius = width;
+		break;
+	case EISF_LANCZOS3:
+		radius = 3.f * width;
+		break;
+	default:
+		radius = width * 0.5f + 0.5f;
+		break;
+	}
+
+	taps.Taps = (u32)ceilf(radius * 2.f) + 1;
+	taps.Index.set_used(targetSize * taps.Taps);
+	taps.Weight.set_used(targetSize * taps.Taps);
+
+	for (u32 i = 0; i < targetSize; ++i)
+	{
+		const f32 center = (i + 0.5f) * scale - 0.5f;
+		const s32 first = (s32)floorf(center - radius) + 1;
+		u32* index = &taps.Index[i * taps.Taps];
+		f32* weight = &taps.Weight[i * taps.Taps];
+
+		f32 sum = 0.f;
+		for (u32 k = 0; k < taps.Taps; ++k)
+		{
+			const s32 j = first + (s32)k;
+			index[k] = (u32)core::s32_clamp(j, 0, (s32)sourceSize - 1);
+			weight[k] = filterWeight(filter, (f32)j - center, scale);
+			sum += weight[k];
+		}
+
+		if (sum != 0.f)
+		{
+			for (u32 k = 0; k < taps.Taps; ++k)
+				weight[k] /= sum;
+		}
+		else
+		{
+			// can't happen with the filters above, but don't leave black pixels
+			weight[0] = 1.f;
+			index[0] = (u32)core::s32_clamp(core::round32(center), 0, (s32)sourceSize - 1);
+		}
+	}
+
+	// the range above is conservative, the zero weights at its ends are cut off
+	u32 maxSpan = 1;
+	core::array<u32> firstTap;
+	firstTap.set_used(targetSize);
+	for (u32 i = 0; i < targetSize; ++i)
+	{
+		const f32* weight = &taps.Weight[i * taps.Taps];
+		u32 first = 0;
+		u32 last = taps.Taps - 1;
+		while (first < last && weight[first] == 0.f)
+			++first;
+		while (last > first && weight[last] == 0.f)
+			--last;
+		firstTap[i] = first;
+		maxSpan = core::max_(maxSpan, last - first + 1);
+	}
+
+	if (maxSpan < taps.Taps)
+	{
+		for (u32 i = 0; i < targetSize; ++i)
+		{
+			for (u32 k = 0; k < maxSpan; ++k)
+			{
+				const u32 from = i * taps.Taps + core::min_(firstTap[i] + k, taps.Taps - 1);
+				const bool inside = firstTap[i] + k < taps.Taps;
+				taps.Index[i * maxSpan + k] = taps.Index[from];
+				taps.Weight[i * maxSpan + k] = inside ? taps.Weight[from] : 0.f;
+			}
+		}
+		taps.Taps = maxSpan;
+		taps.Index.set_used(targetSize * maxSpan);
+		taps.Weight.set_used(targetSize * maxSpan);
+	}
+}
+
+inline f32 fromUnorm(u32 value, f32 max)
+{
+	return value * (1.f / max);
+}
+
+inline u32 toUnorm(f32 value, f32 max)
+{
+	return (u32)(core::clamp(value, 0.f, 1.f) * max + 0.5f);
+}
+
+//! Reads a row into 4 floats per pixel, red, green, blue and alpha
+void decodeRow(const u8* in, ECOLOR_FORMAT format, u32 count, f32* out)
+{
+	switch (format)
+	{
+	case ECF_A1R5G5B5:
+		for (u32 x = 0; x < count; ++x, out += 4)
+		{
+			const u16 c = ((const u16*)in)[x];
+			out[0] = fromUnorm((c >> 10) & 0x1f, 31.f);
+			out[1] = fromUnorm((c >> 5) & 0x1f, 31.f);
+			out[2] = fromUnorm(c & 0x1f, 31.f);
+			out[3] = (f32)(c >> 15);
+		}
+		break;
+	case ECF_R5G6B5:
+		for (u32 x = 0; x < count; ++x, out += 4)
+		{
+			const u16 c = ((const u16*)in)[x];
+			out[0] = fromUnorm(c >> 11, 31.f);
+			out[1] = fromUnorm((c >> 5) & 0x3f, 63.f);
+			out[2] = fromUnorm(c & 0x1f, 31.f);
+			out[3] = 1.f;
+		}
+		break;
+	case ECF_R8G8B8:
+		for (u32 x = 0; x < count; ++x, in += 3, out += 4)
+		{
+			out[0] = fromUnorm(in[0], 255.f);
+			out[1] = fromUnorm(in[1], 255.f);
+			out[2] = fromUnorm(in[2], 255.f);
+			out[3] = 1.f;
+		}
+		break;
+	case ECF_A8R8G8B8:
+		{
+			u32 x = 0;
+#if defined(_IRR_RESAMPLE_SSE2_)
+			// 4 pixels at once, blue and red swap places
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 scale = _mm_set1_ps(1.f / 255.f);
+			for (; x + 4 <= count; x += 4, in += 16, out += 16)
+			{
+				const __m128i pixels = _mm_loadu_si128((const __m128i*)in);
+				const __m128i low = _mm_unpacklo_epi8(pixels, zero);
+				const __m128i high = _mm_unpackhi_epi8(pixels, zero);
+				const __m128i words[4] = { _mm_unpacklo_epi16(low, zero), _mm_unpackhi_epi16(low, zero),
+					_mm_unpacklo_epi16(high, zero), _mm_unpackhi_epi16(high, zero) };
+				for (u32 i = 0; i < 4; ++i)
+				{
+					const __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(words[i]), scale);
+					_mm_storeu_ps(out + i * 4, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2)));
+				}
+			}
+#endif
+			for (; x < count; ++x, in += 4, out += 4)
+			{
+				out[0] = fromUnorm(in[2], 255.f);
+			out[1] = fromUnorm(in[1], 255.f);
+				out[2] = fromUnorm(in[0], 255.f);
+				out[3] = fromUnorm(in[3], 255.f);
+			}
+		}
+		break;
+	case ECF_R8:
+	case ECF_R8G8:
+		{
+			const u32 channels = format == ECF_R8 ? 1 : 2;
+			for (u32 x = 0; x < count; ++x, in += channels, out += 4)
+			{
+				out[0] = fromUnorm(in[0], 255.f);
+				out[1] = channels == 2 ? fromUnorm(in[1], 255.f) : 0.f;
+				out[2] = 0.f;
+				out[3] = 1.f;
+			}
+		}
+		break;
+	case ECF_R16:
+	case ECF_R16G16:
+		{
+			const u32 channels = format == ECF_R16 ? 1 : 2;
+			const u16* p = (const u16*)in;
+			for (u32 x = 0; x < count; ++x, p += channels, out += 4)
+			{
+				out[0] = fromUnorm(p[0], 65535.f);
+				out[1] = channels == 2 ? fromUnorm(p[1], 65535.f) : 0.f;
+				out[2] = 0.f;
+				out[3] = 1.f;
+			}
+		}
+		break;
+	case ECF_R16F:
+	case ECF_G16R16F:
+	case ECF_A16B16G16R16F:
+		{
+			const u32 channels = format == ECF_R16F ? 1 : format == ECF_G16R16F ? 2 : 4;
+			const u16* p = (const u16*)in;
+			for (u32 x = 0; x < count; ++x, p += channels, out += 4)
+			{
+				out[0] = S3DVertexCompact::unpackHalf(p[0]);
+				out[1] = channels > 1 ? S3DVertexCompact::unpackHalf(p[1]) : 0.f;
+				out[2] = channels > 2 ? S3DVertexCompact::unpackHalf(p[2]) : 0.f;
+				out[3] = channels > 2 ? S3DVertexCompact::unpackHalf(p[3]) : 1.f;
+			}
+		}
+		break;
+	case ECF_R32F:
+	case ECF_G32R32F:
+	case ECF_A32B32G32R32F:
+		{
+			const u32 channels = format == ECF_R32F ? 1 : format == ECF_G32R32F ? 2 : 4;
+			const f32* p = (const f32*)in;
+			for (u32 x = 0; x < count; ++x, p += channels, out += 4)
+			{
+				out[0] = p[0];
+				out[1] = channels > 1 ? p[1] : 0.f;
+				out[2] = channels > 2 ? p[2] : 0.f;
+				out[3] = channels > 2 ? p[3] : 1.f;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+//! Conversions between the 8 bit sRGB codes and linear values
+struct SSRGBTables
+{
+	SSRGBTables()
+	{
+		for (u32 i = 0; i < 256; ++i)
+			ToLinear[i] = toLinear(i / 255.f);
+		for (u32 i = 0; i < 255; ++i)
+			Thresholds[i] = toLinear((i + 0.5f) / 255.f);
+	}
+
+	static f32 toLinear(f32 value)
+	{
+		return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	//! Returns the code whose range contains a linear value
+	u8 toCode(f32 value) const
+	{
+		u32 code = 0;
+		for (u32 step = 128; step; step >>= 1)
+		{
+			if (code + step <= 255 && value > Thresholds[code + step - 1])
+				code += step;
+		}
+		return (u8)code;
+	}
+
+	f32 ToLinear[256];
+	//! linear values halfway between neighboring codes
+	f32 Thresholds[255];
+};
+
+const SSRGBTables& getSRGBTables()
+{
+	static const SSRGBTables tables;
+	return tables;
+}
+
+inline bool isSRGBFormat(ECOLOR_FORMAT format)
+{
+	return format == ECF_R8G8B8 || format == ECF_A8R8G8B8;
+}
+
+//! Reads a row of 8 bit sRGB colors, the colors become linear, alpha stays linear anyway
+void decodeRowSRGB(const u8* in, ECOLOR_FORMAT format, u32 count, f32* out, const SSRGBTables& tables)
+{
+	// A8R8G8B8 is stored as blue, green, red, alpha
+	const bool alpha = format == ECF_A8R8G8B8;
+	const u32 stride = alpha ? 4 : 3;
+	const u32 red = alpha ? 2 : 0;
+	const u32 blue = 2 - red;
+	for (u32 x = 0; x < count; ++x, in += stride, out += 4)
+	{
+		out[0] = tables.ToLinear[in[red]];
+		out[1] = tables.ToLinear[in[1]];
+		out[2] = tables.ToLinear[in[blue]];
+		out[3] = alpha ? fromUnorm(in[3], 255.f) : 1.f;
+	}
+}
+
+//! Writes a row of linear colors as 8 bit sRGB
+void encodeRowSRGB(const f32* in, ECOLOR_FORMAT format, u32 count, u8* out, const SSRGBTables& tables)
+{
+	const bool alpha = format == ECF_A8R8G8B8;
+	const u32 stride = alpha ? 4 : 3;
+	const u32 red = alpha ? 2 : 0;
+	const u32 blue = 2 - red;
+	for (u32 x = 0; x < count; ++x, in += 4, out += stride)
+	{
+		out[red] = tables.toCode(in[0]);
+		out[1] = tables.toCode(in[1]);
+		out[blue] = tables.toCode(in[2]);
+		if (alpha)
+			out[3] = (u8)toUnorm(in[3], 255.f);
+	}
+}
+
+//! Writes a row of 4 floats per pixel, the normalized formats are clamped and rounded
+void encodeRow(const f32* in, ECOLOR_FORMAT format, u32 count, u8* out)
+{
+	switch (format)
+	{
+	case ECF_A1R5G5B5:
+		for (u32 x = 0; x < count; ++x, in += 4)
+		{
+			((u16*)out)[x] = (u16)((in[3] >= 0.5f ? 0x8000 : 0) | (toUnorm(in[0], 31.f) << 10) |
+				(toUnorm(in[1], 31.f) << 5) | toUnorm(in[2], 31.f));
+		}
+		break;
+	case ECF_R5G6B5:
+		for (u32 x = 0; x < count; ++x, in += 4)
+			((u16*)out)[x] = (u16)((toUnorm(in[0], 31.f) << 11) | (toUnorm(in[1], 63.f) << 5) | toUnorm(in[2], 31.f));
+		break;
+	case ECF_R8G8B8:
+		for (u32 x = 0; x < count; ++x, in += 4, out += 3)
+		{
+			out[0] = (u8)toUnorm(in[0], 255.f);
+			out[1] = (u8)toUnorm(in[1], 255.f);
+			out[2] = (u8)toUnorm(in[2], 255.f);
+		}
+		break;
+	case ECF_A8R8G8B8:
+		{
+			u32 x = 0;
+#if defined(_IRR_RESAMPLE_SSE2_)
+			// 4 pixels at once, clamped and rounded like toUnorm()
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 one = _mm_set1_ps(1.f);
+			const __m128 scale = _mm_set1_ps(255.f);
+			const __m128 half = _mm_set1_ps(0.5f);
+			for (; x + 4 <= count; x += 4, in += 16, out += 16)
+			{
+				__m128i words[4];
+				for (u32 i = 0; i < 4; ++i)
+				{
+					const __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i * 4), zero), one);
+					words[i] = _mm_shuffle_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half)), _MM_SHUFFLE(3, 0, 1, 2));
+				}
+				_mm_storeu_si128((__m128i*)out, _mm_packus_epi16(_mm_packs_epi32(words[0], words[1]),
+					_mm_packs_epi32(words[2], words[3])));
+			}
+#endif
+			for (; x < count; ++x, in += 4, out += 4)
+			{
+				out[0] = (u8)toUnorm(in[2], 255.f);
+				out[1] = (u8)toUnorm(in[1], 255.f);
+				out[2] = (u8)toUnorm(in[0], 255.f);
+				out[3] = (u8)toUnorm(in[3], 255.f);
+			}
+		}
+		break;
+	case ECF_R8:
+	case ECF_R8G8:
+		{
+			const u32 channels = format == ECF_R8 ? 1 : 2;
+			for (u32 x = 0; x < count; ++x, in += 4, out += channels)
+			{
+				for (u32 c = 0; c < channels; ++c)
+					out[c] = (u8)toUnorm(in[c], 255.f);
+			}
+		}
+		break;
+	case ECF_R16:
+	case ECF_R16G16:
+		{
+			const u32 channels = format == ECF_R16 ? 1 : 2;
+			u16* p = (u16*)out;
+			for (u32 x = 0; x < count; ++x, in += 4, p += channels)
+			{
+				for (u32 c = 0; c < channels; ++c)
+					p[c] = (u16)toUnorm(in[c], 65535.f);
+			}
+		}
+		break;
+	case ECF_R16F:
+	case ECF_G16R16F:
+	case ECF_A16B16G16R16F:
+		{
+			const u32 channels = format == ECF_R16F ? 1 : format == ECF_G16R16F ? 2 : 4;
+			u16* p = (u16*)out;
+			for (u32 x = 0; x < count; ++x, in += 4, p += channels)
+			{
+				for (u32 c = 0; c < channels; ++c)
+					p[c] = S3DVertexCompact::packHalf(in[c]);
+			}
+		}
+		break;
+	case ECF_R32F:
+	case ECF_G32R32F:
+	case ECF_A32B32G32R32F:
+		{
+			const u32 channels = format == ECF_R32F ? 1 : format == ECF_G32R32F ? 2 : 4;
+			f32* p = (f32*)out;
+			for (u32 x = 0; x < count; ++x, in += 4, p += channels)
+			{
+				for (u32 c = 0; c < channels; ++c)
+					p[c] = in[c];
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+//! Filters a decoded row horizontally
+void filterRow(const f32* in, const SResampleTaps& taps, u32 count, f32* out)
+{
+	const u32* index = taps.Index.const_pointer();
+	const f32* weight = taps.Weight.const_pointer();
+	for (u32 x = 0; x < count; ++x, out += 4)
+	{
+		f32x4 sum = splat4(0.f);
+		for (u32 k = 0; k < taps.Taps; ++k, ++index, ++weight)
+			sum = add4(sum, mul4(load4(in + *index * 4), splat4(*weight)));
+		store4(out, sum);
+	}
+}
+
+//! Resamples a band of target rows
+/** The source rows the band needs are filtered horizontally first, then
+each target row is summed up from them. */
+void resampleRows(void* data)
+{
+	const SResampleJob& job = *(const SResampleJob*)data;
+	const SResample& r = *job.Resample;
+	const SResampleTaps& vertical = r.Vertical;
+	const u32 rowFloats = r.TargetSize.Width * 4;
+
+	u32 firstSource = r.SourceSize.Height;
+	u32 lastSource = 0;
+	for (u32 i = job.FirstRow * vertical.Taps; i < job.EndRow * vertical.Taps; ++i)
+	{
+		if (vertical.Weight[i] == 0.f)
+			continue;
+		firstSource = core::min_(firstSource, vertical.Index[i]);
+		lastSource = core::max_(lastSource, vertical.Index[i]);
+	}
+	if (firstSource > lastSource)
+		firstSource = lastSource = 0;
+
+	core::array<f32> decoded;
+	decoded.set_used(r.SourceSize.Width * 4);
+	core::array<f32> filtered;
+	filtered.set_used((lastSource - firstSource + 1) * rowFloats);
+
+	for (u32 y = firstSource; y <= lastSource; ++y)
+	{
+		const u8* in = r.Source + (size_t)y * r.SourcePitch;
+		if (r.SRGB && isSRGBFormat(r.SourceFormat))
+			decodeRowSRGB(in, r.SourceFormat, r.SourceSize.Width, decoded.pointer(), *r.SRGB);
+		else
+			decodeRow(in, r.SourceFormat, r.SourceSize.Width, decoded.pointer());
+		filterRow(decoded.const_pointer(), r.Horizontal, r.TargetSize.Width, &filtered[(y - firstSource) * rowFloats]);
+	}
+
+	core::array<f32> row;
+	row.set_used(rowFloats);
+	for (u32 y = job.FirstRow; y < job.EndRow; ++y)
+	{
+		f32* out = row.pointer();
+		for (u32 i = 0; i < rowFloats; i += 4)
+			store4(out + i, splat4(0.f));
+
+		for (u32 k = 0; k < vertical.Taps; ++k)
+		{
+			const f32 weight = vertical.Weight[y * vertical.Taps + k];
+			if (weight == 0.f)
+				continue;
+
+			const f32* in = &filtered[(vertical.Index[y * vertical.Taps + k] - firstSource) * rowFloats];
+			const f32x4 w = splat4(weight);
+			for (u32 i = 0; i < rowFloats; i += 4)
+				store4(out + i, add4(load4(out + i), mul4(load4(in + i), w)));
+		}
+
+		u8* target = r.Target + (size_t)y * r.TargetPitch;
+		if (r.SRGB && isSRGBFormat(r.TargetFormat))
+			encodeRowSRGB(out, r.TargetFormat, r.TargetSize.Width, target, *r.SRGB);
+		else
+			encodeRow(out, r.TargetFormat, r.TargetSize.Width, target);
+	}
+}
+
+} // end anonymous namespace
+
+
+bool isResampleFormat(ECOLOR_FORMAT format)
+{
+	switch (format)
+	{
+	case ECF_A1R5G5B5:
+	case ECF_R5G6B5:
+	case ECF_R8G8B8:
+	case ECF_A8R8G8B8:
+	case ECF_R16F:
+	case ECF_G16R16F:
+	case ECF_A16B16G16R16F:
+	case ECF_R32F:
+	case ECF_G32R32F:
+	case ECF_A32B32G32R32F:
+	case ECF_R8:
+	case ECF_R8G8:
+	case ECF_R16:
+	case ECF_R16G16:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+bool resampleImage(const u8* source, ECOLOR_FORMAT sourceFormat,
+	const core::dimension2d<u32>& sourceSize, u32 sourcePitch,
+	u8* target, ECOLOR_FORMAT targetFormat,
+	const core::dimension2d<u32>& targetSize, u32 targetPitch,
+	E_IMAGE_SCALING_FILTER filter, bool srgb)
+{
+	if (!isResampleFormat(sourceFormat) || !isResampleFormat(targetFormat))
+		return false;
+
+	if (!source || !target || !sourceSize.Width || !sourceSize.Height || !targetSize.Width || !targetSize.Height)
+		return true;
+
+	SResample r;
+	r.Source = source;
+	r.SourceFormat = sourceFormat;
+	r.SourceSize = sourceSize;
+	r.SourcePitch = sourcePitch;
+	r.Target = target;
+	r.TargetFormat = targetFormat;
+	r.TargetSize = targetSize;
+	r.TargetPitch = targetPitch;
+	r.SRGB = srgb ? &getSRGBTables() : 0;
+	computeTaps(r.Horizontal, sourceSize.Width, targetSize.Width, filter);
+	computeTaps(r.Vertical, sourceSize.Height, targetSize.Height, filter);
+
+	// the bands also bound the memory of the horizontally filtered rows
+	const u32 bandCount = (targetSize.Height + RESAMPLE_BAND_ROWS - 1) / RESAMPLE_BAND_ROWS;
+	core::array<SResampleJob> jobs;
+	jobs.set_used(bandCount);
+	for (u32 i = 0; i < bandCount; ++i)
+	{
+		jobs[i].Resample = &r;
+		jobs[i].FirstRow = i * RESAMPLE_BAND_ROWS;
+		jobs[i].EndRow = core::min_(targetSize.Height, (i + 1) * RESAMPLE_BAND_ROWS);
+	}
+
+	const u32 cores = std::thread::hardware_concurrency();
+	if (bandCount > 1 && cores > 1 && targetSize.getArea() >= PARALLEL_RESAMPLE_MIN_PIXELS)
+	{
+		scene::CJobSystem jobSystem(core::min_(cores, bandCount) - 1);
+		for (u32 i = 0; i < bandCount; ++i)
+			jobSystem.add(resampleRows, &jobs[i]);
+		jobSystem.wait();
+	}
+	else
+	{
+		for (u32 i = 0; i < bandCount; ++i)
+			resampleRows(&jobs[i]);
+	}
+
+	return true;
+}
+
+} // end namespace video
+} // end namespace irr
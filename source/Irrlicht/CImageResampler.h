@@ -0,0 +1,33 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IMAGE_RESAMPLER_H_INCLUDED__
+#define __C_IMAGE_RESAMPLER_H_INCLUDED__
+
+#include "IImage.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Returns if resampleImage() can read and write a color format
+bool isResampleFormat(ECOLOR_FORMAT format);
+
+//! Resamples the pixels of an image into another size with a separable filter
+/** The rows are filtered horizontally, then vertically, in floating point
+with 4 channels. The formats may differ, the pixels are converted on the way.
+Large targets are split into bands of rows which are resampled on several threads.
+\param srgb Filter the colors of R8G8B8 and A8R8G8B8 in linear space, they
+are sRGB coded on both sides then.
+\return False if one of the formats isn't supported, nothing is written then. */
+bool resampleImage(const u8* source, ECOLOR_FORMAT sourceFormat,
+	const core::dimension2d<u32>& sourceSize, u32 sourcePitch,
+	u8* target, ECOLOR_FORMAT targetFormat,
+	const core::dimension2d<u32>& targetSize, u32 targetPitch,
+	E_IMAGE_SCALING_FILTER filter, bool srgb = false);
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -11,6 +11,7 @@
 #include "os.h" // for logging
 
 #include <png.h> // use system lib png
+#include <zlib.h>
 
 namespace irr
 {
@@ -91,6 +92,21 @@ bool CImageWriterPNG::writeImage(io::IWriteFile* file, IImage* image,u32 param)
 
 	png_set_write_fn(png_ptr, file, user_write_data_fcn, NULL);
 
+	// speed against size, see E_PNG_WRITE_PARAM
+	if (param & EPWP_LEVEL_MASK)
+		png_set_compression_level(png_ptr, core::min_(param & EPWP_LEVEL_MASK, 9u));
+	if (param & EPWP_ZLIB_RLE)
+		png_set_compression_strategy(png_ptr, Z_RLE);
+	if (param & (EPWP_FILTER_NONE | EPWP_FILTER_SUB | EPWP_FILTER_UP | EPWP_FILTER_AVG | EPWP_FILTER_PAETH))
+	{
+		const int filters = ((param & EPWP_FILTER_NONE) ? PNG_FILTER_NONE : 0) |
+			((param & EPWP_FILTER_SUB) ? PNG_FILTER_SUB : 0) |
+			((param & EPWP_FILTER_UP) ? PNG_FILTER_UP : 0) |
+			((param & EPWP_FILTER_AVG) ? PNG_FILTER_AVG : 0) |
+			((param & EPWP_FILTER_PAETH) ? PNG_FILTER_PAETH : 0);
+		png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filters);
+	}
+
 	// Set info
 	switch(image->getColorFormat())
 	{
@@ -123,36 +139,31 @@ bool CImageWriterPNG::writeImage(io::IWriteFile* file, IImage* image,u32 param)
 	default:
 		break;
 	}
-	u8* tmpImage = new u8[image->getDimension().Height*lineWidth];
-	if (!tmpImage)
-	{
-		os::Printer::log("PNGWriter: Internal PNG create image failure", file->getFileName(), ELL_ERROR);
-		png_destroy_write_struct(&png_ptr, &info_ptr);
-		return false;
-	}
-
+	// libpng copies each row before transforming it, so 24 and 32 bit images are written without a copy
+	u8* tmpImage = 0;
 	u8* data = (u8*)image->getData();
 	switch(image->getColorFormat())
 	{
 	case ECF_R8G8B8:
-		CColorConverter::convert_R8G8B8toR8G8B8(data,image->getDimension().Height*image->getDimension().Width,tmpImage);
-		break;
 	case ECF_A8R8G8B8:
-		CColorConverter::convert_A8R8G8B8toA8R8G8B8(data,image->getDimension().Height*image->getDimension().Width,tmpImage);
+		lineWidth = image->getPitch();
 		break;
 	case ECF_R5G6B5:
+		tmpImage = new u8[image->getDimension().Height*lineWidth];
 		CColorConverter::convert_R5G6B5toR8G8B8(data,image->getDimension().Height*image->getDimension().Width,tmpImage);
 		break;
 	case ECF_A1R5G5B5:
+		tmpImage = new u8[image->getDimension().Height*lineWidth];
 		CColorConverter::convert_A1R5G5B5toA8R8G8B8(data,image->getDimension().Height*image->getDimension().Width,tmpImage);
 		break;
 		// TODO: Error handling in case of unsupported color format
 	default:
 		os::Printer::log("CImageWriterPNG does not support image format", ColorFormatNames[image->getColorFormat()], ELL_WARNING);
 		png_destroy_write_struct(&png_ptr, &info_ptr);
-		delete [] tmpImage;
 		return false;
 	}
+	if (tmpImage)
+		data = tmpImage;
 
 	// Create array of pointers to rows in image data
 
@@ -166,7 +177,6 @@ bool CImageWriterPNG::writeImage(io::IWriteFile* file, IImage* image,u32 param)
 		return false;
 	}
 
-	data=tmpImage;
 	// Fill array of pointers to rows in image data
 	for (u32 i=0; i<image->getDimension().Height; ++i)
 	{
@@ -0,0 +1,154 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInflateReadFile.h"
+#include "irrMath.h"
+#include "os.h"
+
+namespace irr
+{
+namespace io
+{
+
+
+CInflateReadFile::CInflateReadFile(IReadFile* alreadyOpenedFile, long pos, long compressedSize,
+		long size, const io::path& name)
+	: Filename(name), File(alreadyOpenedFile), AreaStart(pos), CompressedSize(compressedSize),
+	CompressedPos(0), Size(size), Pos(0), StreamOk(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CInflateReadFile");
+	#endif
+
+	memset(&Stream, 0, sizeof(Stream));
+	if (File)
+	{
+		File->grab();
+
+		// wbits < 0 indicates no zlib header inside the data.
+		StreamOk = inflateInit2(&Stream, -MAX_WBITS) == Z_OK;
+	}
+}
+
+
+CInflateReadFile::~CInflateReadFile()
+{
+	if (File)
+	{
+		inflateEnd(&Stream);
+		File->drop();
+	}
+}
+
+
+//! returns how much was read
+size_t CInflateReadFile::read(void* buffer, size_t sizeToRead)
+{
+	if (!StreamOk)
+		return 0;
+
+	const long toRead = core::min_((long)sizeToRead, Size - Pos);
+	if (toRead <= 0)
+		return 0;
+
+	Stream.next_out = (Bytef*)buffer;
+	Stream.avail_out = (uInt)toRead;
+
+	while (Stream.avail_out)
+	{
+		if (!Stream.avail_in)
+		{
+			// the archive file is shared, so it is read at a position
+			const long count = core::min_((long)sizeof(Input), CompressedSize - CompressedPos);
+			if (count <= 0)
+				break;
+
+			const long r = (long)File->readAt(AreaStart + CompressedPos, Input, count);
+			if (r <= 0)
+				break;
+
+			CompressedPos += r;
+			Stream.next_in = (Bytef*)Input;
+			Stream.avail_in = (uInt)r;
+		}
+
+		const s32 err = inflate(&Stream, Z_NO_FLUSH);
+		if (err == Z_STREAM_END)
+			break;
+
+		if (err != Z_OK)
+		{
+			os::Printer::log("Error decompressing", Filename, ELL_ERROR);
+			StreamOk = false;
+			break;
+		}
+	}
+
+	const long r = toRead - (long)Stream.avail_out;
+	Pos += r;
+	return (size_t)r;
+}
+
+
+//! changes position in file, returns true if successful
+bool CInflateReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > Size)
+		return false;
+
+	if (finalPos < Pos && !reset())
+		return false;
+
+	// the data up to the new position has to be decompressed anyway
+	u8 skipped[4096];
+	while (Pos < finalPos)
+	{
+		if (!read(skipped, (size_t)core::min_((long)sizeof(skipped), finalPos - Pos)))
+			return false;
+	}
+
+	return true;
+}
+
+
+//! returns size of file
+long CInflateReadFile::getSize() const
+{
+	return Size;
+}
+
+
+//! returns where in the file we are.
+long CInflateReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CInflateReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+//! starts decompressing from the beginning of the file again
+bool CInflateReadFile::reset()
+{
+	if (!File)
+		return false;
+
+	Stream.next_in = 0;
+	Stream.avail_in = 0;
+	CompressedPos = 0;
+	Pos = 0;
+	StreamOk = inflateReset(&Stream) == Z_OK;
+	return StreamOk;
+}
+
+
+} // end namespace io
+} // end namespace irr
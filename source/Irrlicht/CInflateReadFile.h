@@ -0,0 +1,81 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INFLATE_READ_FILE_H_INCLUDED__
+#define __C_INFLATE_READ_FILE_H_INCLUDED__
+
+#include "IReadFile.h"
+#include "irrString.h"
+
+#include <zlib.h> // use system lib
+
+namespace irr
+{
+namespace io
+{
+
+	/*!
+		Class for reading a deflated area of another file, decompressing it
+		while it is read. Used for the large files of zip archives, so they
+		are never held in memory completely. Reading forward is cheap, seeking
+		backward starts decompressing from the beginning again.
+	*/
+	class CInflateReadFile : public IReadFile
+	{
+	public:
+
+		//! Constructor
+		/** \param alreadyOpenedFile File with the deflated data, it is grabbed.
+		\param pos Start of the deflated data in alreadyOpenedFile.
+		\param compressedSize Size of the deflated data.
+		\param size Size of the data after decompressing it.
+		\param name Name of the file. */
+		CInflateReadFile(IReadFile* alreadyOpenedFile, long pos, long compressedSize,
+			long size, const io::path& name);
+
+		//! Destructor
+		virtual ~CInflateReadFile();
+
+		//! returns how much was read
+		size_t read(void* buffer, size_t sizeToRead) override;
+
+		//! changes position in file, returns true if successful
+		bool seek(long finalPos, bool relativeMovement = false) override;
+
+		//! returns size of file
+		long getSize() const override;
+
+		//! returns where in the file we are.
+		long getPos() const override;
+
+		//! returns name of file
+		const io::path& getFileName() const override;
+
+		//! Get the type of the class implementing this interface
+		EREAD_FILE_TYPE getType() const override
+		{
+			return ERFT_INFLATE_READ_FILE;
+		}
+
+	private:
+
+		//! starts decompressing from the beginning of the file again
+		bool reset();
+
+		io::path Filename;
+		IReadFile* File;
+		long AreaStart;
+		long CompressedSize;
+		//! how much of the deflated data was read from File
+		long CompressedPos;
+		long Size;
+		long Pos;
+		z_stream Stream;
+		bool StreamOk;
+		u8 Input[16384];
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
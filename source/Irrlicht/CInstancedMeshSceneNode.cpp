@@ -0,0 +1,375 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CInstancedMeshSceneNode.h"
+#include "IVideoDriver.h"
+#include "ISceneManager.h"
+#include "ICameraSceneNode.h"
+#include "SViewFrustum.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CInstancedMeshSceneNode::CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IInstancedMeshSceneNode(parent, mgr, id, position, rotation, scale),
+	CasterInstancesValid(false), BoxDirty(true), Mesh(0), PassCount(0), ReadOnlyMaterials(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CInstancedMeshSceneNode");
+	#endif
+
+	setMesh(mesh);
+}
+
+
+//! destructor
+CInstancedMeshSceneNode::~CInstancedMeshSceneNode()
+{
+	if (Mesh)
+		Mesh->drop();
+}
+
+
+//! frame
+void CInstancedMeshSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible && Mesh && !Instances.empty())
+	{
+		video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+		PassCount = 0;
+		CasterInstancesValid = false;
+		int transparentCount = 0;
+		int solidCount = 0;
+
+		// casters are registered even when culled, their shadows may still be visible
+		SceneManager->registerNodeForRendering(this, scene::ESNRP_SHADOW);
+
+		// count transparent and solid materials in this scene node
+		const u32 numMaterials = ReadOnlyMaterials ? Mesh->getMeshBufferCount() : Materials.size();
+		for (u32 i=0; i<numMaterials; ++i)
+		{
+			const video::SMaterial& material = ReadOnlyMaterials ? Mesh->getMeshBuffer(i)->getMaterial() : Materials[i];
+
+			if ( driver->needsTransparentRenderPass(material) )
+				++transparentCount;
+			else
+				++solidCount;
+
+			if (solidCount && transparentCount)
+				break;
+		}
+
+		// register according to material types counted
+
+		if (solidCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_SOLID);
+
+		if (transparentCount)
+			SceneManager->registerNodeForRendering(this, scene::ESNRP_TRANSPARENT);
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! renders the node.
+void CInstancedMeshSceneNode::render()
+{
+	video::IVideoDriver* driver = SceneManager->getVideoDriver();
+
+	if (!Mesh || !driver)
+		return;
+
+	const E_SCENE_NODE_RENDER_PASS pass = SceneManager->getSceneNodeRenderPass();
+
+	// all instances cast shadows, also those outside of the view of the camera.
+	// The shadow pass draws each cascade, so they are transformed only once.
+	if (pass == scene::ESNRP_SHADOW)
+	{
+		if (!CasterInstancesValid)
+		{
+			transformInstances(CasterInstances);
+			CasterInstancesValid = true;
+		}
+		if (!CasterInstances.empty())
+			drawInstances(driver, CasterInstances, false);
+		return;
+	}
+
+	// the camera doesn't move between the passes of a frame
+	if (PassCount == 0)
+		cullInstances();
+	// the depth pre-pass draws the solid buffers once more, without debug data
+	if (pass != scene::ESNRP_DEPTH_PREPASS)
+		++PassCount;
+
+	if (VisibleInstances.empty())
+		return;
+
+	drawInstances(driver, VisibleInstances, pass == scene::ESNRP_TRANSPARENT);
+
+	// for debug purposes only:
+	if (DebugDataVisible && PassCount==1)
+	{
+		video::SMaterial m;
+		m.Lighting = false;
+		m.AntiAliasing=0;
+		driver->setMaterial(m);
+		driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
+
+		if (DebugDataVisible & scene::EDS_BBOX)
+		{
+			driver->draw3DBox(getBoundingBox(), video::SColor(255,255,255,255));
+		}
+	}
+}
+
+
+void CInstancedMeshSceneNode::drawInstances(video::IVideoDriver* driver, const core::array<video::S3DInstance>& instances, bool transparent)
+{
+	for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+	{
+		scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+		if (mb)
+		{
+			const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+
+			// only render transparent buffer if this is the transparent render pass
+			// and solid only in solid pass
+			if (driver->needsTransparentRenderPass(material) == transparent)
+			{
+				driver->setMaterial(material);
+				driver->drawMeshBufferInstanced(mb, instances.const_pointer(), instances.size());
+			}
+		}
+	}
+}
+
+
+void CInstancedMeshSceneNode::transformInstances(core::array<video::S3DInstance>& out) const
+{
+	const u32 count = Instances.size();
+	out.set_used(count);
+	for (u32 i=0; i<count; ++i)
+	{
+		out[i] = Instances[i];
+		out[i].Transform = AbsoluteTransformation * Instances[i].Transform;
+	}
+}
+
+
+void CInstancedMeshSceneNode::cullInstances()
+{
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	const SViewFrustum* frustum = (camera && AutomaticCullingState != EAC_OFF) ? camera->getViewFrustum() : 0;
+	const core::aabbox3d<f32>& meshBox = Mesh->getBoundingBox();
+
+	transformInstances(VisibleInstances);
+	const u32 count = VisibleInstances.size();
+
+	if (!frustum)
+		return;
+
+	// classify all instance boxes in one batch, then drop the ones outside
+	InstanceBoxes.set_used(count);
+	InstanceRelations.set_used(count);
+	for (u32 i=0; i<count; ++i)
+	{
+		InstanceBoxes[i] = meshBox;
+		VisibleInstances[i].Transform.transformBoxEx(InstanceBoxes[i]);
+	}
+
+	frustum->getPackedPlanes().classifyBoxes(InstanceBoxes.const_pointer(), count, InstanceRelations.pointer());
+
+	u32 visible = 0;
+	for (u32 i=0; i<count; ++i)
+	{
+		if (InstanceRelations[i] == core::ISREL3D_FRONT)
+			continue;
+		if (visible != i)
+			VisibleInstances[visible] = VisibleInstances[i];
+		++visible;
+	}
+	VisibleInstances.set_used(visible);
+}
+
+
+//! returns the axis aligned bounding box enclosing all instances
+const core::aabbox3d<f32>& CInstancedMeshSceneNode::getBoundingBox() const
+{
+	if (BoxDirty)
+	{
+		const core::aabbox3d<f32> meshBox = Mesh ? Mesh->getBoundingBox() : core::aabbox3d<f32>(0,0,0,0,0,0);
+		Box = meshBox;
+		for (u32 i=0; i<Instances.size(); ++i)
+		{
+			core::aabbox3d<f32> box = meshBox;
+			Instances[i].Transform.transformBoxEx(box);
+			if (i == 0)
+				Box = box;
+			else
+				Box.addInternalBox(box);
+		}
+		BoxDirty = false;
+	}
+	return Box;
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CInstancedMeshSceneNode::getMaterial(u32 i)
+{
+	if (Mesh && ReadOnlyMaterials && i<Mesh->getMeshBufferCount())
+	{
+		ReadOnlyMaterial = Mesh->getMeshBuffer(i)->getMaterial();
+		return ReadOnlyMaterial;
+	}
+
+	if (i >= Materials.size())
+		return ISceneNode::getMaterial(i);
+
+	return Materials[i];
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CInstancedMeshSceneNode::getMaterialCount() const
+{
+	if (Mesh && ReadOnlyMaterials)
+		return Mesh->getMeshBufferCount();
+
+	return Materials.size();
+}
+
+
+//! Sets a new mesh
+void CInstancedMeshSceneNode::setMesh(IMesh* mesh)
+{
+	if (mesh)
+	{
+		mesh->grab();
+		if (Mesh)
+			Mesh->drop();
+
+		Mesh = mesh;
+		copyMaterials();
+		BoxDirty = true;
+		updateSpatialIndex();
+	}
+}
+
+
+void CInstancedMeshSceneNode::copyMaterials()
+{
+	Materials.clear();
+
+	if (Mesh)
+	{
+		video::SMaterial mat;
+
+		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		{
+			IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			if (mb)
+				mat = mb->getMaterial();
+
+			Materials.push_back(mat);
+		}
+	}
+}
+
+
+//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+void CInstancedMeshSceneNode::setReadOnlyMaterials(bool readonly)
+{
+	ReadOnlyMaterials = readonly;
+}
+
+
+//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+bool CInstancedMeshSceneNode::isReadOnlyMaterials() const
+{
+	return ReadOnlyMaterials;
+}
+
+
+//! Adds an instance
+u32 CInstancedMeshSceneNode::addInstance(const video::S3DInstance& instance)
+{
+	Instances.push_back(instance);
+	BoxDirty = true;
+	updateSpatialIndex();
+	return Instances.size() - 1;
+}
+
+
+//! Replaces the data of an instance
+void CInstancedMeshSceneNode::setInstance(u32 index, const video::S3DInstance& instance)
+{
+	Instances[index] = instance;
+	BoxDirty = true;
+	updateSpatialIndex();
+}
+
+
+//! Get the data of an instance
+const video::S3DInstance& CInstancedMeshSceneNode::getInstance(u32 index) const
+{
+	return Instances[index];
+}
+
+
+//! Removes an instance
+void CInstancedMeshSceneNode::removeInstance(u32 index)
+{
+	if (index >= Instances.size())
+		return;
+
+	Instances[index] = Instances.getLast();
+	Instances.erase(Instances.size() - 1);
+	BoxDirty = true;
+	updateSpatialIndex();
+}
+
+
+//! Removes all instances
+void CInstancedMeshSceneNode::clearInstances()
+{
+	Instances.clear();
+	VisibleInstances.clear();
+	BoxDirty = true;
+	updateSpatialIndex();
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CInstancedMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CInstancedMeshSceneNode* nb = new CInstancedMeshSceneNode(Mesh, newParent,
+		newManager, ID, RelativeTranslation, RelativeRotation, RelativeScale);
+
+	nb->cloneMembers(this, newManager);
+	nb->ReadOnlyMaterials = ReadOnlyMaterials;
+	nb->Materials = Materials;
+	nb->Instances = Instances;
+
+	if (newParent)
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
+
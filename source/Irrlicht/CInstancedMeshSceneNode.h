@@ -0,0 +1,128 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+#define __C_INSTANCED_MESH_SCENE_NODE_H_INCLUDED__
+
+#include "IInstancedMeshSceneNode.h"
+#include "IMesh.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+} // end namespace video
+
+namespace scene
+{
+
+	class CInstancedMeshSceneNode : public IInstancedMeshSceneNode
+	{
+	public:
+
+		//! constructor
+		CInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CInstancedMeshSceneNode();
+
+		//! frame
+		void OnRegisterSceneNode() override;
+
+		//! renders the node.
+		void render() override;
+
+		//! returns the axis aligned bounding box enclosing all instances
+		const core::aabbox3d<f32>& getBoundingBox() const override;
+
+		//! returns the material based on the zero based index i.
+		video::SMaterial& getMaterial(u32 i) override;
+
+		//! returns amount of materials used by this scene node.
+		u32 getMaterialCount() const override;
+
+		//! Returns type of the scene node
+		ESCENE_NODE_TYPE getType() const override { return ESNT_INSTANCED_MESH; }
+
+		//! Sets a new mesh
+		void setMesh(IMesh* mesh) override;
+
+		//! Returns the current mesh
+		IMesh* getMesh(void) override { return Mesh; }
+
+		//! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
+		void setReadOnlyMaterials(bool readonly) override;
+
+		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
+		bool isReadOnlyMaterials() const override;
+
+		//! Adds an instance
+		u32 addInstance(const video::S3DInstance& instance) override;
+
+		//! Replaces the data of an instance
+		void setInstance(u32 index, const video::S3DInstance& instance) override;
+
+		//! Get the data of an instance
+		const video::S3DInstance& getInstance(u32 index) const override;
+
+		//! Removes an instance
+		void removeInstance(u32 index) override;
+
+		//! Removes all instances
+		void clearInstances() override;
+
+		//! Get the number of instances
+		u32 getInstanceCount() const override { return Instances.size(); }
+
+		//! Get the number of instances which passed culling in the last rendered frame
+		u32 getVisibleInstanceCount() const override { return VisibleInstances.size(); }
+
+		//! Creates a clone of this scene node and its children.
+		ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) override;
+
+	protected:
+
+		void copyMaterials();
+
+		//! Collects the instances inside the view frustum, in world space
+		void cullInstances();
+
+		//! Transforms all instances into world space
+		void transformInstances(core::array<video::S3DInstance>& out) const;
+
+		//! Draws the buffers of the solid or the transparent materials
+		void drawInstances(video::IVideoDriver* driver, const core::array<video::S3DInstance>& instances, bool transparent);
+
+		core::array<video::SMaterial> Materials;
+		video::SMaterial ReadOnlyMaterial;
+
+		core::array<video::S3DInstance> Instances;
+		core::array<video::S3DInstance> VisibleInstances;
+
+		//! All instances in world space, for the shadow maps
+		core::array<video::S3DInstance> CasterInstances;
+		bool CasterInstancesValid;
+
+		//! World space instance boxes and their frustum relations, kept for reuse
+		core::array<core::aabbox3d<f32> > InstanceBoxes;
+		core::array<core::EIntersectionRelation3D> InstanceRelations;
+
+		//! Union of the instance boxes, rebuilt on demand
+		mutable core::aabbox3d<f32> Box;
+		mutable bool BoxDirty;
+
+		IMesh* Mesh;
+
+		s32 PassCount;
+		bool ReadOnlyMaterials;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
+
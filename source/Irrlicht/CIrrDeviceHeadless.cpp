@@ -0,0 +1,194 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CIrrDeviceHeadless.h"
+
+#ifdef _IRR_COMPILE_WITH_HEADLESS_DEVICE_
+
+#include <sys/utsname.h>
+#include <time.h>
+#include "IGUIEnvironment.h"
+#include "ISceneManager.h"
+#include "os.h"
+#include "COSOperator.h"
+#include "SIrrCreationParameters.h"
+#include "SExposedVideoData.h"
+#include "CEGLManager.h"
+
+namespace irr
+{
+	namespace video
+	{
+#ifdef _IRR_COMPILE_WITH_OGLES1_
+		IVideoDriver* createOGLES1Driver(const irr::SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager);
+#endif
+
+#ifdef _IRR_COMPILE_WITH_OGLES2_
+		IVideoDriver* createOGLES2Driver(const irr::SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager);
+#endif
+
+#ifdef _IRR_COMPILE_WITH_WEBGL1_
+		IVideoDriver* createWebGL1Driver(const irr::SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager);
+#endif
+	}
+} // end namespace irr
+
+namespace irr
+{
+//! constructor
+CIrrDeviceHeadless::CIrrDeviceHeadless(const SIrrlichtCreationParameters& param)
+	: CIrrDeviceStub(param)
+{
+	#ifdef _DEBUG
+	setDebugName("CIrrDeviceHeadless");
+	#endif
+
+	core::stringc osversion;
+	struct utsname info;
+	uname(&info);
+
+	osversion += info.sysname;
+	osversion += " ";
+	osversion += info.release;
+	osversion += " ";
+	osversion += info.version;
+	osversion += " ";
+	osversion += info.machine;
+
+	Operator = new COSOperator(osversion);
+	os::Printer::log(osversion.c_str(), ELL_INFORMATION);
+
+	CursorControl = new CCursorControl(CreationParams.WindowSize);
+
+	// create driver
+	createDriver();
+
+	if (!VideoDriver)
+		return;
+
+	createGUIAndScene();
+}
+
+
+//! destructor
+CIrrDeviceHeadless::~CIrrDeviceHeadless()
+{
+	// Take the context back from the render thread before freeing anything
+	if (VideoDriver)
+		VideoDriver->setRenderThreadEnabled(false);
+
+	// Must free OpenGL textures etc before destroying context, so can't wait for stub destructor
+	if (GUIEnvironment)
+	{
+		GUIEnvironment->drop();
+		GUIEnvironment = NULL;
+	}
+	if (SceneManager)
+	{
+		SceneManager->drop();
+		SceneManager = NULL;
+	}
+	if (VideoDriver)
+	{
+		VideoDriver->drop();
+		VideoDriver = NULL;
+	}
+}
+
+
+//! create the driver
+void CIrrDeviceHeadless::createDriver()
+{
+	switch(CreationParams.DriverType)
+	{
+	case video::EDT_OGLES1:
+#ifdef _IRR_COMPILE_WITH_OGLES1_
+		{
+			ContextManager = new video::CEGLManager();
+			if (ContextManager->initialize(CreationParams, video::SExposedVideoData()))
+				VideoDriver = video::createOGLES1Driver(CreationParams, FileSystem, ContextManager);
+		}
+#else
+		os::Printer::log("No OpenGL-ES1 support compiled in.", ELL_ERROR);
+#endif
+		break;
+	case video::EDT_OGLES2:
+#ifdef _IRR_COMPILE_WITH_OGLES2_
+		{
+			ContextManager = new video::CEGLManager();
+			if (ContextManager->initialize(CreationParams, video::SExposedVideoData()))
+				VideoDriver = video::createOGLES2Driver(CreationParams, FileSystem, ContextManager);
+		}
+#else
+		os::Printer::log("No OpenGL-ES2 support compiled in.", ELL_ERROR);
+#endif
+		break;
+	case video::EDT_WEBGL1:
+#ifdef _IRR_COMPILE_WITH_WEBGL1_
+		{
+			ContextManager = new video::CEGLManager();
+			if (ContextManager->initialize(CreationParams, video::SExposedVideoData()))
+				VideoDriver = video::createWebGL1Driver(CreationParams, FileSystem, ContextManager);
+		}
+#else
+		os::Printer::log("No WebGL1 support compiled in.", ELL_ERROR);
+#endif
+		break;
+	case video::EDT_NULL:
+		VideoDriver = video::createNullDriver(FileSystem, CreationParams.WindowSize);
+		break;
+	default:
+		os::Printer::log("The headless device only supports the OpenGL-ES and null drivers.", ELL_ERROR);
+		break;
+	}
+}
+
+
+//! runs the device. Returns false if device wants to be deleted
+bool CIrrDeviceHeadless::run()
+{
+	paceFrame();
+	os::Timer::tick();
+	runMainThreadJobs();
+
+	return !Close;
+}
+
+
+//! Pause the current process for the minimum time allowed only to allow other processes to execute
+void CIrrDeviceHeadless::yield()
+{
+	struct timespec ts = {0,1};
+	nanosleep(&ts, NULL);
+}
+
+
+//! Pause execution and let other processes to run for a specified amount of time.
+void CIrrDeviceHeadless::sleep(u32 timeMs, bool pauseTimer)
+{
+	const bool wasStopped = Timer ? Timer->isStopped() : true;
+
+	struct timespec ts;
+	ts.tv_sec = (time_t) (timeMs / 1000);
+	ts.tv_nsec = (long) (timeMs % 1000) * 1000000;
+
+	if (pauseTimer && !wasStopped)
+		Timer->stop();
+
+	nanosleep(&ts, NULL);
+
+	if (pauseTimer && !wasStopped)
+		Timer->start();
+}
+
+
+//! notifies the device that it should close itself
+void CIrrDeviceHeadless::closeDevice()
+{
+	Close = true;
+}
+
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_HEADLESS_DEVICE_
@@ -0,0 +1,138 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_IRR_DEVICE_HEADLESS_H_INCLUDED__
+#define __C_IRR_DEVICE_HEADLESS_H_INCLUDED__
+
+
+#ifdef _IRR_COMPILE_WITH_HEADLESS_DEVICE_
+
+#include "CIrrDeviceStub.h"
+#include "IrrlichtDevice.h"
+#include "ICursorControl.h"
+
+namespace irr
+{
+
+	//! Device without a window which renders with EGL to an offscreen pbuffer
+	/** Each device has its own EGL display connection, context and pbuffer, so several
+	devices can render in parallel when each is created and run on its own thread. */
+	class CIrrDeviceHeadless : public CIrrDeviceStub
+	{
+	public:
+
+		//! constructor
+		CIrrDeviceHeadless(const SIrrlichtCreationParameters& param);
+
+		//! destructor
+		virtual ~CIrrDeviceHeadless();
+
+		//! runs the device. Returns false if device wants to be deleted
+		bool run() override;
+
+		//! Cause the device to temporarily pause execution and let other processes to run
+		void yield() override;
+
+		//! Pause execution and let other processes to run for a specified amount of time.
+		void sleep(u32 timeMs, bool pauseTimer) override;
+
+		//! Does nothing, there is no window
+		void setWindowCaption(const wchar_t* text) override {}
+
+		//! Always true, the pbuffer is always drawn
+		bool isWindowActive() const override { return true; }
+
+		//! Always true, so the GUI keeps processing injected events
+		bool isWindowFocused() const override { return true; }
+
+		//! Always false
+		bool isWindowMinimized() const override { return false; }
+
+		//! notifies the device that it should close itself
+		void closeDevice() override;
+
+		//! Does nothing, the pbuffer size is fixed by SIrrlichtCreationParameters::WindowSize
+		void setResizable(bool resize=false) override {}
+
+		//! Does nothing
+		void minimizeWindow() override {}
+
+		//! Does nothing
+		void maximizeWindow() override {}
+
+		//! Does nothing
+		void restoreWindow() override {}
+
+		//! Always 0,0
+		core::position2di getWindowPosition() override { return core::position2di(0, 0); }
+
+		//! Get the device type
+		E_DEVICE_TYPE getType() const override
+		{
+			return EIDT_HEADLESS;
+		}
+
+	private:
+
+		//! create the driver
+		void createDriver();
+
+		//! Cursor control which only remembers the position set
+		class CCursorControl : public gui::ICursorControl
+		{
+		public:
+
+			CCursorControl(const core::dimension2d<u32>& size)
+				: Size(size), IsVisible(true) {}
+
+			void setVisible(bool visible) override { IsVisible = visible; }
+
+			bool isVisible() const override { return IsVisible; }
+
+			void setPosition(const core::position2d<f32> &pos) override
+			{
+				setPosition(pos.X, pos.Y);
+			}
+
+			void setPosition(f32 x, f32 y) override
+			{
+				setPosition((s32)(x*Size.Width), (s32)(y*Size.Height));
+			}
+
+			void setPosition(const core::position2d<s32> &pos) override
+			{
+				CursorPos = pos;
+			}
+
+			void setPosition(s32 x, s32 y) override
+			{
+				CursorPos.X = x;
+				CursorPos.Y = y;
+			}
+
+			const core::position2d<s32>& getPosition(bool updateCursor) override
+			{
+				return CursorPos;
+			}
+
+			core::position2d<f32> getRelativePosition(bool updateCursor) override
+			{
+				return core::position2d<f32>(CursorPos.X / (f32)Size.Width,
+					CursorPos.Y / (f32)Size.Height);
+			}
+
+			void setReferenceRect(core::rect<s32>* rect=0) override {}
+
+		private:
+
+			core::position2d<s32> CursorPos;
+			core::dimension2d<u32> Size;
+			bool IsVisible;
+		};
+	};
+
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_HEADLESS_DEVICE_
+#endif // __C_IRR_DEVICE_HEADLESS_H_INCLUDED__
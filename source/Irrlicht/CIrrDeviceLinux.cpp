@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/utsname.h>
+#include <sys/select.h>
 #include <time.h>
 #include <locale.h>
 #include "IEventReceiver.h"
@@ -115,7 +116,7 @@ CIrrDeviceLinux::CIrrDeviceLinux(const SIrrlichtCreationParameters& param)
 	HasNetWM(false),
 #endif
 #if defined(_IRR_LINUX_X11_XINPUT2_)
-	currentTouchedCount(0),
+	currentTouchedCount(0), RawMotionEnabled(false), RawMotionX(0.f), RawMotionY(0.f),
 #endif
 	Width(param.WindowSize.Width), Height(param.WindowSize.Height),
 	WindowHasFocus(false), WindowMinimized(false), WindowMaximized(param.WindowMaximized),
@@ -187,6 +188,10 @@ CIrrDeviceLinux::~CIrrDeviceLinux()
 		static_cast<CCursorControl*>(CursorControl)->clearCursors();
 	}
 
+	// Take the context back from the render thread before freeing anything
+	if ( VideoDriver )
+		VideoDriver->setRenderThreadEnabled(false);
+
 	// Must free OpenGL textures etc before destroying context, so can't wait for stub destructor
 	if ( GUIEnvironment )
 	{
@@ -321,6 +326,9 @@ bool CIrrDeviceLinux::createWindow()
 	XSetErrorHandler(IrrPrintXError);
 #endif
 
+	// The video driver may render from its own thread
+	XInitThreads();
+
 	XDisplay = XOpenDisplay(0);
 	if (!XDisplay)
 	{
@@ -707,7 +715,10 @@ EKEY_CODE CIrrDeviceLinux::getKeyCode(XEvent &event)
 //! runs the device. Returns false if device wants to be deleted
 bool CIrrDeviceLinux::run()
 {
+	// waits for the frame time before the input is read
+	paceFrame();
 	os::Timer::tick();
+	runMainThreadJobs();
 
 #ifdef _IRR_COMPILE_WITH_X11_
 
@@ -719,10 +730,15 @@ bool CIrrDeviceLinux::run()
 		SEvent irrevent;
 		irrevent.MouseInput.ButtonStates = 0xffffffff;
 
-		while (XPending(XDisplay) > 0 && !Close)
+		// XPending reads the connection on every call, so the queued events
+		// are taken in batches and the connection is only read again after them
+		bool hadEvents = false;
+		for (int pending = XPending(XDisplay); pending > 0 && !Close;
+			pending = pending > 1 ? pending - 1 : XPending(XDisplay))
 		{
 			XEvent event;
 			XNextEvent(XDisplay, &event);
+			hadEvents = true;
 			if (XFilterEvent(&event, None))
 				continue;
 
@@ -751,10 +767,18 @@ bool CIrrDeviceLinux::run()
 
 			case FocusIn:
 				WindowHasFocus=true;
+#if defined(_IRR_LINUX_X11_XINPUT2_)
+				if (RawMotionEnabled)
+					confinePointer(true);
+#endif
 				break;
 
 			case FocusOut:
 				WindowHasFocus=false;
+#if defined(_IRR_LINUX_X11_XINPUT2_)
+				if (RawMotionEnabled)
+					confinePointer(false);
+#endif
 				break;
 
 			case MotionNotify:
@@ -770,7 +794,7 @@ bool CIrrDeviceLinux::run()
 				irrevent.MouseInput.ButtonStates |= (event.xbutton.state & Button3Mask) ? irr::EMBSM_RIGHT : 0;
 				irrevent.MouseInput.ButtonStates |= (event.xbutton.state & Button2Mask) ? irr::EMBSM_MIDDLE : 0;
 
-				postEventFromUser(irrevent);
+				postEventFromSystem(irrevent);
 				break;
 
 			case ButtonPress:
@@ -831,7 +855,7 @@ bool CIrrDeviceLinux::run()
 
 				if (irrevent.MouseInput.Event != irr::EMIE_COUNT)
 				{
-					postEventFromUser(irrevent);
+					postEventFromSystem(irrevent);
 
 					if ( irrevent.MouseInput.Event >= EMIE_LMOUSE_PRESSED_DOWN && irrevent.MouseInput.Event <= EMIE_MMOUSE_PRESSED_DOWN )
 					{
@@ -1070,7 +1094,25 @@ bool CIrrDeviceLinux::run()
 			case GenericEvent:
 				{
 					XGenericEventCookie *cookie = &event.xcookie;
-					if (XGetEventData(XDisplay, cookie) && cookie->extension == XI_EXTENSIONS_OPCODE && XI_EXTENSIONS_OPCODE
+					if (!XGetEventData(XDisplay, cookie))
+						break;
+
+					if (cookie->extension == XI_EXTENSIONS_OPCODE && XI_EXTENSIONS_OPCODE
+					&& cookie->evtype == XI_RawMotion)
+					{
+						// raw events come from all windows, only the focused one should move
+						XIRawEvent *re = (XIRawEvent *) cookie->data;
+						const double *value = re->raw_values;
+						for (int i = 0; i < 2 && i < re->valuators.mask_len * 8; ++i)
+						{
+							if (!XIMaskIsSet(re->valuators.mask, i))
+								continue;
+							if (WindowHasFocus && RawMotionEnabled)
+								(i == 0 ? RawMotionX : RawMotionY) += (f32)*value;
+							++value;
+						}
+					}
+					else if (cookie->extension == XI_EXTENSIONS_OPCODE && XI_EXTENSIONS_OPCODE
 					&& (cookie->evtype == XI_TouchUpdate || cookie->evtype == XI_TouchBegin || cookie->evtype == XI_TouchEnd))
 					{
 						XIDeviceEvent *de = (XIDeviceEvent *) cookie->data;
@@ -1093,6 +1135,8 @@ bool CIrrDeviceLinux::run()
 
 						postEventFromUser(irrevent);
 					}
+
+					XFreeEventData(XDisplay, cookie);
 				}
 				break;
 #endif
@@ -1100,8 +1144,13 @@ bool CIrrDeviceLinux::run()
 			default:
 				break;
 			} // end switch
+		} // end while
+
+		postCoalescedEvent();
 
-			// Update IME information
+		// Update IME information, once for all events
+		if (hadEvents && !Close)
+		{
 			if (XInputContext && GUIEnvironment)
 			{
 				gui::IGUIElement *elem = GUIEnvironment->getFocus();
@@ -1119,9 +1168,7 @@ bool CIrrDeviceLinux::run()
 					XUnsetICFocus(XInputContext);
 				}
 			}
-
-		} // end while
-
+		}
 	}
 #endif //_IRR_COMPILE_WITH_X11_
 
@@ -1159,6 +1206,34 @@ void CIrrDeviceLinux::sleep(u32 timeMs, bool pauseTimer=false)
 }
 
 
+//! Blocks until the window system has events for the device, or the time passed
+bool CIrrDeviceLinux::waitForEvents(u32 timeoutMs)
+{
+#ifdef _IRR_COMPILE_WITH_X11_
+	if ((CreationParams.DriverType != video::EDT_NULL) && XDisplay)
+	{
+		// flushes the requests and reads what arrived already
+		if (XPending(XDisplay))
+			return true;
+
+		const int fd = ConnectionNumber(XDisplay);
+		fd_set fds;
+		FD_ZERO(&fds);
+		FD_SET(fd, &fds);
+		struct timeval tv;
+		tv.tv_sec = (time_t) (timeoutMs / 1000);
+		tv.tv_usec = (suseconds_t) (timeoutMs % 1000) * 1000;
+		select(fd + 1, &fds, NULL, NULL, &tv);
+
+		return XPending(XDisplay) > 0;
+	}
+#endif
+
+	sleep(timeoutMs, false);
+	return false;
+}
+
+
 //! sets the caption of the window
 void CIrrDeviceLinux::setWindowCaption(const wchar_t* text)
 {
@@ -1898,6 +1973,7 @@ void CIrrDeviceLinux::initXInput2()
 	if ( rc != Success )
 	{
 		os::Printer::log("No XI2 support.", ELL_WARNING);
+		XI_EXTENSIONS_OPCODE = 0;
 		return;
 	}
 
@@ -1918,6 +1994,54 @@ void CIrrDeviceLinux::initXInput2()
 }
 
 
+//! Selects the raw motion events of XInput2 and confines the pointer, or stops both
+bool CIrrDeviceLinux::setRawMotion(bool enable)
+{
+#if defined(_IRR_COMPILE_WITH_X11_) && defined(_IRR_LINUX_X11_XINPUT2_)
+	if (!XDisplay || !XI_EXTENSIONS_OPCODE)
+		return false;
+	if (enable == RawMotionEnabled)
+		return true;
+
+	// raw events are only sent to the root window, so they are independent of the cursor position
+	XIEventMask eventMask;
+	unsigned char mask[XIMaskLen(XI_RawMotion)];
+	memset(mask, 0, sizeof(mask));
+	eventMask.deviceid = XIAllMasterDevices;
+	eventMask.mask_len = sizeof(mask);
+	eventMask.mask = mask;
+	if (enable)
+		XISetMask(eventMask.mask, XI_RawMotion);
+	XISelectEvents(XDisplay, DefaultRootWindow(XDisplay), &eventMask, 1);
+
+	RawMotionEnabled = enable;
+	RawMotionX = 0.f;
+	RawMotionY = 0.f;
+	confinePointer(enable && WindowHasFocus);
+	XFlush(XDisplay);
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//! Keeps the pointer inside the window while in relative mode
+void CIrrDeviceLinux::confinePointer(bool confine)
+{
+#if defined(_IRR_COMPILE_WITH_X11_) && defined(_IRR_LINUX_X11_XINPUT2_)
+	if (confine)
+	{
+		XGrabPointer(XDisplay, XWindow, True,
+			ButtonPressMask | ButtonReleaseMask | PointerMotionMask,
+			GrabModeAsync, GrabModeAsync, XWindow, None, CurrentTime);
+	}
+	else
+		XUngrabPointer(XDisplay, CurrentTime);
+#endif
+}
+
+
 #ifdef _IRR_COMPILE_WITH_X11_
 
 Cursor CIrrDeviceLinux::TextureToMonochromeCursor(irr::video::ITexture * tex, const core::rect<s32>& sourceRect, const core::position2d<s32> &hotspot)
@@ -2245,6 +2369,28 @@ irr::core::dimension2di CIrrDeviceLinux::CCursorControl::getSupportedIconSize()
 	return core::dimension2di(width, height);
 }
 
+
+//! Reads the raw mouse movement with XInput2 and keeps the cursor in the window
+void CIrrDeviceLinux::CCursorControl::setRelativeMode(bool relative)
+{
+	if (!Null)
+		Device->setRawMotion(relative);
+}
+
+
+//! Returns the raw mouse movement accumulated since the last call
+core::vector2d<f32> CIrrDeviceLinux::CCursorControl::getRelativeMotion()
+{
+#if defined(_IRR_LINUX_X11_XINPUT2_)
+	const core::vector2d<f32> motion(Device->RawMotionX, Device->RawMotionY);
+	Device->RawMotionX = 0.f;
+	Device->RawMotionY = 0.f;
+	return motion;
+#else
+	return core::vector2d<f32>(0.f, 0.f);
+#endif
+}
+
 } // end namespace
 
 #endif // _IRR_COMPILE_WITH_X11_DEVICE_
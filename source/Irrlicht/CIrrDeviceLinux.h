@@ -51,6 +51,9 @@ namespace irr
 		//! Pause execution and let other processes to run for a specified amount of time.
 		void sleep(u32 timeMs, bool pauseTimer) override;
 
+		//! Blocks until the window system has events for the device, or the time passed
+		bool waitForEvents(u32 timeoutMs) override;
+
 		//! sets the caption of the window
 		void setWindowCaption(const wchar_t* text) override;
 
@@ -144,6 +147,12 @@ namespace irr
 
 		void initXInput2();
 
+		//! Selects the raw motion events of XInput2 and confines the pointer, or stops both
+		bool setRawMotion(bool enable);
+
+		//! Keeps the pointer inside the window while in relative mode
+		void confinePointer(bool confine);
+
 		bool switchToFullscreen();
 
 #ifdef _IRR_COMPILE_WITH_X11_
@@ -331,6 +340,12 @@ namespace irr
 			//! Return a system-specific size which is supported for cursors. Larger icons will fail, smaller icons might work.
 			core::dimension2di getSupportedIconSize() const override;
 
+			//! Reads the raw mouse movement with XInput2 and keeps the cursor in the window
+			void setRelativeMode(bool relative) override;
+
+			//! Returns the raw mouse movement accumulated since the last call
+			core::vector2d<f32> getRelativeMotion() override;
+
 #ifdef _IRR_COMPILE_WITH_X11_
 			//! Set platform specific behavior flags.
 			void setPlatformBehavior(gui::ECURSOR_PLATFORM_BEHAVIOR behavior) override {PlatformBehavior = behavior; }
@@ -429,6 +444,10 @@ namespace irr
 #endif
 #if defined(_IRR_LINUX_X11_XINPUT2_)
 		int currentTouchedCount;
+		//! raw mouse movement of the relative mode, accumulated until read
+		bool RawMotionEnabled;
+		f32 RawMotionX;
+		f32 RawMotionY;
 #endif
 		u32 Width, Height;
 		bool WindowHasFocus;
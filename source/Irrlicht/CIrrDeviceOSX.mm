@@ -782,7 +782,10 @@ bool CIrrDeviceMacOSX::run()
 	NSEvent *event;
 	irr::SEvent	ievent;
 
+	// waits for the frame time before the input is read
+	paceFrame();
 	os::Timer::tick();
+	runMainThreadJobs();
 	storeMouseLocation();
 
 	event = [NSApp nextEventMatchingMask:NSAnyEventMask untilDate:[NSDate distantPast] inMode:NSDefaultRunLoopMode dequeue:YES];
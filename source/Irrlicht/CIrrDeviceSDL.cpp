@@ -225,7 +225,7 @@ void CIrrDeviceSDL::resetReceiveTextInputEvents() {
 CIrrDeviceSDL::CIrrDeviceSDL(const SIrrlichtCreationParameters& param)
 	: CIrrDeviceStub(param),
 	Window((SDL_Window*)param.WindowId), SDL_Flags(0),
-	MouseX(0), MouseY(0), MouseXRel(0), MouseYRel(0), MouseButtonStates(0),
+	MouseX(0), MouseY(0), MouseXRel(0), MouseYRel(0), RelativeMotionX(0), RelativeMotionY(0), MouseButtonStates(0),
 	Width(param.WindowSize.Width), Height(param.WindowSize.Height),
 	Resizable(param.WindowResizable == 1 ? true : false)
 {
@@ -296,6 +296,9 @@ CIrrDeviceSDL::CIrrDeviceSDL(const SIrrlichtCreationParameters& param)
 //! destructor
 CIrrDeviceSDL::~CIrrDeviceSDL()
 {
+	if (VideoDriver)
+		VideoDriver->setRenderThreadEnabled(false);
+
 	if ( --SDLDeviceInstances == 0 )
 	{
 #if defined(_IRR_COMPILE_WITH_JOYSTICK_EVENTS_)
@@ -521,7 +524,10 @@ void CIrrDeviceSDL::createDriver()
 //! runs the device. Returns false if device wants to be deleted
 bool CIrrDeviceSDL::run()
 {
+	// waits for the frame time before the input is read
+	paceFrame();
 	os::Timer::tick();
+	runMainThreadJobs();
 
 	SEvent irrevent;
 	SDL_Event SDL_event;
@@ -539,13 +545,19 @@ bool CIrrDeviceSDL::run()
 			irrevent.MouseInput.Event = irr::EMIE_MOUSE_MOVED;
 			MouseX = irrevent.MouseInput.X = SDL_event.motion.x;
 			MouseY = irrevent.MouseInput.Y = SDL_event.motion.y;
-			MouseXRel = SDL_event.motion.xrel;
-			MouseYRel = SDL_event.motion.yrel;
+			// accumulated until the cursor control reads them, as moves might be merged
+			MouseXRel += SDL_event.motion.xrel;
+			MouseYRel += SDL_event.motion.yrel;
+			if (SDL_GetRelativeMouseMode())
+			{
+				RelativeMotionX += SDL_event.motion.xrel;
+				RelativeMotionY += SDL_event.motion.yrel;
+			}
 			irrevent.MouseInput.ButtonStates = MouseButtonStates;
 			irrevent.MouseInput.Shift = (keymod & KMOD_SHIFT) != 0;
 			irrevent.MouseInput.Control = (keymod & KMOD_CTRL) != 0;
 
-			postEventFromUser(irrevent);
+			postEventFromSystem(irrevent);
 			break;
 		}
 		case SDL_MOUSEWHEEL: {
@@ -559,7 +571,7 @@ bool CIrrDeviceSDL::run()
 			irrevent.MouseInput.X = MouseX;
 			irrevent.MouseInput.Y = MouseY;
 
-			postEventFromUser(irrevent);
+			postEventFromSystem(irrevent);
 			break;
 		}
 		case SDL_MOUSEBUTTONDOWN:
@@ -745,6 +757,8 @@ bool CIrrDeviceSDL::run()
 	resetReceiveTextInputEvents();
 	} // end while
 
+	postCoalescedEvent();
+
 #if defined(_IRR_COMPILE_WITH_JOYSTICK_EVENTS_)
 	// TODO: Check if the multiple open/close calls are too expensive, then
 	// open/close in the constructor/destructor instead
@@ -876,6 +890,16 @@ void CIrrDeviceSDL::SwapWindow()
 	SDL_GL_SwapWindow(Window);
 }
 
+bool CIrrDeviceSDL::MakeContextCurrent(bool current)
+{
+	if (SDL_GL_MakeCurrent(Window, current ? Context : NULL) != 0)
+	{
+		os::Printer::log("Could not change the current GL context", SDL_GetError(), ELL_ERROR);
+		return false;
+	}
+	return true;
+}
+
 
 
 //! pause execution temporarily
@@ -899,6 +923,14 @@ void CIrrDeviceSDL::sleep(u32 timeMs, bool pauseTimer)
 }
 
 
+//! Blocks until the window system has events for the device, or the time passed
+bool CIrrDeviceSDL::waitForEvents(u32 timeoutMs)
+{
+	// without an event to fill, the event stays queued for run()
+	return SDL_WaitEventTimeout(NULL, (int)timeoutMs) == 1;
+}
+
+
 //! sets the caption of the window
 void CIrrDeviceSDL::setWindowCaption(const wchar_t* text)
 {
@@ -1010,7 +1042,8 @@ bool CIrrDeviceSDL::isWindowFocused() const
 //! returns if window is minimized.
 bool CIrrDeviceSDL::isWindowMinimized() const
 {
-	return Window && (SDL_GetWindowFlags(Window) & SDL_WINDOW_MINIMIZED) != 0;
+	// hidden windows count as well, like unmapped ones on X11
+	return Window && (SDL_GetWindowFlags(Window) & (SDL_WINDOW_MINIMIZED | SDL_WINDOW_HIDDEN)) != 0;
 }
 
 
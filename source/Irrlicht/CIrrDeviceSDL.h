@@ -45,6 +45,9 @@ namespace irr
 		//! pause execution for a specified time
 		void sleep(u32 timeMs, bool pauseTimer) override;
 
+		//! Blocks until the window system has events for the device, or the time passed
+		bool waitForEvents(u32 timeoutMs) override;
+
 		//! sets the caption of the window
 		void setWindowCaption(const wchar_t* text) override;
 
@@ -96,6 +99,9 @@ namespace irr
 
 		void SwapWindow();
 
+		//! Makes the GL context current on the calling thread, or releases it
+		bool MakeContextCurrent(bool current);
+
 		//! Implementation of the linux cursor control
 		class CCursorControl : public gui::ICursorControl
 		{
@@ -187,6 +193,14 @@ namespace irr
 				}
 			}
 
+			core::vector2d<f32> getRelativeMotion() override
+			{
+				const core::vector2d<f32> motion((f32)Device->RelativeMotionX, (f32)Device->RelativeMotionY);
+				Device->RelativeMotionX = 0;
+				Device->RelativeMotionY = 0;
+				return motion;
+			}
+
 			void setActiveIcon(gui::ECURSOR_ICON iconId) override
 			{
 				ActiveIcon = iconId;
@@ -289,6 +303,8 @@ namespace irr
 
 		s32 MouseX, MouseY;
 		s32 MouseXRel, MouseYRel;
+		//! movement in relative mode, until the cursor control reads it
+		s32 RelativeMotionX, RelativeMotionY;
 		u32 MouseButtonStates;
 
 		u32 Width, Height;
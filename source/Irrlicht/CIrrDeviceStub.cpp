@@ -11,8 +11,12 @@
 #include "os.h"
 #include "CTimer.h"
 #include "CLogger.h"
+#include "CJobScheduler.h"
+#include "CProfiler.h"
+#include "CFrameCaptureDriver.h"
 #include "irrString.h"
 #include "IrrCompileConfig.h" // for IRRLICHT_SDK_VERSION
+#include <thread>
 
 namespace irr
 {
@@ -20,8 +24,11 @@ namespace irr
 CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 : IrrlichtDevice(), VideoDriver(0), GUIEnvironment(0), SceneManager(0),
 	Timer(0), CursorControl(0), UserReceiver(params.EventReceiver),
-	Logger(0), Operator(0), FileSystem(0),
-	InputReceivingSceneManager(0), ContextManager(0),
+	Logger(0), JobScheduler(0), Operator(0), FileSystem(0),
+	InputReceivingSceneManager(0),
+	CoalescedMouseEvents(1 << EMIE_MOUSE_MOVED), HasCoalescedEvent(false),
+	FramePacingTime(0), FramePacingSpin(0), MinimizedWaitTime(100),
+	ContextManager(0),
 	CreationParams(params), Close(false)
 {
 	Timer = new CTimer(params.UsePerformanceTimer);
@@ -37,9 +44,19 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 		os::Printer::Logger = Logger;
 	}
 	Logger->setLogLevel(CreationParams.LoggingLevel);
+	Logger->setAsynchronous(CreationParams.AsyncLogging);
 
 	os::Printer::Logger = Logger;
 
+	u32 jobThreads = (u32)core::max_(params.JobThreads, 0);
+	if (params.JobThreads < 0)
+	{
+		const u32 cores = std::thread::hardware_concurrency();
+		jobThreads = cores > 1 ? cores - 1 : 0;
+	}
+	JobScheduler = new CJobScheduler(jobThreads);
+	CJobScheduler::share(JobScheduler);
+
 	FileSystem = io::createFileSystem();
 
 	core::stringc s = "Irrlicht Engine version ";
@@ -52,6 +69,9 @@ CIrrDeviceStub::CIrrDeviceStub(const SIrrlichtCreationParameters& params)
 
 CIrrDeviceStub::~CIrrDeviceStub()
 {
+	if (VideoDriver)
+		VideoDriver->setRenderThreadEnabled(false);
+
 	if (GUIEnvironment)
 		GUIEnvironment->drop();
 
@@ -81,6 +101,10 @@ CIrrDeviceStub::~CIrrDeviceStub()
 	if (Timer)
 		Timer->drop();
 
+	// batches still running keep their grab on the scheduler
+	CJobScheduler::unshare(JobScheduler);
+	JobScheduler->drop();
+
 	if (Logger->drop())
 		os::Printer::Logger = 0;
 }
@@ -88,11 +112,19 @@ CIrrDeviceStub::~CIrrDeviceStub()
 
 void CIrrDeviceStub::createGUIAndScene()
 {
+	// everything which draws has to go through the capturing driver
+	if (CreationParams.FrameCapture && VideoDriver)
+	{
+		video::IVideoDriver* driver = video::createFrameCaptureDriver(VideoDriver);
+		VideoDriver->drop();
+		VideoDriver = driver;
+	}
+
 	// create gui environment
 	GUIEnvironment = gui::createGUIEnvironment(FileSystem, VideoDriver, Operator);
 
 	// create Scene manager
-	SceneManager = scene::createSceneManager(VideoDriver, CursorControl);
+	SceneManager = scene::createSceneManager(VideoDriver, FileSystem, CursorControl);
 
 	setEventReceiver(UserReceiver);
 }
@@ -136,6 +168,24 @@ ITimer* CIrrDeviceStub::getTimer()
 }
 
 
+//! Returns the profiler of the engine, 0 if it isn't compiled in
+IProfiler* CIrrDeviceStub::getProfiler()
+{
+#ifdef _IRR_COMPILE_WITH_PROFILER_
+	return &CProfiler::getInstance();
+#else
+	return 0;
+#endif
+}
+
+
+//! Returns the thread pool of the engine
+IJobScheduler* CIrrDeviceStub::getJobScheduler()
+{
+	return JobScheduler;
+}
+
+
 //! Returns the version of the engine.
 const char* CIrrDeviceStub::getVersion() const
 {
@@ -208,6 +258,9 @@ u32 CIrrDeviceStub::checkSuccessiveClicks(s32 mouseX, s32 mouseY, EMOUSE_INPUT_E
 //! send the event to the right receiver
 bool CIrrDeviceStub::postEventFromUser(const SEvent& event)
 {
+	// keep the order of events
+	postCoalescedEvent();
+
 	bool absorbed = false;
 
 	if (UserReceiver)
@@ -227,6 +280,134 @@ bool CIrrDeviceStub::postEventFromUser(const SEvent& event)
 }
 
 
+//! Posts an event received from the system, merging it with the previous one when enabled
+bool CIrrDeviceStub::postEventFromSystem(const SEvent& event)
+{
+	if (event.EventType != EET_MOUSE_INPUT_EVENT || !getEventCoalescing(event.MouseInput.Event))
+		return postEventFromUser(event);
+
+	if (HasCoalescedEvent &&
+		CoalescedEvent.MouseInput.Event == event.MouseInput.Event &&
+		CoalescedEvent.MouseInput.ButtonStates == event.MouseInput.ButtonStates &&
+		CoalescedEvent.MouseInput.Shift == event.MouseInput.Shift &&
+		CoalescedEvent.MouseInput.Control == event.MouseInput.Control)
+	{
+		const f32 wheel = CoalescedEvent.MouseInput.Wheel;
+		CoalescedEvent = event;
+		if (event.MouseInput.Event == EMIE_MOUSE_WHEEL)
+			CoalescedEvent.MouseInput.Wheel += wheel;
+		return false;
+	}
+
+	postCoalescedEvent();
+	CoalescedEvent = event;
+	HasCoalescedEvent = true;
+	return false;
+}
+
+
+//! Posts the event merged from previous ones, if there is one
+void CIrrDeviceStub::postCoalescedEvent()
+{
+	if (!HasCoalescedEvent)
+		return;
+
+	HasCoalescedEvent = false;
+	postEventFromUser(CoalescedEvent);
+}
+
+
+//! Sets if consecutive mouse input events of a type received from the system are merged.
+void CIrrDeviceStub::setEventCoalescing(EMOUSE_INPUT_EVENT type, bool merge)
+{
+	if (type != EMIE_MOUSE_MOVED && type != EMIE_MOUSE_WHEEL)
+		return;
+
+	if (merge)
+		CoalescedMouseEvents |= 1 << type;
+	else
+	{
+		CoalescedMouseEvents &= ~(1 << type);
+		if (HasCoalescedEvent && CoalescedEvent.MouseInput.Event == type)
+			postCoalescedEvent();
+	}
+}
+
+
+//! Checks if consecutive mouse input events of a type received from the system are merged.
+bool CIrrDeviceStub::getEventCoalescing(EMOUSE_INPUT_EVENT type) const
+{
+	return type < EMIE_COUNT && (CoalescedMouseEvents & (1 << type)) != 0;
+}
+
+
+//! Sleeps for the time, for devices which can't wait for their events
+bool CIrrDeviceStub::waitForEvents(u32 timeoutMs)
+{
+	sleep(timeoutMs, false);
+	return false;
+}
+
+
+//! Makes run() keep a steady time between frames
+void CIrrDeviceStub::setFramePacing(u32 frameTimeUs, u32 spinTimeUs)
+{
+	FramePacingTime = frameTimeUs;
+	FramePacingSpin = spinTimeUs;
+	NextFrameTime = std::chrono::steady_clock::now();
+}
+
+
+//! Makes run() wait for events while the window is minimized
+void CIrrDeviceStub::setMinimizedWaitTime(u32 timeoutMs)
+{
+	MinimizedWaitTime = timeoutMs;
+}
+
+
+//! Waits for the frame time of setFramePacing(), called by run() before reading the input
+void CIrrDeviceStub::paceFrame()
+{
+	// nothing drawn is shown, so the application loop waits for input instead of spinning
+	if (MinimizedWaitTime && isWindowMinimized())
+	{
+		waitForEvents(MinimizedWaitTime);
+		NextFrameTime = std::chrono::steady_clock::now();
+	}
+
+	if (!FramePacingTime)
+		return;
+
+	typedef std::chrono::steady_clock clock;
+	const std::chrono::microseconds spinTime(FramePacingSpin);
+	const std::chrono::microseconds frameTime(FramePacingTime);
+
+	// sleeping may overshoot, so the last part is spent spinning
+	clock::time_point now = clock::now();
+	while (NextFrameTime - now > spinTime)
+	{
+		std::this_thread::sleep_for(NextFrameTime - now - spinTime);
+		now = clock::now();
+	}
+	while (now < NextFrameTime)
+	{
+		std::this_thread::yield();
+		now = clock::now();
+	}
+
+	// a frame late by more than a frame time doesn't make the next ones catch up
+	NextFrameTime += frameTime;
+	if (NextFrameTime < now)
+		NextFrameTime = now + frameTime;
+}
+
+
+void CIrrDeviceStub::runMainThreadJobs()
+{
+	JobScheduler->runMainThreadJobs();
+}
+
+
 //! Sets a new event receiver to receive events
 void CIrrDeviceStub::setEventReceiver(IEventReceiver* receiver)
 {
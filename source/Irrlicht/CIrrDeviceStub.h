@@ -8,12 +8,14 @@
 #include "IrrlichtDevice.h"
 #include "SIrrCreationParameters.h"
 #include "IContextManager.h"
+#include <chrono>
 
 namespace irr
 {
 	// lots of prototypes:
 	class ILogger;
 	class CLogger;
+	class CJobScheduler;
 
 	namespace gui
 	{
@@ -24,7 +26,7 @@ namespace irr
 
 	namespace scene
 	{
-		ISceneManager* createSceneManager(video::IVideoDriver* driver, gui::ICursorControl* cc);
+		ISceneManager* createSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs, gui::ICursorControl* cc);
 	}
 
 	namespace io
@@ -71,12 +73,39 @@ namespace irr
 		//! Returns a pointer to the ITimer object. With it the current Time can be received.
 		ITimer* getTimer() override;
 
+		//! Returns the profiler of the engine, 0 if it isn't compiled in
+		IProfiler* getProfiler() override;
+
+		//! Returns the thread pool of the engine
+		IJobScheduler* getJobScheduler() override;
+
 		//! Returns the version of the engine.
 		const char* getVersion() const override;
 
 		//! send the event to the right receiver
 		bool postEventFromUser(const SEvent& event) override;
 
+		//! Posts an event received from the system, merging it with the previous one when enabled
+		bool postEventFromSystem(const SEvent& event);
+
+		//! Posts the event merged from previous ones, if there is one
+		void postCoalescedEvent();
+
+		//! Sets if consecutive mouse input events of a type received from the system are merged.
+		void setEventCoalescing(EMOUSE_INPUT_EVENT type, bool merge) override;
+
+		//! Checks if consecutive mouse input events of a type received from the system are merged.
+		bool getEventCoalescing(EMOUSE_INPUT_EVENT type) const override;
+
+		//! Sleeps for the time, for devices which can't wait for their events
+		bool waitForEvents(u32 timeoutMs) override;
+
+		//! Makes run() keep a steady time between frames
+		void setFramePacing(u32 frameTimeUs, u32 spinTimeUs=2000) override;
+
+		//! Makes run() wait for events while the window is minimized
+		void setMinimizedWaitTime(u32 timeoutMs) override;
+
 		//! Sets a new event receiver to receive events
 		void setEventReceiver(IEventReceiver* receiver) override;
 
@@ -170,6 +199,13 @@ namespace irr
 		//! Checks whether the input device should take input from the IME
 		bool acceptsIME();
 
+		//! Waits for the frame time of setFramePacing(), called by run() before reading the input
+		/** Also waits for events while the window is minimized, see setMinimizedWaitTime(). */
+		void paceFrame();
+
+		//! Runs the jobs queued by IJobScheduler::addMainThreadJob(), called by run()
+		void runMainThreadJobs();
+
 		video::IVideoDriver* VideoDriver;
 		gui::IGUIEnvironment* GUIEnvironment;
 		scene::ISceneManager* SceneManager;
@@ -177,6 +213,7 @@ namespace irr
 		gui::ICursorControl* CursorControl;
 		IEventReceiver* UserReceiver;
 		CLogger* Logger;
+		CJobScheduler* JobScheduler;
 		IOSOperator* Operator;
 		io::IFileSystem* FileSystem;
 		scene::ISceneManager* InputReceivingSceneManager;
@@ -194,6 +231,21 @@ namespace irr
 			EMOUSE_INPUT_EVENT LastMouseInputEvent;
 		};
 		SMouseMultiClicks MouseMultiClicks;
+
+		//! Bit mask of the EMOUSE_INPUT_EVENT types which are merged
+		u32 CoalescedMouseEvents;
+		SEvent CoalescedEvent;
+		bool HasCoalescedEvent;
+
+		//! Target time between frames and the part of it spent spinning, in microseconds
+		u32 FramePacingTime;
+		u32 FramePacingSpin;
+		//! When the next frame is due
+		std::chrono::steady_clock::time_point NextFrameTime;
+
+		//! see setMinimizedWaitTime()
+		u32 MinimizedWaitTime;
+
 		video::IContextManager* ContextManager;
 		SIrrlichtCreationParameters CreationParams;
 		bool Close;
@@ -634,7 +634,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		dev = getDeviceFromHWnd(hWnd);
 		if (dev)
 		{
-			dev->postEventFromUser(event);
+			dev->postEventFromSystem(event);
 
 			if ( event.MouseInput.Event >= irr::EMIE_LMOUSE_PRESSED_DOWN && event.MouseInput.Event <= irr::EMIE_MMOUSE_PRESSED_DOWN )
 			{
@@ -1025,11 +1025,15 @@ void CIrrDeviceWin32::createDriver()
 //! runs the device. Returns false if device wants to be deleted
 bool CIrrDeviceWin32::run()
 {
+	// waits for the frame time before the input is read
+	paceFrame();
 	os::Timer::tick();
+	runMainThreadJobs();
 
 	static_cast<CCursorControl*>(CursorControl)->update();
 
 	handleSystemMessages();
+	postCoalescedEvent();
 
 	if (!Close)
 		resizeIfNecessary();
@@ -1060,6 +1064,17 @@ void CIrrDeviceWin32::sleep(u32 timeMs, bool pauseTimer)
 		Timer->start();
 }
 
+//! Blocks until the window system has events for the device, or the time passed
+bool CIrrDeviceWin32::waitForEvents(u32 timeoutMs)
+{
+	// the wait only reports messages which arrived after the last check of the queue
+	MSG msg;
+	if (PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE))
+		return true;
+
+	return MsgWaitForMultipleObjects(0, NULL, FALSE, timeoutMs, QS_ALLINPUT) == WAIT_OBJECT_0;
+}
+
 
 void CIrrDeviceWin32::resizeIfNecessary()
 {
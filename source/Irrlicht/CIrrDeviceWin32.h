@@ -44,6 +44,9 @@ namespace irr
 		//! Pause execution and let other processes to run for a specified amount of time.
 		void sleep(u32 timeMs, bool pauseTimer) override;
 
+		//! Blocks until the window system has events for the device, or the time passed
+		bool waitForEvents(u32 timeoutMs) override;
+
 		//! sets the caption of the window
 		void setWindowCaption(const wchar_t* text) override;
 
@@ -0,0 +1,371 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CJobScheduler.h"
+#include "irrArray.h"
+#include "irrMath.h"
+#include "os.h"
+
+namespace irr
+{
+
+namespace
+{
+	//! Scheduler and queue of a worker thread, 0 on other threads
+	thread_local CJobScheduler* LocalScheduler = 0;
+	thread_local u32 LocalQueue = 0;
+
+	//! Scratch memory of each thread
+	thread_local std::vector<u8> LocalScratch;
+
+	std::mutex SharedMutex;
+	CJobScheduler* Shared = 0;
+
+	//! One part of a parallelFor()
+	struct SRange
+	{
+		IJobScheduler::RangeFunction Function;
+		void* Data;
+		u32 Begin;
+		u32 End;
+	};
+
+	void runRange(void* data)
+	{
+		const SRange* range = static_cast<const SRange*>(data);
+		range->Function(range->Data, range->Begin, range->End);
+	}
+}
+
+//! Job graph running on a CJobScheduler
+class CJobGraph : public IJobGraph
+{
+public:
+	CJobGraph(CJobScheduler* scheduler) : Scheduler(scheduler), RemainingSize(0), Counter(0)
+	{
+		Scheduler->grab();
+	}
+
+	~CJobGraph()
+	{
+		Scheduler->drop();
+	}
+
+	u32 addJob(JobFunction function, void* data, const u32* dependencies, u32 dependencyCount) override
+	{
+		const u32 index = Nodes.size();
+
+		SNode node;
+		node.Graph = this;
+		node.Function = function;
+		node.Data = data;
+		node.DependencyCount = 0;
+		Nodes.push_back(node);
+
+		for (u32 i = 0; i < dependencyCount; ++i)
+		{
+			// only jobs added before can be waited for, so there are no cycles
+			if (dependencies[i] >= index)
+			{
+				os::Printer::log("Job graph dependency on a job which wasn't added yet is ignored", ELL_WARNING);
+				continue;
+			}
+
+			Nodes[dependencies[i]].Dependents.push_back(index);
+			++Nodes[index].DependencyCount;
+		}
+
+		return index;
+	}
+
+	u32 getJobCount() const override
+	{
+		return Nodes.size();
+	}
+
+	void run() override
+	{
+		if (Nodes.empty())
+			return;
+
+		if (RemainingSize != Nodes.size())
+		{
+			Remaining.reset(new std::atomic<u32>[Nodes.size()]);
+			RemainingSize = Nodes.size();
+		}
+
+		for (u32 i = 0; i < Nodes.size(); ++i)
+			Remaining[i] = Nodes[i].DependencyCount;
+
+		for (u32 i = 0; i < Nodes.size(); ++i)
+		{
+			if (!Nodes[i].DependencyCount)
+				Scheduler->add(runNode, &Nodes[i], Counter);
+		}
+
+		Scheduler->wait(Counter);
+	}
+
+	void clear() override
+	{
+		Nodes.clear();
+	}
+
+private:
+	struct SNode
+	{
+		CJobGraph* Graph;
+		JobFunction Function;
+		void* Data;
+		u32 DependencyCount;
+		core::array<u32> Dependents;
+	};
+
+	//! Runs a job and queues the dependents it was the last dependency of
+	static void runNode(void* data)
+	{
+		SNode* node = static_cast<SNode*>(data);
+		node->Function(node->Data);
+
+		// the dependents are counted before this job is, so the graph doesn't look done in between
+		CJobGraph* graph = node->Graph;
+		for (u32 i = 0; i < node->Dependents.size(); ++i)
+		{
+			const u32 dependent = node->Dependents[i];
+			if (--graph->Remaining[dependent] == 0)
+				graph->Scheduler->add(runNode, &graph->Nodes[dependent], graph->Counter);
+		}
+	}
+
+	CJobScheduler* Scheduler;
+	core::array<SNode> Nodes;
+	//! Dependencies each job still waits for while the graph runs
+	std::unique_ptr<std::atomic<u32>[]> Remaining;
+	u32 RemainingSize;
+	std::atomic<u32> Counter;
+};
+
+
+CJobScheduler::CJobScheduler(u32 workerCount) :
+	Queues(new SQueue[workerCount + 1]), QueueCount(workerCount + 1),
+	Queued(0), Sleeping(0), Quit(false)
+{
+	Threads.reserve(workerCount);
+	for (u32 i = 0; i < workerCount; ++i)
+		Threads.emplace_back(&CJobScheduler::workerLoop, this, i);
+}
+
+CJobScheduler::~CJobScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(WakeMutex);
+		Quit = true;
+	}
+	Wake.notify_all();
+
+	for (auto &thread : Threads)
+		thread.join();
+}
+
+void CJobScheduler::parallelFor(u32 count, u32 grainSize, RangeFunction function, void* data)
+{
+	if (!count)
+		return;
+
+	// a few parts for each thread, so stealing evens out parts which take longer
+	if (!grainSize)
+		grainSize = core::max_(count / ((getWorkerCount() + 1) * 4), 1u);
+
+	const u32 parts = (count + grainSize - 1) / grainSize;
+	if (parts == 1 || Threads.empty())
+	{
+		function(data, 0, count);
+		return;
+	}
+
+	std::vector<SRange> ranges(parts);
+	for (u32 i = 0; i < parts; ++i)
+	{
+		ranges[i].Function = function;
+		ranges[i].Data = data;
+		ranges[i].Begin = i * grainSize;
+		ranges[i].End = core::min_(ranges[i].Begin + grainSize, count);
+	}
+
+	std::atomic<u32> counter(0);
+	for (u32 i = 1; i < parts; ++i)
+		add(runRange, &ranges[i], counter);
+
+	runRange(&ranges[0]);
+	wait(counter);
+}
+
+IJobGraph* CJobScheduler::createJobGraph()
+{
+	return new CJobGraph(this);
+}
+
+void CJobScheduler::addMainThreadJob(JobFunction function, void* data)
+{
+	SJob job;
+	job.Function = function;
+	job.Data = data;
+	job.Counter = 0;
+
+	std::lock_guard<std::mutex> lock(MainThreadMutex);
+	MainThreadJobs.push_back(job);
+}
+
+u32 CJobScheduler::runMainThreadJobs()
+{
+	std::vector<SJob> jobs;
+	{
+		std::lock_guard<std::mutex> lock(MainThreadMutex);
+		if (MainThreadJobs.empty())
+			return 0;
+		jobs.swap(MainThreadJobs);
+	}
+
+	// jobs added by these run with the next call
+	for (const SJob& job : jobs)
+		job.Function(job.Data);
+
+	return (u32)jobs.size();
+}
+
+void* CJobScheduler::getScratchMemory(u32 size)
+{
+	if (LocalScratch.size() < size)
+		LocalScratch.resize(size);
+
+	return LocalScratch.data();
+}
+
+void CJobScheduler::add(JobFunction function, void* data, std::atomic<u32>& counter)
+{
+	SJob job;
+	job.Function = function;
+	job.Data = data;
+	job.Counter = &counter;
+
+	// counted before it can be taken, so the counters never drop below zero
+	++counter;
+	++Queued;
+
+	{
+		SQueue& queue = Queues[getOwnQueue()];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		queue.Jobs.push_back(job);
+	}
+
+	// a worker going to sleep checks Queued after counting itself as sleeping,
+	// so either it sees the job or the job sees it
+	if (Sleeping != 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(WakeMutex);
+		}
+		Wake.notify_one();
+	}
+}
+
+void CJobScheduler::wait(const std::atomic<u32>& counter)
+{
+	const u32 own = getOwnQueue();
+	SJob job;
+	while (counter != 0)
+	{
+		if (take(own, job))
+			run(job);
+		else
+			std::this_thread::yield();
+	}
+}
+
+u32 CJobScheduler::getOwnQueue()
+{
+	return (LocalScheduler == this) ? LocalQueue : QueueCount - 1;
+}
+
+bool CJobScheduler::take(u32 queue, SJob& job)
+{
+	// the own queue is used as a stack, the jobs added last have their data still in the cache
+	{
+		SQueue& q = Queues[queue];
+		std::lock_guard<std::mutex> lock(q.Mutex);
+		if (!q.Jobs.empty())
+		{
+			job = q.Jobs.back();
+			q.Jobs.pop_back();
+			--Queued;
+			return true;
+		}
+	}
+
+	for (u32 i = 1; i < QueueCount; ++i)
+	{
+		SQueue& q = Queues[(queue + i) % QueueCount];
+		std::lock_guard<std::mutex> lock(q.Mutex);
+		if (!q.Jobs.empty())
+		{
+			job = q.Jobs.front();
+			q.Jobs.pop_front();
+			--Queued;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CJobScheduler::run(const SJob& job)
+{
+	job.Function(job.Data);
+	--*job.Counter;
+}
+
+void CJobScheduler::workerLoop(u32 queue)
+{
+	LocalScheduler = this;
+	LocalQueue = queue;
+
+	SJob job;
+	for (;;)
+	{
+		if (take(queue, job))
+		{
+			run(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(WakeMutex);
+		++Sleeping;
+		Wake.wait(lock, [this] { return Quit || Queued != 0; });
+		--Sleeping;
+		if (Quit)
+			return;
+	}
+}
+
+void CJobScheduler::share(CJobScheduler* scheduler)
+{
+	std::lock_guard<std::mutex> lock(SharedMutex);
+	Shared = scheduler;
+}
+
+void CJobScheduler::unshare(CJobScheduler* scheduler)
+{
+	std::lock_guard<std::mutex> lock(SharedMutex);
+	if (Shared == scheduler)
+		Shared = 0;
+}
+
+CJobScheduler* CJobScheduler::grabShared()
+{
+	std::lock_guard<std::mutex> lock(SharedMutex);
+	if (Shared)
+		Shared->grab();
+	return Shared;
+}
+
+} // end namespace irr
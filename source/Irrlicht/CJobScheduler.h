@@ -0,0 +1,109 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_JOB_SCHEDULER_H_INCLUDED__
+#define __C_JOB_SCHEDULER_H_INCLUDED__
+
+#include "IJobScheduler.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace irr
+{
+
+//! Work stealing thread pool of a device
+/** Every worker has a queue of its own. It takes the jobs it added itself
+from the back of its queue and steals from the front of the others when it
+runs out. Threads which aren't workers share one more queue. Each batch of
+jobs counts its unfinished jobs, so waiting for one batch doesn't wait for
+the jobs of others. */
+class CJobScheduler : public IJobScheduler
+{
+public:
+	//! Starts the worker threads
+	explicit CJobScheduler(u32 workerCount);
+
+	//! Stops the worker threads, jobs which didn't run yet are dropped
+	~CJobScheduler();
+
+	u32 getWorkerCount() const override
+	{
+		return (u32)Threads.size();
+	}
+
+	void parallelFor(u32 count, u32 grainSize, RangeFunction function, void* data) override;
+
+	IJobGraph* createJobGraph() override;
+
+	void addMainThreadJob(JobFunction function, void* data) override;
+
+	u32 runMainThreadJobs() override;
+
+	void* getScratchMemory(u32 size) override;
+
+	//! Queues a job of a batch, counter counts the unfinished jobs of the batch
+	void add(JobFunction function, void* data, std::atomic<u32>& counter);
+
+	//! Runs jobs on the calling thread as well until counter is 0
+	void wait(const std::atomic<u32>& counter);
+
+	//! Makes the scheduler the one engine parts without access to the device use
+	static void share(CJobScheduler* scheduler);
+
+	//! Stops sharing the scheduler if it is the shared one
+	static void unshare(CJobScheduler* scheduler);
+
+	//! Grabs the shared scheduler, 0 if no device shares one
+	static CJobScheduler* grabShared();
+
+private:
+	struct SJob
+	{
+		JobFunction Function;
+		void* Data;
+		std::atomic<u32>* Counter;
+	};
+
+	struct SQueue
+	{
+		std::mutex Mutex;
+		std::deque<SJob> Jobs;
+	};
+
+	//! Queue the calling thread adds to and takes from first
+	u32 getOwnQueue();
+
+	//! Takes a job from the own queue or steals one from another
+	bool take(u32 queue, SJob& job);
+
+	//! Runs a job taken from the queues
+	void run(const SJob& job);
+
+	void workerLoop(u32 queue);
+
+	std::vector<std::thread> Threads;
+	//! One queue for each worker and the last one for all other threads
+	std::unique_ptr<SQueue[]> Queues;
+	u32 QueueCount;
+
+	//! Jobs in the queues
+	std::atomic<u32> Queued;
+	//! Workers waiting for jobs, only they need a notification
+	std::atomic<u32> Sleeping;
+
+	std::mutex WakeMutex;
+	std::condition_variable Wake;
+	bool Quit;
+
+	std::mutex MainThreadMutex;
+	std::vector<SJob> MainThreadJobs;
+};
+
+} // end namespace irr
+
+#endif
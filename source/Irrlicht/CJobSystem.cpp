@@ -0,0 +1,42 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CJobSystem.h"
+#include "CJobScheduler.h"
+
+namespace irr
+{
+namespace scene
+{
+
+CJobSystem::CJobSystem(u32 threadCount) :
+	Scheduler(CJobScheduler::grabShared()), Pending(0)
+{
+	if (!Scheduler)
+		Scheduler = new CJobScheduler(threadCount);
+}
+
+CJobSystem::~CJobSystem()
+{
+	// the jobs of a shared scheduler outlive the batch, so they can't be dropped
+	wait();
+	Scheduler->drop();
+}
+
+void CJobSystem::add(JobFunction function, void* data)
+{
+	Scheduler->add(function, data, Pending);
+}
+
+void CJobSystem::wait()
+{
+	Scheduler->wait(Pending);
+}
+
+u32 CJobSystem::getThreadCount() const
+{
+	return Scheduler->getWorkerCount();
+}
+
+} // end namespace scene
+} // end namespace irr
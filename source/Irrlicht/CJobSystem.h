@@ -0,0 +1,55 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_JOB_SYSTEM_H_INCLUDED__
+#define __C_JOB_SYSTEM_H_INCLUDED__
+
+#include "irrTypes.h"
+#include <atomic>
+#include <thread>
+
+namespace irr
+{
+class CJobScheduler;
+
+namespace scene
+{
+
+//! Batch of small jobs which is waited for at once
+/** The jobs run on the job scheduler of the device, so engine parts
+creating their own batches don't start more threads than there are cores.
+Without a device the batch starts a scheduler of its own. Jobs must only
+be added from the thread which calls wait(). */
+class CJobSystem
+{
+public:
+	typedef void (*JobFunction)(void* data);
+
+	//! Takes the scheduler of the device
+	/** \param threadCount Number of threads besides the one calling wait()
+	a scheduler of its own gets, if there is no device. */
+	explicit CJobSystem(u32 threadCount);
+
+	//! Waits for the jobs which were added
+	~CJobSystem();
+
+	//! Queues a job, it starts at the latest during the next wait()
+	void add(JobFunction function, void* data);
+
+	//! Runs jobs on the calling thread as well until all queued jobs are done
+	void wait();
+
+	//! Number of worker threads
+	u32 getThreadCount() const;
+
+private:
+	CJobScheduler* Scheduler;
+
+	//! Jobs not finished yet
+	std::atomic<u32> Pending;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
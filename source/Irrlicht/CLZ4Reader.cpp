@@ -0,0 +1,228 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CLZ4Reader.h"
+
+#ifdef _IRR_COMPILE_WITH_LZ4_
+
+#include "CMemoryFile.h"
+#include "IMemoryReadFile.h"
+#include "coreutil.h"
+#include "os.h"
+
+#include <lz4frame.h> // use system lib
+
+namespace irr
+{
+namespace io
+{
+
+
+// -----------------------------------------------------------------------------
+// LZ4 loader
+// -----------------------------------------------------------------------------
+
+//! Constructor
+CArchiveLoaderLZ4::CArchiveLoaderLZ4(io::IFileSystem* fs)
+: FileSystem(fs)
+{
+	#ifdef _DEBUG
+	setDebugName("CArchiveLoaderLZ4");
+	#endif
+}
+
+//! returns true if the file maybe is able to be loaded by this class
+bool CArchiveLoaderLZ4::isALoadableFileFormat(const io::path& filename) const
+{
+	return core::hasFileExtension(filename, "lz4");
+}
+
+//! Check to see if the loader can create archives of this type.
+bool CArchiveLoaderLZ4::isALoadableFileFormat(E_FILE_ARCHIVE_TYPE fileType) const
+{
+	return fileType == EFAT_LZ4;
+}
+
+
+//! Creates an archive from the filename
+IFileArchive* CArchiveLoaderLZ4::createArchive(const io::path& filename, bool ignoreCase, bool ignorePaths) const
+{
+	IFileArchive *archive = 0;
+	io::IReadFile* file = FileSystem->createAndOpenFile(filename);
+
+	if (file)
+	{
+		archive = createArchive(file, ignoreCase, ignorePaths);
+		file->drop();
+	}
+
+	return archive;
+}
+
+//! creates/loads an archive from the file.
+IFileArchive* CArchiveLoaderLZ4::createArchive(io::IReadFile* file, bool ignoreCase, bool ignorePaths) const
+{
+	if (!file)
+		return 0;
+
+	file->seek(0);
+	return new CLZ4Reader(file, ignoreCase, ignorePaths);
+}
+
+//! Check if the file might be loaded by this class
+bool CArchiveLoaderLZ4::isALoadableFileFormat(io::IReadFile* file) const
+{
+	u32 magic = 0;
+	file->read(&magic, 4);
+#ifdef __BIG_ENDIAN__
+	magic = os::Byteswap::byteswap(magic);
+#endif
+
+	return magic == LZ4_FRAME_MAGIC;
+}
+
+
+// -----------------------------------------------------------------------------
+// LZ4 archive
+// -----------------------------------------------------------------------------
+
+CLZ4Reader::CLZ4Reader(IReadFile* file, bool ignoreCase, bool ignorePaths)
+ : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), File(file)
+{
+	#ifdef _DEBUG
+	setDebugName("CLZ4Reader");
+	#endif
+
+	if (!File)
+		return;
+
+	File->grab();
+
+	// the size is only known if the frame header has it
+	u8 header[LZ4F_HEADER_SIZE_MAX];
+	size_t headerSize = File->read(header, sizeof(header));
+
+	LZ4F_frameInfo_t info;
+	memset(&info, 0, sizeof(info));
+	LZ4F_dctx* context = 0;
+	if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION)))
+		return;
+	const size_t result = LZ4F_getFrameInfo(context, &info, header, &headerSize);
+	LZ4F_freeDecompressionContext(context);
+	if (LZ4F_isError(result))
+	{
+		os::Printer::log("Not a valid LZ4 frame", Path, ELL_ERROR);
+		return;
+	}
+
+	io::path name = Path;
+	core::deletePathFromFilename(name);
+	if (core::hasFileExtension(name, "lz4"))
+		core::cutFilenameExtension(name, name);
+
+	addItem(name, 0, (u32)info.contentSize, false, 0);
+	sort();
+}
+
+CLZ4Reader::~CLZ4Reader()
+{
+	if (File)
+		File->drop();
+}
+
+
+//! get the archive type
+E_FILE_ARCHIVE_TYPE CLZ4Reader::getType() const
+{
+	return EFAT_LZ4;
+}
+
+const IFileList* CLZ4Reader::getFileList() const
+{
+	return this;
+}
+
+
+//! opens a file by file name
+IReadFile* CLZ4Reader::createAndOpenFile(const io::path& filename)
+{
+	s32 index = findFile(filename, false);
+
+	if (index != -1)
+		return createAndOpenFile(index);
+
+	return 0;
+}
+
+
+//! opens a file by index
+IReadFile* CLZ4Reader::createAndOpenFile(u32 index)
+{
+	if (index >= Files.size())
+		return 0;
+
+	// mapped archives are decompressed in place
+	const long compressedSize = File->getSize();
+	core::array<u8> copy;
+	const u8* compressed;
+	if (File->getType() == ERFT_MEMORY_READ_FILE)
+		compressed = (const u8*)static_cast<IMemoryReadFile*>(File)->getBuffer();
+	else
+	{
+		copy.set_used((u32)compressedSize);
+		if (!File->seek(0) || File->read(copy.pointer(), compressedSize) != (size_t)compressedSize)
+		{
+			os::Printer::log("Could not read LZ4 frame", Path, ELL_ERROR);
+			return 0;
+		}
+		compressed = copy.const_pointer();
+	}
+
+	LZ4F_dctx* context = 0;
+	if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION)))
+		return 0;
+
+	// the buffer grows if the frame header has no size
+	size_t capacity = Files[index].Size > 0 ? Files[index].Size : (size_t)compressedSize * 2 + 1;
+	c8* data = new c8[capacity];
+	size_t size = 0;
+	size_t inPos = 0;
+	size_t result = 1;
+	while (result != 0)
+	{
+		if (size == capacity)
+		{
+			c8* grown = new c8[capacity * 2];
+			memcpy(grown, data, size);
+			delete [] data;
+			data = grown;
+			capacity *= 2;
+		}
+
+		size_t outSize = capacity - size;
+		size_t inSize = (size_t)compressedSize - inPos;
+		result = LZ4F_decompress(context, data + size, &outSize, compressed + inPos, &inSize, 0);
+		size += outSize;
+		inPos += inSize;
+
+		// a truncated frame makes no progress
+		if (LZ4F_isError(result) || (result != 0 && outSize == 0 && inSize == 0))
+			break;
+	}
+	LZ4F_freeDecompressionContext(context);
+
+	if (result != 0)
+	{
+		os::Printer::log("Error decompressing", Files[index].FullName, ELL_ERROR);
+		delete [] data;
+		return 0;
+	}
+
+	return new CMemoryReadFile(data, (long)size, Files[index].FullName, true);
+}
+
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_LZ4_
@@ -0,0 +1,97 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_LZ4_READER_H_INCLUDED__
+#define __C_LZ4_READER_H_INCLUDED__
+
+#ifdef _IRR_COMPILE_WITH_LZ4_
+
+#include "IReadFile.h"
+#include "IFileSystem.h"
+#include "CFileList.h"
+
+namespace irr
+{
+namespace io
+{
+	//! First four bytes of an LZ4 frame, little endian
+	const u32 LZ4_FRAME_MAGIC = 0x184D2204;
+
+	//! Archiveloader capable of loading LZ4 frames
+	class CArchiveLoaderLZ4 : public IArchiveLoader
+	{
+	public:
+
+		//! Constructor
+		CArchiveLoaderLZ4(io::IFileSystem* fs);
+
+		//! returns true if the file maybe is able to be loaded by this class
+		//! based on the file extension (e.g. ".lz4")
+		bool isALoadableFileFormat(const io::path& filename) const override;
+
+		//! Check if the file might be loaded by this class
+		/** Check might look into the file.
+		\param file File handle to check.
+		\return True if file seems to be loadable. */
+		bool isALoadableFileFormat(io::IReadFile* file) const override;
+
+		//! Check to see if the loader can create archives of this type.
+		/** Check based on the archive type.
+		\param fileType The archive type to check.
+		\return True if the archile loader supports this type, false if not */
+		bool isALoadableFileFormat(E_FILE_ARCHIVE_TYPE fileType) const override;
+
+		//! Creates an archive from the filename
+		/** \param file File handle to check.
+		\return Pointer to newly created archive, or 0 upon error. */
+		IFileArchive* createArchive(const io::path& filename, bool ignoreCase, bool ignorePaths) const override;
+
+		//! creates/loads an archive from the file.
+		//! \return Pointer to the created archive. Returns 0 if loading failed.
+		io::IFileArchive* createArchive(io::IReadFile* file, bool ignoreCase, bool ignorePaths) const override;
+
+	private:
+		io::IFileSystem* FileSystem;
+	};
+
+/*!
+	Reader of LZ4 frames. Like a gzip file, a frame holds one file, named
+	like the archive without the .lz4 extension.
+*/
+	class CLZ4Reader : public virtual IFileArchive, virtual CFileList
+	{
+	public:
+
+		//! constructor
+		CLZ4Reader(IReadFile* file, bool ignoreCase, bool ignorePaths);
+
+		//! destructor
+		virtual ~CLZ4Reader();
+
+		//! opens a file by file name
+		IReadFile* createAndOpenFile(const io::path& filename) override;
+
+		//! opens a file by index
+		/** The frame is decompressed completely into memory. */
+		IReadFile* createAndOpenFile(u32 index) override;
+
+		//! returns the list of files
+		const IFileList* getFileList() const override;
+
+		//! get the archive type
+		E_FILE_ARCHIVE_TYPE getType() const override;
+
+		//! return the id of the file Archive
+		const io::path& getArchiveName() const override {return Path;}
+
+	private:
+
+		IReadFile* File;
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_LZ4_
+
+#endif // __C_LZ4_READER_H_INCLUDED__
@@ -0,0 +1,408 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CLightClusters.h"
+#include "ILightSceneNode.h"
+#include "ICameraSceneNode.h"
+#include "IVideoDriver.h"
+#include "CJobSystem.h"
+#include "irrSIMD.h"
+#include "os.h"
+#include <cmath>
+#include <cstring>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! inclusive range of clusters covered by a range in normalized device coordinates
+	inline bool clusterRange(f32 minNdc, f32 maxNdc, u32 count, u8& first, u8& last)
+	{
+		if (maxNdc < -1.f || minNdc > 1.f)
+			return false;
+
+		// clamped before the conversion, spheres around the camera are unbounded
+		const f32 scale = 0.5f * count;
+		first = (u8)core::min_((u32)((core::max_(minNdc, -1.f) + 1.f) * scale), count - 1);
+		last = (u8)core::min_((u32)((core::min_(maxNdc, 1.f) + 1.f) * scale), count - 1);
+		return true;
+	}
+} // end anonymous namespace
+
+CLightClusters::CLightClusters() : TexturesUnsupported(false)
+{
+	memset(Offsets, 0, sizeof(Offsets));
+	memset(Counts, 0, sizeof(Counts));
+	for (u32 i = 0; i < ELCT_COUNT; ++i)
+		Textures[i] = 0;
+	for (u32 i = 0; i < JOB_COUNT; ++i)
+	{
+		Jobs[i].Clusters = this;
+		Jobs[i].FirstSlice = i * SLICES_PER_JOB;
+		Jobs[i].EndSlice = core::min_((i + 1) * SLICES_PER_JOB, LIGHT_CLUSTERS_Z);
+	}
+}
+
+void CLightClusters::release(video::IVideoDriver* driver)
+{
+	for (u32 i = 0; i < ELCT_COUNT; ++i)
+	{
+		if (Textures[i])
+			driver->removeTexture(Textures[i]);
+		Textures[i] = 0;
+	}
+}
+
+void CLightClusters::transformLights(const core::matrix4& view, const core::matrix4& projection, f32 nearValue)
+{
+	const u32 count = PosX.size();
+	const f32* m = view.pointer();
+	const f32* p = projection.pointer();
+	// the projections of Irrlicht are perspective along +z, or orthogonal
+	const bool perspective = p[11] != 0.f;
+
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+	typedef core::SSIMD4f S;
+	const S::V zero = S::splat(0.f);
+	const S::V nearZ = S::splat(nearValue);
+	const S::V scaleX = S::splat(p[0]), scaleY = S::splat(p[5]);
+	const S::V offsetX = S::splat(p[12]), offsetY = S::splat(p[13]);
+	const S::V unbounded = S::splat(1e30f);
+	for (u32 i = 0; i < count; i += 4)
+	{
+		const S::V x = S::load(&PosX[i]), y = S::load(&PosY[i]), z = S::load(&PosZ[i]);
+		const S::V r = S::load(&Radius[i]);
+
+		const S::V vx = S::madd(x, S::splat(m[0]), S::madd(y, S::splat(m[4]), S::madd(z, S::splat(m[8]), S::splat(m[12]))));
+		const S::V vy = S::madd(x, S::splat(m[1]), S::madd(y, S::splat(m[5]), S::madd(z, S::splat(m[9]), S::splat(m[13]))));
+		const S::V vz = S::madd(x, S::splat(m[2]), S::madd(y, S::splat(m[6]), S::madd(z, S::splat(m[10]), S::splat(m[14]))));
+		S::store(&PosX[i], vx);
+		S::store(&PosY[i], vy);
+		S::store(&PosZ[i], vz);
+
+		const S::V x0 = S::sub(vx, r), x1 = S::add(vx, r);
+		const S::V y0 = S::sub(vy, r), y1 = S::add(vy, r);
+		S::V minX, maxX, minY, maxY;
+		if (perspective)
+		{
+			// a side of the sphere projects furthest out at its nearest or
+			// farthest depth, depending on the side of the view axis
+			const S::V zn = S::max_(S::sub(vz, r), nearZ);
+			const S::V zf = S::max_(S::add(vz, r), nearZ);
+			minX = S::div(S::mul(scaleX, x0), S::select(S::less(x0, zero), zn, zf));
+			maxX = S::div(S::mul(scaleX, x1), S::select(S::less(zero, x1), zn, zf));
+			minY = S::div(S::mul(scaleY, y0), S::select(S::less(y0, zero), zn, zf));
+			maxY = S::div(S::mul(scaleY, y1), S::select(S::less(zero, y1), zn, zf));
+
+			// spheres reaching behind the near plane cover the whole screen
+			const S::M crossing = S::lessEqual(S::sub(vz, r), nearZ);
+			minX = S::select(crossing, S::sub(zero, unbounded), minX);
+			maxX = S::select(crossing, unbounded, maxX);
+			minY = S::select(crossing, S::sub(zero, unbounded), minY);
+			maxY = S::select(crossing, unbounded, maxY);
+		}
+		else
+		{
+			minX = S::madd(scaleX, x0, offsetX);
+			maxX = S::madd(scaleX, x1, offsetX);
+			minY = S::madd(scaleY, y0, offsetY);
+			maxY = S::madd(scaleY, y1, offsetY);
+		}
+		S::store(&MinNdcX[i], minX);
+		S::store(&MaxNdcX[i], maxX);
+		S::store(&MinNdcY[i], minY);
+		S::store(&MaxNdcY[i], maxY);
+	}
+#else
+	for (u32 i = 0; i < count; ++i)
+	{
+		const f32 x = PosX[i], y = PosY[i], z = PosZ[i], r = Radius[i];
+		const f32 vx = x * m[0] + y * m[4] + z * m[8] + m[12];
+		const f32 vy = x * m[1] + y * m[5] + z * m[9] + m[13];
+		const f32 vz = x * m[2] + y * m[6] + z * m[10] + m[14];
+		PosX[i] = vx;
+		PosY[i] = vy;
+		PosZ[i] = vz;
+
+		const f32 x0 = vx - r, x1 = vx + r, y0 = vy - r, y1 = vy + r;
+		if (perspective && vz - r <= nearValue)
+		{
+			MinNdcX[i] = MinNdcY[i] = -1e30f;
+			MaxNdcX[i] = MaxNdcY[i] = 1e30f;
+		}
+		else if (perspective)
+		{
+			const f32 zn = vz - r, zf = vz + r;
+			MinNdcX[i] = p[0] * x0 / (x0 < 0.f ? zn : zf);
+			MaxNdcX[i] = p[0] * x1 / (0.f < x1 ? zn : zf);
+			MinNdcY[i] = p[5] * y0 / (y0 < 0.f ? zn : zf);
+			MaxNdcY[i] = p[5] * y1 / (0.f < y1 ? zn : zf);
+		}
+		else
+		{
+			MinNdcX[i] = p[0] * x0 + p[12];
+			MaxNdcX[i] = p[0] * x1 + p[12];
+			MinNdcY[i] = p[5] * y0 + p[13];
+			MaxNdcY[i] = p[5] * y1 + p[13];
+		}
+	}
+#endif
+}
+
+void CLightClusters::build(const ICameraSceneNode* camera, CJobSystem* jobs)
+{
+	VisibleLights.set_used(0);
+	Bounds.set_used(0);
+	Indices.set_used(0);
+
+	const u32 lightCount = Lights.size();
+	if (!camera || !lightCount)
+	{
+		memset(Offsets, 0, sizeof(Offsets));
+		memset(Counts, 0, sizeof(Counts));
+		return;
+	}
+
+	// gather the spheres, padded for the SIMD loop
+	const u32 padded = (lightCount + 3) & ~3u;
+	PosX.set_used(padded);
+	PosY.set_used(padded);
+	PosZ.set_used(padded);
+	Radius.set_used(padded);
+	MinNdcX.set_used(padded);
+	MaxNdcX.set_used(padded);
+	MinNdcY.set_used(padded);
+	MaxNdcY.set_used(padded);
+	for (u32 i = 0; i < padded; ++i)
+	{
+		if (i < lightCount)
+		{
+			const core::vector3df pos = Lights[i]->getAbsolutePosition();
+			PosX[i] = pos.X;
+			PosY[i] = pos.Y;
+			PosZ[i] = pos.Z;
+			Radius[i] = Lights[i]->getRadius();
+		}
+		else
+			PosX[i] = PosY[i] = PosZ[i] = Radius[i] = 0.f;
+	}
+
+	const f32 nearValue = core::max_(camera->getNearValue(), 0.001f);
+	const f32 farValue = core::max_(camera->getFarValue(), nearValue * 2.f);
+	transformLights(camera->getViewMatrix(), camera->getProjectionMatrix(), nearValue);
+
+	// drop the lights outside of the view, the others keep their view space
+	// spheres at the index of their bounds
+	const f32 sliceScale = LIGHT_CLUSTERS_Z / logf(farValue / nearValue);
+	for (u32 i = 0; i < lightCount; ++i)
+	{
+		const f32 zNear = PosZ[i] - Radius[i];
+		const f32 zFar = PosZ[i] + Radius[i];
+		if (zFar < nearValue || zNear > farValue)
+			continue;
+
+		SBounds bounds;
+		if (!clusterRange(MinNdcX[i], MaxNdcX[i], LIGHT_CLUSTERS_X, bounds.MinX, bounds.MaxX) ||
+			!clusterRange(MinNdcY[i], MaxNdcY[i], LIGHT_CLUSTERS_Y, bounds.MinY, bounds.MaxY))
+			continue;
+
+		bounds.MinZ = zNear <= nearValue ? 0 :
+			(u8)core::min_((u32)(logf(zNear / nearValue) * sliceScale), LIGHT_CLUSTERS_Z - 1);
+		bounds.MaxZ = zFar >= farValue ? (u8)(LIGHT_CLUSTERS_Z - 1) :
+			(u8)core::min_((u32)(logf(zFar / nearValue) * sliceScale), LIGHT_CLUSTERS_Z - 1);
+
+		const u32 visible = VisibleLights.size();
+		PosX[visible] = PosX[i];
+		PosY[visible] = PosY[i];
+		PosZ[visible] = PosZ[i];
+		Radius[visible] = Radius[i];
+		VisibleLights.push_back(Lights[i]);
+		Bounds.push_back(bounds);
+	}
+
+	// the slices write only their own clusters, so they are filled in parallel
+	if (jobs && VisibleLights.size())
+	{
+		for (u32 i = 0; i < JOB_COUNT; ++i)
+			jobs->add(countJob, &Jobs[i]);
+		jobs->wait();
+	}
+	else
+		countSlices(0, LIGHT_CLUSTERS_Z);
+
+	u32 total = 0;
+	for (u32 i = 0; i < CLUSTER_COUNT; ++i)
+	{
+		Offsets[i] = total;
+		total += Counts[i];
+	}
+	Indices.set_used(total);
+
+	if (jobs && total)
+	{
+		for (u32 i = 0; i < JOB_COUNT; ++i)
+			jobs->add(fillJob, &Jobs[i]);
+		jobs->wait();
+	}
+	else if (total)
+		fillSlices(0, LIGHT_CLUSTERS_Z);
+}
+
+void CLightClusters::countJob(void* data)
+{
+	SJob* job = static_cast<SJob*>(data);
+	job->Clusters->countSlices(job->FirstSlice, job->EndSlice);
+}
+
+void CLightClusters::fillJob(void* data)
+{
+	SJob* job = static_cast<SJob*>(data);
+	job->Clusters->fillSlices(job->FirstSlice, job->EndSlice);
+}
+
+void CLightClusters::countSlices(u32 firstSlice, u32 endSlice)
+{
+	const u32 sliceSize = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y;
+	memset(Counts + firstSlice * sliceSize, 0, (endSlice - firstSlice) * sliceSize * sizeof(u32));
+
+	for (u32 i = 0; i < Bounds.size(); ++i)
+	{
+		const SBounds& b = Bounds[i];
+		const u32 z0 = core::max_((u32)b.MinZ, firstSlice);
+		const u32 z1 = core::min_((u32)b.MaxZ + 1, endSlice);
+		for (u32 z = z0; z < z1; ++z)
+			for (u32 y = b.MinY; y <= b.MaxY; ++y)
+			{
+				u32* row = Counts + (z * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X;
+				for (u32 x = b.MinX; x <= b.MaxX; ++x)
+					++row[x];
+			}
+	}
+}
+
+void CLightClusters::fillSlices(u32 firstSlice, u32 endSlice)
+{
+	// Counts is rebuilt while writing, it ends up as it was
+	const u32 sliceSize = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y;
+	memset(Counts + firstSlice * sliceSize, 0, (endSlice - firstSlice) * sliceSize * sizeof(u32));
+
+	for (u32 i = 0; i < Bounds.size(); ++i)
+	{
+		const SBounds& b = Bounds[i];
+		const u32 z0 = core::max_((u32)b.MinZ, firstSlice);
+		const u32 z1 = core::min_((u32)b.MaxZ + 1, endSlice);
+		for (u32 z = z0; z < z1; ++z)
+			for (u32 y = b.MinY; y <= b.MaxY; ++y)
+			{
+				const u32 row = (z * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X;
+				for (u32 x = b.MinX; x <= b.MaxX; ++x)
+					Indices[Offsets[row + x] + Counts[row + x]++] = i;
+			}
+	}
+}
+
+bool CLightClusters::createTextures(video::IVideoDriver* driver)
+{
+	const video::ECOLOR_FORMAT formats[ELCT_COUNT] = { video::ECF_G32R32F, video::ECF_R32F, video::ECF_A32B32G32R32F };
+	const char* const names[ELCT_COUNT] = { "<light clusters>", "<light indices>", "<lights>" };
+	const u32 texels[ELCT_COUNT] = { 0, Indices.size(), VisibleLights.size() * 2 };
+
+	for (u32 i = 0; i < ELCT_COUNT; ++i)
+	{
+		core::dimension2du size(LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y, LIGHT_CLUSTERS_Z);
+		if (i != ELCT_CLUSTERS)
+		{
+			// grow in powers of two, to recreate them rarely
+			const u32 rows = (texels[i] + LIGHT_TEXTURE_WIDTH - 1) / LIGHT_TEXTURE_WIDTH;
+			size.set(LIGHT_TEXTURE_WIDTH, 1);
+			while (size.Height < rows)
+				size.Height *= 2;
+		}
+
+		if (Textures[i] && Textures[i]->getSize().Height >= size.Height)
+			continue;
+
+		if (!driver->queryTextureFormat(formats[i]))
+		{
+			os::Printer::log("The driver has no float textures for the light clusters.", ELL_WARNING);
+			release(driver);
+			TexturesUnsupported = true;
+			return false;
+		}
+
+		if (Textures[i])
+			driver->removeTexture(Textures[i]);
+
+		video::IImage* image = driver->createImage(formats[i], size);
+		memset(image->getData(), 0, image->getImageDataSizeInBytes());
+		const bool mipMaps = driver->getTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS);
+		driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, false);
+		Textures[i] = driver->addTexture(names[i], image);
+		driver->setTextureCreationFlag(video::ETCF_CREATE_MIP_MAPS, mipMaps);
+		image->drop();
+
+		if (!Textures[i])
+		{
+			release(driver);
+			TexturesUnsupported = true;
+			return false;
+		}
+	}
+	return true;
+}
+
+void CLightClusters::upload(video::IVideoDriver* driver)
+{
+	if (TexturesUnsupported || !createTextures(driver))
+		return;
+
+	f32* clusters = static_cast<f32*>(Textures[ELCT_CLUSTERS]->lock(video::ETLM_WRITE_ONLY));
+	if (clusters)
+	{
+		for (u32 i = 0; i < CLUSTER_COUNT; ++i)
+		{
+			clusters[i * 2] = (f32)Offsets[i];
+			clusters[i * 2 + 1] = (f32)Counts[i];
+		}
+		Textures[ELCT_CLUSTERS]->unlock();
+	}
+
+	if (Indices.size())
+	{
+		f32* indices = static_cast<f32*>(Textures[ELCT_INDICES]->lock(video::ETLM_WRITE_ONLY));
+		if (indices)
+		{
+			for (u32 i = 0; i < Indices.size(); ++i)
+				indices[i] = (f32)Indices[i];
+			Textures[ELCT_INDICES]->unlock();
+		}
+	}
+
+	if (VisibleLights.size())
+	{
+		f32* lights = static_cast<f32*>(Textures[ELCT_LIGHTS]->lock(video::ETLM_WRITE_ONLY));
+		if (lights)
+		{
+			for (u32 i = 0; i < VisibleLights.size(); ++i)
+			{
+				const video::SColorf& color = VisibleLights[i]->getColor();
+				f32* light = lights + i * 8;
+				light[0] = PosX[i];
+				light[1] = PosY[i];
+				light[2] = PosZ[i];
+				light[3] = Radius[i];
+				light[4] = color.r;
+				light[5] = color.g;
+				light[6] = color.b;
+				light[7] = color.a;
+			}
+			Textures[ELCT_LIGHTS]->unlock();
+		}
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
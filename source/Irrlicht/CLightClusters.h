@@ -0,0 +1,123 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_LIGHT_CLUSTERS_H_INCLUDED__
+#define __C_LIGHT_CLUSTERS_H_INCLUDED__
+
+#include "ELightClusterTextures.h"
+#include "irrArray.h"
+#include "matrix4.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+	class ITexture;
+} // end namespace video
+
+namespace scene
+{
+	class ICameraSceneNode;
+	class ILightSceneNode;
+	class CJobSystem;
+
+//! Bins the lights registered for ESNRP_LIGHT into the clusters of the camera view
+/** The view frustum is split into LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y tiles
+across the screen and LIGHT_CLUSTERS_Z exponential slices along the view
+direction. The view space bounds of all lights are computed four at a time,
+then the depth slices are filled in parallel, as each slice only writes its
+own clusters. */
+class CLightClusters
+{
+public:
+	CLightClusters();
+
+	//! Adds a light for the current frame
+	void addLight(ILightSceneNode* light) { Lights.push_back(light); }
+
+	//! Forgets the lights of the current frame
+	void clearLights() { Lights.set_used(0); }
+
+	//! Lights were added, or the textures have to be cleared of the previous ones
+	bool hasWork() const { return !Lights.empty() || VisibleLights.size() != 0; }
+
+	//! Bins the lights added since the last clearLights() into the clusters
+	/** The lights are kept, so the clusters of several views can be built
+	from them.
+	\param jobs Worker threads to fill the slices, can be 0. */
+	void build(const ICameraSceneNode* camera, CJobSystem* jobs);
+
+	//! Writes the clusters and the visible lights into the textures
+	void upload(video::IVideoDriver* driver);
+
+	//! Removes the textures from the driver
+	void release(video::IVideoDriver* driver);
+
+	video::ITexture* getTexture(E_LIGHT_CLUSTER_TEXTURE texture) const
+	{
+		return texture < ELCT_COUNT ? Textures[texture] : 0;
+	}
+
+	u32 getVisibleLightCount() const { return VisibleLights.size(); }
+
+private:
+	//! Inclusive cluster ranges touched by a light
+	struct SBounds
+	{
+		u8 MinX, MaxX, MinY, MaxY, MinZ, MaxZ;
+	};
+
+	//! A range of depth slices, filled by one job
+	struct SJob
+	{
+		CLightClusters* Clusters;
+		u32 FirstSlice;
+		u32 EndSlice;
+	};
+
+	static const u32 CLUSTER_COUNT = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z;
+	static const u32 SLICES_PER_JOB = 4;
+	static const u32 JOB_COUNT = (LIGHT_CLUSTERS_Z + SLICES_PER_JOB - 1) / SLICES_PER_JOB;
+
+	//! transforms the lights into view space and their spheres into normalized device coordinates
+	void transformLights(const core::matrix4& view, const core::matrix4& projection, f32 nearValue);
+
+	//! counts the lights of the clusters of some slices
+	void countSlices(u32 firstSlice, u32 endSlice);
+
+	//! writes the light indices of the clusters of some slices
+	void fillSlices(u32 firstSlice, u32 endSlice);
+
+	static void countJob(void* data);
+	static void fillJob(void* data);
+
+	//! creates the textures, or recreates one if it is too small
+	bool createTextures(video::IVideoDriver* driver);
+
+	core::array<ILightSceneNode*> Lights;
+	core::array<ILightSceneNode*> VisibleLights;
+
+	//! view space spheres and their screen rectangles, padded to a multiple of four
+	core::array<f32> PosX, PosY, PosZ, Radius;
+	core::array<f32> MinNdcX, MaxNdcX, MinNdcY, MaxNdcY;
+
+	//! cluster ranges of the visible lights
+	core::array<SBounds> Bounds;
+
+	//! first entry in Indices and number of lights of each cluster
+	u32 Offsets[CLUSTER_COUNT];
+	u32 Counts[CLUSTER_COUNT];
+	core::array<u32> Indices;
+
+	SJob Jobs[JOB_COUNT];
+
+	video::ITexture* Textures[ELCT_COUNT];
+	//! the driver lacks the float formats, the textures aren't created
+	bool TexturesUnsupported;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
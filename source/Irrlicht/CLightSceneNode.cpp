@@ -0,0 +1,73 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CLightSceneNode.h"
+#include "ISceneManager.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! constructor
+CLightSceneNode::CLightSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+		const core::vector3df& position, video::SColorf color, f32 radius)
+: ILightSceneNode(parent, mgr, id, position), Color(color), Radius(0.f)
+{
+	#ifdef _DEBUG
+	setDebugName("CLightSceneNode");
+	#endif
+
+	// the lights outside of the view are dropped while binning
+	setAutomaticCulling(scene::EAC_OFF);
+	setRadius(radius);
+}
+
+
+//! pre render event
+void CLightSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible)
+		SceneManager->registerNodeForRendering(this, ESNRP_LIGHT);
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! render
+void CLightSceneNode::render()
+{
+	// do nothing
+}
+
+
+void CLightSceneNode::setRadius(f32 radius)
+{
+	Radius = core::max_(radius, 0.f);
+	Box.reset(-Radius, -Radius, -Radius);
+	Box.addInternalPoint(Radius, Radius, Radius);
+	updateSpatialIndex();
+}
+
+
+//! Creates a clone of this scene node and its children.
+ISceneNode* CLightSceneNode::clone(ISceneNode* newParent, ISceneManager* newManager)
+{
+	if (!newParent)
+		newParent = Parent;
+	if (!newManager)
+		newManager = SceneManager;
+
+	CLightSceneNode* nb = new CLightSceneNode(newParent,
+		newManager, ID, RelativeTranslation, Color, Radius);
+
+	nb->cloneMembers(this, newManager);
+
+	if ( newParent )
+		nb->drop();
+	return nb;
+}
+
+
+} // end namespace scene
+} // end namespace irr
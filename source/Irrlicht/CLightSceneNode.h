@@ -0,0 +1,56 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_LIGHT_SCENE_NODE_H_INCLUDED__
+#define __C_LIGHT_SCENE_NODE_H_INCLUDED__
+
+#include "ILightSceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+	//! Scene node which is a dynamic point light
+	class CLightSceneNode : public ILightSceneNode
+	{
+	public:
+
+		//! constructor
+		CLightSceneNode(ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, video::SColorf color, f32 radius);
+
+		//! registers the light for ESNRP_LIGHT
+		void OnRegisterSceneNode() override;
+
+		//! does nothing, lights are binned by the scene manager
+		void render() override;
+
+		//! returns the box of the sphere of the light
+		const core::aabbox3d<f32>& getBoundingBox() const override { return Box; }
+
+		void setColor(const video::SColorf& color) override { Color = color; }
+
+		const video::SColorf& getColor() const override { return Color; }
+
+		void setRadius(f32 radius) override;
+
+		f32 getRadius() const override { return Radius; }
+
+		//! Returns type of the scene node
+		ESCENE_NODE_TYPE getType() const override { return ESNT_LIGHT; }
+
+		//! Creates a clone of this scene node and its children.
+		ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) override;
+
+	private:
+
+		video::SColorf Color;
+		f32 Radius;
+		core::aabbox3d<f32> Box;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -44,12 +44,7 @@ size_t CLimitReadFile::read(void* buffer, size_t sizeToRead)
 		return 0;
 
 #if 1
-	long r = AreaStart + Pos;
-	long toRead = core::min_(AreaEnd, r + (long)sizeToRead) - core::max_(AreaStart, r);
-	if (toRead < 0)
-		return 0;
-	File->seek(r);
-	r = (long)File->read(buffer, toRead);
+	const long r = (long)readAt(Pos, buffer, sizeToRead);
 	Pos += r;
 	return r;
 #else
@@ -92,6 +87,21 @@ bool CLimitReadFile::seek(long finalPos, bool relativeMovement)
 }
 
 
+//! reads from a position without changing the position of read()
+size_t CLimitReadFile::readAt(long offset, void* buffer, size_t sizeToRead)
+{
+	if (0 == File || offset < 0)
+		return 0;
+
+	// the file is shared by the files of an archive, so it's never sought
+	const long r = AreaStart + offset;
+	const long toRead = core::min_(AreaEnd, r + (long)sizeToRead) - r;
+	if (toRead <= 0)
+		return 0;
+	return File->readAt(r, buffer, toRead);
+}
+
+
 //! returns size of file
 long CLimitReadFile::getSize() const
 {
@@ -19,7 +19,8 @@ namespace io
 		so that it may only start from a certain file position
 		and may only read until a certain file position.
 		This can be useful, for example for reading uncompressed files
-		in an archive (zip, tar).
+		in an archive (zip, tar). The file is only read with readAt(),
+		so several limit read files of it can be read by different threads.
 	!*/
 	class CLimitReadFile : public IReadFile
 	{
@@ -37,6 +38,9 @@ namespace io
 		//! otherwise from begin of file
 		bool seek(long finalPos, bool relativeMovement = false) override;
 
+		//! reads from a position without changing the position of read()
+		size_t readAt(long offset, void* buffer, size_t sizeToRead) override;
+
 		//! returns size of file
 		long getSize() const override;
 
@@ -3,18 +3,24 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CLogger.h"
+#include "CAsyncLogWriter.h"
 
 namespace irr
 {
 
 	CLogger::CLogger(IEventReceiver* r)
-		: LogLevel(ELL_INFORMATION), Receiver(r)
+		: LogLevel(ELL_INFORMATION), Receiver(r), Writer(0)
 	{
 		#ifdef _DEBUG
 		setDebugName("CLogger");
 		#endif
 	}
 
+	CLogger::~CLogger()
+	{
+		delete Writer;
+	}
+
 	//! Returns the current set log level.
 	ELOG_LEVEL CLogger::getLogLevel() const
 	{
@@ -43,6 +49,9 @@ namespace irr
 				return;
 		}
 
+		if (Writer && Writer->push(text, 0, ll))
+			return;
+
 		os::Printer::print(text);
 	}
 
@@ -53,6 +62,10 @@ namespace irr
 		if (ll < LogLevel)
 			return;
 
+		// the writer thread joins them when nobody needs the text right away
+		if (!Receiver && Writer && Writer->push(text, hint, ll))
+			return;
+
 		core::stringc s = text;
 		s += ": ";
 		s += hint;
@@ -97,6 +110,18 @@ namespace irr
 		Receiver = r;
 	}
 
+	//! Writes the messages on a background thread instead of the calling one
+	void CLogger::setAsynchronous(bool async)
+	{
+		if (async && !Writer)
+			Writer = new CAsyncLogWriter();
+		else if (!async && Writer)
+		{
+			delete Writer;
+			Writer = 0;
+		}
+	}
+
 
 } // end namespace irr
 
@@ -13,6 +13,8 @@
 namespace irr
 {
 
+class CAsyncLogWriter;
+
 //! Class for logging messages, warnings and errors to stdout
 class CLogger : public ILogger
 {
@@ -20,6 +22,8 @@ public:
 
 	CLogger(IEventReceiver* r);
 
+	~CLogger();
+
 	//! Returns the current set log level.
 	ELOG_LEVEL getLogLevel() const override;
 
@@ -44,10 +48,17 @@ public:
 	//! Sets a new event receiver
 	void setReceiver(IEventReceiver* r);
 
+	//! Writes the messages on a background thread instead of the calling one
+	/** The event receiver is still called on the calling thread. Messages
+	are printed synchronously while the queue of the writer thread is full.
+	Disabling it waits until the queued messages are written. */
+	void setAsynchronous(bool async);
+
 private:
 
 	ELOG_LEVEL LogLevel;
 	IEventReceiver* Receiver;
+	CAsyncLogWriter* Writer;
 };
 
 } // end namespace
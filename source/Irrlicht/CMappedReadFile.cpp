@@ -0,0 +1,193 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMappedReadFile.h"
+#include "irrMath.h"
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif (defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_) || defined(_IRR_ANDROID_PLATFORM_))
+	#define _IRR_MAPPED_FILES_POSIX_
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+
+CMappedReadFile::CMappedReadFile(const io::path& fileName)
+: Buffer(0), Len(0), Pos(0), Filename(fileName)
+#if defined(_IRR_WINDOWS_API_)
+, Mapping(0)
+#endif
+{
+	#ifdef _DEBUG
+	setDebugName("CMappedReadFile");
+	#endif
+}
+
+
+CMappedReadFile::~CMappedReadFile()
+{
+#if defined(_IRR_WINDOWS_API_)
+	if (Buffer)
+		UnmapViewOfFile(Buffer);
+	if (Mapping)
+		CloseHandle(Mapping);
+#elif defined(_IRR_MAPPED_FILES_POSIX_)
+	if (Buffer)
+		munmap(const_cast<void*>(Buffer), Len);
+#endif
+}
+
+
+//! returns how much was read
+size_t CMappedReadFile::read(void* buffer, size_t sizeToRead)
+{
+	long amount = static_cast<long>(sizeToRead);
+	if (Pos + amount > Len)
+		amount -= Pos + amount - Len;
+
+	if (amount <= 0)
+		return 0;
+
+	memcpy(buffer, (const c8*)Buffer + Pos, amount);
+
+	Pos += amount;
+
+	return static_cast<size_t>(amount);
+}
+
+
+//! changes position in file, returns true if successful
+//! if relativeMovement==true, the pos is changed relative to current pos,
+//! otherwise from begin of file
+bool CMappedReadFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > Len)
+		return false;
+
+	Pos = finalPos;
+	return true;
+}
+
+
+//! reads from a position without changing the position of read()
+size_t CMappedReadFile::readAt(long offset, void* buffer, size_t sizeToRead)
+{
+	if (offset < 0 || offset >= Len)
+		return 0;
+
+	const long amount = core::min_(static_cast<long>(sizeToRead), Len - offset);
+	memcpy(buffer, (const c8*)Buffer + offset, amount);
+	return static_cast<size_t>(amount);
+}
+
+
+//! returns size of file
+long CMappedReadFile::getSize() const
+{
+	return Len;
+}
+
+
+//! returns where in the file we are.
+long CMappedReadFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CMappedReadFile::getFileName() const
+{
+	return Filename;
+}
+
+
+//! Maps the file if it has at least minSize bytes
+bool CMappedReadFile::mapFile(long minSize)
+{
+	// empty files can't be mapped
+	if (minSize < 1)
+		minSize = 1;
+
+#if defined(_IRR_WINDOWS_API_)
+	HANDLE file = CreateFileA(Filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < minSize || size.QuadPart > 0x7fffffff)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// the mapping keeps the file open
+	Mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+	CloseHandle(file);
+	if (!Mapping)
+		return false;
+
+	Buffer = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!Buffer)
+		return false;
+	Len = (long)size.QuadPart;
+	return true;
+#elif defined(_IRR_MAPPED_FILES_POSIX_)
+	const int fd = open(Filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size < minSize || info.st_size > 0x7fffffff)
+	{
+		close(fd);
+		return false;
+	}
+
+	// the mapping keeps the file open
+	void* memory = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED)
+		return false;
+
+	// loaders read their files from the front to the back
+	madvise(memory, info.st_size, MADV_SEQUENTIAL);
+
+	Buffer = memory;
+	Len = (long)info.st_size;
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+IReadFile* CMappedReadFile::createMappedReadFile(const io::path& fileName, long minSize)
+{
+	if (fileName.size() == 0)
+		return 0;
+
+	CMappedReadFile* file = new CMappedReadFile(fileName);
+	if (file->mapFile(minSize))
+		return file;
+
+	file->drop();
+	return 0;
+}
+
+
+} // end namespace io
+} // end namespace irr
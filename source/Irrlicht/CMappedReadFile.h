@@ -0,0 +1,83 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MAPPED_READ_FILE_H_INCLUDED__
+#define __C_MAPPED_READ_FILE_H_INCLUDED__
+
+#include "IMemoryReadFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace io
+{
+
+	/*!
+		Class for reading a real file from disk through a read-only memory mapping.
+		Loaders can parse the contents in place with getBuffer(), like those of
+		a CMemoryReadFile.
+	*/
+	class CMappedReadFile : public IMemoryReadFile
+	{
+	public:
+
+		//! Destructor, unmaps the file
+		virtual ~CMappedReadFile();
+
+		//! returns how much was read
+		size_t read(void* buffer, size_t sizeToRead) override;
+
+		//! changes position in file, returns true if successful
+		bool seek(long finalPos, bool relativeMovement = false) override;
+
+		//! reads from a position without changing the position of read()
+		size_t readAt(long offset, void* buffer, size_t sizeToRead) override;
+
+		//! returns size of file
+		long getSize() const override;
+
+		//! returns where in the file we are.
+		long getPos() const override;
+
+		//! returns name of file
+		const io::path& getFileName() const override;
+
+		//! Get the type of the class implementing this interface
+		/** The same as for CMemoryReadFile, so loaders use getBuffer() */
+		EREAD_FILE_TYPE getType() const override
+		{
+			return ERFT_MEMORY_READ_FILE;
+		}
+
+		//! Get direct access to the mapped file
+		const void *getBuffer() const override
+		{
+			return Buffer;
+		}
+
+		//! Maps a file on disk
+		/** \return 0 if the file is smaller than minSize, or can't be mapped
+		on this platform. */
+		static IReadFile* createMappedReadFile(const io::path& fileName, long minSize);
+
+	private:
+
+		CMappedReadFile(const io::path& fileName);
+
+		//! Maps the file if it has at least minSize bytes
+		bool mapFile(long minSize);
+
+		const void *Buffer;
+		long Len;
+		long Pos;
+		io::path Filename;
+#if defined(_IRR_WINDOWS_API_)
+		void* Mapping;
+#endif
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
@@ -0,0 +1,184 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMappedWriteFile.h"
+#include "os.h"
+#include <string.h>
+
+#if defined(_IRR_WINDOWS_API_)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif (defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_) || defined(_IRR_ANDROID_PLATFORM_))
+	#define _IRR_MAPPED_FILES_POSIX_
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace irr
+{
+namespace io
+{
+
+
+CMappedWriteFile::CMappedWriteFile(const io::path& fileName)
+: Buffer(0), Len(0), Pos(0), Written(0), Filename(fileName)
+#if defined(_IRR_WINDOWS_API_)
+, File(INVALID_HANDLE_VALUE), Mapping(0)
+#else
+, Descriptor(-1)
+#endif
+{
+	#ifdef _DEBUG
+	setDebugName("CMappedWriteFile");
+	#endif
+}
+
+
+CMappedWriteFile::~CMappedWriteFile()
+{
+#if defined(_IRR_WINDOWS_API_)
+	if (Buffer)
+		UnmapViewOfFile(Buffer);
+	if (Mapping)
+		CloseHandle(Mapping);
+	if (File != INVALID_HANDLE_VALUE)
+	{
+		// the mapping made the file as large as requested
+		LARGE_INTEGER end;
+		end.QuadPart = Written;
+		if (SetFilePointerEx(File, end, 0, FILE_BEGIN))
+			SetEndOfFile(File);
+		CloseHandle(File);
+	}
+#elif defined(_IRR_MAPPED_FILES_POSIX_)
+	if (Buffer)
+		munmap(Buffer, Len);
+	if (Descriptor >= 0)
+	{
+		if (Written != Len && ftruncate(Descriptor, Written) != 0)
+			os::Printer::log("Could not truncate mapped file", Filename, ELL_WARNING);
+		close(Descriptor);
+	}
+#endif
+}
+
+
+//! returns how much was written, nothing is written beyond the size
+size_t CMappedWriteFile::write(const void* buffer, size_t sizeToWrite)
+{
+	long amount = static_cast<long>(sizeToWrite);
+	if (Pos + amount > Len)
+		amount -= Pos + amount - Len;
+
+	if (amount <= 0)
+		return 0;
+
+	memcpy((c8*)Buffer + Pos, buffer, amount);
+
+	Pos += amount;
+	if (Pos > Written)
+		Written = Pos;
+
+	return static_cast<size_t>(amount);
+}
+
+
+//! changes position in file, returns true if successful
+//! if relativeMovement==true, the pos is changed relative to current pos,
+//! otherwise from begin of file
+bool CMappedWriteFile::seek(long finalPos, bool relativeMovement)
+{
+	if (relativeMovement)
+		finalPos += Pos;
+
+	if (finalPos < 0 || finalPos > Len)
+		return false;
+
+	Pos = finalPos;
+	return true;
+}
+
+
+//! returns where in the file we are.
+long CMappedWriteFile::getPos() const
+{
+	return Pos;
+}
+
+
+//! returns name of file
+const io::path& CMappedWriteFile::getFileName() const
+{
+	return Filename;
+}
+
+
+//! The mapping is written back by the system
+bool CMappedWriteFile::flush()
+{
+	return Buffer != 0;
+}
+
+
+//! Creates the file with size bytes and maps it
+bool CMappedWriteFile::mapFile(long size)
+{
+	// empty files can't be mapped
+	if (size < 1)
+		return false;
+
+#if defined(_IRR_WINDOWS_API_)
+	File = CreateFileA(Filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, 0,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+	if (File == INVALID_HANDLE_VALUE)
+		return false;
+
+	// creating the mapping grows the file to its size
+	Mapping = CreateFileMappingA(File, 0, PAGE_READWRITE, 0, (DWORD)size, 0);
+	if (!Mapping)
+		return false;
+
+	Buffer = MapViewOfFile(Mapping, FILE_MAP_WRITE, 0, 0, 0);
+	if (!Buffer)
+		return false;
+	Len = size;
+	return true;
+#elif defined(_IRR_MAPPED_FILES_POSIX_)
+	Descriptor = open(Filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+	if (Descriptor < 0)
+		return false;
+
+	if (ftruncate(Descriptor, size) != 0)
+		return false;
+
+	void* memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, Descriptor, 0);
+	if (memory == MAP_FAILED)
+		return false;
+
+	Buffer = memory;
+	Len = size;
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+IWriteFile* CMappedWriteFile::createMappedWriteFile(const io::path& fileName, long size)
+{
+	if (fileName.size() == 0)
+		return 0;
+
+	CMappedWriteFile* file = new CMappedWriteFile(fileName);
+	if (file->mapFile(size))
+		return file;
+
+	file->drop();
+	return 0;
+}
+
+
+} // end namespace io
+} // end namespace irr
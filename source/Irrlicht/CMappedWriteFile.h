@@ -0,0 +1,71 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MAPPED_WRITE_FILE_H_INCLUDED__
+#define __C_MAPPED_WRITE_FILE_H_INCLUDED__
+
+#include "IWriteFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace io
+{
+
+	/*!
+		Class for writing a file of known size through a shared memory mapping.
+		Writes are copies into the mapping, the file is cut to the bytes
+		written when it is dropped.
+	*/
+	class CMappedWriteFile : public IWriteFile
+	{
+	public:
+
+		//! Destructor, unmaps the file
+		virtual ~CMappedWriteFile();
+
+		//! returns how much was written, nothing is written beyond the size
+		size_t write(const void* buffer, size_t sizeToWrite) override;
+
+		//! changes position in file, returns true if successful
+		bool seek(long finalPos, bool relativeMovement = false) override;
+
+		//! returns where in the file we are.
+		long getPos() const override;
+
+		//! returns name of file
+		const io::path& getFileName() const override;
+
+		//! The mapping is written back by the system
+		bool flush() override;
+
+		//! Creates a file of the given size and maps it
+		/** \return 0 if the file can't be created or mapped on this platform. */
+		static IWriteFile* createMappedWriteFile(const io::path& fileName, long size);
+
+	private:
+
+		CMappedWriteFile(const io::path& fileName);
+
+		//! Creates the file with size bytes and maps it
+		bool mapFile(long size);
+
+		void *Buffer;
+		long Len;
+		long Pos;
+		//! End of the bytes written
+		long Written;
+		io::path Filename;
+#if defined(_IRR_WINDOWS_API_)
+		void* File;
+		void* Mapping;
+#else
+		int Descriptor;
+#endif
+	};
+
+} // end namespace io
+} // end namespace irr
+
+#endif
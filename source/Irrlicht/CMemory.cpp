@@ -0,0 +1,114 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "irrMemory.h"
+#include "os.h"
+#include <atomic>
+#include <new>
+
+namespace irr
+{
+namespace core
+{
+
+namespace
+{
+	struct SMemoryCounters
+	{
+		std::atomic<s64> LiveBytes;
+		std::atomic<s64> PeakBytes;
+		std::atomic<u64> TotalAllocations;
+		std::atomic<u64> TotalBytes;
+	};
+
+	// zero initialized before any dynamic initialization, so usable from
+	// constructors of static objects
+	SMemoryCounters Counters[EMC_COUNT];
+	std::atomic<IMemoryAllocator*> Allocator;
+	//! Allocations of allocateMemory not freed yet
+	std::atomic<s64> LiveAllocations;
+
+	void count(s64 size, E_MEMORY_CATEGORY category)
+	{
+		SMemoryCounters& c = Counters[category];
+		const s64 live = c.LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+		if (size <= 0)
+			return;
+
+		c.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+		c.TotalBytes.fetch_add((u64)size, std::memory_order_relaxed);
+		s64 peak = c.PeakBytes.load(std::memory_order_relaxed);
+		while (live > peak && !c.PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		{
+		}
+	}
+}
+
+IRRLICHT_API bool IRRCALLCONV setMemoryAllocator(IMemoryAllocator* allocator)
+{
+	if (Allocator.load() == allocator)
+		return true;
+
+	if (LiveAllocations.load() != 0)
+	{
+		os::Printer::log("Could not change the memory allocator while its memory is in use", ELL_ERROR);
+		return false;
+	}
+
+	Allocator.store(allocator);
+	return true;
+}
+
+IRRLICHT_API IMemoryAllocator* IRRCALLCONV getMemoryAllocator()
+{
+	return Allocator.load();
+}
+
+IRRLICHT_API void* IRRCALLCONV allocateMemory(size_t size, E_MEMORY_CATEGORY category)
+{
+	if (size == 0)
+		size = 1;
+
+	IMemoryAllocator* allocator = Allocator.load(std::memory_order_acquire);
+	void* p = allocator ? allocator->allocate(size, category) : ::operator new(size);
+
+	LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+	count((s64)size, category);
+	return p;
+}
+
+IRRLICHT_API void IRRCALLCONV deallocateMemory(void* p, size_t size, E_MEMORY_CATEGORY category)
+{
+	if (!p)
+		return;
+	if (size == 0)
+		size = 1;
+
+	IMemoryAllocator* allocator = Allocator.load(std::memory_order_acquire);
+	if (allocator)
+		allocator->deallocate(p, size, category);
+	else
+		::operator delete(p);
+
+	LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	count(-(s64)size, category);
+}
+
+IRRLICHT_API void IRRCALLCONV trackMemory(s64 size, E_MEMORY_CATEGORY category)
+{
+	count(size, category);
+}
+
+IRRLICHT_API SMemoryStats IRRCALLCONV getMemoryStats(E_MEMORY_CATEGORY category)
+{
+	const SMemoryCounters& c = Counters[category];
+	SMemoryStats stats;
+	stats.LiveBytes = (u64)c.LiveBytes.load(std::memory_order_relaxed);
+	stats.PeakBytes = (u64)c.PeakBytes.load(std::memory_order_relaxed);
+	stats.TotalAllocations = c.TotalAllocations.load(std::memory_order_relaxed);
+	stats.TotalBytes = c.TotalBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+} // end namespace core
+} // end namespace irr
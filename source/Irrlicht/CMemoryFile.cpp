@@ -4,6 +4,7 @@
 
 #include "CMemoryFile.h"
 #include "irrString.h"
+#include "irrMath.h"
 
 namespace irr
 {
@@ -20,6 +21,16 @@ CMemoryReadFile::CMemoryReadFile(const void* memory, long len, const io::path& f
 }
 
 
+CMemoryReadFile::CMemoryReadFile(std::shared_ptr<const c8> memory, long len, const io::path& fileName)
+: Buffer(memory.get()), Len(len), Pos(0), Filename(fileName), deleteMemoryWhenDropped(false),
+	SharedBuffer(memory)
+{
+	#ifdef _DEBUG
+	setDebugName("CMemoryReadFile");
+	#endif
+}
+
+
 CMemoryReadFile::~CMemoryReadFile()
 {
 	if (deleteMemoryWhenDropped)
@@ -69,6 +80,18 @@ bool CMemoryReadFile::seek(long finalPos, bool relativeMovement)
 }
 
 
+//! reads from a position without changing the position of read()
+size_t CMemoryReadFile::readAt(long offset, void* buffer, size_t sizeToRead)
+{
+	if (offset < 0 || offset >= Len)
+		return 0;
+
+	const long amount = core::min_(static_cast<long>(sizeToRead), Len - offset);
+	memcpy(buffer, (const c8*)Buffer + offset, amount);
+	return static_cast<size_t>(amount);
+}
+
+
 //! returns size of file
 long CMemoryReadFile::getSize() const
 {
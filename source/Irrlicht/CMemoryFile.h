@@ -8,6 +8,7 @@
 #include "IMemoryReadFile.h"
 #include "IWriteFile.h"
 #include "irrString.h"
+#include <memory>
 
 namespace irr
 {
@@ -25,6 +26,9 @@ namespace io
 		//! Constructor
 		CMemoryReadFile(const void* memory, long len, const io::path& fileName, bool deleteMemoryWhenDropped);
 
+		//! Constructor, the file keeps a reference to the memory until it is dropped
+		CMemoryReadFile(std::shared_ptr<const c8> memory, long len, const io::path& fileName);
+
 		//! Destructor
 		virtual ~CMemoryReadFile();
 
@@ -34,6 +38,9 @@ namespace io
 		//! changes position in file, returns true if successful
 		bool seek(long finalPos, bool relativeMovement = false) override;
 
+		//! reads from a position without changing the position of read()
+		size_t readAt(long offset, void* buffer, size_t sizeToRead) override;
+
 		//! returns size of file
 		long getSize() const override;
 
@@ -62,6 +69,8 @@ namespace io
 		long Pos;
 		io::path Filename;
 		bool deleteMemoryWhenDropped;
+		//! Holds the memory if it is shared with others
+		std::shared_ptr<const c8> SharedBuffer;
 	};
 
 	/*!
@@ -27,8 +27,12 @@ void CMeshCache::addMesh(const io::path& filename, IAnimatedMesh* mesh)
 
 	MeshEntry e ( filename );
 	e.Mesh = mesh;
+	// the first frame of a skinned mesh is the mesh itself, getting it would animate the mesh
+	e.FirstFrame = mesh->getMeshType() == EAMT_SKINNED ? mesh : mesh->getMesh(0);
 
+	std::lock_guard<std::mutex> lock(Mutex);
 	Meshes.push_back(e);
+	indexEntry(Meshes.size()-1);
 }
 
 
@@ -37,21 +41,18 @@ void CMeshCache::removeMesh(const IMesh* const mesh)
 {
 	if ( !mesh )
 		return;
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-		{
-			Meshes[i].Mesh->drop();
-			Meshes.erase(i);
-			return;
-		}
-	}
+
+	std::lock_guard<std::mutex> lock(Mutex);
+	const s32 index = findMesh(mesh);
+	if (index != -1)
+		removeEntry(index);
 }
 
 
 //! Returns amount of loaded meshes
 u32 CMeshCache::getMeshCount() const
 {
+	std::lock_guard<std::mutex> lock(Mutex);
 	return Meshes.size();
 }
 
@@ -59,19 +60,15 @@ u32 CMeshCache::getMeshCount() const
 //! Returns current number of the mesh
 s32 CMeshCache::getMeshIndex(const IMesh* const mesh) const
 {
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-			return (s32)i;
-	}
-
-	return -1;
+	std::lock_guard<std::mutex> lock(Mutex);
+	return findMesh(mesh);
 }
 
 
 //! Returns a mesh based on its index number
 IAnimatedMesh* CMeshCache::getMeshByIndex(u32 number)
 {
+	std::lock_guard<std::mutex> lock(Mutex);
 	if (number >= Meshes.size())
 		return 0;
 
@@ -82,15 +79,18 @@ IAnimatedMesh* CMeshCache::getMeshByIndex(u32 number)
 //! Returns a mesh based on its name.
 IAnimatedMesh* CMeshCache::getMeshByName(const io::path& name)
 {
-	MeshEntry e ( name );
-	s32 id = Meshes.binary_search(e);
-	return (id != -1) ? Meshes[id].Mesh : 0;
+	const io::SNamedPath namedPath(name);
+
+	std::lock_guard<std::mutex> lock(Mutex);
+	const auto it = NameIndex.find(namedPath.getInternalName());
+	return it != NameIndex.end() ? Meshes[it->second].Mesh : 0;
 }
 
 
 //! Get the name of a loaded mesh, based on its index.
 const io::SNamedPath& CMeshCache::getMeshName(u32 index) const
 {
+	std::lock_guard<std::mutex> lock(Mutex);
 	if (index >= Meshes.size())
 		return emptyNamedPath;
 
@@ -104,23 +104,19 @@ const io::SNamedPath& CMeshCache::getMeshName(const IMesh* const mesh) const
 	if (!mesh)
 		return emptyNamedPath;
 
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-			return Meshes[i].NamedPath;
-	}
-
-	return emptyNamedPath;
+	std::lock_guard<std::mutex> lock(Mutex);
+	const s32 index = findMesh(mesh);
+	return index != -1 ? Meshes[index].NamedPath : emptyNamedPath;
 }
 
 //! Renames a loaded mesh.
 bool CMeshCache::renameMesh(u32 index, const io::path& name)
 {
+	std::lock_guard<std::mutex> lock(Mutex);
 	if (index >= Meshes.size())
 		return false;
 
-	Meshes[index].NamedPath.setPath(name);
-	Meshes.sort();
+	renameEntry(index, name);
 	return true;
 }
 
@@ -128,17 +124,13 @@ bool CMeshCache::renameMesh(u32 index, const io::path& name)
 //! Renames a loaded mesh.
 bool CMeshCache::renameMesh(const IMesh* const mesh, const io::path& name)
 {
-	for (u32 i=0; i<Meshes.size(); ++i)
-	{
-		if (Meshes[i].Mesh == mesh || (Meshes[i].Mesh && Meshes[i].Mesh->getMesh(0) == mesh))
-		{
-			Meshes[i].NamedPath.setPath(name);
-			Meshes.sort();
-			return true;
-		}
-	}
+	std::lock_guard<std::mutex> lock(Mutex);
+	const s32 index = findMesh(mesh);
+	if (index == -1)
+		return false;
 
-	return false;
+	renameEntry(index, name);
+	return true;
 }
 
 
@@ -152,24 +144,98 @@ bool CMeshCache::isMeshLoaded(const io::path& name)
 //! Clears the whole mesh cache, removing all meshes.
 void CMeshCache::clear()
 {
+	std::lock_guard<std::mutex> lock(Mutex);
 	for (u32 i=0; i<Meshes.size(); ++i)
 		Meshes[i].Mesh->drop();
 
 	Meshes.clear();
+	NameIndex.clear();
+	MeshIndex.clear();
 }
 
 //! Clears all meshes that are held in the mesh cache but not used anywhere else.
 void CMeshCache::clearUnusedMeshes()
 {
+	std::lock_guard<std::mutex> lock(Mutex);
+
+	// backwards, so the entries moved into the removed places were checked already
+	for (u32 i=Meshes.size(); i>0; --i)
+	{
+		if (Meshes[i-1].Mesh->getReferenceCount() == 1)
+			removeEntry(i-1);
+	}
+}
+
+
+//! Returns the index of the mesh or of the animated mesh it is the first frame of, or -1
+s32 CMeshCache::findMesh(const IMesh* const mesh) const
+{
+	const auto it = MeshIndex.find(mesh);
+	if (it != MeshIndex.end())
+		return (s32)it->second;
+
+	// the frames of an animated mesh may have changed since it was added
 	for (u32 i=0; i<Meshes.size(); ++i)
 	{
-		if (Meshes[i].Mesh->getReferenceCount() == 1)
-		{
-			Meshes[i].Mesh->drop();
-			Meshes.erase(i);
-			--i;
-		}
+		if (Meshes[i].Mesh->getMeshType() != EAMT_SKINNED && Meshes[i].Mesh->getMesh(0) == mesh)
+			return (s32)i;
+	}
+
+	return -1;
+}
+
+
+//! Removes the entry at an index, moving the last one into its place
+void CMeshCache::removeEntry(u32 index)
+{
+	MeshEntry& e = Meshes[index];
+
+	const auto name = NameIndex.find(e.NamedPath.getInternalName());
+	if (name != NameIndex.end() && name->second == index)
+		NameIndex.erase(name);
+
+	const auto mesh = MeshIndex.find(e.Mesh);
+	if (mesh != MeshIndex.end() && mesh->second == index)
+		MeshIndex.erase(mesh);
+
+	const auto frame = MeshIndex.find(e.FirstFrame);
+	if (frame != MeshIndex.end() && frame->second == index)
+		MeshIndex.erase(frame);
+
+	e.Mesh->drop();
+
+	const u32 last = Meshes.size()-1;
+	if (index != last)
+	{
+		Meshes[index] = Meshes[last];
+		Meshes.erase(last);
+		indexEntry(index);
 	}
+	else
+		Meshes.erase(last);
+}
+
+
+//! Renames the entry at an index
+void CMeshCache::renameEntry(u32 index, const io::path& name)
+{
+	const auto it = NameIndex.find(Meshes[index].NamedPath.getInternalName());
+	if (it != NameIndex.end() && it->second == index)
+		NameIndex.erase(it);
+
+	Meshes[index].NamedPath.setPath(name);
+	NameIndex[Meshes[index].NamedPath.getInternalName()] = index;
+}
+
+
+//! Adds the entry at an index to NameIndex and MeshIndex
+void CMeshCache::indexEntry(u32 index)
+{
+	const MeshEntry& e = Meshes[index];
+	NameIndex[e.NamedPath.getInternalName()] = index;
+	MeshIndex[e.Mesh] = index;
+	if (e.FirstFrame)
+		MeshIndex[e.FirstFrame] = index;
 }
 
 
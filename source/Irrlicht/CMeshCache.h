@@ -7,12 +7,19 @@
 
 #include "IMeshCache.h"
 #include "irrArray.h"
+#include <mutex>
+#include <unordered_map>
 
 namespace irr
 {
 
 namespace scene
 {
+	//! Mesh cache with hashed lookups by name and by mesh
+	/** All methods lock the cache, so meshes can be looked up and added from
+	several threads. References returned by getMeshName() are only valid
+	until the cache is changed. The indices of the meshes are in the order
+	they were added, removing a mesh moves the last one into its place. */
 	class CMeshCache : public IMeshCache
 	{
 	public:
@@ -104,15 +111,44 @@ namespace scene
 			}
 			io::SNamedPath NamedPath;
 			IAnimatedMesh* Mesh;
+			//! first frame of Mesh when it was added, which is found as well
+			const IMesh* FirstFrame;
+		};
 
-			bool operator < (const MeshEntry& other) const
+		struct PathHash
+		{
+			size_t operator()(const io::path& p) const
 			{
-				return (NamedPath < other.NamedPath);
+				// FNV-1a
+				size_t hash = 2166136261u;
+				for (u32 i=0; i<p.size(); ++i)
+					hash = (hash ^ (size_t)p[i]) * 16777619u;
+				return hash;
 			}
 		};
 
+		//! Returns the index of the mesh or of the animated mesh it is the first frame of, or -1
+		s32 findMesh(const IMesh* const mesh) const;
+
+		//! Removes the entry at an index, moving the last one into its place
+		void removeEntry(u32 index);
+
+		//! Renames the entry at an index
+		void renameEntry(u32 index, const io::path& name);
+
+		//! Adds the entry at an index to NameIndex and MeshIndex
+		void indexEntry(u32 index);
+
 		//! loaded meshes
 		core::array<MeshEntry> Meshes;
+
+		//! index in Meshes by internal name
+		std::unordered_map<io::path, u32, PathHash> NameIndex;
+
+		//! index in Meshes by mesh and by first frame
+		std::unordered_map<const IMesh*, u32> MeshIndex;
+
+		mutable std::mutex Mutex;
 	};
 
 
@@ -0,0 +1,107 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CMeshLoadRequest.h"
+#include "IAnimatedMesh.h"
+#include "IReadFile.h"
+#include "ITexture.h"
+
+namespace irr
+{
+namespace scene
+{
+
+CMeshLoadRequest::CMeshLoadRequest(io::IReadFile* file, const io::path& cacheName,
+		const core::array<IMeshLoader*>& loaders)
+	: File(file), CacheName(cacheName), Loaders(loaders), LoadedMesh(0), Mesh(0),
+	Loaded(false), Ready(false), Failed(false)
+{
+	// dropped by the mesh load thread and the caller
+	setThreadSafeReferenceCounting(true);
+	File->grab();
+	for (u32 i=0; i<Loaders.size(); ++i)
+		Loaders[i]->grab();
+}
+
+CMeshLoadRequest::CMeshLoadRequest(IAnimatedMesh* mesh)
+	: File(0), LoadedMesh(0), Mesh(mesh), Loaded(true), Ready(mesh != 0), Failed(mesh == 0)
+{
+}
+
+CMeshLoadRequest::~CMeshLoadRequest()
+{
+	releaseSource();
+
+	if (LoadedMesh)
+		LoadedMesh->drop();
+
+	for (u32 i=0; i<TextureReferences.size(); ++i)
+		TextureReferences[i]->drop();
+}
+
+bool CMeshLoadRequest::isReady() const
+{
+	return Ready.load(std::memory_order_acquire);
+}
+
+bool CMeshLoadRequest::isFailed() const
+{
+	return Failed.load(std::memory_order_acquire);
+}
+
+IAnimatedMesh* CMeshLoadRequest::getMesh() const
+{
+	return isReady() ? Mesh : 0;
+}
+
+void CMeshLoadRequest::load()
+{
+	// iterate the list in reverse order so user-added loaders can override the built-in ones
+	for (s32 i=(s32)Loaders.size()-1; i>=0 && !LoadedMesh; --i)
+	{
+		// reset file to avoid side effects of previous calls to createMesh
+		File->seek(0);
+		LoadedMesh = Loaders[i]->createMesh(File);
+	}
+
+	Loaded.store(true, std::memory_order_release);
+}
+
+bool CMeshLoadRequest::isLoaded() const
+{
+	return Loaded.load(std::memory_order_acquire);
+}
+
+IAnimatedMesh* CMeshLoadRequest::takeLoadedMesh()
+{
+	IAnimatedMesh* mesh = LoadedMesh;
+	LoadedMesh = 0;
+	return mesh;
+}
+
+void CMeshLoadRequest::setReady(IAnimatedMesh* mesh)
+{
+	releaseSource();
+	Mesh = mesh;
+	Ready.store(true, std::memory_order_release);
+}
+
+void CMeshLoadRequest::setFailed()
+{
+	releaseSource();
+	Failed.store(true, std::memory_order_release);
+}
+
+void CMeshLoadRequest::releaseSource()
+{
+	if (File)
+		File->drop();
+	File = 0;
+
+	for (u32 i=0; i<Loaders.size(); ++i)
+		Loaders[i]->drop();
+	Loaders.clear();
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,99 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_MESH_LOAD_REQUEST_H_INCLUDED__
+#define __C_MESH_LOAD_REQUEST_H_INCLUDED__
+
+#include "IMeshLoadRequest.h"
+#include "IMeshLoader.h"
+#include "irrArray.h"
+#include <atomic>
+
+namespace irr
+{
+namespace io
+{
+	class IReadFile;
+} // end namespace io
+namespace video
+{
+	class ITexture;
+} // end namespace video
+namespace scene
+{
+
+//! IMeshLoadRequest implementation, parsed by the loading thread of the scene manager
+class CMeshLoadRequest : public IMeshLoadRequest
+{
+public:
+	//! Request for a file which is parsed later by load()
+	/** \param file File which is only read by the loading thread from now
+	on, grabbed by the request.
+	\param loaders Loaders to try, last one first. They are grabbed by the
+	request, so loaders added to the scene manager meanwhile don't matter. */
+	CMeshLoadRequest(io::IReadFile* file, const io::path& cacheName,
+			const core::array<IMeshLoader*>& loaders);
+
+	//! Request which is ready right away
+	/** \param mesh Mesh which is already in the mesh cache. May be 0, the
+	request fails then. */
+	explicit CMeshLoadRequest(IAnimatedMesh* mesh);
+
+	~CMeshLoadRequest();
+
+	bool isReady() const override;
+
+	bool isFailed() const override;
+
+	IAnimatedMesh* getMesh() const override;
+
+	//! Name of the mesh in the mesh cache
+	const io::path& getCacheName() const { return CacheName; }
+
+	//! Parses the file, called on the loading thread
+	void load();
+
+	//! Check if load() is done
+	bool isLoaded() const;
+
+	//! Takes the mesh created by load(), which may be 0
+	/** Only valid once isLoaded() returns true. The caller has to drop the mesh. */
+	IAnimatedMesh* takeLoadedMesh();
+
+	//! Takes the texture references recorded while the file was parsed
+	/** Called on the loading thread after load(). */
+	void setTextureReferences(core::array<video::ITexture*>& references) { TextureReferences.swap(references); }
+
+	//! Gives the texture references to resolve along with takeLoadedMesh()
+	void takeTextureReferences(core::array<video::ITexture*>& references) { references.swap(TextureReferences); }
+
+	//! Sets the mesh from the mesh cache, which makes the request ready
+	void setReady(IAnimatedMesh* mesh);
+
+	//! Releases the file and the loaders, the request is never ready then
+	void setFailed();
+
+private:
+	//! Drops the file and the loaders
+	void releaseSource();
+
+	io::IReadFile* File;
+	io::path CacheName;
+	core::array<IMeshLoader*> Loaders;
+
+	//! mesh created by load(), until it is taken
+	IAnimatedMesh* LoadedMesh;
+	//! references of ISceneManager::addMeshTextureReference() for LoadedMesh
+	core::array<video::ITexture*> TextureReferences;
+	//! mesh in the mesh cache
+	IAnimatedMesh* Mesh;
+
+	std::atomic<bool> Loaded;
+	std::atomic<bool> Ready;
+	std::atomic<bool> Failed;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -9,82 +9,333 @@
 #include "SAnimatedMesh.h"
 #include "os.h"
 #include "triangle3d.h"
+#include "CJobSystem.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _IRR_NORMALS_SSE2_
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define _IRR_NORMALS_NEON_
+#endif
 
 namespace irr
 {
 namespace scene
 {
 
-static inline core::vector3df getAngleWeight(const core::vector3df& v1,
-		const core::vector3df& v2,
-		const core::vector3df& v3)
+namespace
+{
+#if defined(_IRR_NORMALS_SSE2_)
+	typedef __m128 f32x4;
+
+	inline f32x4 load4(const f32* p) { return _mm_loadu_ps(p); }
+	inline void store4(f32* p, f32x4 a) { _mm_storeu_ps(p, a); }
+	inline f32x4 set4(f32 a, f32 b, f32 c, f32 d) { return _mm_setr_ps(a, b, c, d); }
+	inline f32x4 splat4(f32 v) { return _mm_set1_ps(v); }
+	inline f32x4 add4(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+	inline f32x4 div4(f32x4 a, f32x4 b) { return _mm_div_ps(a, b); }
+	inline f32x4 sqrt4(f32x4 a) { return _mm_sqrt_ps(a); }
+	inline f32x4 max4(f32x4 a, f32x4 b) { return _mm_max_ps(a, b); }
+	inline f32x4 min4(f32x4 a, f32x4 b) { return _mm_min_ps(a, b); }
+	inline f32x4 abs4(f32x4 a) { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+	//! 1 where a is negative, else 0
+	inline f32x4 negative4(f32x4 a) { return _mm_and_ps(_mm_cmplt_ps(a, _mm_setzero_ps()), _mm_set1_ps(1.f)); }
+#elif defined(_IRR_NORMALS_NEON_)
+	typedef float32x4_t f32x4;
+
+	inline f32x4 load4(const f32* p) { return vld1q_f32(p); }
+	inline void store4(f32* p, f32x4 a) { vst1q_f32(p, a); }
+	inline f32x4 set4(f32 a, f32 b, f32 c, f32 d) { const f32 v[4] = { a, b, c, d }; return vld1q_f32(v); }
+	inline f32x4 splat4(f32 v) { return vdupq_n_f32(v); }
+	inline f32x4 add4(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+	inline f32x4 div4(f32x4 a, f32x4 b) { return vdivq_f32(a, b); }
+	inline f32x4 sqrt4(f32x4 a) { return vsqrtq_f32(a); }
+	inline f32x4 max4(f32x4 a, f32x4 b) { return vmaxq_f32(a, b); }
+	inline f32x4 min4(f32x4 a, f32x4 b) { return vminq_f32(a, b); }
+	inline f32x4 abs4(f32x4 a) { return vabsq_f32(a); }
+	inline f32x4 negative4(f32x4 a) { return vbslq_f32(vcltq_f32(a, vdupq_n_f32(0.f)), vdupq_n_f32(1.f), vdupq_n_f32(0.f)); }
+#else
+	struct f32x4
+	{
+		f32 v[4];
+	};
+
+	inline f32x4 load4(const f32* p) { f32x4 r; for (u32 i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+	inline void store4(f32* p, f32x4 a) { for (u32 i = 0; i < 4; ++i) p[i] = a.v[i]; }
+	inline f32x4 set4(f32 a, f32 b, f32 c, f32 d) { f32x4 r = { { a, b, c, d } }; return r; }
+	inline f32x4 splat4(f32 v) { f32x4 r; for (u32 i = 0; i < 4; ++i) r.v[i] = v; return r; }
+	inline f32x4 add4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+	inline f32x4 div4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+	inline f32x4 sqrt4(f32x4 a) { for (u32 i = 0; i < 4; ++i) a.v[i] = sqrtf(a.v[i]); return a; }
+	inline f32x4 max4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] = core::max_(a.v[i], b.v[i]); return a; }
+	inline f32x4 min4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] = core::min_(a.v[i], b.v[i]); return a; }
+	inline f32x4 abs4(f32x4 a) { for (u32 i = 0; i < 4; ++i) a.v[i] = fabsf(a.v[i]); return a; }
+	inline f32x4 negative4(f32x4 a) { for (u32 i = 0; i < 4; ++i) a.v[i] = a.v[i] < 0.f ? 1.f : 0.f; return a; }
+#endif
+
+//! Divides x, y and z by the length of the vectors they form, zero vectors stay zero
+inline void normalize4(f32x4& x, f32x4& y, f32x4& z)
 {
-	// Calculate this triangle's weight for each of its three vertices
-	// start by calculating the lengths of its sides
-	const f32 a = v2.getDistanceFromSQ(v3);
-	const f32 asqrt = sqrtf(a);
-	const f32 b = v1.getDistanceFromSQ(v3);
-	const f32 bsqrt = sqrtf(b);
-	const f32 c = v1.getDistanceFromSQ(v2);
-	const f32 csqrt = sqrtf(c);
+	const f32x4 length = sqrt4(max4(add4(add4(mul4(x, x), mul4(y, y)), mul4(z, z)), splat4(1e-30f)));
+	const f32x4 inverse = div4(splat4(1.f), length);
+	x = mul4(x, inverse);
+	y = mul4(y, inverse);
+	z = mul4(z, inverse);
+}
 
-	// use them to find the angle at each vertex
-	return core::vector3df(
-		acosf((b + c - a) / (2.f * bsqrt * csqrt)),
-		acosf((-b + c + a) / (2.f * asqrt * csqrt)),
-		acosf((b - c + a) / (2.f * bsqrt * asqrt)));
+//! All vertex types start with the members of S3DVertex
+inline video::S3DVertex& getVertex(u8* vertices, u32 pitch, u32 i)
+{
+	return *reinterpret_cast<video::S3DVertex*>(vertices + i*pitch);
 }
 
+inline const video::S3DVertex& getVertex(const u8* vertices, u32 pitch, u32 i)
+{
+	return *reinterpret_cast<const video::S3DVertex*>(vertices + i*pitch);
+}
 
-namespace
+//! acos with an error below 2e-8, Abramowitz and Stegun 4.4.46, x is clamped to [-1,1]
+inline f32x4 acos4(f32x4 x)
+{
+	x = max4(min4(x, splat4(1.f)), splat4(-1.f));
+	const f32x4 a = abs4(x);
+	f32x4 poly = splat4(-0.0012624911f);
+	poly = add4(mul4(poly, a), splat4(0.0066700901f));
+	poly = add4(mul4(poly, a), splat4(-0.0170881256f));
+	poly = add4(mul4(poly, a), splat4(0.0308918810f));
+	poly = add4(mul4(poly, a), splat4(-0.0501743046f));
+	poly = add4(mul4(poly, a), splat4(0.0889789874f));
+	poly = add4(mul4(poly, a), splat4(-0.2145988016f));
+	poly = add4(mul4(poly, a), splat4(1.5707963050f));
+	const f32x4 result = mul4(sqrt4(sub4(splat4(1.f), a)), poly);
+
+	// acos(-x) = pi - acos(x)
+	return add4(result, mul4(negative4(x), sub4(splat4(core::PI), add4(result, result))));
+}
+
+//! Four triangles in SoA form, the positions of their corners and their unit normals
+struct STriangleBatch
 {
+	//! The corners of the triangles, missing triangles use Zero
+	const video::S3DVertex* Corners[4][3];
+	f32 NX[4];
+	f32 NY[4];
+	f32 NZ[4];
+	//! The angles at the corners, if calculated
+	f32 Angles[3][4];
+
+	//! Points the corners at the triangles starting at index first
+	template <typename T>
+	u32 gather(const u8* vertices, u32 pitch, const T* idx, u32 first, u32 idxcnt)
+	{
+		static const video::S3DVertex Zero;
+		const u32 count = core::min_((idxcnt - first) / 3, 4u);
+		for (u32 t=0; t<4; ++t)
+		{
+			for (u32 k=0; k<3; ++k)
+				Corners[t][k] = t < count ? &getVertex(vertices, pitch, idx[first + t*3 + k]) : &Zero;
+		}
+		return count;
+	}
+
+	//! Calculates the unit normals, like core::plane3df does, and the angles like getAngleWeight()
+	void calculate(bool angles)
+	{
+		f32x4 x[3], y[3], z[3];
+		for (u32 k=0; k<3; ++k)
+		{
+			x[k] = set4(Corners[0][k]->Pos.X, Corners[1][k]->Pos.X, Corners[2][k]->Pos.X, Corners[3][k]->Pos.X);
+			y[k] = set4(Corners[0][k]->Pos.Y, Corners[1][k]->Pos.Y, Corners[2][k]->Pos.Y, Corners[3][k]->Pos.Y);
+			z[k] = set4(Corners[0][k]->Pos.Z, Corners[1][k]->Pos.Z, Corners[2][k]->Pos.Z, Corners[3][k]->Pos.Z);
+		}
+
+		const f32x4 ax = sub4(x[1], x[0]), ay = sub4(y[1], y[0]), az = sub4(z[1], z[0]);
+		const f32x4 bx = sub4(x[2], x[0]), by = sub4(y[2], y[0]), bz = sub4(z[2], z[0]);
+
+		f32x4 nx = sub4(mul4(ay, bz), mul4(az, by));
+		f32x4 ny = sub4(mul4(az, bx), mul4(ax, bz));
+		f32x4 nz = sub4(mul4(ax, by), mul4(ay, bx));
+		normalize4(nx, ny, nz);
+
+		store4(NX, nx);
+		store4(NY, ny);
+		store4(NZ, nz);
+
+		if (!angles)
+			return;
+
+		// the squared lengths of the sides opposite of the corners
+		const f32x4 cx = sub4(x[2], x[1]), cy = sub4(y[2], y[1]), cz = sub4(z[2], z[1]);
+		const f32x4 a = add4(add4(mul4(cx, cx), mul4(cy, cy)), mul4(cz, cz));
+		const f32x4 b = add4(add4(mul4(bx, bx), mul4(by, by)), mul4(bz, bz));
+		const f32x4 c = add4(add4(mul4(ax, ax), mul4(ay, ay)), mul4(az, az));
+		// degenerated triangles must not turn the sums into NaN
+		const f32x4 tiny = splat4(1e-30f);
+		const f32x4 asqrt = sqrt4(max4(a, tiny));
+		const f32x4 bsqrt = sqrt4(max4(b, tiny));
+		const f32x4 csqrt = sqrt4(max4(c, tiny));
+		const f32x4 two = splat4(2.f);
+
+		store4(Angles[0], acos4(div4(sub4(add4(b, c), a), mul4(two, mul4(bsqrt, csqrt)))));
+		store4(Angles[1], acos4(div4(sub4(add4(c, a), b), mul4(two, mul4(asqrt, csqrt)))));
+		store4(Angles[2], acos4(div4(sub4(add4(b, a), c), mul4(two, mul4(bsqrt, asqrt)))));
+	}
+};
+
+//! weld[v] is the first vertex at the position of v, found through a hash table
+void weldPositions(const u8* vertices, u32 pitch, u32 vtxcnt, core::array<u32>& weld)
+{
+	u32 size = 1;
+	while (size < vtxcnt * 2)
+		size <<= 1;
+
+	core::array<u32> table;
+	table.set_used(size);
+	memset(table.pointer(), 0xff, size * sizeof(u32));
+
+	weld.set_used(vtxcnt);
+	for (u32 v=0; v<vtxcnt; ++v)
+	{
+		const core::vector3df& p = getVertex(vertices, pitch, v).Pos;
+		// adding 0 turns -0 into 0, so both hash alike
+		const f32 coords[3] = { p.X + 0.f, p.Y + 0.f, p.Z + 0.f };
+		u32 bits[3];
+		memcpy(bits, coords, sizeof(bits));
+		u32 slot = ((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u)) & (size - 1);
+
+		while (table[slot] != 0xffffffff)
+		{
+			const core::vector3df& q = getVertex(vertices, pitch, table[slot]).Pos;
+			if (q.X == p.X && q.Y == p.Y && q.Z == p.Z)
+				break;
+			slot = (slot + 1) & (size - 1);
+		}
+
+		if (table[slot] == 0xffffffff)
+			table[slot] = v;
+		weld[v] = table[slot];
+	}
+}
+
+//! Recalculates the normals four triangles at a time
+/** Smooth normals are summed for each position, so vertices which only
+differ in other attributes, like at texture seams, get the same normal. */
 template <typename T>
 void recalculateNormalsT(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
 {
 	const u32 vtxcnt = buffer->getVertexCount();
 	const u32 idxcnt = buffer->getIndexCount();
 	const T* idx = reinterpret_cast<T*>(buffer->getIndices());
+	u8* vertices = static_cast<u8*>(buffer->getVertices());
+	const u32 pitch = video::getVertexPitchFromType(buffer->getVertexType());
+	STriangleBatch batch;
 
 	if (!smooth)
 	{
-		for (u32 i=0; i<idxcnt; i+=3)
+		for (u32 i=0; i+2<idxcnt; i+=12)
 		{
-			const core::vector3df& v1 = buffer->getPosition(idx[i+0]);
-			const core::vector3df& v2 = buffer->getPosition(idx[i+1]);
-			const core::vector3df& v3 = buffer->getPosition(idx[i+2]);
-			const core::vector3df normal = core::plane3d<f32>(v1, v2, v3).Normal;
-			buffer->getNormal(idx[i+0]) = normal;
-			buffer->getNormal(idx[i+1]) = normal;
-			buffer->getNormal(idx[i+2]) = normal;
+			const u32 count = batch.gather(vertices, pitch, idx, i, idxcnt);
+			batch.calculate(false);
+			for (u32 t=0; t<count; ++t)
+			{
+				const core::vector3df normal(batch.NX[t], batch.NY[t], batch.NZ[t]);
+				for (u32 k=0; k<3; ++k)
+					const_cast<video::S3DVertex*>(batch.Corners[t][k])->Normal = normal;
+			}
 		}
+		return;
 	}
-	else
-	{
-		u32 i;
-
-		for ( i = 0; i!= vtxcnt; ++i )
-			buffer->getNormal(i).set(0.f, 0.f, 0.f);
 
-		for ( i=0; i<idxcnt; i+=3)
-		{
-			const core::vector3df& v1 = buffer->getPosition(idx[i+0]);
-			const core::vector3df& v2 = buffer->getPosition(idx[i+1]);
-			const core::vector3df& v3 = buffer->getPosition(idx[i+2]);
-			const core::vector3df normal = core::plane3d<f32>(v1, v2, v3).Normal;
+	core::array<u32> weld;
+	weldPositions(vertices, pitch, vtxcnt, weld);
 
-			core::vector3df weight(1.f,1.f,1.f);
-			if (angleWeighted)
-				weight = irr::scene::getAngleWeight(v1,v2,v3); // writing irr::scene:: necessary for borland
+	// the sums in SoA form, padded to whole batches
+	const u32 padded = (vtxcnt + 3) & ~3u;
+	core::array<f32> sums;
+	sums.set_used(padded * 3);
+	memset(sums.pointer(), 0, padded * 3 * sizeof(f32));
+	f32* sumX = sums.pointer();
+	f32* sumY = sumX + padded;
+	f32* sumZ = sumY + padded;
 
-			buffer->getNormal(idx[i+0]) += weight.X*normal;
-			buffer->getNormal(idx[i+1]) += weight.Y*normal;
-			buffer->getNormal(idx[i+2]) += weight.Z*normal;
+	for (u32 i=0; i+2<idxcnt; i+=12)
+	{
+		const u32 count = batch.gather(vertices, pitch, idx, i, idxcnt);
+		batch.calculate(angleWeighted);
+		for (u32 t=0; t<count; ++t)
+		{
+			for (u32 k=0; k<3; ++k)
+			{
+				const u32 w = weld[idx[i + t*3 + k]];
+				const f32 weight = angleWeighted ? batch.Angles[k][t] : 1.f;
+				sumX[w] += weight * batch.NX[t];
+				sumY[w] += weight * batch.NY[t];
+				sumZ[w] += weight * batch.NZ[t];
+			}
 		}
+	}
 
-		for ( i = 0; i!= vtxcnt; ++i )
-			buffer->getNormal(i).normalize();
+	for (u32 v=0; v<padded; v+=4)
+	{
+		f32x4 x = load4(sumX + v), y = load4(sumY + v), z = load4(sumZ + v);
+		normalize4(x, y, z);
+		store4(sumX + v, x);
+		store4(sumY + v, y);
+		store4(sumZ + v, z);
 	}
+
+	for (u32 v=0; v!=vtxcnt; ++v)
+	{
+		const u32 w = weld[v];
+		getVertex(vertices, pitch, v).Normal.set(sumX[w], sumY[w], sumZ[w]);
+	}
+}
+
+//! Recalculates the normals of a buffer of any index type
+void recalculateBufferNormals(IMeshBuffer* buffer, bool smooth, bool angleWeighted)
+{
+	if (buffer->getIndexType()==video::EIT_16BIT)
+		recalculateNormalsT<u16>(buffer, smooth, angleWeighted);
+	else
+		recalculateNormalsT<u32>(buffer, smooth, angleWeighted);
+}
+
+//! Meshes with fewer indices have their buffers recalculated on the calling thread
+const u32 PARALLEL_NORMALS_MIN_INDICES = 65536;
+
+struct SNormalsJob
+{
+	IMeshBuffer* Buffer;
+	bool Smooth;
+	bool AngleWeighted;
+};
+
+void normalsJob(void* data)
+{
+	const SNormalsJob* job = static_cast<const SNormalsJob*>(data);
+	recalculateBufferNormals(job->Buffer, job->Smooth, job->AngleWeighted);
+}
+}
+
+
+//! Constructor
+CMeshManipulator::CMeshManipulator() : Jobs(0)
+{
 }
+
+
+//! Destructor
+CMeshManipulator::~CMeshManipulator()
+{
+	delete Jobs;
 }
 
 
@@ -95,10 +346,7 @@ void CMeshManipulator::recalculateNormals(IMeshBuffer* buffer, bool smooth, bool
 	if (!buffer)
 		return;
 
-	if (buffer->getIndexType()==video::EIT_16BIT)
-		recalculateNormalsT<u16>(buffer, smooth, angleWeighted);
-	else
-		recalculateNormalsT<u32>(buffer, smooth, angleWeighted);
+	recalculateBufferNormals(buffer, smooth, angleWeighted);
 }
 
 
@@ -116,8 +364,35 @@ void CMeshManipulator::recalculateNormals(scene::IMesh* mesh, bool smooth, bool
 	}
 
 	const u32 bcount = mesh->getMeshBufferCount();
-	for ( u32 b=0; b<bcount; ++b)
-		recalculateNormals(mesh->getMeshBuffer(b), smooth, angleWeighted);
+	u32 idxcnt = 0;
+	for (u32 b=0; b<bcount; ++b)
+		idxcnt += mesh->getMeshBuffer(b)->getIndexCount();
+
+	// the buffers are spread over the worker threads, unless another thread
+	// is using them, loaders call this on the loading thread as well
+	std::unique_lock<std::mutex> lock(JobsMutex, std::defer_lock);
+	const u32 cores = std::thread::hardware_concurrency();
+	if (bcount > 1 && cores > 1 && idxcnt >= PARALLEL_NORMALS_MIN_INDICES && lock.try_lock())
+	{
+		if (!Jobs)
+			Jobs = new CJobSystem(cores - 1);
+
+		core::array<SNormalsJob> jobs;
+		jobs.set_used(bcount);
+		for (u32 b=0; b<bcount; ++b)
+		{
+			jobs[b].Buffer = mesh->getMeshBuffer(b);
+			jobs[b].Smooth = smooth;
+			jobs[b].AngleWeighted = angleWeighted;
+			Jobs->add(normalsJob, &jobs[b]);
+		}
+		Jobs->wait();
+	}
+	else
+	{
+		for (u32 b=0; b<bcount; ++b)
+			recalculateNormals(mesh->getMeshBuffer(b), smooth, angleWeighted);
+	}
 
 	if (mesh->getMeshType() == EAMT_SKINNED)
 	{
@@ -127,6 +402,861 @@ void CMeshManipulator::recalculateNormals(scene::IMesh* mesh, bool smooth, bool
 }
 
 
+namespace
+{
+
+//! Size of the post transform vertex cache the triangles are ordered for
+const u32 VERTEX_CACHE_SIZE = 32;
+
+//! Size of the FIFO cache the overdraw clusters are split with, that of older hardware
+const u32 OVERDRAW_CACHE_SIZE = 16;
+
+//! Clusters may have this much more cache misses than the cache ordered triangles
+const f32 OVERDRAW_THRESHOLD = 1.05f;
+
+//! Orders vertices by their bytes, and equal ones by their index
+struct SVertexLess
+{
+	SVertexLess(const u8* vertices, u32 pitch) : Vertices(vertices), Pitch(pitch) {}
+
+	bool operator()(u32 a, u32 b) const
+	{
+		const int cmp = memcmp(Vertices + a*Pitch, Vertices + b*Pitch, Pitch);
+		return cmp < 0 || (cmp == 0 && a < b);
+	}
+
+	const u8* Vertices;
+	u32 Pitch;
+};
+
+//! Points the indices at the first of each group of equal vertices
+//! \return True if any vertices were equal
+bool weldVertices(IMeshBuffer* buffer, u16* indices, u32 indexCount)
+{
+	const u32 vertexCount = buffer->getVertexCount();
+	const u32 pitch = video::getVertexPitchFromType(buffer->getVertexType());
+	const u8* vertices = (const u8*)buffer->getVertices();
+
+	core::array<u32> order;
+	order.set_used(vertexCount);
+	for (u32 i=0; i<vertexCount; ++i)
+		order[i] = i;
+	std::sort(order.pointer(), order.pointer() + vertexCount, SVertexLess(vertices, pitch));
+
+	core::array<u32> remap;
+	remap.set_used(vertexCount);
+	for (u32 i=0; i<vertexCount; ++i)
+		remap[i] = i;
+
+	bool welded = false;
+	for (u32 i=1; i<vertexCount; ++i)
+	{
+		if (memcmp(vertices + order[i-1]*pitch, vertices + order[i]*pitch, pitch) == 0)
+		{
+			remap[order[i]] = remap[order[i-1]];
+			welded = true;
+		}
+	}
+
+	if (welded)
+	{
+		for (u32 i=0; i<indexCount; ++i)
+			indices[i] = (u16)remap[indices[i]];
+	}
+	return welded;
+}
+
+//! Score of a vertex, from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+class CVertexScore
+{
+public:
+	CVertexScore()
+	{
+		// the vertices of the last triangle get a fixed score, so it isn't repeated
+		for (u32 i=0; i<3; ++i)
+			CacheScores[i] = 0.75f;
+		for (u32 i=3; i<VERTEX_CACHE_SIZE; ++i)
+			CacheScores[i] = powf(1.f - (i-3) / (f32)(VERTEX_CACHE_SIZE-3), 1.5f);
+
+		// vertices with few triangles left are preferred, to get rid of them
+		ValenceScores[0] = 0.f;
+		for (u32 i=1; i<VALENCE_SCORES; ++i)
+			ValenceScores[i] = 2.f * powf((f32)i, -0.5f);
+	}
+
+	f32 get(s32 cachePosition, u32 remainingTriangles) const
+	{
+		if (remainingTriangles == 0)
+			return -1.f;
+
+		const f32 score = remainingTriangles < VALENCE_SCORES ? ValenceScores[remainingTriangles] :
+			2.f * powf((f32)remainingTriangles, -0.5f);
+		return cachePosition < 0 ? score : score + CacheScores[cachePosition];
+	}
+
+private:
+	enum { VALENCE_SCORES = 32 };
+
+	f32 CacheScores[VERTEX_CACHE_SIZE];
+	f32 ValenceScores[VALENCE_SCORES];
+};
+
+//! Orders the triangles for the vertex cache, always adding the triangle of the highest score
+void optimizeVertexCache(u16* indices, u32 triangleCount, u32 vertexCount)
+{
+	const u32 indexCount = triangleCount * 3;
+	const CVertexScore scores;
+
+	// the triangles not added yet of vertex v are
+	// VertexTriangles[TriangleStart[v]] to VertexTriangles[TriangleStart[v]+Remaining[v]-1]
+	core::array<u32> remaining;
+	remaining.set_used(vertexCount);
+	memset(remaining.pointer(), 0, vertexCount * sizeof(u32));
+	for (u32 i=0; i<indexCount; ++i)
+		++remaining[indices[i]];
+
+	core::array<u32> triangleStart;
+	triangleStart.set_used(vertexCount);
+	u32 offset = 0;
+	for (u32 v=0; v<vertexCount; ++v)
+	{
+		triangleStart[v] = offset;
+		offset += remaining[v];
+	}
+
+	core::array<u32> vertexTriangles;
+	vertexTriangles.set_used(indexCount);
+	core::array<u32> filled;
+	filled.set_used(vertexCount);
+	memset(filled.pointer(), 0, vertexCount * sizeof(u32));
+	for (u32 i=0; i<indexCount; ++i)
+	{
+		const u16 v = indices[i];
+		vertexTriangles[triangleStart[v] + filled[v]++] = i / 3;
+	}
+
+	core::array<s32> cachePosition;
+	core::array<f32> vertexScore;
+	cachePosition.set_used(vertexCount);
+	vertexScore.set_used(vertexCount);
+	for (u32 v=0; v<vertexCount; ++v)
+	{
+		cachePosition[v] = -1;
+		vertexScore[v] = scores.get(-1, remaining[v]);
+	}
+
+	core::array<f32> triangleScore;
+	core::array<u8> added;
+	triangleScore.set_used(triangleCount);
+	added.set_used(triangleCount);
+	s32 best = -1;
+	for (u32 t=0; t<triangleCount; ++t)
+	{
+		const u16* tri = indices + t*3;
+		triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+		added[t] = 0;
+		if (best < 0 || triangleScore[t] > triangleScore[best])
+			best = t;
+	}
+
+	core::array<u16> output;
+	output.reallocate(indexCount, false);
+
+	u32 cache[VERTEX_CACHE_SIZE + 3];
+	u32 cacheSize = 0;
+	u32 nextUnadded = 0;
+
+	while (best >= 0)
+	{
+		added[best] = 1;
+		const u16* tri = indices + best*3;
+
+		u32 newCache[VERTEX_CACHE_SIZE + 3];
+		u32 newCacheSize = 0;
+		for (u32 k=0; k<3; ++k)
+		{
+			const u16 v = tri[k];
+			output.push_back(v);
+
+			u32* list = vertexTriangles.pointer() + triangleStart[v];
+			for (u32 j=0; j<remaining[v]; ++j)
+			{
+				if (list[j] == (u32)best)
+				{
+					list[j] = list[remaining[v]-1];
+					break;
+				}
+			}
+			--remaining[v];
+
+			// the vertices of degenerated triangles are only cached once
+			if (newCacheSize == 0 || newCache[0] != v)
+			{
+				if (newCacheSize < 2 || newCache[1] != v)
+					newCache[newCacheSize++] = v;
+			}
+		}
+
+		for (u32 i=0; i<cacheSize; ++i)
+		{
+			const u32 v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				newCache[newCacheSize++] = v;
+		}
+
+		// vertices pushed out of the cache are rescored as well
+		for (u32 i=0; i<newCacheSize; ++i)
+			cachePosition[newCache[i]] = i < VERTEX_CACHE_SIZE ? (s32)i : -1;
+
+		for (u32 i=0; i<newCacheSize; ++i)
+		{
+			const u32 v = newCache[i];
+			const f32 score = scores.get(cachePosition[v], remaining[v]);
+			const f32 change = score - vertexScore[v];
+			vertexScore[v] = score;
+
+			const u32* list = vertexTriangles.const_pointer() + triangleStart[v];
+			for (u32 j=0; j<remaining[v]; ++j)
+				triangleScore[list[j]] += change;
+		}
+
+		cacheSize = core::min_(newCacheSize, VERTEX_CACHE_SIZE);
+		memcpy(cache, newCache, cacheSize * sizeof(u32));
+
+		// the next triangle uses a cached vertex if possible
+		best = -1;
+		for (u32 i=0; i<cacheSize; ++i)
+		{
+			const u32 v = cache[i];
+			const u32* list = vertexTriangles.const_pointer() + triangleStart[v];
+			for (u32 j=0; j<remaining[v]; ++j)
+			{
+				if (best < 0 || triangleScore[list[j]] > triangleScore[best])
+					best = list[j];
+			}
+		}
+
+		if (best < 0)
+		{
+			while (nextUnadded < triangleCount && added[nextUnadded])
+				++nextUnadded;
+			if (nextUnadded < triangleCount)
+				best = nextUnadded;
+		}
+	}
+
+	memcpy(indices, output.const_pointer(), indexCount * sizeof(u16));
+}
+
+//! FIFO vertex cache simulation
+class CFifoCache
+{
+public:
+	CFifoCache(u32 vertexCount) : Time(OVERDRAW_CACHE_SIZE + 1)
+	{
+		Timestamps.set_used(vertexCount);
+		memset(Timestamps.pointer(), 0, vertexCount * sizeof(u32));
+	}
+
+	//! Adds the vertices of a triangle, returns the number of cache misses
+	u32 add(const u16* tri)
+	{
+		u32 misses = 0;
+		for (u32 k=0; k<3; ++k)
+		{
+			// a vertex is cached if less than OVERDRAW_CACHE_SIZE vertices came in after it
+			if (Time - Timestamps[tri[k]] > OVERDRAW_CACHE_SIZE)
+			{
+				Timestamps[tri[k]] = ++Time;
+				++misses;
+			}
+		}
+		return misses;
+	}
+
+	void flush()
+	{
+		Time += OVERDRAW_CACHE_SIZE + 1;
+	}
+
+private:
+	core::array<u32> Timestamps;
+	u32 Time;
+};
+
+struct SOverdrawCluster
+{
+	u32 Start;
+	u32 End;
+	f32 Outwardness;
+
+	bool operator<(const SOverdrawCluster& other) const
+	{
+		return Outwardness > other.Outwardness;
+	}
+};
+
+//! Orders clusters of the cache ordered triangles from the outside of the mesh in, after Sander et al.'s Tipsify
+void optimizeOverdraw(u16* indices, u32 triangleCount, const IMeshBuffer* buffer)
+{
+	CFifoCache cache(buffer->getVertexCount());
+
+	// the cache ordering started over where all vertices of a triangle miss
+	core::array<u32> hardStarts;
+	for (u32 t=0; t<triangleCount; ++t)
+	{
+		if (cache.add(indices + t*3) == 3 || t == 0)
+			hardStarts.push_back(t);
+	}
+	hardStarts.push_back(triangleCount);
+
+	// the clusters are split further while their cache misses stay close to those of the whole cluster
+	core::array<SOverdrawCluster> clusters;
+	for (u32 c=0; c+1<hardStarts.size(); ++c)
+	{
+		const u32 start = hardStarts[c];
+		const u32 end = hardStarts[c+1];
+
+		cache.flush();
+		u32 misses = 0;
+		for (u32 t=start; t<end; ++t)
+			misses += cache.add(indices + t*3);
+		const f32 threshold = OVERDRAW_THRESHOLD * misses / (end - start);
+
+		cache.flush();
+		SOverdrawCluster cluster;
+		cluster.Start = start;
+		misses = 0;
+		for (u32 t=start; t<end; ++t)
+		{
+			misses += cache.add(indices + t*3);
+			if (t+1 == end || misses <= threshold * (t+1 - cluster.Start))
+			{
+				cluster.End = t+1;
+				clusters.push_back(cluster);
+				cluster.Start = t+1;
+				misses = 0;
+				cache.flush();
+			}
+		}
+	}
+
+	// centroids weighted by the triangle areas
+	core::vector3df meshCentroid;
+	f32 meshArea = 0.f;
+	core::array<core::vector3df> centroids;
+	core::array<core::vector3df> normals;
+	centroids.set_used(clusters.size());
+	normals.set_used(clusters.size());
+	for (u32 c=0; c<clusters.size(); ++c)
+	{
+		core::vector3df centroid;
+		core::vector3df normal;
+		f32 area = 0.f;
+		for (u32 t=clusters[c].Start; t<clusters[c].End; ++t)
+		{
+			const core::vector3df& a = buffer->getPosition(indices[t*3]);
+			const core::vector3df& b = buffer->getPosition(indices[t*3+1]);
+			const core::vector3df& d = buffer->getPosition(indices[t*3+2]);
+			const core::vector3df cross = (b - a).crossProduct(d - a);
+			const f32 triangleArea = cross.getLength();
+			centroid += (a + b + d) * (triangleArea / 3.f);
+			normal += cross;
+			area += triangleArea;
+		}
+
+		meshCentroid += centroid;
+		meshArea += area;
+		centroids[c] = area > 0.f ? centroid / area : centroid;
+		normals[c] = normal.normalize();
+	}
+	if (meshArea > 0.f)
+		meshCentroid /= meshArea;
+
+	// clusters facing away from the center are drawn first, they likely occlude the others
+	for (u32 c=0; c<clusters.size(); ++c)
+		clusters[c].Outwardness = (centroids[c] - meshCentroid).dotProduct(normals[c]);
+	std::stable_sort(clusters.pointer(), clusters.pointer() + clusters.size());
+
+	core::array<u16> output;
+	output.reallocate(triangleCount * 3, false);
+	for (u32 c=0; c<clusters.size(); ++c)
+	{
+		for (u32 i=clusters[c].Start*3; i<clusters[c].End*3; ++i)
+			output.push_back(indices[i]);
+	}
+	memcpy(indices, output.const_pointer(), triangleCount * 3 * sizeof(u16));
+}
+
+//! Moves the used vertices to the front, in the order of their first use or in their order,
+//! the unused ones are removed if the buffer supports it
+void compactVertices(IMeshBuffer* buffer, u16* indices, u32 indexCount, bool byFirstUse)
+{
+	const u32 vertexCount = buffer->getVertexCount();
+	const u32 pitch = video::getVertexPitchFromType(buffer->getVertexType());
+	const u32 unused = 0xffffffff;
+
+	core::array<u32> remap;
+	remap.set_used(vertexCount);
+	memset(remap.pointer(), 0xff, vertexCount * sizeof(u32));
+
+	u32 used = 0;
+	if (byFirstUse)
+	{
+		for (u32 i=0; i<indexCount; ++i)
+		{
+			if (remap[indices[i]] == unused)
+				remap[indices[i]] = used++;
+		}
+	}
+	else
+	{
+		for (u32 i=0; i<indexCount; ++i)
+			remap[indices[i]] = 0;
+		for (u32 v=0; v<vertexCount; ++v)
+		{
+			if (remap[v] != unused)
+				remap[v] = used++;
+		}
+	}
+
+	u32 next = used;
+	for (u32 v=0; v<vertexCount; ++v)
+	{
+		if (remap[v] == unused)
+			remap[v] = next++;
+	}
+
+	u8* vertices = (u8*)buffer->getVertices();
+	core::array<u8> copy;
+	copy.set_used(vertexCount * pitch);
+	memcpy(copy.pointer(), vertices, vertexCount * pitch);
+	for (u32 v=0; v<vertexCount; ++v)
+		memcpy(vertices + remap[v]*pitch, copy.const_pointer() + v*pitch, pitch);
+
+	for (u32 i=0; i<indexCount; ++i)
+		indices[i] = (u16)remap[indices[i]];
+
+	if (used < vertexCount && buffer->truncateVertices(used))
+		buffer->recalculateBoundingBox();
+}
+
+//! Error quadric of Garland and Heckbert, the summed squared distances to a set of planes
+struct SQuadric
+{
+	SQuadric() : A00(0), A01(0), A02(0), A11(0), A12(0), A22(0), B0(0), B1(0), B2(0), C(0) {}
+
+	//! Adds the plane through point with the unit normal, weighted
+	void addPlane(const core::vector3df& normal, const core::vector3df& point, f64 weight)
+	{
+		const f64 x = normal.X, y = normal.Y, z = normal.Z;
+		const f64 d = -(x*point.X + y*point.Y + z*point.Z);
+		A00 += weight*x*x; A01 += weight*x*y; A02 += weight*x*z;
+		A11 += weight*y*y; A12 += weight*y*z; A22 += weight*z*z;
+		B0 += weight*d*x; B1 += weight*d*y; B2 += weight*d*z;
+		C += weight*d*d;
+	}
+
+	void add(const SQuadric& q)
+	{
+		A00 += q.A00; A01 += q.A01; A02 += q.A02;
+		A11 += q.A11; A12 += q.A12; A22 += q.A22;
+		B0 += q.B0; B1 += q.B1; B2 += q.B2;
+		C += q.C;
+	}
+
+	f64 getError(const core::vector3df& p) const
+	{
+		const f64 x = p.X, y = p.Y, z = p.Z;
+		return A00*x*x + A11*y*y + A22*z*z + 2*(A01*x*y + A02*x*z + A12*y*z) +
+			2*(B0*x + B1*y + B2*z) + C;
+	}
+
+	f64 A00, A01, A02, A11, A12, A22, B0, B1, B2, C;
+};
+
+//! Orders vertices by their position, and equal ones by their index
+struct SPositionLess
+{
+	SPositionLess(const IMeshBuffer* buffer) : Buffer(buffer) {}
+
+	bool operator()(u32 a, u32 b) const
+	{
+		const core::vector3df& pa = Buffer->getPosition(a);
+		const core::vector3df& pb = Buffer->getPosition(b);
+		if (pa.X != pb.X)
+			return pa.X < pb.X;
+		if (pa.Y != pb.Y)
+			return pa.Y < pb.Y;
+		if (pa.Z != pb.Z)
+			return pa.Z < pb.Z;
+		return a < b;
+	}
+
+	const IMeshBuffer* Buffer;
+};
+
+struct SCollapse
+{
+	u32 From;
+	u32 To;
+	f64 Error;
+
+	bool operator<(const SCollapse& other) const
+	{
+		return Error < other.Error;
+	}
+};
+
+//! Collapses the vertices of a triangle list until it has at most targetIndexCount indices
+//! \return The new number of indices, the triangles are at the start of indices
+u32 simplifyTriangles(const IMeshBuffer* buffer, u16* indices, u32 indexCount, u32 targetIndexCount)
+{
+	const u32 vertexCount = buffer->getVertexCount();
+
+	// vertices at the same position are one corner of the surface with different
+	// attributes, position[v] is the first of them
+	core::array<u32> order;
+	order.set_used(vertexCount);
+	for (u32 i=0; i<vertexCount; ++i)
+		order[i] = i;
+	std::sort(order.pointer(), order.pointer() + vertexCount, SPositionLess(buffer));
+
+	core::array<u32> position;
+	core::array<u8> locked;
+	position.set_used(vertexCount);
+	locked.set_used(vertexCount);
+	memset(locked.pointer(), 0, vertexCount);
+	for (u32 i=0; i<vertexCount; ++i)
+	{
+		if (i > 0 && buffer->getPosition(order[i]) == buffer->getPosition(order[i-1]))
+		{
+			position[order[i]] = position[order[i-1]];
+			locked[position[order[i]]] = 1;
+		}
+		else
+			position[order[i]] = order[i];
+	}
+
+	// the planes of the triangles, weighted by their area
+	core::array<SQuadric> quadrics;
+	quadrics.set_used(vertexCount);
+	for (u32 i=0; i+2<indexCount; i+=3)
+	{
+		const core::vector3df& a = buffer->getPosition(indices[i]);
+		core::vector3df normal = (buffer->getPosition(indices[i+1]) - a).crossProduct(buffer->getPosition(indices[i+2]) - a);
+		const f32 length = normal.getLength();
+		if (length == 0.f)
+			continue;
+		normal /= length;
+		for (u32 k=0; k<3; ++k)
+			quadrics[position[indices[i+k]]].addPlane(normal, a, length * 0.5f);
+	}
+
+	// edges with other than two triangles are on the border of the surface
+	core::array<u64> edges;
+	edges.reallocate(indexCount, false);
+	for (u32 i=0; i+2<indexCount; i+=3)
+	{
+		for (u32 k=0; k<3; ++k)
+		{
+			const u32 a = position[indices[i+k]];
+			const u32 b = position[indices[i+(k+1)%3]];
+			edges.push_back(a < b ? ((u64)a << 32) | b : ((u64)b << 32) | a);
+		}
+	}
+	std::sort(edges.pointer(), edges.pointer() + edges.size());
+	for (u32 i=0; i<edges.size(); )
+	{
+		u32 end = i+1;
+		while (end < edges.size() && edges[end] == edges[i])
+			++end;
+		if (end - i != 2)
+		{
+			locked[(u32)(edges[i] >> 32)] = 1;
+			locked[(u32)edges[i]] = 1;
+		}
+		i = end;
+	}
+	for (u32 v=0; v<vertexCount; ++v)
+		locked[v] = locked[position[v]];
+
+	core::array<u32> triangleStart;
+	core::array<u32> vertexTriangles;
+	core::array<u32> remap;
+	core::array<u8> touched;
+	core::array<SCollapse> best;
+	core::array<SCollapse> collapses;
+	triangleStart.set_used(vertexCount + 1);
+	remap.set_used(vertexCount);
+	touched.set_used(vertexCount);
+	best.set_used(vertexCount);
+
+	while (indexCount > targetIndexCount)
+	{
+		// the triangles of vertex v are vertexTriangles[triangleStart[v]] to vertexTriangles[triangleStart[v+1]-1]
+		memset(triangleStart.pointer(), 0, (vertexCount + 1) * sizeof(u32));
+		for (u32 i=0; i<indexCount; ++i)
+			++triangleStart[indices[i] + 1];
+		for (u32 v=0; v<vertexCount; ++v)
+			triangleStart[v+1] += triangleStart[v];
+		vertexTriangles.set_used(indexCount);
+		for (u32 i=0; i<indexCount; ++i)
+			vertexTriangles[triangleStart[indices[i]]++] = i / 3;
+		for (u32 v=vertexCount; v>0; --v)
+			triangleStart[v] = triangleStart[v-1];
+		triangleStart[0] = 0;
+
+		// the cheapest collapse of each vertex along its edges
+		for (u32 v=0; v<vertexCount; ++v)
+			best[v].Error = -1.0;
+		for (u32 i=0; i<indexCount; ++i)
+		{
+			const u32 from = indices[i];
+			if (locked[from])
+				continue;
+
+			const u32 triangle = i - i%3;
+			for (u32 k=1; k<3; ++k)
+			{
+				const u32 to = indices[triangle + (i%3 + k)%3];
+				if (position[to] == from)
+					continue;
+
+				SQuadric quadric = quadrics[from];
+				quadric.add(quadrics[position[to]]);
+				const f64 error = quadric.getError(buffer->getPosition(to));
+				if (best[from].Error < 0.0 || error < best[from].Error)
+				{
+					best[from].From = from;
+					best[from].To = to;
+					best[from].Error = error;
+				}
+			}
+		}
+
+		collapses.set_used(0);
+		for (u32 v=0; v<vertexCount; ++v)
+		{
+			if (best[v].Error >= 0.0)
+				collapses.push_back(best[v]);
+		}
+		if (collapses.empty())
+			break;
+		std::sort(collapses.pointer(), collapses.pointer() + collapses.size());
+
+		for (u32 v=0; v<vertexCount; ++v)
+			remap[v] = v;
+		memset(touched.pointer(), 0, vertexCount);
+
+		// only the cheaper half is collapsed, the errors of the rest change meanwhile
+		u32 removed = 0;
+		const u32 collapseLimit = core::max_(collapses.size() / 2, 1u);
+		for (u32 c=0; c<collapseLimit && indexCount - removed*3 > targetIndexCount; ++c)
+		{
+			const u32 from = collapses[c].From;
+			const u32 to = collapses[c].To;
+			if (touched[from] || touched[to])
+				continue;
+
+			// collapses must not flip triangles around
+			const core::vector3df& target = buffer->getPosition(to);
+			bool flips = false;
+			u32 degenerated = 0;
+			for (u32 t=triangleStart[from]; t<triangleStart[from+1] && !flips; ++t)
+			{
+				const u16* tri = indices + vertexTriangles[t]*3;
+				if (position[tri[0]] == position[to] || position[tri[1]] == position[to] || position[tri[2]] == position[to])
+				{
+					++degenerated;
+					continue;
+				}
+
+				core::vector3df p[3];
+				for (u32 k=0; k<3; ++k)
+					p[k] = buffer->getPosition(tri[k]);
+				const core::vector3df before = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+				for (u32 k=0; k<3; ++k)
+				{
+					if (tri[k] == from)
+						p[k] = target;
+				}
+				const core::vector3df after = (p[1] - p[0]).crossProduct(p[2] - p[0]);
+				flips = after.dotProduct(before) <= 0.f;
+			}
+			if (flips)
+				continue;
+
+			remap[from] = to;
+			quadrics[position[to]].add(quadrics[from]);
+			removed += degenerated;
+
+			// the neighbours keep their triangles for the flip tests of this pass
+			for (u32 t=triangleStart[from]; t<triangleStart[from+1]; ++t)
+			{
+				const u16* tri = indices + vertexTriangles[t]*3;
+				touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+			}
+		}
+
+		if (removed == 0)
+			break;
+
+		// triangles with two corners at the same position are removed
+		u32 kept = 0;
+		for (u32 i=0; i<indexCount; i+=3)
+		{
+			const u16 a = (u16)remap[indices[i]];
+			const u16 b = (u16)remap[indices[i+1]];
+			const u16 c = (u16)remap[indices[i+2]];
+			if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c])
+				continue;
+			indices[kept++] = a;
+			indices[kept++] = b;
+			indices[kept++] = c;
+		}
+		indexCount = kept;
+	}
+
+	return indexCount;
+}
+
+//! Shrinks the indices of the buffers createMeshCopy() creates
+void setIndexCount(IMeshBuffer* buffer, u32 count)
+{
+	switch (buffer->getVertexType())
+	{
+	case video::EVT_2TCOORDS:
+		static_cast<SMeshBufferLightMap*>(buffer)->Indices.set_used(count);
+		break;
+	case video::EVT_TANGENTS:
+		static_cast<SMeshBufferTangents*>(buffer)->Indices.set_used(count);
+		break;
+	default:
+		static_cast<SMeshBuffer*>(buffer)->Indices.set_used(count);
+		break;
+	}
+}
+
+} // end anonymous namespace
+
+
+//! Reorders and welds the vertices and triangles of a mesh buffer for faster rendering.
+void CMeshManipulator::optimizeMeshBuffer(IMeshBuffer* buffer, u32 flags) const
+{
+	if (!buffer || buffer->getPrimitiveType() != EPT_TRIANGLES ||
+		buffer->getIndexType() != video::EIT_16BIT || buffer->getIndexCount() < 3)
+		return;
+
+	u16* indices = buffer->getIndices();
+	const u32 indexCount = buffer->getIndexCount();
+	const u32 vertexCount = buffer->getVertexCount();
+	for (u32 i=0; i<indexCount; ++i)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			os::Printer::log("Mesh buffer not optimized, it has invalid indices", ELL_WARNING);
+			return;
+		}
+	}
+
+	const bool welded = (flags & EMO_WELD_VERTICES) && weldVertices(buffer, indices, indexCount);
+
+	if (flags & EMO_VERTEX_CACHE)
+		optimizeVertexCache(indices, indexCount / 3, vertexCount);
+
+	if (flags & EMO_OVERDRAW)
+		optimizeOverdraw(indices, indexCount / 3, buffer);
+
+	if (welded || (flags & EMO_VERTEX_FETCH))
+		compactVertices(buffer, indices, indexCount, (flags & EMO_VERTEX_FETCH) != 0);
+
+	buffer->setDirty();
+}
+
+
+//! Reorders and welds the vertices and triangles of a mesh for faster rendering.
+void CMeshManipulator::optimizeMesh(scene::IMesh* mesh, u32 flags) const
+{
+	if (!mesh)
+		return;
+
+	// the weights of skinned meshes refer to the vertices, so only their triangles are reordered
+	const bool skinned = mesh->getMeshType() == EAMT_SKINNED;
+	if (skinned)
+		flags &= ~(EMO_WELD_VERTICES | EMO_VERTEX_FETCH);
+
+	core::aabbox3df box;
+	const u32 bcount = mesh->getMeshBufferCount();
+	for (u32 b=0; b<bcount; ++b)
+	{
+		IMeshBuffer* buffer = mesh->getMeshBuffer(b);
+		optimizeMeshBuffer(buffer, flags);
+
+		if (b == 0)
+			box.reset(buffer->getBoundingBox());
+		else
+			box.addInternalBox(buffer->getBoundingBox());
+	}
+
+	// removing unused vertices may have shrunk the boxes of the buffers
+	if (!skinned && bcount && (flags & (EMO_WELD_VERTICES | EMO_VERTEX_FETCH)))
+		mesh->setBoundingBox(box);
+}
+
+
+//! Creates a copy of a mesh with fewer triangles.
+SMesh* CMeshManipulator::createSimplifiedMesh(scene::IMesh* mesh, f32 ratio) const
+{
+	SMesh* clone = createMeshCopy(mesh);
+	if (!clone)
+		return 0;
+
+	ratio = core::clamp(ratio, 0.f, 1.f);
+	for (u32 b=0; b<clone->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* original = mesh->getMeshBuffer(b);
+		IMeshBuffer* buffer = clone->getMeshBuffer(b);
+		if (original->getPrimitiveType() != EPT_TRIANGLES || original->getIndexType() != video::EIT_16BIT)
+			continue;
+
+		u16* indices = buffer->getIndices();
+		const u32 indexCount = buffer->getIndexCount() - buffer->getIndexCount() % 3;
+		bool valid = true;
+		for (u32 i=0; i<indexCount && valid; ++i)
+			valid = indices[i] < buffer->getVertexCount();
+		if (!valid)
+			continue;
+
+		const u32 target = (u32)(indexCount / 3 * ratio) * 3;
+		setIndexCount(buffer, simplifyTriangles(buffer, indices, indexCount, target));
+
+		// the collapsed vertices are removed
+		optimizeMeshBuffer(buffer, EMO_VERTEX_CACHE | EMO_VERTEX_FETCH);
+	}
+
+	clone->recalculateBoundingBox();
+	return clone;
+}
+
+
+//! Creates meshes of decreasing detail for IMeshSceneNode::setLODMeshes().
+void CMeshManipulator::createLODChain(scene::IMesh* mesh, core::array<IMesh*>& lods, u32 levelCount, f32 reduction) const
+{
+	lods.clear();
+	if (!mesh)
+		return;
+
+	// every level is simplified from the full mesh, so the errors don't add up
+	f32 ratio = 1.f;
+	for (u32 i=0; i<levelCount; ++i)
+	{
+		ratio *= reduction;
+		lods.push_back(createSimplifiedMesh(mesh, ratio));
+	}
+}
+
+
 //! Clones a static IMesh into a modifyable SMesh.
 // not yet 32bit
 SMesh* CMeshManipulator::createMeshCopy(scene::IMesh* mesh) const
@@ -197,6 +1327,28 @@ SMesh* CMeshManipulator::createMeshCopy(scene::IMesh* mesh) const
 				buffer->drop();
 			}
 			break;
+		case video::EVT_SKINNED:
+			{
+				// the copy is static, so the joints are dropped
+				SMeshBuffer* buffer = new SMeshBuffer();
+				buffer->Material = mb->getMaterial();
+				const u32 vcount = mb->getVertexCount();
+				buffer->Vertices.reallocate(vcount);
+				video::S3DVertexSkinned* vertices = (video::S3DVertexSkinned*)mb->getVertices();
+				for (u32 i=0; i < vcount; ++i)
+					buffer->Vertices.push_back(vertices[i]);
+				const u32 icount = mb->getIndexCount();
+				buffer->Indices.reallocate(icount);
+				const u16* indices = mb->getIndices();
+				for (u32 i=0; i < icount; ++i)
+					buffer->Indices.push_back(indices[i]);
+				clone->addMeshBuffer(buffer);
+				buffer->drop();
+			}
+			break;
+		// compact vertices are only kept by the drivers
+		case video::EVT_COMPACT:
+			break;
 		}// end switch
 
 	}// end for all mesh buffers
@@ -206,6 +1358,143 @@ SMesh* CMeshManipulator::createMeshCopy(scene::IMesh* mesh) const
 }
 
 
+namespace
+{
+	//! Vertices a merged buffer can hold with 16 bit indices
+	const u32 MERGED_BUFFER_VERTICES = 65536;
+
+	void transformVertexNormals(video::S3DVertex& vertex, const core::matrix4& transform, const core::matrix4& normalTransform)
+	{
+		normalTransform.rotateVect(vertex.Normal);
+		vertex.Normal.normalize();
+	}
+
+	void transformVertexNormals(video::S3DVertexTangents& vertex, const core::matrix4& transform, const core::matrix4& normalTransform)
+	{
+		normalTransform.rotateVect(vertex.Normal);
+		vertex.Normal.normalize();
+		transform.rotateVect(vertex.Tangent);
+		vertex.Tangent.normalize();
+		transform.rotateVect(vertex.Binormal);
+		vertex.Binormal.normalize();
+	}
+
+	//! Appends the transformed triangles of a buffer to a merged buffer of its vertex type
+	template <class T>
+	void appendTransformed(CMeshBuffer<T>* target, const IMeshBuffer* source,
+		const core::matrix4& transform, const core::matrix4& normalTransform)
+	{
+		const u32 first = target->Vertices.size();
+		const u32 vertexCount = source->getVertexCount();
+		const T* vertices = static_cast<const T*>(source->getVertices());
+		target->Vertices.reallocate(first + vertexCount);
+		for (u32 i=0; i<vertexCount; ++i)
+		{
+			T vertex = vertices[i];
+			transform.transformVect(vertex.Pos);
+			transformVertexNormals(vertex, transform, normalTransform);
+			target->Vertices.push_back(vertex);
+		}
+
+		const u32 indexCount = source->getIndexCount();
+		target->Indices.reallocate(target->Indices.size() + indexCount);
+		if (source->getIndexType() == video::EIT_32BIT)
+		{
+			const u32* indices = reinterpret_cast<const u32*>(source->getIndices());
+			for (u32 i=0; i<indexCount; ++i)
+				target->Indices.push_back((u16)(first + indices[i]));
+		}
+		else
+		{
+			const u16* indices = source->getIndices();
+			for (u32 i=0; i<indexCount; ++i)
+				target->Indices.push_back((u16)(first + indices[i]));
+		}
+	}
+}
+
+
+//! Merges meshes into few large buffers, for drawing static geometry with few draw calls.
+SMesh* CMeshManipulator::createMergedMesh(const core::array<IMesh*>& meshes, const core::array<core::matrix4>& transforms,
+	const core::array<video::SMaterial>& materials) const
+{
+	SMesh* merged = new SMesh();
+
+	u32 materialIndex = 0;
+	for (u32 m=0; m<meshes.size(); ++m)
+	{
+		if (!meshes[m])
+			continue;
+
+		const core::matrix4& transform = transforms[m];
+		core::matrix4 normalTransform;
+		transform.getInverse(normalTransform);
+		normalTransform = normalTransform.getTransposed();
+
+		for (u32 b=0; b<meshes[m]->getMeshBufferCount(); ++b, ++materialIndex)
+		{
+			const IMeshBuffer* mb = meshes[m]->getMeshBuffer(b);
+			const video::E_VERTEX_TYPE vertexType = mb->getVertexType();
+			const u32 vertexCount = mb->getVertexCount();
+			if (mb->getPrimitiveType() != EPT_TRIANGLES || mb->isClientDataReleased() ||
+				vertexCount == 0 || vertexCount > MERGED_BUFFER_VERTICES ||
+				(vertexType != video::EVT_STANDARD && vertexType != video::EVT_2TCOORDS && vertexType != video::EVT_TANGENTS))
+				continue;
+
+			const video::SMaterial& material = materialIndex < materials.size() ? materials[materialIndex] : mb->getMaterial();
+
+			// the last buffer with room of this material and vertex type
+			IMeshBuffer* target = 0;
+			for (u32 t=merged->getMeshBufferCount(); t>0 && !target; --t)
+			{
+				IMeshBuffer* candidate = merged->getMeshBuffer(t-1);
+				if (candidate->getVertexType() == vertexType && candidate->getMaterial() == material &&
+					candidate->getVertexCount() + vertexCount <= MERGED_BUFFER_VERTICES)
+					target = candidate;
+			}
+
+			if (!target)
+			{
+				switch (vertexType)
+				{
+				case video::EVT_2TCOORDS:
+					target = new SMeshBufferLightMap();
+					break;
+				case video::EVT_TANGENTS:
+					target = new SMeshBufferTangents();
+					break;
+				default:
+					target = new SMeshBuffer();
+					break;
+				}
+				target->getMaterial() = material;
+				merged->addMeshBuffer(target);
+				target->drop();
+			}
+
+			switch (vertexType)
+			{
+			case video::EVT_2TCOORDS:
+				appendTransformed(static_cast<SMeshBufferLightMap*>(target), mb, transform, normalTransform);
+				break;
+			case video::EVT_TANGENTS:
+				appendTransformed(static_cast<SMeshBufferTangents*>(target), mb, transform, normalTransform);
+				break;
+			default:
+				appendTransformed(static_cast<SMeshBuffer*>(target), mb, transform, normalTransform);
+				break;
+			}
+		}
+	}
+
+	for (u32 i=0; i<merged->getMeshBufferCount(); ++i)
+		merged->getMeshBuffer(i)->recalculateBoundingBox();
+	merged->recalculateBoundingBox();
+
+	return merged;
+}
+
+
 //! Returns amount of polygons in mesh.
 s32 CMeshManipulator::getPolyCount(scene::IMesh* mesh) const
 {
@@ -6,6 +6,7 @@
 #define __C_MESH_MANIPULATOR_H_INCLUDED__
 
 #include "IMeshManipulator.h"
+#include <mutex>
 
 namespace irr
 {
@@ -17,9 +18,17 @@ namespace scene
 problems with wrong imported or exported meshes quickly after loading. It is
 not intended for doing mesh modifications and/or animations during runtime.
 */
+class CJobSystem;
+
 class CMeshManipulator : public IMeshManipulator
 {
 public:
+	//! Constructor
+	CMeshManipulator();
+
+	//! Destructor
+	~CMeshManipulator();
+
 	//! Recalculates all normals of the mesh.
 	/** \param mesh: Mesh on which the operation is performed.
 	\param smooth: Whether to use smoothed normals. */
@@ -33,6 +42,22 @@ public:
 	//! Clones a static IMesh into a modifiable SMesh.
 	SMesh* createMeshCopy(scene::IMesh* mesh) const override;
 
+	//! Merges meshes into few large buffers, for drawing static geometry with few draw calls.
+	SMesh* createMergedMesh(const core::array<IMesh*>& meshes, const core::array<core::matrix4>& transforms,
+		const core::array<video::SMaterial>& materials=core::array<video::SMaterial>()) const override;
+
+	//! Reorders and welds the vertices and triangles of a mesh for faster rendering.
+	void optimizeMesh(scene::IMesh* mesh, u32 flags=EMO_ALL) const override;
+
+	//! Reorders and welds the vertices and triangles of a mesh buffer for faster rendering.
+	void optimizeMeshBuffer(IMeshBuffer* buffer, u32 flags=EMO_ALL) const override;
+
+	//! Creates a copy of a mesh with fewer triangles.
+	SMesh* createSimplifiedMesh(scene::IMesh* mesh, f32 ratio) const override;
+
+	//! Creates meshes of decreasing detail for IMeshSceneNode::setLODMeshes().
+	void createLODChain(scene::IMesh* mesh, core::array<IMesh*>& lods, u32 levelCount, f32 reduction=0.5f) const override;
+
 	//! Returns amount of polygons in mesh.
 	s32 getPolyCount(scene::IMesh* mesh) const override;
 
@@ -41,6 +66,12 @@ public:
 
 	//! create a new AnimatedMesh and adds the mesh to it
 	IAnimatedMesh * createAnimatedMesh(scene::IMesh* mesh,scene::E_ANIMATED_MESH_TYPE type) const override;
+
+private:
+
+	//! Threads recalculateNormals() spreads the buffers of large meshes over, created on first use
+	mutable CJobSystem* Jobs;
+	mutable std::mutex JobsMutex;
 };
 
 } // end namespace scene
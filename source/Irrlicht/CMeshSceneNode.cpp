@@ -11,6 +11,7 @@
 #include "IAnimatedMesh.h"
 #include "IMaterialRenderer.h"
 #include "IFileSystem.h"
+#include "os.h"
 
 namespace irr
 {
@@ -24,7 +25,8 @@ CMeshSceneNode::CMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* m
 			const core::vector3df& position, const core::vector3df& rotation,
 			const core::vector3df& scale)
 : IMeshSceneNode(parent, mgr, id, position, rotation, scale), Mesh(0),
-	PassCount(0), ReadOnlyMaterials(false)
+	LODHysteresis(0.1f), CurrentLOD(0), ImpostorViews(0), ImpostorDistance(0.f),
+	ImpostorVisible(false), OccluderMesh(0), PassCount(0), ReadOnlyMaterials(false)
 {
 	#ifdef _DEBUG
 	setDebugName("CMeshSceneNode");
@@ -37,6 +39,9 @@ CMeshSceneNode::CMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* m
 //! destructor
 CMeshSceneNode::~CMeshSceneNode()
 {
+	setLODMeshes(core::array<IMesh*>(), core::array<f32>());
+	setOccluderMesh(0);
+
 	if (Mesh)
 		Mesh->drop();
 }
@@ -58,6 +63,40 @@ void CMeshSceneNode::OnRegisterSceneNode()
 		int transparentCount = 0;
 		int solidCount = 0;
 
+		// casters are registered even when culled, their shadows may still be visible
+		SceneManager->registerNodeForRendering(this, scene::ESNRP_SHADOW);
+
+		// without debug data, the buffers are sorted by the scene manager
+		// one by one instead of drawing them all in render()
+		if (!DebugDataVisible)
+		{
+			Box = Mesh->getBoundingBox();
+			ImpostorVisible = false;
+
+			if (!SceneManager->isCulled(this) && !registerImpostor(SceneManager->getActiveCamera()))
+			{
+				updateLOD();
+				const IMesh* mesh = getLODMesh();
+				const u32 count = mesh->getMeshBufferCount();
+				for (u32 i=0; i<count; ++i)
+				{
+					scene::IMeshBuffer* mb = mesh->getMeshBuffer(i);
+					if (!mb)
+						continue;
+
+					const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
+					SceneManager->registerMeshBufferForRendering(this, mb, material,
+						driver->needsTransparentRenderPass(material) ? scene::ESNRP_TRANSPARENT : scene::ESNRP_SOLID);
+				}
+			}
+
+			ISceneNode::OnRegisterSceneNode();
+			return;
+		}
+
+		ImpostorVisible = false;
+		updateLOD();
+
 		// count transparent and solid materials in this scene node
 		const u32 numMaterials = ReadOnlyMaterials ? Mesh->getMeshBufferCount() : Materials.size();
 		for (u32 i=0; i<numMaterials; ++i)
@@ -94,10 +133,13 @@ void CMeshSceneNode::render()
 	if (!Mesh || !driver)
 		return;
 
-	const bool isTransparentPass =
-		SceneManager->getSceneNodeRenderPass() == scene::ESNRP_TRANSPARENT;
+	const E_SCENE_NODE_RENDER_PASS pass = SceneManager->getSceneNodeRenderPass();
+	const bool isTransparentPass = pass == scene::ESNRP_TRANSPARENT;
 
-	++PassCount;
+	// the depth pre-pass and the shadow maps draw the solid buffers once more,
+	// without debug data
+	if (pass != scene::ESNRP_DEPTH_PREPASS && pass != scene::ESNRP_SHADOW)
+		++PassCount;
 
 	driver->setTransform(video::ETS_WORLD, AbsoluteTransformation);
 	Box = Mesh->getBoundingBox();
@@ -125,9 +167,10 @@ void CMeshSceneNode::render()
 	// render original meshes
 	if (renderMeshes)
 	{
-		for (u32 i=0; i<Mesh->getMeshBufferCount(); ++i)
+		const IMesh* mesh = getLODMesh();
+		for (u32 i=0; i<mesh->getMeshBufferCount(); ++i)
 		{
-			scene::IMeshBuffer* mb = Mesh->getMeshBuffer(i);
+			scene::IMeshBuffer* mb = mesh->getMeshBuffer(i);
 			if (mb)
 			{
 				const video::SMaterial& material = ReadOnlyMaterials ? mb->getMaterial() : Materials[i];
@@ -251,7 +294,9 @@ void CMeshSceneNode::setMesh(IMesh* mesh)
 			Mesh->drop();
 
 		Mesh = mesh;
+		setLODMeshes(core::array<IMesh*>(), core::array<f32>());
 		copyMaterials();
+		updateSpatialIndex();
 	}
 }
 
@@ -276,6 +321,148 @@ void CMeshSceneNode::copyMaterials()
 }
 
 
+//! Sets meshes of less detail, drawn when the node gets small on screen
+void CMeshSceneNode::setLODMeshes(const core::array<IMesh*>& meshes,
+	const core::array<f32>& screenSizes, f32 hysteresis)
+{
+	if (meshes.size() != screenSizes.size())
+	{
+		os::Printer::log("Need a screen size for each level of detail", ELL_WARNING);
+		return;
+	}
+	for (u32 i=0; i<meshes.size(); ++i)
+	{
+		if (!meshes[i] || !Mesh || meshes[i]->getMeshBufferCount() != Mesh->getMeshBufferCount())
+		{
+			os::Printer::log("Levels of detail need as many mesh buffers as the mesh", ELL_WARNING);
+			return;
+		}
+	}
+
+	for (u32 i=0; i<meshes.size(); ++i)
+		meshes[i]->grab();
+	for (u32 i=0; i<LODMeshes.size(); ++i)
+		LODMeshes[i]->drop();
+
+	LODMeshes = meshes;
+	LODScreenSizes = screenSizes;
+	LODHysteresis = hysteresis;
+	CurrentLOD = 0;
+}
+
+
+//! Set a quad with a prerendered view of the mesh, drawn instead of it when far away
+void CMeshSceneNode::setImpostor(video::ITexture* texture, u32 views, f32 distance)
+{
+	ImpostorMaterial = video::SMaterial();
+	ImpostorMaterial.MaterialType = video::EMT_TRANSPARENT_ALPHA_CHANNEL_REF;
+	ImpostorMaterial.MaterialTypeParam = 0.5f;
+	ImpostorMaterial.Lighting = false;
+	ImpostorMaterial.setTexture(0, texture);
+	ImpostorMaterial.TextureLayer[0].TextureWrapU = video::ETC_CLAMP_TO_EDGE;
+	ImpostorMaterial.TextureLayer[0].TextureWrapV = video::ETC_CLAMP_TO_EDGE;
+	ImpostorViews = texture ? views : 0;
+	ImpostorDistance = distance;
+}
+
+
+//! Sets a simplified mesh used when the node is an occluder
+void CMeshSceneNode::setOccluderMesh(IMesh* mesh)
+{
+	if (mesh)
+		mesh->grab();
+	if (OccluderMesh)
+		OccluderMesh->drop();
+
+	OccluderMesh = mesh;
+}
+
+
+//! registers the impostor quad if the camera is far enough away
+bool CMeshSceneNode::registerImpostor(const ICameraSceneNode* camera)
+{
+	if (!ImpostorViews || !camera)
+		return false;
+
+	// same bounding sphere as in CSceneManager::createImpostorTexture
+	const core::aabbox3df& box = Mesh->getBoundingBox();
+	const f32 radius = box.getExtent().getLength() * 0.5f;
+	core::vector3df center = box.getCenter();
+	AbsoluteTransformation.transformVect(center);
+
+	core::vector3df toCamera = camera->getAbsolutePosition() - center;
+	if (toCamera.getLengthSQ() <= ImpostorDistance * ImpostorDistance)
+		return false;
+
+	// the view closest to the direction of the camera around the Y axis of the mesh
+	core::matrix4 inverse;
+	AbsoluteTransformation.getInverse(inverse);
+	core::vector3df direction;
+	inverse.rotateVect(direction, toCamera);
+	const f32 step = 2.f * core::PI / ImpostorViews;
+	s32 view = core::round32(atan2f(direction.X, -direction.Z) / step);
+	if (view < 0)
+		view += ImpostorViews;
+	view %= ImpostorViews;
+
+	const u32 columns = (u32)ceilf(sqrtf((f32)ImpostorViews));
+	const u32 rows = (ImpostorViews + columns - 1) / columns;
+	const f32 u0 = (f32)(view % columns) / columns;
+	const f32 v0 = (f32)(view / columns) / rows;
+	const f32 u1 = u0 + 1.f / columns;
+	const f32 v1 = v0 + 1.f / rows;
+
+	core::vector3df up(0.f, radius, 0.f);
+	AbsoluteTransformation.rotateVect(up);
+	toCamera.normalize();
+	core::vector3df right = toCamera.crossProduct(up);
+	right.setLength(radius * AbsoluteTransformation.getScale().X);
+
+	/* Vertices are like those of billboards:
+	2--1
+	|\ |
+	| \|
+	3--0
+	*/
+	video::S3DVertex vertices[4];
+	vertices[0] = video::S3DVertex(center + right - up, toCamera, video::SColor(0xffffffff), core::vector2df(u1, v1));
+	vertices[1] = video::S3DVertex(center + right + up, toCamera, video::SColor(0xffffffff), core::vector2df(u1, v0));
+	vertices[2] = video::S3DVertex(center - right + up, toCamera, video::SColor(0xffffffff), core::vector2df(u0, v0));
+	vertices[3] = video::S3DVertex(center - right - up, toCamera, video::SColor(0xffffffff), core::vector2df(u0, v1));
+	SceneManager->registerBillboardForRendering(ImpostorMaterial, vertices);
+
+	ImpostorVisible = true;
+	return true;
+}
+
+
+//! chooses CurrentLOD by the size of the node on screen
+void CMeshSceneNode::updateLOD()
+{
+	const ICameraSceneNode* camera = SceneManager->getActiveCamera();
+	if (LODMeshes.empty() || !camera)
+		return;
+
+	core::aabbox3df box = Mesh->getBoundingBox();
+	AbsoluteTransformation.transformBoxEx(box);
+	const f32 radius = box.getExtent().getLength() * 0.5f;
+
+	// the projection scales y by the cotangent of half the field of view,
+	// or by 2 / height for orthogonal cameras
+	f32 size = radius * camera->getProjectionMatrix()[5];
+	if (!camera->isOrthogonal())
+	{
+		const f32 distance = camera->getAbsolutePosition().getDistanceFrom(box.getCenter());
+		size = distance > radius ? size / distance : FLT_MAX;
+	}
+
+	while (CurrentLOD < LODMeshes.size() && size < LODScreenSizes[CurrentLOD] * (1.f - LODHysteresis))
+		++CurrentLOD;
+	while (CurrentLOD > 0 && size > LODScreenSizes[CurrentLOD-1] * (1.f + LODHysteresis))
+		--CurrentLOD;
+}
+
+
 //! Sets if the scene node should not copy the materials of the mesh but use them in a read only style.
 /* In this way it is possible to change the materials a mesh causing all mesh scene nodes
 referencing this mesh to change too. */
@@ -306,6 +493,11 @@ ISceneNode* CMeshSceneNode::clone(ISceneNode* newParent, ISceneManager* newManag
 	nb->cloneMembers(this, newManager);
 	nb->ReadOnlyMaterials = ReadOnlyMaterials;
 	nb->Materials = Materials;
+	nb->setLODMeshes(LODMeshes, LODScreenSizes, LODHysteresis);
+	nb->ImpostorMaterial = ImpostorMaterial;
+	nb->ImpostorViews = ImpostorViews;
+	nb->ImpostorDistance = ImpostorDistance;
+	nb->setOccluderMesh(OccluderMesh);
 
 	if (newParent)
 		nb->drop();
@@ -7,16 +7,22 @@
 
 #include "IMeshSceneNode.h"
 #include "IMesh.h"
+#include "CSceneNodePool.h"
 
 namespace irr
 {
 namespace scene
 {
+	class ICameraSceneNode;
 
-	class CMeshSceneNode : public IMeshSceneNode
+	class CMeshSceneNode : public IMeshSceneNode, public CSceneNodePoolAllocated<CMeshSceneNode>
 	{
 	public:
 
+		//! the pool takes precedence over the operators of ISceneNode
+		using CSceneNodePoolAllocated<CMeshSceneNode>::operator new;
+		using CSceneNodePoolAllocated<CMeshSceneNode>::operator delete;
+
 		//! constructor
 		CMeshSceneNode(IMesh* mesh, ISceneNode* parent, ISceneManager* mgr,	s32 id,
 			const core::vector3df& position = core::vector3df(0,0,0),
@@ -62,6 +68,25 @@ namespace scene
 		//! Returns if the scene node should not copy the materials of the mesh but use them in a read only style
 		bool isReadOnlyMaterials() const override;
 
+		//! Sets meshes of less detail, drawn when the node gets small on screen
+		void setLODMeshes(const core::array<IMesh*>& meshes,
+			const core::array<f32>& screenSizes, f32 hysteresis=0.1f) override;
+
+		//! Get the level of detail chosen in the last frame
+		u32 getCurrentLOD() const override { return CurrentLOD; }
+
+		//! Set a quad with a prerendered view of the mesh, drawn instead of it when far away
+		void setImpostor(video::ITexture* texture, u32 views, f32 distance) override;
+
+		//! Check if the quad was drawn instead of the mesh in the last frame
+		bool isImpostorVisible() const override { return ImpostorVisible; }
+
+		//! Sets a simplified mesh used when the node is an occluder
+		void setOccluderMesh(IMesh* mesh) override;
+
+		//! Get the mesh rasterized when the node is an occluder
+		const IMesh* getOccluderMesh() const override { return OccluderMesh ? OccluderMesh : Mesh; }
+
 		//! Creates a clone of this scene node and its children.
 		ISceneNode* clone(ISceneNode* newParent=0, ISceneManager* newManager=0) override;
 
@@ -74,12 +99,33 @@ namespace scene
 
 		void copyMaterials();
 
+		//! chooses CurrentLOD by the size of the node on screen
+		void updateLOD();
+
+		//! the mesh of CurrentLOD
+		IMesh* getLODMesh() const { return CurrentLOD ? LODMeshes[CurrentLOD-1] : Mesh; }
+
+		//! registers the impostor quad if the camera is far enough away
+		bool registerImpostor(const ICameraSceneNode* camera);
+
 		core::array<video::SMaterial> Materials;
 		core::aabbox3d<f32> Box;
 		video::SMaterial ReadOnlyMaterial;
 
 		IMesh* Mesh;
 
+		core::array<IMesh*> LODMeshes;
+		core::array<f32> LODScreenSizes;
+		f32 LODHysteresis;
+		u32 CurrentLOD;
+
+		video::SMaterial ImpostorMaterial;
+		u32 ImpostorViews;
+		f32 ImpostorDistance;
+		bool ImpostorVisible;
+
+		IMesh* OccluderMesh;
+
 		s32 PassCount;
 		bool ReadOnlyMaterials;
 	};
@@ -3,7 +3,10 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CNullDriver.h"
+#include "CRecordingNullDriver.h"
+#include "CFrameReplay.h"
 #include "os.h"
+#include "CProfiler.h"
 #include "CImage.h"
 #include "CAttributes.h"
 #include "IReadFile.h"
@@ -14,8 +17,16 @@
 #include "IAnimatedMeshSceneNode.h"
 #include "CMeshManipulator.h"
 #include "CColorConverter.h"
+#include "CJobSystem.h"
+#include "CMemoryFile.h"
+#include "CScreenShotRequest.h"
 #include "IReferenceCounted.h"
 #include "IRenderTarget.h"
+#include "S3DInstance.h"
+#include "CPostProcessChain.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
 
 
 namespace irr
@@ -35,18 +46,248 @@ IImageLoader* createImageLoaderTGA();
 //! creates a loader which is able to load png images
 IImageLoader* createImageLoaderPNG();
 
+//! creates a loader which is able to load dds images
+IImageLoader* createImageLoaderDDS();
+
+//! creates a loader which is able to load ktx2 images
+IImageLoader* createImageLoaderKTX(IVideoDriver* driver);
+
 //! creates a writer which is able to save jpg images
 IImageWriter* createImageWriterJPG();
 
 //! creates a writer which is able to save png images
 IImageWriter* createImageWriterPNG();
 
+namespace
+{
+
+//! Marks a texture found in the cache, textures of getTextureAsync() still loading keep their source
+void updateCachedSource(ITexture* texture)
+{
+	if (texture->getSource() != ETS_LOADING)
+		texture->updateSource(ETS_FROM_CACHE);
+}
+
+//! Decodes the image of a texture straight into ECF_A8R8G8B8, which the drivers expand 24 bit images to anyway
+/** Loaders able to decode at reduced sizes use the smallest one which still
+covers the size the texture gets with maxSize, the largest texture size.
+\return The image, or 0 if the loader doesn't support loadImageInto() for the file. */
+IImage* decodeTextureImage(IImageLoader* loader, io::IReadFile* file, const core::dimension2du& maxSize)
+{
+	core::dimension2du size;
+	ECOLOR_FORMAT format;
+	if (!loader->getImageInfo(file, size, format) || (format != ECF_R8G8B8 && format != ECF_A8R8G8B8))
+		return 0;
+
+	u32 scaleDenominator = 1;
+	for (u32 d = 2; d <= 8; d *= 2)
+	{
+		if ((size.Width + d - 1) / d < core::min_(size.Width, maxSize.Width) ||
+			(size.Height + d - 1) / d < core::min_(size.Height, maxSize.Height))
+			break;
+		scaleDenominator = d;
+	}
+
+	if (scaleDenominator > 1)
+	{
+		file->seek(0);
+		if (!loader->getImageInfo(file, size, format, scaleDenominator))
+			return 0;
+	}
+
+	IImage* image = new CImage(ECF_A8R8G8B8, size);
+	file->seek(0);
+	if (!loader->loadImageInto(file, image->getData(), image->getPitch(), ECF_A8R8G8B8, scaleDenominator))
+	{
+		image->drop();
+		return 0;
+	}
+
+	return image;
+}
+
+//! Loads the images of a file with the last loader taking it
+/** \param maxTextureSize Set when loading textures, see decodeTextureImage(). */
+core::array<IImage*> loadImages(const core::array<IImageLoader*>& loaders, io::IReadFile* file, E_TEXTURE_TYPE* type,
+	const core::dimension2du* maxTextureSize = 0)
+{
+	// TO-DO -> use 'move' feature from C++11 standard.
+
+	core::array<IImage*> imageArray;
+
+	if (file)
+	{
+		s32 i;
+
+		// try to load file based on file extension
+		for (i = loaders.size() - 1; i >= 0; --i)
+		{
+			if (loaders[i]->isALoadableFileExtension(file->getFileName()))
+			{
+				// reset file position which might have changed due to previous loadImage calls
+				file->seek(0);
+				IImage* decoded = maxTextureSize ? decodeTextureImage(loaders[i], file, *maxTextureSize) : 0;
+				if (decoded)
+				{
+					imageArray.push_back(decoded);
+					return imageArray;
+				}
+
+				file->seek(0);
+				imageArray = loaders[i]->loadImages(file, type);
+
+				if (imageArray.size() == 0)
+				{
+					file->seek(0);
+					IImage* image = loaders[i]->loadImage(file);
+
+					if (image)
+						imageArray.push_back(image);
+				}
+
+				if (imageArray.size() > 0)
+					return imageArray;
+			}
+		}
+
+		// try to load file based on what is in it
+		for (i = loaders.size() - 1; i >= 0; --i)
+		{
+			// dito
+			file->seek(0);
+			if (loaders[i]->isALoadableFileFormat(file)
+				&& !loaders[i]->isALoadableFileExtension(file->getFileName())	// extension was tried above already
+				)
+			{
+				file->seek(0);
+				IImage* decoded = maxTextureSize ? decodeTextureImage(loaders[i], file, *maxTextureSize) : 0;
+				if (decoded)
+				{
+					imageArray.push_back(decoded);
+					return imageArray;
+				}
+
+				file->seek(0);
+				imageArray = loaders[i]->loadImages(file, type);
+
+				if (imageArray.size() == 0)
+				{
+					file->seek(0);
+					IImage* image = loaders[i]->loadImage(file);
+
+					if (image)
+						imageArray.push_back(image);
+				}
+
+				if (imageArray.size() > 0)
+					return imageArray;
+			}
+		}
+	}
+
+	return imageArray;
+}
+
+//! Decodes one file of CNullDriver::createImagesFromFiles()
+struct SImageDecodeJob
+{
+	const core::array<IImageLoader*>* Loaders;
+	io::IReadFile* File;
+	IImage* Image;
+};
+
+//! CJobSystem job loading the image of an SImageDecodeJob, the loaders don't share any state
+void decodeImageJob(void* data)
+{
+	SImageDecodeJob* job = (SImageDecodeJob*)data;
+	E_TEXTURE_TYPE type = ETT_2D;
+	core::array<IImage*> images = loadImages(*job->Loaders, job->File, &type);
+
+	for (u32 i = 1; i < images.size(); ++i)
+	{
+		if (images[i])
+			images[i]->drop();
+	}
+	job->Image = images.size() ? images[0] : 0;
+}
+
+//! Creates the missing mipmaps of loaded images, see ETCF_CREATE_MIP_MAPS_ON_CPU
+void createMipMaps(const core::array<IImage*>& images, u32 flags)
+{
+	for (u32 i = 0; i < images.size(); ++i)
+	{
+		if (images[i] && !images[i]->getMipMapsData())
+			images[i]->createMipMaps(flags);
+	}
+}
+
+//! Gets the modification time and size of a file on disk, both are 0 for files in archives
+void getFileStatus(const io::path& fileName, u64& modificationTime, u64& size)
+{
+	modificationTime = 0;
+	size = 0;
+#if defined(_IRR_WINDOWS_API_)
+	struct _stat64 buf;
+#if defined(_IRR_WCHAR_FILESYSTEM)
+	if (_wstat64(fileName.c_str(), &buf) == 0)
+#else
+	if (_stat64(fileName.c_str(), &buf) == 0)
+#endif
+#else
+	struct stat buf;
+	if (stat(fileName.c_str(), &buf) == 0)
+#endif
+	{
+		modificationTime = (u64)buf.st_mtime;
+		size = (u64)buf.st_size;
+	}
+}
+
+//! Inserts defines into a shader behind its #version line, which has to stay the first one
+void insertShaderDefines(core::stringc& source, const c8* defines)
+{
+	u32 start = 0;
+	while (start < source.size() && core::isspace(source[start]))
+		++start;
+
+	u32 pos = 0;
+	if (strncmp(source.c_str() + start, "#version", 8) == 0)
+	{
+		const s32 lineEnd = source.findNext('\n', start);
+		pos = lineEnd < 0 ? source.size() : (u32)lineEnd + 1;
+	}
+
+	core::stringc result = source.subString(0, pos);
+	if (pos == source.size() && pos && source[pos - 1] != '\n')
+		result.append('\n');
+	result.append(defines);
+	if (result.size() && result[result.size() - 1] != '\n')
+		result.append('\n');
+	result.append(source.subString(pos, source.size() - pos));
+	source = result;
+}
+
+//! Continues an FNV-1a hash with some bytes
+u64 hashShaderPermutation(u64 hash, const void* data, size_t size)
+{
+	const u8* bytes = (const u8*)data;
+	for (size_t i = 0; i < size; ++i)
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	return hash;
+}
+
+} // end anonymous namespace
+
 
 //! constructor
 CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
-	: SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
-	ViewPort(0, 0, 0, 0), ScreenSize(screenSize), PrimitivesDrawn(0), MinVertexCountForVBO(500),
-	TextureCreationFlags(0), OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false)
+	: ImageWriteQuit(false), RenderFrameSubmitted(false), RenderThreadQuit(false),
+	SubmittedFrames(0), ResizeQueued(false), SharedRenderTarget(0), CurrentRenderTarget(0), CurrentRenderTargetSize(0, 0), FileSystem(io), MeshManipulator(0),
+	ViewPort(0, 0, 0, 0), ScreenSize(screenSize), PrimitivesDrawn(0), MinVertexCountForVBO(500), HWBufferDeletionBudget(64),
+	TextureCreationFlags(0), OverrideMaterial2DEnabled(false), AllowZWriteOnTransparent(false), ReverseDepth(false), RenderTargetMultisampled(false), FrameCount(0),
+	FrameBeginNs(0), LastFrameEndNs(0),
+	FrameDamageSet(false), DamageRegionActive(false), DamageHistoryCount(0),
+	TextureImagesDisposable(false), BlockOnOcclusionQueries(true)
 {
 	#ifdef _DEBUG
 	setDebugName("CNullDriver");
@@ -87,6 +328,8 @@ CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& scre
 	SurfaceLoader.push_back(video::createImageLoaderPNG());
 	SurfaceLoader.push_back(video::createImageLoaderJPG());
 	SurfaceLoader.push_back(video::createImageLoaderBMP());
+	SurfaceLoader.push_back(video::createImageLoaderDDS());
+	SurfaceLoader.push_back(video::createImageLoaderKTX(this));
 
 	SurfaceWriter.push_back(video::createImageWriterJPG());
 	SurfaceWriter.push_back(video::createImageWriterPNG());
@@ -116,9 +359,15 @@ CNullDriver::CNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& scre
 //! destructor
 CNullDriver::~CNullDriver()
 {
+	setRenderThreadEnabled(false);
+
 	if (DriverAttributes)
 		DriverAttributes->drop();
 
+	// the loads use the file system
+	cancelTextureLoads();
+	finishImageWrites();
+
 	if (FileSystem)
 		FileSystem->drop();
 
@@ -201,6 +450,8 @@ IImageWriter* CNullDriver::getImageWriter(u32 n)
 //! deletes all textures
 void CNullDriver::deleteAllTextures()
 {
+	cancelTextureLoads();
+
 	// we need to remove previously set textures which might otherwise be kept in the
 	// last set material member. Could be optimized to reduce state changes.
 	setMaterial(SMaterial());
@@ -210,27 +461,299 @@ void CNullDriver::deleteAllTextures()
 	for (u32 i=0; i<RenderTargets.size(); ++i)
 		RenderTargets[i]->setTexture(0, 0);
 
+	// the pooled targets are useless without their textures
+	for (u32 i=0; i<TransientTargets.size(); ++i)
+		removeRenderTarget(TransientTargets[i].Target);
+	TransientTargets.clear();
+
 	// remove textures.
 
 	for (u32 i=0; i<Textures.size(); ++i)
 		Textures[i].Surface->drop();
 
 	Textures.clear();
+	TextureIndex.clear();
 
 	SharedDepthTextures.clear();
+	TransientTextures.clear();
 }
 
 bool CNullDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil, const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
 {
 	PrimitivesDrawn = 0;
+	FrameStats.reset();
+	if (FPSCounter.isFrameTimeHistoryEnabled())
+		FrameBeginNs = os::Timer::getRealTimeNs();
 	return true;
 }
 
 bool CNullDriver::endScene()
 {
 	FPSCounter.registerFrame(os::Timer::getRealTime(), PrimitivesDrawn);
+	if (FPSCounter.isFrameTimeHistoryEnabled())
+	{
+		const u64 now = os::Timer::getRealTimeNs();
+		FPSCounter.registerFrameTimes(FrameCount,
+			LastFrameEndNs ? (f32)((now - LastFrameEndNs) / 1000000.0) : -1.f,
+			FrameBeginNs ? (f32)((now - FrameBeginNs) / 1000000.0) : -1.f);
+		LastFrameEndNs = now;
+		FrameBeginNs = 0;
+	}
 	updateAllHardwareBuffers();
-	updateAllOcclusionQueries();
+	updateTextureLoads();
+	updateImageWrites();
+	updateAllOcclusionQueries(BlockOnOcclusionQueries);
+
+	// sizes change with dynamic resolution, don't keep the old ones forever
+	for (s32 i = (s32)TransientTargets.size() - 1; i >= 0; --i)
+	{
+		if (!TransientTargets[i].InUse && FrameCount - TransientTargets[i].ReleaseFrame > 120)
+			removeTransientTarget(i);
+	}
+
+	++FrameCount;
+	return true;
+}
+
+
+//! Sets how many vertical blanks the presentation of endScene() waits for
+bool CNullDriver::setSwapInterval(s32 interval)
+{
+	return false;
+}
+
+
+//! Tells the driver which part of the screen the next frame changes
+void CNullDriver::setFrameDamage(const core::rect<s32>& rect)
+{
+	FrameDamage = rect;
+	FrameDamage.repair();
+	FrameDamage.clipAgainst(core::rect<s32>(0, 0, ScreenSize.Width, ScreenSize.Height));
+	FrameDamageSet = true;
+}
+
+
+namespace
+{
+	//! grows rect to contain other, empty rectangles are ignored
+	void addDamage(core::rect<s32>& rect, const core::rect<s32>& other)
+	{
+		if (other.getArea() <= 0)
+			return;
+
+		if (rect.getArea() <= 0)
+		{
+			rect = other;
+			return;
+		}
+
+		rect.addInternalPoint(other.UpperLeftCorner);
+		rect.addInternalPoint(other.LowerRightCorner);
+	}
+}
+
+
+//! Sets DamageRegion for a frame drawn into a back buffer of the given age
+bool CNullDriver::beginFrameDamage(s32 bufferAge)
+{
+	DamageRegionActive = false;
+
+	// the damage of the frames since the buffer was presented has to be known
+	if (!FrameDamageSet || bufferAge <= 0 || (u32)bufferAge - 1 > DamageHistoryCount)
+		return false;
+
+	DamageRegion = FrameDamage;
+	for (s32 i = 0; i < bufferAge - 1; ++i)
+		addDamage(DamageRegion, DamageHistory[i]);
+
+	// a frame changing nothing draws nothing, one changing everything is drawn as usual
+	if (DamageRegion.getArea() <= 0)
+		DamageRegion = core::rect<s32>(0, 0, 0, 0);
+	else if (DamageRegion == core::rect<s32>(0, 0, ScreenSize.Width, ScreenSize.Height))
+		return false;
+
+	DamageRegionActive = true;
+	return true;
+}
+
+
+//! Remembers the damage of the presented frame for the next ones
+void CNullDriver::endFrameDamage()
+{
+	for (u32 i = DAMAGE_HISTORY_SIZE - 1; i > 0; --i)
+		DamageHistory[i] = DamageHistory[i - 1];
+	DamageHistory[0] = FrameDamageSet ? FrameDamage : core::rect<s32>(0, 0, ScreenSize.Width, ScreenSize.Height);
+	DamageHistoryCount = core::min_(DamageHistoryCount + 1, (u32)DAMAGE_HISTORY_SIZE);
+
+	FrameDamageSet = false;
+	DamageRegionActive = false;
+}
+
+
+//! Gets the scissor rectangle for drawing with an optional clipping rectangle
+bool CNullDriver::getScissorRect(const core::rect<s32>* clipRect, core::rect<s32>& rect) const
+{
+	const bool damage = DamageRegionActive && !CurrentRenderTarget;
+	if (clipRect)
+	{
+		rect = *clipRect;
+		if (damage)
+			rect.clipAgainst(DamageRegion);
+		return true;
+	}
+
+	if (damage)
+	{
+		rect = DamageRegion;
+		return true;
+	}
+
+	return false;
+}
+
+
+//! Limits how many frames the GPU may lag behind endScene()
+bool CNullDriver::setMaxFramesInFlight(u32 frames)
+{
+	return false;
+}
+
+
+//! Selects how the driver checks for errors of the graphics API
+bool CNullDriver::setErrorCheckMode(E_ERROR_CHECK_MODE mode)
+{
+	return mode == EECM_NONE;
+}
+
+
+//! Moves all work on the rendering context to a thread of the driver
+bool CNullDriver::setRenderThreadEnabled(bool enable)
+{
+	if (enable == RenderThread.joinable())
+		return true;
+
+	if (enable)
+	{
+		if (!queryFeature(EVDF_RENDER_THREAD) || !setContextCurrent(false))
+			return false;
+
+		RenderThreadQuit = false;
+		RenderThread = std::thread(&CNullDriver::renderThreadLoop, this);
+		return true;
+	}
+
+	finishRenderCommands();
+	{
+		std::lock_guard<std::mutex> lock(RenderThreadMutex);
+		RenderThreadQuit = true;
+	}
+	RenderThreadWake.notify_one();
+	RenderThread.join();
+	setContextCurrent(true);
+
+	// commands recorded since the last submit run on this thread now
+	core::array<IRenderCommand*> recorded;
+	recorded.swap(RecordedCommands);
+	ResizeQueued = false;
+	for (u32 i=0; i<recorded.size(); ++i)
+		recorded[i]->execute(this);
+
+	return true;
+}
+
+
+//! Checks if the render thread runs
+bool CNullDriver::isRenderThreadEnabled() const
+{
+	return RenderThread.joinable();
+}
+
+
+//! Records a command into the frame submitted by the next submitRenderCommands()
+void CNullDriver::queueRenderCommand(IRenderCommand* command)
+{
+	if (!command)
+		return;
+
+	if (RenderThread.joinable())
+		RecordedCommands.push_back(command);
+	else
+		command->execute(this);
+}
+
+
+//! Hands the recorded commands over to the render thread
+void CNullDriver::submitRenderCommands()
+{
+	if (!RenderThread.joinable())
+		return;
+
+	{
+		std::unique_lock<std::mutex> lock(RenderThreadMutex);
+		RenderFrameDone.wait(lock, [this] { return !RenderFrameSubmitted; });
+		SubmittedCommands.swap(RecordedCommands);
+		RenderFrameSubmitted = true;
+	}
+	RenderThreadWake.notify_one();
+
+	++SubmittedFrames;
+	ResizeQueued = false;
+}
+
+
+//! Waits until the render thread executed all submitted commands
+void CNullDriver::finishRenderCommands()
+{
+	if (!RenderThread.joinable())
+		return;
+
+	std::unique_lock<std::mutex> lock(RenderThreadMutex);
+	RenderFrameDone.wait(lock, [this] { return !RenderFrameSubmitted; });
+}
+
+
+//! Executes the submitted commands, runs on RenderThread
+void CNullDriver::renderThreadLoop()
+{
+	setContextCurrent(true);
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(RenderThreadMutex);
+			RenderThreadWake.wait(lock, [this] { return RenderThreadQuit || RenderFrameSubmitted; });
+			if (!RenderFrameSubmitted)
+				break;
+		}
+
+		for (u32 i=0; i<SubmittedCommands.size(); ++i)
+			SubmittedCommands[i]->execute(this);
+		SubmittedCommands.set_used(0);
+
+		{
+			std::lock_guard<std::mutex> lock(RenderThreadMutex);
+			RenderFrameSubmitted = false;
+		}
+		RenderFrameDone.notify_all();
+	}
+
+	setContextCurrent(false);
+}
+
+
+//! Queues a resize reported on another thread than the render thread
+bool CNullDriver::queueResize(const core::dimension2d<u32>& size)
+{
+	if (!RenderThread.joinable() || std::this_thread::get_id() == RenderThread.get_id())
+		return false;
+
+	SResizeCommand& command = ResizeCommands[SubmittedFrames & 1];
+	command.Size = size;
+	if (!ResizeQueued)
+	{
+		RecordedCommands.push_back(&command);
+		ResizeQueued = true;
+	}
 	return true;
 }
 
@@ -286,6 +809,7 @@ void CNullDriver::removeTexture(ITexture* texture)
 	{
 		if (Textures[i].Surface == texture)
 		{
+			unindexTexture(texture);
 			texture->drop();
 			Textures.erase(i);
 			return;
@@ -294,6 +818,26 @@ void CNullDriver::removeTexture(ITexture* texture)
 }
 
 
+//! removes a texture from TextureIndex, another one of the same name takes its place
+void CNullDriver::unindexTexture(ITexture* texture)
+{
+	const io::path& name = texture->getName().getInternalName();
+	const auto it = TextureIndex.find(core::atom::find(name));
+	if (it == TextureIndex.end() || it->second != texture)
+		return;
+
+	for (u32 i=0; i<Textures.size(); ++i)
+	{
+		if (Textures[i].Surface != texture && Textures[i].Surface->getName().getInternalName() == name)
+		{
+			it->second = Textures[i].Surface;
+			return;
+		}
+	}
+	TextureIndex.erase(it);
+}
+
+
 //! Removes all texture from the texture cache and deletes them, freeing lot of
 //! memory.
 void CNullDriver::removeAllTextures()
@@ -327,10 +871,13 @@ void CNullDriver::renameTexture(ITexture* texture, const io::path& newName)
 	// is just readonly to prevent the user changing the texture name without invoking
 	// this method, because the textures will need resorting afterwards
 
+	unindexTexture(texture);
+
 	io::SNamedPath& name = const_cast<io::SNamedPath&>(texture->getName());
 	name.setPath(newName);
 
 	Textures.sort();
+	TextureIndex.emplace(core::atom(name.getInternalName()), texture);
 }
 
 ITexture* CNullDriver::addTexture(const core::dimension2d<u32>& size, const io::path& name, ECOLOR_FORMAT format)
@@ -465,7 +1012,7 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 	ITexture* texture = findTexture(absolutePath);
 	if (texture)
 	{
-		texture->updateSource(ETS_FROM_CACHE);
+		updateCachedSource(texture);
 		return texture;
 	}
 
@@ -473,94 +1020,268 @@ ITexture* CNullDriver::getTexture(const io::path& filename)
 	texture = findTexture(filename);
 	if (texture)
 	{
-		texture->updateSource(ETS_FROM_CACHE);
+		updateCachedSource(texture);
 		return texture;
 	}
 
 	// Now try to open the file using the complete path.
 	io::IReadFile* file = FileSystem->createAndOpenFile(absolutePath);
 
-	if (!file)
-	{
-		// Try to open it using the raw filename.
-		file = FileSystem->createAndOpenFile(filename);
-	}
+	if (!file)
+	{
+		// Try to open it using the raw filename.
+		file = FileSystem->createAndOpenFile(filename);
+	}
+
+	if (file)
+	{
+		// Re-check name for actual archive names
+		texture = findTexture(file->getFileName());
+		if (texture)
+		{
+			updateCachedSource(texture);
+			file->drop();
+			return texture;
+		}
+
+		texture = loadTextureFromFile(file);
+		file->drop();
+
+		if (texture)
+		{
+			texture->updateSource(ETS_FROM_FILE);
+			addTexture(texture);
+			texture->drop(); // drop it because we created it, one grab too much
+		}
+		else
+			os::Printer::log("Could not load texture", filename, ELL_ERROR);
+		return texture;
+	}
+	else
+	{
+		os::Printer::log("Could not open file of texture", filename, ELL_WARNING);
+		return 0;
+	}
+}
+
+
+//! loads a Texture
+ITexture* CNullDriver::getTexture(io::IReadFile* file)
+{
+	ITexture* texture = 0;
+
+	if (file)
+	{
+		texture = findTexture(file->getFileName());
+
+		if (texture)
+		{
+			updateCachedSource(texture);
+			return texture;
+		}
+
+		texture = loadTextureFromFile(file);
+
+		if (texture)
+		{
+			texture->updateSource(ETS_FROM_FILE);
+			addTexture(texture);
+			texture->drop(); // drop it because we created it, one grab too much
+		}
+
+		if (!texture)
+			os::Printer::log("Could not load texture", file->getFileName(), ELL_WARNING);
+	}
+
+	return texture;
+}
+
+
+//! loads a Texture on the worker threads of the file system
+ITexture* CNullDriver::getTextureAsync(const io::path& filename)
+{
+	if (!queryFeature(EVDF_ASYNC_TEXTURE_LOADING))
+		return getTexture(filename);
+
+	const io::path absolutePath = FileSystem->getAbsolutePath(filename);
+
+	ITexture* texture = findTexture(absolutePath);
+	if (!texture)
+		texture = findTexture(filename);
+	if (texture)
+	{
+		updateCachedSource(texture);
+		return texture;
+	}
+
+	io::path name;
+	if (FileSystem->existFile(absolutePath))
+		name = absolutePath;
+	else if (FileSystem->existFile(filename))
+		name = filename;
+	else
+	{
+		os::Printer::log("Could not open file of texture", filename, ELL_WARNING);
+		return 0;
+	}
+
+	IImage* image = new CImage(ECF_A8R8G8B8, core::dimension2d<u32>(1, 1));
+	image->fill(SColor(255, 128, 128, 128));
+
+	// the placeholder must not wait in the upload queue, its storage is replaced
+	const bool deferredUpload = getTextureCreationFlag(ETCF_DEFERRED_UPLOAD);
+	setTextureCreationFlag(ETCF_DEFERRED_UPLOAD, false);
+	texture = createDeviceDependentTexture(name, image);
+	setTextureCreationFlag(ETCF_DEFERRED_UPLOAD, deferredUpload);
+
+	image->drop();
+
+	if (!texture)
+		return 0;
+
+	texture->updateSource(ETS_LOADING);
+	addTexture(texture);
+	texture->drop();
+
+	STextureLoad* load = new STextureLoad(texture, SurfaceLoader);
+	load->CPUMipMaps = getCPUMipMapFlags(load->MipMapFlags);
+	load->MaxTextureSize = getMaxTextureSize();
+	core::array<io::path> filenames(1);
+	filenames.push_back(name);
+	load->Request = FileSystem->prefetchFiles(filenames, load);
+	TextureLoads.push_back(load);
+
+	return texture;
+}
+
 
-	if (file)
+//! Hands the textures decoded for getTextureAsync() to replaceTexture()
+void CNullDriver::updateTextureLoads()
+{
+	for (u32 i = 0; i < TextureLoads.size();)
 	{
-		// Re-check name for actual archive names
-		texture = findTexture(file->getFileName());
-		if (texture)
+		STextureLoad* load = TextureLoads[i];
+		if (!load->Request->isReady())
 		{
-			texture->updateSource(ETS_FROM_CACHE);
-			file->drop();
-			return texture;
+			++i;
+			continue;
 		}
 
-		texture = loadTextureFromFile(file);
-		file->drop();
+		ITexture* texture = load->Texture;
+		const io::path& name = texture->getName();
 
-		if (texture)
+		// textures removed meanwhile are only kept alive by the load
+		if (findTexture(name) == texture)
 		{
-			texture->updateSource(ETS_FROM_FILE);
-			addTexture(texture);
-			texture->drop(); // drop it because we created it, one grab too much
+			const core::array<IImage*>& images = load->Images;
+			const u32 required = load->Type == ETT_CUBEMAP ? 6 : 1;
+
+			// the images are dropped with the load, so the texture may keep them
+			TextureImagesDisposable = true;
+			const bool replaced = images.size() >= required && checkImage(images) && replaceTexture(texture, images, load->Type);
+			TextureImagesDisposable = false;
+
+			if (replaced)
+			{
+				texture->updateSource(ETS_FROM_FILE);
+				os::Printer::log("Loaded texture", name, ELL_DEBUG);
+			}
+			else
+			{
+				texture->updateSource(ETS_UNKNOWN);
+				os::Printer::log("Could not load texture", name, ELL_ERROR);
+			}
 		}
-		else
-			os::Printer::log("Could not load texture", filename, ELL_ERROR);
-		return texture;
+
+		delete load;
+		TextureLoads.erase(i);
 	}
-	else
+}
+
+
+//! Waits for the files of getTextureAsync() and drops the loads
+void CNullDriver::cancelTextureLoads()
+{
+	for (u32 i = 0; i < TextureLoads.size(); ++i)
 	{
-		os::Printer::log("Could not open file of texture", filename, ELL_WARNING);
-		return 0;
+		TextureLoads[i]->Request->wait();
+		delete TextureLoads[i];
 	}
+	TextureLoads.clear();
 }
 
 
-//! loads a Texture
-ITexture* CNullDriver::getTexture(io::IReadFile* file)
+//! Returns if textures loaded now get their mipmaps on the CPU
+bool CNullDriver::getCPUMipMapFlags(u32& flags) const
 {
-	ITexture* texture = 0;
+	flags = (getTextureCreationFlag(ETCF_SRGB_MIP_MAPS) ? EMMF_SRGB : 0) |
+		(getTextureCreationFlag(ETCF_PRESERVE_ALPHA_COVERAGE) ? EMMF_PRESERVE_ALPHA_COVERAGE : 0);
+	return getTextureCreationFlag(ETCF_CREATE_MIP_MAPS) && getTextureCreationFlag(ETCF_CREATE_MIP_MAPS_ON_CPU);
+}
 
-	if (file)
-	{
-		texture = findTexture(file->getFileName());
 
-		if (texture)
-		{
-			texture->updateSource(ETS_FROM_CACHE);
-			return texture;
-		}
+//! Gives a placeholder of getTextureAsync() the loaded images
+bool CNullDriver::replaceTexture(ITexture* texture, const core::array<IImage*>& images, E_TEXTURE_TYPE type)
+{
+	return false;
+}
 
-		texture = loadTextureFromFile(file);
 
-		if (texture)
-		{
-			texture->updateSource(ETS_FROM_FILE);
-			addTexture(texture);
-			texture->drop(); // drop it because we created it, one grab too much
-		}
+CNullDriver::STextureLoad::STextureLoad(ITexture* texture, const core::array<IImageLoader*>& loaders)
+	: Texture(texture), Request(0), Loaders(loaders), Type(ETT_2D), CPUMipMaps(false), MipMapFlags(0)
+{
+	Texture->grab();
+	for (u32 i = 0; i < Loaders.size(); ++i)
+		Loaders[i]->grab();
+}
 
-		if (!texture)
-			os::Printer::log("Could not load texture", file->getFileName(), ELL_WARNING);
+
+CNullDriver::STextureLoad::~STextureLoad()
+{
+	for (u32 i = 0; i < Images.size(); ++i)
+	{
+		if (Images[i])
+			Images[i]->drop();
 	}
+	for (u32 i = 0; i < Loaders.size(); ++i)
+		Loaders[i]->drop();
+	Request->drop();
+	Texture->drop();
+}
 
-	return texture;
+
+//! Decodes the file with Loaders, on a worker thread
+void CNullDriver::STextureLoad::OnFilePrefetched(io::IFilePrefetchRequest* request, u32 index, io::IReadFile* file)
+{
+	IRR_PROFILE_SCOPE("STextureLoad::OnFilePrefetched");
+	if (file)
+		Images = loadImages(Loaders, file, &Type, &MaxTextureSize);
+
+	if (CPUMipMaps)
+		createMipMaps(Images, MipMapFlags);
 }
 
 
 //! opens the file and loads it into the surface
 video::ITexture* CNullDriver::loadTextureFromFile(io::IReadFile* file, const io::path& hashName )
 {
+	IRR_PROFILE_SCOPE("CNullDriver::loadTextureFromFile");
 	ITexture* texture = 0;
 
 	E_TEXTURE_TYPE type = ETT_2D;
 
-	core::array<IImage*> imageArray = createImagesFromFile(file, &type);
+	const core::dimension2du maxTextureSize = getMaxTextureSize();
+	core::array<IImage*> imageArray = loadImages(SurfaceLoader, file, &type, &maxTextureSize);
+
+	u32 mipMapFlags;
+	if (getCPUMipMapFlags(mipMapFlags))
+		createMipMaps(imageArray, mipMapFlags);
 
 	if (checkImage(imageArray))
 	{
+		// the images are dropped below, so the texture may keep them
+		TextureImagesDisposable = true;
+
 		switch (type)
 		{
 		case ETT_2D:
@@ -577,6 +1298,8 @@ video::ITexture* CNullDriver::loadTextureFromFile(io::IReadFile* file, const io:
 			break;
 		}
 
+		TextureImagesDisposable = false;
+
 		if (texture)
 			os::Printer::log("Loaded texture", file->getFileName(), ELL_DEBUG);
 	}
@@ -601,6 +1324,7 @@ void CNullDriver::addTexture(video::ITexture* texture)
 		texture->grab();
 
 		Textures.push_back(s);
+		TextureIndex.emplace(core::atom(texture->getName().getInternalName()), texture);
 
 		// the new texture is now at the end of the texture list. when searching for
 		// the next new texture, the texture array will be sorted and the index of this texture
@@ -615,15 +1339,15 @@ void CNullDriver::addTexture(video::ITexture* texture)
 //! looks if the image is already loaded
 video::ITexture* CNullDriver::findTexture(const io::path& filename)
 {
-	SSurface s;
-	SDummyTexture dummy(filename, ETT_2D);
-	s.Surface = &dummy;
+	const io::SNamedPath name(filename);
 
-	s32 index = Textures.binary_search(s);
-	if (index != -1)
-		return Textures[index].Surface;
+	// texture names are interned, no texture has a name which isn't
+	const core::atom key = core::atom::find(name.getInternalName());
+	if (key.empty() && !name.getInternalName().empty())
+		return 0;
 
-	return 0;
+	const auto it = TextureIndex.find(key);
+	return it != TextureIndex.end() ? it->second : 0;
 }
 
 ITexture* CNullDriver::createDeviceDependentTexture(const io::path& name, IImage* image)
@@ -700,6 +1424,11 @@ void CNullDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
 	PrimitivesDrawn += primitiveCount;
+	FrameStats.PrimitivesDrawn += primitiveCount;
+	++FrameStats.DrawCalls;
+	// hardware buffers pass no vertices
+	if (vertices)
+		FrameStats.VerticesUploaded += vertexCount;
 }
 
 
@@ -709,6 +1438,11 @@ void CNullDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCoun
 	if ((iType==EIT_16BIT) && (vertexCount>65536))
 		os::Printer::log("Too many vertices for 16bit index type, render artifacts may occur.");
 	PrimitivesDrawn += primitiveCount;
+	FrameStats.PrimitivesDrawn += primitiveCount;
+	++FrameStats.DrawCalls;
+	// hardware buffers pass no vertices
+	if (vertices)
+		FrameStats.VerticesUploaded += vertexCount;
 }
 
 
@@ -822,6 +1556,28 @@ void CNullDriver::draw2DLine(const core::position2d<s32>& start,
 }
 
 
+//! Starts recording 2d drawing, not supported by default
+bool CNullDriver::beginRecording2D(S2DDrawList& list)
+{
+	list.clear();
+	return false;
+}
+
+
+//! Stops recording 2d drawing
+bool CNullDriver::endRecording2D()
+{
+	return false;
+}
+
+
+//! Draws recorded 2d drawing again
+bool CNullDriver::drawRecording2D(const S2DDrawList& list)
+{
+	return false;
+}
+
+
 //! returns color format
 ECOLOR_FORMAT CNullDriver::getColorFormat() const
 {
@@ -868,6 +1624,75 @@ u32 CNullDriver::getPrimitiveCountDrawn( u32 param ) const
 }
 
 
+//! Returns the work done by the driver in the current frame.
+const SFrameStats& CNullDriver::getFrameStats() const
+{
+	return FrameStats;
+}
+
+
+//! Records the submitted commands, only the null driver does
+bool CNullDriver::setCommandRecording(bool enable, io::IWriteFile* log)
+{
+	return false;
+}
+
+
+//! Needs SIrrlichtCreationParameters::FrameCapture, which puts a capturing driver in front
+bool CNullDriver::captureFrame(io::IWriteFile* file, bool payloads)
+{
+	os::Printer::log("Frame capture needs SIrrlichtCreationParameters::FrameCapture", ELL_WARNING);
+	return false;
+}
+
+
+//! Loads a capture to replay on this driver
+IFrameReplay* CNullDriver::createFrameReplay(io::IReadFile* file)
+{
+	CFrameReplay* replay = new CFrameReplay(this);
+	if (!replay->load(file))
+	{
+		replay->drop();
+		return 0;
+	}
+	return replay;
+}
+
+
+//! Sets how many frames getFrameTimeStats() can look back on
+void CNullDriver::setFrameTimeHistory(u32 frames, f32 hitchMilliseconds)
+{
+	FPSCounter.setFrameTimeHistory(frames, hitchMilliseconds);
+	FrameBeginNs = 0;
+	LastFrameEndNs = 0;
+}
+
+
+//! Returns the distribution of the frame times of the latest frames
+SFrameTimeStats CNullDriver::getFrameTimeStats(u32 frames) const
+{
+	return FPSCounter.getFrameTimeStats(frames);
+}
+
+
+//! Records the time since swapBeginNs as present time of the frame endScene() finished
+void CNullDriver::registerSwapTime(u64 swapBeginNs)
+{
+	if (FPSCounter.isFrameTimeHistoryEnabled())
+		FPSCounter.registerSwapTime(FrameCount - 1, (f32)((os::Timer::getRealTimeNs() - swapBeginNs) / 1000000.0));
+}
+
+void CNullDriver::setTextureMemoryBudget(u64 bytes)
+{
+	TextureResidencyStats.Budget = bytes;
+}
+
+const STextureResidencyStats& CNullDriver::getTextureResidencyStats() const
+{
+	return TextureResidencyStats;
+}
+
+
 
 //! Sets the dynamic ambient light color. The default color is
 //! (0,0,0,0) which means it is dark.
@@ -922,22 +1747,9 @@ void CNullDriver::makeColorKeyTexture(video::ITexture* texture,
 		// color with alpha disabled (i.e. fully transparent)
 		const u16 refZeroAlpha = (0x7fff & color.toA1R5G5B5());
 
-		const u32 pixels = pitch * dim.Height;
-
-		for (u32 pixel = 0; pixel < pixels; ++ pixel)
-		{
-			// If the color matches the reference color, ignoring alphas,
-			// set the alpha to zero.
-			if(((*p) & 0x7fff) == refZeroAlpha)
-			{
-				if(zeroTexels)
-					(*p) = 0;
-				else
-					(*p) = refZeroAlpha;
-			}
-
-			++p;
-		}
+		// If the color matches the reference color, ignoring alphas,
+		// set the alpha to zero.
+		CColorConverter::replaceColorKey16(p, pitch * dim.Height, 0x7fff, refZeroAlpha, zeroTexels ? 0 : refZeroAlpha);
 
 		texture->unlock();
 	}
@@ -957,21 +1769,9 @@ void CNullDriver::makeColorKeyTexture(video::ITexture* texture,
 		// color with alpha disabled (fully transparent)
 		const u32 refZeroAlpha = 0x00ffffff & color.color;
 
-		const u32 pixels = pitch * dim.Height;
-		for (u32 pixel = 0; pixel < pixels; ++ pixel)
-		{
-			// If the color matches the reference color, ignoring alphas,
-			// set the alpha to zero.
-			if(((*p) & 0x00ffffff) == refZeroAlpha)
-			{
-				if(zeroTexels)
-					(*p) = 0;
-				else
-					(*p) = refZeroAlpha;
-			}
-
-			++p;
-		}
+		// If the color matches the reference color, ignoring alphas,
+		// set the alpha to zero.
+		CColorConverter::replaceColorKey32(p, pitch * dim.Height, 0x00ffffff, refZeroAlpha, zeroTexels ? 0 : refZeroAlpha);
 
 		texture->unlock();
 	}
@@ -1127,6 +1927,22 @@ bool CNullDriver::checkImage(const core::array<IImage*>& image) const
 					status = false;
 				}
 				break;
+			case ECF_BC7:
+				if (!queryFeature(EVDF_TEXTURE_COMPRESSED_BPTC))
+				{
+					os::Printer::log("BC7 texture compression not available.", ELL_ERROR);
+					status = false;
+				}
+				break;
+			case ECF_ASTC_4x4:
+			case ECF_ASTC_6x6:
+			case ECF_ASTC_8x8:
+				if (!queryFeature(EVDF_TEXTURE_COMPRESSED_ASTC))
+				{
+					os::Printer::log("ASTC texture compression not available.", ELL_ERROR);
+					status = false;
+				}
+				break;
 			default:
 				break;
 			}
@@ -1192,97 +2008,215 @@ core::array<IImage*> CNullDriver::createImagesFromFile(const io::path& filename,
 
 core::array<IImage*> CNullDriver::createImagesFromFile(io::IReadFile* file, E_TEXTURE_TYPE* type)
 {
-	// TO-DO -> use 'move' feature from C++11 standard.
+	return loadImages(SurfaceLoader, file, type);
+}
 
-	core::array<IImage*> imageArray;
 
-	if (file)
+//! Creates software images from several files on worker threads
+core::array<IImage*> CNullDriver::createImagesFromFiles(const core::array<io::IReadFile*>& files)
+{
+	core::array<SImageDecodeJob> jobs(files.size());
+	for (u32 i = 0; i < files.size(); ++i)
 	{
-		s32 i;
+		SImageDecodeJob job = {&SurfaceLoader, files[i], 0};
 
-		// try to load file based on file extension
-		for (i = SurfaceLoader.size() - 1; i >= 0; --i)
+		// files of archives may read from the file of their archive, which can't be shared between threads
+		if (job.File && job.File->getType() != io::ERFT_READ_FILE && job.File->getType() != io::ERFT_MEMORY_READ_FILE)
 		{
-			if (SurfaceLoader[i]->isALoadableFileExtension(file->getFileName()))
+			const long size = job.File->getSize();
+			c8* data = new c8[size > 0 ? size : 1];
+			job.File->seek(0);
+			if (size < 0 || job.File->read(data, size) != (size_t)size)
 			{
-				// reset file position which might have changed due to previous loadImage calls
-				file->seek(0);
-				imageArray = SurfaceLoader[i]->loadImages(file, type);
-
-				if (imageArray.size() == 0)
-				{
-					file->seek(0);
-					IImage* image = SurfaceLoader[i]->loadImage(file);
+				delete [] data;
+				job.File = 0;
+			}
+			else
+				job.File = new io::CMemoryReadFile(data, size, job.File->getFileName(), true);
+		}
+		else if (job.File)
+			job.File->grab();
 
-					if (image)
-						imageArray.push_back(image);
-				}
+		jobs.push_back(job);
+	}
 
-				if (imageArray.size() > 0)
-					return imageArray;
-			}
+	const u32 cores = std::thread::hardware_concurrency();
+	if (jobs.size() > 1 && cores > 1)
+	{
+		scene::CJobSystem workers(core::min_(cores, jobs.size()) - 1);
+		for (u32 i = 0; i < jobs.size(); ++i)
+		{
+			if (jobs[i].File)
+				workers.add(decodeImageJob, &jobs[i]);
 		}
+		workers.wait();
+	}
+	else
+	{
+		for (u32 i = 0; i < jobs.size(); ++i)
+		{
+			if (jobs[i].File)
+				decodeImageJob(&jobs[i]);
+		}
+	}
 
-		// try to load file based on what is in it
-		for (i = SurfaceLoader.size() - 1; i >= 0; --i)
+	core::array<IImage*> images(jobs.size());
+	for (u32 i = 0; i < jobs.size(); ++i)
+	{
+		if (jobs[i].File)
 		{
-			// dito
-			file->seek(0);
-			if (SurfaceLoader[i]->isALoadableFileFormat(file)
-				&& !SurfaceLoader[i]->isALoadableFileExtension(file->getFileName())	// extension was tried above already
-				)
-			{
-				file->seek(0);
-				imageArray = SurfaceLoader[i]->loadImages(file, type);
+			if (!jobs[i].Image)
+				os::Printer::log("Could not load image", jobs[i].File->getFileName(), ELL_ERROR);
+			jobs[i].File->drop();
+		}
+		images.push_back(jobs[i].Image);
+	}
 
-				if (imageArray.size() == 0)
-				{
-					file->seek(0);
-					IImage* image = SurfaceLoader[i]->loadImage(file);
+	return images;
+}
 
-					if (image)
-						imageArray.push_back(image);
-				}
 
-				if (imageArray.size() > 0)
-					return imageArray;
-			}
+//! Writes the provided image to disk file
+bool CNullDriver::writeImageToFile(IImage* image, const io::path& filename,u32 param)
+{
+	io::IWriteFile* file = FileSystem->createAndWriteFile(filename);
+	if(!file)
+		return false;
+
+	bool result = writeImageToFile(image, file, param);
+	file->drop();
+
+	return result;
+}
+
+//! Writes the provided image to a file.
+bool CNullDriver::writeImageToFile(IImage* image, io::IWriteFile * file, u32 param)
+{
+	if(!file)
+		return false;
+
+	for (s32 i=SurfaceWriter.size()-1; i>=0; --i)
+	{
+		if (SurfaceWriter[i]->isAWriteableFileExtension(file->getFileName()))
+		{
+			bool written = SurfaceWriter[i]->writeImage(file, image, param);
+			if (written)
+				return true;
 		}
 	}
+	return false; // failed to write
+}
+
+
+//! Writes an image to a file on ImageWriteThread
+bool CNullDriver::writeImageToFileAsync(IImage* image, const io::path& filename, u32 param,
+	IImageWriteCallback* callback)
+{
+	if (!image)
+		return false;
+
+	SImageWrite write = {image, 0, 0, param, callback, false};
+	for (s32 i=SurfaceWriter.size()-1; i>=0 && !write.Writer; --i)
+	{
+		if (SurfaceWriter[i]->isAWriteableFileExtension(filename))
+			write.Writer = SurfaceWriter[i];
+	}
+
+	// the file system isn't thread safe, so the file is created here
+	if (write.Writer)
+		write.File = FileSystem->createAndWriteFile(filename);
+
+	if (!write.File)
+	{
+		os::Printer::log("Could not write image", filename, ELL_ERROR);
+		image->drop();
+		return false;
+	}
+	write.Writer->grab();
+
+	if (!ImageWriteThread.joinable())
+		ImageWriteThread = std::thread(&CNullDriver::imageWriteLoop, this);
+
+	{
+		std::lock_guard<std::mutex> lock(ImageWriteMutex);
+		ImageWriteQueue.push_back(write);
+	}
+	ImageWriteWake.notify_one();
+
+	return true;
+}
+
+
+//! Writes the images queued by writeImageToFileAsync(), runs on ImageWriteThread
+void CNullDriver::imageWriteLoop()
+{
+	for (;;)
+	{
+		SImageWrite write;
+		{
+			std::unique_lock<std::mutex> lock(ImageWriteMutex);
+			ImageWriteWake.wait(lock, [this] { return ImageWriteQuit || !ImageWriteQueue.empty(); });
+			if (ImageWriteQueue.empty())
+				return;
+
+			write = ImageWriteQueue.front();
+			ImageWriteQueue.pop_front();
+		}
 
-	return imageArray;
+		write.Written = write.Writer->writeImage(write.File, write.Image, write.Param) && write.File->flush();
+
+		std::lock_guard<std::mutex> lock(ImageWriteMutex);
+		ImageWritesDone.push_back(write);
+	}
 }
 
 
-//! Writes the provided image to disk file
-bool CNullDriver::writeImageToFile(IImage* image, const io::path& filename,u32 param)
+//! Tells the callbacks of writeImageToFileAsync() about the written images
+void CNullDriver::updateImageWrites()
 {
-	io::IWriteFile* file = FileSystem->createAndWriteFile(filename);
-	if(!file)
-		return false;
-
-	bool result = writeImageToFile(image, file, param);
-	file->drop();
+	core::array<SImageWrite> done;
+	{
+		std::lock_guard<std::mutex> lock(ImageWriteMutex);
+		if (ImageWritesDone.empty())
+			return;
+		done.swap(ImageWritesDone);
+	}
 
-	return result;
+	for (u32 i=0; i<done.size(); ++i)
+	{
+		const io::path filename = done[i].File->getFileName();
+		done[i].File->drop();
+		done[i].Writer->drop();
+		done[i].Image->drop();
+
+		if (!done[i].Written)
+			os::Printer::log("Could not write image", filename, ELL_ERROR);
+		if (done[i].Callback)
+			done[i].Callback->OnImageWritten(filename, done[i].Written);
+	}
 }
 
-//! Writes the provided image to a file.
-bool CNullDriver::writeImageToFile(IImage* image, io::IWriteFile * file, u32 param)
-{
-	if(!file)
-		return false;
 
-	for (s32 i=SurfaceWriter.size()-1; i>=0; --i)
+//! Waits until all queued images are written, without calling the callbacks
+void CNullDriver::finishImageWrites()
+{
+	if (ImageWriteThread.joinable())
 	{
-		if (SurfaceWriter[i]->isAWriteableFileExtension(file->getFileName()))
 		{
-			bool written = SurfaceWriter[i]->writeImage(file, image, param);
-			if (written)
-				return true;
+			std::lock_guard<std::mutex> lock(ImageWriteMutex);
+			ImageWriteQuit = true;
 		}
+		ImageWriteWake.notify_one();
+		ImageWriteThread.join();
 	}
-	return false; // failed to write
+
+	for (u32 i=0; i<ImageWritesDone.size(); ++i)
+	{
+		ImageWritesDone[i].File->drop();
+		ImageWritesDone[i].Writer->drop();
+		ImageWritesDone[i].Image->drop();
+	}
+	ImageWritesDone.clear();
 }
 
 
@@ -1406,6 +2340,44 @@ void CNullDriver::drawMeshBuffer(const scene::IMeshBuffer* mb)
 }
 
 
+//! Draws several mesh buffers with the currently set material
+void CNullDriver::drawMeshBufferBatch(const scene::IMeshBuffer* const* mb,
+		const core::matrix4* worldMatrices, u32 count)
+{
+	if (!mb || !worldMatrices)
+		return;
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		setTransform(ETS_WORLD, worldMatrices[i]);
+		drawMeshBuffer(mb[i]);
+	}
+}
+
+
+//! Draws several instances of a mesh buffer, one at a time
+void CNullDriver::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+		const S3DInstance* instances, u32 count)
+{
+	if (!mb || !instances)
+		return;
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		setTransform(ETS_WORLD, instances[i].Transform);
+		drawMeshBuffer(mb);
+	}
+}
+
+
+//! Draws a mesh buffer without blending it towards the target
+void CNullDriver::drawMeshBufferMorphed(const scene::IMeshBuffer* mb,
+		const scene::IMeshBuffer* target, f32 blend)
+{
+	drawMeshBuffer(mb);
+}
+
+
 //! Draws the normals of a mesh buffer
 void CNullDriver::drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length, SColor color)
 {
@@ -1430,7 +2402,7 @@ CNullDriver::SHWBufferLink *CNullDriver::getBufferLink(const scene::IMeshBuffer*
 		return 0;
 
 	//search for hardware links
-	SHWBufferLink *HWBuffer = reinterpret_cast<SHWBufferLink*>(mb->getHWBuffer());
+	SHWBufferLink *HWBuffer = static_cast<SHWBufferLink*>(mb->getHWBuffer());
 	if (HWBuffer)
 		return HWBuffer;
 
@@ -1438,17 +2410,28 @@ CNullDriver::SHWBufferLink *CNullDriver::getBufferLink(const scene::IMeshBuffer*
 }
 
 
-//! Update all hardware buffers, remove unused ones
+void CNullDriver::SHWBufferLink::onMeshBufferDestroyed(const scene::IMeshBuffer* mb)
+{
+	// a copied mesh buffer may still point to the link of the original
+	if (mb != MeshBuffer)
+		return;
+	MeshBuffer = 0;
+	Driver->HWBufferDeletionQueue.push_back(this);
+}
+
+
+//! Delete the hardware buffers of destroyed mesh buffers, up to the deletion budget
 void CNullDriver::updateAllHardwareBuffers()
 {
-	auto it = HWBufferList.begin();
-	while (it != HWBufferList.end()) {
-		SHWBufferLink *Link = *it;
-		++it;
+	u32 count = HWBufferDeletionQueue.size();
+	if (HWBufferDeletionBudget && count > HWBufferDeletionBudget)
+		count = HWBufferDeletionBudget;
+	if (!count)
+		return;
 
-		if (!Link->MeshBuffer || Link->MeshBuffer->getReferenceCount() == 1)
-			deleteHardwareBuffer(Link);
-	}
+	for (u32 i=0; i<count; ++i)
+		deleteHardwareBuffer(HWBufferDeletionQueue[i]);
+	HWBufferDeletionQueue.erase(0, count);
 }
 
 
@@ -1466,7 +2449,7 @@ void CNullDriver::removeHardwareBuffer(const scene::IMeshBuffer* mb)
 {
 	if (!mb)
 		return;
-	SHWBufferLink *HWBuffer = reinterpret_cast<SHWBufferLink*>(mb->getHWBuffer());
+	SHWBufferLink *HWBuffer = static_cast<SHWBufferLink*>(mb->getHWBuffer());
 	if (HWBuffer)
 		deleteHardwareBuffer(HWBuffer);
 }
@@ -1475,6 +2458,7 @@ void CNullDriver::removeHardwareBuffer(const scene::IMeshBuffer* mb)
 //! Remove all hardware buffers
 void CNullDriver::removeAllHardwareBuffers()
 {
+	HWBufferDeletionQueue.clear();
 	while (!HWBufferList.empty())
 		deleteHardwareBuffer(HWBufferList.front());
 }
@@ -1485,6 +2469,10 @@ bool CNullDriver::isHardwareBufferRecommend(const scene::IMeshBuffer* mb)
 	if (!mb || (mb->getHardwareMappingHint_Index()==scene::EHM_NEVER && mb->getHardwareMappingHint_Vertex()==scene::EHM_NEVER))
 		return false;
 
+	// there is nothing left to draw from but the hardware buffer
+	if (mb->isClientDataReleased())
+		return true;
+
 	if (mb->getVertexCount()<MinVertexCountForVBO)
 		return false;
 
@@ -1629,6 +2617,25 @@ u32 CNullDriver::getOcclusionQueryResult(scene::ISceneNode* node) const
 }
 
 
+//! Starts a named GPU timer scope.
+void CNullDriver::beginGPUTimerScope(const c8* name)
+{
+}
+
+
+//! Ends the GPU timer scope which was started last.
+void CNullDriver::endGPUTimerScope()
+{
+}
+
+
+//! Return the GPU timer scopes of the latest frame with results.
+const core::array<SGPUTimerResult>& CNullDriver::getGPUTimerResults() const
+{
+	return GPUTimerResults;
+}
+
+
 //! Create render target.
 IRenderTarget* CNullDriver::addRenderTarget()
 {
@@ -1646,6 +2653,10 @@ void CNullDriver::removeRenderTarget(IRenderTarget* renderTarget)
 	{
 		if (RenderTargets[i] == renderTarget)
 		{
+			// the drivers resolve the current target when leaving it
+			if (CurrentRenderTarget == renderTarget)
+				CurrentRenderTarget = 0;
+
 			RenderTargets[i]->drop();
 			RenderTargets.erase(i);
 
@@ -1658,12 +2669,121 @@ void CNullDriver::removeRenderTarget(IRenderTarget* renderTarget)
 //! Remove all render targets.
 void CNullDriver::removeAllRenderTargets()
 {
+	for (u32 i = 0; i < TransientTargets.size(); ++i)
+	{
+		removeTexture(TransientTargets[i].Color);
+		removeTexture(TransientTargets[i].Depth);
+	}
+	TransientTargets.clear();
+
 	for (u32 i = 0; i < RenderTargets.size(); ++i)
 		RenderTargets[i]->drop();
 
 	RenderTargets.clear();
 
 	SharedRenderTarget = 0;
+	CurrentRenderTarget = 0;
+}
+
+
+ITexture* CNullDriver::acquireTransientRenderTargetTexture(const core::dimension2d<u32>& size, ECOLOR_FORMAT format)
+{
+	for (u32 i = 0; i < TransientTextures.size(); ++i)
+	{
+		STransientTexture& entry = TransientTextures[i];
+		if (!entry.InUse && entry.Texture->getSize() == size && entry.Texture->getColorFormat() == format)
+		{
+			entry.InUse = true;
+			return entry.Texture;
+		}
+	}
+
+	STransientTexture entry;
+	entry.Texture = addRenderTargetTexture(size, "<transient render target>", format);
+	if (!entry.Texture)
+		return 0;
+	entry.InUse = true;
+	TransientTextures.push_back(entry);
+	return entry.Texture;
+}
+
+
+void CNullDriver::releaseTransientRenderTargetTexture(ITexture* texture)
+{
+	for (u32 i = 0; i < TransientTextures.size(); ++i)
+	{
+		if (TransientTextures[i].Texture == texture)
+		{
+			TransientTextures[i].InUse = false;
+			return;
+		}
+	}
+}
+
+
+IRenderTarget* CNullDriver::acquireTransientRenderTarget(const core::dimension2d<u32>& size,
+	ECOLOR_FORMAT colorFormat, ECOLOR_FORMAT depthFormat)
+{
+	for (u32 i = 0; i < TransientTargets.size(); ++i)
+	{
+		STransientTarget& entry = TransientTargets[i];
+		if (!entry.InUse && entry.Color->getSize() == size && entry.Color->getColorFormat() == colorFormat &&
+			(entry.Depth ? entry.Depth->getColorFormat() : ECF_UNKNOWN) == depthFormat)
+		{
+			// a previous user may have changed how it is drawn
+			entry.Target->setSampleCount(0);
+			entry.Target->setDiscardDepthStencil(false);
+			entry.InUse = true;
+			return entry.Target;
+		}
+	}
+
+	STransientTarget entry;
+	entry.Color = addRenderTargetTexture(size, "<transient render target>", colorFormat);
+	entry.Depth = 0;
+	if (entry.Color && depthFormat != ECF_UNKNOWN)
+		entry.Depth = addRenderTargetTexture(size, "<transient render target depth>", depthFormat);
+	entry.Target = (entry.Color && (entry.Depth || depthFormat == ECF_UNKNOWN)) ? addRenderTarget() : 0;
+	if (!entry.Target)
+	{
+		removeTexture(entry.Color);
+		removeTexture(entry.Depth);
+		return 0;
+	}
+	entry.Target->setTexture(entry.Color, entry.Depth);
+	entry.InUse = true;
+	entry.ReleaseFrame = FrameCount;
+	TransientTargets.push_back(entry);
+	return entry.Target;
+}
+
+
+void CNullDriver::releaseTransientRenderTarget(IRenderTarget* target)
+{
+	for (u32 i = 0; i < TransientTargets.size(); ++i)
+	{
+		if (TransientTargets[i].Target == target)
+		{
+			TransientTargets[i].InUse = false;
+			TransientTargets[i].ReleaseFrame = FrameCount;
+			return;
+		}
+	}
+}
+
+
+void CNullDriver::removeTransientTarget(u32 index)
+{
+	removeRenderTarget(TransientTargets[index].Target);
+	removeTexture(TransientTargets[index].Color);
+	removeTexture(TransientTargets[index].Depth);
+	TransientTargets.erase(index);
+}
+
+
+IPostProcessChain* CNullDriver::createPostProcessChain()
+{
+	return new CPostProcessChain(this);
 }
 
 
@@ -1671,12 +2791,30 @@ void CNullDriver::removeAllRenderTargets()
 //! the window was resized.
 void CNullDriver::OnResize(const core::dimension2d<u32>& size)
 {
+	if (queueResize(size))
+		return;
+
 	if (ViewPort.getWidth() == (s32)ScreenSize.Width &&
 		ViewPort.getHeight() == (s32)ScreenSize.Height)
 		ViewPort = core::rect<s32>(core::position2d<s32>(0,0),
 									core::dimension2di(size));
 
 	ScreenSize = size;
+
+	// the free transient textures and targets likely have the old size
+	for (s32 i = (s32)TransientTextures.size() - 1; i >= 0; --i)
+	{
+		if (!TransientTextures[i].InUse)
+		{
+			removeTexture(TransientTextures[i].Texture);
+			TransientTextures.erase(i);
+		}
+	}
+	for (s32 i = (s32)TransientTargets.size() - 1; i >= 0; --i)
+	{
+		if (!TransientTargets[i].InUse)
+			removeTransientTarget(i);
+	}
 }
 
 
@@ -1760,6 +2898,7 @@ void CNullDriver::deleteMaterialRenders()
 			MaterialRenderers[i].Renderer->drop();
 
 	MaterialRenderers.clear();
+	ShaderPermutations.clear();
 }
 
 
@@ -1837,14 +2976,17 @@ s32 CNullDriver::addHighLevelShaderMaterialFromFiles(
 		E_MATERIAL_TYPE baseMaterial,
 		s32 userData)
 {
-	io::IReadFile* vsfile = 0;
-	io::IReadFile* psfile = 0;
-	io::IReadFile* gsfile = 0;
+	core::stringc vs;
+	core::stringc ps;
+	core::stringc gs;
+	bool hasVS = false;
+	bool hasPS = false;
+	bool hasGS = false;
 
 	if (vertexShaderProgramFileName.size() )
 	{
-		vsfile = FileSystem->createAndOpenFile(vertexShaderProgramFileName);
-		if (!vsfile)
+		hasVS = loadShaderSource(vertexShaderProgramFileName, vs);
+		if (!hasVS)
 		{
 			os::Printer::log("Could not open vertex shader program file",
 				vertexShaderProgramFileName, ELL_WARNING);
@@ -1853,8 +2995,8 @@ s32 CNullDriver::addHighLevelShaderMaterialFromFiles(
 
 	if (pixelShaderProgramFileName.size() )
 	{
-		psfile = FileSystem->createAndOpenFile(pixelShaderProgramFileName);
-		if (!psfile)
+		hasPS = loadShaderSource(pixelShaderProgramFileName, ps);
+		if (!hasPS)
 		{
 			os::Printer::log("Could not open pixel shader program file",
 				pixelShaderProgramFileName, ELL_WARNING);
@@ -1863,31 +3005,20 @@ s32 CNullDriver::addHighLevelShaderMaterialFromFiles(
 
 	if (geometryShaderProgramFileName.size() )
 	{
-		gsfile = FileSystem->createAndOpenFile(geometryShaderProgramFileName);
-		if (!gsfile)
+		hasGS = loadShaderSource(geometryShaderProgramFileName, gs);
+		if (!hasGS)
 		{
 			os::Printer::log("Could not open geometry shader program file",
 				geometryShaderProgramFileName, ELL_WARNING);
 		}
 	}
 
-	s32 result = addHighLevelShaderMaterialFromFiles(
-		vsfile, vertexShaderEntryPointName, vsCompileTarget,
-		psfile, pixelShaderEntryPointName, psCompileTarget,
-		gsfile, geometryShaderEntryPointName, gsCompileTarget,
+	return this->addHighLevelShaderMaterial(
+		hasVS && vs.size() ? vs.c_str() : 0, vertexShaderEntryPointName, vsCompileTarget,
+		hasPS && ps.size() ? ps.c_str() : 0, pixelShaderEntryPointName, psCompileTarget,
+		hasGS && gs.size() ? gs.c_str() : 0, geometryShaderEntryPointName, gsCompileTarget,
 		inType, outType, verticesOut,
 		callback, baseMaterial, userData);
-
-	if (psfile)
-		psfile->drop();
-
-	if (vsfile)
-		vsfile->drop();
-
-	if (gsfile)
-		gsfile->drop();
-
-	return result;
 }
 
 
@@ -1968,6 +3099,188 @@ s32 CNullDriver::addHighLevelShaderMaterialFromFiles(
 }
 
 
+//! Like IGPUProgrammingServices::addHighLevelShaderPermutationFromFiles() (look there for a detailed description)
+s32 CNullDriver::addHighLevelShaderPermutationFromFiles(
+		const io::path& vertexShaderProgramFileName,
+		const io::path& pixelShaderProgramFileName,
+		const c8* defines,
+		IShaderConstantSetCallBack* callback,
+		E_MATERIAL_TYPE baseMaterial,
+		s32 userData)
+{
+	core::stringc vs;
+	core::stringc ps;
+
+	if (vertexShaderProgramFileName.size() && !loadShaderSource(vertexShaderProgramFileName, vs))
+	{
+		os::Printer::log("Could not open vertex shader program file",
+			vertexShaderProgramFileName, ELL_WARNING);
+		return -1;
+	}
+
+	if (pixelShaderProgramFileName.size() && !loadShaderSource(pixelShaderProgramFileName, ps))
+	{
+		os::Printer::log("Could not open pixel shader program file",
+			pixelShaderProgramFileName, ELL_WARNING);
+		return -1;
+	}
+
+	if (defines && *defines)
+	{
+		if (vs.size())
+			insertShaderDefines(vs, defines);
+		if (ps.size())
+			insertShaderDefines(ps, defines);
+	}
+
+	// The callback, base material and user data belong to the material
+	// renderer owning the program, so they are part of the permutation
+	u64 key = 14695981039346656037ull;
+	key = hashShaderPermutation(key, vs.c_str(), vs.size() + 1);
+	key = hashShaderPermutation(key, ps.c_str(), ps.size() + 1);
+	key = hashShaderPermutation(key, &callback, sizeof(callback));
+	key = hashShaderPermutation(key, &baseMaterial, sizeof(baseMaterial));
+	key = hashShaderPermutation(key, &userData, sizeof(userData));
+
+	const auto found = ShaderPermutations.find(key);
+	if (found != ShaderPermutations.end())
+		return found->second;
+
+	const s32 materialType = addHighLevelShaderMaterial(
+		vs.size() ? vs.c_str() : 0, "main", EVST_VS_1_1,
+		ps.size() ? ps.c_str() : 0, "main", EPST_PS_1_1,
+		0, "main", EGST_GS_4_0,
+		scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0,
+		callback, baseMaterial, userData);
+
+	if (materialType >= 0)
+		ShaderPermutations[key] = materialType;
+
+	return materialType;
+}
+
+
+//! Reads a shader file with its #include lines resolved
+bool CNullDriver::loadShaderSource(const io::path& fileName, core::stringc& source)
+{
+	const core::stringc* content = getShaderFileSource(fileName);
+	if (!content)
+		return false;
+
+	source = *content;
+	core::array<io::path> included;
+	included.push_back(FileSystem->getAbsolutePath(fileName));
+	return resolveShaderIncludes(source, fileName, included);
+}
+
+
+//! Returns the content of a shader file from ShaderSources, reading it if it changed
+const core::stringc* CNullDriver::getShaderFileSource(const io::path& fileName)
+{
+	const io::path absolutePath = FileSystem->getAbsolutePath(fileName);
+	const core::atom key((core::stringc(absolutePath)));
+
+	u64 modificationTime;
+	u64 size;
+	getFileStatus(absolutePath, modificationTime, size);
+
+	const auto found = ShaderSources.find(key);
+	if (found != ShaderSources.end() && found->second.ModificationTime == modificationTime &&
+		found->second.Size == size)
+		return &found->second.Source;
+
+	io::IReadFile* file = FileSystem->createAndOpenFile(fileName);
+	if (!file)
+		return 0;
+
+	const long fileSize = file->getSize();
+	c8* data = new c8[fileSize+1];
+	const size_t read = file->read(data, fileSize);
+	data[read] = 0;
+	file->drop();
+
+	SShaderSourceFile& entry = ShaderSources[key];
+	entry.Source = data;
+	entry.ModificationTime = modificationTime;
+	entry.Size = size;
+	delete [] data;
+
+	return &entry.Source;
+}
+
+
+//! Replaces the #include lines of source, included holds the absolute paths of the files already included
+bool CNullDriver::resolveShaderIncludes(core::stringc& source, const io::path& fileName, core::array<io::path>& included)
+{
+	if (source.find("#include") < 0)
+		return true;
+
+	const io::path fileDir = FileSystem->getFileDir(fileName);
+	core::stringc result;
+	u32 lineStart = 0;
+	while (lineStart < source.size())
+	{
+		const s32 lineEnd = source.findNext('\n', lineStart);
+		const u32 lineLength = (lineEnd < 0 ? source.size() : (u32)lineEnd) - lineStart;
+
+		const c8* p = source.c_str() + lineStart;
+		while (*p == ' ' || *p == '\t')
+			++p;
+
+		if (strncmp(p, "#include", 8) != 0)
+		{
+			result.append(source.subString(lineStart, lineLength));
+		}
+		else
+		{
+			p += 8;
+			while (*p == ' ' || *p == '\t')
+				++p;
+
+			const c8 close = *p == '"' ? '"' : (*p == '<' ? '>' : 0);
+			const c8* nameEnd = p + 1;
+			while (close && *nameEnd && *nameEnd != close && *nameEnd != '\n')
+				++nameEnd;
+
+			if (!close || *nameEnd != close)
+			{
+				os::Printer::log("Malformed #include in shader file", fileName, ELL_ERROR);
+				return false;
+			}
+
+			io::path includeName(core::stringc(p + 1, (u32)(nameEnd - p - 1)));
+			if (fileDir != ".")
+				includeName = fileDir + "/" + includeName;
+
+			const io::path absolutePath = FileSystem->getAbsolutePath(includeName);
+			if (included.linear_search(absolutePath) < 0)
+			{
+				included.push_back(absolutePath);
+
+				const core::stringc* content = getShaderFileSource(includeName);
+				if (!content)
+				{
+					os::Printer::log("Could not open shader include file", includeName, ELL_ERROR);
+					return false;
+				}
+
+				core::stringc includeSource(*content);
+				if (!resolveShaderIncludes(includeSource, includeName, included))
+					return false;
+				result.append(includeSource);
+			}
+		}
+
+		if (lineEnd >= 0)
+			result.append('\n');
+		lineStart += lineLength + 1;
+	}
+
+	source = result;
+	return true;
+}
+
+
 //! Adds a new material renderer to the VideoDriver, using pixel and/or
 //! vertex shaders to render geometry.
 s32 CNullDriver::addShaderMaterial(const c8* vertexShaderProgram,
@@ -2089,6 +3402,13 @@ void CNullDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 }
 
 
+//! Sets if depth values get smaller with the distance from the camera
+void CNullDriver::setReverseDepth(bool reverse)
+{
+	ReverseDepth = reverse;
+}
+
+
 //! Returns a pointer to the mesh manipulator.
 scene::IMeshManipulator* CNullDriver::getMeshManipulator()
 {
@@ -2103,6 +3423,24 @@ IImage* CNullDriver::createScreenShot(video::ECOLOR_FORMAT format, video::E_REND
 }
 
 
+//! Returns a request holding a screenshot of the last rendered frame.
+IScreenShotRequest* CNullDriver::createScreenShotAsync(video::ECOLOR_FORMAT format, video::E_RENDER_TARGET target)
+{
+	IImage* image = createScreenShot(format, target);
+	if (!image)
+		return 0;
+
+	if (format == ECF_UNKNOWN)
+		format = ECF_A8R8G8B8;
+	if (!CColorConverter::canConvertFormat(image->getColorFormat(), format))
+		format = image->getColorFormat();
+
+	IScreenShotRequest* request = new CScreenShotRequest(format, image);
+	image->drop();
+	return request;
+}
+
+
 // prints renderer version
 void CNullDriver::printVersion()
 {
@@ -2115,7 +3453,7 @@ void CNullDriver::printVersion()
 //! creates a video driver
 IVideoDriver* createNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
 {
-	CNullDriver* nullDriver = new CNullDriver(io, screenSize);
+	CNullDriver* nullDriver = new CRecordingNullDriver(io, screenSize);
 
 	// create empty material renderers
 	for(u32 i=0; sBuiltInMaterialTypeNames[i]; ++i)
@@ -2163,6 +3501,12 @@ void CNullDriver::setMinHardwareBufferVertexCount(u32 count)
 }
 
 
+void CNullDriver::setHardwareBufferDeletionBudget(u32 count)
+{
+	HWBufferDeletionBudget = count;
+}
+
+
 SOverrideMaterial& CNullDriver::getOverrideMaterial()
 {
 	return OverrideMaterial;
@@ -2197,6 +3541,10 @@ bool CNullDriver::needsTransparentRenderPass(const irr::video::SMaterial& materi
 	//		Be careful - this function is deeply connected to getWriteZBuffer as transparent render passes are usually about rendering with
 	//      zwrite disabled and getWriteZBuffer calls this function.
 
+	// the coverage of the samples replaces blending, so the order doesn't matter
+	if (usesAlphaToCoverage(material))
+		return false;
+
 	video::IMaterialRenderer* rnd = getMaterialRenderer(material.MaterialType);
 	// TODO: I suspect IMaterialRenderer::isTransparent also often could use SMaterial as parameter
 	//       We could for example then get rid of IsTransparent function in SMaterial and move that to the software material renderer.
@@ -2207,6 +3555,23 @@ bool CNullDriver::needsTransparentRenderPass(const irr::video::SMaterial& materi
 }
 
 
+bool CNullDriver::canAccumulateTransparency(const SMaterial& material) const
+{
+	return false;
+}
+
+
+bool CNullDriver::beginTransparencyAccumulation()
+{
+	return false;
+}
+
+
+void CNullDriver::endTransparencyAccumulation()
+{
+}
+
+
 //! Color conversion convenience function
 /** Convert an image (as array of pixels) from source to destination
 array, thereby converting the color format. The pixel size is
@@ -10,15 +10,22 @@
 #include "IGPUProgrammingServices.h"
 #include "irrArray.h"
 #include "irrString.h"
+#include "irrAtom.h"
 #include "IAttributes.h"
 #include "IMesh.h"
 #include "IMeshBuffer.h"
 #include "IMeshSceneNode.h"
 #include "CFPSCounter.h"
+#include "IRenderCommand.h"
 #include "S3DVertex.h"
 #include "SVertexIndex.h"
 #include "SExposedVideoData.h"
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 namespace irr
 {
@@ -47,6 +54,39 @@ namespace video
 
 		bool endScene() override;
 
+		//! Sets how many vertical blanks the presentation of endScene() waits for
+		bool setSwapInterval(s32 interval) override;
+
+		//! Tells the driver which part of the screen the next frame changes
+		void setFrameDamage(const core::rect<s32>& rect) override;
+
+		//! Limits how many frames the GPU may lag behind endScene()
+		bool setMaxFramesInFlight(u32 frames) override;
+
+		//! Selects how the driver checks for errors of the graphics API
+		bool setErrorCheckMode(E_ERROR_CHECK_MODE mode) override;
+
+		//! Discards debug output below a log level
+		void setDebugMessageLevel(ELOG_LEVEL minLevel) override {}
+
+		//! Enables or disables a message of the debug output
+		void setDebugMessageEnabled(u32 id, bool enabled) override {}
+
+		//! Moves all work on the rendering context to a thread of the driver
+		bool setRenderThreadEnabled(bool enable) override;
+
+		//! Checks if the render thread runs
+		bool isRenderThreadEnabled() const override;
+
+		//! Records a command into the frame submitted by the next submitRenderCommands()
+		void queueRenderCommand(IRenderCommand* command) override;
+
+		//! Hands the recorded commands over to the render thread
+		void submitRenderCommands() override;
+
+		//! Waits until the render thread executed all submitted commands
+		void finishRenderCommands() override;
+
 		//! Disable a feature of the driver.
 		void disableFeature(E_VIDEO_DRIVER_FEATURE feature, bool flag=true) override;
 
@@ -80,6 +120,9 @@ namespace video
 		//! loads a Texture
 		ITexture* getTexture(io::IReadFile* file) override;
 
+		//! loads a Texture on the worker threads of the file system
+		ITexture* getTextureAsync(const io::path& filename) override;
+
 		//! Returns a texture by index
 		ITexture* getTextureByIndex(u32 index) override;
 
@@ -211,6 +254,15 @@ namespace video
 					const core::position2d<s32>& end,
 					SColor color=SColor(255,255,255,255)) override;
 
+		//! Starts recording 2d drawing, not supported by default
+		bool beginRecording2D(S2DDrawList& list) override;
+
+		//! Stops recording 2d drawing
+		bool endRecording2D() override;
+
+		//! Draws recorded 2d drawing again
+		bool drawRecording2D(const S2DDrawList& list) override;
+
 		//! Draws a pixel
 		[[deprecated]] virtual void drawPixel(u32 x, u32 y, const SColor & color) {}
 
@@ -234,7 +286,7 @@ namespace video
 		const core::dimension2d<u32>& getScreenSize() const override;
 
 		//! get current render target
-		IRenderTarget* getCurrentRenderTarget() const;
+		IRenderTarget* getCurrentRenderTarget() const override;
 
 		//! get render target size
 		const core::dimension2d<u32>& getCurrentRenderTargetSize() const override;
@@ -246,6 +298,49 @@ namespace video
 		//! very useful method for statistics.
 		u32 getPrimitiveCountDrawn( u32 param = 0 ) const override;
 
+		//! Returns the work done by the driver in the current frame.
+		const SFrameStats& getFrameStats() const override;
+
+		//! Records the submitted commands, only the null driver does
+		bool setCommandRecording(bool enable, io::IWriteFile* log = 0) override;
+
+		//! Needs SIrrlichtCreationParameters::FrameCapture, which puts a capturing driver in front
+		bool captureFrame(io::IWriteFile* file, bool payloads = true) override;
+
+		//! Loads a capture to replay on this driver
+		IFrameReplay* createFrameReplay(io::IReadFile* file) override;
+
+		//! Counters of the current frame, for driver internals like the cache handlers
+		SFrameStats& getFrameStatsCounters()
+		{
+			return FrameStats;
+		}
+
+		//! Number of frames finished by endScene
+		u32 getFrameCount() const override
+		{
+			return FrameCount;
+		}
+
+		//! Sets how many frames getFrameTimeStats() can look back on
+		void setFrameTimeHistory(u32 frames, f32 hitchMilliseconds = 50.f) override;
+
+		//! Returns the distribution of the frame times of the latest frames
+		SFrameTimeStats getFrameTimeStats(u32 frames = 0) const override;
+
+		//! True while textures are created from images only the driver references
+		/** Those textures may keep the images instead of copying them. */
+		bool areTextureImagesDisposable() const
+		{
+			return TextureImagesDisposable;
+		}
+
+		void setTextureMemoryBudget(u64 bytes) override;
+
+		const STextureResidencyStats& getTextureResidencyStats() const override;
+
+		bool restoreResources() override { return false; }
+
 		//! \return Returns the name of the video driver. Example: In case of the DIRECT3D8
 		//! driver, it would return "Direct3D8.1".
 		const wchar_t* getName() const override;
@@ -318,6 +413,9 @@ namespace video
 
 		core::array<IImage*> createImagesFromFile(io::IReadFile* file, E_TEXTURE_TYPE* type = 0) override;
 
+		//! Creates software images from several files on worker threads
+		core::array<IImage*> createImagesFromFiles(const core::array<io::IReadFile*>& files) override;
+
 		//! Creates a software image from a byte array.
 		/** \param useForeignMemory: If true, the image will use the data pointer
 		directly and own it from now on, which means it will also try to delete [] the
@@ -345,6 +443,18 @@ namespace video
 		//! Draws a mesh buffer
 		void drawMeshBuffer(const scene::IMeshBuffer* mb) override;
 
+		//! Draws several mesh buffers with the currently set material
+		void drawMeshBufferBatch(const scene::IMeshBuffer* const* mb,
+			const core::matrix4* worldMatrices, u32 count) override;
+
+		//! Draws several instances of a mesh buffer, one at a time
+		void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const S3DInstance* instances, u32 count) override;
+
+		//! Draws a mesh buffer without blending it towards the target
+		void drawMeshBufferMorphed(const scene::IMeshBuffer* mb,
+			const scene::IMeshBuffer* target, f32 blend) override;
+
 		//! Draws the normals of a mesh buffer
 		virtual void drawMeshBufferNormals(const scene::IMeshBuffer* mb, f32 length=10.f,
 			SColor color=0xffffffff) override;
@@ -356,27 +466,32 @@ namespace video
 		}
 
 	protected:
-		struct SHWBufferLink
+		//! Link of a mesh buffer to its hardware buffer
+		/** The link doesn't hold a reference to the mesh buffer. The mesh
+		buffer tells it when it is destroyed, and the link then waits in
+		HWBufferDeletionQueue until updateAllHardwareBuffers() deletes it. */
+		struct SHWBufferLink : public scene::IHardwareBufferLink
 		{
-			SHWBufferLink(const scene::IMeshBuffer *_MeshBuffer)
-				:MeshBuffer(_MeshBuffer),
+			SHWBufferLink(const scene::IMeshBuffer *_MeshBuffer, CNullDriver *driver)
+				:Driver(driver), MeshBuffer(_MeshBuffer),
 				ChangedID_Vertex(0),ChangedID_Index(0),
 				Mapped_Vertex(scene::EHM_NEVER),Mapped_Index(scene::EHM_NEVER)
 			{
-				if (MeshBuffer) {
-					MeshBuffer->grab();
-					MeshBuffer->setHWBuffer(reinterpret_cast<void*>(this));
-				}
+				if (MeshBuffer)
+					MeshBuffer->setHWBuffer(this);
 			}
 
 			virtual ~SHWBufferLink()
 			{
-				if (MeshBuffer) {
+				if (MeshBuffer)
 					MeshBuffer->setHWBuffer(NULL);
-					MeshBuffer->drop();
-				}
 			}
 
+			//! Queues the link for deletion, the mesh buffer is gone
+			void onMeshBufferDestroyed(const scene::IMeshBuffer* mb) override;
+
+			CNullDriver *Driver;
+			//! 0 once the mesh buffer was destroyed
 			const scene::IMeshBuffer *MeshBuffer;
 			u32 ChangedID_Vertex;
 			u32 ChangedID_Index;
@@ -407,7 +522,7 @@ namespace video
 		//! Remove all hardware buffers
 		void removeAllHardwareBuffers() override;
 
-		//! Update all hardware buffers, remove unused ones
+		//! Delete the hardware buffers of destroyed mesh buffers, up to the deletion budget
 		virtual void updateAllHardwareBuffers();
 
 		//! is vbo recommended on this mesh?
@@ -450,6 +565,15 @@ namespace video
 		actual value of pixels. */
 		u32 getOcclusionQueryResult(scene::ISceneNode* node) const override;
 
+		//! Starts a named GPU timer scope.
+		void beginGPUTimerScope(const c8* name) override;
+
+		//! Ends the GPU timer scope which was started last.
+		void endGPUTimerScope() override;
+
+		//! Return the GPU timer scopes of the latest frame with results.
+		const core::array<SGPUTimerResult>& getGPUTimerResults() const override;
+
 		//! Create render target.
 		IRenderTarget* addRenderTarget() override;
 
@@ -459,6 +583,17 @@ namespace video
 		//! Remove all render targets.
 		void removeAllRenderTargets() override;
 
+		ITexture* acquireTransientRenderTargetTexture(const core::dimension2d<u32>& size, ECOLOR_FORMAT format) override;
+
+		void releaseTransientRenderTargetTexture(ITexture* texture) override;
+
+		IRenderTarget* acquireTransientRenderTarget(const core::dimension2d<u32>& size,
+			ECOLOR_FORMAT colorFormat, ECOLOR_FORMAT depthFormat) override;
+
+		void releaseTransientRenderTarget(IRenderTarget* target) override;
+
+		IPostProcessChain* createPostProcessChain() override;
+
 		//! Only used by the engine internally.
 		/** Used to notify the driver that the window was resized. */
 		void OnResize(const core::dimension2d<u32>& size) override;
@@ -569,20 +704,50 @@ namespace video
 			E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID,
 			s32 userData = 0) override;
 
+		//! Like IGPUProgrammingServices::addHighLevelShaderPermutationFromFiles() (look there for a detailed description)
+		s32 addHighLevelShaderPermutationFromFiles(
+			const io::path& vertexShaderProgramFileName,
+			const io::path& pixelShaderProgramFileName,
+			const c8* defines,
+			IShaderConstantSetCallBack* callback = 0,
+			E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID,
+			s32 userData = 0) override;
+
 		//! Returns a pointer to the mesh manipulator.
 		scene::IMeshManipulator* getMeshManipulator() override;
 
 		void clearBuffers(u16 flag, SColor color = SColor(255,0,0,0), f32 depth = 1.f, u8 stencil = 0) override;
 
+		//! Sets if depth values get smaller with the distance from the camera
+		void setReverseDepth(bool reverse) override;
+
+		//! Checks if depth values get smaller with the distance from the camera
+		bool isReverseDepth() const override { return ReverseDepth; }
+
 		//! Returns an image created from the last rendered frame.
 		IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override;
 
+		//! Wraps a synchronous createScreenShot() into a request which is ready right away
+		IScreenShotRequest* createScreenShotAsync(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override;
+
+		//! Starts reading a texture of this driver without waiting for the GPU
+		/** Used by ITexture::lock() with ETLF_ASYNC_READ. Like for screenshots,
+		the image created by the request has the rows in reverse order
+		compared to OpenGL, so render target textures have a left-top origin.
+		\return Request in the color format of the texture, or 0 if the
+		texture has to be read synchronously. */
+		virtual IScreenShotRequest* createTextureReadbackAsync(ITexture* texture, u32 mipmapLevel, u32 layer) { return 0; }
+
 		//! Writes the provided image to disk file
 		bool writeImageToFile(IImage* image, const io::path& filename, u32 param = 0) override;
 
 		//! Writes the provided image to a file.
 		bool writeImageToFile(IImage* image, io::IWriteFile * file, u32 param = 0) override;
 
+		//! Writes an image to a file on ImageWriteThread
+		bool writeImageToFileAsync(IImage* image, const io::path& filename, u32 param = 0,
+			IImageWriteCallback* callback = 0) override;
+
 		//! Sets the name of a material renderer.
 		void setMaterialRendererName(u32 idx, const char* name) override;
 
@@ -612,6 +777,9 @@ namespace video
 		/** \param count Number of vertices to set as minimum. */
 		void setMinHardwareBufferVertexCount(u32 count) override;
 
+		//! Set how many hardware buffers of destroyed mesh buffers are released per frame
+		void setHardwareBufferDeletionBudget(u32 count) override;
+
 		//! Get the global Material, which might override local materials.
 		/** Depending on the enable flags, values from this Material
 		are used to override those of local materials of some
@@ -634,6 +802,24 @@ namespace video
 		//! Used by some SceneNodes to check if a material should be rendered in the transparent render pass
 		bool needsTransparentRenderPass(const irr::video::SMaterial& material) const override;
 
+		//! Checks if a material can be drawn between beginTransparencyAccumulation() and endTransparencyAccumulation()
+		bool canAccumulateTransparency(const SMaterial& material) const override;
+
+		//! Starts accumulating transparent materials independent of the order they are drawn in
+		bool beginTransparencyAccumulation() override;
+
+		//! Blends the accumulated transparent materials over the current render target
+		void endTransparencyAccumulation() override;
+
+		//! Returns if alpha to coverage replaces the blending and the alpha test of a material
+		/** True for alpha channel materials with EAAM_ALPHA_TO_COVERAGE drawn
+		into a multisampled render target, which are drawn in the solid pass. */
+		inline bool usesAlphaToCoverage(const SMaterial& material) const
+		{
+			return RenderTargetMultisampled && (material.AntiAliasing & EAAM_ALPHA_TO_COVERAGE) &&
+				(material.MaterialType == EMT_TRANSPARENT_ALPHA_CHANNEL || material.MaterialType == EMT_TRANSPARENT_ALPHA_CHANNEL_REF);
+		}
+
 		//! Color conversion convenience function
 		/** Convert an image (as array of pixels) from source to destination
 		array, thereby converting the color format. The pixel size is
@@ -657,6 +843,9 @@ namespace video
 		//! deletes all textures
 		void deleteAllTextures();
 
+		//! removes a texture from TextureIndex, another one of the same name takes its place
+		void unindexTexture(ITexture* texture);
+
 		//! opens the file and loads it into the surface
 		ITexture* loadTextureFromFile(io::IReadFile* file, const io::path& hashName = "");
 
@@ -667,6 +856,59 @@ namespace video
 
 		virtual ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image);
 
+		//! Gives a placeholder of getTextureAsync() the loaded images
+		/** Only called by drivers supporting EVDF_ASYNC_TEXTURE_LOADING.
+		\param texture Texture created by createDeviceDependentTexture(),
+		which keeps its address.
+		\param images One image for ETT_2D, six for ETT_CUBEMAP.
+		\return False if the texture couldn't be created from the images. */
+		virtual bool replaceTexture(ITexture* texture, const core::array<IImage*>& images, E_TEXTURE_TYPE type);
+
+		//! Hands the textures decoded for getTextureAsync() to replaceTexture()
+		void updateTextureLoads();
+
+		//! Records the time since swapBeginNs as present time of the frame endScene() finished
+		void registerSwapTime(u64 swapBeginNs);
+
+		//! Sets DamageRegion for a frame drawn into a back buffer of the given age
+		/** \return True if only DamageRegion has to be drawn, see setFrameDamage(). */
+		bool beginFrameDamage(s32 bufferAge);
+
+		//! Remembers the damage of the presented frame for the next ones
+		void endFrameDamage();
+
+		//! Gets the scissor rectangle for drawing with an optional clipping rectangle
+		/** Drawing to the screen is clipped to DamageRegion while it is active.
+		\return False if the scissor test has to be disabled. */
+		bool getScissorRect(const core::rect<s32>* clipRect, core::rect<s32>& rect) const;
+
+		//! Waits for the files of getTextureAsync() and drops the loads
+		void cancelTextureLoads();
+
+		//! Makes the rendering context current on the calling thread, or releases it
+		/** Drivers supporting EVDF_RENDER_THREAD move their context with it. */
+		virtual bool setContextCurrent(bool current) { return true; }
+
+		//! Executes the submitted commands, runs on RenderThread
+		void renderThreadLoop();
+
+		//! Queues a resize reported on another thread than the render thread
+		/** \return True if the resize is left to the render thread. */
+		bool queueResize(const core::dimension2d<u32>& size);
+
+		//! Writes the images queued by writeImageToFileAsync(), runs on ImageWriteThread
+		void imageWriteLoop();
+
+		//! Tells the callbacks of writeImageToFileAsync() about the written images
+		void updateImageWrites();
+
+		//! Waits until all queued images are written, without calling the callbacks
+		void finishImageWrites();
+
+		//! Returns if textures loaded now get their mipmaps on the CPU
+		/** \param flags Receives the E_MIP_MAP_FLAGS for IImage::createMipMaps(). */
+		bool getCPUMipMapFlags(u32& flags) const;
+
 		//! checks triangle count and print warning if wrong
 		bool checkPrimitiveCount(u32 prmcnt) const;
 
@@ -678,6 +920,15 @@ namespace video
 		//! deletes all material renderers
 		void deleteMaterialRenders();
 
+		//! Reads a shader file with its #include lines resolved
+		bool loadShaderSource(const io::path& fileName, core::stringc& source);
+
+		//! Returns the content of a shader file from ShaderSources, reading it if it changed
+		const core::stringc* getShaderFileSource(const io::path& fileName);
+
+		//! Replaces the #include lines of source, included holds the absolute paths of the files already included
+		bool resolveShaderIncludes(core::stringc& source, const io::path& fileName, core::array<io::path>& included);
+
 		// prints renderer version
 		void printVersion();
 
@@ -695,6 +946,33 @@ namespace video
 			return true; // never should get here, but some compilers don't know and complain
 		}
 
+		//! The comparison of SMaterial::ZBuffer, with less and greater swapped for reverse depth
+		inline u8 getDepthComparison(const SMaterial& material) const
+		{
+			if (!ReverseDepth)
+				return material.ZBuffer;
+
+			switch (material.ZBuffer)
+			{
+				case ECFN_LESSEQUAL:
+					return ECFN_GREATEREQUAL;
+				case ECFN_LESS:
+					return ECFN_GREATER;
+				case ECFN_GREATEREQUAL:
+					return ECFN_LESSEQUAL;
+				case ECFN_GREATER:
+					return ECFN_LESS;
+				default:
+					return material.ZBuffer;
+			}
+		}
+
+		//! The depth buffer value to clear to, mirrored for reverse depth
+		inline f32 getClearDepth(f32 depth) const
+		{
+			return ReverseDepth ? 1.f - depth : depth;
+		}
+
 		struct SSurface
 		{
 			video::ITexture* Surface;
@@ -723,6 +1001,101 @@ namespace video
 		};
 		core::array<SSurface> Textures;
 
+		//! The first texture of each internal name in Textures, for findTexture()
+		std::unordered_map<core::atom, ITexture*> TextureIndex;
+
+		//! A shader file read by addHighLevelShaderMaterialFromFiles()
+		struct SShaderSourceFile
+		{
+			core::stringc Source;
+			u64 ModificationTime;
+			u64 Size;
+		};
+
+		//! Shader files by their absolute path
+		std::unordered_map<core::atom, SShaderSourceFile> ShaderSources;
+
+		//! Material types of addHighLevelShaderPermutationFromFiles() by a hash of the sources and parameters
+		std::unordered_map<u64, s32> ShaderPermutations;
+
+		//! A texture of getTextureAsync() whose file is loaded and decoded on worker threads
+		struct STextureLoad : public io::IFilePrefetchCallback
+		{
+			//! Grabs the texture and the image loaders
+			STextureLoad(ITexture* texture, const core::array<IImageLoader*>& loaders);
+
+			//! Drops everything, the request has to be ready
+			~STextureLoad();
+
+			//! Decodes the file with Loaders, on a worker thread
+			void OnFilePrefetched(io::IFilePrefetchRequest* request, u32 index, io::IReadFile* file) override;
+
+			ITexture* Texture;
+			io::IFilePrefetchRequest* Request;
+
+			//! copy of the loaders of the driver, which may get new ones meanwhile
+			core::array<IImageLoader*> Loaders;
+
+			//! decoded images, only valid once Request is ready
+			core::array<IImage*> Images;
+			E_TEXTURE_TYPE Type;
+
+			//! set if the images get their mipmaps on the loading thread, see getCPUMipMapFlags()
+			bool CPUMipMaps;
+			u32 MipMapFlags;
+
+			//! images larger than the driver supports may be decoded at a reduced size
+			core::dimension2du MaxTextureSize;
+		};
+		core::array<STextureLoad*> TextureLoads;
+
+		//! An image of writeImageToFileAsync()
+		/** Everything is grabbed and dropped on the thread using the driver,
+		the reference counts aren't thread safe. */
+		struct SImageWrite
+		{
+			IImage* Image;
+			IImageWriter* Writer;
+			io::IWriteFile* File;
+			u32 Param;
+			IImageWriteCallback* Callback;
+			bool Written;
+		};
+		std::thread ImageWriteThread;
+		//! guards ImageWriteQueue, ImageWritesDone and ImageWriteQuit
+		std::mutex ImageWriteMutex;
+		std::condition_variable ImageWriteWake;
+		std::deque<SImageWrite> ImageWriteQueue;
+		core::array<SImageWrite> ImageWritesDone;
+		bool ImageWriteQuit;
+
+		//! Passes a window resize on to the render thread
+		struct SResizeCommand : public IRenderCommand
+		{
+			core::dimension2d<u32> Size;
+
+			void execute(IVideoDriver* driver) override
+			{
+				driver->OnResize(Size);
+			}
+		};
+
+		std::thread RenderThread;
+		//! Commands recorded by the application, only used by its thread
+		core::array<IRenderCommand*> RecordedCommands;
+		//! Commands of the submitted frame, used by RenderThread while RenderFrameSubmitted
+		core::array<IRenderCommand*> SubmittedCommands;
+		//! guards RenderFrameSubmitted and RenderThreadQuit
+		std::mutex RenderThreadMutex;
+		std::condition_variable RenderThreadWake;
+		std::condition_variable RenderFrameDone;
+		bool RenderFrameSubmitted;
+		bool RenderThreadQuit;
+		//! One per recorded and submitted frame, so the recorded one is never executing
+		SResizeCommand ResizeCommands[2];
+		u32 SubmittedFrames;
+		bool ResizeQueued;
+
 		struct SOccQuery
 		{
 			SOccQuery(scene::ISceneNode* node, const scene::IMesh* mesh=0) : Node(node), Mesh(mesh), PID(0), Result(0xffffffff), Run(0xffffffff)
@@ -786,6 +1159,29 @@ namespace video
 		IRenderTarget* SharedRenderTarget;
 		core::array<ITexture*> SharedDepthTextures;
 
+		//! Pool of acquireTransientRenderTargetTexture()
+		struct STransientTexture
+		{
+			ITexture* Texture;
+			bool InUse;
+		};
+		core::array<STransientTexture> TransientTextures;
+
+		//! Pool of acquireTransientRenderTarget(), the textures stay attached
+		struct STransientTarget
+		{
+			IRenderTarget* Target;
+			ITexture* Color;
+			ITexture* Depth;
+			bool InUse;
+			//! Frame of the last release, free targets unused for long are removed
+			u32 ReleaseFrame;
+		};
+		core::array<STransientTarget> TransientTargets;
+
+		//! Removes a target of the pool with its textures
+		void removeTransientTarget(u32 index);
+
 		IRenderTarget* CurrentRenderTarget;
 		core::dimension2d<u32> CurrentRenderTargetSize;
 
@@ -794,6 +1190,8 @@ namespace video
 		core::array<SMaterialRenderer> MaterialRenderers;
 
 		std::list<SHWBufferLink*> HWBufferList;
+		//! Links whose mesh buffer was destroyed, oldest first
+		core::array<SHWBufferLink*> HWBufferDeletionQueue;
 
 		io::IFileSystem* FileSystem;
 
@@ -808,6 +1206,7 @@ namespace video
 
 		u32 PrimitivesDrawn;
 		u32 MinVertexCountForVBO;
+		u32 HWBufferDeletionBudget;
 
 		u32 TextureCreationFlags;
 
@@ -828,10 +1227,52 @@ namespace video
 		bool PixelFog;
 		bool RangeFog;
 		bool AllowZWriteOnTransparent;
+		bool ReverseDepth;
+		//! Set by drivers supporting alpha to coverage if the current render target has multiple samples
+		bool RenderTargetMultisampled;
 
 		bool FeatureEnabled[video::EVDF_COUNT];
 
 		SColorf AmbientLight;
+
+		core::array<SGPUTimerResult> GPUTimerResults;
+
+		SFrameStats FrameStats;
+		u32 FrameCount;
+
+		//! real times in nanoseconds of the last beginScene and endScene for the frame time history
+		u64 FrameBeginNs;
+		u64 LastFrameEndNs;
+
+		//! see setFrameDamage()
+		core::rect<s32> FrameDamage;
+		bool FrameDamageSet;
+		//! part of the screen drawn in the current frame, if DamageRegionActive
+		core::rect<s32> DamageRegion;
+		bool DamageRegionActive;
+		//! damage of the previously presented frames, the last one first
+		enum { DAMAGE_HISTORY_SIZE = 4 };
+		core::rect<s32> DamageHistory[DAMAGE_HISTORY_SIZE];
+		u32 DamageHistoryCount;
+
+		//! see areTextureImagesDisposable()
+		bool TextureImagesDisposable;
+
+		//! If endScene() waits for the results of the occlusion queries
+		/** Only for drivers which don't restart a query before its result
+		arrived, otherwise results would get lost. */
+		bool BlockOnOcclusionQueries;
+
+		mutable STextureResidencyStats TextureResidencyStats;
+
+		//! Counts an upload into a GPU buffer
+		/** \param reallocated True if the storage of the buffer was (re)created for it */
+		void countBufferUpload(u32 bytes, bool reallocated)
+		{
+			FrameStats.BufferBytesUploaded += bytes;
+			if (reallocated)
+				++FrameStats.BufferReallocations;
+		}
 	};
 
 } // end namespace video
@@ -9,10 +9,12 @@
 #include "SMeshBuffer.h"
 #include "SAnimatedMesh.h"
 #include "IReadFile.h"
+#include "CReadFile.h"
 #include "IAttributes.h"
 #include "fast_atof.h"
 #include "coreutil.h"
 #include "os.h"
+#include "CJobSystem.h"
 
 namespace irr
 {
@@ -23,9 +25,47 @@ namespace scene
 #define _IRR_DEBUG_OBJ_LOADER_
 #endif
 
+namespace
+{
+
+//! Smaller files are parsed on one thread, even if OBJ_LOADER_PARALLEL_PARSE is set
+const long PARALLEL_PARSE_MIN_SIZE = 1 << 20;
+
+//! Converts an index of the file to a 0-based one, -1 if it is missing or out of range
+/** \param count Number of elements before the statement, negative indices are relative to it */
+s32 resolveIndex(s32 index, u32 count)
+{
+	if (index > 0)
+		index -= 1;
+	else if (index < 0)
+		index += (s32)count;
+	else
+		return -1;
+
+	return (index >= 0 && (u32)index < count) ? index : -1;
+}
+
+//! Appends the elements of one array to another, or takes them if the other is empty
+template <class T>
+void appendArray(core::array<T>& to, core::array<T>& from)
+{
+	if (to.size() == 0)
+	{
+		to.swap(from);
+		return;
+	}
+
+	to.reallocate(to.size() + from.size(), false);
+	for (u32 i=0; i<from.size(); ++i)
+		to.push_back(from[i]);
+}
+
+} // end anonymous namespace
+
 //! Constructor
 COBJMeshFileLoader::COBJMeshFileLoader(scene::ISceneManager* smgr)
-: SceneManager(smgr)
+: SceneManager(smgr), CurrMtl(0), MtlChanged(false), UseGroups(true),
+	UseMaterials(true), LoadTextures(false), DegeneratedFaces(0), Jobs(0)
 {
 	#ifdef _DEBUG
 	setDebugName("COBJMeshFileLoader");
@@ -36,6 +76,7 @@ COBJMeshFileLoader::COBJMeshFileLoader(scene::ISceneManager* smgr)
 //! destructor
 COBJMeshFileLoader::~COBJMeshFileLoader()
 {
+	delete Jobs;
 }
 
 
@@ -60,277 +101,422 @@ IAnimatedMesh* COBJMeshFileLoader::createMesh(io::IReadFile* file)
 	if (!filesize)
 		return 0;
 
-	const u32 WORD_BUFFER_LENGTH = 512;
-
-	core::array<core::vector3df> vertexBuffer(1000);
-	core::array<core::vector3df> normalsBuffer(1000);
-	core::array<core::vector2df> textureCoordBuffer(1000);
-
-	SObjMtl * currMtl = new SObjMtl();
-	Materials.push_back(currMtl);
-	u32 smoothingGroup=0;
+	CurrMtl = new SObjMtl();
+	Materials.push_back(CurrMtl);
 
 	const io::path fullName = file->getFileName();
 
-	c8* buf = new c8[filesize];
-	memset(buf, 0, filesize);
-	file->read((void*)buf, filesize);
-	const c8* const bufEnd = buf+filesize;
-
-	// Process obj information
-	const c8* bufPtr = buf;
-	core::stringc grpName, mtlName;
-	bool mtlChanged=false;
-	bool useGroups = !SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_GROUPS);
-	bool useMaterials = !SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_MATERIAL_FILES);
-	irr::u32 lineNr = 1;	// only counts non-empty lines, still useful in debugging to locate errors
-	core::array<int> faceCorners;
-	faceCorners.reallocate(32); // should be large enough
-	const core::stringc TAG_OFF = "off";
-	irr::u32 degeneratedFaces = 0;
+	// the zero after the contents stops the number parsers at the end of the file
+	c8* buf = new c8[filesize+1];
+	const size_t readsize = file->read((void*)buf, filesize);
+	buf[readsize] = 0;
+	const c8* const bufEnd = buf+readsize;
+
+	GrpName = "";
+	MtlName = "";
+	MtlChanged = false;
+	UseGroups = !SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_GROUPS);
+	UseMaterials = !SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_IGNORE_MATERIAL_FILES);
+	LoadTextures = SceneManager->getParameters()->getAttributeAsBool(MESH_LOADER_TEXTURES);
+	FileDir = fullName.subString(0, fullName.findLast('/') + 1);
+	FaceCorners.reallocate(32); // should be large enough
+	DegeneratedFaces = 0;
+
+	// large files are split into one part per thread
+	u32 chunkCount = 1;
+	if (filesize >= PARALLEL_PARSE_MIN_SIZE && SceneManager->getParameters()->getAttributeAsBool(OBJ_LOADER_PARALLEL_PARSE))
+	{
+		if (!Jobs)
+		{
+			const u32 cores = std::thread::hardware_concurrency();
+			Jobs = new CJobSystem(cores > 1 ? cores - 1 : 1);
+		}
+		chunkCount = Jobs->getThreadCount() + 1;
+	}
 
-	while(bufPtr != bufEnd)
+	core::array<SObjChunk> chunks;
+	chunks.set_used(chunkCount);
+	const c8* chunkBegin = buf;
+	for (u32 i=0; i<chunkCount; ++i)
 	{
-		switch(bufPtr[0])
+		const c8* chunkEnd = bufEnd;
+		if (i+1 < chunkCount)
 		{
-		case 'm':	// mtllib (material)
+			chunkEnd = core::max_<const c8*>(buf + (size_t)((u64)readsize*(i+1)/chunkCount), chunkBegin);
+			while (chunkEnd != bufEnd && *chunkEnd != '\n' && *chunkEnd != '\r')
+				++chunkEnd;
+			if (chunkEnd != bufEnd)
+				++chunkEnd;
+		}
+
+		chunks[i].Loader = this;
+		chunks[i].Begin = chunkBegin;
+		chunks[i].End = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	for (u32 i=1; i<chunkCount; ++i)
+		Jobs->add(parseChunkJob, &chunks[i]);
+	parseChunk(chunks[0]);
+	if (chunkCount > 1)
+		Jobs->wait();
+
+	// the statements are applied in file order, with the vertex data of all parts before them
+	bool ok = true;
+	for (u32 i=0; i<chunkCount && ok; ++i)
+	{
+		SObjChunk& chunk = chunks[i];
+		const u32 vertexBase = VertexBuffer.size();
+		const u32 textureCoordBase = TextureCoordBuffer.size();
+		const u32 normalBase = NormalsBuffer.size();
+		appendArray(VertexBuffer, chunk.Vertices);
+		appendArray(TextureCoordBuffer, chunk.TextureCoords);
+		appendArray(NormalsBuffer, chunk.Normals);
+
+		for (u32 s=0; s<chunk.Statements.size() && ok; ++s)
 		{
-			if (useMaterials)
+			const SObjStatement& statement = chunk.Statements[s];
+			if ('f' == statement.Line[0])
 			{
-				c8 name[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(name, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-#ifdef _IRR_DEBUG_OBJ_LOADER_
-				os::Printer::log("Reading material file",name);
-#endif
+				ok = addFace(chunk.Corners.const_pointer() + statement.FirstCorner, statement.CornerCount,
+					vertexBase + statement.VertexCount, textureCoordBase + statement.TextureCoordCount,
+					normalBase + statement.NormalCount, statement.Line, bufEnd);
 			}
+			else
+				readStatement(statement.Line, bufEnd);
 		}
-			break;
+	}
+
+	// Clean up the allocate obj file contents
+	delete [] buf;
+
+	if (!ok)
+	{
+		cleanUp();
+		return 0;
+	}
 
+	if ( DegeneratedFaces > 0 )
+	{
+		irr::core::stringc log(DegeneratedFaces);
+		log += " degenerated faces removed in ";
+		log += irr::core::stringc(fullName);
+		os::Printer::log(log.c_str(), ELL_INFORMATION);
+	}
+
+	SMesh* mesh = new SMesh();
+
+	// Combine all the groups (meshbuffers) into the mesh
+	for ( u32 m = 0; m < Materials.size(); ++m )
+	{
+		if ( Materials[m]->Meshbuffer->getIndexCount() > 0 )
+		{
+			Materials[m]->Meshbuffer->recalculateBoundingBox();
+			if (Materials[m]->RecalculateNormals)
+				SceneManager->getMeshManipulator()->recalculateNormals(Materials[m]->Meshbuffer);
+			mesh->addMeshBuffer( Materials[m]->Meshbuffer );
+		}
+	}
+
+	// Create the Animated mesh if there's anything in the mesh
+	SAnimatedMesh* animMesh = 0;
+	if ( 0 != mesh->getMeshBufferCount() )
+	{
+		mesh->recalculateBoundingBox();
+		animMesh = new SAnimatedMesh();
+		animMesh->Type = EAMT_OBJ;
+		animMesh->addMesh(mesh);
+		animMesh->recalculateBoundingBox();
+	}
+
+	// more cleaning up
+	cleanUp();
+	mesh->drop();
+
+	return animMesh;
+}
+
+
+//! Reads the vertex data and the statements of a part of the file
+void COBJMeshFileLoader::parseChunk(SObjChunk& chunk)
+{
+	const c8* bufPtr = goFirstWord(chunk.Begin, chunk.End);
+	while(bufPtr != chunk.End)
+	{
+		switch(bufPtr[0])
+		{
 		case 'v':               // v, vn, vt
 			switch(bufPtr[1])
 			{
 			case ' ':          // vertex
 				{
 					core::vector3df vec;
-					bufPtr = readVec3(bufPtr, vec, bufEnd);
-					vertexBuffer.push_back(vec);
+					bufPtr = readVec3(bufPtr, vec, chunk.End);
+					chunk.Vertices.push_back(vec);
 				}
 				break;
 
 			case 'n':       // normal
 				{
 					core::vector3df vec;
-					bufPtr = readVec3(bufPtr, vec, bufEnd);
-					normalsBuffer.push_back(vec);
+					bufPtr = readVec3(bufPtr, vec, chunk.End);
+					chunk.Normals.push_back(vec);
 				}
 				break;
 
 			case 't':       // texcoord
 				{
 					core::vector2df vec;
-					bufPtr = readUV(bufPtr, vec, bufEnd);
-					textureCoordBuffer.push_back(vec);
+					bufPtr = readUV(bufPtr, vec, chunk.End);
+					chunk.TextureCoords.push_back(vec);
 				}
 				break;
 			}
 			break;
 
-		case 'g': // group name
+		case 'f':               // face
+		case 'm':               // mtllib (material)
+		case 'g':               // group name
+		case 's':               // smoothing group
+		case 'u':               // usemtl
 			{
-				c8 grp[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(grp, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				SObjStatement statement;
+				statement.Line = bufPtr;
+				statement.FirstCorner = chunk.Corners.size();
+				statement.VertexCount = chunk.Vertices.size();
+				statement.TextureCoordCount = chunk.TextureCoords.size();
+				statement.NormalCount = chunk.Normals.size();
+				if ('f' == bufPtr[0])
+					bufPtr = readFace(bufPtr, chunk.Corners, chunk.End);
+				statement.CornerCount = (chunk.Corners.size() - statement.FirstCorner) / 3;
+				chunk.Statements.push_back(statement);
+			}
+			break;
+
+		case '#': // comment
+		default:
+			break;
+		}	// end switch(bufPtr[0])
+		// eat up rest of line
+		bufPtr = goNextLine(bufPtr, chunk.End);
+	}
+}
+
+
+void COBJMeshFileLoader::parseChunkJob(void* data)
+{
+	SObjChunk* chunk = (SObjChunk*)data;
+	chunk->Loader->parseChunk(*chunk);
+}
+
+
+//! Applies a group, smoothing, material or material library statement
+void COBJMeshFileLoader::readStatement(const c8* bufPtr, const c8* const bufEnd)
+{
+	const u32 WORD_BUFFER_LENGTH = 512;
+	const core::stringc TAG_OFF = "off";
+
+	switch(bufPtr[0])
+	{
+	case 'm':	// mtllib (material)
+	{
+		if (UseMaterials)
+		{
+			c8 name[WORD_BUFFER_LENGTH];
+			bufPtr = goAndCopyNextWord(name, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+#ifdef _IRR_DEBUG_OBJ_LOADER_
+			os::Printer::log("Reading material file",name);
+#endif
+			if (LoadTextures)
+				readMTL(name);
+		}
+	}
+		break;
+
+	case 'g': // group name
+		{
+			c8 grp[WORD_BUFFER_LENGTH];
+			bufPtr = goAndCopyNextWord(grp, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
 #ifdef _IRR_DEBUG_OBJ_LOADER_
 	os::Printer::log("Loaded group start",grp, ELL_DEBUG);
 #endif
-				if (useGroups)
-				{
-					if (0 != grp[0])
-						grpName = grp;
-					else
-						grpName = "default";
-				}
-				mtlChanged=true;
+			if (UseGroups)
+			{
+				if (0 != grp[0])
+					GrpName = grp;
+				else
+					GrpName = "default";
 			}
-			break;
+			MtlChanged=true;
+		}
+		break;
 
-		case 's': // smoothing can be a group or off (equiv. to 0)
-			{
-				c8 smooth[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(smooth, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+	case 's': // smoothing can be a group or off (equiv. to 0)
+		{
+			c8 smooth[WORD_BUFFER_LENGTH];
+			bufPtr = goAndCopyNextWord(smooth, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
 #ifdef _IRR_DEBUG_OBJ_LOADER_
 	os::Printer::log("Loaded smoothing group start",smooth, ELL_DEBUG);
 #endif
-				if (TAG_OFF==smooth)
-					smoothingGroup=0;
-				else
-					smoothingGroup=core::strtoul10(smooth);
+			u32 smoothingGroup;
+			if (TAG_OFF==smooth)
+				smoothingGroup=0;
+			else
+				smoothingGroup=core::strtoul10(smooth);
 
-				(void)smoothingGroup; // disable unused variable warnings
-			}
-			break;
+			(void)smoothingGroup; // disable unused variable warnings
+		}
+		break;
 
-		case 'u': // usemtl
-			// get name of material
-			{
-				c8 matName[WORD_BUFFER_LENGTH];
-				bufPtr = goAndCopyNextWord(matName, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+	case 'u': // usemtl
+		// get name of material
+		{
+			c8 matName[WORD_BUFFER_LENGTH];
+			bufPtr = goAndCopyNextWord(matName, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
 #ifdef _IRR_DEBUG_OBJ_LOADER_
 	os::Printer::log("Loaded material start",matName, ELL_DEBUG);
 #endif
-				mtlName=matName;
-				mtlChanged=true;
-			}
-			break;
+			MtlName=matName;
+			MtlChanged=true;
+		}
+		break;
+	}
+}
 
-		case 'f':               // face
+
+//! Reads the indices of a face statement into corners, 0 for missing ones
+const c8* COBJMeshFileLoader::readFace(const c8* bufPtr, core::array<s32>& corners, const c8* const bufEnd)
+{
+	bufPtr = goNextWord(bufPtr, bufEnd, false);
+	while (bufPtr != bufEnd && *bufPtr != '\n' && *bufPtr != '\r')
+	{
+		// position/texcoord/normal, each of them may be missing
+		s32 idx[3] = {0, 0, 0};
+		u32 idxType = 0;
+		while (bufPtr != bufEnd && !core::isspace(*bufPtr))
 		{
-			c8 vertexWord[WORD_BUFFER_LENGTH]; // for retrieving vertex data
-			video::S3DVertex v;
-			// Assign vertex color from currently active material's diffuse color
-			if (mtlChanged)
+			if (*bufPtr == '/')
 			{
-				// retrieve the material
-				SObjMtl *useMtl = findMtl(mtlName, grpName);
-				// only change material if we found it
-				if (useMtl)
-					currMtl = useMtl;
-				mtlChanged=false;
+				// error checking, shouldn't reach here unless file is wrong
+				if ( ++idxType > 2 )
+					idxType = 0;
+				++bufPtr;
 			}
-			if (currMtl)
-				v.Color = currMtl->Meshbuffer->Material.DiffuseColor;
+			else if (core::isdigit(*bufPtr) || *bufPtr == '-')
+				idx[idxType] = core::strtol10(bufPtr, &bufPtr);
+			else
+				++bufPtr;
+		}
 
-			// get all vertices data in this face (current line of obj file)
-			const core::stringc wordBuffer = copyLine(bufPtr, bufEnd);
-			const c8* linePtr = wordBuffer.c_str();
-			const c8* const endPtr = linePtr+wordBuffer.size();
+		corners.push_back(idx[0]);
+		corners.push_back(idx[1]);
+		corners.push_back(idx[2]);
+		bufPtr = goFirstWord(bufPtr, bufEnd, false);
+	}
+	return bufPtr;
+}
 
-			faceCorners.set_used(0); // fast clear
 
-			// read in all vertices
-			linePtr = goNextWord(linePtr, endPtr);
-			while (0 != linePtr[0])
-			{
-				// Array to communicate with retrieveVertexIndices()
-				// sends the buffer sizes and gets the actual indices
-				// if index not set returns -1
-				s32 Idx[3];
-				Idx[0] = Idx[1] = Idx[2] = -1;
-
-				// read in next vertex's data
-				u32 wlength = copyWord(vertexWord, linePtr, WORD_BUFFER_LENGTH, endPtr);
-				// this function will also convert obj's 1-based index to c++'s 0-based index
-				retrieveVertexIndices(vertexWord, Idx, vertexWord+wlength+1, vertexBuffer.size(), textureCoordBuffer.size(), normalsBuffer.size());
-				if ( -1 != Idx[0] && Idx[0] < (irr::s32)vertexBuffer.size() )
-					v.Pos = vertexBuffer[Idx[0]];
-				else
-				{
-					os::Printer::log("Invalid vertex index in this line", wordBuffer.c_str(), ELL_ERROR);
-					delete [] buf;
-					return 0;
-				}
-				if ( -1 != Idx[1] && Idx[1] < (irr::s32)textureCoordBuffer.size() )
-					v.TCoords = textureCoordBuffer[Idx[1]];
-				else
-					v.TCoords.set(0.0f,0.0f);
-				if ( -1 != Idx[2] && Idx[2] < (irr::s32)normalsBuffer.size() )
-					v.Normal = normalsBuffer[Idx[2]];
-				else
-				{
-					v.Normal.set(0.0f,0.0f,0.0f);
-					currMtl->RecalculateNormals=true;
-				}
+//! Adds a face to the current material
+bool COBJMeshFileLoader::addFace(const s32* corners, u32 cornerCount, u32 vertexCount, u32 textureCoordCount,
+		u32 normalCount, const c8* line, const c8* const bufEnd)
+{
+	video::S3DVertex v;
+	// Assign vertex color from currently active material's diffuse color
+	if (MtlChanged)
+	{
+		// retrieve the material
+		SObjMtl *useMtl = findMtl(MtlName, GrpName);
+		// only change material if we found it
+		if (useMtl)
+			CurrMtl = useMtl;
+		MtlChanged=false;
+	}
+	if (CurrMtl)
+		v.Color = CurrMtl->Meshbuffer->Material.DiffuseColor;
 
-				int vertLocation;
-				auto n = currMtl->VertMap.find(v);
-				if (n != currMtl->VertMap.end())
-				{
-					vertLocation = n->second;
-				}
-				else
-				{
-					currMtl->Meshbuffer->Vertices.push_back(v);
-					vertLocation = currMtl->Meshbuffer->Vertices.size() -1;
-					currMtl->VertMap.emplace(v, vertLocation);
-				}
+	FaceCorners.set_used(0); // fast clear
 
-				faceCorners.push_back(vertLocation);
+	for (u32 i=0; i<cornerCount; ++i, corners+=3)
+	{
+		// the indices of the file are 1-based, or relative to the current count when negative
+		const s32 position = resolveIndex(corners[0], vertexCount);
+		if ( -1 != position )
+			v.Pos = VertexBuffer[position];
+		else
+		{
+			const c8* lineEnd = line;
+			while (lineEnd != bufEnd && *lineEnd != '\n' && *lineEnd != '\r')
+				++lineEnd;
+			os::Printer::log("Invalid vertex index in this line", core::stringc(line, (u32)(lineEnd-line)).c_str(), ELL_ERROR);
+			return false;
+		}
 
-				// go to next vertex
-				linePtr = goNextWord(linePtr, endPtr);
-			}
+		const s32 textureCoord = resolveIndex(corners[1], textureCoordCount);
+		if ( -1 != textureCoord )
+			v.TCoords = TextureCoordBuffer[textureCoord];
+		else
+			v.TCoords.set(0.0f,0.0f);
 
-			// triangulate the face
-			const int c = faceCorners[0];
-			for ( u32 i = 1; i < faceCorners.size() - 1; ++i )
-			{
-				// Add a triangle
-				const int a = faceCorners[i + 1];
-				const int b = faceCorners[i];
-				if (a != b && a != c && b != c)	// ignore degenerated faces. We can get them when we merge vertices above in the VertMap.
-				{
-					currMtl->Meshbuffer->Indices.push_back(a);
-					currMtl->Meshbuffer->Indices.push_back(b);
-					currMtl->Meshbuffer->Indices.push_back(c);
-				}
-				else
-				{
-					++degeneratedFaces;
-				}
-			}
+		const s32 normal = resolveIndex(corners[2], normalCount);
+		if ( -1 != normal )
+			v.Normal = NormalsBuffer[normal];
+		else
+		{
+			v.Normal.set(0.0f,0.0f,0.0f);
+			CurrMtl->RecalculateNormals=true;
 		}
-		break;
 
-		case '#': // comment
-		default:
-			break;
-		}	// end switch(bufPtr[0])
-		// eat up rest of line
-		bufPtr = goNextLine(bufPtr, bufEnd);
-		++lineNr;
-	}	// end while(bufPtr && (bufPtr-buf<filesize))
+		int vertLocation;
+		auto n = CurrMtl->VertMap.find(v);
+		if (n != CurrMtl->VertMap.end())
+		{
+			vertLocation = n->second;
+		}
+		else
+		{
+			CurrMtl->Meshbuffer->Vertices.push_back(v);
+			vertLocation = CurrMtl->Meshbuffer->Vertices.size() -1;
+			CurrMtl->VertMap.emplace(v, vertLocation);
+		}
 
-	if ( degeneratedFaces > 0 )
-	{
-		irr::core::stringc log(degeneratedFaces);
-		log += " degenerated faces removed in ";
-		log += irr::core::stringc(fullName);
-		os::Printer::log(log.c_str(), ELL_INFORMATION);
+		FaceCorners.push_back(vertLocation);
 	}
 
-	SMesh* mesh = new SMesh();
+	if (FaceCorners.size() < 3)
+		return true;
 
-	// Combine all the groups (meshbuffers) into the mesh
-	for ( u32 m = 0; m < Materials.size(); ++m )
+	// triangulate the face
+	const int c = FaceCorners[0];
+	for ( u32 i = 1; i < FaceCorners.size() - 1; ++i )
 	{
-		if ( Materials[m]->Meshbuffer->getIndexCount() > 0 )
+		// Add a triangle
+		const int a = FaceCorners[i + 1];
+		const int b = FaceCorners[i];
+		if (a != b && a != c && b != c)	// ignore degenerated faces. We can get them when we merge vertices above in the VertMap.
 		{
-			Materials[m]->Meshbuffer->recalculateBoundingBox();
-			if (Materials[m]->RecalculateNormals)
-				SceneManager->getMeshManipulator()->recalculateNormals(Materials[m]->Meshbuffer);
-			mesh->addMeshBuffer( Materials[m]->Meshbuffer );
+			CurrMtl->Meshbuffer->Indices.push_back(a);
+			CurrMtl->Meshbuffer->Indices.push_back(b);
+			CurrMtl->Meshbuffer->Indices.push_back(c);
+		}
+		else
+		{
+			++DegeneratedFaces;
 		}
 	}
+	return true;
+}
 
-	// Create the Animated mesh if there's anything in the mesh
-	SAnimatedMesh* animMesh = 0;
-	if ( 0 != mesh->getMeshBufferCount() )
-	{
-		mesh->recalculateBoundingBox();
-		animMesh = new SAnimatedMesh();
-		animMesh->Type = EAMT_OBJ;
-		animMesh->addMesh(mesh);
-		animMesh->recalculateBoundingBox();
-	}
-
-	// Clean up the allocate obj file contents
-	delete [] buf;
-	// more cleaning up
-	cleanUp();
-	mesh->drop();
 
-	return animMesh;
+//! Read the float in the next word
+const c8* COBJMeshFileLoader::readFloat(const c8* bufPtr, f32& value, const c8* const bufEnd)
+{
+	// the numbers are parsed in place, the buffer ends with a zero
+	bufPtr = goNextWord(bufPtr, bufEnd, false);
+	return core::fast_atof_fixed_move(bufPtr, value);
 }
 
+
 //! Read RGB color
 const c8* COBJMeshFileLoader::readColor(const c8* bufPtr, video::SColor& color, const c8* const bufEnd)
 {
@@ -350,29 +536,19 @@ const c8* COBJMeshFileLoader::readColor(const c8* bufPtr, video::SColor& color,
 //! Read 3d vector of floats
 const c8* COBJMeshFileLoader::readVec3(const c8* bufPtr, core::vector3df& vec, const c8* const bufEnd)
 {
-	const u32 WORD_BUFFER_LENGTH = 256;
-	c8 wordBuffer[WORD_BUFFER_LENGTH];
-
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	vec.X=-core::fast_atof(wordBuffer); // change handedness
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	vec.Y=core::fast_atof(wordBuffer);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	vec.Z=core::fast_atof(wordBuffer);
-	return bufPtr;
+	bufPtr = readFloat(bufPtr, vec.X, bufEnd);
+	vec.X=-vec.X; // change handedness
+	bufPtr = readFloat(bufPtr, vec.Y, bufEnd);
+	return readFloat(bufPtr, vec.Z, bufEnd);
 }
 
 
 //! Read 2d vector of floats
 const c8* COBJMeshFileLoader::readUV(const c8* bufPtr, core::vector2df& vec, const c8* const bufEnd)
 {
-	const u32 WORD_BUFFER_LENGTH = 256;
-	c8 wordBuffer[WORD_BUFFER_LENGTH];
-
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	vec.X=core::fast_atof(wordBuffer);
-	bufPtr = goAndCopyNextWord(wordBuffer, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
-	vec.Y=1-core::fast_atof(wordBuffer); // change handedness
+	bufPtr = readFloat(bufPtr, vec.X, bufEnd);
+	bufPtr = readFloat(bufPtr, vec.Y, bufEnd);
+	vec.Y=1-vec.Y; // change handedness
 	return bufPtr;
 }
 
@@ -389,6 +565,65 @@ const c8* COBJMeshFileLoader::readBool(const c8* bufPtr, bool& tf, const c8* con
 }
 
 
+//! Adds the materials of a material library with their map_Kd textures, see MESH_LOADER_TEXTURES
+void COBJMeshFileLoader::readMTL(const c8* fileName)
+{
+	const u32 WORD_BUFFER_LENGTH = 512;
+
+	// the loader may run on the loading thread, so the file is read from disk directly
+	io::path name = fileName;
+	name.replace('\\', '/');
+	io::IReadFile* mtlFile = io::CReadFile::createReadFile(FileDir + name);
+	if (!mtlFile)
+		mtlFile = io::CReadFile::createReadFile(name);
+	if (!mtlFile)
+	{
+		os::Printer::log("Could not open material file", name, ELL_WARNING);
+		return;
+	}
+
+	const long filesize = mtlFile->getSize();
+	c8* buf = new c8[filesize+1];
+	const size_t readsize = filesize > 0 ? mtlFile->read((void*)buf, filesize) : 0;
+	buf[readsize] = 0;
+	const c8* const bufEnd = buf+readsize;
+	mtlFile->drop();
+
+	SObjMtl* currMaterial = 0;
+	const c8* bufPtr = goFirstWord(buf, bufEnd);
+	while (bufPtr != bufEnd)
+	{
+		if (!strncmp(bufPtr, "newmtl", 6) && core::isspace(bufPtr[6]))
+		{
+			c8 mtlName[WORD_BUFFER_LENGTH];
+			bufPtr = goAndCopyNextWord(mtlName, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+			currMaterial = new SObjMtl();
+			currMaterial->Name = mtlName;
+			Materials.push_back(currMaterial);
+		}
+		else if (currMaterial && !strncmp(bufPtr, "map_Kd", 6) && core::isspace(bufPtr[6]))
+		{
+			// the options come first, the file name is the last word of the line
+			c8 textureName[WORD_BUFFER_LENGTH];
+			textureName[0] = 0;
+			bufPtr = goNextWord(bufPtr, bufEnd, false);
+			while (bufPtr != bufEnd && *bufPtr != '\n' && *bufPtr != '\r')
+			{
+				copyWord(textureName, bufPtr, WORD_BUFFER_LENGTH, bufEnd);
+				bufPtr = goNextWord(bufPtr, bufEnd, false);
+			}
+
+			// the file is loaded by the scene manager after parsing
+			if (textureName[0])
+				currMaterial->Meshbuffer->Material.setTexture(0, SceneManager->addMeshTextureReference(textureName));
+		}
+		bufPtr = goNextLine(bufPtr, bufEnd);
+	}
+
+	delete [] buf;
+}
+
+
 COBJMeshFileLoader::SObjMtl* COBJMeshFileLoader::findMtl(const core::stringc& mtlName, const core::stringc& grpName)
 {
 	COBJMeshFileLoader::SObjMtl* defMaterial = 0;
@@ -490,23 +725,6 @@ u32 COBJMeshFileLoader::copyWord(c8* outBuf, const c8* const inBuf, u32 outBufLe
 }
 
 
-core::stringc COBJMeshFileLoader::copyLine(const c8* inBuf, const c8* bufEnd)
-{
-	if (!inBuf)
-		return core::stringc();
-
-	const c8* ptr = inBuf;
-	while (ptr<bufEnd)
-	{
-		if (*ptr=='\n' || *ptr=='\r')
-			break;
-		++ptr;
-	}
-	// we must avoid the +1 in case the array is used up
-	return core::stringc(inBuf, (u32)(ptr-inBuf+((ptr < bufEnd) ? 1 : 0)));
-}
-
-
 const c8* COBJMeshFileLoader::goAndCopyNextWord(c8* outBuf, const c8* inBuf, u32 outBufLength, const c8* bufEnd)
 {
 	inBuf = goNextWord(inBuf, bufEnd, false);
@@ -515,80 +733,6 @@ const c8* COBJMeshFileLoader::goAndCopyNextWord(c8* outBuf, const c8* inBuf, u32
 }
 
 
-bool COBJMeshFileLoader::retrieveVertexIndices(c8* vertexData, s32* idx, const c8* bufEnd, u32 vbsize, u32 vtsize, u32 vnsize)
-{
-	const u32 BUFFER_LENGTH = 16;
-	c8 word[BUFFER_LENGTH];
-	const c8* p = goFirstWord(vertexData, bufEnd);
-	u32 idxType = 0;	// 0 = posIdx, 1 = texcoordIdx, 2 = normalIdx
-
-	u32 i = 0;
-	while ( p != bufEnd )
-	{
-		if ( i >= BUFFER_LENGTH )
-		{
-			return false;
-		}
-		if ( ( core::isdigit(*p)) || (*p == '-') )
-		{
-			// build up the number
-			word[i++] = *p;
-		}
-		else if ( *p == '/' || *p == ' ' || *p == '\0' )
-		{
-			// number is completed. Convert and store it
-			word[i] = '\0';
-			// if no number was found index will become 0 and later on -1 by decrement
-			idx[idxType] = core::strtol10(word);
-			if (idx[idxType]<0)
-			{
-				switch (idxType)
-				{
-					case 0:
-						idx[idxType] += vbsize;
-						break;
-					case 1:
-						idx[idxType] += vtsize;
-						break;
-					case 2:
-						idx[idxType] += vnsize;
-						break;
-				}
-			}
-			else
-				idx[idxType]-=1;
-
-			// reset the word
-			word[0] = '\0';
-			i = 0;
-
-			// go to the next kind of index type
-			if (*p == '/')
-			{
-				if ( ++idxType > 2 )
-				{
-					// error checking, shouldn't reach here unless file is wrong
-					idxType = 0;
-				}
-			}
-			else
-			{
-				// set all missing values to disable (=-1)
-				while (++idxType < 3)
-					idx[idxType]=-1;
-				++p;
-				break; // while
-			}
-		}
-
-		// go to the next char
-		++p;
-	}
-
-	return true;
-}
-
-
 void COBJMeshFileLoader::cleanUp()
 {
 	for (u32 i=0; i < Materials.size(); ++i )
@@ -598,6 +742,11 @@ void COBJMeshFileLoader::cleanUp()
 	}
 
 	Materials.clear();
+
+	VertexBuffer.clear();
+	NormalsBuffer.clear();
+	TextureCoordBuffer.clear();
+	CurrMtl = 0;
 }
 
 
@@ -16,6 +16,8 @@ namespace irr
 namespace scene
 {
 
+class CJobSystem;
+
 //! Meshloader capable of loading obj meshes.
 class COBJMeshFileLoader : public IMeshLoader
 {
@@ -69,6 +71,54 @@ private:
 		bool RecalculateNormals;
 	};
 
+	//! A face, group, smoothing, material or material library statement
+	struct SObjStatement
+	{
+		const c8* Line;
+		//! first index in SObjChunk::Corners and number of corners of faces
+		u32 FirstCorner;
+		u32 CornerCount;
+		//! v, vt and vn lines of the chunk before the statement, for relative indices
+		u32 VertexCount;
+		u32 TextureCoordCount;
+		u32 NormalCount;
+	};
+
+	//! A part of the file, which ends after a line break
+	/** The vertex data and the statements of the parts are read in parallel,
+	the statements are applied in file order afterwards. */
+	struct SObjChunk
+	{
+		COBJMeshFileLoader* Loader;
+		const c8* Begin;
+		const c8* End;
+		core::array<core::vector3df> Vertices;
+		core::array<core::vector3df> Normals;
+		core::array<core::vector2df> TextureCoords;
+		core::array<SObjStatement> Statements;
+		//! position, texture coordinate and normal index of each face corner, as in the file
+		core::array<s32> Corners;
+	};
+
+	//! Reads the vertex data and the statements of a part of the file
+	void parseChunk(SObjChunk& chunk);
+	//! CJobSystem job of parseChunk
+	static void parseChunkJob(void* data);
+
+	//! Applies a group, smoothing, material or material library statement
+	void readStatement(const c8* bufPtr, const c8* const bufEnd);
+	//! Adds the materials of a material library with their map_Kd textures, see MESH_LOADER_TEXTURES
+	void readMTL(const c8* fileName);
+	//! Reads the indices of a face statement into corners, 0 for missing ones
+	const c8* readFace(const c8* bufPtr, core::array<s32>& corners, const c8* const bufEnd);
+	//! Adds a face to the current material
+	/** \param corners Indices of the corners as they are in the file.
+	\param vertexCount Number of vertices before the face, likewise
+	textureCoordCount and normalCount.
+	\return False if a position index is invalid. */
+	bool addFace(const s32* corners, u32 cornerCount, u32 vertexCount, u32 textureCoordCount,
+		u32 normalCount, const c8* line, const c8* const bufEnd);
+
 	// returns a pointer to the first printable character available in the buffer
 	const c8* goFirstWord(const c8* buf, const c8* const bufEnd, bool acrossNewlines=true);
 	// returns a pointer to the first printable character after the first non-printable
@@ -77,8 +127,6 @@ private:
 	const c8* goNextLine(const c8* buf, const c8* const bufEnd);
 	// copies the current word from the inBuf to the outBuf
 	u32 copyWord(c8* outBuf, const c8* inBuf, u32 outBufLength, const c8* const pBufEnd);
-	// copies the current line from the inBuf to the outBuf
-	core::stringc copyLine(const c8* inBuf, const c8* const bufEnd);
 
 	// combination of goNextWord followed by copyWord
 	const c8* goAndCopyNextWord(c8* outBuf, const c8* inBuf, u32 outBufLength, const c8* const pBufEnd);
@@ -86,6 +134,8 @@ private:
 	//! Find and return the material with the given name
 	SObjMtl* findMtl(const core::stringc& mtlName, const core::stringc& grpName);
 
+	//! Read the float in the next word
+	const c8* readFloat(const c8* bufPtr, f32& value, const c8* const bufEnd);
 	//! Read RGB color
 	const c8* readColor(const c8* bufPtr, video::SColor& color, const c8* const pBufEnd);
 	//! Read 3d vector of floats
@@ -95,16 +145,31 @@ private:
 	//! Read boolean value represented as 'on' or 'off'
 	const c8* readBool(const c8* bufPtr, bool& tf, const c8* const bufEnd);
 
-	// reads and convert to integer the vertex indices in a line of obj file's face statement
-	// -1 for the index if it doesn't exist
-	// indices are changed to 0-based index instead of 1-based from the obj file
-	bool retrieveVertexIndices(c8* vertexData, s32* idx, const c8* bufEnd, u32 vbsize, u32 vtsize, u32 vnsize);
-
 	void cleanUp();
 
 	scene::ISceneManager* SceneManager;
 
 	core::array<SObjMtl*> Materials;
+
+	core::array<core::vector3df> VertexBuffer;
+	core::array<core::vector3df> NormalsBuffer;
+	core::array<core::vector2df> TextureCoordBuffer;
+	core::array<int> FaceCorners;
+
+	SObjMtl* CurrMtl;
+	core::stringc GrpName;
+	core::stringc MtlName;
+	bool MtlChanged;
+	bool UseGroups;
+	bool UseMaterials;
+	//! Reads the material libraries for their textures, see MESH_LOADER_TEXTURES
+	bool LoadTextures;
+	//! Directory of the file, with a trailing slash if not empty
+	io::path FileDir;
+	u32 DegeneratedFaces;
+
+	//! Parses large files in parallel, see OBJ_LOADER_PARALLEL_PARSE
+	CJobSystem* Jobs;
 };
 
 } // end namespace scene
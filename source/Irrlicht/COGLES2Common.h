@@ -36,6 +36,13 @@ typedef char GLchar;
 #define GL_BGRA 0x80E1;
 #endif
 
+// GL_EXT_clip_control
+#ifndef GL_ZERO_TO_ONE_EXT
+#define GL_LOWER_LEFT_EXT 0x8CA1
+#define GL_NEGATIVE_ONE_TO_ONE_EXT 0x935E
+#define GL_ZERO_TO_ONE_EXT 0x935F
+#endif
+
 // FBO definitions.
 
 #define GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER 1
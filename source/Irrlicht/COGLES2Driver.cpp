@@ -27,6 +27,8 @@
 
 #include "mt_opengl.h"
 
+#include <algorithm>
+
 namespace irr
 {
 namespace video
@@ -35,7 +37,7 @@ namespace video
 COGLES2Driver::COGLES2Driver(const SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager) :
 	CNullDriver(io, params.WindowSize), COGLES2ExtensionHandler(), CacheHandler(0),
 	Params(params), ResetRenderStates(true), LockRenderStateMode(false), AntiAlias(params.AntiAlias),
-	MaterialRenderer2DActive(0), MaterialRenderer2DTexture(0), MaterialRenderer2DNoTexture(0),
+	MaterialRenderer2DActive(0), MaterialRenderer2DTexture(0), MaterialRenderer2DNoTexture(0), MaterialRenderer2DDistanceField(0),
 	CurrentRenderMode(ERM_NONE), Transformation3DChanged(true),
 	OGLES2ShaderPath(params.OGLES2ShaderPath),
 	ColorFormat(ECF_R8G8B8), ContextManager(contextManager)
@@ -68,6 +70,7 @@ COGLES2Driver::~COGLES2Driver()
 
 	delete MaterialRenderer2DTexture;
 	delete MaterialRenderer2DNoTexture;
+	delete MaterialRenderer2DDistanceField;
 	delete CacheHandler;
 
 	if (ContextManager)
@@ -91,9 +94,7 @@ COGLES2Driver::~COGLES2Driver()
 		// load extensions
 		initExtensions();
 
-		// reset cache handler
-		delete CacheHandler;
-		CacheHandler = new COGLES2CacheHandler(this);
+		resetGLStates();
 
 		StencilBuffer = stencilBuffer;
 
@@ -110,18 +111,12 @@ COGLES2Driver::~COGLES2Driver()
 		DriverAttributes->setAttribute("Version", Version);
 		DriverAttributes->setAttribute("AntiAlias", AntiAlias);
 
-		glPixelStorei(GL_PACK_ALIGNMENT, 1);
-
 		UserClipPlane.reallocate(0);
 
 		for (s32 i = 0; i < ETS_COUNT; ++i)
 			setTransform(static_cast<E_TRANSFORMATION_STATE>(i), core::IdentityMatrix);
 
 		setAmbientLight(SColorf(0.0f, 0.0f, 0.0f, 0.0f));
-		glClearDepthf(1.0f);
-
-		glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST);
-		glFrontFace(GL_CW);
 
 		// create material renderers
 		createMaterialRenderers();
@@ -144,6 +139,162 @@ COGLES2Driver::~COGLES2Driver()
 		return true;
 	}
 
+	void COGLES2Driver::resetGLStates()
+	{
+		// reset cache handler
+		delete CacheHandler;
+		CacheHandler = new COGLES2CacheHandler(this);
+		updateRenderTargetMultisampled();
+
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glClearDepthf(1.0f);
+
+		glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST);
+		glFrontFace(GL_CW);
+	}
+
+	bool COGLES2Driver::restoreResources()
+	{
+		os::Printer::log("Restoring the resources of the lost context", ELL_INFORMATION);
+
+		// the textures of the cache are bound in the lost context
+		CacheHandler->getTextureCache().clear();
+		resetGLStates();
+
+		bool status = true;
+
+		// all programs are compiled before waiting for one, drivers may compile them in parallel
+		for (u32 i = 0; i < RestorableRenderers.size(); ++i)
+			RestorableRenderers[i]->startRestore();
+
+		for (u32 i = 0; i < RestorableRenderers.size(); ++i)
+			status &= RestorableRenderers[i]->finishRestore();
+
+		// hardware buffers are uploaded again when they are drawn, the lost names must not be deleted
+		for (SHWBufferLink* link : HWBufferList)
+		{
+			SHWBufferLink_opengl* buffer = static_cast<SHWBufferLink_opengl*>(link);
+			buffer->vbo_verticesID = 0;
+			buffer->vbo_indicesID = 0;
+			buffer->vbo_verticesSize = 0;
+			buffer->vbo_indicesSize = 0;
+		}
+
+		for (u32 i = 0; i < HWBufferDeletionQueue.size(); ++i)
+		{
+			SHWBufferLink_opengl* buffer = static_cast<SHWBufferLink_opengl*>(HWBufferDeletionQueue[i]);
+			buffer->vbo_verticesID = 0;
+			buffer->vbo_indicesID = 0;
+		}
+
+		// textures used most recently are restored first
+		core::array<COGLES2Texture*> textures(Textures.size());
+		for (u32 i = 0; i < Textures.size(); ++i)
+		{
+			if (Textures[i].Surface->getDriverType() != EDT_OGLES2)
+				continue;
+
+			COGLES2Texture* texture = static_cast<COGLES2Texture*>(Textures[i].Surface);
+			texture->onContextLost();
+			textures.push_back(texture);
+		}
+
+		std::sort(textures.pointer(), textures.pointer() + textures.size(), [](const COGLES2Texture* a, const COGLES2Texture* b) {
+			return a->getLastUseFrame() > b->getLastUseFrame();
+		});
+
+		// textures of the last frame are uploaded right away, other ones with images when they are used again
+		core::array<COGLES2Texture*> reloadedTextures;
+		core::array<io::IReadFile*> files;
+
+		for (u32 i = 0; i < textures.size(); ++i)
+		{
+			COGLES2Texture* texture = textures[i];
+
+			if (texture->isRenderTarget())
+			{
+				texture->restoreStorage();
+			}
+			else if (texture->hasImages())
+			{
+				if (texture->getLastUseFrame() + 1 >= FrameCount)
+					CacheHandler->getTextureCache().set(0, texture);
+			}
+			else
+			{
+				io::IReadFile* file = (texture->getType() == ETT_2D) ? FileSystem->createAndOpenFile(texture->getName().getPath()) : 0;
+
+				if (file)
+				{
+					reloadedTextures.push_back(texture);
+					files.push_back(file);
+				}
+				else
+				{
+					os::Printer::log("Could not restore the content of a texture", texture->getName().getPath(), ELL_WARNING);
+					texture->restoreStorage();
+					status = false;
+				}
+			}
+		}
+
+		// textures without images are loaded again, decoding their files in parallel
+		core::array<IImage*> images = createImagesFromFiles(files);
+
+		for (u32 i = 0; i < reloadedTextures.size(); ++i)
+		{
+			files[i]->drop();
+
+			core::array<IImage*> textureImages;
+			if (images[i])
+				textureImages.push_back(images[i]);
+
+			const bool restored = reloadedTextures[i]->setRestoreImages(textureImages);
+
+			if (images[i])
+				images[i]->drop();
+
+			if (restored)
+			{
+				CacheHandler->getTextureCache().set(0, reloadedTextures[i]);
+			}
+			else
+			{
+				os::Printer::log("Could not restore the content of a texture", reloadedTextures[i]->getName().getPath(), ELL_WARNING);
+				reloadedTextures[i]->restoreStorage();
+				status = false;
+			}
+		}
+
+		CacheHandler->getTextureCache().set(0, 0);
+
+		// the textures are attached again when the render targets are set
+		for (u32 i = 0; i < RenderTargets.size(); ++i)
+			static_cast<COGLES2RenderTarget*>(RenderTargets[i])->restore();
+
+		CurrentRenderTarget = 0;
+		setRenderTargetEx(0, ECBF_NONE);
+
+		CurrentRenderMode = ERM_NONE;
+		ResetRenderStates = true;
+
+		testGLError(__LINE__);
+
+		return status;
+	}
+
+	void COGLES2Driver::addRestorableRenderer(COGLES2MaterialRenderer* renderer)
+	{
+		RestorableRenderers.push_back(renderer);
+	}
+
+	void COGLES2Driver::removeRestorableRenderer(COGLES2MaterialRenderer* renderer)
+	{
+		const s32 index = RestorableRenderers.linear_search(renderer);
+		if (index >= 0)
+			RestorableRenderers.erase(index);
+	}
+
 	void COGLES2Driver::loadShaderData(const io::path& vertexShaderName, const io::path& fragmentShaderName, c8** vertexShaderData, c8** fragmentShaderData)
 	{
 		io::path vsPath(OGLES2ShaderPath);
@@ -350,6 +501,25 @@ COGLES2Driver::~COGLES2Driver()
 		MaterialRenderer2DNoTexture = new COGLES2Renderer2D(vs2DData, fs2DData, this, false);
 		delete[] vs2DData;
 		delete[] fs2DData;
+		vs2DData = 0;
+		fs2DData = 0;
+
+		// without this shader distance fields are drawn like other textures
+		loadShaderData(io::path("COGLES2Renderer2D.vsh"), io::path("COGLES2Renderer2D_distanceField.fsh"), &vs2DData, &fs2DData);
+		if (vs2DData && fs2DData)
+		{
+			MaterialRenderer2DDistanceField = new COGLES2Renderer2D(vs2DData, fs2DData, this, true);
+
+			GLint linked = GL_FALSE;
+			glGetProgramiv(MaterialRenderer2DDistanceField->getProgram(), GL_LINK_STATUS, &linked);
+			if (!linked)
+			{
+				delete MaterialRenderer2DDistanceField;
+				MaterialRenderer2DDistanceField = 0;
+			}
+		}
+		delete[] vs2DData;
+		delete[] fs2DData;
 	}
 
 	bool COGLES2Driver::setMaterialTexture(irr::u32 layerIdx, const irr::video::ITexture* texture)
@@ -363,8 +533,17 @@ COGLES2Driver::~COGLES2Driver()
 		CNullDriver::beginScene(clearFlag, clearColor, clearDepth, clearStencil, videoData, sourceRect);
 
 		if (ContextManager)
+		{
 			ContextManager->activateContext(videoData, true);
 
+			if (ContextManager->recreateLostContext())
+				restoreResources();
+
+			if (beginFrameDamage(ContextManager->getBufferAge()))
+				ContextManager->setDamageRegion(&DamageRegion, 1);
+		}
+		setScissor(0);
+
 		clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
 
 		return true;
@@ -374,12 +553,51 @@ COGLES2Driver::~COGLES2Driver()
 	{
 		CNullDriver::endScene();
 
+		discardFrameBuffers();
+
+		const u64 swapBeginNs = os::Timer::getRealTimeNs();
 		glFlush();
 
+		bool status = false;
 		if (ContextManager)
-			return ContextManager->swapBuffers();
+			status = DamageRegionActive ? ContextManager->swapBuffersWithDamage(&DamageRegion, 1) : ContextManager->swapBuffers();
 
-		return false;
+		registerSwapTime(swapBeginNs);
+
+		endFrameDamage();
+		setScissor(0);
+
+		return status;
+	}
+
+
+	void COGLES2Driver::setScissor(const core::rect<s32>* clipRect)
+	{
+		core::rect<s32> rect;
+		if (getScissorRect(clipRect, rect))
+		{
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(rect.UpperLeftCorner.X, getCurrentRenderTargetSize().Height - rect.LowerRightCorner.Y,
+				core::max_(rect.getWidth(), 0), core::max_(rect.getHeight(), 0));
+		}
+		else
+			glDisable(GL_SCISSOR_TEST);
+	}
+
+
+	void COGLES2Driver::discardFrameBuffers()
+	{
+		if (CurrentRenderTarget)
+		{
+			static_cast<COGLES2RenderTarget*>(CurrentRenderTarget)->resolve();
+		}
+		else
+		{
+			// the screen only presents its color
+			const GLenum attachments[2] = { GL_DEPTH, GL_STENCIL };
+			CacheHandler->setFBO(0);
+			irrGlInvalidateFramebuffer(GL_FRAMEBUFFER, 2, attachments);
+		}
 	}
 
 
@@ -427,6 +645,9 @@ COGLES2Driver::~COGLES2Driver()
 
 		glBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
 
+		countBufferUpload(bufferSize, newBuffer);
+		FrameStats.VerticesUploaded += vertexCount;
+
 		// copy data to graphics card
 		if (!newBuffer)
 			glBufferSubData(GL_ARRAY_BUFFER, 0, bufferSize, buffer);
@@ -490,6 +711,8 @@ COGLES2Driver::~COGLES2Driver()
 
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
 
+		countBufferUpload(indexCount * indexSize, newBuffer);
+
 		// copy data to graphics card
 		if (!newBuffer)
 			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount * indexSize, indices);
@@ -551,7 +774,7 @@ COGLES2Driver::~COGLES2Driver()
 		if (!mb || (mb->getHardwareMappingHint_Index() == scene::EHM_NEVER && mb->getHardwareMappingHint_Vertex() == scene::EHM_NEVER))
 			return 0;
 
-		SHWBufferLink_opengl *HWBuffer = new SHWBufferLink_opengl(mb);
+		SHWBufferLink_opengl *HWBuffer = new SHWBufferLink_opengl(mb, this);
 
 		//add to map
 		HWBuffer->listPosition = HWBufferList.insert(HWBufferList.end(), HWBuffer);
@@ -646,7 +869,7 @@ COGLES2Driver::~COGLES2Driver()
 
 
 	// small helper function to create vertex buffer object adress offsets
-	static inline u8* buffer_offset(const long offset)
+	static inline u8* buffer_offset(const uintptr_t offset)
 	{
 		return ((u8*)0 + offset);
 	}
@@ -663,8 +886,19 @@ COGLES2Driver::~COGLES2Driver()
 		if (!checkPrimitiveCount(primitiveCount))
 			return;
 
+		// skinned and compact vertices need the shader variants of the OpenGL 3 driver
+		if (vType == EVT_SKINNED || vType == EVT_COMPACT)
+			return;
+
 		CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
+		renderPrimitiveList((uintptr_t)vertices, indexList, primitiveCount, vType, pType, iType);
+	}
+
+
+	void COGLES2Driver::renderPrimitiveList(uintptr_t verticesBase, const void* indexList, u32 primitiveCount,
+			E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+	{
 		setRenderStates3DMode();
 
 		glEnableVertexAttribArray(EVA_POSITION);
@@ -675,64 +909,34 @@ COGLES2Driver::~COGLES2Driver()
 		switch (vType)
 		{
 		case EVT_STANDARD:
-			if (vertices)
-			{
-				glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].Pos);
-				glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].Normal);
-				glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].Color);
-				glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].TCoords);
-			}
-			else
-			{
-				glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertex), 0);
-				glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertex), buffer_offset(12));
-				glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertex), buffer_offset(24));
-				glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertex), buffer_offset(28));
-			}
+			glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertex), buffer_offset(verticesBase));
+			glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertex), buffer_offset(verticesBase + 12));
+			glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertex), buffer_offset(verticesBase + 24));
+			glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertex), buffer_offset(verticesBase + 28));
 
 			break;
 		case EVT_2TCOORDS:
 			glEnableVertexAttribArray(EVA_TCOORD1);
 
-			if (vertices)
-			{
-				glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertex2TCoords), &(static_cast<const S3DVertex2TCoords*>(vertices))[0].Pos);
-				glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertex2TCoords), &(static_cast<const S3DVertex2TCoords*>(vertices))[0].Normal);
-				glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertex2TCoords), &(static_cast<const S3DVertex2TCoords*>(vertices))[0].Color);
-				glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertex2TCoords), &(static_cast<const S3DVertex2TCoords*>(vertices))[0].TCoords);
-				glVertexAttribPointer(EVA_TCOORD1, 2, GL_FLOAT, false, sizeof(S3DVertex2TCoords), &(static_cast<const S3DVertex2TCoords*>(vertices))[0].TCoords2);
-			}
-			else
-			{
-				glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertex2TCoords), buffer_offset(0));
-				glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertex2TCoords), buffer_offset(12));
-				glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertex2TCoords), buffer_offset(24));
-				glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertex2TCoords), buffer_offset(28));
-				glVertexAttribPointer(EVA_TCOORD1, 2, GL_FLOAT, false, sizeof(S3DVertex2TCoords), buffer_offset(36));
-			}
+			glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase));
+			glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 12));
+			glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 24));
+			glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 28));
+			glVertexAttribPointer(EVA_TCOORD1, 2, GL_FLOAT, false, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 36));
 			break;
 		case EVT_TANGENTS:
 			glEnableVertexAttribArray(EVA_TANGENT);
 			glEnableVertexAttribArray(EVA_BINORMAL);
 
-			if (vertices)
-			{
-				glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Pos);
-				glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Normal);
-				glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Color);
-				glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].TCoords);
-				glVertexAttribPointer(EVA_TANGENT, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Tangent);
-				glVertexAttribPointer(EVA_BINORMAL, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Binormal);
-			}
-			else
-			{
-				glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(0));
-				glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(12));
-				glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertexTangents), buffer_offset(24));
-				glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(28));
-				glVertexAttribPointer(EVA_TANGENT, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(36));
-				glVertexAttribPointer(EVA_BINORMAL, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(48));
-			}
+			glVertexAttribPointer(EVA_POSITION, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(verticesBase));
+			glVertexAttribPointer(EVA_NORMAL, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 12));
+			glVertexAttribPointer(EVA_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 24));
+			glVertexAttribPointer(EVA_TCOORD0, 2, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 28));
+			glVertexAttribPointer(EVA_TANGENT, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 36));
+			glVertexAttribPointer(EVA_BINORMAL, 3, GL_FLOAT, false, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 48));
+			break;
+		case EVT_SKINNED:
+		case EVT_COMPACT:
 			break;
 		}
 
@@ -986,9 +1190,7 @@ COGLES2Driver::~COGLES2Driver()
 			if (!clipRect->isValid())
 				return;
 
-			glEnable(GL_SCISSOR_TEST);
-			glScissor(clipRect->UpperLeftCorner.X, renderTargetSize.Height - clipRect->LowerRightCorner.Y,
-				clipRect->getWidth(), clipRect->getHeight());
+			setScissor(clipRect);
 		}
 
 		f32 left = (f32)destRect.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
@@ -1015,7 +1217,7 @@ COGLES2Driver::~COGLES2Driver()
 		glDisableVertexAttribArray(EVA_POSITION);
 
 		if (clipRect)
-			glDisable(GL_SCISSOR_TEST);
+			setScissor(0);
 
 		testGLError(__LINE__);
 	}
@@ -1245,9 +1447,7 @@ COGLES2Driver::~COGLES2Driver()
 			if (!clipRect->isValid())
 				return;
 
-			glEnable(GL_SCISSOR_TEST);
-			glScissor(clipRect->UpperLeftCorner.X, renderTargetSize.Height - clipRect->LowerRightCorner.Y,
-					clipRect->getWidth(), clipRect->getHeight());
+			setScissor(clipRect);
 		}
 
 		const core::dimension2du& ss = texture->getOriginalSize();
@@ -1311,7 +1511,7 @@ COGLES2Driver::~COGLES2Driver()
 		}
 
 		if (clipRect)
-			glDisable(GL_SCISSOR_TEST);
+			setScissor(0);
 
 		testGLError(__LINE__);
 	}
@@ -1619,6 +1819,7 @@ COGLES2Driver::~COGLES2Driver()
 					Material, LastMaterial, ResetRenderStates, this);
 
 			LastMaterial = Material;
+			++FrameStats.MaterialChanges;
 			CacheHandler->correctCacheMaterial(LastMaterial);
 			ResetRenderStates = false;
 		}
@@ -1633,7 +1834,7 @@ COGLES2Driver::~COGLES2Driver()
 	void COGLES2Driver::setBasicRenderStates(const SMaterial& material, const SMaterial& lastmaterial, bool resetAllRenderStates)
 	{
 		// ZBuffer
-		switch (material.ZBuffer)
+		switch (getDepthComparison(material))
 		{
 			case ECFN_DISABLED:
 				CacheHandler->setDepthTest(false);
@@ -1755,13 +1956,7 @@ COGLES2Driver::~COGLES2Driver()
 			glLineWidth(core::clamp(static_cast<GLfloat>(material.Thickness), DimAliasedLine[0], DimAliasedLine[1]));
 
 		// Anti aliasing
-		if (resetAllRenderStates || lastmaterial.AntiAliasing != material.AntiAliasing)
-		{
-			if (material.AntiAliasing & EAAM_ALPHA_TO_COVERAGE)
-				glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-			else if (lastmaterial.AntiAliasing & EAAM_ALPHA_TO_COVERAGE)
-				glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-		}
+		CacheHandler->setAlphaToCoverage((material.AntiAliasing & EAAM_ALPHA_TO_COVERAGE) != 0);
 
 		// Texture parameters
 		setTextureRenderStates(material, resetAllRenderStates);
@@ -1878,6 +2073,14 @@ COGLES2Driver::~COGLES2Driver()
 
 		COGLES2Renderer2D* nextActiveRenderer = texture ? MaterialRenderer2DTexture : MaterialRenderer2DNoTexture;
 
+		// distance fields are turned into smooth edges by their own shader
+		if (texture && alphaChannel && MaterialRenderer2DDistanceField)
+		{
+			const ITexture* current = CacheHandler->getTextureCache().get(0);
+			if (current && current->isDistanceField())
+				nextActiveRenderer = MaterialRenderer2DDistanceField;
+		}
+
 		if (CurrentRenderMode != ERM_2D)
 		{
 			// unset last 3d material
@@ -1898,6 +2101,7 @@ COGLES2Driver::~COGLES2Driver()
 
 		MaterialRenderer2DActive->OnSetMaterial(Material, LastMaterial, true, 0);
 		LastMaterial = Material;
+		++FrameStats.MaterialChanges;
 		CacheHandler->correctCacheMaterial(LastMaterial);
 
 		// no alphaChannel without texture
@@ -1917,10 +2121,17 @@ COGLES2Driver::~COGLES2Driver()
 
 		if (texture)
 		{
-			if (OverrideMaterial2DEnabled)
-				setTextureRenderStates(OverrideMaterial2D, false);
+			const SMaterial& material2D = OverrideMaterial2DEnabled ? OverrideMaterial2D : InitMaterial2D;
+
+			if (MaterialRenderer2DActive == MaterialRenderer2DDistanceField)
+			{
+				// the distances between the texels have to be interpolated
+				SMaterial filtered(material2D);
+				filtered.TextureLayer[0].BilinearFilter = true;
+				setTextureRenderStates(filtered, false);
+			}
 			else
-				setTextureRenderStates(InitMaterial2D, false);
+				setTextureRenderStates(material2D, false);
 		}
 
 		MaterialRenderer2DActive->OnRender(this, video::EVT_STANDARD);
@@ -1988,7 +2199,7 @@ COGLES2Driver::~COGLES2Driver()
 		setRenderStates3DMode();
 
 		CacheHandler->setDepthTest(true);
-		CacheHandler->setDepthFunc(GL_LESS);
+		CacheHandler->setDepthFunc(ReverseDepth ? GL_GREATER : GL_LESS);
 		CacheHandler->setDepthMask(false);
 
 		if (!(debugDataVisible & (scene::EDS_SKELETON|scene::EDS_MESH_WIRE_OVERLAY)))
@@ -2314,14 +2525,17 @@ COGLES2Driver::~COGLES2Driver()
 			return false;
 		}
 
+		if (CurrentRenderTarget && CurrentRenderTarget != target)
+			static_cast<COGLES2RenderTarget*>(CurrentRenderTarget)->resolve();
+
 		core::dimension2d<u32> destRenderTargetSize(0, 0);
 
 		if (target)
 		{
 			COGLES2RenderTarget* renderTarget = static_cast<COGLES2RenderTarget*>(target);
 
-			CacheHandler->setFBO(renderTarget->getBufferID());
 			renderTarget->update();
+			CacheHandler->setFBO(renderTarget->getBufferID());
 
 			destRenderTargetSize = renderTarget->getSize();
 
@@ -2344,12 +2558,30 @@ COGLES2Driver::~COGLES2Driver()
 		}
 
 		CurrentRenderTarget = target;
+		setScissor(0);
+		updateRenderTargetMultisampled();
 
 		clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
 
 		return true;
 	}
 
+	void COGLES2Driver::updateRenderTargetMultisampled()
+	{
+		// alpha to coverage has no effect with a single sample per pixel
+		GLint sampleBuffers = 0;
+		if (queryFeature(EVDF_ALPHA_TO_COVERAGE))
+			glGetIntegerv(GL_SAMPLE_BUFFERS, &sampleBuffers);
+
+		if (RenderTargetMultisampled != (sampleBuffers > 0))
+		{
+			RenderTargetMultisampled = sampleBuffers > 0;
+
+			// alpha channel materials blend and write depth depending on it
+			ResetRenderStates = true;
+		}
+	}
+
 	void COGLES2Driver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 	{
 		GLbitfield mask = 0;
@@ -2373,7 +2605,7 @@ COGLES2Driver::~COGLES2Driver()
 		if (flag & ECBF_DEPTH)
 		{
 			CacheHandler->setDepthMask(true);
-			glClearDepthf(depth);
+			glClearDepthf(getClearDepth(depth));
 			mask |= GL_DEPTH_BUFFER_BIT;
 		}
 
@@ -2391,6 +2623,23 @@ COGLES2Driver::~COGLES2Driver()
 	}
 
 
+	void COGLES2Driver::setReverseDepth(bool reverse)
+	{
+		if (reverse == ReverseDepth)
+			return;
+
+		CNullDriver::setReverseDepth(reverse);
+
+		// the depth buffer only gets its full precision when depth isn't
+		// mapped from -1 to 1 first
+		if (queryFeature(EVDF_DEPTH_CLIP_CONTROL))
+			irrGlClipControl(GL_LOWER_LEFT_EXT, reverse ? GL_ZERO_TO_ONE_EXT : GL_NEGATIVE_ONE_TO_ONE_EXT);
+
+		// the depth comparisons of the current material are swapped
+		ResetRenderStates = true;
+	}
+
+
 	//! Returns an image created from the last rendered frame.
 	// We want to read the front buffer to get the latest render finished.
 	// This is not possible under ogl-es, though, so one has to call this method
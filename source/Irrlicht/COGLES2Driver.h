@@ -24,6 +24,7 @@ namespace video
 {
 
 	class COGLES2FixedPipelineRenderer;
+	class COGLES2MaterialRenderer;
 	class COGLES2Renderer2D;
 
 	class COGLES2Driver : public CNullDriver, public IMaterialRendererServices, public COGLES2ExtensionHandler
@@ -45,13 +46,15 @@ namespace video
 
 		bool endScene() override;
 
+		bool restoreResources() override;
+
 		//! sets transformation
 		void setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat) override;
 
 		struct SHWBufferLink_opengl : public SHWBufferLink
 		{
-			SHWBufferLink_opengl(const scene::IMeshBuffer *meshBuffer)
-			: SHWBufferLink(meshBuffer), vbo_verticesID(0), vbo_indicesID(0)
+			SHWBufferLink_opengl(const scene::IMeshBuffer *meshBuffer, CNullDriver *driver)
+			: SHWBufferLink(meshBuffer, driver), vbo_verticesID(0), vbo_indicesID(0)
 			, vbo_verticesSize(0), vbo_indicesSize(0)
 			{}
 
@@ -256,6 +259,9 @@ namespace video
 
 		void clearBuffers(u16 flag, SColor color = SColor(255, 0, 0, 0), f32 depth = 1.f, u8 stencil = 0) override;
 
+		//! Sets if depth values get smaller with the distance from the camera
+		void setReverseDepth(bool reverse) override;
+
 		//! Returns an image created from the last rendered frame.
 		IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override;
 
@@ -305,12 +311,26 @@ namespace video
 
 		COGLES2CacheHandler* getCacheHandler() const;
 
+		//! Adds a renderer whose program restoreResources() compiles again
+		void addRestorableRenderer(COGLES2MaterialRenderer* renderer);
+
+		void removeRestorableRenderer(COGLES2MaterialRenderer* renderer);
+
 	protected:
 		//! inits the opengl-es driver
 		virtual bool genericDriverInit(const core::dimension2d<u32>& screenSize, bool stencilBuffer);
 
+		//! Creates the cache handler and sets the states it doesn't track, for a new context
+		void resetGLStates();
+
 		void chooseMaterial2D();
 
+		//! Sets up the attributes and issues the draw call of drawVertexPrimitiveList
+		/** \param verticesBase Address of the vertices in client memory, or
+		their offset in the bound array buffer. */
+		void renderPrimitiveList(uintptr_t verticesBase, const void* indexList, u32 primitiveCount,
+				E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType);
+
 		ITexture* createDeviceDependentTexture(const io::path& name, IImage* image) override;
 
 		ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image) override;
@@ -346,6 +366,15 @@ namespace video
 
 		void createMaterialRenderers();
 
+		//! Resolves the current render target, or discards the depth and stencil of the screen
+		void discardFrameBuffers();
+
+		//! Scissors to the clipping rectangle and the damage region of the frame, see getScissorRect()
+		void setScissor(const core::rect<s32>* clipRect);
+
+		//! Queries if the bound frame buffer has multiple samples, see usesAlphaToCoverage()
+		void updateRenderTargetMultisampled();
+
 		void loadShaderData(const io::path& vertexShaderName, const io::path& fragmentShaderName, c8** vertexShaderData, c8** fragmentShaderData);
 
 		bool setMaterialTexture(irr::u32 layerIdx, const irr::video::ITexture* texture);
@@ -378,6 +407,10 @@ private:
 		COGLES2Renderer2D* MaterialRenderer2DActive;
 		COGLES2Renderer2D* MaterialRenderer2DTexture;
 		COGLES2Renderer2D* MaterialRenderer2DNoTexture;
+		COGLES2Renderer2D* MaterialRenderer2DDistanceField;
+
+		//! All renderers with a linked program, including the 2D ones
+		core::array<COGLES2MaterialRenderer*> RestorableRenderers;
 
 		core::matrix4 Matrices[ETS_COUNT];
 
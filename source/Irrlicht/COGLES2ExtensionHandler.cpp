@@ -12,6 +12,14 @@
 #include "SMaterial.h"
 #include "fast_atof.h"
 
+#ifdef _IRR_COMPILE_WITH_EGL_MANAGER_
+#include <EGL/egl.h>
+#endif
+
+#ifndef GL_MAX_SAMPLES
+#define GL_MAX_SAMPLES 0x8D57
+#endif
+
 namespace irr
 {
 namespace video
@@ -48,6 +56,26 @@ namespace video
 
 		Feature.MaxTextureUnits = core::min_(Feature.MaxTextureUnits, static_cast<u8>(MATERIAL_MAX_TEXTURES));
 		Feature.ColorAttachment = 1;
+
+	#ifdef _IRR_COMPILE_WITH_EGL_MANAGER_
+		// multisampled render targets and their resolve are core since OpenGL ES 3.0
+		if (Version >= 300)
+		{
+			pGlRenderbufferStorageMultisample = (PFNIRRGLRENDERBUFFERSTORAGEMULTISAMPLEPROC)eglGetProcAddress("glRenderbufferStorageMultisample");
+			pGlBlitFramebuffer = (PFNIRRGLBLITFRAMEBUFFERPROC)eglGetProcAddress("glBlitFramebuffer");
+			pGlInvalidateFramebuffer = (PFNIRRGLINVALIDATEFRAMEBUFFERPROC)eglGetProcAddress("glInvalidateFramebuffer");
+		}
+		if (!pGlInvalidateFramebuffer && FeatureAvailable[IRR_GL_EXT_discard_framebuffer])
+			pGlInvalidateFramebuffer = (PFNIRRGLINVALIDATEFRAMEBUFFERPROC)eglGetProcAddress("glDiscardFramebufferEXT");
+		if (FeatureAvailable[IRR_GL_EXT_clip_control])
+			pGlClipControl = (PFNIRRGLCLIPCONTROLPROC)eglGetProcAddress("glClipControlEXT");
+	#endif
+
+		if (pGlRenderbufferStorageMultisample && pGlBlitFramebuffer)
+		{
+			glGetIntegerv(GL_MAX_SAMPLES, &val);
+			Feature.MaxRenderTargetSamples = static_cast<u8>(core::s32_min(val, 255));
+		}
 	}
 
 } // end namespace video
@@ -25,7 +25,9 @@ namespace video
 	class COGLES2ExtensionHandler : public COGLESCoreExtensionHandler
 	{
 	public:
-		COGLES2ExtensionHandler() : COGLESCoreExtensionHandler() {}
+		COGLES2ExtensionHandler() : COGLESCoreExtensionHandler(),
+			pGlRenderbufferStorageMultisample(0), pGlBlitFramebuffer(0), pGlInvalidateFramebuffer(0),
+			pGlClipControl(0) {}
 
 		void initExtensions();
 
@@ -78,6 +80,8 @@ namespace video
 				return false;
 			case EVDF_STENCIL_BUFFER:
 				return StencilBuffer;
+			case EVDF_DEPTH_CLIP_CONTROL:
+				return pGlClipControl != 0;
 			default:
 				return false;
 			};
@@ -135,6 +139,55 @@ namespace video
 			glGenerateMipmap(target);
 		}
 
+		inline void irrGlBindRenderbuffer(GLenum target, GLuint renderbuffer)
+		{
+			glBindRenderbuffer(target, renderbuffer);
+		}
+
+		inline void irrGlDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
+		{
+			glDeleteRenderbuffers(n, renderbuffers);
+		}
+
+		inline void irrGlGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
+		{
+			glGenRenderbuffers(n, renderbuffers);
+		}
+
+		inline void irrGlFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+		{
+			glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+		}
+
+		inline void irrGlRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+		{
+			if (pGlRenderbufferStorageMultisample)
+				pGlRenderbufferStorageMultisample(target, samples, internalformat, width, height);
+		}
+
+		inline void irrGlBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+		{
+			if (pGlBlitFramebuffer)
+				pGlBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+		}
+
+		inline void irrGlInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments)
+		{
+			if (pGlInvalidateFramebuffer)
+				pGlInvalidateFramebuffer(target, numAttachments, attachments);
+		}
+
+		inline void irrGlClipControl(GLenum origin, GLenum depth)
+		{
+			if (pGlClipControl)
+				pGlClipControl(origin, depth);
+		}
+
+		inline bool irrGlTexStorage2D(GLenum target, GLsizei levels, GLint internalformat, GLsizei width, GLsizei height)
+		{
+			return false;
+		}
+
 		inline void irrGlActiveStencilFace(GLenum face)
 		{
 		}
@@ -184,6 +237,20 @@ namespace video
 		inline void irrGlBlendEquationSeparateIndexed(GLuint buf, GLenum modeRGB, GLenum modeAlpha)
 		{
 		}
+
+	protected:
+		// OpenGL ES 3.0 functions, loaded by initExtensions() if the context has them
+		typedef void (GL_APIENTRY *PFNIRRGLRENDERBUFFERSTORAGEMULTISAMPLEPROC)(GLenum, GLsizei, GLenum, GLsizei, GLsizei);
+		typedef void (GL_APIENTRY *PFNIRRGLBLITFRAMEBUFFERPROC)(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum);
+		typedef void (GL_APIENTRY *PFNIRRGLINVALIDATEFRAMEBUFFERPROC)(GLenum, GLsizei, const GLenum*);
+
+		PFNIRRGLRENDERBUFFERSTORAGEMULTISAMPLEPROC pGlRenderbufferStorageMultisample;
+		PFNIRRGLBLITFRAMEBUFFERPROC pGlBlitFramebuffer;
+		// glInvalidateFramebuffer, or glDiscardFramebufferEXT with the same parameters
+		PFNIRRGLINVALIDATEFRAMEBUFFERPROC pGlInvalidateFramebuffer;
+		// glClipControlEXT of GL_EXT_clip_control
+		typedef void (GL_APIENTRY *PFNIRRGLCLIPCONTROLPROC)(GLenum, GLenum);
+		PFNIRRGLCLIPCONTROLPROC pGlClipControl;
 	};
 
 }
@@ -87,6 +87,8 @@ COGLES2MaterialRenderer::COGLES2MaterialRenderer(COGLES2Driver* driver,
 
 COGLES2MaterialRenderer::~COGLES2MaterialRenderer()
 {
+	Driver->removeRestorableRenderer(this);
+
 	if (CallBack)
 		CallBack->drop();
 
@@ -137,11 +139,73 @@ void COGLES2MaterialRenderer::init(s32& outMaterialTypeNr,
 	if (!linkProgram())
 		return;
 
+	if (vertexShaderProgram)
+		VertexShaderSource = vertexShaderProgram;
+
+	if (pixelShaderProgram)
+		PixelShaderSource = pixelShaderProgram;
+
+	Driver->addRestorableRenderer(this);
+
 	if (addMaterial)
 		outMaterialTypeNr = Driver->addMaterialRenderer(this);
 }
 
 
+void COGLES2MaterialRenderer::startRestore()
+{
+	// the names of the lost context are invalid already, they aren't deleted
+	Program = glCreateProgram();
+
+	if (!Program)
+		return;
+
+	const GLenum shaderTypes[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	const core::stringc* sources[2] = { &VertexShaderSource, &PixelShaderSource };
+
+	for (u32 i = 0; i < 2; ++i)
+	{
+		if (sources[i]->empty())
+			continue;
+
+		const char* shader = sources[i]->c_str();
+
+		GLuint shaderHandle = glCreateShader(shaderTypes[i]);
+		glShaderSource(shaderHandle, 1, &shader, NULL);
+		glCompileShader(shaderHandle);
+		glAttachShader(Program, shaderHandle);
+	}
+
+	for ( size_t i = 0; i < EVA_COUNT; ++i )
+			glBindAttribLocation( Program, i, sBuiltInVertexAttributeNames[i]);
+
+	glLinkProgram(Program);
+}
+
+
+bool COGLES2MaterialRenderer::finishRestore()
+{
+	if (!Program)
+		return false;
+
+	GLint status = 0;
+
+	glGetProgramiv(Program, GL_LINK_STATUS, &status);
+
+	if (!status)
+	{
+		os::Printer::log("GLSL shader program failed to link after the context was lost", ELL_ERROR);
+		logProgramInfo();
+	}
+
+	// uniforms of a failed program are ignored
+	for (u32 i = 0; i < UniformInfo.size(); ++i)
+		UniformInfo[i].location = status ? glGetUniformLocation(Program, UniformInfo[i].name.c_str()) : -1;
+
+	return status != 0;
+}
+
+
 bool COGLES2MaterialRenderer::OnRender(IMaterialRendererServices* service, E_VERTEX_TYPE vtxtype)
 {
 	if (CallBack && Program)
@@ -164,8 +228,12 @@ void COGLES2MaterialRenderer::OnSetMaterial(const video::SMaterial& material,
 
 	if (Alpha)
 	{
-		cacheHandler->setBlend(true);
-		cacheHandler->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		// the coverage of the samples replaces blending in the solid pass
+		if (!Driver->usesAlphaToCoverage(material))
+		{
+			cacheHandler->setBlend(true);
+			cacheHandler->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
 	}
 	else if (FixedBlending)
 	{
@@ -260,20 +328,7 @@ bool COGLES2MaterialRenderer::linkProgram()
 		if (!status)
 		{
 			os::Printer::log("GLSL shader program failed to link", ELL_ERROR);
-
-			GLint maxLength=0;
-			GLsizei length;
-
-			glGetProgramiv(Program, GL_INFO_LOG_LENGTH, &maxLength);
-
-			if (maxLength)
-			{
-				GLchar *infoLog = new GLchar[maxLength];
-				glGetProgramInfoLog(Program, maxLength, &length, infoLog);
-				os::Printer::log(reinterpret_cast<const c8*>(infoLog), ELL_ERROR);
-				delete [] infoLog;
-			}
-
+			logProgramInfo();
 			return false;
 		}
 
@@ -333,6 +388,23 @@ bool COGLES2MaterialRenderer::linkProgram()
 }
 
 
+void COGLES2MaterialRenderer::logProgramInfo()
+{
+	GLint maxLength=0;
+	GLsizei length;
+
+	glGetProgramiv(Program, GL_INFO_LOG_LENGTH, &maxLength);
+
+	if (maxLength)
+	{
+		GLchar *infoLog = new GLchar[maxLength];
+		glGetProgramInfoLog(Program, maxLength, &length, infoLog);
+		os::Printer::log(reinterpret_cast<const c8*>(infoLog), ELL_ERROR);
+		delete [] infoLog;
+	}
+}
+
+
 void COGLES2MaterialRenderer::setBasicRenderStates(const SMaterial& material,
 						const SMaterial& lastMaterial,
 						bool resetAllRenderstates)
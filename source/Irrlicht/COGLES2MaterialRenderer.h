@@ -41,6 +41,15 @@ public:
 
 	GLuint getProgram() const;
 
+	//! Compiles and links the program again after the context was lost
+	/** Only issues the commands, so the driver can compile the programs of
+	all renderers in parallel before finishRestore() waits for them. */
+	void startRestore();
+
+	//! Checks the program of startRestore() and looks up its uniforms again
+	/** The indices of the uniforms don't change, callbacks may keep them. */
+	bool finishRestore();
+
 	virtual void OnSetMaterial(const SMaterial& material, const SMaterial& lastMaterial,
 		bool resetAllRenderstates, IMaterialRendererServices* services);
 
@@ -78,6 +87,7 @@ protected:
 
 	bool createShader(GLenum shaderType, const char* shader);
 	bool linkProgram();
+	void logProgramInfo();
 
 	COGLES2Driver* Driver;
 	IShaderConstantSetCallBack* CallBack;
@@ -96,6 +106,10 @@ protected:
 	GLuint Program;
 	core::array<SUniformInfo> UniformInfo;
 	s32 UserData;
+
+	//! Kept for compiling the program again after the context was lost
+	core::stringc VertexShaderSource;
+	core::stringc PixelShaderSource;
 };
 
 
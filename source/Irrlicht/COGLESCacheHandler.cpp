@@ -0,0 +1,284 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#include "COGLESCacheHandler.h"
+
+#ifdef _IRR_COMPILE_WITH_OGLES1_
+
+#include "COGLESDriver.h"
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	//! Cached texture environment parameters and their initial values from the specification
+	const GLenum TexEnvNames[] =
+	{
+		GL_TEXTURE_ENV_MODE, GL_COMBINE_RGB, GL_COMBINE_ALPHA,
+		GL_SRC0_RGB, GL_SRC1_RGB, GL_SRC2_RGB, GL_SRC0_ALPHA, GL_SRC1_ALPHA, GL_SRC2_ALPHA,
+		GL_OPERAND0_RGB, GL_OPERAND1_RGB, GL_OPERAND2_RGB, GL_OPERAND0_ALPHA, GL_OPERAND1_ALPHA, GL_OPERAND2_ALPHA
+	};
+
+	const GLint TexEnvDefaults[] =
+	{
+		GL_MODULATE, GL_MODULATE, GL_MODULATE,
+		GL_TEXTURE, GL_PREVIOUS, GL_CONSTANT, GL_TEXTURE, GL_PREVIOUS, GL_CONSTANT,
+		GL_SRC_COLOR, GL_SRC_COLOR, GL_SRC_ALPHA, GL_SRC_ALPHA, GL_SRC_ALPHA, GL_SRC_ALPHA
+	};
+}
+
+/* COGLES1CacheHandler */
+
+COGLES1CacheHandler::COGLES1CacheHandler(COGLES1Driver* driver) :
+	COpenGLCoreCacheHandler<COGLES1Driver, COGLES1Texture>(driver), AlphaMode(GL_ALWAYS), AlphaRef(0.f), AlphaTest(false),
+	Lighting(false), Fog(false), ShadeModel(GL_SMOOTH), MatrixMode(GL_MODELVIEW), ClientActiveTexture(GL_TEXTURE0),
+	ClientStateVertex(false), ClientStateNormal(false), ClientStateColor(false), ClientStateTexCoord0(false)
+{
+	// Initial OpenGL values from specification.
+
+	glAlphaFunc(AlphaMode, AlphaRef);
+	glDisable(GL_ALPHA_TEST);
+
+	glDisable(GL_LIGHTING);
+	glDisable(GL_FOG);
+	glShadeModel(ShadeModel);
+
+	glMatrixMode(MatrixMode);
+
+	glClientActiveTexture(ClientActiveTexture);
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	// The texture environment and the texture matrices are only assumed to be
+	// in their initial state, the context is new when the driver creates the cache.
+	for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i)
+	{
+		TextureMatrixIdentity[i] = true;
+
+		for (u32 j = 0; j < TEXENV_PARAM_COUNT; ++j)
+			TexEnv[i][j] = TexEnvDefaults[j];
+
+		TexEnvScale[i] = 1.f;
+	}
+}
+
+COGLES1CacheHandler::~COGLES1CacheHandler()
+{
+}
+
+void COGLES1CacheHandler::setAlphaFunc(GLenum mode, GLclampf ref)
+{
+	if (AlphaMode != mode || AlphaRef != ref)
+	{
+		glAlphaFunc(mode, ref);
+
+		AlphaMode = mode;
+		AlphaRef = ref;
+	}
+}
+
+void COGLES1CacheHandler::setAlphaTest(bool enable)
+{
+	if (AlphaTest != enable)
+	{
+		if (enable)
+			glEnable(GL_ALPHA_TEST);
+		else
+			glDisable(GL_ALPHA_TEST);
+		AlphaTest = enable;
+	}
+}
+
+void COGLES1CacheHandler::getLighting(bool& enable) const
+{
+	enable = Lighting;
+}
+
+void COGLES1CacheHandler::setLighting(bool enable)
+{
+	if (Lighting != enable)
+	{
+		if (enable)
+			glEnable(GL_LIGHTING);
+		else
+			glDisable(GL_LIGHTING);
+		Lighting = enable;
+	}
+}
+
+void COGLES1CacheHandler::getFog(bool& enable) const
+{
+	enable = Fog;
+}
+
+void COGLES1CacheHandler::setFog(bool enable)
+{
+	if (Fog != enable)
+	{
+		if (enable)
+			glEnable(GL_FOG);
+		else
+			glDisable(GL_FOG);
+		Fog = enable;
+	}
+}
+
+void COGLES1CacheHandler::getShadeModel(GLenum& mode) const
+{
+	mode = ShadeModel;
+}
+
+void COGLES1CacheHandler::setShadeModel(GLenum mode)
+{
+	if (ShadeModel != mode)
+	{
+		glShadeModel(mode);
+		ShadeModel = mode;
+	}
+}
+
+void COGLES1CacheHandler::setClientState(bool vertex, bool normal, bool color, bool texCoord0)
+{
+	if (ClientStateVertex != vertex)
+	{
+		if (vertex)
+			glEnableClientState(GL_VERTEX_ARRAY);
+		else
+			glDisableClientState(GL_VERTEX_ARRAY);
+
+		ClientStateVertex = vertex;
+	}
+
+	if (ClientStateNormal != normal)
+	{
+		if (normal)
+			glEnableClientState(GL_NORMAL_ARRAY);
+		else
+			glDisableClientState(GL_NORMAL_ARRAY);
+
+		ClientStateNormal = normal;
+	}
+
+	if (ClientStateColor != color)
+	{
+		if (color)
+			glEnableClientState(GL_COLOR_ARRAY);
+		else
+			glDisableClientState(GL_COLOR_ARRAY);
+
+		ClientStateColor = color;
+	}
+
+	if (ClientStateTexCoord0 != texCoord0)
+	{
+		setClientActiveTexture(GL_TEXTURE0);
+
+		if (texCoord0)
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		else
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+		ClientStateTexCoord0 = texCoord0;
+	}
+}
+
+void COGLES1CacheHandler::setMatrixMode(GLenum mode)
+{
+	if (MatrixMode != mode)
+	{
+		glMatrixMode(mode);
+		MatrixMode = mode;
+	}
+}
+
+void COGLES1CacheHandler::loadMatrix(GLenum mode, const GLfloat* matrix)
+{
+	setMatrixMode(mode);
+	glLoadMatrixf(matrix);
+
+	if (mode == GL_TEXTURE && getActiveUnit() < MATERIAL_MAX_TEXTURES)
+		TextureMatrixIdentity[getActiveUnit()] = false;
+}
+
+void COGLES1CacheHandler::loadIdentity(GLenum mode)
+{
+	const u32 unit = getActiveUnit();
+
+	if (mode == GL_TEXTURE && unit < MATERIAL_MAX_TEXTURES)
+	{
+		if (TextureMatrixIdentity[unit])
+			return;
+
+		TextureMatrixIdentity[unit] = true;
+	}
+
+	setMatrixMode(mode);
+	glLoadIdentity();
+}
+
+void COGLES1CacheHandler::setClientActiveTexture(GLenum texture)
+{
+	if (ClientActiveTexture != texture)
+	{
+		glClientActiveTexture(texture);
+		ClientActiveTexture = texture;
+	}
+}
+
+void COGLES1CacheHandler::setTexEnv(GLenum name, GLint param)
+{
+	const u32 unit = getActiveUnit();
+	const s32 index = getTexEnvIndex(name);
+
+	if (unit >= MATERIAL_MAX_TEXTURES || index < 0)
+	{
+		glTexEnvi(GL_TEXTURE_ENV, name, param);
+	}
+	else if (TexEnv[unit][index] != param)
+	{
+		glTexEnvi(GL_TEXTURE_ENV, name, param);
+		TexEnv[unit][index] = param;
+	}
+}
+
+void COGLES1CacheHandler::setTexEnvScale(GLfloat scale)
+{
+	const u32 unit = getActiveUnit();
+
+	if (unit >= MATERIAL_MAX_TEXTURES)
+	{
+		glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, scale);
+	}
+	else if (TexEnvScale[unit] != scale)
+	{
+		glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, scale);
+		TexEnvScale[unit] = scale;
+	}
+}
+
+s32 COGLES1CacheHandler::getTexEnvIndex(GLenum name)
+{
+	for (s32 i = 0; i < TEXENV_PARAM_COUNT; ++i)
+	{
+		if (TexEnvNames[i] == name)
+			return i;
+	}
+
+	return -1;
+}
+
+u32 COGLES1CacheHandler::getActiveUnit() const
+{
+	return ActiveTexture - GL_TEXTURE0;
+}
+
+} // end namespace
+} // end namespace
+
+#endif // _IRR_COMPILE_WITH_OGLES1_
@@ -0,0 +1,112 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#ifndef __C_OGLES1_CACHE_HANDLER_H_INCLUDED__
+#define __C_OGLES1_CACHE_HANDLER_H_INCLUDED__
+
+
+#ifdef _IRR_COMPILE_WITH_OGLES1_
+
+#include "COGLESCommon.h"
+
+#include "COpenGLCoreFeature.h"
+#include "COpenGLCoreTexture.h"
+#include "COpenGLCoreCacheHandler.h"
+
+namespace irr
+{
+namespace video
+{
+
+	//! Cache for the fixed function state of OpenGL ES 1.x
+	class COGLES1CacheHandler : public COpenGLCoreCacheHandler<COGLES1Driver, COGLES1Texture>
+	{
+	public:
+		COGLES1CacheHandler(COGLES1Driver* driver);
+		virtual ~COGLES1CacheHandler();
+
+		// Alpha calls.
+
+		void setAlphaFunc(GLenum mode, GLclampf ref);
+
+		void setAlphaTest(bool enable);
+
+		// Lighting, fog and shading calls.
+
+		void getLighting(bool& enable) const;
+
+		void setLighting(bool enable);
+
+		void getFog(bool& enable) const;
+
+		void setFog(bool enable);
+
+		void getShadeModel(GLenum& mode) const;
+
+		void setShadeModel(GLenum mode);
+
+		// Client state calls.
+
+		void setClientState(bool vertex, bool normal, bool color, bool texCoord0);
+
+		// Matrix calls.
+
+		void setMatrixMode(GLenum mode);
+
+		//! Loads a matrix into the stack of the given mode
+		void loadMatrix(GLenum mode, const GLfloat* matrix);
+
+		//! Loads the identity into the stack of the given mode
+		/** Texture matrices remember whether they are the identity already,
+		so resetting them for every material is free. */
+		void loadIdentity(GLenum mode);
+
+		// Texture calls.
+
+		void setClientActiveTexture(GLenum texture);
+
+		//! Sets an integer parameter of the texture environment of the active texture unit
+		void setTexEnv(GLenum name, GLint param);
+
+		//! Sets GL_RGB_SCALE of the texture environment of the active texture unit
+		void setTexEnvScale(GLfloat scale);
+
+	protected:
+		enum
+		{
+			TEXENV_PARAM_COUNT = 15
+		};
+
+		//! Index of a texture environment parameter in TexEnv, or -1 if it isn't cached
+		static s32 getTexEnvIndex(GLenum name);
+
+		//! Texture unit the texture environment and texture matrix calls apply to
+		u32 getActiveUnit() const;
+
+		GLenum AlphaMode;
+		GLclampf AlphaRef;
+		bool AlphaTest;
+
+		bool Lighting;
+		bool Fog;
+		GLenum ShadeModel;
+
+		GLenum MatrixMode;
+		bool TextureMatrixIdentity[MATERIAL_MAX_TEXTURES];
+
+		GLenum ClientActiveTexture;
+
+		bool ClientStateVertex;
+		bool ClientStateNormal;
+		bool ClientStateColor;
+		bool ClientStateTexCoord0;
+
+		GLint TexEnv[MATERIAL_MAX_TEXTURES][TEXENV_PARAM_COUNT];
+		GLfloat TexEnvScale[MATERIAL_MAX_TEXTURES];
+	};
+
+} // end namespace video
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_OGLES1_
+#endif
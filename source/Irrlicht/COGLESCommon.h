@@ -50,6 +50,7 @@ typedef char GLchar;
 #define GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS_OES
 #define GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT_OES
 #define GL_FRAMEBUFFER_UNSUPPORTED GL_FRAMEBUFFER_UNSUPPORTED_OES
+#define GL_RENDERBUFFER GL_RENDERBUFFER_OES
 #else
 #define GL_NONE 0
 #define GL_FRAMEBUFFER 0
@@ -65,6 +66,7 @@ typedef char GLchar;
 #define GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS 5
 #define GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT 6
 #define GL_FRAMEBUFFER_UNSUPPORTED 7
+#define GL_RENDERBUFFER 0
 #endif
 
 #define GL_DEPTH_COMPONENT 0x1902
@@ -113,7 +115,7 @@ namespace video
 	class COGLES1Driver;
 	typedef COpenGLCoreTexture<COGLES1Driver> COGLES1Texture;
 	typedef COpenGLCoreRenderTarget<COGLES1Driver, COGLES1Texture> COGLES1RenderTarget;
-	typedef COpenGLCoreCacheHandler<COGLES1Driver, COGLES1Texture> COGLES1CacheHandler;
+	class COGLES1CacheHandler;
 
 }
 }
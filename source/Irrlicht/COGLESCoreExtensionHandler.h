@@ -9,6 +9,7 @@
 
 #include "irrMath.h"
 #include "COpenGLCoreFeature.h"
+#include "CGLExtensionNameIndex.h"
 
 namespace irr
 {
@@ -372,6 +373,11 @@ namespace video
 	protected:
 
 		const char* getFeatureString(size_t index) const
+		{
+			return getFeatureStrings()[index];
+		}
+
+		static const char* const* getFeatureStrings()
 		{
 			// Extension names from https://www.khronos.org/registry/OpenGL/index_es.php
 			// One for each EOGLESFeatures
@@ -688,7 +694,7 @@ namespace video
 				"WGL_ARB_context_flush_control"
 			};
 
-			return OGLESFeatureStrings[index];
+			return OGLESFeatureStrings;
 		}
 
 
@@ -725,32 +731,9 @@ namespace video
 			if (extensions.find("GL_IMG_user_clip_planes"))
 				FeatureAvailable[IRR_GL_IMG_user_clip_plane] = true;
 
-			const u32 size = extensions.size() + 1;
-			c8* str = new c8[size];
-			strncpy(str, extensions.c_str(), extensions.size());
-			str[extensions.size()] = ' ';
-			c8* p = str;
-
-			for (u32 i=0; i<size; ++i)
-			{
-				if (str[i] == ' ')
-				{
-					str[i] = 0;
-					if (*p)
-						for (size_t j=0; j<IRR_OGLES_Feature_Count; ++j)
-						{
-							if (!strcmp(getFeatureString(j), p))
-							{
-								FeatureAvailable[j] = true;
-								break;
-							}
-						}
-
-					p = p + strlen(p) + 1;
-				}
-			}
-
-			delete[] str;
+			static const CGLExtensionNameIndex knownExtensions(getFeatureStrings(), IRR_OGLES_Feature_Count);
+			knownExtensions.parse(extensions.c_str(),
+				[this](u32 index) { FeatureAvailable[index] = true; });
 		}
 
 
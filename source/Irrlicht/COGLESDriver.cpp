@@ -10,7 +10,7 @@
 
 #include "COpenGLCoreTexture.h"
 #include "COpenGLCoreRenderTarget.h"
-#include "COpenGLCoreCacheHandler.h"
+#include "COGLESCacheHandler.h"
 
 #include "COGLESMaterialRenderer.h"
 
@@ -126,9 +126,9 @@ bool COGLES1Driver::genericDriverInit(const core::dimension2d<u32>& screenSize,
 	glHint(GL_GENERATE_MIPMAP_HINT, GL_FASTEST);
 	glHint(GL_LINE_SMOOTH_HINT, GL_FASTEST);
 	glHint(GL_POINT_SMOOTH_HINT, GL_FASTEST);
-	glDepthFunc(GL_LEQUAL);
+	CacheHandler->setDepthFunc(GL_LEQUAL);
 	glFrontFace(GL_CW);
-	glAlphaFunc(GL_GREATER, 0.f);
+	CacheHandler->setAlphaFunc(GL_GREATER, 0.f);
 
 	// create material renderers
 	createMaterialRenderers();
@@ -200,12 +200,15 @@ bool COGLES1Driver::endScene()
 {
 	CNullDriver::endScene();
 
+	const u64 swapBeginNs = os::Timer::getRealTimeNs();
 	glFlush();
 
+	bool status = false;
 	if (ContextManager)
-		return ContextManager->swapBuffers();
+		status = ContextManager->swapBuffers();
 
-	return false;
+	registerSwapTime(swapBeginNs);
+	return status;
 }
 
 
@@ -228,8 +231,7 @@ void COGLES1Driver::setTransform(E_TRANSFORMATION_STATE state, const core::matri
 	case ETS_WORLD:
 		{
 			// OGLES1 only has a model matrix, view and world is not existent. so lets fake these two.
-			glMatrixMode(GL_MODELVIEW);
-			glLoadMatrixf((Matrices[ETS_VIEW] * Matrices[ETS_WORLD]).pointer());
+			CacheHandler->loadMatrix(GL_MODELVIEW, (Matrices[ETS_VIEW] * Matrices[ETS_WORLD]).pointer());
 			// we have to update the clip planes to the latest view matrix
 			for (u32 i=0; i<MaxUserClipPlanes; ++i)
 				if (UserClipPlaneEnabled[i])
@@ -242,8 +244,7 @@ void COGLES1Driver::setTransform(E_TRANSFORMATION_STATE state, const core::matri
 			getGLMatrix(glmat, mat);
 			// flip z to compensate OGLES1s right-hand coordinate system
 			glmat[12] *= -1.0f;
-			glMatrixMode(GL_PROJECTION);
-			glLoadMatrixf(glmat);
+			CacheHandler->loadMatrix(GL_PROJECTION, glmat);
 		}
 		break;
 	default:
@@ -321,6 +322,9 @@ bool COGLES1Driver::updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer)
 
 	glBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID );
 
+	countBufferUpload(vertexCount * vertexSize, newBuffer);
+	FrameStats.VerticesUploaded += vertexCount;
+
 	// copy data to graphics card
 	if (!newBuffer)
 		glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * vertexSize, buffer.const_pointer());
@@ -385,6 +389,8 @@ bool COGLES1Driver::updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffer)
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
 
+	countBufferUpload(indexCount * indexSize, newBuffer);
+
 	// copy data to graphics card
 	if (!newBuffer)
 		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount * indexSize, indices);
@@ -446,7 +452,7 @@ COGLES1Driver::SHWBufferLink *COGLES1Driver::createHardwareBuffer(const scene::I
 	if (!mb || (mb->getHardwareMappingHint_Index()==scene::EHM_NEVER && mb->getHardwareMappingHint_Vertex()==scene::EHM_NEVER))
 		return 0;
 
-	SHWBufferLink_opengl *HWBuffer=new SHWBufferLink_opengl(mb);
+	SHWBufferLink_opengl *HWBuffer=new SHWBufferLink_opengl(mb, this);
 
 	//add to map
 	HWBuffer->listPosition = HWBufferList.insert(HWBufferList.end(), HWBuffer);
@@ -554,6 +560,10 @@ void COGLES1Driver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 	if (!checkPrimitiveCount(primitiveCount))
 		return;
 
+	// skinned and compact vertices need the shader variants of the OpenGL 3 driver
+	if (vType == EVT_SKINNED || vType == EVT_COMPACT)
+		return;
+
 	setRenderStates3DMode();
 
 	drawVertexPrimitiveList2d3d(vertices, vertexCount, (const u16*)indexList, primitiveCount, vType, pType, iType);
@@ -611,21 +621,20 @@ void COGLES1Driver::drawVertexPrimitiveList2d3d(const void* vertices, u32 vertex
 				}
 			}
 			break;
+			case EVT_SKINNED:
+			case EVT_COMPACT:
+				break;
 		}
 	}
 
 	// draw everything
-	glClientActiveTexture(GL_TEXTURE0);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_VERTEX_ARRAY);
-	if ((pType!=scene::EPT_POINTS) && (pType!=scene::EPT_POINT_SPRITES))
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	const bool points = (pType==scene::EPT_POINTS) || (pType==scene::EPT_POINT_SPRITES);
+	CacheHandler->setClientState(true, threed && !points, true, !points);
+	CacheHandler->setClientActiveTexture(GL_TEXTURE0);
 #ifdef GL_OES_point_size_array
-	else if (FeatureAvailable[COGLESCoreExtensionHandler::IRR_GL_OES_point_size_array] && (Material.Thickness==0.0f))
+	if (points && FeatureAvailable[COGLESCoreExtensionHandler::IRR_GL_OES_point_size_array] && (Material.Thickness==0.0f))
 		glEnableClientState(GL_POINT_SIZE_ARRAY_OES);
 #endif
-	if (threed && (pType!=scene::EPT_POINTS) && (pType!=scene::EPT_POINT_SPRITES))
-		glEnableClientState(GL_NORMAL_ARRAY);
 
 	if (vertices)
 		glColorPointer(4, GL_UNSIGNED_BYTE, 0, &ColorBuffer[0]);
@@ -650,7 +659,7 @@ void COGLES1Driver::drawVertexPrimitiveList2d3d(const void* vertices, u32 vertex
 
 			if (Feature.MaxTextureUnits > 0 && CacheHandler->getTextureCache().get(1))
 			{
-				glClientActiveTexture(GL_TEXTURE0 + 1);
+				CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 1);
 				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 				if (vertices)
 					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].TCoords);
@@ -676,7 +685,7 @@ void COGLES1Driver::drawVertexPrimitiveList2d3d(const void* vertices, u32 vertex
 
 			if (Feature.MaxTextureUnits > 0)
 			{
-				glClientActiveTexture(GL_TEXTURE0 + 1);
+				CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 1);
 				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 				if (vertices)
 					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), &(static_cast<const S3DVertex2TCoords*>(vertices))[0].TCoords2);
@@ -702,14 +711,14 @@ void COGLES1Driver::drawVertexPrimitiveList2d3d(const void* vertices, u32 vertex
 
 			if (Feature.MaxTextureUnits > 0)
 			{
-				glClientActiveTexture(GL_TEXTURE0 + 1);
+				CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 1);
 				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 				if (vertices)
 					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Tangent);
 				else
 					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(36));
 
-				glClientActiveTexture(GL_TEXTURE0 + 2);
+				CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 2);
 				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 				if (vertices)
 					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Binormal);
@@ -717,6 +726,9 @@ void COGLES1Driver::drawVertexPrimitiveList2d3d(const void* vertices, u32 vertex
 					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(48));
 			}
 			break;
+		case EVT_SKINNED:
+		case EVT_COMPACT:
+			break;
 	}
 
 	GLenum indexSize=0;
@@ -807,26 +819,23 @@ void COGLES1Driver::drawVertexPrimitiveList2d3d(const void* vertices, u32 vertex
 	{
 		if (vType == EVT_TANGENTS)
 		{
-			glClientActiveTexture(GL_TEXTURE0 + 2);
+			CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 2);
 			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 		}
 		if ((vType != EVT_STANDARD) || CacheHandler->getTextureCache().get(1))
 		{
-			glClientActiveTexture(GL_TEXTURE0 + 1);
+			CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 1);
 			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 		}
-		glClientActiveTexture(GL_TEXTURE0);
+		CacheHandler->setClientActiveTexture(GL_TEXTURE0);
 	}
 
 #ifdef GL_OES_point_size_array
-	if (FeatureAvailable[COGLESCoreExtensionHandler::IRR_GL_OES_point_size_array] && (Material.Thickness==0.0f))
+	if (points && FeatureAvailable[COGLESCoreExtensionHandler::IRR_GL_OES_point_size_array] && (Material.Thickness==0.0f))
 		glDisableClientState(GL_POINT_SIZE_ARRAY_OES);
 #endif
 
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_VERTEX_ARRAY);
-	glDisableClientState(GL_NORMAL_ARRAY);
-	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	// the other arrays stay enabled for the next draw, the cache handler knows about them
 }
 
 
@@ -1018,10 +1027,8 @@ void COGLES1Driver::draw2DImage(const video::ITexture* texture, u32 layer, bool
 
 	setRenderStates2DMode(false, true, true);
 
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
+	CacheHandler->loadIdentity(GL_PROJECTION);
+	CacheHandler->loadIdentity(GL_MODELVIEW);
 
 	Transformation3DChanged = true;
 
@@ -1452,18 +1459,16 @@ void COGLES1Driver::setRenderStates3DMode()
 	{
 		// Reset Texture Stages
 		CacheHandler->setBlend(false);
-		glDisable(GL_ALPHA_TEST);
+		CacheHandler->setAlphaTest(false);
 		CacheHandler->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// switch back the matrices
-		glMatrixMode(GL_MODELVIEW);
-		glLoadMatrixf((Matrices[ETS_VIEW] * Matrices[ETS_WORLD]).pointer());
+		CacheHandler->loadMatrix(GL_MODELVIEW, (Matrices[ETS_VIEW] * Matrices[ETS_WORLD]).pointer());
 
 		GLfloat glmat[16];
 		getGLMatrix(glmat, Matrices[ETS_PROJECTION]);
 		glmat[12] *= -1.0f;
-		glMatrixMode(GL_PROJECTION);
-		glLoadMatrixf(glmat);
+		CacheHandler->loadMatrix(GL_PROJECTION, glmat);
 
 		ResetRenderStates = true;
 	}
@@ -1482,6 +1487,7 @@ void COGLES1Driver::setRenderStates3DMode()
 				Material, LastMaterial, ResetRenderStates, this);
 
 		LastMaterial = Material;
+		++FrameStats.MaterialChanges;
 		CacheHandler->correctCacheMaterial(LastMaterial);
 		ResetRenderStates = false;
 	}
@@ -1624,109 +1630,78 @@ void COGLES1Driver::setBasicRenderStates(const SMaterial& material, const SMater
 //		glPolygonMode(GL_FRONT_AND_BACK, material.Wireframe ? GL_LINE : material.PointCloud? GL_POINT : GL_FILL);
 
 	// shademode
-	if (resetAllRenderStates || (lastmaterial.GouraudShading != material.GouraudShading))
-	{
-		if (material.GouraudShading)
-			glShadeModel(GL_SMOOTH);
-		else
-			glShadeModel(GL_FLAT);
-	}
+	CacheHandler->setShadeModel(material.GouraudShading ? GL_SMOOTH : GL_FLAT);
 
 	// lighting
-	if (resetAllRenderStates || (lastmaterial.Lighting != material.Lighting))
-	{
-		if (material.Lighting)
-			glEnable(GL_LIGHTING);
-		else
-			glDisable(GL_LIGHTING);
-	}
+	CacheHandler->setLighting(material.Lighting);
 
 	// zbuffer
-	if (resetAllRenderStates || lastmaterial.ZBuffer != material.ZBuffer)
+	switch (getDepthComparison(material))
 	{
-		switch (material.ZBuffer)
-		{
-			case ECFN_DISABLED:
-				glDisable(GL_DEPTH_TEST);
-				break;
-			case ECFN_LESSEQUAL:
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_LEQUAL);
-				break;
-			case ECFN_EQUAL:
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_EQUAL);
-				break;
-			case ECFN_LESS:
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_LESS);
-				break;
-			case ECFN_NOTEQUAL:
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_NOTEQUAL);
-				break;
-			case ECFN_GREATEREQUAL:
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_GEQUAL);
-				break;
-			case ECFN_GREATER:
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_GREATER);
-				break;
-			case ECFN_ALWAYS:
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_ALWAYS);
-				break;
-			case ECFN_NEVER:
-				glEnable(GL_DEPTH_TEST);
-				glDepthFunc(GL_NEVER);
-				break;
-		}
+		case ECFN_DISABLED:
+			CacheHandler->setDepthTest(false);
+			break;
+		case ECFN_LESSEQUAL:
+			CacheHandler->setDepthTest(true);
+			CacheHandler->setDepthFunc(GL_LEQUAL);
+			break;
+		case ECFN_EQUAL:
+			CacheHandler->setDepthTest(true);
+			CacheHandler->setDepthFunc(GL_EQUAL);
+			break;
+		case ECFN_LESS:
+			CacheHandler->setDepthTest(true);
+			CacheHandler->setDepthFunc(GL_LESS);
+			break;
+		case ECFN_NOTEQUAL:
+			CacheHandler->setDepthTest(true);
+			CacheHandler->setDepthFunc(GL_NOTEQUAL);
+			break;
+		case ECFN_GREATEREQUAL:
+			CacheHandler->setDepthTest(true);
+			CacheHandler->setDepthFunc(GL_GEQUAL);
+			break;
+		case ECFN_GREATER:
+			CacheHandler->setDepthTest(true);
+			CacheHandler->setDepthFunc(GL_GREATER);
+			break;
+		case ECFN_ALWAYS:
+			CacheHandler->setDepthTest(true);
+			CacheHandler->setDepthFunc(GL_ALWAYS);
+			break;
+		case ECFN_NEVER:
+			CacheHandler->setDepthTest(true);
+			CacheHandler->setDepthFunc(GL_NEVER);
+			break;
 	}
 
 	// zwrite
-	if (getWriteZBuffer(material))
+	CacheHandler->setDepthMask(getWriteZBuffer(material));
+
+	// back face culling
+	if ((material.FrontfaceCulling) && (material.BackfaceCulling))
 	{
-		glDepthMask(GL_TRUE);
+		CacheHandler->setCullFaceFunc(GL_FRONT_AND_BACK);
+		CacheHandler->setCullFace(true);
 	}
-	else
+	else if (material.BackfaceCulling)
 	{
-		glDepthMask(GL_FALSE);
+		CacheHandler->setCullFaceFunc(GL_BACK);
+		CacheHandler->setCullFace(true);
 	}
-
-	// back face culling
-	if (resetAllRenderStates || (lastmaterial.FrontfaceCulling != material.FrontfaceCulling) || (lastmaterial.BackfaceCulling != material.BackfaceCulling))
+	else if (material.FrontfaceCulling)
 	{
-		if ((material.FrontfaceCulling) && (material.BackfaceCulling))
-		{
-			glCullFace(GL_FRONT_AND_BACK);
-			glEnable(GL_CULL_FACE);
-		}
-		else
-		if (material.BackfaceCulling)
-		{
-			glCullFace(GL_BACK);
-			glEnable(GL_CULL_FACE);
-		}
-		else
-		if (material.FrontfaceCulling)
-		{
-			glCullFace(GL_FRONT);
-			glEnable(GL_CULL_FACE);
-		}
-		else
-			glDisable(GL_CULL_FACE);
+		CacheHandler->setCullFaceFunc(GL_FRONT);
+		CacheHandler->setCullFace(true);
 	}
-
-	// fog
-	if (resetAllRenderStates || lastmaterial.FogEnable != material.FogEnable)
+	else
 	{
-		if (material.FogEnable)
-			glEnable(GL_FOG);
-		else
-			glDisable(GL_FOG);
+		CacheHandler->setCullFace(false);
 	}
 
+	// fog
+	CacheHandler->setFog(material.FogEnable);
+
 	// normalization
 	if (resetAllRenderStates || lastmaterial.NormalizeNormals != material.NormalizeNormals)
 	{
@@ -1737,14 +1712,7 @@ void COGLES1Driver::setBasicRenderStates(const SMaterial& material, const SMater
 	}
 
 	// Color Mask
-	if (resetAllRenderStates || lastmaterial.ColorMask != material.ColorMask)
-	{
-		glColorMask(
-			(material.ColorMask & ECP_RED)?GL_TRUE:GL_FALSE,
-			(material.ColorMask & ECP_GREEN)?GL_TRUE:GL_FALSE,
-			(material.ColorMask & ECP_BLUE)?GL_TRUE:GL_FALSE,
-			(material.ColorMask & ECP_ALPHA)?GL_TRUE:GL_FALSE);
-	}
+	CacheHandler->setColorMask(material.ColorMask);
 
 	// Blend Equation
 	if (material.BlendOperation == EBO_NONE)
@@ -1878,10 +1846,8 @@ void COGLES1Driver::setTextureRenderStates(const SMaterial& material, bool reset
 		{
 			const bool isRTT = tmpTexture->isRenderTarget();
 
-			glMatrixMode(GL_TEXTURE);
-
 			if (!isRTT && Matrices[ETS_TEXTURE_0 + i].isIdentity())
-				glLoadIdentity();
+				CacheHandler->loadIdentity(GL_TEXTURE);
 			else
 			{
 				GLfloat glmat[16];
@@ -1889,7 +1855,7 @@ void COGLES1Driver::setTextureRenderStates(const SMaterial& material, bool reset
 					getGLTextureMatrix(glmat, Matrices[ETS_TEXTURE_0 + i] * TextureFlipMatrix);
 				else
 					getGLTextureMatrix(glmat, Matrices[ETS_TEXTURE_0 + i]);
-				glLoadMatrixf(glmat);
+				CacheHandler->loadMatrix(GL_TEXTURE, glmat);
 			}
 		}
 
@@ -2020,16 +1986,13 @@ void COGLES1Driver::setRenderStates2DMode(bool alpha, bool texture, bool alphaCh
 		}
 		if (Transformation3DChanged)
 		{
-			glMatrixMode(GL_PROJECTION);
-
 			const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
 			core::matrix4 m(core::matrix4::EM4CONST_NOTHING);
 			m.buildProjectionMatrixOrthoLH(f32(renderTargetSize.Width), f32(-(s32)(renderTargetSize.Height)), -1.0f, 1.0f);
 			m.setTranslation(core::vector3df(-1, 1, 0));
-			glLoadMatrixf(m.pointer());
+			CacheHandler->loadMatrix(GL_PROJECTION, m.pointer());
 
-			glMatrixMode(GL_MODELVIEW);
-			glLoadIdentity();
+			CacheHandler->loadIdentity(GL_MODELVIEW);
 
 			Transformation3DChanged = false;
 		}
@@ -2043,6 +2006,7 @@ void COGLES1Driver::setRenderStates2DMode(bool alpha, bool texture, bool alphaCh
 	setBasicRenderStates(Material, LastMaterial, false);
 
 	LastMaterial = Material;
+	++FrameStats.MaterialChanges;
 	CacheHandler->correctCacheMaterial(LastMaterial);
 
 	// no alphaChannel without texture
@@ -2053,13 +2017,13 @@ void COGLES1Driver::setRenderStates2DMode(bool alpha, bool texture, bool alphaCh
 		CacheHandler->setBlend(true);
 		CacheHandler->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 		CacheHandler->setBlendEquation(GL_FUNC_ADD);
-		glEnable(GL_ALPHA_TEST);
-		glAlphaFunc(GL_GREATER, 0.f);
+		CacheHandler->setAlphaTest(true);
+		CacheHandler->setAlphaFunc(GL_GREATER, 0.f);
 	}
 	else
 	{
 		CacheHandler->setBlend(false);
-		glDisable(GL_ALPHA_TEST);
+		CacheHandler->setAlphaTest(false);
 	}
 
 	if (texture)
@@ -2073,34 +2037,34 @@ void COGLES1Driver::setRenderStates2DMode(bool alpha, bool texture, bool alphaCh
 			// if alpha and alpha texture just modulate, otherwise use only the alpha channel
 			if (alpha)
 			{
-				glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+				CacheHandler->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 			}
 			else
 			{
-				glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_ALPHA, GL_TEXTURE);
+				CacheHandler->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
+				CacheHandler->setTexEnv(GL_COMBINE_ALPHA, GL_REPLACE);
+				CacheHandler->setTexEnv(GL_SRC0_ALPHA, GL_TEXTURE);
 				// rgb always modulates
-				glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_TEXTURE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_PRIMARY_COLOR);
+				CacheHandler->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
+				CacheHandler->setTexEnv(GL_SRC0_RGB, GL_TEXTURE);
+				CacheHandler->setTexEnv(GL_SRC1_RGB, GL_PRIMARY_COLOR);
 			}
 		}
 		else
 		{
 			if (alpha)
 			{
-				glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_ALPHA, GL_PRIMARY_COLOR);
+				CacheHandler->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
+				CacheHandler->setTexEnv(GL_COMBINE_ALPHA, GL_REPLACE);
+				CacheHandler->setTexEnv(GL_SRC0_ALPHA, GL_PRIMARY_COLOR);
 				// rgb always modulates
-				glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_TEXTURE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_PRIMARY_COLOR);
+				CacheHandler->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
+				CacheHandler->setTexEnv(GL_SRC0_RGB, GL_TEXTURE);
+				CacheHandler->setTexEnv(GL_SRC1_RGB, GL_PRIMARY_COLOR);
 			}
 			else
 			{
-				glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+				CacheHandler->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 			}
 		}
 	}
@@ -2153,30 +2117,34 @@ void COGLES1Driver::drawStencilShadowVolume(const core::array<core::vector3df>&
 	if (!StencilBuffer || !count)
 		return;
 
-	u8 colorMask = LastMaterial.ColorMask;
-	const GLboolean lightingEnabled = glIsEnabled(GL_LIGHTING);
-	const GLboolean fogEnabled = glIsEnabled(GL_FOG);
-	const GLboolean cullFaceEnabled = glIsEnabled(GL_CULL_FACE);
-
-	GLint cullFaceMode = 0;
-	glGetIntegerv(GL_CULL_FACE_MODE, &cullFaceMode);
-	GLint depthFunc = 0;
-	glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
-	GLboolean depthMask = 0;
-	glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
-
-	glDisable(GL_LIGHTING);
-	glDisable(GL_FOG);
-	glDepthFunc(GL_LEQUAL);
-	glDepthMask(GL_FALSE);
+	// the previous states come from the cache, querying them would stall the pipeline
+	u8 colorMask = 0;
+	CacheHandler->getColorMask(colorMask);
+	bool lightingEnabled = false;
+	CacheHandler->getLighting(lightingEnabled);
+	bool fogEnabled = false;
+	CacheHandler->getFog(fogEnabled);
+	bool cullFaceEnabled = false;
+	CacheHandler->getCullFace(cullFaceEnabled);
+	GLenum cullFaceMode = 0;
+	CacheHandler->getCullFaceFunc(cullFaceMode);
+	GLenum depthFunc = 0;
+	CacheHandler->getDepthFunc(depthFunc);
+	bool depthMask = false;
+	CacheHandler->getDepthMask(depthMask);
+
+	CacheHandler->setLighting(false);
+	CacheHandler->setFog(false);
+	CacheHandler->setDepthFunc(GL_LEQUAL);
+	CacheHandler->setDepthMask(false);
 
 	if (!(debugDataVisible & (scene::EDS_SKELETON|scene::EDS_MESH_WIRE_OVERLAY)))
 	{
-		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+		CacheHandler->setColorMask(ECP_NONE);
 		glEnable(GL_STENCIL_TEST);
 	}
 
-	glEnableClientState(GL_VERTEX_ARRAY);
+	CacheHandler->setClientState(true, false, false, false);
 	glVertexPointer(3, GL_FLOAT, sizeof(core::vector3df), triangles.const_pointer());
 
 	glStencilMask(~0);
@@ -2193,52 +2161,39 @@ void COGLES1Driver::drawStencilShadowVolume(const core::array<core::vector3df>&
 	}
 #endif
 
-	glEnable(GL_CULL_FACE);
+	CacheHandler->setCullFace(true);
 
 	if (zfail)
 	{
-		glCullFace(GL_FRONT);
+		CacheHandler->setCullFaceFunc(GL_FRONT);
 		glStencilOp(GL_KEEP, incr, GL_KEEP);
 		glDrawArrays(GL_TRIANGLES, 0, count);
 
-		glCullFace(GL_BACK);
+		CacheHandler->setCullFaceFunc(GL_BACK);
 		glStencilOp(GL_KEEP, decr, GL_KEEP);
 		glDrawArrays(GL_TRIANGLES, 0, count);
 	}
 	else // zpass
 	{
-		glCullFace(GL_BACK);
+		CacheHandler->setCullFaceFunc(GL_BACK);
 		glStencilOp(GL_KEEP, GL_KEEP, incr);
 		glDrawArrays(GL_TRIANGLES, 0, count);
 
-		glCullFace(GL_FRONT);
+		CacheHandler->setCullFaceFunc(GL_FRONT);
 		glStencilOp(GL_KEEP, GL_KEEP, decr);
 		glDrawArrays(GL_TRIANGLES, 0, count);
 	}
 
-	glDisableClientState(GL_VERTEX_ARRAY);
-
-	glColorMask((colorMask & ECP_RED)?GL_TRUE:GL_FALSE,
-			(colorMask & ECP_GREEN)?GL_TRUE:GL_FALSE,
-			(colorMask & ECP_BLUE)?GL_TRUE:GL_FALSE,
-			(colorMask & ECP_ALPHA)?GL_TRUE:GL_FALSE);
+	CacheHandler->setColorMask(colorMask);
 
 	glDisable(GL_STENCIL_TEST);
 
-	if (lightingEnabled)
-		glEnable(GL_LIGHTING);
-
-	if (fogEnabled)
-		glEnable(GL_FOG);
-
-	if (cullFaceEnabled)
-		glEnable(GL_CULL_FACE);
-	else
-		glDisable(GL_CULL_FACE);
-
-	glCullFace(cullFaceMode);
-	glDepthFunc(depthFunc);
-	glDepthMask(depthMask);
+	CacheHandler->setLighting(lightingEnabled);
+	CacheHandler->setFog(fogEnabled);
+	CacheHandler->setCullFace(cullFaceEnabled);
+	CacheHandler->setCullFaceFunc(cullFaceMode);
+	CacheHandler->setDepthFunc(depthFunc);
+	CacheHandler->setDepthMask(depthMask);
 }
 
 
@@ -2251,39 +2206,41 @@ void COGLES1Driver::drawStencilShadow(bool clearStencilBuffer,
 
 	setTextureRenderStates(SMaterial(), false);
 
-	u8 colorMask = LastMaterial.ColorMask;
-	const GLboolean lightingEnabled = glIsEnabled(GL_LIGHTING);
-	const GLboolean fogEnabled = glIsEnabled(GL_FOG);
-	const GLboolean blendEnabled = glIsEnabled(GL_BLEND);
-
-	GLboolean depthMask = 0;
-	glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
-	GLint shadeModel = 0;
-	glGetIntegerv(GL_SHADE_MODEL, &shadeModel);
-	GLint blendSrc = 0, blendDst = 0;
-	glGetIntegerv(GL_BLEND_SRC, &blendSrc);
-	glGetIntegerv(GL_BLEND_DST, &blendDst);
-
-	glDisable(GL_LIGHTING);
-	glDisable(GL_FOG);
-	glDepthMask(GL_FALSE);
-
-	glShadeModel(GL_FLAT);
-	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	u8 colorMask = 0;
+	CacheHandler->getColorMask(colorMask);
+	bool lightingEnabled = false;
+	CacheHandler->getLighting(lightingEnabled);
+	bool fogEnabled = false;
+	CacheHandler->getFog(fogEnabled);
+	bool blendEnabled = false;
+	CacheHandler->getBlend(blendEnabled);
+	bool depthMask = false;
+	CacheHandler->getDepthMask(depthMask);
+	GLenum shadeModel = 0;
+	CacheHandler->getShadeModel(shadeModel);
+	GLenum blendSrc = 0, blendDst = 0;
+	CacheHandler->getBlendFunc(blendSrc, blendDst);
+
+	CacheHandler->setLighting(false);
+	CacheHandler->setFog(false);
+	CacheHandler->setDepthMask(false);
+
+	CacheHandler->setShadeModel(GL_FLAT);
+	CacheHandler->setColorMask(ECP_ALL);
+
+	CacheHandler->setBlend(true);
+	CacheHandler->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	glEnable(GL_STENCIL_TEST);
 	glStencilFunc(GL_NOTEQUAL, 0, ~0);
 	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
 
-	glMatrixMode(GL_MODELVIEW);
+	CacheHandler->setMatrixMode(GL_MODELVIEW);
 	glPushMatrix();
-	glLoadIdentity();
-	glMatrixMode(GL_PROJECTION);
+	CacheHandler->loadIdentity(GL_MODELVIEW);
+	CacheHandler->setMatrixMode(GL_PROJECTION);
 	glPushMatrix();
-	glLoadIdentity();
+	CacheHandler->loadIdentity(GL_PROJECTION);
 
 	u16 indices[] = {0, 1, 2, 3};
 	S3DVertex vertices[4];
@@ -2296,29 +2253,20 @@ void COGLES1Driver::drawStencilShadow(bool clearStencilBuffer,
 	if (clearStencilBuffer)
 		glClear(GL_STENCIL_BUFFER_BIT);
 
-	glColorMask((colorMask & ECP_RED)?GL_TRUE:GL_FALSE,
-			(colorMask & ECP_GREEN)?GL_TRUE:GL_FALSE,
-			(colorMask & ECP_BLUE)?GL_TRUE:GL_FALSE,
-			(colorMask & ECP_ALPHA)?GL_TRUE:GL_FALSE);
+	CacheHandler->setColorMask(colorMask);
 
 	glDisable(GL_STENCIL_TEST);
 
 	glPopMatrix();
-	glMatrixMode(GL_MODELVIEW);
+	CacheHandler->setMatrixMode(GL_MODELVIEW);
 	glPopMatrix();
 
-	if (lightingEnabled)
-		glEnable(GL_LIGHTING);
-
-	if (fogEnabled)
-		glEnable(GL_FOG);
-
-	if (!blendEnabled)
-		glDisable(GL_BLEND);
-
-	glDepthMask(depthMask);
-	glShadeModel(shadeModel);
-	glBlendFunc(blendSrc, blendDst);
+	CacheHandler->setLighting(lightingEnabled);
+	CacheHandler->setFog(fogEnabled);
+	CacheHandler->setBlend(blendEnabled);
+	CacheHandler->setDepthMask(depthMask);
+	CacheHandler->setShadeModel(shadeModel);
+	CacheHandler->setBlendFunc(blendSrc, blendDst);
 }
 
 
@@ -2589,8 +2537,8 @@ bool COGLES1Driver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SCol
 
 		if (supportForFBO)
 		{
-			CacheHandler->setFBO(renderTarget->getBufferID());
 			renderTarget->update();
+			CacheHandler->setFBO(renderTarget->getBufferID());
 		}
 
 		destRenderTargetSize = renderTarget->getSize();
@@ -2650,7 +2598,7 @@ void COGLES1Driver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 
 	if (flag & ECBF_COLOR)
 	{
-		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		CacheHandler->setColorMask(ECP_ALL);
 
 		const f32 inv = 1.0f / 255.0f;
 		glClearColor(color.getRed() * inv, color.getGreen() * inv,
@@ -2661,8 +2609,8 @@ void COGLES1Driver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 
 	if (flag & ECBF_DEPTH)
 	{
-		glDepthMask(GL_TRUE);
-		glClearDepthf(depth);
+		CacheHandler->setDepthMask(true);
+		glClearDepthf(getClearDepth(depth));
 		mask |= GL_DEPTH_BUFFER_BIT;
 	}
 
@@ -2677,6 +2625,18 @@ void COGLES1Driver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 }
 
 
+void COGLES1Driver::setReverseDepth(bool reverse)
+{
+	if (reverse == ReverseDepth)
+		return;
+
+	CNullDriver::setReverseDepth(reverse);
+
+	// the depth comparisons of the current material are swapped
+	ResetRenderStates = true;
+}
+
+
 //! Returns an image created from the last rendered frame.
 // We want to read the front buffer to get the latest render finished.
 // This is not possible under ogl-es, though, so one has to call this method
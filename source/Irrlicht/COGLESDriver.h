@@ -44,7 +44,7 @@ namespace video
 
 		struct SHWBufferLink_opengl : public SHWBufferLink
 		{
-			SHWBufferLink_opengl(const scene::IMeshBuffer *_MeshBuffer): SHWBufferLink(_MeshBuffer), vbo_verticesID(0),vbo_indicesID(0){}
+			SHWBufferLink_opengl(const scene::IMeshBuffer *_MeshBuffer, CNullDriver *driver): SHWBufferLink(_MeshBuffer, driver), vbo_verticesID(0),vbo_indicesID(0){}
 
 			GLuint vbo_verticesID; //tmp
 			GLuint vbo_indicesID; //tmp
@@ -242,6 +242,9 @@ namespace video
 
 		void clearBuffers(u16 flag, SColor color = SColor(255, 0, 0, 0), f32 depth = 1.f, u8 stencil = 0) override;
 
+		//! Sets if depth values get smaller with the distance from the camera
+		void setReverseDepth(bool reverse) override;
+
 		//! Returns an image created from the last rendered frame.
 		IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override;
 
@@ -155,6 +155,40 @@ namespace video
 #endif
 		}
 
+		// multisampled render targets need OpenGL ES 3.0, Feature.MaxRenderTargetSamples stays 0
+		inline void irrGlBindRenderbuffer(GLenum target, GLuint renderbuffer)
+		{
+		}
+
+		inline void irrGlDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
+		{
+		}
+
+		inline void irrGlGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
+		{
+		}
+
+		inline void irrGlFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+		{
+		}
+
+		inline void irrGlRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+		{
+		}
+
+		inline void irrGlBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+		{
+		}
+
+		inline void irrGlInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments)
+		{
+		}
+
+		inline bool irrGlTexStorage2D(GLenum target, GLsizei levels, GLint internalformat, GLsizei width, GLsizei height)
+		{
+			return false;
+		}
+
 		inline void irrGlActiveStencilFace(GLenum face)
 		{
 		}
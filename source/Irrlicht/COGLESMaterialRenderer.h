@@ -7,9 +7,11 @@
 
 #ifdef _IRR_COMPILE_WITH_OGLES1_
 
-#include "COGLESDriver.h"
 #include "IMaterialRenderer.h"
 
+#include "COGLESDriver.h"
+#include "COGLESCacheHandler.h"
+
 namespace irr
 {
 namespace video
@@ -48,7 +50,7 @@ public:
 		{
 			// thanks to Murphy, the following line removed some
 			// bugs with several OGLES1 implementations.
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 		}
 	}
 };
@@ -88,35 +90,35 @@ public:
                 Driver->getCacheHandler()->setBlendFunc(Driver->getGLBlend(srcRGBFact), Driver->getGLBlend(dstRGBFact));
             }
 
-			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_TEXTURE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_PREVIOUS);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
+			Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_TEXTURE);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_PREVIOUS);
 
-			glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, (f32) modulate );
+			Driver->getCacheHandler()->setTexEnvScale((f32) modulate);
 
-			glEnable(GL_ALPHA_TEST);
-			glAlphaFunc(GL_GREATER, 0.f);
+			Driver->getCacheHandler()->setAlphaTest(true);
+			Driver->getCacheHandler()->setAlphaFunc(GL_GREATER, 0.f);
 
 			if (textureBlendFunc_hasAlpha(srcRGBFact) || textureBlendFunc_hasAlpha(dstRGBFact) ||
                 textureBlendFunc_hasAlpha(srcAlphaFact) || textureBlendFunc_hasAlpha(dstAlphaFact))
 			{
-				glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_ALPHA, GL_TEXTURE);
+				Driver->getCacheHandler()->setTexEnv(GL_COMBINE_ALPHA, GL_REPLACE);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC0_ALPHA, GL_TEXTURE);
 
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_PRIMARY_COLOR);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_PRIMARY_COLOR);
 			}
 		}
 	}
 
 	virtual void OnUnsetMaterial()
 	{
-		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-		glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, 1.f );
-		glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_PREVIOUS);
+		Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
+		Driver->getCacheHandler()->setTexEnvScale(1.f);
+		Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_PREVIOUS);
 
 		Driver->getCacheHandler()->setBlend(false);
-		glDisable(GL_ALPHA_TEST);
+		Driver->getCacheHandler()->setAlphaTest(false);
 	}
 
 	//! Returns if the material is transparent.
@@ -168,14 +170,14 @@ public:
 			if (Driver->queryFeature(EVDF_MULTITEXTURE))
 			{
 				Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-				glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_ALPHA, GL_PRIMARY_COLOR);
-				glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_INTERPOLATE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_PREVIOUS);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_TEXTURE);
-				glTexEnvf(GL_TEXTURE_ENV, GL_SRC2_RGB, GL_PRIMARY_COLOR);
-				glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND2_RGB, GL_SRC_ALPHA);
+				Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
+				Driver->getCacheHandler()->setTexEnv(GL_COMBINE_ALPHA, GL_REPLACE);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC0_ALPHA, GL_PRIMARY_COLOR);
+				Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_INTERPOLATE);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_PREVIOUS);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_TEXTURE);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC2_RGB, GL_PRIMARY_COLOR);
+				Driver->getCacheHandler()->setTexEnv(GL_OPERAND2_RGB, GL_SRC_ALPHA);
 			}
 		}
 	}
@@ -185,8 +187,8 @@ public:
 		if (Driver->queryFeature(EVDF_MULTITEXTURE))
 		{
 			Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_OPERAND2_RGB, GL_SRC_COLOR);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_OPERAND2_RGB, GL_SRC_COLOR);
 			Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE0);
 		}
 	}
@@ -210,7 +212,7 @@ public:
 		Driver->getCacheHandler()->setBlend(true);
 
 		if ((material.MaterialType != lastMaterial.MaterialType) || resetAllRenderstates)
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 	}
 
 	virtual void OnUnsetMaterial()
@@ -244,27 +246,27 @@ public:
 
 		if (material.MaterialType != lastMaterial.MaterialType || resetAllRenderstates)
 		{
-			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
 
-			glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_ALPHA, GL_PRIMARY_COLOR );
+			Driver->getCacheHandler()->setTexEnv(GL_COMBINE_ALPHA, GL_REPLACE);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC0_ALPHA, GL_PRIMARY_COLOR);
 
-			glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_PRIMARY_COLOR );
-			glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_TEXTURE);
+			Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_PRIMARY_COLOR);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_TEXTURE);
 		}
 	}
 
 	virtual void OnUnsetMaterial()
 	{
 		// default values
-		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
-		glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE );
-		glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_ALPHA, GL_TEXTURE );
-		glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_ALPHA, GL_PREVIOUS );
-		glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-		glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_TEXTURE );
-		glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_PREVIOUS);
+		Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
+		Driver->getCacheHandler()->setTexEnv(GL_COMBINE_ALPHA, GL_MODULATE);
+		Driver->getCacheHandler()->setTexEnv(GL_SRC0_ALPHA, GL_TEXTURE);
+		Driver->getCacheHandler()->setTexEnv(GL_SRC1_ALPHA, GL_PREVIOUS);
+		Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
+		Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_TEXTURE);
+		Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_PREVIOUS);
 
 		Driver->getCacheHandler()->setBlend(false);
 	}
@@ -296,23 +298,23 @@ public:
 		if (material.MaterialType != lastMaterial.MaterialType || resetAllRenderstates
 			|| material.MaterialTypeParam != lastMaterial.MaterialTypeParam )
 		{
-			glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_TEXTURE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_PREVIOUS);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
+			Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_TEXTURE);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_PREVIOUS);
 
-			glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_REPLACE);
-			glTexEnvf(GL_TEXTURE_ENV, GL_SRC0_ALPHA, GL_TEXTURE);
+			Driver->getCacheHandler()->setTexEnv(GL_COMBINE_ALPHA, GL_REPLACE);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC0_ALPHA, GL_TEXTURE);
 
-			glEnable(GL_ALPHA_TEST);
+			Driver->getCacheHandler()->setAlphaTest(true);
 
-			glAlphaFunc(GL_GREATER, material.MaterialTypeParam);
+			Driver->getCacheHandler()->setAlphaFunc(GL_GREATER, material.MaterialTypeParam);
 		}
 	}
 
 	virtual void OnUnsetMaterial()
 	{
-		glDisable(GL_ALPHA_TEST);
+		Driver->getCacheHandler()->setAlphaTest(false);
 		Driver->getCacheHandler()->setBlend(false);
 	}
 
@@ -340,15 +342,15 @@ public:
 
 		if (material.MaterialType != lastMaterial.MaterialType || resetAllRenderstates)
 		{
-			glEnable(GL_ALPHA_TEST);
-			glAlphaFunc(GL_GREATER, 0.5f);
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			Driver->getCacheHandler()->setAlphaTest(true);
+			Driver->getCacheHandler()->setAlphaFunc(GL_GREATER, 0.5f);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 		}
 	}
 
 	virtual void OnUnsetMaterial()
 	{
-		glDisable(GL_ALPHA_TEST);
+		Driver->getCacheHandler()->setAlphaTest(false);
 	}
 
 	//! Returns if the material is transparent.
@@ -381,14 +383,14 @@ public:
 				case EMT_LIGHTMAP_LIGHTING:
 				case EMT_LIGHTMAP_LIGHTING_M2:
 				case EMT_LIGHTMAP_LIGHTING_M4:
-					glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+					Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 					break;
 				case EMT_LIGHTMAP_ADD:
 				case EMT_LIGHTMAP:
 				case EMT_LIGHTMAP_M2:
 				case EMT_LIGHTMAP_M4:
 				default:
-					glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+					Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_REPLACE);
 					break;
 			}
 
@@ -397,32 +399,32 @@ public:
 				// lightmap
 
 				Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-				glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
+				Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
 
 				if (material.MaterialType == EMT_LIGHTMAP_ADD)
-					glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_ADD);
+					Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_ADD);
 				else
-					glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
+					Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
 
-				glTexEnvi(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_PREVIOUS);
-				glTexEnvi(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_TEXTURE);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_PREVIOUS);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_TEXTURE);
 
-				glTexEnvf(GL_TEXTURE_ENV, GL_COMBINE_ALPHA, GL_MODULATE);
-				glTexEnvi(GL_TEXTURE_ENV, GL_SRC0_ALPHA, GL_PREVIOUS);
-				glTexEnvi(GL_TEXTURE_ENV, GL_SRC1_ALPHA, GL_PREVIOUS);
+				Driver->getCacheHandler()->setTexEnv(GL_COMBINE_ALPHA, GL_MODULATE);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC0_ALPHA, GL_PREVIOUS);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC1_ALPHA, GL_PREVIOUS);
 
 				switch (material.MaterialType)
 				{
 					case EMT_LIGHTMAP_M4:
 					case EMT_LIGHTMAP_LIGHTING_M4:
-						glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, 4.0f);
+						Driver->getCacheHandler()->setTexEnvScale(4.0f);
 						break;
 					case EMT_LIGHTMAP_M2:
 					case EMT_LIGHTMAP_LIGHTING_M2:
-						glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, 2.0f);
+						Driver->getCacheHandler()->setTexEnvScale(2.0f);
 						break;
 					default:
-						glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, 1.0f);
+						Driver->getCacheHandler()->setTexEnvScale(1.0f);
 				}
 			}
 		}
@@ -433,10 +435,10 @@ public:
 		if (Driver->queryFeature(EVDF_MULTITEXTURE))
 		{
 			Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-			glTexEnvf(GL_TEXTURE_ENV, GL_RGB_SCALE, 1.f );
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnvScale(1.f);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 			Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE0);
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 		}
 	}
 };
@@ -456,17 +458,17 @@ public:
 		if (material.MaterialType != lastMaterial.MaterialType || resetAllRenderstates)
 		{
 			Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-			glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_ADD_SIGNED);
-			glTexEnvi(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_PREVIOUS);
-			glTexEnvi(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_TEXTURE);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
+			Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_ADD_SIGNED);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_PREVIOUS);
+			Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_TEXTURE);
 		}
 	}
 
 	void OnUnsetMaterial() override
 	{
 		Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-		glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+		Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 		Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE0);
 	}
 };
@@ -521,10 +523,10 @@ public:
 			if (Driver->queryFeature(EVDF_MULTITEXTURE))
 			{
 				Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-				glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-				glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-				glTexEnvi(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_PREVIOUS);
-				glTexEnvi(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_TEXTURE);
+				Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
+				Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_PREVIOUS);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_TEXTURE);
 
 			}
 //			glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
@@ -539,7 +541,7 @@ public:
 		if (Driver->queryFeature(EVDF_MULTITEXTURE))
 		{
 			Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 		}
 //		glDisable(GL_TEXTURE_GEN_S);
 //		glDisable(GL_TEXTURE_GEN_T);
@@ -572,10 +574,10 @@ public:
 			if (Driver->queryFeature(EVDF_MULTITEXTURE))
 			{
 				Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-				glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_COMBINE);
-				glTexEnvi(GL_TEXTURE_ENV, GL_COMBINE_RGB, GL_MODULATE);
-				glTexEnvi(GL_TEXTURE_ENV, GL_SRC0_RGB, GL_PREVIOUS);
-				glTexEnvi(GL_TEXTURE_ENV, GL_SRC1_RGB, GL_TEXTURE);
+				Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_COMBINE);
+				Driver->getCacheHandler()->setTexEnv(GL_COMBINE_RGB, GL_MODULATE);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC0_RGB, GL_PREVIOUS);
+				Driver->getCacheHandler()->setTexEnv(GL_SRC1_RGB, GL_TEXTURE);
 			}
 //			glTexGeni(GL_S, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
 //			glTexGeni(GL_T, GL_TEXTURE_GEN_MODE, GL_SPHERE_MAP);
@@ -589,7 +591,7 @@ public:
 		if (Driver->queryFeature(EVDF_MULTITEXTURE))
 		{
 			Driver->getCacheHandler()->setActiveTexture(GL_TEXTURE1);
-			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+			Driver->getCacheHandler()->setTexEnv(GL_TEXTURE_ENV_MODE, GL_MODULATE);
 		}
 //		glDisable(GL_TEXTURE_GEN_S);
 //		glDisable(GL_TEXTURE_GEN_T);
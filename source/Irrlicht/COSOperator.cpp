@@ -55,6 +55,9 @@ namespace irr
 
 // constructor
 COSOperator::COSOperator(const core::stringc& osVersion) : OperatingSystem(osVersion)
+#if defined(_IRR_COMPILE_WITH_X11_DEVICE_)
+	, IrrDeviceLinux(0)
+#endif
 {
 	#ifdef _DEBUG
 	setDebugName("COSOperator");
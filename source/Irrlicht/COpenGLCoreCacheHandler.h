@@ -70,8 +70,13 @@ class COpenGLCoreCacheHandler
 
 				const TOpenGLTexture* prevTexture = Texture[index];
 
+				if (texture && texture == prevTexture)
+					prevTexture->setLastUseFrame(CacheHandler.Driver->getFrameCount());
+
 				if (texture != prevTexture)
 				{
+					++CacheHandler.Driver->getFrameStatsCounters().TextureBinds;
+
 					if ( esa == EST_ACTIVE_ON_CHANGE )
 						CacheHandler.setActiveTexture(GL_TEXTURE0 + index);
 
@@ -84,6 +89,12 @@ class COpenGLCoreCacheHandler
 							texture->grab();
 
 							const TOpenGLTexture* curTexture = static_cast<const TOpenGLTexture*>(texture);
+							curTexture->setLastUseFrame(CacheHandler.Driver->getFrameCount());
+
+							// evicted textures are uploaded again on their first use, they bind themselves to the active unit
+							if (!curTexture->isResident())
+								const_cast<TOpenGLTexture*>(curTexture)->makeResident();
+
 							const GLenum curTextureType = curTexture->getOpenGLTextureType();
 							const GLenum prevTextureType = (prevTexture) ? prevTexture->getOpenGLTextureType() : curTextureType;
 
@@ -136,6 +147,67 @@ class COpenGLCoreCacheHandler
 			return (status && type == DriverType);
 		}
 
+		//! Sets the textures of all units to the ones of a material
+		/** With multi-bind the changed units are bound by a single call and the active unit stays,
+		otherwise each unit is set like set() does. */
+		void setMaterialTextures(const SMaterial& material)
+		{
+			const u32 count = core::min_(TextureCount, static_cast<u32>(MATERIAL_MAX_TEXTURES));
+
+			if (!CacheHandler.Driver->getFeature().MultiBind)
+			{
+				for (u32 i = 0; i < count; ++i)
+					set(i, material.getTexture(i));
+
+				return;
+			}
+
+			GLuint names[MATERIAL_MAX_TEXTURES];
+			u32 first = count;
+			u32 last = 0;
+
+			for (u32 i = 0; i < count; ++i)
+			{
+				const ITexture* texture = material.getTexture(i);
+				const TOpenGLTexture* prevTexture = Texture[i];
+
+				if (texture != prevTexture)
+				{
+					const TOpenGLTexture* curTexture = static_cast<const TOpenGLTexture*>(texture);
+
+					// foreign textures are reported and evicted ones upload themselves on the active unit
+					if (texture && (texture->getDriverType() != DriverType || !curTexture->isResident()))
+					{
+						set(i, texture);
+					}
+					else
+					{
+						++CacheHandler.Driver->getFrameStatsCounters().TextureBinds;
+
+						if (curTexture)
+							curTexture->grab();
+
+						Texture[i] = curTexture;
+
+						if (prevTexture)
+							prevTexture->drop();
+
+						first = core::min_(first, i);
+						last = i;
+					}
+				}
+
+				if (Texture[i])
+					Texture[i]->setLastUseFrame(CacheHandler.Driver->getFrameCount());
+
+				// a zero name unbinds all targets of the unit
+				names[i] = Texture[i] ? Texture[i]->getOpenGLTextureName() : 0;
+			}
+
+			if (first <= last)
+				CacheHandler.Driver->irrGlBindTextures(first, last - first + 1, names + first);
+		}
+
 		void remove(ITexture* texture)
 		{
 			if (!texture)
@@ -189,7 +261,7 @@ public:
 #endif
 		FrameBufferCount(0), BlendEquation(0), BlendSourceRGB(0),
 		BlendDestinationRGB(0), BlendSourceAlpha(0), BlendDestinationAlpha(0), Blend(0), BlendEquationInvalid(false), BlendFuncInvalid(false), BlendInvalid(false),
-		ColorMask(0), ColorMaskInvalid(false), CullFaceMode(GL_BACK), CullFace(false), DepthFunc(GL_LESS), DepthMask(true), DepthTest(false), FrameBufferID(0),
+		ColorMask(0), ColorMaskInvalid(false), CullFaceMode(GL_BACK), CullFace(false), DepthFunc(GL_LESS), DepthMask(true), DepthTest(false), AlphaToCoverage(false), FrameBufferID(0),
 		ProgramID(0), ActiveTexture(GL_TEXTURE0), ViewportX(0), ViewportY(0)
 	{
 		const COpenGLCoreFeature& feature = Driver->getFeature();
@@ -236,6 +308,8 @@ public:
 		glDepthMask(GL_TRUE);
 		glDisable(GL_DEPTH_TEST);
 
+		glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+
 		Driver->irrGlActiveTexture(ActiveTexture);
 
 #if ( defined(IRR_COMPILE_GL_COMMON) || defined(IRR_COMPILE_GLES_COMMON) )
@@ -296,6 +370,12 @@ public:
 		}
 	}
 
+	void getBlendFunc(GLenum& source, GLenum& destination) const
+	{
+		source = BlendSourceRGB[0];
+		destination = BlendDestinationRGB[0];
+	}
+
 	void setBlendFunc(GLenum source, GLenum destination)
 	{
 		if (BlendSourceRGB[0] != source || BlendDestinationRGB[0] != destination ||
@@ -380,6 +460,11 @@ public:
 		}
 	}
 
+	void getBlend(bool& enable) const
+	{
+		enable = Blend[0];
+	}
+
 	void setBlend(bool enable)
 	{
 		if (Blend[0] != enable || BlendInvalid)
@@ -443,6 +528,11 @@ public:
 
 	// Cull face calls.
 
+	void getCullFaceFunc(GLenum& mode) const
+	{
+		mode = CullFaceMode;
+	}
+
 	void setCullFaceFunc(GLenum mode)
 	{
 		if (CullFaceMode != mode)
@@ -452,6 +542,11 @@ public:
 		}
 	}
 
+	void getCullFace(bool& enable) const
+	{
+		enable = CullFace;
+	}
+
 	void setCullFace(bool enable)
 	{
 		if (CullFace != enable)
@@ -467,6 +562,11 @@ public:
 
 	// Depth calls.
 
+	void getDepthFunc(GLenum& mode) const
+	{
+		mode = DepthFunc;
+	}
+
 	void setDepthFunc(GLenum mode)
 	{
 		if (DepthFunc != mode)
@@ -512,6 +612,26 @@ public:
 		}
 	}
 
+	// Multisample calls.
+
+	void getAlphaToCoverage(bool& enable) const
+	{
+		enable = AlphaToCoverage;
+	}
+
+	void setAlphaToCoverage(bool enable)
+	{
+		if (AlphaToCoverage != enable)
+		{
+			if (enable)
+				glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+			else
+				glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+
+			AlphaToCoverage = enable;
+		}
+	}
+
 	// FBO calls.
 
 	void getFBO(GLuint& frameBufferID) const
@@ -525,6 +645,7 @@ public:
 		{
 			Driver->irrGlBindFramebuffer(GL_FRAMEBUFFER, frameBufferID);
 			FrameBufferID = frameBufferID;
+			++Driver->getFrameStatsCounters().RenderTargetSwitches;
 		}
 	}
 
@@ -541,6 +662,7 @@ public:
 		{
 			Driver->irrGlUseProgram(programID);
 			ProgramID = programID;
+			++Driver->getFrameStatsCounters().ProgramSwitches;
 		}
 	}
 
@@ -585,16 +707,20 @@ public:
 	//! Compare material to current cache and update it when there are differences
 	// Some material renderers do change the cache beyond the original material settings
 	// This corrects the material to represent the current cache state again.
-	void correctCacheMaterial(irr::video::SMaterial& material)
+	//! Fixes textures of material which got removed
+	/** \return True if material was changed. */
+	bool correctCacheMaterial(irr::video::SMaterial& material)
 	{
-		// Fix textures which got removed
+		bool changed = false;
 		for ( u32 i=0; i < MATERIAL_MAX_TEXTURES; ++i )
 		{
 			if ( material.TextureLayer[i].Texture && !TextureCache[i] )
 			{
 				material.TextureLayer[i].Texture = 0;
+				changed = true;
 			}
 		}
+		return changed;
 	}
 
 protected:
@@ -625,6 +751,8 @@ protected:
 	bool DepthMask;
 	bool DepthTest;
 
+	bool AlphaToCoverage;
+
 	GLuint FrameBufferID;
 
 	GLuint ProgramID;
@@ -16,7 +16,8 @@ namespace video
 class COpenGLCoreFeature
 {
 public:
-	COpenGLCoreFeature() : BlendOperation(false), ColorAttachment(0), MultipleRenderTarget(0), MaxTextureUnits(1)
+	COpenGLCoreFeature() : BlendOperation(false), ColorAttachment(0), MultipleRenderTarget(0), MaxTextureUnits(1),
+		MaxRenderTargetSamples(0), MultiBind(false), DirectStateAccess(false)
 	{
 	}
 
@@ -29,6 +30,15 @@ public:
 	u8 ColorAttachment;
 	u8 MultipleRenderTarget;
 	u8 MaxTextureUnits;
+
+	// 0 without multisampled renderbuffers and framebuffer blits
+	u8 MaxRenderTargetSamples;
+
+	// glBindTextures and glBindSamplers set a range of units without touching the active one
+	bool MultiBind;
+
+	// buffers and textures are updated by name, without binding them first
+	bool DirectStateAccess;
 };
 
 }
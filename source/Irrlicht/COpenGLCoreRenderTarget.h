@@ -16,6 +16,23 @@
 #define GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS GL_FRAMEBUFFER_INCOMPLETE_DIMENSIONS_EXT
 #endif
 
+// multisampling and invalidation, missing in the OpenGL ES 2.0 headers
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#endif
+
+#ifndef GL_DRAW_FRAMEBUFFER
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#endif
+
+#ifndef GL_DEPTH
+#define GL_DEPTH 0x1801
+#endif
+
+#ifndef GL_STENCIL
+#define GL_STENCIL 0x1802
+#endif
+
 namespace irr
 {
 namespace video
@@ -26,7 +43,9 @@ class COpenGLCoreRenderTarget : public IRenderTarget
 {
 public:
 	COpenGLCoreRenderTarget(TOpenGLDriver* driver) : AssignedDepth(false), AssignedStencil(false), RequestTextureUpdate(false), RequestDepthStencilUpdate(false),
-		BufferID(0), ColorAttachment(0), MultipleRenderTarget(0), Driver(driver)
+		BufferID(0), MultisampleBufferID(0), MultisampleColorBuffer(0), MultisampleDepthBuffer(0),
+		ResolveBufferID(0), ResolveColorBuffer(0), ResolveDepthStencil(false), AssignedSamples(0),
+		ColorAttachment(0), MultipleRenderTarget(0), Driver(driver)
 	{
 #ifdef _DEBUG
 		setDebugName("COpenGLCoreRenderTarget");
@@ -50,6 +69,8 @@ public:
 
 	virtual ~COpenGLCoreRenderTarget()
 	{
+		deleteMultisampleBuffers();
+
 		if (ColorAttachment > 0 && BufferID != 0)
 			Driver->irrGlDeleteFramebuffers(1, &BufferID);
 
@@ -178,10 +199,16 @@ public:
 		}
 	}
 
+	//! Attaches the textures to the framebuffer and binds it
+	/** getBufferID() has to be bound for drawing afterwards. */
 	void update()
 	{
-		if (RequestTextureUpdate || RequestDepthStencilUpdate)
+		const u8 samples = getSupportedSampleCount();
+
+		if (RequestTextureUpdate || RequestDepthStencilUpdate || samples != AssignedSamples)
 		{
+			Driver->getCacheHandler()->setFBO(BufferID);
+
 			// Set color attachments.
 
 			if (RequestTextureUpdate)
@@ -312,12 +339,80 @@ public:
 #ifdef _DEBUG
 			checkFBO(Driver);
 #endif
+
+			updateMultisampleBuffers(samples);
+		}
+	}
+
+	//! Resolves the multisampled buffers and discards what isn't needed anymore
+	/** Called by the driver when the target is left, or the scene ends while
+	it is set. */
+	void resolve()
+	{
+		if (ColorAttachment == 0)
+			return;
+
+		GLenum attachments[3];
+		GLsizei attachmentCount = 0;
+
+		if (MultisampleBufferID != 0)
+		{
+			GLbitfield depthMask = 0;
+			if (ResolveDepthStencil && !DiscardDepthStencil)
+				depthMask = AssignedStencil ? GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT : GL_DEPTH_BUFFER_BIT;
+
+			GLuint boundBufferID = 0;
+			Driver->getCacheHandler()->getFBO(boundBufferID);
+
+			Driver->irrGlBindFramebuffer(GL_READ_FRAMEBUFFER, MultisampleBufferID);
+			Driver->irrGlBindFramebuffer(GL_DRAW_FRAMEBUFFER, BufferID);
+
+			if (ResolveBufferID != 0)
+			{
+				if (depthMask != 0)
+					Driver->irrGlBlitFramebuffer(0, 0, Size.Width, Size.Height, 0, 0, Size.Width, Size.Height, depthMask, GL_NEAREST);
+
+				Driver->irrGlBindFramebuffer(GL_DRAW_FRAMEBUFFER, ResolveBufferID);
+				Driver->irrGlBlitFramebuffer(0, 0, Size.Width, Size.Height, 0, 0, Size.Width, Size.Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			}
+			else
+			{
+				Driver->irrGlBlitFramebuffer(0, 0, Size.Width, Size.Height, 0, 0, Size.Width, Size.Height, GL_COLOR_BUFFER_BIT | depthMask, GL_NEAREST);
+			}
+
+			// the multisampled buffers are never read after the resolve
+			attachments[attachmentCount++] = GL_COLOR_ATTACHMENT0;
+			if (AssignedDepth)
+				attachments[attachmentCount++] = GL_DEPTH_ATTACHMENT;
+			if (AssignedStencil)
+				attachments[attachmentCount++] = GL_STENCIL_ATTACHMENT;
+			Driver->irrGlInvalidateFramebuffer(GL_READ_FRAMEBUFFER, attachmentCount, attachments);
+
+			if (ResolveBufferID != 0)
+			{
+				Driver->irrGlBindFramebuffer(GL_READ_FRAMEBUFFER, ResolveBufferID);
+				Driver->irrGlBindFramebuffer(GL_DRAW_FRAMEBUFFER, BufferID);
+				Driver->irrGlBlitFramebuffer(0, 0, Size.Width, Size.Height, 0, 0, Size.Width, Size.Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+				Driver->irrGlInvalidateFramebuffer(GL_READ_FRAMEBUFFER, 1, attachments);
+			}
+
+			Driver->irrGlBindFramebuffer(GL_FRAMEBUFFER, boundBufferID);
+		}
+		else if (AssignedDepth && DiscardDepthStencil)
+		{
+			attachments[attachmentCount++] = GL_DEPTH_ATTACHMENT;
+			if (AssignedStencil)
+				attachments[attachmentCount++] = GL_STENCIL_ATTACHMENT;
+
+			Driver->getCacheHandler()->setFBO(BufferID);
+			Driver->irrGlInvalidateFramebuffer(GL_FRAMEBUFFER, attachmentCount, attachments);
 		}
 	}
 
+	//! Returns the framebuffer to draw into, the multisampled one if there is one
 	GLuint getBufferID() const
 	{
-		return BufferID;
+		return MultisampleBufferID != 0 ? MultisampleBufferID : BufferID;
 	}
 
 	const core::dimension2d<u32>& getSize() const
@@ -336,7 +431,174 @@ public:
 		return 0;
 	}
 
+	//! Creates the framebuffer again after the context was lost
+	/** The names of the lost context aren't deleted, they are invalid
+	already. The textures are attached again by the next update(), so
+	they have to be restored before. */
+	void restore()
+	{
+		BufferID = 0;
+		MultisampleBufferID = 0;
+		MultisampleColorBuffer = 0;
+		MultisampleDepthBuffer = 0;
+		ResolveBufferID = 0;
+		ResolveColorBuffer = 0;
+		ResolveDepthStencil = false;
+		AssignedSamples = 0;
+
+		if (ColorAttachment > 0)
+			Driver->irrGlGenFramebuffers(1, &BufferID);
+
+		for (u32 i = 0; i < AssignedTextures.size(); ++i)
+			AssignedTextures[i] = GL_NONE;
+
+		AssignedDepth = false;
+		AssignedStencil = false;
+
+		RequestTextureUpdate = true;
+		RequestDepthStencilUpdate = true;
+	}
+
 protected:
+	//! Returns the samples for the multisampled buffers, 0 for none
+	u8 getSupportedSampleCount() const
+	{
+		const u8 maxSamples = Driver->getFeature().MaxRenderTargetSamples;
+
+		if (ColorAttachment == 0 || SampleCount < 2 || maxSamples < 2 || Textures.size() != 1 || !Textures[0])
+			return 0;
+
+		return core::min_(SampleCount, maxSamples);
+	}
+
+	//! Creates the multisampled buffers matching the textures, with the resolve framebuffer bound
+	void updateMultisampleBuffers(u8 samples)
+	{
+		deleteMultisampleBuffers();
+
+		// also remembered when failing, so the creation isn't tried on each bind
+		AssignedSamples = samples;
+
+		if (samples == 0)
+			return;
+
+		const GLenum colorFormat = getRenderbufferFormat(Textures[0]->getColorFormat());
+
+		Driver->irrGlGenFramebuffers(1, &MultisampleBufferID);
+		Driver->getCacheHandler()->setFBO(MultisampleBufferID);
+
+		Driver->irrGlGenRenderbuffers(1, &MultisampleColorBuffer);
+		Driver->irrGlBindRenderbuffer(GL_RENDERBUFFER, MultisampleColorBuffer);
+		Driver->irrGlRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, colorFormat, Size.Width, Size.Height);
+		Driver->irrGlFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, MultisampleColorBuffer);
+
+		if (AssignedDepth)
+		{
+			const GLenum depthFormat = getRenderbufferFormat(DepthStencil->getColorFormat());
+
+			Driver->irrGlGenRenderbuffers(1, &MultisampleDepthBuffer);
+			Driver->irrGlBindRenderbuffer(GL_RENDERBUFFER, MultisampleDepthBuffer);
+			Driver->irrGlRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, depthFormat, Size.Width, Size.Height);
+			Driver->irrGlFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, MultisampleDepthBuffer);
+
+			if (AssignedStencil)
+				Driver->irrGlFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, MultisampleDepthBuffer);
+
+			// depth can't be converted by a multisample resolve, textures with unsized formats keep their content
+			ResolveDepthStencil = (static_cast<GLenum>(static_cast<TOpenGLTexture*>(DepthStencil)->getOpenGLInternalFormat()) == depthFormat);
+		}
+
+		Driver->irrGlDrawBuffer(GL_COLOR_ATTACHMENT0);
+
+		bool complete = checkFBO(Driver);
+
+		// neither can color, so other texture formats get an intermediate buffer matching the samples
+		if (complete && static_cast<GLenum>(static_cast<TOpenGLTexture*>(Textures[0])->getOpenGLInternalFormat()) != colorFormat)
+		{
+			Driver->irrGlGenFramebuffers(1, &ResolveBufferID);
+			Driver->getCacheHandler()->setFBO(ResolveBufferID);
+
+			Driver->irrGlGenRenderbuffers(1, &ResolveColorBuffer);
+			Driver->irrGlBindRenderbuffer(GL_RENDERBUFFER, ResolveColorBuffer);
+			Driver->irrGlRenderbufferStorageMultisample(GL_RENDERBUFFER, 0, colorFormat, Size.Width, Size.Height);
+			Driver->irrGlFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ResolveColorBuffer);
+
+			complete = checkFBO(Driver);
+			Driver->getCacheHandler()->setFBO(MultisampleBufferID);
+		}
+
+		Driver->irrGlBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		if (!complete)
+		{
+			os::Printer::log("Could not create the multisampled buffers of a render target, drawing without antialiasing.", ELL_WARNING);
+
+			Driver->getCacheHandler()->setFBO(BufferID);
+			deleteMultisampleBuffers();
+		}
+	}
+
+	void deleteMultisampleBuffers()
+	{
+		if (MultisampleColorBuffer != 0)
+			Driver->irrGlDeleteRenderbuffers(1, &MultisampleColorBuffer);
+
+		if (MultisampleDepthBuffer != 0)
+			Driver->irrGlDeleteRenderbuffers(1, &MultisampleDepthBuffer);
+
+		if (MultisampleBufferID != 0)
+			Driver->irrGlDeleteFramebuffers(1, &MultisampleBufferID);
+
+		if (ResolveColorBuffer != 0)
+			Driver->irrGlDeleteRenderbuffers(1, &ResolveColorBuffer);
+
+		if (ResolveBufferID != 0)
+			Driver->irrGlDeleteFramebuffers(1, &ResolveBufferID);
+
+		MultisampleColorBuffer = 0;
+		MultisampleDepthBuffer = 0;
+		MultisampleBufferID = 0;
+		ResolveColorBuffer = 0;
+		ResolveBufferID = 0;
+		ResolveDepthStencil = false;
+	}
+
+	//! Returns the sized renderbuffer format for a texture format
+	static GLenum getRenderbufferFormat(ECOLOR_FORMAT format)
+	{
+		switch (format)
+		{
+		case ECF_A1R5G5B5:
+			return 0x8057; // GL_RGB5_A1
+		case ECF_R5G6B5:
+			return 0x8D62; // GL_RGB565
+		case ECF_R8:
+			return 0x8229; // GL_R8
+		case ECF_R8G8:
+			return 0x822B; // GL_RG8
+		case ECF_R16F:
+			return 0x822D; // GL_R16F
+		case ECF_G16R16F:
+			return 0x822F; // GL_RG16F
+		case ECF_A16B16G16R16F:
+			return 0x881A; // GL_RGBA16F
+		case ECF_R32F:
+			return 0x822E; // GL_R32F
+		case ECF_G32R32F:
+			return 0x8230; // GL_RG32F
+		case ECF_A32B32G32R32F:
+			return 0x8814; // GL_RGBA32F
+		case ECF_D16:
+			return 0x81A5; // GL_DEPTH_COMPONENT16
+		case ECF_D32:
+			return 0x81A6; // GL_DEPTH_COMPONENT24, what OpenGL ES makes of 32 bit unsigned depth
+		case ECF_D24S8:
+			return 0x88F0; // GL_DEPTH24_STENCIL8
+		default:
+			return 0x8058; // GL_RGBA8
+		}
+	}
+
 	bool checkFBO(TOpenGLDriver* driver)
 	{
 		if (ColorAttachment == 0)
@@ -386,6 +648,20 @@ protected:
 
 	GLuint BufferID;
 
+	//! Framebuffer of the multisampled renderbuffers, resolved into BufferID
+	GLuint MultisampleBufferID;
+	GLuint MultisampleColorBuffer;
+	GLuint MultisampleDepthBuffer;
+
+	//! Single sampled copy of the samples, when the texture format differs from theirs
+	GLuint ResolveBufferID;
+	GLuint ResolveColorBuffer;
+
+	//! Depth and stencil formats allow a resolve into the texture
+	bool ResolveDepthStencil;
+
+	u8 AssignedSamples;
+
 	core::dimension2d<u32> Size;
 
 	u32 ColorAttachment;
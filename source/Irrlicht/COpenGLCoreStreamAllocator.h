@@ -0,0 +1,87 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_OGLCORE_STREAM_ALLOCATOR_H_INCLUDED__
+#define __C_OGLCORE_STREAM_ALLOCATOR_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace video
+{
+
+//! Places transient geometry in a buffer for streaming, split into regions
+/** Each frame writes into a region of its own while the GPU still reads the
+regions of the frames in flight. Drivers with fences fence a region at the
+end of its frame and wait for it when the region comes around again.
+Drivers without them use a single region and orphan the buffer when it is
+full. The allocator only does the bookkeeping, the buffer belongs to the
+driver. */
+class COpenGLCoreStreamAllocator
+{
+public:
+	COpenGLCoreStreamAllocator(u32 regions, u32 regionSize)
+		: Regions(regions), RegionSize(regionSize), Region(0), Offset(0)
+	{
+	}
+
+	//! Size of the buffer the driver has to create
+	u32 getSize() const
+	{
+		return Regions * RegionSize;
+	}
+
+	//! Reserves size bytes in the region of the current frame
+	/** Every allocation is aligned for any attribute or index type.
+	\param offset Receives the offset of the allocation in the buffer.
+	\return False if the region has no room left for it. */
+	bool allocate(u32 size, u32& offset)
+	{
+		const u32 start = (Offset + 15) & ~15u;
+		if (!size || size > RegionSize || start > RegionSize - size)
+			return false;
+
+		offset = Region * RegionSize + start;
+		Offset = start + size;
+		return true;
+	}
+
+	//! Index of the region of the current frame
+	u32 getRegion() const
+	{
+		return Region;
+	}
+
+	//! True if anything was allocated in the region of the current frame
+	bool isRegionUsed() const
+	{
+		return Offset != 0;
+	}
+
+	//! Moves on to the region of the next frame and returns its index
+	u32 nextRegion()
+	{
+		Region = (Region + 1) % Regions;
+		Offset = 0;
+		return Region;
+	}
+
+	//! Starts over at the beginning of the region, after the buffer got new storage
+	void resetRegion()
+	{
+		Offset = 0;
+	}
+
+private:
+	u32 Regions;
+	u32 RegionSize;
+	u32 Region;
+	//! Write position inside the current region
+	u32 Offset;
+};
+
+}
+}
+
+#endif
@@ -9,10 +9,12 @@
 #include "irrArray.h"
 #include "SMaterialLayer.h"
 #include "ITexture.h"
+#include "IScreenShotRequest.h"
 #include "EDriverFeatures.h"
 #include "os.h"
 #include "CImage.h"
 #include "CColorConverter.h"
+#include <utility>
 
 // Check if GL version we compile with should have the glGenerateMipmap function.
 #if defined(GL_VERSION_3_0) || defined(GL_ES_VERSION_2_0)
@@ -49,7 +51,10 @@ public:
 
 	COpenGLCoreTexture(const io::path& name, const core::array<IImage*>& images, E_TEXTURE_TYPE type, TOpenGLDriver* driver) : ITexture(name, type), Driver(driver), TextureType(GL_TEXTURE_2D),
 		TextureName(0), InternalFormat(GL_RGBA), PixelFormat(GL_RGBA), PixelType(GL_UNSIGNED_BYTE), Converter(0), LockReadOnly(false), LockImage(0), LockLayer(0),
-		KeepImage(false), MipLevelStored(0), LegacyAutoGenerateMipMaps(false)
+		Readback(0), ReadbackLevel(0), ReadbackLayer(0), DataRevision(0), KeepImage(false), MipLevelStored(0), LegacyAutoGenerateMipMaps(false), UploadPending(false), PendingDataUploaded(false),
+		ImmutableStorage(false), MipLevelCount(1), MipStreaming(false), StreamedLevel(0), ScreenSizeHint(0),
+		CPUMipMaps(false), MipMapFlags(0),
+		Resident(true), LastUseFrame(0)
 	{
 		_IRR_DEBUG_BREAK_IF(images.size() == 0)
 
@@ -57,24 +62,60 @@ public:
 		TextureType = TextureTypeIrrToGL(Type);
 		HasMipMaps = Driver->getTextureCreationFlag(ETCF_CREATE_MIP_MAPS);
 		KeepImage = Driver->getTextureCreationFlag(ETCF_ALLOW_MEMORY_COPY);
+		IsDistanceField = Driver->getTextureCreationFlag(ETCF_DISTANCE_FIELD);
 
 		getImageValues(images[0]);
 
+		// mipmaps of compressed formats can't be generated, only loaded
+		if (IImage::isCompressedFormat(ColorFormat) && !images[0]->getMipMapsData())
+			HasMipMaps = false;
+
+		if (HasMipMaps)
+			MipLevelCount = getMipLevelCount(Size);
+
+		CPUMipMaps = HasMipMaps && Driver->getTextureCreationFlag(ETCF_CREATE_MIP_MAPS_ON_CPU) && !IImage::isCompressedFormat(ColorFormat);
+		MipMapFlags = (Driver->getTextureCreationFlag(ETCF_SRGB_MIP_MAPS) ? EMMF_SRGB : 0) |
+			(Driver->getTextureCreationFlag(ETCF_PRESERVE_ALPHA_COVERAGE) ? EMMF_PRESERVE_ALPHA_COVERAGE : 0);
+
+		// all levels are kept in main memory, missing mipmaps are created on the CPU
+		const bool hasMipMapsData = images[0]->getMipMapsData() && OriginalSize == Size && OriginalColorFormat == ColorFormat;
+		MipStreaming = HasMipMaps && Type == ETT_2D && Driver->getTextureCreationFlag(ETCF_STREAM_MIP_MAPS) &&
+			Driver->queryFeature(EVDF_TEXTURE_STORAGE) && (hasMipMapsData || ColorFormat <= ECF_A8R8G8B8);
+
+		const bool keepImageRequested = KeepImage;
+		KeepImage |= MipStreaming;
+
+		// the images are kept until the driver uploads them
+		UploadPending = Driver->getTextureCreationFlag(ETCF_DEFERRED_UPLOAD) &&
+			Driver->queryFeature(EVDF_TEXTURE_UPLOAD_QUEUE) && !IImage::isCompressedFormat(ColorFormat) && !MipStreaming;
+
 		const core::array<IImage*>* tmpImages = &images;
 
-		if (KeepImage || OriginalSize != Size || OriginalColorFormat != ColorFormat)
+		if (KeepImage || UploadPending || OriginalSize != Size || OriginalColorFormat != ColorFormat || (CPUMipMaps && !hasMipMapsData))
 		{
 			Images.set_used(images.size());
 
 			for (u32 i = 0; i < images.size(); ++i)
 			{
+				// images only the driver references are taken over instead of copied
+				if (Driver->areTextureImagesDisposable() && images[i]->getDimension() == Size && images[i]->getColorFormat() == ColorFormat)
+				{
+					Images[i] = images[i];
+					Images[i]->grab();
+					continue;
+				}
+
 				Images[i] = Driver->createImage(ColorFormat, Size);
 
+				// resized images are filtered, nearest pixels are only left for the formats the resampler lacks
 				if (images[i]->getDimension() == Size)
 					images[i]->copyTo(Images[i]);
-				else
+				else if (!images[i]->copyToScalingFiltered(Images[i], EISF_BILINEAR))
 					images[i]->copyToScaling(Images[i]);
 
+				if (images[i]->getDimension() != Size || images[i]->getColorFormat() != ColorFormat)
+					Driver->getFrameStatsCounters().TextureBytesConverted += Images[i]->getImageDataSizeInBytes();
+
 				if ( images[i]->getMipMapsData() )
 				{
 					if ( OriginalSize == Size && OriginalColorFormat == ColorFormat )
@@ -90,6 +131,13 @@ public:
 			}
 
 			tmpImages = &Images;
+
+			// formats createMipMaps() can't handle fall back to the GPU
+			for (u32 i = 0; i < Images.size(); ++i)
+			{
+				if ((MipStreaming || CPUMipMaps) && !Images[i]->getMipMapsData())
+					createMipMapsData(Images[i]);
+			}
 		}
 
 		glGenTextures(1, &TextureName);
@@ -116,11 +164,43 @@ public:
 		if (HasMipMaps)
 		{
 			LegacyAutoGenerateMipMaps = Driver->getTextureCreationFlag(ETCF_AUTO_GENERATE_MIP_MAPS)  &&
-										Driver->queryFeature(EVDF_MIP_MAP_AUTO_UPDATE);
+										Driver->queryFeature(EVDF_MIP_MAP_AUTO_UPDATE) && !CPUMipMaps;
 			glTexParameteri(TextureType, GL_GENERATE_MIPMAP, LegacyAutoGenerateMipMaps ? GL_TRUE : GL_FALSE);
 		}
 #endif
 
+		if (MipStreaming)
+		{
+			// start with the levels up to 64 pixels, the larger ones are streamed in later
+			while (StreamedLevel + 1 < MipLevelCount && getMaxDimension(StreamedLevel) > 64)
+				++StreamedLevel;
+		}
+
+		const core::dimension2d<u32> storageSize(IImage::getMipMapsSize(Size, StreamedLevel));
+		ImmutableStorage = Driver->irrGlTexStorage2D(TextureType, MipLevelCount - StreamedLevel, InternalFormat, storageSize.Width, storageSize.Height);
+
+		if (!ImmutableStorage && MipStreaming)
+		{
+			MipStreaming = false;
+			StreamedLevel = 0;
+			KeepImage = keepImageRequested;
+		}
+
+		for (u32 i = 0; i < Images.size() && KeepImage; ++i)
+			Driver->getFrameStatsCounters().TextureBytesKept += Images[i]->getImageDataSizeInBytes();
+
+		if (UploadPending)
+		{
+			// only allocate the storage, the data follows with finishPendingUpload
+			for (u32 i = 0; i < Images.size() && !ImmutableStorage; ++i)
+				glTexImage2D(getLayerTextureType(i), 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
+
+			Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+
+			Driver->testGLError(__LINE__);
+			return;
+		}
+
 		for (u32 i = 0; i < (*tmpImages).size(); ++i)
 			uploadTexture(true, i, 0, (*tmpImages)[i]->getData());
 
@@ -151,8 +231,11 @@ public:
 	COpenGLCoreTexture(const io::path& name, const core::dimension2d<u32>& size, E_TEXTURE_TYPE type, ECOLOR_FORMAT format, TOpenGLDriver* driver)
 		: ITexture(name, type),
 		Driver(driver), TextureType(GL_TEXTURE_2D),
-		TextureName(0), InternalFormat(GL_RGBA), PixelFormat(GL_RGBA), PixelType(GL_UNSIGNED_BYTE), Converter(0), LockReadOnly(false), LockImage(0), LockLayer(0), KeepImage(false),
-		MipLevelStored(0), LegacyAutoGenerateMipMaps(false)
+		TextureName(0), InternalFormat(GL_RGBA), PixelFormat(GL_RGBA), PixelType(GL_UNSIGNED_BYTE), Converter(0), LockReadOnly(false), LockImage(0), LockLayer(0),
+		Readback(0), ReadbackLevel(0), ReadbackLayer(0), DataRevision(0), KeepImage(false), MipLevelStored(0), LegacyAutoGenerateMipMaps(false), UploadPending(false), PendingDataUploaded(false),
+		ImmutableStorage(false), MipLevelCount(1), MipStreaming(false), StreamedLevel(0), ScreenSizeHint(0),
+		CPUMipMaps(false), MipMapFlags(0),
+		Resident(true), LastUseFrame(0)
 	{
 		DriverType = Driver->getDriverType();
 		TextureType = TextureTypeIrrToGL(Type);
@@ -176,47 +259,7 @@ public:
 			os::Printer::log("COpenGLCoreTexture: Color format is not supported", ColorFormatNames[ColorFormat < ECF_UNKNOWN?ColorFormat:ECF_UNKNOWN], ELL_ERROR);
 		}
 
-		glGenTextures(1, &TextureName);
-
-		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
-		Driver->getCacheHandler()->getTextureCache().set(0, this);
-
-
-		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(TextureType, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(TextureType, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-#if defined(GL_VERSION_1_2)
-		glTexParameteri(TextureType, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-#endif
-
-		StatesCache.WrapU = ETC_CLAMP_TO_EDGE;
-		StatesCache.WrapV = ETC_CLAMP_TO_EDGE;
-		StatesCache.WrapW = ETC_CLAMP_TO_EDGE;
-
-		switch (Type)
-		{
-		case ETT_2D:
-			glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
-			break;
-		case ETT_CUBEMAP:
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
-			break;
-		}
-
-		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
-		if ( Driver->testGLError(__LINE__) )
-		{
-			char msg[256];
-			snprintf_irr(msg, 256, "COpenGLCoreTexture: InternalFormat:0x%04x PixelFormat:0x%04x", (int)InternalFormat, (int)PixelFormat);
-			os::Printer::log(msg, ELL_ERROR);
-		}
+		createEmptyStorage();
 	}
 
 	virtual ~COpenGLCoreTexture()
@@ -227,18 +270,69 @@ public:
 		if (LockImage)
 			LockImage->drop();
 
+		if (Readback)
+			Readback->drop();
+
 		for (u32 i = 0; i < Images.size(); ++i)
 			Images[i]->drop();
 	}
 
 	void* lock(E_TEXTURE_LOCK_MODE mode = ETLM_READ_WRITE, u32 mipmapLevel=0, u32 layer = 0, E_TEXTURE_LOCK_FLAGS lockFlags = ETLF_FLIP_Y_UP_RTT) override
 	{
+		if (UploadPending)
+			finishPendingUpload();
+
 		if (LockImage)
 			return getLockImageData(MipLevelStored);
 
 		if (IImage::isCompressedFormat(ColorFormat))
 			return 0;
 
+		if ((lockFlags & ETLF_ASYNC_READ) && mode == ETLM_READ_ONLY && !KeepImage)
+		{
+			if (Readback && (ReadbackLevel != mipmapLevel || ReadbackLayer != layer))
+			{
+				Readback->drop();
+				Readback = 0;
+			}
+
+			if (!Readback)
+			{
+				Readback = Driver->createTextureReadbackAsync(this, mipmapLevel, layer);
+				if (Readback)
+				{
+					ReadbackLevel = mipmapLevel;
+					ReadbackLayer = layer;
+					return 0;
+				}
+				// not supported, read synchronously below
+			}
+			else if (!Readback->isReady() && !Readback->isFailed())
+			{
+				return 0;
+			}
+			else
+			{
+				LockImage = Readback->createImage();
+				Readback->drop();
+				Readback = 0;
+
+				if (LockImage)
+				{
+					LockReadOnly = true;
+					LockLayer = layer;
+					MipLevelStored = mipmapLevel;
+
+					// the request flipped the rows already
+					if (!IsRenderTarget || !(lockFlags & ETLF_FLIP_Y_UP_RTT))
+						flipLockImage();
+
+					return getLockImageData(MipLevelStored);
+				}
+				// failed, read synchronously below
+			}
+		}
+
 		LockReadOnly |= (mode == ETLM_READ_ONLY);
 		LockLayer = layer;
 		MipLevelStored = mipmapLevel;
@@ -282,27 +376,6 @@ public:
 
 				glGetTexImage(tmpTextureType, MipLevelStored, PixelFormat, PixelType, tmpImage->getData());
 				Driver->testGLError(__LINE__);
-
-				if (IsRenderTarget && lockFlags == ETLF_FLIP_Y_UP_RTT)
-				{
-					const s32 pitch = tmpImage->getPitch();
-
-					u8* srcA = static_cast<u8*>(tmpImage->getData());
-					u8* srcB = srcA + (tmpImage->getDimension().Height - 1) * pitch;
-
-					u8* tmpBuffer = new u8[pitch];
-
-					for (u32 i = 0; i < tmpImage->getDimension().Height; i += 2)
-					{
-						memcpy(tmpBuffer, srcA, pitch);
-						memcpy(srcA, srcB, pitch);
-						memcpy(srcB, tmpBuffer, pitch);
-						srcA += pitch;
-						srcB -= pitch;
-					}
-
-					delete[] tmpBuffer;
-				}
 #elif (defined(IRR_COMPILE_GLES2_COMMON)	|| defined(IRR_COMPILE_GLES_COMMON))
 // TODO: on ES2 we can likely also work with glCopyTexImage2D instead of rendering which should be faster.
 				COpenGLCoreTexture* tmpTexture = new COpenGLCoreTexture("OGL_CORE_LOCK_TEXTURE", Size, ETT_2D, ColorFormat, Driver);
@@ -360,6 +433,10 @@ public:
 				tmpImage->drop();
 #endif
 
+				// both ways give the rows bottom up, as the render target stores them
+				if (passed && IsRenderTarget && (lockFlags & ETLF_FLIP_Y_UP_RTT))
+					flipLockImage();
+
 				if (!passed)
 				{
 					LockImage->drop();
@@ -386,6 +463,8 @@ public:
 			uploadTexture(false, LockLayer, MipLevelStored, getLockImageData(MipLevelStored));
 
 			Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+
+			++DataRevision;
 		}
 
 		LockImage->drop();
@@ -400,6 +479,23 @@ public:
 		if (!HasMipMaps || LegacyAutoGenerateMipMaps || (Size.Width <= 1 && Size.Height <= 1))
 			return;
 
+		// the copy in main memory has to match, it is uploaded again when the levels are streamed
+		if (MipStreaming)
+		{
+			if (!data)
+				createMipMapsData(Images[layer]);
+			else if (data != Images[layer]->getMipMapsData())
+				Images[layer]->setMipMapsData(data, false);
+
+			data = Images[layer]->getMipMapsData();
+		}
+		else if (!data && CPUMipMaps && layer < Images.size())
+		{
+			// kept images have the current content
+			createMipMapsData(Images[layer]);
+			data = Images[layer]->getMipMapsData();
+		}
+
 		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
 		Driver->getCacheHandler()->getTextureCache().set(0, this);
 
@@ -438,6 +534,11 @@ public:
 		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
 	}
 
+	GLint getOpenGLInternalFormat() const
+	{
+		return InternalFormat;
+	}
+
 	GLenum getOpenGLTextureType() const
 	{
 		return TextureType;
@@ -453,8 +554,563 @@ public:
 		return StatesCache;
 	}
 
+	//! Incremented whenever the texture data was changed through lock()
+	u32 getDataRevision() const
+	{
+		return DataRevision;
+	}
+
+	//! Exchanges the OpenGL texture and its state with another texture
+	/** Name, source, size hint and last use stay with each texture, so a
+	placeholder can take over a texture created later. Both must not be
+	locked, and the driver must not track either while they are swapped. */
+	void swapTexture(COpenGLCoreTexture& other)
+	{
+		_IRR_DEBUG_BREAK_IF(LockImage || other.LockImage)
+
+		std::swap(OriginalSize, other.OriginalSize);
+		std::swap(Size, other.Size);
+		std::swap(OriginalColorFormat, other.OriginalColorFormat);
+		std::swap(ColorFormat, other.ColorFormat);
+		std::swap(Pitch, other.Pitch);
+		std::swap(HasMipMaps, other.HasMipMaps);
+		std::swap(IsRenderTarget, other.IsRenderTarget);
+		std::swap(Type, other.Type);
+
+		std::swap(TextureType, other.TextureType);
+		std::swap(TextureName, other.TextureName);
+		std::swap(InternalFormat, other.InternalFormat);
+		std::swap(PixelFormat, other.PixelFormat);
+		std::swap(PixelType, other.PixelType);
+		std::swap(Converter, other.Converter);
+		std::swap(KeepImage, other.KeepImage);
+		Images.swap(other.Images);
+		std::swap(LegacyAutoGenerateMipMaps, other.LegacyAutoGenerateMipMaps);
+		std::swap(UploadPending, other.UploadPending);
+		std::swap(PendingDataUploaded, other.PendingDataUploaded);
+		std::swap(ImmutableStorage, other.ImmutableStorage);
+		std::swap(MipLevelCount, other.MipLevelCount);
+		std::swap(MipStreaming, other.MipStreaming);
+		std::swap(StreamedLevel, other.StreamedLevel);
+		std::swap(CPUMipMaps, other.CPUMipMaps);
+		std::swap(MipMapFlags, other.MipMapFlags);
+		std::swap(Resident, other.Resident);
+		std::swap(StatesCache, other.StatesCache);
+		std::swap(Readback, other.Readback);
+		std::swap(ReadbackLevel, other.ReadbackLevel);
+		std::swap(ReadbackLayer, other.ReadbackLayer);
+
+		++DataRevision;
+		++other.DataRevision;
+	}
+
+	bool isReady() const override
+	{
+		return !UploadPending;
+	}
+
+	bool isReadbackPending() const override
+	{
+		return Readback && !Readback->isReady() && !Readback->isFailed();
+	}
+
+	void setScreenSizeHint(u32 size) override
+	{
+		ScreenSizeHint = size;
+	}
+
+	//! True if the texture was created with ETCF_STREAM_MIP_MAPS and the driver supports it
+	bool isMipStreamed() const
+	{
+		return MipStreaming;
+	}
+
+	//! Levels of the full mip chain
+	u32 getMipLevelCount() const
+	{
+		return MipLevelCount;
+	}
+
+	//! Largest mip level uploaded
+	u32 getStreamedLevel() const
+	{
+		return StreamedLevel;
+	}
+
+	//! Largest mip level needed for the screen size hint
+	u32 getRequestedLevel() const
+	{
+		u32 level = 0;
+
+		if (ScreenSizeHint)
+		{
+			while (level + 1 < MipLevelCount && getMaxDimension(level + 1) >= ScreenSizeHint)
+				++level;
+		}
+
+		return level;
+	}
+
+	//! Size of a mip level in bytes
+	u32 getLevelDataSize(u32 level) const
+	{
+		const core::dimension2d<u32> levelSize(IImage::getMipMapsSize(Size, level));
+		return IImage::getDataSizeFromFormat(ColorFormat, levelSize.Width, levelSize.Height);
+	}
+
+	//! Size of all uploaded mip levels in bytes
+	u32 getStreamedDataSize() const
+	{
+		u32 dataSize = 0;
+
+		for (u32 i = StreamedLevel; i < MipLevelCount; ++i)
+			dataSize += getLevelDataSize(i);
+
+		return dataSize;
+	}
+
+	//! Uploads the mip levels from level on into new storage and releases the previous one
+	/** Only used for textures streaming their mip levels. As immutable
+	storage can't be resized, the texture gets a new OpenGL name. */
+	void setStreamedLevel(u32 level)
+	{
+		if (!MipStreaming || level >= MipLevelCount || level == StreamedLevel)
+			return;
+
+		// the levels are uploaded once the texture is used again
+		if (!Resident)
+		{
+			StreamedLevel = level;
+			return;
+		}
+
+		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
+
+		// the cache must not skip binding the new name
+		Driver->getCacheHandler()->getTextureCache().remove(this);
+
+		glDeleteTextures(1, &TextureName);
+		glGenTextures(1, &TextureName);
+		StatesCache.IsCached = false;
+
+		Driver->getCacheHandler()->getTextureCache().set(0, this);
+
+		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		StreamedLevel = level;
+
+		const core::dimension2d<u32> storageSize(IImage::getMipMapsSize(Size, StreamedLevel));
+		Driver->irrGlTexStorage2D(TextureType, MipLevelCount - StreamedLevel, InternalFormat, storageSize.Width, storageSize.Height);
+
+		for (u32 i = StreamedLevel; i < MipLevelCount; ++i)
+			uploadTexture(false, 0, i, (i == 0) ? Images[0]->getData() : Images[0]->getMipMapsData(i));
+
+		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+
+		Driver->testGLError(__LINE__);
+	}
+
+	bool isResident() const override
+	{
+		return Resident;
+	}
+
+	//! Approximate video memory used by the texture, or needed once it is resident again
+	u32 getMemorySize() const
+	{
+		return getStreamedDataSize() * ((Type == ETT_CUBEMAP) ? 6 : 1);
+	}
+
+	//! Called by the cache handler whenever the texture is set
+	void setLastUseFrame(u32 frame) const
+	{
+		LastUseFrame = frame;
+	}
+
+	u32 getLastUseFrame() const
+	{
+		return LastUseFrame;
+	}
+
+	//! True if evict() can release the video memory of the texture
+	bool isEvictable() const
+	{
+		return Resident && !IsRenderTarget && !UploadPending && !LockImage && Images.size() > 0;
+	}
+
+	//! Releases the video memory of the texture, its images stay in main memory
+	bool evict()
+	{
+		if (!isEvictable())
+			return false;
+
+		Driver->getCacheHandler()->getTextureCache().remove(this);
+
+		glDeleteTextures(1, &TextureName);
+		TextureName = 0;
+		Resident = false;
+
+		return true;
+	}
+
+	//! Uploads an evicted texture again
+	/** Called by the cache handler before binding the texture, so the
+	texture is bound to the active unit without going through the cache. */
+	void makeResident()
+	{
+		if (Resident)
+			return;
+
+		glGenTextures(1, &TextureName);
+		glBindTexture(TextureType, TextureName);
+		StatesCache.IsCached = false;
+
+		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		const core::dimension2d<u32> storageSize(IImage::getMipMapsSize(Size, StreamedLevel));
+		ImmutableStorage = Driver->irrGlTexStorage2D(TextureType, MipLevelCount - StreamedLevel, InternalFormat, storageSize.Width, storageSize.Height);
+
+		Resident = true;
+
+		for (u32 i = 0; i < Images.size(); ++i)
+		{
+			uploadTexture(true, i, 0, Images[i]->getData());
+
+			if (HasMipMaps && Images[i]->getMipMapsData())
+			{
+				for (u32 level = 1; level < MipLevelCount; ++level)
+					uploadTexture(true, i, level, Images[i]->getMipMapsData(level));
+			}
+		}
+
+#ifdef IRR_OPENGL_HAS_glGenerateMipmap
+		if (HasMipMaps && !Images[0]->getMipMapsData())
+			Driver->irrGlGenerateMipmap(TextureType);
+#endif
+
+		// only set for restoring a lost texture, see setRestoreImages()
+		if (!KeepImage)
+		{
+			for (u32 i = 0; i < Images.size(); ++i)
+				Images[i]->drop();
+
+			Images.clear();
+		}
+
+		Driver->testGLError(__LINE__);
+	}
+
+	//! Forgets the OpenGL texture after the context was lost, its name isn't valid anymore
+	/** makeResident() uploads the texture again from its images, textures
+	without images need setRestoreImages() or restoreStorage() first. */
+	void onContextLost()
+	{
+		TextureName = 0;
+		Resident = false;
+		StatesCache.IsCached = false;
+
+		// the images of a pending upload are uploaded by makeResident() instead
+		UploadPending = false;
+		PendingDataUploaded = false;
+	}
+
+	//! True if makeResident() can upload the texture from images in main memory
+	bool hasImages() const
+	{
+		return Images.size() > 0;
+	}
+
+	//! Sets the images a lost texture without own images is uploaded from by makeResident()
+	/** The images are converted to the size and format of the texture,
+	and released after the upload unless the texture keeps its images.
+	\return False if they don't fit the texture. */
+	bool setRestoreImages(const core::array<IImage*>& images)
+	{
+		if (Resident || Images.size() > 0 || images.size() != ((Type == ETT_CUBEMAP) ? 6u : 1u))
+			return false;
+
+		for (u32 i = 0; i < images.size(); ++i)
+		{
+			IImage* image = images[i];
+
+			if (!image || (image->getColorFormat() != ColorFormat && (IImage::isCompressedFormat(image->getColorFormat()) || IImage::isCompressedFormat(ColorFormat))))
+				break;
+
+			if (image->getDimension() == Size && image->getColorFormat() == ColorFormat)
+			{
+				image->grab();
+			}
+			else
+			{
+				image = Driver->createImage(ColorFormat, Size);
+
+				if (images[i]->getDimension() == Size)
+					images[i]->copyTo(image);
+				else if (!images[i]->copyToScalingFiltered(image, EISF_BILINEAR))
+					images[i]->copyToScaling(image);
+			}
+
+			if ((MipStreaming || CPUMipMaps) && !image->getMipMapsData())
+				createMipMapsData(image);
+
+			Images.push_back(image);
+		}
+
+		if (Images.size() == images.size())
+			return true;
+
+		for (u32 i = 0; i < Images.size(); ++i)
+			Images[i]->drop();
+
+		Images.clear();
+		return false;
+	}
+
+	//! Allocates empty storage for a lost render target, or a lost texture whose data is gone
+	void restoreStorage()
+	{
+		if (Resident)
+			return;
+
+		createEmptyStorage();
+		Resident = true;
+	}
+
+	//! Size of the data written by writePendingUpload
+	u32 getPendingUploadSize() const
+	{
+		return Images.size() * IImage::getDataSizeFromFormat(ColorFormat, Size.Width, Size.Height);
+	}
+
+	//! Writes the data of all layers of a texture created with ETCF_DEFERRED_UPLOAD, converted for uploading
+	void writePendingUpload(void* target) const
+	{
+		const u32 layerSize = IImage::getDataSizeFromFormat(ColorFormat, Size.Width, Size.Height);
+		u8* tmpTarget = static_cast<u8*>(target);
+
+		for (u32 i = 0; i < Images.size(); ++i, tmpTarget += layerSize)
+		{
+			if (Converter)
+				Converter(Images[i]->getData(), Size.getArea(), tmpTarget);
+			else
+				memcpy(tmpTarget, Images[i]->getData(), layerSize);
+		}
+	}
+
+	//! Uploads the data written by writePendingUpload, finishPendingUpload has to follow
+	/** \param data Pointer to the data, or its offset into the bound pixel unpack buffer. */
+	void uploadPendingData(const void* data)
+	{
+		if (!UploadPending || PendingDataUploaded)
+			return;
+
+		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
+		Driver->getCacheHandler()->getTextureCache().set(0, this);
+
+		const u32 layerSize = IImage::getDataSizeFromFormat(ColorFormat, Size.Width, Size.Height);
+
+		for (u32 i = 0; i < Images.size(); ++i)
+		{
+			const void* layerData = reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(data) + i * layerSize);
+			glTexSubImage2D(getLayerTextureType(i), 0, 0, 0, Size.Width, Size.Height, PixelFormat, PixelType, layerData);
+		}
+
+		PendingDataUploaded = true;
+
+		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+
+		Driver->testGLError(__LINE__);
+	}
+
+	//! Creates the mipmaps of a texture created with ETCF_DEFERRED_UPLOAD and releases its images
+	/** The data is uploaded right away if uploadPendingData wasn't called. */
+	void finishPendingUpload()
+	{
+		if (!UploadPending)
+			return;
+
+		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
+		Driver->getCacheHandler()->getTextureCache().set(0, this);
+
+		if (!PendingDataUploaded)
+		{
+			for (u32 i = 0; i < Images.size(); ++i)
+				uploadTexture(false, i, 0, Images[i]->getData());
+		}
+
+		UploadPending = false;
+		PendingDataUploaded = false;
+
+		if (HasMipMaps && !LegacyAutoGenerateMipMaps)
+		{
+			for (u32 i = 0; i < Images.size(); ++i)
+				regenerateMipMapLevels(Images[i]->getMipMapsData(), i);
+		}
+
+		if (!KeepImage)
+		{
+			for (u32 i = 0; i < Images.size(); ++i)
+				Images[i]->drop();
+
+			Images.clear();
+		}
+
+		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+	}
+
+	//! Storage and data of a texture created with ETCF_DEFERRED_UPLOAD, for uploading on a shared context
+	struct SPendingUpload
+	{
+		GLenum TextureType;
+		GLint InternalFormat;
+		GLenum PixelFormat;
+		GLenum PixelType;
+		core::dimension2d<u32> Size;
+		//! Levels of the immutable storage, 0 if the storage is allocated with glTexImage2D
+		u32 StorageLevels;
+		//! Bytes of a converted layer
+		u32 LayerSize;
+		void (*Converter)(const void*, s32, void*);
+		//! Grabbed images, one per layer
+		core::array<IImage*> Images;
+		//! getDataRevision() of the texture, changed data can't be adopted
+		u32 DataRevision;
+	};
+
+	//! Describes the pending upload and grabs the images, which have to be dropped on the thread of the driver
+	/** \return False if the texture doesn't wait for an upload another context can do. */
+	bool getPendingUpload(SPendingUpload& upload) const
+	{
+		if (!UploadPending || PendingDataUploaded || LegacyAutoGenerateMipMaps)
+			return false;
+
+		upload.TextureType = TextureType;
+		upload.InternalFormat = InternalFormat;
+		upload.PixelFormat = PixelFormat;
+		upload.PixelType = PixelType;
+		upload.Size = Size;
+		upload.StorageLevels = ImmutableStorage ? MipLevelCount : 0;
+		upload.LayerSize = IImage::getDataSizeFromFormat(ColorFormat, Size.Width, Size.Height);
+		upload.Converter = Converter;
+		upload.Images = Images;
+		upload.DataRevision = DataRevision;
+
+		for (u32 i = 0; i < Images.size(); ++i)
+			Images[i]->grab();
+
+		return true;
+	}
+
+	//! Takes over a texture a shared context filled from getPendingUpload() and finishes the upload
+	/** \return False if the texture was uploaded or changed meanwhile, the
+	caller keeps the name then. */
+	bool adoptPendingUpload(GLuint name, u32 dataRevision)
+	{
+		if (!UploadPending || PendingDataUploaded || DataRevision != dataRevision)
+			return false;
+
+		// the cache must not skip binding the new name
+		Driver->getCacheHandler()->getTextureCache().remove(this);
+
+		glDeleteTextures(1, &TextureName);
+		TextureName = name;
+		StatesCache.IsCached = false;
+
+		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
+		Driver->getCacheHandler()->getTextureCache().set(0, this);
+
+		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+
+		PendingDataUploaded = true;
+		finishPendingUpload();
+		return true;
+	}
+
 protected:
 
+	//! Creates the OpenGL texture of a render target, or of a lost texture without images
+	/** The levels of textures with mipmaps are complete, but undefined. */
+	void createEmptyStorage()
+	{
+		glGenTextures(1, &TextureName);
+
+		const COpenGLCoreTexture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
+		Driver->getCacheHandler()->getTextureCache().set(0, this);
+
+		glTexParameteri(TextureType, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(TextureType, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(TextureType, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(TextureType, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+#if defined(GL_VERSION_1_2)
+		glTexParameteri(TextureType, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+#endif
+
+		StatesCache.WrapU = ETC_CLAMP_TO_EDGE;
+		StatesCache.WrapV = ETC_CLAMP_TO_EDGE;
+		StatesCache.WrapW = ETC_CLAMP_TO_EDGE;
+
+		ImmutableStorage = Driver->irrGlTexStorage2D(TextureType, HasMipMaps ? MipLevelCount : 1, InternalFormat, Size.Width, Size.Height);
+
+		if (!ImmutableStorage)
+		{
+			switch (Type)
+			{
+			case ETT_2D:
+				glTexImage2D(GL_TEXTURE_2D, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
+				break;
+			case ETT_CUBEMAP:
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_X, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Y, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Y, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, 0, InternalFormat, Size.Width, Size.Height, 0, PixelFormat, PixelType, 0);
+				break;
+			}
+
+#ifdef IRR_OPENGL_HAS_glGenerateMipmap
+			if (HasMipMaps && !IImage::isCompressedFormat(ColorFormat))
+				Driver->irrGlGenerateMipmap(TextureType);
+#endif
+		}
+
+		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+		if ( Driver->testGLError(__LINE__) )
+		{
+			char msg[256];
+			snprintf_irr(msg, 256, "COpenGLCoreTexture: InternalFormat:0x%04x PixelFormat:0x%04x", (int)InternalFormat, (int)PixelFormat);
+			os::Printer::log(msg, ELL_ERROR);
+		}
+	}
+
+	//! Swaps the rows of LockImage between OpenGL and Irrlicht order
+	void flipLockImage()
+	{
+		const s32 pitch = LockImage->getPitch();
+
+		u8* srcA = static_cast<u8*>(LockImage->getData());
+		u8* srcB = srcA + (LockImage->getDimension().Height - 1) * pitch;
+
+		u8* tmpBuffer = new u8[pitch];
+
+		for (u32 i = 0; i < LockImage->getDimension().Height; i += 2)
+		{
+			memcpy(tmpBuffer, srcA, pitch);
+			memcpy(srcA, srcB, pitch);
+			memcpy(srcB, tmpBuffer, pitch);
+			srcA += pitch;
+			srcB -= pitch;
+		}
+
+		delete[] tmpBuffer;
+	}
+
 	void * getLockImageData(irr::u32 miplevel) const
 	{
 		if ( KeepImage && MipLevelStored > 0
@@ -493,6 +1149,18 @@ protected:
 			break;
 		}
 
+		// formats the driver uploads as they are need no conversion and no copy of the image
+		if (Driver->getTextureCreationFlag(ETCF_PRESERVE_IMAGE_FORMAT) && !Driver->getTextureCreationFlag(ETCF_NO_ALPHA_CHANNEL))
+		{
+			GLint internalFormat = 0;
+			GLenum pixelFormat = 0;
+			GLenum pixelType = 0;
+			void (*converter)(const void*, s32, void*) = 0;
+
+			if (Driver->getColorFormatParameters(format, internalFormat, pixelFormat, pixelType, &converter) && !converter)
+				return format;
+		}
+
 		if (Driver->getTextureCreationFlag(ETCF_NO_ALPHA_CHANNEL))
 		{
 			switch (destFormat)
@@ -556,13 +1224,46 @@ protected:
 		Pitch = Size.Width * IImage::getBitsPerPixelFromFormat(ColorFormat) / 8;
 	}
 
+	static u32 getMipLevelCount(const core::dimension2d<u32>& size)
+	{
+		u32 count = 1;
+
+		for (u32 i = core::max_(size.Width, size.Height); i > 1; i >>= 1)
+			++count;
+
+		return count;
+	}
+
+	u32 getMaxDimension(u32 level) const
+	{
+		const core::dimension2d<u32> levelSize(IImage::getMipMapsSize(Size, level));
+		return core::max_(levelSize.Width, levelSize.Height);
+	}
+
+	//! Replaces the mipmaps of an image by ones filtered from its first level
+	void createMipMapsData(IImage* image) const
+	{
+		image->createMipMaps(MipMapFlags);
+	}
+
+	GLenum getLayerTextureType(u32 layer) const
+	{
+		return (TextureType == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer : TextureType;
+	}
+
+	//! Uploads a mip level, initTexture allocates it unless the storage is immutable
 	void uploadTexture(bool initTexture, u32 layer, u32 level, void* data)
 	{
-		if (!data)
+		// streamed textures only hold the levels from StreamedLevel on
+		if (!data || level < StreamedLevel)
 			return;
 
-		u32 width = Size.Width >> level;
-		u32 height = Size.Height >> level;
+		const core::dimension2d<u32> levelSize(IImage::getMipMapsSize(Size, level));
+		const u32 width = levelSize.Width;
+		const u32 height = levelSize.Height;
+
+		const GLint textureLevel = level - StreamedLevel;
+		initTexture &= !ImmutableStorage;
 
 		GLenum tmpTextureType = TextureType;
 
@@ -588,20 +1289,28 @@ protected:
 				Converter(data, tmpImageSize.getArea(), tmpData);
 			}
 
+			// rows of 8, 16 and 24 bit images don't always start at four byte boundaries
+			const bool unalignedRows = (width * IImage::getBitsPerPixelFromFormat(ColorFormat) / 8) % 4 != 0;
+			if (unalignedRows)
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
 			switch (TextureType)
 			{
 			case GL_TEXTURE_2D:
 			case GL_TEXTURE_CUBE_MAP:
 				if (initTexture)
-					glTexImage2D(tmpTextureType, level, InternalFormat, width, height, 0, PixelFormat, PixelType, tmpData);
+					glTexImage2D(tmpTextureType, textureLevel, InternalFormat, width, height, 0, PixelFormat, PixelType, tmpData);
 				else
-					glTexSubImage2D(tmpTextureType, level, 0, 0, width, height, PixelFormat, PixelType, tmpData);
+					glTexSubImage2D(tmpTextureType, textureLevel, 0, 0, width, height, PixelFormat, PixelType, tmpData);
 				Driver->testGLError(__LINE__);
 				break;
 			default:
 				break;
 			}
 
+			if (unalignedRows)
+				glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
 			delete tmpImage;
 		}
 		else
@@ -613,9 +1322,9 @@ protected:
 			case GL_TEXTURE_2D:
 			case GL_TEXTURE_CUBE_MAP:
 				if (initTexture)
-					Driver->irrGlCompressedTexImage2D(tmpTextureType, level, InternalFormat, width, height, 0, dataSize, data);
+					Driver->irrGlCompressedTexImage2D(tmpTextureType, textureLevel, InternalFormat, width, height, 0, dataSize, data);
 				else
-					Driver->irrGlCompressedTexSubImage2D(tmpTextureType, level, 0, 0, width, height, PixelFormat, dataSize, data);
+					Driver->irrGlCompressedTexSubImage2D(tmpTextureType, textureLevel, 0, 0, width, height, InternalFormat, dataSize, data);
 				Driver->testGLError(__LINE__);
 				break;
 			default:
@@ -651,12 +1360,43 @@ protected:
 	IImage* LockImage;
 	u32 LockLayer;
 
+	//! Pending lock() with ETLF_ASYNC_READ
+	IScreenShotRequest* Readback;
+	u32 ReadbackLevel;
+	u32 ReadbackLayer;
+
+	u32 DataRevision;
+
 	bool KeepImage;
 	core::array<IImage*> Images;
 
 	u8 MipLevelStored;
 	bool LegacyAutoGenerateMipMaps;
 
+	//! True while the images wait in the upload queue of the driver
+	bool UploadPending;
+	bool PendingDataUploaded;
+
+	//! True if the storage was allocated with irrGlTexStorage2D and can't be respecified
+	bool ImmutableStorage;
+
+	//! Levels of the full mip chain, 1 without mipmaps
+	u8 MipLevelCount;
+	//! True if only the mip levels from StreamedLevel on are uploaded, see ETCF_STREAM_MIP_MAPS
+	bool MipStreaming;
+	//! Mip level of the images stored in level 0 of the OpenGL texture
+	u8 StreamedLevel;
+	u32 ScreenSizeHint;
+
+	//! True if missing mip levels are created on the CPU, see ETCF_CREATE_MIP_MAPS_ON_CPU
+	bool CPUMipMaps;
+	//! E_MIP_MAP_FLAGS of the levels created on the CPU
+	u32 MipMapFlags;
+
+	//! False while evicted by the residency budget of the driver
+	bool Resident;
+	mutable u32 LastUseFrame;
+
 	mutable SStatesCache StatesCache;
 };
 
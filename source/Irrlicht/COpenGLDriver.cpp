@@ -31,7 +31,7 @@ const u16 COpenGLDriver::Quad2DIndices[4] = { 0, 1, 2, 3 };
 COpenGLDriver::COpenGLDriver(const SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager)
 	: CNullDriver(io, params.WindowSize), COpenGLExtensionHandler(), CacheHandler(0), CurrentRenderMode(ERM_NONE), ResetRenderStates(true),
 	Transformation3DChanged(true), AntiAlias(params.AntiAlias), ColorFormat(ECF_R8G8B8), FixedPipelineState(EOFPS_ENABLE), Params(params),
-	ContextManager(contextManager)
+	ContextManager(contextManager), StreamBufferID(0), StreamAllocator(1, StreamBufferSize)
 {
 #ifdef _DEBUG
 	setDebugName("COpenGLDriver");
@@ -68,6 +68,7 @@ COpenGLDriver::~COpenGLDriver()
 	deleteAllTextures();
 	removeAllOcclusionQueries();
 	removeAllHardwareBuffers();
+	deleteStreamBuffer();
 
 	delete CacheHandler;
 
@@ -187,6 +188,8 @@ bool COpenGLDriver::genericDriverInit()
 	// create material renderers
 	createMaterialRenderers();
 
+	initStreamBuffer();
+
 	// set the renderstates
 	setRenderStates3DMode();
 
@@ -248,10 +251,29 @@ bool COpenGLDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth,
 	return true;
 }
 
+void COpenGLDriver::discardFrameBuffers()
+{
+	if (CurrentRenderTarget)
+	{
+		if (Feature.ColorAttachment > 0)
+			static_cast<COpenGLRenderTarget*>(CurrentRenderTarget)->resolve();
+	}
+	else
+	{
+		// the screen only presents its color
+		const GLenum attachments[2] = { GL_DEPTH, GL_STENCIL };
+		CacheHandler->setFBO(0);
+		irrGlInvalidateFramebuffer(GL_FRAMEBUFFER, 2, attachments);
+	}
+}
+
 bool COpenGLDriver::endScene()
 {
 	CNullDriver::endScene();
 
+	discardFrameBuffers();
+
+	const u64 swapBeginNs = os::Timer::getRealTimeNs();
 	glFlush();
 
 	bool status = false;
@@ -259,12 +281,21 @@ bool COpenGLDriver::endScene()
 	if (ContextManager)
 		status = ContextManager->swapBuffers();
 
+	registerSwapTime(swapBeginNs);
+
 	// todo: console device present
 
 	return status;
 }
 
 
+//! Sets how many vertical blanks the presentation of endScene() waits for
+bool COpenGLDriver::setSwapInterval(s32 interval)
+{
+	return ContextManager && ContextManager->setSwapInterval(interval);
+}
+
+
 //! Returns the transformation set by setTransform
 const core::matrix4& COpenGLDriver::getTransform(E_TRANSFORMATION_STATE state) const
 {
@@ -390,6 +421,9 @@ bool COpenGLDriver::updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer)
 
 	extGlBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
 
+	countBufferUpload(vertexCount * vertexSize, newBuffer);
+	FrameStats.VerticesUploaded += vertexCount;
+
 	// copy data to graphics card
 	if (!newBuffer)
 		extGlBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * vertexSize, vbuf);
@@ -464,6 +498,8 @@ bool COpenGLDriver::updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffer)
 
 	extGlBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
 
+	countBufferUpload(indexCount * indexSize, newBuffer);
+
 	// copy data to graphics card
 	if (!newBuffer)
 		extGlBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount * indexSize, indices);
@@ -531,7 +567,7 @@ COpenGLDriver::SHWBufferLink *COpenGLDriver::createHardwareBuffer(const scene::I
 	if (!mb || (mb->getHardwareMappingHint_Index()==scene::EHM_NEVER && mb->getHardwareMappingHint_Vertex()==scene::EHM_NEVER))
 		return 0;
 
-	SHWBufferLink_opengl *HWBuffer=new SHWBufferLink_opengl(mb);
+	SHWBufferLink_opengl *HWBuffer=new SHWBufferLink_opengl(mb, this);
 
 	//add to map
 	HWBuffer->listPosition = HWBufferList.insert(HWBufferList.end(), HWBuffer);
@@ -764,8 +800,15 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 	if (!checkPrimitiveCount(primitiveCount))
 		return;
 
+	// skinned and compact vertices need the shader variants of the OpenGL 3 driver
+	if (vType == EVT_SKINNED || vType == EVT_COMPACT)
+		return;
+
 	CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
+	long verticesBase = 0;
+	const bool streamed = streamPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType, verticesBase);
+
 	if (vertices && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
 		getColorBuffer(vertices, vertexCount, vType);
 
@@ -799,6 +842,9 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 				case EVT_TANGENTS:
 					glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Color);
 					break;
+				case EVT_SKINNED:
+				case EVT_COMPACT:
+					break;
 			}
 		}
 		else
@@ -820,10 +866,10 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 			}
 			else
 			{
-				glNormalPointer(GL_FLOAT, sizeof(S3DVertex), buffer_offset(12));
-				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), buffer_offset(24));
-				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(28));
-				glVertexPointer(3, GL_FLOAT, sizeof(S3DVertex), 0);
+				glNormalPointer(GL_FLOAT, sizeof(S3DVertex), buffer_offset(verticesBase + 12));
+				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), buffer_offset(verticesBase + 24));
+				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(verticesBase + 28));
+				glVertexPointer(3, GL_FLOAT, sizeof(S3DVertex), buffer_offset(verticesBase));
 			}
 
 			if (Feature.MaxTextureUnits > 0 && CacheHandler->getTextureCache()[1])
@@ -833,7 +879,7 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 				if (vertices)
 					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].TCoords);
 				else
-					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(28));
+					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(verticesBase + 28));
 			}
 			break;
 		case EVT_2TCOORDS:
@@ -845,10 +891,10 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 			}
 			else
 			{
-				glNormalPointer(GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(12));
-				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex2TCoords), buffer_offset(24));
-				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(28));
-				glVertexPointer(3, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(0));
+				glNormalPointer(GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 12));
+				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 24));
+				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 28));
+				glVertexPointer(3, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase));
 			}
 
 
@@ -859,7 +905,7 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 				if (vertices)
 					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), &(static_cast<const S3DVertex2TCoords*>(vertices))[0].TCoords2);
 				else
-					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(36));
+					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 36));
 			}
 			break;
 		case EVT_TANGENTS:
@@ -871,10 +917,10 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 			}
 			else
 			{
-				glNormalPointer(GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(12));
-				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertexTangents), buffer_offset(24));
-				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(28));
-				glVertexPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(0));
+				glNormalPointer(GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 12));
+				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 24));
+				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 28));
+				glVertexPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(verticesBase));
 			}
 
 			if (Feature.MaxTextureUnits > 0)
@@ -884,20 +930,26 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 				if (vertices)
 					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Tangent);
 				else
-					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(36));
+					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 36));
 
 				CacheHandler->setClientActiveTexture(GL_TEXTURE0 + 2);
 				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 				if (vertices)
 					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Binormal);
 				else
-					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(48));
+					glTexCoordPointer(3, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 48));
 			}
 			break;
+		case EVT_SKINNED:
+		case EVT_COMPACT:
+			break;
 	}
 
 	renderArray(indexList, primitiveCount, pType, iType);
 
+	if (streamed)
+		endStreamDraw();
+
 	if (Feature.MaxTextureUnits > 0)
 	{
 		if (vType==EVT_TANGENTS)
@@ -915,6 +967,126 @@ void COpenGLDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 }
 
 
+//! Number of indices renderArray reads
+static u32 getIndexCount(scene::E_PRIMITIVE_TYPE pType, u32 primitiveCount)
+{
+	switch (pType)
+	{
+		case scene::EPT_LINE_STRIP:
+			return primitiveCount + 1;
+		case scene::EPT_LINE_LOOP:
+		case scene::EPT_POLYGON:
+			return primitiveCount;
+		case scene::EPT_LINES:
+			return primitiveCount * 2;
+		case scene::EPT_TRIANGLE_STRIP:
+		case scene::EPT_TRIANGLE_FAN:
+			return primitiveCount + 2;
+		case scene::EPT_TRIANGLES:
+			return primitiveCount * 3;
+		case scene::EPT_QUAD_STRIP:
+			return primitiveCount * 2 + 2;
+		case scene::EPT_QUADS:
+			return primitiveCount * 4;
+		default:
+			return 0;
+	}
+}
+
+
+void COpenGLDriver::initStreamBuffer()
+{
+#if defined(GL_ARB_vertex_buffer_object)
+	if (!FeatureAvailable[IRR_ARB_vertex_buffer_object])
+		return;
+
+	extGlGenBuffers(1, &StreamBufferID);
+	if (!StreamBufferID)
+		return;
+
+	extGlBindBuffer(GL_ARRAY_BUFFER, StreamBufferID);
+	extGlBufferData(GL_ARRAY_BUFFER, StreamAllocator.getSize(), 0, GL_STREAM_DRAW);
+	extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (testGLError(__LINE__))
+		deleteStreamBuffer();
+	else
+		os::Printer::log("Using stream buffer.", ELL_DEBUG);
+#endif
+}
+
+
+void COpenGLDriver::deleteStreamBuffer()
+{
+#if defined(GL_ARB_vertex_buffer_object)
+	if (StreamBufferID)
+		extGlDeleteBuffers(1, &StreamBufferID);
+	StreamBufferID = 0;
+#endif
+}
+
+
+bool COpenGLDriver::uploadStreamData(GLenum target, const void* data, u32 size, u32& offset)
+{
+#if defined(GL_ARB_vertex_buffer_object)
+	if (!StreamBufferID || !size || size > StreamAllocator.getSize())
+		return false;
+
+	extGlBindBuffer(target, StreamBufferID);
+	if (!StreamAllocator.allocate(size, offset))
+	{
+		// Orphan the full buffer. The draws still reading it keep the old
+		// storage, so the new one is written without waiting for them.
+		extGlBufferData(target, StreamAllocator.getSize(), 0, GL_STREAM_DRAW);
+		countBufferUpload(0, true);
+		StreamAllocator.resetRegion();
+		StreamAllocator.allocate(size, offset);
+	}
+
+	extGlBufferSubData(target, offset, size, data);
+	countBufferUpload(size, false);
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+bool COpenGLDriver::streamPrimitiveList(const void*& vertices, u32 vertexCount, const void*& indexList,
+		u32 primitiveCount, E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType, long& verticesBase)
+{
+	bool streamed = false;
+	u32 offset;
+
+	// the colors in the buffer can't be swizzled on the CPU, so they need GL_BGRA
+	if (vertices && (FeatureAvailable[IRR_ARB_vertex_array_bgra] || FeatureAvailable[IRR_EXT_vertex_array_bgra]) &&
+		uploadStreamData(GL_ARRAY_BUFFER, vertices, vertexCount * getVertexPitchFromType(vType), offset))
+	{
+		vertices = 0;
+		verticesBase = offset;
+		streamed = true;
+	}
+
+	const u32 indexCount = getIndexCount(pType, primitiveCount);
+	if (indexList && indexCount &&
+		uploadStreamData(GL_ELEMENT_ARRAY_BUFFER, indexList, indexCount * (iType == EIT_32BIT ? sizeof(u32) : sizeof(u16)), offset))
+	{
+		indexList = buffer_offset(offset);
+		streamed = true;
+	}
+
+	return streamed;
+}
+
+
+void COpenGLDriver::endStreamDraw()
+{
+	// the pointers keep the buffer they were set with
+	extGlBindBuffer(GL_ARRAY_BUFFER, 0);
+	extGlBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+
 void COpenGLDriver::getColorBuffer(const void* vertices, u32 vertexCount, E_VERTEX_TYPE vType)
 {
 	// convert colors to gl color format.
@@ -954,6 +1126,9 @@ void COpenGLDriver::getColorBuffer(const void* vertices, u32 vertexCount, E_VERT
 			}
 		}
 		break;
+		case EVT_SKINNED:
+		case EVT_COMPACT:
+			break;
 	}
 }
 
@@ -1080,8 +1255,14 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 	if (!checkPrimitiveCount(primitiveCount))
 		return;
 
+	if (vType == EVT_SKINNED || vType == EVT_COMPACT)
+		return;
+
 	CNullDriver::draw2DVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
 
+	long verticesBase = 0;
+	const bool streamed = streamPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType, verticesBase);
+
 	if (vertices && !FeatureAvailable[IRR_ARB_vertex_array_bgra] && !FeatureAvailable[IRR_EXT_vertex_array_bgra])
 		getColorBuffer(vertices, vertexCount, vType);
 
@@ -1126,6 +1307,9 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 				case EVT_TANGENTS:
 					glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertexTangents), &(static_cast<const S3DVertexTangents*>(vertices))[0].Color);
 					break;
+				case EVT_SKINNED:
+				case EVT_COMPACT:
+					break;
 			}
 		}
 		else
@@ -1146,9 +1330,9 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 			}
 			else
 			{
-				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), buffer_offset(24));
-				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(28));
-				glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex), 0);
+				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex), buffer_offset(verticesBase + 24));
+				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(verticesBase + 28));
+				glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(verticesBase));
 			}
 
 			if (Feature.MaxTextureUnits > 0 && CacheHandler->getTextureCache()[1])
@@ -1158,7 +1342,7 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 				if (vertices)
 					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), &(static_cast<const S3DVertex*>(vertices))[0].TCoords);
 				else
-					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(28));
+					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex), buffer_offset(verticesBase + 28));
 			}
 			break;
 		case EVT_2TCOORDS:
@@ -1169,9 +1353,9 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 			}
 			else
 			{
-				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex2TCoords), buffer_offset(24));
-				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(28));
-				glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(0));
+				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 24));
+				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 28));
+				glVertexPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase));
 			}
 
 			if (Feature.MaxTextureUnits > 0)
@@ -1181,7 +1365,7 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 				if (vertices)
 					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), &(static_cast<const S3DVertex2TCoords*>(vertices))[0].TCoords2);
 				else
-					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(36));
+					glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertex2TCoords), buffer_offset(verticesBase + 36));
 			}
 			break;
 		case EVT_TANGENTS:
@@ -1192,16 +1376,22 @@ void COpenGLDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCo
 			}
 			else
 			{
-				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertexTangents), buffer_offset(24));
-				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(28));
-				glVertexPointer(2, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(0));
+				glColorPointer(colorSize, GL_UNSIGNED_BYTE, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 24));
+				glTexCoordPointer(2, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(verticesBase + 28));
+				glVertexPointer(2, GL_FLOAT, sizeof(S3DVertexTangents), buffer_offset(verticesBase));
 			}
 
+			break;
+		case EVT_SKINNED:
+		case EVT_COMPACT:
 			break;
 	}
 
 	renderArray(indexList, primitiveCount, pType, iType);
 
+	if (streamed)
+		endStreamDraw();
+
 	if (Feature.MaxTextureUnits > 0)
 	{
 		if ((vType!=EVT_STANDARD) || CacheHandler->getTextureCache()[1])
@@ -2072,6 +2262,7 @@ void COpenGLDriver::setRenderStates3DMode()
 				Material, LastMaterial, ResetRenderStates, this);
 
 		LastMaterial = Material;
+		++FrameStats.MaterialChanges;
 		CacheHandler->correctCacheMaterial(LastMaterial);
 		ResetRenderStates = false;
 	}
@@ -2354,7 +2545,7 @@ void COpenGLDriver::setBasicRenderStates(const SMaterial& material, const SMater
 		glPolygonMode(GL_FRONT_AND_BACK, material.Wireframe ? GL_LINE : material.PointCloud? GL_POINT : GL_FILL);
 
 	// ZBuffer
-	switch (material.ZBuffer)
+	switch (getDepthComparison(material))
 	{
 	case ECFN_DISABLED:
 		CacheHandler->setDepthTest(false);
@@ -3042,7 +3233,7 @@ void COpenGLDriver::drawStencilShadowVolume(const core::array<core::vector3df>&
 	glDisable(GL_LIGHTING);
 	glDisable(GL_FOG);
 	glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LESS);
+	glDepthFunc(ReverseDepth ? GL_GREATER : GL_LESS);
 	glDepthMask(GL_FALSE);
 
 	if (debugDataVisible & scene::EDS_MESH_WIRE_OVERLAY)
@@ -3636,6 +3827,9 @@ bool COpenGLDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SCol
 
 	bool supportForFBO = (Feature.ColorAttachment > 0);
 
+	if (supportForFBO && CurrentRenderTarget && CurrentRenderTarget != target)
+		static_cast<COpenGLRenderTarget*>(CurrentRenderTarget)->resolve();
+
 	core::dimension2d<u32> destRenderTargetSize(0, 0);
 
 	if (target)
@@ -3644,8 +3838,8 @@ bool COpenGLDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SCol
 
 		if (supportForFBO)
 		{
-			CacheHandler->setFBO(renderTarget->getBufferID());
 			renderTarget->update();
+			CacheHandler->setFBO(renderTarget->getBufferID());
 		}
 
 		destRenderTargetSize = renderTarget->getSize();
@@ -3723,7 +3917,7 @@ void COpenGLDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 	if (flag & ECBF_DEPTH)
 	{
 		CacheHandler->setDepthMask(true);
-		glClearDepth(depth);
+		glClearDepth(getClearDepth(depth));
 		mask |= GL_DEPTH_BUFFER_BIT;
 	}
 
@@ -3741,6 +3935,18 @@ void COpenGLDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 }
 
 
+void COpenGLDriver::setReverseDepth(bool reverse)
+{
+	if (reverse == ReverseDepth)
+		return;
+
+	CNullDriver::setReverseDepth(reverse);
+
+	// the depth comparisons of the current material are swapped
+	ResetRenderStates = true;
+}
+
+
 //! Returns an image created from the last rendered frame.
 IImage* COpenGLDriver::createScreenShot(video::ECOLOR_FORMAT format, video::E_RENDER_TARGET target)
 {
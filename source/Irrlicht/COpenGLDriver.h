@@ -23,6 +23,7 @@ namespace irr
 
 #include "COpenGLExtensionHandler.h"
 #include "IContextManager.h"
+#include "COpenGLCoreStreamAllocator.h"
 
 namespace irr
 {
@@ -55,13 +56,16 @@ namespace video
 
 		bool endScene() override;
 
+		//! Sets how many vertical blanks the presentation of endScene() waits for
+		bool setSwapInterval(s32 interval) override;
+
 		//! sets transformation
 		void setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat) override;
 
 
 		struct SHWBufferLink_opengl : public SHWBufferLink
 		{
-			SHWBufferLink_opengl(const scene::IMeshBuffer *_MeshBuffer): SHWBufferLink(_MeshBuffer), vbo_verticesID(0),vbo_indicesID(0){}
+			SHWBufferLink_opengl(const scene::IMeshBuffer *_MeshBuffer, CNullDriver *driver): SHWBufferLink(_MeshBuffer, driver), vbo_verticesID(0),vbo_indicesID(0){}
 
 			GLuint vbo_verticesID; //tmp
 			GLuint vbo_indicesID; //tmp
@@ -334,6 +338,9 @@ namespace video
 
 		void clearBuffers(u16 flag, SColor color = SColor(255,0,0,0), f32 depth = 1.f, u8 stencil = 0) override;
 
+		//! Sets if depth values get smaller with the distance from the camera
+		void setReverseDepth(bool reverse) override;
+
 		//! Returns an image created from the last rendered frame.
 		IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override;
 
@@ -424,11 +431,33 @@ namespace video
 
 		void createMaterialRenderers();
 
+		//! Resolves the current render target, or discards the depth and stencil of the screen
+		void discardFrameBuffers();
+
 		//! Assign a hardware light to the specified requested light, if any
 		//! free hardware lights exist.
 		//! \param[in] lightIndex: the index of the requesting light
 		void assignHardwareLight(u32 lightIndex);
 
+		//! Creates the buffer client-side geometry is streamed through, if buffer objects are supported
+		void initStreamBuffer();
+		void deleteStreamBuffer();
+
+		//! Copies data into the stream buffer bound to target, orphaning the buffer when it is full
+		/** \return False if streaming is unavailable or the data is larger than the buffer. */
+		bool uploadStreamData(GLenum target, const void* data, u32 size, u32& offset);
+
+		//! Moves client-side vertices and indices of a draw into the stream buffer
+		/** Streamed vertices are passed on like those of a hardware buffer, as 0 with
+		their offset in verticesBase, streamed indices as their offset in the buffer.
+		\return True if anything was streamed, then endStreamDraw() is due after the draw. */
+		bool streamPrimitiveList(const void*& vertices, u32 vertexCount, const void*& indexList,
+				u32 primitiveCount, E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType,
+				long& verticesBase);
+
+		//! Unbinds the stream buffer after a draw
+		void endStreamDraw();
+
 		//! helper function for render setup.
 		void getColorBuffer(const void* vertices, u32 vertexCount, E_VERTEX_TYPE vType);
 
@@ -485,6 +514,12 @@ namespace video
 		static const u16 Quad2DIndices[4];
 
 		IContextManager* ContextManager;
+
+		static const u32 StreamBufferSize = 4 * 1024 * 1024;
+		//! Buffer for client-side geometry, 0 without buffer objects
+		GLuint StreamBufferID;
+		//! A single region, the buffer is orphaned instead of fenced
+		COpenGLCoreStreamAllocator StreamAllocator;
 	};
 
 } // end namespace video
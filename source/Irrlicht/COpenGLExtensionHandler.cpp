@@ -9,6 +9,7 @@
 #include "irrString.h"
 #include "SMaterial.h"
 #include "fast_atof.h"
+#include "CGLExtensionNameIndex.h"
 
 namespace irr
 {
@@ -58,6 +59,7 @@ COpenGLExtensionHandler::COpenGLExtensionHandler() :
 	pGlCheckFramebufferStatus(0), pGlFramebufferTexture2D(0),
 	pGlBindRenderbuffer(0), pGlDeleteRenderbuffers(0), pGlGenRenderbuffers(0),
 	pGlRenderbufferStorage(0), pGlFramebufferRenderbuffer(0), pGlGenerateMipmap(0),
+	pGlRenderbufferStorageMultisample(0), pGlBlitFramebuffer(0), pGlInvalidateFramebuffer(0),
 	// EXT framebuffer object
 	pGlBindFramebufferEXT(0), pGlDeleteFramebuffersEXT(0), pGlGenFramebuffersEXT(0),
 	pGlCheckFramebufferStatusEXT(0), pGlFramebufferTexture2DEXT(0),
@@ -351,37 +353,9 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 		os::Printer::log("OpenGL driver version is not 1.2 or better.", ELL_WARNING);
 
 	{
-		const char* t = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
-		size_t len = 0;
-		c8 *str = 0;
-		if (t)
-		{
-			len = strlen(t);
-			str = new c8[len+1];
-		}
-		c8* p = str;
-
-		for (size_t i=0; i<len; ++i)
-		{
-			str[i] = static_cast<char>(t[i]);
-
-			if (str[i] == ' ')
-			{
-				str[i] = 0;
-				for (u32 j=0; j<IRR_OpenGL_Feature_Count; ++j)
-				{
-					if (!strcmp(OpenGLFeatureStrings[j], p))
-					{
-						FeatureAvailable[j] = true;
-						break;
-					}
-				}
-
-				p = p + strlen(p) + 1;
-			}
-		}
-
-		delete [] str;
+		static const CGLExtensionNameIndex knownExtensions(OpenGLFeatureStrings, IRR_OpenGL_Feature_Count);
+		knownExtensions.parse(reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS)),
+			[this](u32 index) { FeatureAvailable[index] = true; });
 	}
 
 	TextureCompressionExtension = FeatureAvailable[IRR_ARB_texture_compression];
@@ -516,6 +490,9 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 	pGlRenderbufferStorage = (PFNGLRENDERBUFFERSTORAGEPROC) IRR_OGL_LOAD_EXTENSION("glRenderbufferStorage");
 	pGlFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC) IRR_OGL_LOAD_EXTENSION("glFramebufferRenderbuffer");
 	pGlGenerateMipmap = (PFNGLGENERATEMIPMAPPROC) IRR_OGL_LOAD_EXTENSION("glGenerateMipmap");
+	pGlRenderbufferStorageMultisample = (PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC) IRR_OGL_LOAD_EXTENSION("glRenderbufferStorageMultisample");
+	pGlBlitFramebuffer = (PFNGLBLITFRAMEBUFFERPROC) IRR_OGL_LOAD_EXTENSION("glBlitFramebuffer");
+	pGlInvalidateFramebuffer = (PFNGLINVALIDATEFRAMEBUFFERPROC) IRR_OGL_LOAD_EXTENSION("glInvalidateFramebuffer");
 
 	// EXT FrameBufferObjects
 	pGlBindFramebufferEXT = (PFNGLBINDFRAMEBUFFEREXTPROC) IRR_OGL_LOAD_EXTENSION("glBindFramebufferEXT");
@@ -711,6 +688,14 @@ void COpenGLExtensionHandler::initExtensions(bool stencilBuffer)
 	{
 		glGetIntegerv(GL_MAX_COLOR_ATTACHMENTS, &num);
 		Feature.ColorAttachment = static_cast<u8>(num);
+
+		// the multisampled render targets are resolved by a blit, both part of the extension
+		glGetIntegerv(GL_MAX_SAMPLES, &num);
+		Feature.MaxRenderTargetSamples = static_cast<u8>(core::s32_min(num, 255));
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+		if (!pGlRenderbufferStorageMultisample || !pGlBlitFramebuffer)
+			Feature.MaxRenderTargetSamples = 0;
+#endif
 	}
 #endif
 #if defined(GL_EXT_framebuffer_object)
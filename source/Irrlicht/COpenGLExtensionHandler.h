@@ -1156,7 +1156,11 @@ class COpenGLExtensionHandler
 	void irrGlGenRenderbuffers(GLsizei n, GLuint *renderbuffers);
 	void irrGlRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
 	void irrGlFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+	void irrGlRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+	void irrGlBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+	void irrGlInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments);
 	void irrGlGenerateMipmap(GLenum target);
+	bool irrGlTexStorage2D(GLenum target, GLsizei levels, GLint internalformat, GLsizei width, GLsizei height);
 	void irrGlActiveStencilFace(GLenum face);
 	void irrGlDrawBuffer(GLenum mode);
 	void irrGlDrawBuffers(GLsizei n, const GLenum *bufs);
@@ -1306,6 +1310,9 @@ class COpenGLExtensionHandler
 		PFNGLRENDERBUFFERSTORAGEPROC pGlRenderbufferStorage;
 		PFNGLFRAMEBUFFERRENDERBUFFERPROC pGlFramebufferRenderbuffer;
 		PFNGLGENERATEMIPMAPPROC pGlGenerateMipmap;
+		PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC pGlRenderbufferStorageMultisample;
+		PFNGLBLITFRAMEBUFFERPROC pGlBlitFramebuffer;
+		PFNGLINVALIDATEFRAMEBUFFERPROC pGlInvalidateFramebuffer;
 		// EXT framebuffer object
 		PFNGLBINDFRAMEBUFFEREXTPROC pGlBindFramebufferEXT;
 		PFNGLDELETEFRAMEBUFFERSEXTPROC pGlDeleteFramebuffersEXT;
@@ -2377,6 +2384,41 @@ inline void COpenGLExtensionHandler::irrGlFramebufferRenderbuffer(GLenum target,
 #endif
 }
 
+inline void COpenGLExtensionHandler::irrGlRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlRenderbufferStorageMultisample)
+		pGlRenderbufferStorageMultisample(target, samples, internalformat, width, height);
+#elif defined(GL_ARB_framebuffer_object)
+	glRenderbufferStorageMultisample(target, samples, internalformat, width, height);
+#else
+	os::Printer::log("glRenderbufferStorageMultisample not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::irrGlBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+{
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlBlitFramebuffer)
+		pGlBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+#elif defined(GL_ARB_framebuffer_object)
+	glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+#else
+	os::Printer::log("glBlitFramebuffer not supported", ELL_ERROR);
+#endif
+}
+
+inline void COpenGLExtensionHandler::irrGlInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments)
+{
+	// only a hint, nothing to do without it
+#ifdef _IRR_OPENGL_USE_EXTPOINTER_
+	if (pGlInvalidateFramebuffer)
+		pGlInvalidateFramebuffer(target, numAttachments, attachments);
+#elif defined(GL_ARB_invalidate_subdata)
+	glInvalidateFramebuffer(target, numAttachments, attachments);
+#endif
+}
+
 inline void COpenGLExtensionHandler::irrGlGenerateMipmap(GLenum target)
 {
 #ifdef _IRR_OPENGL_USE_EXTPOINTER_
@@ -2393,6 +2435,12 @@ inline void COpenGLExtensionHandler::irrGlGenerateMipmap(GLenum target)
 #endif
 }
 
+inline bool COpenGLExtensionHandler::irrGlTexStorage2D(GLenum target, GLsizei levels, GLint internalformat, GLsizei width, GLsizei height)
+{
+	// textures of this driver are always mutable
+	return false;
+}
+
 inline void COpenGLExtensionHandler::irrGlActiveStencilFace(GLenum face)
 {
 #ifdef _IRR_OPENGL_USE_EXTPOINTER_
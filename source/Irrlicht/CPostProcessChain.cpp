@@ -0,0 +1,298 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CPostProcessChain.h"
+#include "IVideoDriver.h"
+#include "IRenderTarget.h"
+#include "os.h"
+
+namespace irr
+{
+namespace video
+{
+
+CPostProcessChain::CPostProcessChain(IVideoDriver* driver)
+	: Driver(driver), SceneFormat(ECF_A8R8G8B8), ClearColor(255,0,0,0),
+	Scene(0), SceneLastReader(-1), TargetMilliseconds(0.f), MinScale(0.5f), MaxScale(1.f),
+	ResolutionScale(1.f), AverageMilliseconds(0.f), FramesSinceChange(0), OuterTarget(0), Active(false)
+{
+	#ifdef _DEBUG
+	setDebugName("CPostProcessChain");
+	#endif
+
+	Driver->grab();
+
+	UpscaleMaterial.MaterialType = EMT_SOLID;
+	UpscaleMaterial.ZBuffer = ECFN_DISABLED;
+	UpscaleMaterial.ZWriteEnable = EZW_OFF;
+	UpscaleMaterial.BackfaceCulling = false;
+	UpscaleMaterial.Lighting = false;
+	UpscaleMaterial.TextureLayer[0].BilinearFilter = true;
+	UpscaleMaterial.TextureLayer[0].TextureWrapU = ETC_CLAMP_TO_EDGE;
+	UpscaleMaterial.TextureLayer[0].TextureWrapV = ETC_CLAMP_TO_EDGE;
+}
+
+CPostProcessChain::~CPostProcessChain()
+{
+	Driver->drop();
+}
+
+u32 CPostProcessChain::addPass(s32 materialType, f32 scale, ECOLOR_FORMAT format)
+{
+	SPass pass;
+	pass.Material.MaterialType = (E_MATERIAL_TYPE)materialType;
+	pass.Material.ZBuffer = ECFN_DISABLED;
+	pass.Material.ZWriteEnable = EZW_OFF;
+	pass.Material.BackfaceCulling = false;
+	pass.Material.Lighting = false;
+	pass.Inputs[0] = Passes.empty() ? (s32)EPPS_SCENE : (s32)Passes.size() - 1;
+	for (u32 i = 1; i < MATERIAL_MAX_TEXTURES; ++i)
+		pass.Inputs[i] = EPPS_NONE;
+	pass.Scale = scale;
+	pass.Format = format;
+	pass.Output = 0;
+	pass.LastReader = -1;
+	Passes.push_back(pass);
+	return Passes.size() - 1;
+}
+
+void CPostProcessChain::removeAllPasses()
+{
+	if (Active)
+	{
+		os::Printer::log("Can't remove the passes of an active post-processing chain", ELL_WARNING);
+		return;
+	}
+	Passes.clear();
+}
+
+void CPostProcessChain::setPassInput(u32 pass, u32 layer, s32 source)
+{
+	if (pass >= Passes.size() || layer >= MATERIAL_MAX_TEXTURES ||
+		source >= (s32)pass || source < EPPS_NONE)
+	{
+		os::Printer::log("Invalid input of a post-processing pass", ELL_WARNING);
+		return;
+	}
+	Passes[pass].Inputs[layer] = source;
+}
+
+void CPostProcessChain::setDynamicResolution(f32 milliseconds, f32 minScale, f32 maxScale)
+{
+	TargetMilliseconds = core::max_(milliseconds, 0.f);
+	MaxScale = core::clamp(maxScale, 0.05f, 1.f);
+	MinScale = core::clamp(minScale, 0.05f, MaxScale);
+	ResolutionScale = TargetMilliseconds > 0.f ? MaxScale : 1.f;
+	AverageMilliseconds = 0.f;
+	FramesSinceChange = 0;
+}
+
+bool CPostProcessChain::begin()
+{
+	if (Active || (Passes.empty() && TargetMilliseconds <= 0.f) || !Driver->queryFeature(EVDF_RENDER_TO_TARGET))
+		return false;
+
+	if (TargetMilliseconds > 0.f)
+		updateResolutionScale();
+
+	// each target goes back to the pool after the last pass reading it
+	SceneLastReader = -1;
+	bool depthRead = false;
+	for (u32 i = 0; i < Passes.size(); ++i)
+	{
+		Passes[i].LastReader = -1;
+		for (u32 l = 0; l < MATERIAL_MAX_TEXTURES; ++l)
+		{
+			const s32 source = Passes[i].Inputs[l];
+			if (source >= 0)
+				Passes[source].LastReader = i;
+			else if (source != EPPS_NONE)
+				SceneLastReader = i;
+			depthRead |= (source == EPPS_SCENE_DEPTH);
+		}
+	}
+
+	OuterTarget = Driver->getCurrentRenderTarget();
+	OuterViewPort = Driver->getViewPort();
+	const core::dimension2d<u32> size(
+		core::max_(core::round32(OuterViewPort.getWidth() * ResolutionScale), 1),
+		core::max_(core::round32(OuterViewPort.getHeight() * ResolutionScale), 1));
+
+	const ECOLOR_FORMAT depthFormat = Driver->queryTextureFormat(ECF_D24S8) ? ECF_D24S8 : ECF_D16;
+	Scene = Driver->acquireTransientRenderTarget(size, SceneFormat, depthFormat);
+	if (!Scene)
+	{
+		os::Printer::log("Could not create the scene textures of a post-processing chain", ELL_ERROR);
+		return false;
+	}
+	Scene->setDiscardDepthStencil(!depthRead);
+
+	if (!Driver->setRenderTargetEx(Scene, ECBF_COLOR | ECBF_DEPTH, ClearColor))
+	{
+		releaseSource(EPPS_SCENE, Passes.size());
+		return false;
+	}
+
+	Active = true;
+	return true;
+}
+
+void CPostProcessChain::end()
+{
+	if (!Active)
+		return;
+	Active = false;
+
+	const core::matrix4 world = Driver->getTransform(ETS_WORLD);
+	const core::matrix4 view = Driver->getTransform(ETS_VIEW);
+	const core::matrix4 projection = Driver->getTransform(ETS_PROJECTION);
+	Driver->setTransform(ETS_WORLD, core::IdentityMatrix);
+	Driver->setTransform(ETS_VIEW, core::IdentityMatrix);
+	Driver->setTransform(ETS_PROJECTION, core::IdentityMatrix);
+
+	// a single triangle covering the target, texture coordinates 0 to 1 inside
+	const S3DVertex vertices[3] = {
+		S3DVertex(-1.f, -1.f, 0.f, 0.f, 0.f, -1.f, SColor(0xffffffff), 0.f, 0.f),
+		S3DVertex(3.f, -1.f, 0.f, 0.f, 0.f, -1.f, SColor(0xffffffff), 2.f, 0.f),
+		S3DVertex(-1.f, 3.f, 0.f, 0.f, 0.f, -1.f, SColor(0xffffffff), 0.f, 2.f)
+	};
+	const u16 indices[3] = { 0, 1, 2 };
+
+	const core::dimension2d<u32> sceneSize = Scene->getTexture()[0]->getSize();
+
+	if (Passes.empty())
+	{
+		// dynamic resolution alone, the scene still has to reach the viewport
+		Driver->setRenderTargetEx(OuterTarget, 0);
+		Driver->setViewPort(OuterViewPort);
+		UpscaleMaterial.TextureLayer[0].Texture = Scene->getTexture()[0];
+		Driver->setMaterial(UpscaleMaterial);
+		Driver->drawIndexedTriangleList(vertices, 3, indices, 1);
+		UpscaleMaterial.TextureLayer[0].Texture = 0;
+	}
+
+	for (u32 i = 0; i < Passes.size(); ++i)
+	{
+		SPass& pass = Passes[i];
+
+		if (i + 1 == Passes.size())
+		{
+			Driver->setRenderTargetEx(OuterTarget, 0);
+			Driver->setViewPort(OuterViewPort);
+		}
+		else
+		{
+			const core::dimension2d<u32> size(
+				core::max_((u32)(sceneSize.Width * pass.Scale), 1u),
+				core::max_((u32)(sceneSize.Height * pass.Scale), 1u));
+			pass.Output = Driver->acquireTransientRenderTarget(size, pass.Format);
+			if (!pass.Output)
+			{
+				os::Printer::log("Could not create the texture of a post-processing pass", ELL_ERROR);
+				break;
+			}
+			Driver->setRenderTargetEx(pass.Output, 0);
+		}
+
+		SMaterial material = pass.Material;
+		for (u32 l = 0; l < MATERIAL_MAX_TEXTURES; ++l)
+		{
+			if (pass.Inputs[l] == EPPS_NONE)
+				continue;
+			SMaterialLayer& layer = material.TextureLayer[l];
+			layer.Texture = getSource(pass.Inputs[l]);
+			layer.TextureWrapU = ETC_CLAMP_TO_EDGE;
+			layer.TextureWrapV = ETC_CLAMP_TO_EDGE;
+		}
+		Driver->setMaterial(material);
+		Driver->drawIndexedTriangleList(vertices, 3, indices, 1);
+
+		for (u32 l = 0; l < MATERIAL_MAX_TEXTURES; ++l)
+			releaseSource(pass.Inputs[l], i);
+		if (pass.LastReader < 0)
+			releaseSource(i, i);
+	}
+
+	// after a failed pass, or for sources nobody read
+	for (u32 i = 0; i < Passes.size(); ++i)
+		releaseSource(i, Passes.size());
+	releaseSource(EPPS_SCENE, Passes.size());
+
+	Driver->setRenderTargetEx(OuterTarget, 0);
+	Driver->setViewPort(OuterViewPort);
+	Driver->setTransform(ETS_WORLD, world);
+	Driver->setTransform(ETS_VIEW, view);
+	Driver->setTransform(ETS_PROJECTION, projection);
+}
+
+ITexture* CPostProcessChain::getSource(s32 source) const
+{
+	if (source >= 0)
+		return Passes[source].Output ? Passes[source].Output->getTexture()[0] : 0;
+	if (source == EPPS_SCENE)
+		return Scene->getTexture()[0];
+	if (source == EPPS_SCENE_DEPTH)
+		return Scene->getDepthStencil();
+	return 0;
+}
+
+void CPostProcessChain::updateResolutionScale()
+{
+	// results of a frame only come in a few frames later, skip those still drawn at the old scale
+	if (FramesSinceChange < 8)
+	{
+		++FramesSinceChange;
+		return;
+	}
+
+	const core::array<SGPUTimerResult>& results = Driver->getGPUTimerResults();
+	f32 milliseconds = 0.f;
+	for (u32 i = 0; i < results.size(); ++i)
+	{
+		if (results[i].Depth == 0)
+			milliseconds += results[i].Milliseconds;
+	}
+	if (milliseconds <= 0.f)
+		return;
+
+	AverageMilliseconds = AverageMilliseconds > 0.f ? AverageMilliseconds * 0.8f + milliseconds * 0.2f : milliseconds;
+
+	// hysteresis, a scale between fits and drawing a step larger wouldn't
+	if (AverageMilliseconds <= TargetMilliseconds && AverageMilliseconds >= TargetMilliseconds * 0.75f)
+		return;
+
+	// the GPU time mostly follows the number of pixels, the square of the scale
+	f32 scale = ResolutionScale * core::squareroot(TargetMilliseconds * 0.9f / AverageMilliseconds);
+	scale = core::clamp(core::round_(scale * 20.f) / 20.f, MinScale, MaxScale);
+	if (core::equals(scale, ResolutionScale))
+		return;
+
+	ResolutionScale = scale;
+	AverageMilliseconds = 0.f;
+	FramesSinceChange = 0;
+}
+
+void CPostProcessChain::releaseSource(s32 source, u32 pass)
+{
+	IRenderTarget** target = 0;
+	s32 lastReader = -1;
+	if (source >= 0)
+	{
+		target = &Passes[source].Output;
+		lastReader = Passes[source].LastReader;
+	}
+	else if (source != EPPS_NONE)
+	{
+		target = &Scene;
+		lastReader = SceneLastReader;
+	}
+
+	if (!target || !*target || lastReader > (s32)pass)
+		return;
+
+	Driver->releaseTransientRenderTarget(*target);
+	*target = 0;
+}
+
+} // end namespace video
+} // end namespace irr
@@ -0,0 +1,102 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_POST_PROCESS_CHAIN_H_INCLUDED__
+#define __C_POST_PROCESS_CHAIN_H_INCLUDED__
+
+#include "IPostProcessChain.h"
+#include "irrArray.h"
+#include "rect.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+	class IRenderTarget;
+	class ITexture;
+
+//! Draws the passes of IPostProcessChain into render targets of the transient pool of the driver
+class CPostProcessChain : public IPostProcessChain
+{
+public:
+	CPostProcessChain(IVideoDriver* driver);
+
+	~CPostProcessChain();
+
+	u32 addPass(s32 materialType, f32 scale, ECOLOR_FORMAT format) override;
+
+	u32 getPassCount() const override { return Passes.size(); }
+
+	void removeAllPasses() override;
+
+	void setPassInput(u32 pass, u32 layer, s32 source) override;
+
+	SMaterial& getPassMaterial(u32 pass) override { return Passes[pass].Material; }
+
+	void setSceneFormat(ECOLOR_FORMAT format) override { SceneFormat = format; }
+
+	void setClearColor(SColor color) override { ClearColor = color; }
+
+	void setDynamicResolution(f32 milliseconds, f32 minScale, f32 maxScale) override;
+
+	f32 getResolutionScale() const override { return ResolutionScale; }
+
+	bool begin() override;
+
+	void end() override;
+
+	bool isActive() const override { return Active; }
+
+private:
+	struct SPass
+	{
+		SMaterial Material;
+		s32 Inputs[MATERIAL_MAX_TEXTURES];
+		f32 Scale;
+		ECOLOR_FORMAT Format;
+		IRenderTarget* Output;
+		//! Last pass reading the output, or -1
+		s32 LastReader;
+	};
+
+	//! Returns the texture of an input source while drawing
+	ITexture* getSource(s32 source) const;
+
+	//! Gives a target back to the pool once the pass has been its last reader
+	void releaseSource(s32 source, u32 pass);
+
+	//! Adapts ResolutionScale to the latest GPU timer results
+	void updateResolutionScale();
+
+	IVideoDriver* Driver;
+
+	core::array<SPass> Passes;
+	ECOLOR_FORMAT SceneFormat;
+	SColor ClearColor;
+
+	IRenderTarget* Scene;
+	s32 SceneLastReader;
+
+	//! Dynamic resolution, disabled while TargetMilliseconds is 0
+	f32 TargetMilliseconds;
+	f32 MinScale;
+	f32 MaxScale;
+	f32 ResolutionScale;
+	f32 AverageMilliseconds;
+	u32 FramesSinceChange;
+
+	//! Draws the scene into the viewport when there are no passes
+	SMaterial UpscaleMaterial;
+
+	//! State of the driver at begin()
+	IRenderTarget* OuterTarget;
+	core::rect<s32> OuterViewPort;
+
+	bool Active;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
@@ -0,0 +1,176 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CProfiler.h"
+
+#ifdef _IRR_COMPILE_WITH_PROFILER_
+
+#include "IWriteFile.h"
+#include "irrString.h"
+
+namespace irr
+{
+
+namespace
+{
+	//! zones the writer may overwrite while writeChromeTrace() reads the oldest ones
+	const u32 OverwriteMargin = 1024;
+
+	//! appends text to the file in large writes
+	struct STraceWriter
+	{
+		STraceWriter(io::IWriteFile* file) : File(file), Ok(true) {}
+
+		void add(const c8* text)
+		{
+			Text += text;
+			if (Text.size() >= 65536)
+				flush();
+		}
+
+		bool flush()
+		{
+			if (Text.size() && File->write(Text.c_str(), Text.size()) != Text.size())
+				Ok = false;
+			Text = "";
+			return Ok;
+		}
+
+		io::IWriteFile* File;
+		core::stringc Text;
+		bool Ok;
+	};
+
+	//! zone names are literals of the engine, escaping only keeps the JSON valid
+	void addEscaped(STraceWriter& writer, const c8* name)
+	{
+		c8 c[2] = { 0, 0 };
+		for (; *name; ++name)
+		{
+			if (*name == '"' || *name == '\\')
+				writer.add("\\");
+			c[0] = *name;
+			writer.add(c);
+		}
+	}
+}
+
+
+//! Returns the profiler every zone records to
+CProfiler& CProfiler::getInstance()
+{
+	static CProfiler profiler;
+	return profiler;
+}
+
+
+CProfiler::CProfiler() : Enabled(false)
+{
+}
+
+
+CProfiler::~CProfiler()
+{
+	for (u32 i = 0; i < Buffers.size(); ++i)
+		delete Buffers[i];
+}
+
+
+void CProfiler::setEnabled(bool enabled)
+{
+	Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+bool CProfiler::isEnabled() const
+{
+	return Enabled.load(std::memory_order_relaxed);
+}
+
+
+void CProfiler::clear()
+{
+	std::lock_guard<std::mutex> lock(BuffersMutex);
+	for (u32 i = 0; i < Buffers.size(); ++i)
+		Buffers[i]->ClearedCount = Buffers[i]->Count.load(std::memory_order_acquire);
+}
+
+
+//! Returns the buffer of the calling thread, creating it on first use
+CProfiler::SThreadBuffer* CProfiler::getThreadBuffer()
+{
+	static thread_local SThreadBuffer* threadBuffer = 0;
+	if (!threadBuffer)
+	{
+		threadBuffer = new SThreadBuffer();
+		threadBuffer->Count.store(0, std::memory_order_relaxed);
+		threadBuffer->ClearedCount = 0;
+
+		std::lock_guard<std::mutex> lock(BuffersMutex);
+		threadBuffer->Id = Buffers.size();
+		Buffers.push_back(threadBuffer);
+	}
+	return threadBuffer;
+}
+
+
+//! Adds a zone to the buffer of the calling thread
+void CProfiler::record(const c8* name, u64 beginNs, u64 endNs)
+{
+	SThreadBuffer* buffer = getThreadBuffer();
+	const u32 count = buffer->Count.load(std::memory_order_relaxed);
+
+	SZone& zone = buffer->Zones[count % BufferZones];
+	zone.Name = name;
+	zone.BeginNs = beginNs;
+	zone.EndNs = endNs;
+
+	buffer->Count.store(count + 1, std::memory_order_release);
+}
+
+
+bool CProfiler::writeChromeTrace(io::IWriteFile* file) const
+{
+	if (!file)
+		return false;
+
+	STraceWriter writer(file);
+	c8 line[128];
+	bool first = true;
+
+	writer.add("{\"traceEvents\":[\n");
+
+	std::lock_guard<std::mutex> lock(BuffersMutex);
+	for (u32 i = 0; i < Buffers.size(); ++i)
+	{
+		const SThreadBuffer* buffer = Buffers[i];
+
+		snprintf_irr(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}}",
+			first ? "" : ",\n", buffer->Id, buffer->Id);
+		writer.add(line);
+		first = false;
+
+		const u32 count = buffer->Count.load(std::memory_order_acquire);
+		u32 recorded = count - buffer->ClearedCount;
+		if (recorded > BufferZones - OverwriteMargin)
+			recorded = BufferZones - OverwriteMargin;
+
+		for (u32 j = count - recorded; j != count; ++j)
+		{
+			const SZone& zone = buffer->Zones[j % BufferZones];
+			writer.add(",\n{\"name\":\"");
+			addEscaped(writer, zone.Name);
+			snprintf_irr(line, sizeof(line), "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				buffer->Id, zone.BeginNs / 1000.0, (zone.EndNs - zone.BeginNs) / 1000.0);
+			writer.add(line);
+		}
+	}
+
+	writer.add("\n]}\n");
+	return writer.flush();
+}
+
+} // end namespace irr
+
+#endif // _IRR_COMPILE_WITH_PROFILER_
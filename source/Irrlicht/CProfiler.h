@@ -0,0 +1,117 @@
+// Copyright (C) 2002-2012 Nikolaus Gebhardt
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_PROFILER_H_INCLUDED__
+#define __C_PROFILER_H_INCLUDED__
+
+#include "IProfiler.h"
+
+#ifdef _IRR_COMPILE_WITH_PROFILER_
+
+#include "irrArray.h"
+#include "os.h"
+#include <atomic>
+#include <mutex>
+
+namespace irr
+{
+
+//! The profiler of the zones, one per process as zones run without a device
+class CProfiler : public IProfiler
+{
+public:
+
+	//! Returns the profiler every zone records to
+	static CProfiler& getInstance();
+
+	~CProfiler();
+
+	void setEnabled(bool enabled) override;
+
+	bool isEnabled() const override;
+
+	void clear() override;
+
+	bool writeChromeTrace(io::IWriteFile* file) const override;
+
+	//! Returns if zones are recorded, cheap enough to ask in every zone
+	bool isRecording() const
+	{
+		return Enabled.load(std::memory_order_relaxed);
+	}
+
+	//! Adds a zone to the buffer of the calling thread
+	/** \param name Has to live as long as the profiler, usually a literal. */
+	void record(const c8* name, u64 beginNs, u64 endNs);
+
+private:
+
+	CProfiler();
+
+	//! zones kept per thread
+	static constexpr u32 BufferZones = 1 << 14;
+
+	struct SZone
+	{
+		const c8* Name;
+		u64 BeginNs;
+		u64 EndNs;
+	};
+
+	//! zones of one thread, only written by that thread
+	struct SThreadBuffer
+	{
+		//! number of zones ever recorded, published after the zone is written
+		std::atomic<u32> Count;
+		//! value of Count at the last clear(), only used under BuffersMutex
+		u32 ClearedCount;
+		u32 Id;
+		SZone Zones[BufferZones];
+	};
+
+	//! Returns the buffer of the calling thread, creating it on first use
+	SThreadBuffer* getThreadBuffer();
+
+	std::atomic<bool> Enabled;
+
+	//! guards Buffers, which are never freed while the profiler lives
+	mutable std::mutex BuffersMutex;
+	core::array<SThreadBuffer*> Buffers;
+};
+
+//! Records the time until the end of its scope as zone
+class CProfileScope
+{
+public:
+	CProfileScope(const c8* name) : Name(name),
+		BeginNs(CProfiler::getInstance().isRecording() ? os::Timer::getRealTimeNs() : 0)
+	{
+	}
+
+	~CProfileScope()
+	{
+		if (BeginNs)
+			CProfiler::getInstance().record(Name, BeginNs, os::Timer::getRealTimeNs());
+	}
+
+private:
+	const c8* Name;
+	u64 BeginNs;
+};
+
+} // end namespace irr
+
+#define IRR_PROFILE_CONCAT_(a, b) a##b
+#define IRR_PROFILE_CONCAT(a, b) IRR_PROFILE_CONCAT_(a, b)
+
+//! Records the rest of the enclosing scope as zone of the given name
+#define IRR_PROFILE_SCOPE(name) irr::CProfileScope IRR_PROFILE_CONCAT(irrProfileScope, __LINE__)(name)
+
+#else
+
+#define IRR_PROFILE_SCOPE(name)
+
+#endif // _IRR_COMPILE_WITH_PROFILER_
+
+#endif
@@ -4,6 +4,12 @@
 
 #include "CReadFile.h"
 
+#if !defined(_IRR_WINDOWS_API_) && (defined(_IRR_POSIX_API_) || defined(_IRR_OSX_PLATFORM_) || defined(_IRR_ANDROID_PLATFORM_))
+	#include <unistd.h>
+	#include <errno.h>
+	#define _IRR_READ_FILE_PREAD_
+#endif
+
 namespace irr
 {
 namespace io
@@ -50,6 +56,38 @@ bool CReadFile::seek(long finalPos, bool relativeMovement)
 }
 
 
+//! reads from a position without changing the position of read()
+size_t CReadFile::readAt(long offset, void* buffer, size_t sizeToRead)
+{
+	if (!isOpen() || offset < 0)
+		return 0;
+
+#if defined(_IRR_READ_FILE_PREAD_)
+	// the descriptor has no position of its own for pread, the FILE buffer isn't used
+	const int fd = fileno(File);
+	size_t done = 0;
+	while (done < sizeToRead)
+	{
+		const ssize_t r = pread(fd, (c8*)buffer + done, sizeToRead - done, (off_t)offset + done);
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0)
+			break;
+		done += (size_t)r;
+	}
+	return done;
+#else
+	std::lock_guard<std::mutex> lock(ReadAtLock);
+	const long pos = ftell(File);
+	if (fseek(File, offset, SEEK_SET) != 0)
+		return 0;
+	const size_t r = fread(buffer, 1, sizeToRead, File);
+	fseek(File, pos, SEEK_SET);
+	return r;
+#endif
+}
+
+
 //! returns size of file
 long CReadFile::getSize() const
 {
@@ -9,6 +9,8 @@
 #include "IReadFile.h"
 #include "irrString.h"
 
+#include <mutex>
+
 namespace irr
 {
 
@@ -32,6 +34,9 @@ namespace io
 		//! changes position in file, returns true if successful
 		bool seek(long finalPos, bool relativeMovement = false) override;
 
+		//! reads from a position without changing the position of read()
+		size_t readAt(long offset, void* buffer, size_t sizeToRead) override;
+
 		//! returns size of file
 		long getSize() const override;
 
@@ -64,6 +69,8 @@ namespace io
 		FILE* File;
 		long FileSize;
 		io::path Filename;
+		//! Serializes readAt() where there's no pread()
+		std::mutex ReadAtLock;
 	};
 
 } // end namespace io
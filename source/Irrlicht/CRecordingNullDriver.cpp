@@ -0,0 +1,558 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CRecordingNullDriver.h"
+#include "IWriteFile.h"
+#include "IMeshBuffer.h"
+#include "os.h"
+
+namespace irr
+{
+namespace video
+{
+
+namespace
+{
+	// FNV-1a over the elements, matrices may carry a flag besides them
+	u32 hashMatrix(const core::matrix4& matrix)
+	{
+		const u8* bytes = reinterpret_cast<const u8*>(matrix.pointer());
+		u32 hash = 2166136261u;
+		for (u32 i = 0; i < 16 * sizeof(f32); ++i)
+			hash = (hash ^ bytes[i]) * 16777619u;
+		return hash;
+	}
+
+	// textures are logged by name, their addresses differ between runs
+	const c8* getTextureName(const ITexture* texture)
+	{
+		return texture ? texture->getName().getPath().c_str() : "none";
+	}
+}
+
+
+CRecordingNullDriver::CRecordingNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize)
+	: CNullDriver(io, screenSize), Recording(false), Log(0),
+	MaterialRevision(1), LastMaterialRevision(0), ResetRenderStates(true),
+	NextBufferID(1), NextRenderTargetID(1)
+{
+	#ifdef _DEBUG
+	setDebugName("CRecordingNullDriver");
+	#endif
+
+	for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i)
+		BoundTextures[i] = 0;
+}
+
+
+CRecordingNullDriver::~CRecordingNullDriver()
+{
+	if (Log)
+		Log->drop();
+}
+
+
+bool CRecordingNullDriver::setCommandRecording(bool enable, io::IWriteFile* log)
+{
+	if (!enable)
+		log = 0;
+	if (log)
+		log->grab();
+	if (Log)
+		Log->drop();
+	Log = log;
+
+	// the first draw after starting sets all states, like after a context switch
+	Recording = enable;
+	ResetRenderStates = true;
+	for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i)
+		BoundTextures[i] = 0;
+
+	return Recording;
+}
+
+
+void CRecordingNullDriver::record(const c8* line)
+{
+	if (!Log)
+		return;
+
+	Log->write(line, strlen(line));
+	Log->write("\n", 1);
+}
+
+
+bool CRecordingNullDriver::beginScene(u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil,
+		const SExposedVideoData& videoData, core::rect<s32>* sourceRect)
+{
+	CNullDriver::beginScene(clearFlag, clearColor, clearDepth, clearStencil, videoData, sourceRect);
+
+	if (Recording)
+	{
+		c8 tmp[64];
+		snprintf_irr(tmp, sizeof(tmp), "frame %u", getFrameCount());
+		record(tmp);
+		clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
+	}
+	return true;
+}
+
+
+bool CRecordingNullDriver::endScene()
+{
+	if (Recording)
+	{
+		const SFrameStats& stats = getFrameStats();
+		c8 tmp[256];
+		snprintf_irr(tmp, sizeof(tmp), "end draws %u primitives %u materials %u binds %u targets %u uploaded %u",
+			stats.DrawCalls, stats.PrimitivesDrawn, stats.MaterialChanges, stats.TextureBinds,
+			stats.RenderTargetSwitches, stats.BufferBytesUploaded);
+		record(tmp);
+	}
+
+	return CNullDriver::endScene();
+}
+
+
+void CRecordingNullDriver::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat)
+{
+	if (!Recording)
+	{
+		CNullDriver::setTransform(state, mat);
+		return;
+	}
+
+	Matrices[state] = mat;
+
+	// world matrices are part of the draw lines
+	if (state != ETS_WORLD)
+	{
+		c8 tmp[64];
+		snprintf_irr(tmp, sizeof(tmp), "transform %d %08x", (s32)state, hashMatrix(mat));
+		record(tmp);
+	}
+}
+
+
+const core::matrix4& CRecordingNullDriver::getTransform(E_TRANSFORMATION_STATE state) const
+{
+	if (!Recording)
+		return CNullDriver::getTransform(state);
+	return Matrices[state];
+}
+
+
+void CRecordingNullDriver::setMaterial(const SMaterial& material)
+{
+	if (!Recording)
+	{
+		CNullDriver::setMaterial(material);
+		return;
+	}
+
+	bool changed;
+	if (!OverrideMaterial.Enabled)
+	{
+		changed = Material != material;
+		if (changed)
+			Material = material;
+	}
+	else
+	{
+		SMaterial overridden(material);
+		OverrideMaterial.apply(overridden);
+		changed = Material != overridden;
+		if (changed)
+			Material = std::move(overridden);
+	}
+
+	if (changed)
+		++MaterialRevision;
+}
+
+
+void CRecordingNullDriver::setRenderStates3DMode()
+{
+	if (ResetRenderStates || LastMaterialRevision != MaterialRevision)
+	{
+		++FrameStats.MaterialChanges;
+
+		c8 tmp[256];
+		snprintf_irr(tmp, sizeof(tmp), "material %d zbuffer %d zwrite %d culling %d %d wireframe %d blend %d lighting %d",
+			(s32)Material.MaterialType, (s32)Material.ZBuffer, (s32)Material.ZWriteEnable,
+			(s32)Material.BackfaceCulling, (s32)Material.FrontfaceCulling, (s32)Material.Wireframe,
+			(s32)Material.BlendOperation, (s32)Material.Lighting);
+		record(tmp);
+
+		LastMaterialRevision = MaterialRevision;
+		ResetRenderStates = false;
+	}
+
+	for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i)
+		bindTexture(i, Material.getTexture(i));
+}
+
+
+void CRecordingNullDriver::setRenderStates2DMode(const ITexture* texture)
+{
+	// 2d draws set their own states, the next 3d draw restores the material
+	ResetRenderStates = true;
+	bindTexture(0, texture);
+}
+
+
+void CRecordingNullDriver::bindTexture(u32 unit, const ITexture* texture)
+{
+	if (BoundTextures[unit] == texture)
+		return;
+
+	// unbinding is logged, but isn't counted as a bind
+	BoundTextures[unit] = texture;
+	if (texture)
+		++FrameStats.TextureBinds;
+
+	c8 tmp[256];
+	snprintf_irr(tmp, sizeof(tmp), "bind %u %s", unit, getTextureName(texture));
+	record(tmp);
+}
+
+
+void CRecordingNullDriver::recordDraw(const c8* kind, u32 buffer, u32 vertexCount, u32 primitiveCount,
+		E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+{
+	c8 tmp[128];
+	snprintf_irr(tmp, sizeof(tmp), "%s %u vertices %u primitives %u type %d %d %d world %08x",
+		kind, buffer, vertexCount, primitiveCount, (s32)vType, (s32)pType, (s32)iType,
+		hashMatrix(Matrices[ETS_WORLD]));
+	record(tmp);
+}
+
+
+bool CRecordingNullDriver::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SColor clearColor,
+		f32 clearDepth, u8 clearStencil)
+{
+	if (!Recording)
+		return CNullDriver::setRenderTargetEx(target, clearFlag, clearColor, clearDepth, clearStencil);
+
+	if (target && target->getDriverType() != EDT_NULL)
+	{
+		os::Printer::log("Fatal Error: Tried to set a render target not owned by this driver.", ELL_ERROR);
+		return false;
+	}
+
+	if (CurrentRenderTarget != target)
+		++FrameStats.RenderTargetSwitches;
+
+	CurrentRenderTarget = target;
+	CurrentRenderTargetSize = target ? static_cast<CRenderTarget*>(target)->getSize() : core::dimension2d<u32>(0, 0);
+
+	c8 tmp[64];
+	snprintf_irr(tmp, sizeof(tmp), "target %u", target ? static_cast<CRenderTarget*>(target)->ID : 0);
+	record(tmp);
+
+	clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
+	return true;
+}
+
+
+void CRecordingNullDriver::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
+{
+	if (!Recording || !flag)
+		return;
+
+	c8 tmp[64];
+	snprintf_irr(tmp, sizeof(tmp), "clear %u %08x %g %u", (u32)flag, color.color, depth, (u32)stencil);
+	record(tmp);
+}
+
+
+IRenderTarget* CRecordingNullDriver::addRenderTarget()
+{
+	if (!Recording)
+		return CNullDriver::addRenderTarget();
+
+	CRenderTarget* renderTarget = new CRenderTarget(NextRenderTargetID++);
+	RenderTargets.push_back(renderTarget);
+
+	return renderTarget;
+}
+
+
+ITexture* CRecordingNullDriver::addRenderTargetTexture(const core::dimension2d<u32>& size,
+		const io::path& name, const ECOLOR_FORMAT format)
+{
+	if (!Recording)
+		return CNullDriver::addRenderTargetTexture(size, name, format);
+
+	SRenderTargetTexture* texture = new SRenderTargetTexture(name, size,
+		format == ECF_UNKNOWN ? ECF_A8R8G8B8 : format);
+	addTexture(texture);
+	texture->drop();
+
+	return texture;
+}
+
+
+void CRecordingNullDriver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
+		const void* indexList, u32 primitiveCount,
+		E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+{
+	CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+
+	if (!Recording)
+		return;
+
+	setRenderStates3DMode();
+	recordDraw("draw", 0, vertexCount, primitiveCount, vType, pType, iType);
+}
+
+
+void CRecordingNullDriver::draw2DVertexPrimitiveList(const void* vertices, u32 vertexCount,
+		const void* indexList, u32 primitiveCount,
+		E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+{
+	CNullDriver::draw2DVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+
+	if (!Recording)
+		return;
+
+	setRenderStates2DMode(Material.getTexture(0));
+	recordDraw("draw2d", 0, vertexCount, primitiveCount, vType, pType, iType);
+}
+
+
+void CRecordingNullDriver::draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+		SColor color, bool useAlphaChannelOfTexture)
+{
+	if (!Recording || !texture)
+		return;
+
+	setRenderStates2DMode(texture);
+
+	c8 tmp[256];
+	snprintf_irr(tmp, sizeof(tmp), "image %d %d %d %d %d %d %08x %d", destPos.X, destPos.Y,
+		sourceRect.UpperLeftCorner.X, sourceRect.UpperLeftCorner.Y,
+		sourceRect.LowerRightCorner.X, sourceRect.LowerRightCorner.Y,
+		color.color, (s32)useAlphaChannelOfTexture);
+	record(tmp);
+
+	CNullDriver::draw2DVertexPrimitiveList(0, 4, 0, 2, EVT_STANDARD, scene::EPT_TRIANGLES, EIT_16BIT);
+}
+
+
+void CRecordingNullDriver::draw2DRectangle(const core::rect<s32>& pos,
+		SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
+		const core::rect<s32>* clip)
+{
+	if (!Recording)
+		return;
+
+	setRenderStates2DMode(0);
+
+	c8 tmp[128];
+	snprintf_irr(tmp, sizeof(tmp), "rectangle %d %d %d %d %08x", pos.UpperLeftCorner.X, pos.UpperLeftCorner.Y,
+		pos.LowerRightCorner.X, pos.LowerRightCorner.Y, colorLeftUp.color);
+	record(tmp);
+
+	CNullDriver::draw2DVertexPrimitiveList(0, 4, 0, 2, EVT_STANDARD, scene::EPT_TRIANGLES, EIT_16BIT);
+}
+
+
+void CRecordingNullDriver::draw2DLine(const core::position2d<s32>& start,
+		const core::position2d<s32>& end, SColor color)
+{
+	if (!Recording)
+		return;
+
+	setRenderStates2DMode(0);
+
+	c8 tmp[128];
+	snprintf_irr(tmp, sizeof(tmp), "line2d %d %d %d %d %08x", start.X, start.Y, end.X, end.Y, color.color);
+	record(tmp);
+
+	CNullDriver::draw2DVertexPrimitiveList(0, 2, 0, 1, EVT_STANDARD, scene::EPT_LINES, EIT_16BIT);
+}
+
+
+void CRecordingNullDriver::draw3DLine(const core::vector3df& start,
+		const core::vector3df& end, SColor color)
+{
+	if (!Recording)
+		return;
+
+	// drawVertexPrimitiveList applies the material and records the draw
+	S3DVertex vertices[2];
+	vertices[0] = S3DVertex(start.X, start.Y, start.Z, 0, 0, 1, color, 0, 0);
+	vertices[1] = S3DVertex(end.X, end.Y, end.Z, 0, 0, 1, color, 0, 0);
+	const u16 indices[] = {0, 1};
+
+	drawVertexPrimitiveList(vertices, 2, indices, 1, EVT_STANDARD, scene::EPT_LINES, EIT_16BIT);
+}
+
+
+CRecordingNullDriver::SHWBufferLink* CRecordingNullDriver::createHardwareBuffer(const scene::IMeshBuffer* mb)
+{
+	if (!Recording)
+		return CNullDriver::createHardwareBuffer(mb);
+
+	if (!mb || (mb->getHardwareMappingHint_Index() == scene::EHM_NEVER && mb->getHardwareMappingHint_Vertex() == scene::EHM_NEVER))
+		return 0;
+
+	SHWBufferLink_recording* HWBuffer = new SHWBufferLink_recording(mb, this, NextBufferID++);
+
+	//add to map
+	HWBuffer->listPosition = HWBufferList.insert(HWBufferList.end(), HWBuffer);
+
+	// zero forces the first upload in updateHardwareBuffer
+	HWBuffer->ChangedID_Vertex = 0;
+	HWBuffer->ChangedID_Index = 0;
+	HWBuffer->Mapped_Vertex = mb->getHardwareMappingHint_Vertex();
+	HWBuffer->Mapped_Index = mb->getHardwareMappingHint_Index();
+
+	c8 tmp[64];
+	snprintf_irr(tmp, sizeof(tmp), "create buffer %u", HWBuffer->ID);
+	record(tmp);
+
+	updateHardwareBuffer(HWBuffer);
+	return HWBuffer;
+}
+
+
+bool CRecordingNullDriver::updateHardwareBuffer(SHWBufferLink* HWBuffer)
+{
+	if (!HWBuffer || !HWBuffer->MeshBuffer)
+		return false;
+
+	const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+	const u32 id = static_cast<SHWBufferLink_recording*>(HWBuffer)->ID;
+	c8 tmp[64];
+
+	// the buffers are rewritten completely, as the null driver doesn't
+	// know which part of the data changed
+	if (HWBuffer->Mapped_Vertex != scene::EHM_NEVER && HWBuffer->ChangedID_Vertex != mb->getChangedID_Vertex())
+	{
+		const bool reallocated = HWBuffer->ChangedID_Vertex == 0;
+		HWBuffer->ChangedID_Vertex = mb->getChangedID_Vertex();
+
+		const u32 bytes = getVertexPitchFromType(mb->getVertexType()) * mb->getVertexCount();
+		countBufferUpload(bytes, reallocated);
+		snprintf_irr(tmp, sizeof(tmp), "upload vertices %u %u", id, bytes);
+		record(tmp);
+	}
+
+	if (HWBuffer->Mapped_Index != scene::EHM_NEVER && HWBuffer->ChangedID_Index != mb->getChangedID_Index())
+	{
+		const bool reallocated = HWBuffer->ChangedID_Index == 0;
+		HWBuffer->ChangedID_Index = mb->getChangedID_Index();
+
+		const u32 bytes = mb->getIndexCount() * (mb->getIndexType() == EIT_16BIT ? sizeof(u16) : sizeof(u32));
+		countBufferUpload(bytes, reallocated);
+		snprintf_irr(tmp, sizeof(tmp), "upload indices %u %u", id, bytes);
+		record(tmp);
+	}
+
+	return true;
+}
+
+
+void CRecordingNullDriver::drawHardwareBuffer(SHWBufferLink* HWBuffer)
+{
+	if (!HWBuffer || !HWBuffer->MeshBuffer)
+		return;
+
+	const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+
+	if (Recording)
+		updateHardwareBuffer(HWBuffer);
+
+	// no vertices, they are in the buffer
+	CNullDriver::drawVertexPrimitiveList(0, mb->getVertexCount(), 0, mb->getPrimitiveCount(),
+		mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType());
+
+	if (!Recording)
+		return;
+
+	setRenderStates3DMode();
+	recordDraw("draw buffer", static_cast<SHWBufferLink_recording*>(HWBuffer)->ID, mb->getVertexCount(),
+		mb->getPrimitiveCount(), mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType());
+}
+
+
+void CRecordingNullDriver::deleteHardwareBuffer(SHWBufferLink* HWBuffer)
+{
+	if (!HWBuffer)
+		return;
+
+	if (Recording)
+	{
+		c8 tmp[64];
+		snprintf_irr(tmp, sizeof(tmp), "delete buffer %u", static_cast<SHWBufferLink_recording*>(HWBuffer)->ID);
+		record(tmp);
+	}
+
+	CNullDriver::deleteHardwareBuffer(HWBuffer);
+}
+
+
+CRecordingNullDriver::CRenderTarget::~CRenderTarget()
+{
+	for (u32 i = 0; i < Textures.size(); ++i)
+	{
+		if (Textures[i])
+			Textures[i]->drop();
+	}
+
+	if (DepthStencil)
+		DepthStencil->drop();
+}
+
+
+void CRecordingNullDriver::CRenderTarget::setTextures(ITexture* const* textures, u32 numTextures, ITexture* depthStencil,
+	const E_CUBE_SURFACE* cubeSurfaces, u32 numCubeSurfaces)
+{
+	for (u32 i = 0; i < numTextures; ++i)
+	{
+		if (textures[i])
+			textures[i]->grab();
+	}
+	if (depthStencil)
+		depthStencil->grab();
+
+	for (u32 i = 0; i < Textures.size(); ++i)
+	{
+		if (Textures[i])
+			Textures[i]->drop();
+	}
+	if (DepthStencil)
+		DepthStencil->drop();
+
+	Textures.set_data(textures, numTextures);
+	DepthStencil = depthStencil;
+	CubeSurfaces.set_data(cubeSurfaces, numCubeSurfaces);
+}
+
+
+core::dimension2d<u32> CRecordingNullDriver::CRenderTarget::getSize() const
+{
+	for (u32 i = 0; i < Textures.size(); ++i)
+	{
+		if (Textures[i])
+			return Textures[i]->getSize();
+	}
+
+	return DepthStencil ? DepthStencil->getSize() : core::dimension2d<u32>(0, 0);
+}
+
+
+CRecordingNullDriver::SRenderTargetTexture::SRenderTargetTexture(const io::path& name,
+		const core::dimension2d<u32>& size, ECOLOR_FORMAT format)
+	: ITexture(name, ETT_2D)
+{
+	Size = OriginalSize = size;
+	ColorFormat = OriginalColorFormat = format;
+	IsRenderTarget = true;
+}
+
+} // end namespace video
+} // end namespace irr
@@ -0,0 +1,155 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_RECORDING_NULL_DRIVER_H_INCLUDED__
+#define __C_RECORDING_NULL_DRIVER_H_INCLUDED__
+
+#include "CNullDriver.h"
+#include "IRenderTarget.h"
+
+namespace irr
+{
+namespace video
+{
+	//! The null driver, which can record the submitted commands
+	/** While recording it keeps the state of a GPU driver, see
+	IVideoDriver::setCommandRecording(). Otherwise it behaves like the
+	plain null driver. */
+	class CRecordingNullDriver : public CNullDriver
+	{
+	public:
+
+		CRecordingNullDriver(io::IFileSystem* io, const core::dimension2d<u32>& screenSize);
+
+		~CRecordingNullDriver();
+
+		bool setCommandRecording(bool enable, io::IWriteFile* log = 0) override;
+
+		virtual bool beginScene(u16 clearFlag, SColor clearColor = SColor(255,0,0,0), f32 clearDepth = 1.f, u8 clearStencil = 0,
+				const SExposedVideoData& videoData=SExposedVideoData(), core::rect<s32>* sourceRect = 0) override;
+
+		bool endScene() override;
+
+		void setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat) override;
+
+		const core::matrix4& getTransform(E_TRANSFORMATION_STATE state) const override;
+
+		//! Compares the material like COpenGL3DriverBase::setMaterial
+		void setMaterial(const SMaterial& material) override;
+
+		virtual bool setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SColor clearColor = SColor(255,0,0,0),
+			f32 clearDepth = 1.f, u8 clearStencil = 0) override;
+
+		void clearBuffers(u16 flag, SColor color = SColor(255,0,0,0), f32 depth = 1.f, u8 stencil = 0) override;
+
+		IRenderTarget* addRenderTarget() override;
+
+		virtual ITexture* addRenderTargetTexture(const core::dimension2d<u32>& size,
+			const io::path& name = "rt", const ECOLOR_FORMAT format = ECF_UNKNOWN) override;
+
+		virtual void drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
+				const void* indexList, u32 primitiveCount,
+				E_VERTEX_TYPE vType=EVT_STANDARD, scene::E_PRIMITIVE_TYPE pType=scene::EPT_TRIANGLES,
+				E_INDEX_TYPE iType=EIT_16BIT) override;
+
+		virtual void draw2DVertexPrimitiveList(const void* vertices, u32 vertexCount,
+				const void* indexList, u32 primitiveCount,
+				E_VERTEX_TYPE vType=EVT_STANDARD, scene::E_PRIMITIVE_TYPE pType=scene::EPT_TRIANGLES,
+				E_INDEX_TYPE iType=EIT_16BIT) override;
+
+		virtual void draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+			const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect = 0,
+			SColor color=SColor(255,255,255,255), bool useAlphaChannelOfTexture=false) override;
+
+		virtual void draw2DRectangle(const core::rect<s32>& pos,
+			SColor colorLeftUp, SColor colorRightUp, SColor colorLeftDown, SColor colorRightDown,
+			const core::rect<s32>* clip = 0) override;
+
+		virtual void draw2DLine(const core::position2d<s32>& start,
+			const core::position2d<s32>& end, SColor color=SColor(255,255,255,255)) override;
+
+		virtual void draw3DLine(const core::vector3df& start,
+			const core::vector3df& end, SColor color = SColor(255,255,255,255)) override;
+
+	protected:
+
+		//! Hardware buffer link of the recording driver, nothing is uploaded
+		struct SHWBufferLink_recording : public SHWBufferLink
+		{
+			SHWBufferLink_recording(const scene::IMeshBuffer* meshBuffer, CNullDriver* driver, u32 id)
+				: SHWBufferLink(meshBuffer, driver), ID(id) {}
+
+			//! Number of the link in creation order, pointers differ between runs
+			u32 ID;
+		};
+
+		SHWBufferLink* createHardwareBuffer(const scene::IMeshBuffer* mb) override;
+
+		bool updateHardwareBuffer(SHWBufferLink* HWBuffer) override;
+
+		void drawHardwareBuffer(SHWBufferLink* HWBuffer) override;
+
+		void deleteHardwareBuffer(SHWBufferLink* HWBuffer) override;
+
+	private:
+
+		//! Render target whose textures are only bookkept
+		class CRenderTarget : public IRenderTarget
+		{
+		public:
+			CRenderTarget(u32 id) : ID(id) {}
+
+			~CRenderTarget();
+
+			void setTextures(ITexture* const* textures, u32 numTextures, ITexture* depthStencil,
+				const E_CUBE_SURFACE* cubeSurfaces, u32 numCubeSurfaces) override;
+
+			core::dimension2d<u32> getSize() const;
+
+			u32 ID;
+		};
+
+		//! Render target texture without any storage
+		struct SRenderTargetTexture : public ITexture
+		{
+			SRenderTargetTexture(const io::path& name, const core::dimension2d<u32>& size, ECOLOR_FORMAT format);
+
+			void* lock(E_TEXTURE_LOCK_MODE mode = ETLM_READ_WRITE, u32 mipmapLevel=0, u32 layer = 0, E_TEXTURE_LOCK_FLAGS lockFlags = ETLF_FLIP_Y_UP_RTT) override { return 0; }
+			void unlock() override {}
+			void regenerateMipMapLevels(void* data = 0, u32 layer = 0) override {}
+		};
+
+		//! Writes a line to the log
+		void record(const c8* line);
+
+		//! Applies the material for drawing, like setRenderStates3DMode of the GPU drivers
+		void setRenderStates3DMode();
+
+		//! Leaves the 3d states, the next 3d draw sets the material again
+		void setRenderStates2DMode(const ITexture* texture);
+
+		//! Counts and records the texture of a unit which differs from the bound one
+		void bindTexture(u32 unit, const ITexture* texture);
+
+		void recordDraw(const c8* kind, u32 buffer, u32 vertexCount, u32 primitiveCount,
+			E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType);
+
+		bool Recording;
+		io::IWriteFile* Log;
+
+		core::matrix4 Matrices[ETS_COUNT];
+
+		SMaterial Material;
+		u32 MaterialRevision;
+		u32 LastMaterialRevision;
+		bool ResetRenderStates;
+		const ITexture* BoundTextures[MATERIAL_MAX_TEXTURES];
+
+		u32 NextBufferID;
+		u32 NextRenderTargetID;
+	};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
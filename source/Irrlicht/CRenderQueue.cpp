@@ -0,0 +1,238 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CRenderQueue.h"
+#include "SMaterial.h"
+#include <algorithm>
+#include <cmath>
+
+namespace irr
+{
+namespace scene
+{
+
+void CRenderQueue::add(u64 key, ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial& material)
+{
+	SEntry entry;
+	entry.Key = key;
+	entry.Node = node;
+	entry.MeshBuffer = meshBuffer;
+	entry.Material = &material;
+	Entries.push_back(entry);
+}
+
+void CRenderQueue::add(u64 key, ISceneNode* node)
+{
+	SEntry entry;
+	entry.Key = key;
+	entry.Node = node;
+	entry.MeshBuffer = 0;
+	entry.Material = 0;
+	Entries.push_back(entry);
+}
+
+bool CRenderQueue::isUnchanged() const
+{
+	if (!PreviousSorted || Entries.size() != PreviousEntries.size())
+		return false;
+
+	for (size_t i = 0; i < Entries.size(); ++i)
+	{
+		const SEntry& a = Entries[i];
+		const SEntry& b = PreviousEntries[i];
+		if (a.Key != b.Key || a.Node != b.Node || a.MeshBuffer != b.MeshBuffer || a.Material != b.Material)
+			return false;
+	}
+	return true;
+}
+
+void CRenderQueue::sort()
+{
+	if (isUnchanged())
+	{
+		Sorted = true;
+		return;
+	}
+
+	const u32 count = (u32)Entries.size();
+	Items.resize(count);
+	ItemsTemp.resize(count);
+	for (u32 i = 0; i < count; ++i)
+	{
+		Items[i].Key = Entries[i].Key;
+		Items[i].Index = i;
+	}
+
+	// histograms of all eight bytes in one go
+	u32 histogram[8][256] = {};
+	for (u32 i = 0; i < count; ++i)
+	{
+		const u64 key = Items[i].Key;
+		for (u32 b = 0; b < 8; ++b)
+			++histogram[b][(key >> (b * 8)) & 0xff];
+	}
+
+	// least significant byte first, each pass is stable
+	for (u32 b = 0; b < 8; ++b)
+	{
+		u32* h = histogram[b];
+
+		// all keys share this byte, the pass wouldn't move anything
+		if (count == 0 || h[(Items[0].Key >> (b * 8)) & 0xff] == count)
+			continue;
+
+		u32 offset = 0;
+		for (u32 d = 0; d < 256; ++d)
+		{
+			const u32 n = h[d];
+			h[d] = offset;
+			offset += n;
+		}
+
+		for (u32 i = 0; i < count; ++i)
+			ItemsTemp[h[(Items[i].Key >> (b * 8)) & 0xff]++] = Items[i];
+
+		Items.swap(ItemsTemp);
+	}
+
+	Order.resize(count);
+	for (u32 i = 0; i < count; ++i)
+		Order[i] = Items[i].Index;
+
+	Sorted = true;
+}
+
+void CRenderQueue::clear()
+{
+	// keep the entries of a sorted frame to compare the next one against
+	if (Sorted)
+		PreviousEntries.swap(Entries);
+	else
+		PreviousEntries.clear();
+
+	PreviousSorted = Sorted;
+	Sorted = false;
+	Entries.clear();
+}
+
+void CTransparentRenderQueue::add(f32 distance, ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial& material)
+{
+	SEntry entry;
+	entry.Distance = distance;
+	entry.Node = node;
+	entry.MeshBuffer = meshBuffer;
+	entry.Material = &material;
+	Entries.push_back(entry);
+}
+
+void CTransparentRenderQueue::add(f32 distance, ISceneNode* node)
+{
+	SEntry entry;
+	entry.Distance = distance;
+	entry.Node = node;
+	entry.MeshBuffer = 0;
+	entry.Material = 0;
+	Entries.push_back(entry);
+}
+
+bool CTransparentRenderQueue::isSameDraws() const
+{
+	if (!PreviousSorted || Entries.size() != PreviousEntries.size())
+		return false;
+
+	for (size_t i = 0; i < Entries.size(); ++i)
+	{
+		const SEntry& a = Entries[i];
+		const SEntry& b = PreviousEntries[i];
+		if (a.Node != b.Node || a.MeshBuffer != b.MeshBuffer || a.Material != b.Material)
+			return false;
+	}
+	return true;
+}
+
+void CTransparentRenderQueue::sort()
+{
+	const u32 count = (u32)Entries.size();
+	Sorted = true;
+
+	// farthest first, equal distances keep their order
+	const auto isFarther = [this](u32 a, u32 b) {
+		return Entries[a].Distance > Entries[b].Distance;
+	};
+
+	if (isSameDraws())
+	{
+		// Order still holds the last frame, only a few entries should move
+		const u32 maxMoves = count * 8;
+		u32 moves = 0;
+		for (u32 i = 1; i < count && moves <= maxMoves; ++i)
+		{
+			const u32 index = Order[i];
+			u32 j = i;
+			for (; j > 0 && isFarther(index, Order[j - 1]); --j)
+				Order[j] = Order[j - 1];
+			Order[j] = index;
+			moves += i - j;
+		}
+
+		if (moves <= maxMoves)
+			return;
+
+		// the camera jumped, sort what is already half sorted
+		std::stable_sort(Order.begin(), Order.end(), isFarther);
+		return;
+	}
+
+	Order.resize(count);
+	for (u32 i = 0; i < count; ++i)
+		Order[i] = i;
+	std::stable_sort(Order.begin(), Order.end(), isFarther);
+}
+
+void CTransparentRenderQueue::clear()
+{
+	if (Sorted)
+		PreviousEntries.swap(Entries);
+	else
+		PreviousEntries.clear();
+
+	PreviousSorted = Sorted;
+	Sorted = false;
+	Entries.clear();
+}
+
+u64 CRenderQueue::makeKey(u32 pass, const video::SMaterial& material, f32 depth)
+{
+	// FNV-1a over the texture pointers
+	u64 textures = 14695981039346656037ULL;
+	for (u32 i = 0; i < video::MATERIAL_MAX_TEXTURES; ++i)
+	{
+		textures ^= (u64)(size_t)material.TextureLayer[i].Texture;
+		textures *= 1099511628211ULL;
+	}
+	textures ^= textures >> 28;
+
+	u32 states = material.ZBuffer;
+	states = states * 31 + material.ZWriteEnable;
+	states = states * 31 + material.BackfaceCulling;
+	states = states * 31 + material.FrontfaceCulling;
+	states = states * 31 + material.Wireframe;
+	states = states * 31 + material.Lighting;
+	states = states * 31 + material.BlendOperation;
+	states = states * 31 + material.ColorMask;
+	states ^= states >> 8;
+	states ^= states >> 16;
+
+	u32 bucket = 0;
+	if (depth > 0.f)
+		bucket = depth < 1.f ? (u32)(sqrtf(depth) * 255.f) : 255;
+
+	return ((u64)(pass & 0xf) << 60) |
+		((u64)(material.MaterialType & 0xffff) << 44) |
+		((textures & 0xfffffff) << 16) |
+		((u64)(states & 0xff) << 8) |
+		bucket;
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,146 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_RENDER_QUEUE_H_INCLUDED__
+#define __C_RENDER_QUEUE_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "IMeshBuffer.h"
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+
+//! Draw list of the solid render pass, sorted by a 64 bit key.
+/** The key holds from the highest to the lowest bits the pass, the material
+type, a hash of the textures, a hash of the render states and a depth bucket,
+so draws sharing a shader and textures end up next to each other and are
+drawn roughly front to back within such a group. Sorting is done with a radix
+sort. When the same entries with the same keys are added as in the previous
+frame, the order of the previous frame is reused without sorting again. */
+class CRenderQueue
+{
+public:
+	struct SEntry
+	{
+		u64 Key;
+		//! 0 for mesh buffers in world space
+		ISceneNode* Node;
+		//! 0 if the node draws itself with ISceneNode::render()
+		IMeshBuffer* MeshBuffer;
+		const video::SMaterial* Material;
+	};
+
+	//! Adds a mesh buffer drawn with the transformation of node
+	void add(u64 key, ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial& material);
+
+	//! Adds a node which draws itself
+	void add(u64 key, ISceneNode* node);
+
+	//! Sorts the entries added since the last clear()
+	void sort();
+
+	//! Number of entries
+	u32 size() const
+	{
+		return (u32)Entries.size();
+	}
+
+	//! Gets an entry, in sorted order after sort() was called
+	const SEntry& operator[](u32 index) const
+	{
+		return Entries[Order[index]];
+	}
+
+	//! Removes all entries, remembering them for the next sort()
+	void clear();
+
+	//! Creates the key of a material
+	/** \param pass Entries of a lower pass are drawn first, up to 15.
+	\param depth Distance from the camera divided by the far plane distance. */
+	static u64 makeKey(u32 pass, const video::SMaterial& material, f32 depth);
+
+private:
+	struct SSortItem
+	{
+		u64 Key;
+		u32 Index;
+	};
+
+	//! Checks if Entries equals the entries of the last sorted frame
+	bool isUnchanged() const;
+
+	std::vector<SEntry> Entries;
+	std::vector<SEntry> PreviousEntries;
+	std::vector<u32> Order;
+	std::vector<SSortItem> Items;
+	std::vector<SSortItem> ItemsTemp;
+	//! Order matches Entries
+	bool Sorted = false;
+	//! Order matches PreviousEntries
+	bool PreviousSorted = false;
+};
+
+//! Draw list of the transparent render passes, sorted back to front.
+/** Entries are sorted by the squared distance of the center of their
+bounding box from the camera, farthest first. The order of the previous
+frame is the starting point of an insertion sort, which only has to move the
+entries that passed each other since. This works as long as the same entries
+are added in the same order each frame, as happens while the scene graph
+doesn't change. Otherwise, or if too much moved, a full sort is done. */
+class CTransparentRenderQueue
+{
+public:
+	struct SEntry
+	{
+		f32 Distance;
+		//! 0 for mesh buffers in world space
+		ISceneNode* Node;
+		//! 0 if the node draws itself with ISceneNode::render()
+		IMeshBuffer* MeshBuffer;
+		const video::SMaterial* Material;
+	};
+
+	//! Adds a mesh buffer drawn with the transformation of node
+	void add(f32 distance, ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial& material);
+
+	//! Adds a node which draws itself
+	void add(f32 distance, ISceneNode* node);
+
+	//! Sorts the entries added since the last clear()
+	void sort();
+
+	//! Number of entries
+	u32 size() const
+	{
+		return (u32)Entries.size();
+	}
+
+	//! Gets an entry, in sorted order after sort() was called
+	const SEntry& operator[](u32 index) const
+	{
+		return Entries[Order[index]];
+	}
+
+	//! Removes all entries, remembering their order for the next sort()
+	void clear();
+
+private:
+	//! Checks if Entries holds the same draws as the last sorted frame
+	bool isSameDraws() const;
+
+	std::vector<SEntry> Entries;
+	std::vector<SEntry> PreviousEntries;
+	std::vector<u32> Order;
+	//! Order matches Entries
+	bool Sorted = false;
+	//! Order matches PreviousEntries
+	bool PreviousSorted = false;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
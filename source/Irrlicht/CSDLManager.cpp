@@ -37,6 +37,19 @@ bool CSDLManager::activateContext(const SExposedVideoData& videoData, bool resto
 	return true;
 }
 
+bool CSDLManager::setContextCurrent(bool current)
+{
+	return SDLDevice->MakeContextCurrent(current);
+}
+
+bool CSDLManager::setSwapInterval(s32 interval)
+{
+	// adaptive vsync falls back to normal vsync where it's missing
+	if (SDL_GL_SetSwapInterval(interval) == 0)
+		return true;
+	return interval < 0 && SDL_GL_SetSwapInterval(-interval) == 0;
+}
+
 void* CSDLManager::getProcAddress(const std::string &procName)
 {
 	return SDL_GL_GetProcAddress(procName.c_str());
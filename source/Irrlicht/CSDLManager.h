@@ -37,6 +37,12 @@ namespace video
 
 		bool activateContext(const SExposedVideoData& videoData, bool restorePrimaryOnZero=false) override;
 
+		//! Makes the context current on the calling thread, or releases it
+		bool setContextCurrent(bool current) override;
+
+		//! Sets how many vertical blanks swapBuffers() waits for
+		bool setSwapInterval(s32 interval) override;
+
 		void* getProcAddress(const std::string &procName) override;
 
 		bool swapBuffers() override;
@@ -5,9 +5,15 @@
 #include "CSceneCollisionManager.h"
 #include "ICameraSceneNode.h"
 #include "SViewFrustum.h"
+#include "ISpatialIndex.h"
+#include "IMeshSceneNode.h"
+#include "IAnimatedMeshSceneNode.h"
+#include "IInstancedMeshSceneNode.h"
+#include "IAnimatedMesh.h"
 
 #include "os.h"
 #include "irrMath.h"
+#include "irrSIMD.h"
 
 namespace irr
 {
@@ -16,7 +22,7 @@ namespace scene
 
 //! constructor
 CSceneCollisionManager::CSceneCollisionManager(ISceneManager* smanager, video::IVideoDriver* driver)
-: SceneManager(smanager), Driver(driver)
+: SceneManager(smanager), Driver(driver), TriangleBVHSweepSize(64)
 {
 	#ifdef _DEBUG
 	setDebugName("CSceneCollisionManager");
@@ -30,6 +36,8 @@ CSceneCollisionManager::CSceneCollisionManager(ISceneManager* smanager, video::I
 //! destructor
 CSceneCollisionManager::~CSceneCollisionManager()
 {
+	clearTriangleBVHCache();
+
 	if (Driver)
 		Driver->drop();
 }
@@ -72,5 +80,404 @@ core::line3d<f32> CSceneCollisionManager::getRayFromScreenCoordinates(
 	return ln;
 }
 
+
+namespace
+{
+	//! Projects a position with the view projection m and the view matrix v, returns if it's visible
+	bool projectToScreen(const core::vector3df& p, const f32* m, const f32* v,
+		f32 halfWidth, f32 halfHeight, SScreenPosition& out)
+	{
+		const f32 x = m[12] + m[0] * p.X + m[4] * p.Y + m[8] * p.Z;
+		const f32 y = m[13] + m[1] * p.X + m[5] * p.Y + m[9] * p.Z;
+		const f32 w = m[15] + m[3] * p.X + m[7] * p.Y + m[11] * p.Z;
+		out.Depth = v[14] + v[2] * p.X + v[6] * p.Y + v[10] * p.Z;
+
+		if (w > 0.f)
+			out.Pos.set((x / w + 1.f) * halfWidth, (1.f - y / w) * halfHeight);
+		else
+			out.Pos.set(-10000.f, -10000.f);
+
+		out.Visible = w > 0.f && out.Depth > 0.f && fabsf(x) <= w && fabsf(y) <= w;
+		return out.Visible;
+	}
+}
+
+
+//! Projects many 3d positions to the screen at once
+u32 CSceneCollisionManager::getScreenCoordinatesFrom3DPositions(const core::vector3df* positions, u32 count,
+	SScreenPosition* outPositions, const ICameraSceneNode* camera)
+{
+	if (!SceneManager || !Driver)
+		return 0;
+
+	if (!camera)
+		camera = SceneManager->getActiveCamera();
+
+	if (!camera)
+		return 0;
+
+	const core::matrix4 viewProjection = camera->getProjectionMatrix() * camera->getViewMatrix();
+	const f32* m = viewProjection.pointer();
+	const f32* v = camera->getViewMatrix().pointer();
+
+	const core::rect<s32>& viewPort = Driver->getViewPort();
+	const f32 halfWidth = viewPort.getWidth() * 0.5f;
+	const f32 halfHeight = viewPort.getHeight() * 0.5f;
+
+	u32 visible = 0;
+	u32 i = 0;
+
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+	typedef core::SSIMD4f S;
+	const S::V zero = S::splat(0.f);
+	const S::V one = S::splat(1.f);
+	const S::V halfW = S::splat(halfWidth);
+	const S::V halfH = S::splat(halfHeight);
+	const S::V mx0 = S::splat(m[0]), mx1 = S::splat(m[4]), mx2 = S::splat(m[8]), mx3 = S::splat(m[12]);
+	const S::V my0 = S::splat(m[1]), my1 = S::splat(m[5]), my2 = S::splat(m[9]), my3 = S::splat(m[13]);
+	const S::V mw0 = S::splat(m[3]), mw1 = S::splat(m[7]), mw2 = S::splat(m[11]), mw3 = S::splat(m[15]);
+	const S::V vd0 = S::splat(v[2]), vd1 = S::splat(v[6]), vd2 = S::splat(v[10]), vd3 = S::splat(v[14]);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const core::vector3df* p = positions + i;
+		const S::V px = S::set(p[0].X, p[1].X, p[2].X, p[3].X);
+		const S::V py = S::set(p[0].Y, p[1].Y, p[2].Y, p[3].Y);
+		const S::V pz = S::set(p[0].Z, p[1].Z, p[2].Z, p[3].Z);
+
+		// summed in the order of projectToScreen()
+		const S::V x = S::madd(mx2, pz, S::madd(mx1, py, S::madd(mx0, px, mx3)));
+		const S::V y = S::madd(my2, pz, S::madd(my1, py, S::madd(my0, px, my3)));
+		const S::V w = S::madd(mw2, pz, S::madd(mw1, py, S::madd(mw0, px, mw3)));
+		const S::V depth = S::madd(vd2, pz, S::madd(vd1, py, S::madd(vd0, px, vd3)));
+
+		const u32 front = S::bits(S::less(zero, w));
+		const u32 inside = front & S::bits(S::less(zero, depth)) &
+			S::bits(S::lessEqual(S::abs(x), w)) & S::bits(S::lessEqual(S::abs(y), w));
+
+		f32 screenX[4], screenY[4], depths[4];
+		S::store(screenX, S::mul(S::add(S::div(x, w), one), halfW));
+		S::store(screenY, S::mul(S::sub(one, S::div(y, w)), halfH));
+		S::store(depths, depth);
+
+		for (u32 j = 0; j < 4; ++j)
+		{
+			SScreenPosition& out = outPositions[i + j];
+			if (front & (1 << j))
+				out.Pos.set(screenX[j], screenY[j]);
+			else
+				out.Pos.set(-10000.f, -10000.f);
+			out.Depth = depths[j];
+			out.Visible = (inside & (1 << j)) != 0;
+			visible += out.Visible;
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+		visible += projectToScreen(positions[i], m, v, halfWidth, halfHeight, outPositions[i]);
+
+	return visible;
+}
+
+
+//! Returns the nearest scene node whose bounding box is hit by a ray.
+ISceneNode* CSceneCollisionManager::getSceneNodeFromRayBB(const core::line3d<f32>& ray,
+	s32 idBitMask, bool bNoDebugObjects, ISceneNode* root)
+{
+	gatherBoxHits(ray, idBitMask, bNoDebugObjects, root);
+
+	return BoxHits.empty() ? 0 : BoxHits[0].Node;
+}
+
+
+//! Finds the nearest triangle of a mesh hit by a ray.
+bool CSceneCollisionManager::getCollisionPoint(const core::line3d<f32>& ray, IMesh* mesh, SCollisionHit& outHit)
+{
+	if (!mesh)
+		return false;
+
+	f32 t = 1.f;
+	if (!getMeshHit(mesh, core::IdentityMatrix, ray, t, outHit))
+		return false;
+
+	outHit.Node = 0;
+	outHit.Instance = -1;
+	return true;
+}
+
+
+//! Finds the nearest triangle of the scene hit by a ray.
+ISceneNode* CSceneCollisionManager::getSceneNodeAndCollisionPointFromRay(const core::line3d<f32>& ray,
+	SCollisionHit& outHit, s32 idBitMask, bool bNoDebugObjects, ISceneNode* root)
+{
+	gatherBoxHits(ray, idBitMask, bNoDebugObjects, root);
+
+	ISceneNode* best = 0;
+	f32 t = 1.f;
+	for (u32 i = 0; i < BoxHits.size(); ++i)
+	{
+		// the remaining boxes start behind the nearest hit
+		if (BoxHits[i].T > t)
+			break;
+
+		if (getNodeHit(BoxHits[i].Node, ray, t, outHit))
+			best = BoxHits[i].Node;
+	}
+
+	return best;
+}
+
+
+//! Finds the nearest triangle of each node hit by a ray.
+u32 CSceneCollisionManager::getSceneNodesAndCollisionPointsFromRay(const core::line3d<f32>& ray,
+	core::array<SCollisionHit>& outHits, s32 idBitMask, bool bNoDebugObjects, ISceneNode* root)
+{
+	outHits.set_used(0);
+
+	gatherBoxHits(ray, idBitMask, bNoDebugObjects, root);
+
+	SCollisionHit hit;
+	for (u32 i = 0; i < BoxHits.size(); ++i)
+	{
+		f32 t = 1.f;
+		if (getNodeHit(BoxHits[i].Node, ray, t, hit))
+			outHits.push_back(hit);
+	}
+
+	outHits.sort();
+	return outHits.size();
+}
+
+
+//! Deletes the cached triangle hierarchies of all meshes.
+void CSceneCollisionManager::clearTriangleBVHCache()
+{
+	for (auto &entry : TriangleBVHs)
+	{
+		delete entry.second.BVH;
+		entry.second.Mesh->drop();
+	}
+	TriangleBVHs.clear();
+	TriangleBVHSweepSize = 64;
+}
+
+
+void CSceneCollisionManager::gatherBoxHits(const core::line3d<f32>& ray, s32 idBitMask, bool bNoDebugObjects, ISceneNode* root)
+{
+	Candidates.set_used(0);
+	BoxHits.set_used(0);
+
+	ISpatialIndex* index = SceneManager->getSpatialIndex();
+	if (!root && index)
+		index->getNodesOnLine(ray, Candidates);
+	else
+		gatherRayCandidates(root ? root : SceneManager->getRootSceneNode());
+
+	for (u32 i = 0; i < Candidates.size(); ++i)
+	{
+		ISceneNode* node = Candidates[i];
+
+		if ((idBitMask && !(node->getID() & idBitMask)) || (bNoDebugObjects && node->isDebugObject()))
+			continue;
+
+		SBoxHit hit;
+		if (getRayHit(node, ray, hit.T) && (!index || root || node->isTrulyVisible()))
+		{
+			hit.Node = node;
+			BoxHits.push_back(hit);
+		}
+	}
+
+	BoxHits.sort();
+}
+
+
+bool CSceneCollisionManager::getNodeHit(ISceneNode* node, const core::line3d<f32>& ray, f32& t, SCollisionHit& outHit)
+{
+	IMesh* mesh = 0;
+	switch (node->getType())
+	{
+	case ESNT_MESH:
+	case ESNT_INSTANCED_MESH:
+		mesh = static_cast<IMeshSceneNode*>(node)->getMesh();
+		break;
+	case ESNT_ANIMATED_MESH:
+		{
+			IAnimatedMeshSceneNode* animatedNode = static_cast<IAnimatedMeshSceneNode*>(node);
+			IAnimatedMesh* animatedMesh = animatedNode->getMesh();
+			if (!animatedMesh)
+				break;
+			// skinned meshes hold the vertices of the frame they were animated to last
+			if (animatedMesh->getMeshType() == EAMT_SKINNED)
+				mesh = animatedMesh;
+			else
+				mesh = animatedMesh->getMesh((s32)animatedNode->getFrameNr());
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (!mesh)
+		return false;
+
+	bool hit = false;
+	if (node->getType() == ESNT_INSTANCED_MESH)
+	{
+		const IInstancedMeshSceneNode* instancedNode = static_cast<const IInstancedMeshSceneNode*>(node);
+		for (u32 i = 0; i < instancedNode->getInstanceCount(); ++i)
+		{
+			const core::matrix4 transform = node->getAbsoluteTransformation() * instancedNode->getInstance(i).Transform;
+			if (getMeshHit(mesh, transform, ray, t, outHit))
+			{
+				outHit.Instance = i;
+				hit = true;
+			}
+		}
+	}
+	else if (getMeshHit(mesh, node->getAbsoluteTransformation(), ray, t, outHit))
+	{
+		outHit.Instance = -1;
+		hit = true;
+	}
+
+	if (hit)
+		outHit.Node = node;
+	return hit;
+}
+
+
+bool CSceneCollisionManager::getMeshHit(IMesh* mesh, const core::matrix4& transform, const core::line3d<f32>& ray, f32& t, SCollisionHit& outHit)
+{
+	const CTriangleBVH* bvh = getTriangleBVH(mesh);
+	if (!bvh)
+		return false;
+
+	core::matrix4 inverse;
+	if (!transform.getInverse(inverse))
+		return false;
+
+	// the ray parameter is the same in the space of the mesh
+	core::line3d<f32> localRay(ray);
+	inverse.transformVect(localRay.start);
+	inverse.transformVect(localRay.end);
+
+	u32 meshBuffer, triangleIndex;
+	core::triangle3df triangle;
+	if (!bvh->getNearestHit(localRay, t, meshBuffer, triangleIndex, triangle))
+		return false;
+
+	transform.transformVect(triangle.pointA);
+	transform.transformVect(triangle.pointB);
+	transform.transformVect(triangle.pointC);
+
+	outHit.Point = ray.start + ray.getVector() * t;
+	outHit.Triangle = triangle;
+	outHit.Distance = ray.getLength() * t;
+	outHit.MeshBuffer = meshBuffer;
+	outHit.TriangleIndex = triangleIndex;
+	return true;
+}
+
+
+const CTriangleBVH* CSceneCollisionManager::getTriangleBVH(IMesh* mesh)
+{
+	auto it = TriangleBVHs.find(mesh);
+	if (it != TriangleBVHs.end())
+	{
+		if (it->second.BVH->isOutdated(mesh))
+		{
+			delete it->second.BVH;
+			it->second.BVH = new CTriangleBVH(mesh);
+		}
+		return it->second.BVH;
+	}
+
+	// free the hierarchies of meshes which were dropped by everyone else
+	if (TriangleBVHs.size() >= TriangleBVHSweepSize)
+	{
+		for (it = TriangleBVHs.begin(); it != TriangleBVHs.end();)
+		{
+			if (it->second.Mesh->getReferenceCount() == 1)
+			{
+				delete it->second.BVH;
+				it->second.Mesh->drop();
+				it = TriangleBVHs.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		TriangleBVHSweepSize = core::max_(64u, (u32)TriangleBVHs.size() * 2);
+	}
+
+	STriangleBVHEntry entry;
+	entry.Mesh = mesh;
+	entry.BVH = new CTriangleBVH(mesh);
+	mesh->grab();
+	TriangleBVHs[mesh] = entry;
+	return entry.BVH;
+}
+
+
+void CSceneCollisionManager::gatherRayCandidates(ISceneNode* root)
+{
+	for (ISceneNode* child : root->getChildren())
+	{
+		if (!child->isVisible())
+			continue;
+
+		Candidates.push_back(child);
+		gatherRayCandidates(child);
+	}
+}
+
+
+bool CSceneCollisionManager::getRayHit(const ISceneNode* node, const core::line3d<f32>& ray, f32& t) const
+{
+	core::matrix4 inverse;
+	if (!node->getAbsoluteTransformation().getInverse(inverse))
+		return false;
+
+	// the ray parameter is the same in the space of the node
+	core::vector3df start = ray.start;
+	core::vector3df end = ray.end;
+	inverse.transformVect(start);
+	inverse.transformVect(end);
+	const core::vector3df dir = end - start;
+
+	const core::aabbox3d<f32>& box = node->getBoundingBox();
+	const f32 s[3] = { start.X, start.Y, start.Z };
+	const f32 d[3] = { dir.X, dir.Y, dir.Z };
+	const f32 bMin[3] = { box.MinEdge.X, box.MinEdge.Y, box.MinEdge.Z };
+	const f32 bMax[3] = { box.MaxEdge.X, box.MaxEdge.Y, box.MaxEdge.Z };
+
+	f32 tMin = 0.f;
+	f32 tMax = 1.f;
+	for (u32 i = 0; i < 3; ++i)
+	{
+		if (core::iszero(d[i]))
+		{
+			if (s[i] < bMin[i] || s[i] > bMax[i])
+				return false;
+			continue;
+		}
+
+		f32 t1 = (bMin[i] - s[i]) / d[i];
+		f32 t2 = (bMax[i] - s[i]) / d[i];
+		if (t1 > t2)
+			core::swap(t1, t2);
+		tMin = core::max_(tMin, t1);
+		tMax = core::min_(tMax, t2);
+		if (tMin > tMax)
+			return false;
+	}
+
+	t = tMin;
+	return true;
+}
+
 } // end namespace scene
 } // end namespace irr
@@ -8,6 +8,8 @@
 #include "ISceneCollisionManager.h"
 #include "ISceneManager.h"
 #include "IVideoDriver.h"
+#include "CTriangleBVH.h"
+#include <unordered_map>
 
 namespace irr
 {
@@ -28,10 +30,76 @@ namespace scene
 		virtual core::line3d<f32> getRayFromScreenCoordinates(
 			const core::position2d<s32> & pos, const ICameraSceneNode* camera = 0) override;
 
+		//! Projects many 3d positions to the screen at once
+		u32 getScreenCoordinatesFrom3DPositions(const core::vector3df* positions, u32 count,
+			SScreenPosition* outPositions, const ICameraSceneNode* camera = 0) override;
+
+		//! Returns the nearest scene node whose bounding box is hit by a ray.
+		ISceneNode* getSceneNodeFromRayBB(const core::line3d<f32>& ray,
+			s32 idBitMask=0, bool bNoDebugObjects=false, ISceneNode* root=0) override;
+
+		//! Finds the nearest triangle of a mesh hit by a ray.
+		bool getCollisionPoint(const core::line3d<f32>& ray, IMesh* mesh, SCollisionHit& outHit) override;
+
+		//! Finds the nearest triangle of the scene hit by a ray.
+		ISceneNode* getSceneNodeAndCollisionPointFromRay(const core::line3d<f32>& ray,
+			SCollisionHit& outHit, s32 idBitMask=0, bool bNoDebugObjects=false, ISceneNode* root=0) override;
+
+		//! Finds the nearest triangle of each node hit by a ray.
+		u32 getSceneNodesAndCollisionPointsFromRay(const core::line3d<f32>& ray,
+			core::array<SCollisionHit>& outHits, s32 idBitMask=0, bool bNoDebugObjects=false, ISceneNode* root=0) override;
+
+		//! Deletes the cached triangle hierarchies of all meshes.
+		void clearTriangleBVHCache() override;
+
 	private:
 
+		//! A node whose bounding box is hit by a ray
+		struct SBoxHit
+		{
+			ISceneNode* Node;
+			f32 T;
+
+			bool operator<(const SBoxHit& other) const
+			{
+				return T < other.T;
+			}
+		};
+
+		//! Fills BoxHits with the candidates hit by a ray, sorted by distance
+		void gatherBoxHits(const core::line3d<f32>& ray, s32 idBitMask, bool bNoDebugObjects, ISceneNode* root);
+
+		//! Tests the triangles of a node, only finds hits nearer than t
+		bool getNodeHit(ISceneNode* node, const core::line3d<f32>& ray, f32& t, SCollisionHit& outHit);
+
+		//! Tests the triangles of a mesh with a transformation
+		bool getMeshHit(IMesh* mesh, const core::matrix4& transform, const core::line3d<f32>& ray, f32& t, SCollisionHit& outHit);
+
+		//! Returns the cached hierarchy of a mesh, building it if needed
+		const CTriangleBVH* getTriangleBVH(IMesh* mesh);
+
+		//! adds the visible nodes below root to Candidates
+		void gatherRayCandidates(ISceneNode* root);
+
+		//! returns the ray parameter where a ray enters the bounding box of a node
+		bool getRayHit(const ISceneNode* node, const core::line3d<f32>& ray, f32& t) const;
+
 		ISceneManager* SceneManager;
 		video::IVideoDriver* Driver;
+
+		core::array<ISceneNode*> Candidates;
+		core::array<SBoxHit> BoxHits;
+
+		struct STriangleBVHEntry
+		{
+			IMesh* Mesh;
+			CTriangleBVH* BVH;
+		};
+
+		//! Hierarchies of the meshes, which are grabbed
+		std::unordered_map<const IMesh*, STriangleBVHEntry> TriangleBVHs;
+		//! Cache size at which entries of meshes only held by the cache are freed
+		u32 TriangleBVHSweepSize;
 	};
 
 
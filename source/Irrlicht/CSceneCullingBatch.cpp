@@ -0,0 +1,211 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneCullingBatch.h"
+#include "ICameraSceneNode.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _IRR_CULLING_SSE2_
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define _IRR_CULLING_NEON_
+#endif
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+#if defined(_IRR_CULLING_SSE2_)
+	typedef __m128 f32x4;
+
+	inline f32x4 load4(const f32* p) { return _mm_loadu_ps(p); }
+	inline f32x4 splat4(f32 v) { return _mm_set1_ps(v); }
+	inline f32x4 add4(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+	inline f32x4 sqrt4(f32x4 a) { return _mm_sqrt_ps(a); }
+	inline f32x4 abs4(f32x4 a) { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+	//! One bit per lane where a > b
+	inline u32 greater4(f32x4 a, f32x4 b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+#elif defined(_IRR_CULLING_NEON_)
+	typedef float32x4_t f32x4;
+
+	inline f32x4 load4(const f32* p) { return vld1q_f32(p); }
+	inline f32x4 splat4(f32 v) { return vdupq_n_f32(v); }
+	inline f32x4 add4(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+	inline f32x4 sqrt4(f32x4 a) { return vsqrtq_f32(a); }
+	inline f32x4 abs4(f32x4 a) { return vabsq_f32(a); }
+	inline u32 greater4(f32x4 a, f32x4 b)
+	{
+		static const uint32x4_t bits = { 1, 2, 4, 8 };
+		return vaddvq_u32(vandq_u32(vcgtq_f32(a, b), bits));
+	}
+#else
+	struct f32x4
+	{
+		f32 v[4];
+	};
+
+	inline f32x4 load4(const f32* p) { f32x4 r; for (u32 i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+	inline f32x4 splat4(f32 v) { f32x4 r; for (u32 i = 0; i < 4; ++i) r.v[i] = v; return r; }
+	inline f32x4 add4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { for (u32 i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+	inline f32x4 sqrt4(f32x4 a) { for (u32 i = 0; i < 4; ++i) a.v[i] = sqrtf(a.v[i]); return a; }
+	inline f32x4 abs4(f32x4 a) { for (u32 i = 0; i < 4; ++i) a.v[i] = fabsf(a.v[i]); return a; }
+	inline u32 greater4(f32x4 a, f32x4 b) { u32 r = 0; for (u32 i = 0; i < 4; ++i) r |= (a.v[i] > b.v[i]) << i; return r; }
+#endif
+}
+
+void CSceneCullingBatch::begin(const ICameraSceneNode* camera)
+{
+	clear();
+
+	Camera = camera;
+	const SViewFrustum* frustum = camera->getViewFrustum();
+	FrustumBox = frustum->getBoundingBox();
+	FrustumCenter = frustum->getBoundingCenter();
+	FrustumRadius = frustum->getBoundingRadius();
+	Planes = frustum->getPackedPlanes();
+}
+
+void CSceneCullingBatch::add(const ISceneNode* node)
+{
+	const u32 culling = node->getAutomaticCulling() & (EAC_BOX | EAC_FRUSTUM_SPHERE | EAC_FRUSTUM_BOX);
+	if (!culling)
+		return;
+
+	const core::aabbox3df& box = node->getBoundingBox();
+	const core::matrix4& m = node->getAbsoluteTransformation();
+
+	core::vector3df center = box.getCenter();
+	m.transformVect(center);
+	const core::vector3df extent = box.getExtent();
+	const f32 halfExtent[3] = { extent.X * 0.5f, extent.Y * 0.5f, extent.Z * 0.5f };
+
+	Indices[node] = Culling.size();
+	Culling.push_back(culling);
+
+	Center[0].push_back(center.X);
+	Center[1].push_back(center.Y);
+	Center[2].push_back(center.Z);
+	for (u32 i = 0; i < 3; ++i)
+	{
+		for (u32 j = 0; j < 3; ++j)
+			Axis[i][j].push_back(m[i * 4 + j] * halfExtent[i]);
+	}
+}
+
+void CSceneCullingBatch::process()
+{
+	const u32 count = Culling.size();
+	const u32 paddedCount = (count + 3) & ~3u;
+	for (u32 i = 0; i < 3; ++i)
+	{
+		Center[i].resize(paddedCount, 0.f);
+		for (u32 j = 0; j < 3; ++j)
+			Axis[i][j].resize(paddedCount, 0.f);
+	}
+	Culled.resize(paddedCount);
+
+	const f32x4 boxMin[3] = { splat4(FrustumBox.MinEdge.X), splat4(FrustumBox.MinEdge.Y), splat4(FrustumBox.MinEdge.Z) };
+	const f32x4 boxMax[3] = { splat4(FrustumBox.MaxEdge.X), splat4(FrustumBox.MaxEdge.Y), splat4(FrustumBox.MaxEdge.Z) };
+	const f32x4 sphereCenter[3] = { splat4(FrustumCenter.X), splat4(FrustumCenter.Y), splat4(FrustumCenter.Z) };
+	const f32x4 sphereRadius = splat4(FrustumRadius);
+	const f32x4 rounding = splat4(core::ROUNDING_ERROR_f32);
+
+	for (u32 i = 0; i < paddedCount; i += 4)
+	{
+		f32x4 c[3], a[3][3], extent[3];
+		for (u32 j = 0; j < 3; ++j)
+		{
+			c[j] = load4(&Center[j][i]);
+			for (u32 k = 0; k < 3; ++k)
+				a[k][j] = load4(&Axis[k][j][i]);
+		}
+
+		// half size of the world space bounding box, what transformBoxEx gives
+		for (u32 j = 0; j < 3; ++j)
+			extent[j] = add4(add4(abs4(a[0][j]), abs4(a[1][j])), abs4(a[2][j]));
+
+		// EAC_BOX: disjoint from the bounding box of the frustum
+		u32 boxCulled = 0;
+		for (u32 j = 0; j < 3; ++j)
+		{
+			boxCulled |= greater4(sub4(c[j], extent[j]), boxMax[j]);
+			boxCulled |= greater4(boxMin[j], add4(c[j], extent[j]));
+		}
+
+		// EAC_FRUSTUM_SPHERE: bounding spheres further apart than their radii
+		f32x4 dist = splat4(0.f);
+		f32x4 radius = splat4(0.f);
+		for (u32 j = 0; j < 3; ++j)
+		{
+			const f32x4 d = sub4(c[j], sphereCenter[j]);
+			dist = add4(dist, mul4(d, d));
+			radius = add4(radius, mul4(extent[j], extent[j]));
+		}
+		radius = add4(sqrt4(radius), sphereRadius);
+		const u32 sphereCulled = greater4(dist, mul4(radius, radius));
+
+		// EAC_FRUSTUM_BOX: all corners in front of one of the planes
+		u32 planeCulled = 0;
+		for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			const f32x4 n[3] = { splat4(Planes.NormalX[p]), splat4(Planes.NormalY[p]), splat4(Planes.NormalZ[p]) };
+
+			f32x4 distance = splat4(Planes.D[p]);
+			f32x4 projectedRadius = splat4(0.f);
+			for (u32 j = 0; j < 3; ++j)
+			{
+				distance = add4(distance, mul4(n[j], c[j]));
+				projectedRadius = add4(projectedRadius, abs4(add4(add4(mul4(n[0], a[j][0]), mul4(n[1], a[j][1])), mul4(n[2], a[j][2]))));
+			}
+			planeCulled |= greater4(sub4(distance, projectedRadius), rounding);
+		}
+
+		for (u32 j = 0; j < 4; ++j)
+		{
+			const u32 culling = (i + j < count) ? Culling[i + j] : 0;
+			Culled[i + j] = ((culling & EAC_BOX) && (boxCulled & (1 << j))) ||
+				((culling & EAC_FRUSTUM_SPHERE) && (sphereCulled & (1 << j))) ||
+				((culling & EAC_FRUSTUM_BOX) && (planeCulled & (1 << j)));
+		}
+	}
+}
+
+bool CSceneCullingBatch::find(const ISceneNode* node, const ICameraSceneNode* camera, bool& culled) const
+{
+	if (camera != Camera || Indices.empty())
+		return false;
+
+	auto it = Indices.find(node);
+	if (it == Indices.end() || it->second >= Culled.size())
+		return false;
+
+	culled = Culled[it->second] != 0;
+	return true;
+}
+
+void CSceneCullingBatch::clear()
+{
+	Camera = nullptr;
+	Indices.clear();
+	Culling.clear();
+	Culled.clear();
+	for (u32 i = 0; i < 3; ++i)
+	{
+		Center[i].clear();
+		for (u32 j = 0; j < 3; ++j)
+			Axis[i][j].clear();
+	}
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,62 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_CULLING_BATCH_H_INCLUDED__
+#define __C_SCENE_CULLING_BATCH_H_INCLUDED__
+
+#include "ISceneNode.h"
+#include "SViewFrustum.h"
+#include <unordered_map>
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+	class ICameraSceneNode;
+
+//! Culls the scene nodes against the view of one camera, four at a time.
+/** Gives the same results as the EAC_BOX, EAC_FRUSTUM_SPHERE and
+EAC_FRUSTUM_BOX tests of CSceneManager::isCulled. The boxes of the nodes are
+kept as world space center and half axes in a structure of arrays, so the
+tests map onto SSE2 or NEON registers without shuffling. */
+class CSceneCullingBatch
+{
+public:
+	//! Starts gathering nodes for a camera, forgetting the previous results
+	void begin(const ICameraSceneNode* camera);
+
+	//! Adds a node, if it uses any of the culling tests done here
+	void add(const ISceneNode* node);
+
+	//! Culls all added nodes
+	void process();
+
+	//! Gets the result of a node added since the last begin()
+	/** \return False if the node wasn't added, or for another camera. */
+	bool find(const ISceneNode* node, const ICameraSceneNode* camera, bool& culled) const;
+
+	//! Forgets all nodes and results
+	void clear();
+
+private:
+	const ICameraSceneNode* Camera = nullptr;
+
+	core::aabbox3df FrustumBox;
+	core::vector3df FrustumCenter;
+	f32 FrustumRadius = 0.f;
+	SPackedFrustum Planes;
+
+	std::unordered_map<const ISceneNode*, u32> Indices;
+	std::vector<u8> Culling;
+	std::vector<u8> Culled;
+
+	//! Box centers and the three half axes, padded to a multiple of four
+	std::vector<f32> Center[3];
+	std::vector<f32> Axis[3][3];
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -9,23 +9,40 @@
 #include "CMeshCache.h"
 #include "IGUIEnvironment.h"
 #include "IMaterialRenderer.h"
+#include "IMeshManipulator.h"
+#include "IPostProcessChain.h"
+#include "IRenderTarget.h"
 #include "IReadFile.h"
 #include "IWriteFile.h"
+#include "CMemoryFile.h"
+#include "CMeshLoadRequest.h"
 
 #include "os.h"
+#include "CProfiler.h"
 
 #include "CSkinnedMesh.h"
 #include "CXMeshFileLoader.h"
 #include "COBJMeshFileLoader.h"
 #include "CB3DMeshFileLoader.h"
+#include "CGLTFMeshFileLoader.h"
+#include "CIRBMeshFileLoader.h"
+#include "CIRBMeshWriter.h"
+#include "SIRBStructs.h"
+#include "CReadFile.h"
+#include "CWriteFile.h"
 #include "CBillboardSceneNode.h"
 #include "CAnimatedMeshSceneNode.h"
 #include "CCameraSceneNode.h"
 #include "CMeshSceneNode.h"
+#include "CInstancedMeshSceneNode.h"
+#include "CChunkGridSceneNode.h"
+#include "CStaticBatchSceneNode.h"
 #include "CDummyTransformationSceneNode.h"
 #include "CEmptySceneNode.h"
+#include "CLightSceneNode.h"
 
 #include "CSceneCollisionManager.h"
+#include "CSceneViewsCamera.h"
 
 namespace irr
 {
@@ -33,13 +50,18 @@ namespace scene
 {
 
 //! constructor
-CSceneManager::CSceneManager(video::IVideoDriver* driver,
+CSceneManager::CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs,
 		gui::ICursorControl* cursorControl, IMeshCache* cache)
-: ISceneNode(0, 0), Driver(driver),
-	CursorControl(cursorControl),
-	ActiveCamera(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
-	MeshCache(cache), CurrentRenderPass(ESNRP_NONE)
+: ISceneNode(0, 0), Driver(driver), FileSystem(fs),
+	CursorControl(cursorControl), DepthPrepass(false), OrderIndependentTransparency(false), ShadowMapping(false),
+	PostProcessChain(0), MeshLoadQuit(false), ActiveCamera(0),
+	Invalidated(true), FrameAnimated(false), TrackChanges(false), DrawnSignature(0), ViewsCamera(0), CubemapFaceBit(0), NodeIndex(0), NodeRegistry(0), OcclusionBuffer(0), UpdateJobs(0), ShadowColor(150,0,0,0), AmbientLight(0,0,0,0), Parameters(0),
+	AllowZWriteParameter(-1), FractionalTimeParameter(-1), ParameterGeneration(0),
+	MeshCache(cache), CurrentRenderPass(ESNRP_NONE), AnimationTimeNs(0)
 {
+	for (u32 i=0; i<6; ++i)
+		CubemapCameras[i] = 0;
+
 	#ifdef _DEBUG
 	ISceneManager::setDebugName("CSceneManager ISceneManager");
 	ISceneNode::setDebugName("CSceneManager ISceneNode");
@@ -51,6 +73,9 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver,
 	if (Driver)
 		Driver->grab();
 
+	if (FileSystem)
+		FileSystem->grab();
+
 	if (CursorControl)
 		CursorControl->grab();
 
@@ -62,6 +87,7 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver,
 
 	// set scene parameters
 	Parameters = new io::CAttributes();
+	ParameterGeneration = Parameters->getHandleGeneration() - 1;
 
 	// create collision manager
 	CollisionManager = new CSceneCollisionManager(this, Driver);
@@ -75,12 +101,21 @@ CSceneManager::CSceneManager(video::IVideoDriver* driver,
 	MeshLoaderList.push_back(new CXMeshFileLoader(this));
 	MeshLoaderList.push_back(new COBJMeshFileLoader(this));
 	MeshLoaderList.push_back(new CB3DMeshFileLoader(this));
+	MeshLoaderList.push_back(new CGLTFMeshFileLoader(this));
+	MeshLoaderList.push_back(new CIRBMeshFileLoader());
 }
 
 
 //! destructor
 CSceneManager::~CSceneManager()
 {
+	// the loading thread uses the mesh loaders
+	stopMeshLoads();
+
+	// left by loaders which weren't run by getMesh() or getMeshAsync()
+	for (u32 r=0; r<MeshTextureReferences.size(); ++r)
+		MeshTextureReferences[r]->drop();
+
 	clearDeletionList();
 
 	//! force to remove hardwareTextures from the driver
@@ -103,6 +138,17 @@ CSceneManager::~CSceneManager()
 		ActiveCamera->drop();
 	ActiveCamera = 0;
 
+	if (ViewsCamera)
+		ViewsCamera->drop();
+	ViewsCamera = 0;
+
+	for (i=0; i<6; ++i)
+	{
+		if (CubemapCameras[i])
+			CubemapCameras[i]->drop();
+		CubemapCameras[i] = 0;
+	}
+
 	if (MeshCache)
 		MeshCache->drop();
 
@@ -114,8 +160,23 @@ CSceneManager::~CSceneManager()
 
 	removeAll();
 
+	setSpatialIndexEnabled(false);
+	setNodeRegistryEnabled(false);
+	setOcclusionCullingEnabled(false);
+	setParallelUpdateEnabled(false);
+
+	if (PostProcessChain)
+		PostProcessChain->drop();
+
 	if (Driver)
+	{
+		ShadowMaps.release(Driver);
+		LightClusters.release(Driver);
 		Driver->drop();
+	}
+
+	if (FileSystem)
+		FileSystem->drop();
 }
 
 
@@ -138,8 +199,40 @@ IAnimatedMesh* CSceneManager::getMesh(io::IReadFile* file)
 // load and create a mesh which we know already isn't in the cache and put it in there
 IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename)
 {
+	IRR_PROFILE_SCOPE("CSceneManager::getUncachedMesh");
 	IAnimatedMesh* msh = 0;
 
+	// the loading thread may be parsing a file with the same loader
+	std::unique_lock<std::mutex> lock(MeshLoaderMutex);
+
+	msh = createMeshThroughCache(file, filename);
+	if (!msh)
+		msh = createMeshFromLoaders(file, filename);
+
+	core::array<video::ITexture*> references;
+	references.swap(MeshTextureReferences);
+
+	lock.unlock();
+
+	resolveMeshTextures(msh, filename, references);
+
+	if (msh)
+	{
+		MeshCache->addMesh(cachename, msh);
+		msh->drop();
+	}
+
+	if (!msh)
+		os::Printer::log("Could not load mesh, file format seems to be unsupported", filename, ELL_ERROR);
+	else
+		os::Printer::log("Loaded mesh", filename, ELL_DEBUG);
+
+	return msh;
+}
+
+//! creates a mesh with the first loader taking the file, MeshLoaderMutex has to be held
+IAnimatedMesh* CSceneManager::createMeshFromLoaders(io::IReadFile* file, const io::path& filename)
+{
 	// iterate the list in reverse order so user-added loaders can override the built-in ones
 	s32 count = MeshLoaderList.size();
 	for (s32 i=count-1; i>=0; --i)
@@ -148,24 +241,364 @@ IAnimatedMesh* CSceneManager::getUncachedMesh(io::IReadFile* file, const io::pat
 		{
 			// reset file to avoid side effects of previous calls to createMesh
 			file->seek(0);
-			msh = MeshLoaderList[i]->createMesh(file);
+			IAnimatedMesh* msh = MeshLoaderList[i]->createMesh(file);
 			if (msh)
 			{
-				MeshCache->addMesh(cachename, msh);
-				msh->drop();
-				break;
+				if (Driver && Parameters->getAttributeAsBool(OPTIMIZE_LOADED_MESHES))
+					optimizeLoadedMesh(msh);
+				return msh;
 			}
 		}
 	}
 
-	if (!msh)
-		os::Printer::log("Could not load mesh, file format seems to be unsupported", filename, ELL_ERROR);
-	else
-		os::Printer::log("Loaded mesh", filename, ELL_DEBUG);
+	return 0;
+}
+
+
+//! runs the OPTIMIZE_LOADED_MESHES pass on a mesh a loader created
+void CSceneManager::optimizeLoadedMesh(IAnimatedMesh* msh)
+{
+	// the frames of other animated meshes would have to be changed alike
+	if (msh->getMeshType() == EAMT_SKINNED)
+		getMeshManipulator()->optimizeMesh(msh);
+	else if (msh->getFrameCount() == 1)
+		getMeshManipulator()->optimizeMesh(msh->getMesh(0));
+}
+
+
+//! loads a mesh through the .irrbm files in MeshCacheDirectory, 0 if it is not set
+IAnimatedMesh* CSceneManager::createMeshThroughCache(io::IReadFile* file, const io::path& filename)
+{
+	if (MeshCacheDirectory.empty() || core::hasFileExtension(filename, "irrbm"))
+		return 0;
+
+	// the whole file is hashed, and parsed from memory if it isn't cached yet
+	const long size = file->getSize();
+	if (size <= 0)
+		return 0;
+
+	c8* data = new c8[size];
+	file->seek(0);
+	if (file->read(data, size) != (size_t)size)
+	{
+		delete [] data;
+		return 0;
+	}
+
+	// FNV-1a, along with the size and the format version
+	u64 hash = 14695981039346656037ull;
+	for (long i=0; i<size; ++i)
+		hash = (hash ^ (u8)data[i]) * 1099511628211ull;
+
+	c8 name[64];
+	// optimized meshes are cached apart, the cached ones aren't optimized again
+	const bool optimize = Parameters->getAttributeAsBool(OPTIMIZE_LOADED_MESHES);
+	// the meshes of the loaders are cached apart if they may have textures
+	const bool textures = Parameters->getAttributeAsBool(MESH_LOADER_TEXTURES);
+	snprintf_irr(name, sizeof(name), "/%016llx-%lx-%u%s%s.irrbm", (unsigned long long)hash, size, IRB_VERSION,
+		optimize ? "o" : "", textures ? "t" : "");
+	const io::path cachePath = MeshCacheDirectory + name;
+
+	IAnimatedMesh* msh = 0;
+	io::IReadFile* cached = io::CReadFile::createReadFile(cachePath);
+	if (cached)
+	{
+		CIRBMeshFileLoader loader;
+		msh = loader.createMesh(cached);
+		cached->drop();
+	}
+
+	if (msh)
+	{
+		delete [] data;
+		os::Printer::log("Loaded mesh from cache", cachePath, ELL_DEBUG);
+		return msh;
+	}
+
+	io::IReadFile* memoryFile = new io::CMemoryReadFile(data, size, filename, true);
+	msh = createMeshFromLoaders(memoryFile, filename);
+	memoryFile->drop();
+
+	// .irrbm files store no textures
+	if (msh && msh->getMeshType() == EAMT_SKINNED && MeshTextureReferences.empty())
+	{
+		io::IWriteFile* out = io::CWriteFile::createWriteFile(cachePath, false);
+		if (out)
+		{
+			CIRBMeshWriter writer;
+			if (!writer.writeMesh(out, msh))
+				os::Printer::log("Could not write mesh to cache", cachePath, ELL_WARNING);
+			out->drop();
+		}
+	}
 
 	return msh;
 }
 
+
+//! sets a directory in which getMesh() caches skinned meshes
+void CSceneManager::setMeshCacheDirectory(const io::path& directory)
+{
+	std::lock_guard<std::mutex> lock(MeshLoaderMutex);
+	MeshCacheDirectory = directory;
+}
+
+
+namespace
+{
+	//! Texture file a mesh file refers to, until resolveMeshTextures() replaces it
+	class CMeshTextureReference : public video::ITexture
+	{
+	public:
+		CMeshTextureReference(const io::path& name) : video::ITexture(name, video::ETT_2D)
+		{
+			Source = video::ETS_UNRESOLVED;
+		}
+
+		void* lock(video::E_TEXTURE_LOCK_MODE mode, u32 mipmapLevel, u32 layer, video::E_TEXTURE_LOCK_FLAGS lockFlags) override { return 0; }
+		void unlock() override {}
+		void regenerateMipMapLevels(void* data, u32 layer) override {}
+	};
+}
+
+
+//! records a texture file a mesh file refers to, for mesh loaders
+video::ITexture* CSceneManager::addMeshTextureReference(const io::path& name)
+{
+	// the loaders call it while MeshLoaderMutex is held
+	for (u32 i=0; i<MeshTextureReferences.size(); ++i)
+	{
+		if (MeshTextureReferences[i]->getName().getPath() == name)
+			return MeshTextureReferences[i];
+	}
+
+	video::ITexture* reference = new CMeshTextureReference(name);
+	MeshTextureReferences.push_back(reference);
+	return reference;
+}
+
+
+//! replaces the texture references in the materials of a mesh by the textures, drops the references
+void CSceneManager::resolveMeshTextures(IAnimatedMesh* msh, const io::path& filename, core::array<video::ITexture*>& references)
+{
+	if (references.empty())
+		return;
+
+	if (msh && Driver && FileSystem)
+	{
+		IRR_PROFILE_SCOPE("CSceneManager::resolveMeshTextures");
+		const io::path meshDir = FileSystem->getFileDir(filename) + "/";
+
+		// the textures are decoded on the worker threads of the driver meanwhile
+		std::unordered_map<const video::ITexture*, video::ITexture*> textures;
+		for (u32 i=0; i<references.size(); ++i)
+		{
+			io::path name = references[i]->getName().getPath();
+			name.replace('\\', '/');
+
+			io::path path = name;
+			if (!FileSystem->existFile(path))
+				path = meshDir + name;
+			if (!FileSystem->existFile(path))
+				path = meshDir + FileSystem->getFileBasename(name);
+
+			video::ITexture* texture = FileSystem->existFile(path) ? Driver->getTextureAsync(path) : 0;
+			if (!texture)
+				os::Printer::log("Could not find texture of mesh", name, ELL_WARNING);
+			textures[references[i]] = texture;
+		}
+
+		// the frames of the other animated meshes share the buffers of the first one
+		for (u32 b=0; b<msh->getMeshBufferCount(); ++b)
+		{
+			video::SMaterial& material = msh->getMeshBuffer(b)->getMaterial();
+			for (u32 l=0; l<video::MATERIAL_MAX_TEXTURES; ++l)
+			{
+				video::ITexture* texture = material.getTexture(l);
+				if (texture && texture->getSource() == video::ETS_UNRESOLVED)
+				{
+					auto found = textures.find(texture);
+					if (found != textures.end())
+						material.setTexture(l, found->second);
+				}
+			}
+		}
+	}
+
+	for (u32 i=0; i<references.size(); ++i)
+		references[i]->drop();
+	references.clear();
+}
+
+
+//! loads a mesh on the loading thread
+IMeshLoadRequest* CSceneManager::getMeshAsync(io::IReadFile* file)
+{
+	if (!file)
+		return 0;
+
+	finishMeshLoads();
+
+	const io::path name = file->getFileName();
+	IAnimatedMesh* msh = MeshCache->getMeshByName(name);
+	if (msh)
+		return new CMeshLoadRequest(msh);
+
+	for (u32 i=0; i<MeshLoads.size(); ++i)
+	{
+		if (MeshLoads[i]->getCacheName() == name)
+		{
+			MeshLoads[i]->grab();
+			return MeshLoads[i];
+		}
+	}
+
+	// the loaders are picked here, as the list may change while the file is parsed
+	core::array<IMeshLoader*> loaders;
+	for (u32 i=0; i<MeshLoaderList.size(); ++i)
+	{
+		if (MeshLoaderList[i]->isALoadableFileExtension(name))
+			loaders.push_back(MeshLoaderList[i]);
+	}
+
+	if (loaders.empty())
+	{
+		os::Printer::log("Could not load mesh, file format seems to be unsupported", name, ELL_ERROR);
+		return new CMeshLoadRequest(0);
+	}
+
+	// files of archives share the file of the archive, so they are read here
+	io::IReadFile* source = file;
+	if (file->getType() != io::ERFT_READ_FILE && file->getType() != io::ERFT_MEMORY_READ_FILE)
+	{
+		const long size = file->getSize();
+		c8* data = new c8[size > 0 ? size : 1];
+		file->seek(0);
+		if (file->read(data, size) != (size_t)size)
+		{
+			delete [] data;
+			os::Printer::log("Could not read mesh file", name, ELL_ERROR);
+			return new CMeshLoadRequest(0);
+		}
+		source = new io::CMemoryReadFile(data, size, name, true);
+	}
+	else
+		source->grab();
+
+	CMeshLoadRequest* request = new CMeshLoadRequest(source, name, loaders);
+	source->drop();
+
+	// one reference for MeshLoads, one for the queue and one for the caller
+	MeshLoads.push_back(request);
+	request->grab();
+	request->grab();
+
+	{
+		std::lock_guard<std::mutex> lock(MeshLoadMutex);
+		MeshLoadQueue.push_back(request);
+	}
+	MeshLoadWake.notify_one();
+
+	if (!MeshLoadThread.joinable())
+		MeshLoadThread = std::thread(&CSceneManager::meshLoadLoop, this);
+
+	return request;
+}
+
+
+//! parses the files of the queued requests, runs on MeshLoadThread
+void CSceneManager::meshLoadLoop()
+{
+	for (;;)
+	{
+		CMeshLoadRequest* request;
+		{
+			std::unique_lock<std::mutex> lock(MeshLoadMutex);
+			MeshLoadWake.wait(lock, [this] { return MeshLoadQuit || !MeshLoadQueue.empty(); });
+			if (MeshLoadQuit)
+				return;
+			request = MeshLoadQueue.front();
+			MeshLoadQueue.pop_front();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(MeshLoaderMutex);
+			request->load();
+			request->setTextureReferences(MeshTextureReferences);
+		}
+		request->drop();
+	}
+}
+
+
+//! adds the meshes of the parsed requests to the mesh cache
+void CSceneManager::finishMeshLoads()
+{
+	for (u32 i=0; i<MeshLoads.size(); )
+	{
+		CMeshLoadRequest* request = MeshLoads[i];
+		if (!request->isLoaded())
+		{
+			++i;
+			continue;
+		}
+
+		const io::path& name = request->getCacheName();
+		IAnimatedMesh* msh = request->takeLoadedMesh();
+		core::array<video::ITexture*> references;
+		request->takeTextureReferences(references);
+		resolveMeshTextures(msh, name, references);
+		if (msh)
+		{
+			// getMesh() may have loaded the file meanwhile
+			IAnimatedMesh* cached = MeshCache->getMeshByName(name);
+			if (!cached)
+			{
+				MeshCache->addMesh(name, msh);
+				cached = msh;
+			}
+			request->setReady(cached);
+			msh->drop();
+			os::Printer::log("Loaded mesh", name, ELL_DEBUG);
+		}
+		else
+		{
+			request->setFailed();
+			os::Printer::log("Could not load mesh, file format seems to be unsupported", name, ELL_ERROR);
+		}
+
+		MeshLoads.erase(i);
+		request->drop();
+	}
+}
+
+
+//! stops MeshLoadThread, the requests not finished yet fail
+void CSceneManager::stopMeshLoads()
+{
+	if (MeshLoadThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(MeshLoadMutex);
+			MeshLoadQuit = true;
+		}
+		MeshLoadWake.notify_one();
+		MeshLoadThread.join();
+	}
+
+	for (u32 i=0; i<MeshLoadQueue.size(); ++i)
+		MeshLoadQueue[i]->drop();
+	MeshLoadQueue.clear();
+
+	for (u32 i=0; i<MeshLoads.size(); ++i)
+	{
+		MeshLoads[i]->setFailed();
+		MeshLoads[i]->drop();
+	}
+	MeshLoads.clear();
+}
+
+
 //! returns the video driver
 video::IVideoDriver* CSceneManager::getVideoDriver()
 {
@@ -192,6 +625,54 @@ IMeshSceneNode* CSceneManager::addMeshSceneNode(IMesh* mesh, ISceneNode* parent,
 }
 
 
+//! adds a scene node for rendering many instances of a static mesh
+IInstancedMeshSceneNode* CSceneManager::addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale, bool alsoAddIfMeshPointerZero)
+{
+	if (!alsoAddIfMeshPointerZero && !mesh)
+		return 0;
+
+	if (!parent)
+		parent = this;
+
+	IInstancedMeshSceneNode* node = new CInstancedMeshSceneNode(mesh, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
+//! adds a scene node for large world geometry made of chunk meshes
+IChunkGridSceneNode* CSceneManager::addChunkGridSceneNode(ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale)
+{
+	if (!parent)
+		parent = this;
+
+	IChunkGridSceneNode* node = new CChunkGridSceneNode(parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
+//! adds a scene node merging many static mesh scene nodes into few large buffers
+IStaticBatchSceneNode* CSceneManager::addStaticBatchSceneNode(ISceneNode* parent, s32 id,
+	const core::vector3df& position, const core::vector3df& rotation,
+	const core::vector3df& scale, f32 cellSize)
+{
+	if (!parent)
+		parent = this;
+
+	IStaticBatchSceneNode* node = new CStaticBatchSceneNode(cellSize, parent, this, id, position, rotation, scale);
+	node->drop();
+
+	return node;
+}
+
+
 //! adds a scene node for rendering an animated mesh model
 IAnimatedMeshSceneNode* CSceneManager::addAnimatedMeshSceneNode(IAnimatedMesh* mesh, ISceneNode* parent, s32 id,
 	const core::vector3df& position, const core::vector3df& rotation,
@@ -253,6 +734,20 @@ IBillboardSceneNode* CSceneManager::addBillboardSceneNode(ISceneNode* parent,
 }
 
 
+//! Adds a dynamic point light.
+ILightSceneNode* CSceneManager::addLightSceneNode(ISceneNode* parent,
+	const core::vector3df& position, video::SColorf color, f32 radius, s32 id)
+{
+	if (!parent)
+		parent = this;
+
+	ILightSceneNode* node = new CLightSceneNode(parent, this, id, position, color, radius);
+	node->drop();
+
+	return node;
+}
+
+
 //! Adds an empty scene node.
 ISceneNode* CSceneManager::addEmptySceneNode(ISceneNode* parent, s32 id)
 {
@@ -338,6 +833,7 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 	{
 		return false;
 	}
+	const SViewFrustum* frustum = cam->getViewFrustum();
 	bool result = false;
 
 	// has occlusion query information
@@ -346,12 +842,23 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 		result = (Driver->getOcclusionQueryResult(const_cast<ISceneNode*>(node))==0);
 	}
 
+	// already culled together with the other nodes
+	bool batchResult;
+	if (!result && CullingBatch.find(node, cam, batchResult))
+		return batchResult || isOccluded(node, cam);
+
+	// the index knows the box already
+	core::aabbox3df indexBox;
+	if (!result && NodeIndex && (node->getAutomaticCulling() & scene::EAC_BOX) &&
+			NodeIndex->getBox(node, indexBox) && !indexBox.intersectsWithBox(frustum->getBoundingBox()))
+		return true;
+
 	// can be seen by a bounding box ?
 	if (!result && (node->getAutomaticCulling() & scene::EAC_BOX))
 	{
 		core::aabbox3d<f32> tbox = node->getBoundingBox();
 		node->getAbsoluteTransformation().transformBoxEx(tbox);
-		result = !(tbox.intersectsWithBox(cam->getViewFrustum()->getBoundingBox() ));
+		result = !(tbox.intersectsWithBox(frustum->getBoundingBox() ));
 	}
 
 	// can be seen by a bounding sphere
@@ -361,8 +868,8 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 		const float rad = nbox.getRadius();
 		const core::vector3df center = nbox.getCenter();
 
-		const float camrad = cam->getViewFrustum()->getBoundingRadius();
-		const core::vector3df camcenter = cam->getViewFrustum()->getBoundingCenter();
+		const float camrad = frustum->getBoundingRadius();
+		const core::vector3df camcenter = frustum->getBoundingCenter();
 
 		const float dist = (center - camcenter).getLengthSQ();
 		const float maxdist = (rad + camrad) * (rad + camrad);
@@ -373,7 +880,7 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 	// can be seen by cam pyramid planes ?
 	if (!result && (node->getAutomaticCulling() & scene::EAC_FRUSTUM_BOX))
 	{
-		SViewFrustum frust = *cam->getViewFrustum();
+		SViewFrustum frust = *frustum;
 
 		//transform the frustum to the node's current absolute transformation
 		core::matrix4 invTrans(node->getAbsoluteTransformation(), core::matrix4::EM4CONST_INVERSE);
@@ -403,31 +910,275 @@ bool CSceneManager::isCulled(const ISceneNode* node) const
 		}
 	}
 
-	return result;
+	return result || isOccluded(node, cam);
 }
 
 
-//! registers a node for rendering it at a specific time.
-u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
+//! checks a node with automatic culling against the OcclusionBuffer
+bool CSceneManager::isOccluded(const ISceneNode* node, const ICameraSceneNode* cam) const
 {
-	u32 taken = 0;
+	if (!OcclusionBuffer || !(node->getAutomaticCulling() & (scene::EAC_BOX | scene::EAC_FRUSTUM_BOX | scene::EAC_FRUSTUM_SPHERE)))
+		return false;
 
-	switch(pass)
+	return OcclusionBuffer->isOccluded(node->getBoundingBox(), node->getAbsoluteTransformation(), cam);
+}
+
+
+void CSceneManager::setSpatialIndexEnabled(bool enable)
+{
+	if (enable == (NodeIndex != 0))
+		return;
+
+	if (enable)
 	{
-		// take camera if it is not already registered
-	case ESNRP_CAMERA:
-		{
-			taken = 1;
-			for (u32 i = 0; i != CameraList.size(); ++i)
-			{
-				if (CameraList[i] == node)
-				{
-					taken = 0;
-					break;
-				}
-			}
-			if (taken)
-			{
+		NodeIndex = new CSceneNodeSpatialIndex();
+		setSpatialIndex(NodeIndex);
+	}
+	else
+	{
+		setSpatialIndex(0);
+		delete NodeIndex;
+		NodeIndex = 0;
+	}
+}
+
+
+ISpatialIndex* CSceneManager::getSpatialIndex() const
+{
+	return NodeIndex;
+}
+
+
+void CSceneManager::setNodeRegistryEnabled(bool enable)
+{
+	if (enable == (NodeRegistry != 0))
+		return;
+
+	if (enable)
+	{
+		NodeRegistry = new CSceneNodeRegistry();
+		setNodeRegistry(NodeRegistry);
+	}
+	else
+	{
+		setNodeRegistry(0);
+		delete NodeRegistry;
+		NodeRegistry = 0;
+	}
+}
+
+
+void CSceneManager::setOcclusionCullingEnabled(bool enable)
+{
+	if (enable == (OcclusionBuffer != 0))
+		return;
+
+	if (enable)
+	{
+		OcclusionBuffer = new CSceneOcclusionBuffer();
+	}
+	else
+	{
+		delete OcclusionBuffer;
+		OcclusionBuffer = 0;
+		Occluders.clear();
+	}
+}
+
+
+void CSceneManager::setParallelUpdateEnabled(bool enable)
+{
+	if (enable == (UpdateJobs != 0))
+		return;
+
+	if (enable)
+	{
+		// the thread calling drawAll works on the jobs as well
+		const u32 cores = std::thread::hardware_concurrency();
+		UpdateJobs = new CJobSystem(cores > 1 ? cores - 1 : 1);
+	}
+	else
+	{
+		delete UpdateJobs;
+		UpdateJobs = 0;
+	}
+}
+
+
+void CSceneManager::setShadowMappingEnabled(bool enable)
+{
+	ShadowMapping = enable;
+
+	// free the textures, they are created again when enabled
+	if (!enable && Driver)
+		ShadowMaps.release(Driver);
+}
+
+
+void CSceneManager::setPostProcessChain(video::IPostProcessChain* chain)
+{
+	if (chain)
+		chain->grab();
+	if (PostProcessChain)
+		PostProcessChain->drop();
+	PostProcessChain = chain;
+}
+
+
+//! adds the visible skinned animated mesh nodes at and below node to the list
+static void gatherSkinnedNodes(ISceneNode* node, core::array<ISceneNode*>& outNodes)
+{
+	if (!node->isVisible())
+		return;
+
+	if (node->getType() == ESNT_ANIMATED_MESH)
+	{
+		IAnimatedMesh* mesh = static_cast<CAnimatedMeshSceneNode*>(node)->getMesh();
+		if (mesh && mesh->getMeshType() == EAMT_SKINNED)
+			outNodes.push_back(node);
+	}
+
+	for (ISceneNode* child : node->getChildren())
+		gatherSkinnedNodes(child, outNodes);
+}
+
+
+void CSceneManager::animateJob(void* data)
+{
+	SAnimateJob* job = static_cast<SAnimateJob*>(data);
+	IRR_PROFILE_SCOPE("OnAnimate job");
+	job->Node->OnAnimate(job->TimeMs);
+
+	// gathered here, while the subtree is still in the cache of this thread
+	gatherSkinnedNodes(job->Node, job->SkinnedNodes);
+}
+
+
+void CSceneManager::skinJob(void* data)
+{
+	static_cast<CAnimatedMeshSceneNode*>(data)->prepareMeshForCurrentFrame();
+}
+
+
+void CSceneManager::animateParallel(u32 timeMs)
+{
+	SkinnedMeshUsers.clear();
+	if (!IsVisible)
+	{
+		AnimateJobs.clear();
+		return;
+	}
+
+	updateAbsolutePosition();
+
+	const ISceneNodeList& children = getChildren();
+	AnimateJobs.resize(children.size());
+
+	u32 count = 0;
+	for (ISceneNode* child : children)
+	{
+		SAnimateJob& job = AnimateJobs[count++];
+		job.Node = child;
+		job.TimeMs = timeMs;
+		job.SkinnedNodes.set_used(0);
+		UpdateJobs->add(animateJob, &job);
+	}
+	UpdateJobs->wait();
+
+	for (const SAnimateJob& job : AnimateJobs)
+	{
+		for (u32 j = 0; j < job.SkinnedNodes.size(); ++j)
+			++SkinnedMeshUsers[static_cast<CAnimatedMeshSceneNode*>(job.SkinnedNodes[j])->getMesh()];
+	}
+}
+
+
+void CSceneManager::skinParallel()
+{
+	bool added = false;
+	for (const SAnimateJob& job : AnimateJobs)
+	{
+		for (u32 j = 0; j < job.SkinnedNodes.size(); ++j)
+		{
+			CAnimatedMeshSceneNode* node = static_cast<CAnimatedMeshSceneNode*>(job.SkinnedNodes[j]);
+
+			// nodes sharing a mesh go through its pose cache, which isn't thread safe
+			if (SkinnedMeshUsers[node->getMesh()] != 1 || isCulled(node))
+				continue;
+
+			UpdateJobs->add(skinJob, node);
+			added = true;
+		}
+	}
+
+	if (added)
+		UpdateJobs->wait();
+
+	// the pose cache is used from this thread only, a mesh splits its own skinning into jobs
+	for (const SAnimateJob& job : AnimateJobs)
+	{
+		for (u32 j = 0; j < job.SkinnedNodes.size(); ++j)
+		{
+			CAnimatedMeshSceneNode* node = static_cast<CAnimatedMeshSceneNode*>(job.SkinnedNodes[j]);
+
+			if (SkinnedMeshUsers[node->getMesh()] != 1 && !isCulled(node))
+				node->preparePoseForCurrentFrame(UpdateJobs);
+		}
+	}
+}
+
+
+void CSceneManager::gatherNodesForCulling(const ISceneNode* node)
+{
+	for (const ISceneNode* child : node->getChildren())
+	{
+		if (!child->isVisible())
+			continue;
+
+		CullingBatch.add(child);
+		if (OcclusionBuffer && (child->getAutomaticCulling() & EAC_OCCLUDER))
+			Occluders.push_back(child);
+		gatherNodesForCulling(child);
+	}
+}
+
+
+void CSceneManager::rasterizeOccluders()
+{
+	OcclusionBuffer->begin(ActiveCamera);
+	for (u32 i = 0; i < Occluders.size(); ++i)
+	{
+		// occluders outside of the view can't hide anything
+		bool culled;
+		if (!CullingBatch.find(Occluders[i], ActiveCamera, culled) || !culled)
+			OcclusionBuffer->addOccluder(Occluders[i]);
+	}
+	OcclusionBuffer->rasterize();
+	Occluders.set_used(0);
+}
+
+
+//! registers a node for rendering it at a specific time.
+u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass)
+{
+	u32 taken = 0;
+
+	switch(pass)
+	{
+		// take camera if it is not already registered
+	case ESNRP_CAMERA:
+		{
+			taken = 1;
+			for (u32 i = 0; i != CameraList.size(); ++i)
+			{
+				if (CameraList[i] == node)
+				{
+					taken = 0;
+					break;
+				}
+			}
+			if (taken)
+			{
 				CameraList.push_back(node);
 			}
 		}
@@ -439,21 +1190,23 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	case ESNRP_SOLID:
 		if (!isCulled(node))
 		{
-			SolidNodeList.push_back(node);
+			SolidRenderQueue.add(CRenderQueue::makeKey(0,
+				node->getMaterialCount() ? node->getMaterial(0) : video::IdentityMaterial,
+				getRelativeDepth(node)), node);
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT:
 		if (!isCulled(node))
 		{
-			TransparentNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			addTransparentNode(node);
 			taken = 1;
 		}
 		break;
 	case ESNRP_TRANSPARENT_EFFECT:
 		if (!isCulled(node))
 		{
-			TransparentEffectNodeList.push_back(TransparentNodeEntry(node, camWorldPos));
+			TransparentEffectRenderQueue.add(getBoxDistanceSQ(node), node);
 			taken = 1;
 		}
 		break;
@@ -468,8 +1221,7 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 				if (Driver->needsTransparentRenderPass(node->getMaterial(i)))
 				{
 					// register as transparent node
-					TransparentNodeEntry e(node, camWorldPos);
-					TransparentNodeList.push_back(e);
+					addTransparentNode(node);
 					taken = 1;
 					break;
 				}
@@ -478,7 +1230,9 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 			// not transparent, register as solid
 			if (!taken)
 			{
-				SolidNodeList.push_back(node);
+				SolidRenderQueue.add(CRenderQueue::makeKey(0,
+					count ? node->getMaterial(0) : video::IdentityMaterial,
+					getRelativeDepth(node)), node);
 				taken = 1;
 			}
 		}
@@ -489,10 +1243,34 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 			GuiNodeList.push_back(node);
 			taken = 1;
 		}
+		break;
+	case ESNRP_SHADOW:
+		// not culled by the camera, the shadows reach into its view. Only
+		// solid materials are drawn into the shadow maps.
+		if (ShadowMapping)
+		{
+			const u32 count = node->getMaterialCount();
+			for (u32 i=0; i<count; ++i)
+			{
+				if (!Driver->needsTransparentRenderPass(node->getMaterial(i)))
+				{
+					ShadowMaps.addCaster(node);
+					taken = 1;
+					break;
+				}
+			}
+		}
+		break;
 
-	// as of yet unused
 	case ESNRP_LIGHT:
-	case ESNRP_SHADOW:
+		if (node->getType() == ESNT_LIGHT)
+		{
+			LightClusters.addLight(static_cast<ILightSceneNode*>(node));
+			taken = 1;
+		}
+		break;
+
+	case ESNRP_DEPTH_PREPASS: // drawn from the solid nodes
 	case ESNRP_NONE: // ignore this one
 		break;
 	}
@@ -500,14 +1278,194 @@ u32 CSceneManager::registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDE
 	return taken;
 }
 
+
+//! registers a solid mesh buffer of a node for rendering.
+void CSceneManager::registerMeshBufferForRendering(ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial& material,
+		E_SCENE_NODE_RENDER_PASS pass)
+{
+	switch (pass)
+	{
+	case ESNRP_SOLID:
+		SolidRenderQueue.add(CRenderQueue::makeKey(0, material, getRelativeDepth(node)), node, meshBuffer, material);
+		break;
+	case ESNRP_TRANSPARENT:
+		if (OrderIndependentTransparency && Driver->canAccumulateTransparency(material))
+			AccumulatedRenderQueue.add(CRenderQueue::makeKey(0, material, 0.f), node, meshBuffer, material);
+		else
+			TransparentRenderQueue.add(getMeshBufferDistanceSQ(node, meshBuffer), node, meshBuffer, material);
+		break;
+	default:
+		break;
+	}
+}
+
+
+//! registers a camera facing quad, batched with the others of its material
+void CSceneManager::registerBillboardForRendering(const video::SMaterial& material, const video::S3DVertex* vertices)
+{
+	const core::vector3df center = (vertices[0].Pos + vertices[2].Pos) * 0.5f;
+	BillboardBatch.add(material, Driver->needsTransparentRenderPass(material), vertices,
+		center.getDistanceFromSQ(camWorldPos));
+}
+
+
+f32 CSceneManager::getBoxDistanceSQ(const ISceneNode* node) const
+{
+	return node->getTransformedBoundingBox().getCenter().getDistanceFromSQ(camWorldPos);
+}
+
+
+f32 CSceneManager::getMeshBufferDistanceSQ(const ISceneNode* node, const IMeshBuffer* meshBuffer) const
+{
+	core::vector3df center = meshBuffer->getBoundingBox().getCenter();
+	if (node)
+		node->getAbsoluteTransformation().transformVect(center);
+	return center.getDistanceFromSQ(camWorldPos);
+}
+
+
+bool CSceneManager::canAccumulateTransparency(ISceneNode* node) const
+{
+	const u32 count = node->getMaterialCount();
+	for (u32 i=0; i<count; ++i)
+	{
+		if (!Driver->canAccumulateTransparency(node->getMaterial(i)))
+			return false;
+	}
+	return count != 0;
+}
+
+
+void CSceneManager::addTransparentNode(ISceneNode* node)
+{
+	// accumulated nodes only need to be grouped by their materials
+	if (OrderIndependentTransparency && canAccumulateTransparency(node))
+		AccumulatedRenderQueue.add(CRenderQueue::makeKey(0, node->getMaterial(0), 0.f), node);
+	else
+		TransparentRenderQueue.add(getBoxDistanceSQ(node), node);
+}
+
+
+void CSceneManager::sortAccumulatedTransparency()
+{
+	for (u32 i=0; i<AccumulatedRenderQueue.size(); ++i)
+	{
+		const CRenderQueue::SEntry& entry = AccumulatedRenderQueue[i];
+		if (entry.MeshBuffer)
+			TransparentRenderQueue.add(getMeshBufferDistanceSQ(entry.Node, entry.MeshBuffer),
+				entry.Node, entry.MeshBuffer, *entry.Material);
+		else
+			TransparentRenderQueue.add(getBoxDistanceSQ(entry.Node), entry.Node);
+	}
+	AccumulatedRenderQueue.clear();
+	TransparentRenderQueue.sort();
+	TransparentFaceMasks.set_used(0);
+}
+
+
+template <class TQueue>
+void CSceneManager::drawRenderQueue(const TQueue& queue, core::array<u8>& faceMasks)
+{
+	if (CubemapFaceBit && faceMasks.size() != queue.size())
+		buildFaceMasks(queue, faceMasks);
+
+	const ISceneNode* transformNode = 0;
+	bool transformSet = false;
+	for (u32 i=0; i<queue.size(); ++i)
+	{
+		if (CubemapFaceBit && !(faceMasks[i] & CubemapFaceBit))
+			continue;
+
+		const typename TQueue::SEntry& entry = queue[i];
+		if (!entry.MeshBuffer)
+		{
+			// nodes drawing themselves change the transformation as well
+			entry.Node->render();
+			transformSet = false;
+			continue;
+		}
+
+		if (!transformSet || entry.Node != transformNode)
+		{
+			Driver->setTransform(video::ETS_WORLD,
+				entry.Node ? entry.Node->getAbsoluteTransformation() : core::IdentityMatrix);
+			transformNode = entry.Node;
+			transformSet = true;
+		}
+		Driver->setMaterial(*entry.Material);
+		Driver->drawMeshBuffer(entry.MeshBuffer);
+	}
+}
+
+
+template <class TQueue>
+void CSceneManager::buildFaceMasks(const TQueue& queue, core::array<u8>& faceMasks)
+{
+	const u32 count = queue.size();
+	faceMasks.set_used(count);
+	FaceMaskBoxes.set_used(count);
+	FaceMaskRelations.set_used(count);
+
+	u32 i;
+	for (i=0; i<count; ++i)
+	{
+		const typename TQueue::SEntry& entry = queue[i];
+		if (entry.MeshBuffer)
+		{
+			FaceMaskBoxes[i] = entry.MeshBuffer->getBoundingBox();
+			if (entry.Node)
+				entry.Node->getAbsoluteTransformation().transformBoxEx(FaceMaskBoxes[i]);
+		}
+		else
+			FaceMaskBoxes[i] = entry.Node->getTransformedBoundingBox();
+		faceMasks[i] = 0;
+	}
+
+	for (u32 face=0; face<6; ++face)
+	{
+		CubemapFrusta[face].classifyBoxes(FaceMaskBoxes.const_pointer(), count, FaceMaskRelations.pointer());
+		for (i=0; i<count; ++i)
+		{
+			if (FaceMaskRelations[i] != core::ISREL3D_FRONT)
+				faceMasks[i] |= (u8)(1 << face);
+		}
+	}
+
+	// entries without culling are drawn into every face, like by drawAll()
+	for (i=0; i<count; ++i)
+	{
+		const ISceneNode* node = queue[i].Node;
+		if (node && node->getAutomaticCulling() == EAC_OFF)
+			faceMasks[i] = 0x3f;
+	}
+}
+
+
+f32 CSceneManager::getRelativeDepth(const ISceneNode* node) const
+{
+	if (!ActiveCamera)
+		return 0.f;
+
+	const f32 farValue = ActiveCamera->getFarValue();
+	if (farValue <= 0.f)
+		return 0.f;
+
+	return (f32)(node->getAbsolutePosition().getDistanceFromSQ(camWorldPos) / (farValue * farValue));
+}
+
+
 void CSceneManager::clearAllRegisteredNodesForRendering()
 {
 	CameraList.clear();
 	SkyBoxList.clear();
-	SolidNodeList.clear();
-	TransparentNodeList.clear();
-	TransparentEffectNodeList.clear();
+	SolidRenderQueue.clear();
+	TransparentRenderQueue.clear();
+	TransparentEffectRenderQueue.clear();
+	AccumulatedRenderQueue.clear();
+	BillboardBatch.clear();
 	GuiNodeList.clear();
+	ShadowMaps.clearCasters();
+	LightClusters.clearLights();
 }
 
 //! This method is called just before the rendering process of the whole scene.
@@ -517,7 +1475,224 @@ void CSceneManager::drawAll()
 	if (!Driver)
 		return;
 
-	u32 i; // new ISO for scoping problem in some compilers
+	IRR_PROFILE_SCOPE("CSceneManager::drawAll");
+
+	beginDrawAll(true);
+
+	/*!
+		First Scene Node for prerendering should be the active camera
+		consistent Camera is needed for culling
+	*/
+	camWorldPos.set(0,0,0);
+	if (ActiveCamera)
+	{
+		ActiveCamera->render();
+		camWorldPos = ActiveCamera->getAbsolutePosition();
+	}
+
+	registerNodes(true);
+
+	Driver->beginGPUTimerScope("scene");
+
+	// the passes draw the scene texture into the current render target at the end
+	const bool postProcess = PostProcessChain && PostProcessChain->begin();
+
+	SolidRenderQueue.sort(); // sort by material and depth
+	TransparentRenderQueue.sort(); // sort by distance from camera
+	TransparentEffectRenderQueue.sort();
+	AccumulatedRenderQueue.sort(); // by material only
+
+	drawRegisteredNodes(true);
+
+	endDrawAll(postProcess);
+}
+
+
+//! draws all scene nodes as seen by several cameras
+void CSceneManager::drawAllViews(const core::array<SSceneView>& views)
+{
+	if (!Driver || views.empty())
+		return;
+
+	u32 i;
+	for (i=0; i<views.size(); ++i)
+	{
+		if (!views[i].Camera)
+		{
+			os::Printer::log("Could not draw scene views, a view has no camera.", ELL_ERROR);
+			return;
+		}
+	}
+
+	IRR_PROFILE_SCOPE("CSceneManager::drawAllViews");
+
+	beginDrawAll(true);
+
+	for (i=0; i<views.size(); ++i)
+		views[i].Camera->updateMatrices();
+
+	// the nodes of all views are culled and register at once
+	ICameraSceneNode* const activeCamera = ActiveCamera;
+	if (views.size() == 1)
+	{
+		ActiveCamera = views[0].Camera;
+	}
+	else
+	{
+		if (!ViewsCamera)
+			ViewsCamera = new CSceneViewsCamera(this);
+		ViewsCamera->setViews(views);
+		ActiveCamera = ViewsCamera;
+	}
+	camWorldPos = ActiveCamera->getAbsolutePosition();
+
+	registerNodes(views.size() == 1);
+
+	Driver->beginGPUTimerScope("scene");
+
+	const bool postProcess = PostProcessChain && PostProcessChain->begin();
+	const core::rect<s32> viewPort = Driver->getViewPort();
+
+	SolidRenderQueue.sort();
+	TransparentRenderQueue.sort();
+	TransparentEffectRenderQueue.sort();
+	AccumulatedRenderQueue.sort();
+
+	// replay the sorted queues for each view, the camera pass renders its camera
+	for (i=0; i<views.size(); ++i)
+	{
+		IRR_PROFILE_SCOPE("drawAllViews: view");
+
+		ActiveCamera = views[i].Camera;
+		CameraList.set_used(0);
+		CameraList.push_back(views[i].Camera);
+		Driver->setViewPort(views[i].ViewPort);
+
+		// the shadow maps of the first view stay bound for the others
+		drawRegisteredNodes(i == 0);
+	}
+
+	Driver->setViewPort(viewPort);
+	ActiveCamera = activeCamera;
+	camWorldPos = ActiveCamera ? ActiveCamera->getAbsolutePosition() : core::vector3df(0,0,0);
+
+	endDrawAll(postProcess);
+}
+
+
+//! draws all scene nodes into the faces of a cubemap
+void CSceneManager::drawAllToCubemap(video::IRenderTarget* target, const core::vector3df& position,
+	f32 nearValue, f32 farValue, u32 faces, video::SColor clearColor)
+{
+	if (!Driver || !target || !(faces & 0x3f))
+		return;
+
+	const core::array<video::ITexture*>& textures = target->getTexture();
+	if (textures.size() != 1 || !textures[0] || textures[0]->getType() != video::ETT_CUBEMAP)
+	{
+		os::Printer::log("Could not draw scene to cubemap, the render target needs one cubemap texture.", ELL_ERROR);
+		return;
+	}
+	video::ITexture* const cubemap = textures[0];
+	video::ITexture* const depthStencil = target->getDepthStencil();
+
+	IRR_PROFILE_SCOPE("CSceneManager::drawAllToCubemap");
+
+	// the nodes keep the animation of the frame, so the faces match it
+	beginDrawAll(false);
+
+	// the faces in the order of E_CUBE_SURFACE
+	static const core::vector3df faceTargets[6] = {
+		core::vector3df(1.f, 0.f, 0.f), core::vector3df(-1.f, 0.f, 0.f),
+		core::vector3df(0.f, 1.f, 0.f), core::vector3df(0.f, -1.f, 0.f),
+		core::vector3df(0.f, 0.f, 1.f), core::vector3df(0.f, 0.f, -1.f) };
+	static const core::vector3df faceUps[6] = {
+		core::vector3df(0.f, 1.f, 0.f), core::vector3df(0.f, 1.f, 0.f),
+		core::vector3df(0.f, 0.f, -1.f), core::vector3df(0.f, 0.f, 1.f),
+		core::vector3df(0.f, 1.f, 0.f), core::vector3df(0.f, 1.f, 0.f) };
+
+	core::aabbox3df box(position);
+	u32 face;
+	for (face=0; face<6; ++face)
+	{
+		if (!CubemapCameras[face])
+			CubemapCameras[face] = new CCameraSceneNode(0, this, -1);
+		ICameraSceneNode* camera = CubemapCameras[face];
+		camera->setFOV(core::HALF_PI);
+		camera->setAspectRatio(1.f);
+		camera->setNearValue(nearValue);
+		camera->setFarValue(farValue);
+		camera->setPosition(position);
+		camera->setTarget(position + faceTargets[face]);
+		camera->setUpVector(faceUps[face]);
+		camera->updateAbsolutePosition();
+		camera->updateMatrices();
+		CubemapFrusta[face] = camera->getViewFrustum()->getPackedPlanes();
+		if (faces & (1 << face))
+			box.addInternalBox(camera->getViewFrustum()->getBoundingBox());
+	}
+
+	// the nodes of all faces are culled and register at once, within the box
+	// enclosing the frusta of the drawn faces
+	ICameraSceneNode* const activeCamera = ActiveCamera;
+	if (!ViewsCamera)
+		ViewsCamera = new CSceneViewsCamera(this);
+	ViewsCamera->setBox(CubemapCameras[0], box);
+	ActiveCamera = ViewsCamera;
+	camWorldPos = position;
+
+	registerNodes(false);
+
+	Driver->beginGPUTimerScope("cubemap");
+
+	SolidRenderQueue.sort();
+	TransparentRenderQueue.sort();
+	TransparentEffectRenderQueue.sort();
+	AccumulatedRenderQueue.sort();
+
+	// replay the sorted queues for each face, drawing the entries it sees
+	video::IRenderTarget* const renderTarget = Driver->getCurrentRenderTarget();
+	bool first = true;
+	for (face=0; face<6; ++face)
+	{
+		if (!(faces & (1 << face)))
+			continue;
+
+		IRR_PROFILE_SCOPE("drawAllToCubemap: face");
+
+		ActiveCamera = CubemapCameras[face];
+		CameraList.set_used(0);
+		CameraList.push_back(CubemapCameras[face]);
+		CubemapFaceBit = (u8)(1 << face);
+
+		target->setTexture(cubemap, depthStencil, (video::E_CUBE_SURFACE)face);
+		Driver->setRenderTargetEx(target, video::ECBF_ALL, clearColor);
+
+		// the shadow maps of the first face stay bound for the others
+		drawRegisteredNodes(first);
+		first = false;
+	}
+	CubemapFaceBit = 0;
+
+	Driver->setRenderTargetEx(renderTarget, 0);
+	ActiveCamera = activeCamera;
+	camWorldPos = ActiveCamera ? ActiveCamera->getAbsolutePosition() : core::vector3df(0,0,0);
+
+	clearRenderQueues();
+	ShadowMaps.clearCasters();
+	GuiNodeList.set_used(0);
+	Driver->endGPUTimerScope();
+
+	clearDeletionList();
+
+	CurrentRenderPass = ESNRP_NONE;
+}
+
+
+//! resets the driver state, animates the nodes unless needsRedraw() did
+void CSceneManager::beginDrawAll(bool animateNodes)
+{
+	u32 i;
 
 	// reset all transforms
 	Driver->setMaterial(video::SMaterial());
@@ -526,102 +1701,473 @@ void CSceneManager::drawAll()
 	Driver->setTransform ( video::ETS_WORLD, core::IdentityMatrix );
 	for (i=video::ETS_COUNT-1; i>=video::ETS_TEXTURE_0; --i)
 		Driver->setTransform ( (video::E_TRANSFORMATION_STATE)i, core::IdentityMatrix );
-	// TODO: This should not use an attribute here but a real parameter when necessary (too slow!)
-	Driver->setAllowZWriteOnTransparent(Parameters->getAttributeAsBool(ALLOW_ZWRITE_ON_TRANSPARENT));
+	if (ParameterGeneration != Parameters->getHandleGeneration())
+	{
+		AllowZWriteParameter = Parameters->getAttributeHandle(ALLOW_ZWRITE_ON_TRANSPARENT);
+		FractionalTimeParameter = Parameters->getAttributeHandle(FRACTIONAL_ANIMATION_TIME);
+		ParameterGeneration = Parameters->getHandleGeneration();
+	}
+	Driver->setAllowZWriteOnTransparent(Parameters->getBool(AllowZWriteParameter));
+
+	if (!animateNodes)
+		return;
+
+	if (FrameAnimated)
+		FrameAnimated = false;
+	else
+		animate();
+	Invalidated = false;
+}
+
+
+//! publishes loaded meshes and animates the nodes
+void CSceneManager::animate()
+{
+	// publish the meshes loaded in the background
+	if (!MeshLoads.empty())
+	{
+		const u32 loads = MeshLoads.size();
+		finishMeshLoads();
+		if (MeshLoads.size() != loads)
+			Invalidated = true;
+	}
 
 	// do animations and other stuff.
-	OnAnimate(os::Timer::getTime());
+	const u64 timeNs = os::Timer::getTimeNs();
+	const u32 timeMs = (u32)(timeNs / 1000000);
+	AnimationTimeNs = Parameters->getBool(FractionalTimeParameter) ? timeNs : 0;
+	{
+		IRR_PROFILE_SCOPE("OnAnimate");
+		if (UpdateJobs)
+			animateParallel(timeMs);
+		else
+			OnAnimate(timeMs);
+	}
+}
 
-	/*!
-		First Scene Node for prerendering should be the active camera
-		consistent Camera is needed for culling
-	*/
-	camWorldPos.set(0,0,0);
+
+//! culls the nodes against the active camera and lets the visible ones register
+void CSceneManager::registerNodes(bool occlusion)
+{
+	// without occlusion culling isCulled doesn't see the buffer
+	CSceneOcclusionBuffer* const occlusionBuffer = OcclusionBuffer;
+	if (!occlusion)
+		OcclusionBuffer = 0;
+
+	// cull all nodes at once, before they register themselves
 	if (ActiveCamera)
 	{
-		ActiveCamera->render();
-		camWorldPos = ActiveCamera->getAbsolutePosition();
+		IRR_PROFILE_SCOPE("drawAll: culling");
+		CullingBatch.begin(ActiveCamera);
+		if (NodeIndex)
+		{
+			// the others are culled by their box in isCulled
+			CullingCandidates.set_used(0);
+			NodeIndex->getNodesInBox(ActiveCamera->getViewFrustum()->getBoundingBox(), CullingCandidates);
+			for (u32 j = 0; j < CullingCandidates.size(); ++j)
+			{
+				CullingBatch.add(CullingCandidates[j]);
+				if (OcclusionBuffer && (CullingCandidates[j]->getAutomaticCulling() & EAC_OCCLUDER) &&
+						CullingCandidates[j]->isTrulyVisible())
+					Occluders.push_back(CullingCandidates[j]);
+			}
+		}
+		else
+		{
+			gatherNodesForCulling(this);
+		}
+		CullingBatch.process();
+
+		if (OcclusionBuffer)
+			rasterizeOccluders();
+	}
+
+	// skinning waits for the culling, the nodes register once it is done
+	if (UpdateJobs)
+	{
+		IRR_PROFILE_SCOPE("drawAll: skinning");
+		skinParallel();
 	}
 
 	// let all nodes register themselves
-	OnRegisterSceneNode();
+	{
+		IRR_PROFILE_SCOPE("OnRegisterSceneNode");
+		OnRegisterSceneNode();
+		BillboardBatch.build(SolidRenderQueue, TransparentRenderQueue);
+	}
+
+	CullingBatch.clear();
+	if (OcclusionBuffer)
+		OcclusionBuffer->clear();
+	OcclusionBuffer = occlusionBuffer;
+}
+
+
+//! draws the registered nodes with the active camera into the viewport
+void CSceneManager::drawRegisteredNodes(bool shadows)
+{
+	u32 i;
 
 	//render camera scenes
 	{
 		CurrentRenderPass = ESNRP_CAMERA;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
+		Driver->beginGPUTimerScope("camera");
+		IRR_PROFILE_SCOPE("drawAll: camera");
 
 		for (i=0; i<CameraList.size(); ++i)
 			CameraList[i]->render();
 
-		CameraList.set_used(0);
+		Driver->endGPUTimerScope();
+	}
+
+	// bin the lights into the clusters of the camera view
+	if (LightClusters.hasWork())
+	{
+		CurrentRenderPass = ESNRP_LIGHT;
+		IRR_PROFILE_SCOPE("drawAll: light");
+
+		LightClusters.build(ActiveCamera, UpdateJobs);
+		LightClusters.upload(Driver);
 	}
 
 	// render skyboxes
 	{
 		CurrentRenderPass = ESNRP_SKY_BOX;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
+		Driver->beginGPUTimerScope("skybox");
+		IRR_PROFILE_SCOPE("drawAll: skybox");
 
 		for (i=0; i<SkyBoxList.size(); ++i)
 			SkyBoxList[i]->render();
 
-		SkyBoxList.set_used(0);
+		Driver->endGPUTimerScope();
 	}
 
-	// render default objects
+	// render the shadow casters into the shadow maps
+	if (shadows && ShadowMapping)
 	{
-		CurrentRenderPass = ESNRP_SOLID;
+		CurrentRenderPass = ESNRP_SHADOW;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
+		Driver->beginGPUTimerScope("shadow");
+		IRR_PROFILE_SCOPE("drawAll: shadow");
 
-		SolidNodeList.sort(); // sort by textures
+		ShadowMaps.draw(Driver, ActiveCamera);
 
-		for (i=0; i<SolidNodeList.size(); ++i)
-			SolidNodeList[i].Node->render();
+		ShadowMaps.clearCasters();
+		Driver->endGPUTimerScope();
+	}
 
-		SolidNodeList.set_used(0);
+	// render the depth of the default objects, then shade only what is visible
+	const bool depthPrepass = DepthPrepass && SolidRenderQueue.size() != 0;
+	video::SOverrideMaterial& overrideMaterial = Driver->getOverrideMaterial();
+	video::SOverrideMaterial solidOverride;
+	if (depthPrepass)
+	{
+		// the user's overrides for the solid pass apply to both passes, so
+		// their depth matches
+		solidOverride = overrideMaterial;
+		if (!(overrideMaterial.EnablePasses & ESNRP_SOLID))
+			overrideMaterial.reset();
+		overrideMaterial.Enabled = true;
+		overrideMaterial.EnablePasses = solidOverride.EnablePasses;
+
+		CurrentRenderPass = ESNRP_DEPTH_PREPASS;
+		Driver->beginGPUTimerScope("depth prepass");
+		IRR_PROFILE_SCOPE("drawAll: depth prepass");
+
+		const u32 flags = overrideMaterial.EnableFlags;
+		const u8 colorMask = overrideMaterial.Material.ColorMask;
+		overrideMaterial.EnableFlags |= video::EMF_COLOR_MASK;
+		overrideMaterial.Material.ColorMask = video::ECP_NONE;
+
+		drawRenderQueue(SolidRenderQueue, SolidFaceMasks);
+
+		overrideMaterial.EnableFlags = flags | video::EMF_ZBUFFER | video::EMF_ZWRITE_ENABLE;
+		overrideMaterial.Material.ColorMask = colorMask;
+		overrideMaterial.Material.ZBuffer = video::ECFN_EQUAL;
+		overrideMaterial.Material.ZWriteEnable = video::EZW_OFF;
+		Driver->endGPUTimerScope();
+	}
+
+	// render default objects
+	{
+		CurrentRenderPass = ESNRP_SOLID;
+		if (!depthPrepass)
+			Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
+		Driver->beginGPUTimerScope("solid");
+		IRR_PROFILE_SCOPE("drawAll: solid");
+
+		drawRenderQueue(SolidRenderQueue, SolidFaceMasks);
+
+		if (depthPrepass)
+			overrideMaterial = solidOverride;
+		Driver->endGPUTimerScope();
 	}
 
 	// render transparent objects.
 	{
 		CurrentRenderPass = ESNRP_TRANSPARENT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
+		Driver->beginGPUTimerScope("transparent");
+		IRR_PROFILE_SCOPE("drawAll: transparent");
+
+		// the accumulated entries blend in any order, the sorted ones are drawn over them
+		if (AccumulatedRenderQueue.size())
+		{
+			if (Driver->beginTransparencyAccumulation())
+			{
+				drawRenderQueue(AccumulatedRenderQueue, AccumulatedFaceMasks);
+				Driver->endTransparencyAccumulation();
+			}
+			else
+				sortAccumulatedTransparency();
+		}
 
-		TransparentNodeList.sort(); // sort by distance from camera
-		for (i=0; i<TransparentNodeList.size(); ++i)
-			TransparentNodeList[i].Node->render();
+		drawRenderQueue(TransparentRenderQueue, TransparentFaceMasks);
 
-		TransparentNodeList.set_used(0);
+		Driver->endGPUTimerScope();
 	}
 
 	// render transparent effect objects.
 	{
 		CurrentRenderPass = ESNRP_TRANSPARENT_EFFECT;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
+		Driver->beginGPUTimerScope("effect");
+		IRR_PROFILE_SCOPE("drawAll: effect");
+
+		drawRenderQueue(TransparentEffectRenderQueue, EffectFaceMasks);
+
+		Driver->endGPUTimerScope();
+	}
+}
 
-		TransparentEffectNodeList.sort(); // sort by distance from camera
 
-		for (i=0; i<TransparentEffectNodeList.size(); ++i)
-			TransparentEffectNodeList[i].Node->render();
+//! clears the drawn nodes, post-processes the scene and draws the gui nodes
+void CSceneManager::endDrawAll(bool postProcess)
+{
+	clearRenderQueues();
 
-		TransparentEffectNodeList.set_used(0);
+	// draw the post-processing passes, the gui nodes stay unprocessed
+	if (postProcess)
+	{
+		CurrentRenderPass = ESNRP_NONE;
+		Driver->getOverrideMaterial().Enabled = false;
+		Driver->beginGPUTimerScope("post process");
+		IRR_PROFILE_SCOPE("drawAll: post process");
+
+		PostProcessChain->end();
+		Driver->endGPUTimerScope();
 	}
 
 	// render custom gui nodes
 	{
 		CurrentRenderPass = ESNRP_GUI;
 		Driver->getOverrideMaterial().Enabled = ((Driver->getOverrideMaterial().EnablePasses & CurrentRenderPass) != 0);
+		Driver->beginGPUTimerScope("gui nodes");
+		IRR_PROFILE_SCOPE("drawAll: gui nodes");
 
-		for (i=0; i<GuiNodeList.size(); ++i)
+		for (u32 i=0; i<GuiNodeList.size(); ++i)
 			GuiNodeList[i]->render();
 
 		GuiNodeList.set_used(0);
+		Driver->endGPUTimerScope();
 	}
+	Driver->endGPUTimerScope();
+
 	clearDeletionList();
 
+	if (TrackChanges)
+		DrawnSignature = getSceneSignature();
+
 	CurrentRenderPass = ESNRP_NONE;
 }
 
 
+//! clears the nodes registered for the render passes of the drawn scene
+void CSceneManager::clearRenderQueues()
+{
+	CameraList.set_used(0);
+	SkyBoxList.set_used(0);
+	SolidRenderQueue.clear();
+	TransparentRenderQueue.clear();
+	TransparentEffectRenderQueue.clear();
+	AccumulatedRenderQueue.clear();
+	BillboardBatch.clear();
+	LightClusters.clearLights();
+	SolidFaceMasks.set_used(0);
+	TransparentFaceMasks.set_used(0);
+	EffectFaceMasks.set_used(0);
+	AccumulatedFaceMasks.set_used(0);
+}
+
+
+//! animates the scene and tells if it changed since it was drawn
+bool CSceneManager::needsRedraw()
+{
+	IRR_PROFILE_SCOPE("CSceneManager::needsRedraw");
+
+	TrackChanges = true;
+	animate();
+	FrameAnimated = true;
+
+	return Invalidated || !DeletionList.empty() || getSceneSignature() != DrawnSignature;
+}
+
+
+//! makes needsRedraw() return true until the scene is drawn again
+void CSceneManager::invalidate()
+{
+	Invalidated = true;
+}
+
+
+namespace
+{
+	inline void hashSignature(u64& hash, u64 value)
+	{
+		hash = (hash ^ value) * 0x100000001b3ULL;
+	}
+
+	inline void hashSignature(u64& hash, const core::matrix4& matrix)
+	{
+		for (u32 i = 0; i < 16; ++i)
+			hashSignature(hash, core::IR(matrix[i]));
+	}
+}
+
+
+//! hash of the state needsRedraw() compares
+u64 CSceneManager::getSceneSignature()
+{
+	u64 hash = 0xcbf29ce484222325ULL;
+	hashSignature(hash, (u64)(size_t)ActiveCamera);
+	addSceneSignature(this, hash);
+	return hash;
+}
+
+
+//! adds the nodes below node to the hash of getSceneSignature()
+void CSceneManager::addSceneSignature(ISceneNode* node, u64& hash)
+{
+	const ISceneNodeList& children = node->getChildren();
+	for (u32 i = 0; i < children.size(); ++i)
+	{
+		ISceneNode* child = children[i];
+		hashSignature(hash, (u64)(size_t)child);
+		hashSignature(hash, ((u64)child->getTransformRevision() << 1) | (child->isVisible() ? 1 : 0));
+		if (!child->isVisible())
+			continue;
+
+		switch (child->getType())
+		{
+		case ESNT_ANIMATED_MESH:
+			hashSignature(hash, core::IR(static_cast<IAnimatedMeshSceneNode*>(child)->getFrameNr()));
+			break;
+		case ESNT_CAMERA:
+			{
+				// animators move the target, which only the matrices reflect
+				ICameraSceneNode* camera = static_cast<ICameraSceneNode*>(child);
+				camera->updateMatrices();
+				hashSignature(hash, camera->getViewMatrix());
+				hashSignature(hash, camera->getProjectionMatrix());
+			}
+			break;
+		default:
+			break;
+		}
+
+		addSceneSignature(child, hash);
+	}
+}
+
+//! Renders a mesh from several directions into one texture, for impostors.
+video::ITexture* CSceneManager::createImpostorTexture(IMesh* mesh, u32 views, u32 viewSize, const io::path& name)
+{
+	if (!mesh || !views || !viewSize)
+		return 0;
+
+	const core::aabbox3df& box = mesh->getBoundingBox();
+	const core::vector3df center = box.getCenter();
+	const f32 radius = box.getExtent().getLength() * 0.5f;
+	if (radius <= 0.f)
+		return 0;
+
+	const u32 columns = (u32)ceilf(sqrtf((f32)views));
+	const u32 rows = (views + columns - 1) / columns;
+	const core::dimension2du size(columns * viewSize, rows * viewSize);
+
+	video::ITexture* color = Driver->addRenderTargetTexture(size, "IRR_IMPOSTOR", video::ECF_A8R8G8B8);
+	video::ITexture* depth = Driver->addRenderTargetTexture(size, "IRR_IMPOSTOR_DEPTH", video::ECF_D16);
+	video::IRenderTarget* target = (color && depth) ? Driver->addRenderTarget() : 0;
+	if (!target)
+	{
+		os::Printer::log("Could not create render target for impostor", name, ELL_ERROR);
+		if (color)
+			Driver->removeTexture(color);
+		if (depth)
+			Driver->removeTexture(depth);
+		return 0;
+	}
+	target->setTexture(color, depth);
+
+	video::IRenderTarget* previousTarget = Driver->getCurrentRenderTarget();
+	const core::recti previousViewPort = Driver->getViewPort();
+	const core::matrix4 previousTransforms[] = {Driver->getTransform(video::ETS_VIEW),
+		Driver->getTransform(video::ETS_WORLD), Driver->getTransform(video::ETS_PROJECTION)};
+	const bool previousReverseDepth = Driver->isReverseDepth();
+	Driver->setReverseDepth(false);
+
+	Driver->setRenderTargetEx(target, video::ECBF_COLOR | video::ECBF_DEPTH, video::SColor(0,0,0,0));
+
+	// the camera is outside of the bounding sphere, which fills each cell
+	core::matrix4 projection;
+	projection.buildProjectionMatrixOrthoLH(radius * 2.f, radius * 2.f, radius * 0.5f, radius * 3.5f);
+	Driver->setTransform(video::ETS_PROJECTION, projection);
+	Driver->setTransform(video::ETS_WORLD, core::IdentityMatrix);
+
+	const f32 step = 2.f * core::PI / views;
+	for (u32 i=0; i<views; ++i)
+	{
+		const s32 x = (i % columns) * viewSize;
+		const s32 y = (i / columns) * viewSize;
+		Driver->setViewPort(core::recti(x, y, x + viewSize, y + viewSize));
+
+		const core::vector3df direction(sinf(i * step), 0.f, -cosf(i * step));
+		core::matrix4 view;
+		view.buildCameraLookAtMatrixLH(center + direction * (radius * 2.f), center, core::vector3df(0.f, 1.f, 0.f));
+		Driver->setTransform(video::ETS_VIEW, view);
+
+		for (u32 j=0; j<mesh->getMeshBufferCount(); ++j)
+		{
+			IMeshBuffer* mb = mesh->getMeshBuffer(j);
+			Driver->setMaterial(mb->getMaterial());
+			Driver->drawMeshBuffer(mb);
+		}
+	}
+
+	Driver->setRenderTargetEx(previousTarget, 0);
+	Driver->setViewPort(previousViewPort);
+	Driver->setTransform(video::ETS_VIEW, previousTransforms[0]);
+	Driver->setTransform(video::ETS_WORLD, previousTransforms[1]);
+	Driver->setTransform(video::ETS_PROJECTION, previousTransforms[2]);
+	Driver->setReverseDepth(previousReverseDepth);
+
+	// render target textures have no mipmaps and are stored bottom up,
+	// so the views are copied into an ordinary texture
+	video::IImage* image = Driver->createImage(color, core::position2di(0, 0), size);
+	Driver->removeRenderTarget(target);
+	Driver->removeTexture(color);
+	Driver->removeTexture(depth);
+	if (!image)
+		return 0;
+
+	video::ITexture* texture = Driver->addTexture(name, image);
+	image->drop();
+	return texture;
+}
+
+
 //! Adds an external mesh loader.
 void CSceneManager::addExternalMeshLoader(IMeshLoader* externalLoader)
 {
@@ -697,7 +2243,22 @@ ISceneNode* CSceneManager::getSceneNodeFromName(const char* name, ISceneNode* st
 	if (start == 0)
 		start = getRootSceneNode();
 
-	if (!strcmp(start->getName(),name))
+	// node names are interned, no node has a name which isn't
+	const core::atom key = core::atom::find(name);
+	if (key.empty() && name && name[0])
+		return 0;
+
+	if (canUseNodeRegistry(start))
+		return getRegisteredNodeBelow(NodeRegistry->getNodesFromName(key), start);
+
+	return getSceneNodeFromAtom(key, start);
+}
+
+
+//! returns the first node below start with an interned name
+ISceneNode* CSceneManager::getSceneNodeFromAtom(const core::atom& name, ISceneNode* start)
+{
+	if (start->getNameAtom() == name)
 		return start;
 
 	ISceneNode* node = 0;
@@ -706,7 +2267,7 @@ ISceneNode* CSceneManager::getSceneNodeFromName(const char* name, ISceneNode* st
 	ISceneNodeList::const_iterator it = list.begin();
 	for (; it!=list.end(); ++it)
 	{
-		node = getSceneNodeFromName(name, *it);
+		node = getSceneNodeFromAtom(name, *it);
 		if (node)
 			return node;
 	}
@@ -715,6 +2276,38 @@ ISceneNode* CSceneManager::getSceneNodeFromName(const char* name, ISceneNode* st
 }
 
 
+//! checks if node is start or below it
+static bool isNodeBelow(const ISceneNode* node, const ISceneNode* start)
+{
+	for (; node; node = node->getParent())
+	{
+		if (node == start)
+			return true;
+	}
+	return false;
+}
+
+
+//! returns the first of the registered nodes which is start or below it
+ISceneNode* CSceneManager::getRegisteredNodeBelow(const std::vector<ISceneNode*>* nodes, ISceneNode* start) const
+{
+	if (!nodes)
+		return 0;
+
+	// all registered nodes are below the root
+	if (start == this)
+		return nodes->front();
+
+	for (size_t i=0; i<nodes->size(); ++i)
+	{
+		if (isNodeBelow((*nodes)[i], start))
+			return (*nodes)[i];
+	}
+
+	return 0;
+}
+
+
 //! Returns the first scene node with the specified id.
 ISceneNode* CSceneManager::getSceneNodeFromId(s32 id, ISceneNode* start)
 {
@@ -724,6 +2317,9 @@ ISceneNode* CSceneManager::getSceneNodeFromId(s32 id, ISceneNode* start)
 	if (start->getID() == id)
 		return start;
 
+	if (canUseNodeRegistry(start))
+		return getRegisteredNodeBelow(NodeRegistry->getNodesFromId(id), start);
+
 	ISceneNode* node = 0;
 
 	const ISceneNodeList& list = start->getChildren();
@@ -748,6 +2344,9 @@ ISceneNode* CSceneManager::getSceneNodeFromType(scene::ESCENE_NODE_TYPE type, IS
 	if (start->getType() == type || ESNT_ANY == type)
 		return start;
 
+	if (canUseNodeRegistry(start))
+		return getRegisteredNodeBelow(NodeRegistry->getNodesFromType(type), start);
+
 	ISceneNode* node = 0;
 
 	const ISceneNodeList& list = start->getChildren();
@@ -769,6 +2368,21 @@ void CSceneManager::getSceneNodesFromType(ESCENE_NODE_TYPE type, core::array<sce
 	if (start == 0)
 		start = getRootSceneNode();
 
+	// all nodes are visited anyway for ESNT_ANY
+	if (ESNT_ANY != type && canUseNodeRegistry(start))
+	{
+		const std::vector<ISceneNode*>* nodes = NodeRegistry->getNodesFromType(type);
+		if (!nodes)
+			return;
+
+		for (size_t i=0; i<nodes->size(); ++i)
+		{
+			if (isNodeBelow((*nodes)[i], start))
+				outNodes.push_back((*nodes)[i]);
+		}
+		return;
+	}
+
 	if (start->getType() == type || ESNT_ANY == type)
 		outNodes.push_back(start);
 
@@ -827,6 +2441,15 @@ E_SCENE_NODE_RENDER_PASS CSceneManager::getSceneNodeRenderPass() const
 }
 
 
+//! Returns the sub-millisecond part of the time the scene is animated with
+f32 CSceneManager::getAnimationTimeFraction(u32 timeMs) const
+{
+	if ((u32)(AnimationTimeNs / 1000000) != timeMs)
+		return 0.f;
+	return (f32)(AnimationTimeNs % 1000000) / 1000000.f;
+}
+
+
 //! Returns an interface to the mesh cache which is shared between all existing scene managers.
 IMeshCache* CSceneManager::getMeshCache()
 {
@@ -837,7 +2460,7 @@ IMeshCache* CSceneManager::getMeshCache()
 //! Creates a new scene manager.
 ISceneManager* CSceneManager::createNewSceneManager(bool cloneContent)
 {
-	CSceneManager* manager = new CSceneManager(Driver, CursorControl, MeshCache);
+	CSceneManager* manager = new CSceneManager(Driver, FileSystem, CursorControl, MeshCache);
 
 	if (cloneContent)
 		manager->cloneMembers(this, manager);
@@ -869,14 +2492,20 @@ ISkinnedMesh* CSceneManager::createSkinnedMesh()
 //! Returns a mesh writer implementation if available
 IMeshWriter* CSceneManager::createMeshWriter(EMESH_WRITER_TYPE type)
 {
-	return 0;
+	switch (type)
+	{
+	case EMWT_IRB:
+		return new CIRBMeshWriter();
+	default:
+		return 0;
+	}
 }
 
 
 // creates a scenemanager
-ISceneManager* createSceneManager(video::IVideoDriver* driver, gui::ICursorControl* cursorcontrol)
+ISceneManager* createSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs, gui::ICursorControl* cursorcontrol)
 {
-	return new CSceneManager(driver, cursorcontrol, nullptr);
+	return new CSceneManager(driver, fs, cursorcontrol, nullptr);
 }
 
 
@@ -12,6 +12,21 @@
 #include "irrArray.h"
 #include "IMeshLoader.h"
 #include "CAttributes.h"
+#include "CSceneCullingBatch.h"
+#include "CSceneOcclusionBuffer.h"
+#include "CRenderQueue.h"
+#include "CBillboardBatch.h"
+#include "CShadowMapPass.h"
+#include "CLightClusters.h"
+#include "CJobSystem.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "CSceneNodeSpatialIndex.h"
+#include "CSceneNodeRegistry.h"
 
 namespace irr
 {
@@ -22,6 +37,8 @@ namespace io
 namespace scene
 {
 	class IMeshCache;
+	class CMeshLoadRequest;
+	class CSceneViewsCamera;
 
 	/*!
 		The Scene Manager manages scene nodes, mesh resources, cameras and all the other stuff.
@@ -31,7 +48,7 @@ namespace scene
 	public:
 
 		//! constructor
-		CSceneManager(video::IVideoDriver* driver, gui::ICursorControl* cursorControl, IMeshCache* cache = 0);
+		CSceneManager(video::IVideoDriver* driver, io::IFileSystem* fs, gui::ICursorControl* cursorControl, IMeshCache* cache = 0);
 
 		//! destructor
 		virtual ~CSceneManager();
@@ -39,6 +56,15 @@ namespace scene
 		//! gets an animateable mesh. loads it if needed. returned pointer must not be dropped.
 		IAnimatedMesh* getMesh(io::IReadFile* file) override;
 
+		//! loads a mesh on the loading thread
+		IMeshLoadRequest* getMeshAsync(io::IReadFile* file) override;
+
+		//! sets a directory in which getMesh() caches skinned meshes
+		void setMeshCacheDirectory(const io::path& directory) override;
+
+		//! records a texture file a mesh file refers to, for mesh loaders
+		video::ITexture* addMeshTextureReference(const io::path& name) override;
+
 		//! Returns an interface to the mesh cache which is shared between all existing scene managers.
 		IMeshCache* getMeshCache() override;
 
@@ -60,6 +86,29 @@ namespace scene
 			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
 			bool alsoAddIfMeshPointerZero=false) override;
 
+		//! adds a scene node for rendering many instances of a static mesh
+		//! the returned pointer must not be dropped.
+		IInstancedMeshSceneNode* addInstancedMeshSceneNode(IMesh* mesh, ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			bool alsoAddIfMeshPointerZero=false) override;
+
+		//! adds a scene node for large world geometry made of chunk meshes
+		//! the returned pointer must not be dropped.
+		IChunkGridSceneNode* addChunkGridSceneNode(ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f)) override;
+
+		//! adds a scene node merging many static mesh scene nodes into few large buffers
+		//! the returned pointer must not be dropped.
+		IStaticBatchSceneNode* addStaticBatchSceneNode(ISceneNode* parent=0, s32 id=-1,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f),
+			f32 cellSize=100.f) override;
+
 		//! renders the node.
 		void render() override;
 
@@ -69,12 +118,36 @@ namespace scene
 		//! registers a node for rendering it at a specific time.
 		u32 registerNodeForRendering(ISceneNode* node, E_SCENE_NODE_RENDER_PASS pass = ESNRP_AUTOMATIC) override;
 
+		//! registers a solid mesh buffer of a node for rendering.
+		void registerMeshBufferForRendering(ISceneNode* node, IMeshBuffer* meshBuffer, const video::SMaterial& material,
+			E_SCENE_NODE_RENDER_PASS pass = ESNRP_SOLID) override;
+
+		//! registers a camera facing quad, batched with the others of its material
+		void registerBillboardForRendering(const video::SMaterial& material, const video::S3DVertex* vertices) override;
+
 		//! Clear all nodes which are currently registered for rendering
 		void clearAllRegisteredNodesForRendering() override;
 
 		//! draws all scene nodes
 		void drawAll() override;
 
+		//! draws all scene nodes as seen by several cameras
+		void drawAllViews(const core::array<SSceneView>& views) override;
+
+		//! draws all scene nodes into the faces of a cubemap
+		void drawAllToCubemap(video::IRenderTarget* target, const core::vector3df& position,
+			f32 nearValue, f32 farValue, u32 faces, video::SColor clearColor) override;
+
+		//! animates the scene and tells if it changed since it was drawn
+		bool needsRedraw() override;
+
+		//! makes needsRedraw() return true until the scene is drawn again
+		void invalidate() override;
+
+		//! Renders a mesh from several directions into one texture, for impostors.
+		video::ITexture* createImpostorTexture(IMesh* mesh, u32 views=8,
+			u32 viewSize=128, const io::path& name="impostor") override;
+
 		//! Adds a camera scene node to the tree and sets it as active camera.
 		//! \param position: Position of the space relative to its parent where the camera will be placed.
 		//! \param lookat: Position where the camera will look at. Also known as target.
@@ -98,6 +171,12 @@ namespace scene
 		virtual IDummyTransformationSceneNode* addDummyTransformationSceneNode(
 			ISceneNode* parent=0, s32 id=-1) override;
 
+		//! Adds a dynamic point light.
+		ILightSceneNode* addLightSceneNode(ISceneNode* parent = 0,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			video::SColorf color = video::SColorf(1.0f, 1.0f, 1.0f),
+			f32 radius = 100.0f, s32 id = -1) override;
+
 		//! Adds an empty scene node.
 		ISceneNode* addEmptySceneNode(ISceneNode* parent, s32 id=-1) override;
 
@@ -163,6 +242,9 @@ namespace scene
 		//! Returns current render pass.
 		E_SCENE_NODE_RENDER_PASS getSceneNodeRenderPass() const override;
 
+		//! Returns the sub-millisecond part of the time the scene is animated with
+		f32 getAnimationTimeFraction(u32 timeMs) const override;
+
 		//! Creates a new scene manager.
 		ISceneManager* createNewSceneManager(bool cloneContent) override;
 
@@ -190,58 +272,174 @@ namespace scene
 		//! returns if node is culled
 		bool isCulled(const ISceneNode* node) const override;
 
+		void setSpatialIndexEnabled(bool enable) override;
+
+		ISpatialIndex* getSpatialIndex() const override;
+
+		void setNodeRegistryEnabled(bool enable) override;
+
+		bool isNodeRegistryEnabled() const override { return NodeRegistry != 0; }
+
+		void setOcclusionCullingEnabled(bool enable) override;
+
+		bool isOcclusionCullingEnabled() const override { return OcclusionBuffer != 0; }
+
+		void setParallelUpdateEnabled(bool enable) override;
+
+		void setDepthPrepassEnabled(bool enable) override { DepthPrepass = enable; }
+
+		bool isDepthPrepassEnabled() const override { return DepthPrepass; }
+
+		void setOrderIndependentTransparencyEnabled(bool enable) override { OrderIndependentTransparency = enable; }
+
+		bool isOrderIndependentTransparencyEnabled() const override { return OrderIndependentTransparency; }
+
+		void setShadowMappingEnabled(bool enable) override;
+
+		bool isShadowMappingEnabled() const override { return ShadowMapping; }
+
+		void setShadowMapParameters(const SShadowMapParameters& parameters) override { ShadowMaps.setParameters(parameters); }
+
+		const SShadowMapParameters& getShadowMapParameters() const override { return ShadowMaps.getParameters(); }
+
+		video::ITexture* getShadowMap(u32 cascade) const override { return ShadowMaps.getTexture(cascade); }
+
+		const core::matrix4& getShadowMapMatrix(u32 cascade) const override { return ShadowMaps.getMatrix(cascade); }
+
+		f32 getShadowMapSplit(u32 cascade) const override { return ShadowMaps.getSplit(cascade); }
+
+		void invalidateShadowMaps() override { ShadowMaps.invalidate(); }
+
+		video::ITexture* getLightClusterTexture(E_LIGHT_CLUSTER_TEXTURE texture) const override { return LightClusters.getTexture(texture); }
+
+		u32 getVisibleLightCount() const override { return LightClusters.getVisibleLightCount(); }
+
+		void setPostProcessChain(video::IPostProcessChain* chain) override;
+
+		video::IPostProcessChain* getPostProcessChain() const override { return PostProcessChain; }
+
 	private:
 
 		// load and create a mesh which we know already isn't in the cache and put it in there
 		IAnimatedMesh* getUncachedMesh(io::IReadFile* file, const io::path& filename, const io::path& cachename);
 
+		//! creates a mesh with the first loader taking the file, MeshLoaderMutex has to be held
+		IAnimatedMesh* createMeshFromLoaders(io::IReadFile* file, const io::path& filename);
+
+		//! runs the OPTIMIZE_LOADED_MESHES pass on a mesh a loader created
+		void optimizeLoadedMesh(IAnimatedMesh* msh);
+
+		//! loads a mesh through the .irrbm files in MeshCacheDirectory, 0 if it is not set
+		IAnimatedMesh* createMeshThroughCache(io::IReadFile* file, const io::path& filename);
+
+		//! replaces the texture references in the materials of a mesh by the textures, drops the references
+		void resolveMeshTextures(IAnimatedMesh* msh, const io::path& filename, core::array<video::ITexture*>& references);
+
+		//! parses the files of the queued requests, runs on MeshLoadThread
+		void meshLoadLoop();
+
+		//! adds the meshes of the parsed requests to the mesh cache
+		void finishMeshLoads();
+
+		//! stops MeshLoadThread, the requests not finished yet fail
+		void stopMeshLoads();
+
 		//! clears the deletion list
 		void clearDeletionList();
 
-		struct DefaultNodeEntry
+		//! returns the first node below start with an interned name
+		ISceneNode* getSceneNodeFromAtom(const core::atom& name, ISceneNode* start);
+
+		//! checks if the lookups below start can use NodeRegistry
+		bool canUseNodeRegistry(const ISceneNode* start) const
 		{
-			DefaultNodeEntry()
-			{ }
+			return NodeRegistry && start->getNodeRegistry() == NodeRegistry;
+		}
 
-			DefaultNodeEntry(ISceneNode* n) :
-				Node(n), TextureValue(0)
-			{
-				if (n->getMaterialCount())
-					TextureValue = (n->getMaterial(0).getTexture(0));
-			}
+		//! returns the first of the registered nodes which is start or below it
+		ISceneNode* getRegisteredNodeBelow(const std::vector<ISceneNode*>* nodes, ISceneNode* start) const;
 
-			bool operator < (const DefaultNodeEntry& other) const
-			{
-				return (TextureValue < other.TextureValue);
-			}
+		//! adds the visible nodes below node to CullingBatch
+		void gatherNodesForCulling(const ISceneNode* node);
 
-			ISceneNode* Node;
-			private:
-			void* TextureValue;
-		};
+		//! rasterizes the gathered Occluders the culling batch didn't cull
+		void rasterizeOccluders();
 
-		//! sort on distance (center) to camera
-		struct TransparentNodeEntry
-		{
-			TransparentNodeEntry()
-			{ }
+		//! checks a node with automatic culling against the OcclusionBuffer
+		bool isOccluded(const ISceneNode* node, const ICameraSceneNode* cam) const;
 
-			TransparentNodeEntry(ISceneNode* n, const core::vector3df& camera)
-				: Node(n)
-			{
-				Distance = Node->getAbsoluteTransformation().getTranslation().getDistanceFromSQ(camera);
-			}
+		//! distance of a node from the camera, relative to the far plane
+		f32 getRelativeDepth(const ISceneNode* node) const;
 
-			bool operator < (const TransparentNodeEntry& other) const
-			{
-				return Distance > other.Distance;
-			}
+		//! squared distance of the center of the transformed box of a node from the camera
+		f32 getBoxDistanceSQ(const ISceneNode* node) const;
+
+		//! squared distance of the center of the box of a mesh buffer, transformed by its node, from the camera
+		f32 getMeshBufferDistanceSQ(const ISceneNode* node, const IMeshBuffer* meshBuffer) const;
+
+		//! checks if the driver can accumulate all materials of a node drawing itself
+		bool canAccumulateTransparency(ISceneNode* node) const;
+
+		//! registers a transparent node drawing itself, unsorted if the driver can accumulate it
+		void addTransparentNode(ISceneNode* node);
+
+		//! moves the accumulated transparent entries into the sorted ones, for a driver failing to accumulate them
+		void sortAccumulatedTransparency();
 
+		//! resets the driver state, animates the nodes unless needsRedraw() did
+		//! \param animateNodes false keeps the nodes as the last frame animated them
+		void beginDrawAll(bool animateNodes);
+
+		//! publishes loaded meshes and animates the nodes
+		void animate();
+
+		//! hash of the state needsRedraw() compares
+		u64 getSceneSignature();
+
+		//! adds the nodes below node to the hash of getSceneSignature()
+		void addSceneSignature(ISceneNode* node, u64& hash);
+
+		//! culls the nodes against the active camera and lets the visible ones register
+		void registerNodes(bool occlusion);
+
+		//! draws the registered nodes with the active camera into the viewport
+		//! \param shadows also renders the shadow maps for the active camera
+		void drawRegisteredNodes(bool shadows);
+
+		//! clears the drawn nodes, post-processes the scene and draws the gui nodes
+		void endDrawAll(bool postProcess);
+
+		//! clears the nodes registered for the render passes of the drawn scene
+		void clearRenderQueues();
+
+		//! draws the entries of a sorted render queue
+		//! \param faceMasks faces of drawAllToCubemap() seeing each entry, filled on first use
+		template <class TQueue>
+		void drawRenderQueue(const TQueue& queue, core::array<u8>& faceMasks);
+
+		//! sets the bits of the cubemap faces whose frustum sees each entry of queue
+		template <class TQueue>
+		void buildFaceMasks(const TQueue& queue, core::array<u8>& faceMasks);
+
+		//! calls OnAnimate of the children on UpdateJobs, gathering the nodes to skin
+		void animateParallel(u32 timeMs);
+
+		//! skins the gathered nodes not sharing their mesh and not culled on UpdateJobs,
+		//! and the shared copies of the others split into jobs
+		void skinParallel();
+
+		struct SAnimateJob
+		{
 			ISceneNode* Node;
-			private:
-				f64 Distance;
+			u32 TimeMs;
+			//! visible skinned animated mesh nodes below Node
+			core::array<ISceneNode*> SkinnedNodes;
 		};
 
+		static void animateJob(void* data);
+		static void skinJob(void* data);
+
+		//! sort on distance (center) to camera
 		//! sort on distance (sphere) to camera
 		struct DistanceNodeEntry
 		{
@@ -271,6 +469,9 @@ namespace scene
 		//! video driver
 		video::IVideoDriver* Driver;
 
+		//! file system, to find the textures of loaded meshes
+		io::IFileSystem* FileSystem;
+
 		//! cursor control
 		gui::ICursorControl* CursorControl;
 
@@ -280,29 +481,115 @@ namespace scene
 		//! render pass lists
 		core::array<ISceneNode*> CameraList;
 		core::array<ISceneNode*> SkyBoxList;
-		core::array<DefaultNodeEntry> SolidNodeList;
-		core::array<TransparentNodeEntry> TransparentNodeList;
-		core::array<TransparentNodeEntry> TransparentEffectNodeList;
+		CRenderQueue SolidRenderQueue;
+		CTransparentRenderQueue TransparentRenderQueue;
+		CTransparentRenderQueue TransparentEffectRenderQueue;
+		//! the transparent entries drawn unsorted with order-independent transparency, grouped by material
+		CRenderQueue AccumulatedRenderQueue;
+		CBillboardBatch BillboardBatch;
 		core::array<ISceneNode*> GuiNodeList;
 
+		//! draw the solid render queue once more before, for its depth only
+		bool DepthPrepass;
+
+		//! let the driver accumulate the transparent entries it can instead of sorting them
+		bool OrderIndependentTransparency;
+
+		//! the casters registered for ESNRP_SHADOW and their cascades
+		CShadowMapPass ShadowMaps;
+		bool ShadowMapping;
+
+		//! the lights registered for ESNRP_LIGHT, binned into the clusters of the camera view
+		CLightClusters LightClusters;
+
+		//! draws the scene into its texture and its passes after the transparent effects
+		video::IPostProcessChain* PostProcessChain;
+
 		core::array<IMeshLoader*> MeshLoaderList;
+
+		//! directory of the .irrbm files of createMeshThroughCache(), empty if disabled
+		io::path MeshCacheDirectory;
+
+		//! held while a mesh loader parses a file, as the loaders keep state meanwhile
+		std::mutex MeshLoaderMutex;
+		//! references of addMeshTextureReference() for the file parsed meanwhile
+		core::array<video::ITexture*> MeshTextureReferences;
+
+		//! thread parsing the files of getMeshAsync(), started by the first request
+		std::thread MeshLoadThread;
+		//! guards MeshLoadQueue and MeshLoadQuit
+		std::mutex MeshLoadMutex;
+		std::condition_variable MeshLoadWake;
+		std::deque<CMeshLoadRequest*> MeshLoadQueue;
+		bool MeshLoadQuit;
+		//! requests whose mesh isn't in the mesh cache yet
+		core::array<CMeshLoadRequest*> MeshLoads;
 		core::array<ISceneNode*> DeletionList;
 
 		//! current active camera
 		ICameraSceneNode* ActiveCamera;
 		core::vector3df camWorldPos; // Position of camera for transparent nodes.
 
+		//! set by invalidate(), cleared when the scene is drawn
+		bool Invalidated;
+		//! needsRedraw() animated the nodes of the next drawAll()
+		bool FrameAnimated;
+		//! needsRedraw() was called, the drawn scene has to be hashed
+		bool TrackChanges;
+		u64 DrawnSignature;
+
+		//! active camera while the nodes of several views register, 0 until needed
+		CSceneViewsCamera* ViewsCamera;
+
+		//! cameras of the faces drawAllToCubemap() draws, 0 until needed
+		ICameraSceneNode* CubemapCameras[6];
+		//! frusta of the faces, for the entries of the queues registered once for all of them
+		SPackedFrustum CubemapFrusta[6];
+		//! bit of the face being drawn, 0 draws all entries
+		u8 CubemapFaceBit;
+		core::array<u8> SolidFaceMasks;
+		core::array<u8> TransparentFaceMasks;
+		core::array<u8> EffectFaceMasks;
+		core::array<u8> AccumulatedFaceMasks;
+		core::array<core::aabbox3df> FaceMaskBoxes;
+		core::array<core::EIntersectionRelation3D> FaceMaskRelations;
+
+		//! culling results of the active camera, only valid while the nodes register
+		CSceneCullingBatch CullingBatch;
+
+		//! spatial index of all nodes, 0 if disabled
+		CSceneNodeSpatialIndex* NodeIndex;
+		core::array<ISceneNode*> CullingCandidates;
+
+		//! registry of all nodes by id, name and type, 0 if disabled
+		CSceneNodeRegistry* NodeRegistry;
+
+		//! depth of the occluders of the active camera, 0 if disabled
+		CSceneOcclusionBuffer* OcclusionBuffer;
+		core::array<const ISceneNode*> Occluders;
+
+		//! worker threads of the parallel update, 0 if disabled
+		CJobSystem* UpdateJobs;
+		std::vector<SAnimateJob> AnimateJobs;
+		std::unordered_map<const IAnimatedMesh*, u32> SkinnedMeshUsers;
+
 		video::SColor ShadowColor;
 		video::SColorf AmbientLight;
 
 		//! String parameters
-		// NOTE: Attributes are slow and should only be used for debug-info and not in release
 		io::CAttributes* Parameters;
+		//! handles of the parameters read each frame, taken again when ParameterGeneration is outdated
+		s32 AllowZWriteParameter;
+		s32 FractionalTimeParameter;
+		u32 ParameterGeneration;
 
 		//! Mesh cache
 		IMeshCache* MeshCache;
 
 		E_SCENE_NODE_RENDER_PASS CurrentRenderPass;
+
+		//! virtual time in nanoseconds of the current animation, 0 without FRACTIONAL_ANIMATION_TIME
+		u64 AnimationTimeNs;
 	};
 
 } // end namespace video
@@ -0,0 +1,68 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodePool.h"
+
+namespace irr
+{
+namespace scene
+{
+
+CSceneNodePool::CSceneNodePool(size_t size) :
+	FreeList(0), Allocated(0)
+{
+	const size_t alignment = alignof(std::max_align_t);
+	if (size < sizeof(SFreeObject))
+		size = sizeof(SFreeObject);
+	Size = (size + alignment - 1) / alignment * alignment;
+}
+
+CSceneNodePool::~CSceneNodePool()
+{
+	// nodes still alive at exit, e.g. held by other static objects, keep their memory
+	if (Allocated != 0)
+		return;
+
+	for (void* block : Blocks)
+		::operator delete(block);
+	core::trackMemory(-(s64)(Size * BlockSize * Blocks.size()), core::EMC_SCENE);
+}
+
+void* CSceneNodePool::allocate()
+{
+	std::lock_guard<std::mutex> lock(Mutex);
+
+	if (!FreeList)
+	{
+		u8* block = static_cast<u8*>(::operator new(Size * BlockSize));
+		Blocks.push_back(block);
+		// the blocks outlive any allocator set later, so only count them
+		core::trackMemory((s64)(Size * BlockSize), core::EMC_SCENE);
+
+		// link the objects so the first one is allocated first
+		for (u32 i = BlockSize; i > 0; --i)
+		{
+			SFreeObject* object = reinterpret_cast<SFreeObject*>(block + (i - 1) * Size);
+			object->Next = FreeList;
+			FreeList = object;
+		}
+	}
+
+	SFreeObject* object = FreeList;
+	FreeList = object->Next;
+	++Allocated;
+	return object;
+}
+
+void CSceneNodePool::deallocate(void* p)
+{
+	std::lock_guard<std::mutex> lock(Mutex);
+
+	SFreeObject* object = static_cast<SFreeObject*>(p);
+	object->Next = FreeList;
+	FreeList = object;
+	--Allocated;
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,86 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_POOL_H_INCLUDED__
+#define __C_SCENE_NODE_POOL_H_INCLUDED__
+
+#include "irrTypes.h"
+#include "irrMemory.h"
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+
+//! Allocates objects of one size from blocks holding many of them
+/** Freed objects are kept in a free list and handed out again by the next
+allocation, so creating and removing nodes all the time doesn't fragment the
+heap, and nodes of a class created together lie next to each other. The
+blocks are only given back when the pool is destroyed. */
+class CSceneNodePool
+{
+public:
+	explicit CSceneNodePool(size_t size);
+	~CSceneNodePool();
+
+	void* allocate();
+	void deallocate(void* p);
+
+private:
+	struct SFreeObject
+	{
+		SFreeObject* Next;
+	};
+
+	//! Objects per block
+	static constexpr u32 BlockSize = 64;
+
+	//! Size of an object, rounded up to keep the objects aligned
+	size_t Size;
+	SFreeObject* FreeList;
+	std::vector<void*> Blocks;
+	//! Objects allocated and not deallocated yet
+	u32 Allocated;
+	std::mutex Mutex;
+};
+
+//! Base class giving scene node class T the operators new and delete of a CSceneNodePool
+/** Classes derived from T have a different size and allocate from the
+scene memory category instead. */
+template <class T>
+class CSceneNodePoolAllocated
+{
+public:
+	static void* operator new(size_t size)
+	{
+		if (size != sizeof(T))
+			return core::allocateMemory(size, core::EMC_SCENE);
+		return getPool().allocate();
+	}
+
+	static void operator delete(void* p, size_t size)
+	{
+		if (!p)
+			return;
+		if (size != sizeof(T))
+			core::deallocateMemory(p, size, core::EMC_SCENE);
+		else
+			getPool().deallocate(p);
+	}
+
+private:
+	static CSceneNodePool& getPool()
+	{
+		static CSceneNodePool pool(sizeof(T));
+		return pool;
+	}
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
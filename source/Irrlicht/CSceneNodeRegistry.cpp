@@ -0,0 +1,132 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeRegistry.h"
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	template <class TKey>
+	inline const std::vector<ISceneNode*>* findNodes(const std::unordered_map<TKey, std::vector<ISceneNode*> >& map, const TKey& key)
+	{
+		typename std::unordered_map<TKey, std::vector<ISceneNode*> >::const_iterator it = map.find(key);
+		return it != map.end() ? &it->second : 0;
+	}
+}
+
+void CSceneNodeRegistry::updateNode(ISceneNode* node)
+{
+	std::lock_guard<std::mutex> lock(UpdateMutex);
+
+	std::unordered_map<ISceneNode*, SEntry>::iterator it = Entries.find(node);
+	if (it == Entries.end())
+	{
+		SEntry entry;
+		entry.Id = -1;
+		entry.Type = ESNT_UNKNOWN;
+		entry.Pending = true;
+		Entries[node] = entry;
+	}
+	else if (!it->second.Pending)
+	{
+		unlink(node, it->second);
+		it->second.Pending = true;
+	}
+	else
+	{
+		return;
+	}
+	PendingNodes.push_back(node);
+}
+
+void CSceneNodeRegistry::removeNode(ISceneNode* node)
+{
+	std::lock_guard<std::mutex> lock(UpdateMutex);
+
+	std::unordered_map<ISceneNode*, SEntry>::iterator it = Entries.find(node);
+	if (it == Entries.end())
+		return;
+
+	// pending nodes aren't in the maps yet, update() skips them
+	if (!it->second.Pending)
+		unlink(node, it->second);
+	Entries.erase(it);
+}
+
+const std::vector<ISceneNode*>* CSceneNodeRegistry::getNodesFromId(s32 id)
+{
+	update();
+	return findNodes(Ids, id);
+}
+
+const std::vector<ISceneNode*>* CSceneNodeRegistry::getNodesFromName(const core::atom& name)
+{
+	update();
+	return findNodes(Names, name);
+}
+
+const std::vector<ISceneNode*>* CSceneNodeRegistry::getNodesFromType(ESCENE_NODE_TYPE type)
+{
+	update();
+	return findNodes(Types, (u32)type);
+}
+
+void CSceneNodeRegistry::update()
+{
+	std::lock_guard<std::mutex> lock(UpdateMutex);
+
+	for (size_t i = 0; i < PendingNodes.size(); ++i)
+	{
+		ISceneNode* node = PendingNodes[i];
+		std::unordered_map<ISceneNode*, SEntry>::iterator it = Entries.find(node);
+		if (it == Entries.end() || !it->second.Pending)
+			continue;
+
+		SEntry& entry = it->second;
+		entry.Id = node->getID();
+		entry.Name = node->getNameAtom();
+		entry.Type = (u32)node->getType();
+		entry.Pending = false;
+
+		Ids[entry.Id].push_back(node);
+		Names[entry.Name].push_back(node);
+		Types[entry.Type].push_back(node);
+	}
+	PendingNodes.clear();
+}
+
+void CSceneNodeRegistry::unlink(ISceneNode* node, const SEntry& entry)
+{
+	eraseNode(Ids, entry.Id, node);
+	eraseNode(Names, entry.Name, node);
+	eraseNode(Types, entry.Type, node);
+}
+
+template <class TKey>
+void CSceneNodeRegistry::eraseNode(std::unordered_map<TKey, std::vector<ISceneNode*> >& map, const TKey& key, ISceneNode* node)
+{
+	typename std::unordered_map<TKey, std::vector<ISceneNode*> >::iterator it = map.find(key);
+	if (it == map.end())
+		return;
+
+	std::vector<ISceneNode*>& nodes = it->second;
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		if (nodes[i] == node)
+		{
+			nodes[i] = nodes.back();
+			nodes.pop_back();
+			break;
+		}
+	}
+	if (nodes.empty())
+		map.erase(it);
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,71 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_REGISTRY_H_INCLUDED__
+#define __C_SCENE_NODE_REGISTRY_H_INCLUDED__
+
+#include "ISceneNodeRegistry.h"
+#include "ESceneNodeTypes.h"
+#include "irrAtom.h"
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+
+//! ISceneNodeRegistry implementation with a hash map for each key.
+/** Each map holds the nodes sharing a key in no particular order. */
+class CSceneNodeRegistry : public ISceneNodeRegistry
+{
+public:
+	void updateNode(ISceneNode* node) override;
+
+	void removeNode(ISceneNode* node) override;
+
+	//! Get the nodes with an id, 0 if there are none
+	/** Valid until the registry changes. */
+	const std::vector<ISceneNode*>* getNodesFromId(s32 id);
+
+	//! Get the nodes with an interned name, 0 if there are none
+	const std::vector<ISceneNode*>* getNodesFromName(const core::atom& name);
+
+	//! Get the nodes of a type, 0 if there are none
+	const std::vector<ISceneNode*>* getNodesFromType(ESCENE_NODE_TYPE type);
+
+private:
+	struct SEntry
+	{
+		s32 Id;
+		core::atom Name;
+		u32 Type;
+		//! The keys weren't read since the node was added or changed
+		bool Pending;
+	};
+
+	//! Reads the keys of the nodes marked by updateNode()
+	void update();
+
+	//! Removes a node from the maps with the keys of its entry
+	void unlink(ISceneNode* node, const SEntry& entry);
+
+	template <class TKey>
+	static void eraseNode(std::unordered_map<TKey, std::vector<ISceneNode*> >& map, const TKey& key, ISceneNode* node);
+
+	std::unordered_map<ISceneNode*, SEntry> Entries;
+	std::vector<ISceneNode*> PendingNodes;
+
+	std::unordered_map<s32, std::vector<ISceneNode*> > Ids;
+	std::unordered_map<core::atom, std::vector<ISceneNode*> > Names;
+	std::unordered_map<u32, std::vector<ISceneNode*> > Types;
+
+	//! nodes are added and renamed from the threads of the parallel scene update as well
+	std::mutex UpdateMutex;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -0,0 +1,413 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneNodeSpatialIndex.h"
+#include "ISceneNode.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! Cost of a box for the insertion heuristic
+	inline f32 getSurfaceArea(const core::aabbox3df& box)
+	{
+		return box.getArea();
+	}
+
+	inline core::aabbox3df getUnion(const core::aabbox3df& a, const core::aabbox3df& b)
+	{
+		core::aabbox3df box(a);
+		box.addInternalBox(b);
+		return box;
+	}
+
+	inline bool intersectsSphere(const core::aabbox3df& box, const core::vector3df& center, f32 radiusSQ)
+	{
+		const core::vector3df closest(
+			core::clamp(center.X, box.MinEdge.X, box.MaxEdge.X),
+			core::clamp(center.Y, box.MinEdge.Y, box.MaxEdge.Y),
+			core::clamp(center.Z, box.MinEdge.Z, box.MaxEdge.Z));
+		return closest.getDistanceFromSQ(center) <= radiusSQ;
+	}
+
+	//! Slab test of a line segment against a box
+	inline bool intersectsLine(const core::aabbox3df& box, const core::vector3df& start, const core::vector3df& dir)
+	{
+		f32 tMin = 0.f;
+		f32 tMax = 1.f;
+		const f32 s[3] = { start.X, start.Y, start.Z };
+		const f32 d[3] = { dir.X, dir.Y, dir.Z };
+		const f32 bMin[3] = { box.MinEdge.X, box.MinEdge.Y, box.MinEdge.Z };
+		const f32 bMax[3] = { box.MaxEdge.X, box.MaxEdge.Y, box.MaxEdge.Z };
+		for (u32 i = 0; i < 3; ++i)
+		{
+			if (core::iszero(d[i]))
+			{
+				if (s[i] < bMin[i] || s[i] > bMax[i])
+					return false;
+				continue;
+			}
+
+			f32 t1 = (bMin[i] - s[i]) / d[i];
+			f32 t2 = (bMax[i] - s[i]) / d[i];
+			if (t1 > t2)
+				core::swap(t1, t2);
+			tMin = core::max_(tMin, t1);
+			tMax = core::min_(tMax, t2);
+			if (tMin > tMax)
+				return false;
+		}
+		return true;
+	}
+}
+
+CSceneNodeSpatialIndex::CSceneNodeSpatialIndex() : Root(-1), FreeList(-1)
+{
+}
+
+void CSceneNodeSpatialIndex::updateNode(ISceneNode* node)
+{
+	// the root scene node isn't indexed
+	if (!node->getParent())
+		return;
+
+	std::lock_guard<std::mutex> lock(UpdateMutex);
+
+	s32 id = node->getSpatialIndexId();
+	if (id < 0)
+	{
+		id = allocateNode();
+		Nodes[id].SceneNode = node;
+		node->setSpatialIndexId(id);
+	}
+	else if (Nodes[id].Dirty)
+	{
+		return;
+	}
+
+	Nodes[id].Dirty = true;
+	DirtyLeaves.push_back(id);
+}
+
+void CSceneNodeSpatialIndex::removeNode(ISceneNode* node)
+{
+	const s32 id = node->getSpatialIndexId();
+	if (id < 0)
+		return;
+
+	if (Nodes[id].Height >= 0)
+		removeLeaf(id);
+	freeNode(id);
+	node->setSpatialIndexId(-1);
+}
+
+void CSceneNodeSpatialIndex::update()
+{
+	for (u32 i = 0; i < DirtyLeaves.size(); ++i)
+	{
+		const s32 id = DirtyLeaves[i];
+
+		// removed, or listed twice because the entry was reused
+		if (!Nodes[id].Dirty)
+			continue;
+		Nodes[id].Dirty = false;
+
+		const core::aabbox3df box = Nodes[id].SceneNode->getTransformedBoundingBox();
+		Nodes[id].NodeBox = box;
+
+		if (Nodes[id].Height >= 0)
+		{
+			if (box.isFullInside(Nodes[id].Box))
+				continue;
+			removeLeaf(id);
+		}
+
+		// the margin grows with the node, so small movements stay inside
+		const core::vector3df margin = box.getExtent() * 0.1f + core::vector3df(0.01f);
+		Nodes[id].Box = core::aabbox3df(box.MinEdge - margin, box.MaxEdge + margin);
+		insertLeaf(id);
+	}
+	DirtyLeaves.clear();
+}
+
+bool CSceneNodeSpatialIndex::getBox(const ISceneNode* node, core::aabbox3df& box) const
+{
+	const s32 id = node->getSpatialIndexId();
+	if (id < 0 || Nodes[id].Dirty || Nodes[id].Height < 0)
+		return false;
+
+	box = Nodes[id].NodeBox;
+	return true;
+}
+
+void CSceneNodeSpatialIndex::getNodesInBox(const core::aabbox3df& box, core::array<ISceneNode*>& outNodes)
+{
+	query([&box](const core::aabbox3df& b) { return b.intersectsWithBox(box); }, outNodes);
+}
+
+void CSceneNodeSpatialIndex::getNodesInRadius(const core::vector3df& center, f32 radius, core::array<ISceneNode*>& outNodes)
+{
+	const f32 radiusSQ = radius * radius;
+	query([&center, radiusSQ](const core::aabbox3df& b) { return intersectsSphere(b, center, radiusSQ); }, outNodes);
+}
+
+void CSceneNodeSpatialIndex::getNodesOnLine(const core::line3df& line, core::array<ISceneNode*>& outNodes)
+{
+	const core::vector3df dir = line.getVector();
+	query([&line, &dir](const core::aabbox3df& b) { return intersectsLine(b, line.start, dir); }, outNodes);
+}
+
+template <class Test>
+void CSceneNodeSpatialIndex::query(const Test& test, core::array<ISceneNode*>& outNodes)
+{
+	update();
+
+	if (Root < 0)
+		return;
+
+	Stack.push_back(Root);
+	while (!Stack.empty())
+	{
+		const STreeNode& node = Nodes[Stack.back()];
+		Stack.pop_back();
+
+		if (!test(node.Box))
+			continue;
+
+		if (node.isLeaf())
+		{
+			if (test(node.NodeBox))
+				outNodes.push_back(node.SceneNode);
+		}
+		else
+		{
+			Stack.push_back(node.Child1);
+			Stack.push_back(node.Child2);
+		}
+	}
+}
+
+s32 CSceneNodeSpatialIndex::allocateNode()
+{
+	s32 id;
+	if (FreeList >= 0)
+	{
+		id = FreeList;
+		FreeList = Nodes[id].Parent;
+	}
+	else
+	{
+		id = Nodes.size();
+		Nodes.push_back(STreeNode());
+	}
+
+	STreeNode& node = Nodes[id];
+	node.SceneNode = 0;
+	node.Parent = -1;
+	node.Child1 = -1;
+	node.Child2 = -1;
+	node.Height = -1;
+	node.Dirty = false;
+	return id;
+}
+
+void CSceneNodeSpatialIndex::freeNode(s32 id)
+{
+	Nodes[id].SceneNode = 0;
+	Nodes[id].Dirty = false;
+	Nodes[id].Parent = FreeList;
+	FreeList = id;
+}
+
+void CSceneNodeSpatialIndex::insertLeaf(s32 leaf)
+{
+	Nodes[leaf].Height = 0;
+
+	if (Root < 0)
+	{
+		Root = leaf;
+		Nodes[Root].Parent = -1;
+		return;
+	}
+
+	// find the sibling which grows the tree the least
+	const core::aabbox3df leafBox = Nodes[leaf].Box;
+	s32 index = Root;
+	while (!Nodes[index].isLeaf())
+	{
+		const STreeNode& node = Nodes[index];
+		const f32 area = getSurfaceArea(node.Box);
+		const f32 combinedArea = getSurfaceArea(getUnion(node.Box, leafBox));
+
+		// cost of a new parent for this node and the leaf
+		const f32 cost = 2.f * combinedArea;
+		// minimum cost of pushing the leaf further down the tree
+		const f32 inheritanceCost = 2.f * (combinedArea - area);
+
+		f32 childCost[2];
+		const s32 children[2] = { node.Child1, node.Child2 };
+		for (u32 i = 0; i < 2; ++i)
+		{
+			const STreeNode& child = Nodes[children[i]];
+			const f32 unionArea = getSurfaceArea(getUnion(child.Box, leafBox));
+			childCost[i] = child.isLeaf() ? unionArea + inheritanceCost :
+				unionArea - getSurfaceArea(child.Box) + inheritanceCost;
+		}
+
+		if (cost < childCost[0] && cost < childCost[1])
+			break;
+
+		index = (childCost[0] < childCost[1]) ? children[0] : children[1];
+	}
+
+	const s32 sibling = index;
+
+	const s32 oldParent = Nodes[sibling].Parent;
+	const s32 newParent = allocateNode();
+	Nodes[newParent].Parent = oldParent;
+	Nodes[newParent].Box = getUnion(leafBox, Nodes[sibling].Box);
+	Nodes[newParent].Height = Nodes[sibling].Height + 1;
+	Nodes[newParent].Child1 = sibling;
+	Nodes[newParent].Child2 = leaf;
+	Nodes[sibling].Parent = newParent;
+	Nodes[leaf].Parent = newParent;
+
+	if (oldParent >= 0)
+	{
+		if (Nodes[oldParent].Child1 == sibling)
+			Nodes[oldParent].Child1 = newParent;
+		else
+			Nodes[oldParent].Child2 = newParent;
+	}
+	else
+	{
+		Root = newParent;
+	}
+
+	// refit the boxes up to the root
+	index = Nodes[leaf].Parent;
+	while (index >= 0)
+	{
+		index = balance(index);
+
+		const s32 child1 = Nodes[index].Child1;
+		const s32 child2 = Nodes[index].Child2;
+		Nodes[index].Height = 1 + core::max_(Nodes[child1].Height, Nodes[child2].Height);
+		Nodes[index].Box = getUnion(Nodes[child1].Box, Nodes[child2].Box);
+
+		index = Nodes[index].Parent;
+	}
+}
+
+void CSceneNodeSpatialIndex::removeLeaf(s32 leaf)
+{
+	Nodes[leaf].Height = -1;
+
+	if (leaf == Root)
+	{
+		Root = -1;
+		return;
+	}
+
+	const s32 parent = Nodes[leaf].Parent;
+	const s32 grandParent = Nodes[parent].Parent;
+	const s32 sibling = (Nodes[parent].Child1 == leaf) ? Nodes[parent].Child2 : Nodes[parent].Child1;
+
+	if (grandParent >= 0)
+	{
+		// the sibling takes the place of the parent
+		if (Nodes[grandParent].Child1 == parent)
+			Nodes[grandParent].Child1 = sibling;
+		else
+			Nodes[grandParent].Child2 = sibling;
+		Nodes[sibling].Parent = grandParent;
+		freeNode(parent);
+
+		s32 index = grandParent;
+		while (index >= 0)
+		{
+			index = balance(index);
+
+			const s32 child1 = Nodes[index].Child1;
+			const s32 child2 = Nodes[index].Child2;
+			Nodes[index].Box = getUnion(Nodes[child1].Box, Nodes[child2].Box);
+			Nodes[index].Height = 1 + core::max_(Nodes[child1].Height, Nodes[child2].Height);
+
+			index = Nodes[index].Parent;
+		}
+	}
+	else
+	{
+		Root = sibling;
+		Nodes[sibling].Parent = -1;
+		freeNode(parent);
+	}
+}
+
+s32 CSceneNodeSpatialIndex::balance(s32 iA)
+{
+	if (Nodes[iA].isLeaf() || Nodes[iA].Height < 2)
+		return iA;
+
+	const s32 iB = Nodes[iA].Child1;
+	const s32 iC = Nodes[iA].Child2;
+	const s32 diff = Nodes[iC].Height - Nodes[iB].Height;
+
+	// rotates the higher child up, returns its index
+	auto rotate = [this](s32 iA, s32 iUp, s32 iOther) -> s32
+	{
+		STreeNode& A = Nodes[iA];
+		STreeNode& up = Nodes[iUp];
+		const s32 iF = up.Child1;
+		const s32 iG = up.Child2;
+		STreeNode& F = Nodes[iF];
+		STreeNode& G = Nodes[iG];
+
+		// swap A and its child
+		up.Child1 = iA;
+		up.Parent = A.Parent;
+		A.Parent = iUp;
+
+		if (up.Parent >= 0)
+		{
+			if (Nodes[up.Parent].Child1 == iA)
+				Nodes[up.Parent].Child1 = iUp;
+			else
+				Nodes[up.Parent].Child2 = iUp;
+		}
+		else
+		{
+			Root = iUp;
+		}
+
+		// the higher grandchild stays, the lower one moves below A
+		const s32 iStay = (F.Height > G.Height) ? iF : iG;
+		const s32 iMove = (iStay == iF) ? iG : iF;
+		up.Child2 = iStay;
+		if (A.Child1 == iUp)
+			A.Child1 = iMove;
+		else
+			A.Child2 = iMove;
+		Nodes[iMove].Parent = iA;
+
+		A.Box = getUnion(Nodes[iOther].Box, Nodes[iMove].Box);
+		up.Box = getUnion(A.Box, Nodes[iStay].Box);
+		A.Height = 1 + core::max_(Nodes[iOther].Height, Nodes[iMove].Height);
+		up.Height = 1 + core::max_(A.Height, Nodes[iStay].Height);
+
+		return iUp;
+	};
+
+	if (diff > 1)
+		return rotate(iA, iC, iB);
+	if (diff < -1)
+		return rotate(iA, iB, iC);
+
+	return iA;
+}
+
+} // end namespace scene
+} // end namespace irr
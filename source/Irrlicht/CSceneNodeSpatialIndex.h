@@ -0,0 +1,87 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_NODE_SPATIAL_INDEX_H_INCLUDED__
+#define __C_SCENE_NODE_SPATIAL_INDEX_H_INCLUDED__
+
+#include "ISpatialIndex.h"
+#include <mutex>
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+
+//! ISpatialIndex implementation as a dynamic bounding volume tree.
+/** Leaves hold the boxes of the nodes, enlarged by a margin so nodes moving
+a little don't need to be reinserted. Inner nodes are kept balanced by
+rotations, like in Box2D's b2DynamicTree. */
+class CSceneNodeSpatialIndex : public ISpatialIndex
+{
+public:
+	CSceneNodeSpatialIndex();
+
+	void updateNode(ISceneNode* node) override;
+
+	void removeNode(ISceneNode* node) override;
+
+	void getNodesInBox(const core::aabbox3df& box, core::array<ISceneNode*>& outNodes) override;
+
+	void getNodesInRadius(const core::vector3df& center, f32 radius, core::array<ISceneNode*>& outNodes) override;
+
+	void getNodesOnLine(const core::line3df& line, core::array<ISceneNode*>& outNodes) override;
+
+	//! Updates the boxes of the nodes marked by updateNode()
+	void update();
+
+	//! Get the transformed bounding box of a node as of the last update()
+	/** \return False if the node isn't indexed or was changed since. */
+	bool getBox(const ISceneNode* node, core::aabbox3df& box) const;
+
+private:
+	struct STreeNode
+	{
+		//! Enlarged box of leaves, union of the children of inner nodes
+		core::aabbox3df Box;
+		//! Exact box of the scene node of a leaf
+		core::aabbox3df NodeBox;
+		//! Scene node of a leaf, 0 for inner nodes and unused entries
+		ISceneNode* SceneNode;
+		//! Next unused entry for unused entries
+		s32 Parent;
+		s32 Child1;
+		s32 Child2;
+		//! Leaves have height 0, -1 for leaves not inserted into the tree yet
+		s32 Height;
+		bool Dirty;
+
+		bool isLeaf() const { return Child1 == -1; }
+	};
+
+	s32 allocateNode();
+	void freeNode(s32 id);
+
+	void insertLeaf(s32 leaf);
+	void removeLeaf(s32 leaf);
+
+	//! Rotates the subtree at id if it is unbalanced, returns the new root of the subtree
+	s32 balance(s32 id);
+
+	template <class Test>
+	void query(const Test& test, core::array<ISceneNode*>& outNodes);
+
+	std::vector<STreeNode> Nodes;
+	s32 Root;
+	s32 FreeList;
+	std::vector<s32> DirtyLeaves;
+	std::vector<s32> Stack;
+
+	//! updateNode() is called from the threads of the parallel scene update
+	std::mutex UpdateMutex;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
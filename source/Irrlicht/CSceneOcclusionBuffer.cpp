@@ -0,0 +1,335 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneOcclusionBuffer.h"
+#include "ICameraSceneNode.h"
+#include "IMeshSceneNode.h"
+#include "IMesh.h"
+#include "IMeshBuffer.h"
+#include "irrSIMD.h"
+#include <float.h>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! Triangles reaching further out are left out, their edge planes lose too much precision
+	const f32 MAX_PIXEL_COORDINATE = 65536.f;
+}
+
+CSceneOcclusionBuffer::CSceneOcclusionBuffer()
+	: Camera(0), DepthSign(1.f), Ready(false),
+	JobSystem(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0)
+{
+	for (u32 i = 0; i < TILES_X * TILES_Y; ++i)
+	{
+		Jobs[i].Buffer = this;
+		Jobs[i].Tile = i;
+		TileDepth[i] = FLT_MAX;
+	}
+}
+
+void CSceneOcclusionBuffer::begin(const ICameraSceneNode* camera)
+{
+	clear();
+
+	Camera = camera;
+	ViewProjection = camera->getViewProjectionMatrix();
+	DepthSign = camera->isReverseDepth() ? -1.f : 1.f;
+
+	Triangles.set_used(0);
+	for (u32 i = 0; i < TILES_X * TILES_Y; ++i)
+		Bins[i].set_used(0);
+}
+
+void CSceneOcclusionBuffer::addOccluder(const ISceneNode* node)
+{
+	if (!Camera || node->getType() != ESNT_MESH)
+		return;
+
+	const IMesh* mesh = static_cast<const IMeshSceneNode*>(node)->getOccluderMesh();
+	if (!mesh)
+		return;
+
+	core::matrix4 transform(ViewProjection);
+	transform *= node->getAbsoluteTransformation();
+
+	for (u32 b = 0; b < mesh->getMeshBufferCount(); ++b)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(b);
+		if (mb->getPrimitiveType() != EPT_TRIANGLES || mb->isClientDataReleased())
+			continue;
+
+		const u32 vertexCount = mb->getVertexCount();
+		ClipVertices.set_used(vertexCount * 4);
+		for (u32 v = 0; v < vertexCount; ++v)
+			transform.transformVect(&ClipVertices[v * 4], mb->getPosition(v));
+
+		const u32 indexCount = mb->getIndexCount();
+		if (mb->getIndexType() == video::EIT_32BIT)
+		{
+			const u32* indices = reinterpret_cast<const u32*>(mb->getIndices());
+			for (u32 i = 0; i + 2 < indexCount; i += 3)
+				addTriangle(&ClipVertices[indices[i] * 4], &ClipVertices[indices[i + 1] * 4], &ClipVertices[indices[i + 2] * 4]);
+		}
+		else
+		{
+			const u16* indices = mb->getIndices();
+			for (u32 i = 0; i + 2 < indexCount; i += 3)
+				addTriangle(&ClipVertices[indices[i] * 4], &ClipVertices[indices[i + 1] * 4], &ClipVertices[indices[i + 2] * 4]);
+		}
+	}
+}
+
+void CSceneOcclusionBuffer::addTriangle(const f32* a, const f32* b, const f32* c)
+{
+	if (a[3] <= core::ROUNDING_ERROR_f32 || b[3] <= core::ROUNDING_ERROR_f32 || c[3] <= core::ROUNDING_ERROR_f32)
+		return;
+
+	// pixel coordinates with y up, and depth
+	f32 p[3][3];
+	const f32* clip[3] = { a, b, c };
+	for (u32 i = 0; i < 3; ++i)
+	{
+		const f32 invW = 1.f / clip[i][3];
+		p[i][0] = (clip[i][0] * invW * 0.5f + 0.5f) * WIDTH;
+		p[i][1] = (clip[i][1] * invW * 0.5f + 0.5f) * HEIGHT;
+		p[i][2] = DepthSign * clip[i][2] * invW;
+		if (fabsf(p[i][0]) > MAX_PIXEL_COORDINATE || fabsf(p[i][1]) > MAX_PIXEL_COORDINATE)
+			return;
+	}
+
+	f32 area = (p[1][0] - p[0][0]) * (p[2][1] - p[0][1]) - (p[2][0] - p[0][0]) * (p[1][1] - p[0][1]);
+	if (fabsf(area) <= core::ROUNDING_ERROR_f32)
+		return;
+
+	// occluders are rasterized from both sides, counter clockwise is the order the edges expect
+	if (area < 0.f)
+	{
+		for (u32 i = 0; i < 3; ++i)
+			core::swap(p[1][i], p[2][i]);
+		area = -area;
+	}
+
+	const s32 minX = core::max_((s32)floorf(core::min_(p[0][0], p[1][0], p[2][0])), 0);
+	const s32 minY = core::max_((s32)floorf(core::min_(p[0][1], p[1][1], p[2][1])), 0);
+	const s32 maxX = core::min_((s32)ceilf(core::max_(p[0][0], p[1][0], p[2][0])) - 1, (s32)WIDTH - 1);
+	const s32 maxY = core::min_((s32)ceilf(core::max_(p[0][1], p[1][1], p[2][1])) - 1, (s32)HEIGHT - 1);
+	if (minX > maxX || minY > maxY)
+		return;
+
+	Triangles.push_back(STriangle());
+	STriangle& t = Triangles.getLast();
+	t.MinX = minX;
+	t.MinY = minY;
+	t.MaxX = maxX;
+	t.MaxY = maxY;
+
+	// edge planes, >= 0 inside, so pixels take the triangle if it covers their center
+	f32* edges[3] = { t.Edge0, t.Edge1, t.Edge2 };
+	for (u32 i = 0; i < 3; ++i)
+	{
+		const f32* from = p[i];
+		const f32* to = p[(i + 1) % 3];
+		const f32 ex = from[1] - to[1];
+		const f32 ey = to[0] - from[0];
+		edges[i][0] = ex;
+		edges[i][1] = ey;
+		edges[i][2] = -(ex * from[0] + ey * from[1]);
+	}
+
+	// depth plane, moved to the farthest depth within a pixel
+	const f32 invArea = 1.f / area;
+	const f32 dx = ((p[1][2] - p[0][2]) * (p[2][1] - p[0][1]) - (p[2][2] - p[0][2]) * (p[1][1] - p[0][1])) * invArea;
+	const f32 dy = ((p[2][2] - p[0][2]) * (p[1][0] - p[0][0]) - (p[1][2] - p[0][2]) * (p[2][0] - p[0][0])) * invArea;
+	t.Depth[0] = dx;
+	t.Depth[1] = dy;
+	t.Depth[2] = p[0][2] - dx * p[0][0] - dy * p[0][1] + 0.5f * (fabsf(dx) + fabsf(dy));
+
+	const u32 index = Triangles.size() - 1;
+	for (s32 y = minY / TILE_HEIGHT; y <= maxY / (s32)TILE_HEIGHT; ++y)
+		for (s32 x = minX / TILE_WIDTH; x <= maxX / (s32)TILE_WIDTH; ++x)
+			Bins[y * TILES_X + x].push_back(index);
+}
+
+void CSceneOcclusionBuffer::rasterize()
+{
+	if (!Camera || Triangles.empty())
+		return;
+
+	for (u32 i = 0; i < TILES_X * TILES_Y; ++i)
+		JobSystem.add(rasterizeJob, &Jobs[i]);
+	JobSystem.wait();
+
+	Ready = true;
+}
+
+void CSceneOcclusionBuffer::rasterizeJob(void* data)
+{
+	SJob* job = static_cast<SJob*>(data);
+	job->Buffer->rasterizeTile(job->Tile);
+}
+
+void CSceneOcclusionBuffer::rasterizeTile(u32 tile)
+{
+	const s32 tileX = (tile % TILES_X) * TILE_WIDTH;
+	const s32 tileY = (tile / TILES_X) * TILE_HEIGHT;
+
+	for (u32 y = 0; y < TILE_HEIGHT; ++y)
+	{
+		f32* row = Depth + (tileY + y) * WIDTH + tileX;
+		for (u32 x = 0; x < TILE_WIDTH; ++x)
+			row[x] = FLT_MAX;
+	}
+
+	const core::array<u32>& bin = Bins[tile];
+	for (u32 i = 0; i < bin.size(); ++i)
+	{
+		const STriangle& t = Triangles[bin[i]];
+		// tiles start at multiples of four, so do the groups of four pixels
+		const s32 minX = core::max_(t.MinX, tileX) & ~3;
+		const s32 maxX = core::min_(t.MaxX, tileX + (s32)TILE_WIDTH - 1);
+		const s32 minY = core::max_(t.MinY, tileY);
+		const s32 maxY = core::min_(t.MaxY, tileY + (s32)TILE_HEIGHT - 1);
+
+		for (s32 y = minY; y <= maxY; ++y)
+		{
+			const f32 centerY = y + 0.5f;
+			const f32 edge0 = t.Edge0[1] * centerY + t.Edge0[2];
+			const f32 edge1 = t.Edge1[1] * centerY + t.Edge1[2];
+			const f32 edge2 = t.Edge2[1] * centerY + t.Edge2[2];
+			const f32 depth = t.Depth[1] * centerY + t.Depth[2];
+			f32* row = Depth + y * WIDTH;
+
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+			typedef core::SSIMD4f S;
+			const S::V zero = S::splat(0.f);
+			const S::V step = S::splat(4.f);
+			const S::V e0x = S::splat(t.Edge0[0]);
+			const S::V e1x = S::splat(t.Edge1[0]);
+			const S::V e2x = S::splat(t.Edge2[0]);
+			const S::V dx = S::splat(t.Depth[0]);
+			const S::V e0 = S::splat(edge0);
+			const S::V e1 = S::splat(edge1);
+			const S::V e2 = S::splat(edge2);
+			const S::V d = S::splat(depth);
+
+			S::V centerX = S::set(minX + 0.5f, minX + 1.5f, minX + 2.5f, minX + 3.5f);
+			for (s32 x = minX; x <= maxX; x += 4)
+			{
+				// covered where the smallest edge value is not negative
+				const S::V inside = S::min_(S::min_(S::madd(centerX, e0x, e0), S::madd(centerX, e1x, e1)), S::madd(centerX, e2x, e2));
+				const S::V old = S::load(row + x);
+				S::store(row + x, S::select(S::lessEqual(zero, inside), S::min_(old, S::madd(centerX, dx, d)), old));
+				centerX = S::add(centerX, step);
+			}
+#else
+			for (s32 x = minX; x <= maxX; ++x)
+			{
+				const f32 centerX = x + 0.5f;
+				if (t.Edge0[0] * centerX + edge0 >= 0.f && t.Edge1[0] * centerX + edge1 >= 0.f && t.Edge2[0] * centerX + edge2 >= 0.f)
+					row[x] = core::min_(row[x], t.Depth[0] * centerX + depth);
+			}
+#endif
+		}
+	}
+
+	f32 farthest = -FLT_MAX;
+	for (u32 y = 0; y < TILE_HEIGHT; ++y)
+	{
+		const f32* row = Depth + (tileY + y) * WIDTH + tileX;
+		for (u32 x = 0; x < TILE_WIDTH; ++x)
+			farthest = core::max_(farthest, row[x]);
+	}
+	TileDepth[tile] = farthest;
+}
+
+bool CSceneOcclusionBuffer::isOccluded(const core::aabbox3df& box, const core::matrix4& transform, const ICameraSceneNode* camera) const
+{
+	if (!Ready || camera != Camera)
+		return false;
+
+	core::matrix4 m(ViewProjection);
+	m *= transform;
+
+	core::vector3df corners[8];
+	box.getEdges(corners);
+
+	f32 minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	f32 nearest = FLT_MAX;
+	for (u32 i = 0; i < 8; ++i)
+	{
+		f32 clip[4];
+		m.transformVect(clip, corners[i]);
+		// boxes reaching behind the camera are never hidden
+		if (clip[3] <= core::ROUNDING_ERROR_f32)
+			return false;
+
+		const f32 invW = 1.f / clip[3];
+		const f32 x = (clip[0] * invW * 0.5f + 0.5f) * WIDTH;
+		const f32 y = (clip[1] * invW * 0.5f + 0.5f) * HEIGHT;
+		minX = core::min_(minX, x);
+		minY = core::min_(minY, y);
+		maxX = core::max_(maxX, x);
+		maxY = core::max_(maxY, y);
+		nearest = core::min_(nearest, DepthSign * clip[2] * invW);
+	}
+
+	// every pixel the box touches has to be nearer than the box
+	const s32 x0 = core::max_((s32)floorf(minX), 0);
+	const s32 y0 = core::max_((s32)floorf(minY), 0);
+	const s32 x1 = core::min_(core::max_((s32)ceilf(maxX) - 1, (s32)floorf(minX)), (s32)WIDTH - 1);
+	const s32 y1 = core::min_(core::max_((s32)ceilf(maxY) - 1, (s32)floorf(minY)), (s32)HEIGHT - 1);
+	if (x0 > x1 || y0 > y1)
+		return false;
+
+	for (s32 ty = y0 / (s32)TILE_HEIGHT; ty <= y1 / (s32)TILE_HEIGHT; ++ty)
+	{
+		for (s32 tx = x0 / (s32)TILE_WIDTH; tx <= x1 / (s32)TILE_WIDTH; ++tx)
+		{
+			if (TileDepth[ty * TILES_X + tx] < nearest)
+				continue;
+
+			const s32 rx0 = core::max_(x0, tx * (s32)TILE_WIDTH);
+			const s32 rx1 = core::min_(x1, (tx + 1) * (s32)TILE_WIDTH - 1);
+			const s32 ry0 = core::max_(y0, ty * (s32)TILE_HEIGHT);
+			const s32 ry1 = core::min_(y1, (ty + 1) * (s32)TILE_HEIGHT - 1);
+			for (s32 y = ry0; y <= ry1; ++y)
+			{
+				const f32* row = Depth + y * WIDTH;
+#if defined(_IRR_SIMD_SSE2_) || defined(_IRR_SIMD_NEON_)
+				typedef core::SSIMD4f S;
+				const S::V n = S::splat(nearest);
+				for (s32 x = rx0 & ~3; x <= rx1; x += 4)
+				{
+					u32 lanes = S::bits(S::lessEqual(n, S::load(row + x)));
+					if (x < rx0)
+						lanes &= ~0u << (rx0 - x);
+					if (x + 3 > rx1)
+						lanes &= 0xfu >> (x + 3 - rx1);
+					if (lanes)
+						return false;
+				}
+#else
+				for (s32 x = rx0; x <= rx1; ++x)
+					if (row[x] >= nearest)
+						return false;
+#endif
+			}
+		}
+	}
+
+	return true;
+}
+
+void CSceneOcclusionBuffer::clear()
+{
+	Ready = false;
+	Camera = 0;
+}
+
+} // end namespace scene
+} // end namespace irr
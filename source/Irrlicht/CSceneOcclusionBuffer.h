@@ -0,0 +1,111 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_OCCLUSION_BUFFER_H_INCLUDED__
+#define __C_SCENE_OCCLUSION_BUFFER_H_INCLUDED__
+
+#include "irrArray.h"
+#include "matrix4.h"
+#include "aabbox3d.h"
+#include "CJobSystem.h"
+
+namespace irr
+{
+namespace scene
+{
+	class ICameraSceneNode;
+	class ISceneNode;
+	class IMesh;
+
+//! Coarse depth buffer of the occluders in the view of a camera, rasterized on the CPU
+/** The occluder meshes are transformed and set up on the calling thread, then
+the tiles of the buffer are rasterized on the job system, four pixels at a
+time. A pixel takes the farthest depth of the triangle within the pixel if
+the triangle covers its center, so a box is only reported hidden if it is,
+apart from less than half a pixel at the silhouettes of the occluders.
+Triangles reaching behind the near plane are left out, they can only hide
+less then. */
+class CSceneOcclusionBuffer
+{
+public:
+	CSceneOcclusionBuffer();
+
+	//! Starts a frame for a camera, forgetting the previous occluders
+	void begin(const ICameraSceneNode* camera);
+
+	//! Adds the occluder mesh of a node with EAC_OCCLUDER
+	void addOccluder(const ISceneNode* node);
+
+	//! Rasterizes the occluders added since begin()
+	void rasterize();
+
+	//! Checks if a box is hidden by the occluders
+	/** \param box Box in the space of transform.
+	\param transform Transformation into world space.
+	\param camera Camera the box is seen from.
+	\return False if the box may be visible, or the buffer holds no
+	occluders of the camera. */
+	bool isOccluded(const core::aabbox3df& box, const core::matrix4& transform, const ICameraSceneNode* camera) const;
+
+	//! Forgets the occluders, isOccluded() returns false until the next rasterize()
+	void clear();
+
+	static const u32 WIDTH = 256;
+	static const u32 HEIGHT = 128;
+	static const u32 TILE_WIDTH = 32;
+	static const u32 TILE_HEIGHT = 32;
+	static const u32 TILES_X = WIDTH / TILE_WIDTH;
+	static const u32 TILES_Y = HEIGHT / TILE_HEIGHT;
+
+private:
+	//! Edge and depth planes of a triangle in pixel coordinates
+	struct STriangle
+	{
+		//! The triangle covers the pixel center x, y where all Edge*[0] * x + Edge*[1] * y + Edge*[2] are >= 0
+		f32 Edge0[3];
+		f32 Edge1[3];
+		f32 Edge2[3];
+		//! Farthest depth within a pixel at its center
+		f32 Depth[3];
+		//! Inclusive pixel bounds
+		s32 MinX, MinY, MaxX, MaxY;
+	};
+
+	//! The triangles of the tiles a job rasterizes
+	struct SJob
+	{
+		CSceneOcclusionBuffer* Buffer;
+		u32 Tile;
+	};
+
+	void addTriangle(const f32* a, const f32* b, const f32* c);
+
+	void rasterizeTile(u32 tile);
+
+	static void rasterizeJob(void* data);
+
+	const ICameraSceneNode* Camera;
+	core::matrix4 ViewProjection;
+	//! Depth is negated for reverse depth, so smaller depths are always nearer
+	f32 DepthSign;
+	bool Ready;
+
+	core::array<STriangle> Triangles;
+	//! Triangle indices binned by tile
+	core::array<u32> Bins[TILES_X * TILES_Y];
+	//! Vertices of the occluder being added in clip space
+	core::array<f32> ClipVertices;
+
+	//! Depth of the pixels, rows bottom up
+	f32 Depth[WIDTH * HEIGHT];
+	//! Farthest depth of each tile, so boxes behind a whole tile need no pixel tests
+	f32 TileDepth[TILES_X * TILES_Y];
+
+	SJob Jobs[TILES_X * TILES_Y];
+	CJobSystem JobSystem;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
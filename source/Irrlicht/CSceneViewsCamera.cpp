@@ -0,0 +1,98 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CSceneViewsCamera.h"
+
+namespace irr
+{
+namespace scene
+{
+
+CSceneViewsCamera::CSceneViewsCamera(ISceneManager* mgr)
+	: CCameraSceneNode(0, mgr, -1)
+{
+	#ifdef _DEBUG
+	setDebugName("CSceneViewsCamera");
+	#endif
+}
+
+
+void CSceneViewsCamera::setViews(const core::array<SSceneView>& views)
+{
+	ViewArea = *views[0].Camera->getViewFrustum();
+	ViewProjection = views[0].Camera->getViewProjectionMatrix();
+
+	core::vector3df corners[8];
+	core::vector3df position;
+	f32 distances[SViewFrustum::VF_PLANE_COUNT];
+	ZNear = views[0].Camera->getNearValue();
+	ZFar = views[0].Camera->getFarValue();
+
+	for (u32 i = 0; i < views.size(); ++i)
+	{
+		const ICameraSceneNode* camera = views[i].Camera;
+		const SViewFrustum* frustum = camera->getViewFrustum();
+		corners[0] = frustum->getNearLeftUp();
+		corners[1] = frustum->getNearRightUp();
+		corners[2] = frustum->getNearLeftDown();
+		corners[3] = frustum->getNearRightDown();
+		corners[4] = frustum->getFarLeftUp();
+		corners[5] = frustum->getFarRightUp();
+		corners[6] = frustum->getFarLeftDown();
+		corners[7] = frustum->getFarRightDown();
+
+		// the planes face out of the frustum, a corner is inside where
+		// Normal.dot(corner) + D <= 0
+		for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p)
+		{
+			const core::vector3df& normal = ViewArea.planes[p].Normal;
+			for (u32 c = 0; c < 8; ++c)
+			{
+				const f32 d = normal.dotProduct(corners[c]);
+				if ((i == 0 && c == 0) || d > distances[p])
+					distances[p] = d;
+			}
+		}
+
+		position += frustum->cameraPosition;
+		ZNear = core::min_(ZNear, camera->getNearValue());
+		ZFar = core::max_(ZFar, camera->getFarValue());
+	}
+
+	for (u32 p = 0; p < SViewFrustum::VF_PLANE_COUNT; ++p)
+		ViewArea.planes[p].D = -distances[p];
+
+	// the transparent nodes are sorted by their distance from the middle
+	position /= (f32)views.size();
+	ViewArea.cameraPosition = position;
+	ViewArea.setFarNearDistance(ZFar - ZNear);
+	ViewArea.recalculateBoundingBox();
+
+	setPosition(position);
+	updateAbsolutePosition();
+}
+
+
+void CSceneViewsCamera::setBox(const ICameraSceneNode* camera, const core::aabbox3df& box)
+{
+	ViewArea = *camera->getViewFrustum();
+	ViewProjection = camera->getViewProjectionMatrix();
+	ZNear = camera->getNearValue();
+	ZFar = camera->getFarValue();
+
+	// the planes face out of the box
+	ViewArea.planes[SViewFrustum::VF_FAR_PLANE].setPlane(core::vector3df(0.f, 0.f, 1.f), -box.MaxEdge.Z);
+	ViewArea.planes[SViewFrustum::VF_NEAR_PLANE].setPlane(core::vector3df(0.f, 0.f, -1.f), box.MinEdge.Z);
+	ViewArea.planes[SViewFrustum::VF_LEFT_PLANE].setPlane(core::vector3df(-1.f, 0.f, 0.f), box.MinEdge.X);
+	ViewArea.planes[SViewFrustum::VF_RIGHT_PLANE].setPlane(core::vector3df(1.f, 0.f, 0.f), -box.MaxEdge.X);
+	ViewArea.planes[SViewFrustum::VF_BOTTOM_PLANE].setPlane(core::vector3df(0.f, -1.f, 0.f), box.MinEdge.Y);
+	ViewArea.planes[SViewFrustum::VF_TOP_PLANE].setPlane(core::vector3df(0.f, 1.f, 0.f), -box.MaxEdge.Y);
+	ViewArea.setFarNearDistance(ZFar - ZNear);
+	ViewArea.recalculateBoundingBox();
+
+	setPosition(ViewArea.cameraPosition);
+	updateAbsolutePosition();
+}
+
+} // end namespace scene
+} // end namespace irr
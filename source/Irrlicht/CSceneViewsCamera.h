@@ -0,0 +1,47 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCENE_VIEWS_CAMERA_H_INCLUDED__
+#define __C_SCENE_VIEWS_CAMERA_H_INCLUDED__
+
+#include "CCameraSceneNode.h"
+#include "SSceneView.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! Camera the nodes are culled against when several views are drawn at once
+/** Its frustum encloses the frustums of the cameras of the views. It has the
+planes of the first view, each moved out until the corners of all views are
+behind it. This isn't the tightest volume for views looking into different
+directions, but it never culls a node one of the views sees. The frustum has
+no projection, so the camera isn't rendered, it only stands in for the active
+camera while the nodes cull and register themselves. */
+class CSceneViewsCamera : public CCameraSceneNode
+{
+public:
+
+	//! constructor, the camera isn't part of the scene graph
+	CSceneViewsCamera(ISceneManager* mgr);
+
+	//! Encloses the frustums of the views, their matrices have to be up to date
+	void setViews(const core::array<SSceneView>& views);
+
+	//! Makes the frustum a box, for views around camera like the faces of a cubemap
+	/** The position, matrices and planes distances are taken from camera. */
+	void setBox(const ICameraSceneNode* camera, const core::aabbox3df& box);
+
+	//! Does nothing, the frustum has no projection to render with
+	void render() override {}
+
+	//! Does nothing, keeps the frustum set by setViews
+	void updateMatrices() override {}
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
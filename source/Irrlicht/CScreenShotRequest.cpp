@@ -0,0 +1,91 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CScreenShotRequest.h"
+#include "CImage.h"
+#include "CColorConverter.h"
+
+namespace irr
+{
+namespace video
+{
+
+CScreenShotRequest::CScreenShotRequest(ECOLOR_FORMAT format, const core::dimension2d<u32>& size)
+	: Format(format), Size(size), Pixels(size.getArea() * 4), Image(0), Ready(false), Failed(false)
+{
+}
+
+CScreenShotRequest::CScreenShotRequest(ECOLOR_FORMAT format, IImage* image)
+	: Format(format), Image(image), Ready(image != 0), Failed(image == 0)
+{
+	if (Image)
+	{
+		Image->grab();
+		Size = Image->getDimension();
+	}
+}
+
+CScreenShotRequest::~CScreenShotRequest()
+{
+	if (Image)
+		Image->drop();
+}
+
+bool CScreenShotRequest::isReady() const
+{
+	return Ready.load(std::memory_order_acquire);
+}
+
+bool CScreenShotRequest::isFailed() const
+{
+	return Failed.load(std::memory_order_acquire);
+}
+
+IImage* CScreenShotRequest::createImage() const
+{
+	if (!isReady())
+		return 0;
+
+	IImage* image = new CImage(Format, Size);
+
+	if (Image)
+	{
+		CColorConverter::convert_viaFormat(Image->getData(), Image->getColorFormat(), Size.getArea(), image->getData(), Format);
+		return image;
+	}
+
+	// OpenGL rows start at the bottom and GL_RGBA has red and blue swapped compared to ECF_A8R8G8B8
+	const u32 rowSize = Size.Width * 4;
+	u8* row = (Format != ECF_A8R8G8B8) ? new u8[rowSize] : 0;
+	u8* dst = static_cast<u8*>(image->getData());
+	for (u32 y = 0; y < Size.Height; ++y)
+	{
+		const u8* src = Pixels.data() + (Size.Height - 1 - y) * rowSize;
+		if (row)
+		{
+			CColorConverter::convert_A8R8G8B8toA8B8G8R8(src, Size.Width, row);
+			CColorConverter::convert_viaFormat(row, ECF_A8R8G8B8, Size.Width, dst, Format);
+		}
+		else
+		{
+			CColorConverter::convert_A8R8G8B8toA8B8G8R8(src, Size.Width, dst);
+		}
+		dst += image->getPitch();
+	}
+	delete[] row;
+
+	return image;
+}
+
+void CScreenShotRequest::setReady()
+{
+	Ready.store(true, std::memory_order_release);
+}
+
+void CScreenShotRequest::setFailed()
+{
+	Failed.store(true, std::memory_order_release);
+}
+
+} // end namespace video
+} // end namespace irr
@@ -0,0 +1,62 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SCREEN_SHOT_REQUEST_H_INCLUDED__
+#define __C_SCREEN_SHOT_REQUEST_H_INCLUDED__
+
+#include "IScreenShotRequest.h"
+#include "IImage.h"
+#include <atomic>
+#include <vector>
+
+namespace irr
+{
+namespace video
+{
+
+//! IScreenShotRequest implementation, filled by the driver on the render thread
+class CScreenShotRequest : public IScreenShotRequest
+{
+public:
+	//! Request for pixels which are written to getPixels() later
+	/** \param format Format of the images created from the request. */
+	CScreenShotRequest(ECOLOR_FORMAT format, const core::dimension2d<u32>& size);
+
+	//! Request which is ready right away
+	/** \param image Screenshot taken synchronously, grabbed by the request.
+	May be 0, the request fails then. */
+	CScreenShotRequest(ECOLOR_FORMAT format, IImage* image);
+
+	~CScreenShotRequest();
+
+	bool isReady() const override;
+
+	bool isFailed() const override;
+
+	IImage* createImage() const override;
+
+	//! Buffer receiving the pixels as GL_RGBA/GL_UNSIGNED_BYTE, bottom row first
+	/** Only to be written before setReady() is called. */
+	u8* getPixels() { return Pixels.data(); }
+
+	u32 getPixelsSize() const { return Pixels.size(); }
+
+	//! Makes the pixels written to getPixels() available to other threads
+	void setReady();
+
+	void setFailed();
+
+private:
+	ECOLOR_FORMAT Format;
+	core::dimension2d<u32> Size;
+	std::vector<u8> Pixels;
+	IImage* Image;
+
+	std::atomic<bool> Ready;
+	std::atomic<bool> Failed;
+};
+
+} // end namespace video
+} // end namespace irr
+
+#endif
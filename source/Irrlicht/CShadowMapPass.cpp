@@ -0,0 +1,291 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CShadowMapPass.h"
+#include "IVideoDriver.h"
+#include "IRenderTarget.h"
+#include "ICameraSceneNode.h"
+#include "SViewFrustum.h"
+#include "os.h"
+#include <cmath>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	// FNV-1a
+	void hashBytes(u64& hash, const void* data, size_t size)
+	{
+		const u8* bytes = static_cast<const u8*>(data);
+		for (size_t i = 0; i < size; ++i)
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+
+	// the elements only, matrices may carry a flag besides them
+	void hashMatrix(u64& hash, const core::matrix4& matrix)
+	{
+		hashBytes(hash, matrix.pointer(), 16 * sizeof(f32));
+	}
+
+	inline f32 snap(f32 value, f32 step)
+	{
+		return floorf(value / step) * step;
+	}
+} // end anonymous namespace
+
+CShadowMapPass::CShadowMapPass() : TargetCount(0), TargetsDirty(true)
+{
+}
+
+void CShadowMapPass::setParameters(const SShadowMapParameters& parameters)
+{
+	SShadowMapParameters clamped = parameters;
+	clamped.CascadeCount = core::clamp(clamped.CascadeCount, 1u, MAX_SHADOW_CASCADES);
+	clamped.Resolution = core::max_(clamped.Resolution, 1u);
+
+	if (clamped.CascadeCount != Parameters.CascadeCount || clamped.Resolution != Parameters.Resolution)
+		TargetsDirty = true;
+
+	Parameters = clamped;
+	invalidate();
+}
+
+void CShadowMapPass::invalidate()
+{
+	for (u32 i = 0; i < MAX_SHADOW_CASCADES; ++i)
+		Cascades[i].Drawn = false;
+}
+
+video::ITexture* CShadowMapPass::getTexture(u32 cascade) const
+{
+	return cascade < TargetCount && Cascades[cascade].Drawn ? Cascades[cascade].Depth : 0;
+}
+
+const core::matrix4& CShadowMapPass::getMatrix(u32 cascade) const
+{
+	return cascade < MAX_SHADOW_CASCADES ? Cascades[cascade].ViewProjection : core::IdentityMatrix;
+}
+
+f32 CShadowMapPass::getSplit(u32 cascade) const
+{
+	return cascade < MAX_SHADOW_CASCADES ? Cascades[cascade].Split : 0.f;
+}
+
+void CShadowMapPass::release(video::IVideoDriver* driver)
+{
+	for (u32 i = 0; i < TargetCount; ++i)
+	{
+		SCascade& cascade = Cascades[i];
+		if (cascade.Target)
+			driver->removeRenderTarget(cascade.Target);
+		if (cascade.Depth)
+			driver->removeTexture(cascade.Depth);
+		cascade = SCascade();
+	}
+	TargetCount = 0;
+	TargetsDirty = true;
+}
+
+bool CShadowMapPass::createTargets(video::IVideoDriver* driver)
+{
+	video::ECOLOR_FORMAT format = video::ECF_D16;
+	if (driver->queryTextureFormat(video::ECF_D32))
+		format = video::ECF_D32;
+	else if (driver->queryTextureFormat(video::ECF_D24S8))
+		format = video::ECF_D24S8;
+
+	const core::dimension2du size(Parameters.Resolution, Parameters.Resolution);
+	for (u32 i = 0; i < Parameters.CascadeCount; ++i)
+	{
+		SCascade& cascade = Cascades[i];
+		c8 name[32];
+		snprintf_irr(name, sizeof(name), "<shadow map %u>", i);
+		cascade.Depth = driver->addRenderTargetTexture(size, name, format);
+		cascade.Target = cascade.Depth ? driver->addRenderTarget() : 0;
+		// count the cascade right away, so release() removes it on failure
+		TargetCount = i + 1;
+		if (!cascade.Target)
+			return false;
+		cascade.Target->setTexture(0, cascade.Depth);
+	}
+	return true;
+}
+
+void CShadowMapPass::draw(video::IVideoDriver* driver, const ICameraSceneNode* camera)
+{
+	if (TargetsDirty)
+	{
+		release(driver);
+		TargetsDirty = false;
+		if (!createTargets(driver))
+		{
+			os::Printer::log("Could not create the shadow map render targets.", ELL_ERROR);
+			release(driver);
+			// don't try again before the parameters change
+			TargetsDirty = false;
+			return;
+		}
+	}
+
+	if (!TargetCount || !camera)
+		return;
+
+	// basis of the light space, as built by buildCameraLookAtMatrixLH()
+	LightZ = Parameters.LightDirection;
+	if (LightZ.getLengthSQ() == 0.f)
+		LightZ.set(0.f, -1.f, 0.f);
+	LightZ.normalize();
+	const core::vector3df up = fabsf(LightZ.Y) > 0.99f ? core::vector3df(1.f, 0.f, 0.f) : core::vector3df(0.f, 1.f, 0.f);
+	LightX = up.crossProduct(LightZ).normalize();
+	LightY = LightZ.crossProduct(LightX);
+
+	// casters are tested against all cascades, transform their boxes once
+	CasterBoxes.set_used(Casters.size());
+	for (u32 i = 0; i < Casters.size(); ++i)
+	{
+		const core::aabbox3df box = Casters[i]->getTransformedBoundingBox();
+		const core::vector3df center = box.getCenter();
+		const core::vector3df extent = box.getExtent() * 0.5f;
+		const core::vector3df lightCenter(center.dotProduct(LightX), center.dotProduct(LightY), center.dotProduct(LightZ));
+		const core::vector3df lightExtent(
+			fabsf(extent.X * LightX.X) + fabsf(extent.Y * LightX.Y) + fabsf(extent.Z * LightX.Z),
+			fabsf(extent.X * LightY.X) + fabsf(extent.Y * LightY.Y) + fabsf(extent.Z * LightY.Z),
+			fabsf(extent.X * LightZ.X) + fabsf(extent.Y * LightZ.Y) + fabsf(extent.Z * LightZ.Z));
+		CasterBoxes[i].MinEdge = lightCenter - lightExtent;
+		CasterBoxes[i].MaxEdge = lightCenter + lightExtent;
+	}
+
+	const SViewFrustum* frustum = camera->getViewFrustum();
+	const f32 nearValue = core::max_(camera->getNearValue(), 0.001f);
+	const f32 farValue = core::max_(camera->getFarValue(), nearValue * 2.f);
+	const f32 maxDistance = Parameters.MaxDistance > 0.f ? core::clamp(Parameters.MaxDistance, nearValue * 2.f, farValue) : farValue;
+
+	// the corners move linearly with the depth, for perspective and orthogonal cameras
+	const core::vector3df nearCorners[4] = { frustum->getNearLeftUp(), frustum->getNearRightUp(),
+		frustum->getNearLeftDown(), frustum->getNearRightDown() };
+	const core::vector3df farCorners[4] = { frustum->getFarLeftUp(), frustum->getFarRightUp(),
+		frustum->getFarLeftDown(), frustum->getFarRightDown() };
+
+	video::IRenderTarget* const previousTarget = driver->getCurrentRenderTarget();
+	const core::rect<s32> viewPort = driver->getViewPort();
+	const core::matrix4 view = driver->getTransform(video::ETS_VIEW);
+	const core::matrix4 projection = driver->getTransform(video::ETS_PROJECTION);
+	bool targetChanged = false;
+
+	// the light projections map depth the conventional way
+	const bool reverseDepth = driver->isReverseDepth();
+	driver->setReverseDepth(false);
+
+	f32 sliceNear = nearValue;
+	for (u32 i = 0; i < TargetCount; ++i)
+	{
+		// the practical split scheme, blending logarithmic and uniform splits
+		const f32 fraction = (f32)(i + 1) / TargetCount;
+		const f32 logSplit = nearValue * powf(maxDistance / nearValue, fraction);
+		const f32 uniformSplit = nearValue + (maxDistance - nearValue) * fraction;
+		const f32 sliceFar = Parameters.SplitLambda * logSplit + (1.f - Parameters.SplitLambda) * uniformSplit;
+
+		core::vector3df corners[8];
+		const f32 nearT = (sliceNear - nearValue) / (farValue - nearValue);
+		const f32 farT = (sliceFar - nearValue) / (farValue - nearValue);
+		for (u32 k = 0; k < 4; ++k)
+		{
+			const core::vector3df edge = farCorners[k] - nearCorners[k];
+			corners[k] = nearCorners[k] + edge * nearT;
+			corners[k + 4] = nearCorners[k] + edge * farT;
+		}
+
+		Cascades[i].Split = sliceFar;
+		if (drawCascade(driver, Cascades[i], corners))
+			targetChanged = true;
+		sliceNear = sliceFar;
+	}
+
+	driver->setReverseDepth(reverseDepth);
+	if (targetChanged)
+	{
+		driver->setRenderTargetEx(previousTarget, 0);
+		driver->setViewPort(viewPort);
+		driver->setTransform(video::ETS_VIEW, view);
+		driver->setTransform(video::ETS_PROJECTION, projection);
+	}
+}
+
+bool CShadowMapPass::drawCascade(video::IVideoDriver* driver, SCascade& cascade, const core::vector3df* sliceCorners)
+{
+	// bound the slice with a sphere, so the cascade doesn't change its size
+	// when the camera turns
+	core::vector3df center;
+	for (u32 k = 0; k < 8; ++k)
+		center += sliceCorners[k];
+	center *= 0.125f;
+
+	f32 radiusSQ = 0.f;
+	for (u32 k = 0; k < 8; ++k)
+		radiusSQ = core::max_(radiusSQ, center.getDistanceFromSQ(sliceCorners[k]));
+	// rounded up, against flickering from rounding errors
+	const f32 radius = ceilf(sqrtf(radiusSQ) * 16.f) / 16.f;
+
+	// move in steps of whole texels only, so the shadow edges stay in place
+	const f32 texel = 2.f * radius / Parameters.Resolution;
+	const core::vector3df lightCenter(snap(center.dotProduct(LightX), texel),
+		snap(center.dotProduct(LightY), texel), snap(center.dotProduct(LightZ), texel));
+	const f32 maxZ = lightCenter.Z + radius;
+	f32 minZ = lightCenter.Z - radius;
+	const f32 minCasterZ = minZ - Parameters.CasterDistance;
+
+	// the casters overlapping the cascade, including those towards the light
+	bool dynamic = false;
+	f32 nearestZ = minZ;
+	CascadeCasters.set_used(0);
+	for (u32 i = 0; i < Casters.size(); ++i)
+	{
+		const core::aabbox3df& box = CasterBoxes[i];
+		if (box.MaxEdge.X < lightCenter.X - radius || box.MinEdge.X > lightCenter.X + radius ||
+			box.MaxEdge.Y < lightCenter.Y - radius || box.MinEdge.Y > lightCenter.Y + radius ||
+			box.MaxEdge.Z < minCasterZ || box.MinEdge.Z > maxZ)
+			continue;
+
+		CascadeCasters.push_back(i);
+		nearestZ = core::min_(nearestZ, box.MinEdge.Z);
+		if (Casters[i]->getType() == ESNT_ANIMATED_MESH)
+			dynamic = true;
+	}
+	minZ = core::max_(nearestZ, minCasterZ);
+
+	const core::vector3df eye = LightX * lightCenter.X + LightY * lightCenter.Y + LightZ * minZ;
+	cascade.View.buildCameraLookAtMatrixLH(eye, eye + LightZ, LightY);
+	cascade.Projection.buildProjectionMatrixOrthoLH(2.f * radius, 2.f * radius, 0.f, maxZ - minZ,
+		driver->getDriverType() != video::EDT_OPENGL);
+	cascade.ViewProjection = cascade.Projection * cascade.View;
+
+	u64 signature = 14695981039346656037ull;
+	hashMatrix(signature, cascade.ViewProjection);
+	for (u32 i = 0; i < CascadeCasters.size(); ++i)
+	{
+		const ISceneNode* node = Casters[CascadeCasters[i]];
+		hashBytes(signature, &node, sizeof(node));
+		hashMatrix(signature, node->getAbsoluteTransformation());
+		hashBytes(signature, &CasterBoxes[CascadeCasters[i]], sizeof(core::aabbox3df));
+	}
+
+	if (cascade.Drawn && !dynamic && signature == cascade.Signature)
+		return false;
+	cascade.Signature = signature;
+	cascade.Drawn = true;
+
+	driver->setRenderTargetEx(cascade.Target, video::ECBF_DEPTH, video::SColor(0), 1.f);
+	driver->setTransform(video::ETS_VIEW, cascade.View);
+	driver->setTransform(video::ETS_PROJECTION, cascade.Projection);
+
+	for (u32 i = 0; i < CascadeCasters.size(); ++i)
+		Casters[CascadeCasters[i]]->render();
+
+	return true;
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,108 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_SHADOW_MAP_PASS_H_INCLUDED__
+#define __C_SHADOW_MAP_PASS_H_INCLUDED__
+
+#include "SShadowMapParameters.h"
+#include "matrix4.h"
+#include "aabbox3d.h"
+#include "irrArray.h"
+
+namespace irr
+{
+namespace video
+{
+	class IVideoDriver;
+	class ITexture;
+	class IRenderTarget;
+} // end namespace video
+
+namespace scene
+{
+	class ISceneNode;
+	class ICameraSceneNode;
+
+//! Draws the nodes registered for ESNRP_SHADOW into cascaded shadow maps
+/** Each cascade bounds a slice of the camera frustum with a sphere, seen by an
+orthographic projection along the light direction. Its center is snapped to
+the texels of the cascade, so the cascade keeps its transformation as long as
+the camera stays within a texel, and the depth texture from the previous frame
+is reused while its casters don't change either. */
+class CShadowMapPass
+{
+public:
+	CShadowMapPass();
+
+	//! Sets the parameters, the textures are recreated by the next draw() if needed
+	void setParameters(const SShadowMapParameters& parameters);
+
+	const SShadowMapParameters& getParameters() const { return Parameters; }
+
+	//! Adds a caster for the current frame
+	void addCaster(ISceneNode* node) { Casters.push_back(node); }
+
+	//! Forgets the casters of the current frame
+	void clearCasters() { Casters.set_used(0); }
+
+	//! Draws the cascades for the view of a camera, keeping the current render target
+	/** The render pass of the scene manager has to be ESNRP_SHADOW meanwhile. */
+	void draw(video::IVideoDriver* driver, const ICameraSceneNode* camera);
+
+	//! Removes the textures and render targets from the driver
+	void release(video::IVideoDriver* driver);
+
+	//! Draws all cascades again in the next draw()
+	void invalidate();
+
+	video::ITexture* getTexture(u32 cascade) const;
+
+	const core::matrix4& getMatrix(u32 cascade) const;
+
+	f32 getSplit(u32 cascade) const;
+
+private:
+	struct SCascade
+	{
+		SCascade() : Depth(0), Target(0), Split(0.f), Signature(0), Drawn(false) {}
+
+		video::ITexture* Depth;
+		video::IRenderTarget* Target;
+		core::matrix4 View;
+		core::matrix4 Projection;
+		//! world to clip space, the product of Projection and View
+		core::matrix4 ViewProjection;
+		f32 Split;
+		//! hash of the transformation and casters the texture was drawn with
+		u64 Signature;
+		bool Drawn;
+	};
+
+	//! creates the textures and render targets of all cascades
+	bool createTargets(video::IVideoDriver* driver);
+
+	//! computes the transformation of a cascade and draws it if anything changed
+	/** \return True if the render target was changed. */
+	bool drawCascade(video::IVideoDriver* driver, SCascade& cascade, const core::vector3df* sliceCorners);
+
+	SShadowMapParameters Parameters;
+	SCascade Cascades[MAX_SHADOW_CASCADES];
+	//! number of cascades with targets, 0 until they were created
+	u32 TargetCount;
+	//! the textures have to be recreated for new parameters
+	bool TargetsDirty;
+
+	core::array<ISceneNode*> Casters;
+	//! bounding boxes of the casters in the basis of the light, filled by draw()
+	core::array<core::aabbox3df> CasterBoxes;
+	//! casters overlapping the current cascade
+	core::array<u32> CascadeCasters;
+
+	//! basis of the light space, the z axis points along the light
+	core::vector3df LightX, LightY, LightZ;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -3,12 +3,88 @@
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
 #include "CSkinnedMesh.h"
+#include "CAnimationClip.h"
 #include "CBoneSceneNode.h"
 #include "IAnimatedMeshSceneNode.h"
+#include "CJobSystem.h"
 #include "os.h"
+#include "CProfiler.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _IRR_SKINNING_SSE2_
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define _IRR_SKINNING_NEON_
+#endif
 
 namespace
 {
+#if defined(_IRR_SKINNING_SSE2_)
+	typedef __m128 f32x4;
+
+	inline f32x4 load4(const irr::f32* p) { return _mm_loadu_ps(p); }
+	inline void store4(irr::f32* p, f32x4 a) { _mm_storeu_ps(p, a); }
+	inline f32x4 zero4() { return _mm_setzero_ps(); }
+	inline f32x4 splat4(irr::f32 v) { return _mm_set1_ps(v); }
+	inline f32x4 madd4(f32x4 a, f32x4 b, f32x4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	inline f32x4 set4(irr::f32 a, irr::f32 b, irr::f32 c, irr::f32 d) { return _mm_setr_ps(a, b, c, d); }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+	inline f32x4 div4(f32x4 a, f32x4 b) { return _mm_div_ps(a, b); }
+	inline f32x4 sqrt4(f32x4 a) { return _mm_sqrt_ps(a); }
+	inline f32x4 max4(f32x4 a, f32x4 b) { return _mm_max_ps(a, b); }
+	//! 1 where a is negative, else 0
+	inline f32x4 negative4(f32x4 a) { return _mm_and_ps(_mm_cmplt_ps(a, _mm_setzero_ps()), _mm_set1_ps(1.f)); }
+#elif defined(_IRR_SKINNING_NEON_)
+	typedef float32x4_t f32x4;
+
+	inline f32x4 load4(const irr::f32* p) { return vld1q_f32(p); }
+	inline void store4(irr::f32* p, f32x4 a) { vst1q_f32(p, a); }
+	inline f32x4 zero4() { return vdupq_n_f32(0.f); }
+	inline f32x4 splat4(irr::f32 v) { return vdupq_n_f32(v); }
+	inline f32x4 madd4(f32x4 a, f32x4 b, f32x4 c) { return vmlaq_f32(c, a, b); }
+	inline f32x4 set4(irr::f32 a, irr::f32 b, irr::f32 c, irr::f32 d) { const irr::f32 v[4] = { a, b, c, d }; return vld1q_f32(v); }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+	inline f32x4 div4(f32x4 a, f32x4 b) { return vdivq_f32(a, b); }
+	inline f32x4 sqrt4(f32x4 a) { return vsqrtq_f32(a); }
+	inline f32x4 max4(f32x4 a, f32x4 b) { return vmaxq_f32(a, b); }
+	inline f32x4 negative4(f32x4 a) { return vbslq_f32(vcltq_f32(a, vdupq_n_f32(0.f)), vdupq_n_f32(1.f), vdupq_n_f32(0.f)); }
+#else
+	struct f32x4
+	{
+		irr::f32 v[4];
+	};
+
+	inline f32x4 load4(const irr::f32* p) { f32x4 r; for (irr::u32 i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+	inline void store4(irr::f32* p, f32x4 a) { for (irr::u32 i = 0; i < 4; ++i) p[i] = a.v[i]; }
+	inline f32x4 splat4(irr::f32 v) { f32x4 r; for (irr::u32 i = 0; i < 4; ++i) r.v[i] = v; return r; }
+	inline f32x4 zero4() { return splat4(0.f); }
+	inline f32x4 madd4(f32x4 a, f32x4 b, f32x4 c) { for (irr::u32 i = 0; i < 4; ++i) c.v[i] += a.v[i] * b.v[i]; return c; }
+	inline f32x4 set4(irr::f32 a, irr::f32 b, irr::f32 c, irr::f32 d) { f32x4 r = { { a, b, c, d } }; return r; }
+	inline f32x4 sub4(f32x4 a, f32x4 b) { for (irr::u32 i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+	inline f32x4 mul4(f32x4 a, f32x4 b) { for (irr::u32 i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+	inline f32x4 div4(f32x4 a, f32x4 b) { for (irr::u32 i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+	inline f32x4 sqrt4(f32x4 a) { for (irr::u32 i = 0; i < 4; ++i) a.v[i] = sqrtf(a.v[i]); return a; }
+	inline f32x4 max4(f32x4 a, f32x4 b) { for (irr::u32 i = 0; i < 4; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+	inline f32x4 negative4(f32x4 a) { for (irr::u32 i = 0; i < 4; ++i) a.v[i] = a.v[i] < 0.f ? 1.f : 0.f; return a; }
+#endif
+
+	//! Divides x, y and z by the length of the vectors they form, zero vectors stay zero
+	inline void normalize4(f32x4& x, f32x4& y, f32x4& z)
+	{
+		const f32x4 length = sqrt4(max4(madd4(x, x, madd4(y, y, mul4(z, z))), splat4(1e-30f)));
+		const f32x4 inverse = div4(splat4(1.f), length);
+		x = mul4(x, inverse);
+		y = mul4(y, inverse);
+		z = mul4(z, inverse);
+	}
+
+	//! Meshes with fewer indices get their tangents on the calling thread
+	const irr::u32 PARALLEL_TANGENTS_MIN_INDICES = 65536;
+
 	// Frames must always be increasing, so we remove objects where this isn't the case
 	// return number of kicked keys
 	template <class T> // T = objects containing a "frame" variable
@@ -34,6 +110,41 @@ namespace
 		return d;
 	}
 
+	// Find the first key which isn't before frame, or -1 if frame is past the last key.
+	// Playing forward mostly stays on the hint or moves to the next key, everything
+	// else (looping, seeking, playing backwards) is a binary search over the keys.
+	template <class T> // T = objects containing a "frame" variable
+	irr::s32 findKey(const irr::core::array<T>& array, irr::f32 frame, irr::s32& hint)
+	{
+		const irr::s32 count = (irr::s32)array.size();
+
+		if (hint>=0 && hint<count)
+		{
+			if (hint>0 && array[hint].frame>=frame && array[hint-1].frame<frame)
+				return hint;
+			if (hint+1<count && array[hint+1].frame>=frame && array[hint].frame<frame)
+				return ++hint;
+		}
+
+		// keys are sorted by frame, see dropBadKeys
+		irr::s32 first = 0;
+		irr::s32 last = count;
+		while (first<last)
+		{
+			const irr::s32 middle = first + (last-first)/2;
+			if (array[middle].frame<frame)
+				first = middle+1;
+			else
+				last = middle;
+		}
+
+		if (first==count)
+			return -1;
+
+		hint = first;
+		return first;
+	}
+
 	// drop identical middle keys - we only need the first and last
 	// return number of kicked keys
 	template <class T, typename Cmp> // Cmp = comparison for keys of type T
@@ -86,10 +197,56 @@ namespace irr
 namespace scene
 {
 
+namespace
+{
+	//! A weight of SkinningVertices before they are built
+	struct SSortedWeight
+	{
+		u32 Buffer;
+		u32 Vertex;
+		u32 Joint;
+		const ISkinnedMesh::SWeight* Weight;
+	};
+
+	//! Memory reused by finalize() and buildSkeleton() of all meshes
+	/** One per thread, as the loaders finalize meshes on their threads. */
+	struct SFinalizeScratch
+	{
+		//! first index of each joint in AllJoints
+		std::unordered_map<const ISkinnedMesh::SJoint*, u32> JointNumbers;
+		std::vector<u8> HasParent;
+		//! first vertex of each buffer in VertexWeights and TotalWeights, and the total
+		std::vector<u32> BufferStarts;
+		//! first weight of each vertex in SortedWeights
+		std::vector<u32> VertexWeights;
+		std::vector<SSortedWeight> SortedWeights;
+		std::vector<f32> TotalWeights;
+		std::vector<s32> JointBoxes;
+		std::vector<u8> Moved;
+	};
+
+	SFinalizeScratch& getFinalizeScratch()
+	{
+		static thread_local SFinalizeScratch scratch;
+		return scratch;
+	}
+
+	//! Sets the first vertex of each buffer in all buffers
+	void setBufferStarts(const core::array<SSkinMeshBuffer*>& buffers, std::vector<u32>& starts)
+	{
+		starts.resize(buffers.size()+1);
+		starts[0] = 0;
+		for (u32 i=0; i<buffers.size(); ++i)
+			starts[i+1] = starts[i] + buffers[i]->getVertexCount();
+	}
+}
+
 
 //! constructor
 CSkinnedMesh::CSkinnedMesh()
-: SkinningBuffers(0), EndFrame(0.f), FramesPerSecond(25.f),
+: SkinningBuffers(0), JointIndexCount(0), LoopBoxesGeneration(0), Clip(0), ClipJoints(0), PoseGeneration(0),
+	BakedBegin(0), BakedEnd(0), BakedSamples(1), BakedInterpolate(true),
+	EndFrame(0.f), FramesPerSecond(25.f),
 	LastAnimatedFrame(-1), SkinnedLastFrame(false),
 	InterpolationMode(EIM_LINEAR),
 	HasAnimation(false), PreparedForSkinning(false),
@@ -114,6 +271,17 @@ CSkinnedMesh::~CSkinnedMesh()
 		if (LocalBuffers[j])
 			LocalBuffers[j]->drop();
 	}
+
+	for (u32 p=0; p<Poses.size(); ++p)
+	{
+		Poses[p]->Mesh->drop();
+		delete Poses[p];
+	}
+
+	clearBakedFrames();
+
+	if (Clip)
+		Clip->drop();
 }
 
 
@@ -173,114 +341,205 @@ void CSkinnedMesh::animateMesh(f32 frame, f32 blend)
 	if (blend<=0.f)
 		return; //No need to animate
 
-	for (u32 i=0; i<AllJoints.size(); ++i)
+	sampleSkeleton(frame, blend);
+
+	//Note:
+	//LocalAnimatedMatrix needs to be built at some point, but this function may be called lots of times for
+	//one render (to play two animations at the same time) LocalAnimatedMatrix only needs to be built once.
+	//a call to buildAllLocalAnimatedMatrices is needed before skinning the mesh, and before the user gets the joints to move
+
+	//----------------
+	// Temp!
+	buildAllLocalAnimatedMatrices();
+	//-----------------
+
+	updateBoundingBox();
+}
+
+
+void CSkinnedMesh::sampleSkeleton(f32 frame, f32 blend)
+{
+	//The joints can be animated here with no input from their
+	//parents, but for setAnimationMode extra checks are needed
+	//to their parents
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
+		sampleJoint(frame, i, blend);
+
+	blendSamples();
+
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
 	{
-		//The joints can be animated here with no input from their
-		//parents, but for setAnimationMode extra checks are needed
-		//to their parents
-		SJoint *joint = AllJoints[i];
+		SJoint *joint = SkeletonJoints[i];
+		joint->Animatedposition = SkeletonPositions[i];
+		joint->Animatedscale = SkeletonScales[i];
+		joint->Animatedrotation = SkeletonRotations[i];
+	}
+}
 
-		const core::vector3df oldPosition = joint->Animatedposition;
-		const core::vector3df oldScale = joint->Animatedscale;
-		const core::quaternion oldRotation = joint->Animatedrotation;
 
-		core::vector3df position = oldPosition;
-		core::vector3df scale = oldScale;
-		core::quaternion rotation = oldRotation;
+void CSkinnedMesh::sampleJoint(f32 frame, u32 i, f32 weight)
+{
+	SJoint *joint = SkeletonJoints[i];
+
+	core::vector3df position = SkeletonPositions[i];
+	core::vector3df scale = SkeletonScales[i];
+	core::quaternion rotation = SkeletonRotations[i];
 
+	if (Clip)
+	{
+		if (SkeletonClipTracks[i] >= 0)
+			Clip->sample((u32)SkeletonClipTracks[i], frame, InterpolationMode != EIM_CONSTANT, position, rotation, scale);
+	}
+	else
+	{
 		getFrameData(frame, joint,
 				position, joint->positionHint,
 				scale, joint->scaleHint,
 				rotation, joint->rotationHint);
+	}
 
-		if (blend==1.0f)
-		{
-			//No blending needed
-			joint->Animatedposition = position;
-			joint->Animatedscale = scale;
-			joint->Animatedrotation = rotation;
-		}
-		else
-		{
-			//Blend animation
-			joint->Animatedposition = core::lerp(oldPosition, position, blend);
-			joint->Animatedscale = core::lerp(oldScale, scale, blend);
-			joint->Animatedrotation.slerp(oldRotation, rotation, blend);
-		}
+	if (weight > 0.f && weight < 1.f)
+	{
+		BlendJoints.push_back(i);
+		BlendWeights.push_back(weight);
+		BlendFromPositions.push_back(SkeletonPositions[i]);
+		BlendFromRotations.push_back(SkeletonRotations[i]);
+		BlendFromScales.push_back(SkeletonScales[i]);
+		BlendToPositions.push_back(position);
+		BlendToRotations.push_back(rotation);
+		BlendToScales.push_back(scale);
+		return;
 	}
 
-	//Note:
-	//LocalAnimatedMatrix needs to be built at some point, but this function may be called lots of times for
-	//one render (to play two animations at the same time) LocalAnimatedMatrix only needs to be built once.
-	//a call to buildAllLocalAnimatedMatrices is needed before skinning the mesh, and before the user gets the joints to move
+	if (weight != 1.f)
+	{
+		// extrapolation, which the batch slerp doesn't approximate
+		position = core::lerp(SkeletonPositions[i], position, weight);
+		scale = core::lerp(SkeletonScales[i], scale, weight);
+		rotation.slerp(SkeletonRotations[i], rotation, weight);
+	}
 
-	//----------------
-	// Temp!
-	buildAllLocalAnimatedMatrices();
-	//-----------------
+	SkeletonPositions[i] = position;
+	SkeletonScales[i] = scale;
+	SkeletonRotations[i] = rotation;
+}
+
+
+void CSkinnedMesh::blendSamples()
+{
+	const u32 count = BlendJoints.size();
+	if (!count)
+		return;
+
+	const f32* weights = BlendWeights.const_pointer();
+	core::lerpArray(BlendToPositions.pointer(), BlendFromPositions.const_pointer(), BlendToPositions.const_pointer(), weights, 1, count);
+	core::lerpArray(BlendToScales.pointer(), BlendFromScales.const_pointer(), BlendToScales.const_pointer(), weights, 1, count);
+	core::slerpArray(BlendToRotations.pointer(), BlendFromRotations.const_pointer(), BlendToRotations.const_pointer(), weights, 1, count);
+
+	for (u32 k=0; k<count; ++k)
+	{
+		const u32 i = BlendJoints[k];
+		SkeletonPositions[i] = BlendToPositions[k];
+		SkeletonRotations[i] = BlendToRotations[k];
+		SkeletonScales[i] = BlendToScales[k];
+	}
+
+	BlendJoints.set_used(0);
+	BlendWeights.set_used(0);
+	BlendFromPositions.set_used(0);
+	BlendFromRotations.set_used(0);
+	BlendFromScales.set_used(0);
+	BlendToPositions.set_used(0);
+	BlendToRotations.set_used(0);
+	BlendToScales.set_used(0);
+}
+
+
+void CSkinnedMesh::beginBlend(f32 frame)
+{
+	if (!HasAnimation)
+		return;
+
+	sampleSkeleton(frame, 1.f);
+}
+
+
+void CSkinnedMesh::blendPose(f32 frame, f32 weight, const core::array<f32>* jointWeights)
+{
+	if (!HasAnimation || weight<=0.f)
+		return;
+
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
+	{
+		f32 jointWeight = weight;
+		if (jointWeights && SkeletonJointNumbers[i] < jointWeights->size())
+			jointWeight *= (*jointWeights)[SkeletonJointNumbers[i]];
+		if (jointWeight<=0.f)
+			continue;
+
+		sampleJoint(frame, i, core::min_(jointWeight, 1.f));
+	}
+
+	blendSamples();
+}
+
+
+void CSkinnedMesh::endBlend()
+{
+	if (!HasAnimation)
+		return;
 
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
+	{
+		SJoint *joint = SkeletonJoints[i];
+		joint->Animatedposition = SkeletonPositions[i];
+		joint->Animatedscale = SkeletonScales[i];
+		joint->Animatedrotation = SkeletonRotations[i];
+	}
+
+	// the pose isn't the one of any frame, animateMesh() has to animate again
+	LastAnimatedFrame = -1.f;
+
+	buildAllLocalAnimatedMatrices();
 	updateBoundingBox();
 }
 
 
 void CSkinnedMesh::buildAllLocalAnimatedMatrices()
 {
-	for (u32 i=0; i<AllJoints.size(); ++i)
-	{
-		SJoint *joint = AllJoints[i];
+	// IRR_TEST_BROKEN_QUATERNION_USE: TODO - switched to getMatrix_transposed instead of getMatrix for downward compatibility.
+	//								   Not tested so far if this was correct or wrong before quaternion fix!
+	// All joints at once, the matrices of not animated joints are just not used
+	core::getMatrixArray_transposed(SkeletonLocalMatrices.pointer(), SkeletonRotations.const_pointer(),
+			SkeletonPositions.const_pointer(), 0, SkeletonJoints.size());
 
-		//Could be faster:
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
+	{
+		SJoint *joint = SkeletonJoints[i];
 
-		if (joint->UseAnimationFrom &&
-			(joint->UseAnimationFrom->PositionKeys.size() ||
-			 joint->UseAnimationFrom->ScaleKeys.size() ||
-			 joint->UseAnimationFrom->RotationKeys.size() ))
+		if (SkeletonAnimation[i] != ESJA_NONE)
 		{
 			joint->GlobalSkinningSpace=false;
 
-			// IRR_TEST_BROKEN_QUATERNION_USE: TODO - switched to getMatrix_transposed instead of getMatrix for downward compatibility.
-			//								   Not tested so far if this was correct or wrong before quaternion fix!
-			joint->Animatedrotation.getMatrix_transposed(joint->LocalAnimatedMatrix);
-
-			// --- joint->LocalAnimatedMatrix *= joint->Animatedrotation.getMatrix() ---
-			f32 *m1 = joint->LocalAnimatedMatrix.pointer();
-			core::vector3df &Pos = joint->Animatedposition;
-			m1[0] += Pos.X*m1[3];
-			m1[1] += Pos.Y*m1[3];
-			m1[2] += Pos.Z*m1[3];
-			m1[4] += Pos.X*m1[7];
-			m1[5] += Pos.Y*m1[7];
-			m1[6] += Pos.Z*m1[7];
-			m1[8] += Pos.X*m1[11];
-			m1[9] += Pos.Y*m1[11];
-			m1[10] += Pos.Z*m1[11];
-			m1[12] += Pos.X*m1[15];
-			m1[13] += Pos.Y*m1[15];
-			m1[14] += Pos.Z*m1[15];
-			// -----------------------------------
-
-			if (joint->ScaleKeys.size())
-			{
-				/*
-				core::matrix4 scaleMatrix;
-				scaleMatrix.setScale(joint->Animatedscale);
-				joint->LocalAnimatedMatrix *= scaleMatrix;
-				*/
+			core::matrix4& mat = joint->LocalAnimatedMatrix;
+			mat = SkeletonLocalMatrices[i];
 
+			if (SkeletonAnimation[i] == ESJA_SCALED)
+			{
 				// -------- joint->LocalAnimatedMatrix *= scaleMatrix -----------------
-				core::matrix4& mat = joint->LocalAnimatedMatrix;
-				mat[0] *= joint->Animatedscale.X;
-				mat[1] *= joint->Animatedscale.X;
-				mat[2] *= joint->Animatedscale.X;
-				mat[3] *= joint->Animatedscale.X;
-				mat[4] *= joint->Animatedscale.Y;
-				mat[5] *= joint->Animatedscale.Y;
-				mat[6] *= joint->Animatedscale.Y;
-				mat[7] *= joint->Animatedscale.Y;
-				mat[8] *= joint->Animatedscale.Z;
-				mat[9] *= joint->Animatedscale.Z;
-				mat[10] *= joint->Animatedscale.Z;
-				mat[11] *= joint->Animatedscale.Z;
+				const core::vector3df &Scale = SkeletonScales[i];
+				mat[0] *= Scale.X;
+				mat[1] *= Scale.X;
+				mat[2] *= Scale.X;
+				mat[3] *= Scale.X;
+				mat[4] *= Scale.Y;
+				mat[5] *= Scale.Y;
+				mat[6] *= Scale.Y;
+				mat[7] *= Scale.Y;
+				mat[8] *= Scale.Z;
+				mat[9] *= Scale.Z;
+				mat[10] *= Scale.Z;
+				mat[11] *= Scale.Z;
 				// -----------------------------------
 			}
 		}
@@ -293,25 +552,103 @@ void CSkinnedMesh::buildAllLocalAnimatedMatrices()
 }
 
 
-void CSkinnedMesh::buildAllGlobalAnimatedMatrices(SJoint *joint, SJoint *parentJoint)
+void CSkinnedMesh::buildAllGlobalAnimatedMatrices()
 {
-	if (!joint)
+	// parents come first, so their global matrix is always ready
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
 	{
-		for (u32 i=0; i<RootJoints.size(); ++i)
-			buildAllGlobalAnimatedMatrices(RootJoints[i], 0);
-		return;
+		SJoint *joint = SkeletonJoints[i];
+		const s32 parent = SkeletonParents[i];
+
+		if (parent < 0 || joint->GlobalSkinningSpace)
+			SkeletonGlobalMatrices[i] = joint->LocalAnimatedMatrix;
+		else
+			SkeletonGlobalMatrices[i].setbyproduct_nocheck(SkeletonGlobalMatrices[parent], joint->LocalAnimatedMatrix);
+
+		joint->GlobalAnimatedMatrix = SkeletonGlobalMatrices[i];
 	}
-	else
+}
+
+
+void CSkinnedMesh::buildSkeleton()
+{
+	buildSkeletonOrder();
+	buildSkeletonData();
+}
+
+
+void CSkinnedMesh::buildSkeletonOrder()
+{
+	SkeletonJoints.set_used(0);
+	SkeletonParents.set_used(0);
+
+	// breadth first, each joint is added behind its parent
+	for (u32 i=0; i<RootJoints.size(); ++i)
+	{
+		SkeletonJoints.push_back(RootJoints[i]);
+		SkeletonParents.push_back(-1);
+	}
+
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
+	{
+		const SJoint *joint = SkeletonJoints[i];
+		for (u32 j=0; j<joint->Children.size(); ++j)
+		{
+			SkeletonJoints.push_back(joint->Children[j]);
+			SkeletonParents.push_back((s32)i);
+		}
+	}
+}
+
+
+void CSkinnedMesh::buildSkeletonData()
+{
+	SFinalizeScratch& scratch = getFinalizeScratch();
+	scratch.JointNumbers.clear();
+	for (u32 i=0; i<AllJoints.size(); ++i)
+		scratch.JointNumbers.emplace(AllJoints[i], i);
+
+	const u32 count = SkeletonJoints.size();
+	SkeletonPositions.set_used(count);
+	SkeletonRotations.set_used(count);
+	SkeletonScales.set_used(count);
+	SkeletonGlobalMatrices.set_used(count);
+	SkeletonLocalMatrices.set_used(count);
+	SkeletonAnimation.set_used(count);
+	SkeletonJointNumbers.set_used(count);
+	SkeletonClipTracks.set_used(count);
+
+	for (u32 i=0; i<count; ++i)
 	{
-		// Find global matrix...
-		if (!parentJoint || joint->GlobalSkinningSpace)
-			joint->GlobalAnimatedMatrix = joint->LocalAnimatedMatrix;
+		const SJoint *joint = SkeletonJoints[i];
+		SkeletonPositions[i] = joint->Animatedposition;
+		SkeletonRotations[i] = joint->Animatedrotation;
+		SkeletonScales[i] = joint->Animatedscale;
+		SkeletonGlobalMatrices[i] = joint->GlobalAnimatedMatrix;
+		const std::unordered_map<const SJoint*, u32>::const_iterator number = scratch.JointNumbers.find(joint);
+		SkeletonJointNumbers[i] = number != scratch.JointNumbers.end() ? number->second : (u32)-1;
+
+		const SJoint *source = joint->UseAnimationFrom;
+		if (Clip)
+		{
+			const s32 track = SkeletonJointNumbers[i] < ClipJoints->size() ? (*ClipJoints)[SkeletonJointNumbers[i]] : -1;
+			SkeletonClipTracks[i] = track;
+			if (track < 0 || (!Clip->isAnimated(track) && !Clip->isScaled(track)))
+				SkeletonAnimation[i] = ESJA_NONE;
+			else if (Clip->isScaled(track))
+				SkeletonAnimation[i] = ESJA_SCALED;
+			else
+				SkeletonAnimation[i] = ESJA_ANIMATED;
+		}
+		else if (!source || (source->PositionKeys.empty() && source->ScaleKeys.empty() && source->RotationKeys.empty()))
+			SkeletonAnimation[i] = ESJA_NONE;
+		else if (joint->ScaleKeys.size())
+			SkeletonAnimation[i] = ESJA_SCALED;
 		else
-			joint->GlobalAnimatedMatrix = parentJoint->GlobalAnimatedMatrix * joint->LocalAnimatedMatrix;
+			SkeletonAnimation[i] = ESJA_ANIMATED;
 	}
 
-	for (u32 j=0; j<joint->Children.size(); ++j)
-		buildAllGlobalAnimatedMatrices(joint->Children[j], joint);
+	buildSkinningVertices();
 }
 
 
@@ -320,10 +657,6 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 				core::vector3df &scale, s32 &scaleHint,
 				core::quaternion &rotation, s32 &rotationHint)
 {
-	s32 foundPositionIndex = -1;
-	s32 foundScaleIndex = -1;
-	s32 foundRotationIndex = -1;
-
 	if (joint->UseAnimationFrom)
 	{
 		const core::array<SPositionKey> &PositionKeys=joint->UseAnimationFrom->PositionKeys;
@@ -332,39 +665,7 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 
 		if (PositionKeys.size())
 		{
-			foundPositionIndex = -1;
-
-			//Test the Hints...
-			if (positionHint>=0 && (u32)positionHint < PositionKeys.size())
-			{
-				//check this hint
-				if (positionHint>0 && PositionKeys[positionHint].frame>=frame && PositionKeys[positionHint-1].frame<frame )
-					foundPositionIndex=positionHint;
-				else if (positionHint+1 < (s32)PositionKeys.size())
-				{
-					//check the next index
-					if ( PositionKeys[positionHint+1].frame>=frame &&
-							PositionKeys[positionHint+0].frame<frame)
-					{
-						positionHint++;
-						foundPositionIndex=positionHint;
-					}
-				}
-			}
-
-			//The hint test failed, do a full scan...
-			if (foundPositionIndex==-1)
-			{
-				for (u32 i=0; i<PositionKeys.size(); ++i)
-				{
-					if (PositionKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundPositionIndex=i;
-						positionHint=i;
-						break;
-					}
-				}
-			}
+			const s32 foundPositionIndex = findKey(PositionKeys, frame, positionHint);
 
 			//Do interpolation...
 			if (foundPositionIndex!=-1)
@@ -389,40 +690,7 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 
 		if (ScaleKeys.size())
 		{
-			foundScaleIndex = -1;
-
-			//Test the Hints...
-			if (scaleHint>=0 && (u32)scaleHint < ScaleKeys.size())
-			{
-				//check this hint
-				if (scaleHint>0 && ScaleKeys[scaleHint].frame>=frame && ScaleKeys[scaleHint-1].frame<frame )
-					foundScaleIndex=scaleHint;
-				else if (scaleHint+1 < (s32)ScaleKeys.size())
-				{
-					//check the next index
-					if ( ScaleKeys[scaleHint+1].frame>=frame &&
-							ScaleKeys[scaleHint+0].frame<frame)
-					{
-						scaleHint++;
-						foundScaleIndex=scaleHint;
-					}
-				}
-			}
-
-
-			//The hint test failed, do a full scan...
-			if (foundScaleIndex==-1)
-			{
-				for (u32 i=0; i<ScaleKeys.size(); ++i)
-				{
-					if (ScaleKeys[i].frame >= frame) //Keys should to be sorted by frame
-					{
-						foundScaleIndex=i;
-						scaleHint=i;
-						break;
-					}
-				}
-			}
+			const s32 foundScaleIndex = findKey(ScaleKeys, frame, scaleHint);
 
 			//Do interpolation...
 			if (foundScaleIndex!=-1)
@@ -447,40 +715,7 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 
 		if (RotationKeys.size())
 		{
-			foundRotationIndex = -1;
-
-			//Test the Hints...
-			if (rotationHint>=0 && (u32)rotationHint < RotationKeys.size())
-			{
-				//check this hint
-				if (rotationHint>0 && RotationKeys[rotationHint].frame>=frame && RotationKeys[rotationHint-1].frame<frame )
-					foundRotationIndex=rotationHint;
-				else if (rotationHint+1 < (s32)RotationKeys.size())
-				{
-					//check the next index
-					if ( RotationKeys[rotationHint+1].frame>=frame &&
-							RotationKeys[rotationHint+0].frame<frame)
-					{
-						rotationHint++;
-						foundRotationIndex=rotationHint;
-					}
-				}
-			}
-
-
-			//The hint test failed, do a full scan...
-			if (foundRotationIndex==-1)
-			{
-				for (u32 i=0; i<RotationKeys.size(); ++i)
-				{
-					if (RotationKeys[i].frame >= frame) //Keys should be sorted by frame
-					{
-						foundRotationIndex=i;
-						rotationHint=i;
-						break;
-					}
-				}
-			}
+			const s32 foundRotationIndex = findKey(RotationKeys, frame, rotationHint);
 
 			//Do interpolation...
 			if (foundRotationIndex!=-1)
@@ -517,17 +752,39 @@ void CSkinnedMesh::getFrameData(f32 frame, SJoint *joint,
 
 //! Preforms a software skin on this mesh based of joint positions
 void CSkinnedMesh::skinMesh()
+{
+	skinMesh(0);
+}
+
+
+void CSkinnedMesh::skinMesh(CJobSystem* jobs, bool normals)
 {
 	if (!HasAnimation || SkinnedLastFrame)
 		return;
 
+	IRR_PROFILE_SCOPE("CSkinnedMesh::skinMesh");
+
 	//----------------
 	// This is marked as "Temp!".  A shiny dubloon to whomever can tell me why.
 	buildAllGlobalAnimatedMatrices();
 	//-----------------
 
 	SkinnedLastFrame=true;
-	if (!HardwareSkinning)
+	if (HardwareSkinning)
+	{
+		//rigid animation
+		for (u32 i=0; i<AllJoints.size(); ++i)
+		{
+			for (u32 j=0; j<AllJoints[i]->AttachedMeshes.size(); ++j)
+			{
+				SSkinMeshBuffer* Buffer=(*SkinningBuffers)[ AllJoints[i]->AttachedMeshes[j] ];
+				Buffer->Transformation=AllJoints[i]->GlobalAnimatedMatrix;
+			}
+		}
+
+		updateJointMatrices();
+	}
+	else
 	{
 		//Software skin....
 		u32 i;
@@ -542,73 +799,599 @@ void CSkinnedMesh::skinMesh()
 			}
 		}
 
-		//clear skinning helper array
-		for (i=0; i<Vertices_Moved.size(); ++i)
-			for (u32 j=0; j<Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j]=false;
+		const bool animateNormals = AnimateNormals;
+		AnimateNormals = animateNormals && normals;
+		skinVertices(jobs);
+		AnimateNormals = animateNormals;
+
+		// skinned again once the normals are needed
+		if (animateNormals && !normals)
+			SkinnedLastFrame = false;
+
+		for (i=0; i<SkinningBuffers->size(); ++i)
+			(*SkinningBuffers)[i]->setDirty(EBT_VERTEX);
+	}
+	updateBoundingBox();
+}
+
+
+void CSkinnedMesh::skinVertices(CJobSystem* jobs)
+{
+	// pull of each joint on its vertices
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
+		SkinningMatrices[i].setbyproduct(SkeletonGlobalMatrices[i], SkeletonJoints[i]->GlobalInversedMatrix);
+
+	// large buffers are split into jobs, which run while the others are skinned here
+	SkinningJobs.set_used(0);
+	if (jobs)
+	{
+		for (u32 b=0; b+1<SkinningBufferStarts.size(); ++b)
+		{
+			const u32 count = SkinningBufferStarts[b+1] - SkinningBufferStarts[b];
+			if (count < 2*SkinningJobVertices)
+				continue;
+
+			for (u32 first=0; first<count; first+=SkinningJobVertices)
+			{
+				SSkinningJob job;
+				job.Mesh = this;
+				job.Buffer = b;
+				job.First = SkinningBufferStarts[b] + first;
+				job.Count = core::min_(SkinningJobVertices, count - first);
+				SkinningJobs.push_back(job);
+			}
+		}
+
+		for (u32 i=0; i<SkinningJobs.size(); ++i)
+			jobs->add(skinJob, &SkinningJobs[i]);
+	}
+
+	for (u32 b=0; b+1<SkinningBufferStarts.size(); ++b)
+	{
+		const u32 count = SkinningBufferStarts[b+1] - SkinningBufferStarts[b];
+		if (!count)
+			continue;
+
+		if (!jobs || count < 2*SkinningJobVertices)
+			skinRange(b, SkinningBufferStarts[b], count);
+
+		// the joint boxes save looking at all vertices again
+		core::aabbox3df box;
+		if (getJointBoundingBox(b, box))
+			(*SkinningBuffers)[b]->setBoundingBox(box);
+		else
+			(*SkinningBuffers)[b]->boundingBoxNeedsRecalculated();
+	}
+
+	if (!SkinningJobs.empty())
+		jobs->wait();
+}
+
+
+void CSkinnedMesh::skinJob(void* data)
+{
+	const SSkinningJob* job = static_cast<const SSkinningJob*>(data);
+	job->Mesh->skinRange(job->Buffer, job->First, job->Count);
+}
+
+
+void CSkinnedMesh::skinRange(u32 buffer, u32 first, u32 count) const
+{
+	SSkinMeshBuffer* target = (*SkinningBuffers)[buffer];
+	u8* vertices = static_cast<u8*>(target->getVertices());
+	const u32 pitch = target->getVertexPitch();
+
+	const SSkinningVertex* vertex = SkinningVertices.const_pointer() + first;
+	const SSkinningInfluence* influences = SkinningInfluences.const_pointer();
+	const core::matrix4* matrices = SkinningMatrices.const_pointer();
+
+	f32 result[4];
+	for (u32 i=0; i<count; ++i, ++vertex)
+	{
+		// blend the columns of the joint matrices, then move the vertex once
+		f32x4 c0 = zero4();
+		f32x4 c1 = zero4();
+		f32x4 c2 = zero4();
+		f32x4 c3 = zero4();
+
+		const SSkinningInfluence* influence = influences + vertex->FirstInfluence;
+		for (u32 k=0; k<vertex->InfluenceCount; ++k, ++influence)
+		{
+			const f32* m = matrices[influence->Joint].pointer();
+			const f32x4 weight = splat4(influence->Weight);
+			c0 = madd4(load4(m), weight, c0);
+			c1 = madd4(load4(m+4), weight, c1);
+			c2 = madd4(load4(m+8), weight, c2);
+			c3 = madd4(load4(m+12), weight, c3);
+		}
+
+		video::S3DVertex* v = reinterpret_cast<video::S3DVertex*>(vertices + vertex->Vertex*pitch);
+
+		const core::vector3df& pos = vertex->StaticPos;
+		store4(result, madd4(c0, splat4(pos.X), madd4(c1, splat4(pos.Y), madd4(c2, splat4(pos.Z), c3))));
+		v->Pos.set(result[0], result[1], result[2]);
+
+		if (AnimateNormals)
+		{
+			const core::vector3df& normal = vertex->StaticNormal;
+			store4(result, madd4(c0, splat4(normal.X), madd4(c1, splat4(normal.Y), madd4(c2, splat4(normal.Z), zero4()))));
+			v->Normal.set(result[0], result[1], result[2]);
+		}
+	}
+}
+
+
+void CSkinnedMesh::buildSkinningVertices()
+{
+	SFinalizeScratch& scratch = getFinalizeScratch();
+	std::vector<u32>& bufferStarts = scratch.BufferStarts;
+	std::vector<u32>& vertexWeights = scratch.VertexWeights;
+	setBufferStarts(LocalBuffers, bufferStarts);
+	const u32 vertexCount = bufferStarts.back();
+
+	// counting sort of the weights by buffer and vertex, keeping the joint order
+	vertexWeights.assign(vertexCount+1, 0);
+	u32 i, j;
+	for (i=0; i<SkeletonJoints.size(); ++i)
+	{
+		const SJoint* joint = SkeletonJoints[i];
+		for (j=0; j<joint->Weights.size(); ++j)
+		{
+			const SWeight& weight = joint->Weights[j];
+			if (weight.buffer_id < LocalBuffers.size() && weight.vertex_id < LocalBuffers[weight.buffer_id]->getVertexCount())
+				++vertexWeights[bufferStarts[weight.buffer_id] + weight.vertex_id + 1];
+		}
+	}
+	for (i=0; i<vertexCount; ++i)
+		vertexWeights[i+1] += vertexWeights[i];
+
+	std::vector<SSortedWeight>& entries = scratch.SortedWeights;
+	entries.resize(vertexWeights[vertexCount]);
+	for (i=0; i<SkeletonJoints.size(); ++i)
+	{
+		const SJoint* joint = SkeletonJoints[i];
+		for (j=0; j<joint->Weights.size(); ++j)
+		{
+			const SWeight& weight = joint->Weights[j];
+			if (weight.buffer_id >= LocalBuffers.size() || weight.vertex_id >= LocalBuffers[weight.buffer_id]->getVertexCount())
+				continue;
+
+			SSortedWeight& entry = entries[vertexWeights[bufferStarts[weight.buffer_id] + weight.vertex_id]++];
+			entry.Buffer = weight.buffer_id;
+			entry.Vertex = weight.vertex_id;
+			entry.Joint = i;
+			entry.Weight = &weight;
+		}
+	}
+
+	SkinningVertices.set_used(0);
+	SkinningInfluences.set_used(0);
+	SkinningBufferStarts.set_used(LocalBuffers.size()+1);
+	SkinningMatrices.set_used(SkeletonJoints.size());
+
+	SkinningVertices.reallocate(vertexCount, false);
+	SkinningInfluences.reallocate((u32)entries.size(), false);
+
+	u32 buffer = 0;
+	for (i=0; i<entries.size(); ++i)
+	{
+		const SSortedWeight& entry = entries[i];
+		while (buffer <= entry.Buffer)
+			SkinningBufferStarts[buffer++] = SkinningVertices.size();
+
+		if (i == 0 || entry.Buffer != entries[i-1].Buffer || entry.Vertex != entries[i-1].Vertex)
+		{
+			SSkinningVertex vertex;
+			vertex.StaticPos = entry.Weight->StaticPos;
+			vertex.StaticNormal = entry.Weight->StaticNormal;
+			vertex.Vertex = entry.Vertex;
+			vertex.FirstInfluence = SkinningInfluences.size();
+			vertex.InfluenceCount = 0;
+			SkinningVertices.push_back(vertex);
+		}
+
+		SSkinningInfluence influence;
+		influence.Joint = entry.Joint;
+		influence.Weight = entry.Weight->strength;
+		SkinningInfluences.push_back(influence);
+		++SkinningVertices.getLast().InfluenceCount;
+	}
+
+	while (buffer <= LocalBuffers.size())
+		SkinningBufferStarts[buffer++] = SkinningVertices.size();
+
+	SkinningBoxes.set_used(0);
+	SkinningBounds.set_used(LocalBuffers.size());
+
+	std::vector<s32>& jointBoxes = scratch.JointBoxes;
+	jointBoxes.resize(SkeletonJoints.size());
+	std::vector<u8>& moved = scratch.Moved;
+
+	for (u32 b=0; b<LocalBuffers.size(); ++b)
+	{
+		SSkinningBounds& bounds = SkinningBounds[b];
+		bounds.FirstBox = SkinningBoxes.size();
+		bounds.HasStatic = false;
+		bounds.HasOrigin = false;
+		bounds.Conservative = true;
+
+		std::fill(jointBoxes.begin(), jointBoxes.end(), -1);
+
+		const IMeshBuffer* localBuffer = LocalBuffers[b];
+		moved.assign(localBuffer->getVertexCount(), 0);
+
+		for (u32 v=SkinningBufferStarts[b]; v<SkinningBufferStarts[b+1]; ++v)
+		{
+			const SSkinningVertex& vertex = SkinningVertices[v];
+			moved[vertex.Vertex] = 1;
+
+			f32 weights = 0.f;
+			for (u32 k=0; k<vertex.InfluenceCount; ++k)
+			{
+				const SSkinningInfluence& influence = SkinningInfluences[vertex.FirstInfluence+k];
+				weights += influence.Weight;
+
+				if (jointBoxes[influence.Joint] == -1)
+				{
+					jointBoxes[influence.Joint] = (s32)SkinningBoxes.size();
+					SSkinningBox box;
+					box.Joint = influence.Joint;
+					box.Box.reset(vertex.StaticPos);
+					SkinningBoxes.push_back(box);
+				}
+				else
+					SkinningBoxes[jointBoxes[influence.Joint]].Box.addInternalPoint(vertex.StaticPos);
+			}
+
+			if (weights > 1.f + 0.001f)
+				bounds.Conservative = false;
+			else if (weights < 1.f - 0.001f)
+				bounds.HasOrigin = true;
+		}
+
+		for (i=0; i<moved.size(); ++i)
+		{
+			if (moved[i])
+				continue;
+
+			const core::vector3df& pos = localBuffer->getPosition(i);
+			if (bounds.HasStatic)
+				bounds.StaticBox.addInternalPoint(pos);
+			else
+				bounds.StaticBox.reset(pos);
+			bounds.HasStatic = true;
+		}
+
+		bounds.BoxCount = SkinningBoxes.size() - bounds.FirstBox;
+	}
+}
+
+
+bool CSkinnedMesh::getJointBoundingBox(u32 buffer, core::aabbox3df& box) const
+{
+	if (buffer >= SkinningBounds.size())
+		return false;
+
+	const SSkinningBounds& bounds = SkinningBounds[buffer];
+	if (!bounds.Conservative || !bounds.BoxCount)
+		return false;
+
+	for (u32 i=0; i<bounds.BoxCount; ++i)
+	{
+		const SSkinningBox& jointBox = SkinningBoxes[bounds.FirstBox+i];
+		core::aabbox3df moved = jointBox.Box;
+		SkinningMatrices[jointBox.Joint].transformBoxEx(moved);
+
+		if (i == 0)
+			box = moved;
+		else
+			box.addInternalBox(moved);
+	}
+
+	if (bounds.HasStatic)
+		box.addInternalBox(bounds.StaticBox);
+	if (bounds.HasOrigin)
+		box.addInternalPoint(core::vector3df(0,0,0));
+
+	return true;
+}
+
+
+core::aabbox3df CSkinnedMesh::getLoopBoundingBox(s32 begin, s32 end)
+{
+	if (!HasAnimation)
+		return BoundingBox;
+
+	if (LoopBoxesGeneration != PoseGeneration)
+	{
+		LoopBoxes.clear();
+		LoopBoxesGeneration = PoseGeneration;
+	}
+
+	const u64 key = ((u64)(u32)begin << 32) | (u32)end;
+	std::unordered_map<u64, core::aabbox3df>::const_iterator it = LoopBoxes.find(key);
+	if (it != LoopBoxes.end())
+		return it->second;
+
+	// the buffers moved by a joint as a whole
+	core::array<s32> attachedJoints;
+	attachedJoints.set_used(LocalBuffers.size());
+	for (u32 b=0; b<attachedJoints.size(); ++b)
+		attachedJoints[b] = -1;
+	for (u32 i=0; i<AllJoints.size(); ++i)
+		for (u32 j=0; j<AllJoints[i]->AttachedMeshes.size(); ++j)
+			attachedJoints[AllJoints[i]->AttachedMeshes[j]] = (s32)i;
+
+	core::aabbox3df loopBox;
+	bool empty = true;
+	for (s32 frame=begin; frame<=end; ++frame)
+	{
+		animateMesh((f32)frame, 1.f);
+		buildAllGlobalAnimatedMatrices();
+		for (u32 i=0; i<SkeletonJoints.size(); ++i)
+			SkinningMatrices[i].setbyproduct(SkeletonGlobalMatrices[i], SkeletonJoints[i]->GlobalInversedMatrix);
+
+		for (u32 b=0; b<LocalBuffers.size(); ++b)
+		{
+			core::aabbox3df box;
+			if (!getJointBoundingBox(b, box))
+				box = LocalBuffers[b]->getBoundingBox();
+
+			if (attachedJoints[b] != -1)
+				AllJoints[attachedJoints[b]]->GlobalAnimatedMatrix.transformBoxEx(box);
+			else
+				LocalBuffers[b]->Transformation.transformBoxEx(box);
+
+			if (empty)
+				loopBox = box;
+			else
+				loopBox.addInternalBox(box);
+			empty = false;
+		}
+	}
+
+	// the joints are in the pose of the last frame, not the one skinned last
+	LastAnimatedFrame = -1.f;
+	SkinnedLastFrame = false;
+
+	if (empty)
+		loopBox = BoundingBox;
+
+	LoopBoxes[key] = loopBox;
+	return loopBox;
+}
+
+
+SMesh* CSkinnedMesh::grabPose(f32 frame, CJobSystem* jobs, bool normals)
+{
+	if (!HasAnimation || HardwareSkinning)
+		return 0;
+
+	if (!BakedFrames.empty())
+	{
+		if (BakedFrames[0]->Generation != PoseGeneration)
+			bakeFrames(BakedBegin, BakedEnd, BakedSamples, BakedInterpolate);
+
+		// the nearest baked frame is shown as it is
+		const f32 position = (frame - BakedBegin) * BakedSamples;
+		if (!BakedInterpolate && position >= 0.f && position <= (f32)(BakedFrames.size()-1))
+		{
+			SPose& pose = *BakedFrames[core::round32(position)];
+			for (u32 i=0; i<pose.Buffers.size(); ++i)
+				pose.Buffers[i]->Material = LocalBuffers[i]->Material;
+
+			pose.Mesh->grab();
+			return pose.Mesh;
+		}
+	}
+
+	u32 index = Poses.size();
+
+	std::unordered_map<f32, u32>::iterator it = PoseCache.find(frame);
+	if (it != PoseCache.end())
+	{
+		SPose* pose = Poses[it->second];
+		if (pose->Generation == PoseGeneration)
+		{
+			if (!normals || !pose->SkippedNormals)
+			{
+				pose->Mesh->grab();
+				return pose->Mesh;
+			}
+
+			// skinned again with its normals, for all nodes showing it
+			index = it->second;
+		}
+		else
+			PoseCache.erase(it);
+	}
+
+	if (index == Poses.size())
+	{
+		// reuse a pose no scene node shows anymore
+		index = 0;
+		while (index < Poses.size() && Poses[index]->Mesh->getReferenceCount() != 1)
+			++index;
+
+		if (index == Poses.size())
+		{
+			SPose* pose = new SPose();
+			pose->Mesh = new SMesh();
+			pose->Generation = PoseGeneration - 1;
+			Poses.push_back(pose);
+		}
+		else
+		{
+			it = PoseCache.find(Poses[index]->Frame);
+			if (it != PoseCache.end() && it->second == index)
+				PoseCache.erase(it);
+		}
+	}
+
+	SPose& pose = *Poses[index];
+	if (pose.Generation != PoseGeneration)
+		copyPoseBuffers(pose);
 
-		//skin starting with the root joints
-		for (i=0; i<RootJoints.size(); ++i)
-			skinJoint(RootJoints[i], 0);
+	if (!interpolateBakedPose(pose, frame))
+		skinPose(pose, frame, jobs, normals);
 
-		for (i=0; i<SkinningBuffers->size(); ++i)
-			(*SkinningBuffers)[i]->setDirty(EBT_VERTEX);
-	}
-	updateBoundingBox();
+	for (u32 i=0; i<pose.Buffers.size(); ++i)
+		pose.Buffers[i]->Material = LocalBuffers[i]->Material;
+
+	pose.Frame = frame;
+	pose.Generation = PoseGeneration;
+	PoseCache[frame] = index;
+
+	pose.Mesh->grab();
+	return pose.Mesh;
 }
 
 
-void CSkinnedMesh::skinJoint(SJoint *joint, SJoint *parentJoint)
+void CSkinnedMesh::skinPose(SPose& pose, f32 frame, CJobSystem* jobs, bool normals)
 {
-	if (joint->Weights.size())
-	{
-		//Find this joints pull on vertices...
-		core::matrix4 jointVertexPull(core::matrix4::EM4CONST_NOTHING);
-		jointVertexPull.setbyproduct(joint->GlobalAnimatedMatrix, joint->GlobalInversedMatrix);
+	animateMesh(frame, 1.0f);
+
+	core::array<SSkinMeshBuffer*>* const skinningBuffers = SkinningBuffers;
+	SkinningBuffers = &pose.Buffers;
+	SkinnedLastFrame = false;
+	skinMesh(jobs, normals);
+	pose.Mesh->BoundingBox = BoundingBox;
+	SkinningBuffers = skinningBuffers;
+	// the local buffers still are in the pose they were in before
+	SkinnedLastFrame = false;
+
+	pose.SkippedNormals = AnimateNormals && !normals;
+}
 
-		core::vector3df thisVertexMove, thisNormalMove;
 
-		core::array<scene::SSkinMeshBuffer*> &buffersUsed=*SkinningBuffers;
+bool CSkinnedMesh::interpolateBakedPose(SPose& pose, f32 frame)
+{
+	if (BakedFrames.empty())
+		return false;
+
+	const f32 position = (frame - BakedBegin) * BakedSamples;
+	if (position < 0.f || position > (f32)(BakedFrames.size()-1))
+		return false;
 
-		//Skin Vertices Positions and Normals...
-		for (u32 i=0; i<joint->Weights.size(); ++i)
+	const u32 first = core::min_((u32)position, BakedFrames.size()-1);
+	const u32 second = core::min_(first+1, BakedFrames.size()-1);
+	const f32 t = position - first;
+	const SPose& poseA = *BakedFrames[first];
+	const SPose& poseB = *BakedFrames[second];
+
+	// vertices which aren't moved by joints are the same in all copies
+	for (u32 b=0; b<pose.Buffers.size(); ++b)
+	{
+		SSkinMeshBuffer* target = pose.Buffers[b];
+		const SSkinMeshBuffer* bufferA = poseA.Buffers[b];
+		const SSkinMeshBuffer* bufferB = poseB.Buffers[b];
+		target->Transformation = t < 0.5f ? bufferA->Transformation : bufferB->Transformation;
+
+		const u32 start = SkinningBufferStarts[b];
+		const u32 end = SkinningBufferStarts[b+1];
+		if (start == end)
+			continue;
+
+		const u32 pitch = target->getVertexPitch();
+		u8* vertices = static_cast<u8*>(target->getVertices());
+		const u8* verticesA = static_cast<const u8*>(bufferA->getVertices());
+		const u8* verticesB = static_cast<const u8*>(bufferB->getVertices());
+
+		for (u32 i=start; i<end; ++i)
 		{
-			SWeight& weight = joint->Weights[i];
+			const u32 offset = SkinningVertices[i].Vertex*pitch;
+			video::S3DVertex* v = reinterpret_cast<video::S3DVertex*>(vertices + offset);
+			const video::S3DVertex* a = reinterpret_cast<const video::S3DVertex*>(verticesA + offset);
+			const video::S3DVertex* c = reinterpret_cast<const video::S3DVertex*>(verticesB + offset);
 
-			// Pull this vertex...
-			jointVertexPull.transformVect(thisVertexMove, weight.StaticPos);
+			v->Pos = a->Pos + (c->Pos - a->Pos) * t;
+			v->Normal = a->Normal + (c->Normal - a->Normal) * t;
+		}
 
-			if (AnimateNormals)
-				jointVertexPull.rotateVect(thisNormalMove, weight.StaticNormal);
+		// the interpolated vertices lie between both frames
+		core::aabbox3df box = bufferA->BoundingBox;
+		box.addInternalBox(bufferB->BoundingBox);
+		target->setBoundingBox(box);
+		target->setDirty(EBT_VERTEX);
+	}
 
-			if (! (*(weight.Moved)) )
-			{
-				*(weight.Moved) = true;
+	pose.Mesh->BoundingBox = poseA.Mesh->BoundingBox;
+	pose.Mesh->BoundingBox.addInternalBox(poseB.Mesh->BoundingBox);
+	pose.SkippedNormals = poseA.SkippedNormals || poseB.SkippedNormals;
+	return true;
+}
 
-				buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Pos = thisVertexMove * weight.strength;
 
-				if (AnimateNormals)
-					buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Normal = thisNormalMove * weight.strength;
+bool CSkinnedMesh::bakeFrames(s32 begin, s32 end, u32 samplesPerFrame, bool interpolate)
+{
+	clearBakedFrames();
 
-				//*(weight._Pos) = thisVertexMove * weight.strength;
-			}
-			else
-			{
-				buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Pos += thisVertexMove * weight.strength;
+	if (!HasAnimation || HardwareSkinning || end < begin || !samplesPerFrame)
+		return false;
 
-				if (AnimateNormals)
-					buffersUsed[weight.buffer_id]->getVertex(weight.vertex_id)->Normal += thisNormalMove * weight.strength;
+	BakedBegin = begin;
+	BakedEnd = end;
+	BakedSamples = samplesPerFrame;
+	BakedInterpolate = interpolate;
 
-				//*(weight._Pos) += thisVertexMove * weight.strength;
-			}
+	const u32 count = (u32)(end - begin) * samplesPerFrame + 1;
+	BakedFrames.reallocate(count);
+	for (u32 i=0; i<count; ++i)
+	{
+		SPose* pose = new SPose();
+		pose->Mesh = new SMesh();
+		copyPoseBuffers(*pose);
+
+		// baked frames don't change anymore
+		for (u32 b=0; b<pose->Buffers.size(); ++b)
+			pose->Buffers[b]->setHardwareMappingHint(EHM_STATIC, EBT_VERTEX);
+
+		pose->Frame = begin + (f32)i / samplesPerFrame;
+		skinPose(*pose, pose->Frame, 0, true);
+		pose->Generation = PoseGeneration;
+		BakedFrames.push_back(pose);
+	}
 
-			buffersUsed[weight.buffer_id]->boundingBoxNeedsRecalculated();
-		}
+	// the poses interpolated from the old frames are outdated
+	PoseCache.clear();
+	return true;
+}
+
+
+void CSkinnedMesh::clearBakedFrames()
+{
+	for (u32 i=0; i<BakedFrames.size(); ++i)
+	{
+		BakedFrames[i]->Mesh->drop();
+		delete BakedFrames[i];
 	}
+	BakedFrames.clear();
+	PoseCache.clear();
+}
+
+
+void CSkinnedMesh::copyPoseBuffers(SPose& pose)
+{
+	pose.Mesh->clear();
+	pose.Buffers.set_used(0);
 
-	//Skin all children
-	for (u32 j=0; j<joint->Children.size(); ++j)
-		skinJoint(joint->Children[j], joint);
+	for (u32 i=0; i<LocalBuffers.size(); ++i)
+	{
+		const SSkinMeshBuffer* local = LocalBuffers[i];
+		SSkinMeshBuffer* buffer = new SSkinMeshBuffer(local->VertexType);
+		buffer->Vertices = local->Vertices;
+		buffer->Indices = local->Indices;
+		buffer->Transformation = local->Transformation;
+		buffer->Material = local->Material;
+		buffer->BoundingBox = local->BoundingBox;
+		buffer->PrimitiveType = local->PrimitiveType;
+		buffer->setHardwareMappingHint(local->getHardwareMappingHint_Vertex(), EBT_VERTEX);
+		buffer->setHardwareMappingHint(local->getHardwareMappingHint_Index(), EBT_INDEX);
+
+		pose.Mesh->addMeshBuffer(buffer);
+		pose.Buffers.push_back(buffer);
+		buffer->drop();
+	}
 }
 
 
@@ -637,6 +1420,17 @@ const c8* CSkinnedMesh::getJointName(u32 number) const
 //! Gets a joint number from its name
 s32 CSkinnedMesh::getJointNumber(const c8* name) const
 {
+	if (JointIndexCount == AllJoints.size())
+	{
+		const core::atom key = core::atom::find(name);
+		if (key.empty() && name && name[0])
+			return -1;
+
+		const auto it = JointIndex.find(key);
+		return it != JointIndex.end() ? (s32)it->second : -1;
+	}
+
+	// joints were added after finalize()
 	for (u32 i=0; i<AllJoints.size(); ++i)
 	{
 		if (AllJoints[i]->Name == name)
@@ -695,6 +1489,7 @@ void CSkinnedMesh::setMaterialFlag(video::E_MATERIAL_FLAG flag, bool newvalue)
 {
 	for (u32 i=0; i<LocalBuffers.size(); ++i)
 		LocalBuffers[i]->Material.setFlag(flag,newvalue);
+	++PoseGeneration;
 }
 
 
@@ -704,6 +1499,7 @@ void CSkinnedMesh::setHardwareMappingHint(E_HARDWARE_MAPPING newMappingHint,
 {
 	for (u32 i=0; i<LocalBuffers.size(); ++i)
 		LocalBuffers[i]->setHardwareMappingHint(newMappingHint, buffer);
+	++PoseGeneration;
 }
 
 
@@ -712,6 +1508,7 @@ void CSkinnedMesh::setDirty(E_BUFFER_TYPE buffer)
 {
 	for (u32 i=0; i<LocalBuffers.size(); ++i)
 		LocalBuffers[i]->setDirty(buffer);
+	++PoseGeneration;
 }
 
 
@@ -720,6 +1517,12 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 {
 	bool unmatched=false;
 
+	// the linked keys are played instead of a clip
+	if (Clip)
+		Clip->drop();
+	Clip = 0;
+	ClipJoints = 0;
+
 	for(u32 i=0;i<AllJoints.size();++i)
 	{
 		SJoint *joint=AllJoints[i];
@@ -743,17 +1546,129 @@ bool CSkinnedMesh::useAnimationFrom(const ISkinnedMesh *mesh)
 	}
 
 	checkForAnimation();
+	buildSkeleton();
+	++PoseGeneration;
 
 	return !unmatched;
 }
 
 
+//! Creates a clip of the animation played by the keys of the joints
+IAnimationClip* CSkinnedMesh::createAnimationClip(f32 samplesPerFrame)
+{
+	if (!HasAnimation || Clip)
+		return 0;
+
+	core::array<core::stringc> names(AllJoints.size());
+	for (u32 i=0; i<AllJoints.size(); ++i)
+		names.push_back(AllJoints[i]->Name);
+
+	CAnimationClip* clip = new CAnimationClip(names, EndFrame, samplesPerFrame);
+	const u32 count = clip->getSampleCount();
+	core::array<core::vector3df> positions(count);
+	core::array<core::quaternion> rotations(count);
+	core::array<core::vector3df> scales(count);
+	positions.set_used(count);
+	rotations.set_used(count);
+	scales.set_used(count);
+
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		SJoint *joint = AllJoints[i];
+		const SJoint *source = joint->UseAnimationFrom;
+		if (!source || (source->PositionKeys.empty() && source->ScaleKeys.empty() && source->RotationKeys.empty()))
+			continue;
+
+		s32 positionHint = -1;
+		s32 scaleHint = -1;
+		s32 rotationHint = -1;
+		for (u32 k=0; k<count; ++k)
+		{
+			// samples past the end frame hold the last keys
+			const f32 frame = k / clip->getSamplesPerFrame();
+			positions[k] = joint->Animatedposition;
+			rotations[k] = joint->Animatedrotation;
+			scales[k] = joint->Animatedscale;
+			getFrameData(frame, joint, positions[k], positionHint, scales[k], scaleHint, rotations[k], rotationHint);
+		}
+
+		clip->setTrack(i, source->PositionKeys.empty() ? 0 : positions.const_pointer(),
+			source->RotationKeys.empty() ? 0 : rotations.const_pointer(),
+			source->ScaleKeys.empty() ? 0 : scales.const_pointer());
+	}
+
+	return clip;
+}
+
+
+//! Plays a clip instead of the keys of the joints
+bool CSkinnedMesh::setAnimationClip(IAnimationClip* clip)
+{
+	if (clip)
+		clip->grab();
+	if (Clip)
+		Clip->drop();
+	// clips are only made by createAnimationClip()
+	Clip = static_cast<CAnimationClip*>(clip);
+	ClipJoints = 0;
+
+	bool matched = true;
+	if (Clip)
+	{
+		const u64 signature = Clip->getSkeletonSignature();
+		auto it = ClipRemaps.find(signature);
+		if (it == ClipRemaps.end())
+		{
+			// joints of the same names in the same order keep their numbers
+			const bool sameSkeleton = signature == getSkeletonSignature() && Clip->getJointCount() == AllJoints.size();
+
+			core::array<s32> tracks(AllJoints.size());
+			for (u32 i=0; i<AllJoints.size(); ++i)
+				tracks.push_back(sameSkeleton ? (s32)i : Clip->getJointNumber(AllJoints[i]->Name.c_str()));
+			it = ClipRemaps.emplace(signature, tracks).first;
+		}
+		ClipJoints = &it->second;
+
+		for (u32 i=0; i<ClipJoints->size(); ++i)
+		{
+			if ((*ClipJoints)[i] < 0)
+				matched = false;
+		}
+	}
+
+	LastAnimatedFrame = -1;
+	checkForAnimation();
+	buildSkeleton();
+	++PoseGeneration;
+
+	return matched;
+}
+
+
+//! Gets the clip set by setAnimationClip(), or 0
+IAnimationClip* CSkinnedMesh::getAnimationClip() const
+{
+	return Clip;
+}
+
+
+//! Gets the signature of the skeleton
+u64 CSkinnedMesh::getSkeletonSignature() const
+{
+	core::array<core::stringc> names(AllJoints.size());
+	for (u32 i=0; i<AllJoints.size(); ++i)
+		names.push_back(AllJoints[i]->Name);
+	return CAnimationClip::getSkeletonSignature(names);
+}
+
+
 //!Update Normals when Animating
 //!False= Don't animate them, faster
 //!True= Update normals (default)
 void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 {
 	AnimateNormals = on;
+	++PoseGeneration;
 }
 
 
@@ -761,6 +1676,7 @@ void CSkinnedMesh::updateNormalsWhenAnimating(bool on)
 void CSkinnedMesh::setInterpolationMode(E_INTERPOLATION_MODE mode)
 {
 	InterpolationMode = mode;
+	++PoseGeneration;
 }
 
 
@@ -782,32 +1698,208 @@ const core::array<CSkinnedMesh::SJoint*> &CSkinnedMesh::getAllJoints() const
 }
 
 
-//! (This feature is not implemented in irrlicht yet)
+//! Allows to enable hardware skinning
 bool CSkinnedMesh::setHardwareSkinning(bool on)
 {
 	if (HardwareSkinning!=on)
 	{
 		if (on)
 		{
+			// before finalize() the weights are packed by finalize()
+			if (PreparedForSkinning && !buildHardwareSkinning())
+				return false;
+		}
+		else
+		{
+			for (u32 i=0; i<LocalBuffers.size(); ++i)
+			{
+				LocalBuffers[i]->convertSkinnedToStandard();
+				LocalBuffers[i]->boundingBoxNeedsRecalculated();
+			}
+			HardwareSkinningJoints.clear();
+			HardwareSkinningBoxes.clear();
+		}
 
-			//set mesh to static pose...
-			for (u32 i=0; i<AllJoints.size(); ++i)
+		HardwareSkinning=on;
+		SkinnedLastFrame=false;
+		++PoseGeneration;
+	}
+	return HardwareSkinning;
+}
+
+bool CSkinnedMesh::buildHardwareSkinning()
+{
+	struct SInfluences
+	{
+		u32 Joints[4];
+		f32 Strengths[4];
+	};
+
+	// the four strongest joints of every vertex
+	core::array< core::array<SInfluences> > influences;
+	influences.set_used(LocalBuffers.size());
+	for (u32 b=0; b<LocalBuffers.size(); ++b)
+	{
+		SInfluences none;
+		for (u32 k=0; k<4; ++k)
+		{
+			none.Joints[k] = 0;
+			none.Strengths[k] = 0.f;
+		}
+		influences[b].set_used(LocalBuffers[b]->getVertexCount());
+		for (u32 v=0; v<influences[b].size(); ++v)
+			influences[b][v] = none;
+	}
+
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		const SJoint *joint=AllJoints[i];
+		for (u32 j=0; j<joint->Weights.size(); ++j)
+		{
+			const SWeight& weight = joint->Weights[j];
+			if (weight.strength <= 0.f)
+				continue;
+
+			SInfluences& vertex = influences[weight.buffer_id][weight.vertex_id];
+			u32 weakest = 0;
+			for (u32 k=1; k<4; ++k)
+				if (vertex.Strengths[k] < vertex.Strengths[weakest])
+					weakest = k;
+			if (weight.strength > vertex.Strengths[weakest])
+			{
+				vertex.Joints[weakest] = i;
+				vertex.Strengths[weakest] = weight.strength;
+			}
+		}
+	}
+
+	// find the joints of each buffer before changing anything
+	core::array< core::array<u32> > palettes;
+	palettes.set_used(LocalBuffers.size());
+	core::array<s32> slots;
+	for (u32 b=0; b<LocalBuffers.size(); ++b)
+	{
+		slots.set_used(AllJoints.size());
+		for (u32 i=0; i<slots.size(); ++i)
+			slots[i] = -1;
+
+		for (u32 v=0; v<influences[b].size(); ++v)
+		{
+			const SInfluences& vertex = influences[b][v];
+			for (u32 k=0; k<4; ++k)
 			{
-				SJoint *joint=AllJoints[i];
-				for (u32 j=0; j<joint->Weights.size(); ++j)
+				if (vertex.Strengths[k] > 0.f && slots[vertex.Joints[k]] < 0)
 				{
-					const u16 buffer_id=joint->Weights[j].buffer_id;
-					const u32 vertex_id=joint->Weights[j].vertex_id;
-					LocalBuffers[buffer_id]->getVertex(vertex_id)->Pos = joint->Weights[j].StaticPos;
-					LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal = joint->Weights[j].StaticNormal;
-					LocalBuffers[buffer_id]->boundingBoxNeedsRecalculated();
+					slots[vertex.Joints[k]] = palettes[b].size();
+					palettes[b].push_back(vertex.Joints[k]);
 				}
 			}
 		}
 
-		HardwareSkinning=on;
+		if (palettes[b].empty())
+			continue;
+
+		if (LocalBuffers[b]->VertexType != video::EVT_STANDARD)
+		{
+			os::Printer::log("Skinned Mesh: Hardware skinning needs standard vertices", ELL_WARNING);
+			return false;
+		}
+		if (palettes[b].size() > video::MAX_SKINNING_JOINTS)
+		{
+			os::Printer::log("Skinned Mesh: Too many joints in a mesh buffer for hardware skinning", core::stringc(palettes[b].size()).c_str(), ELL_WARNING);
+			return false;
+		}
+	}
+
+	//set mesh to static pose...
+	for (u32 i=0; i<AllJoints.size(); ++i)
+	{
+		SJoint *joint=AllJoints[i];
+		for (u32 j=0; j<joint->Weights.size(); ++j)
+		{
+			const u16 buffer_id=joint->Weights[j].buffer_id;
+			const u32 vertex_id=joint->Weights[j].vertex_id;
+			LocalBuffers[buffer_id]->getVertex(vertex_id)->Pos = joint->Weights[j].StaticPos;
+			LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal = joint->Weights[j].StaticNormal;
+			LocalBuffers[buffer_id]->boundingBoxNeedsRecalculated();
+		}
+	}
+
+	HardwareSkinningJoints.set_used(LocalBuffers.size());
+	HardwareSkinningBoxes.set_used(LocalBuffers.size());
+	for (u32 b=0; b<LocalBuffers.size(); ++b)
+	{
+		HardwareSkinningJoints[b] = palettes[b];
+		if (palettes[b].empty())
+			continue;
+
+		slots.set_used(AllJoints.size());
+		for (u32 i=0; i<palettes[b].size(); ++i)
+			slots[palettes[b][i]] = i;
+
+		SSkinMeshBuffer* buffer = LocalBuffers[b];
+		buffer->convertToSkinned();
+		buffer->recalculateBoundingBox();
+		HardwareSkinningBoxes[b] = buffer->BoundingBox;
+		video::S3DVertexSkinned* vertices = buffer->getVertexArray<video::S3DVertexSkinned>();
+		for (u32 v=0; v<influences[b].size(); ++v)
+		{
+			const SInfluences& vertex = influences[b][v];
+			video::S3DVertexSkinned& skinned = vertices[v];
+
+			const f32 total = vertex.Strengths[0] + vertex.Strengths[1] + vertex.Strengths[2] + vertex.Strengths[3];
+			if (total <= 0.f)
+				continue;
+
+			// fixed point weights adding up to 255, the rounding error goes to the strongest joint
+			u32 sum = 0;
+			u32 strongest = 0;
+			for (u32 k=0; k<4; ++k)
+			{
+				const u32 weight = core::round32(vertex.Strengths[k] / total * 255.f);
+				skinned.JointIndices[k] = weight ? (u8)slots[vertex.Joints[k]] : 0;
+				skinned.JointWeights[k] = (u8)weight;
+				sum += weight;
+				if (vertex.Strengths[k] > vertex.Strengths[strongest])
+					strongest = k;
+			}
+			skinned.JointIndices[strongest] = (u8)slots[vertex.Joints[strongest]];
+			skinned.JointWeights[strongest] = (u8)(skinned.JointWeights[strongest] + 255 - sum);
+		}
+	}
+
+	updateJointMatrices();
+	return true;
+}
+
+void CSkinnedMesh::updateJointMatrices()
+{
+	for (u32 b=0; b<HardwareSkinningJoints.size(); ++b)
+	{
+		const core::array<u32>& joints = HardwareSkinningJoints[b];
+		if (joints.empty())
+			continue;
+
+		SSkinMeshBuffer* buffer = LocalBuffers[b];
+		buffer->JointMatrices.set_used(joints.size());
+
+		// the skinned vertices stay in the static pose, so the box is widened by the moves of all joints
+		const core::aabbox3df& staticBox = HardwareSkinningBoxes[b];
+		core::aabbox3df box;
+		for (u32 i=0; i<joints.size(); ++i)
+		{
+			const SJoint *joint = AllJoints[joints[i]];
+			buffer->JointMatrices[i].setbyproduct(joint->GlobalAnimatedMatrix, joint->GlobalInversedMatrix);
+
+			core::aabbox3df jointBox = staticBox;
+			buffer->JointMatrices[i].transformBoxEx(jointBox);
+			if (i == 0)
+				box = jointBox;
+			else
+				box.addInternalBox(jointBox);
+		}
+		buffer->setBoundingBox(box);
 	}
-	return HardwareSkinning;
 }
 
 void CSkinnedMesh::refreshJointCache()
@@ -824,6 +1916,8 @@ void CSkinnedMesh::refreshJointCache()
 			joint->Weights[j].StaticNormal = LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal;
 		}
 	}
+	buildSkinningVertices();
+	++PoseGeneration;
 }
 
 void CSkinnedMesh::resetAnimation()
@@ -844,35 +1938,28 @@ void CSkinnedMesh::resetAnimation()
 	LastAnimatedFrame = -1;
 }
 
-void CSkinnedMesh::calculateGlobalMatrices(SJoint *joint,SJoint *parentJoint)
+void CSkinnedMesh::calculateGlobalMatrices()
 {
-	if (!joint && parentJoint) // bit of protection from endless loops
-		return;
-
-	//Go through the root bones
-	if (!joint)
+	// parents come first in the skeleton
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
 	{
-		for (u32 i=0; i<RootJoints.size(); ++i)
-			calculateGlobalMatrices(RootJoints[i],0);
-		return;
-	}
+		SJoint *joint = SkeletonJoints[i];
+		const s32 parent = SkeletonParents[i];
 
-	if (!parentJoint)
-		joint->GlobalMatrix = joint->LocalMatrix;
-	else
-		joint->GlobalMatrix = parentJoint->GlobalMatrix * joint->LocalMatrix;
+		if (parent < 0)
+			joint->GlobalMatrix = joint->LocalMatrix;
+		else
+			joint->GlobalMatrix = SkeletonJoints[parent]->GlobalMatrix * joint->LocalMatrix;
 
-	joint->LocalAnimatedMatrix=joint->LocalMatrix;
-	joint->GlobalAnimatedMatrix=joint->GlobalMatrix;
+		joint->LocalAnimatedMatrix=joint->LocalMatrix;
+		joint->GlobalAnimatedMatrix=joint->GlobalMatrix;
 
-	if (joint->GlobalInversedMatrix.isIdentity())//might be pre calculated
-	{
-		joint->GlobalInversedMatrix = joint->GlobalMatrix;
-		joint->GlobalInversedMatrix.makeInverse(); // slow
+		if (joint->GlobalInversedMatrix.isIdentity())//might be pre calculated
+		{
+			joint->GlobalInversedMatrix = joint->GlobalMatrix;
+			joint->GlobalInversedMatrix.makeInverse(); // slow
+		}
 	}
-
-	for (u32 j=0; j<joint->Children.size(); ++j)
-		calculateGlobalMatrices(joint->Children[j],joint);
 	SkinnedLastFrame=false;
 }
 
@@ -882,7 +1969,14 @@ void CSkinnedMesh::checkForAnimation()
 	u32 i,j;
 	//Check for animation...
 	HasAnimation = false;
-	for(i=0;i<AllJoints.size();++i)
+	for(i=0;Clip && i<ClipJoints->size();++i)
+	{
+		const s32 track = (*ClipJoints)[i];
+		if (track >= 0 && (Clip->isAnimated(track) || Clip->isScaled(track)))
+			HasAnimation = true;
+	}
+
+	for(i=0;!Clip && i<AllJoints.size();++i)
 	{
 		if (AllJoints[i]->UseAnimationFrom)
 		{
@@ -896,16 +1990,15 @@ void CSkinnedMesh::checkForAnimation()
 	}
 
 	//meshes with weights, are still counted as animated for ragdolls, etc
-	if (!HasAnimation)
+	for(i=0;!HasAnimation && i<AllJoints.size();++i)
 	{
-		for(i=0;i<AllJoints.size();++i)
-		{
-			if (AllJoints[i]->Weights.size())
-				HasAnimation = true;
-		}
+		if (AllJoints[i]->Weights.size())
+			HasAnimation = true;
 	}
 
-	if (HasAnimation)
+	if (HasAnimation && Clip)
+		EndFrame = Clip->getEndFrame();
+	else if (HasAnimation)
 	{
 		//--- Find the length of the animation ---
 		EndFrame=0;
@@ -932,50 +2025,29 @@ void CSkinnedMesh::checkForAnimation()
 	{
 		PreparedForSkinning=true;
 
-		//check for bugs:
+		// check for bugs, and cache the weight values for skinning in the same pass
 		for(i=0; i < AllJoints.size(); ++i)
 		{
 			SJoint *joint = AllJoints[i];
 			for (j=0; j<joint->Weights.size(); ++j)
 			{
-				const u16 buffer_id=joint->Weights[j].buffer_id;
-				const u32 vertex_id=joint->Weights[j].vertex_id;
+				SWeight& weight = joint->Weights[j];
 
 				//check for invalid ids
-				if (buffer_id>=LocalBuffers.size())
+				if (weight.buffer_id>=LocalBuffers.size())
 				{
 					os::Printer::log("Skinned Mesh: Weight buffer id too large", ELL_WARNING);
-					joint->Weights[j].buffer_id = joint->Weights[j].vertex_id =0;
+					weight.buffer_id = weight.vertex_id =0;
 				}
-				else if (vertex_id>=LocalBuffers[buffer_id]->getVertexCount())
+				else if (weight.vertex_id>=LocalBuffers[weight.buffer_id]->getVertexCount())
 				{
 					os::Printer::log("Skinned Mesh: Weight vertex id too large", ELL_WARNING);
-					joint->Weights[j].buffer_id = joint->Weights[j].vertex_id =0;
+					weight.buffer_id = weight.vertex_id =0;
 				}
-			}
-		}
-
-		//An array used in skinning
-
-		for (i=0; i<Vertices_Moved.size(); ++i)
-			for (j=0; j<Vertices_Moved[i].size(); ++j)
-				Vertices_Moved[i][j] = false;
-
-		// For skinning: cache weight values for speed
 
-		for (i=0; i<AllJoints.size(); ++i)
-		{
-			SJoint *joint = AllJoints[i];
-			for (j=0; j<joint->Weights.size(); ++j)
-			{
-				const u16 buffer_id=joint->Weights[j].buffer_id;
-				const u32 vertex_id=joint->Weights[j].vertex_id;
-
-				joint->Weights[j].Moved = &Vertices_Moved[buffer_id] [vertex_id];
-				joint->Weights[j].StaticPos = LocalBuffers[buffer_id]->getVertex(vertex_id)->Pos;
-				joint->Weights[j].StaticNormal = LocalBuffers[buffer_id]->getVertex(vertex_id)->Normal;
-
-				//joint->Weights[j]._Pos=&Buffers[buffer_id]->getVertex(vertex_id)->Pos;
+				const video::S3DVertex* vertex = LocalBuffers[weight.buffer_id]->getVertex(weight.vertex_id);
+				weight.StaticPos = vertex->Pos;
+				weight.StaticNormal = vertex->Normal;
 			}
 		}
 
@@ -994,6 +2066,7 @@ void CSkinnedMesh::finalize()
 	// Make sure we recalc the next frame
 	LastAnimatedFrame=-1;
 	SkinnedLastFrame=false;
+	++PoseGeneration;
 
 	//calculate bounding box
 	for (i=0; i<LocalBuffers.size(); ++i)
@@ -1006,22 +2079,27 @@ void CSkinnedMesh::finalize()
 		// populate AllJoints or RootJoints, depending on which is empty
 		if (!RootJoints.size())
 		{
-
-			for(u32 CheckingIdx=0; CheckingIdx < AllJoints.size(); ++CheckingIdx)
+			// the joints which are no child of any joint are the roots
+			SFinalizeScratch& scratch = getFinalizeScratch();
+			scratch.JointNumbers.clear();
+			for (i=0; i < AllJoints.size(); ++i)
+				scratch.JointNumbers.emplace(AllJoints[i], i);
+
+			scratch.HasParent.assign(AllJoints.size(), 0);
+			for (i=0; i < AllJoints.size(); ++i)
 			{
-
-				bool foundParent=false;
-				for(i=0; i < AllJoints.size(); ++i)
+				for (u32 n=0; n < AllJoints[i]->Children.size(); ++n)
 				{
-					for(u32 n=0; n < AllJoints[i]->Children.size(); ++n)
-					{
-						if (AllJoints[i]->Children[n] == AllJoints[CheckingIdx])
-							foundParent=true;
-					}
+					const std::unordered_map<const SJoint*, u32>::const_iterator child = scratch.JointNumbers.find(AllJoints[i]->Children[n]);
+					if (child != scratch.JointNumbers.end())
+						scratch.HasParent[child->second] = 1;
 				}
+			}
 
-				if (!foundParent)
-					RootJoints.push_back(AllJoints[CheckingIdx]);
+			for (i=0; i < AllJoints.size(); ++i)
+			{
+				if (!scratch.HasParent[scratch.JointNumbers[AllJoints[i]]])
+					RootJoints.push_back(AllJoints[i]);
 			}
 		}
 		else
@@ -1035,13 +2113,18 @@ void CSkinnedMesh::finalize()
 		AllJoints[i]->UseAnimationFrom=AllJoints[i];
 	}
 
-	//Set array sizes...
+	// the first joint of a name is found
+	JointIndex.clear();
+	for (i=0; i < AllJoints.size(); ++i)
+		JointIndex.emplace(core::atom(AllJoints[i]->Name), i);
+	JointIndexCount = AllJoints.size();
 
-	for (i=0; i<LocalBuffers.size(); ++i)
-	{
-		Vertices_Moved.push_back( core::array<char>() );
-		Vertices_Moved[i].set_used(LocalBuffers[i]->getVertexCount());
-	}
+	// the joints may have changed since a clip was mapped, play the keys
+	ClipRemaps.clear();
+	if (Clip)
+		Clip->drop();
+	Clip = 0;
+	ClipJoints = 0;
 
 	checkForAnimation();
 
@@ -1160,11 +2243,9 @@ void CSkinnedMesh::finalize()
 
 	//Needed for animation and skinning...
 
-	calculateGlobalMatrices(0,0);
-
-	//animateMesh(0, 1);
-	//buildAllLocalAnimatedMatrices();
-	//buildAllGlobalAnimatedMatrices();
+	buildSkeletonOrder();
+	calculateGlobalMatrices();
+	buildSkeletonData();
 
 	//rigid animation for non animated meshes
 	for (i=0; i<AllJoints.size(); ++i)
@@ -1176,6 +2257,10 @@ void CSkinnedMesh::finalize()
 		}
 	}
 
+	// hardware skinning enabled before the weights were known
+	if (HardwareSkinning && PreparedForSkinning && !buildHardwareSkinning())
+		HardwareSkinning=false;
+
 	//calculate bounding box
 	if (LocalBuffers.empty())
 		BoundingBox.reset(0,0,0);
@@ -1298,44 +2383,39 @@ void CSkinnedMesh::normalizeWeights()
 	// Normalise the weights on bones....
 
 	u32 i,j;
-	core::array< core::array<f32> > verticesTotalWeight;
-
-	verticesTotalWeight.reallocate(LocalBuffers.size());
-	for (i=0; i<LocalBuffers.size(); ++i)
-	{
-		verticesTotalWeight.push_back(core::array<f32>());
-		verticesTotalWeight[i].set_used(LocalBuffers[i]->getVertexCount());
-	}
-
-	for (i=0; i<verticesTotalWeight.size(); ++i)
-		for (j=0; j<verticesTotalWeight[i].size(); ++j)
-			verticesTotalWeight[i][j] = 0;
+	SFinalizeScratch& scratch = getFinalizeScratch();
+	std::vector<u32>& bufferStarts = scratch.BufferStarts;
+	std::vector<f32>& totalWeights = scratch.TotalWeights;
+	setBufferStarts(LocalBuffers, bufferStarts);
+	totalWeights.assign(bufferStarts.back(), 0.f);
 
 	for (i=0; i<AllJoints.size(); ++i)
 	{
-		SJoint *joint=AllJoints[i];
-		for (j=0; j<joint->Weights.size(); ++j)
+		core::array<SWeight>& weights = AllJoints[i]->Weights;
+
+		// drop invalid weights, keeping the order of the others
+		u32 kept = 0;
+		for (j=0; j<weights.size(); ++j)
 		{
-			if (joint->Weights[j].strength<=0)//Check for invalid weights
-			{
-				joint->Weights.erase(j);
-				--j;
-			}
-			else
-			{
-				verticesTotalWeight[joint->Weights[j].buffer_id] [joint->Weights[j].vertex_id] += joint->Weights[j].strength;
-			}
+			if (weights[j].strength<=0)
+				continue;
+
+			if (kept != j)
+				weights[kept] = weights[j];
+			totalWeights[bufferStarts[weights[kept].buffer_id] + weights[kept].vertex_id] += weights[kept].strength;
+			++kept;
 		}
+		weights.set_used(kept);
 	}
 
 	for (i=0; i<AllJoints.size(); ++i)
 	{
-		SJoint *joint=AllJoints[i];
-		for (j=0; j< joint->Weights.size(); ++j)
+		core::array<SWeight>& weights = AllJoints[i]->Weights;
+		for (j=0; j<weights.size(); ++j)
 		{
-			const f32 total = verticesTotalWeight[joint->Weights[j].buffer_id] [joint->Weights[j].vertex_id];
+			const f32 total = totalWeights[bufferStarts[weights[j].buffer_id] + weights[j].vertex_id];
 			if (total != 0 && total != 1)
-				joint->Weights[j].strength /= total;
+				weights[j].strength /= total;
 		}
 	}
 }
@@ -1360,6 +2440,30 @@ void CSkinnedMesh::recoverJointsFromMesh(core::array<IBoneSceneNode*> &jointChil
 }
 
 
+void CSkinnedMesh::recoverJointsFromMesh(core::array<IBoneSceneNode*> &jointChildSceneNodes, const core::array<u8>& needed)
+{
+	// in skeleton order the absolute positions of the parents are up to date
+	for (u32 i=0; i<SkeletonJoints.size(); ++i)
+	{
+		const u32 number = SkeletonJointNumbers[i];
+		if (number >= needed.size() || !needed[number])
+			continue;
+
+		IBoneSceneNode* node=jointChildSceneNodes[number];
+		const SJoint *joint=SkeletonJoints[i];
+		node->setPosition(joint->LocalAnimatedMatrix.getTranslation());
+		node->setRotation(joint->LocalAnimatedMatrix.getRotationDegrees());
+		node->setScale(joint->LocalAnimatedMatrix.getScale());
+
+		node->positionHint=joint->positionHint;
+		node->scaleHint=joint->scaleHint;
+		node->rotationHint=joint->rotationHint;
+
+		node->updateAbsolutePosition();
+	}
+}
+
+
 void CSkinnedMesh::transferJointsToMesh(const core::array<IBoneSceneNode*> &jointChildSceneNodes)
 {
 	for (u32 i=0; i<AllJoints.size(); ++i)
@@ -1444,93 +2548,124 @@ void CSkinnedMesh::addJoints(core::array<IBoneSceneNode*> &jointChildSceneNodes,
 
 void CSkinnedMesh::convertMeshToTangents()
 {
-	// now calculate tangents
+	core::array<SSkinMeshBuffer*> buffers;
+	u32 idxCnt = 0;
 	for (u32 b=0; b < LocalBuffers.size(); ++b)
 	{
 		if (LocalBuffers[b])
 		{
 			LocalBuffers[b]->convertToTangents();
-
-			const s32 idxCnt = LocalBuffers[b]->getIndexCount();
-
-			u16* idx = LocalBuffers[b]->getIndices();
-			video::S3DVertexTangents* v =
-				(video::S3DVertexTangents*)LocalBuffers[b]->getVertices();
-
-			for (s32 i=0; i<idxCnt; i+=3)
+			if (LocalBuffers[b]->getVertexType() == video::EVT_TANGENTS)
 			{
-				calculateTangents(
-					v[idx[i+0]].Normal,
-					v[idx[i+0]].Tangent,
-					v[idx[i+0]].Binormal,
-					v[idx[i+0]].Pos,
-					v[idx[i+1]].Pos,
-					v[idx[i+2]].Pos,
-					v[idx[i+0]].TCoords,
-					v[idx[i+1]].TCoords,
-					v[idx[i+2]].TCoords);
-
-				calculateTangents(
-					v[idx[i+1]].Normal,
-					v[idx[i+1]].Tangent,
-					v[idx[i+1]].Binormal,
-					v[idx[i+1]].Pos,
-					v[idx[i+2]].Pos,
-					v[idx[i+0]].Pos,
-					v[idx[i+1]].TCoords,
-					v[idx[i+2]].TCoords,
-					v[idx[i+0]].TCoords);
-
-				calculateTangents(
-					v[idx[i+2]].Normal,
-					v[idx[i+2]].Tangent,
-					v[idx[i+2]].Binormal,
-					v[idx[i+2]].Pos,
-					v[idx[i+0]].Pos,
-					v[idx[i+1]].Pos,
-					v[idx[i+2]].TCoords,
-					v[idx[i+0]].TCoords,
-					v[idx[i+1]].TCoords);
+				buffers.push_back(LocalBuffers[b]);
+				idxCnt += LocalBuffers[b]->getIndexCount();
 			}
 		}
 	}
+
+	// now calculate tangents, large meshes spread their buffers over threads
+	const u32 cores = std::thread::hardware_concurrency();
+	if (buffers.size() > 1 && cores > 1 && idxCnt >= PARALLEL_TANGENTS_MIN_INDICES)
+	{
+		CJobSystem jobs(cores - 1);
+		for (u32 b=0; b < buffers.size(); ++b)
+			jobs.add(calculateTangentsJob, buffers[b]);
+		jobs.wait();
+	}
+	else
+	{
+		for (u32 b=0; b < buffers.size(); ++b)
+			calculateTangents(buffers[b]);
+	}
+	++PoseGeneration;
 }
 
 
-void CSkinnedMesh::calculateTangents(
-	core::vector3df& normal,
-	core::vector3df& tangent,
-	core::vector3df& binormal,
-	const core::vector3df& vt1, const core::vector3df& vt2, const core::vector3df& vt3, // vertices
-	const core::vector2df& tc1, const core::vector2df& tc2, const core::vector2df& tc3) // texture coords
+//! Calculates normal, tangent and binormal of the vertices of a buffer, four triangles at a time
+void CSkinnedMesh::calculateTangents(SSkinMeshBuffer* buffer)
 {
-	core::vector3df v1 = vt1 - vt2;
-	core::vector3df v2 = vt3 - vt1;
-	normal = v2.crossProduct(v1);
-	normal.normalize();
+	const u32 idxCnt = buffer->getIndexCount() - buffer->getIndexCount() % 3;
+	const u16* idx = buffer->getIndices();
+	video::S3DVertexTangents* v = buffer->getVertexArray<video::S3DVertexTangents>();
 
-	// binormal
+	video::S3DVertexTangents padding;
+	video::S3DVertexTangents* corners[4][3];
+	f32 results[9][4];
 
-	f32 deltaX1 = tc1.X - tc2.X;
-	f32 deltaX2 = tc3.X - tc1.X;
-	binormal = (v1 * deltaX2) - (v2 * deltaX1);
-	binormal.normalize();
+	for (u32 i=0; i<idxCnt; i+=12)
+	{
+		const u32 count = core::min_((idxCnt - i) / 3, 4u);
+		for (u32 t=0; t<4; ++t)
+		{
+			for (u32 k=0; k<3; ++k)
+				corners[t][k] = t < count ? &v[idx[i + t*3 + k]] : &padding;
+		}
 
-	// tangent
+		f32x4 x[3], y[3], z[3], tu[3], tv[3];
+		for (u32 k=0; k<3; ++k)
+		{
+			x[k] = set4(corners[0][k]->Pos.X, corners[1][k]->Pos.X, corners[2][k]->Pos.X, corners[3][k]->Pos.X);
+			y[k] = set4(corners[0][k]->Pos.Y, corners[1][k]->Pos.Y, corners[2][k]->Pos.Y, corners[3][k]->Pos.Y);
+			z[k] = set4(corners[0][k]->Pos.Z, corners[1][k]->Pos.Z, corners[2][k]->Pos.Z, corners[3][k]->Pos.Z);
+			tu[k] = set4(corners[0][k]->TCoords.X, corners[1][k]->TCoords.X, corners[2][k]->TCoords.X, corners[3][k]->TCoords.X);
+			tv[k] = set4(corners[0][k]->TCoords.Y, corners[1][k]->TCoords.Y, corners[2][k]->TCoords.Y, corners[3][k]->TCoords.Y);
+		}
 
-	f32 deltaY1 = tc1.Y - tc2.Y;
-	f32 deltaY2 = tc3.Y - tc1.Y;
-	tangent = (v1 * deltaY2) - (v2 * deltaY1);
-	tangent.normalize();
+		const f32x4 v1x = sub4(x[0], x[1]), v1y = sub4(y[0], y[1]), v1z = sub4(z[0], z[1]);
+		const f32x4 v2x = sub4(x[2], x[0]), v2y = sub4(y[2], y[0]), v2z = sub4(z[2], z[0]);
+
+		f32x4 nx = sub4(mul4(v2y, v1z), mul4(v2z, v1y));
+		f32x4 ny = sub4(mul4(v2z, v1x), mul4(v2x, v1z));
+		f32x4 nz = sub4(mul4(v2x, v1y), mul4(v2y, v1x));
+		normalize4(nx, ny, nz);
+
+		const f32x4 deltaX1 = sub4(tu[0], tu[1]);
+		const f32x4 deltaX2 = sub4(tu[2], tu[0]);
+		f32x4 bx = sub4(mul4(v1x, deltaX2), mul4(v2x, deltaX1));
+		f32x4 by = sub4(mul4(v1y, deltaX2), mul4(v2y, deltaX1));
+		f32x4 bz = sub4(mul4(v1z, deltaX2), mul4(v2z, deltaX1));
+		normalize4(bx, by, bz);
+
+		const f32x4 deltaY1 = sub4(tv[0], tv[1]);
+		const f32x4 deltaY2 = sub4(tv[2], tv[0]);
+		f32x4 tx = sub4(mul4(v1x, deltaY2), mul4(v2x, deltaY1));
+		f32x4 ty = sub4(mul4(v1y, deltaY2), mul4(v2y, deltaY1));
+		f32x4 tz = sub4(mul4(v1z, deltaY2), mul4(v2z, deltaY1));
+		normalize4(tx, ty, tz);
+
+		// tangent and binormal are flipped if they don't form a frame with the normal
+		const f32x4 txbx = sub4(mul4(ty, bz), mul4(tz, by));
+		const f32x4 txby = sub4(mul4(tz, bx), mul4(tx, bz));
+		const f32x4 txbz = sub4(mul4(tx, by), mul4(ty, bx));
+		const f32x4 dot = madd4(txbx, nx, madd4(txby, ny, mul4(txbz, nz)));
+		const f32x4 sign = sub4(splat4(1.f), mul4(splat4(2.f), negative4(dot)));
+
+		store4(results[0], nx);
+		store4(results[1], ny);
+		store4(results[2], nz);
+		store4(results[3], mul4(tx, sign));
+		store4(results[4], mul4(ty, sign));
+		store4(results[5], mul4(tz, sign));
+		store4(results[6], mul4(bx, sign));
+		store4(results[7], mul4(by, sign));
+		store4(results[8], mul4(bz, sign));
+
+		for (u32 t=0; t<count; ++t)
+		{
+			for (u32 k=0; k<3; ++k)
+			{
+				corners[t][k]->Normal.set(results[0][t], results[1][t], results[2][t]);
+				corners[t][k]->Tangent.set(results[3][t], results[4][t], results[5][t]);
+				corners[t][k]->Binormal.set(results[6][t], results[7][t], results[8][t]);
+			}
+		}
+	}
+}
 
-	// adjust
 
-	core::vector3df txb = tangent.crossProduct(binormal);
-	if (txb.dotProduct(normal) < 0.0f)
-	{
-		tangent *= -1.0f;
-		binormal *= -1.0f;
-	}
+void CSkinnedMesh::calculateTangentsJob(void* buffer)
+{
+	calculateTangents(static_cast<SSkinMeshBuffer*>(buffer));
 }
 
 
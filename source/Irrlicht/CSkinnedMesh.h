@@ -8,11 +8,14 @@
 #define __C_SKINNED_MESH_H_INCLUDED__
 
 #include "ISkinnedMesh.h"
+#include "SMesh.h"
 #include "SMeshBuffer.h"
 #include "S3DVertex.h"
 #include "irrString.h"
+#include "irrAtom.h"
 #include "matrix4.h"
 #include "quaternion.h"
+#include <unordered_map>
 
 namespace irr
 {
@@ -21,6 +24,8 @@ namespace scene
 
 	class IAnimatedMeshSceneNode;
 	class IBoneSceneNode;
+	class CJobSystem;
+	class CAnimationClip;
 
 	class CSkinnedMesh: public ISkinnedMesh
 	{
@@ -54,6 +59,13 @@ namespace scene
 		//! Preforms a software skin on this mesh based of joint positions
 		void skinMesh() override;
 
+		//! Preforms a software skin, splitting large buffers into jobs
+		/** \param jobs Job system to skin on, or 0 to skin on the calling
+		thread only. Must be called from the thread which waits on it.
+		\param normals False to leave the normals as they are, even if
+		they are animated. */
+		void skinMesh(CJobSystem* jobs, bool normals=true);
+
 		//! returns amount of mesh buffers.
 		u32 getMeshBufferCount() const override;
 
@@ -96,6 +108,18 @@ namespace scene
 		//! uses animation from another mesh
 		bool useAnimationFrom(const ISkinnedMesh *mesh) override;
 
+		//! Creates a clip of the animation played by the keys of the joints
+		IAnimationClip* createAnimationClip(f32 samplesPerFrame=1.f) override;
+
+		//! Plays a clip instead of the keys of the joints
+		bool setAnimationClip(IAnimationClip* clip) override;
+
+		//! Gets the clip set by setAnimationClip(), or 0
+		IAnimationClip* getAnimationClip() const override;
+
+		//! Gets the signature of the skeleton
+		u64 getSkeletonSignature() const override;
+
 		//! Update Normals when Animating
 		//! False= Don't (default)
 		//! True = Update normals, slower
@@ -110,9 +134,15 @@ namespace scene
 		//! Does the mesh have no animation
 		bool isStatic() override;
 
-		//! (This feature is not implemented in irrlicht yet)
+		//! Allows to enable hardware skinning
 		bool setHardwareSkinning(bool on) override;
 
+		//! Skins the frames of a loop in advance, for meshes played by many nodes.
+		bool bakeFrames(s32 begin, s32 end, u32 samplesPerFrame=1, bool interpolate=true) override;
+
+		//! Drops the frames baked by bakeFrames()
+		void clearBakedFrames() override;
+
 		//! Refreshes vertex data cached in joints such as positions and normals
 		void refreshJointCache() override;
 
@@ -155,6 +185,11 @@ namespace scene
 		//! Recovers the joints from the mesh
 		void recoverJointsFromMesh(core::array<IBoneSceneNode*> &jointChildSceneNodes);
 
+		//! Recovers only some joints from the mesh, parents before their children
+		/** \param needed Whether to recover each joint, by joint number.
+		The parents of recovered joints have to be recovered as well. */
+		void recoverJointsFromMesh(core::array<IBoneSceneNode*> &jointChildSceneNodes, const core::array<u8>& needed);
+
 		//! Tranfers the joint data to the mesh
 		void transferJointsToMesh(const core::array<IBoneSceneNode*> &jointChildSceneNodes);
 
@@ -166,6 +201,42 @@ namespace scene
 				IAnimatedMeshSceneNode* node,
 				ISceneManager* smgr);
 
+		//! Gets a copy of the mesh skinned to a frame
+		/** All scene nodes showing the same frame get the same copy, which is
+		only skinned again once the copy is used for another frame. The mesh
+		buffers are SSkinMeshBuffers like those of this mesh. Not thread safe.
+		\param frame Frame to skin the copy to.
+		\param jobs Job system to skin a new copy on, or 0.
+		\param normals False if the normals of the copy may be left out,
+		for nodes too small on the screen to see them.
+		\return The grabbed copy, drop it when done, or 0 if the mesh is
+		skinned by the hardware or not animated. */
+		SMesh* grabPose(f32 frame, CJobSystem* jobs=0, bool normals=true);
+
+		//! Animates the joints to a frame, as the first pose of a blend
+		/** Like animateMesh(frame, 1.f), but the joint matrices are only
+		built by endBlend(), once for all poses blended over it. */
+		void beginBlend(f32 frame);
+
+		//! Blends the pose at a frame over the joints
+		/** \param frame Frame of the pose.
+		\param weight 0 keeps the joints as they are, 1 replaces their pose.
+		\param jointWeights Factor of weight for each joint by joint
+		number, or 0 to blend all joints alike. */
+		void blendPose(f32 frame, f32 weight, const core::array<f32>* jointWeights);
+
+		//! Builds the joint matrices of the blended pose
+		void endBlend();
+
+		//! Gets a bounding box enclosing all frames of a frame loop
+		/** The box is made of the pose of each frame, computed from the
+		boxes of the joints without skinning, and cached until the joints
+		change. Animates the joints, so it isn't thread safe.
+		\param begin Start frame of the loop.
+		\param end End frame of the loop.
+		\return The bounding box in the space of the mesh. */
+		core::aabbox3df getLoopBoundingBox(s32 begin, s32 end);
+
 private:
 		void checkForAnimation();
 
@@ -173,21 +244,62 @@ private:
 
 		void buildAllLocalAnimatedMatrices();
 
-		void buildAllGlobalAnimatedMatrices(SJoint *Joint=0, SJoint *ParentJoint=0);
+		void buildAllGlobalAnimatedMatrices();
+
+		//! Puts the joints in parent before child order for the animation
+		void buildSkeleton();
+
+		//! Fills SkeletonJoints and SkeletonParents, the first part of buildSkeleton()
+		void buildSkeletonOrder();
+
+		//! Fills the other arrays of the skeleton and the skinning vertices, the second part of buildSkeleton()
+		void buildSkeletonData();
 
 		void getFrameData(f32 frame, SJoint *Node,
 				core::vector3df &position, s32 &positionHint,
 				core::vector3df &scale, s32 &scaleHint,
 				core::quaternion &rotation, s32 &rotationHint);
 
-		void calculateGlobalMatrices(SJoint *Joint,SJoint *ParentJoint);
+		//! Animates SkeletonPositions, SkeletonRotations and SkeletonScales towards a frame
+		void sampleSkeleton(f32 frame, f32 blend);
+
+		//! Animates a joint of the skeleton towards a frame
+		/** Weights between 0 and 1 are queued and blended by blendSamples(). */
+		void sampleJoint(f32 frame, u32 joint, f32 weight);
+
+		//! Blends all joints queued by sampleJoint() at once
+		void blendSamples();
+
+		//! Sets the global matrices of the joints from their local ones, in the order of buildSkeletonOrder()
+		void calculateGlobalMatrices();
+
+		//! Skins all weighted vertices of the skinning buffers to the current pose
+		void skinVertices(CJobSystem* jobs);
+
+		//! Skins the vertices first to first+count-1 of SkinningVertices, which belong to one buffer
+		void skinRange(u32 buffer, u32 first, u32 count) const;
+
+		static void skinJob(void* data);
+
+		//! Gathers the weights of each vertex for skinVertices(), and the joint boxes of the buffers
+		void buildSkinningVertices();
+
+		//! Bounding box of a buffer moved by SkinningMatrices, from the boxes of the joints pulling on it
+		/** \return False if the box has to be measured from the vertices. */
+		bool getJointBoundingBox(u32 buffer, core::aabbox3df& box) const;
+
+		//! Converts the weighted buffers to skinned vertices and builds their joint palettes
+		bool buildHardwareSkinning();
+
+		//! Sets the joint matrices of the skinned buffers to the current pose
+		void updateJointMatrices();
 
-		void skinJoint(SJoint *Joint, SJoint *ParentJoint);
+		//! Calculates normal, tangent and binormal of the vertices of a buffer, four triangles at a time
+		/** All corners of a triangle get its frame, the last triangle using a vertex wins. */
+		static void calculateTangents(SSkinMeshBuffer* buffer);
 
-		void calculateTangents(core::vector3df& normal,
-			core::vector3df& tangent, core::vector3df& binormal,
-			const core::vector3df& vt1, const core::vector3df& vt2, const core::vector3df& vt3,
-			const core::vector2df& tc1, const core::vector2df& tc2, const core::vector2df& tc3);
+		//! CJobSystem job running calculateTangents()
+		static void calculateTangentsJob(void* buffer);
 
 		core::array<SSkinMeshBuffer*> *SkinningBuffers; //Meshbuffer to skin, default is to skin localBuffers
 
@@ -196,9 +308,168 @@ private:
 		core::array<SJoint*> AllJoints;
 		core::array<SJoint*> RootJoints;
 
-		// bool can't be used here because std::vector<bool>
-		// doesn't allow taking a reference to individual elements.
-		core::array< core::array<char> > Vertices_Moved;
+		//! Index in AllJoints by interned name, built by finalize()
+		std::unordered_map<core::atom, u32> JointIndex;
+		//! Size of AllJoints when JointIndex was built
+		u32 JointIndexCount;
+
+		//! How the local matrix of a joint is built
+		enum E_SKELETON_JOINT_ANIMATION
+		{
+			//! Not animated, the local matrix is used
+			ESJA_NONE = 0,
+			//! Animated position and rotation
+			ESJA_ANIMATED,
+			//! Animated position, rotation and scale
+			ESJA_SCALED
+		};
+
+		//! Joints ordered with parents before their children
+		core::array<SJoint*> SkeletonJoints;
+		//! Index of the parent in SkeletonJoints, -1 for root joints
+		core::array<s32> SkeletonParents;
+		//! Animated transformation of each joint of SkeletonJoints
+		core::array<core::vector3df> SkeletonPositions;
+		core::array<core::quaternion> SkeletonRotations;
+		core::array<core::vector3df> SkeletonScales;
+		core::array<core::matrix4> SkeletonGlobalMatrices;
+		//! Local matrix built from the animated position and rotation of each joint
+		core::array<core::matrix4> SkeletonLocalMatrices;
+		core::array<u8> SkeletonAnimation;
+		//! Joint number of each joint of SkeletonJoints, its index in AllJoints
+		core::array<u32> SkeletonJointNumbers;
+
+		//! Joints queued by sampleJoint(), as index in SkeletonJoints
+		core::array<u32> BlendJoints;
+		core::array<f32> BlendWeights;
+		//! Transformation of each of BlendJoints before the sampling
+		core::array<core::vector3df> BlendFromPositions;
+		core::array<core::quaternion> BlendFromRotations;
+		core::array<core::vector3df> BlendFromScales;
+		//! Sampled transformation of each of BlendJoints, the blended one after blendSamples()
+		core::array<core::vector3df> BlendToPositions;
+		core::array<core::quaternion> BlendToRotations;
+		core::array<core::vector3df> BlendToScales;
+
+		//! Pull of a joint on a vertex
+		struct SSkinningInfluence
+		{
+			//! Index in SkeletonJoints
+			u32 Joint;
+			f32 Weight;
+		};
+
+		//! A vertex moved by joints, with its influences following each other in SkinningInfluences
+		struct SSkinningVertex
+		{
+			core::vector3df StaticPos;
+			core::vector3df StaticNormal;
+			u32 Vertex;
+			u32 FirstInfluence;
+			u32 InfluenceCount;
+		};
+
+		//! Part of a buffer skinned on another thread
+		struct SSkinningJob
+		{
+			CSkinnedMesh* Mesh;
+			u32 Buffer;
+			u32 First;
+			u32 Count;
+		};
+
+		//! Vertices are skinned in jobs of this size when their buffer has at least twice as many
+		static const u32 SkinningJobVertices = 4096;
+
+		//! Weighted vertices ordered by buffer and vertex
+		core::array<SSkinningVertex> SkinningVertices;
+		core::array<SSkinningInfluence> SkinningInfluences;
+		//! Index of the first vertex of each buffer in SkinningVertices, followed by the vertex count
+		core::array<u32> SkinningBufferStarts;
+		//! Joint matrices times the inverse of the static pose, one per joint of SkeletonJoints
+		core::array<core::matrix4> SkinningMatrices;
+		core::array<SSkinningJob> SkinningJobs;
+
+		//! Box of the static positions of the vertices a joint pulls on
+		struct SSkinningBox
+		{
+			//! Index in SkeletonJoints
+			u32 Joint;
+			core::aabbox3df Box;
+		};
+
+		//! Where the skinned vertices of a buffer can be, by the boxes of its joints
+		/** A skinned vertex is a weighted sum of its static position moved
+		by each of its joints. With weights adding up to at most 1 it lies
+		within the moved joint boxes, and the origin for weights below 1. */
+		struct SSkinningBounds
+		{
+			u32 FirstBox;
+			u32 BoxCount;
+			//! Box of the vertices no joint pulls on
+			core::aabbox3df StaticBox;
+			bool HasStatic;
+			bool HasOrigin;
+			//! False if the weights of a vertex add up to more than 1
+			bool Conservative;
+		};
+
+		core::array<SSkinningBounds> SkinningBounds;
+		core::array<SSkinningBox> SkinningBoxes;
+
+		//! Boxes of getLoopBoundingBox() by start and end frame
+		std::unordered_map<u64, core::aabbox3df> LoopBoxes;
+		u32 LoopBoxesGeneration;
+
+		//! Joints in the palette of each buffer when using hardware skinning, empty for buffers without weights
+		core::array< core::array<u32> > HardwareSkinningJoints;
+		//! Bounding boxes of the buffers in the static pose when using hardware skinning
+		core::array<core::aabbox3df> HardwareSkinningBoxes;
+
+		//! Skinned copy of the mesh buffers for one frame
+		struct SPose
+		{
+			SMesh* Mesh;
+			//! The buffers of Mesh
+			core::array<SSkinMeshBuffer*> Buffers;
+			f32 Frame;
+			u32 Generation;
+			//! The normals weren't animated for this frame
+			bool SkippedNormals;
+		};
+
+		//! Updates the buffers of a pose to be copies of the local buffers
+		void copyPoseBuffers(SPose& pose);
+
+		//! Animates the joints to a frame and skins the buffers of a pose
+		void skinPose(SPose& pose, f32 frame, CJobSystem* jobs, bool normals);
+
+		//! Interpolates the moved vertices of a pose between the baked frames
+		/** \return False if the frame isn't baked. */
+		bool interpolateBakedPose(SPose& pose, f32 frame);
+
+		//! Clip played instead of the keys of the joints
+		CAnimationClip* Clip;
+		//! Track of the clip for each joint by joint number, -1 for unmatched joints
+		const core::array<s32>* ClipJoints;
+		//! ClipJoints of each skeleton signature the mesh played a clip of
+		std::unordered_map<u64, core::array<s32> > ClipRemaps;
+		//! Track of the clip for each joint of SkeletonJoints
+		core::array<s32> SkeletonClipTracks;
+
+		//! Poses are only in use while grabbed by someone but the mesh
+		core::array<SPose*> Poses;
+		//! Index of the pose skinned to a frame
+		std::unordered_map<f32, u32> PoseCache;
+		//! Increased when poses of older generations can't be used anymore
+		u32 PoseGeneration;
+
+		//! Poses skinned by bakeFrames(), in steps of 1/BakedSamples frames from BakedBegin
+		core::array<SPose*> BakedFrames;
+		s32 BakedBegin;
+		s32 BakedEnd;
+		u32 BakedSamples;
+		bool BakedInterpolate;
 
 		core::aabbox3d<f32> BoundingBox;
 
@@ -0,0 +1,264 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CStaticBatchSceneNode.h"
+#include "CChunkGridSceneNode.h"
+#include "IMeshSceneNode.h"
+#include "IMeshManipulator.h"
+#include "ISceneManager.h"
+#include "SMesh.h"
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! Packs a cell position like the chunk keys of CChunkGridSceneNode
+	u64 makeCellKey(const core::vector3di& position)
+	{
+		return ((u64)(position.X & 0x1fffff) << 42) | ((u64)(position.Y & 0x1fffff) << 21) | (u64)(position.Z & 0x1fffff);
+	}
+
+	//! Absolute transformation from the relative ones, which are current even before the first frame
+	core::matrix4 getCurrentAbsoluteTransformation(const ISceneNode* node)
+	{
+		core::matrix4 transform(node->getRelativeTransformation());
+		for (const ISceneNode* parent = node->getParent(); parent; parent = parent->getParent())
+			transform = parent->getRelativeTransformation() * transform;
+		return transform;
+	}
+}
+
+
+//! The cells are chunks of a grid which isn't part of the scene graph, so
+//! it takes the transformation of the batch instead of calculating one
+class CStaticBatchSceneNode::CCellGrid : public CChunkGridSceneNode
+{
+public:
+	CCellGrid(ISceneManager* mgr) : CChunkGridSceneNode(0, mgr, -1) {}
+
+	void setAbsoluteTransformation(const core::matrix4& transform)
+	{
+		// getTransformedBoundingBox() is cached by the revision
+		if (transform == AbsoluteTransformation)
+			return;
+		AbsoluteTransformation = transform;
+		++TransformRevision;
+	}
+
+	void updateAbsolutePosition() override {}
+};
+
+
+//! constructor
+CStaticBatchSceneNode::CStaticBatchSceneNode(f32 cellSize, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position, const core::vector3df& rotation,
+			const core::vector3df& scale)
+: IStaticBatchSceneNode(parent, mgr, id, position, rotation, scale),
+	CellSize(core::max_(cellSize, core::ROUNDING_ERROR_f32)), Grid(0)
+{
+	#ifdef _DEBUG
+	setDebugName("CStaticBatchSceneNode");
+	#endif
+
+	Grid = new CCellGrid(mgr);
+}
+
+
+//! destructor
+CStaticBatchSceneNode::~CStaticBatchSceneNode()
+{
+	// members still in the scene are shown again
+	for (u32 i=0; i<Members.size(); ++i)
+	{
+		if (Members[i].Node->getParent())
+			Members[i].Node->setVisible(true);
+		Members[i].Node->drop();
+	}
+
+	Grid->drop();
+}
+
+
+//! frame
+void CStaticBatchSceneNode::OnRegisterSceneNode()
+{
+	if (IsVisible)
+	{
+		// members removed from the scene graph leave the batch
+		for (u32 i=Members.size(); i>0; --i)
+		{
+			if (!Members[i-1].Node->getParent())
+				removeNode(Members[i-1].Node);
+		}
+
+		rebuildCells();
+
+		Grid->setAbsoluteTransformation(AbsoluteTransformation);
+		Grid->setAutomaticCulling(AutomaticCullingState);
+		Grid->setDebugDataVisible(DebugDataVisible);
+		Grid->OnRegisterSceneNode();
+	}
+
+	ISceneNode::OnRegisterSceneNode();
+}
+
+
+//! returns the axis aligned bounding box of the merged cells
+const core::aabbox3d<f32>& CStaticBatchSceneNode::getBoundingBox() const
+{
+	return Grid->getBoundingBox();
+}
+
+
+//! returns the material based on the zero based index i.
+video::SMaterial& CStaticBatchSceneNode::getMaterial(u32 i)
+{
+	return Grid->getMaterial(i);
+}
+
+
+//! returns amount of materials used by this scene node.
+u32 CStaticBatchSceneNode::getMaterialCount() const
+{
+	return Grid->getMaterialCount();
+}
+
+
+//! Get the number of cells which passed culling in the last rendered frame
+u32 CStaticBatchSceneNode::getVisibleCellCount() const
+{
+	return Grid->getVisibleChunkCount();
+}
+
+
+//! Adds a mesh scene node to the batch
+void CStaticBatchSceneNode::addNode(IMeshSceneNode* node)
+{
+	if (!node || !node->getMesh() || MemberIndices.find(node) != MemberIndices.end())
+		return;
+
+	SMember member;
+	member.Node = node;
+	getCurrentAbsoluteTransformation(this).getInverse(member.Transform);
+	member.Transform *= getCurrentAbsoluteTransformation(node);
+
+	// the cell holding the center of the box
+	core::aabbox3df box = node->getMesh()->getBoundingBox();
+	member.Transform.transformBoxEx(box);
+	const core::vector3df center = box.getCenter() / CellSize;
+	const core::vector3di position(core::floor32(center.X), core::floor32(center.Y), core::floor32(center.Z));
+	member.Cell = makeCellKey(position);
+
+	node->grab();
+	node->setVisible(false);
+	MemberIndices[node] = Members.size();
+	Members.push_back(member);
+
+	std::unordered_map<u64, SCell>::iterator it = Cells.find(member.Cell);
+	if (it == Cells.end())
+	{
+		SCell cell;
+		cell.Position = position;
+		cell.Dirty = false;
+		it = Cells.insert(std::make_pair(member.Cell, cell)).first;
+	}
+	it->second.Nodes.push_back(node);
+	markDirty(member.Cell, it->second);
+}
+
+
+//! Removes a node from the batch and shows it again
+void CStaticBatchSceneNode::removeNode(IMeshSceneNode* node)
+{
+	std::unordered_map<const IMeshSceneNode*, u32>::iterator it = MemberIndices.find(node);
+	if (it == MemberIndices.end())
+		return;
+
+	const u32 index = it->second;
+	MemberIndices.erase(it);
+
+	SCell& cell = Cells[Members[index].Cell];
+	for (u32 i=0; i<cell.Nodes.size(); ++i)
+	{
+		if (cell.Nodes[i] == node)
+		{
+			cell.Nodes[i] = cell.Nodes.getLast();
+			cell.Nodes.erase(cell.Nodes.size() - 1);
+			break;
+		}
+	}
+	markDirty(Members[index].Cell, cell);
+
+	// the last member takes the place of the removed one
+	const u32 last = Members.size() - 1;
+	if (index != last)
+	{
+		Members[index] = Members[last];
+		MemberIndices[Members[index].Node] = index;
+	}
+	Members.erase(last);
+
+	if (node->getParent())
+		node->setVisible(true);
+	node->drop();
+}
+
+
+void CStaticBatchSceneNode::markDirty(u64 key, SCell& cell)
+{
+	if (cell.Dirty)
+		return;
+
+	cell.Dirty = true;
+	DirtyCells.push_back(key);
+}
+
+
+void CStaticBatchSceneNode::rebuildCells()
+{
+	if (DirtyCells.empty())
+		return;
+
+	IMeshManipulator* manipulator = SceneManager->getMeshManipulator();
+
+	for (u32 i=0; i<DirtyCells.size(); ++i)
+	{
+		std::unordered_map<u64, SCell>::iterator it = Cells.find(DirtyCells[i]);
+		SCell& cell = it->second;
+		cell.Dirty = false;
+
+		if (cell.Nodes.empty())
+		{
+			Grid->removeChunk(cell.Position);
+			Cells.erase(it);
+			continue;
+		}
+
+		MergeMeshes.set_used(0);
+		MergeTransforms.set_used(0);
+		MergeMaterials.set_used(0);
+		for (u32 n=0; n<cell.Nodes.size(); ++n)
+		{
+			IMeshSceneNode* node = cell.Nodes[n];
+			IMesh* mesh = node->getMesh();
+			MergeMeshes.push_back(mesh);
+			MergeTransforms.push_back(Members[MemberIndices[node]].Transform);
+			for (u32 b=0; b<mesh->getMeshBufferCount(); ++b)
+				MergeMaterials.push_back(b < node->getMaterialCount() ? node->getMaterial(b) : mesh->getMeshBuffer(b)->getMaterial());
+		}
+
+		SMesh* merged = manipulator->createMergedMesh(MergeMeshes, MergeTransforms, MergeMaterials);
+		Grid->setChunk(cell.Position, merged);
+		merged->drop();
+	}
+	DirtyCells.set_used(0);
+
+	updateSpatialIndex();
+}
+
+
+} // end namespace scene
+} // end namespace irr
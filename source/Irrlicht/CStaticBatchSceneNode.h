@@ -0,0 +1,107 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+#define __C_STATIC_BATCH_SCENE_NODE_H_INCLUDED__
+
+#include "IStaticBatchSceneNode.h"
+#include "IMesh.h"
+#include <unordered_map>
+
+namespace irr
+{
+namespace scene
+{
+
+	class CStaticBatchSceneNode : public IStaticBatchSceneNode
+	{
+	public:
+
+		//! constructor
+		CStaticBatchSceneNode(f32 cellSize, ISceneNode* parent, ISceneManager* mgr, s32 id,
+			const core::vector3df& position = core::vector3df(0,0,0),
+			const core::vector3df& rotation = core::vector3df(0,0,0),
+			const core::vector3df& scale = core::vector3df(1.0f, 1.0f, 1.0f));
+
+		//! destructor
+		virtual ~CStaticBatchSceneNode();
+
+		//! frame
+		void OnRegisterSceneNode() override;
+
+		//! renders the node, the cells draw themselves
+		void render() override {}
+
+		//! returns the axis aligned bounding box of the merged cells
+		const core::aabbox3d<f32>& getBoundingBox() const override;
+
+		//! returns the material based on the zero based index i.
+		video::SMaterial& getMaterial(u32 i) override;
+
+		//! returns amount of materials used by this scene node.
+		u32 getMaterialCount() const override;
+
+		//! Returns type of the scene node
+		ESCENE_NODE_TYPE getType() const override { return ESNT_STATIC_BATCH; }
+
+		//! Adds a mesh scene node to the batch
+		void addNode(IMeshSceneNode* node) override;
+
+		//! Removes a node from the batch and shows it again
+		void removeNode(IMeshSceneNode* node) override;
+
+		//! Get the number of nodes in the batch
+		u32 getNodeCount() const override { return Members.size(); }
+
+		//! Get the number of cells holding nodes
+		u32 getCellCount() const override { return (u32)Cells.size(); }
+
+		//! Get the number of cells which passed culling in the last rendered frame
+		u32 getVisibleCellCount() const override;
+
+	protected:
+
+		//! The chunk grid drawing the merged cells
+		class CCellGrid;
+
+		struct SMember
+		{
+			IMeshSceneNode* Node;
+			//! Transformation of the node relative to the batch when it was added
+			core::matrix4 Transform;
+			u64 Cell;
+		};
+
+		struct SCell
+		{
+			core::vector3di Position;
+			core::array<IMeshSceneNode*> Nodes;
+			bool Dirty;
+		};
+
+		//! Queues a cell to be merged again
+		void markDirty(u64 key, SCell& cell);
+
+		//! Merges the cells whose members changed
+		void rebuildCells();
+
+		f32 CellSize;
+
+		core::array<SMember> Members;
+		std::unordered_map<const IMeshSceneNode*, u32> MemberIndices;
+
+		std::unordered_map<u64, SCell> Cells;
+		core::array<u64> DirtyCells;
+
+		CCellGrid* Grid;
+
+		//! Merge input, kept for reuse
+		core::array<IMesh*> MergeMeshes;
+		core::array<core::matrix4> MergeTransforms;
+		core::array<video::SMaterial> MergeMaterials;
+	};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -50,6 +50,24 @@ namespace irr
 			os::Timer::setTime(time);
 		}
 
+		//! Returns current real time in nanoseconds of a monotonic clock.
+		u64 getRealTimeNs() const override
+		{
+			return os::Timer::getRealTimeNs();
+		}
+
+		//! Returns current virtual time in nanoseconds.
+		u64 getTimeNs() const override
+		{
+			return os::Timer::getTimeNs();
+		}
+
+		//! Sets current virtual time in nanoseconds
+		void setTimeNs(u64 time) override
+		{
+			os::Timer::setTimeNs(time);
+		}
+
 		//! Stops the game timer.
 		/** The timer is reference counted, which means everything which calls
 		stopTimer() will also have to call startTimer(), otherwise the timer may not start/stop
@@ -0,0 +1,273 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#include "CTriangleBVH.h"
+#include "IMeshBuffer.h"
+#include <algorithm>
+
+namespace irr
+{
+namespace scene
+{
+
+namespace
+{
+	//! Triangles per leaf
+	const u32 MaxLeafSize = 4;
+
+	//! Slab test, returns the entry distance in tNear
+	inline bool intersectsBox(const core::aabbox3df& box, const core::vector3df& start,
+		const core::vector3df& invDir, f32 tMax, f32& tNear)
+	{
+		f32 t1 = (box.MinEdge.X - start.X) * invDir.X;
+		f32 t2 = (box.MaxEdge.X - start.X) * invDir.X;
+		f32 tMin = core::min_(t1, t2);
+		f32 tFar = core::max_(t1, t2);
+
+		t1 = (box.MinEdge.Y - start.Y) * invDir.Y;
+		t2 = (box.MaxEdge.Y - start.Y) * invDir.Y;
+		tMin = core::max_(tMin, core::min_(t1, t2));
+		tFar = core::min_(tFar, core::max_(t1, t2));
+
+		t1 = (box.MinEdge.Z - start.Z) * invDir.Z;
+		t2 = (box.MaxEdge.Z - start.Z) * invDir.Z;
+		tMin = core::max_(tMin, core::min_(t1, t2));
+		tFar = core::min_(tFar, core::max_(t1, t2));
+
+		tNear = tMin;
+		return tFar >= core::max_(tMin, 0.f) && tMin <= tMax;
+	}
+
+	//! Moeller-Trumbore intersection, t along dir
+	inline bool intersectsTriangle(const core::vector3df& a, const core::vector3df& b, const core::vector3df& c,
+		const core::vector3df& start, const core::vector3df& dir, f32& t)
+	{
+		const core::vector3df e1 = b - a;
+		const core::vector3df e2 = c - a;
+		const core::vector3df p = dir.crossProduct(e2);
+		const f32 det = e1.dotProduct(p);
+		if (core::iszero(det, 1e-12f))
+			return false;
+
+		const f32 invDet = 1.f / det;
+		const core::vector3df s = start - a;
+		const f32 u = s.dotProduct(p) * invDet;
+		if (u < 0.f || u > 1.f)
+			return false;
+
+		const core::vector3df q = s.crossProduct(e1);
+		const f32 v = dir.dotProduct(q) * invDet;
+		if (v < 0.f || u + v > 1.f)
+			return false;
+
+		t = e2.dotProduct(q) * invDet;
+		return true;
+	}
+
+	//! Avoids infinities for axis aligned rays, which make 0 * inf in the slab test
+	inline f32 getInverse(f32 d)
+	{
+		return 1.f / (core::iszero(d, 1e-20f) ? (d < 0.f ? -1e-20f : 1e-20f) : d);
+	}
+}
+
+CTriangleBVH::CTriangleBVH(const IMesh* mesh)
+{
+	const u32 bufferCount = mesh->getMeshBufferCount();
+	ChangedIDs.resize(bufferCount * 2);
+
+	for (u32 i = 0; i < bufferCount; ++i)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+		ChangedIDs[i * 2] = mb->getChangedID_Vertex();
+		ChangedIDs[i * 2 + 1] = mb->getChangedID_Index();
+
+		if (mb->getPrimitiveType() != EPT_TRIANGLES)
+			continue;
+
+		const u32 vertexCount = mb->getVertexCount();
+		const u32 indexCount = mb->getIndexCount() / 3 * 3;
+		const u16* indices16 = mb->getIndices();
+		const u32* indices32 = reinterpret_cast<const u32*>(indices16);
+		const bool is32Bit = mb->getIndexType() == video::EIT_32BIT;
+
+		for (u32 j = 0; j < indexCount; j += 3)
+		{
+			u32 idx[3];
+			for (u32 k = 0; k < 3; ++k)
+				idx[k] = is32Bit ? indices32[j + k] : indices16[j + k];
+			if (idx[0] >= vertexCount || idx[1] >= vertexCount || idx[2] >= vertexCount)
+				continue;
+
+			STriangle triangle;
+			triangle.A = mb->getPosition(idx[0]);
+			triangle.B = mb->getPosition(idx[1]);
+			triangle.C = mb->getPosition(idx[2]);
+			triangle.MeshBuffer = i;
+			triangle.Index = j / 3;
+			Triangles.push_back(triangle);
+		}
+	}
+
+	if (Triangles.empty())
+		return;
+
+	std::vector<core::vector3df> centers(Triangles.size());
+	for (u32 i = 0; i < Triangles.size(); ++i)
+		centers[i] = (Triangles[i].A + Triangles[i].B + Triangles[i].C) / 3.f;
+
+	Nodes.reserve(Triangles.size() / MaxLeafSize * 2 + 1);
+	build(0, Triangles.size(), centers);
+}
+
+bool CTriangleBVH::isOutdated(const IMesh* mesh) const
+{
+	const u32 bufferCount = mesh->getMeshBufferCount();
+	if (bufferCount * 2 != ChangedIDs.size())
+		return true;
+
+	for (u32 i = 0; i < bufferCount; ++i)
+	{
+		const IMeshBuffer* mb = mesh->getMeshBuffer(i);
+		if (ChangedIDs[i * 2] != mb->getChangedID_Vertex() || ChangedIDs[i * 2 + 1] != mb->getChangedID_Index())
+			return true;
+	}
+	return false;
+}
+
+u32 CTriangleBVH::build(u32 first, u32 count, std::vector<core::vector3df>& centers)
+{
+	const u32 index = Nodes.size();
+	Nodes.push_back(SBVHNode());
+
+	core::aabbox3df box(Triangles[first].A);
+	core::aabbox3df centerBox(centers[first]);
+	for (u32 i = first; i < first + count; ++i)
+	{
+		box.addInternalPoint(Triangles[i].A);
+		box.addInternalPoint(Triangles[i].B);
+		box.addInternalPoint(Triangles[i].C);
+		centerBox.addInternalPoint(centers[i]);
+	}
+	Nodes[index].Box = box;
+
+	const core::vector3df extent = centerBox.getExtent();
+	if (count <= MaxLeafSize || extent.getLengthSQ() == 0.f)
+	{
+		Nodes[index].Offset = first;
+		Nodes[index].Count = count;
+		return index;
+	}
+
+	// split at the median of the longest axis of the centers
+	const u32 axis = (extent.X >= extent.Y && extent.X >= extent.Z) ? 0 : (extent.Y >= extent.Z ? 1 : 2);
+	std::vector<u32> order(count);
+	for (u32 i = 0; i < count; ++i)
+		order[i] = first + i;
+
+	const u32 half = count / 2;
+	std::nth_element(order.begin(), order.begin() + half, order.end(), [&centers, axis](u32 a, u32 b)
+	{
+		const core::vector3df& ca = centers[a];
+		const core::vector3df& cb = centers[b];
+		return axis == 0 ? ca.X < cb.X : (axis == 1 ? ca.Y < cb.Y : ca.Z < cb.Z);
+	});
+
+	std::vector<STriangle> triangles(count);
+	std::vector<core::vector3df> sortedCenters(count);
+	for (u32 i = 0; i < count; ++i)
+	{
+		triangles[i] = Triangles[order[i]];
+		sortedCenters[i] = centers[order[i]];
+	}
+	std::copy(triangles.begin(), triangles.end(), Triangles.begin() + first);
+	std::copy(sortedCenters.begin(), sortedCenters.end(), centers.begin() + first);
+
+	build(first, half, centers);
+	const u32 second = build(first + half, count - half, centers);
+	Nodes[index].Offset = second;
+	Nodes[index].Count = 0;
+	return index;
+}
+
+bool CTriangleBVH::getNearestHit(const core::line3df& ray, f32& t, u32& meshBuffer, u32& triangleIndex, core::triangle3df& triangle) const
+{
+	if (Nodes.empty())
+		return false;
+
+	const core::vector3df start = ray.start;
+	const core::vector3df dir = ray.getVector();
+	const core::vector3df invDir(getInverse(dir.X), getInverse(dir.Y), getInverse(dir.Z));
+
+	const STriangle* best = 0;
+	f32 bestT = core::min_(t, 1.f);
+
+	u32 stack[64];
+	u32 stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize)
+	{
+		const u32 nodeIndex = stack[--stackSize];
+		const SBVHNode& node = Nodes[nodeIndex];
+
+		f32 tNear;
+		if (!intersectsBox(node.Box, start, invDir, bestT, tNear))
+			continue;
+
+		if (node.Count)
+		{
+			for (u32 i = node.Offset; i < node.Offset + node.Count; ++i)
+			{
+				const STriangle& tri = Triangles[i];
+				f32 hitT;
+				if (intersectsTriangle(tri.A, tri.B, tri.C, start, dir, hitT) && hitT >= 0.f && hitT <= bestT)
+				{
+					bestT = hitT;
+					best = &tri;
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first
+		const u32 first = nodeIndex + 1;
+		const u32 second = node.Offset;
+		f32 tFirst, tSecond;
+		const bool hitFirst = intersectsBox(Nodes[first].Box, start, invDir, bestT, tFirst);
+		const bool hitSecond = intersectsBox(Nodes[second].Box, start, invDir, bestT, tSecond);
+		if (hitFirst && hitSecond)
+		{
+			if (tFirst < tSecond)
+			{
+				stack[stackSize++] = second;
+				stack[stackSize++] = first;
+			}
+			else
+			{
+				stack[stackSize++] = first;
+				stack[stackSize++] = second;
+			}
+		}
+		else if (hitFirst)
+		{
+			stack[stackSize++] = first;
+		}
+		else if (hitSecond)
+		{
+			stack[stackSize++] = second;
+		}
+	}
+
+	if (!best)
+		return false;
+
+	t = bestT;
+	meshBuffer = best->MeshBuffer;
+	triangleIndex = best->Index;
+	triangle.set(best->A, best->B, best->C);
+	return true;
+}
+
+} // end namespace scene
+} // end namespace irr
@@ -0,0 +1,73 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+#ifndef __C_TRIANGLE_BVH_H_INCLUDED__
+#define __C_TRIANGLE_BVH_H_INCLUDED__
+
+#include "IMesh.h"
+#include "aabbox3d.h"
+#include "line3d.h"
+#include "triangle3d.h"
+#include <vector>
+
+namespace irr
+{
+namespace scene
+{
+
+//! Bounding volume hierarchy over the triangles of a mesh, for ray queries.
+/** Holds a copy of the vertex positions, so it has to be rebuilt when the
+mesh changes, see isOutdated(). Only mesh buffers with triangle lists are
+used. */
+class CTriangleBVH
+{
+public:
+	//! Builds the hierarchy from the current vertices of a mesh
+	CTriangleBVH(const IMesh* mesh);
+
+	//! Checks if the mesh buffers changed since the hierarchy was built
+	bool isOutdated(const IMesh* mesh) const;
+
+	//! Finds the nearest triangle hit by a line segment
+	/** \param ray Line segment in the space of the mesh.
+	\param t Receives the position of the hit along the ray, between 0 and 1.
+	Only hits before its value on input are found.
+	\param meshBuffer Receives the index of the mesh buffer of the triangle.
+	\param triangleIndex Receives the index of the triangle in its mesh buffer.
+	\param triangle Receives the triangle.
+	\return True if a triangle was hit. */
+	bool getNearestHit(const core::line3df& ray, f32& t, u32& meshBuffer, u32& triangleIndex, core::triangle3df& triangle) const;
+
+	u32 getTriangleCount() const { return Triangles.size(); }
+
+private:
+	struct STriangle
+	{
+		core::vector3df A, B, C;
+		u32 MeshBuffer;
+		u32 Index;
+	};
+
+	struct SBVHNode
+	{
+		core::aabbox3df Box;
+		//! First triangle of leaves, second child of inner nodes
+		u32 Offset;
+		//! Triangles of leaves, 0 for inner nodes
+		u32 Count;
+	};
+
+	//! Returns the index of the new node, its first child follows right after it
+	u32 build(u32 first, u32 count, std::vector<core::vector3df>& centers);
+
+	std::vector<STriangle> Triangles;
+	std::vector<SBVHNode> Nodes;
+
+	//! Change ids of the mesh buffers when the hierarchy was built
+	std::vector<u32> ChangedIDs;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
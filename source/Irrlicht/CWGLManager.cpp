@@ -472,6 +472,82 @@ bool CWGLManager::activateContext(const SExposedVideoData& videoData, bool resto
 	return true;
 }
 
+bool CWGLManager::setContextCurrent(bool current)
+{
+	const BOOL success = current ?
+		wglMakeCurrent((HDC)CurrentContext.OpenGLWin32.HDc, (HGLRC)CurrentContext.OpenGLWin32.HRc) :
+		wglMakeCurrent((HDC)0, (HGLRC)0);
+	if (!success)
+		os::Printer::log(current ? "Render Context switch failed." : "Render Context reset failed.");
+	return success != FALSE;
+}
+
+void* CWGLManager::createSharedContext()
+{
+	HDC HDc=(HDC)PrimaryContext.OpenGLWin32.HDc;
+	HGLRC shareContext=(HGLRC)PrimaryContext.OpenGLWin32.HRc;
+	if (!shareContext)
+		return 0;
+
+	HGLRC hrc=0;
+	// the context has no window of its own, it's made current with the one of the primary context
+#ifdef WGL_ARB_create_context
+	PFNWGLCREATECONTEXTATTRIBSARBPROC wglCreateContextAttribs_ARB = (PFNWGLCREATECONTEXTATTRIBSARBPROC)FunctionPointers[0];
+	if (wglCreateContextAttribs_ARB)
+	{
+		const int iAttribs[] =
+		{
+			WGL_CONTEXT_MAJOR_VERSION_ARB, 1,
+			WGL_CONTEXT_MINOR_VERSION_ARB, 1,
+			0
+		};
+		hrc=wglCreateContextAttribs_ARB(HDc, shareContext, iAttribs);
+	}
+	else
+#endif
+	{
+		// sharing fails once the new context owns objects, so it's done right away
+		hrc=wglCreateContext(HDc);
+		if (hrc && !wglShareLists(shareContext, hrc))
+		{
+			wglDeleteContext(hrc);
+			hrc=0;
+		}
+	}
+
+	if (!hrc)
+		os::Printer::log("Cannot create a shared GL rendering context.", ELL_WARNING);
+	return hrc;
+}
+
+bool CWGLManager::makeSharedContextCurrent(void* context)
+{
+	const BOOL success = context ?
+		wglMakeCurrent((HDC)PrimaryContext.OpenGLWin32.HDc, (HGLRC)context) :
+		wglMakeCurrent((HDC)0, (HGLRC)0);
+	if (!success)
+		os::Printer::log(context ? "Shared Render Context switch failed." : "Shared Render Context reset failed.", ELL_WARNING);
+	return success != FALSE;
+}
+
+void CWGLManager::destroySharedContext(void* context)
+{
+	if (context && !wglDeleteContext((HGLRC)context))
+		os::Printer::log("Deletion of shared render context failed.", ELL_WARNING);
+}
+
+bool CWGLManager::setSwapInterval(s32 interval)
+{
+	PFNWGLSWAPINTERVALEXTPROC wglSwapInterval_EXT = (PFNWGLSWAPINTERVALEXTPROC)wglGetProcAddress("wglSwapIntervalEXT");
+	if (!wglSwapInterval_EXT)
+		return false;
+
+	// adaptive vsync needs WGL_EXT_swap_control_tear, otherwise it's normal vsync
+	if (wglSwapInterval_EXT(interval))
+		return true;
+	return interval < 0 && wglSwapInterval_EXT(-interval);
+}
+
 void CWGLManager::destroyContext()
 {
 	if (CurrentContext.OpenGLWin32.HRc)
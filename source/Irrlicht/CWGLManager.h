@@ -55,6 +55,21 @@ namespace video
 		//! Change render context, disable old and activate new defined by videoData
 		bool activateContext(const SExposedVideoData& videoData, bool restorePrimaryOnZero) override;
 
+		//! Makes the context current on the calling thread, or releases it
+		bool setContextCurrent(bool current) override;
+
+		//! Creates a context sharing the resources of the context of the manager
+		void* createSharedContext() override;
+
+		//! Makes a context of createSharedContext() current on the calling thread, or releases it
+		bool makeSharedContextCurrent(void* context) override;
+
+		//! Destroys a context of createSharedContext()
+		void destroySharedContext(void* context) override;
+
+		//! Sets how many vertical blanks swapBuffers() waits for
+		bool setSwapInterval(s32 interval) override;
+
 		// Get procedure address.
 		void* getProcAddress(const std::string &procName) override;
 
@@ -19,6 +19,8 @@ namespace video
 CWebGL1Driver::CWebGL1Driver(const SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager) :
 	COGLES2Driver(params, io, contextManager)
 	, MBTriangleFanSize4(0), MBLinesSize2(0), MBPointsSize1(0)
+	, StreamVertexBufferID(0), StreamIndexBufferID(0)
+	, StreamVertexAllocator(1, StreamBufferSize), StreamIndexAllocator(1, StreamBufferSize)
 {
 #ifdef _DEBUG
 	setDebugName("CWebGL1Driver");
@@ -45,6 +47,11 @@ CWebGL1Driver::~CWebGL1Driver()
 		MBLinesSize2->drop();
 	if ( MBPointsSize1 )
 		MBPointsSize1->drop();
+
+	if ( StreamVertexBufferID )
+		glDeleteBuffers(1, &StreamVertexBufferID);
+	if ( StreamIndexBufferID )
+		glDeleteBuffers(1, &StreamIndexBufferID);
 }
 
 //! Returns type of video driver
@@ -53,6 +60,27 @@ E_DRIVER_TYPE CWebGL1Driver::getDriverType() const
 	return EDT_WEBGL1;
 }
 
+//! Number of indices COGLES2Driver::renderPrimitiveList reads
+static u32 getIndexCount(scene::E_PRIMITIVE_TYPE pType, u32 primitiveCount)
+{
+	switch (pType)
+	{
+		case scene::EPT_LINE_STRIP:
+			return primitiveCount + 1;
+		case scene::EPT_LINE_LOOP:
+			return primitiveCount;
+		case scene::EPT_LINES:
+			return primitiveCount * 2;
+		case scene::EPT_TRIANGLE_STRIP:
+		case scene::EPT_TRIANGLE_FAN:
+			return primitiveCount + 2;
+		case scene::EPT_TRIANGLES:
+			return primitiveCount * 3;
+		default:
+			return 0;
+	}
+}
+
 //! draws a vertex primitive list
 void CWebGL1Driver::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
                              const void* indexList, u32 primitiveCount,
@@ -61,14 +89,46 @@ void CWebGL1Driver::drawVertexPrimitiveList(const void* vertices, u32 vertexCoun
 	if ( !vertices )
 	{
 		COGLES2Driver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+		return;
 	}
-	else
+
+	if (!primitiveCount || !vertexCount)
+		return;
+
+	if (!checkPrimitiveCount(primitiveCount))
+		return;
+
+	if (vType == EVT_SKINNED || vType == EVT_COMPACT)
+		return;
+
+	// WebGL can't read client memory, so the geometry goes through the stream buffers.
+	u32 verticesOffset = 0;
+	u32 indicesOffset = 0;
+	const u32 indexCount = getIndexCount(pType, primitiveCount);
+	bool streamed = uploadStreamData(GL_ARRAY_BUFFER, StreamVertexBufferID, StreamVertexAllocator,
+		vertices, vertexCount * getVertexPitchFromType(vType), verticesOffset);
+	if (streamed && indexCount)
+	{
+		streamed = indexList && uploadStreamData(GL_ELEMENT_ARRAY_BUFFER, StreamIndexBufferID, StreamIndexAllocator,
+			indexList, indexCount * (iType == EIT_32BIT ? sizeof(u32) : sizeof(u16)), indicesOffset);
+	}
+
+	if (streamed)
+	{
+		CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+		renderPrimitiveList(verticesOffset, (const u8*)0 + indicesOffset, primitiveCount, vType, pType, iType);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	if (!streamed)
 	{
 		static bool first = true;
 		if ( first )
 		{
 			first = false;
-			os::Printer::log("WebGL driver does not support drawVertexPrimitiveList calls without a VBO", ELL_WARNING);
+			os::Printer::log("WebGL driver could not stream a drawVertexPrimitiveList call without a VBO", ELL_WARNING);
 			os::Printer::log(__FILE__, irr::core::stringc(__LINE__).c_str(), ELL_WARNING);
 		}
 	}
@@ -1040,6 +1100,8 @@ bool CWebGL1Driver::genericDriverInit(const core::dimension2d<u32>& screenSize,
 	// create material renderers
 	createMaterialRenderers();
 
+	initStreamBuffers();
+
 	// set the renderstates
 	setRenderStates3DMode();
 
@@ -1101,6 +1163,42 @@ void CWebGL1Driver::initWebGLExtensions()
 	Feature.ColorAttachment = 1;
 }
 
+void CWebGL1Driver::initStreamBuffers()
+{
+	glGenBuffers(1, &StreamVertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, StreamVertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, StreamVertexAllocator.getSize(), 0, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	glGenBuffers(1, &StreamIndexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, StreamIndexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, StreamIndexAllocator.getSize(), 0, GL_STREAM_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	testGLError(__LINE__);
+}
+
+bool CWebGL1Driver::uploadStreamData(GLenum target, GLuint buffer, COpenGLCoreStreamAllocator& allocator,
+	const void* data, u32 size, u32& offset)
+{
+	if (!buffer || !size || size > allocator.getSize())
+		return false;
+
+	glBindBuffer(target, buffer);
+	if (!allocator.allocate(size, offset))
+	{
+		// Orphan the full buffer, the draws still reading it keep the old storage.
+		glBufferData(target, allocator.getSize(), 0, GL_STREAM_DRAW);
+		countBufferUpload(0, true);
+		allocator.resetRegion();
+		allocator.allocate(size, offset);
+	}
+
+	glBufferSubData(target, offset, size, data);
+	countBufferUpload(size, false);
+	return true;
+}
+
 } // end namespace video
 } // end namespace irr
 
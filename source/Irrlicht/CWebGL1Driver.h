@@ -14,6 +14,7 @@
 #include "CWebGLExtensionHandler.h"
 #include "CMeshBuffer.h"
 #include "EHardwareBufferFlags.h"
+#include "COpenGLCoreStreamAllocator.h"
 
 namespace irr
 {
@@ -126,6 +127,15 @@ namespace video
 		bool genericDriverInit(const core::dimension2d<u32>& screenSize, bool stencilBuffer) override;
 		void initWebGLExtensions();
 
+		//! Creates the buffers client-side geometry is streamed through
+		void initStreamBuffers();
+
+		//! Copies data into a stream buffer, orphaning the buffer when it is full
+		/** \param offset Receives the offset of the data in the buffer.
+		\return False if the data doesn't fit into the buffer at all. */
+		bool uploadStreamData(GLenum target, GLuint buffer, COpenGLCoreStreamAllocator& allocator,
+				const void* data, u32 size, u32& offset);
+
 	private:
 		// CWebGL1Driver is derived from COGLES2Driver so it already got an extension handler from that.
 		// But we shouldn't use other extensions most of the time as there are minor differences.
@@ -135,6 +145,14 @@ namespace video
 		scene::SMeshBuffer* MBTriangleFanSize4;
 		scene::SMeshBuffer* MBLinesSize2;
 		scene::SMeshBuffer* MBPointsSize1;
+
+		// WebGL doesn't allow binding one buffer to both the array and the element target,
+		// so vertices and indices get a stream buffer each.
+		static const u32 StreamBufferSize = 1024 * 1024;
+		GLuint StreamVertexBufferID;
+		GLuint StreamIndexBufferID;
+		COpenGLCoreStreamAllocator StreamVertexAllocator;
+		COpenGLCoreStreamAllocator StreamIndexAllocator;
 	};
 
 } // end namespace video
@@ -4,6 +4,7 @@
 
 #include "CWriteFile.h"
 #include <stdio.h>
+#include <string.h>
 
 namespace irr
 {
@@ -11,14 +12,18 @@ namespace io
 {
 
 
-CWriteFile::CWriteFile(const io::path& fileName, bool append)
-: Filename(fileName), FileSize(0)
+CWriteFile::CWriteFile(const io::path& fileName, bool append, u32 bufferSize)
+: Filename(fileName), FileSize(0), Buffer(0), BufferSize(bufferSize),
+	BufferUsed(0), BufferPos(0), BufferStart(0)
 {
 	#ifdef _DEBUG
 	setDebugName("CWriteFile");
 	#endif
 
 	openFile(append);
+
+	if (File && BufferSize)
+		Buffer = new c8[BufferSize];
 }
 
 
@@ -26,7 +31,11 @@ CWriteFile::CWriteFile(const io::path& fileName, bool append)
 CWriteFile::~CWriteFile()
 {
 	if (File)
+	{
+		flushBuffer();
 		fclose(File);
+	}
+	delete [] Buffer;
 }
 
 
@@ -42,10 +51,57 @@ inline bool CWriteFile::isOpen() const
 //! returns how much was read
 size_t CWriteFile::write(const void* buffer, size_t sizeToWrite)
 {
-	if (!isOpen())
+	if (!isOpen() || !sizeToWrite)
 		return 0;
 
-	return fwrite(buffer, 1, sizeToWrite, File);
+	if (BufferPos + sizeToWrite > BufferSize)
+	{
+		if (!flushBuffer())
+			return 0;
+
+		// large blocks are written through
+		if (sizeToWrite >= BufferSize)
+		{
+			const size_t written = fwrite(buffer, 1, sizeToWrite, File);
+			BufferStart += (long)written;
+			return written;
+		}
+	}
+
+	memcpy(Buffer + BufferPos, buffer, sizeToWrite);
+	BufferPos += (u32)sizeToWrite;
+	if (BufferPos > BufferUsed)
+		BufferUsed = BufferPos;
+	return sizeToWrite;
+}
+
+
+
+//! Writes the buffered bytes to the file and empties the buffer
+bool CWriteFile::flushBuffer()
+{
+	if (!BufferUsed)
+		return true;
+
+	const bool written = fwrite(Buffer, 1, BufferUsed, File) == BufferUsed;
+	const long pos = BufferStart + BufferPos;
+	const long end = BufferStart + BufferUsed;
+	BufferUsed = 0;
+	BufferPos = 0;
+
+	// the file is behind the buffer now, go back if the last seek went into it
+	if (!written)
+	{
+		fseek(File, pos, SEEK_SET);
+		BufferStart = ftell(File);
+	}
+	else
+	{
+		if (pos != end)
+			fseek(File, pos, SEEK_SET);
+		BufferStart = pos;
+	}
+	return written;
 }
 
 
@@ -58,7 +114,20 @@ bool CWriteFile::seek(long finalPos, bool relativeMovement)
 	if (!isOpen())
 		return false;
 
-	return fseek(File, finalPos, relativeMovement ? SEEK_CUR : SEEK_SET) == 0;
+	if (relativeMovement)
+		finalPos += getPos();
+
+	// patch bytes which weren't written yet in the buffer
+	if (finalPos >= BufferStart && finalPos <= BufferStart + (long)BufferUsed)
+	{
+		BufferPos = (u32)(finalPos - BufferStart);
+		return true;
+	}
+
+	flushBuffer();
+	const bool success = fseek(File, finalPos, SEEK_SET) == 0;
+	BufferStart = ftell(File);
+	return success;
 }
 
 
@@ -66,7 +135,7 @@ bool CWriteFile::seek(long finalPos, bool relativeMovement)
 //! returns where in the file we are.
 long CWriteFile::getPos() const
 {
-	return ftell(File);
+	return BufferStart + BufferPos;
 }
 
 
@@ -89,6 +158,7 @@ void CWriteFile::openFile(bool append)
 		fseek(File, 0, SEEK_END);
 		FileSize = ftell(File);
 		fseek(File, 0, SEEK_SET);
+		BufferStart = ftell(File);
 	}
 }
 
@@ -106,12 +176,15 @@ bool CWriteFile::flush()
 	if (!isOpen())
 		return false;
 
+	if (!flushBuffer())
+		return false;
+
 	return fflush(File) == 0; // 0 indicates success, otherwise EOF and errno is set
 }
 
-IWriteFile* CWriteFile::createWriteFile(const io::path& fileName, bool append)
+IWriteFile* CWriteFile::createWriteFile(const io::path& fileName, bool append, u32 bufferSize)
 {
-	CWriteFile* file = new CWriteFile(fileName, append);
+	CWriteFile* file = new CWriteFile(fileName, append, bufferSize);
 	if (file->isOpen())
 		return file;
 
@@ -17,12 +17,14 @@ namespace io
 
 	/*!
 		Class for writing a real file to disk.
+		Writes are collected in a buffer, seeking back into the buffered bytes
+		patches them in memory, like the chunk sizes written by mesh writers.
 	*/
 	class CWriteFile : public IWriteFile
 	{
 	public:
 
-		CWriteFile(const io::path& fileName, bool append);
+		CWriteFile(const io::path& fileName, bool append, u32 bufferSize);
 
 		virtual ~CWriteFile();
 
@@ -45,16 +47,28 @@ namespace io
 		bool isOpen() const;
 
 		//! creator method
-		static IWriteFile* createWriteFile(const io::path& fileName, bool append);
+		/** \param bufferSize Bytes collected before they are written, 0 writes each call through. */
+		static IWriteFile* createWriteFile(const io::path& fileName, bool append, u32 bufferSize = 64 * 1024);
 
 	private:
 
 		//! opens the file
 		void openFile(bool append);
 
+		//! Writes the buffered bytes to the file and empties the buffer
+		bool flushBuffer();
+
 		io::path Filename;
 		FILE* File;
 		long FileSize;
+
+		//! Bytes which belong at BufferStart in the file, the file is positioned there
+		c8* Buffer;
+		u32 BufferSize;
+		u32 BufferUsed;
+		//! Write position in the buffer, below BufferUsed after seeking back
+		u32 BufferPos;
+		long BufferStart;
 	};
 
 } // end namespace io
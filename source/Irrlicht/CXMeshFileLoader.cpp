@@ -10,7 +10,10 @@
 #include "coreutil.h"
 #include "ISceneManager.h"
 #include "IVideoDriver.h"
-#include "IReadFile.h"
+#include "IMemoryReadFile.h"
+#include "IAttributes.h"
+
+#include <zlib.h> // use system lib
 
 #ifdef _DEBUG
 #define _XREADER_DEBUG
@@ -24,8 +27,9 @@ namespace scene
 
 //! Constructor
 CXMeshFileLoader::CXMeshFileLoader(scene::ISceneManager* smgr)
-: AnimatedMesh(0), Buffer(0), P(0), End(0), BinaryNumCount(0), Line(0),
-	CurFrame(0), MajorVersion(0), MinorVersion(0), BinaryFormat(false), FloatSize(0)
+: AnimatedMesh(0), Buffer(0), Copy(0), P(0), End(0), BinaryNumCount(0), Line(0),
+	CurFrame(0), MajorVersion(0), MinorVersion(0), BinaryFormat(false), FloatSize(0),
+	LoadTextures(false), SceneManager(smgr)
 {
 	#ifdef _DEBUG
 	setDebugName("CXMeshFileLoader");
@@ -55,6 +59,7 @@ IAnimatedMesh* CXMeshFileLoader::createMesh(io::IReadFile* file)
 #endif
 
 	AnimatedMesh = new CSkinnedMesh();
+	LoadTextures = SceneManager->getParameters()->getAttributeAsBool(MESH_LOADER_TEXTURES);
 
 	if (load(file))
 	{
@@ -85,7 +90,8 @@ IAnimatedMesh* CXMeshFileLoader::createMesh(io::IReadFile* file)
 	End=0;
 	CurFrame=0;
 
-	delete [] Buffer;
+	delete [] Copy;
+	Copy = 0;
 	Buffer = 0;
 
 	for (u32 i=0; i<Meshes.size(); ++i)
@@ -206,8 +212,8 @@ bool CXMeshFileLoader::load(io::IReadFile* file)
 				for (u32 j=0; j < Array.size(); ++j)
 				{
 					scene::SSkinMeshBuffer *buffer = mesh->Buffers[ Array[j] ];
-					verticesLinkIndex[i].push_back( buffer->Vertices_Standard.size() );
-					buffer->Vertices_Standard.push_back( mesh->Vertices[i] );
+					verticesLinkIndex[i].push_back( buffer->getVertexCount() );
+					buffer->pushVertex( mesh->Vertices[i] );
 				}
 			}
 
@@ -309,14 +315,14 @@ bool CXMeshFileLoader::load(io::IReadFile* file)
 				{
 					for (i=0; i!=mesh->Buffers.size(); ++i)
 					{
-						mesh->Buffers[i]->Vertices_2TCoords.reallocate(vCountArray[i]);
-						mesh->Buffers[i]->VertexType=video::EVT_2TCOORDS;
+						mesh->Buffers[i]->setVertexType(video::EVT_2TCOORDS);
+						mesh->Buffers[i]->reallocateVertices(vCountArray[i]);
 					}
 				}
 				else
 				{
 					for (i=0; i!=mesh->Buffers.size(); ++i)
-						mesh->Buffers[i]->Vertices_Standard.reallocate(vCountArray[i]);
+						mesh->Buffers[i]->reallocateVertices(vCountArray[i]);
 				}
 
 				verticesLinkIndex.set_used(mesh->Vertices.size());
@@ -330,16 +336,17 @@ bool CXMeshFileLoader::load(io::IReadFile* file)
 
 					if (mesh->TCoords2.size())
 					{
-						verticesLinkIndex[i] = buffer->Vertices_2TCoords.size();
-						buffer->Vertices_2TCoords.push_back( mesh->Vertices[i] );
+						verticesLinkIndex[i] = buffer->getVertexCount();
+						video::S3DVertex2TCoords vertex(mesh->Vertices[i]);
 						// We have a problem with correct tcoord2 handling here
 						// crash fixed for now by checking the values
-						buffer->Vertices_2TCoords.getLast().TCoords2=(i<mesh->TCoords2.size())?mesh->TCoords2[i]:mesh->Vertices[i].TCoords;
+						vertex.TCoords2=(i<mesh->TCoords2.size())?mesh->TCoords2[i]:mesh->Vertices[i].TCoords;
+						buffer->pushVertex(vertex);
 					}
 					else
 					{
-						verticesLinkIndex[i] = buffer->Vertices_Standard.size();
-						buffer->Vertices_Standard.push_back( mesh->Vertices[i] );
+						verticesLinkIndex[i] = buffer->getVertexCount();
+						buffer->pushVertex( mesh->Vertices[i] );
 					}
 				}
 
@@ -390,19 +397,26 @@ bool CXMeshFileLoader::load(io::IReadFile* file)
 bool CXMeshFileLoader::readFileIntoMemory(io::IReadFile* file)
 {
 	const long size = file->getSize();
-	if (size < 12)
+	if (size < 16)
 	{
 		os::Printer::log("X File is too small.", ELL_WARNING);
 		return false;
 	}
 
-	Buffer = new c8[size];
-
-	//! read all into memory
-	if (file->read(Buffer, size) != static_cast<size_t>(size))
+	// files in memory, like mapped assets, are parsed in place
+	if (file->getType() == io::ERFT_MEMORY_READ_FILE)
+		Buffer = (const c8*)static_cast<io::IMemoryReadFile*>(file)->getBuffer();
+	else
 	{
-		os::Printer::log("Could not read from x file.", ELL_WARNING);
-		return false;
+		Copy = new c8[size];
+
+		//! read all into memory
+		if (file->read(Copy, size) != static_cast<size_t>(size))
+		{
+			os::Printer::log("Could not read from x file.", ELL_WARNING);
+			return false;
+		}
+		Buffer = Copy;
 	}
 
 	Line = 1;
@@ -427,13 +441,24 @@ bool CXMeshFileLoader::readFileIntoMemory(io::IReadFile* file)
 	MinorVersion = core::strtoul10(tmp);
 
 	//! read format
+	bool compressed = false;
 	if (strncmp(&Buffer[8], "txt ", 4) ==0)
 		BinaryFormat = false;
 	else if (strncmp(&Buffer[8], "bin ", 4) ==0)
 		BinaryFormat = true;
+	else if (strncmp(&Buffer[8], "tzip", 4) ==0)
+	{
+		BinaryFormat = false;
+		compressed = true;
+	}
+	else if (strncmp(&Buffer[8], "bzip", 4) ==0)
+	{
+		BinaryFormat = true;
+		compressed = true;
+	}
 	else
 	{
-		os::Printer::log("Only uncompressed x files currently supported.", ELL_WARNING);
+		os::Printer::log("Unknown x file format.", ELL_WARNING);
 		return false;
 	}
 	BinaryNumCount=0;
@@ -449,10 +474,111 @@ bool CXMeshFileLoader::readFileIntoMemory(io::IReadFile* file)
 		return false;
 	}
 
+	if (compressed && !uncompressBuffer())
+	{
+		os::Printer::log("Could not uncompress x file.", ELL_WARNING);
+		return false;
+	}
+
 	P = &Buffer[16];
 
-	readUntilEndOfLine();
+	// the compressed data starts right after the header
+	if (!compressed)
+		readUntilEndOfLine();
+
+	return true;
+}
+
+
+//! replaces Buffer by the uncompressed data of a tzip or bzip file
+/** The header is followed by the size of the uncompressed file including
+the header, and by blocks of up to 32 KB compressed with MSZIP: the
+uncompressed and the compressed size as words, then "CK" and deflate data,
+which uses the block before as dictionary. */
+bool CXMeshFileLoader::uncompressBuffer()
+{
+	const c8* in = Buffer + 16;
+	if (End - in < 4)
+		return false;
+
+	u32 size;
+	memcpy(&size, in, 4);
+#ifdef __BIG_ENDIAN__
+	size = os::Byteswap::byteswap(size);
+#endif
+	in += 4;
+
+	// deflate can't compress more than about 1:1032
+	if (size < 16 || (u64)(size - 16) > (u64)(End - in) * 1032)
+		return false;
+
+	c8* out = new c8[size];
+	memcpy(out, Buffer, 16);
+	u32 outPos = 16;
+
+	z_stream stream;
+	stream.zalloc = Z_NULL;
+	stream.zfree = Z_NULL;
+	stream.opaque = Z_NULL;
+	stream.next_in = Z_NULL;
+	stream.avail_in = 0;
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+	{
+		delete [] out;
+		return false;
+	}
+
+	bool ok = true;
+	while (ok && outPos < size)
+	{
+		if (End - in < 4)
+		{
+			ok = false;
+			break;
+		}
+
+		u16 blockSize, compressedSize;
+		memcpy(&blockSize, in, 2);
+		memcpy(&compressedSize, in + 2, 2);
+#ifdef __BIG_ENDIAN__
+		blockSize = os::Byteswap::byteswap(blockSize);
+		compressedSize = os::Byteswap::byteswap(compressedSize);
+#endif
+		in += 4;
+
+		if (compressedSize < 2 || compressedSize > End - in ||
+			in[0] != 'C' || in[1] != 'K' || blockSize > size - outPos)
+		{
+			ok = false;
+			break;
+		}
+
+		stream.next_in = (Bytef*)(in + 2);
+		stream.avail_in = compressedSize - 2;
+		stream.next_out = (Bytef*)(out + outPos);
+		stream.avail_out = blockSize;
 
+		const int err = inflate(&stream, Z_SYNC_FLUSH);
+		ok = (err == Z_OK || err == Z_STREAM_END) && stream.avail_out == 0 &&
+			inflateReset(&stream) == Z_OK &&
+			inflateSetDictionary(&stream, (const Bytef*)(out + outPos), blockSize) == Z_OK;
+
+		in += compressedSize;
+		outPos += blockSize;
+	}
+
+	inflateEnd(&stream);
+
+	if (!ok)
+	{
+		delete [] out;
+		return false;
+	}
+
+	delete [] Copy;
+	Copy = out;
+	Buffer = Copy;
+	End = Buffer + size;
 	return true;
 }
 
@@ -472,14 +598,14 @@ bool CXMeshFileLoader::parseFile()
 //! Parses the next Data object in the file
 bool CXMeshFileLoader::parseDataObject()
 {
-	core::stringc objectName = getNextToken();
+	SXToken objectName = getNextToken();
 
 	if (objectName.size() == 0)
 		return false;
 
 	// parse specific object
 #ifdef _XREADER_DEBUG
-	os::Printer::log("debug DataObject", objectName.c_str(), ELL_DEBUG);
+	os::Printer::log("debug DataObject", objectName.toString().c_str(), ELL_DEBUG);
 #endif
 
 	if (objectName == "template")
@@ -524,7 +650,7 @@ bool CXMeshFileLoader::parseDataObject()
 		return true;
 	}
 
-	os::Printer::log("Unknown data object in animation of .x file", objectName.c_str(), ELL_WARNING);
+	os::Printer::log("Unknown data object in animation of .x file", objectName.toString().c_str(), ELL_WARNING);
 
 	return parseUnknownDataObject();
 }
@@ -553,7 +679,7 @@ bool CXMeshFileLoader::parseDataObjectTemplate()
 	// read and ignore data members
 	while(true)
 	{
-		core::stringc s = getNextToken();
+		const SXToken s = getNextToken();
 
 		if (s == "}")
 			break;
@@ -627,10 +753,10 @@ bool CXMeshFileLoader::parseDataObjectFrame(CSkinnedMesh::SJoint *Parent)
 
 	while(true)
 	{
-		core::stringc objectName = getNextToken();
+		SXToken objectName = getNextToken();
 
 #ifdef _XREADER_DEBUG
-		os::Printer::log("debug DataObject in frame:", objectName.c_str(), ELL_DEBUG);
+		os::Printer::log("debug DataObject in frame:", objectName.toString().c_str(), ELL_DEBUG);
 #endif
 
 		if (objectName.size() == 0)
@@ -680,7 +806,7 @@ bool CXMeshFileLoader::parseDataObjectFrame(CSkinnedMesh::SJoint *Parent)
 		}
 		else
 		{
-			os::Printer::log("Unknown data object in frame in x file", objectName.c_str(), ELL_WARNING);
+			os::Printer::log("Unknown data object in frame in x file", objectName.toString().c_str(), ELL_WARNING);
 			if (!parseUnknownDataObject())
 				return false;
 		}
@@ -743,11 +869,16 @@ bool CXMeshFileLoader::parseDataObjectMesh(SXMesh &mesh)
 	// read vertex count
 	const u32 nVertices = readInt();
 
-	// read vertices
+	// read vertices, the positions are read as one list
+	core::array<core::vector3df> positions;
+	positions.set_used(nVertices);
+	if (nVertices)
+		readFloats(&positions[0].X, nVertices*3);
+
 	mesh.Vertices.set_used(nVertices);
 	for (u32 n=0; n<nVertices; ++n)
 	{
-		readVector3(mesh.Vertices[n].Pos);
+		mesh.Vertices[n].Pos=positions[n];
 		mesh.Vertices[n].Color=0xFFFFFFFF;
 		mesh.Vertices[n].Normal=core::vector3df(0.0f);
 	}
@@ -817,7 +948,7 @@ bool CXMeshFileLoader::parseDataObjectMesh(SXMesh &mesh)
 
 	while(true)
 	{
-		core::stringc objectName = getNextToken();
+		SXToken objectName = getNextToken();
 
 		if (objectName.size() == 0)
 		{
@@ -832,7 +963,7 @@ bool CXMeshFileLoader::parseDataObjectMesh(SXMesh &mesh)
 		}
 
 #ifdef _XREADER_DEBUG
-		os::Printer::log("debug DataObject in mesh", objectName.c_str(), ELL_DEBUG);
+		os::Printer::log("debug DataObject in mesh", objectName.toString().c_str(), ELL_DEBUG);
 #endif
 
 		if (objectName == "MeshNormals")
@@ -1075,7 +1206,7 @@ bool CXMeshFileLoader::parseDataObjectMesh(SXMesh &mesh)
 		}
 		else
 		{
-			os::Printer::log("Unknown data object in mesh in x file", objectName.c_str(), ELL_WARNING);
+			os::Printer::log("Unknown data object in mesh in x file", objectName.toString().c_str(), ELL_WARNING);
 			if (!parseUnknownDataObject())
 				return false;
 		}
@@ -1143,6 +1274,11 @@ bool CXMeshFileLoader::parseDataObjectSkinWeights(SXMesh &mesh)
 	mesh.WeightJoint.reallocate( mesh.WeightJoint.size() + nWeights );
 	mesh.WeightNum.reallocate( mesh.WeightNum.size() + nWeights );
 
+	core::array<u32> vertexIds;
+	vertexIds.set_used(nWeights);
+	if (nWeights)
+		readInts(vertexIds.pointer(), nWeights);
+
 	for (i=0; i<nWeights; ++i)
 	{
 		mesh.WeightJoint.push_back(n);
@@ -1151,13 +1287,18 @@ bool CXMeshFileLoader::parseDataObjectSkinWeights(SXMesh &mesh)
 		CSkinnedMesh::SWeight *weight=AnimatedMesh->addWeight(joint);
 
 		weight->buffer_id=0;
-		weight->vertex_id=readInt();
+		weight->vertex_id=vertexIds[i];
 	}
 
 	// read vertex weights
 
-	for (i=jointStart; i<jointStart+nWeights; ++i)
-		joint->Weights[i].strength = readFloat();
+	core::array<f32> strengths;
+	strengths.set_used(nWeights);
+	if (nWeights)
+		readFloats(strengths.pointer(), nWeights);
+
+	for (i=0; i<nWeights; ++i)
+		joint->Weights[jointStart+i].strength = strengths[i];
 
 	// read matrix offset
 
@@ -1235,8 +1376,8 @@ bool CXMeshFileLoader::parseDataObjectMeshNormals(SXMesh &mesh)
 	normals.set_used(nNormals);
 
 	// read normals
-	for (u32 i=0; i<nNormals; ++i)
-		readVector3(normals[i]);
+	if (nNormals)
+		readFloats(&normals[0].X, nNormals*3);
 
 	if (!checkForTwoFollowingSemicolons())
 	{
@@ -1436,7 +1577,7 @@ bool CXMeshFileLoader::parseDataObjectMeshMaterialList(SXMesh &mesh)
 
 	while(true)
 	{
-		core::stringc objectName = getNextToken();
+		SXToken objectName = getNextToken();
 
 		if (objectName.size() == 0)
 		{
@@ -1461,7 +1602,12 @@ bool CXMeshFileLoader::parseDataObjectMeshMaterialList(SXMesh &mesh)
 		if (objectName == "Material")
 		{
 			mesh.Materials.push_back(video::SMaterial());
-			if (!parseUnknownDataObject())
+			if (LoadTextures)
+			{
+				if (!parseDataObjectMaterial(mesh.Materials.getLast()))
+					return false;
+			}
+			else if (!parseUnknownDataObject())
 				return false;
 		}
 		else
@@ -1471,7 +1617,66 @@ bool CXMeshFileLoader::parseDataObjectMeshMaterialList(SXMesh &mesh)
 		}
 		else
 		{
-			os::Printer::log("Unknown data object in material list in x file", objectName.c_str(), ELL_WARNING);
+			os::Printer::log("Unknown data object in material list in x file", objectName.toString().c_str(), ELL_WARNING);
+			if (!parseUnknownDataObject())
+				return false;
+		}
+	}
+	return true;
+}
+
+
+bool CXMeshFileLoader::parseDataObjectMaterial(video::SMaterial& material)
+{
+#ifdef _XREADER_DEBUG
+	os::Printer::log("CXFileReader: Reading mesh material", ELL_DEBUG);
+#endif
+
+	if (!readHeadOfDataObject())
+	{
+		os::Printer::log("No opening brace in Mesh Material found in x file", ELL_WARNING);
+		os::Printer::log("Line", core::stringc(Line).c_str(), ELL_WARNING);
+		return false;
+	}
+
+	// the colors are skipped, the materials keep their defaults as without textures
+	video::SColor color;
+	readRGBA(color); checkForOneFollowingSemicolons(); // diffuse
+	readFloat(); // power
+	readRGB(color); checkForOneFollowingSemicolons(); // specular
+	readRGB(color); checkForOneFollowingSemicolons(); // emissive
+
+	// read texture filenames, one for each texture layer
+	u32 textureLayer = 0;
+	while(true)
+	{
+		SXToken objectName = getNextToken();
+
+		if (objectName.size() == 0)
+		{
+			os::Printer::log("Unexpected ending found in Mesh Material in .x file.", ELL_WARNING);
+			os::Printer::log("Line", core::stringc(Line).c_str(), ELL_WARNING);
+			return false;
+		}
+		else
+		if (objectName == "}")
+		{
+			break; // material finished
+		}
+		else
+		if (objectName == "TextureFilename" || objectName == "TextureFileName")
+		{
+			core::stringc textureName;
+			if (!parseDataObjectTextureFilename(textureName))
+				return false;
+
+			// the file is loaded by the scene manager after parsing
+			if (textureName.size() && textureLayer < video::MATERIAL_MAX_TEXTURES)
+				material.setTexture(textureLayer++, SceneManager->addMeshTextureReference(textureName));
+		}
+		else
+		{
+			os::Printer::log("Unknown data object in material in x file", objectName.toString().c_str(), ELL_WARNING);
 			if (!parseUnknownDataObject())
 				return false;
 		}
@@ -1498,7 +1703,7 @@ bool CXMeshFileLoader::parseDataObjectAnimationSet()
 
 	while(true)
 	{
-		core::stringc objectName = getNextToken();
+		SXToken objectName = getNextToken();
 
 		if (objectName.size() == 0)
 		{
@@ -1519,7 +1724,7 @@ bool CXMeshFileLoader::parseDataObjectAnimationSet()
 		}
 		else
 		{
-			os::Printer::log("Unknown data object in animation set in x file", objectName.c_str(), ELL_WARNING);
+			os::Printer::log("Unknown data object in animation set in x file", objectName.toString().c_str(), ELL_WARNING);
 			if (!parseUnknownDataObject())
 				return false;
 		}
@@ -1582,7 +1787,7 @@ bool CXMeshFileLoader::parseDataObjectAnimation()
 
 	while(true)
 	{
-		core::stringc objectName = getNextToken();
+		SXToken objectName = getNextToken();
 
 		if (objectName.size() == 0)
 		{
@@ -1612,7 +1817,7 @@ bool CXMeshFileLoader::parseDataObjectAnimation()
 		if (objectName == "{")
 		{
 			// read frame name
-			FrameName = getNextToken();
+			FrameName = getNextToken().toString();
 
 			if (!checkForClosingBrace())
 			{
@@ -1623,7 +1828,7 @@ bool CXMeshFileLoader::parseDataObjectAnimation()
 		}
 		else
 		{
-			os::Printer::log("Unknown data object in animation in x file", objectName.c_str(), ELL_WARNING);
+			os::Printer::log("Unknown data object in animation in x file", objectName.toString().c_str(), ELL_WARNING);
 			if (!parseUnknownDataObject())
 				return false;
 		}
@@ -1732,10 +1937,12 @@ bool CXMeshFileLoader::parseDataObjectAnimationKey(ISkinnedMesh::SJoint *joint)
 					return false;
 				}
 
-				f32 W = -readFloat();
-				f32 X = -readFloat();
-				f32 Y = -readFloat();
-				f32 Z = -readFloat();
+				f32 wxyz[4];
+				readFloats(wxyz, 4);
+				const f32 W = -wxyz[0];
+				const f32 X = -wxyz[1];
+				const f32 Y = -wxyz[2];
+				const f32 Z = -wxyz[3];
 
 				if (!checkForTwoFollowingSemicolons())
 				{
@@ -1891,7 +2098,7 @@ bool CXMeshFileLoader::parseUnknownDataObject()
 	// find opening delimiter
 	while(true)
 	{
-		core::stringc t = getNextToken();
+		const SXToken t = getNextToken();
 
 		if (t.size() == 0)
 			return false;
@@ -1906,7 +2113,7 @@ bool CXMeshFileLoader::parseUnknownDataObject()
 
 	while(counter)
 	{
-		core::stringc t = getNextToken();
+		const SXToken t = getNextToken();
 
 		if (t.size() == 0)
 			return false;
@@ -1969,11 +2176,11 @@ bool CXMeshFileLoader::checkForTwoFollowingSemicolons()
 //! if there is one
 bool CXMeshFileLoader::readHeadOfDataObject(core::stringc* outname)
 {
-	core::stringc nameOrBrace = getNextToken();
+	const SXToken nameOrBrace = getNextToken();
 	if (nameOrBrace != "{")
 	{
 		if (outname)
-			(*outname) = nameOrBrace;
+			(*outname) = nameOrBrace.toString();
 
 		if (getNextToken() != "{")
 			return false;
@@ -1983,11 +2190,9 @@ bool CXMeshFileLoader::readHeadOfDataObject(core::stringc* outname)
 }
 
 
-//! returns next parseable token. Returns empty string if no token there
-core::stringc CXMeshFileLoader::getNextToken()
+//! returns next parseable token. Returns empty token if no token there
+CXMeshFileLoader::SXToken CXMeshFileLoader::getNextToken()
 {
-	core::stringc s;
-
 	// process binary-formatted file
 	if (BinaryFormat)
 	{
@@ -2000,17 +2205,19 @@ core::stringc CXMeshFileLoader::getNextToken()
 		// standalone tokens
 		switch (tok) {
 			case 1:
-				// name token
-				len = readBinDWord();
-				s = core::stringc(P, len);
-				P += len;
-				return s;
 			case 2:
-				// string token
-				len = readBinDWord();
-				s = core::stringc(P, len);
-				P += (len + 2);
-				return s;
+				{
+					// name token, or string token which is followed by its terminator
+					len = readBinDWord();
+					if (P > End || len > (u32)(End - P))
+					{
+						P = End;
+						return SXToken();
+					}
+					const SXToken token(P, len);
+					P += (tok == 2) ? len + 2 : len;
+					return token;
+				}
 			case 3:
 				// integer token
 				P += 4;
@@ -2085,25 +2292,21 @@ core::stringc CXMeshFileLoader::getNextToken()
 		findNextNoneWhiteSpace();
 
 		if (P >= End)
-			return s;
+			return SXToken();
 
-		while((P < End) && !core::isspace(P[0]))
-		{
-			// either keep token delimiters when already holding a token, or return if first valid char
-			if (P[0]==';' || P[0]=='}' || P[0]=='{' || P[0]==',')
-			{
-				if (!s.size())
-				{
-					s.append(P[0]);
-					++P;
-				}
-				break; // stop for delimiter
-			}
-			s.append(P[0]);
+		const c8* start = P;
+		// delimiters are tokens of their own, and end other tokens
+		if (P[0]==';' || P[0]=='}' || P[0]=='{' || P[0]==',')
 			++P;
+		else
+		{
+			while((P < End) && !core::isspace(P[0]) &&
+				P[0]!=';' && P[0]!='}' && P[0]!='{' && P[0]!=',')
+				++P;
 		}
+		return SXToken(start, (u32)(P - start));
 	}
-	return s;
+	return SXToken();
 }
 
 
@@ -2159,7 +2362,7 @@ bool CXMeshFileLoader::getNextTokenAsString(core::stringc& out)
 {
 	if (BinaryFormat)
 	{
-		out=getNextToken();
+		out=getNextToken().toString();
 		return true;
 	}
 	findNextNoneWhiteSpace();
@@ -2234,7 +2437,34 @@ u32 CXMeshFileLoader::readBinDWord()
 
 u32 CXMeshFileLoader::readInt()
 {
-	if (BinaryFormat)
+	u32 value;
+	readInts(&value, 1);
+	return value;
+}
+
+
+f32 CXMeshFileLoader::readFloat()
+{
+	f32 value;
+	readFloats(&value, 1);
+	return value;
+}
+
+
+//! reads count numbers at once, a whole list in binary files
+void CXMeshFileLoader::readInts(u32* out, u32 count)
+{
+	if (!BinaryFormat)
+	{
+		for (u32 i=0; i<count; ++i)
+		{
+			findNextNoneWhiteSpaceNumber();
+			out[i] = core::strtoul10(P, &P);
+		}
+		return;
+	}
+
+	while (count)
 	{
 		if (!BinaryNumCount)
 		{
@@ -2243,21 +2473,52 @@ u32 CXMeshFileLoader::readInt()
 				BinaryNumCount = readBinDWord();
 			else
 				BinaryNumCount = 1; // single int
+			continue;
 		}
-		--BinaryNumCount;
-		return readBinDWord();
-	}
-	else
-	{
-		findNextNoneWhiteSpaceNumber();
-		return core::strtoul10(P, &P);
+
+		// as much of the list as needed, but not beyond the end of the file
+		const u32 n = core::min_(count, BinaryNumCount);
+		if (P >= End || n > (u32)(End - P) / 4)
+		{
+			memset(out, 0, count * sizeof(u32));
+			P = End;
+			BinaryNumCount = 0;
+			return;
+		}
+
+#ifdef __BIG_ENDIAN__
+		for (u32 i=0; i<n; ++i)
+		{
+			u32 tmp;
+			memcpy(&tmp, P + i*4, 4);
+			out[i] = os::Byteswap::byteswap(tmp);
+		}
+#else
+		memcpy(out, P, n*4);
+#endif
+		P += n*4;
+		BinaryNumCount -= n;
+		out += n;
+		count -= n;
 	}
 }
 
 
-f32 CXMeshFileLoader::readFloat()
+void CXMeshFileLoader::readFloats(f32* out, u32 count)
 {
-	if (BinaryFormat)
+	if (!BinaryFormat)
+	{
+		// lists are mostly numbers and separators, comments end the bulk parsing
+		u32 i = core::fast_atof_array(P, End, out, count, &P);
+		for (; i<count; ++i)
+		{
+			findNextNoneWhiteSpaceNumber();
+			P = core::fast_atof_fixed_move(P, out[i], End);
+		}
+		return;
+	}
+
+	while (count)
 	{
 		if (!BinaryNumCount)
 		{
@@ -2265,46 +2526,59 @@ f32 CXMeshFileLoader::readFloat()
 			if (tmp == 0x07)
 				BinaryNumCount = readBinDWord();
 			else
-				BinaryNumCount = 1; // single int
+				BinaryNumCount = 1; // single float
+			continue;
 		}
-		--BinaryNumCount;
+
+		// as much of the list as needed, but not beyond the end of the file
+		const u32 n = core::min_(count, BinaryNumCount);
+		if (P >= End || n > (u32)(End - P) / FloatSize)
+		{
+			memset(out, 0, count * sizeof(f32));
+			P = End;
+			BinaryNumCount = 0;
+			return;
+		}
+
 		if (FloatSize == 8)
 		{
+			for (u32 i=0; i<n; ++i)
+			{
+				u64 tmp;
+				memcpy(&tmp, P + i*8, 8);
 #ifdef __BIG_ENDIAN__
-			//TODO: Check if data is properly converted here
-			f32 ctmp[2];
-			ctmp[1] = os::Byteswap::byteswap(*(f32*)P);
-			ctmp[0] = os::Byteswap::byteswap(*(f32*)P+4);
-			const f32 tmp = (f32)(*(f64*)(void*)ctmp);
-#else
-			const f32 tmp = (f32)(*(f64 *)P);
+				tmp = os::Byteswap::byteswap(tmp);
 #endif
-			P += 8;
-			return tmp;
+				f64 value;
+				memcpy(&value, &tmp, 8);
+				out[i] = (f32)value;
+			}
 		}
 		else
 		{
 #ifdef __BIG_ENDIAN__
-			const f32 tmp = os::Byteswap::byteswap(*(f32 *)P);
+			for (u32 i=0; i<n; ++i)
+			{
+				f32 tmp;
+				memcpy(&tmp, P + i*4, 4);
+				out[i] = os::Byteswap::byteswap(tmp);
+			}
 #else
-			const f32 tmp = *(f32 *)P;
+			memcpy(out, P, n*4);
 #endif
-			P += 4;
-			return tmp;
 		}
+		P += n*FloatSize;
+		BinaryNumCount -= n;
+		out += n;
+		count -= n;
 	}
-	findNextNoneWhiteSpaceNumber();
-	f32 ftmp;
-	P = core::fast_atof_move(P, ftmp);
-	return ftmp;
 }
 
 
 // read 2-dimensional vector. Stops at semicolon after second value for text file format
 bool CXMeshFileLoader::readVector2(core::vector2df& vec)
 {
-	vec.X = readFloat();
-	vec.Y = readFloat();
+	readFloats(&vec.X, 2);
 	return true;
 }
 
@@ -2312,9 +2586,7 @@ bool CXMeshFileLoader::readVector2(core::vector2df& vec)
 // read 3-dimensional vector. Stops at semicolon after third value for text file format
 bool CXMeshFileLoader::readVector3(core::vector3df& vec)
 {
-	vec.X = readFloat();
-	vec.Y = readFloat();
-	vec.Z = readFloat();
+	readFloats(&vec.X, 3);
 	return true;
 }
 
@@ -2347,8 +2619,7 @@ bool CXMeshFileLoader::readRGBA(video::SColor& color)
 // read matrix from list of floats
 bool CXMeshFileLoader::readMatrix(core::matrix4& mat)
 {
-	for (u32 i=0; i<16; ++i)
-		mat[i] = readFloat();
+	readFloats(mat.pointer(), 16);
 	return checkForOneFollowingSemicolons();
 }
 
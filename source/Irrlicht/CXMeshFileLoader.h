@@ -79,10 +79,46 @@ public:
 
 private:
 
+	//! A token of the file, the text is in Buffer or a static string
+	/** Tokens are compared without copying them, names which are kept are
+	copied with toString(). */
+	struct SXToken
+	{
+		SXToken() : Text(""), Length(0) {}
+		SXToken(const c8* text) : Text(text), Length((u32)strlen(text)) {}
+		SXToken(const c8* text, u32 length) : Text(text), Length(length) {}
+
+		bool operator==(const c8* other) const
+		{
+			return strncmp(Text, other, Length) == 0 && other[Length] == 0;
+		}
+
+		bool operator!=(const c8* other) const
+		{
+			return !(*this == other);
+		}
+
+		u32 size() const
+		{
+			return Length;
+		}
+
+		core::stringc toString() const
+		{
+			return core::stringc(Text, Length);
+		}
+
+		const c8* Text;
+		u32 Length;
+	};
+
 	bool load(io::IReadFile* file);
 
 	bool readFileIntoMemory(io::IReadFile* file);
 
+	//! replaces Buffer by the uncompressed data of a tzip or bzip file
+	bool uncompressBuffer();
+
 	bool parseFile();
 
 	bool parseDataObject();
@@ -107,6 +143,9 @@ private:
 
 	bool parseDataObjectMeshMaterialList(SXMesh &mesh);
 
+	//! reads the texture files of a material, see MESH_LOADER_TEXTURES
+	bool parseDataObjectMaterial(video::SMaterial& material);
+
 	bool parseDataObjectAnimationSet();
 
 	bool parseDataObjectAnimationTicksPerSecond();
@@ -126,8 +165,8 @@ private:
 	// and ignores comments
 	void findNextNoneWhiteSpaceNumber();
 
-	//! returns next parseable token. Returns empty string if no token there
-	core::stringc getNextToken();
+	//! returns next parseable token. Returns empty token if no token there
+	SXToken getNextToken();
 
 	//! reads header of dataobject including the opening brace.
 	//! returns false if error happened, and writes name of object
@@ -152,6 +191,9 @@ private:
 	u32 readBinDWord();
 	u32 readInt();
 	f32 readFloat();
+	//! reads count numbers at once, a whole list in binary files
+	void readInts(u32* out, u32 count);
+	void readFloats(f32* out, u32 count);
 	bool readVector2(core::vector2df& vec);
 	bool readVector3(core::vector3df& vec);
 	bool readMatrix(core::matrix4& mat);
@@ -160,9 +202,12 @@ private:
 
 	CSkinnedMesh* AnimatedMesh;
 
-	c8* Buffer;
+	//! Contents of the file, in Copy unless the file was read from memory
+	const c8* Buffer;
+	//! Copy of the file, or the uncompressed file
+	c8* Copy;
 	const c8* P;
-	c8* End;
+	const c8* End;
 	// counter for number arrays in binary format
 	u32 BinaryNumCount;
 	u32 Line;
@@ -176,6 +221,11 @@ private:
 	u32 MinorVersion;
 	bool BinaryFormat;
 	c8 FloatSize;
+
+	//! Records the textures of the materials, see MESH_LOADER_TEXTURES
+	bool LoadTextures;
+
+	scene::ISceneManager* SceneManager;
 };
 
 } // end namespace scene
@@ -5,13 +5,19 @@
 #include "CZipReader.h"
 
 #include "os.h"
+#include "CProfiler.h"
 
 
 #include "CFileList.h"
 #include "CReadFile.h"
+#include "CInflateReadFile.h"
+#include "CMemoryFile.h"
 #include "coreutil.h"
 
 #include <zlib.h> // use system lib
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+#include <zstd.h>
+#endif
 
 namespace irr
 {
@@ -19,13 +25,103 @@ namespace io
 {
 
 
+// -----------------------------------------------------------------------------
+// cache of decompressed files
+// -----------------------------------------------------------------------------
+
+//! Constructor
+CZipEntryCache::CZipEntryCache(u32 budget)
+: Budget(budget), Used(0)
+{
+}
+
+
+//! Sets the budget in bytes, removes files until it is met
+void CZipEntryCache::setBudget(u32 budget)
+{
+	Budget = budget;
+	shrink(Budget);
+}
+
+
+//! Opens a cached file, returns 0 if it isn't in the cache
+IReadFile* CZipEntryCache::createAndOpenFile(const IFileArchive* archive, u32 index, const io::path& name)
+{
+	const SKey key = {archive, index};
+	auto it = Lookup.find(key);
+	if (it == Lookup.end())
+		return 0;
+
+	// the file becomes the most recently opened
+	Entries.splice(Entries.begin(), Entries, it->second);
+	return new CMemoryReadFile(it->second->Data, it->second->Size, name);
+}
+
+
+//! Adds a decompressed file to the cache and opens it
+IReadFile* CZipEntryCache::addFile(const IFileArchive* archive, u32 index, c8* data, u32 size, const io::path& name)
+{
+	SEntry entry;
+	entry.Archive = archive;
+	entry.Index = index;
+	entry.Data = std::shared_ptr<const c8>(data, std::default_delete<c8[]>());
+	entry.Size = size;
+
+	IReadFile* file = new CMemoryReadFile(entry.Data, size, name);
+	if (!isCacheable(size))
+		return file;
+
+	const SKey key = {archive, index};
+	if (Lookup.find(key) != Lookup.end())
+		return file;
+
+	shrink(Budget - size);
+	Entries.push_front(entry);
+	Lookup[key] = Entries.begin();
+	Used += size;
+	return file;
+}
+
+
+//! Removes all files of an archive
+void CZipEntryCache::removeArchive(const IFileArchive* archive)
+{
+	for (auto it = Entries.begin(); it != Entries.end();)
+	{
+		if (it->Archive == archive)
+		{
+			const SKey key = {it->Archive, it->Index};
+			Lookup.erase(key);
+			Used -= it->Size;
+			it = Entries.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+
+//! removes the least recently opened files until at most budget bytes are used
+void CZipEntryCache::shrink(u32 budget)
+{
+	while (Used > budget && !Entries.empty())
+	{
+		const SEntry& entry = Entries.back();
+		const SKey key = {entry.Archive, entry.Index};
+		Lookup.erase(key);
+		Used -= entry.Size;
+		Entries.pop_back();
+	}
+}
+
+
 // -----------------------------------------------------------------------------
 // zip loader
 // -----------------------------------------------------------------------------
 
 //! Constructor
-CArchiveLoaderZIP::CArchiveLoaderZIP(io::IFileSystem* fs)
-: FileSystem(fs)
+CArchiveLoaderZIP::CArchiveLoaderZIP(io::IFileSystem* fs, std::shared_ptr<CZipEntryCache> cache)
+: FileSystem(fs), Cache(cache)
 {
 	#ifdef _DEBUG
 	setDebugName("CArchiveLoaderZIP");
@@ -83,7 +179,7 @@ IFileArchive* CArchiveLoaderZIP::createArchive(io::IReadFile* file, bool ignoreC
 
 		bool isGZip = (sig == 0x8b1f);
 
-		archive = new CZipReader(FileSystem, file, ignoreCase, ignorePaths, isGZip);
+		archive = new CZipReader(FileSystem, file, ignoreCase, ignorePaths, isGZip, Cache);
 	}
 	return archive;
 }
@@ -109,8 +205,10 @@ bool CArchiveLoaderZIP::isALoadableFileFormat(io::IReadFile* file) const
 // zip archive
 // -----------------------------------------------------------------------------
 
-CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip)
- : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), FileSystem(fs), File(file), IsGZip(isGZip)
+CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip,
+		std::shared_ptr<CZipEntryCache> cache)
+ : CFileList((file ? file->getFileName() : io::path("")), ignoreCase, ignorePaths), FileSystem(fs), File(file),
+	Cache(cache), IsGZip(isGZip)
 {
 	#ifdef _DEBUG
 	setDebugName("CZipReader");
@@ -123,8 +221,14 @@ CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool i
 		// load file entries
 		if (IsGZip)
 			while (scanGZipHeader()) { }
-		else
+		else if (!scanCentralDirectory())
+		{
+			// walk the local headers of damaged archives
+			FileInfo.clear();
+			Files.clear();
+			File->seek(0);
 			while (scanZipHeader()) { }
+		}
 
 		sort();
 	}
@@ -132,6 +236,9 @@ CZipReader::CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool i
 
 CZipReader::~CZipReader()
 {
+	if (Cache)
+		Cache->removeArchive(this);
+
 	if (File)
 		File->drop();
 }
@@ -156,6 +263,7 @@ bool CZipReader::scanGZipHeader()
 {
 	SZipFileEntry entry;
 	entry.Offset = 0;
+	entry.LocalHeaderOffset = -1;
 	memset(&entry.header, 0, sizeof(SZIPFileHeader));
 
 	// read header
@@ -265,6 +373,7 @@ bool CZipReader::scanZipHeader(bool ignoreGPBits)
 	io::path ZipFileName = "";
 	SZipFileEntry entry;
 	entry.Offset = 0;
+	entry.LocalHeaderOffset = -1;
 	memset(&entry.header, 0, sizeof(SZIPFileHeader));
 
 	File->read(&entry.header, sizeof(SZIPFileHeader));
@@ -367,6 +476,166 @@ bool CZipReader::scanZipHeader(bool ignoreGPBits)
 }
 
 
+//! reads the file list from the central directory at the end of the archive
+bool CZipReader::scanCentralDirectory()
+{
+	// the end record is followed by a comment of up to 0xffff bytes
+	const long size = File->getSize();
+	const long tailSize = core::min_(size, (long)(sizeof(SZIPFileCentralDirEnd) + 0xffff));
+	if (tailSize < (long)sizeof(SZIPFileCentralDirEnd))
+		return false;
+
+	core::array<u8> tail;
+	tail.set_used((u32)tailSize);
+	if (!File->seek(size - tailSize) || File->read(tail.pointer(), tailSize) != (size_t)tailSize)
+		return false;
+
+	s32 end = tailSize - (s32)sizeof(SZIPFileCentralDirEnd);
+	while (end >= 0 && !(tail[end] == 0x50 && tail[end+1] == 0x4b && tail[end+2] == 0x05 && tail[end+3] == 0x06))
+		--end;
+	if (end < 0)
+		return false;
+
+	SZIPFileCentralDirEnd dirEnd;
+	memcpy(&dirEnd, &tail[end], sizeof(dirEnd));
+#ifdef __BIG_ENDIAN__
+	dirEnd.NumberDisk = os::Byteswap::byteswap(dirEnd.NumberDisk);
+	dirEnd.TotalEntries = os::Byteswap::byteswap(dirEnd.TotalEntries);
+	dirEnd.Size = os::Byteswap::byteswap(dirEnd.Size);
+	dirEnd.Offset = os::Byteswap::byteswap(dirEnd.Offset);
+#endif
+
+	// archives split over several disks aren't supported
+	if (dirEnd.NumberDisk != 0 || (u64)dirEnd.Offset + dirEnd.Size > (u64)size)
+		return false;
+
+	core::array<u8> dir;
+	dir.set_used(dirEnd.Size);
+	if (dirEnd.Size && (!File->seek(dirEnd.Offset) || File->read(dir.pointer(), dirEnd.Size) != dirEnd.Size))
+		return false;
+
+	FileInfo.reallocate(dirEnd.TotalEntries);
+	u32 pos = 0;
+	for (u32 i=0; i<dirEnd.TotalEntries; ++i)
+	{
+		if (pos + sizeof(SZIPFileCentralDirFileHeader) > dir.size())
+			return false;
+
+		SZIPFileCentralDirFileHeader header;
+		memcpy(&header, &dir[pos], sizeof(header));
+#ifdef __BIG_ENDIAN__
+		header.Sig = os::Byteswap::byteswap(header.Sig);
+		header.VersionToExtract = os::Byteswap::byteswap(header.VersionToExtract);
+		header.GeneralBitFlag = os::Byteswap::byteswap(header.GeneralBitFlag);
+		header.CompressionMethod = os::Byteswap::byteswap(header.CompressionMethod);
+		header.LastModFileTime = os::Byteswap::byteswap(header.LastModFileTime);
+		header.LastModFileDate = os::Byteswap::byteswap(header.LastModFileDate);
+		header.CRC32 = os::Byteswap::byteswap(header.CRC32);
+		header.CompressedSize = os::Byteswap::byteswap(header.CompressedSize);
+		header.UncompressedSize = os::Byteswap::byteswap(header.UncompressedSize);
+		header.FilenameLength = os::Byteswap::byteswap(header.FilenameLength);
+		header.ExtraFieldLength = os::Byteswap::byteswap(header.ExtraFieldLength);
+		header.FileCommentLength = os::Byteswap::byteswap(header.FileCommentLength);
+		header.RelativeOffsetOfLocalHeader = os::Byteswap::byteswap(header.RelativeOffsetOfLocalHeader);
+#endif
+
+		if (header.Sig != 0x02014b50)
+			return false;
+
+		pos += sizeof(header);
+		if (pos + header.FilenameLength > dir.size())
+			return false;
+
+		const io::path ZipFileName((const c8*)&dir[pos], header.FilenameLength);
+		pos += header.FilenameLength + header.ExtraFieldLength + header.FileCommentLength;
+
+		// the central directory has the sizes even if the local header doesn't
+		SZipFileEntry entry;
+		memset(&entry.header, 0, sizeof(SZIPFileHeader));
+		entry.Offset = 0;
+		entry.LocalHeaderOffset = (s32)header.RelativeOffsetOfLocalHeader;
+		entry.header.Sig = 0x04034b50;
+		entry.header.VersionToExtract = header.VersionToExtract;
+		entry.header.GeneralBitFlag = header.GeneralBitFlag;
+		entry.header.CompressionMethod = header.CompressionMethod;
+		entry.header.LastModFileTime = header.LastModFileTime;
+		entry.header.LastModFileDate = header.LastModFileDate;
+		entry.header.DataDescriptor.CRC32 = header.CRC32;
+		entry.header.DataDescriptor.CompressedSize = header.CompressedSize;
+		entry.header.DataDescriptor.UncompressedSize = header.UncompressedSize;
+		entry.header.FilenameLength = header.FilenameLength;
+
+		addItem(ZipFileName, entry.LocalHeaderOffset, header.UncompressedSize, ZipFileName.lastChar()=='/', FileInfo.size());
+		FileInfo.push_back(entry);
+	}
+
+	return true;
+}
+
+
+//! reads the local file header of a file, to find the start of its data
+bool CZipReader::readLocalHeader(SZipFileEntry& entry)
+{
+	SZIPFileHeader header;
+	if (File->readAt(entry.LocalHeaderOffset, &header, sizeof(header)) != sizeof(header))
+		return false;
+
+#ifdef __BIG_ENDIAN__
+	header.Sig = os::Byteswap::byteswap(header.Sig);
+	header.FilenameLength = os::Byteswap::byteswap(header.FilenameLength);
+	header.ExtraFieldLength = os::Byteswap::byteswap(header.ExtraFieldLength);
+#endif
+
+	if (header.Sig != 0x04034b50)
+		return false;
+
+	// the extra field of the local header may differ from the central one
+	entry.Offset = entry.LocalHeaderOffset + (s32)sizeof(SZIPFileHeader) +
+		(u16)header.FilenameLength + (u16)header.ExtraFieldLength;
+	entry.header.ExtraFieldLength = header.ExtraFieldLength;
+	entry.LocalHeaderOffset = -1;
+	return true;
+}
+
+
+//! reads the deflated data of a file, to decompress it with inflateData()
+bool CZipReader::readDeflatedData(u32 index, core::array<u8>& data, u32& size)
+{
+	if (index >= Files.size())
+		return false;
+
+	SZipFileEntry& e = FileInfo[Files[index].ID];
+	if (e.header.CompressionMethod != 8 || (e.LocalHeaderOffset >= 0 && !readLocalHeader(e)))
+		return false;
+
+	const u32 compressedSize = e.header.DataDescriptor.CompressedSize;
+	data.set_used(compressedSize);
+	size = e.header.DataDescriptor.UncompressedSize;
+	return File->readAt(e.Offset, data.pointer(), compressedSize) == compressedSize;
+}
+
+
+//! decompresses deflated data without zlib header
+bool CZipReader::inflateData(const u8* in, u32 inSize, c8* out, u32 outSize)
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	stream.next_in = (Bytef*)in;
+	stream.avail_in = (uInt)inSize;
+	stream.next_out = (Bytef*)out;
+	stream.avail_out = (uInt)outSize;
+
+	// wbits < 0 indicates no zlib header inside the data.
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+		return false;
+
+	IRR_PROFILE_SCOPE("CZipReader inflate");
+	const s32 err = inflate(&stream, Z_FINISH);
+	inflateEnd(&stream);
+	return err == Z_STREAM_END;
+}
+
+
 //! scans for a local header, returns false if there is no more local file header.
 bool CZipReader::scanCentralDirectoryHeader()
 {
@@ -423,7 +692,7 @@ IReadFile* CZipReader::createAndOpenFile(const io::path& filename)
 //! opens a file by index
 IReadFile* CZipReader::createAndOpenFile(u32 index)
 {
-	// Irrlicht supports 0, 8, 12, 14, 99
+	// Irrlicht supports 0, 8, 12, 14, 93, 99
 	//0 - The file is stored (no compression)
 	//1 - The file is Shrunk
 	//2 - The file is Reduced with compression factor 1
@@ -437,13 +706,20 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 	//10 - PKWARE Date Compression Library Imploding
 	//12 - bzip2 - Compression Method from libbz2, WinZip 10
 	//14 - LZMA - Compression Method, WinZip 12
+	//93 - Zstandard, if compiled with _IRR_COMPILE_WITH_ZSTD_
 	//96 - Jpeg compression - Compression Method, WinZip 12
 	//97 - WavPack - Compression Method, WinZip 11
 	//98 - PPMd - Compression Method, WinZip 10
 	//99 - AES encryption, WinZip 9
 
-	const SZipFileEntry &e = FileInfo[Files[index].ID];
+	SZipFileEntry &e = FileInfo[Files[index].ID];
 	char buf[64];
+	if (e.LocalHeaderOffset >= 0 && !readLocalHeader(e))
+	{
+		os::Printer::log("Could not read zip file header of", Files[index].FullName, ELL_ERROR);
+		return 0;
+	}
+
 	s16 actualCompressionMethod=e.header.CompressionMethod;
 	IReadFile* decrypted=0;
 	u8* decryptedBuf=0;
@@ -460,6 +736,13 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 	case 8:
 		{
 			const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
+			if (!Cache || !Cache->isCacheable(uncompressedSize))
+				return new CInflateReadFile(File, e.Offset, decryptedSize, uncompressedSize, Files[index].FullName);
+
+			IReadFile* cached = Cache->createAndOpenFile(this, index, Files[index].FullName);
+			if (cached)
+				return cached;
+
 			c8* pBuf = new c8[ uncompressedSize ];
 			if (!pBuf)
 			{
@@ -483,8 +766,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				}
 
 				//memset(pcData, 0, decryptedSize);
-				File->seek(e.Offset);
-				File->read(pcData, decryptedSize);
+				File->readAt(e.Offset, pcData, decryptedSize);
 			}
 
 			// Setup the inflate stream.
@@ -502,6 +784,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 			err = inflateInit2(&stream, -MAX_WBITS);
 			if (err == Z_OK)
 			{
+				IRR_PROFILE_SCOPE("CZipReader inflate");
 				err = inflate(&stream, Z_FINISH);
 				inflateEnd(&stream);
 				if (err == Z_STREAM_END)
@@ -523,7 +806,7 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 				return 0;
 			}
 			else
-				return FileSystem->createMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
+				return Cache->addFile(this, index, pBuf, uncompressedSize, Files[index].FullName);
 		}
 	case 12:
 		{
@@ -535,6 +818,43 @@ IReadFile* CZipReader::createAndOpenFile(u32 index)
 			os::Printer::log("lzma decompression not supported. File cannot be read.", ELL_ERROR);
 			return 0;
 		}
+	case 93:
+		{
+#ifdef _IRR_COMPILE_WITH_ZSTD_
+			const u32 uncompressedSize = e.header.DataDescriptor.UncompressedSize;
+			if (Cache)
+			{
+				IReadFile* cached = Cache->createAndOpenFile(this, index, Files[index].FullName);
+				if (cached)
+					return cached;
+			}
+
+			core::array<u8> compressed;
+			compressed.set_used(decryptedSize);
+			if (File->readAt(e.Offset, compressed.pointer(), decryptedSize) != decryptedSize)
+			{
+				os::Printer::log("Could not read zstd compressed file", Files[index].FullName, ELL_ERROR);
+				return 0;
+			}
+
+			c8* pBuf = new c8[uncompressedSize > 0 ? uncompressedSize : 1];
+			const size_t r = ZSTD_decompress(pBuf, uncompressedSize, compressed.const_pointer(), decryptedSize);
+			if (ZSTD_isError(r) || r != uncompressedSize)
+			{
+				snprintf_irr ( buf, 64, "Error decompressing %s", Files[index].FullName.c_str() );
+				os::Printer::log( buf, ZSTD_isError(r) ? ZSTD_getErrorName(r) : "", ELL_ERROR);
+				delete [] pBuf;
+				return 0;
+			}
+
+			if (Cache)
+				return Cache->addFile(this, index, pBuf, uncompressedSize, Files[index].FullName);
+			return new CMemoryReadFile(pBuf, uncompressedSize, Files[index].FullName, true);
+#else
+			os::Printer::log("zstd decompression not supported. File cannot be read.", ELL_ERROR);
+			return 0;
+#endif
+		}
 	case 99:
 		// If we come here with an encrypted file, decryption support is missing
 		os::Printer::log("Decryption support not enabled. File cannot be read.", ELL_ERROR);
@@ -11,6 +11,9 @@
 #include "irrString.h"
 #include "IFileSystem.h"
 #include "CFileList.h"
+#include <list>
+#include <memory>
+#include <unordered_map>
 
 namespace irr
 {
@@ -128,17 +131,93 @@ namespace io
 		//! Position of data in the archive file
 		s32 Offset;
 
+		//! Position of the local file header, -1 once Offset is known
+		/** Files found in the central directory read their local header
+		when they are opened first. */
+		s32 LocalHeaderOffset;
+
 		//! The header for this file containing compression info etc
 		SZIPFileHeader header;
 	};
 
+	//! Keeps decompressed files of zip archives in memory, within a budget of bytes
+	/** Shared by the zip archives of a file system through a std::shared_ptr,
+	so archives can be created on other threads. The least recently opened
+	files are removed first. Opened files keep their memory until they are
+	dropped, even if it was removed from the cache. */
+	class CZipEntryCache
+	{
+	public:
+
+		//! Constructor
+		CZipEntryCache(u32 budget);
+
+		//! Sets the budget in bytes, removes files until it is met
+		void setBudget(u32 budget);
+
+		//! Whether files of this size are kept in the cache
+		bool isCacheable(u32 size) const
+		{
+			return size <= Budget / 16;
+		}
+
+		//! Opens a cached file, returns 0 if it isn't in the cache
+		IReadFile* createAndOpenFile(const IFileArchive* archive, u32 index, const io::path& name);
+
+		//! Adds a decompressed file to the cache and opens it
+		/** Takes ownership of data, which has to be allocated with new[]. */
+		IReadFile* addFile(const IFileArchive* archive, u32 index, c8* data, u32 size, const io::path& name);
+
+		//! Removes all files of an archive
+		void removeArchive(const IFileArchive* archive);
+
+	private:
+
+		struct SEntry
+		{
+			const IFileArchive* Archive;
+			u32 Index;
+			std::shared_ptr<const c8> Data;
+			u32 Size;
+		};
+
+		struct SKey
+		{
+			const IFileArchive* Archive;
+			u32 Index;
+
+			bool operator==(const SKey& other) const
+			{
+				return Archive == other.Archive && Index == other.Index;
+			}
+		};
+
+		struct SKeyHash
+		{
+			size_t operator()(const SKey& key) const
+			{
+				return std::hash<const void*>()(key.Archive) ^ ((size_t)key.Index * 0x9e3779b9u);
+			}
+		};
+
+		//! removes the least recently opened files until at most budget bytes are used
+		void shrink(u32 budget);
+
+		//! most recently opened first
+		std::list<SEntry> Entries;
+		std::unordered_map<SKey, std::list<SEntry>::iterator, SKeyHash> Lookup;
+		u32 Budget;
+		u32 Used;
+	};
+
 	//! Archiveloader capable of loading ZIP Archives
 	class CArchiveLoaderZIP : public IArchiveLoader
 	{
 	public:
 
 		//! Constructor
-		CArchiveLoaderZIP(io::IFileSystem* fs);
+		/** \param cache Cache of decompressed files for the created archives, may be empty. */
+		CArchiveLoaderZIP(io::IFileSystem* fs, std::shared_ptr<CZipEntryCache> cache=nullptr);
 
 		//! returns true if the file maybe is able to be loaded by this class
 		//! based on the file extension (e.g. ".zip")
@@ -167,17 +246,32 @@ namespace io
 
 	private:
 		io::IFileSystem* FileSystem;
+		std::shared_ptr<CZipEntryCache> Cache;
+	};
+
+	//! An archive whose files can be read deflated, to decompress them on another thread
+	/** Derived non-virtually from IFileArchive, so CFileSystem can reach it
+	from the IFileArchive of a zip or gzip archive without RTTI. */
+	class IDeflatedFileArchive : public IFileArchive
+	{
+	public:
+
+		//! reads the deflated data of a file, to decompress it with CZipReader::inflateData()
+		/** \param size Receives the size of the decompressed file.
+		\return False if the file isn't deflated or can't be read. */
+		virtual bool readDeflatedData(u32 index, core::array<u8>& data, u32& size) = 0;
 	};
 
 /*!
 	Zip file Reader written April 2002 by N.Gebhardt.
 */
-	class CZipReader : public virtual IFileArchive, virtual CFileList
+	class CZipReader : public IDeflatedFileArchive, virtual CFileList
 	{
 	public:
 
 		//! constructor
-		CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip=false);
+		CZipReader(IFileSystem* fs, IReadFile* file, bool ignoreCase, bool ignorePaths, bool isGZip=false,
+			std::shared_ptr<CZipEntryCache> cache=nullptr);
 
 		//! destructor
 		virtual ~CZipReader();
@@ -186,6 +280,8 @@ namespace io
 		IReadFile* createAndOpenFile(const io::path& filename) override;
 
 		//! opens a file by index
+		/** Small deflated files are decompressed completely and kept in the
+		cache, larger ones are decompressed while they are read. */
 		IReadFile* createAndOpenFile(u32 index) override;
 
 		//! returns the list of files
@@ -197,6 +293,16 @@ namespace io
 		//! return the id of the file Archive
 		const io::path& getArchiveName() const override {return Path;}
 
+		//! reads the deflated data of a file, to decompress it with inflateData()
+		/** \param size Receives the size of the decompressed file.
+		\return False if the file isn't deflated or can't be read. */
+		bool readDeflatedData(u32 index, core::array<u8>& data, u32& size) override;
+
+		//! decompresses deflated data without zlib header
+		/** Can be called on any thread.
+		\return True if the data was decompressed completely. */
+		static bool inflateData(const u8* in, u32 inSize, c8* out, u32 outSize);
+
 	protected:
 
 		//! reads the next file header from a ZIP file, returns false if there are no more headers.
@@ -210,12 +316,23 @@ namespace io
 
 		bool scanCentralDirectoryHeader();
 
+		//! reads the file list from the central directory at the end of the archive
+		/** Reads the end of the archive and then the whole directory at once.
+		\return False if there is no valid central directory. */
+		bool scanCentralDirectory();
+
+		//! reads the local file header of a file, to find the start of its data
+		bool readLocalHeader(SZipFileEntry& entry);
+
 		io::IFileSystem* FileSystem;
 		IReadFile* File;
 
 		// holds extended info about files
 		core::array<SZipFileEntry> FileInfo;
 
+		//! decompressed small files, may be empty
+		std::shared_ptr<CZipEntryCache> Cache;
+
 		bool IsGZip;
 	};
 
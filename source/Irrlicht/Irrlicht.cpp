@@ -33,6 +33,10 @@ static const char* const copyright = "Irrlicht Engine (c) 2002-2017 Nikolaus Geb
 #include "Android/CIrrDeviceAndroid.h"
 #endif
 
+#ifdef _IRR_COMPILE_WITH_HEADLESS_DEVICE_
+#include "CIrrDeviceHeadless.h"
+#endif
+
 namespace irr
 {
 	//! stub for calling createDeviceEx
@@ -57,6 +61,8 @@ namespace irr
 
 	extern "C" IRRLICHT_API IrrlichtDevice* IRRCALLCONV createDeviceEx(const SIrrlichtCreationParameters& params)
 	{
+		if (params.MemoryAllocator && !core::setMemoryAllocator(params.MemoryAllocator))
+			return 0;
 
 		IrrlichtDevice* dev = 0;
 
@@ -85,6 +91,11 @@ namespace irr
 			dev = new CIrrDeviceSDL(params);
 #endif
 
+#ifdef _IRR_COMPILE_WITH_HEADLESS_DEVICE_
+		if (params.DeviceType == EIDT_HEADLESS)
+			dev = new CIrrDeviceHeadless(params);
+#endif
+
 		if (dev && !dev->getVideoDriver() && params.DriverType != video::EDT_NULL)
 		{
 			dev->closeDevice(); // destroy window
@@ -6,6 +6,7 @@
 
 #include "Driver.h"
 #include <cassert>
+#include <algorithm>
 #include "CNullDriver.h"
 #include "IContextManager.h"
 
@@ -16,10 +17,18 @@
 #include "MaterialRenderer.h"
 #include "FixedPipelineRenderer.h"
 #include "Renderer2D.h"
+#include "TextureAtlas.h"
+#include "TextureResidency.h"
+#include "GPUCulling.h"
+#include "WeightedTransparency.h"
+#include "CScreenShotRequest.h"
 
 #include "EVertexAttributes.h"
 #include "CImage.h"
+#include "IWriteFile.h"
+#include "S3DInstance.h"
 #include "os.h"
+#include "CProfiler.h"
 
 #ifdef _IRR_COMPILE_WITH_ANDROID_DEVICE_
 #include "android_native_app_glue.h"
@@ -96,18 +105,88 @@ namespace video
 		},
 	};
 
+	static constexpr VertexType vtSkinned = {
+		sizeof(S3DVertexSkinned), 6, {
+			{EVA_POSITION, 3, GL_FLOAT, VertexAttribute::Mode::Regular, offsetof(S3DVertexSkinned, Pos)},
+			{EVA_NORMAL, 3, GL_FLOAT, VertexAttribute::Mode::Regular, offsetof(S3DVertexSkinned, Normal)},
+			{EVA_COLOR, 4, GL_UNSIGNED_BYTE, VertexAttribute::Mode::Normalized, offsetof(S3DVertexSkinned, Color)},
+			{EVA_TCOORD0, 2, GL_FLOAT, VertexAttribute::Mode::Regular, offsetof(S3DVertexSkinned, TCoords)},
+			{EVA_JOINT_INDICES, 4, GL_UNSIGNED_BYTE, VertexAttribute::Mode::Regular, offsetof(S3DVertexSkinned, JointIndices)},
+			{EVA_JOINT_WEIGHTS, 4, GL_UNSIGNED_BYTE, VertexAttribute::Mode::Normalized, offsetof(S3DVertexSkinned, JointWeights)},
+		},
+	};
+
+	static constexpr VertexType vtCompact = {
+		sizeof(S3DVertexCompact), 4, {
+			{EVA_POSITION, 3, GL_UNSIGNED_SHORT, VertexAttribute::Mode::Normalized, offsetof(S3DVertexCompact, Pos)},
+			{EVA_NORMAL, 4, OpenGLProcedures::INT_2_10_10_10_REV, VertexAttribute::Mode::Normalized, offsetof(S3DVertexCompact, Normal)},
+			{EVA_COLOR, 4, GL_UNSIGNED_BYTE, VertexAttribute::Mode::Normalized, offsetof(S3DVertexCompact, Color)},
+			{EVA_TCOORD0, 2, OpenGLProcedures::HALF_FLOAT, VertexAttribute::Mode::Regular, offsetof(S3DVertexCompact, TCoords)},
+		},
+	};
+
 #pragma GCC diagnostic pop
 
+	//! Bytes of one attribute value
+	static u32 getAttributeSize(const VertexAttribute &attr)
+	{
+		switch (attr.ComponentType) {
+			case GL_FLOAT: return 4 * attr.ComponentCount;
+			case GL_UNSIGNED_SHORT:
+			case OpenGLProcedures::HALF_FLOAT: return 2 * attr.ComponentCount;
+			case OpenGLProcedures::INT_2_10_10_10_REV: return 4;
+			default: return attr.ComponentCount;
+		}
+	}
+
+	//! Bytes of the stream of one attribute, streams start at 4 byte boundaries
+	static u32 getAttributeStreamSize(const VertexAttribute &attr, u32 vertexCount)
+	{
+		return (getAttributeSize(attr) * vertexCount + 3) & ~3u;
+	}
+
 	static const VertexType &getVertexTypeDescription(E_VERTEX_TYPE type)
 	{
 		switch (type) {
 			case EVT_STANDARD: return vtStandard;
 			case EVT_2TCOORDS: return vt2TCoords;
 			case EVT_TANGENTS: return vtTangents;
+			case EVT_SKINNED: return vtSkinned;
+			case EVT_COMPACT: return vtCompact;
 			default: assert(false);
 		}
 	}
 
+	//! Number of indices read by drawPrimitives
+	static u32 getIndexCount(scene::E_PRIMITIVE_TYPE pType, u32 primitiveCount)
+	{
+		switch (pType)
+		{
+			case scene::EPT_POINTS:
+			case scene::EPT_POINT_SPRITES:
+				return 0;
+			case scene::EPT_LINE_STRIP:
+				return primitiveCount + 1;
+			case scene::EPT_LINE_LOOP:
+				return primitiveCount;
+			case scene::EPT_LINES:
+				return primitiveCount * 2;
+			case scene::EPT_TRIANGLE_STRIP:
+			case scene::EPT_TRIANGLE_FAN:
+				return primitiveCount + 2;
+			case scene::EPT_TRIANGLES:
+				return primitiveCount * 3;
+			default:
+				return 0;
+		}
+	}
+
+
+	static u32 getIndexSize(E_INDEX_TYPE iType)
+	{
+		return iType == EIT_32BIT ? sizeof(u32) : sizeof(u16);
+	}
+
 	static constexpr VertexType vt2DImage = {
 		sizeof(S3DVertex), 3, {
 			{EVA_POSITION, 3, GL_FLOAT, VertexAttribute::Mode::Regular, offsetof(S3DVertex, Pos)},
@@ -131,21 +210,77 @@ void APIENTRY COpenGL3DriverBase::debugCb(GLenum source, GLenum type, GLuint id,
 
 void COpenGL3DriverBase::debugCb(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message)
 {
-	printf("%04x %04x %x %x %.*s\n", source, type, id, severity, length, message);
+	{
+		std::lock_guard<std::mutex> lock(DebugMessageMutex);
+		SDebugMessageCount &count = DebugMessageCounts[((u64)source << 48) | ((u64)type << 32) | id];
+		++count.Count;
+		if (count.Logged >= DebugMessagesLoggedPerReport)
+			return;
+		++count.Logged;
+	}
+
+	ELOG_LEVEL level = ELL_DEBUG;
+	if (severity == GL.DEBUG_SEVERITY_HIGH)
+		level = ELL_ERROR;
+	else if (severity == GL.DEBUG_SEVERITY_MEDIUM)
+		level = ELL_WARNING;
+	else if (severity == GL.DEBUG_SEVERITY_LOW)
+		level = ELL_INFORMATION;
+
+	char hint[48];
+	snprintf(hint, sizeof(hint), "source %04x type %04x id %x", source, type, id);
+	const core::stringc text = length < 0 ? core::stringc(message) : core::stringc(message, (u32)length);
+	os::Printer::log(text.c_str(), hint, level);
+}
+
+void COpenGL3DriverBase::reportDebugMessages()
+{
+	const u32 now = os::Timer::getRealTime();
+	if (now - DebugMessageReportTime < 1000)
+		return;
+	DebugMessageReportTime = now;
+
+	std::lock_guard<std::mutex> lock(DebugMessageMutex);
+	for (const auto &it : DebugMessageCounts)
+	{
+		if (it.second.Count <= it.second.Logged)
+			continue;
+		char text[96];
+		snprintf(text, sizeof(text), "GL debug message source %04x type %04x id %x repeated %u more times",
+			(u32)(it.first >> 48), (u32)(it.first >> 32) & 0xffff, (u32)it.first, it.second.Count - it.second.Logged);
+		os::Printer::log(text, ELL_WARNING);
+	}
+	DebugMessageCounts.clear();
 }
 
 COpenGL3DriverBase::COpenGL3DriverBase(const SIrrlichtCreationParameters& params, io::IFileSystem* io, IContextManager* contextManager) :
 	CNullDriver(io, params.WindowSize), COpenGL3ExtensionHandler(), CacheHandler(0),
 	Params(params), ResetRenderStates(true), LockRenderStateMode(false), AntiAlias(params.AntiAlias),
-	MaterialRenderer2DActive(0), MaterialRenderer2DTexture(0), MaterialRenderer2DNoTexture(0),
-	CurrentRenderMode(ERM_NONE), Transformation3DChanged(true),
+	VertexArrayObjectSupported(false), InstancingSupported(false),
+	HardwareSkinningSupported(false), JointMatrices(0), JointMatrixCount(0), LastMaterialVariant(EMV_NONE),
+	LastMaterialPermutation(EMP_GENERIC), VariantMaterialRenderers(), VariantMaterialFailed(), CompactVerticesSupported(false), CompactVertices(false),
+	MorphTarget(0), MorphBlend(0.f),
+	InstanceBufferID(0),
+	OcclusionQueryTarget(0), SamplerObjectsSupported(false), ParallelShaderCompileSupported(false),
+	TimerQuerySupported(false), GPUTimerFrame(0), GPUFrameTimers(), GPUFrameBeginQuery(0), TextureUploadQueueSupported(false), BufferMapRangeSupported(false),
+	SharedContextUploadSupported(false), UploadContext(0), UploadThreadQuit(false), TextureStorageSupported(false), TextureRGSupported(false), AsyncReadbackSupported(false), MaxFramesInFlight(0),
+	TextureCompressionDXT(false), TextureCompressionETC2(false), TextureCompressionBPTC(false), TextureCompressionASTC(false),
+	ClipControlSupported(false), ShaderCacheDriverHash(0), UniformBlocksSupported(false),
+	MaterialStateKey(0), AppliedStateKey(0),
+	MaterialRenderer2DActive(0), MaterialRenderer2DTexture(0), MaterialRenderer2DNoTexture(0), MaterialRenderer2DDistanceField(0),
+	DerivedMatricesDirty((1 << EDM_COUNT) - 1), CurrentRenderMode(ERM_NONE), Transformation3DChanged(true),
 	OGLES2ShaderPath(params.OGLES2ShaderPath),
+	MaterialRevision(1), LastMaterialRevision(0),
 	ColorFormat(ECF_R8G8B8), ContextManager(contextManager)
 {
 #ifdef _DEBUG
 	setDebugName("Driver");
 #endif
 
+	// runOcclusionQuery() keeps a query until its result is available, so
+	// endScene() picks the results up later instead of waiting for the GPU
+	BlockOnOcclusionQueries = false;
+
 	if (!ContextManager)
 		return;
 
@@ -155,13 +290,72 @@ COpenGL3DriverBase::COpenGL3DriverBase(const SIrrlichtCreationParameters& params
 	ExposedData = ContextManager->getContext();
 	ContextManager->activateContext(ExposedData, false);
 	GL.LoadAllProcedures(ContextManager);
-	GL.DebugMessageCallback(debugCb, this);
 	initQuadsIndices();
 }
 
 COpenGL3DriverBase::~COpenGL3DriverBase()
 {
+	// the GL objects are deleted on this thread
+	setRenderThreadEnabled(false);
+	stopUploadThread();
+
+	// while the buffer objects still exist, GPU only mesh buffers get their data back
+	removeAllHardwareBuffers();
 	deleteMaterialRenders();
+	deleteStreamBuffer();
+	if (InstanceBufferID)
+		glDeleteBuffers(1, &InstanceBufferID);
+	for (auto &sampler : Samplers)
+		GL.DeleteSamplers(1, &sampler.second);
+	if (UniformBlocksSupported)
+		glDeleteBuffers(EUB_COUNT, BuiltInUniformBlockBuffers);
+	for (u32 i = 0; i < GPUTimerFrames; ++i)
+	{
+		for (u32 j = 0; j < GPUTimerScopes[i].size(); ++j)
+		{
+			FreeTimerQueries.push_back(GPUTimerScopes[i][j].BeginQuery);
+			if (GPUTimerScopes[i][j].EndQuery)
+				FreeTimerQueries.push_back(GPUTimerScopes[i][j].EndQuery);
+		}
+		if (GPUFrameTimers[i].BeginQuery)
+		{
+			FreeTimerQueries.push_back(GPUFrameTimers[i].BeginQuery);
+			FreeTimerQueries.push_back(GPUFrameTimers[i].EndQuery);
+		}
+	}
+	if (GPUFrameBeginQuery)
+		FreeTimerQueries.push_back(GPUFrameBeginQuery);
+	if (FreeTimerQueries.size())
+		GL.DeleteQueries(FreeTimerQueries.size(), FreeTimerQueries.pointer());
+
+	if (Batch2D.Texture)
+		Batch2D.Texture->drop();
+	for (auto texture : TextureUploadQueue)
+		texture->drop();
+	for (auto &upload : StagedTextureUploads)
+	{
+		upload.Texture->drop();
+		FreeTextureUploadBuffers.push_back(upload.Buffer);
+	}
+	if (!FreeTextureUploadBuffers.empty())
+		glDeleteBuffers(FreeTextureUploadBuffers.size(), FreeTextureUploadBuffers.data());
+	if (!FreeBufferNames.empty())
+		glDeleteBuffers(FreeBufferNames.size(), FreeBufferNames.data());
+	for (auto texture : StreamedTextures)
+		texture->drop();
+	for (auto fence : FrameFences)
+		GL.DeleteSync(fence);
+	for (auto &readback : ScreenShotReadbacks)
+	{
+		readback.Request->setFailed();
+		readback.Request->drop();
+		GL.DeleteSync(readback.Fence);
+		glDeleteBuffers(1, &readback.Buffer);
+	}
+	delete TextureAtlas;
+	delete TextureResidency;
+	delete GPUCulling;
+	delete WeightedTransparency;
 
 	CacheHandler->getTextureCache().clear();
 
@@ -170,8 +364,21 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	removeAllOcclusionQueries();
 	removeAllHardwareBuffers();
 
+	for (u32 v = 0; v < EMV_COUNT; ++v)
+	{
+		for (u32 i = 0; i <= EMT_ONETEXTURE_BLEND; ++i)
+		{
+			for (u32 p = 0; p < EMP_COUNT; ++p)
+			{
+				if (VariantMaterialRenderers[v][i][p])
+					VariantMaterialRenderers[v][i][p]->drop();
+			}
+		}
+	}
+
 	delete MaterialRenderer2DTexture;
 	delete MaterialRenderer2DNoTexture;
+	delete MaterialRenderer2DDistanceField;
 	delete CacheHandler;
 
 	if (ContextManager)
@@ -197,6 +404,32 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		}
 	}
 
+	static const u64 FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+	//! 64 bit FNV-1a over a zero terminated string, including the terminator
+	static u64 hashShaderCacheKey(u64 hash, const c8* str)
+	{
+		if (str)
+			for (; *str; ++str)
+				hash = (hash ^ (u8)*str) * 1099511628211ull;
+		// the terminator keeps "ab" + "c" apart from "a" + "bc"
+		return hash * 1099511628211ull;
+	}
+
+	// Layout of a shader cache file, followed by the program binary
+	struct SProgramBinaryHeader
+	{
+		u32 Magic;
+		u32 Version;
+		u64 DriverHash;
+		u32 Format;
+		u32 Length;
+	};
+
+	static const u32 PROGRAM_BINARY_MAGIC = 0x42505249; // "IRPB"
+	static const u32 PROGRAM_BINARY_VERSION = 1;
+
+
 	bool COpenGL3DriverBase::genericDriverInit(const core::dimension2d<u32>& screenSize, bool stencilBuffer)
 	{
 		Name = glGetString(GL_VERSION);
@@ -209,9 +442,201 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		// load extensions
 		initExtensions();
 
+		VertexArrayObjectSupported = Version >= 300 &&
+			GL.GenVertexArrays && GL.BindVertexArray && GL.DeleteVertexArrays;
+
+		// instanced arrays are core since OpenGL 3.3 and OpenGL ES 3.0
+		InstancingSupported = Version >= (getDriverType() == EDT_OGLES2 ? 300 : 330) &&
+			GL.DrawArraysInstanced && GL.DrawElementsInstanced && GL.VertexAttribDivisor;
+
+		// sampler objects are core since OpenGL 3.3 and OpenGL ES 3.0
+		SamplerObjectsSupported = Version >= (getDriverType() == EDT_OGLES2 ? 300 : 330) &&
+			GL.GenSamplers && GL.DeleteSamplers && GL.BindSampler && GL.SamplerParameteri && GL.SamplerParameterf;
+		for (u32 i = 0; i < MATERIAL_MAX_TEXTURES; ++i)
+		{
+			BoundSamplerKeys[i] = ~0u;
+			BoundSamplers[i] = 0;
+		}
+
+		// timestamps instead of GL_TIME_ELAPSED, as elapsed time queries can't be nested
+		TimerQuerySupported = GL.GenQueries && GL.DeleteQueries && GL.QueryCounter &&
+			GL.GetQueryObjectuiv && GL.GetQueryObjectui64v &&
+			(getDriverType() == EDT_OGLES2 ? GL.IsExtensionPresent("GL_EXT_disjoint_timer_query") :
+				Version >= 330 || GL.IsExtensionPresent("GL_ARB_timer_query"));
+
+		// pixel buffer objects are core since OpenGL 2.1 and OpenGL ES 3.0, mapping them since OpenGL 3.0
+		TextureUploadQueueSupported = Version >= 300 &&
+			GL.MapBufferRange && GL.UnmapBuffer;
+		BufferMapRangeSupported = TextureUploadQueueSupported;
+		AsyncReadbackSupported = TextureUploadQueueSupported &&
+			GL.FenceSync && GL.ClientWaitSync && GL.DeleteSync;
+		SharedContextUploadSupported = AsyncReadbackSupported && ContextManager;
+
+		// BC7 is core since OpenGL 4.2, ETC2 since OpenGL 4.3 and OpenGL ES 3.0 and ASTC since OpenGL ES 3.2
+		const bool isGLES = getDriverType() == EDT_OGLES2;
+
+		// multi-bind is core since OpenGL 4.4 and direct state access since OpenGL 4.5, OpenGL ES has neither
+		Feature.MultiBind = !isGLES && (Version >= 440 || GL.IsExtensionPresent("GL_ARB_multi_bind")) &&
+			GL.BindTextures && GL.BindSamplers;
+		Feature.DirectStateAccess = !isGLES && (Version >= 450 || GL.IsExtensionPresent("GL_ARB_direct_state_access")) &&
+			GL.NamedBufferData && GL.NamedBufferSubData && GL.MapNamedBufferRange && GL.UnmapNamedBuffer &&
+			GL.TextureSubImage2D;
+
+		// multisampled renderbuffers and their resolve are core since OpenGL 3.0 and OpenGL ES 3.0
+		if (Version >= 300 && GL.RenderbufferStorageMultisample && GL.BlitFramebuffer)
+		{
+			GLint maxSamples = 0;
+			glGetIntegerv(GL.MAX_SAMPLES, &maxSamples);
+			Feature.MaxRenderTargetSamples = static_cast<u8>(core::s32_min(maxSamples, 255));
+		}
+
+		// clip control is core since OpenGL 4.5, the loader only knows the core name
+		if (isGLES && !GL.ClipControl && GL.IsExtensionPresent("GL_EXT_clip_control"))
+			GL.ClipControl = (decltype(GL.ClipControl))ContextManager->getProcAddress("glClipControlEXT");
+		ClipControlSupported = GL.ClipControl &&
+			(isGLES ? GL.IsExtensionPresent("GL_EXT_clip_control") : Version >= 450 || GL.IsExtensionPresent("GL_ARB_clip_control"));
+
+		// debug output is core since OpenGL 4.3 and OpenGL ES 3.2
+		DebugOutputSupported = GL.DebugMessageCallback && GL.DebugMessageControl &&
+			(Version >= (isGLES ? 320 : 430) || GL.IsExtensionPresent("GL_KHR_debug"));
+		if (DebugOutputSupported)
+			GL.DebugMessageCallback(debugCb, this);
+		setDebugMessageLevel(DebugMessageLevel);
+#ifdef _DEBUG
+		setErrorCheckMode(DebugOutputSupported ? EECM_DEBUG_OUTPUT : EECM_SYNCHRONOUS);
+#else
+		setErrorCheckMode(EECM_NONE);
+#endif
+
+		// three vec4 per joint, with room left for the other uniforms of the built-in shaders
+		GLint vertexUniformVectors = 0;
+		if (isGLES && Version < 300)
+			glGetIntegerv(GL.MAX_VERTEX_UNIFORM_VECTORS, &vertexUniformVectors);
+		else
+		{
+			glGetIntegerv(GL.MAX_VERTEX_UNIFORM_COMPONENTS, &vertexUniformVectors);
+			vertexUniformVectors /= 4;
+		}
+		HardwareSkinningSupported = vertexUniformVectors >= (GLint)(MAX_SKINNING_JOINTS * 3 + 32);
+
+		// signed 10:10:10:2 attributes are core since OpenGL 3.3 and OpenGL ES 3.0, half floats before that
+		CompactVerticesSupported = Version >= (isGLES ? 300 : 330);
+
+		// immutable storage is core since OpenGL 4.2 and OpenGL ES 3.0
+		TextureStorageSupported = GL.TexStorage2D &&
+			(Version >= (isGLES ? 300 : 420) || GL.IsExtensionPresent("GL_ARB_texture_storage"));
+		// red and red-green textures are core since OpenGL 3.0 and OpenGL ES 3.0
+		TextureRGSupported = Version >= 300 || queryGLESFeature(COGLESCoreExtensionHandler::IRR_GL_EXT_texture_rg);
+		TextureCompressionDXT = GL.IsExtensionPresent("GL_EXT_texture_compression_s3tc");
+		TextureCompressionETC2 = Version >= (isGLES ? 300 : 430) || GL.IsExtensionPresent("GL_ARB_ES3_compatibility");
+		TextureCompressionBPTC = isGLES ? GL.IsExtensionPresent("GL_EXT_texture_compression_bptc") :
+			Version >= 420 || GL.IsExtensionPresent("GL_ARB_texture_compression_bptc");
+		TextureCompressionASTC = (isGLES && Version >= 320) || GL.IsExtensionPresent("GL_KHR_texture_compression_astc_ldr");
+
+		// let the driver compile on as many threads as it likes
+		ParallelShaderCompileSupported = GL.MaxShaderCompilerThreads &&
+			(GL.IsExtensionPresent("GL_KHR_parallel_shader_compile") || GL.IsExtensionPresent("GL_ARB_parallel_shader_compile"));
+		if (ParallelShaderCompileSupported)
+			GL.MaxShaderCompilerThreads(0xFFFFFFFF);
+
+		// program binaries are core since OpenGL 4.1 and OpenGL ES 3.0, but drivers may support no format at all
+		if (!Params.ShaderCachePath.empty() && GL.GetProgramBinary && GL.ProgramBinary && GL.ProgramParameteri &&
+			(Version >= (getDriverType() == EDT_OGLES2 ? 300 : 410) || GL.IsExtensionPresent("GL_ARB_get_program_binary")))
+		{
+			GLint formats = 0;
+			glGetIntegerv(GL.NUM_PROGRAM_BINARY_FORMATS, &formats);
+			if (formats > 0)
+			{
+				ShaderCachePath = Params.ShaderCachePath;
+
+				core::stringc driver(glGetString(GL_VENDOR));
+				driver += '/';
+				driver += (const c8*)glGetString(GL_RENDERER);
+				driver += '/';
+				driver += (const c8*)glGetString(GL_VERSION);
+				ShaderCacheDriverHash = hashShaderCacheKey(FNV_OFFSET_BASIS, driver.c_str());
+			}
+			else
+				os::Printer::log("Driver supports no program binary formats, shader cache disabled.", ELL_INFORMATION);
+		}
+
+		// uniform buffers are core since OpenGL 3.1 and OpenGL ES 3.0
+		UniformBlocksSupported = Version >= (getDriverType() == EDT_OGLES2 ? 300 : 310) &&
+			GL.BindBufferBase && GL.GetActiveUniformBlockiv && GL.GetActiveUniformBlockName && GL.UniformBlockBinding;
+		if (UniformBlocksSupported)
+		{
+			const GLsizeiptr blockSize[EUB_COUNT] = { sizeof(SFrameUniformBlock), sizeof(SDrawUniformBlock) };
+
+			glGenBuffers(EUB_COUNT, BuiltInUniformBlockBuffers);
+			for (u32 i = 0; i < EUB_COUNT; ++i)
+			{
+				glBindBuffer(GL.UNIFORM_BUFFER, BuiltInUniformBlockBuffers[i]);
+				glBufferData(GL.UNIFORM_BUFFER, blockSize[i], 0, GL_DYNAMIC_DRAW);
+				GL.BindBufferBase(GL.UNIFORM_BUFFER, i, BuiltInUniformBlockBuffers[i]);
+				BuiltInUniformBlockDirty[i] = true;
+			}
+			glBindBuffer(GL.UNIFORM_BUFFER, 0);
+		}
+
+		// conservative queries may report hidden geometry as visible, but are cheaper on tiled GPUs
+		if (GL.GenQueries && GL.DeleteQueries && GL.BeginQuery && GL.EndQuery && GL.GetQueryObjectuiv)
+		{
+			if (getDriverType() == EDT_OGLES2)
+				OcclusionQueryTarget = Version >= 300 ? GL.ANY_SAMPLES_PASSED_CONSERVATIVE : 0;
+			else if (Version >= 430 || GL.IsExtensionPresent("GL_ARB_ES3_compatibility"))
+				OcclusionQueryTarget = GL.ANY_SAMPLES_PASSED_CONSERVATIVE;
+			else if (Version >= 330)
+				OcclusionQueryTarget = GL.ANY_SAMPLES_PASSED;
+			else if (Version >= 150)
+				OcclusionQueryTarget = GL.SAMPLES_PASSED;
+		}
+
+		initStreamBuffer();
+
 		// reset cache handler
 		delete CacheHandler;
 		CacheHandler = new COpenGL3CacheHandler(this);
+		updateRenderTargetMultisampled();
+
+		delete TextureAtlas;
+		TextureAtlas = new COpenGL3TextureAtlas(this);
+
+		delete TextureResidency;
+		TextureResidency = new COpenGL3TextureResidency(this);
+		TextureResidency->setBudget(Params.TextureMemoryBudget);
+
+		// compute shaders, shader storage buffers and indirect draws are core since OpenGL 4.3
+		delete GPUCulling;
+		GPUCulling = nullptr;
+		if (!isGLES && Version >= 430 && VertexArrayObjectSupported &&
+			GL.DispatchCompute && GL.MemoryBarrier && GL.BindBufferBase && GL.BindImageTexture &&
+			GL.TexStorage2D && GL.Uniform1ui && GL.MultiDrawElementsIndirect)
+		{
+			GPUCulling = new COpenGL3GPUCulling(this);
+			if (!GPUCulling->init())
+			{
+				delete GPUCulling;
+				GPUCulling = nullptr;
+			}
+		}
+
+		// half float color buffers are renderable since OpenGL 3.0 and OpenGL ES 3.2, the composite shader
+		// needs GLSL 1.50. Shaders of OpenGL ES 2.0 only write several draw buffers with EXT_draw_buffers.
+		delete WeightedTransparency;
+		WeightedTransparency = nullptr;
+		TransparencyAccumulating = false;
+		if (Version >= (isGLES ? 300 : 320) && VertexArrayObjectSupported &&
+			GL.DrawBuffers && GL.BlitFramebuffer && GL.ClearBufferfv &&
+			(!isGLES || (GL.IsExtensionPresent("GL_EXT_draw_buffers") && (Version >= 320 ||
+				GL.IsExtensionPresent("GL_EXT_color_buffer_half_float") || GL.IsExtensionPresent("GL_EXT_color_buffer_float")))))
+		{
+			WeightedTransparency = new COpenGL3WeightedTransparency(this);
+			if (!WeightedTransparency->init(isGLES))
+			{
+				delete WeightedTransparency;
+				WeightedTransparency = nullptr;
+			}
+		}
 
 		StencilBuffer = stencilBuffer;
 
@@ -262,6 +687,106 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		return true;
 	}
 
+	io::path COpenGL3DriverBase::getProgramBinaryFileName(const c8* vertexShaderProgram, const c8* pixelShaderProgram) const
+	{
+		// attribute bindings depend on the enabled features, so they are part of the key
+		u64 hash = hashShaderCacheKey(FNV_OFFSET_BASIS, vertexShaderProgram);
+		hash = hashShaderCacheKey(hash, pixelShaderProgram);
+		hash = hashShaderCacheKey(hash, queryFeature(EVDF_INSTANCING) ? "instancing" : "");
+		hash = hashShaderCacheKey(hash, queryFeature(EVDF_UNIFORM_BLOCKS) ? "uniform_blocks" : "");
+
+		c8 name[24];
+		snprintf_irr(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+
+		io::path path(ShaderCachePath);
+		path += name;
+		return path;
+	}
+
+
+	bool COpenGL3DriverBase::loadProgramBinary(GLuint program, const c8* vertexShaderProgram, const c8* pixelShaderProgram)
+	{
+		if (ShaderCachePath.empty())
+			return false;
+
+		// needed before linking, in case the program is built from source
+		GL.ProgramParameteri(program, GL.PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+		const io::path path = getProgramBinaryFileName(vertexShaderProgram, pixelShaderProgram);
+		if (!FileSystem->existFile(path))
+			return false;
+
+		io::IReadFile* file = FileSystem->createAndOpenFile(path);
+		if (!file)
+			return false;
+
+		SProgramBinaryHeader header;
+		bool success = file->read(&header, sizeof(header)) == sizeof(header) &&
+			header.Magic == PROGRAM_BINARY_MAGIC && header.Version == PROGRAM_BINARY_VERSION &&
+			header.DriverHash == ShaderCacheDriverHash &&
+			(long)(sizeof(header) + header.Length) == file->getSize();
+
+		if (success)
+		{
+			c8* data = new c8[header.Length];
+			success = file->read(data, header.Length) == header.Length;
+			if (success)
+			{
+				GL.ProgramBinary(program, header.Format, data, header.Length);
+
+				GLint status = 0;
+				glGetProgramiv(program, GL_LINK_STATUS, &status);
+				success = status == GL_TRUE;
+			}
+			delete[] data;
+		}
+
+		file->drop();
+
+		// stale entries are overwritten once the program is linked from source
+		if (!success)
+			os::Printer::log("Shader cache entry is outdated", path, ELL_DEBUG);
+
+		return success;
+	}
+
+
+	void COpenGL3DriverBase::saveProgramBinary(GLuint program, const c8* vertexShaderProgram, const c8* pixelShaderProgram)
+	{
+		if (ShaderCachePath.empty())
+			return;
+
+		GLint length = 0;
+		glGetProgramiv(program, GL.PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+
+		SProgramBinaryHeader header;
+		header.Magic = PROGRAM_BINARY_MAGIC;
+		header.Version = PROGRAM_BINARY_VERSION;
+		header.DriverHash = ShaderCacheDriverHash;
+
+		c8* data = new c8[length];
+		GLenum format = 0;
+		GLsizei written = 0;
+		GL.GetProgramBinary(program, length, &written, &format, data);
+		header.Format = format;
+		header.Length = written;
+
+		const io::path path = getProgramBinaryFileName(vertexShaderProgram, pixelShaderProgram);
+		io::IWriteFile* file = written > 0 ? FileSystem->createSizedWriteFile(path, sizeof(header) + written) : 0;
+		if (file)
+		{
+			if (file->write(&header, sizeof(header)) != sizeof(header) ||
+				file->write(data, written) != (size_t)written)
+				os::Printer::log("Could not write shader cache file", path, ELL_WARNING);
+			file->drop();
+		}
+
+		delete[] data;
+	}
+
+
 	void COpenGL3DriverBase::loadShaderData(const io::path& vertexShaderName, const io::path& fragmentShaderName, c8** vertexShaderData, c8** fragmentShaderData)
 	{
 		io::path vsPath(OGLES2ShaderPath);
@@ -317,162 +842,317 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		fsFile->drop();
 	}
 
-	void COpenGL3DriverBase::createMaterialRenderers()
+	//! Shaders of the built-in materials, in the order of E_MATERIAL_TYPE
+	static const struct
 	{
-		// Create callbacks.
-
-		COpenGL3MaterialSolidCB* SolidCB = new COpenGL3MaterialSolidCB();
-		COpenGL3MaterialSolid2CB* Solid2LayerCB = new COpenGL3MaterialSolid2CB();
-		COpenGL3MaterialLightmapCB* LightmapCB = new COpenGL3MaterialLightmapCB(1.f);
-		COpenGL3MaterialLightmapCB* LightmapAddCB = new COpenGL3MaterialLightmapCB(1.f);
-		COpenGL3MaterialLightmapCB* LightmapM2CB = new COpenGL3MaterialLightmapCB(2.f);
-		COpenGL3MaterialLightmapCB* LightmapM4CB = new COpenGL3MaterialLightmapCB(4.f);
-		COpenGL3MaterialLightmapCB* LightmapLightingCB = new COpenGL3MaterialLightmapCB(1.f);
-		COpenGL3MaterialLightmapCB* LightmapLightingM2CB = new COpenGL3MaterialLightmapCB(2.f);
-		COpenGL3MaterialLightmapCB* LightmapLightingM4CB = new COpenGL3MaterialLightmapCB(4.f);
-		COpenGL3MaterialSolid2CB* DetailMapCB = new COpenGL3MaterialSolid2CB();
-		COpenGL3MaterialReflectionCB* SphereMapCB = new COpenGL3MaterialReflectionCB();
-		COpenGL3MaterialReflectionCB* Reflection2LayerCB = new COpenGL3MaterialReflectionCB();
-		COpenGL3MaterialSolidCB* TransparentAddColorCB = new COpenGL3MaterialSolidCB();
-		COpenGL3MaterialSolidCB* TransparentAlphaChannelCB = new COpenGL3MaterialSolidCB();
-		COpenGL3MaterialSolidCB* TransparentAlphaChannelRefCB = new COpenGL3MaterialSolidCB();
-		COpenGL3MaterialSolidCB* TransparentVertexAlphaCB = new COpenGL3MaterialSolidCB();
-		COpenGL3MaterialReflectionCB* TransparentReflection2LayerCB = new COpenGL3MaterialReflectionCB();
-		COpenGL3MaterialOneTextureBlendCB* OneTextureBlendCB = new COpenGL3MaterialOneTextureBlendCB();
-
-		// Create built-in materials.
-
-		core::stringc VertexShader = OGLES2ShaderPath + "Solid.vsh";
-		core::stringc FragmentShader = OGLES2ShaderPath + "Solid.fsh";
-
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, SolidCB, EMT_SOLID, 0);
-
-		VertexShader = OGLES2ShaderPath + "Solid2.vsh";
-		FragmentShader = OGLES2ShaderPath + "Solid2Layer.fsh";
-
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, Solid2LayerCB, EMT_SOLID, 0);
-
-		VertexShader = OGLES2ShaderPath + "Solid2.vsh";
-		FragmentShader = OGLES2ShaderPath + "LightmapModulate.fsh";
-
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, LightmapCB, EMT_SOLID, 0);
-
-		FragmentShader = OGLES2ShaderPath + "LightmapAdd.fsh";
-
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, LightmapAddCB, EMT_SOLID, 0);
-
-		FragmentShader = OGLES2ShaderPath + "LightmapModulate.fsh";
-
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, LightmapM2CB, EMT_SOLID, 0);
-
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, LightmapM4CB, EMT_SOLID, 0);
-
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, LightmapLightingCB, EMT_SOLID, 0);
+		const c8* VertexShader;
+		const c8* FragmentShader;
+		E_MATERIAL_TYPE BaseMaterial;
+		//! Texture layers and alpha reference the fragment shader reads
+		u32 TextureLayers;
+		bool AlphaTest;
+	} BuiltInMaterials[] = {
+		{"Solid.vsh", "Solid.fsh", EMT_SOLID, 1, false},
+		{"Solid2.vsh", "Solid2Layer.fsh", EMT_SOLID, 2, false},
+		{"Solid2.vsh", "LightmapModulate.fsh", EMT_SOLID, 2, false},
+		{"Solid2.vsh", "LightmapAdd.fsh", EMT_SOLID, 2, false},
+		{"Solid2.vsh", "LightmapModulate.fsh", EMT_SOLID, 2, false},
+		{"Solid2.vsh", "LightmapModulate.fsh", EMT_SOLID, 2, false},
+		{"Solid2.vsh", "LightmapModulate.fsh", EMT_SOLID, 2, false},
+		{"Solid2.vsh", "LightmapModulate.fsh", EMT_SOLID, 2, false},
+		{"Solid2.vsh", "LightmapModulate.fsh", EMT_SOLID, 2, false},
+		{"Solid2.vsh", "DetailMap.fsh", EMT_SOLID, 2, false},
+		{"SphereMap.vsh", "SphereMap.fsh", EMT_SOLID, 1, false},
+		{"Reflection2Layer.vsh", "Reflection2Layer.fsh", EMT_SOLID, 2, false},
+		{"Solid.vsh", "Solid.fsh", EMT_TRANSPARENT_ADD_COLOR, 1, false},
+		{"Solid.vsh", "TransparentAlphaChannel.fsh", EMT_TRANSPARENT_ALPHA_CHANNEL, 1, true},
+		{"Solid.vsh", "TransparentAlphaChannelRef.fsh", EMT_SOLID, 1, true},
+		{"Solid.vsh", "TransparentVertexAlpha.fsh", EMT_TRANSPARENT_ALPHA_CHANNEL, 1, false},
+		{"Reflection2Layer.vsh", "Reflection2Layer.fsh", EMT_TRANSPARENT_ALPHA_CHANNEL, 2, false},
+		{"Solid.vsh", "OneTextureBlend.fsh", EMT_ONETEXTURE_BLEND, 1, false},
+	};
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, LightmapLightingM2CB, EMT_SOLID, 0);
+	IShaderConstantSetCallBack* COpenGL3DriverBase::createBuiltInCallBack(E_MATERIAL_TYPE type) const
+	{
+		switch (type)
+		{
+		case EMT_SOLID_2_LAYER:
+		case EMT_DETAIL_MAP:
+			return new COpenGL3MaterialSolid2CB();
+		case EMT_LIGHTMAP:
+		case EMT_LIGHTMAP_ADD:
+		case EMT_LIGHTMAP_LIGHTING:
+			return new COpenGL3MaterialLightmapCB(1.f);
+		case EMT_LIGHTMAP_M2:
+		case EMT_LIGHTMAP_LIGHTING_M2:
+			return new COpenGL3MaterialLightmapCB(2.f);
+		case EMT_LIGHTMAP_M4:
+		case EMT_LIGHTMAP_LIGHTING_M4:
+			return new COpenGL3MaterialLightmapCB(4.f);
+		case EMT_SPHERE_MAP:
+		case EMT_REFLECTION_2_LAYER:
+		case EMT_TRANSPARENT_REFLECTION_2_LAYER:
+			return new COpenGL3MaterialReflectionCB();
+		case EMT_ONETEXTURE_BLEND:
+			return new COpenGL3MaterialOneTextureBlendCB();
+		default:
+			return new COpenGL3MaterialSolidCB();
+		}
+	}
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, LightmapLightingM4CB, EMT_SOLID, 0);
+	void COpenGL3DriverBase::createMaterialRenderers()
+	{
+		// Create built-in materials, each with a callback of its own.
 
-		VertexShader = OGLES2ShaderPath + "Solid2.vsh";
-		FragmentShader = OGLES2ShaderPath + "DetailMap.fsh";
+		for (u32 i = 0; i < sizeof(BuiltInMaterials) / sizeof(BuiltInMaterials[0]); ++i)
+		{
+			const core::stringc vertexShader = OGLES2ShaderPath + BuiltInMaterials[i].VertexShader;
+			const core::stringc fragmentShader = OGLES2ShaderPath + BuiltInMaterials[i].FragmentShader;
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, DetailMapCB, EMT_SOLID, 0);
+			IShaderConstantSetCallBack* callBack = createBuiltInCallBack((E_MATERIAL_TYPE)i);
+			addHighLevelShaderMaterialFromFiles(vertexShader, "main", EVST_VS_2_0, fragmentShader, "main", EPST_PS_2_0, "", "main",
+				EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, callBack, BuiltInMaterials[i].BaseMaterial, 0);
+			callBack->drop();
+		}
 
-		VertexShader = OGLES2ShaderPath + "SphereMap.vsh";
-		FragmentShader = OGLES2ShaderPath + "SphereMap.fsh";
+		// Create 2D material renderers
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, SphereMapCB, EMT_SOLID, 0);
+		c8* vs2DData = 0;
+		c8* fs2DData = 0;
+		loadShaderData(io::path("Renderer2D.vsh"), io::path("Renderer2D.fsh"), &vs2DData, &fs2DData);
+		MaterialRenderer2DTexture = new COpenGL3Renderer2D(vs2DData, fs2DData, this, true);
+		delete[] vs2DData;
+		delete[] fs2DData;
+		vs2DData = 0;
+		fs2DData = 0;
 
-		VertexShader = OGLES2ShaderPath + "Reflection2Layer.vsh";
-		FragmentShader = OGLES2ShaderPath + "Reflection2Layer.fsh";
+		loadShaderData(io::path("Renderer2D.vsh"), io::path("Renderer2D_noTex.fsh"), &vs2DData, &fs2DData);
+		MaterialRenderer2DNoTexture = new COpenGL3Renderer2D(vs2DData, fs2DData, this, false);
+		delete[] vs2DData;
+		delete[] fs2DData;
+		vs2DData = 0;
+		fs2DData = 0;
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, Reflection2LayerCB, EMT_SOLID, 0);
+		// without this shader distance fields are drawn like other textures
+		loadShaderData(io::path("Renderer2D.vsh"), io::path("Renderer2D_distanceField.fsh"), &vs2DData, &fs2DData);
+		if (vs2DData && fs2DData)
+		{
+			MaterialRenderer2DDistanceField = new COpenGL3Renderer2D(vs2DData, fs2DData, this, true);
 
-		VertexShader = OGLES2ShaderPath + "Solid.vsh";
-		FragmentShader = OGLES2ShaderPath + "Solid.fsh";
+			GLint linked = GL_FALSE;
+			glGetProgramiv(MaterialRenderer2DDistanceField->getProgram(), GL_LINK_STATUS, &linked);
+			if (!linked)
+			{
+				delete MaterialRenderer2DDistanceField;
+				MaterialRenderer2DDistanceField = 0;
+			}
+		}
+		delete[] vs2DData;
+		delete[] fs2DData;
+	}
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, TransparentAddColorCB, EMT_TRANSPARENT_ADD_COLOR, 0);
+	COpenGL3MaterialRenderer* COpenGL3DriverBase::getMaterialVariantRenderer(E_MATERIAL_TYPE type, E_MATERIAL_VARIANT variant, u32 permutation)
+	{
+		if ((variant == EMV_NONE && permutation == EMP_GENERIC) || static_cast<u32>(type) > EMT_ONETEXTURE_BLEND ||
+				permutation >= EMP_COUNT || VariantMaterialFailed[variant][type][permutation])
+			return 0;
 
-		FragmentShader = OGLES2ShaderPath + "TransparentAlphaChannel.fsh";
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, TransparentAlphaChannelCB, EMT_TRANSPARENT_ALPHA_CHANNEL, 0);
+		if (VariantMaterialRenderers[variant][type][permutation])
+			return VariantMaterialRenderers[variant][type][permutation];
 
-		FragmentShader = OGLES2ShaderPath + "TransparentAlphaChannelRef.fsh";
+		if ((variant == EMV_SKINNING && !HardwareSkinningSupported) ||
+				(variant == EMV_COMPACT && !CompactVerticesSupported))
+		{
+			VariantMaterialFailed[variant][type][permutation] = true;
+			return 0;
+		}
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, TransparentAlphaChannelRefCB, EMT_SOLID, 0);
+		c8* vsData = 0;
+		c8* fsData = 0;
+		loadShaderData(io::path(BuiltInMaterials[type].VertexShader), io::path(BuiltInMaterials[type].FragmentShader), &vsData, &fsData);
 
-		FragmentShader = OGLES2ShaderPath + "TransparentVertexAlpha.fsh";
+		const c8* versionEnd = vsData ? strchr(vsData, '\n') : 0;
+		const c8* fsVersionEnd = fsData ? strchr(fsData, '\n') : 0;
+		if (!versionEnd || !fsVersionEnd)
+		{
+			delete[] vsData;
+			delete[] fsData;
+			VariantMaterialFailed[variant][type][permutation] = true;
+			return 0;
+		}
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, TransparentVertexAlphaCB, EMT_TRANSPARENT_ALPHA_CHANNEL, 0);
+		// the defines and their declarations have to follow the #version line
+		core::stringc vertexShader(vsData, (u32)(versionEnd - vsData + 1));
+		if (variant == EMV_COMPACT)
+		{
+			// the shaders scale the positions from the unit box if COMPACT_VERTICES is defined
+			vertexShader += "#define COMPACT_VERTICES\n"
+				"uniform vec3 uPositionScale;\n"
+				"uniform vec3 uPositionOffset;\n";
+		}
+		else if (variant == EMV_SKINNING)
+		{
+			// the shaders call skinVertex() if SKINNING is defined
+			vertexShader += "#define SKINNING\n"
+				"attribute vec4 inJointIndices;\n"
+				"attribute vec4 inJointWeights;\n"
+				"uniform vec4 uJointMatrices[";
+			vertexShader += core::stringc(MAX_SKINNING_JOINTS * 3);
+			vertexShader += "];\n"
+				"void skinVertex(inout vec3 position, inout vec3 normal)\n"
+				"{\n"
+				"\tvec4 row0 = vec4(0.0);\n"
+				"\tvec4 row1 = vec4(0.0);\n"
+				"\tvec4 row2 = vec4(0.0);\n"
+				"\tfor (int i = 0; i < 4; ++i)\n"
+				"\t{\n"
+				"\t\tint joint = int(inJointIndices[i]) * 3;\n"
+				"\t\trow0 += inJointWeights[i] * uJointMatrices[joint];\n"
+				"\t\trow1 += inJointWeights[i] * uJointMatrices[joint + 1];\n"
+				"\t\trow2 += inJointWeights[i] * uJointMatrices[joint + 2];\n"
+				"\t}\n"
+				"\tfloat rest = 1.0 - dot(inJointWeights, vec4(1.0));\n"
+				"\trow0.x += rest;\n"
+				"\trow1.y += rest;\n"
+				"\trow2.z += rest;\n"
+				"\tvec4 p = vec4(position, 1.0);\n"
+				"\tposition = vec3(dot(row0, p), dot(row1, p), dot(row2, p));\n"
+				"\tnormal = vec3(dot(row0.xyz, normal), dot(row1.xyz, normal), dot(row2.xyz, normal));\n"
+				"}\n";
+		}
+		else if (variant == EMV_MORPHING)
+		{
+			// the shaders call morphVertex() if MORPHING is defined
+			vertexShader += "#define MORPHING\n"
+				"attribute vec3 inMorphPosition;\n"
+				"attribute vec3 inMorphNormal;\n"
+				"uniform float uMorphBlend;\n"
+				"void morphVertex(inout vec3 position, inout vec3 normal)\n"
+				"{\n"
+				"\tposition = mix(position, inMorphPosition, uMorphBlend);\n"
+				"\tnormal = mix(normal, inMorphNormal, uMorphBlend);\n"
+				"}\n";
+		}
+		vertexShader += versionEnd + 1;
 
-		VertexShader = OGLES2ShaderPath + "Reflection2Layer.vsh";
-		FragmentShader = OGLES2ShaderPath + "Reflection2Layer.fsh";
+		core::stringc fragmentShader(fsData, (u32)(fsVersionEnd - fsData + 1));
+		if (permutation & EMP_SPECIALIZED)
+		{
+			// the defines replace the uniforms of the same names, so the branches on them are resolved by the compiler
+			const u32 fog = (permutation & EMP_FOG_MASK) >> EMP_FOG_SHIFT;
+			fragmentShader += "#define uFogEnable ";
+			fragmentShader += fog ? "1\n" : "0\n";
+			fragmentShader += "#define uFogType ";
+			fragmentShader += core::stringc(fog ? fog - 1 : 0);
+			fragmentShader += "\n#define uTextureUsage0 ";
+			fragmentShader += (permutation & EMP_TEXTURE0) ? "1\n" : "0\n";
+			fragmentShader += "#define uTextureUsage1 ";
+			fragmentShader += (permutation & EMP_TEXTURE1) ? "1\n" : "0\n";
+			if (!(permutation & (EMP_ALPHA_TEST | EMP_ALPHA_TO_COVERAGE)))
+				fragmentShader += "#define NO_ALPHA_TEST\n";
+			if (permutation & EMP_ALPHA_TO_COVERAGE)
+			{
+				// the width of the coverage edge is taken from the derivatives of the alpha
+				fragmentShader += "#ifdef GL_OES_standard_derivatives\n"
+					"#extension GL_OES_standard_derivatives : enable\n"
+					"#endif\n"
+					"#define ALPHA_TO_COVERAGE\n";
+			}
+			if (permutation & EMP_WEIGHTED_TRANSPARENCY)
+			{
+				// the shaders call writeAccumulation() instead of writing gl_FragColor if WEIGHTED_TRANSPARENCY
+				// is defined. The weight falls off with the view depth, see McGuire and Bavoil, equation 9,
+				// with the terms clamped to stay within medium precision.
+				fragmentShader += "#ifdef GL_EXT_draw_buffers\n"
+					"#extension GL_EXT_draw_buffers : require\n"
+					"#endif\n"
+					"#define WEIGHTED_TRANSPARENCY\n"
+					"void writeAccumulation(mediump vec4 color)\n"
+					"{\n"
+					"\tmediump float alpha = clamp(color.a, 0.0, 1.0);\n"
+					"\tmediump float depth = 1.0 / gl_FragCoord.w;\n"
+					"\tmediump float near = min(depth / 5.0, 100.0);\n"
+					"\tmediump float far = min(depth / 200.0, 5.0);\n"
+					"\tfar = far * far * far;\n"
+					"\tmediump float weight = alpha * clamp(10.0 / (0.00001 + near * near + far * far), 0.01, 3000.0);\n"
+					"\tgl_FragData[0] = vec4(color.rgb * alpha * weight, alpha);\n"
+					"\tgl_FragData[1] = vec4(alpha * weight);\n"
+					"}\n";
+			}
+		}
+		fragmentShader += fsVersionEnd + 1;
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, TransparentReflection2LayerCB, EMT_TRANSPARENT_ALPHA_CHANNEL, 0);
+		IShaderConstantSetCallBack* callBack = createBuiltInCallBack(type);
+		s32 nr = -1;
+		COpenGL3MaterialRenderer* renderer = new COpenGL3MaterialRenderer(this, nr, vertexShader.c_str(), fragmentShader.c_str(),
+			callBack, BuiltInMaterials[type].BaseMaterial, 0, false, false);
+		callBack->drop();
 
-		VertexShader = OGLES2ShaderPath + "Solid.vsh";
-		FragmentShader = OGLES2ShaderPath + "OneTextureBlend.fsh";
+		delete[] vsData;
+		delete[] fsData;
 
-		addHighLevelShaderMaterialFromFiles(VertexShader, "main", EVST_VS_2_0, FragmentShader, "main", EPST_PS_2_0, "", "main",
-			EGST_GS_4_0, scene::EPT_TRIANGLES, scene::EPT_TRIANGLE_STRIP, 0, OneTextureBlendCB, EMT_ONETEXTURE_BLEND, 0);
+		if (nr < 0)
+		{
+			renderer->drop();
+			os::Printer::log("Could not create a variant of a built-in material", sBuiltInMaterialTypeNames[type], ELL_WARNING);
+			VariantMaterialFailed[variant][type][permutation] = true;
+			return 0;
+		}
 
-		// Drop callbacks.
+		VariantMaterialRenderers[variant][type][permutation] = renderer;
+		return renderer;
+	}
 
-		SolidCB->drop();
-		Solid2LayerCB->drop();
-		LightmapCB->drop();
-		LightmapAddCB->drop();
-		LightmapM2CB->drop();
-		LightmapM4CB->drop();
-		LightmapLightingCB->drop();
-		LightmapLightingM2CB->drop();
-		LightmapLightingM4CB->drop();
-		DetailMapCB->drop();
-		SphereMapCB->drop();
-		Reflection2LayerCB->drop();
-		TransparentAddColorCB->drop();
-		TransparentAlphaChannelCB->drop();
-		TransparentAlphaChannelRefCB->drop();
-		TransparentVertexAlphaCB->drop();
-		TransparentReflection2LayerCB->drop();
-		OneTextureBlendCB->drop();
+	u32 COpenGL3DriverBase::getMaterialPermutation(const SMaterial& material) const
+	{
+		if (static_cast<u32>(material.MaterialType) > EMT_ONETEXTURE_BLEND)
+			return EMP_GENERIC;
+
+		// fields a shader doesn't read would only compile the same program again
+		const u32 layers = BuiltInMaterials[material.MaterialType].TextureLayers;
+
+		u32 permutation = EMP_SPECIALIZED;
+		if (material.FogEnable)
+			permutation |= ((u32)FogType + 1) << EMP_FOG_SHIFT;
+		if (material.TextureLayer[0].Texture)
+			permutation |= EMP_TEXTURE0;
+		if (layers > 1 && material.TextureLayer[1].Texture)
+			permutation |= EMP_TEXTURE1;
+		// a reference of 0 never discards, with alpha to coverage no reference discards
+		if (material.MaterialType == EMT_TRANSPARENT_ALPHA_CHANNEL_REF && usesAlphaToCoverage(material))
+			permutation |= EMP_ALPHA_TO_COVERAGE;
+		else if (BuiltInMaterials[material.MaterialType].AlphaTest && material.MaterialTypeParam > 0.f)
+			permutation |= EMP_ALPHA_TEST;
+		if (TransparencyAccumulating && canAccumulateTransparency(material))
+			permutation |= EMP_WEIGHTED_TRANSPARENCY;
+
+		return permutation;
+	}
 
-		// Create 2D material renderers
+	IMaterialRenderer* COpenGL3DriverBase::getActiveMaterialRenderer(E_MATERIAL_TYPE type, E_MATERIAL_VARIANT variant, u32 permutation)
+	{
+		if (variant != EMV_NONE || permutation != EMP_GENERIC)
+		{
+			COpenGL3MaterialRenderer* renderer = getMaterialVariantRenderer(type, variant, permutation);
+			if (renderer)
+				return renderer;
 
-		c8* vs2DData = 0;
-		c8* fs2DData = 0;
-		loadShaderData(io::path("Renderer2D.vsh"), io::path("Renderer2D.fsh"), &vs2DData, &fs2DData);
-		MaterialRenderer2DTexture = new COpenGL3Renderer2D(vs2DData, fs2DData, this, true);
-		delete[] vs2DData;
-		delete[] fs2DData;
-		vs2DData = 0;
-		fs2DData = 0;
+			// permutations which don't compile fall back to branching on the uniforms
+			if (variant != EMV_NONE && permutation != EMP_GENERIC)
+			{
+				renderer = getMaterialVariantRenderer(type, variant);
+				if (renderer)
+					return renderer;
+			}
+		}
 
-		loadShaderData(io::path("Renderer2D.vsh"), io::path("Renderer2D_noTex.fsh"), &vs2DData, &fs2DData);
-		MaterialRenderer2DNoTexture = new COpenGL3Renderer2D(vs2DData, fs2DData, this, false);
-		delete[] vs2DData;
-		delete[] fs2DData;
+		return MaterialRenderers[type].Renderer;
 	}
 
 	bool COpenGL3DriverBase::setMaterialTexture(irr::u32 layerIdx, const irr::video::ITexture* texture)
 	{
 		Material.TextureLayer[layerIdx].Texture = const_cast<ITexture*>(texture); // function uses const-pointer for texture because all draw functions use const-pointers already
+		++MaterialRevision;
 		return CacheHandler->getTextureCache().set(0, texture);
 	}
 
@@ -481,23 +1161,181 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		CNullDriver::beginScene(clearFlag, clearColor, clearDepth, clearStencil, videoData, sourceRect);
 
 		if (ContextManager)
+		{
 			ContextManager->activateContext(videoData, true);
 
+			if (beginFrameDamage(ContextManager->getBufferAge()))
+				ContextManager->setDamageRegion(&DamageRegion, 1);
+		}
+		setScissor(0);
+
+		if (TimerQuerySupported && FPSCounter.isFrameTimeHistoryEnabled() && !GPUFrameBeginQuery)
+		{
+			GPUFrameBeginQuery = allocateTimerQuery();
+			GL.QueryCounter(GPUFrameBeginQuery, GL.TIMESTAMP);
+		}
+
 		clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
 
 		return true;
 	}
 
-	bool COpenGL3DriverBase::endScene()
+	void COpenGL3DriverBase::setScissor(const core::rect<s32>* clipRect)
 	{
-		CNullDriver::endScene();
+		core::rect<s32> rect;
+		if (getScissorRect(clipRect, rect))
+		{
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(rect.UpperLeftCorner.X, getCurrentRenderTargetSize().Height - rect.LowerRightCorner.Y,
+				core::max_(rect.getWidth(), 0), core::max_(rect.getHeight(), 0));
+		}
+		else
+			glDisable(GL_SCISSOR_TEST);
+	}
 
+	void COpenGL3DriverBase::discardFrameBuffers()
+	{
+		if (CurrentRenderTarget)
+		{
+			static_cast<COpenGL3RenderTarget*>(CurrentRenderTarget)->resolve();
+		}
+		else
+		{
+			// the screen only presents its color
+			const GLenum attachments[2] = { GL_DEPTH, GL_STENCIL };
+			CacheHandler->setFBO(0);
+			irrGlInvalidateFramebuffer(GL_FRAMEBUFFER, 2, attachments);
+		}
+	}
+
+	bool COpenGL3DriverBase::endScene()
+	{
+		flush2DBatch();
+		flush3DLines();
+		processTextureUploads();
+		processMipStreaming();
+		TextureResidency->update();
+		processScreenShotReadbacks();
+
+		CNullDriver::endScene();
+
+		// before the depth of the screen is discarded
+		if (GPUCulling)
+			GPUCulling->endFrame(!CurrentRenderTarget, getCurrentRenderTargetSize());
+
+		discardFrameBuffers();
+
+		if (ErrorCheckMode != EECM_NONE)
+			reportDebugMessages();
+
+		finishStreamFrame();
+		finishGPUTimerFrame();
+
+		const u64 swapBeginNs = os::Timer::getRealTimeNs();
 		glFlush();
 
+		bool status = false;
 		if (ContextManager)
-			return ContextManager->swapBuffers();
+			status = DamageRegionActive ? ContextManager->swapBuffersWithDamage(&DamageRegion, 1) : ContextManager->swapBuffers();
 
-		return false;
+		limitFramesInFlight();
+		registerSwapTime(swapBeginNs);
+
+		endFrameDamage();
+		setScissor(0);
+
+		return status;
+	}
+
+	bool COpenGL3DriverBase::setSwapInterval(s32 interval)
+	{
+		return ContextManager && ContextManager->setSwapInterval(interval);
+	}
+
+	bool COpenGL3DriverBase::setMaxFramesInFlight(u32 frames)
+	{
+		if (!GL.FenceSync || !GL.ClientWaitSync || !GL.DeleteSync)
+			return false;
+
+		MaxFramesInFlight = frames;
+		return true;
+	}
+
+	bool COpenGL3DriverBase::setErrorCheckMode(E_ERROR_CHECK_MODE mode)
+	{
+#ifdef _IRR_OPENGL_SYNC_ERROR_CHECKS_
+		const bool errorQueries = true;
+#else
+		const bool errorQueries = false;
+#endif
+		if (mode != EECM_NONE && !DebugOutputSupported && !(mode == EECM_SYNCHRONOUS && errorQueries))
+			return false;
+
+		ErrorCheckMode = mode;
+		if (DebugOutputSupported)
+		{
+			if (mode == EECM_NONE)
+				glDisable(GL.DEBUG_OUTPUT);
+			else
+				glEnable(GL.DEBUG_OUTPUT);
+			if (mode == EECM_SYNCHRONOUS)
+				glEnable(GL.DEBUG_OUTPUT_SYNCHRONOUS);
+			else
+				glDisable(GL.DEBUG_OUTPUT_SYNCHRONOUS);
+		}
+		return true;
+	}
+
+	void COpenGL3DriverBase::setDebugMessageLevel(ELOG_LEVEL minLevel)
+	{
+		DebugMessageLevel = minLevel;
+		if (!DebugOutputSupported)
+			return;
+
+		// indexed by the log level they map to
+		const GLenum severities[] = {GL.DEBUG_SEVERITY_NOTIFICATION, GL.DEBUG_SEVERITY_LOW,
+			GL.DEBUG_SEVERITY_MEDIUM, GL.DEBUG_SEVERITY_HIGH};
+		for (u32 i = 0; i < 4; ++i)
+			GL.DebugMessageControl(GL.DONT_CARE, GL.DONT_CARE, severities[i], 0, nullptr,
+				i >= (u32)minLevel ? GL_TRUE : GL_FALSE);
+	}
+
+	void COpenGL3DriverBase::setDebugMessageEnabled(u32 id, bool enabled)
+	{
+		if (!DebugOutputSupported)
+			return;
+
+		// IDs can only be selected together with a source and type
+		const GLenum sources[] = {GL.DEBUG_SOURCE_API, GL.DEBUG_SOURCE_WINDOW_SYSTEM, GL.DEBUG_SOURCE_SHADER_COMPILER,
+			GL.DEBUG_SOURCE_THIRD_PARTY, GL.DEBUG_SOURCE_APPLICATION, GL.DEBUG_SOURCE_OTHER};
+		const GLenum types[] = {GL.DEBUG_TYPE_ERROR, GL.DEBUG_TYPE_DEPRECATED_BEHAVIOR, GL.DEBUG_TYPE_UNDEFINED_BEHAVIOR,
+			GL.DEBUG_TYPE_PORTABILITY, GL.DEBUG_TYPE_PERFORMANCE, GL.DEBUG_TYPE_OTHER,
+			GL.DEBUG_TYPE_MARKER, GL.DEBUG_TYPE_PUSH_GROUP, GL.DEBUG_TYPE_POP_GROUP};
+		const GLuint glId = id;
+		for (GLenum source : sources)
+			for (GLenum type : types)
+				GL.DebugMessageControl(source, type, GL.DONT_CARE, 1, &glId, enabled ? GL_TRUE : GL_FALSE);
+	}
+
+	void COpenGL3DriverBase::limitFramesInFlight()
+	{
+		if (!MaxFramesInFlight)
+		{
+			for (auto fence : FrameFences)
+				GL.DeleteSync(fence);
+			FrameFences.clear();
+			return;
+		}
+
+		// the fence follows the swap, so it signals once the GPU finished the frame
+		FrameFences.push_back(GL.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+		while (FrameFences.size() > MaxFramesInFlight)
+		{
+			GL.ClientWaitSync(FrameFences.front(), GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+			GL.DeleteSync(FrameFences.front());
+			FrameFences.pop_front();
+		}
 	}
 
 
@@ -511,673 +1349,2576 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	//! sets transformation
 	void COpenGL3DriverBase::setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat)
 	{
+		// queued lines are in world space already
+		if (state == ETS_VIEW || state == ETS_PROJECTION)
+			flush3DLines();
+
 		Matrices[state] = mat;
 		Transformation3DChanged = true;
+
+		switch (state)
+		{
+		case ETS_VIEW:
+			DerivedMatricesDirty = (1 << EDM_COUNT) - 1;
+			break;
+		case ETS_WORLD:
+			DerivedMatricesDirty |= (1 << EDM_WORLD_VIEW) | (1 << EDM_WORLD_VIEW_PROJECTION) | (1 << EDM_NORMAL);
+			break;
+		case ETS_PROJECTION:
+			DerivedMatricesDirty |= (1 << EDM_VIEW_PROJECTION) | (1 << EDM_WORLD_VIEW_PROJECTION);
+			break;
+		default:
+			break;
+		}
+
+		if (UniformBlocksSupported && state <= ETS_PROJECTION)
+		{
+			if (state != ETS_WORLD)
+				BuiltInUniformBlockDirty[EUB_FRAME] = true;
+			BuiltInUniformBlockDirty[EUB_DRAW] = true;
+		}
 	}
 
 
-	bool COpenGL3DriverBase::updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer)
+	//! Inverts a matrix whose last column is 0, 0, 0, 1, like all transformations of the scene
+	static bool getInverseAffine(const core::matrix4& m, core::matrix4& out)
 	{
-		if (!HWBuffer)
+		// inverse of the upper 3x3 part from its cofactors
+		const f32 c0 = m[5] * m[10] - m[6] * m[9];
+		const f32 c1 = m[6] * m[8] - m[4] * m[10];
+		const f32 c2 = m[4] * m[9] - m[5] * m[8];
+		const f32 det = m[0] * c0 + m[1] * c1 + m[2] * c2;
+		if (core::iszero(det, FLT_MIN))
 			return false;
 
-		const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
-		const void* vertices = mb->getVertices();
-		const u32 vertexCount = mb->getVertexCount();
-		const E_VERTEX_TYPE vType = mb->getVertexType();
-		const u32 vertexSize = getVertexPitchFromType(vType);
+		const f32 inv = 1.f / det;
+		out[0] = c0 * inv;
+		out[1] = (m[2] * m[9] - m[1] * m[10]) * inv;
+		out[2] = (m[1] * m[6] - m[2] * m[5]) * inv;
+		out[3] = 0.f;
+		out[4] = c1 * inv;
+		out[5] = (m[0] * m[10] - m[2] * m[8]) * inv;
+		out[6] = (m[2] * m[4] - m[0] * m[6]) * inv;
+		out[7] = 0.f;
+		out[8] = c2 * inv;
+		out[9] = (m[1] * m[8] - m[0] * m[9]) * inv;
+		out[10] = (m[0] * m[5] - m[1] * m[4]) * inv;
+		out[11] = 0.f;
+		out[12] = -(m[12] * out[0] + m[13] * out[4] + m[14] * out[8]);
+		out[13] = -(m[12] * out[1] + m[13] * out[5] + m[14] * out[9]);
+		out[14] = -(m[12] * out[2] + m[13] * out[6] + m[14] * out[10]);
+		out[15] = 1.f;
+		return true;
+	}
 
-		const void *buffer = vertices;
-		size_t bufferSize = vertexSize * vertexCount;
 
-		//get or create buffer
-		bool newBuffer = false;
-		if (!HWBuffer->vbo_verticesID)
+	//! Returns a product of the transformations
+	const core::matrix4& COpenGL3DriverBase::getDerivedMatrix(E_DERIVED_MATRIX matrix)
+	{
+		if (!(DerivedMatricesDirty & (1 << matrix)))
+			return DerivedMatrices[matrix];
+
+		switch (matrix)
 		{
-			glGenBuffers(1, &HWBuffer->vbo_verticesID);
-			if (!HWBuffer->vbo_verticesID) return false;
-			newBuffer = true;
-		}
-		else if (HWBuffer->vbo_verticesSize < bufferSize)
+		case EDM_VIEW_PROJECTION:
+			DerivedMatrices[matrix] = Matrices[ETS_PROJECTION] * Matrices[ETS_VIEW];
+			break;
+		case EDM_WORLD_VIEW:
+			DerivedMatrices[matrix] = Matrices[ETS_VIEW] * Matrices[ETS_WORLD];
+			break;
+		case EDM_WORLD_VIEW_PROJECTION:
+			DerivedMatrices[matrix] = getDerivedMatrix(EDM_VIEW_PROJECTION) * Matrices[ETS_WORLD];
+			break;
+		case EDM_NORMAL:
 		{
-			newBuffer = true;
+			const core::matrix4& worldView = getDerivedMatrix(EDM_WORLD_VIEW);
+			core::matrix4 inverse(core::matrix4::EM4CONST_NOTHING);
+			const f32* m = worldView.pointer();
+			if (m[3] != 0.f || m[7] != 0.f || m[11] != 0.f || m[15] != 1.f || !getInverseAffine(worldView, inverse))
+			{
+				inverse = worldView;
+				inverse.makeInverse();
+			}
+			inverse.getTransposed(DerivedMatrices[matrix]);
+			break;
+		}
+		default:
+			break;
 		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
+		DerivedMatricesDirty &= ~(1 << matrix);
+		return DerivedMatrices[matrix];
+	}
 
-		// copy data to graphics card
-		if (!newBuffer)
-			glBufferSubData(GL_ARRAY_BUFFER, 0, bufferSize, buffer);
+
+	void COpenGL3DriverBase::setFog(SColor color, E_FOG_TYPE fogType, f32 start, f32 end,
+			f32 density, bool pixelFog, bool rangeFog)
+	{
+		flush3DLines();
+		CNullDriver::setFog(color, fogType, start, end, density, pixelFog, rangeFog);
+
+		if (UniformBlocksSupported)
+			BuiltInUniformBlockDirty[EUB_FRAME] = true;
+	}
+
+
+	void COpenGL3DriverBase::setAmbientLight(const SColorf& color)
+	{
+		CNullDriver::setAmbientLight(color);
+
+		if (UniformBlocksSupported)
+			BuiltInUniformBlockDirty[EUB_FRAME] = true;
+	}
+
+
+	void COpenGL3DriverBase::updateBuiltInUniformBlock(E_BUILT_IN_UNIFORM_BLOCK block)
+	{
+		if (!UniformBlocksSupported || !BuiltInUniformBlockDirty[block])
+			return;
+
+		const GLuint buffer = BuiltInUniformBlockBuffers[block];
+		if (!Feature.DirectStateAccess)
+			glBindBuffer(GL.UNIFORM_BUFFER, buffer);
+
+		if (block == EUB_FRAME)
+		{
+			SFrameUniformBlock data;
+			const core::matrix4& viewProjection = getDerivedMatrix(EDM_VIEW_PROJECTION);
+			const SColorf fogColor(FogColor);
+
+			memcpy(data.View, Matrices[ETS_VIEW].pointer(), sizeof(data.View));
+			memcpy(data.Projection, Matrices[ETS_PROJECTION].pointer(), sizeof(data.Projection));
+			memcpy(data.ViewProjection, viewProjection.pointer(), sizeof(data.ViewProjection));
+			data.FogColor[0] = fogColor.r;
+			data.FogColor[1] = fogColor.g;
+			data.FogColor[2] = fogColor.b;
+			data.FogColor[3] = fogColor.a;
+			data.FogParams[0] = FogStart;
+			data.FogParams[1] = FogEnd;
+			data.FogParams[2] = FogDensity;
+			data.FogParams[3] = (f32)FogType;
+			data.AmbientLight[0] = AmbientLight.r;
+			data.AmbientLight[1] = AmbientLight.g;
+			data.AmbientLight[2] = AmbientLight.b;
+			data.AmbientLight[3] = AmbientLight.a;
+
+			if (Feature.DirectStateAccess)
+				GL.NamedBufferSubData(buffer, 0, sizeof(data), &data);
+			else
+				glBufferSubData(GL.UNIFORM_BUFFER, 0, sizeof(data), &data);
+			countBufferUpload(sizeof(data), false);
+		}
 		else
 		{
-			HWBuffer->vbo_verticesSize = bufferSize;
+			SDrawUniformBlock data;
+			const core::matrix4& worldView = getDerivedMatrix(EDM_WORLD_VIEW);
+			const core::matrix4& worldViewProjection = getDerivedMatrix(EDM_WORLD_VIEW_PROJECTION);
 
-			if (HWBuffer->Mapped_Vertex == scene::EHM_STATIC)
-				glBufferData(GL_ARRAY_BUFFER, bufferSize, buffer, GL_STATIC_DRAW);
+			memcpy(data.World, Matrices[ETS_WORLD].pointer(), sizeof(data.World));
+			memcpy(data.WorldView, worldView.pointer(), sizeof(data.WorldView));
+			memcpy(data.WorldViewProjection, worldViewProjection.pointer(), sizeof(data.WorldViewProjection));
+
+			// changes with every draw, so orphan the storage instead of waiting for the previous draw
+			if (Feature.DirectStateAccess)
+				GL.NamedBufferData(buffer, sizeof(data), &data, GL_STREAM_DRAW);
 			else
-				glBufferData(GL_ARRAY_BUFFER, bufferSize, buffer, GL_DYNAMIC_DRAW);
+				glBufferData(GL.UNIFORM_BUFFER, sizeof(data), &data, GL_STREAM_DRAW);
+			countBufferUpload(sizeof(data), true);
 		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		if (!Feature.DirectStateAccess)
+			glBindBuffer(GL.UNIFORM_BUFFER, 0);
+		BuiltInUniformBlockDirty[block] = false;
+	}
 
-		return (!testGLError(__LINE__));
+
+	// small helper function to create vertex buffer object adress offsets
+	static inline u8* buffer_offset(const long offset)
+	{
+		return ((u8*)0 + offset);
 	}
 
 
-	bool COpenGL3DriverBase::updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffer)
+	bool COpenGL3DriverBase::updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer, u32 changedID)
 	{
 		if (!HWBuffer)
 			return false;
 
 		const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+		E_VERTEX_TYPE vType = mb->getVertexType();
+		const void* vertices = mb->getVertices();
+		const u32 vertexCount = mb->getVertexCount();
+
+		if (vType == EVT_STANDARD && vertexCount && mb->getCompactVertices() && queryFeature(EVDF_COMPACT_VERTICES))
+		{
+			// the box is taken from the vertices, the one of the buffer may be outdated
+			const S3DVertex* standard = static_cast<const S3DVertex*>(vertices);
+			core::aabbox3df box(standard[0].Pos);
+			for (u32 i = 1; i < vertexCount; ++i)
+				box.addInternalPoint(standard[i].Pos);
+
+			const core::vector3df extent = box.getExtent();
+			const core::vector3df invExtent(extent.X > 0.f ? 1.f / extent.X : 0.f,
+				extent.Y > 0.f ? 1.f / extent.Y : 0.f, extent.Z > 0.f ? 1.f / extent.Z : 0.f);
+
+			CompactVertexData.set_used(vertexCount);
+			for (u32 i = 0; i < vertexCount; ++i)
+				CompactVertexData[i] = S3DVertexCompact(standard[i], box.MinEdge, invExtent);
+
+			vType = EVT_COMPACT;
+			vertices = CompactVertexData.const_pointer();
+			HWBuffer->compactOffset = box.MinEdge;
+			HWBuffer->compactScale = extent;
+		}
 
-		const void* indices = mb->getIndices();
-		u32 indexCount = mb->getIndexCount();
+		const u32 pitch = getVertexPitchFromType(vType);
+		u32 bufferSize = pitch * vertexCount;
 
-		GLenum indexSize;
-		switch (mb->getIndexType())
+		// one stream per attribute, all positions first
+		const bool separateStreams = vType != EVT_COMPACT && vertexCount && mb->getSeparateVertexStreams();
+		if (separateStreams)
 		{
-			case(EIT_16BIT):
+			const VertexType &desc = getVertexTypeDescription(vType);
+			bufferSize = 0;
+			for (auto &attr : desc)
+				bufferSize += getAttributeStreamSize(attr, vertexCount);
+
+			VertexStreamData.set_used(bufferSize);
+			u8* stream = VertexStreamData.pointer();
+			for (auto &attr : desc)
 			{
-				indexSize = sizeof(u16);
-				break;
+				const u32 size = getAttributeSize(attr);
+				const u8* src = static_cast<const u8*>(vertices) + attr.Offset;
+				for (u32 i = 0; i < vertexCount; ++i)
+					memcpy(stream + i * size, src + i * pitch, size);
+				stream += getAttributeStreamSize(attr, vertexCount);
 			}
-			case(EIT_32BIT):
+			vertices = VertexStreamData.const_pointer();
+		}
+
+		// compact vertices are quantized in a box which may have changed,
+		// and the streams move when the vertex count changes
+		u32 first = 0;
+		u32 count = vertexCount;
+		if (vType == EVT_COMPACT || separateStreams || HWBuffer->streamVertexCount || vType != HWBuffer->vertexType ||
+				!mb->getDirtyRange(changedID, first, count, scene::EBT_VERTEX) || first >= vertexCount)
+		{
+			first = 0;
+			count = vertexCount;
+		}
+		count = core::min_(count, vertexCount - first);
+		const u32 dirtyOffset = separateStreams ? 0 : first * pitch;
+		const u32 dirtySize = separateStreams ? bufferSize : count * pitch;
+
+		const u32 oldID = HWBuffer->vbo_verticesID;
+		const u32 oldOffset = HWBuffer->vbo_verticesOffset;
+
+		const bool uploaded = updateBufferData(GL_ARRAY_BUFFER, vType, HWBuffer->Mapped_Vertex, vertices, bufferSize,
+				dirtyOffset, dirtySize,
+				HWBuffer->vbo_verticesID, HWBuffer->vbo_verticesSize, HWBuffer->vbo_verticesOffset, HWBuffer->vertexArena);
+
+		// large meshes would keep their scratch copy otherwise
+		if (vType == EVT_COMPACT && CompactVertexData.allocated_size() > 65536)
+			CompactVertexData.clear();
+		if (separateStreams && VertexStreamData.allocated_size() > 65536 * sizeof(S3DVertex))
+			VertexStreamData.clear();
+
+		if (!uploaded)
+			return false;
+
+		// the attribute pointers recorded in the VAO refer to the old location or layout
+		if (HWBuffer->vbo_verticesID != oldID || HWBuffer->vbo_verticesOffset != oldOffset ||
+				separateStreams || HWBuffer->streamVertexCount)
+			deleteVertexArrayObject(HWBuffer);
+
+		HWBuffer->vertexType = vType;
+		HWBuffer->streamVertexCount = separateStreams ? vertexCount : 0;
+
+		FrameStats.VerticesUploaded += count;
+
+		return true;
+	}
+
+
+	bool COpenGL3DriverBase::updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffer, u32 changedID)
+	{
+		if (!HWBuffer)
+			return false;
+
+		const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+		const E_INDEX_TYPE iType = mb->getIndexType();
+		if (iType != EIT_16BIT && iType != EIT_32BIT)
+			return false;
+
+		const u32 indexSize = getIndexSize(iType);
+		const u32 indexCount = mb->getIndexCount();
+		const u32 bufferSize = indexSize * indexCount;
+
+		u32 first = 0;
+		u32 count = indexCount;
+		if (!mb->getDirtyRange(changedID, first, count, scene::EBT_INDEX) || first >= indexCount)
+		{
+			first = 0;
+			count = indexCount;
+		}
+		count = core::min_(count, indexCount - first);
+
+		// the element array binding is recorded in the VAO, the offset is passed at draw time
+		const u32 oldID = HWBuffer->vbo_indicesID;
+
+		if (!updateBufferData(GL_ELEMENT_ARRAY_BUFFER, iType, HWBuffer->Mapped_Index, mb->getIndices(), bufferSize,
+				first * indexSize, count * indexSize, HWBuffer->vbo_indicesID, HWBuffer->vbo_indicesSize, HWBuffer->vbo_indicesOffset, HWBuffer->indexArena))
+			return false;
+
+		if (HWBuffer->vbo_indicesID != oldID)
+			deleteVertexArrayObject(HWBuffer);
+
+		return true;
+	}
+
+
+	bool COpenGL3DriverBase::updateBufferData(GLenum target, u32 arenaKey, scene::E_HARDWARE_MAPPING mapping,
+			const void* data, u32 size, u32 dirtyOffset, u32 dirtySize,
+			u32 &id, u32 &capacity, u32 &offset, SBufferArena *&arena)
+	{
+		const bool useArena = mapping == scene::EHM_STATIC && size && size <= BufferArenaMaxRange;
+		const u8* bytes = static_cast<const u8*>(data);
+
+		// arena ranges can't grow in place
+		if (arena && (!useArena || capacity < size))
+		{
+			releaseArenaRange(arena, offset, capacity);
+			arena = 0;
+			id = 0;
+			capacity = 0;
+			offset = 0;
+		}
+
+		if (useArena)
+		{
+			if (!arena)
 			{
-				indexSize = sizeof(u32);
-				break;
+				if (id)
+				{
+					releaseBuffer(id);
+					id = 0;
+				}
+
+				capacity = (size + 15) & ~15u;
+				arena = allocateArenaRange(target, arenaKey, capacity, offset);
+				if (!arena)
+				{
+					capacity = 0;
+					return false;
+				}
+				id = arena->ID;
+
+				// a new range holds nothing yet
+				dirtyOffset = 0;
+				dirtySize = size;
 			}
-			default:
+
+			if (Feature.DirectStateAccess)
+				GL.NamedBufferSubData(id, offset + dirtyOffset, dirtySize, bytes + dirtyOffset);
+			else
 			{
-				return false;
+				glBindBuffer(target, id);
+				glBufferSubData(target, offset + dirtyOffset, dirtySize, bytes + dirtyOffset);
+				glBindBuffer(target, 0);
 			}
+			countBufferUpload(dirtySize, false);
+
+			return (!testGLError(__LINE__));
 		}
 
 		//get or create buffer
 		bool newBuffer = false;
-		if (!HWBuffer->vbo_indicesID)
+		if (!id)
 		{
-			glGenBuffers(1, &HWBuffer->vbo_indicesID);
-			if (!HWBuffer->vbo_indicesID) return false;
+			id = genBuffer();
+			if (!id) return false;
 			newBuffer = true;
 		}
-		else if (HWBuffer->vbo_indicesSize < indexCount*indexSize)
+		else if (capacity < size)
 		{
 			newBuffer = true;
 		}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
+		// updates of existing buffers don't need a binding with direct state access
+		const bool bind = newBuffer || !Feature.DirectStateAccess;
+		if (bind)
+			glBindBuffer(target, id);
 
 		// copy data to graphics card
 		if (!newBuffer)
-			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexCount * indexSize, indices);
+			writeBufferRange(target, id, mapping, dirtyOffset, dirtySize, bytes + dirtyOffset, dirtySize == capacity);
 		else
 		{
-			HWBuffer->vbo_indicesSize = indexCount * indexSize;
+			capacity = size;
 
-			if (HWBuffer->Mapped_Index == scene::EHM_STATIC)
-				glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indices, GL_STATIC_DRAW);
+			if (mapping == scene::EHM_STATIC)
+				glBufferData(target, size, data, GL_STATIC_DRAW);
 			else
-				glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indices, GL_DYNAMIC_DRAW);
+				glBufferData(target, size, data, GL_DYNAMIC_DRAW);
 		}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		if (bind)
+			glBindBuffer(target, 0);
+		countBufferUpload(newBuffer ? size : dirtySize, newBuffer);
 
 		return (!testGLError(__LINE__));
 	}
 
 
-	//! updates hardware buffer if needed
-	bool COpenGL3DriverBase::updateHardwareBuffer(SHWBufferLink *HWBuffer)
+	void COpenGL3DriverBase::writeBufferRange(GLenum target, GLuint id, scene::E_HARDWARE_MAPPING mapping,
+			u32 offset, u32 size, const void* data, bool wholeBuffer)
 	{
-		if (!HWBuffer)
-			return false;
-
-		if (HWBuffer->Mapped_Vertex != scene::EHM_NEVER)
-		{
-			if (HWBuffer->ChangedID_Vertex != HWBuffer->MeshBuffer->getChangedID_Vertex()
-				|| !static_cast<SHWBufferLink_opengl*>(HWBuffer)->vbo_verticesID)
-			{
-
-				HWBuffer->ChangedID_Vertex = HWBuffer->MeshBuffer->getChangedID_Vertex();
-
-				if (!updateVertexHardwareBuffer(static_cast<SHWBufferLink_opengl*>(HWBuffer)))
-					return false;
-			}
-		}
-
-		if (HWBuffer->Mapped_Index != scene::EHM_NEVER)
+		// Mapping an invalidated range spares the driver its staging copy of large updates,
+		// while static buffers are rarely written and small writes don't pay for the mapping.
+		if (BufferMapRangeSupported && mapping != scene::EHM_STATIC && size >= BufferMapRangeMinSize)
 		{
-			if (HWBuffer->ChangedID_Index != HWBuffer->MeshBuffer->getChangedID_Index()
-				|| !static_cast<SHWBufferLink_opengl*>(HWBuffer)->vbo_indicesID)
+			const GLbitfield flags = GL_MAP_WRITE_BIT |
+				(wholeBuffer ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT);
+			void* dst = Feature.DirectStateAccess ? GL.MapNamedBufferRange(id, offset, size, flags) :
+				GL.MapBufferRange(target, offset, size, flags);
+			if (dst)
 			{
-
-				HWBuffer->ChangedID_Index = HWBuffer->MeshBuffer->getChangedID_Index();
-
-				if (!updateIndexHardwareBuffer((SHWBufferLink_opengl*)HWBuffer))
-					return false;
+				memcpy(dst, data, size);
+				// the contents are undefined if unmapping fails, so they are written again
+				if (Feature.DirectStateAccess ? GL.UnmapNamedBuffer(id) : GL.UnmapBuffer(target))
+					return;
 			}
 		}
 
-		return true;
+		if (Feature.DirectStateAccess)
+			GL.NamedBufferSubData(id, offset, size, data);
+		else
+			glBufferSubData(target, offset, size, data);
 	}
 
 
-	//! Create hardware buffer from meshbuffer
-	COpenGL3DriverBase::SHWBufferLink *COpenGL3DriverBase::createHardwareBuffer(const scene::IMeshBuffer* mb)
+	bool COpenGL3DriverBase::SBufferArena::allocate(u32 size, u32 &offset)
 	{
-		if (!mb || (mb->getHardwareMappingHint_Index() == scene::EHM_NEVER && mb->getHardwareMappingHint_Vertex() == scene::EHM_NEVER))
-			return 0;
-
-		SHWBufferLink_opengl *HWBuffer = new SHWBufferLink_opengl(mb);
-
-		//add to map
-		HWBuffer->listPosition = HWBufferList.insert(HWBufferList.end(), HWBuffer);
-
-		HWBuffer->ChangedID_Vertex = HWBuffer->MeshBuffer->getChangedID_Vertex();
-		HWBuffer->ChangedID_Index = HWBuffer->MeshBuffer->getChangedID_Index();
-		HWBuffer->Mapped_Vertex = mb->getHardwareMappingHint_Vertex();
-		HWBuffer->Mapped_Index = mb->getHardwareMappingHint_Index();
-		HWBuffer->vbo_verticesID = 0;
-		HWBuffer->vbo_indicesID = 0;
-		HWBuffer->vbo_verticesSize = 0;
-		HWBuffer->vbo_indicesSize = 0;
-
-		if (!updateHardwareBuffer(HWBuffer))
+		for (auto it = Free.begin(); it != Free.end(); ++it)
 		{
-			deleteHardwareBuffer(HWBuffer);
-			return 0;
-		}
+			if (it->Size < size)
+				continue;
 
-		return HWBuffer;
+			offset = it->Offset;
+			it->Offset += size;
+			it->Size -= size;
+			if (!it->Size)
+				Free.erase(it);
+			Used += size;
+			return true;
+		}
+		return false;
 	}
 
 
-	void COpenGL3DriverBase::deleteHardwareBuffer(SHWBufferLink *_HWBuffer)
+	void COpenGL3DriverBase::SBufferArena::release(u32 offset, u32 size)
 	{
-		if (!_HWBuffer)
-			return;
+		auto it = std::lower_bound(Free.begin(), Free.end(), offset,
+			[](const SRange &range, u32 o) { return range.Offset < o; });
 
-		SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl*>(_HWBuffer);
-		if (HWBuffer->vbo_verticesID)
+		if (it != Free.end() && offset + size == it->Offset)
 		{
-			glDeleteBuffers(1, &HWBuffer->vbo_verticesID);
-			HWBuffer->vbo_verticesID = 0;
+			it->Offset = offset;
+			it->Size += size;
 		}
-		if (HWBuffer->vbo_indicesID)
+		else
 		{
-			glDeleteBuffers(1, &HWBuffer->vbo_indicesID);
-			HWBuffer->vbo_indicesID = 0;
+			it = Free.insert(it, SRange{offset, size});
 		}
 
-		CNullDriver::deleteHardwareBuffer(_HWBuffer);
+		if (it != Free.begin())
+		{
+			auto prev = it - 1;
+			if (prev->Offset + prev->Size == it->Offset)
+			{
+				prev->Size += it->Size;
+				Free.erase(it);
+			}
+		}
+
+		Used -= size;
 	}
 
 
-	//! Draw hardware buffer
-	void COpenGL3DriverBase::drawHardwareBuffer(SHWBufferLink *_HWBuffer)
+	GLuint COpenGL3DriverBase::genBuffer()
 	{
-		if (!_HWBuffer)
-			return;
-
-		SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl*>(_HWBuffer);
-
-		updateHardwareBuffer(HWBuffer); //check if update is needed
+		GLuint id = 0;
+		if (!FreeBufferNames.empty())
+		{
+			id = FreeBufferNames.back();
+			FreeBufferNames.pop_back();
+		}
+		else
+			glGenBuffers(1, &id);
+		return id;
+	}
 
-		const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
-		const void *vertices = mb->getVertices();
-		const void *indexList = mb->getIndices();
 
-		if (HWBuffer->Mapped_Vertex != scene::EHM_NEVER)
+	void COpenGL3DriverBase::releaseBuffer(GLuint id)
+	{
+		if (FreeBufferNames.size() >= FreeBufferNamesMax)
 		{
-			glBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
-			vertices = 0;
+			glDeleteBuffers(1, &id);
+			return;
 		}
 
-		if (HWBuffer->Mapped_Index != scene::EHM_NEVER)
+		// the name stays, the memory goes; the user gets new storage with glBufferData
+		glBindBuffer(GL_ARRAY_BUFFER, id);
+		glBufferData(GL_ARRAY_BUFFER, 0, 0, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		FreeBufferNames.push_back(id);
+	}
+
+
+	COpenGL3DriverBase::SBufferArena *COpenGL3DriverBase::allocateArenaRange(GLenum target, u32 key, u32 size, u32 &offset)
+	{
+		for (SBufferArena &arena : BufferArenas)
 		{
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
-			indexList = 0;
+			if (arena.Target == target && arena.Key == key && arena.allocate(size, offset))
+			{
+				updateArenaAttributes();
+				return &arena;
+			}
 		}
 
+		GLuint id = 0;
+		glGenBuffers(1, &id);
+		if (!id)
+			return 0;
 
-		drawVertexPrimitiveList(vertices, mb->getVertexCount(),
-				indexList, mb->getPrimitiveCount(),
-				mb->getVertexType(), mb->getPrimitiveType(),
-				mb->getIndexType());
+		glBindBuffer(target, id);
+		glBufferData(target, BufferArenaSize, 0, GL_STATIC_DRAW);
+		glBindBuffer(target, 0);
+		countBufferUpload(0, true);
+		if (testGLError(__LINE__))
+		{
+			glDeleteBuffers(1, &id);
+			return 0;
+		}
 
-		if (HWBuffer->Mapped_Vertex != scene::EHM_NEVER)
-			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		BufferArenas.emplace_back();
+		SBufferArena &arena = BufferArenas.back();
+		arena.ID = id;
+		arena.Target = target;
+		arena.Key = key;
+		arena.Free.push_back(SBufferArena::SRange{0, BufferArenaSize});
+		arena.allocate(size, offset);
 
-		if (HWBuffer->Mapped_Index != scene::EHM_NEVER)
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		updateArenaAttributes();
+		return &arena;
 	}
 
 
-	IRenderTarget* COpenGL3DriverBase::addRenderTarget()
+	void COpenGL3DriverBase::releaseArenaRange(SBufferArena *arena, u32 offset, u32 size)
 	{
-		COpenGL3RenderTarget* renderTarget = new COpenGL3RenderTarget(this);
-		RenderTargets.push_back(renderTarget);
+		arena->release(offset, size);
 
-		return renderTarget;
+		if (!arena->Used)
+		{
+			glDeleteBuffers(1, &arena->ID);
+			for (auto it = BufferArenas.begin(); it != BufferArenas.end(); ++it)
+			{
+				if (&*it == arena)
+				{
+					BufferArenas.erase(it);
+					break;
+				}
+			}
+		}
+
+		updateArenaAttributes();
 	}
 
 
-	// small helper function to create vertex buffer object adress offsets
-	static inline u8* buffer_offset(const long offset)
+	void COpenGL3DriverBase::updateArenaAttributes()
 	{
-		return ((u8*)0 + offset);
+		u32 used = 0;
+		u32 freeRanges = 0;
+		u32 largestFree = 0;
+		for (const SBufferArena &arena : BufferArenas)
+		{
+			used += arena.Used;
+			freeRanges += arena.Free.size();
+			for (const SBufferArena::SRange &range : arena.Free)
+				largestFree = core::max_(largestFree, range.Size);
+		}
+
+		const u32 allocated = BufferArenas.size() * BufferArenaSize;
+		DriverAttributes->setAttribute("BufferArenaCount", (s32)BufferArenas.size());
+		DriverAttributes->setAttribute("BufferArenaBytes", (s32)allocated);
+		DriverAttributes->setAttribute("BufferArenaUsedBytes", (s32)used);
+		DriverAttributes->setAttribute("BufferArenaFreeRanges", (s32)freeRanges);
+		// 0 if all free space is contiguous, approaching 1 the more it is scattered
+		DriverAttributes->setAttribute("BufferArenaFragmentation",
+			allocated > used ? 1.f - (f32)largestFree / (allocated - used) : 0.f);
 	}
 
 
-	//! draws a vertex primitive list
-	void COpenGL3DriverBase::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
-			const void* indexList, u32 primitiveCount,
-			E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+	//! updates hardware buffer if needed
+	bool COpenGL3DriverBase::updateHardwareBuffer(SHWBufferLink *HWBuffer)
 	{
-		if (!primitiveCount || !vertexCount)
-			return;
+		if (!HWBuffer)
+			return false;
 
-		if (!checkPrimitiveCount(primitiveCount))
-			return;
+		// the buffer objects hold the only copy of the data
+		if (HWBuffer->MeshBuffer->isClientDataReleased())
+			return static_cast<SHWBufferLink_opengl*>(HWBuffer)->vbo_verticesID != 0;
 
-		CNullDriver::drawVertexPrimitiveList(vertices, vertexCount, indexList, primitiveCount, vType, pType, iType);
+		if (HWBuffer->Mapped_Vertex != scene::EHM_NEVER)
+		{
+			if (HWBuffer->ChangedID_Vertex != HWBuffer->MeshBuffer->getChangedID_Vertex()
+				|| !static_cast<SHWBufferLink_opengl*>(HWBuffer)->vbo_verticesID)
+			{
 
-		setRenderStates3DMode();
+				// an empty buffer object needs all of the data
+				const u32 changedID = static_cast<SHWBufferLink_opengl*>(HWBuffer)->vbo_verticesID ? HWBuffer->ChangedID_Vertex : 0;
+				HWBuffer->ChangedID_Vertex = HWBuffer->MeshBuffer->getChangedID_Vertex();
 
-		auto &vTypeDesc = getVertexTypeDescription(vType);
-		beginDraw(vTypeDesc, reinterpret_cast<uintptr_t>(vertices));
-		GLenum indexSize = 0;
+				if (!updateVertexHardwareBuffer(static_cast<SHWBufferLink_opengl*>(HWBuffer), changedID))
+					return false;
+			}
+		}
 
-		switch (iType)
+		if (HWBuffer->Mapped_Index != scene::EHM_NEVER)
 		{
-			case(EIT_16BIT):
-			{
-				indexSize = GL_UNSIGNED_SHORT;
-				break;
-			}
-			case(EIT_32BIT):
+			if (HWBuffer->ChangedID_Index != HWBuffer->MeshBuffer->getChangedID_Index()
+				|| !static_cast<SHWBufferLink_opengl*>(HWBuffer)->vbo_indicesID)
 			{
-#ifdef GL_OES_element_index_uint
-#ifndef GL_UNSIGNED_INT
-#define GL_UNSIGNED_INT 0x1405
-#endif
-				if (FeatureAvailable[COGLESCoreExtensionHandler::IRR_GL_OES_element_index_uint])
-					indexSize = GL_UNSIGNED_INT;
-				else
-#endif
-					indexSize = GL_UNSIGNED_SHORT;
-				break;
+
+				const u32 changedID = static_cast<SHWBufferLink_opengl*>(HWBuffer)->vbo_indicesID ? HWBuffer->ChangedID_Index : 0;
+				HWBuffer->ChangedID_Index = HWBuffer->MeshBuffer->getChangedID_Index();
+
+				if (!updateIndexHardwareBuffer((SHWBufferLink_opengl*)HWBuffer, changedID))
+					return false;
 			}
 		}
 
-		switch (pType)
+		if (VertexArrayObjectSupported && HWBuffer->Mapped_Vertex != scene::EHM_NEVER && HWBuffer->Mapped_Index != scene::EHM_NEVER)
 		{
-			case scene::EPT_POINTS:
-			case scene::EPT_POINT_SPRITES:
-				glDrawArrays(GL_POINTS, 0, primitiveCount);
-				break;
-			case scene::EPT_LINE_STRIP:
-				glDrawElements(GL_LINE_STRIP, primitiveCount + 1, indexSize, indexList);
-				break;
-			case scene::EPT_LINE_LOOP:
-				glDrawElements(GL_LINE_LOOP, primitiveCount, indexSize, indexList);
-				break;
-			case scene::EPT_LINES:
-				glDrawElements(GL_LINES, primitiveCount*2, indexSize, indexList);
-				break;
-			case scene::EPT_TRIANGLE_STRIP:
-				glDrawElements(GL_TRIANGLE_STRIP, primitiveCount + 2, indexSize, indexList);
-				break;
-			case scene::EPT_TRIANGLE_FAN:
-				glDrawElements(GL_TRIANGLE_FAN, primitiveCount + 2, indexSize, indexList);
-				break;
-			case scene::EPT_TRIANGLES:
-				glDrawElements((LastMaterial.Wireframe) ? GL_LINES : (LastMaterial.PointCloud) ? GL_POINTS : GL_TRIANGLES, primitiveCount*3, indexSize, indexList);
-				break;
-			default:
-				break;
+			if (!updateVertexArrayObject(static_cast<SHWBufferLink_opengl*>(HWBuffer)))
+				return false;
 		}
 
-		endDraw(vTypeDesc);
+		releaseMeshBufferData(static_cast<SHWBufferLink_opengl*>(HWBuffer));
+		return true;
 	}
 
 
-	void COpenGL3DriverBase::draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
-		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect, SColor color,
-		bool useAlphaChannelOfTexture)
+	void COpenGL3DriverBase::releaseMeshBufferData(SHWBufferLink_opengl *HWBuffer)
 	{
-		if (!texture)
-			return;
-
-		if (!sourceRect.isValid())
+		const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+		// The data has to be readable with a mapping to give it back later as
+		// interleaved vertices, and compact vertices are drawn from the client
+		// arrays by some materials
+		if (!mb->getGPUOnly() || !BufferMapRangeSupported
+			|| HWBuffer->Mapped_Vertex != scene::EHM_STATIC || HWBuffer->Mapped_Index != scene::EHM_STATIC
+			|| HWBuffer->vertexType == EVT_COMPACT || HWBuffer->streamVertexCount
+			|| !HWBuffer->vbo_verticesID || !HWBuffer->vbo_indicesID)
 			return;
 
-		SColor colors[4] = {color, color, color, color};
-		draw2DImage(texture, {destPos, sourceRect.getSize()}, sourceRect, clipRect, colors, useAlphaChannelOfTexture);
+		const_cast<scene::IMeshBuffer*>(mb)->releaseClientData();
 	}
 
 
-	void COpenGL3DriverBase::draw2DImage(const video::ITexture* texture, const core::rect<s32>& destRect,
-		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
-		const video::SColor* const colors, bool useAlphaChannelOfTexture)
+	void COpenGL3DriverBase::restoreMeshBufferData(SHWBufferLink_opengl *HWBuffer)
 	{
-		if (!texture)
+		const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+		if (!mb || !mb->isClientDataReleased())
 			return;
 
-		// texcoords need to be flipped horizontally for RTTs
-		const bool isRTT = texture->isRenderTarget();
-		const core::dimension2du& ss = texture->getOriginalSize();
-		const f32 invW = 1.f / static_cast<f32>(ss.Width);
-		const f32 invH = 1.f / static_cast<f32>(ss.Height);
-		const core::rect<f32> tcoords(
-			sourceRect.UpperLeftCorner.X * invW,
-			(isRTT ? sourceRect.LowerRightCorner.Y : sourceRect.UpperLeftCorner.Y) * invH,
-			sourceRect.LowerRightCorner.X * invW,
-			(isRTT ? sourceRect.UpperLeftCorner.Y : sourceRect.LowerRightCorner.Y) *invH);
+		core::array<u8> vertices;
+		vertices.set_used(mb->getVertexCount() * getVertexPitchFromType(mb->getVertexType()));
+		core::array<u8> indices;
+		indices.set_used(mb->getIndexCount() * getIndexSize(mb->getIndexType()));
 
-		const video::SColor temp[4] =
+		if (!readBufferData(HWBuffer->vbo_verticesID, HWBuffer->vbo_verticesOffset, vertices.size(), vertices.pointer())
+			|| !readBufferData(HWBuffer->vbo_indicesID, HWBuffer->vbo_indicesOffset, indices.size(), indices.pointer()))
 		{
-			0xFFFFFFFF,
-			0xFFFFFFFF,
-			0xFFFFFFFF,
-			0xFFFFFFFF
-		};
-
-		const video::SColor* const useColor = colors ? colors : temp;
+			// zeroes at least leave a consistent buffer of degenerate primitives
+			os::Printer::log("Could not read back the data of a GPU only mesh buffer", ELL_ERROR);
+			memset(vertices.pointer(), 0, vertices.size());
+			memset(indices.pointer(), 0, indices.size());
+		}
 
-		chooseMaterial2D();
-		if (!setMaterialTexture(0, texture ))
-			return;
+		const_cast<scene::IMeshBuffer*>(mb)->restoreClientData(vertices.const_pointer(), indices.const_pointer());
+	}
 
-		setRenderStates2DMode(useColor[0].getAlpha() < 255 || useColor[1].getAlpha() < 255 ||
-			useColor[2].getAlpha() < 255 || useColor[3].getAlpha() < 255,
-			true, useAlphaChannelOfTexture);
 
-		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+	bool COpenGL3DriverBase::readBufferData(GLuint id, u32 offset, u32 size, void* data)
+	{
+		if (!size)
+			return true;
 
-		if (clipRect)
+		// GL_ARRAY_BUFFER, as the element array binding would change the bound VAO
+		glBindBuffer(GL_ARRAY_BUFFER, id);
+		bool ok = false;
+		if (const void* src = GL.MapBufferRange(GL_ARRAY_BUFFER, offset, size, GL.MAP_READ_BIT))
 		{
-			if (!clipRect->isValid())
-				return;
-
-			glEnable(GL_SCISSOR_TEST);
-			glScissor(clipRect->UpperLeftCorner.X, renderTargetSize.Height - clipRect->LowerRightCorner.Y,
-				clipRect->getWidth(), clipRect->getHeight());
+			memcpy(data, src, size);
+			ok = GL.UnmapBuffer(GL_ARRAY_BUFFER);
 		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return ok && !testGLError(__LINE__);
+	}
 
-		f32 left = (f32)destRect.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 right = (f32)destRect.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 down = 2.f - (f32)destRect.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-		f32 top = 2.f - (f32)destRect.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
 
-		S3DVertex vertices[4];
-		vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, useColor[0], tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
-		vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, useColor[3], tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
-		vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, useColor[2], tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
-		vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, useColor[1], tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
+	bool COpenGL3DriverBase::updateVertexArrayObject(SHWBufferLink_opengl *HWBuffer)
+	{
+		const E_VERTEX_TYPE vType = HWBuffer->vertexType;
+		if (HWBuffer->vaoID && HWBuffer->vaoVertexType == vType)
+			return true;
 
-		drawQuad(vt2DImage, vertices);
+		// attributes of the old vertex type would stay enabled, so start over
+		deleteVertexArrayObject(HWBuffer);
 
-		if (clipRect)
-			glDisable(GL_SCISSOR_TEST);
+		GL.GenVertexArrays(1, &HWBuffer->vaoID);
+		if (!HWBuffer->vaoID)
+			return false;
+		HWBuffer->vaoVertexType = vType;
 
-		testGLError(__LINE__);
+		// The element array binding and the attribute pointers are recorded in the VAO.
+		GL.BindVertexArray(HWBuffer->vaoID);
+		glBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
+		if (HWBuffer->streamVertexCount)
+			beginDrawStreams(getVertexTypeDescription(vType), HWBuffer->vbo_verticesOffset, HWBuffer->streamVertexCount, false);
+		else
+			beginDraw(getVertexTypeDescription(vType), HWBuffer->vbo_verticesOffset);
+		GL.BindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		return (!testGLError(__LINE__));
 	}
 
-	void COpenGL3DriverBase::draw2DImage(const video::ITexture* texture, u32 layer, bool flip)
-	{
-		if (!texture)
-			return;
 
-		chooseMaterial2D();
-		if (!setMaterialTexture(0, texture ))
-			return;
+	void COpenGL3DriverBase::deleteVertexArrayObject(SHWBufferLink_opengl *HWBuffer)
+	{
+		if (HWBuffer->vaoID)
+		{
+			GL.DeleteVertexArrays(1, &HWBuffer->vaoID);
+			HWBuffer->vaoID = 0;
+		}
+	}
 
-		setRenderStates2DMode(false, true, true);
 
-		S3DVertex quad2DVertices[4];
+	//! Create hardware buffer from meshbuffer
+	COpenGL3DriverBase::SHWBufferLink *COpenGL3DriverBase::createHardwareBuffer(const scene::IMeshBuffer* mb)
+	{
+		if (!mb || (mb->getHardwareMappingHint_Index() == scene::EHM_NEVER && mb->getHardwareMappingHint_Vertex() == scene::EHM_NEVER))
+			return 0;
 
-		quad2DVertices[0].Pos = core::vector3df(-1.f, 1.f, 0.f);
-		quad2DVertices[1].Pos = core::vector3df(1.f, 1.f, 0.f);
-		quad2DVertices[2].Pos = core::vector3df(1.f, -1.f, 0.f);
-		quad2DVertices[3].Pos = core::vector3df(-1.f, -1.f, 0.f);
+		SHWBufferLink_opengl *HWBuffer = new SHWBufferLink_opengl(mb, this);
 
-		f32 modificator = (flip) ? 1.f : 0.f;
+		//add to map
+		HWBuffer->listPosition = HWBufferList.insert(HWBufferList.end(), HWBuffer);
 
-		quad2DVertices[0].TCoords = core::vector2df(0.f, 0.f + modificator);
-		quad2DVertices[1].TCoords = core::vector2df(1.f, 0.f + modificator);
-		quad2DVertices[2].TCoords = core::vector2df(1.f, 1.f - modificator);
-		quad2DVertices[3].TCoords = core::vector2df(0.f, 1.f - modificator);
+		HWBuffer->ChangedID_Vertex = HWBuffer->MeshBuffer->getChangedID_Vertex();
+		HWBuffer->ChangedID_Index = HWBuffer->MeshBuffer->getChangedID_Index();
+		HWBuffer->Mapped_Vertex = mb->getHardwareMappingHint_Vertex();
+		HWBuffer->Mapped_Index = mb->getHardwareMappingHint_Index();
+		HWBuffer->vbo_verticesID = 0;
+		HWBuffer->vbo_indicesID = 0;
+		HWBuffer->vbo_verticesSize = 0;
+		HWBuffer->vbo_indicesSize = 0;
+		HWBuffer->vbo_verticesOffset = 0;
+		HWBuffer->vbo_indicesOffset = 0;
+		HWBuffer->vertexArena = 0;
+		HWBuffer->indexArena = 0;
+		HWBuffer->vaoID = 0;
 
-		quad2DVertices[0].Color = SColor(0xFFFFFFFF);
-		quad2DVertices[1].Color = SColor(0xFFFFFFFF);
-		quad2DVertices[2].Color = SColor(0xFFFFFFFF);
-		quad2DVertices[3].Color = SColor(0xFFFFFFFF);
+		if (!updateHardwareBuffer(HWBuffer))
+		{
+			deleteHardwareBuffer(HWBuffer);
+			return 0;
+		}
 
-		drawQuad(vt2DImage, quad2DVertices);
+		return HWBuffer;
 	}
 
-	void COpenGL3DriverBase::draw2DImageBatch(const video::ITexture* texture,
-			const core::array<core::position2d<s32> >& positions,
-			const core::array<core::rect<s32> >& sourceRects,
-			const core::rect<s32>* clipRect,
-			SColor color, bool useAlphaChannelOfTexture)
-	{
-		if (!texture)
-			return;
 
-		chooseMaterial2D();
-		if (!setMaterialTexture(0, texture))
+	void COpenGL3DriverBase::deleteHardwareBuffer(SHWBufferLink *_HWBuffer)
+	{
+		if (!_HWBuffer)
 			return;
 
-		setRenderStates2DMode(color.getAlpha() < 255, true, useAlphaChannelOfTexture);
-
-		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
-
-		if (clipRect)
+		SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl*>(_HWBuffer);
+		restoreMeshBufferData(HWBuffer);
+		deleteVertexArrayObject(HWBuffer);
+		if (HWBuffer->vertexArena)
 		{
-			if (!clipRect->isValid())
-				return;
-
-			glEnable(GL_SCISSOR_TEST);
-			glScissor(clipRect->UpperLeftCorner.X, renderTargetSize.Height - clipRect->LowerRightCorner.Y,
-					clipRect->getWidth(), clipRect->getHeight());
+			releaseArenaRange(HWBuffer->vertexArena, HWBuffer->vbo_verticesOffset, HWBuffer->vbo_verticesSize);
+			HWBuffer->vertexArena = 0;
 		}
-
-		const irr::u32 drawCount = core::min_<u32>(positions.size(), sourceRects.size());
-		assert(6 * std::size_t(drawCount) <= QuadsIndices.size());
-
-		core::array<S3DVertex> vtx(drawCount * 4);
-
-		for (u32 i = 0; i < drawCount; i++)
+		else if (HWBuffer->vbo_verticesID)
 		{
-			core::position2d<s32> targetPos = positions[i];
-			core::position2d<s32> sourcePos = sourceRects[i].UpperLeftCorner;
-			// This needs to be signed as it may go negative.
-			core::dimension2d<s32> sourceSize(sourceRects[i].getSize());
-
+			releaseBuffer(HWBuffer->vbo_verticesID);
+		}
+		HWBuffer->vbo_verticesID = 0;
+		if (HWBuffer->indexArena)
+		{
+			releaseArenaRange(HWBuffer->indexArena, HWBuffer->vbo_indicesOffset, HWBuffer->vbo_indicesSize);
+			HWBuffer->indexArena = 0;
+		}
+		else if (HWBuffer->vbo_indicesID)
+		{
+			releaseBuffer(HWBuffer->vbo_indicesID);
+		}
+		HWBuffer->vbo_indicesID = 0;
+
+		CNullDriver::deleteHardwareBuffer(_HWBuffer);
+	}
+
+
+	//! Draw hardware buffer
+	void COpenGL3DriverBase::drawHardwareBuffer(SHWBufferLink *_HWBuffer)
+	{
+		if (!_HWBuffer)
+			return;
+
+		IRR_PROFILE_SCOPE("COpenGL3DriverBase::drawHardwareBuffer");
+
+		SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl*>(_HWBuffer);
+
+		updateHardwareBuffer(HWBuffer); //check if update is needed
+
+		const scene::IMeshBuffer* mb = HWBuffer->MeshBuffer;
+
+		if (getDrawVertexType(mb, HWBuffer) == EVT_COMPACT)
+		{
+			// materials without a compact variant get the vertices of the mesh buffer
+			if (!getMaterialVariantRenderer(Material.MaterialType, EMV_COMPACT, getMaterialPermutation(Material)))
+			{
+				drawVertexPrimitiveList(mb->getVertices(), mb->getVertexCount(), mb->getIndices(),
+					mb->getPrimitiveCount(), mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType());
+				return;
+			}
+
+			// picked up by setRenderStates3DMode and the material callbacks
+			CompactVertices = true;
+			CompactScale = HWBuffer->compactScale;
+			CompactOffset = HWBuffer->compactOffset;
+		}
+
+		if (beginDrawPrimitiveList(mb->getVertexCount(), mb->getPrimitiveCount(),
+				mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType()))
+		{
+			const void *indexList = beginMeshBufferDraw(mb, HWBuffer);
+			if (MorphTarget)
+				beginMorphTarget();
+			drawPrimitives(indexList, mb->getPrimitiveCount(), mb->getPrimitiveType(), mb->getIndexType());
+			if (MorphTarget)
+				endMorphTarget();
+			endMeshBufferDraw(mb, HWBuffer);
+		}
+
+		CompactVertices = false;
+	}
+
+
+	E_VERTEX_TYPE COpenGL3DriverBase::getDrawVertexType(const scene::IMeshBuffer* mb, const SHWBufferLink_opengl *HWBuffer) const
+	{
+		if (HWBuffer && HWBuffer->Mapped_Vertex != scene::EHM_NEVER)
+			return HWBuffer->vertexType;
+		return mb->getVertexType();
+	}
+
+
+	const void* COpenGL3DriverBase::beginMeshBufferDraw(const scene::IMeshBuffer* mb, SHWBufferLink_opengl *HWBuffer)
+	{
+		// the VAO enables all streams, depth only draws bind the position stream alone
+		const bool positionsOnly = HWBuffer && HWBuffer->streamVertexCount && isPositionOnlyDraw(mb);
+		if (HWBuffer && HWBuffer->vaoID && !positionsOnly)
+		{
+			GL.BindVertexArray(HWBuffer->vaoID);
+			return buffer_offset(HWBuffer->vbo_indicesOffset);
+		}
+
+		// Buffers which aren't mapped are streamed.
+		auto &vTypeDesc = getVertexTypeDescription(getDrawVertexType(mb, HWBuffer));
+		uintptr_t verticesBase = 0;
+		if (HWBuffer && HWBuffer->Mapped_Vertex != scene::EHM_NEVER)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, HWBuffer->vbo_verticesID);
+			verticesBase = HWBuffer->vbo_verticesOffset;
+		}
+		else
+			verticesBase = streamVertices(vTypeDesc, mb->getVertices(), mb->getVertexCount());
+
+		const void *indexList = 0;
+		if (HWBuffer && HWBuffer->Mapped_Index != scene::EHM_NEVER)
+		{
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, HWBuffer->vbo_indicesID);
+			indexList = buffer_offset(HWBuffer->vbo_indicesOffset);
+		}
+		else if (const u32 indexCount = getIndexCount(mb->getPrimitiveType(), mb->getPrimitiveCount()))
+			indexList = streamIndices(mb->getIndices(), indexCount * getIndexSize(mb->getIndexType()));
+
+		if (HWBuffer && HWBuffer->streamVertexCount)
+			beginDrawStreams(vTypeDesc, verticesBase, HWBuffer->streamVertexCount, positionsOnly);
+		else
+			beginDraw(vTypeDesc, verticesBase);
+		return indexList;
+	}
+
+
+	bool COpenGL3DriverBase::isPositionOnlyDraw(const scene::IMeshBuffer* mb) const
+	{
+		// the solid shaders don't discard, so nothing but the position decides about the depth
+		return Material.ColorMask == ECP_NONE && Material.MaterialType == EMT_SOLID &&
+			getDrawMaterialVariant() == EMV_NONE;
+	}
+
+
+	void COpenGL3DriverBase::endMeshBufferDraw(const scene::IMeshBuffer* mb, SHWBufferLink_opengl *HWBuffer)
+	{
+		const bool positionsOnly = HWBuffer && HWBuffer->streamVertexCount && isPositionOnlyDraw(mb);
+		if (HWBuffer && HWBuffer->vaoID && !positionsOnly)
+		{
+			GL.BindVertexArray(0);
+			return;
+		}
+
+		endDraw(getVertexTypeDescription(getDrawVertexType(mb, HWBuffer)));
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+
+	void COpenGL3DriverBase::drawMeshBuffer(const scene::IMeshBuffer* mb)
+	{
+		if (!mb)
+			return;
+
+		if (mb->getVertexType() != EVT_SKINNED)
+		{
+			CNullDriver::drawMeshBuffer(mb);
+			return;
+		}
+
+		// picked up by setRenderStates3DMode and the material callbacks
+		JointMatrices = mb->getJointMatrices(JointMatrixCount);
+		CNullDriver::drawMeshBuffer(mb);
+		JointMatrices = 0;
+		JointMatrixCount = 0;
+	}
+
+
+	void COpenGL3DriverBase::drawMeshBufferMorphed(const scene::IMeshBuffer* mb,
+			const scene::IMeshBuffer* target, f32 blend)
+	{
+		if (!mb)
+			return;
+
+		SHWBufferLink_opengl *HWBuffer = 0;
+		SHWBufferLink_opengl *targetBuffer = 0;
+		if (target && target != mb && blend > 0.f && queryFeature(EVDF_HARDWARE_MORPHING) &&
+			mb->getVertexType() != EVT_SKINNED && target->getVertexType() == mb->getVertexType() &&
+			target->getVertexCount() == mb->getVertexCount())
+		{
+			HWBuffer = getMorphBufferLink(mb);
+			targetBuffer = HWBuffer ? getMorphBufferLink(target) : 0;
+		}
+
+		// materials without a morphing variant get the vertices of mb alone
+		if (!HWBuffer || !targetBuffer ||
+			!getMaterialVariantRenderer(Material.MaterialType, EMV_MORPHING, getMaterialPermutation(Material)))
+		{
+			drawMeshBuffer(mb);
+			return;
+		}
+
+		// picked up by setRenderStates3DMode and the material callbacks
+		MorphTarget = targetBuffer;
+		MorphBlend = core::min_(blend, 1.f);
+		drawHardwareBuffer(HWBuffer);
+		MorphTarget = 0;
+	}
+
+
+	COpenGL3DriverBase::SHWBufferLink_opengl* COpenGL3DriverBase::getMorphBufferLink(const scene::IMeshBuffer* mb)
+	{
+		// unlike getBufferLink, small buffers are uploaded as well, each keyframe is drawn over and over
+		if (mb->getHardwareMappingHint_Vertex() == scene::EHM_NEVER)
+			return 0;
+
+		SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl*>(mb->getHWBuffer());
+		if (!HWBuffer)
+			HWBuffer = static_cast<SHWBufferLink_opengl*>(createHardwareBuffer(mb));
+		if (!HWBuffer)
+			return 0;
+
+		updateHardwareBuffer(HWBuffer);
+
+		// compact vertices are quantized, their positions can't be blended by the same weights
+		if (HWBuffer->Mapped_Vertex == scene::EHM_NEVER || !HWBuffer->vbo_verticesID ||
+			HWBuffer->vertexType != mb->getVertexType())
+			return 0;
+
+		return HWBuffer;
+	}
+
+
+	void COpenGL3DriverBase::beginMorphTarget()
+	{
+		// position and normal come first in every vertex type, in the interleaved and the stream layout
+		const VertexType &vTypeDesc = getVertexTypeDescription(MorphTarget->vertexType);
+		uintptr_t stream = MorphTarget->vbo_verticesOffset;
+		glBindBuffer(GL_ARRAY_BUFFER, MorphTarget->vbo_verticesID);
+		for (auto attr: vTypeDesc) {
+			if (attr.Index != EVA_POSITION && attr.Index != EVA_NORMAL)
+				break;
+
+			const GLuint location = attr.Index == EVA_POSITION ? EMA_POSITION : EMA_NORMAL;
+			glEnableVertexAttribArray(location);
+			if (MorphTarget->streamVertexCount)
+			{
+				glVertexAttribPointer(location, attr.ComponentCount, attr.ComponentType, GL_FALSE, getAttributeSize(attr), reinterpret_cast<void *>(stream));
+				stream += getAttributeStreamSize(attr, MorphTarget->streamVertexCount);
+			}
+			else
+				glVertexAttribPointer(location, attr.ComponentCount, attr.ComponentType, GL_FALSE, vTypeDesc.VertexSize, reinterpret_cast<void *>(stream + attr.Offset));
+		}
+	}
+
+
+	void COpenGL3DriverBase::endMorphTarget()
+	{
+		// the vertex array object of the drawn buffer may still be bound, it keeps its own layout otherwise
+		glDisableVertexAttribArray(EMA_POSITION);
+		glDisableVertexAttribArray(EMA_NORMAL);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+
+	void COpenGL3DriverBase::drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const S3DInstance* instances, u32 count)
+	{
+		if (!mb || !instances || !count)
+			return;
+
+		if (InstancingSupported)
+		{
+			// the shader applies the instance transformation on its own
+			setTransform(ETS_WORLD, core::IdentityMatrix);
+			setRenderStates3DMode();
+		}
+
+		SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl*>(getBufferLink(mb));
+		if (HWBuffer)
+			updateHardwareBuffer(HWBuffer);
+
+		// compact buffers need the variants of the built-in materials, which don't instance
+		GLuint program = 0;
+		CacheHandler->getProgram(program);
+		if (!InstancingSupported || !program || mb->getVertexType() == EVT_SKINNED ||
+				getDrawVertexType(mb, HWBuffer) == EVT_COMPACT ||
+				glGetAttribLocation(program, sBuiltInInstanceAttributeNames[0]) != EIA_TRANSFORM)
+		{
+			CNullDriver::drawMeshBufferInstanced(mb, instances, count);
+			return;
+		}
+
+		if (!beginDrawPrimitiveList(mb->getVertexCount(), mb->getPrimitiveCount(),
+				mb->getVertexType(), mb->getPrimitiveType(), mb->getIndexType()))
+			return;
+		PrimitivesDrawn += mb->getPrimitiveCount() * (count - 1);
+		FrameStats.PrimitivesDrawn += mb->getPrimitiveCount() * (count - 1);
+
+		// upload the instances first, streaming them may need to bind the stream buffer
+		const u32 instancesSize = count * sizeof(S3DInstance);
+		GLuint instanceBuffer = StreamBuffer.ID;
+		uintptr_t instancesBase = 0;
+		if (!uploadStreamData(instances, instancesSize, instancesBase))
+		{
+			if (!InstanceBufferID)
+				glGenBuffers(1, &InstanceBufferID);
+			instanceBuffer = InstanceBufferID;
+			glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+			glBufferData(GL_ARRAY_BUFFER, instancesSize, instances, GL_STREAM_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			countBufferUpload(instancesSize, true);
+		}
+
+		const void *indexList = beginMeshBufferDraw(mb, HWBuffer);
+		beginInstanceAttributes(instanceBuffer, instancesBase);
+		drawPrimitives(indexList, mb->getPrimitiveCount(), mb->getPrimitiveType(), mb->getIndexType(), count);
+		endInstanceAttributes();
+		endMeshBufferDraw(mb, HWBuffer);
+	}
+
+
+	void COpenGL3DriverBase::drawMeshBufferBatch(const scene::IMeshBuffer* const* mb,
+			const core::matrix4* worldMatrices, u32 count)
+	{
+		if (!mb || !worldMatrices)
+			return;
+
+		if (count < GPUCullingMinBatch || !queryFeature(EVDF_GPU_CULLING) ||
+				!drawCulledBatch(mb, worldMatrices, count))
+			CNullDriver::drawMeshBufferBatch(mb, worldMatrices, count);
+	}
+
+
+	bool COpenGL3DriverBase::drawCulledBatch(const scene::IMeshBuffer* const* mb,
+			const core::matrix4* worldMatrices, u32 count)
+	{
+		IRR_PROFILE_SCOPE("COpenGL3DriverBase::drawCulledBatch");
+
+		// all buffers have to be in the same arenas, so one VAO reaches them through the base vertex and first index
+		const core::matrix4& world = worldMatrices[0];
+		SHWBufferLink_opengl *base = 0;
+		for (u32 i = 0; i < count; ++i)
+		{
+			if (!mb[i] || worldMatrices[i] != world || mb[i]->getPrimitiveType() != scene::EPT_TRIANGLES ||
+					mb[i]->getVertexType() == EVT_SKINNED)
+				return false;
+
+			SHWBufferLink_opengl *HWBuffer = static_cast<SHWBufferLink_opengl*>(getBufferLink(mb[i]));
+			if (!HWBuffer)
+				return false;
+			updateHardwareBuffer(HWBuffer);
+
+			// compact buffers need their own scale and offset
+			if (!HWBuffer->vaoID || !HWBuffer->vertexArena || !HWBuffer->indexArena ||
+					HWBuffer->streamVertexCount || HWBuffer->vertexType == EVT_COMPACT)
+				return false;
+
+			if (!base)
+				base = HWBuffer;
+			else if (HWBuffer->vertexArena != base->vertexArena || HWBuffer->indexArena != base->indexArena)
+				return false;
+			else if (HWBuffer->vbo_verticesOffset < base->vbo_verticesOffset)
+				base = HWBuffer;
+		}
+
+		const E_VERTEX_TYPE vType = base->vertexType;
+		const E_INDEX_TYPE iType = base->MeshBuffer->getIndexType();
+		const u32 vertexSize = getVertexTypeDescription(vType).VertexSize;
+		const u32 indexSize = getIndexSize(iType);
+
+		COpenGL3GPUCulling::SDraw *draws = GPUCulling->beginBatch(count);
+		u32 primitiveCount = 0;
+		for (u32 i = 0; i < count; ++i)
+		{
+			const SHWBufferLink_opengl *HWBuffer = static_cast<const SHWBufferLink_opengl*>(mb[i]->getHWBuffer());
+			const u32 vertexOffset = HWBuffer->vbo_verticesOffset - base->vbo_verticesOffset;
+			if (vertexOffset % vertexSize || HWBuffer->vbo_indicesOffset % indexSize)
+				return false;
+
+			const core::aabbox3df& box = mb[i]->getBoundingBox();
+			COpenGL3GPUCulling::SDraw &draw = draws[i];
+			draw.MinEdge[0] = box.MinEdge.X;
+			draw.MinEdge[1] = box.MinEdge.Y;
+			draw.MinEdge[2] = box.MinEdge.Z;
+			draw.MinEdge[3] = 1.f;
+			draw.MaxEdge[0] = box.MaxEdge.X;
+			draw.MaxEdge[1] = box.MaxEdge.Y;
+			draw.MaxEdge[2] = box.MaxEdge.Z;
+			draw.MaxEdge[3] = 1.f;
+			draw.IndexCount = getIndexCount(scene::EPT_TRIANGLES, mb[i]->getPrimitiveCount());
+			draw.FirstIndex = HWBuffer->vbo_indicesOffset / indexSize;
+			draw.BaseVertex = vertexOffset / vertexSize;
+			draw.Padding = 0;
+
+			primitiveCount += mb[i]->getPrimitiveCount();
+		}
+
+		// counted as drawn, only the GPU knows how many were culled
+		PrimitivesDrawn += primitiveCount;
+		FrameStats.PrimitivesDrawn += primitiveCount;
+		++FrameStats.DrawCalls;
+
+		// pending lines are drawn before the compute shader changes the program
+		flush3DLines();
+
+		setTransform(ETS_WORLD, world);
+		core::matrix4 viewProjection(Matrices[ETS_PROJECTION]);
+		viewProjection *= Matrices[ETS_VIEW];
+		const bool toScreen = !CurrentRenderTarget &&
+			ViewPort == core::rect<s32>(0, 0, ScreenSize.Width, ScreenSize.Height);
+
+		// the compute shader changes the program, so the states of the material come afterwards
+		GPUCulling->cull(world, viewProjection, toScreen);
+		setRenderStates3DMode();
+
+		GL.BindVertexArray(base->vaoID);
+		GL.MultiDrawElementsIndirect(GL_TRIANGLES, iType == EIT_32BIT ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT,
+			0, count, 0);
+		GL.BindVertexArray(0);
+		GPUCulling->endBatch();
+
+		return true;
+	}
+
+
+	void COpenGL3DriverBase::beginInstanceAttributes(GLuint buffer, uintptr_t base)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+		const GLsizei stride = sizeof(S3DInstance);
+		for (int column = 0; column < 4; ++column)
+		{
+			glEnableVertexAttribArray(EIA_TRANSFORM + column);
+			glVertexAttribPointer(EIA_TRANSFORM + column, 4, GL_FLOAT, GL_FALSE, stride,
+				reinterpret_cast<void*>(base + offsetof(S3DInstance, Transform) + column * 4 * sizeof(f32)));
+		}
+		glEnableVertexAttribArray(EIA_COLOR);
+		glVertexAttribPointer(EIA_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+			reinterpret_cast<void*>(base + offsetof(S3DInstance, Color)));
+		glEnableVertexAttribArray(EIA_PARAMS);
+		glVertexAttribPointer(EIA_PARAMS, 3, GL_FLOAT, GL_FALSE, stride,
+			reinterpret_cast<void*>(base + offsetof(S3DInstance, Params)));
+
+		for (int index = EIA_TRANSFORM; index < EIA_COUNT; ++index)
+			GL.VertexAttribDivisor(index, 1);
+	}
+
+
+	void COpenGL3DriverBase::endInstanceAttributes()
+	{
+		// a VAO may be bound, which records these states
+		for (int index = EIA_TRANSFORM; index < EIA_COUNT; ++index)
+		{
+			GL.VertexAttribDivisor(index, 0);
+			glDisableVertexAttribArray(index);
+		}
+	}
+
+
+	//! Create occlusion query.
+	/** Use node for identification and mesh for occlusion test. */
+	void COpenGL3DriverBase::addOcclusionQuery(scene::ISceneNode* node,
+			const scene::IMesh* mesh)
+	{
+		if (!queryFeature(EVDF_OCCLUSION_QUERY))
+			return;
+
+		CNullDriver::addOcclusionQuery(node, mesh);
+		const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+		if ((index != -1) && (OcclusionQueries[index].UID == 0))
+			GL.GenQueries(1, reinterpret_cast<GLuint*>(&OcclusionQueries[index].UID));
+	}
+
+
+	//! Remove occlusion query.
+	void COpenGL3DriverBase::removeOcclusionQuery(scene::ISceneNode* node)
+	{
+		const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+		if (index != -1)
+		{
+			if (OcclusionQueries[index].UID != 0)
+				GL.DeleteQueries(1, reinterpret_cast<GLuint*>(&OcclusionQueries[index].UID));
+			CNullDriver::removeOcclusionQuery(node);
+		}
+	}
+
+
+	//! Run occlusion query. Draws mesh stored in query.
+	void COpenGL3DriverBase::runOcclusionQuery(scene::ISceneNode* node, bool visible)
+	{
+		if (!node)
+			return;
+
+		const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+		if (index == -1 || !OcclusionQueries[index].UID)
+			return;
+
+		const SOccQuery &query = OcclusionQueries[index];
+
+		// A query can't be restarted before its result arrived, and waiting for
+		// it would stall the pipeline. Keep the previous result meanwhile.
+		if (query.Run != u32(~0))
+		{
+			GLuint available = GL_FALSE;
+			GL.GetQueryObjectuiv(query.UID, GL.QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				return;
+			GL.GetQueryObjectuiv(query.UID, GL.QUERY_RESULT, &OcclusionQueries[index].Result);
+		}
+
+		// the queued lines and 2D quads were drawn before, they must not count
+		flush2DBatch();
+		flush3DLines();
+
+		GL.BeginQuery(OcclusionQueryTarget, query.UID);
+		CNullDriver::runOcclusionQuery(node, visible);
+		GL.EndQuery(OcclusionQueryTarget);
+		testGLError(__LINE__);
+	}
+
+
+	//! Update occlusion query. Retrieves results from GPU.
+	/** If the query shall not block, set the flag to false.
+	Update might not occur in this case, though */
+	void COpenGL3DriverBase::updateOcclusionQuery(scene::ISceneNode* node, bool block)
+	{
+		const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+		if (index == -1 || !OcclusionQueries[index].UID)
+			return;
+
+		// not yet started
+		if (OcclusionQueries[index].Run == u32(~0))
+			return;
+
+		GLuint available = block ? GL_TRUE : GL_FALSE;
+		if (!block)
+			GL.GetQueryObjectuiv(OcclusionQueries[index].UID, GL.QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+			GL.GetQueryObjectuiv(OcclusionQueries[index].UID, GL.QUERY_RESULT, &OcclusionQueries[index].Result);
+		testGLError(__LINE__);
+	}
+
+
+	//! Return query result.
+	u32 COpenGL3DriverBase::getOcclusionQueryResult(scene::ISceneNode* node) const
+	{
+		const s32 index = OcclusionQueries.linear_search(SOccQuery(node));
+		if (index != -1)
+			return OcclusionQueries[index].Result;
+		else
+			return ~0;
+	}
+
+
+	GLuint COpenGL3DriverBase::allocateTimerQuery()
+	{
+		GLuint query = 0;
+		if (FreeTimerQueries.size())
+		{
+			query = FreeTimerQueries.getLast();
+			FreeTimerQueries.erase(FreeTimerQueries.size() - 1);
+		}
+		else
+			GL.GenQueries(1, &query);
+		return query;
+	}
+
+
+	void COpenGL3DriverBase::beginGPUTimerScope(const c8* name)
+	{
+		if (!queryFeature(EVDF_TIMER_QUERY))
+			return;
+
+		flush2DBatch();
+		flush3DLines();
+
+		SGPUTimerScope scope;
+		scope.Name = name;
+		scope.Depth = GPUTimerStack.size();
+		scope.BeginQuery = allocateTimerQuery();
+		scope.EndQuery = 0;
+		GL.QueryCounter(scope.BeginQuery, GL.TIMESTAMP);
+
+		GPUTimerStack.push_back(GPUTimerScopes[GPUTimerFrame].size());
+		GPUTimerScopes[GPUTimerFrame].push_back(scope);
+	}
+
+
+	void COpenGL3DriverBase::endGPUTimerScope()
+	{
+		if (GPUTimerStack.empty())
+			return;
+
+		flush2DBatch();
+		flush3DLines();
+
+		SGPUTimerScope& scope = GPUTimerScopes[GPUTimerFrame][GPUTimerStack.getLast()];
+		scope.EndQuery = allocateTimerQuery();
+		GL.QueryCounter(scope.EndQuery, GL.TIMESTAMP);
+
+		GPUTimerStack.erase(GPUTimerStack.size() - 1);
+	}
+
+
+	void COpenGL3DriverBase::finishGPUTimerFrame()
+	{
+		if (!GPUTimerStack.empty())
+		{
+			os::Printer::log("GPU timer scope not ended before endScene", GPUTimerScopes[GPUTimerFrame][GPUTimerStack[0]].Name.c_str(), ELL_WARNING);
+			while (!GPUTimerStack.empty())
+				endGPUTimerScope();
+		}
+
+		// the frame ended with CNullDriver::endScene, which counted it already
+		if (GPUFrameBeginQuery)
+		{
+			SGPUFrameTimer& frameTimer = GPUFrameTimers[GPUTimerFrame];
+			frameTimer.BeginQuery = GPUFrameBeginQuery;
+			frameTimer.EndQuery = allocateTimerQuery();
+			frameTimer.Frame = FrameCount - 1;
+			GL.QueryCounter(frameTimer.EndQuery, GL.TIMESTAMP);
+			GPUFrameBeginQuery = 0;
+		}
+
+		GPUTimerFrame = (GPUTimerFrame + 1) % GPUTimerFrames;
+		core::array<SGPUTimerScope>& scopes = GPUTimerScopes[GPUTimerFrame];
+		SGPUFrameTimer& frameTimer = GPUFrameTimers[GPUTimerFrame];
+
+		if (scopes.empty() && !frameTimer.BeginQuery)
+			return;
+
+		// a disjoint operation like a frequency change makes the timestamps meaningless
+		GLint disjoint = GL_FALSE;
+		if (getDriverType() == EDT_OGLES2)
+			glGetIntegerv(GL.GPU_DISJOINT, &disjoint);
+
+		if (frameTimer.BeginQuery)
+		{
+			GLuint available = GL_FALSE;
+			GL.GetQueryObjectuiv(frameTimer.EndQuery, GL.QUERY_RESULT_AVAILABLE, &available);
+			if (available && !disjoint)
+			{
+				GLuint64 begin = 0;
+				GLuint64 end = 0;
+				GL.GetQueryObjectui64v(frameTimer.BeginQuery, GL.QUERY_RESULT, &begin);
+				GL.GetQueryObjectui64v(frameTimer.EndQuery, GL.QUERY_RESULT, &end);
+				if (end > begin)
+					FPSCounter.registerGPUTime(frameTimer.Frame, (f32)((end - begin) / 1000000.0));
+			}
+
+			FreeTimerQueries.push_back(frameTimer.BeginQuery);
+			FreeTimerQueries.push_back(frameTimer.EndQuery);
+			frameTimer.BeginQuery = 0;
+			frameTimer.EndQuery = 0;
+		}
+
+		if (scopes.empty())
+			return;
+
+		// queries finish in order, so if the last one is done all of them are
+		GLuint available = GL_FALSE;
+		GL.GetQueryObjectuiv(scopes.getLast().EndQuery, GL.QUERY_RESULT_AVAILABLE, &available);
+
+		if (available && !disjoint)
+		{
+			GPUTimerResults.set_used(scopes.size());
+			for (u32 i = 0; i < scopes.size(); ++i)
+			{
+				GLuint64 begin = 0;
+				GLuint64 end = 0;
+				GL.GetQueryObjectui64v(scopes[i].BeginQuery, GL.QUERY_RESULT, &begin);
+				GL.GetQueryObjectui64v(scopes[i].EndQuery, GL.QUERY_RESULT, &end);
+
+				GPUTimerResults[i].Name = scopes[i].Name;
+				GPUTimerResults[i].Depth = scopes[i].Depth;
+				GPUTimerResults[i].Milliseconds = end > begin ? (f32)((end - begin) / 1000000.0) : 0.f;
+			}
+		}
+
+		for (u32 i = 0; i < scopes.size(); ++i)
+		{
+			FreeTimerQueries.push_back(scopes[i].BeginQuery);
+			FreeTimerQueries.push_back(scopes[i].EndQuery);
+		}
+		scopes.set_used(0);
+		testGLError(__LINE__);
+	}
+
+
+	IRenderTarget* COpenGL3DriverBase::addRenderTarget()
+	{
+		COpenGL3RenderTarget* renderTarget = new COpenGL3RenderTarget(this);
+		RenderTargets.push_back(renderTarget);
+
+		return renderTarget;
+	}
+
+
+	//! draws a vertex primitive list
+	void COpenGL3DriverBase::drawVertexPrimitiveList(const void* vertices, u32 vertexCount,
+			const void* indexList, u32 primitiveCount,
+			E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+	{
+		IRR_PROFILE_SCOPE("COpenGL3DriverBase::drawVertexPrimitiveList");
+		if (!beginDrawPrimitiveList(vertexCount, primitiveCount, vType, pType, iType))
+			return;
+
+		auto &vTypeDesc = getVertexTypeDescription(vType);
+		const uintptr_t verticesBase = streamVertices(vTypeDesc, vertices, vertexCount);
+		if (const u32 indexCount = getIndexCount(pType, primitiveCount))
+			indexList = streamIndices(indexList, indexCount * getIndexSize(iType));
+
+		beginDraw(vTypeDesc, verticesBase);
+		drawPrimitives(indexList, primitiveCount, pType, iType);
+		endDraw(vTypeDesc);
+		endStreamDraw();
+	}
+
+
+	bool COpenGL3DriverBase::beginDrawPrimitiveList(u32 vertexCount, u32 primitiveCount,
+			E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType)
+	{
+		if (!primitiveCount || !vertexCount)
+			return false;
+
+		if (!checkPrimitiveCount(primitiveCount))
+			return false;
+
+		CNullDriver::drawVertexPrimitiveList(0, vertexCount, 0, primitiveCount, vType, pType, iType);
+
+		setRenderStates3DMode();
+		return true;
+	}
+
+
+	void COpenGL3DriverBase::drawPrimitives(const void* indexList, u32 primitiveCount,
+			scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType, u32 instanceCount)
+	{
+		GLenum indexSize = 0;
+
+		switch (iType)
+		{
+			case(EIT_16BIT):
+			{
+				indexSize = GL_UNSIGNED_SHORT;
+				break;
+			}
+			case(EIT_32BIT):
+			{
+#ifdef GL_OES_element_index_uint
+#ifndef GL_UNSIGNED_INT
+#define GL_UNSIGNED_INT 0x1405
+#endif
+				if (FeatureAvailable[COGLESCoreExtensionHandler::IRR_GL_OES_element_index_uint])
+					indexSize = GL_UNSIGNED_INT;
+				else
+#endif
+					indexSize = GL_UNSIGNED_SHORT;
+				break;
+			}
+		}
+
+		GLenum mode;
+		switch (pType)
+		{
+			case scene::EPT_POINTS:
+			case scene::EPT_POINT_SPRITES:
+				mode = GL_POINTS;
+				break;
+			case scene::EPT_LINE_STRIP:
+				mode = GL_LINE_STRIP;
+				break;
+			case scene::EPT_LINE_LOOP:
+				mode = GL_LINE_LOOP;
+				break;
+			case scene::EPT_LINES:
+				mode = GL_LINES;
+				break;
+			case scene::EPT_TRIANGLE_STRIP:
+				mode = GL_TRIANGLE_STRIP;
+				break;
+			case scene::EPT_TRIANGLE_FAN:
+				mode = GL_TRIANGLE_FAN;
+				break;
+			case scene::EPT_TRIANGLES:
+				mode = (LastMaterial.Wireframe) ? GL_LINES : (LastMaterial.PointCloud) ? GL_POINTS : GL_TRIANGLES;
+				break;
+			default:
+				return;
+		}
+
+		const u32 indexCount = getIndexCount(pType, primitiveCount);
+		if (!indexCount)
+		{
+			if (instanceCount == 1)
+				glDrawArrays(mode, 0, primitiveCount);
+			else
+				GL.DrawArraysInstanced(mode, 0, primitiveCount, instanceCount);
+		}
+		else
+		{
+			if (instanceCount == 1)
+				glDrawElements(mode, indexCount, indexSize, indexList);
+			else
+				GL.DrawElementsInstanced(mode, indexCount, indexSize, indexList, instanceCount);
+		}
+	}
+
+
+	void COpenGL3DriverBase::draw2DImage(const video::ITexture* texture, const core::position2d<s32>& destPos,
+		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect, SColor color,
+		bool useAlphaChannelOfTexture)
+	{
+		if (!texture)
+			return;
+
+		if (!sourceRect.isValid())
+			return;
+
+		SColor colors[4] = {color, color, color, color};
+		draw2DImage(texture, {destPos, sourceRect.getSize()}, sourceRect, clipRect, colors, useAlphaChannelOfTexture);
+	}
+
+
+	void COpenGL3DriverBase::draw2DImage(const video::ITexture* texture, const core::rect<s32>& destRect,
+		const core::rect<s32>& sourceRect, const core::rect<s32>* clipRect,
+		const video::SColor* const colors, bool useAlphaChannelOfTexture)
+	{
+		if (!texture)
+			return;
+
+		// texcoords need to be flipped horizontally for RTTs
+		const bool isRTT = texture->isRenderTarget();
+
+		// draw from the atlas page if the texture was added to one
+		const video::ITexture* drawTexture = texture;
+		core::position2d<s32> origin(0, 0);
+		if (TextureAtlas && !isRTT)
+		{
+			if (const video::ITexture* page = TextureAtlas->find(texture, sourceRect, origin))
+				drawTexture = page;
+		}
+
+		const core::dimension2du& ss = drawTexture->getOriginalSize();
+		const f32 invW = 1.f / static_cast<f32>(ss.Width);
+		const f32 invH = 1.f / static_cast<f32>(ss.Height);
+		const core::rect<f32> tcoords(
+			(origin.X + sourceRect.UpperLeftCorner.X) * invW,
+			(origin.Y + (isRTT ? sourceRect.LowerRightCorner.Y : sourceRect.UpperLeftCorner.Y)) * invH,
+			(origin.X + sourceRect.LowerRightCorner.X) * invW,
+			(origin.Y + (isRTT ? sourceRect.UpperLeftCorner.Y : sourceRect.LowerRightCorner.Y)) *invH);
+
+		const video::SColor temp[4] =
+		{
+			0xFFFFFFFF,
+			0xFFFFFFFF,
+			0xFFFFFFFF,
+			0xFFFFFFFF
+		};
+
+		const video::SColor* const useColor = colors ? colors : temp;
+
+		if (texture->getDriverType() != getDriverType())
+			return;
+
+		if (clipRect && !clipRect->isValid())
+			return;
+
+		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+
+		f32 left = (f32)destRect.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+		f32 right = (f32)destRect.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+		f32 down = 2.f - (f32)destRect.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+		f32 top = 2.f - (f32)destRect.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+
+		S3DVertex vertices[4];
+		vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, useColor[0], tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y);
+		vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, useColor[3], tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y);
+		vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, useColor[2], tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y);
+		vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, useColor[1], tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y);
+
+		queue2DQuad(drawTexture, useColor[0].getAlpha() < 255 || useColor[1].getAlpha() < 255 ||
+			useColor[2].getAlpha() < 255 || useColor[3].getAlpha() < 255,
+			useAlphaChannelOfTexture, clipRect, vertices);
+	}
+
+	void COpenGL3DriverBase::draw2DImage(const video::ITexture* texture, u32 layer, bool flip)
+	{
+		if (!texture)
+			return;
+
+		chooseMaterial2D();
+		if (!setMaterialTexture(0, texture ))
+			return;
+
+		setRenderStates2DMode(false, true, true);
+
+		S3DVertex quad2DVertices[4];
+
+		quad2DVertices[0].Pos = core::vector3df(-1.f, 1.f, 0.f);
+		quad2DVertices[1].Pos = core::vector3df(1.f, 1.f, 0.f);
+		quad2DVertices[2].Pos = core::vector3df(1.f, -1.f, 0.f);
+		quad2DVertices[3].Pos = core::vector3df(-1.f, -1.f, 0.f);
+
+		f32 modificator = (flip) ? 1.f : 0.f;
+
+		quad2DVertices[0].TCoords = core::vector2df(0.f, 0.f + modificator);
+		quad2DVertices[1].TCoords = core::vector2df(1.f, 0.f + modificator);
+		quad2DVertices[2].TCoords = core::vector2df(1.f, 1.f - modificator);
+		quad2DVertices[3].TCoords = core::vector2df(0.f, 1.f - modificator);
+
+		quad2DVertices[0].Color = SColor(0xFFFFFFFF);
+		quad2DVertices[1].Color = SColor(0xFFFFFFFF);
+		quad2DVertices[2].Color = SColor(0xFFFFFFFF);
+		quad2DVertices[3].Color = SColor(0xFFFFFFFF);
+
+		drawQuad(vt2DImage, quad2DVertices);
+	}
+
+	void COpenGL3DriverBase::draw2DImageBatch(const video::ITexture* texture,
+			const core::array<core::position2d<s32> >& positions,
+			const core::array<core::rect<s32> >& sourceRects,
+			const core::rect<s32>* clipRect,
+			SColor color, bool useAlphaChannelOfTexture)
+	{
+		if (!texture || texture->getDriverType() != getDriverType())
+			return;
+
+		if (clipRect && !clipRect->isValid())
+			return;
+
+		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+
+		const irr::u32 drawCount = core::min_<u32>(positions.size(), sourceRects.size());
+
+		for (u32 i = 0; i < drawCount; i++)
+		{
+			core::position2d<s32> targetPos = positions[i];
+			core::position2d<s32> sourcePos = sourceRects[i].UpperLeftCorner;
+			// This needs to be signed as it may go negative.
+			core::dimension2d<s32> sourceSize(sourceRects[i].getSize());
+
+			// draw from the atlas page if the texture was added to one
+			const video::ITexture* drawTexture = texture;
+			core::position2d<s32> origin(0, 0);
+			if (TextureAtlas)
+			{
+				if (const video::ITexture* page = TextureAtlas->find(texture, sourceRects[i], origin))
+				{
+					drawTexture = page;
+					sourcePos += origin;
+				}
+			}
+
 			// now draw it.
 
-			core::rect<f32> tcoords;
-			tcoords.UpperLeftCorner.X = (((f32)sourcePos.X)) / texture->getOriginalSize().Width ;
-			tcoords.UpperLeftCorner.Y = (((f32)sourcePos.Y)) / texture->getOriginalSize().Height;
-			tcoords.LowerRightCorner.X = tcoords.UpperLeftCorner.X + ((f32)(sourceSize.Width) / texture->getOriginalSize().Width);
-			tcoords.LowerRightCorner.Y = tcoords.UpperLeftCorner.Y + ((f32)(sourceSize.Height) / texture->getOriginalSize().Height);
+			const core::dimension2du& ss = drawTexture->getOriginalSize();
+			core::rect<f32> tcoords;
+			tcoords.UpperLeftCorner.X = (((f32)sourcePos.X)) / ss.Width ;
+			tcoords.UpperLeftCorner.Y = (((f32)sourcePos.Y)) / ss.Height;
+			tcoords.LowerRightCorner.X = tcoords.UpperLeftCorner.X + ((f32)(sourceSize.Width) / ss.Width);
+			tcoords.LowerRightCorner.Y = tcoords.UpperLeftCorner.Y + ((f32)(sourceSize.Height) / ss.Height);
+
+			const core::rect<s32> poss(targetPos, sourceSize);
+
+			f32 left = (f32)poss.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+			f32 right = (f32)poss.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+			f32 down = 2.f - (f32)poss.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+			f32 top = 2.f - (f32)poss.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+
+			const S3DVertex vertices[4] = {
+				S3DVertex(left, top, 0.0f,
+					0.0f, 0.0f, 0.0f, color,
+					tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y),
+				S3DVertex(right, top, 0.0f,
+					0.0f, 0.0f, 0.0f, color,
+					tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y),
+				S3DVertex(right, down, 0.0f,
+					0.0f, 0.0f, 0.0f, color,
+					tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y),
+				S3DVertex(left, down, 0.0f,
+					0.0f, 0.0f, 0.0f, color,
+					tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y)
+			};
+
+			queue2DQuad(drawTexture, color.getAlpha() < 255, useAlphaChannelOfTexture, clipRect, vertices);
+		}
+	}
+
+
+	//! draw a 2d rectangle
+	void COpenGL3DriverBase::draw2DRectangle(SColor color,
+			const core::rect<s32>& position,
+			const core::rect<s32>* clip)
+	{
+		core::rect<s32> pos = position;
+
+		if (clip)
+			pos.clipAgainst(*clip);
+
+		if (!pos.isValid())
+			return;
+
+		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+
+		f32 left = (f32)pos.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+		f32 right = (f32)pos.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+		f32 down = 2.f - (f32)pos.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+		f32 top = 2.f - (f32)pos.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+
+		S3DVertex vertices[4];
+		vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, color, 0, 0);
+		vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, color, 0, 0);
+		vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, color, 0, 0);
+		vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, color, 0, 0);
+
+		queue2DQuad(0, color.getAlpha() < 255, false, 0, vertices);
+	}
+
+
+	//! draw an 2d rectangle
+	void COpenGL3DriverBase::draw2DRectangle(const core::rect<s32>& position,
+			SColor colorLeftUp, SColor colorRightUp,
+			SColor colorLeftDown, SColor colorRightDown,
+			const core::rect<s32>* clip)
+	{
+		core::rect<s32> pos = position;
+
+		if (clip)
+			pos.clipAgainst(*clip);
+
+		if (!pos.isValid())
+			return;
+
+		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+
+		f32 left = (f32)pos.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+		f32 right = (f32)pos.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+		f32 down = 2.f - (f32)pos.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+		f32 top = 2.f - (f32)pos.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+
+		S3DVertex vertices[4];
+		vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, colorLeftUp, 0, 0);
+		vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, colorRightUp, 0, 0);
+		vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, colorRightDown, 0, 0);
+		vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, colorLeftDown, 0, 0);
+
+		queue2DQuad(0, colorLeftUp.getAlpha() < 255 ||
+				colorRightUp.getAlpha() < 255 ||
+				colorLeftDown.getAlpha() < 255 ||
+				colorRightDown.getAlpha() < 255, false, 0, vertices);
+	}
+
+
+	//! Draws a 2d line.
+	void COpenGL3DriverBase::draw2DLine(const core::position2d<s32>& start,
+			const core::position2d<s32>& end, SColor color)
+	{
+		if (start==end)
+			drawPixel(start.X, start.Y, color);
+		else
+		{
+			chooseMaterial2D();
+			setMaterialTexture(0, 0);
+
+			setRenderStates2DMode(color.getAlpha() < 255, false, false);
+
+			const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
 
-			const core::rect<s32> poss(targetPos, sourceSize);
+			f32 startX = (f32)start.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+			f32 endX = (f32)end.X / (f32)renderTargetSize.Width * 2.f - 1.f;
+			f32 startY = 2.f - (f32)start.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+			f32 endY = 2.f - (f32)end.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
 
-			f32 left = (f32)poss.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-			f32 right = (f32)poss.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-			f32 down = 2.f - (f32)poss.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-			f32 top = 2.f - (f32)poss.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+			S3DVertex vertices[2];
+			vertices[0] = S3DVertex(startX, startY, 0, 0, 0, 1, color, 0, 0);
+			vertices[1] = S3DVertex(endX, endY, 0, 0, 0, 1, color, 1, 1);
 
-			vtx.push_back(S3DVertex(left, top, 0.0f,
-					0.0f, 0.0f, 0.0f, color,
-					tcoords.UpperLeftCorner.X, tcoords.UpperLeftCorner.Y));
-			vtx.push_back(S3DVertex(right, top, 0.0f,
-					0.0f, 0.0f, 0.0f, color,
-					tcoords.LowerRightCorner.X, tcoords.UpperLeftCorner.Y));
-			vtx.push_back(S3DVertex(right, down, 0.0f,
-					0.0f, 0.0f, 0.0f, color,
-					tcoords.LowerRightCorner.X, tcoords.LowerRightCorner.Y));
-			vtx.push_back(S3DVertex(left, down, 0.0f,
-					0.0f, 0.0f, 0.0f, color,
-					tcoords.UpperLeftCorner.X, tcoords.LowerRightCorner.Y));
+			drawArrays(GL_LINES, vtPrimitive, vertices, 2);
+		}
+	}
+
+
+	//! Draws a pixel
+	void COpenGL3DriverBase::drawPixel(u32 x, u32 y, const SColor &color)
+	{
+		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+		if (x > (u32)renderTargetSize.Width || y > (u32)renderTargetSize.Height)
+			return;
+
+		chooseMaterial2D();
+		setMaterialTexture(0, 0);
+
+		setRenderStates2DMode(color.getAlpha() < 255, false, false);
+
+		f32 X = (f32)x / (f32)renderTargetSize.Width * 2.f - 1.f;
+		f32 Y = 2.f - (f32)y / (f32)renderTargetSize.Height * 2.f - 1.f;
+
+		S3DVertex vertices[1];
+		vertices[0] = S3DVertex(X, Y, 0, 0, 0, 1, color, 0, 0);
+
+		drawArrays(GL_POINTS, vtPrimitive, vertices, 1);
+	}
+
+	void COpenGL3DriverBase::drawQuad(const VertexType &vertexType, const S3DVertex (&vertices)[4])
+	{
+		drawArrays(GL_TRIANGLE_FAN, vertexType, vertices, 4);
+	}
+
+	void COpenGL3DriverBase::queue2DQuad(const ITexture* texture, bool alpha, bool alphaChannel,
+			const core::rect<s32>* clipRect, const S3DVertex (&vertices)[4])
+	{
+		queue2DQuads(texture, alpha, alphaChannel, clipRect, vertices, 1);
+	}
+
+	void COpenGL3DriverBase::queue2DQuads(const ITexture* texture, bool alpha, bool alphaChannel,
+			const core::rect<s32>* clipRect, const S3DVertex* vertices, u32 quadCount)
+	{
+		if (!texture)
+			alphaChannel = false;
+
+		if (!Batch2D.Vertices.empty() && (Batch2D.Texture != texture ||
+				Batch2D.Alpha != alpha || Batch2D.AlphaChannel != alphaChannel ||
+				Batch2D.Clip != (clipRect != 0) || (clipRect && Batch2D.ClipRect != *clipRect)))
+			flush2DBatch();
+
+		const u32 maxVertices = QuadsIndices.size() / 6 * 4;
+		const u32 vertexCount = quadCount * 4;
+
+		for (u32 done = 0; done < vertexCount; )
+		{
+			if (Batch2D.Vertices.size() + 4 > maxVertices)
+				flush2DBatch();
+
+			if (Batch2D.Vertices.empty())
+			{
+				Batch2D.Texture = texture;
+				if (texture)
+					texture->grab();
+				Batch2D.Alpha = alpha;
+				Batch2D.AlphaChannel = alphaChannel;
+				Batch2D.Clip = clipRect != 0;
+				if (clipRect)
+					Batch2D.ClipRect = *clipRect;
+			}
+
+			const u32 count = core::min_(vertexCount - done, maxVertices - Batch2D.Vertices.size());
+			for (u32 i = 0; i < count; ++i)
+				Batch2D.Vertices.push_back(vertices[done + i]);
+			done += count;
+		}
+
+		for (u32 r = 0; r < Recordings2D.size(); ++r)
+		{
+			S2DDrawList& list = *Recordings2D[r];
+
+			// quads continuing the last batch of the list are merged into it
+			if (list.Batches.empty() || list.Batches.getLast().Texture != texture ||
+				list.Batches.getLast().Alpha != alpha || list.Batches.getLast().AlphaChannel != alphaChannel ||
+				list.Batches.getLast().Clip != (clipRect != 0) || (clipRect && list.Batches.getLast().ClipRect != *clipRect))
+			{
+				S2DDrawList::SBatch batch;
+				batch.Texture = texture;
+				batch.ClipRect = clipRect ? *clipRect : core::rect<s32>();
+				batch.FirstVertex = list.Vertices.size();
+				batch.VertexCount = 0;
+				batch.Alpha = alpha;
+				batch.AlphaChannel = alphaChannel;
+				batch.Clip = clipRect != 0;
+				list.Batches.push_back(batch);
+			}
+
+			list.Batches.getLast().VertexCount += vertexCount;
+			for (u32 i = 0; i < vertexCount; ++i)
+				list.Vertices.push_back(vertices[i]);
+		}
+	}
+
+	void COpenGL3DriverBase::fail2DRecordings()
+	{
+		for (u32 i = 0; i < Recordings2D.size(); ++i)
+			Recordings2D[i]->Valid = false;
+	}
+
+	bool COpenGL3DriverBase::beginRecording2D(S2DDrawList& list)
+	{
+		list.clear();
+		list.TargetSize = getCurrentRenderTargetSize();
+		list.Generation = Recording2DGeneration;
+		list.Valid = true;
+		Recordings2D.push_back(&list);
+		return true;
+	}
+
+	bool COpenGL3DriverBase::endRecording2D()
+	{
+		if (Recordings2D.empty())
+			return false;
+
+		const bool valid = Recordings2D.getLast()->Valid;
+		Recordings2D.erase(Recordings2D.size() - 1);
+		return valid;
+	}
+
+	bool COpenGL3DriverBase::drawRecording2D(const S2DDrawList& list)
+	{
+		if (!list.Valid || list.Generation != Recording2DGeneration || list.TargetSize != getCurrentRenderTargetSize())
+			return false;
+
+		for (u32 i = 0; i < list.Batches.size(); ++i)
+		{
+			const S2DDrawList::SBatch& batch = list.Batches[i];
+			queue2DQuads(batch.Texture, batch.Alpha, batch.AlphaChannel, batch.Clip ? &batch.ClipRect : 0,
+				list.Vertices.const_pointer() + batch.FirstVertex, batch.VertexCount / 4);
+		}
+
+		return true;
+	}
+
+	void COpenGL3DriverBase::flush2DBatch()
+	{
+		if (Batch2D.Vertices.empty())
+			return;
+
+		// The batch has to be empty before setting the states, as chooseMaterial2D flushes it.
+		Batch2DDrawVertices.swap(Batch2D.Vertices);
+		const ITexture* texture = Batch2D.Texture;
+		Batch2D.Texture = nullptr;
+
+		chooseMaterial2D();
+		if (setMaterialTexture(0, texture))
+		{
+			setRenderStates2DMode(Batch2D.Alpha, texture != 0, Batch2D.AlphaChannel);
+
+			if (Batch2D.Clip)
+				setScissor(&Batch2D.ClipRect);
+
+			const u32 vertexCount = Batch2DDrawVertices.size();
+			drawElements(GL_TRIANGLES, texture ? vt2DImage : vtPrimitive, Batch2DDrawVertices.const_pointer(),
+				vertexCount, QuadsIndices.data(), vertexCount / 4 * 6);
+
+			if (Batch2D.Clip)
+				setScissor(0);
+
+			testGLError(__LINE__);
+		}
+
+		Batch2DDrawVertices.set_used(0);
+		if (texture)
+			texture->drop();
+	}
+
+	void COpenGL3DriverBase::drawArrays(GLenum primitiveType, const VertexType &vertexType, const void *vertices, int vertexCount)
+	{
+		beginDraw(vertexType, streamVertices(vertexType, vertices, vertexCount));
+		glDrawArrays(primitiveType, 0, vertexCount);
+		++FrameStats.DrawCalls;
+		endDraw(vertexType);
+		endStreamDraw();
+	}
+
+	void COpenGL3DriverBase::drawElements(GLenum primitiveType, const VertexType &vertexType, const void *vertices, int vertexCount, const u16 *indices, int indexCount)
+	{
+		beginDraw(vertexType, streamVertices(vertexType, vertices, vertexCount));
+		glDrawElements(primitiveType, indexCount, GL_UNSIGNED_SHORT, streamIndices(indices, indexCount * sizeof(u16)));
+		++FrameStats.DrawCalls;
+		endDraw(vertexType);
+		endStreamDraw();
+	}
+
+	void COpenGL3DriverBase::initStreamBuffer()
+	{
+		// Regions are only reused once the GPU is done with them, which needs fences.
+		const bool isGLES = getDriverType() == EDT_OGLES2;
+		if (Version < (isGLES ? 300 : 320) || !GL.MapBufferRange || !GL.UnmapBuffer ||
+				!GL.FenceSync || !GL.ClientWaitSync || !GL.DeleteSync)
+			return;
+
+		const bool persistent = GL.BufferStorage && (isGLES ?
+			GL.IsExtensionPresent("GL_EXT_buffer_storage") :
+			Version >= 440 || GL.IsExtensionPresent("GL_ARB_buffer_storage"));
+		const GLsizeiptr size = StreamBuffer.Allocator.getSize();
+
+		glGenBuffers(1, &StreamBuffer.ID);
+		if (!StreamBuffer.ID)
+			return;
+		glBindBuffer(GL_ARRAY_BUFFER, StreamBuffer.ID);
+
+		if (persistent)
+		{
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			GL.BufferStorage(GL_ARRAY_BUFFER, size, nullptr, flags);
+			StreamBuffer.Mapped = static_cast<u8*>(GL.MapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+			if (!StreamBuffer.Mapped)
+			{
+				// immutable storage can't be respecified, so start over with a new name
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+				glDeleteBuffers(1, &StreamBuffer.ID);
+				glGenBuffers(1, &StreamBuffer.ID);
+				glBindBuffer(GL_ARRAY_BUFFER, StreamBuffer.ID);
+			}
+		}
+
+		if (!StreamBuffer.Mapped)
+			glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		if (testGLError(__LINE__))
+			deleteStreamBuffer();
+		else
+			os::Printer::log(StreamBuffer.Mapped ? "Using persistently mapped stream buffer." : "Using stream buffer.", ELL_DEBUG);
+	}
+
+	void COpenGL3DriverBase::deleteStreamBuffer()
+	{
+		for (GLsync &fence : StreamBuffer.Fences)
+		{
+			if (fence)
+				GL.DeleteSync(fence);
+			fence = nullptr;
+		}
+
+		if (StreamBuffer.ID)
+		{
+			if (StreamBuffer.Mapped)
+			{
+				glBindBuffer(GL_ARRAY_BUFFER, StreamBuffer.ID);
+				GL.UnmapBuffer(GL_ARRAY_BUFFER);
+				glBindBuffer(GL_ARRAY_BUFFER, 0);
+			}
+			glDeleteBuffers(1, &StreamBuffer.ID);
+		}
+
+		StreamBuffer = SStreamBuffer();
+	}
+
+	bool COpenGL3DriverBase::uploadStreamData(const void* data, u32 size, uintptr_t& offset)
+	{
+		u32 start;
+		if (!StreamBuffer.ID || !data || !StreamBuffer.Allocator.allocate(size, start))
+			return false;
+
+		offset = start;
+
+		if (StreamBuffer.Mapped)
+			memcpy(StreamBuffer.Mapped + offset, data, size);
+		else
+		{
+			// The region is fenced, so no synchronization is needed. Mapping through the copy
+			// target leaves the array buffer binding alone.
+			glBindBuffer(GL_COPY_WRITE_BUFFER, StreamBuffer.ID);
+			void* dst = GL.MapBufferRange(GL_COPY_WRITE_BUFFER, offset, size,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			if (dst)
+			{
+				memcpy(dst, data, size);
+				GL.UnmapBuffer(GL_COPY_WRITE_BUFFER);
+			}
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			if (!dst)
+				return false;
+		}
+
+		countBufferUpload(size, false);
+		return true;
+	}
+
+	void COpenGL3DriverBase::finishStreamFrame()
+	{
+		if (!StreamBuffer.ID)
+			return;
+
+		COpenGLCoreStreamAllocator &allocator = StreamBuffer.Allocator;
+		if (allocator.isRegionUsed())
+			StreamBuffer.Fences[allocator.getRegion()] = GL.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		const u32 region = allocator.nextRegion();
+
+		// this region was written StreamBufferRegions frames ago, usually it is long done
+		if (GLsync &fence = StreamBuffer.Fences[region])
+		{
+			GL.ClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+			GL.DeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	void COpenGL3DriverBase::queueTextureUpload(COpenGL3Texture* texture)
+	{
+		texture->grab();
+		TextureUploadQueue.push_back(texture);
+	}
+
+	void COpenGL3DriverBase::processTextureUploads()
+	{
+		processSharedContextUploads();
+
+		if (StagedTextureUploads.empty() && TextureUploadQueue.empty())
+			return;
+
+		// the buffers were filled a frame ago, so this doesn't wait for the copies
+		for (auto &upload : StagedTextureUploads)
+		{
+			glBindBuffer(GL.PIXEL_UNPACK_BUFFER, upload.Buffer);
+			upload.Texture->uploadPendingData(nullptr);
+			glBindBuffer(GL.PIXEL_UNPACK_BUFFER, 0);
+
+			upload.Texture->finishPendingUpload();
+			upload.Texture->drop();
+			FreeTextureUploadBuffers.push_back(upload.Buffer);
+		}
+		StagedTextureUploads.clear();
+
+		u32 budget = Params.TextureUploadBudget;
+		while (!TextureUploadQueue.empty())
+		{
+			COpenGL3Texture* texture = TextureUploadQueue.front();
+
+			// locking uploads the texture right away
+			if (texture->isReady())
+			{
+				TextureUploadQueue.pop_front();
+				texture->drop();
+				continue;
+			}
+
+			const u32 size = texture->getPendingUploadSize();
+			if (size > budget && !StagedTextureUploads.empty())
+				break;
+
+			TextureUploadQueue.pop_front();
+
+			STextureUpload upload;
+			upload.Texture = texture;
+			if (FreeTextureUploadBuffers.empty())
+			{
+				glGenBuffers(1, &upload.Buffer);
+			}
+			else
+			{
+				upload.Buffer = FreeTextureUploadBuffers.back();
+				FreeTextureUploadBuffers.pop_back();
+			}
+
+			glBindBuffer(GL.PIXEL_UNPACK_BUFFER, upload.Buffer);
+			glBufferData(GL.PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+			void* dst = GL.MapBufferRange(GL.PIXEL_UNPACK_BUFFER, 0, size, GL.MAP_WRITE_BIT | GL.MAP_INVALIDATE_BUFFER_BIT);
+			if (dst)
+			{
+				texture->writePendingUpload(dst);
+				GL.UnmapBuffer(GL.PIXEL_UNPACK_BUFFER);
+				StagedTextureUploads.push_back(upload);
+				countBufferUpload(size, false);
+			}
+			glBindBuffer(GL.PIXEL_UNPACK_BUFFER, 0);
+
+			if (!dst)
+			{
+				texture->finishPendingUpload();
+				texture->drop();
+				FreeTextureUploadBuffers.push_back(upload.Buffer);
+			}
+
+			budget -= core::min_(size, budget);
+		}
+
+		testGLError(__LINE__);
+	}
+
+	struct COpenGL3DriverBase::SSharedContextUpload
+	{
+		SSharedContextUpload(COpenGL3Texture* texture) : Texture(texture), Name(0), Fence(0) {}
+
+		//! Drops the images and the texture, on the thread of the driver
+		~SSharedContextUpload()
+		{
+			for (u32 i = 0; i < Data.Images.size(); ++i)
+				Data.Images[i]->drop();
+			Texture->drop();
+		}
+
+		COpenGL3Texture* Texture;
+		COpenGL3Texture::SPendingUpload Data;
+		GLuint Name;
+		GLsync Fence;
+	};
+
+	void COpenGL3DriverBase::processSharedContextUploads()
+	{
+		if (!UploadThread.joinable() && (TextureUploadQueue.empty() || !startUploadThread()))
+			return;
+
+		bool queued = false;
+		{
+			std::lock_guard<std::mutex> lock(UploadMutex);
+
+			if (queryFeature(EVDF_SHARED_CONTEXT_UPLOAD) && !TextureUploadQueue.empty())
+			{
+				std::deque<COpenGL3Texture*> remaining;
+				for (auto texture : TextureUploadQueue)
+				{
+					COpenGL3Texture::SPendingUpload data;
+					if (texture->getPendingUpload(data))
+					{
+						SSharedContextUpload* upload = new SSharedContextUpload(texture);
+						upload->Data = data;
+						UploadJobs.push_back(upload);
+						queued = true;
+					}
+					// uploaded already, or only this thread can upload it
+					else if (texture->isReady())
+						texture->drop();
+					else
+						remaining.push_back(texture);
+				}
+				TextureUploadQueue.swap(remaining);
+			}
+
+			FencedUploads.insert(FencedUploads.end(), FinishedUploads.begin(), FinishedUploads.end());
+			FinishedUploads.clear();
+		}
+
+		if (queued)
+			UploadWake.notify_one();
+
+		for (auto it = FencedUploads.begin(); it != FencedUploads.end();)
+		{
+			SSharedContextUpload* upload = *it;
+
+			GLenum status = GL._WAIT_FAILED;
+			if (upload->Fence)
+			{
+				status = GL.ClientWaitSync(upload->Fence, 0, 0);
+				if (status == GL.TIMEOUT_EXPIRED)
+				{
+					++it;
+					continue;
+				}
+				GL.DeleteSync(upload->Fence);
+			}
+
+			if (status == GL._WAIT_FAILED || !upload->Texture->adoptPendingUpload(upload->Name, upload->Data.DataRevision))
+			{
+				if (upload->Name)
+					glDeleteTextures(1, &upload->Name);
+
+				if (!upload->Texture->isReady())
+					queueTextureUpload(upload->Texture);
+			}
+
+			delete upload;
+			it = FencedUploads.erase(it);
+		}
+	}
+
+	bool COpenGL3DriverBase::startUploadThread()
+	{
+		if (UploadThread.joinable())
+			return true;
+
+		if (!queryFeature(EVDF_SHARED_CONTEXT_UPLOAD))
+			return false;
+
+		UploadContext = ContextManager->createSharedContext();
+		if (!UploadContext)
+		{
+			SharedContextUploadSupported = false;
+			return false;
+		}
+
+		UploadThreadQuit = false;
+		UploadThread = std::thread(&COpenGL3DriverBase::uploadThreadLoop, this);
+		return true;
+	}
+
+	void COpenGL3DriverBase::stopUploadThread()
+	{
+		if (!UploadThread.joinable())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(UploadMutex);
+			UploadThreadQuit = true;
 		}
+		UploadWake.notify_one();
+		UploadThread.join();
 
-		drawElements(GL_TRIANGLES, vt2DImage, vtx.const_pointer(), QuadsIndices.data(), 6 * drawCount);
+		ContextManager->destroySharedContext(UploadContext);
+		UploadContext = 0;
 
-		if (clipRect)
-			glDisable(GL_SCISSOR_TEST);
-	}
+		for (auto upload : UploadJobs)
+			delete upload;
+		UploadJobs.clear();
 
+		FencedUploads.insert(FencedUploads.end(), FinishedUploads.begin(), FinishedUploads.end());
+		FinishedUploads.clear();
+		for (auto upload : FencedUploads)
+		{
+			if (upload->Fence)
+				GL.DeleteSync(upload->Fence);
+			if (upload->Name)
+				glDeleteTextures(1, &upload->Name);
+			delete upload;
+		}
+		FencedUploads.clear();
+	}
 
-	//! draw a 2d rectangle
-	void COpenGL3DriverBase::draw2DRectangle(SColor color,
-			const core::rect<s32>& position,
-			const core::rect<s32>* clip)
+	void COpenGL3DriverBase::uploadThreadLoop()
 	{
-		chooseMaterial2D();
-		setMaterialTexture(0, 0);
-
-		setRenderStates2DMode(color.getAlpha() < 255, false, false);
-
-		core::rect<s32> pos = position;
+		// without the context the uploads come back empty and are done by the driver
+		const bool current = ContextManager->makeSharedContextCurrent(UploadContext);
 
-		if (clip)
-			pos.clipAgainst(*clip);
+		// rows of 8, 16 and 24 bit images don't always start at four byte boundaries
+		if (current)
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-		if (!pos.isValid())
-			return;
+		std::unique_lock<std::mutex> lock(UploadMutex);
+		for (;;)
+		{
+			UploadWake.wait(lock, [this] { return UploadThreadQuit || !UploadJobs.empty(); });
+			if (UploadThreadQuit)
+				break;
 
-		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+			SSharedContextUpload* upload = UploadJobs.front();
+			UploadJobs.pop_front();
 
-		f32 left = (f32)pos.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 right = (f32)pos.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 down = 2.f - (f32)pos.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-		f32 top = 2.f - (f32)pos.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+			lock.unlock();
+			if (current)
+				uploadOnSharedContext(*upload);
+			lock.lock();
 
-		S3DVertex vertices[4];
-		vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, color, 0, 0);
-		vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, color, 0, 0);
-		vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, color, 0, 0);
-		vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, color, 0, 0);
+			FinishedUploads.push_back(upload);
+		}
+		lock.unlock();
 
-		drawQuad(vtPrimitive, vertices);
+		if (current)
+			ContextManager->makeSharedContextCurrent(0);
 	}
 
-
-	//! draw an 2d rectangle
-	void COpenGL3DriverBase::draw2DRectangle(const core::rect<s32>& position,
-			SColor colorLeftUp, SColor colorRightUp,
-			SColor colorLeftDown, SColor colorRightDown,
-			const core::rect<s32>* clip)
+	void COpenGL3DriverBase::uploadOnSharedContext(SSharedContextUpload& upload)
 	{
-		core::rect<s32> pos = position;
-
-		if (clip)
-			pos.clipAgainst(*clip);
+		const COpenGL3Texture::SPendingUpload& data = upload.Data;
+		const u32 width = data.Size.Width;
+		const u32 height = data.Size.Height;
 
-		if (!pos.isValid())
-			return;
+		glGenTextures(1, &upload.Name);
+		glBindTexture(data.TextureType, upload.Name);
 
-		chooseMaterial2D();
-		setMaterialTexture(0, 0);
+		if (data.StorageLevels)
+			GL.TexStorage2D(data.TextureType, data.StorageLevels, data.InternalFormat, width, height);
 
-		setRenderStates2DMode(colorLeftUp.getAlpha() < 255 ||
-				colorRightUp.getAlpha() < 255 ||
-				colorLeftDown.getAlpha() < 255 ||
-				colorRightDown.getAlpha() < 255, false, false);
+		std::vector<u8> converted(data.Converter ? data.LayerSize : 0);
+		for (u32 i = 0; i < data.Images.size(); ++i)
+		{
+			const GLenum target = (data.TextureType == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + i : data.TextureType;
 
-		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+			const void* pixels = data.Images[i]->getData();
+			if (data.Converter)
+			{
+				data.Converter(pixels, data.Size.getArea(), converted.data());
+				pixels = converted.data();
+			}
 
-		f32 left = (f32)pos.UpperLeftCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 right = (f32)pos.LowerRightCorner.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 down = 2.f - (f32)pos.LowerRightCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-		f32 top = 2.f - (f32)pos.UpperLeftCorner.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+			if (data.StorageLevels)
+				glTexSubImage2D(target, 0, 0, 0, width, height, data.PixelFormat, data.PixelType, pixels);
+			else
+				glTexImage2D(target, 0, data.InternalFormat, width, height, 0, data.PixelFormat, data.PixelType, pixels);
+		}
 
-		S3DVertex vertices[4];
-		vertices[0] = S3DVertex(left, top, 0, 0, 0, 1, colorLeftUp, 0, 0);
-		vertices[1] = S3DVertex(right, top, 0, 0, 0, 1, colorRightUp, 0, 0);
-		vertices[2] = S3DVertex(right, down, 0, 0, 0, 1, colorRightDown, 0, 0);
-		vertices[3] = S3DVertex(left, down, 0, 0, 0, 1, colorLeftDown, 0, 0);
+		glBindTexture(data.TextureType, 0);
 
-		drawQuad(vtPrimitive, vertices);
+		// the driver adopts the texture once the fence shows the data arrived
+		upload.Fence = GL.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
 	}
 
-
-	//! Draws a 2d line.
-	void COpenGL3DriverBase::draw2DLine(const core::position2d<s32>& start,
-			const core::position2d<s32>& end, SColor color)
+	void COpenGL3DriverBase::processMipStreaming()
 	{
-		if (start==end)
-			drawPixel(start.X, start.Y, color);
-		else
-		{
-			chooseMaterial2D();
-			setMaterialTexture(0, 0);
+		if (StreamedTextures.empty())
+			return;
 
-			setRenderStates2DMode(color.getAlpha() < 255, false, false);
+		u32 streamedDataSize = 0;
+		for (auto texture : StreamedTextures)
+			streamedDataSize += texture->getStreamedDataSize();
 
-			const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
+		const u32 limit = Params.TextureStreamingBudget;
+		while (limit && streamedDataSize > limit && dropStreamedLevel(streamedDataSize, false))
+			;
 
-			f32 startX = (f32)start.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-			f32 endX = (f32)end.X / (f32)renderTargetSize.Width * 2.f - 1.f;
-			f32 startY = 2.f - (f32)start.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
-			f32 endY = 2.f - (f32)end.Y / (f32)renderTargetSize.Height * 2.f - 1.f;
+		// one level per texture and frame, so requests of all textures are served evenly
+		u32 budget = Params.TextureUploadBudget;
+		bool uploaded = false;
+		for (auto texture : StreamedTextures)
+		{
+			const u32 level = texture->getStreamedLevel();
+			if (texture->getRequestedLevel() >= level)
+				continue;
 
-			S3DVertex vertices[2];
-			vertices[0] = S3DVertex(startX, startY, 0, 0, 0, 1, color, 0, 0);
-			vertices[1] = S3DVertex(endX, endY, 0, 0, 0, 1, color, 1, 1);
+			const u32 growth = texture->getLevelDataSize(level - 1);
+			if (limit)
+			{
+				while (streamedDataSize + growth > limit && dropStreamedLevel(streamedDataSize, true))
+					;
 
-			drawArrays(GL_LINES, vtPrimitive, vertices, 2);
+				if (streamedDataSize + growth > limit)
+					continue;
+			}
+
+			// all uploaded levels are copied into the new storage
+			const u32 uploadSize = texture->getStreamedDataSize() + growth;
+			if (uploadSize > budget && uploaded)
+				break;
+
+			texture->setStreamedLevel(level - 1);
+			streamedDataSize += growth;
+			budget -= core::min_(uploadSize, budget);
+			uploaded = true;
 		}
 	}
 
-
-	//! Draws a pixel
-	void COpenGL3DriverBase::drawPixel(u32 x, u32 y, const SColor &color)
+	bool COpenGL3DriverBase::dropStreamedLevel(u32& streamedDataSize, bool onlyUnneeded)
 	{
-		const core::dimension2d<u32>& renderTargetSize = getCurrentRenderTargetSize();
-		if (x > (u32)renderTargetSize.Width || y > (u32)renderTargetSize.Height)
-			return;
+		COpenGL3Texture* victim = 0;
+		s32 victimExcess = 0;
 
-		chooseMaterial2D();
-		setMaterialTexture(0, 0);
+		for (auto texture : StreamedTextures)
+		{
+			const u32 level = texture->getStreamedLevel();
+			if (level + 1 >= texture->getMipLevelCount())
+				continue;
 
-		setRenderStates2DMode(color.getAlpha() < 255, false, false);
+			const s32 excess = (s32)texture->getRequestedLevel() - (s32)level;
+			if (onlyUnneeded && excess <= 0)
+				continue;
 
-		f32 X = (f32)x / (f32)renderTargetSize.Width * 2.f - 1.f;
-		f32 Y = 2.f - (f32)y / (f32)renderTargetSize.Height * 2.f - 1.f;
+			if (!victim || excess > victimExcess)
+			{
+				victim = texture;
+				victimExcess = excess;
+			}
+		}
 
-		S3DVertex vertices[1];
-		vertices[0] = S3DVertex(X, Y, 0, 0, 0, 1, color, 0, 0);
+		if (!victim)
+			return false;
 
-		drawArrays(GL_POINTS, vtPrimitive, vertices, 1);
+		streamedDataSize -= victim->getLevelDataSize(victim->getStreamedLevel());
+		victim->setStreamedLevel(victim->getStreamedLevel() + 1);
+		return true;
 	}
 
-	void COpenGL3DriverBase::drawQuad(const VertexType &vertexType, const S3DVertex (&vertices)[4])
+	uintptr_t COpenGL3DriverBase::streamVertices(const VertexType &vertexType, const void* vertices, u32 vertexCount)
 	{
-		drawArrays(GL_TRIANGLE_FAN, vertexType, vertices, 4);
+		FrameStats.VerticesUploaded += vertexCount;
+
+		uintptr_t offset;
+		if (!uploadStreamData(vertices, vertexCount * vertexType.VertexSize, offset))
+			return reinterpret_cast<uintptr_t>(vertices);
+
+		glBindBuffer(GL_ARRAY_BUFFER, StreamBuffer.ID);
+		return offset;
 	}
 
-	void COpenGL3DriverBase::drawArrays(GLenum primitiveType, const VertexType &vertexType, const void *vertices, int vertexCount)
+	const void* COpenGL3DriverBase::streamIndices(const void* indices, u32 size)
 	{
-		beginDraw(vertexType, reinterpret_cast<uintptr_t>(vertices));
-		glDrawArrays(primitiveType, 0, vertexCount);
-		endDraw(vertexType);
+		uintptr_t offset;
+		if (!uploadStreamData(indices, size, offset))
+			return indices;
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, StreamBuffer.ID);
+		return reinterpret_cast<const void*>(offset);
 	}
 
-	void COpenGL3DriverBase::drawElements(GLenum primitiveType, const VertexType &vertexType, const void *vertices, const u16 *indices, int indexCount)
+	void COpenGL3DriverBase::endStreamDraw()
 	{
-		beginDraw(vertexType, reinterpret_cast<uintptr_t>(vertices));
-		glDrawElements(primitiveType, indexCount, GL_UNSIGNED_SHORT, indices);
-		endDraw(vertexType);
+		if (!StreamBuffer.ID)
+			return;
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
 	void COpenGL3DriverBase::beginDraw(const VertexType &vertexType, uintptr_t verticesBase)
 	{
+		// flush2DBatch is the only draw whose vertices are in Batch2DDrawVertices
+		if (Batch2DDrawVertices.empty())
+			fail2DRecordings();
+
 		for (auto attr: vertexType) {
 			glEnableVertexAttribArray(attr.Index);
 			switch (attr.mode) {
@@ -1188,6 +3929,25 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		}
 	}
 
+	void COpenGL3DriverBase::beginDrawStreams(const VertexType &vertexType, uintptr_t verticesBase, u32 vertexCount, bool positionsOnly)
+	{
+		fail2DRecordings();
+
+		for (auto attr: vertexType) {
+			if (positionsOnly && attr.Index != EVA_POSITION)
+				break;
+			// each stream is tightly packed, so the stride is the attribute size
+			const GLsizei stride = getAttributeSize(attr);
+			glEnableVertexAttribArray(attr.Index);
+			switch (attr.mode) {
+			case VertexAttribute::Mode::Regular: glVertexAttribPointer(attr.Index, attr.ComponentCount, attr.ComponentType, GL_FALSE, stride, reinterpret_cast<void *>(verticesBase)); break;
+			case VertexAttribute::Mode::Normalized: glVertexAttribPointer(attr.Index, attr.ComponentCount, attr.ComponentType, GL_TRUE, stride, reinterpret_cast<void *>(verticesBase)); break;
+			case VertexAttribute::Mode::Integral: glVertexAttribIPointer(attr.Index, attr.ComponentCount, attr.ComponentType, stride, reinterpret_cast<void *>(verticesBase)); break;
+			}
+			verticesBase += getAttributeStreamSize(attr, vertexCount);
+		}
+	}
+
 	void COpenGL3DriverBase::endDraw(const VertexType &vertexType)
 	{
 		for (auto attr: vertexType)
@@ -1200,6 +3960,7 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		imageArray.push_back(image);
 
 		COpenGL3Texture* texture = new COpenGL3Texture(name, imageArray, ETT_2D, this);
+		registerTexture(texture, image);
 
 		return texture;
 	}
@@ -1207,27 +3968,112 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	ITexture* COpenGL3DriverBase::createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image)
 	{
 		COpenGL3Texture* texture = new COpenGL3Texture(name, image, ETT_CUBEMAP, this);
+		registerTexture(texture, 0);
 
 		return texture;
 	}
 
+	bool COpenGL3DriverBase::replaceTexture(ITexture* texture, const core::array<IImage*>& images, E_TEXTURE_TYPE type)
+	{
+		flush2DBatch();
+		flush3DLines();
+
+		// uploaded over the next frames, so the placeholder stays until then
+		const bool deferredUpload = getTextureCreationFlag(ETCF_DEFERRED_UPLOAD);
+		setTextureCreationFlag(ETCF_DEFERRED_UPLOAD, true);
+		COpenGL3Texture* loaded = new COpenGL3Texture(texture->getName(), images, type, this);
+		setTextureCreationFlag(ETCF_DEFERRED_UPLOAD, deferredUpload);
+
+		// the placeholder was created without ETCF_DEFERRED_UPLOAD, so it isn't queued
+		unregisterTexture(texture);
+		COpenGL3Texture* placeholder = static_cast<COpenGL3Texture*>(texture);
+		placeholder->swapTexture(*loaded);
+		loaded->drop();
+
+		registerTexture(placeholder, type == ETT_2D ? images[0] : 0);
+		return true;
+	}
+
+	void COpenGL3DriverBase::registerTexture(COpenGL3Texture* texture, IImage* atlasImage)
+	{
+		if (!texture->isReady())
+			queueTextureUpload(texture);
+
+		if (texture->isMipStreamed())
+		{
+			texture->grab();
+			StreamedTextures.push_back(texture);
+		}
+
+		TextureResidency->add(texture);
+
+		if (atlasImage && TextureAtlas && getTextureCreationFlag(ETCF_ALLOW_ATLAS) && !texture->isDistanceField())
+			TextureAtlas->add(texture, atlasImage);
+	}
+
+	void COpenGL3DriverBase::unregisterTexture(ITexture* texture)
+	{
+		++Recording2DGeneration;
+
+		if (TextureAtlas)
+			TextureAtlas->remove(texture);
+		if (TextureResidency)
+			TextureResidency->remove(texture);
+
+		auto it = std::find(StreamedTextures.begin(), StreamedTextures.end(), texture);
+		if (it != StreamedTextures.end())
+		{
+			(*it)->drop();
+			StreamedTextures.erase(it);
+		}
+
+		CacheHandler->getTextureCache().remove(texture);
+	}
+
 	//! Sets a material.
 	void COpenGL3DriverBase::setMaterial(const SMaterial& material)
 	{
-		Material = material;
-		OverrideMaterial.apply(Material);
+		IRR_PROFILE_SCOPE("COpenGL3DriverBase::setMaterial");
+		flush2DBatch();
 
-		for (u32 i = 0; i < Feature.MaxTextureUnits; ++i)
+		// draws in a row mostly use the same material, which then needs neither
+		// a copy nor a new revision, so the render states aren't compared again
+		bool changed;
+		if (!OverrideMaterial.Enabled)
 		{
-			CacheHandler->getTextureCache().set(i, material.getTexture(i));
-			setTransform((E_TRANSFORMATION_STATE)(ETS_TEXTURE_0 + i), material.getTextureMatrix(i));
+			changed = Material != material;
+			if (changed)
+			{
+				flush3DLines();
+				Material = material;
+			}
+		}
+		else
+		{
+			SMaterial overridden(material);
+			OverrideMaterial.apply(overridden);
+			changed = Material != overridden;
+			if (changed)
+			{
+				flush3DLines();
+				Material = std::move(overridden);
+			}
 		}
+
+		if (changed)
+		{
+			MaterialStateKey = getMaterialStateKey(Material);
+			++MaterialRevision;
+		}
+
+		CacheHandler->getTextureCache().setMaterialTextures(material);
+		for (u32 i = 0; i < Feature.MaxTextureUnits; ++i)
+			setTransform((E_TRANSFORMATION_STATE)(ETS_TEXTURE_0 + i), material.getTextureMatrix(i));
 	}
 
 	//! prints error if an error happened.
-	bool COpenGL3DriverBase::testGLError(int code)
+	bool COpenGL3DriverBase::queryGLError(int code)
 	{
-#ifdef _DEBUG
 		GLenum g = glGetError();
 		switch (g)
 		{
@@ -1247,9 +4093,6 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 				break;
 		};
 		return true;
-#else
-		return false;
-#endif
 	}
 
 	//! prints error if an error happened.
@@ -1313,6 +4156,9 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 
 	void COpenGL3DriverBase::setRenderStates3DMode()
 	{
+		flush2DBatch();
+		flush3DLines();
+
 		if ( LockRenderStateMode )
 			return;
 
@@ -1325,7 +4171,12 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 			ResetRenderStates = true;
 		}
 
-		if (ResetRenderStates || LastMaterial != Material)
+		// skinned and compact buffers use variants of the material, fog and textures pick a permutation of it
+		const E_MATERIAL_VARIANT variant = getDrawMaterialVariant();
+		const u32 permutation = getMaterialPermutation(Material);
+
+		if (ResetRenderStates || LastMaterialRevision != MaterialRevision || variant != LastMaterialVariant ||
+			permutation != LastMaterialPermutation)
 		{
 			// unset old material
 
@@ -1335,31 +4186,59 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 				MaterialRenderer2DActive->OnUnsetMaterial();
 				MaterialRenderer2DActive = 0;
 			}
-			else if (LastMaterial.MaterialType != Material.MaterialType &&
+			else if ((LastMaterial.MaterialType != Material.MaterialType || variant != LastMaterialVariant ||
+						permutation != LastMaterialPermutation) &&
 					static_cast<u32>(LastMaterial.MaterialType) < MaterialRenderers.size())
-				MaterialRenderers[LastMaterial.MaterialType].Renderer->OnUnsetMaterial();
+				getActiveMaterialRenderer(LastMaterial.MaterialType, LastMaterialVariant, LastMaterialPermutation)->OnUnsetMaterial();
 
 			// set new material.
 			if (static_cast<u32>(Material.MaterialType) < MaterialRenderers.size())
-				MaterialRenderers[Material.MaterialType].Renderer->OnSetMaterial(
+				getActiveMaterialRenderer(Material.MaterialType, variant, permutation)->OnSetMaterial(
 					Material, LastMaterial, ResetRenderStates, this);
 
 			LastMaterial = Material;
-			CacheHandler->correctCacheMaterial(LastMaterial);
+			LastMaterialVariant = variant;
+			LastMaterialPermutation = permutation;
+			++FrameStats.MaterialChanges;
+			// textures removed in the meantime make the materials differ
+			LastMaterialRevision = CacheHandler->correctCacheMaterial(LastMaterial) ? MaterialRevision - 1 : MaterialRevision;
 			ResetRenderStates = false;
 		}
 
 		if (static_cast<u32>(Material.MaterialType) < MaterialRenderers.size())
-			MaterialRenderers[Material.MaterialType].Renderer->OnRender(this, video::EVT_STANDARD);
+			getActiveMaterialRenderer(Material.MaterialType, variant, permutation)->OnRender(this, video::EVT_STANDARD);
 
 		CurrentRenderMode = ERM_3D;
 	}
 
-	//! Can be called by an IMaterialRenderer to make its work easier.
-	void COpenGL3DriverBase::setBasicRenderStates(const SMaterial& material, const SMaterial& lastmaterial, bool resetAllRenderStates)
+	// Layout of the material state key, each field is handled by one applier
+	enum E_MATERIAL_STATE_KEY_FIELD
+	{
+		EMSK_DEPTH_FUNC_SHIFT = 0,
+		EMSK_DEPTH_MASK_SHIFT = 4,
+		EMSK_CULL_FACE_SHIFT = 5,
+		EMSK_COLOR_MASK_SHIFT = 7,
+		EMSK_ALPHA_TO_COVERAGE_SHIFT = 11,
+		EMSK_LINE_WIDTH_SHIFT = 32
+	};
+
+
+	u64 COpenGL3DriverBase::getMaterialStateKey(const SMaterial& material) const
+	{
+		const u32 cullFaces = (material.BackfaceCulling ? 1 : 0) | (material.FrontfaceCulling ? 2 : 0);
+
+		return (u64)(getDepthComparison(material) & 0xF) << EMSK_DEPTH_FUNC_SHIFT |
+			(u64)(getWriteZBuffer(material) ? 1 : 0) << EMSK_DEPTH_MASK_SHIFT |
+			(u64)cullFaces << EMSK_CULL_FACE_SHIFT |
+			(u64)(material.ColorMask & 0xF) << EMSK_COLOR_MASK_SHIFT |
+			(u64)((material.AntiAliasing & EAAM_ALPHA_TO_COVERAGE) ? 1 : 0) << EMSK_ALPHA_TO_COVERAGE_SHIFT |
+			(u64)(u32)IR(material.Thickness) << EMSK_LINE_WIDTH_SHIFT;
+	}
+
+
+	void COpenGL3DriverBase::applyDepthFunc(u32 zbuffer)
 	{
-		// ZBuffer
-		switch (material.ZBuffer)
+		switch (zbuffer)
 		{
 			case ECFN_DISABLED:
 				CacheHandler->setDepthTest(false);
@@ -1399,41 +4278,89 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 			default:
 				break;
 		}
+	}
 
-		// ZWrite
-		if (getWriteZBuffer(material))
-		{
-			CacheHandler->setDepthMask(true);
-		}
-		else
-		{
-			CacheHandler->setDepthMask(false);
-		}
 
-		// Back face culling
-		if ((material.FrontfaceCulling) && (material.BackfaceCulling))
+	void COpenGL3DriverBase::applyDepthMask(u32 enable)
+	{
+		CacheHandler->setDepthMask(enable != 0);
+	}
+
+
+	void COpenGL3DriverBase::applyCullFace(u32 faces)
+	{
+		switch (faces)
 		{
-			CacheHandler->setCullFaceFunc(GL_FRONT_AND_BACK);
-			CacheHandler->setCullFace(true);
+			case 3:
+				CacheHandler->setCullFaceFunc(GL_FRONT_AND_BACK);
+				CacheHandler->setCullFace(true);
+				break;
+			case 1:
+				CacheHandler->setCullFaceFunc(GL_BACK);
+				CacheHandler->setCullFace(true);
+				break;
+			case 2:
+				CacheHandler->setCullFaceFunc(GL_FRONT);
+				CacheHandler->setCullFace(true);
+				break;
+			default:
+				CacheHandler->setCullFace(false);
+				break;
 		}
-		else if (material.BackfaceCulling)
+	}
+
+
+	void COpenGL3DriverBase::applyColorMask(u32 colorMask)
+	{
+		CacheHandler->setColorMask((E_COLOR_PLANE)colorMask);
+	}
+
+
+	void COpenGL3DriverBase::applyAlphaToCoverage(u32 enable)
+	{
+		CacheHandler->setAlphaToCoverage(enable != 0);
+	}
+
+
+	void COpenGL3DriverBase::applyLineWidth(u32 thickness)
+	{
+		glLineWidth(core::clamp(static_cast<GLfloat>(FR(thickness)), DimAliasedLine[0], DimAliasedLine[1]));
+	}
+
+
+	//! Can be called by an IMaterialRenderer to make its work easier.
+	void COpenGL3DriverBase::setBasicRenderStates(const SMaterial& material, const SMaterial& lastmaterial, bool resetAllRenderStates)
+	{
+		struct SStateField
 		{
-			CacheHandler->setCullFaceFunc(GL_BACK);
-			CacheHandler->setCullFace(true);
-		}
-		else if (material.FrontfaceCulling)
+			u32 Shift;
+			u64 Mask;
+			void (COpenGL3DriverBase::*Apply)(u32 value);
+		};
+
+		static const SStateField fields[] =
 		{
-			CacheHandler->setCullFaceFunc(GL_FRONT);
-			CacheHandler->setCullFace(true);
-		}
-		else
+			{EMSK_DEPTH_FUNC_SHIFT, 0xF, &COpenGL3DriverBase::applyDepthFunc},
+			{EMSK_DEPTH_MASK_SHIFT, 0x1, &COpenGL3DriverBase::applyDepthMask},
+			{EMSK_CULL_FACE_SHIFT, 0x3, &COpenGL3DriverBase::applyCullFace},
+			{EMSK_COLOR_MASK_SHIFT, 0xF, &COpenGL3DriverBase::applyColorMask},
+			{EMSK_ALPHA_TO_COVERAGE_SHIFT, 0x1, &COpenGL3DriverBase::applyAlphaToCoverage},
+			{EMSK_LINE_WIDTH_SHIFT, 0xFFFFFFFF, &COpenGL3DriverBase::applyLineWidth},
+		};
+
+		// Only the fields which differ from the applied states are set again.
+		const u64 key = (&material == &Material) ? MaterialStateKey : getMaterialStateKey(material);
+		const u64 changed = resetAllRenderStates ? ~(u64)0 : key ^ AppliedStateKey;
+		if (changed)
 		{
-			CacheHandler->setCullFace(false);
+			for (const SStateField &field : fields)
+			{
+				if ((changed >> field.Shift) & field.Mask)
+					(this->*field.Apply)((u32)((key >> field.Shift) & field.Mask));
+			}
+			AppliedStateKey = key;
 		}
 
-		// Color Mask
-		CacheHandler->setColorMask(material.ColorMask);
-
 		// Blend Equation
 		if (material.BlendOperation == EBO_NONE)
 			CacheHandler->setBlend(false);
@@ -1471,31 +4398,124 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 
 		    unpack_textureBlendFuncSeparate(srcRGBFact, dstRGBFact, srcAlphaFact, dstAlphaFact, modulo, alphaSource, material.BlendFactor);
 
-			CacheHandler->setBlendFuncSeparate(getGLBlend(srcRGBFact), getGLBlend(dstRGBFact),
-				getGLBlend(srcAlphaFact), getGLBlend(dstAlphaFact));
-		}
+			CacheHandler->setBlendFuncSeparate(getGLBlend(srcRGBFact), getGLBlend(dstRGBFact),
+				getGLBlend(srcAlphaFact), getGLBlend(dstAlphaFact));
+		}
+
+		// TODO: Polygon Offset. Not sure if it was left out deliberately or if it won't work with this driver.
+
+		// Texture parameters
+		setTextureRenderStates(material, resetAllRenderStates);
+	}
+
+	// Layout of the sampler key
+	enum E_SAMPLER_KEY_FIELD
+	{
+		ESK_WRAP_U_SHIFT = 0,
+		ESK_WRAP_V_SHIFT = 4,
+		ESK_WRAP_W_SHIFT = 8,
+		ESK_BILINEAR_SHIFT = 12,
+		ESK_TRILINEAR_SHIFT = 13,
+		ESK_MIPMAPS_SHIFT = 14,
+		ESK_ANISOTROPY_SHIFT = 16,
+		ESK_LOD_BIAS_SHIFT = 24
+	};
+
+
+	u32 COpenGL3DriverBase::getSamplerKey(const SMaterialLayer& layer, bool mipMaps) const
+	{
+		return (layer.TextureWrapU & 0xF) << ESK_WRAP_U_SHIFT |
+			(layer.TextureWrapV & 0xF) << ESK_WRAP_V_SHIFT |
+			(layer.TextureWrapW & 0xF) << ESK_WRAP_W_SHIFT |
+			(layer.BilinearFilter ? 1 : 0) << ESK_BILINEAR_SHIFT |
+			(layer.TrilinearFilter ? 1 : 0) << ESK_TRILINEAR_SHIFT |
+			(mipMaps ? 1 : 0) << ESK_MIPMAPS_SHIFT |
+			(u32)layer.AnisotropicFilter << ESK_ANISOTROPY_SHIFT |
+			(u32)(u8)layer.LODBias << ESK_LOD_BIAS_SHIFT;
+	}
+
+
+	GLuint COpenGL3DriverBase::getSampler(u32 key)
+	{
+		auto it = Samplers.find(key);
+		if (it != Samplers.end())
+			return it->second;
+
+		GLuint sampler = 0;
+		GL.GenSamplers(1, &sampler);
+
+		const bool bilinear = (key >> ESK_BILINEAR_SHIFT) & 1;
+		const bool trilinear = (key >> ESK_TRILINEAR_SHIFT) & 1;
+		const bool mipMaps = (key >> ESK_MIPMAPS_SHIFT) & 1;
+		const u8 anisotropy = (key >> ESK_ANISOTROPY_SHIFT) & 0xFF;
+		const s8 lodBias = (s8)((key >> ESK_LOD_BIAS_SHIFT) & 0xFF);
+
+		GL.SamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, (bilinear || trilinear) ? GL_LINEAR : GL_NEAREST);
+		if (mipMaps)
+			GL.SamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER,
+				trilinear ? GL_LINEAR_MIPMAP_LINEAR :
+				bilinear ? GL_LINEAR_MIPMAP_NEAREST :
+				GL_NEAREST_MIPMAP_NEAREST);
+		else
+			GL.SamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, (bilinear || trilinear) ? GL_LINEAR : GL_NEAREST);
+
+		GL.SamplerParameteri(sampler, GL_TEXTURE_WRAP_S, getTextureWrapMode((key >> ESK_WRAP_U_SHIFT) & 0xF));
+		GL.SamplerParameteri(sampler, GL_TEXTURE_WRAP_T, getTextureWrapMode((key >> ESK_WRAP_V_SHIFT) & 0xF));
+		GL.SamplerParameteri(sampler, GL.TEXTURE_WRAP_R, getTextureWrapMode((key >> ESK_WRAP_W_SHIFT) & 0xF));
 
-		// TODO: Polygon Offset. Not sure if it was left out deliberately or if it won't work with this driver.
+	#ifdef GL_EXT_texture_filter_anisotropic
+		if (FeatureAvailable[COGLESCoreExtensionHandler::IRR_GL_EXT_texture_filter_anisotropic])
+			GL.SamplerParameteri(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy > 1 ? core::min_(MaxAnisotropy, anisotropy) : 1);
+	#endif
 
-		if (resetAllRenderStates || lastmaterial.Thickness != material.Thickness)
-			glLineWidth(core::clamp(static_cast<GLfloat>(material.Thickness), DimAliasedLine[0], DimAliasedLine[1]));
+		// OpenGL ES has no LOD bias sampler state
+		if (getDriverType() != EDT_OGLES2 && lodBias)
+			GL.SamplerParameterf(sampler, GL.TEXTURE_LOD_BIAS,
+				core::clamp(lodBias * 0.125f, -MaxTextureLODBias, MaxTextureLODBias));
 
-		// Anti aliasing
-		if (resetAllRenderStates || lastmaterial.AntiAliasing != material.AntiAliasing)
-		{
-			if (material.AntiAliasing & EAAM_ALPHA_TO_COVERAGE)
-				glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-			else if (lastmaterial.AntiAliasing & EAAM_ALPHA_TO_COVERAGE)
-				glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
-		}
+		testGLError(__LINE__);
 
-		// Texture parameters
-		setTextureRenderStates(material, resetAllRenderStates);
+		Samplers[key] = sampler;
+		return sampler;
 	}
 
+
 	//! Compare in SMaterial doesn't check texture parameters, so we should call this on each OnRender call.
 	void COpenGL3DriverBase::setTextureRenderStates(const SMaterial& material, bool resetAllRenderstates)
 	{
+		if (SamplerObjectsSupported)
+		{
+			// with multi-bind the changed units are bound at once, the ones between keep their samplers
+			u32 first = Feature.MaxTextureUnits;
+			u32 last = 0;
+
+			for (u32 i = 0; i < Feature.MaxTextureUnits; ++i)
+			{
+				const COpenGL3Texture* tmpTexture = CacheHandler->getTextureCache()[i];
+				if (!tmpTexture)
+					continue;
+
+				const u32 key = getSamplerKey(material.TextureLayer[i], material.UseMipMaps && tmpTexture->hasMipMaps());
+				if (resetAllRenderstates || BoundSamplerKeys[i] != key)
+				{
+					BoundSamplers[i] = getSampler(key);
+					BoundSamplerKeys[i] = key;
+
+					if (Feature.MultiBind)
+					{
+						first = core::min_(first, i);
+						last = i;
+					}
+					else
+						GL.BindSampler(i, BoundSamplers[i]);
+				}
+			}
+
+			if (first <= last)
+				GL.BindSamplers(first, last - first + 1, BoundSamplers + first);
+			return;
+		}
+
 		// Set textures to TU/TIU and apply filters to them
 
 		for (s32 i = Feature.MaxTextureUnits - 1; i >= 0; --i)
@@ -1604,13 +4624,21 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 
 		COpenGL3Renderer2D* nextActiveRenderer = texture ? MaterialRenderer2DTexture : MaterialRenderer2DNoTexture;
 
+		// distance fields are turned into smooth edges by their own shader
+		if (texture && alphaChannel && MaterialRenderer2DDistanceField)
+		{
+			const ITexture* current = CacheHandler->getTextureCache().get(0);
+			if (current && current->isDistanceField())
+				nextActiveRenderer = MaterialRenderer2DDistanceField;
+		}
+
 		if (CurrentRenderMode != ERM_2D)
 		{
 			// unset last 3d material
 			if (CurrentRenderMode == ERM_3D)
 			{
 				if (static_cast<u32>(LastMaterial.MaterialType) < MaterialRenderers.size())
-					MaterialRenderers[LastMaterial.MaterialType].Renderer->OnUnsetMaterial();
+					getActiveMaterialRenderer(LastMaterial.MaterialType, LastMaterialVariant, LastMaterialPermutation)->OnUnsetMaterial();
 			}
 
 			CurrentRenderMode = ERM_2D;
@@ -1624,6 +4652,7 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 
 		MaterialRenderer2DActive->OnSetMaterial(Material, LastMaterial, true, 0);
 		LastMaterial = Material;
+		++FrameStats.MaterialChanges;
 		CacheHandler->correctCacheMaterial(LastMaterial);
 
 		// no alphaChannel without texture
@@ -1639,14 +4668,22 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 			CacheHandler->setBlend(false);
 
 		Material.setTexture(0, const_cast<COpenGL3Texture*>(CacheHandler->getTextureCache().get(0)));
+		++MaterialRevision;
 		setTransform(ETS_TEXTURE_0, core::IdentityMatrix);
 
 		if (texture)
 		{
-			if (OverrideMaterial2DEnabled)
-				setTextureRenderStates(OverrideMaterial2D, false);
+			const SMaterial& material2D = OverrideMaterial2DEnabled ? OverrideMaterial2D : InitMaterial2D;
+
+			if (MaterialRenderer2DActive == MaterialRenderer2DDistanceField)
+			{
+				// the distances between the texels have to be interpolated
+				SMaterial filtered(material2D);
+				filtered.TextureLayer[0].BilinearFilter = true;
+				setTextureRenderStates(filtered, false);
+			}
 			else
-				setTextureRenderStates(InitMaterial2D, false);
+				setTextureRenderStates(material2D, false);
 		}
 
 		MaterialRenderer2DActive->OnRender(this, video::EVT_STANDARD);
@@ -1655,6 +4692,9 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 
 	void COpenGL3DriverBase::chooseMaterial2D()
 	{
+		flush2DBatch();
+		flush3DLines();
+
 		if (!OverrideMaterial2DEnabled)
 			Material = InitMaterial2D;
 
@@ -1667,6 +4707,9 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 
 			Material = OverrideMaterial2D;
 		}
+
+		MaterialStateKey = getMaterialStateKey(Material);
+		++MaterialRevision;
 	}
 
 
@@ -1678,6 +4721,10 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 
 	void COpenGL3DriverBase::setViewPort(const core::rect<s32>& area)
 	{
+		flush2DBatch();
+		flush3DLines();
+		fail2DRecordings();
+
 		core::rect<s32> vp = area;
 		core::rect<s32> rendert(0, 0, getCurrentRenderTargetSize().Width, getCurrentRenderTargetSize().Height);
 		vp.clipAgainst(rendert);
@@ -1700,13 +4747,65 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	void COpenGL3DriverBase::draw3DLine(const core::vector3df& start,
 			const core::vector3df& end, SColor color)
 	{
-		setRenderStates3DMode();
-
 		S3DVertex vertices[2];
 		vertices[0] = S3DVertex(start.X, start.Y, start.Z, 0, 0, 1, color, 0, 0);
 		vertices[1] = S3DVertex(end.X, end.Y, end.Z, 0, 0, 1, color, 0, 0);
 
-		drawArrays(GL_LINES, vtPrimitive, vertices, 2);
+		queue3DLines(vertices, 2);
+	}
+
+
+	//! Draws a 3d axis aligned box.
+	void COpenGL3DriverBase::draw3DBox(const core::aabbox3d<f32>& box, SColor color)
+	{
+		// the edges in the order of CNullDriver::draw3DBox
+		static const u8 lines[24] = { 5, 1, 1, 3, 3, 7, 7, 5, 0, 2, 2, 6, 6, 4, 4, 0, 1, 0, 3, 2, 7, 6, 5, 4 };
+
+		core::vector3df edges[8];
+		box.getEdges(edges);
+
+		S3DVertex vertices[24];
+		for (u32 i = 0; i < 24; ++i)
+			vertices[i] = S3DVertex(edges[lines[i]], core::vector3df(0, 0, 1), color, core::vector2df(0, 0));
+
+		queue3DLines(vertices, 24);
+	}
+
+
+	void COpenGL3DriverBase::queue3DLines(const S3DVertex* vertices, u32 vertexCount)
+	{
+		flush2DBatch();
+
+		if (Lines3D.size() + vertexCount > MaxLines3DVertices)
+			flush3DLines();
+
+		const core::matrix4& world = Matrices[ETS_WORLD];
+		const u32 first = Lines3D.size();
+		Lines3D.set_used(first + vertexCount);
+		for (u32 i = 0; i < vertexCount; ++i)
+		{
+			Lines3D[first + i] = vertices[i];
+			world.transformVect(Lines3D[first + i].Pos);
+		}
+	}
+
+
+	void COpenGL3DriverBase::flush3DLines()
+	{
+		if (Lines3D.empty())
+			return;
+
+		// The lines have to be taken before setting the states, as setRenderStates3DMode flushes them.
+		Lines3DDrawVertices.swap(Lines3D);
+
+		const core::matrix4 world = Matrices[ETS_WORLD];
+		setTransform(ETS_WORLD, core::IdentityMatrix);
+		setRenderStates3DMode();
+
+		drawArrays(GL_LINES, vtPrimitive, Lines3DDrawVertices.const_pointer(), Lines3DDrawVertices.size());
+
+		setTransform(ETS_WORLD, world);
+		Lines3DDrawVertices.set_used(0);
 	}
 
 
@@ -1714,12 +4813,22 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	//! the window was resized.
 	void COpenGL3DriverBase::OnResize(const core::dimension2d<u32>& size)
 	{
+		if (queueResize(size))
+			return;
+
 		CNullDriver::OnResize(size);
 		CacheHandler->setViewport(0, 0, size.Width, size.Height);
 		Transformation3DChanged = true;
 	}
 
 
+	//! Moves the context between the application and the render thread
+	bool COpenGL3DriverBase::setContextCurrent(bool current)
+	{
+		return ContextManager && ContextManager->setContextCurrent(current);
+	}
+
+
 	//! Returns type of video driver
 	E_DRIVER_TYPE COpenGL3DriverBase::getDriverType() const
 	{
@@ -1839,6 +4948,42 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		return nr;
 	}
 
+
+	s32 COpenGL3DriverBase::addHighLevelShaderMaterialAsync(const c8* vertexShaderProgram, const c8* pixelShaderProgram,
+			IShaderConstantSetCallBack* callback, E_MATERIAL_TYPE baseMaterial, s32 userData)
+	{
+		s32 nr = -1;
+		COpenGL3MaterialRenderer* r = new COpenGL3MaterialRenderer(
+			this, nr, vertexShaderProgram,
+			pixelShaderProgram,
+			callback, baseMaterial, userData, true);
+
+		if (nr >= 0 && r->isLinking())
+			PendingMaterialRenderers[nr] = r;
+
+		r->drop();
+		return nr;
+	}
+
+
+	bool COpenGL3DriverBase::isShaderMaterialReady(s32 materialType)
+	{
+		auto it = PendingMaterialRenderers.find(materialType);
+		if (it == PendingMaterialRenderers.end())
+			return materialType >= 0 && materialType < (s32)MaterialRenderers.size();
+
+		const bool ready = it->second->pollLink();
+		if (!it->second->isLinking())
+			PendingMaterialRenderers.erase(it);
+		return ready;
+	}
+
+
+	bool COpenGL3DriverBase::isParallelShaderCompileSupported() const
+	{
+		return ParallelShaderCompileSupported;
+	}
+
 	//! Returns a pointer to the IVideoDriver interface. (Implementation for
 	//! IMaterialRendererServices)
 	IVideoDriver* COpenGL3DriverBase::getVideoDriver()
@@ -1861,6 +5006,7 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		setTextureCreationFlag(ETCF_CREATE_MIP_MAPS, false);
 
 		COpenGL3Texture* renderTargetTexture = new COpenGL3Texture(name, size, ETT_2D, format, this);
+		TextureResidency->add(renderTargetTexture);
 		addTexture(renderTargetTexture);
 		renderTargetTexture->drop();
 
@@ -1888,6 +5034,7 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		}
 
 		COpenGL3Texture* renderTargetTexture = new COpenGL3Texture(name, destSize, ETT_CUBEMAP, format, this);
+		TextureResidency->add(renderTargetTexture);
 		addTexture(renderTargetTexture);
 		renderTargetTexture->drop();
 
@@ -1906,20 +5053,27 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 
 	bool COpenGL3DriverBase::setRenderTargetEx(IRenderTarget* target, u16 clearFlag, SColor clearColor, f32 clearDepth, u8 clearStencil)
 	{
+		flush2DBatch();
+		flush3DLines();
+		fail2DRecordings();
+
 		if (target && target->getDriverType() != getDriverType())
 		{
 			os::Printer::log("Fatal Error: Tried to set a render target not owned by OpenGL 3 driver.", ELL_ERROR);
 			return false;
 		}
 
+		if (CurrentRenderTarget && CurrentRenderTarget != target)
+			static_cast<COpenGL3RenderTarget*>(CurrentRenderTarget)->resolve();
+
 		core::dimension2d<u32> destRenderTargetSize(0, 0);
 
 		if (target)
 		{
 			COpenGL3RenderTarget* renderTarget = static_cast<COpenGL3RenderTarget*>(target);
 
-			CacheHandler->setFBO(renderTarget->getBufferID());
 			renderTarget->update();
+			CacheHandler->setFBO(renderTarget->getBufferID());
 
 			destRenderTargetSize = renderTarget->getSize();
 
@@ -1942,14 +5096,37 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		}
 
 		CurrentRenderTarget = target;
+		setScissor(0);
+		updateRenderTargetMultisampled();
 
 		clearBuffers(clearFlag, clearColor, clearDepth, clearStencil);
 
 		return true;
 	}
 
+	void COpenGL3DriverBase::updateRenderTargetMultisampled()
+	{
+		// alpha to coverage has no effect with a single sample per pixel
+		GLint sampleBuffers = 0;
+		if (queryFeature(EVDF_ALPHA_TO_COVERAGE))
+			glGetIntegerv(GL.SAMPLE_BUFFERS, &sampleBuffers);
+
+		if (RenderTargetMultisampled != (sampleBuffers > 0))
+		{
+			RenderTargetMultisampled = sampleBuffers > 0;
+
+			// alpha channel materials blend and write depth depending on it
+			MaterialStateKey = getMaterialStateKey(Material);
+			++MaterialRevision;
+		}
+	}
+
 	void COpenGL3DriverBase::clearBuffers(u16 flag, SColor color, f32 depth, u8 stencil)
 	{
+		flush2DBatch();
+		flush3DLines();
+		fail2DRecordings();
+
 		GLbitfield mask = 0;
 		u8 colorMask = 0;
 		bool depthMask = false;
@@ -1971,7 +5148,7 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		if (flag & ECBF_DEPTH)
 		{
 			CacheHandler->setDepthMask(true);
-			glClearDepthf(depth);
+			glClearDepthf(getClearDepth(depth));
 			mask |= GL_DEPTH_BUFFER_BIT;
 		}
 
@@ -1989,6 +5166,25 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	}
 
 
+	void COpenGL3DriverBase::setReverseDepth(bool reverse)
+	{
+		if (reverse == ReverseDepth)
+			return;
+
+		flush2DBatch();
+		flush3DLines();
+		CNullDriver::setReverseDepth(reverse);
+
+		// the depth buffer only gets its full precision when depth isn't
+		// mapped from -1 to 1 first
+		if (queryFeature(EVDF_DEPTH_CLIP_CONTROL))
+			GL.ClipControl(GL.LOWER_LEFT, reverse ? GL.ZERO_TO_ONE : GL.NEGATIVE_ONE_TO_ONE);
+
+		// the key holds the swapped depth comparison
+		MaterialStateKey = getMaterialStateKey(Material);
+	}
+
+
 	//! Returns an image created from the last rendered frame.
 	// We want to read the front buffer to get the latest render finished.
 	// This is not possible under ogl-es, though, so one has to call this method
@@ -1998,6 +5194,9 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		if (target==video::ERT_MULTI_RENDER_TEXTURES || target==video::ERT_RENDER_TEXTURE || target==video::ERT_STEREO_BOTH_BUFFERS)
 			return 0;
 
+		flush2DBatch();
+		flush3DLines();
+
 		GLint internalformat = GL_RGBA;
 		GLint type = GL_UNSIGNED_BYTE;
 		{
@@ -2079,15 +5278,216 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		return newImage;
 	}
 
+	IScreenShotRequest* COpenGL3DriverBase::createScreenShotAsync(video::ECOLOR_FORMAT format, video::E_RENDER_TARGET target)
+	{
+		if (!AsyncReadbackSupported)
+			return CNullDriver::createScreenShotAsync(format, target);
+
+		if (target != video::ERT_FRAME_BUFFER)
+			return 0;
+
+		if (format == ECF_UNKNOWN)
+			format = ECF_A8R8G8B8;
+		if (!CColorConverter::canConvertFormat(ECF_A8R8G8B8, format))
+			return 0;
+
+		flush2DBatch();
+		flush3DLines();
+
+		CScreenShotRequest* request = new CScreenShotRequest(format, ScreenSize);
+
+		SScreenShotReadback readback;
+		readback.Request = request;
+		glGenBuffers(1, &readback.Buffer);
+		glBindBuffer(GL.PIXEL_PACK_BUFFER, readback.Buffer);
+		glBufferData(GL.PIXEL_PACK_BUFFER, request->getPixelsSize(), nullptr, GL.STREAM_READ);
+		glReadPixels(0, 0, ScreenSize.Width, ScreenSize.Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL.PIXEL_PACK_BUFFER, 0);
+		readback.Fence = GL.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		if (testGLError(__LINE__) || !readback.Fence)
+		{
+			if (readback.Fence)
+				GL.DeleteSync(readback.Fence);
+			glDeleteBuffers(1, &readback.Buffer);
+			request->drop();
+			return 0;
+		}
+
+		// the driver keeps a reference until the pixels arrived
+		request->grab();
+		ScreenShotReadbacks.push_back(readback);
+		return request;
+	}
+
+	IScreenShotRequest* COpenGL3DriverBase::createTextureReadbackAsync(ITexture* texture, u32 mipmapLevel, u32 layer)
+	{
+		if (!AsyncReadbackSupported || !texture || texture->getDriverType() != getDriverType())
+			return 0;
+
+		// glReadPixels can always return GL_RGBA/GL_UNSIGNED_BYTE for these
+		if (!CColorConverter::canConvertFormat(ECF_A8R8G8B8, texture->getColorFormat()))
+			return 0;
+
+		const COpenGL3Texture* glTexture = static_cast<const COpenGL3Texture*>(texture);
+		GLenum textureTarget = GL_TEXTURE_2D;
+		if (texture->getType() == ETT_CUBEMAP)
+		{
+			_IRR_DEBUG_BREAK_IF(layer > 5)
+			textureTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer;
+		}
+
+		flush2DBatch();
+		flush3DLines();
+
+		const core::dimension2d<u32> size = IImage::getMipMapsSize(texture->getSize(), mipmapLevel);
+
+		GLuint prevFBO = 0;
+		CacheHandler->getFBO(prevFBO);
+
+		GLuint frameBuffer = 0;
+		glGenFramebuffers(1, &frameBuffer);
+		CacheHandler->setFBO(frameBuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, textureTarget, glTexture->getOpenGLTextureName(), mipmapLevel);
+
+		CScreenShotRequest* request = 0;
+		SScreenShotReadback readback;
+		readback.Buffer = 0;
+		readback.Fence = 0;
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL.FRAMEBUFFER_COMPLETE)
+		{
+			request = new CScreenShotRequest(texture->getColorFormat(), size);
+			readback.Request = request;
+			glGenBuffers(1, &readback.Buffer);
+			glBindBuffer(GL.PIXEL_PACK_BUFFER, readback.Buffer);
+			glBufferData(GL.PIXEL_PACK_BUFFER, request->getPixelsSize(), nullptr, GL.STREAM_READ);
+			glReadPixels(0, 0, size.Width, size.Height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			glBindBuffer(GL.PIXEL_PACK_BUFFER, 0);
+			readback.Fence = GL.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		CacheHandler->setFBO(prevFBO);
+		glDeleteFramebuffers(1, &frameBuffer);
+
+		if (testGLError(__LINE__) || !readback.Fence)
+		{
+			if (readback.Fence)
+				GL.DeleteSync(readback.Fence);
+			if (readback.Buffer)
+				glDeleteBuffers(1, &readback.Buffer);
+			if (request)
+				request->drop();
+			return 0;
+		}
+
+		// the driver keeps a reference until the pixels arrived
+		request->grab();
+		ScreenShotReadbacks.push_back(readback);
+		return request;
+	}
+
+	void COpenGL3DriverBase::processScreenShotReadbacks()
+	{
+		for (auto it = ScreenShotReadbacks.begin(); it != ScreenShotReadbacks.end();)
+		{
+			SScreenShotReadback& readback = *it;
+
+			// nobody waits for the pixels anymore
+			const bool discarded = readback.Request->getReferenceCount() == 1;
+			if (!discarded)
+			{
+				const GLenum status = GL.ClientWaitSync(readback.Fence, 0, 0);
+				if (status == GL.TIMEOUT_EXPIRED)
+				{
+					++it;
+					continue;
+				}
+
+				bool copied = false;
+				if (status != GL._WAIT_FAILED)
+				{
+					const u32 size = readback.Request->getPixelsSize();
+					glBindBuffer(GL.PIXEL_PACK_BUFFER, readback.Buffer);
+					const void* src = GL.MapBufferRange(GL.PIXEL_PACK_BUFFER, 0, size, GL.MAP_READ_BIT);
+					if (src)
+					{
+						memcpy(readback.Request->getPixels(), src, size);
+						copied = GL.UnmapBuffer(GL.PIXEL_PACK_BUFFER);
+					}
+					glBindBuffer(GL.PIXEL_PACK_BUFFER, 0);
+				}
+
+				if (copied)
+					readback.Request->setReady();
+				else
+					readback.Request->setFailed();
+			}
+
+			GL.DeleteSync(readback.Fence);
+			glDeleteBuffers(1, &readback.Buffer);
+			readback.Request->drop();
+			it = ScreenShotReadbacks.erase(it);
+		}
+
+		testGLError(__LINE__);
+	}
+
 	void COpenGL3DriverBase::removeTexture(ITexture* texture)
 	{
-		CacheHandler->getTextureCache().remove(texture);
+		flush2DBatch();
+		flush3DLines();
+		unregisterTexture(texture);
 		CNullDriver::removeTexture(texture);
 	}
 
+	void COpenGL3DriverBase::removeAllTextures()
+	{
+		flush2DBatch();
+		flush3DLines();
+		++Recording2DGeneration;
+		if (TextureAtlas)
+			TextureAtlas->clear();
+		if (TextureResidency)
+			TextureResidency->clear();
+		for (auto texture : StreamedTextures)
+			texture->drop();
+		StreamedTextures.clear();
+		CNullDriver::removeAllTextures();
+	}
+
+	void COpenGL3DriverBase::setTextureMemoryBudget(u64 bytes)
+	{
+		CNullDriver::setTextureMemoryBudget(bytes);
+		if (TextureResidency)
+			TextureResidency->setBudget(bytes);
+	}
+
+	const STextureResidencyStats& COpenGL3DriverBase::getTextureResidencyStats() const
+	{
+		if (!TextureResidency)
+			return CNullDriver::getTextureResidencyStats();
+		return TextureResidency->getStats();
+	}
+
+	SMaterial& COpenGL3DriverBase::getMaterial2D()
+	{
+		// the returned material may be changed before the pending quads are drawn
+		flush2DBatch();
+		return CNullDriver::getMaterial2D();
+	}
+
+	void COpenGL3DriverBase::enableMaterial2D(bool enable)
+	{
+		flush2DBatch();
+		CNullDriver::enableMaterial2D(enable);
+	}
+
 	//! Set/unset a clipping plane.
 	bool COpenGL3DriverBase::setClipPlane(u32 index, const core::plane3df& plane, bool enable)
 	{
+		flush3DLines();
+
 		if (index >= UserClipPlane.size())
 			UserClipPlane.push_back(SUserClipPlane());
 
@@ -2099,6 +5499,7 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 	//! Enable/disable a clipping plane.
 	void COpenGL3DriverBase::enableClipPlane(u32 index, bool enable)
 	{
+		flush3DLines();
 		UserClipPlane[index].Enabled = enable;
 	}
 
@@ -2188,42 +5589,70 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 			break;
 #ifdef GL_EXT_texture_compression_s3tc
 		case ECF_DXT1:
-			supported = true;
+			supported = TextureCompressionDXT;
 			pixelFormat = GL_RGBA;
 			pixelType = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
 			break;
 		case ECF_DXT2:
 		case ECF_DXT3:
-			supported = true;
+			supported = TextureCompressionDXT;
 			pixelFormat = GL_RGBA;
 			pixelType = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
 			break;
 		case ECF_DXT4:
 		case ECF_DXT5:
-			supported = true;
+			supported = TextureCompressionDXT;
 			pixelFormat = GL_RGBA;
 			pixelType = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
 			break;
 #endif
-#ifdef GL_OES_compressed_ETC1_RGB8_texture
 		case ECF_ETC1:
-			supported = true;
-			pixelFormat = GL_RGB;
-			pixelType = GL_ETC1_RGB8_OES;
-			break;
+			// ETC1 data is valid ETC2 data
+			if (TextureCompressionETC2)
+			{
+				supported = true;
+				pixelFormat = GL_RGB;
+				pixelType = GL.COMPRESSED_RGB8_ETC2;
+			}
+#ifdef GL_OES_compressed_ETC1_RGB8_texture
+			else if (queryGLESFeature(COGLESCoreExtensionHandler::IRR_GL_OES_compressed_ETC1_RGB8_texture))
+			{
+				supported = true;
+				pixelFormat = GL_RGB;
+				pixelType = GL_ETC1_RGB8_OES;
+			}
 #endif
-#ifdef GL_ES_VERSION_3_0 // TO-DO - fix when extension name will be available
+			break;
 		case ECF_ETC2_RGB:
-			supported = true;
+			supported = TextureCompressionETC2;
 			pixelFormat = GL_RGB;
-			pixelType = GL_COMPRESSED_RGB8_ETC2;
+			pixelType = GL.COMPRESSED_RGB8_ETC2;
 			break;
-#endif
-#ifdef GL_ES_VERSION_3_0 // TO-DO - fix when extension name will be available
 		case ECF_ETC2_ARGB:
-			supported = true;
+			supported = TextureCompressionETC2;
+			pixelFormat = GL_RGBA;
+			pixelType = GL.COMPRESSED_RGBA8_ETC2_EAC;
+			break;
+		case ECF_BC7:
+			supported = TextureCompressionBPTC;
+			pixelFormat = GL_RGBA;
+			pixelType = GL.COMPRESSED_RGBA_BPTC_UNORM;
+			break;
+#ifdef GL_KHR_texture_compression_astc_ldr
+		case ECF_ASTC_4x4:
+			supported = TextureCompressionASTC;
+			pixelFormat = GL_RGBA;
+			pixelType = GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+			break;
+		case ECF_ASTC_6x6:
+			supported = TextureCompressionASTC;
+			pixelFormat = GL_RGBA;
+			pixelType = GL_COMPRESSED_RGBA_ASTC_6x6_KHR;
+			break;
+		case ECF_ASTC_8x8:
+			supported = TextureCompressionASTC;
 			pixelFormat = GL_RGBA;
-			pixelType = GL_COMPRESSED_RGBA8_ETC2_EAC;
+			pixelType = GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
 			break;
 #endif
 		case ECF_D16:
@@ -2252,24 +5681,20 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 #endif
 			break;
 		case ECF_R8:
-#if defined(GL_EXT_texture_rg)
-			if (queryGLESFeature(COGLESCoreExtensionHandler::IRR_GL_EXT_texture_rg))
+			if (TextureRGSupported)
 			{
 				supported = true;
-				pixelFormat = GL_RED_EXT;
+				pixelFormat = GL.RED;
 				pixelType = GL_UNSIGNED_BYTE;
 			}
-#endif
 			break;
 		case ECF_R8G8:
-#if defined(GL_EXT_texture_rg)
-			if (queryGLESFeature(COGLESCoreExtensionHandler::IRR_GL_EXT_texture_rg))
+			if (TextureRGSupported)
 			{
 				supported = true;
-				pixelFormat = GL_RG_EXT;
+				pixelFormat = GL.RG;
 				pixelType = GL_UNSIGNED_BYTE;
 			}
-#endif
 			break;
 		case ECF_R16:
 			break;
@@ -2353,6 +5778,34 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		// it means they have to be equal. Note that this was different in OpenGL.
 		internalFormat = pixelFormat;
 
+		// compressed formats are passed as the internal format, pixelType holds it like in the other OpenGL drivers
+		if (IImage::isCompressedFormat(format))
+			internalFormat = pixelType;
+		else if (TextureStorageSupported)
+		{
+			// immutable storage needs sized formats, OpenGL ES 3.0 accepts them for these combinations only
+			const bool isGLES = getDriverType() == EDT_OGLES2;
+
+			if (pixelType == GL_UNSIGNED_BYTE && pixelFormat == GL_RGBA)
+				internalFormat = GL.RGBA8;
+			else if (pixelType == GL_UNSIGNED_BYTE && pixelFormat == GL_BGRA && !isGLES)
+				internalFormat = GL.RGBA8;
+			else if (pixelType == GL_UNSIGNED_BYTE && pixelFormat == GL_RGB)
+				internalFormat = GL.RGB8;
+			else if (pixelType == GL_UNSIGNED_BYTE && pixelFormat == GL.RED)
+				internalFormat = GL.R8;
+			else if (pixelType == GL_UNSIGNED_BYTE && pixelFormat == GL.RG)
+				internalFormat = GL.RG8;
+			else if (pixelType == GL_UNSIGNED_SHORT_5_5_5_1 && pixelFormat == GL_RGBA)
+				internalFormat = GL.RGB5_A1;
+			else if (pixelType == GL_UNSIGNED_SHORT_5_6_5 && pixelFormat == GL_RGB && (isGLES || Version >= 410))
+				internalFormat = GL.RGB565;
+			else if (pixelType == GL_UNSIGNED_SHORT && pixelFormat == GL_DEPTH_COMPONENT)
+				internalFormat = GL.DEPTH_COMPONENT16;
+			else if (pixelType == GL_FLOAT && pixelFormat == GL_RGBA)
+				internalFormat = GL.RGBA32F;
+		}
+
 #ifdef _IRR_IOS_PLATFORM_
 		if (internalFormat == GL_BGRA)
 			internalFormat = GL_RGBA;
@@ -2361,6 +5814,47 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		return supported;
 	}
 
+	bool COpenGL3DriverBase::irrGlTexStorage2D(GLenum target, GLsizei levels, GLint internalformat, GLsizei width, GLsizei height)
+	{
+		if (!TextureStorageSupported)
+			return false;
+
+		// getColorFormatParameters returns unsized formats where no sized one matches the upload
+		switch (internalformat)
+		{
+		case GL_RGBA:
+		case GL_RGB:
+		case GL.BGRA:
+		case GL.RED:
+		case GL.RG:
+		case GL_DEPTH_COMPONENT:
+		case GL.DEPTH_STENCIL:
+			return false;
+		default:
+			break;
+		}
+
+		GL.TexStorage2D(target, levels, internalformat, width, height);
+		return true;
+	}
+
+	void COpenGL3DriverBase::irrGlRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
+	{
+		GL.RenderbufferStorageMultisample(target, samples, internalformat, width, height);
+	}
+
+	void COpenGL3DriverBase::irrGlBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
+	{
+		GL.BlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+	}
+
+	void COpenGL3DriverBase::irrGlInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments)
+	{
+		// core since OpenGL 4.3 and OpenGL ES 3.0
+		if (GL.InvalidateFramebuffer)
+			GL.InvalidateFramebuffer(target, numAttachments, attachments);
+	}
+
 	bool COpenGL3DriverBase::queryTextureFormat(ECOLOR_FORMAT format) const
 	{
 		GLint dummyInternalFormat;
@@ -2375,6 +5869,50 @@ COpenGL3DriverBase::~COpenGL3DriverBase()
 		return CNullDriver::needsTransparentRenderPass(material) || material.isAlphaBlendOperation();
 	}
 
+	bool COpenGL3DriverBase::canAccumulateTransparency(const SMaterial& material) const
+	{
+		// the shaders of these materials write the weighted colors, the blending is replaced by the accumulation
+		if (material.MaterialType != EMT_TRANSPARENT_ALPHA_CHANNEL && material.MaterialType != EMT_TRANSPARENT_VERTEX_ALPHA &&
+				material.MaterialType != EMT_TRANSPARENT_REFLECTION_2_LAYER)
+			return false;
+
+		return queryFeature(EVDF_WEIGHTED_TRANSPARENCY) && (material.BlendOperation == EBO_NONE || material.BlendOperation == EBO_ADD) &&
+			needsTransparentRenderPass(material) && !getWriteZBuffer(material);
+	}
+
+	bool COpenGL3DriverBase::beginTransparencyAccumulation()
+	{
+		if (TransparencyAccumulating || !queryFeature(EVDF_WEIGHTED_TRANSPARENCY))
+			return false;
+
+		flush2DBatch();
+		flush3DLines();
+
+		GLuint frameBuffer = 0;
+		CacheHandler->getFBO(frameBuffer);
+		if (!WeightedTransparency->begin(frameBuffer, getCurrentRenderTargetSize()))
+			return false;
+
+		// the accumulated materials use other permutations, and the color mask was changed
+		TransparencyAccumulating = true;
+		ResetRenderStates = true;
+		return true;
+	}
+
+	void COpenGL3DriverBase::endTransparencyAccumulation()
+	{
+		if (!TransparencyAccumulating)
+			return;
+
+		flush2DBatch();
+		flush3DLines();
+
+		WeightedTransparency->end();
+
+		TransparencyAccumulating = false;
+		ResetRenderStates = true;
+	}
+
 	const SMaterial& COpenGL3DriverBase::getCurrentMaterial() const
 	{
 		return Material;
@@ -15,6 +15,15 @@
 #include "fast_atof.h"
 #include "ExtensionHandler.h"
 #include "IContextManager.h"
+#include "COpenGLCoreStreamAllocator.h"
+#include <map>
+#include <deque>
+
+// glGetError after calls stalls some drivers and is only compiled into debug builds,
+// defining _IRR_OPENGL_NO_SYNC_ERROR_CHECKS_ leaves it out of those as well
+#if defined(_DEBUG) && !defined(_IRR_OPENGL_NO_SYNC_ERROR_CHECKS_)
+#define _IRR_OPENGL_SYNC_ERROR_CHECKS_
+#endif
 
 namespace irr
 {
@@ -23,7 +32,13 @@ namespace video
 	struct VertexType;
 
 	class COpenGL3FixedPipelineRenderer;
+	class COpenGL3GPUCulling;
+	class COpenGL3MaterialRenderer;
 	class COpenGL3Renderer2D;
+	class COpenGL3TextureAtlas;
+	class COpenGL3TextureResidency;
+	class COpenGL3WeightedTransparency;
+	class CScreenShotRequest;
 
 	class COpenGL3DriverBase : public CNullDriver, public IMaterialRendererServices, public COpenGL3ExtensionHandler
 	{
@@ -43,14 +58,65 @@ namespace video
 
 		bool endScene() override;
 
+		//! Sets how many vertical blanks the presentation of endScene() waits for
+		bool setSwapInterval(s32 interval) override;
+
+		//! Limits how many frames the GPU may lag behind endScene()
+		bool setMaxFramesInFlight(u32 frames) override;
+
+		//! Selects how the driver checks for errors of the graphics API
+		bool setErrorCheckMode(E_ERROR_CHECK_MODE mode) override;
+
+		//! Discards debug output below a log level
+		void setDebugMessageLevel(ELOG_LEVEL minLevel) override;
+
+		//! Enables or disables a message of the debug output
+		void setDebugMessageEnabled(u32 id, bool enabled) override;
+
 		//! sets transformation
 		void setTransform(E_TRANSFORMATION_STATE state, const core::matrix4& mat) override;
 
+		//! Sets the fog mode.
+		void setFog(SColor color = SColor(0, 255, 255, 255),
+				E_FOG_TYPE fogType = EFT_FOG_LINEAR,
+				f32 start = 50.0f, f32 end = 100.0f, f32 density = 0.01f,
+				bool pixelFog = false, bool rangeFog = false) override;
+
+		//! Sets the dynamic ambient light color.
+		void setAmbientLight(const SColorf& color) override;
+
+		//! Large buffer object shared by many static hardware buffers
+		struct SBufferArena
+		{
+			struct SRange
+			{
+				u32 Offset;
+				u32 Size;
+			};
+
+			GLuint ID = 0;
+			GLenum Target = 0;
+			//! Vertex or index type of all ranges in this arena
+			u32 Key = 0;
+			u32 Used = 0;
+			//! Free ranges, sorted by offset and never adjacent to each other
+			std::vector<SRange> Free;
+
+			//! First fit allocation, returns false if no free range is large enough
+			bool allocate(u32 size, u32 &offset);
+			//! Returns a range to the free list, merging it with its neighbours
+			void release(u32 offset, u32 size);
+		};
+
 		struct SHWBufferLink_opengl : public SHWBufferLink
 		{
-			SHWBufferLink_opengl(const scene::IMeshBuffer *meshBuffer)
-			: SHWBufferLink(meshBuffer), vbo_verticesID(0), vbo_indicesID(0)
+			SHWBufferLink_opengl(const scene::IMeshBuffer *meshBuffer, CNullDriver *driver)
+			: SHWBufferLink(meshBuffer, driver), vbo_verticesID(0), vbo_indicesID(0)
 			, vbo_verticesSize(0), vbo_indicesSize(0)
+			, vbo_verticesOffset(0), vbo_indicesOffset(0)
+			, vertexArena(0), indexArena(0)
+			, vaoID(0), vaoVertexType(EVT_STANDARD), vertexType(EVT_STANDARD)
+			, streamVertexCount(0)
 			{}
 
 			u32 vbo_verticesID; //tmp
@@ -58,10 +124,69 @@ namespace video
 
 			u32 vbo_verticesSize; //tmp
 			u32 vbo_indicesSize; //tmp
+
+			//! Byte offsets of the data inside the buffers, only non-zero for arena ranges
+			u32 vbo_verticesOffset;
+			u32 vbo_indicesOffset;
+
+			//! Arenas the ranges were taken from, 0 if the buffer has its own buffer object
+			SBufferArena *vertexArena;
+			SBufferArena *indexArena;
+
+			//! Vertex array object recording the attribute layout of both buffers, 0 if not used
+			u32 vaoID;
+			//! Vertex type the VAO was recorded for
+			E_VERTEX_TYPE vaoVertexType;
+
+			//! Vertex type in the buffer object, EVT_COMPACT if the vertices were quantized
+			E_VERTEX_TYPE vertexType;
+			//! Box the compact positions are relative to
+			core::vector3df compactOffset;
+			core::vector3df compactScale;
+
+			//! Vertex count of the separate attribute streams, 0 if the vertices are interleaved
+			u32 streamVertexCount;
 		};
 
-		bool updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer);
-		bool updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffer);
+		//! Uploads the vertices, only the ranges changed since changedID if the mesh buffer knows them
+		bool updateVertexHardwareBuffer(SHWBufferLink_opengl *HWBuffer, u32 changedID);
+		bool updateIndexHardwareBuffer(SHWBufferLink_opengl *HWBuffer, u32 changedID);
+
+		//! Uploads the data of one side of a hardware buffer, into an arena range if it is static and small enough
+		/** If the buffer object already holds the data, only dirtySize bytes from
+		dirtyOffset on are uploaded. */
+		bool updateBufferData(GLenum target, u32 arenaKey, scene::E_HARDWARE_MAPPING mapping,
+				const void* data, u32 size, u32 dirtyOffset, u32 dirtySize,
+				u32 &id, u32 &capacity, u32 &offset, SBufferArena *&arena);
+
+		//! Writes a range of a buffer object, through a mapping if that is worth it
+		/** Without direct state access the buffer has to be bound to target. */
+		void writeBufferRange(GLenum target, GLuint id, scene::E_HARDWARE_MAPPING mapping,
+				u32 offset, u32 size, const void* data, bool wholeBuffer);
+
+		//! Returns a buffer object name, reusing a released one if there is any
+		GLuint genBuffer();
+		//! Drops the storage of a mesh buffer object and keeps its name for genBuffer()
+		void releaseBuffer(GLuint id);
+
+		//! Takes a range from an arena of the given target and key, creating a new arena if all are full
+		SBufferArena *allocateArenaRange(GLenum target, u32 key, u32 size, u32 &offset);
+		//! Returns a range to its arena, deleting the arena when it becomes empty
+		void releaseArenaRange(SBufferArena *arena, u32 offset, u32 size);
+		//! Publishes the arena byte and fragmentation counters as driver attributes
+		void updateArenaAttributes();
+
+		//! Frees the client data of a GPU only mesh buffer once it is in static buffer objects
+		void releaseMeshBufferData(SHWBufferLink_opengl *HWBuffer);
+		//! Reads the data of a GPU only mesh buffer back, before its buffer objects go
+		void restoreMeshBufferData(SHWBufferLink_opengl *HWBuffer);
+		//! Reads size bytes from offset of a buffer object through a mapping
+		bool readBufferData(GLuint id, u32 offset, u32 size, void* data);
+
+		void deleteVertexArrayObject(SHWBufferLink_opengl *HWBuffer);
+
+		//! (Re)creates the vertex array object of a buffer if its vertex type changed
+		bool updateVertexArrayObject(SHWBufferLink_opengl *HWBuffer);
 
 		//! updates hardware buffer if needed
 		bool updateHardwareBuffer(SHWBufferLink *HWBuffer) override;
@@ -75,6 +200,47 @@ namespace video
 		//! Draw hardware buffer
 		void drawHardwareBuffer(SHWBufferLink *HWBuffer) override;
 
+		//! Draws a mesh buffer, passing the joint matrices of skinned buffers on to the skinning materials
+		void drawMeshBuffer(const scene::IMeshBuffer* mb) override;
+
+		//! Draws several instances of a mesh buffer with one draw call if the shader reads the instance attributes
+		void drawMeshBufferInstanced(const scene::IMeshBuffer* mb,
+			const S3DInstance* instances, u32 count) override;
+
+		//! Draws a mesh buffer blended towards another one by the morphing variants of the built-in materials
+		void drawMeshBufferMorphed(const scene::IMeshBuffer* mb,
+			const scene::IMeshBuffer* target, f32 blend) override;
+
+		//! Draws large batches of static buffers sharing their buffer objects with one indirect draw call, culled on the GPU
+		void drawMeshBufferBatch(const scene::IMeshBuffer* const* mb,
+			const core::matrix4* worldMatrices, u32 count) override;
+
+		//! Create occlusion query.
+		/** Use node for identification and mesh for occlusion test. */
+		void addOcclusionQuery(scene::ISceneNode* node,
+				const scene::IMesh* mesh=0) override;
+
+		//! Remove occlusion query.
+		void removeOcclusionQuery(scene::ISceneNode* node) override;
+
+		//! Run occlusion query. Draws mesh stored in query.
+		/** Queries whose previous result hasn't arrived yet are skipped,
+		so the GPU may lag behind by a few frames. */
+		void runOcclusionQuery(scene::ISceneNode* node, bool visible=false) override;
+
+		//! Update occlusion query. Retrieves results from GPU.
+		/** If the query shall not block, set the flag to false.
+		Update might not occur in this case, though */
+		void updateOcclusionQuery(scene::ISceneNode* node, bool block=true) override;
+
+		//! Return query result.
+		/** Depending on the context this is only 0 or 1 instead of the
+		number of visible fragments. */
+		u32 getOcclusionQueryResult(scene::ISceneNode* node) const override;
+
+		void beginGPUTimerScope(const c8* name) override;
+		void endGPUTimerScope() override;
+
 		IRenderTarget* addRenderTarget() override;
 
 		//! draws a vertex primitive list
@@ -85,7 +251,51 @@ namespace video
 		//! queries the features of the driver, returns true if feature is available
 		bool queryFeature(E_VIDEO_DRIVER_FEATURE feature) const override
 		{
-			return FeatureEnabled[feature] && COpenGL3ExtensionHandler::queryFeature(feature);
+			switch (feature)
+			{
+			case EVDF_INSTANCING:
+				return FeatureEnabled[feature] && InstancingSupported;
+			case EVDF_OCCLUSION_QUERY:
+				return FeatureEnabled[feature] && OcclusionQueryTarget;
+			case EVDF_UNIFORM_BLOCKS:
+				return FeatureEnabled[feature] && UniformBlocksSupported;
+			case EVDF_TIMER_QUERY:
+				return FeatureEnabled[feature] && TimerQuerySupported;
+			case EVDF_TEXTURE_UPLOAD_QUEUE:
+				return FeatureEnabled[feature] && TextureUploadQueueSupported;
+			case EVDF_TEXTURE_STORAGE:
+				return FeatureEnabled[feature] && TextureStorageSupported;
+			case EVDF_HARDWARE_SKINNING:
+				return FeatureEnabled[feature] && HardwareSkinningSupported;
+			case EVDF_COMPACT_VERTICES:
+				return FeatureEnabled[feature] && CompactVerticesSupported;
+			case EVDF_HARDWARE_MORPHING:
+				return FeatureEnabled[feature];
+			case EVDF_ASYNC_TEXTURE_LOADING:
+				return FeatureEnabled[feature];
+			case EVDF_RENDER_THREAD:
+				return FeatureEnabled[feature] && ContextManager;
+			case EVDF_SHARED_CONTEXT_UPLOAD:
+				return FeatureEnabled[feature] && TextureUploadQueueSupported && SharedContextUploadSupported;
+			case EVDF_TEXTURE_COMPRESSED_DXT:
+				return FeatureEnabled[feature] && TextureCompressionDXT;
+			case EVDF_TEXTURE_COMPRESSED_ETC1:
+				return FeatureEnabled[feature] && (TextureCompressionETC2 || COpenGL3ExtensionHandler::queryFeature(feature));
+			case EVDF_TEXTURE_COMPRESSED_ETC2:
+				return FeatureEnabled[feature] && TextureCompressionETC2;
+			case EVDF_TEXTURE_COMPRESSED_BPTC:
+				return FeatureEnabled[feature] && TextureCompressionBPTC;
+			case EVDF_TEXTURE_COMPRESSED_ASTC:
+				return FeatureEnabled[feature] && TextureCompressionASTC;
+			case EVDF_GPU_CULLING:
+				return FeatureEnabled[feature] && GPUCulling;
+			case EVDF_DEPTH_CLIP_CONTROL:
+				return FeatureEnabled[feature] && ClipControlSupported;
+			case EVDF_WEIGHTED_TRANSPARENCY:
+				return FeatureEnabled[feature] && WeightedTransparency;
+			default:
+				return FeatureEnabled[feature] && COpenGL3ExtensionHandler::queryFeature(feature);
+			}
 		}
 
 		//! Sets a material.
@@ -124,6 +334,15 @@ namespace video
 				const core::position2d<s32>& end,
 				SColor color = SColor(255, 255, 255, 255)) override;
 
+		//! Starts recording the 2d quads drawn into a list
+		bool beginRecording2D(S2DDrawList& list) override;
+
+		//! Stops the recording started last
+		bool endRecording2D() override;
+
+		//! Queues the quads of a recorded list again
+		bool drawRecording2D(const S2DDrawList& list) override;
+
 		//! Draws a single pixel
 		void drawPixel(u32 x, u32 y, const SColor & color) override;
 
@@ -132,6 +351,10 @@ namespace video
 				const core::vector3df& end,
 				SColor color = SColor(255, 255, 255, 255)) override;
 
+		//! Draws a 3d axis aligned box.
+		void draw3DBox(const core::aabbox3d<f32>& box,
+				SColor color = SColor(255, 255, 255, 255)) override;
+
 		//! Draws a pixel
 //			virtual void drawPixel(u32 x, u32 y, const SColor & color);
 
@@ -156,6 +379,24 @@ namespace video
 		//! Returns the transformation set by setTransform
 		const core::matrix4& getTransform(E_TRANSFORMATION_STATE state) const override;
 
+		//! Products of the transformations used by the built-in shaders
+		enum E_DERIVED_MATRIX
+		{
+			//! projection * view
+			EDM_VIEW_PROJECTION = 0,
+			//! view * world
+			EDM_WORLD_VIEW,
+			//! projection * view * world
+			EDM_WORLD_VIEW_PROJECTION,
+			//! Transposed inverse of view * world, for transforming normals
+			EDM_NORMAL,
+			EDM_COUNT
+		};
+
+		//! Returns a product of the transformations
+		/** It is computed when first asked for after one of its factors changed. */
+		const core::matrix4& getDerivedMatrix(E_DERIVED_MATRIX matrix);
+
 		//! Can be called by an IMaterialRenderer to make its work easier.
 		void setBasicRenderStates(const SMaterial& material, const SMaterial& lastmaterial, bool resetAllRenderstates) override;
 
@@ -214,6 +455,12 @@ namespace video
 				E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID,
 				s32 userData=0) override;
 
+		s32 addHighLevelShaderMaterialAsync(const c8* vertexShaderProgram, const c8* pixelShaderProgram = 0,
+				IShaderConstantSetCallBack* callback = 0, E_MATERIAL_TYPE baseMaterial = video::EMT_SOLID,
+				s32 userData = 0) override;
+
+		bool isShaderMaterialReady(s32 materialType) override;
+
 		//! Returns pointer to the IGPUProgrammingServices interface.
 		IGPUProgrammingServices* getGPUProgrammingServices() override;
 
@@ -235,11 +482,32 @@ namespace video
 
 		void clearBuffers(u16 flag, SColor color = SColor(255, 0, 0, 0), f32 depth = 1.f, u8 stencil = 0) override;
 
+		//! Sets if depth values get smaller with the distance from the camera
+		void setReverseDepth(bool reverse) override;
+
 		//! Returns an image created from the last rendered frame.
 		IImage* createScreenShot(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override;
 
+		//! Reads the frame buffer into a pixel pack buffer, copied to the request once its fence signals
+		IScreenShotRequest* createScreenShotAsync(video::ECOLOR_FORMAT format=video::ECF_UNKNOWN, video::E_RENDER_TARGET target=video::ERT_FRAME_BUFFER) override;
+
+		//! Reads a texture level through a temporary framebuffer into a pixel pack buffer
+		IScreenShotRequest* createTextureReadbackAsync(ITexture* texture, u32 mipmapLevel, u32 layer) override;
+
 		//! checks if an OpenGL error has happened and prints it (+ some internal code which is usually the line number)
-		bool testGLError(int code=0);
+		/** Only queries the error with EECM_SYNCHRONOUS, and is always false
+		without _IRR_OPENGL_SYNC_ERROR_CHECKS_, so hot paths lose the call. */
+		bool testGLError(int code=0)
+		{
+#ifdef _IRR_OPENGL_SYNC_ERROR_CHECKS_
+			return ErrorCheckMode == EECM_SYNCHRONOUS && queryGLError(code);
+#else
+			return false;
+#endif
+		}
+
+		//! Calls glGetError and prints the error
+		bool queryGLError(int code);
 
 		//! checks if an OGLES1 error has happened and prints it
 		bool testEGLError();
@@ -264,12 +532,37 @@ namespace video
 
 		void removeTexture(ITexture* texture) override;
 
+		void removeAllTextures() override;
+
+		void setTextureMemoryBudget(u64 bytes) override;
+
+		const STextureResidencyStats& getTextureResidencyStats() const override;
+
+		SMaterial& getMaterial2D() override;
+
+		void enableMaterial2D(bool enable=true) override;
+
 		//! Check if the driver supports creating textures with the given color format
 		bool queryTextureFormat(ECOLOR_FORMAT format) const override;
 
 		//! Used by some SceneNodes to check if a material should be rendered in the transparent render pass
 		bool needsTransparentRenderPass(const irr::video::SMaterial& material) const override;
 
+		//! Checks if a material can be drawn between beginTransparencyAccumulation() and endTransparencyAccumulation()
+		bool canAccumulateTransparency(const SMaterial& material) const override;
+
+		//! Starts accumulating transparent materials independent of the order they are drawn in
+		bool beginTransparencyAccumulation() override;
+
+		//! Blends the accumulated transparent materials over the current render target
+		void endTransparencyAccumulation() override;
+
+		//! True between beginTransparencyAccumulation() and endTransparencyAccumulation()
+		bool isAccumulatingTransparency() const
+		{
+			return TransparencyAccumulating;
+		}
+
 		//! Convert E_BLEND_FACTOR to OpenGL equivalent
 		GLenum getGLBlend(E_BLEND_FACTOR factor) const;
 
@@ -281,6 +574,56 @@ namespace video
 
 		COpenGL3CacheHandler* getCacheHandler() const;
 
+		//! Uploads a built-in uniform block if its contents changed since the last upload
+		void updateBuiltInUniformBlock(E_BUILT_IN_UNIFORM_BLOCK block);
+
+		//! True if the link status of programs can be polled without blocking
+		bool isParallelShaderCompileSupported() const;
+
+		//! Joint matrices of the skinned mesh buffer being drawn
+		/** \return 0 unless a buffer with EVT_SKINNED vertices is drawn. */
+		const core::matrix4* getJointMatrices(u32& count) const
+		{
+			count = JointMatrixCount;
+			return JointMatrices;
+		}
+
+		//! Weight of the morph target of the buffer being drawn
+		/** \return False unless a buffer is drawn by drawMeshBufferMorphed. */
+		bool getMorphBlend(f32& blend) const
+		{
+			blend = MorphBlend;
+			return MorphTarget != 0;
+		}
+
+		//! Dequantization of the positions of the compact hardware buffer being drawn
+		/** \return False unless a buffer with EVT_COMPACT vertices is drawn. */
+		bool getCompactVertexTransform(core::vector3df& scale, core::vector3df& offset) const
+		{
+			scale = CompactScale;
+			offset = CompactOffset;
+			return CompactVertices;
+		}
+
+		//! Links a program from the shader cache
+		/** \return True if the program was loaded. Otherwise the program
+		should be compiled and linked, then passed to saveProgramBinary(). */
+		bool loadProgramBinary(GLuint program, const c8* vertexShaderProgram, const c8* pixelShaderProgram);
+
+		//! Stores a linked program in the shader cache
+		void saveProgramBinary(GLuint program, const c8* vertexShaderProgram, const c8* pixelShaderProgram);
+
+		//! Allocates immutable storage for the bound texture, if supported for the internal format
+		/** \return False if the storage has to be allocated with glTexImage2D. */
+		bool irrGlTexStorage2D(GLenum target, GLsizei levels, GLint internalformat, GLsizei width, GLsizei height);
+
+		//! Multisampled render targets, only called if getFeature().MaxRenderTargetSamples allows them
+		void irrGlRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height);
+		void irrGlBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter);
+
+		//! Discards framebuffer contents, does nothing without glInvalidateFramebuffer
+		void irrGlInvalidateFramebuffer(GLenum target, GLsizei numAttachments, const GLenum *attachments);
+
 	protected:
 		//! inits the opengl-es driver
 		virtual bool genericDriverInit(const core::dimension2d<u32>& screenSize, bool stencilBuffer);
@@ -291,9 +634,40 @@ namespace video
 
 		ITexture* createDeviceDependentTextureCubemap(const io::path& name, const core::array<IImage*>& image) override;
 
+		//! Creates the loaded texture with ETCF_DEFERRED_UPLOAD and moves it into the placeholder
+		bool replaceTexture(ITexture* texture, const core::array<IImage*>& images, E_TEXTURE_TYPE type) override;
+
+		//! Moves the context between the application and the render thread
+		bool setContextCurrent(bool current) override;
+
+		//! Adds a new texture to the upload queue, the streamed textures, the residency budget and the atlas
+		/** \param atlasImage Image of a 2D texture for the atlas, 0 for cubemaps. */
+		void registerTexture(COpenGL3Texture* texture, IImage* atlasImage);
+
+		//! Removes a texture from everything registerTexture() added it to, except the upload queue
+		void unregisterTexture(ITexture* texture);
+
 		//! Map Irrlicht wrap mode to OpenGL enum
 		GLint getTextureWrapMode(u8 clamp) const;
 
+		//! Packs the sampler states of a texture layer into 32 bits
+		u32 getSamplerKey(const SMaterialLayer& layer, bool mipMaps) const;
+
+		//! Returns the sampler object for a sampler key, creating it on first use
+		GLuint getSampler(u32 key);
+
+		//! Packs the pipeline states applied by setBasicRenderStates into 64 bits.
+		/** Blending isn't part of it, as material renderers override it. */
+		u64 getMaterialStateKey(const SMaterial& material) const;
+
+		//! Appliers for the fields of the material state key, see setBasicRenderStates
+		void applyDepthFunc(u32 zbuffer);
+		void applyDepthMask(u32 enable);
+		void applyCullFace(u32 faces);
+		void applyColorMask(u32 colorMask);
+		void applyAlphaToCoverage(u32 enable);
+		void applyLineWidth(u32 thickness);
+
 		//! sets the needed renderstates
 		void setRenderStates3DMode();
 
@@ -322,6 +696,62 @@ namespace video
 
 		void createMaterialRenderers();
 
+		//! Creates the shader constant callback of a built-in material
+		IShaderConstantSetCallBack* createBuiltInCallBack(E_MATERIAL_TYPE type) const;
+
+		//! Variants of the built-in materials for vertices which need more work in the vertex shader
+		enum E_MATERIAL_VARIANT
+		{
+			EMV_NONE = 0,
+			//! Moves EVT_SKINNED vertices by their joints
+			EMV_SKINNING,
+			//! Dequantizes the positions of EVT_COMPACT vertices
+			EMV_COMPACT,
+			//! Blends the positions and normals towards those of a morph target
+			EMV_MORPHING,
+			EMV_COUNT
+		};
+
+		//! Fragment shader permutations of the built-in materials
+		/** The fields of a permutation are compiled into the shaders as constants, so they
+		don't branch on uniforms. EMP_GENERIC keeps the uniforms. */
+		enum E_MATERIAL_PERMUTATION
+		{
+			EMP_GENERIC = 0,
+			//! Set for every permutation with compiled in fields
+			EMP_SPECIALIZED = 1,
+			//! Two bits of fog mode, 0 without fog or the E_FOG_TYPE + 1
+			EMP_FOG_SHIFT = 1,
+			EMP_FOG_MASK = 3 << EMP_FOG_SHIFT,
+			EMP_TEXTURE0 = 8,
+			EMP_TEXTURE1 = 16,
+			EMP_ALPHA_TEST = 32,
+			//! The alpha reference is the edge of the coverage instead of discarding
+			EMP_ALPHA_TO_COVERAGE = 64,
+			//! Writes weighted colors into the buffers of beginTransparencyAccumulation()
+			EMP_WEIGHTED_TRANSPARENCY = 128,
+			EMP_COUNT = 256
+		};
+
+		//! Variant of a built-in material, created on first use
+		/** \return 0 if the material has no such variant. */
+		COpenGL3MaterialRenderer* getMaterialVariantRenderer(E_MATERIAL_TYPE type, E_MATERIAL_VARIANT variant, u32 permutation = EMP_GENERIC);
+
+		//! Permutation matching the fog, textures and alpha reference of a material
+		u32 getMaterialPermutation(const SMaterial& material) const;
+
+		//! Variant needed by the buffer being drawn
+		E_MATERIAL_VARIANT getDrawMaterialVariant() const
+		{
+			return JointMatrices ? EMV_SKINNING : MorphTarget ? EMV_MORPHING : CompactVertices ? EMV_COMPACT : EMV_NONE;
+		}
+
+		//! Renderer used for a material type, variant and permutation
+		IMaterialRenderer* getActiveMaterialRenderer(E_MATERIAL_TYPE type, E_MATERIAL_VARIANT variant, u32 permutation);
+
+		//! Vertex type the vertices of a mesh buffer are drawn with, which differs for compact hardware buffers
+		E_VERTEX_TYPE getDrawVertexType(const scene::IMeshBuffer* mb, const SHWBufferLink_opengl *HWBuffer) const;
+
 		void loadShaderData(const io::path& vertexShaderName, const io::path& fragmentShaderName, c8** vertexShaderData, c8** fragmentShaderData);
 
 		bool setMaterialTexture(irr::u32 layerIdx, const irr::video::ITexture* texture);
@@ -330,12 +760,141 @@ namespace video
 		virtual void setViewPortRaw(u32 width, u32 height);
 
 		void drawQuad(const VertexType &vertexType, const S3DVertex (&vertices)[4]);
+
+		//! Adds a quad to the pending 2D batch, flushing the batch first if its states differ
+		/** Consecutive 2D images and rectangles sharing texture, blending and
+		clip rectangle are drawn with a single draw call by flush2DBatch. */
+		void queue2DQuad(const ITexture* texture, bool alpha, bool alphaChannel,
+				const core::rect<s32>* clipRect, const S3DVertex (&vertices)[4]);
+
+		//! Adds several quads with the same states to the pending 2D batch, and to the recorded lists
+		void queue2DQuads(const ITexture* texture, bool alpha, bool alphaChannel,
+				const core::rect<s32>* clipRect, const S3DVertex* vertices, u32 quadCount);
+
+		//! Invalidates the lists being recorded, called when drawing anything else than queued quads
+		void fail2DRecordings();
+
+		//! Draws the pending 2D quads. Called before anything which could depend on them or change their states.
+		void flush2DBatch();
+
+		//! Adds lines to the pending 3D lines, transformed to world space
+		/** Lines drawn with the same material, view and projection are
+		drawn with a single draw call by flush3DLines, whatever their world
+		transformations, as debug drawing of many nodes switches them. */
+		void queue3DLines(const S3DVertex* vertices, u32 vertexCount);
+
+		//! Draws the pending 3D lines. Called before anything which could depend on them or change their states.
+		void flush3DLines();
+
 		void drawArrays(GLenum primitiveType, const VertexType &vertexType, const void *vertices, int vertexCount);
-		void drawElements(GLenum primitiveType, const VertexType &vertexType, const void *vertices, const u16 *indices, int indexCount);
+		void drawElements(GLenum primitiveType, const VertexType &vertexType, const void *vertices, int vertexCount, const u16 *indices, int indexCount);
 		void drawElements(GLenum primitiveType, const VertexType &vertexType, uintptr_t vertices, uintptr_t indices, int indexCount);
 
 		void beginDraw(const VertexType &vertexType, uintptr_t verticesBase);
 		void endDraw(const VertexType &vertexType);
+		//! Like beginDraw, for vertices stored as one stream per attribute
+		void beginDrawStreams(const VertexType &vertexType, uintptr_t verticesBase, u32 vertexCount, bool positionsOnly);
+		//! True if the current material only writes depth and its shader only needs positions
+		bool isPositionOnlyDraw(const scene::IMeshBuffer* mb) const;
+
+		//! Common checks and state setup of drawVertexPrimitiveList, returns false if there is nothing to draw
+		bool beginDrawPrimitiveList(u32 vertexCount, u32 primitiveCount,
+				E_VERTEX_TYPE vType, scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType);
+
+		//! Issues the draw call for the currently bound vertex attributes
+		void drawPrimitives(const void* indexList, u32 primitiveCount,
+				scene::E_PRIMITIVE_TYPE pType, E_INDEX_TYPE iType, u32 instanceCount = 1);
+
+		//! Binds the geometry of a mesh buffer, from its hardware buffer where mapped and streamed otherwise.
+		/** Returns the index list to pass to drawPrimitives. */
+		const void* beginMeshBufferDraw(const scene::IMeshBuffer* mb, SHWBufferLink_opengl *HWBuffer);
+		void endMeshBufferDraw(const scene::IMeshBuffer* mb, SHWBufferLink_opengl *HWBuffer);
+
+		//! Hardware buffer of a keyframe drawn by drawMeshBufferMorphed, 0 if its vertices can't be blended
+		SHWBufferLink_opengl* getMorphBufferLink(const scene::IMeshBuffer* mb);
+		//! Binds the positions and normals of MorphTarget to the morph attributes
+		void beginMorphTarget();
+		void endMorphTarget();
+
+		//! Sets up the per-instance attributes from an array of S3DInstance in the given buffer
+		void beginInstanceAttributes(GLuint buffer, uintptr_t base);
+		void endInstanceAttributes();
+
+		//! Creates the ring buffer used for transient geometry, if the context can fence it
+		void initStreamBuffer();
+		void deleteStreamBuffer();
+
+		//! Copies data into the current frame's region of the stream buffer.
+		/** Returns false if streaming is unavailable or the region is full. */
+		bool uploadStreamData(const void* data, u32 size, uintptr_t& offset);
+
+		//! Fences the region written this frame and moves on to the next one
+		void finishStreamFrame();
+
+		//! Moves on to the next frame of GPU timers and reads the oldest one if the GPU is done with it
+		void finishGPUTimerFrame();
+
+		//! Fences the presented frame and waits until at most MaxFramesInFlight frames are unfinished
+		void limitFramesInFlight();
+
+		//! Resolves the current render target, or discards the depth and stencil of the screen
+		void discardFrameBuffers();
+
+		//! Scissors to the clipping rectangle and the damage region of the frame, see getScissorRect()
+		void setScissor(const core::rect<s32>* clipRect);
+
+		//! Queries if the bound frame buffer has multiple samples, see usesAlphaToCoverage()
+		void updateRenderTargetMultisampled();
+		GLuint allocateTimerQuery();
+
+		//! Queues the data of a texture created with ETCF_DEFERRED_UPLOAD
+		void queueTextureUpload(COpenGL3Texture* texture);
+
+		//! Uploads the textures staged last frame and stages the next ones within the budget
+		void processTextureUploads();
+
+		//! Hands the queued textures to UploadThread and adopts the ones it uploaded
+		/** Textures it can't take stay in TextureUploadQueue. */
+		void processSharedContextUploads();
+
+		//! Creates the shared context and starts UploadThread, see EVDF_SHARED_CONTEXT_UPLOAD
+		bool startUploadThread();
+
+		//! Stops UploadThread, drops its uploads and destroys the shared context
+		void stopUploadThread();
+
+		//! Uploads the textures of UploadJobs on the shared context, runs on UploadThread
+		void uploadThreadLoop();
+
+		//! A texture uploaded by UploadThread into a new texture object, defined with the driver
+		struct SSharedContextUpload;
+
+		//! Fills a new texture object from the data of a texture and fences it, runs on UploadThread
+		void uploadOnSharedContext(SSharedContextUpload& upload);
+
+		//! Uploads the mip levels requested by streamed textures and drops levels to stay within the budget
+		void processMipStreaming();
+
+		//! Drops the largest level of the streamed texture with the most levels over its request
+		/** \param onlyUnneeded Only consider textures holding more levels than requested.
+		\return False if no texture had a level to drop. */
+		bool dropStreamedLevel(u32& streamedDataSize, bool onlyUnneeded);
+
+		//! Copies the screenshots the GPU is done with to their requests
+		void processScreenShotReadbacks();
+
+		//! Streams client-side vertices and binds them, returns the base to pass to beginDraw
+		uintptr_t streamVertices(const VertexType &vertexType, const void* vertices, u32 vertexCount);
+
+		//! Streams client-side indices and binds them, returns the pointer to pass to glDrawElements
+		const void* streamIndices(const void* indices, u32 size);
+
+		//! Unbinds the buffers bound by streamVertices and streamIndices
+		void endStreamDraw();
+
+		//! Culls a batch on the GPU and draws it with glMultiDrawElementsIndirect
+		/** \return False if the buffers don't share their buffer objects, the batch has to be drawn one by one then. */
+		bool drawCulledBatch(const scene::IMeshBuffer* const* mb, const core::matrix4* worldMatrices, u32 count);
 
 		COpenGL3CacheHandler* CacheHandler;
 		core::stringw Name;
@@ -347,6 +906,196 @@ namespace video
 		bool LockRenderStateMode;
 		u8 AntiAlias;
 
+		//! Hardware buffers get a vertex array object each, so drawing one only needs a single bind
+		bool VertexArrayObjectSupported;
+
+		bool InstancingSupported;
+
+		//! Hardware skinning needs the joint matrices of MAX_SKINNING_JOINTS joints as vertex shader uniforms
+		bool HardwareSkinningSupported;
+		//! Set by drawMeshBuffer while a skinned buffer is drawn
+		const core::matrix4* JointMatrices;
+		u32 JointMatrixCount;
+		//! Variant the last material was set up with
+		E_MATERIAL_VARIANT LastMaterialVariant;
+		//! Permutation the last material was set up with
+		u32 LastMaterialPermutation;
+		//! Variants of the built-in materials, indexed by variant, material type and permutation
+		COpenGL3MaterialRenderer* VariantMaterialRenderers[EMV_COUNT][EMT_ONETEXTURE_BLEND + 1][EMP_COUNT];
+		bool VariantMaterialFailed[EMV_COUNT][EMT_ONETEXTURE_BLEND + 1][EMP_COUNT];
+
+		//! Compact vertices need signed 10:10:10:2 and half float attributes
+		bool CompactVerticesSupported;
+		//! Set by drawHardwareBuffer while a compact buffer is drawn
+		bool CompactVertices;
+		core::vector3df CompactScale;
+		core::vector3df CompactOffset;
+		//! Set by drawMeshBufferMorphed while a buffer is blended towards the vertices of this hardware buffer
+		SHWBufferLink_opengl* MorphTarget;
+		f32 MorphBlend;
+		//! Reused for quantizing vertices before the upload
+		core::array<S3DVertexCompact> CompactVertexData;
+		//! Reused for splitting vertices into attribute streams before the upload
+		core::array<u8> VertexStreamData;
+
+		//! Holds the instance data if it doesn't fit into the stream buffer
+		GLuint InstanceBufferID;
+
+		//! Query target for occlusion queries, 0 if they aren't supported
+		GLenum OcclusionQueryTarget;
+
+		//! Filtering and wrapping are set through shared sampler objects instead of per texture
+		bool SamplerObjectsSupported;
+		std::map<u32, GLuint> Samplers;
+		//! Sampler key and sampler bound to each texture unit
+		u32 BoundSamplerKeys[MATERIAL_MAX_TEXTURES];
+		GLuint BoundSamplers[MATERIAL_MAX_TEXTURES];
+
+		//! Supports GL_KHR_parallel_shader_compile
+		bool ParallelShaderCompileSupported;
+		//! Material renderers added by addHighLevelShaderMaterialAsync which aren't linked yet
+		std::map<s32, COpenGL3MaterialRenderer*> PendingMaterialRenderers;
+
+		//! A scope of beginGPUTimerScope, measured with two timestamp queries
+		struct SGPUTimerScope
+		{
+			core::stringc Name;
+			u32 Depth;
+			GLuint BeginQuery;
+			GLuint EndQuery;
+		};
+
+		//! Timer scopes are kept for a few frames, so reading them never waits for the GPU
+		static constexpr u32 GPUTimerFrames = 3;
+		bool TimerQuerySupported;
+		core::array<SGPUTimerScope> GPUTimerScopes[GPUTimerFrames];
+		u32 GPUTimerFrame;
+		//! Indices of the open scopes of the current frame
+		core::array<u32> GPUTimerStack;
+		core::array<GLuint> FreeTimerQueries;
+
+		//! Timestamps of a whole frame for the frame time history
+		struct SGPUFrameTimer
+		{
+			GLuint BeginQuery;
+			GLuint EndQuery;
+			u32 Frame;
+		};
+
+		//! kept for GPUTimerFrames frames like the timer scopes
+		SGPUFrameTimer GPUFrameTimers[GPUTimerFrames];
+		//! begin timestamp of the current frame, 0 if not measured
+		GLuint GPUFrameBeginQuery;
+
+		//! A texture written to a pixel unpack buffer, uploaded from it one frame later
+		struct STextureUpload
+		{
+			COpenGL3Texture* Texture;
+			GLuint Buffer;
+		};
+
+		//! Supports filling pixel unpack buffers through MapBufferRange
+		bool TextureUploadQueueSupported;
+		//! Large updates of dynamic hardware buffers map the range instead of calling glBufferSubData
+		bool BufferMapRangeSupported;
+		//! Grabbed textures waiting to be staged, in creation order
+		std::deque<COpenGL3Texture*> TextureUploadQueue;
+		std::vector<STextureUpload> StagedTextureUploads;
+		std::vector<GLuint> FreeTextureUploadBuffers;
+
+		//! Supports fences to hand textures between contexts, false once no shared context could be created
+		bool SharedContextUploadSupported;
+		//! Uploads textures of ETCF_DEFERRED_UPLOAD on UploadContext, shared with the context of the driver
+		std::thread UploadThread;
+		void* UploadContext;
+		std::mutex UploadMutex;
+		std::condition_variable UploadWake;
+		bool UploadThreadQuit;
+		//! Waiting for UploadThread, guarded by UploadMutex
+		std::deque<SSharedContextUpload*> UploadJobs;
+		//! Uploaded by UploadThread, guarded by UploadMutex
+		std::vector<SSharedContextUpload*> FinishedUploads;
+		//! Waiting for their fence on the thread of the driver
+		std::vector<SSharedContextUpload*> FencedUploads;
+
+		//! Supports glTexStorage2D
+		bool TextureStorageSupported;
+		//! Supports one and two channel textures
+		bool TextureRGSupported;
+		//! Grabbed textures created with ETCF_STREAM_MIP_MAPS
+		std::vector<COpenGL3Texture*> StreamedTextures;
+
+		//! A screenshot or texture read into a pixel pack buffer, mapped once its fence signals
+		struct SScreenShotReadback
+		{
+			CScreenShotRequest* Request;
+			GLuint Buffer;
+			GLsync Fence;
+		};
+
+		//! Supports pixel pack buffers and fences
+		bool AsyncReadbackSupported;
+		std::vector<SScreenShotReadback> ScreenShotReadbacks;
+
+		//! Frames the GPU may lag behind endScene(), 0 without limit
+		u32 MaxFramesInFlight;
+		//! Fences following the presentation of the unfinished frames, oldest first
+		std::deque<GLsync> FrameFences;
+
+		//! Block compressed texture formats the context can sample
+		bool TextureCompressionDXT;
+		bool TextureCompressionETC2;
+		bool TextureCompressionBPTC;
+		bool TextureCompressionASTC;
+		//! glClipControl, to clip depth from 0 to 1 for reverse depth
+		bool ClipControlSupported;
+
+		//! Path of the shader cache, empty if program binaries are not used
+		io::path ShaderCachePath;
+		//! Identifies the driver which created the cached programs
+		u64 ShaderCacheDriverHash;
+
+		//! Returns the name of the cache file for a program
+		io::path getProgramBinaryFileName(const c8* vertexShaderProgram, const c8* pixelShaderProgram) const;
+
+		//! Buffers of the built-in uniform blocks, bound to the binding point of the same index
+		bool UniformBlocksSupported;
+		GLuint BuiltInUniformBlockBuffers[EUB_COUNT];
+		bool BuiltInUniformBlockDirty[EUB_COUNT];
+
+		//! State key of Material, updated whenever Material is assigned
+		u64 MaterialStateKey;
+		//! State key of the pipeline states currently applied
+		u64 AppliedStateKey;
+
+		static constexpr u32 StreamBufferRegions = 3;
+		static constexpr u32 StreamBufferRegionSize = 2 * 1024 * 1024;
+
+		//! Ring buffer for client-side geometry, with one fenced region per frame in flight
+		struct SStreamBuffer
+		{
+			GLuint ID = 0;
+			//! Persistent mapping of the whole buffer, 0 if each upload maps its own range
+			u8* Mapped = nullptr;
+			COpenGLCoreStreamAllocator Allocator{StreamBufferRegions, StreamBufferRegionSize};
+			GLsync Fences[StreamBufferRegions] = {};
+		};
+
+		SStreamBuffer StreamBuffer;
+
+		static constexpr u32 BufferArenaSize = 4 * 1024 * 1024;
+		//! Larger static buffers still get a buffer object of their own
+		static constexpr u32 BufferArenaMaxRange = BufferArenaSize / 4;
+		//! Smaller updates of dynamic buffers are cheaper with glBufferSubData than with a mapping
+		static constexpr u32 BufferMapRangeMinSize = 64 * 1024;
+
+		std::list<SBufferArena> BufferArenas;
+
+		//! Names of released mesh buffer objects, reused before generating new ones
+		std::vector<GLuint> FreeBufferNames;
+		//! More released names are deleted
+		static constexpr u32 FreeBufferNamesMax = 256;
+
 		struct SUserClipPlane
 		{
 			core::plane3df Plane;
@@ -362,8 +1111,12 @@ private:
 		COpenGL3Renderer2D* MaterialRenderer2DActive;
 		COpenGL3Renderer2D* MaterialRenderer2DTexture;
 		COpenGL3Renderer2D* MaterialRenderer2DNoTexture;
+		COpenGL3Renderer2D* MaterialRenderer2DDistanceField;
 
 		core::matrix4 Matrices[ETS_COUNT];
+		core::matrix4 DerivedMatrices[EDM_COUNT];
+		//! Bit per E_DERIVED_MATRIX which has to be computed again
+		u32 DerivedMatricesDirty;
 
 		//! enumeration for rendering modes such as 2d and 3d for minimizing the switching of renderStates.
 		enum E_RENDER_MODE
@@ -378,6 +1131,8 @@ private:
 		irr::io::path OGLES2ShaderPath;
 
 		SMaterial Material, LastMaterial;
+		//! Changes whenever Material does, so LastMaterial only needs a compare after that
+		u32 MaterialRevision, LastMaterialRevision;
 
 		//! Color buffer format
 		ECOLOR_FORMAT ColorFormat;
@@ -387,6 +1142,71 @@ private:
 		std::vector<u16> QuadsIndices;
 		void initQuadsIndices(int max_vertex_count = 65536);
 
+		//! Quads queued by queue2DQuad and the states they are drawn with
+		struct S2DBatch
+		{
+			//! Grabbed while quads are pending, 0 for untextured quads
+			const ITexture* Texture = nullptr;
+			bool Alpha = false;
+			bool AlphaChannel = false;
+			bool Clip = false;
+			core::rect<s32> ClipRect;
+			core::array<S3DVertex> Vertices;
+		};
+
+		S2DBatch Batch2D;
+		//! Swapped with the batch vertices while they are drawn
+		core::array<S3DVertex> Batch2DDrawVertices;
+
+		//! Lines queued by queue3DLines, in world space
+		core::array<S3DVertex> Lines3D;
+		//! Swapped with the queued lines while they are drawn
+		core::array<S3DVertex> Lines3DDrawVertices;
+		static constexpr u32 MaxLines3DVertices = 65536;
+
+		//! Lists queue2DQuads records into, innermost recording last
+		core::array<S2DDrawList*> Recordings2D;
+		//! Increased when textures are removed or replaced, which outdates recorded lists
+		u32 Recording2DGeneration = 1;
+
+		//! Pages of the textures created with ETCF_ALLOW_ATLAS
+		COpenGL3TextureAtlas* TextureAtlas = nullptr;
+
+		//! Evicts textures to stay within the texture memory budget
+		COpenGL3TextureResidency* TextureResidency = nullptr;
+
+		//! Culls batches of static buffers with compute shaders, 0 if they aren't supported
+		COpenGL3GPUCulling* GPUCulling = nullptr;
+		//! Smaller batches are drawn one by one, culling them on the GPU doesn't pay off
+		static constexpr u32 GPUCullingMinBatch = 64;
+
+		//! Buffers of order-independent transparency, 0 if they aren't supported
+		COpenGL3WeightedTransparency* WeightedTransparency = nullptr;
+		bool TransparencyAccumulating = false;
+
+		//! Supports KHR_debug
+		bool DebugOutputSupported = false;
+		E_ERROR_CHECK_MODE ErrorCheckMode = EECM_NONE;
+		ELOG_LEVEL DebugMessageLevel = ELL_INFORMATION;
+
+		//! Occurrences of a debug message since the last report
+		struct SDebugMessageCount
+		{
+			u32 Count = 0;
+			u32 Logged = 0;
+		};
+
+		//! Messages logged each second before they are only counted
+		static constexpr u32 DebugMessagesLoggedPerReport = 3;
+		//! Keyed by source, type and ID. Guarded by DebugMessageMutex, as
+		//! asynchronous debug output may arrive on threads of the GL driver
+		std::map<u64, SDebugMessageCount> DebugMessageCounts;
+		std::mutex DebugMessageMutex;
+		u32 DebugMessageReportTime = 0;
+
+		//! Logs how often the messages were repeated, once a second
+		void reportDebugMessages();
+
 		void debugCb(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message);
 		static void APIENTRY debugCb(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message, const void *userParam);
 	};
@@ -22,16 +22,14 @@ namespace video
 		glGetIntegerv(GL_MINOR_VERSION, &minor);
 		Version = 100 * major + 10 * minor;
 
+		static const CGLExtensionNameIndex knownExtensions(getFeatureStrings(), IRR_OGLES_Feature_Count);
 		GLint ext_count = 0;
 		GL.GetIntegerv(GL_NUM_EXTENSIONS, &ext_count);
 		for (int k = 0; k < ext_count; k++) {
-			auto ext_name = (char *)GL.GetStringi(GL_EXTENSIONS, k);
-			for (size_t j=0; j<IRR_OGLES_Feature_Count; ++j) {
-				if (!strcmp(getFeatureString(j), ext_name)) {
-					FeatureAvailable[j] = true;
-					break;
-				}
-			}
+			auto ext_name = (const char *)GL.GetStringi(GL_EXTENSIONS, k);
+			const s32 index = ext_name ? knownExtensions.find(ext_name, strlen(ext_name)) : -1;
+			if (index >= 0)
+				FeatureAvailable[index] = true;
 		}
 
 		GLint val=0;
@@ -62,5 +60,10 @@ namespace video
 		Feature.ColorAttachment = 1;
 	}
 
+	void COpenGL3ExtensionHandler::irrGlBindTextures(GLuint first, GLsizei count, const GLuint* textures)
+	{
+		GL.BindTextures(first, count, textures);
+	}
+
 } // end namespace video
 } // end namespace irr
@@ -97,6 +97,8 @@ namespace video
 			glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, data);
 		}
 
+		void irrGlBindTextures(GLuint first, GLsizei count, const GLuint* textures);
+
 		inline void irrGlUseProgram(GLuint prog)
 		{
 			glUseProgram(prog);
@@ -132,6 +134,26 @@ namespace video
 			glGenerateMipmap(target);
 		}
 
+		inline void irrGlBindRenderbuffer(GLenum target, GLuint renderbuffer)
+		{
+			glBindRenderbuffer(target, renderbuffer);
+		}
+
+		inline void irrGlDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
+		{
+			glDeleteRenderbuffers(n, renderbuffers);
+		}
+
+		inline void irrGlGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
+		{
+			glGenRenderbuffers(n, renderbuffers);
+		}
+
+		inline void irrGlFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+		{
+			glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+		}
+
 		inline void irrGlActiveStencilFace(GLenum face)
 		{
 		}
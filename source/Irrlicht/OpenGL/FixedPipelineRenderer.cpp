@@ -5,6 +5,7 @@
 #include "FixedPipelineRenderer.h"
 
 #include "IVideoDriver.h"
+#include "Driver.h"
 
 namespace irr
 {
@@ -16,7 +17,7 @@ namespace video
 COpenGL3MaterialBaseCB::COpenGL3MaterialBaseCB() :
 	FirstUpdateBase(true), WVPMatrixID(-1), WVMatrixID(-1), NMatrixID(-1), GlobalAmbientID(-1), MaterialAmbientID(-1), MaterialDiffuseID(-1), MaterialEmissiveID(-1), MaterialSpecularID(-1), MaterialShininessID(-1),
 	FogEnableID(-1), FogTypeID(-1), FogColorID(-1), FogStartID(-1),
-	FogEndID(-1), FogDensityID(-1), ThicknessID(-1), LightEnable(false), MaterialAmbient(SColorf(0.f, 0.f, 0.f)), MaterialDiffuse(SColorf(0.f, 0.f, 0.f)), MaterialEmissive(SColorf(0.f, 0.f, 0.f)), MaterialSpecular(SColorf(0.f, 0.f, 0.f)),
+	FogEndID(-1), FogDensityID(-1), ThicknessID(-1), JointMatricesID(-1), PositionScaleID(-1), PositionOffsetID(-1), MorphBlendID(-1), LightEnable(false), MaterialAmbient(SColorf(0.f, 0.f, 0.f)), MaterialDiffuse(SColorf(0.f, 0.f, 0.f)), MaterialEmissive(SColorf(0.f, 0.f, 0.f)), MaterialSpecular(SColorf(0.f, 0.f, 0.f)),
 	MaterialShininess(0.f), FogEnable(0), FogType(1), FogColor(SColorf(0.f, 0.f, 0.f, 1.f)), FogStart(0.f), FogEnd(0.f), FogDensity(0.f), Thickness(1.f)
 {
 }
@@ -57,22 +58,22 @@ void COpenGL3MaterialBaseCB::OnSetConstants(IMaterialRendererServices* services,
 		FogEndID = services->getVertexShaderConstantID("uFogEnd");
 		FogDensityID = services->getVertexShaderConstantID("uFogDensity");
 		ThicknessID = services->getVertexShaderConstantID("uThickness");
+		JointMatricesID = services->getVertexShaderConstantID("uJointMatrices");
+		PositionScaleID = services->getVertexShaderConstantID("uPositionScale");
+		PositionOffsetID = services->getVertexShaderConstantID("uPositionOffset");
+		MorphBlendID = services->getVertexShaderConstantID("uMorphBlend");
 
 		FirstUpdateBase = false;
 	}
 
-	const core::matrix4 W = driver->getTransform(ETS_WORLD);
-	const core::matrix4 V = driver->getTransform(ETS_VIEW);
-	const core::matrix4 P = driver->getTransform(ETS_PROJECTION);
-
-	core::matrix4 Matrix = P * V * W;
-	services->setPixelShaderConstant(WVPMatrixID, Matrix.pointer(), 16);
-
-	Matrix = V * W;
-	services->setPixelShaderConstant(WVMatrixID, Matrix.pointer(), 16);
-
-	Matrix.makeInverse();
-	services->setPixelShaderConstant(NMatrixID, Matrix.getTransposed().pointer(), 16);
+	// the driver keeps the products until a transformation changes, unchanged values aren't sent again
+	COpenGL3DriverBase* glDriver = static_cast<COpenGL3DriverBase*>(driver);
+	if (WVPMatrixID >= 0)
+		services->setPixelShaderConstant(WVPMatrixID, glDriver->getDerivedMatrix(COpenGL3DriverBase::EDM_WORLD_VIEW_PROJECTION).pointer(), 16);
+	if (WVMatrixID >= 0)
+		services->setPixelShaderConstant(WVMatrixID, glDriver->getDerivedMatrix(COpenGL3DriverBase::EDM_WORLD_VIEW).pointer(), 16);
+	if (NMatrixID >= 0)
+		services->setPixelShaderConstant(NMatrixID, glDriver->getDerivedMatrix(COpenGL3DriverBase::EDM_NORMAL).pointer(), 16);
 
 	services->setPixelShaderConstant(FogEnableID, &FogEnable, 1);
 
@@ -96,6 +97,47 @@ void COpenGL3MaterialBaseCB::OnSetConstants(IMaterialRendererServices* services,
 	}
 
 	services->setPixelShaderConstant(ThicknessID, &Thickness, 1);
+
+	if (JointMatricesID >= 0)
+	{
+		u32 count = 0;
+		const core::matrix4* joints = glDriver->getJointMatrices(count);
+		count = core::min_(count, MAX_SKINNING_JOINTS);
+
+		// the affine part is enough, the shader rebuilds the last row
+		for (u32 i = 0; i < count; ++i)
+		{
+			const f32* m = joints[i].pointer();
+			f32* rows = &JointRows[i * 12];
+			for (u32 r = 0; r < 3; ++r)
+			{
+				rows[r * 4 + 0] = m[r];
+				rows[r * 4 + 1] = m[4 + r];
+				rows[r * 4 + 2] = m[8 + r];
+				rows[r * 4 + 3] = m[12 + r];
+			}
+		}
+
+		if (count)
+			services->setPixelShaderConstant(JointMatricesID, JointRows, count * 12);
+	}
+
+	if (PositionScaleID >= 0)
+	{
+		core::vector3df scale;
+		core::vector3df offset;
+		glDriver->getCompactVertexTransform(scale, offset);
+
+		services->setVertexShaderConstant(PositionScaleID, &scale.X, 3);
+		services->setVertexShaderConstant(PositionOffsetID, &offset.X, 3);
+	}
+
+	if (MorphBlendID >= 0)
+	{
+		f32 blend = 0.f;
+		glDriver->getMorphBlend(blend);
+		services->setVertexShaderConstant(MorphBlendID, &blend, 1);
+	}
 }
 
 // EMT_SOLID + EMT_TRANSPARENT_ADD_COLOR + EMT_TRANSPARENT_ALPHA_CHANNEL + EMT_TRANSPARENT_VERTEX_ALPHA
@@ -129,8 +171,7 @@ void COpenGL3MaterialSolidCB::OnSetConstants(IMaterialRendererServices* services
 		FirstUpdate = false;
 	}
 
-	core::matrix4 Matrix = driver->getTransform(ETS_TEXTURE_0);
-	services->setPixelShaderConstant(TMatrix0ID, Matrix.pointer(), 16);
+	services->setPixelShaderConstant(TMatrix0ID, driver->getTransform(ETS_TEXTURE_0).pointer(), 16);
 
 	services->setPixelShaderConstant(AlphaRefID, &AlphaRef, 1);
 	services->setPixelShaderConstant(TextureUsage0ID, &TextureUsage0, 1);
@@ -171,11 +212,9 @@ void COpenGL3MaterialSolid2CB::OnSetConstants(IMaterialRendererServices* service
 		FirstUpdate = false;
 	}
 
-	core::matrix4 Matrix = driver->getTransform(ETS_TEXTURE_0);
-	services->setPixelShaderConstant(TMatrix0ID, Matrix.pointer(), 16);
+	services->setPixelShaderConstant(TMatrix0ID, driver->getTransform(ETS_TEXTURE_0).pointer(), 16);
 
-	Matrix = driver->getTransform(E_TRANSFORMATION_STATE(ETS_TEXTURE_0 + 1));
-	services->setPixelShaderConstant(TMatrix1ID, Matrix.pointer(), 16);
+	services->setPixelShaderConstant(TMatrix1ID, driver->getTransform(E_TRANSFORMATION_STATE(ETS_TEXTURE_0 + 1)).pointer(), 16);
 
 	services->setPixelShaderConstant(TextureUsage0ID, &TextureUsage0, 1);
 	services->setPixelShaderConstant(TextureUsage1ID, &TextureUsage1, 1);
@@ -218,11 +257,9 @@ void COpenGL3MaterialLightmapCB::OnSetConstants(IMaterialRendererServices* servi
 		FirstUpdate = false;
 	}
 
-	core::matrix4 Matrix = driver->getTransform(ETS_TEXTURE_0);
-	services->setPixelShaderConstant(TMatrix0ID, Matrix.pointer(), 16);
+	services->setPixelShaderConstant(TMatrix0ID, driver->getTransform(ETS_TEXTURE_0).pointer(), 16);
 
-	Matrix = driver->getTransform(E_TRANSFORMATION_STATE(ETS_TEXTURE_0 + 1));
-	services->setPixelShaderConstant(TMatrix1ID, Matrix.pointer(), 16);
+	services->setPixelShaderConstant(TMatrix1ID, driver->getTransform(E_TRANSFORMATION_STATE(ETS_TEXTURE_0 + 1)).pointer(), 16);
 
 	services->setPixelShaderConstant(ModulateID, &Modulate, 1);
 	services->setPixelShaderConstant(TextureUsage0ID, &TextureUsage0, 1);
@@ -264,8 +301,7 @@ void COpenGL3MaterialReflectionCB::OnSetConstants(IMaterialRendererServices* ser
 		FirstUpdate = false;
 	}
 
-	core::matrix4 Matrix = driver->getTransform(ETS_TEXTURE_0);
-	services->setPixelShaderConstant(TMatrix0ID, Matrix.pointer(), 16);
+	services->setPixelShaderConstant(TMatrix0ID, driver->getTransform(ETS_TEXTURE_0).pointer(), 16);
 
 	services->setPixelShaderConstant(TextureUsage0ID, &TextureUsage0, 1);
 	services->setPixelShaderConstant(TextureUsage1ID, &TextureUsage1, 1);
@@ -322,8 +358,7 @@ void COpenGL3MaterialOneTextureBlendCB::OnSetConstants(IMaterialRendererServices
 		FirstUpdate = false;
 	}
 
-	core::matrix4 Matrix = driver->getTransform(ETS_TEXTURE_0);
-	services->setPixelShaderConstant(TMatrix0ID, Matrix.pointer(), 16);
+	services->setPixelShaderConstant(TMatrix0ID, driver->getTransform(ETS_TEXTURE_0).pointer(), 16);
 
 	services->setPixelShaderConstant(BlendTypeID, &BlendType, 1);
 	services->setPixelShaderConstant(TextureUsage0ID, &TextureUsage0, 1);
@@ -6,6 +6,7 @@
 
 #include "IShaderConstantSetCallBack.h"
 #include "IMaterialRendererServices.h"
+#include "S3DVertex.h"
 
 namespace irr
 {
@@ -43,6 +44,16 @@ protected:
 
 	s32 ThicknessID;
 
+	//! Only found in the skinning variants of the shaders
+	s32 JointMatricesID;
+
+	//! Only found in the compact variants of the shaders
+	s32 PositionScaleID;
+	s32 PositionOffsetID;
+
+	//! Only found in the morphing variants of the shaders
+	s32 MorphBlendID;
+
 	bool LightEnable;
 	SColorf GlobalAmbient;
 	SColorf MaterialAmbient;
@@ -59,6 +70,9 @@ protected:
 	f32 FogDensity;
 
 	f32 Thickness;
+
+	//! First three rows of each joint matrix
+	f32 JointRows[MAX_SKINNING_JOINTS * 12];
 };
 
 class COpenGL3MaterialSolidCB : public COpenGL3MaterialBaseCB
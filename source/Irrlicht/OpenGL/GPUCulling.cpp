@@ -0,0 +1,377 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#include "GPUCulling.h"
+
+#include "Driver.h"
+
+#include "COpenGLCoreCacheHandler.h"
+#include "os.h"
+
+#include "mt_opengl.h"
+
+namespace irr
+{
+namespace video
+{
+
+// std430 layout of DrawElementsIndirectCommand
+static constexpr u32 CommandSize = 5 * sizeof(u32);
+
+static constexpr u32 CullGroupSize = 64;
+static constexpr u32 PyramidGroupSize = 8;
+
+// above the units of the materials, so the cache handler never binds this one
+static constexpr u32 CullTextureUnit = MATERIAL_MAX_TEXTURES;
+
+static const c8* const CullShader =
+	"#version 430\n"
+	"layout(local_size_x = 64) in;\n"
+	"struct Draw { vec4 MinEdge; vec4 MaxEdge; uvec4 Params; };\n"
+	"struct Command { uint Count; uint InstanceCount; uint FirstIndex; int BaseVertex; uint BaseInstance; };\n"
+	"layout(std430, binding = 0) readonly buffer Draws { Draw draws[]; };\n"
+	"layout(std430, binding = 1) writeonly buffer Commands { Command commands[]; };\n"
+	"uniform mat4 uViewProjection;\n"
+	"uniform mat4 uHiZViewProjection;\n"
+	"uniform uint uCount;\n"
+	"uniform int uHiZLevels;\n"
+	"uniform bool uDepthZeroToOne;\n"
+	"uniform bool uReverseDepth;\n"
+	"uniform sampler2D uHiZ;\n"
+	"vec3 corner(vec3 minEdge, vec3 maxEdge, int i)\n"
+	"{\n"
+	"	return vec3((i & 1) != 0 ? maxEdge.x : minEdge.x, (i & 2) != 0 ? maxEdge.y : minEdge.y, (i & 4) != 0 ? maxEdge.z : minEdge.z);\n"
+	"}\n"
+	"bool outsideFrustum(vec3 minEdge, vec3 maxEdge)\n"
+	"{\n"
+	"	uint outside = 63u;\n"
+	"	for (int i = 0; i < 8; ++i)\n"
+	"	{\n"
+	"		vec4 c = uViewProjection * vec4(corner(minEdge, maxEdge, i), 1.0);\n"
+	"		uint planes = 0u;\n"
+	"		if (c.x < -c.w) planes |= 1u;\n"
+	"		if (c.x > c.w) planes |= 2u;\n"
+	"		if (c.y < -c.w) planes |= 4u;\n"
+	"		if (c.y > c.w) planes |= 8u;\n"
+	"		if (c.z < (uDepthZeroToOne ? 0.0 : -c.w)) planes |= 16u;\n"
+	"		if (c.z > c.w) planes |= 32u;\n"
+	"		outside &= planes;\n"
+	"	}\n"
+	"	return outside != 0u;\n"
+	"}\n"
+	"bool occluded(vec3 minEdge, vec3 maxEdge)\n"
+	"{\n"
+	"	vec2 low = vec2(1.0);\n"
+	"	vec2 high = vec2(0.0);\n"
+	"	float nearest = 1.0;\n"
+	"	for (int i = 0; i < 8; ++i)\n"
+	"	{\n"
+	"		vec4 c = uHiZViewProjection * vec4(corner(minEdge, maxEdge, i), 1.0);\n"
+	"		// boxes reaching behind the camera of the pyramid can't be tested\n"
+	"		if (c.w <= 0.0)\n"
+	"			return false;\n"
+	"		vec3 ndc = c.xyz / c.w;\n"
+	"		vec2 uv = ndc.xy * 0.5 + 0.5;\n"
+	"		low = min(low, uv);\n"
+	"		high = max(high, uv);\n"
+	"		float depth = uDepthZeroToOne ? ndc.z : ndc.z * 0.5 + 0.5;\n"
+	"		nearest = min(nearest, uReverseDepth ? 1.0 - depth : depth);\n"
+	"	}\n"
+	"	vec2 size = vec2(textureSize(uHiZ, 0));\n"
+	"	low = clamp(low, 0.0, 1.0) * size;\n"
+	"	high = clamp(high, 0.0, 1.0) * size;\n"
+	"	// the level where the box covers at most three texels in each direction\n"
+	"	float extent = max(max(high.x - low.x, high.y - low.y), 1.0);\n"
+	"	int level = clamp(int(ceil(log2(extent))) - 1, 0, uHiZLevels - 1);\n"
+	"	ivec2 last = textureSize(uHiZ, level) - 1;\n"
+	"	ivec2 begin = min(ivec2(low) >> level, last);\n"
+	"	ivec2 end = min(ivec2(high) >> level, last);\n"
+	"	if (any(greaterThan(end - begin, ivec2(2))))\n"
+	"		return false;\n"
+	"	float farthest = 0.0;\n"
+	"	for (int y = begin.y; y <= end.y; ++y)\n"
+	"		for (int x = begin.x; x <= end.x; ++x)\n"
+	"			farthest = max(farthest, texelFetch(uHiZ, ivec2(x, y), level).r);\n"
+	"	return nearest > farthest;\n"
+	"}\n"
+	"void main()\n"
+	"{\n"
+	"	uint i = gl_GlobalInvocationID.x;\n"
+	"	if (i >= uCount)\n"
+	"		return;\n"
+	"	Draw draw = draws[i];\n"
+	"	bool visible = !outsideFrustum(draw.MinEdge.xyz, draw.MaxEdge.xyz) &&\n"
+	"		(uHiZLevels == 0 || !occluded(draw.MinEdge.xyz, draw.MaxEdge.xyz));\n"
+	"	commands[i] = Command(draw.Params.x, visible ? 1u : 0u, draw.Params.y, int(draw.Params.z), 0u);\n"
+	"}\n";
+
+static const c8* const PyramidShader =
+	"#version 430\n"
+	"layout(local_size_x = 8, local_size_y = 8) in;\n"
+	"layout(r32f, binding = 0) readonly uniform image2D uSource;\n"
+	"layout(r32f, binding = 1) writeonly uniform image2D uTarget;\n"
+	"uniform sampler2D uDepth;\n"
+	"uniform bool uFromDepth;\n"
+	"uniform bool uReverseDepth;\n"
+	"void main()\n"
+	"{\n"
+	"	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);\n"
+	"	ivec2 size = imageSize(uTarget);\n"
+	"	if (any(greaterThanEqual(texel, size)))\n"
+	"		return;\n"
+	"	if (uFromDepth)\n"
+	"	{\n"
+	"		float depth = texelFetch(uDepth, texel, 0).r;\n"
+	"		imageStore(uTarget, texel, vec4(uReverseDepth ? 1.0 - depth : depth));\n"
+	"		return;\n"
+	"	}\n"
+	"	// the last texels also cover the odd row and column of the source\n"
+	"	ivec2 sourceSize = imageSize(uSource);\n"
+	"	ivec2 begin = texel * 2;\n"
+	"	ivec2 end = min(begin + 1 + ivec2(equal(texel, size - 1)) * (sourceSize & 1), sourceSize - 1);\n"
+	"	float farthest = 0.0;\n"
+	"	for (int y = begin.y; y <= end.y; ++y)\n"
+	"		for (int x = begin.x; x <= end.x; ++x)\n"
+	"			farthest = max(farthest, imageLoad(uSource, ivec2(x, y)).r);\n"
+	"	imageStore(uTarget, texel, vec4(farthest));\n"
+	"}\n";
+
+COpenGL3GPUCulling::COpenGL3GPUCulling(COpenGL3DriverBase* driver) : Driver(driver),
+	CullProgram(0), CullViewProjection(-1), CullHiZViewProjection(-1), CullCount(-1),
+	CullHiZLevels(-1), CullDepthZeroToOne(-1), CullReverseDepth(-1),
+	PyramidProgram(0), PyramidFromDepth(-1), PyramidReverseDepth(-1),
+	DrawBuffer(0), CommandBuffer(0), DepthTexture(0), PyramidTexture(0), PyramidLevels(0),
+	ScreenMultisampled(false), PyramidValid(false), PyramidBuiltReverseDepth(false),
+	FrameToScreen(false), FrameReverseDepth(false)
+{
+}
+
+COpenGL3GPUCulling::~COpenGL3GPUCulling()
+{
+	if (CullProgram)
+		glDeleteProgram(CullProgram);
+	if (PyramidProgram)
+		glDeleteProgram(PyramidProgram);
+	if (DrawBuffer)
+		glDeleteBuffers(1, &DrawBuffer);
+	if (CommandBuffer)
+		glDeleteBuffers(1, &CommandBuffer);
+	if (DepthTexture)
+		glDeleteTextures(1, &DepthTexture);
+	if (PyramidTexture)
+		glDeleteTextures(1, &PyramidTexture);
+}
+
+bool COpenGL3GPUCulling::init()
+{
+	CullProgram = compileProgram(CullShader, "culling");
+	PyramidProgram = compileProgram(PyramidShader, "depth pyramid");
+	if (!CullProgram || !PyramidProgram)
+		return false;
+
+	CullViewProjection = glGetUniformLocation(CullProgram, "uViewProjection");
+	CullHiZViewProjection = glGetUniformLocation(CullProgram, "uHiZViewProjection");
+	CullCount = glGetUniformLocation(CullProgram, "uCount");
+	CullHiZLevels = glGetUniformLocation(CullProgram, "uHiZLevels");
+	CullDepthZeroToOne = glGetUniformLocation(CullProgram, "uDepthZeroToOne");
+	CullReverseDepth = glGetUniformLocation(CullProgram, "uReverseDepth");
+	PyramidFromDepth = glGetUniformLocation(PyramidProgram, "uFromDepth");
+	PyramidReverseDepth = glGetUniformLocation(PyramidProgram, "uReverseDepth");
+
+	COpenGL3CacheHandler* cacheHandler = Driver->getCacheHandler();
+	cacheHandler->setProgram(CullProgram);
+	glUniform1i(glGetUniformLocation(CullProgram, "uHiZ"), CullTextureUnit);
+	cacheHandler->setProgram(PyramidProgram);
+	glUniform1i(glGetUniformLocation(PyramidProgram, "uDepth"), CullTextureUnit);
+	cacheHandler->setProgram(0);
+
+	glGenBuffers(1, &DrawBuffer);
+	glGenBuffers(1, &CommandBuffer);
+
+	// called while the screen is bound
+	GLint sampleBuffers = 0;
+	glGetIntegerv(GL.SAMPLE_BUFFERS, &sampleBuffers);
+	ScreenMultisampled = sampleBuffers != 0;
+
+	return DrawBuffer && CommandBuffer;
+}
+
+COpenGL3GPUCulling::SDraw* COpenGL3GPUCulling::beginBatch(u32 count)
+{
+	Draws.set_used(count);
+	return Draws.pointer();
+}
+
+void COpenGL3GPUCulling::cull(const core::matrix4& world, const core::matrix4& viewProjection, bool toScreen)
+{
+	const u32 count = Draws.size();
+	COpenGL3CacheHandler* cacheHandler = Driver->getCacheHandler();
+
+	// orphaned for each batch, the GPU may still read the storage of the previous one
+	glBindBuffer(GL.SHADER_STORAGE_BUFFER, DrawBuffer);
+	glBufferData(GL.SHADER_STORAGE_BUFFER, count * sizeof(SDraw), Draws.const_pointer(), GL_STREAM_DRAW);
+	glBindBuffer(GL.SHADER_STORAGE_BUFFER, CommandBuffer);
+	glBufferData(GL.SHADER_STORAGE_BUFFER, count * CommandSize, 0, GL_STREAM_DRAW);
+	glBindBuffer(GL.SHADER_STORAGE_BUFFER, 0);
+	GL.BindBufferBase(GL.SHADER_STORAGE_BUFFER, 0, DrawBuffer);
+	GL.BindBufferBase(GL.SHADER_STORAGE_BUFFER, 1, CommandBuffer);
+
+	const bool reverseDepth = Driver->isReverseDepth();
+	core::matrix4 transform(viewProjection);
+	transform *= world;
+
+	cacheHandler->setProgram(CullProgram);
+	glUniformMatrix4fv(CullViewProjection, 1, GL_FALSE, transform.pointer());
+	GL.Uniform1ui(CullCount, count);
+	glUniform1i(CullDepthZeroToOne, reverseDepth && Driver->queryFeature(EVDF_DEPTH_CLIP_CONTROL));
+	glUniform1i(CullReverseDepth, reverseDepth);
+
+	const bool hiZ = PyramidValid && PyramidBuiltReverseDepth == reverseDepth;
+	glUniform1i(CullHiZLevels, hiZ ? PyramidLevels : 0);
+	if (hiZ)
+	{
+		transform = PyramidViewProjection;
+		transform *= world;
+		glUniformMatrix4fv(CullHiZViewProjection, 1, GL_FALSE, transform.pointer());
+
+		GLenum activeTexture = 0;
+		cacheHandler->getActiveTexture(activeTexture);
+		cacheHandler->setActiveTexture(GL_TEXTURE0 + CullTextureUnit);
+		glBindTexture(GL_TEXTURE_2D, PyramidTexture);
+		cacheHandler->setActiveTexture(activeTexture);
+	}
+
+	GL.DispatchCompute((count + CullGroupSize - 1) / CullGroupSize, 1, 1);
+	GL.MemoryBarrier(GL.COMMAND_BARRIER_BIT);
+	glBindBuffer(GL.DRAW_INDIRECT_BUFFER, CommandBuffer);
+
+	if (toScreen)
+	{
+		FrameToScreen = true;
+		FrameReverseDepth = reverseDepth;
+		FrameViewProjection = viewProjection;
+	}
+}
+
+void COpenGL3GPUCulling::endBatch()
+{
+	glBindBuffer(GL.DRAW_INDIRECT_BUFFER, 0);
+}
+
+void COpenGL3GPUCulling::endFrame(bool screenBound, const core::dimension2d<u32>& screenSize)
+{
+	PyramidValid = FrameToScreen && screenBound && !ScreenMultisampled &&
+		screenSize.Width && screenSize.Height;
+	FrameToScreen = false;
+	if (!PyramidValid)
+		return;
+
+	buildDepthPyramid(screenSize, FrameReverseDepth);
+	PyramidBuiltReverseDepth = FrameReverseDepth;
+	PyramidViewProjection = FrameViewProjection;
+}
+
+GLuint COpenGL3GPUCulling::compileProgram(const c8* source, const c8* name)
+{
+	GLuint shader = glCreateShader(GL.COMPUTE_SHADER);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		os::Printer::log("GPU culling shader failed to compile", name, ELL_ERROR);
+
+		GLint maxLength = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
+		if (maxLength)
+		{
+			GLchar *infoLog = new GLchar[maxLength];
+			glGetShaderInfoLog(shader, maxLength, NULL, infoLog);
+			os::Printer::log(reinterpret_cast<const c8*>(infoLog), ELL_ERROR);
+			delete [] infoLog;
+		}
+
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, shader);
+	glLinkProgram(program);
+	glDeleteShader(shader);
+
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		os::Printer::log("GPU culling shader failed to link", name, ELL_ERROR);
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+void COpenGL3GPUCulling::buildDepthPyramid(const core::dimension2d<u32>& screenSize, bool reverseDepth)
+{
+	COpenGL3CacheHandler* cacheHandler = Driver->getCacheHandler();
+
+	GLenum activeTexture = 0;
+	cacheHandler->getActiveTexture(activeTexture);
+	cacheHandler->setActiveTexture(GL_TEXTURE0 + CullTextureUnit);
+
+	if (screenSize != PyramidSize)
+	{
+		if (DepthTexture)
+			glDeleteTextures(1, &DepthTexture);
+		if (PyramidTexture)
+			glDeleteTextures(1, &PyramidTexture);
+
+		PyramidSize = screenSize;
+		PyramidLevels = 1;
+		while ((screenSize.Width | screenSize.Height) >> PyramidLevels)
+			++PyramidLevels;
+
+		glGenTextures(1, &PyramidTexture);
+		glBindTexture(GL_TEXTURE_2D, PyramidTexture);
+		GL.TexStorage2D(GL_TEXTURE_2D, PyramidLevels, GL.R32F, screenSize.Width, screenSize.Height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		// the unsized format takes the depth format of the screen, so copying needs no conversion
+		glGenTextures(1, &DepthTexture);
+		glBindTexture(GL_TEXTURE_2D, DepthTexture);
+		glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, 0, 0, screenSize.Width, screenSize.Height, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	}
+	else
+	{
+		glBindTexture(GL_TEXTURE_2D, DepthTexture);
+		glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, screenSize.Width, screenSize.Height);
+	}
+
+	cacheHandler->setProgram(PyramidProgram);
+	glUniform1i(PyramidReverseDepth, reverseDepth);
+
+	// level 0 is the copied depth, each further level the farthest depth of four texels of the one above
+	for (u32 level = 0; level < PyramidLevels; ++level)
+	{
+		const u32 width = core::max_(screenSize.Width >> level, 1u);
+		const u32 height = core::max_(screenSize.Height >> level, 1u);
+
+		glUniform1i(PyramidFromDepth, level == 0);
+		GL.BindImageTexture(0, PyramidTexture, level ? level - 1 : 0, GL_FALSE, 0, GL.READ_ONLY, GL.R32F);
+		GL.BindImageTexture(1, PyramidTexture, level, GL_FALSE, 0, GL.WRITE_ONLY, GL.R32F);
+		GL.DispatchCompute((width + PyramidGroupSize - 1) / PyramidGroupSize,
+			(height + PyramidGroupSize - 1) / PyramidGroupSize, 1);
+		GL.MemoryBarrier(GL.SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+	GL.MemoryBarrier(GL.TEXTURE_FETCH_BARRIER_BIT);
+
+	cacheHandler->setActiveTexture(activeTexture);
+}
+
+}
+}
@@ -0,0 +1,113 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#pragma once
+
+#include "Common.h"
+#include "irrArray.h"
+#include "matrix4.h"
+#include "dimension2d.h"
+
+namespace irr
+{
+namespace video
+{
+
+class COpenGL3DriverBase;
+
+//! Culls batches of static mesh buffers with a compute shader
+/** Each buffer of a batch is tested against the view frustum and against a
+depth pyramid built from the depth buffer of the previous frame. The result
+is one indirect draw command per buffer, with an instance count of 0 for
+culled buffers, so the whole batch is drawn by one glMultiDrawElementsIndirect
+call. Needs compute shaders and indirect draws, which are core since OpenGL 4.3.
+
+The pyramid is only built if batches were drawn to the screen, it is used for
+batches of the next frame. Buffers which become visible because the camera
+moved may therefore appear one frame late. Multisampled screens can't be copied
+to a texture, they are only culled against the frustum. */
+class COpenGL3GPUCulling
+{
+public:
+	//! Bounds and draw parameters of a buffer, laid out like the shader storage block
+	struct SDraw
+	{
+		f32 MinEdge[4];
+		f32 MaxEdge[4];
+		u32 IndexCount;
+		u32 FirstIndex;
+		s32 BaseVertex;
+		u32 Padding;
+	};
+
+	COpenGL3GPUCulling(COpenGL3DriverBase* driver);
+	~COpenGL3GPUCulling();
+
+	//! Compiles the compute shaders, GPU culling can't be used if this fails
+	bool init();
+
+	//! Returns storage for the draws of a batch, valid until the next call
+	SDraw* beginBatch(u32 count);
+
+	//! Culls the draws of the batch and binds the resulting commands as draw indirect buffer
+	/** Changes the program and the shader storage bindings.
+	\param world World transformation shared by all draws
+	\param viewProjection Projection times view transformation
+	\param toScreen True if the batch is drawn to the screen with a viewport covering it */
+	void cull(const core::matrix4& world, const core::matrix4& viewProjection, bool toScreen);
+
+	//! Unbinds the draw indirect buffer bound by cull()
+	void endBatch();
+
+	//! Builds the depth pyramid for the next frame from the depth buffer of the screen
+	/** Has to be called before the depth buffer is discarded at the end of a frame.
+	\param screenBound True if the screen is the current render target
+	\param screenSize Size of the screen */
+	void endFrame(bool screenBound, const core::dimension2d<u32>& screenSize);
+
+private:
+	GLuint compileProgram(const c8* source, const c8* name);
+
+	void buildDepthPyramid(const core::dimension2d<u32>& screenSize, bool reverseDepth);
+
+	COpenGL3DriverBase* Driver;
+
+	core::array<SDraw> Draws;
+
+	GLuint CullProgram;
+	GLint CullViewProjection;
+	GLint CullHiZViewProjection;
+	GLint CullCount;
+	GLint CullHiZLevels;
+	GLint CullDepthZeroToOne;
+	GLint CullReverseDepth;
+
+	GLuint PyramidProgram;
+	GLint PyramidFromDepth;
+	GLint PyramidReverseDepth;
+
+	GLuint DrawBuffer;
+	GLuint CommandBuffer;
+
+	//! Copy of the depth buffer and the pyramid of the farthest depths built from it
+	GLuint DepthTexture;
+	GLuint PyramidTexture;
+	core::dimension2d<u32> PyramidSize;
+	u32 PyramidLevels;
+	//! The depth buffer of the screen can't be copied if it is multisampled
+	bool ScreenMultisampled;
+	//! True if the pyramid holds the depth of the previous frame
+	bool PyramidValid;
+	//! The depth convention the pyramid was built with
+	bool PyramidBuiltReverseDepth;
+	//! View projection of the previous frame, which the pyramid was rendered with
+	core::matrix4 PyramidViewProjection;
+
+	//! Set by cull() if a batch of the current frame was drawn to the screen
+	bool FrameToScreen;
+	bool FrameReverseDepth;
+	core::matrix4 FrameViewProjection;
+};
+
+}
+}
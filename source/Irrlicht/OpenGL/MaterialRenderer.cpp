@@ -15,11 +15,55 @@
 #include "COpenGLCoreTexture.h"
 #include "COpenGLCoreCacheHandler.h"
 
+#include "mt_opengl.h"
+
 namespace irr
 {
 namespace video
 {
 
+// FNV-1a, the uniform names are short so this is cheaper than comparing them one by one
+static u32 hashUniformName(const c8* name)
+{
+	u32 hash = 2166136261u;
+	for (; *name; ++name)
+		hash = (hash ^ (u8)*name) * 16777619u;
+	return hash;
+}
+
+//! Number of values in a uniform of a type, 0 for types without a value shadow
+static u32 getUniformComponents(GLenum type)
+{
+	switch (type)
+	{
+		case GL_FLOAT:
+		case GL_INT:
+		case GL_BOOL:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_CUBE:
+			return 1;
+		case GL_FLOAT_VEC2:
+		case GL_INT_VEC2:
+		case GL_BOOL_VEC2:
+			return 2;
+		case GL_FLOAT_VEC3:
+		case GL_INT_VEC3:
+		case GL_BOOL_VEC3:
+			return 3;
+		case GL_FLOAT_VEC4:
+		case GL_INT_VEC4:
+		case GL_BOOL_VEC4:
+		case GL_FLOAT_MAT2:
+			return 4;
+		case GL_FLOAT_MAT3:
+			return 9;
+		case GL_FLOAT_MAT4:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
 
 COpenGL3MaterialRenderer::COpenGL3MaterialRenderer(COpenGL3DriverBase* driver,
 		s32& outMaterialTypeNr,
@@ -27,13 +71,19 @@ COpenGL3MaterialRenderer::COpenGL3MaterialRenderer(COpenGL3DriverBase* driver,
 		const c8* pixelShaderProgram,
 		IShaderConstantSetCallBack* callback,
 		E_MATERIAL_TYPE baseMaterial,
-		s32 userData)
-	: Driver(driver), CallBack(callback), Alpha(false), Blending(false), FixedBlending(false), Program(0), UserData(userData)
+		s32 userData,
+		bool asyncLink,
+		bool addMaterial)
+	: Driver(driver), CallBack(callback), Alpha(false), Blending(false), FixedBlending(false),
+	BaseMaterial(baseMaterial), Linking(false), LinkFailed(false), ActivePlaceholder(0), Program(0), UserData(userData)
 {
 #ifdef _DEBUG
 	setDebugName("MaterialRenderer");
 #endif
 
+	for (u32 i = 0; i < EUB_COUNT; ++i)
+		UsesBuiltInUniformBlock[i] = false;
+
 	switch (baseMaterial)
 	{
 	case EMT_TRANSPARENT_VERTEX_ALPHA:
@@ -53,15 +103,19 @@ COpenGL3MaterialRenderer::COpenGL3MaterialRenderer(COpenGL3DriverBase* driver,
 	if (CallBack)
 		CallBack->grab();
 
-	init(outMaterialTypeNr, vertexShaderProgram, pixelShaderProgram);
+	init(outMaterialTypeNr, vertexShaderProgram, pixelShaderProgram, addMaterial, asyncLink);
 }
 
 
 COpenGL3MaterialRenderer::COpenGL3MaterialRenderer(COpenGL3DriverBase* driver,
 					IShaderConstantSetCallBack* callback,
 					E_MATERIAL_TYPE baseMaterial, s32 userData)
-: Driver(driver), CallBack(callback), Alpha(false), Blending(false), FixedBlending(false), Program(0), UserData(userData)
+: Driver(driver), CallBack(callback), Alpha(false), Blending(false), FixedBlending(false),
+	BaseMaterial(baseMaterial), Linking(false), LinkFailed(false), ActivePlaceholder(0), Program(0), UserData(userData)
 {
+	for (u32 i = 0; i < EUB_COUNT; ++i)
+		UsesBuiltInUniformBlock[i] = false;
+
 	switch (baseMaterial)
 	{
 	case EMT_TRANSPARENT_VERTEX_ALPHA:
@@ -101,7 +155,15 @@ COpenGL3MaterialRenderer::~COpenGL3MaterialRenderer()
 		Program = 0;
 	}
 
+	for (u32 i = 0; i < UniformBlockInfo.size(); ++i)
+	{
+		if (UniformBlockInfo[i].buffer)
+			glDeleteBuffers(1, &UniformBlockInfo[i].buffer);
+	}
+
 	UniformInfo.clear();
+	UniformLookup.clear();
+	UniformBlockInfo.clear();
 }
 
 GLuint COpenGL3MaterialRenderer::getProgram() const
@@ -109,10 +171,41 @@ GLuint COpenGL3MaterialRenderer::getProgram() const
 	return Program;
 }
 
+bool COpenGL3MaterialRenderer::isLinking() const
+{
+	return Linking;
+}
+
+bool COpenGL3MaterialRenderer::pollLink()
+{
+	if (Linking)
+	{
+		if (Driver->isParallelShaderCompileSupported())
+		{
+			GLint completed = GL_FALSE;
+			glGetProgramiv(Program, GL.COMPLETION_STATUS, &completed);
+			if (!completed)
+				return false;
+		}
+
+		Linking = false;
+		LinkFailed = !checkLinkStatus();
+
+		if (!LinkFailed)
+			Driver->saveProgramBinary(Program, PendingVertexShader.c_str(), PendingPixelShader.c_str());
+
+		PendingVertexShader = "";
+		PendingPixelShader = "";
+	}
+
+	return !LinkFailed;
+}
+
 void COpenGL3MaterialRenderer::init(s32& outMaterialTypeNr,
 		const c8* vertexShaderProgram,
 		const c8* pixelShaderProgram,
-		bool addMaterial)
+		bool addMaterial,
+		bool asyncLink)
 {
 	outMaterialTypeNr = -1;
 
@@ -121,27 +214,78 @@ void COpenGL3MaterialRenderer::init(s32& outMaterialTypeNr,
 	if (!Program)
 		return;
 
-	if (vertexShaderProgram)
-		if (!createShader(GL_VERTEX_SHADER, vertexShaderProgram))
+	if (Driver->loadProgramBinary(Program, vertexShaderProgram, pixelShaderProgram))
+	{
+		if (!initUniforms())
 			return;
+	}
+	else
+	{
+		// compile errors of async programs show up in the link log
+		if (vertexShaderProgram)
+			if (!createShader(GL_VERTEX_SHADER, vertexShaderProgram, !asyncLink))
+				return;
 
-	if (pixelShaderProgram)
-		if (!createShader(GL_FRAGMENT_SHADER, pixelShaderProgram))
-			return;
+		if (pixelShaderProgram)
+			if (!createShader(GL_FRAGMENT_SHADER, pixelShaderProgram, !asyncLink))
+				return;
 
-	for ( size_t i = 0; i < EVA_COUNT; ++i )
-			glBindAttribLocation( Program, i, sBuiltInVertexAttributeNames[i]);
+		for ( size_t i = 0; i < EVA_COUNT; ++i )
+				glBindAttribLocation( Program, i, sBuiltInVertexAttributeNames[i]);
 
-	if (!linkProgram())
-		return;
+		// a program reads either the joints or the morph target, never both
+		glBindAttribLocation(Program, EMA_POSITION, sBuiltInMorphAttributeNames[0]);
+		glBindAttribLocation(Program, EMA_NORMAL, sBuiltInMorphAttributeNames[1]);
+
+		if (Driver->queryFeature(EVDF_INSTANCING))
+		{
+			glBindAttribLocation(Program, EIA_TRANSFORM, sBuiltInInstanceAttributeNames[0]);
+			glBindAttribLocation(Program, EIA_COLOR, sBuiltInInstanceAttributeNames[1]);
+			glBindAttribLocation(Program, EIA_PARAMS, sBuiltInInstanceAttributeNames[2]);
+		}
+
+		if (asyncLink)
+		{
+			// the status is only queried once needed, so the driver can link meanwhile
+			glLinkProgram(Program);
+			Linking = true;
+			PendingVertexShader = vertexShaderProgram;
+			PendingPixelShader = pixelShaderProgram;
+		}
+		else
+		{
+			if (!linkProgram())
+				return;
+
+			Driver->saveProgramBinary(Program, vertexShaderProgram, pixelShaderProgram);
+		}
+	}
 
 	if (addMaterial)
 		outMaterialTypeNr = Driver->addMaterialRenderer(this);
+	else
+		outMaterialTypeNr = 0;
 }
 
 
 bool COpenGL3MaterialRenderer::OnRender(IMaterialRendererServices* service, E_VERTEX_TYPE vtxtype)
 {
+	if (ActivePlaceholder)
+		return ActivePlaceholder->OnRender(service, vtxtype);
+
+	for (u32 i = 0; i < EUB_COUNT; ++i)
+	{
+		if (UsesBuiltInUniformBlock[i])
+			Driver->updateBuiltInUniformBlock((E_BUILT_IN_UNIFORM_BLOCK)i);
+	}
+
+	// binding points are shared by all programs, so restore ours
+	for (u32 i = 0; i < UniformBlockInfo.size(); ++i)
+	{
+		if (UniformBlockInfo[i].buffer)
+			GL.BindBufferBase(GL.UNIFORM_BUFFER, UniformBlockInfo[i].binding, UniformBlockInfo[i].buffer);
+	}
+
 	if (CallBack && Program)
 		CallBack->OnSetConstants(this, UserData);
 
@@ -154,6 +298,18 @@ void COpenGL3MaterialRenderer::OnSetMaterial(const video::SMaterial& material,
 				bool resetAllRenderstates,
 				video::IMaterialRendererServices* services)
 {
+	ActivePlaceholder = 0;
+	if (Linking || LinkFailed)
+	{
+		IMaterialRenderer* base = Driver->getMaterialRenderer(BaseMaterial);
+		if (!pollLink() && base && base != this)
+		{
+			ActivePlaceholder = base;
+			base->OnSetMaterial(material, lastMaterial, resetAllRenderstates, services);
+			return;
+		}
+	}
+
 	COpenGL3CacheHandler* cacheHandler = Driver->getCacheHandler();
 
 	cacheHandler->setProgram(Program);
@@ -162,8 +318,19 @@ void COpenGL3MaterialRenderer::OnSetMaterial(const video::SMaterial& material,
 
 	if (Alpha)
 	{
-		cacheHandler->setBlend(true);
-		cacheHandler->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		if (Driver->isAccumulatingTransparency())
+		{
+			// weighted colors and weights add up, the alpha of the first buffer multiplies the visibility
+			cacheHandler->setBlend(true);
+			cacheHandler->setBlendEquation(GL_FUNC_ADD);
+			cacheHandler->setBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+		}
+		// the coverage of the samples replaces blending in the solid pass
+		else if (!Driver->usesAlphaToCoverage(material))
+		{
+			cacheHandler->setBlend(true);
+			cacheHandler->setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
 	}
 	else if (FixedBlending)
 	{
@@ -190,6 +357,11 @@ void COpenGL3MaterialRenderer::OnSetMaterial(const video::SMaterial& material,
 
 void COpenGL3MaterialRenderer::OnUnsetMaterial()
 {
+	if (ActivePlaceholder)
+	{
+		ActivePlaceholder->OnUnsetMaterial();
+		ActivePlaceholder = 0;
+	}
 }
 
 
@@ -205,7 +377,7 @@ s32 COpenGL3MaterialRenderer::getRenderCapability() const
 }
 
 
-bool COpenGL3MaterialRenderer::createShader(GLenum shaderType, const char* shader)
+bool COpenGL3MaterialRenderer::createShader(GLenum shaderType, const char* shader, bool checkStatus)
 {
 	if (Program)
 	{
@@ -213,9 +385,10 @@ bool COpenGL3MaterialRenderer::createShader(GLenum shaderType, const char* shade
 		glShaderSource(shaderHandle, 1, &shader, NULL);
 		glCompileShader(shaderHandle);
 
-		GLint status = 0;
+		GLint status = GL_TRUE;
 
-		glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &status);
+		if (checkStatus)
+			glGetShaderiv(shaderHandle, GL_COMPILE_STATUS, &status);
 
 		if (status != GL_TRUE)
 		{
@@ -251,6 +424,17 @@ bool COpenGL3MaterialRenderer::linkProgram()
 	{
 		glLinkProgram(Program);
 
+		return checkLinkStatus();
+	}
+
+	return true;
+}
+
+
+bool COpenGL3MaterialRenderer::checkLinkStatus()
+{
+	if (Program)
+	{
 		GLint status = 0;
 
 		glGetProgramiv(Program, GL_LINK_STATUS, &status);
@@ -275,6 +459,19 @@ bool COpenGL3MaterialRenderer::linkProgram()
 			return false;
 		}
 
+		return initUniforms();
+	}
+
+	return true;
+}
+
+
+bool COpenGL3MaterialRenderer::initUniforms()
+{
+	if (Program)
+	{
+		initUniformBlocks();
+
 		GLint num = 0;
 
 		glGetProgramiv(Program, GL_ACTIVE_UNIFORMS, &num);
@@ -298,6 +495,7 @@ bool COpenGL3MaterialRenderer::linkProgram()
 
 		UniformInfo.clear();
 		UniformInfo.reallocate(num);
+		UniformLookup.clear();
 
 		for (GLint i=0; i < num; ++i)
 		{
@@ -320,7 +518,12 @@ bool COpenGL3MaterialRenderer::linkProgram()
 
 			ui.name = name;
 			ui.location = glGetUniformLocation(Program, buf);
+			ui.value.set_used(size * getUniformComponents(ui.type) * 4);
+			ui.valueBytes = 0;
+			ui.valueInteger = false;
 
+			// on a hash collision the first uniform wins, the others are found by the slow path
+			UniformLookup.emplace(hashUniformName(name.c_str()), (s32)UniformInfo.size());
 			UniformInfo.push_back(ui);
 		}
 
@@ -331,6 +534,65 @@ bool COpenGL3MaterialRenderer::linkProgram()
 }
 
 
+void COpenGL3MaterialRenderer::initUniformBlocks()
+{
+	UniformBlockInfo.clear();
+
+	for (u32 i = 0; i < EUB_COUNT; ++i)
+		UsesBuiltInUniformBlock[i] = false;
+
+	if (!Driver->queryFeature(EVDF_UNIFORM_BLOCKS))
+		return;
+
+	GLint num = 0;
+	glGetProgramiv(Program, GL.ACTIVE_UNIFORM_BLOCKS, &num);
+
+	if (num == 0)
+		return;
+
+	GLint maxBindings = 0;
+	glGetIntegerv(GL.MAX_UNIFORM_BUFFER_BINDINGS, &maxBindings);
+
+	GLuint nextBinding = EUB_COUNT;
+
+	for (GLint i = 0; i < num; ++i)
+	{
+		c8 buf[256];
+		GL.GetActiveUniformBlockName(Program, i, sizeof(buf), 0, reinterpret_cast<GLchar*>(buf));
+
+		SUniformBlockInfo info;
+		info.name = buf;
+		info.index = i;
+		info.buffer = 0;
+		GL.GetActiveUniformBlockiv(Program, i, GL.UNIFORM_BLOCK_DATA_SIZE, &info.size);
+
+		info.binding = nextBinding;
+		for (u32 j = 0; j < EUB_COUNT; ++j)
+		{
+			if (info.name == sBuiltInUniformBlockNames[j])
+			{
+				info.binding = j;
+				UsesBuiltInUniformBlock[j] = true;
+				break;
+			}
+		}
+
+		if (info.binding == nextBinding)
+		{
+			if ((GLint)nextBinding >= maxBindings)
+			{
+				os::Printer::log("GLSL: too many uniform blocks", info.name.c_str(), ELL_ERROR);
+				continue;
+			}
+			++nextBinding;
+		}
+
+		GL.UniformBlockBinding(Program, info.index, info.binding);
+		UniformBlockInfo.push_back(info);
+	}
+}
+
+
 void COpenGL3MaterialRenderer::setBasicRenderStates(const SMaterial& material,
 						const SMaterial& lastMaterial,
 						bool resetAllRenderstates)
@@ -345,6 +607,13 @@ s32 COpenGL3MaterialRenderer::getVertexShaderConstantID(const c8* name)
 
 s32 COpenGL3MaterialRenderer::getPixelShaderConstantID(const c8* name)
 {
+	const auto it = UniformLookup.find(hashUniformName(name));
+	if (it == UniformLookup.end())
+		return -1;
+
+	if (UniformInfo[it->second].name == name)
+		return it->second;
+
 	for (u32 i = 0; i < UniformInfo.size(); ++i)
 	{
 		if (UniformInfo[i].name == name)
@@ -354,6 +623,51 @@ s32 COpenGL3MaterialRenderer::getPixelShaderConstantID(const c8* name)
 	return -1;
 }
 
+s32 COpenGL3MaterialRenderer::getUniformBlockID(const c8* name)
+{
+	for (u32 i = 0; i < UniformBlockInfo.size(); ++i)
+	{
+		if (UniformBlockInfo[i].name == name)
+			return i;
+	}
+
+	return -1;
+}
+
+bool COpenGL3MaterialRenderer::setUniformBlock(s32 index, const void* data, u32 size)
+{
+	if (index < 0 || index >= (s32)UniformBlockInfo.size())
+		return false;
+
+	SUniformBlockInfo& info = UniformBlockInfo[index];
+
+	if (info.binding < EUB_COUNT)
+	{
+		os::Printer::log("Built-in uniform blocks are set by the driver", info.name.c_str(), ELL_WARNING);
+		return false;
+	}
+
+	if (size > (u32)info.size)
+		return false;
+
+	if (!info.buffer)
+		glGenBuffers(1, &info.buffer);
+
+	glBindBuffer(GL.UNIFORM_BUFFER, info.buffer);
+	// orphan the storage, the previous contents may still be in use by the GPU
+	glBufferData(GL.UNIFORM_BUFFER, info.size, 0, GL_STREAM_DRAW);
+	glBufferSubData(GL.UNIFORM_BUFFER, 0, size, data);
+	glBindBuffer(GL.UNIFORM_BUFFER, 0);
+
+	SFrameStats& stats = Driver->getFrameStatsCounters();
+	stats.BufferBytesUploaded += size;
+	++stats.BufferReallocations;
+
+	GL.BindBufferBase(GL.UNIFORM_BUFFER, info.binding, info.buffer);
+
+	return true;
+}
+
 void COpenGL3MaterialRenderer::setVertexShaderConstant(const f32* data, s32 startRegister, s32 constantAmount)
 {
 	os::Printer::log("Cannot set constant, please use high level shader call instead.", ELL_WARNING);
@@ -379,14 +693,33 @@ bool COpenGL3MaterialRenderer::setVertexShaderConstant(s32 index, const u32* int
 	return setPixelShaderConstant(index, ints, count);
 }
 
+bool COpenGL3MaterialRenderer::updateUniformValue(SUniformInfo& info, const void* data, u32 bytes, bool integer)
+{
+	if (!bytes || bytes > info.value.size())
+		return true;
+
+	if (info.valueBytes == bytes && info.valueInteger == integer && !memcmp(info.value.const_pointer(), data, bytes))
+		return false;
+
+	memcpy(info.value.pointer(), data, bytes);
+	info.valueBytes = bytes;
+	info.valueInteger = integer;
+	return true;
+}
+
 bool COpenGL3MaterialRenderer::setPixelShaderConstant(s32 index, const f32* floats, int count)
 {
 	if(index < 0 || UniformInfo[index].location < 0)
 		return false;
 
+	const GLenum type = UniformInfo[index].type;
+	if (type != GL_SAMPLER_2D && type != GL_SAMPLER_CUBE &&
+		!updateUniformValue(UniformInfo[index], floats, count * sizeof(f32), false))
+		return true;
+
 	bool status = true;
 
-	switch (UniformInfo[index].type)
+	switch (type)
 	{
 		case GL_FLOAT:
 			glUniform1fv(UniformInfo[index].location, count, floats);
@@ -415,7 +748,8 @@ bool COpenGL3MaterialRenderer::setPixelShaderConstant(s32 index, const f32* floa
 				if(floats)
 				{
 					const GLint id = (GLint)(*floats);
-					glUniform1iv(UniformInfo[index].location, 1, &id);
+					if (updateUniformValue(UniformInfo[index], &id, sizeof(id), true))
+						glUniform1iv(UniformInfo[index].location, 1, &id);
 				}
 				else
 					status = false;
@@ -434,6 +768,11 @@ bool COpenGL3MaterialRenderer::setPixelShaderConstant(s32 index, const s32* ints
 	if(index < 0 || UniformInfo[index].location < 0)
 		return false;
 
+	const GLenum type = UniformInfo[index].type;
+	const int values = (type == GL_SAMPLER_2D || type == GL_SAMPLER_CUBE) ? 1 : count;
+	if (!updateUniformValue(UniformInfo[index], ints, values * sizeof(s32), true))
+		return true;
+
 	bool status = true;
 
 	switch (UniformInfo[index].type)
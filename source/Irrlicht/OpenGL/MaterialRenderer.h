@@ -11,6 +11,8 @@
 #include "irrArray.h"
 #include "irrString.h"
 
+#include <unordered_map>
+
 #include "Common.h"
 
 namespace irr
@@ -31,12 +33,21 @@ public:
 		const c8* pixelShaderProgram = 0,
 		IShaderConstantSetCallBack* callback = 0,
 		E_MATERIAL_TYPE baseMaterial = EMT_SOLID,
-		s32 userData = 0);
+		s32 userData = 0,
+		bool asyncLink = false,
+		bool addMaterial = true);
 
 	virtual ~COpenGL3MaterialRenderer();
 
 	GLuint getProgram() const;
 
+	//! True while a program created with asyncLink is not finished yet
+	bool isLinking() const;
+
+	//! Finishes linking if the program is ready, blocks if the driver can't tell
+	/** \return True if the program can be used. */
+	bool pollLink();
+
 	virtual void OnSetMaterial(const SMaterial& material, const SMaterial& lastMaterial,
 		bool resetAllRenderstates, IMaterialRendererServices* services);
 
@@ -52,6 +63,8 @@ public:
 
 	s32 getVertexShaderConstantID(const c8* name) override;
 	s32 getPixelShaderConstantID(const c8* name) override;
+	s32 getUniformBlockID(const c8* name) override;
+	bool setUniformBlock(s32 index, const void* data, u32 size) override;
 	void setVertexShaderConstant(const f32* data, s32 startRegister, s32 constantAmount=1) override;
 	void setPixelShaderConstant(const f32* data, s32 startRegister, s32 constantAmount=1) override;
 	bool setVertexShaderConstant(s32 index, const f32* floats, int count) override;
@@ -70,10 +83,23 @@ protected:
 					E_MATERIAL_TYPE baseMaterial = EMT_SOLID,
 					s32 userData = 0);
 
-	void init(s32& outMaterialTypeNr, const c8* vertexShaderProgram, const c8* pixelShaderProgram, bool addMaterial = true);
+	//! Compiles and links the program
+	/** Without addMaterial the renderer is not registered with the driver and
+	outMaterialTypeNr is 0 on success. */
+	void init(s32& outMaterialTypeNr, const c8* vertexShaderProgram, const c8* pixelShaderProgram,
+		bool addMaterial = true, bool asyncLink = false);
 
-	bool createShader(GLenum shaderType, const char* shader);
+	bool createShader(GLenum shaderType, const char* shader, bool checkStatus = true);
 	bool linkProgram();
+	bool checkLinkStatus();
+	bool initUniforms();
+	void initUniformBlocks();
+
+	struct SUniformInfo;
+
+	//! Remembers the value of a uniform, false if it had the value already
+	/** Values larger than the uniform are not remembered. */
+	static bool updateUniformValue(SUniformInfo& info, const void* data, u32 bytes, bool integer);
 
 	COpenGL3DriverBase* Driver;
 	IShaderConstantSetCallBack* CallBack;
@@ -82,15 +108,43 @@ protected:
 	bool Blending;
 	bool FixedBlending;
 
+	//! Drawn with while the program is linking
+	E_MATERIAL_TYPE BaseMaterial;
+	bool Linking;
+	bool LinkFailed;
+	//! Set if OnSetMaterial passed on to the base material
+	IMaterialRenderer* ActivePlaceholder;
+	//! Sources of a linking program, needed for the shader cache
+	core::stringc PendingVertexShader;
+	core::stringc PendingPixelShader;
+
 	struct SUniformInfo
 	{
 		core::stringc name;
 		GLenum type;
 		GLint location;
+		//! Value last sent, the program keeps it while other programs are used
+		core::array<u8> value;
+		u32 valueBytes;
+		bool valueInteger;
+	};
+
+	struct SUniformBlockInfo
+	{
+		core::stringc name;
+		GLuint index;
+		GLuint binding;
+		GLint size;
+		//! Buffer holding the contents set by the callback, 0 for built-in blocks
+		GLuint buffer;
 	};
 
 	GLuint Program;
 	core::array<SUniformInfo> UniformInfo;
+	//! Maps the hash of a uniform name to its index in UniformInfo
+	std::unordered_map<u32, s32> UniformLookup;
+	core::array<SUniformBlockInfo> UniformBlockInfo;
+	bool UsesBuiltInUniformBlock[EUB_COUNT];
 	s32 UserData;
 };
 
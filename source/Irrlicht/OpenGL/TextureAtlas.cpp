@@ -0,0 +1,218 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#include "TextureAtlas.h"
+
+#include "Driver.h"
+
+#include "COpenGLCoreTexture.h"
+#include "COpenGLCoreCacheHandler.h"
+
+#include "mt_opengl.h"
+
+namespace irr
+{
+namespace video
+{
+
+COpenGL3TextureAtlas::COpenGL3TextureAtlas(COpenGL3DriverBase* driver) : Driver(driver)
+{
+}
+
+COpenGL3TextureAtlas::~COpenGL3TextureAtlas()
+{
+	clear();
+}
+
+bool COpenGL3TextureAtlas::add(const COpenGL3Texture* texture, IImage* image)
+{
+	if (!texture || !image || texture->getType() != ETT_2D)
+		return false;
+
+	const core::dimension2d<u32>& size = image->getDimension();
+	if (size.Width == 0 || size.Height == 0 || size.Width > MaxTextureSize || size.Height > MaxTextureSize)
+		return false;
+
+	// formats IImage::copyTo can convert
+	switch (image->getColorFormat())
+	{
+	case ECF_A1R5G5B5:
+	case ECF_R5G6B5:
+	case ECF_R8G8B8:
+	case ECF_A8R8G8B8:
+		break;
+	default:
+		return false;
+	}
+
+	GLint internalFormat = GL_RGBA;
+	GLenum pixelFormat = GL_RGBA;
+	GLenum pixelType = GL_UNSIGNED_BYTE;
+	void (*converter)(const void*, s32, void*) = 0;
+	if (!Driver->getColorFormatParameters(ECF_A8R8G8B8, internalFormat, pixelFormat, pixelType, &converter))
+		return false;
+
+	const core::dimension2d<u32> borderSize(size.Width + 2, size.Height + 2);
+
+	u32 pageIndex = 0;
+	core::position2d<s32> pos;
+	while (pageIndex < Pages.size() && !allocate(Pages[pageIndex], borderSize.Width, borderSize.Height, pos))
+		++pageIndex;
+
+	if (pageIndex == Pages.size())
+	{
+		if (Pages.size() >= MaxPages)
+			return false;
+
+		SPage page;
+		page.Texture = new COpenGL3Texture("<texture atlas>", core::dimension2d<u32>(PageSize, PageSize), ETT_2D, ECF_A8R8G8B8, Driver);
+		page.Used = 0;
+		page.EntryCount = 0;
+		Pages.push_back(page);
+
+		allocate(Pages.back(), borderSize.Width, borderSize.Height, pos);
+	}
+
+	// Repeat the edge pixels around the copy, so filtering doesn't blend in its neighbours.
+	const s32 w = size.Width;
+	const s32 h = size.Height;
+	IImage* copy = Driver->createImage(ECF_A8R8G8B8, borderSize);
+	image->copyTo(copy, core::position2d<s32>(1, 1));
+	image->copyTo(copy, core::position2d<s32>(0, 1), core::rect<s32>(0, 0, 1, h));
+	image->copyTo(copy, core::position2d<s32>(w + 1, 1), core::rect<s32>(w - 1, 0, w, h));
+	copy->copyTo(copy, core::position2d<s32>(0, 0), core::rect<s32>(0, 1, w + 2, 2));
+	copy->copyTo(copy, core::position2d<s32>(0, h + 1), core::rect<s32>(0, h, w + 2, h + 1));
+
+	const void* data = copy->getData();
+	u8* convertedData = 0;
+	if (converter)
+	{
+		convertedData = new u8[copy->getImageDataSizeInBytes()];
+		converter(data, borderSize.getArea(), convertedData);
+		data = convertedData;
+	}
+
+	SPage& page = Pages[pageIndex];
+
+	if (Driver->getFeature().DirectStateAccess)
+	{
+		GL.TextureSubImage2D(page.Texture->getOpenGLTextureName(), 0, pos.X, pos.Y, borderSize.Width, borderSize.Height,
+			pixelFormat, pixelType, data);
+	}
+	else
+	{
+		const COpenGL3Texture* prevTexture = Driver->getCacheHandler()->getTextureCache().get(0);
+		Driver->getCacheHandler()->getTextureCache().set(0, page.Texture);
+
+		glTexSubImage2D(GL_TEXTURE_2D, 0, pos.X, pos.Y, borderSize.Width, borderSize.Height, pixelFormat, pixelType, data);
+
+		Driver->getCacheHandler()->getTextureCache().set(0, prevTexture);
+	}
+
+	delete[] convertedData;
+	copy->drop();
+
+	SEntry entry;
+	entry.Page = pageIndex;
+	entry.Origin = core::position2d<s32>(pos.X + 1, pos.Y + 1);
+	entry.Size = size;
+	entry.Revision = texture->getDataRevision();
+	Entries[texture] = entry;
+	++page.EntryCount;
+
+	Driver->testGLError(__LINE__);
+
+	return true;
+}
+
+void COpenGL3TextureAtlas::remove(const ITexture* texture)
+{
+	auto it = Entries.find(texture);
+	if (it == Entries.end())
+		return;
+
+	SPage& page = Pages[it->second.Page];
+	Entries.erase(it);
+
+	// the pixels are left in place, they are overwritten once the page is refilled
+	if (--page.EntryCount == 0)
+	{
+		page.Shelves.clear();
+		page.Used = 0;
+	}
+}
+
+void COpenGL3TextureAtlas::clear()
+{
+	for (auto &page : Pages)
+		page.Texture->drop();
+
+	Pages.clear();
+	Entries.clear();
+}
+
+const COpenGL3Texture* COpenGL3TextureAtlas::find(const ITexture* texture, const core::rect<s32>& sourceRect, core::position2d<s32>& origin)
+{
+	if (Entries.empty())
+		return 0;
+
+	auto it = Entries.find(texture);
+	if (it == Entries.end())
+		return 0;
+
+	const SEntry& entry = it->second;
+
+	// the copy is outdated
+	if (static_cast<const COpenGL3Texture*>(texture)->getDataRevision() != entry.Revision)
+	{
+		remove(texture);
+		return 0;
+	}
+
+	// repeated or out of bounds texture coordinates need the texture of their own
+	const s32 w = entry.Size.Width;
+	const s32 h = entry.Size.Height;
+	if (sourceRect.UpperLeftCorner.X < 0 || sourceRect.UpperLeftCorner.X > w ||
+			sourceRect.LowerRightCorner.X < 0 || sourceRect.LowerRightCorner.X > w ||
+			sourceRect.UpperLeftCorner.Y < 0 || sourceRect.UpperLeftCorner.Y > h ||
+			sourceRect.LowerRightCorner.Y < 0 || sourceRect.LowerRightCorner.Y > h)
+		return 0;
+
+	origin = entry.Origin;
+	return Pages[entry.Page].Texture;
+}
+
+bool COpenGL3TextureAtlas::allocate(SPage& page, u32 width, u32 height, core::position2d<s32>& pos)
+{
+	// lowest shelf with enough room
+	SShelf* best = 0;
+	for (auto &shelf : page.Shelves)
+	{
+		if (height <= shelf.Height && shelf.Used + width <= PageSize && (!best || shelf.Height < best->Height))
+			best = &shelf;
+	}
+
+	if (!best)
+	{
+		if (page.Used + height > PageSize)
+			return false;
+
+		SShelf shelf;
+		shelf.Y = page.Used;
+		shelf.Height = height;
+		shelf.Used = 0;
+		page.Shelves.push_back(shelf);
+		page.Used += height;
+
+		best = &page.Shelves.back();
+	}
+
+	pos.X = best->Used;
+	pos.Y = best->Y;
+	best->Used += width;
+
+	return true;
+}
+
+}
+}
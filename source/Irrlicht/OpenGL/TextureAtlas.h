@@ -0,0 +1,87 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#pragma once
+
+#include "Common.h"
+#include "IImage.h"
+#include "ITexture.h"
+#include <unordered_map>
+#include <vector>
+
+namespace irr
+{
+namespace video
+{
+
+//! Packs small 2D textures into shared pages, so 2D draws of different textures can be batched.
+/** Textures keep their own OpenGL texture, the atlas only holds a copy of
+their first mip level. Pages are filled with horizontal shelves, the space
+of removed textures is only reused once a page becomes empty. */
+class COpenGL3TextureAtlas
+{
+public:
+	COpenGL3TextureAtlas(COpenGL3DriverBase* driver);
+	~COpenGL3TextureAtlas();
+
+	//! Size of a page in pixels
+	static constexpr u32 PageSize = 2048;
+
+	//! Textures larger than this in any dimension are never added
+	static constexpr u32 MaxTextureSize = PageSize / 4;
+
+	//! Pages are never created beyond this count
+	static constexpr u32 MaxPages = 4;
+
+	//! Copies the image of a texture into a page
+	/** \return False if the texture isn't suitable or there is no space left. */
+	bool add(const COpenGL3Texture* texture, IImage* image);
+
+	//! Removes a texture from its page
+	void remove(const ITexture* texture);
+
+	//! Removes all textures and deletes the pages
+	void clear();
+
+	//! Returns the page a texture is drawn from, if it was added and sourceRect lies within it.
+	/** \param origin Receives the position of the texture inside the page.
+	Textures changed through lock() since they were added are removed here. */
+	const COpenGL3Texture* find(const ITexture* texture, const core::rect<s32>& sourceRect, core::position2d<s32>& origin);
+
+private:
+	struct SShelf
+	{
+		u32 Y;
+		u32 Height;
+		//! Width already used
+		u32 Used;
+	};
+
+	struct SPage
+	{
+		COpenGL3Texture* Texture;
+		std::vector<SShelf> Shelves;
+		//! Height used by all shelves
+		u32 Used;
+		u32 EntryCount;
+	};
+
+	struct SEntry
+	{
+		u32 Page;
+		core::position2d<s32> Origin;
+		core::dimension2d<u32> Size;
+		u32 Revision;
+	};
+
+	//! Finds space for a rectangle of the given size, including its one pixel border
+	bool allocate(SPage& page, u32 width, u32 height, core::position2d<s32>& pos);
+
+	COpenGL3DriverBase* Driver;
+
+	std::vector<SPage> Pages;
+	std::unordered_map<const ITexture*, SEntry> Entries;
+};
+
+}
+}
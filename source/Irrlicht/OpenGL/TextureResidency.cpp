@@ -0,0 +1,124 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#include "TextureResidency.h"
+
+#include "Driver.h"
+
+#include "COpenGLCoreTexture.h"
+#include "COpenGLCoreCacheHandler.h"
+#include <algorithm>
+
+namespace irr
+{
+namespace video
+{
+
+COpenGL3TextureResidency::COpenGL3TextureResidency(COpenGL3DriverBase* driver) : Driver(driver), RemovedEvictions(0)
+{
+}
+
+void COpenGL3TextureResidency::add(COpenGL3Texture* texture)
+{
+	Textures.push_back(texture);
+}
+
+void COpenGL3TextureResidency::remove(const ITexture* texture)
+{
+	auto it = std::find(Textures.begin(), Textures.end(), texture);
+	if (it == Textures.end())
+		return;
+
+	if (!(*it)->isResident())
+		++RemovedEvictions;
+
+	*it = Textures.back();
+	Textures.pop_back();
+}
+
+void COpenGL3TextureResidency::clear()
+{
+	for (auto texture : Textures)
+	{
+		if (!texture->isResident())
+			++RemovedEvictions;
+	}
+
+	Textures.clear();
+}
+
+void COpenGL3TextureResidency::setBudget(u64 bytes)
+{
+	Stats.Budget = bytes;
+}
+
+void COpenGL3TextureResidency::update()
+{
+	if (!Stats.Budget)
+		return;
+
+	u64 residentBytes = 0;
+	for (auto texture : Textures)
+	{
+		if (texture->isResident())
+			residentBytes += texture->getMemorySize();
+	}
+
+	if (residentBytes <= Stats.Budget)
+		return;
+
+	const u32 frame = Driver->getFrameCount();
+
+	std::vector<COpenGL3Texture*> candidates;
+	for (auto texture : Textures)
+	{
+		if (texture->isEvictable() && texture->getLastUseFrame() != frame)
+			candidates.push_back(texture);
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const COpenGL3Texture* a, const COpenGL3Texture* b) {
+		return a->getLastUseFrame() < b->getLastUseFrame();
+	});
+
+	for (auto texture : candidates)
+	{
+		if (residentBytes <= Stats.Budget)
+			break;
+
+		const u32 size = texture->getMemorySize();
+		if (texture->evict())
+		{
+			residentBytes -= size;
+			++Stats.Evictions;
+		}
+	}
+}
+
+const STextureResidencyStats& COpenGL3TextureResidency::getStats() const
+{
+	Stats.TextureCount = Textures.size();
+	Stats.ResidentCount = 0;
+	Stats.ResidentBytes = 0;
+	Stats.EvictedBytes = 0;
+
+	for (auto texture : Textures)
+	{
+		if (texture->isResident())
+		{
+			++Stats.ResidentCount;
+			Stats.ResidentBytes += texture->getMemorySize();
+		}
+		else
+		{
+			Stats.EvictedBytes += texture->getMemorySize();
+		}
+	}
+
+	// each eviction ends with a restore, unless the texture is still evicted or was removed
+	Stats.Restores = Stats.Evictions - RemovedEvictions - (Stats.TextureCount - Stats.ResidentCount);
+
+	return Stats;
+}
+
+}
+}
@@ -0,0 +1,54 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#pragma once
+
+#include "Common.h"
+#include "ITexture.h"
+#include "IVideoDriver.h"
+#include <vector>
+
+namespace irr
+{
+namespace video
+{
+
+//! Keeps the video memory used by textures within a budget
+/** Textures are evicted in least recently used order at the end of a frame,
+the cache handler uploads them again when they are bound. Textures used in
+the current frame are never evicted, so the budget can be exceeded if they
+don't fit. */
+class COpenGL3TextureResidency
+{
+public:
+	COpenGL3TextureResidency(COpenGL3DriverBase* driver);
+
+	//! Starts tracking a texture, it is not grabbed
+	void add(COpenGL3Texture* texture);
+
+	//! Stops tracking a texture
+	void remove(const ITexture* texture);
+
+	//! Stops tracking all textures
+	void clear();
+
+	void setBudget(u64 bytes);
+
+	//! Evicts textures until the resident ones fit into the budget
+	void update();
+
+	const STextureResidencyStats& getStats() const;
+
+private:
+	COpenGL3DriverBase* Driver;
+
+	std::vector<COpenGL3Texture*> Textures;
+
+	//! Evictions of textures removed before they were restored
+	u32 RemovedEvictions;
+
+	mutable STextureResidencyStats Stats;
+};
+
+}
+}
@@ -0,0 +1,334 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#include "WeightedTransparency.h"
+
+#include "Driver.h"
+
+#include "COpenGLCoreCacheHandler.h"
+#include "os.h"
+
+#include "mt_opengl.h"
+
+namespace irr
+{
+namespace video
+{
+
+// above the units of the materials, so the cache handler never binds these
+static constexpr u32 AccumulationTextureUnit = MATERIAL_MAX_TEXTURES;
+static constexpr u32 WeightTextureUnit = MATERIAL_MAX_TEXTURES + 1;
+
+// one triangle covering the viewport, without vertex attributes
+static const c8* const CompositeVertexShader =
+	"void main()\n"
+	"{\n"
+	"	vec2 position = vec2(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0);\n"
+	"	gl_Position = vec4(position, 0.0, 1.0);\n"
+	"}\n";
+
+// premultiplied, so blending it over the framebuffer keeps what the transparent materials reveal of it
+static const c8* const CompositeFragmentShader =
+	"uniform sampler2D uAccumulation;\n"
+	"uniform sampler2D uWeights;\n"
+	"out vec4 outColor;\n"
+	"void main()\n"
+	"{\n"
+	"	ivec2 texel = ivec2(gl_FragCoord.xy);\n"
+	"	vec4 accumulation = texelFetch(uAccumulation, texel, 0);\n"
+	"	float revealage = accumulation.a;\n"
+	"	if (revealage >= 1.0)\n"
+	"		discard;\n"
+	"	float weights = texelFetch(uWeights, texel, 0).r;\n"
+	"	vec3 color = accumulation.rgb / max(weights, 0.00001);\n"
+	"	outColor = vec4(color * (1.0 - revealage), 1.0 - revealage);\n"
+	"}\n";
+
+static GLuint compileShader(GLenum type, const c8* version, const c8* source)
+{
+	const c8* sources[] = { version, source };
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 2, sources, NULL);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		os::Printer::log("Weighted transparency shader failed to compile", ELL_ERROR);
+
+		GLint maxLength = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
+		if (maxLength)
+		{
+			GLchar *infoLog = new GLchar[maxLength];
+			glGetShaderInfoLog(shader, maxLength, NULL, infoLog);
+			os::Printer::log(reinterpret_cast<const c8*>(infoLog), ELL_ERROR);
+			delete [] infoLog;
+		}
+
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+COpenGL3WeightedTransparency::COpenGL3WeightedTransparency(COpenGL3DriverBase* driver) :
+	Driver(driver), Program(0), VertexArray(0), FrameBuffer(0), AccumulationTexture(0),
+	WeightTexture(0), DepthBuffer(0), DepthFormat(GL_NONE), TargetFrameBuffer(0),
+	DepthCopyChecked(false)
+{
+}
+
+COpenGL3WeightedTransparency::~COpenGL3WeightedTransparency()
+{
+	deleteBuffers();
+	if (Program)
+		glDeleteProgram(Program);
+	if (VertexArray)
+		GL.DeleteVertexArrays(1, &VertexArray);
+}
+
+bool COpenGL3WeightedTransparency::init(bool gles)
+{
+	const c8* version = gles ? "#version 300 es\nprecision highp float;\n" : "#version 150\n";
+	GLuint vertexShader = compileShader(GL_VERTEX_SHADER, version, CompositeVertexShader);
+	GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, version, CompositeFragmentShader);
+	if (!vertexShader || !fragmentShader)
+	{
+		if (vertexShader)
+			glDeleteShader(vertexShader);
+		if (fragmentShader)
+			glDeleteShader(fragmentShader);
+		return false;
+	}
+
+	Program = glCreateProgram();
+	glAttachShader(Program, vertexShader);
+	glAttachShader(Program, fragmentShader);
+	glLinkProgram(Program);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(Program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		os::Printer::log("Weighted transparency shader failed to link", ELL_ERROR);
+		glDeleteProgram(Program);
+		Program = 0;
+		return false;
+	}
+
+	COpenGL3CacheHandler* cacheHandler = Driver->getCacheHandler();
+	cacheHandler->setProgram(Program);
+	glUniform1i(glGetUniformLocation(Program, "uAccumulation"), AccumulationTextureUnit);
+	glUniform1i(glGetUniformLocation(Program, "uWeights"), WeightTextureUnit);
+	cacheHandler->setProgram(0);
+
+	// core profiles draw nothing without a vertex array, even if no attribute is read
+	GL.GenVertexArrays(1, &VertexArray);
+
+	return VertexArray != 0;
+}
+
+bool COpenGL3WeightedTransparency::getDepthFormat(GLuint frameBuffer, GLenum& format)
+{
+	// the default framebuffer names its buffers instead of attachments
+	const GLenum depthAttachment = frameBuffer ? GL.DEPTH_ATTACHMENT : GL.DEPTH;
+	const GLenum stencilAttachment = frameBuffer ? GL.STENCIL_ATTACHMENT : GL.STENCIL;
+
+	GLint type = GL_NONE;
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, depthAttachment, GL.FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+	if (type == GL_NONE)
+	{
+		format = GL_NONE;
+		return true;
+	}
+
+	GLint depthBits = 0;
+	GLint componentType = GL_NONE;
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, depthAttachment, GL.FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, depthAttachment, GL.FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &componentType);
+
+	GLint stencilBits = 0;
+	glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, stencilAttachment, GL.FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type);
+	if (type != GL_NONE)
+		glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, stencilAttachment, GL.FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencilBits);
+
+	// blits of depth and stencil need the same formats on both sides
+	if (componentType == GL_FLOAT && depthBits == 32)
+		format = stencilBits == 8 ? GL.DEPTH32F_STENCIL8 : GL.DEPTH_COMPONENT32F;
+	else if (depthBits == 24)
+		format = stencilBits == 8 ? GL.DEPTH24_STENCIL8 : GL.DEPTH_COMPONENT24;
+	else if (depthBits == 16 && stencilBits == 0)
+		format = GL.DEPTH_COMPONENT16;
+	else if (depthBits == 32 && stencilBits == 0)
+		format = GL.DEPTH_COMPONENT32;
+	else
+		return false;
+
+	return stencilBits == 0 || stencilBits == 8;
+}
+
+bool COpenGL3WeightedTransparency::createBuffers(GLenum depthFormat, const core::dimension2d<u32>& size)
+{
+	deleteBuffers();
+
+	DepthFormat = depthFormat;
+	Size = size;
+	DepthCopyChecked = false;
+
+	COpenGL3CacheHandler* cacheHandler = Driver->getCacheHandler();
+
+	GLenum activeTexture = 0;
+	cacheHandler->getActiveTexture(activeTexture);
+	cacheHandler->setActiveTexture(GL_TEXTURE0 + AccumulationTextureUnit);
+
+	glGenTextures(1, &AccumulationTexture);
+	glBindTexture(GL_TEXTURE_2D, AccumulationTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL.RGBA16F, size.Width, size.Height, 0, GL_RGBA, GL.HALF_FLOAT, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	cacheHandler->setActiveTexture(GL_TEXTURE0 + WeightTextureUnit);
+
+	glGenTextures(1, &WeightTexture);
+	glBindTexture(GL_TEXTURE_2D, WeightTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL.R16F, size.Width, size.Height, 0, GL.RED, GL.HALF_FLOAT, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	cacheHandler->setActiveTexture(activeTexture);
+
+	glGenFramebuffers(1, &FrameBuffer);
+	cacheHandler->setFBO(FrameBuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, AccumulationTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL.COLOR_ATTACHMENT1, GL_TEXTURE_2D, WeightTexture, 0);
+
+	if (depthFormat != GL_NONE)
+	{
+		glGenRenderbuffers(1, &DepthBuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, DepthBuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, depthFormat, size.Width, size.Height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		const bool stencil = depthFormat == GL.DEPTH24_STENCIL8 || depthFormat == GL.DEPTH32F_STENCIL8;
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, stencil ? GL.DEPTH_STENCIL_ATTACHMENT : GL.DEPTH_ATTACHMENT,
+			GL_RENDERBUFFER, DepthBuffer);
+	}
+
+	const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL.COLOR_ATTACHMENT1 };
+	GL.DrawBuffers(2, drawBuffers);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL.FRAMEBUFFER_COMPLETE)
+	{
+		os::Printer::log("Could not create the buffers for weighted transparency", ELL_WARNING);
+		cacheHandler->setFBO(TargetFrameBuffer);
+		deleteBuffers();
+		return false;
+	}
+
+	return true;
+}
+
+void COpenGL3WeightedTransparency::deleteBuffers()
+{
+	if (FrameBuffer)
+		glDeleteFramebuffers(1, &FrameBuffer);
+	if (AccumulationTexture)
+		glDeleteTextures(1, &AccumulationTexture);
+	if (WeightTexture)
+		glDeleteTextures(1, &WeightTexture);
+	if (DepthBuffer)
+		glDeleteRenderbuffers(1, &DepthBuffer);
+
+	FrameBuffer = 0;
+	AccumulationTexture = 0;
+	WeightTexture = 0;
+	DepthBuffer = 0;
+	Size = core::dimension2d<u32>(0, 0);
+}
+
+bool COpenGL3WeightedTransparency::begin(GLuint frameBuffer, const core::dimension2d<u32>& size)
+{
+	TargetFrameBuffer = frameBuffer;
+
+	GLenum depthFormat = GL_NONE;
+	if (!getDepthFormat(frameBuffer, depthFormat))
+	{
+		os::Printer::log("Weighted transparency can't copy the depth format of the render target", ELL_WARNING);
+		return false;
+	}
+
+	COpenGL3CacheHandler* cacheHandler = Driver->getCacheHandler();
+
+	if (!FrameBuffer || size != Size || depthFormat != DepthFormat)
+	{
+		if (!createBuffers(depthFormat, size))
+			return false;
+	}
+	else
+		cacheHandler->setFBO(FrameBuffer);
+
+	// the transparent materials are hidden by what was drawn before them
+	if (DepthBuffer)
+	{
+		const bool stencil = DepthFormat == GL.DEPTH24_STENCIL8 || DepthFormat == GL.DEPTH32F_STENCIL8;
+		glBindFramebuffer(GL.READ_FRAMEBUFFER, frameBuffer);
+		GL.BlitFramebuffer(0, 0, Size.Width, Size.Height, 0, 0, Size.Width, Size.Height,
+			GL_DEPTH_BUFFER_BIT | (stencil ? GL_STENCIL_BUFFER_BIT : 0), GL_NEAREST);
+		glBindFramebuffer(GL.READ_FRAMEBUFFER, FrameBuffer);
+
+		// matching sizes don't guarantee matching formats of the default framebuffer
+		if (!DepthCopyChecked)
+		{
+			if (glGetError() != GL_NO_ERROR)
+			{
+				os::Printer::log("Weighted transparency could not copy the depth of the render target", ELL_WARNING);
+				cacheHandler->setFBO(frameBuffer);
+				deleteBuffers();
+				return false;
+			}
+			DepthCopyChecked = true;
+		}
+	}
+
+	const GLfloat accumulation[] = { 0.f, 0.f, 0.f, 1.f };
+	const GLfloat weights[] = { 0.f, 0.f, 0.f, 0.f };
+	cacheHandler->setColorMask(ECP_ALL);
+	GL.ClearBufferfv(GL_COLOR, 0, accumulation);
+	GL.ClearBufferfv(GL_COLOR, 1, weights);
+
+	return true;
+}
+
+void COpenGL3WeightedTransparency::end()
+{
+	COpenGL3CacheHandler* cacheHandler = Driver->getCacheHandler();
+	cacheHandler->setFBO(TargetFrameBuffer);
+
+	GLenum activeTexture = 0;
+	cacheHandler->getActiveTexture(activeTexture);
+	cacheHandler->setActiveTexture(GL_TEXTURE0 + AccumulationTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, AccumulationTexture);
+	cacheHandler->setActiveTexture(GL_TEXTURE0 + WeightTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, WeightTexture);
+	cacheHandler->setActiveTexture(activeTexture);
+
+	cacheHandler->setProgram(Program);
+	cacheHandler->setBlend(true);
+	cacheHandler->setBlendEquation(GL_FUNC_ADD);
+	cacheHandler->setBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	cacheHandler->setDepthTest(false);
+	cacheHandler->setCullFace(false);
+	cacheHandler->setColorMask(ECP_ALL);
+
+	GL.BindVertexArray(VertexArray);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	GL.BindVertexArray(0);
+}
+
+}
+}
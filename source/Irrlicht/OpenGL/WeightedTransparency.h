@@ -0,0 +1,75 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in Irrlicht.h
+
+#pragma once
+
+#include "Common.h"
+#include "dimension2d.h"
+
+namespace irr
+{
+namespace video
+{
+
+class COpenGL3DriverBase;
+
+//! Accumulates transparent materials for weighted blended order-independent transparency
+/** The materials add their colors, weighted by their alpha and view depth,
+into a half float texture and their weights into a second one, while the
+alpha of the first one multiplies what remains visible of the pixel behind
+them. See McGuire and Bavoil, "Weighted Blended Order-Independent
+Transparency", JCGT 2013. A triangle covering the viewport then blends the
+weighted average color over the framebuffer the materials were meant for.
+
+The depth of that framebuffer is copied into the accumulation buffers, so
+it needs a depth format which can be recreated by a renderbuffer. The
+composite shader needs GLSL 1.50 or ESSL 3.00. */
+class COpenGL3WeightedTransparency
+{
+public:
+	COpenGL3WeightedTransparency(COpenGL3DriverBase* driver);
+	~COpenGL3WeightedTransparency();
+
+	//! Compiles the composite shader, weighted transparency can't be used if this fails
+	bool init(bool gles);
+
+	//! Binds the accumulation buffers, cleared and with a copy of the depth of frameBuffer
+	/** \param frameBuffer The bound framebuffer, blended over by end()
+	\param size Size of frameBuffer
+	\return False if the accumulation buffers can't be created for frameBuffer */
+	bool begin(GLuint frameBuffer, const core::dimension2d<u32>& size);
+
+	//! Binds the framebuffer passed to begin() again and blends the accumulated colors over it
+	/** Changes the program, blending, depth test, culling and the color mask. */
+	void end();
+
+private:
+	//! Renderbuffer format with the depth and stencil bits of the bound framebuffer, GL_NONE without depth
+	/** \return False if no format matches */
+	static bool getDepthFormat(GLuint frameBuffer, GLenum& format);
+
+	bool createBuffers(GLenum depthFormat, const core::dimension2d<u32>& size);
+	void deleteBuffers();
+
+	COpenGL3DriverBase* Driver;
+
+	GLuint Program;
+	GLuint VertexArray;
+
+	GLuint FrameBuffer;
+	//! Weighted colors and the remaining visibility in alpha
+	GLuint AccumulationTexture;
+	//! Sum of the weights
+	GLuint WeightTexture;
+	GLuint DepthBuffer;
+	GLenum DepthFormat;
+	core::dimension2d<u32> Size;
+
+	//! The framebuffer bound at begin()
+	GLuint TargetFrameBuffer;
+	//! False until the depth was copied once without an error
+	bool DepthCopyChecked;
+};
+
+}
+}
@@ -0,0 +1,107 @@
+// This file is part of the "Irrlicht Engine".
+// For conditions of distribution and use, see copyright notice in irrlicht.h
+
+// IRB is a binary format of finalized skinned meshes, read by
+// CIRBMeshFileLoader and written by CIRBMeshWriter. The arrays of the mesh are
+// stored in the layout they have in memory, so it is only meant as a cache on
+// the machine which wrote it, not for exchanging meshes.
+//
+// Layout, all values in the byte order of the writing machine:
+//   SIRBHeader
+//   per mesh buffer:
+//     SIRBBufferHeader
+//     vertices, VertexCount times the vertex struct of VertexType
+//     indices, IndexCount times u16
+//   per joint, in the order of ISkinnedMesh::getAllJoints():
+//     SIRBJointHeader
+//     name, NameLength chars without terminating zero
+//     attached mesh buffers, AttachedMeshCount times u32
+//     position keys, PositionKeyCount times ISkinnedMesh::SPositionKey
+//     scale keys, ScaleKeyCount times ISkinnedMesh::SScaleKey
+//     rotation keys, RotationKeyCount times ISkinnedMesh::SRotationKey
+//     weights, WeightCount times u16 buffer_id, then u32 vertex_id, then f32 strength
+
+#ifndef __S_IRB_STRUCTS_H_INCLUDED__
+#define __S_IRB_STRUCTS_H_INCLUDED__
+
+#include "irrTypes.h"
+
+namespace irr
+{
+namespace scene
+{
+
+//! First four bytes of an IRB file
+const u32 IRB_MAGIC = MAKE_IRR_ID('I','R','B','M');
+
+//! Increased whenever the layout changes, files of other versions aren't loaded
+const u32 IRB_VERSION = 1;
+
+//! Flags of SIRBMaterial
+enum E_IRB_MATERIAL_FLAGS
+{
+	EIRBMF_WIREFRAME = 0x1,
+	EIRBMF_GOURAUD_SHADING = 0x2,
+	EIRBMF_LIGHTING = 0x4,
+	EIRBMF_BACKFACE_CULLING = 0x8,
+	EIRBMF_FRONTFACE_CULLING = 0x10,
+	EIRBMF_FOG_ENABLE = 0x20,
+	EIRBMF_NORMALIZE_NORMALS = 0x40
+};
+
+struct SIRBHeader
+{
+	u32 Magic;
+	u32 Version;
+	//! sizeof the vertex structs of EVT_STANDARD, EVT_2TCOORDS and EVT_TANGENTS,
+	//! and of the quaternion, to reject files of a different memory layout
+	u8 LayoutSizes[4];
+	f32 FramesPerSecond;
+	u32 BufferCount;
+	u32 JointCount;
+};
+
+//! The parts of video::SMaterial the mesh loaders set
+struct SIRBMaterial
+{
+	u32 MaterialType;
+	f32 MaterialTypeParam;
+	u32 AmbientColor;
+	u32 DiffuseColor;
+	u32 SpecularColor;
+	u32 EmissiveColor;
+	f32 Shininess;
+	u8 ColorMaterial;
+	u8 ZWriteEnable;
+	u8 Flags;
+	u8 Padding;
+};
+
+struct SIRBBufferHeader
+{
+	u32 VertexType;
+	u32 VertexCount;
+	u32 IndexCount;
+	u32 PrimitiveType;
+	SIRBMaterial Material;
+	f32 Transformation[16];
+};
+
+struct SIRBJointHeader
+{
+	//! index of the parent joint, -1 for root joints
+	s32 Parent;
+	u32 NameLength;
+	f32 LocalMatrix[16];
+	f32 GlobalInversedMatrix[16];
+	u32 AttachedMeshCount;
+	u32 PositionKeyCount;
+	u32 ScaleKeyCount;
+	u32 RotationKeyCount;
+	u32 WeightCount;
+};
+
+} // end namespace scene
+} // end namespace irr
+
+#endif
@@ -6,6 +6,20 @@ OpenGLProcedures GL = OpenGLProcedures();
 
 void OpenGLProcedures::LoadAllProcedures(irr::video::IContextManager *cmgr)
 {
+	// Entry points are only looked up while still missing, so with another context of
+	// the same driver everything left to do is failing the missing ones again.
+	if (!GetString) GetString = (PFNGLGETSTRINGPROC_MT)cmgr->getProcAddress("glGetString");
+	if (!GetString)
+		return;
+	std::string context;
+	for (GLenum name : {VENDOR, RENDERER, VERSION}) {
+		auto str = GetString(name);
+		context.append(str ? (const char *)str : "").append("/");
+	}
+	if (context == loadedContext)
+		return;
+	loadedContext = context;
+	extensions.clear();
 
 	if (!CullFace) CullFace = (PFNGLCULLFACEPROC_MT)cmgr->getProcAddress("glCullFace");
 	if (!FrontFace) FrontFace = (PFNGLFRONTFACEPROC_MT)cmgr->getProcAddress("glFrontFace");
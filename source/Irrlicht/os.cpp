@@ -105,6 +105,23 @@ namespace os
 		return GetTickCount();
 	}
 
+	u64 Timer::getRealTimeNs()
+	{
+		if (HighPerformanceTimerSupport)
+		{
+			LARGE_INTEGER nTime;
+			if (QueryPerformanceCounter(&nTime))
+			{
+				// split to not overflow with high counter frequencies
+				const u64 freq = HighPerformanceFreq.QuadPart;
+				const u64 count = nTime.QuadPart;
+				return (count / freq) * 1000000000 + (count % freq) * 1000000000 / freq;
+			}
+		}
+
+		return GetTickCount64() * 1000000;
+	}
+
 } // end namespace os
 
 
@@ -115,6 +132,7 @@ namespace os
 // ----------------------------------------------------------------
 
 #include <android/log.h>
+#include <time.h>
 
 namespace irr
 {
@@ -169,6 +187,13 @@ namespace os
 		gettimeofday(&tv, 0);
 		return (u32)(tv.tv_sec * 1000) + (tv.tv_usec / 1000);
 	}
+
+	u64 Timer::getRealTimeNs()
+	{
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	}
 } // end namespace os
 
 #elif defined(_IRR_EMSCRIPTEN_PLATFORM_)
@@ -221,6 +246,11 @@ namespace os
         double time = emscripten_get_now();
         return (u32)(time);
 	}
+
+	u64 Timer::getRealTimeNs()
+	{
+		return (u64)(emscripten_get_now() * 1000000.0);
+	}
 } // end namespace os
 
 #else
@@ -255,6 +285,13 @@ namespace os
 		gettimeofday(&tv, 0);
 		return (u32)(tv.tv_sec * 1000) + (tv.tv_usec / 1000);
 	}
+
+	u64 Timer::getRealTimeNs()
+	{
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	}
 } // end namespace os
 
 #endif // end linux / emscripten / android / windows
@@ -293,9 +330,9 @@ namespace os
 
 	f32 Timer::VirtualTimerSpeed = 1.0f;
 	s32 Timer::VirtualTimerStopCounter = 0;
-	u32 Timer::LastVirtualTime = 0;
-	u32 Timer::StartRealTime = 0;
-	u32 Timer::StaticTime = 0;
+	u64 Timer::LastVirtualTimeNs = 0;
+	u64 Timer::StartRealTimeNs = 0;
+	u64 Timer::StaticTimeNs = 0;
 
 	//! Get real time and date in calendar form
 	ITimer::RealTimeDate Timer::getRealTimeAndDate()
@@ -328,25 +365,37 @@ namespace os
 
 	//! returns current virtual time
 	u32 Timer::getTime()
+	{
+		return (u32)(getTimeNs() / 1000000);
+	}
+
+	//! returns current virtual time in nanoseconds
+	u64 Timer::getTimeNs()
 	{
 		if (isStopped())
-			return LastVirtualTime;
+			return LastVirtualTimeNs;
 
-		return LastVirtualTime + (u32)((StaticTime - StartRealTime) * VirtualTimerSpeed);
+		return LastVirtualTimeNs + (u64)((f64)(StaticTimeNs - StartRealTimeNs) * VirtualTimerSpeed);
 	}
 
 	//! ticks, advances the virtual timer
 	void Timer::tick()
 	{
-		StaticTime = getRealTime();
+		StaticTimeNs = getRealTimeNs();
 	}
 
 	//! sets the current virtual time
 	void Timer::setTime(u32 time)
 	{
-		StaticTime = getRealTime();
-		LastVirtualTime = time;
-		StartRealTime = StaticTime;
+		setTimeNs((u64)time * 1000000);
+	}
+
+	//! sets the current virtual time in nanoseconds
+	void Timer::setTimeNs(u64 time)
+	{
+		StaticTimeNs = getRealTimeNs();
+		LastVirtualTimeNs = time;
+		StartRealTimeNs = StaticTimeNs;
 	}
 
 	//! stops the virtual timer
@@ -355,7 +404,7 @@ namespace os
 		if (!isStopped())
 		{
 			// stop the virtual timer
-			LastVirtualTime = getTime();
+			LastVirtualTimeNs = getTimeNs();
 		}
 
 		--VirtualTimerStopCounter;
@@ -369,14 +418,14 @@ namespace os
 		if (!isStopped())
 		{
 			// restart virtual timer
-			setTime(LastVirtualTime);
+			setTimeNs(LastVirtualTimeNs);
 		}
 	}
 
 	//! sets the speed of the virtual timer
 	void Timer::setSpeed(f32 speed)
 	{
-		setTime(getTime());
+		setTimeNs(getTimeNs());
 
 		VirtualTimerSpeed = speed;
 		if (VirtualTimerSpeed < 0.0f)
@@ -397,8 +446,8 @@ namespace os
 
 	void Timer::initVirtualTimer()
 	{
-		StaticTime = getRealTime();
-		StartRealTime = StaticTime;
+		StaticTimeNs = getRealTimeNs();
+		StartRealTimeNs = StaticTimeNs;
 	}
 
 } // end namespace os
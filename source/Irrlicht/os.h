@@ -52,6 +52,9 @@ namespace os
 		//! returns the current time in milliseconds
 		static u32 getTime();
 
+		//! returns the current virtual time in nanoseconds
+		static u64 getTimeNs();
+
 		//! get current time and date in calendar form
 		static ITimer::RealTimeDate getRealTimeAndDate();
 
@@ -61,6 +64,9 @@ namespace os
 		//! sets the current virtual (game) time
 		static void setTime(u32 time);
 
+		//! sets the current virtual (game) time in nanoseconds
+		static void setTimeNs(u64 time);
+
 		//! stops the virtual (game) timer
 		static void stopTimer();
 
@@ -82,15 +88,18 @@ namespace os
 		//! returns the current real time in milliseconds
 		static u32 getRealTime();
 
+		//! returns the time of a monotonic clock in nanoseconds
+		static u64 getRealTimeNs();
+
 	private:
 
 		static void initVirtualTimer();
 
 		static f32 VirtualTimerSpeed;
 		static s32 VirtualTimerStopCounter;
-		static u32 StartRealTime;
-		static u32 LastVirtualTime;
-		static u32 StaticTime;
+		static u64 StartRealTimeNs;
+		static u64 LastVirtualTimeNs;
+		static u64 StaticTimeNs;
 	};
 
 } // end namespace os